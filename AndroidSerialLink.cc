@@ -0,0 +1,290 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AndroidSerialLink
+ *          See AndroidSerialLink.h
+ *
+ */
+
+#include "AndroidSerialLink.h"
+#include "MemoryBudget.h"
+#include "SharedTelemetry.h"
+#include "QsLog.h"
+#include <QHash>
+#include "GroundClock.h"
+#include <QMutexLocker>
+#include <QtAndroidExtras/QAndroidJniObject>
+#include <QtAndroidExtras/QAndroidJniEnvironment>
+#include <jni.h>
+
+static const char *UsbSerialClass = "org/qtproject/qt5/android/bindings/UsbSerial";
+// UsbSerial.PERMISSION_PENDING
+static const int PermissionPending = -2;
+
+// Links by id for the Java callbacks, which only know the id
+static QMutex registryMutex;
+static QHash<int, AndroidSerialLink*> registry;
+
+static void clearException(QAndroidJniEnvironment &env)
+{
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+static void nativeDataReceived(JNIEnv *env, jclass, jint linkId, jbyteArray array, jint length)
+{
+    AndroidSerialLink *link;
+    {
+        QMutexLocker locker(&registryMutex);
+        link = registry.value(linkId);
+    }
+    if (!link || length <= 0)
+    {
+        return;
+    }
+    // close() joins the reader thread we are on, so the link outlives this call
+    QByteArray data(length, Qt::Uninitialized);
+    env->GetByteArrayRegion(array, 0, length, reinterpret_cast<jbyte*>(data.data()));
+    link->dataReceived(data);
+}
+
+static void nativePermission(JNIEnv *, jclass, jint linkId, jboolean granted)
+{
+    QMutexLocker locker(&registryMutex);
+    AndroidSerialLink *link = registry.value(linkId);
+    if (link)
+    {
+        QMetaObject::invokeMethod(link, "permissionResult", Qt::QueuedConnection, Q_ARG(bool, granted));
+    }
+}
+
+static void nativeDetached(JNIEnv *, jclass, jint linkId)
+{
+    QMutexLocker locker(&registryMutex);
+    AndroidSerialLink *link = registry.value(linkId);
+    if (link)
+    {
+        QMetaObject::invokeMethod(link, "deviceDetached", Qt::QueuedConnection);
+    }
+}
+
+JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *)
+{
+    JNIEnv *env;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK)
+    {
+        return JNI_ERR;
+    }
+    static JNINativeMethod methods[] = {
+        { const_cast<char*>("nativeDataReceived"), const_cast<char*>("(I[BI)V"), reinterpret_cast<void*>(nativeDataReceived) },
+        { const_cast<char*>("nativePermission"), const_cast<char*>("(IZ)V"), reinterpret_cast<void*>(nativePermission) },
+        { const_cast<char*>("nativeDetached"), const_cast<char*>("(I)V"), reinterpret_cast<void*>(nativeDetached) }
+    };
+    // The library's own class loader is only in reach here, not on Qt's threads
+    jclass usbSerial = env->FindClass(UsbSerialClass);
+    if (!usbSerial || env->RegisterNatives(usbSerial, methods, sizeof(methods) / sizeof(methods[0])) < 0)
+    {
+        QLOG_ERROR() << "Cannot register the USB serial natives";
+        env->ExceptionClear();
+    }
+    // The one JNI_OnLoad of the library, the activity's natives go in here too
+    MemoryBudget::registerNatives(env);
+    SharedTelemetry::registerNatives(env);
+    return JNI_VERSION_1_6;
+}
+
+AndroidSerialLink::AndroidSerialLink(const QString &deviceName, int baudRate) :
+    m_deviceName(deviceName),
+    m_baudRate(baudRate > 0 ? baudRate : static_cast<int>(DefaultBaudRate)),
+    m_latencyMs(DefaultLatencyMs),
+    m_handle(-1),
+    m_permissionPending(false)
+{
+    m_id = getNextLinkId();
+    m_name = tr("USB serial (%1)").arg(deviceName.isEmpty() ? tr("first adapter") : deviceName);
+    QMutexLocker locker(&registryMutex);
+    registry.insert(m_id, this);
+}
+
+AndroidSerialLink::~AndroidSerialLink()
+{
+    disconnect();
+    QMutexLocker locker(&registryMutex);
+    registry.remove(m_id);
+}
+
+QStringList AndroidSerialLink::availableDevices()
+{
+    QAndroidJniObject devices = QAndroidJniObject::callStaticObjectMethod(UsbSerialClass, "devices", "()Ljava/lang/String;");
+    QAndroidJniEnvironment env;
+    clearException(env);
+    if (!devices.isValid())
+    {
+        return QStringList();
+    }
+    return devices.toString().split('\n', QString::SkipEmptyParts);
+}
+
+bool AndroidSerialLink::isConnected() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_handle >= 0;
+}
+
+bool AndroidSerialLink::connect()
+{
+    if (isConnected())
+    {
+        return true;
+    }
+    QAndroidJniObject device = QAndroidJniObject::fromString(m_deviceName);
+    jint handle = QAndroidJniObject::callStaticMethod<jint>(UsbSerialClass, "open", "(Ljava/lang/String;III)I",
+                                                            device.object<jstring>(), m_baudRate, m_latencyMs, m_id);
+    QAndroidJniEnvironment env;
+    clearException(env);
+    if (handle == PermissionPending)
+    {
+        // permissionResult() connects once the user agreed
+        m_permissionPending = true;
+        emit communicationUpdate(m_name, tr("Waiting for permission to use the USB device"));
+        return false;
+    }
+    if (handle < 0)
+    {
+        QLOG_WARN() << "Cannot open USB serial device" << m_deviceName;
+        emit error(this, tr("Cannot open USB serial device %1").arg(m_deviceName));
+        return false;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_handle = handle;
+    }
+    QLOG_INFO() << "Opened" << m_name << "at" << m_baudRate << "baud";
+    emit connected(true);
+    emit connected(this);
+    emit connected();
+    return true;
+}
+
+bool AndroidSerialLink::disconnect()
+{
+    m_permissionPending = false;
+    int handle;
+    {
+        QMutexLocker locker(&m_mutex);
+        handle = m_handle;
+        m_handle = -1;
+    }
+    if (handle < 0)
+    {
+        return false;
+    }
+    // Returns once the reader thread is gone
+    QAndroidJniObject::callStaticMethod<void>(UsbSerialClass, "close", "(I)V", handle);
+    QAndroidJniEnvironment env;
+    clearException(env);
+    emit connected(false);
+    emit disconnected(this);
+    emit disconnected();
+    return true;
+}
+
+void AndroidSerialLink::permissionResult(bool granted)
+{
+    if (!m_permissionPending)
+    {
+        return;
+    }
+    m_permissionPending = false;
+    if (!granted)
+    {
+        emit error(this, tr("No permission to use the USB device"));
+        return;
+    }
+    connect();
+}
+
+void AndroidSerialLink::deviceDetached()
+{
+    QLOG_WARN() << m_name << "was unplugged";
+    disconnect();
+    emit communicationError(m_name, tr("USB device unplugged"));
+}
+
+void AndroidSerialLink::dataReceived(const QByteArray &data)
+{
+    inTraffic.add(data.size(), 1, GroundClock::msecs());
+    emit bytesReceived(this, data);
+}
+
+void AndroidSerialLink::writeBytes(const char *bytes, qint64 length)
+{
+    int handle;
+    {
+        QMutexLocker locker(&m_mutex);
+        handle = m_handle;
+    }
+    if (handle < 0 || length <= 0)
+    {
+        return;
+    }
+    QAndroidJniEnvironment env;
+    jbyteArray array = env->NewByteArray(length);
+    env->SetByteArrayRegion(array, 0, length, reinterpret_cast<const jbyte*>(bytes));
+    jint written = QAndroidJniObject::callStaticMethod<jint>(UsbSerialClass, "write", "(I[B)I", handle, array);
+    clearException(env);
+    env->DeleteLocalRef(array);
+    if (written > 0)
+    {
+        outTraffic.add(written, 1, GroundClock::msecs());
+    }
+}
+
+void AndroidSerialLink::setBaudRate(int baudRate)
+{
+    if (baudRate <= 0)
+    {
+        return;
+    }
+    m_baudRate = baudRate;
+    int handle;
+    {
+        QMutexLocker locker(&m_mutex);
+        handle = m_handle;
+    }
+    if (handle >= 0)
+    {
+        QAndroidJniObject::callStaticMethod<jboolean>(UsbSerialClass, "setBaudRate", "(II)Z", handle, baudRate);
+        QAndroidJniEnvironment env;
+        clearException(env);
+    }
+}
+
+void AndroidSerialLink::setLatencyTimer(int latencyMs)
+{
+    m_latencyMs = qBound(1, latencyMs, 255);
+}
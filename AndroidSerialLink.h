@@ -0,0 +1,104 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AndroidSerialLink
+ *          Telemetry radios on the USB port of an Android device, through the
+ *          USB host API in UsbSerial.java. FTDI, CP210x and CDC-ACM adapters
+ *          are driven without a serial driver in the kernel. The Java reader
+ *          thread issues large bulk IN transfers and every buffer it gets goes
+ *          to bytesReceived() in one piece, straight to the ingest path.
+ *
+ */
+
+#ifndef ANDROIDSERIALLINK_H
+#define ANDROIDSERIALLINK_H
+
+#include <QStringList>
+#include <QMutex>
+#include "LinkInterface.h"
+
+class AndroidSerialLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    enum {
+        DefaultBaudRate = 57600,
+        DefaultLatencyMs = 2        ///< FTDI latency timer, the chip's default of 16 ms adds that to every short burst
+    };
+
+    /** @brief deviceName as listed by availableDevices(), empty for the first adapter found */
+    explicit AndroidSerialLink(const QString &deviceName, int baudRate = DefaultBaudRate);
+    ~AndroidSerialLink();
+
+    /** @brief USB-serial adapters currently attached that can be driven */
+    static QStringList availableDevices();
+
+    void disableTimeouts() { }
+    void enableTimeouts() { }
+    void requestReset() { }
+
+    int getId() const { return m_id; }
+    QString getName() const { return m_name; }
+    bool isConnected() const;
+    qint64 getConnectionSpeed() const { return m_baudRate; }
+    qint64 bytesAvailable() { return 0; }
+    LinkType getLinkType() { return SERIAL_LINK; }
+
+    QString getDeviceName() const { return m_deviceName; }
+    int getBaudRate() const { return m_baudRate; }
+    int getLatencyTimer() const { return m_latencyMs; }
+
+    /** @brief Called on the Java reader thread with one bulk transfer's worth of bytes */
+    void dataReceived(const QByteArray &data);
+
+public slots:
+    bool connect();
+    bool disconnect();
+    /** @brief Blocking bulk OUT, from any thread */
+    void writeBytes(const char *bytes, qint64 length);
+    /** @brief Applied at once if connected */
+    void setBaudRate(int baudRate);
+    /** @brief FTDI only, 1 to 255 ms; takes effect on the next connect */
+    void setLatencyTimer(int latencyMs);
+
+protected slots:
+    void readBytes() { }
+
+private slots:
+    /** @brief The user answered the USB permission dialog */
+    void permissionResult(bool granted);
+    void deviceDetached();
+
+private:
+    int m_id;
+    QString m_name;
+    QString m_deviceName;
+    int m_baudRate;
+    int m_latencyMs;
+    mutable QMutex m_mutex;     ///< Guards m_handle, writers are on any thread
+    int m_handle;               ///< UsbSerial handle, -1 while closed
+    bool m_permissionPending;
+};
+
+#endif // ANDROIDSERIALLINK_H
@@ -32,6 +32,7 @@ This file is part of the QGROUNDCONTROL project
 #include "QsLog.h"
 #include "GAudioOutput.h"
 #include "LinkManager1.h"
+#include "MAVLinkDispatcher.h"
 
 
 #ifndef MAVLINK_MSG_ID_MOUNT_CONFIGURE
@@ -46,6 +47,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QDir>
 #include <QDesktopServices>
 #include <QSettings>
+#include <QVector>
 
 CustomMode::CustomMode()
 {
@@ -66,30 +68,67 @@ QString CustomMode::operator <<(int aMode)
     return QString::number(aMode);
 }
 
+namespace {
+
+// Mode names by mode number, for the heartbeat's custom_mode
+const char *const PlaneModeNames[] = {
+    "Manual", "Circle", "Stabilize", "Training", "Acro", "FBW A", "FBW B", "Cruise",
+    "Auto Tune", "Reserved", "Auto", "RTL", "Loiter", "Reserved", "Reserved", "Guided",
+    "Initializing"
+};
+
+const char *const CopterModeNames[] = {
+    "Stabilize", "Acro", "Alt Hold", "Auto", "Guided", "Loiter", "RTL", "Circle",
+    "Reserved", // POSITION, not supported since AC3.2
+    "Land", "OF Loiter", "Drift", "Reserved", "Sport", "Flip", "Autotune", "Position Hold"
+};
+
+const char *const RoverModeNames[] = {
+    "Manual", "Reserved", "Learning", "Steering", "Hold", "Reserved", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Auto", "RTL", "Reserved", "Reserved", "Reserved", "Guided",
+    "Initializing"
+};
+
+const char *const KmlModeColors[] = {
+    "FFFF00FF", "FF00FF00", "FFFF0000", "FFFF2323", "FFFFCE00", "FF00CEFF", "FF009900", "FF33FFCC",
+    "FF0000FF", "FFFFAAAA", "FFABABAB", "FF99FF33", "FF66CC99", "FFCC3300", "FF0066FF"
+};
+
+Q_STATIC_ASSERT(sizeof(PlaneModeNames) / sizeof(PlaneModeNames[0]) == ApmPlane::INITIALIZING + 1);
+Q_STATIC_ASSERT(sizeof(CopterModeNames) / sizeof(CopterModeNames[0]) == ApmCopter::POS_HOLD + 1);
+Q_STATIC_ASSERT(sizeof(RoverModeNames) / sizeof(RoverModeNames[0]) == ApmRover::INITIALIZING + 1);
+
+// One of the tables above as QStrings, converted once so a lookup only
+// copies a shared string
+class ModeStrings
+{
+public:
+    template <int N>
+    explicit ModeStrings(const char *const (&strings)[N])
+    {
+        m_strings.reserve(N);
+        for (int i = 0; i < N; ++i)
+            m_strings.append(QString::fromLatin1(strings[i]));
+    }
+
+    int count() const { return m_strings.size(); }
+    bool contains(int index) const { return index >= 0 && index < m_strings.size(); }
+    const QString& at(int index) const { return m_strings.at(index); }
+
+private:
+    QVector<QString> m_strings;
+};
+
+} // namespace
+
 QString CustomMode::colorForMode(int aMode)
 {
-    const uint numberOfKmlColors = 16;
-    const QString kmlColors[] = {"FFFF00FF"
-        , "FF00FF00"
-        , "FFFF0000"
-        , "FFFF2323"
-        , "FFFFCE00"
-        , "FF00CEFF"
-        , "FF009900"
-        , "FF33FFCC"
-        , "FF0000FF"
-        , "FFFFAAAA"
-        , "FFABABAB"
-        , "FF99FF33"
-        , "FF66CC99"
-        , "FFCC3300"
-        , "FF0066FF"};
-
-    if ((sizeof(kmlColors)/sizeof(const char*)) > aMode*numberOfKmlColors ){
+    static const ModeStrings colors(KmlModeColors);
+    if (!colors.contains(aMode)) {
         QLOG_ERROR() << "ColorForMode: not enough colors, so wrapping to 1st color";
-        aMode -= numberOfKmlColors;
+        aMode = qAbs(aMode) % colors.count();
     }
-    return kmlColors[aMode];
+    return colors.at(aMode);
 }
 
 ApmPlane::ApmPlane(planeMode aMode) : CustomMode(aMode)
@@ -103,56 +142,10 @@ ApmPlane::planeMode ApmPlane::mode()
 
 QString ApmPlane::stringForMode(int aMode)
 {
-    switch(static_cast<planeMode>(aMode)) {
-    case MANUAL:
-        return "Manual";
-        break;
-    case CIRCLE:
-        return "Circle";
-        break;
-    case STABILIZE:
-        return "Stabilize";
-        break;
-    case TRAINING:
-        return "Training";
-        break;
-    case FLY_BY_WIRE_A:
-        return "FBW A";
-        break;
-    case FLY_BY_WIRE_B:
-        return "FBW B";
-        break;
-    case AUTO:
-        return "Auto";
-        break;
-    case RTL:
-        return "RTL";
-        break;
-    case LOITER:
-        return "Loiter";
-        break;
-    case GUIDED:
-        return "Guided";
-        break;
-    case INITIALIZING:
-        return "Initializing";
-        break;
-    case ACRO:
-        return "Acro";
-        break;
-    case CRUISE:
-        return "Cruise";
-        break;
-    case AUTOTUNE:
-        return "Auto Tune";
-        break;
-    case RESERVED_9:
-    case RESERVED_13:
-    case RESERVED_14:
-        return "Reserved";
-    default:
-        return "Undefined: " + QString::number(aMode);
-    }
+    static const ModeStrings names(PlaneModeNames);
+    if (names.contains(aMode))
+        return names.at(aMode);
+    return "Undefined: " + QString::number(aMode);
 }
 
 ApmCopter::ApmCopter(copterMode aMode) : CustomMode(aMode)
@@ -164,62 +157,12 @@ ApmCopter::copterMode ApmCopter::mode()
     return static_cast<ApmCopter::copterMode>(m_mode);
 }
 
-QString ApmCopter::stringForMode(int aMode) {
-    switch(static_cast<copterMode>(aMode)) {
-    case STABILIZE:
-        return "Stabilize";
-        break;
-    case ACRO:
-        return "Acro";
-        break;
-    case ALT_HOLD:
-        return "Alt Hold";
-        break;
-    case AUTO:
-        return "Auto";
-        break;
-    case GUIDED:
-        return "Guided";
-        break;
-    case LOITER:
-        return "Loiter";
-        break;
-    case RTL:
-        return "RTL";
-        break;
-    case CIRCLE:
-        return "Circle";
-        break;
-    case POSITION:
-        return "Reserved"; // Marked as reserved as not supported since AC3.2
-        break;
-    case LAND:
-        return "Land";
-        break;
-    case OF_LOITER:
-        return "OF Loiter";
-        break;
-    case DRIFT:
-        return "Drift";
-        break;
-    case SPORT:
-        return "Sport";
-        break;
-    case RESERVED_12:
-        return "Reserved";
-        break;
-    case POS_HOLD:
-        return "Position Hold";
-        break;
-    case AUTOTUNE:
-        return "Autotune";
-        break;
-    case FLIP:
-        return "Flip";
-        break;
-    default:
-        return "Undefined";
-    }
+QString ApmCopter::stringForMode(int aMode)
+{
+    static const ModeStrings names(CopterModeNames);
+    if (names.contains(aMode))
+        return names.at(aMode);
+    return "Undefined";
 }
 
 ApmRover::ApmRover(roverMode aMode) : CustomMode(aMode)
@@ -231,45 +174,12 @@ ApmRover::roverMode ApmRover::mode()
     return static_cast<ApmRover::roverMode>(m_mode);
 }
 
-QString ApmRover::stringForMode(int aMode) {
-    switch(static_cast<roverMode>(aMode)) {
-    case MANUAL:
-        return "Manual";
-        break;
-    case LEARNING:
-        return "Learning";
-        break;
-    case STEERING:
-        return "Steering";
-        break;
-    case HOLD:
-        return "Hold";
-        break;
-    case AUTO:
-        return "Auto";
-        break;
-    case RTL:
-        return "RTL";
-        break;
-    case GUIDED:
-        return "Guided";
-        break;
-    case INITIALIZING:
-        return "Initializing";
-        break;
-    case RESERVED_1:
-    case RESERVED_5:
-    case RESERVED_6:
-    case RESERVED_7:
-    case RESERVED_8:
-    case RESERVED_9:
-    case RESERVED_12:
-    case RESERVED_13:
-    case RESERVED_14:
-        return "Reserved";
-    default:
-        return "Undefined";
-    }
+QString ApmRover::stringForMode(int aMode)
+{
+    static const ModeStrings names(RoverModeNames);
+    if (names.contains(aMode))
+        return names.at(aMode);
+    return "Undefined";
 }
 
 ArduPilotMegaMAV::ArduPilotMegaMAV(MAVLinkProtocol* mavlink, int id) :
@@ -279,12 +189,18 @@ ArduPilotMegaMAV::ArduPilotMegaMAV(MAVLinkProtocol* mavlink, int id) :
     //This does not seem to work. Manually request each stream type at a specified rate.
     // Ask for all streams at 4 Hz
     //enableAllDataTransmission(4);
-    txReqTimer = new QTimer(this);
-    connect(txReqTimer,SIGNAL(timeout()),this,SLOT(RequestAllDataStreams()));
+    TimerWheel::instance()->start(this, SLOT(RequestAllDataStreams()), 5000, false); //Send an initial TX request in 5 seconds.
 
-    QTimer::singleShot(5000,this,SLOT(RequestAllDataStreams())); //Send an initial TX request in 5 seconds.
+    txReqTimer = TimerWheel::instance()->start(this, SLOT(RequestAllDataStreams()), 10000); //Resend the TX requests every 10 seconds.
 
-    txReqTimer->start(10000); //Resend the TX requests every 10 seconds.
+    // Shed and restore streams with the link quality, unless turned off
+    QSettings settings;
+    m_streamRates->setEnabled(settings.value("DATA_RATES/AUTO_TUNE", true).toBool());
+    if (mavlink)
+    {
+        connect(mavlink, SIGNAL(receiveLossChanged(int,float)),
+                m_streamRates, SLOT(receiveLossChanged(int,float)));
+    }
 
     connect(this,SIGNAL(connected()),this,SLOT(uasConnected()));
     connect(this,SIGNAL(disconnected()),this,SLOT(uasDisconnected()));
@@ -299,29 +215,14 @@ ArduPilotMegaMAV::ArduPilotMegaMAV(MAVLinkProtocol* mavlink, int id) :
 void ArduPilotMegaMAV::RequestAllDataStreams()
 {
     QLOG_TRACE() << "APM:RequestAllDataRates";
-    QSettings settings;
-    settings.sync();
-    settings.beginGroup("DATA_RATES");
-    enableExtendedSystemStatusTransmission(settings.value("EXT_SYS_STATUS",2).toInt());
-
-    enablePositionTransmission(settings.value("POSITION",3).toInt());
-
-    enableExtra1Transmission(settings.value("EXTRA1",10).toInt());
-
-    enableExtra2Transmission(settings.value("EXTRA2",10).toInt());
-
-    enableExtra3Transmission(settings.value("EXTRA3",2).toInt());
-
-    enableRawSensorDataTransmission(settings.value("RAW_SENSOR_DATA",2).toInt());
-
-    enableRCChannelDataTransmission(settings.value("RC_CHANNEL_DATA",2).toInt());
-    settings.endGroup();
+    // The DATA_RATES settings are the ceilings of the tuner
+    m_streamRates->requestAll();
 }
 
 void ArduPilotMegaMAV::uasConnected()
 {
     QLOG_INFO() << "ArduPilotMegaMAV APM Connected";
-    QTimer::singleShot(500,this,SLOT(RequestAllDataStreams())); //Send an initial TX request in 0.5 seconds.
+    TimerWheel::instance()->start(this, SLOT(RequestAllDataStreams()), 500, false); //Send an initial TX request in 0.5 seconds.
     createNewMAVLinkLog(type);
     LinkManager::instance()->startLogging();
 }
@@ -377,52 +278,37 @@ void ArduPilotMegaMAV::createNewMAVLinkLog(uint8_t type)
     LinkManager::instance()->setLogSubDirectory(subDir);
 }
 
-/**
- * This function is called by MAVLink once a complete, uncorrupted (CRC check valid)
- * mavlink packet is received.
- *
- * @param link Hardware link the message came from (e.g. /dev/ttyUSB0 or UDP port).
- *             messages can be sent back to the system via this link
- * @param message MAVLink message, as received from the MAVLink protocol stack
- */
-void ArduPilotMegaMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
-{
-    // Let UAS handle the default message set
-    //qDebug() << "Message type:" << message.sysid << message.msgid;
-    UAS::receiveMessage(link, message);
-
-    if (message.sysid == uasId) {
-        // Handle your special messages
-        switch (message.msgid) {
-        case MAVLINK_MSG_ID_HEARTBEAT:
-        {
-            //QLOG_DEBUG() << "ARDUPILOT RECEIVED HEARTBEAT";
-            break;
-        }
-        case MAVLINK_MSG_ID_STATUSTEXT:
-        {
-            QByteArray b;
-            b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1);
-            mavlink_msg_statustext_get_text(&message, b.data());
-            // Ensure NUL-termination
-            b[b.length()-1] = '\0';
-            QString text = QString(b);
-            int severity = mavlink_msg_statustext_get_severity(&message);
-            QLOG_INFO() << "STATUS TEXT:" << severity << ":" << text;
-
-            if (text.startsWith("ArduCopter") || text.startsWith("ArduPlane")
-                    || text.startsWith("ArduRover")) {
-                QLOG_DEBUG() << "APM Version String detected:" << text;
-                emit versionDetected(text);
-            }
-
-        } break;
-        default:
-            //QLOG_DEBUG() << "\nARDUPILOT RECEIVED MESSAGE WITH ID" << message.msgid;
-            break;
-        }
+void ArduPilotMegaMAV::subscribe(MAVLinkDispatcher *dispatcher, const int *msgids)
+{
+    UAS::subscribe(dispatcher, msgids);
+    if (msgids)
+    {
+        return;
     }
+    dispatcher->subscribe(uasId, MAVLINK_MSG_ID_STATUSTEXT,
+                          &MAVLinkDispatcher::call<ArduPilotMegaMAV, &ArduPilotMegaMAV::receiveStatusText>, this);
 }
+
+/** @brief Detects the firmware version from its banner, after UAS handled the text */
+void ArduPilotMegaMAV::receiveStatusText(LinkInterface* link, mavlink_message_t message)
+{
+    Q_UNUSED(link);
+    QByteArray b;
+    b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1);
+    mavlink_msg_statustext_get_text(&message, b.data());
+    // Ensure NUL-termination
+    b[b.length()-1] = '\0';
+    QString text = QString(b);
+    int severity = mavlink_msg_statustext_get_severity(&message);
+    QLOG_INFO() << "STATUS TEXT:" << severity << ":" << text;
+
+    if (text.startsWith("ArduCopter") || text.startsWith("ArduPlane")
+            || text.startsWith("ArduRover")) {
+        QLOG_DEBUG() << "APM Version String detected:" << text;
+        emit versionDetected(text);
+    }
+}
+
 void ArduPilotMegaMAV::setMountConfigure(unsigned char mode, bool stabilize_roll,bool stabilize_pitch,bool stabilize_yaw)
 {
     //Only supported by APM
@@ -447,51 +333,17 @@ void ArduPilotMegaMAV::setMountControl(double pa,double pb,double pc,bool islatl
 void ArduPilotMegaMAV::armSystem()
 {
     QLOG_INFO() << "APM ARM System";
-    mavlink_message_t msg;
-
-    mavlink_msg_command_long_pack(getSystemId(),
-                                  getComponentId(),
-                                  &msg,
-                                  getUASID(),                    // uint8_t target_system,
-                                  MAV_COMP_ID_SYSTEM_CONTROL,    // uint8_t target_component
-                                  MAV_CMD_COMPONENT_ARM_DISARM,    // uint16_t command,
-                                  1,                // uint8_t confirmation,
-                                  1.0,             // float param1,
-                                  0,                // float param2,
-                                  0,                // float param3,
-                                  0,                // float param4,
-                                  0,                // float param5,
-                                  0,                // float param6,
-                                  0                 // float param7)
-                                  );
-    sendMessage(msg);
+    executeCommand(MAV_CMD_COMPONENT_ARM_DISARM, 1, 1.0, 0, 0, 0, 0, 0, 0, MAV_COMP_ID_SYSTEM_CONTROL);
 }
 
 void ArduPilotMegaMAV::disarmSystem()
 {
     QLOG_INFO() << "APM DISARM System";
-    mavlink_message_t msg;
-    mavlink_msg_command_long_pack(getSystemId(),
-                                  getComponentId(),
-                                  &msg,
-                                  getUASID(),                    // uint8_t target_system,
-                                  MAV_COMP_ID_SYSTEM_CONTROL,    // uint8_t target_component
-                                  MAV_CMD_COMPONENT_ARM_DISARM,    // uint16_t command,
-                                  1,                // uint8_t confirmation,
-                                  0.0,             // float param1,
-                                  0,                // float param2,
-                                  0,                // float param3,
-                                  0,                // float param4,
-                                  0,                // float param5,
-                                  0,                // float param6,
-                                  0                 // float param7)
-                                  );
-    sendMessage(msg);
+    executeCommand(MAV_CMD_COMPONENT_ARM_DISARM, 1, 0.0, 0, 0, 0, 0, 0, 0, MAV_COMP_ID_SYSTEM_CONTROL);
 }
 
 QString ArduPilotMegaMAV::getCustomModeText()
 {
-    QLOG_DEBUG() << "APM: getCustomModeText()";
     QString customModeString;
 
     if (isFixedWing()){
@@ -540,7 +392,7 @@ void ArduPilotMegaMAV::heartbeatTimeout(bool timeout, unsigned int /*ms*/)
         QLOG_DEBUG() << "Send requestall data streams when heartbeat restarts";
         // Request data, as this means we have reconnected
         // Send an request in .5 seconds.
-        QTimer::singleShot(500,this,SLOT(RequestAllDataStreams()));
+        TimerWheel::instance()->start(this, SLOT(RequestAllDataStreams()), 500, false);
     }
 }
 
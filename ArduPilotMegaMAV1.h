@@ -154,13 +154,14 @@ public:
     QString getCustomModeAudioText();
     void playCustomModeChangedAudioMessage();
     void playArmStateChangedAudioMessage(bool armedState) ;
+    void subscribe(MAVLinkDispatcher *dispatcher, const int *msgids = 0);
 
 signals:
     void versionDetected(QString versionString);
 
 public slots:
-    /** @brief Receive a MAVLink message from this MAV */
-    void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    /** @brief STATUSTEXT from this MAV */
+    void receiveStatusText(LinkInterface* link, mavlink_message_t message);
     void RequestAllDataStreams();
 
     // Overides from UAS virtual interface
@@ -179,7 +180,7 @@ private:
     void createNewMAVLinkLog(uint8_t type);
 
 private:
-    QTimer *txReqTimer;
+    TimerWheel::TimerId txReqTimer;
 };
 
 #endif // ARDUPILOTMAV_H
@@ -0,0 +1,103 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+#include "Arena.h"
+#include <stdlib.h>
+
+QAtomicInt Arena::s_allocations(0);
+QAtomicInt Arena::s_heapBlocks(0);
+QAtomicInt Arena::s_reservedBytes(0);
+
+Arena::Arena(int blockSize) :
+    m_blockSize(qMax(blockSize, 256)),
+    m_blocks(0),
+    m_offset(0),
+    m_used(0),
+    m_capacity(0),
+    m_pending(0)
+{
+}
+
+Arena::~Arena()
+{
+    s_allocations.fetchAndAddRelaxed(m_pending);
+    freeBlocks();
+}
+
+void Arena::addBlock(int minimum)
+{
+    const int size = qMax(m_blockSize, minimum);
+    Block *block = static_cast<Block*>(malloc(HeaderSize + size));
+    Q_CHECK_PTR(block);
+    block->next = m_blocks;
+    block->size = size;
+    m_blocks = block;
+    m_offset = 0;
+    m_capacity += size;
+    s_heapBlocks.fetchAndAddRelaxed(1);
+    s_reservedBytes.fetchAndAddRelaxed(size);
+}
+
+void Arena::freeBlocks()
+{
+    while (m_blocks)
+    {
+        Block *next = m_blocks->next;
+        free(m_blocks);
+        m_blocks = next;
+    }
+    s_reservedBytes.fetchAndAddRelaxed(-m_capacity);
+    m_capacity = 0;
+    m_offset = 0;
+}
+
+void *Arena::allocate(int size, int align)
+{
+    Q_ASSERT(align > 0 && align <= MaxAlign && (align & (align - 1)) == 0);
+    size = qMax(size, 0);
+    // Block data starts MaxAlign aligned, so aligning the offset is enough
+    int offset = (m_offset + align - 1) & ~(align - 1);
+    if (!m_blocks || offset + size > m_blocks->size)
+    {
+        addBlock(size);
+        offset = 0;
+    }
+    m_offset = offset + size;
+    m_used += size;
+    m_pending++;
+    return m_blocks->data() + offset;
+}
+
+void Arena::reset()
+{
+    s_allocations.fetchAndAddRelaxed(m_pending);
+    m_pending = 0;
+    if (m_blocks && m_blocks->next)
+    {
+        // Outgrew the block, make the next round fit in one
+        const int total = m_capacity;
+        freeBlocks();
+        addBlock(total);
+    }
+    m_offset = 0;
+    m_used = 0;
+}
@@ -0,0 +1,137 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Arena
+ *          Monotonic allocator for memory that is freed all at once, the
+ *          temporaries of one message batch or state that lives as long as
+ *          its vehicle.
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <QAtomicInt>
+#include <QtGlobal>
+
+/**
+ * @brief Bump allocator over a chain of blocks.
+ *
+ * allocate() hands out the next piece of the current block and only goes
+ * to the heap when a block is full. Nothing is freed on its own: reset()
+ * rewinds the whole arena, and when the last round needed more than one
+ * block the chain is replaced by one block of the total, so a steady load
+ * runs out of a single block without touching the heap. Objects placed in
+ * an arena are never destroyed, keep to plain data.
+ *
+ * Not thread safe, an arena belongs to one thread. The counters are
+ * process wide, for the performance overlay.
+ */
+class Arena
+{
+public:
+    enum { DefaultBlockSize = 16 * 1024, MaxAlign = 16 };
+
+    explicit Arena(int blockSize = DefaultBlockSize);
+    ~Arena();
+
+    /** @brief size bytes aligned to align, a power of two up to MaxAlign. Never NULL */
+    void *allocate(int size, int align = MaxAlign);
+    /** @brief Uninitialised room for count plain T */
+    template <typename T>
+    T *allocate(int count)
+    {
+        return static_cast<T*>(allocate(count * int(sizeof(T)), alignFor(int(sizeof(T)))));
+    }
+    /** @brief count T set to value */
+    template <typename T>
+    T *allocate(int count, const T &value)
+    {
+        T *items = allocate<T>(count);
+        for (int i = 0; i < count; i++)
+        {
+            items[i] = value;
+        }
+        return items;
+    }
+    /** @brief Drop everything allocated so far */
+    void reset();
+
+    /** @brief Bytes handed out since the last reset */
+    int used() const { return m_used; }
+    /** @brief Bytes held in blocks */
+    int capacity() const { return m_capacity; }
+
+    /** @brief Resets the arena when it goes out of scope */
+    class Scope
+    {
+    public:
+        explicit Scope(Arena &arena) : m_arena(arena) { }
+        ~Scope() { m_arena.reset(); }
+    private:
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+        Arena &m_arena;
+    };
+
+    /** @brief Allocations served by all arenas since the start */
+    static int allocations() { return s_allocations.load(); }
+    /** @brief Blocks taken from the heap by all arenas since the start */
+    static int heapBlocks() { return s_heapBlocks.load(); }
+    /** @brief Bytes all arenas hold right now */
+    static int reservedBytes() { return s_reservedBytes.load(); }
+
+private:
+    Arena(const Arena &);
+    Arena &operator=(const Arena &);
+
+    struct Block
+    {
+        Block *next;
+        int size;
+        char *data() { return reinterpret_cast<char*>(this) + HeaderSize; }
+    };
+    enum { HeaderSize = (sizeof(Block) + MaxAlign - 1) & ~(MaxAlign - 1) };
+
+    /** @brief Largest power of two that divides size, at most MaxAlign */
+    static int alignFor(int size)
+    {
+        int align = size & -size;
+        return (align == 0 || align > MaxAlign) ? int(MaxAlign) : align;
+    }
+    void addBlock(int minimum);
+    void freeBlocks();
+
+    int m_blockSize;
+    Block *m_blocks;        ///< Newest first, the one allocated from
+    int m_offset;           ///< Into m_blocks
+    int m_used;
+    int m_capacity;
+    int m_pending;          ///< Allocations not yet added to s_allocations, done on reset
+    static QAtomicInt s_allocations;
+    static QAtomicInt s_heapBlocks;
+    static QAtomicInt s_reservedBytes;
+};
+
+#endif // ARENA_H
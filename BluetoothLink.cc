@@ -0,0 +1,312 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief BluetoothLink
+ *          See BluetoothLink.h
+ *
+ */
+
+#include "BluetoothLink.h"
+#include "GroundClock.h"
+#include "ThreadRoles.h"
+#include "TraceMarkers.h"
+#include "QsLog.h"
+#include <QBluetoothAddress>
+#include <QBluetoothUuid>
+#include <QMutexLocker>
+
+BluetoothLink::BluetoothLink(const QString &address, const QString &deviceName) :
+    m_address(address.trimmed().toUpper()),
+    m_deviceName(deviceName),
+    m_socket(NULL),
+    m_connected(false),
+    m_readTimer(this),
+    m_connectTimer(this),
+    m_flushPosted(false)
+{
+    m_id = getNextLinkId();
+    m_name = tr("Bluetooth (%1)").arg(deviceName.isEmpty() ? m_address : deviceName);
+    m_readTimer.setSingleShot(true);
+    QObject::connect(&m_readTimer, SIGNAL(timeout()), this, SLOT(readBytes()));
+    m_connectTimer.setSingleShot(true);
+    QObject::connect(&m_connectTimer, SIGNAL(timeout()), this, SLOT(connectTimeout()));
+
+    // The socket is serviced on this link's own thread, see connect()
+    moveToThread(this);
+}
+
+BluetoothLink::~BluetoothLink()
+{
+    disconnect();
+}
+
+void BluetoothLink::run()
+{
+    ThreadRoles::enter(ThreadRoles::LinkIo);
+    exec();
+}
+
+bool BluetoothLink::connect()
+{
+    disconnect();
+    start(HighPriority);
+    return QMetaObject::invokeMethod(this, "hardwareConnect", Qt::QueuedConnection);
+}
+
+bool BluetoothLink::disconnect()
+{
+    if (isRunning())
+    {
+        // The socket belongs to the I/O thread
+        if (QThread::currentThread() == this)
+        {
+            hardwareDisconnect();
+        }
+        else
+        {
+            QMetaObject::invokeMethod(this, "hardwareDisconnect", Qt::BlockingQueuedConnection);
+        }
+        quit();
+        wait();
+    }
+    return true;
+}
+
+void BluetoothLink::hardwareConnect()
+{
+    Q_ASSERT(m_socket == NULL);
+    QBluetoothAddress address(m_address);
+    if (address.isNull())
+    {
+        connectFailed(tr("%1 is not a Bluetooth address").arg(m_address));
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_txBuffer.clear();
+        m_rxStats = RxStats();
+    }
+    m_socket = new QBluetoothSocket(QBluetoothServiceInfo::RfcommProtocol);
+    QObject::connect(m_socket, SIGNAL(connected()), this, SLOT(socketConnected()));
+    QObject::connect(m_socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+    QObject::connect(m_socket, SIGNAL(error(QBluetoothSocket::SocketError)),
+                     this, SLOT(socketError(QBluetoothSocket::SocketError)));
+    QObject::connect(m_socket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
+    m_connectTimer.start(ConnectTimeoutMs);
+    // The serial port profile, every SPP radio offers it
+    m_socket->connectToService(address, QBluetoothUuid(QBluetoothUuid::SerialPort));
+}
+
+void BluetoothLink::hardwareDisconnect()
+{
+    m_connectTimer.stop();
+    m_readTimer.stop();
+    if (!m_socket)
+    {
+        return;
+    }
+    // Whatever waits still goes out, and what came in goes up
+    flushWrites();
+    readBytes();
+    QObject::disconnect(m_socket, 0, this, 0);
+    m_socket->abort();
+    delete m_socket;
+    m_socket = NULL;
+    if (m_connected)
+    {
+        m_connected = false;
+        emit connected(false);
+        emit disconnected(this);
+        emit disconnected();
+    }
+}
+
+void BluetoothLink::socketConnected()
+{
+    m_connectTimer.stop();
+    m_connected = true;
+    QLOG_INFO() << "Connected" << m_name;
+    emit connected(true);
+    emit connected(this);
+    emit connected();
+    flushWrites();
+}
+
+void BluetoothLink::socketDisconnected()
+{
+    QLOG_WARN() << m_name << "disconnected";
+    m_readTimer.stop();
+    if (m_socket)
+    {
+        QObject::disconnect(m_socket, 0, this, 0);
+        m_socket->deleteLater();
+        m_socket = NULL;
+    }
+    if (m_connected)
+    {
+        m_connected = false;
+        emit connected(false);
+        emit disconnected(this);
+        emit disconnected();
+    }
+    // The next connect() starts the thread again
+    quit();
+}
+
+void BluetoothLink::socketError(QBluetoothSocket::SocketError socketError)
+{
+    Q_UNUSED(socketError);
+    if (!m_socket || sender() != m_socket)
+    {
+        return;
+    }
+    if (!m_connected)
+    {
+        // Radio off, out of range or not paired
+        connectFailed(m_socket->errorString());
+        return;
+    }
+    emit communicationError(getName(), tr("Bluetooth error: %1").arg(m_socket->errorString()));
+}
+
+void BluetoothLink::connectTimeout()
+{
+    if (!m_connected)
+    {
+        connectFailed(tr("Connection timed out"));
+    }
+}
+
+void BluetoothLink::connectFailed(const QString &reason)
+{
+    m_connectTimer.stop();
+    if (m_socket)
+    {
+        QObject::disconnect(m_socket, 0, this, 0);
+        m_socket->deleteLater();
+        m_socket = NULL;
+    }
+    QLOG_WARN() << m_name << ": connection failed," << reason;
+    emit communicationError(getName(), reason);
+    emit error(this, reason);
+    quit();
+}
+
+void BluetoothLink::socketReadyRead()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_rxStats.notifications++;
+    }
+    if (m_socket->bytesAvailable() >= ReadChunkBytes)
+    {
+        readBytes();
+    }
+    else if (!m_readTimer.isActive())
+    {
+        m_readTimer.start(ReadCoalesceMs);
+    }
+}
+
+void BluetoothLink::readBytes()
+{
+    HUD_TRACE_SCOPE("BluetoothLink::readBytes");
+    m_readTimer.stop();
+    qint64 byteCount = m_socket ? m_socket->bytesAvailable() : 0;
+    if (byteCount <= 0)
+    {
+        return;
+    }
+    QByteArray buffer(static_cast<int>(byteCount), Qt::Uninitialized);
+    byteCount = m_socket->read(buffer.data(), byteCount);
+    if (byteCount <= 0)
+    {
+        return;
+    }
+    buffer.resize(static_cast<int>(byteCount));
+    readTime = GroundClock::nsecs();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_rxStats.reads++;
+        m_rxStats.largestRead = qMax(m_rxStats.largestRead, byteCount);
+    }
+    inTraffic.add(byteCount, 1, readTime / 1000000);
+    emit bytesReceived(this, buffer);
+}
+
+qint64 BluetoothLink::bytesAvailable()
+{
+    // Only meaningful on the link's thread, like the socket
+    return m_socket ? m_socket->bytesAvailable() : 0;
+}
+
+BluetoothLink::RxStats BluetoothLink::rxStats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rxStats;
+}
+
+void BluetoothLink::writeBytes(const char *bytes, qint64 length)
+{
+    if (length <= 0)
+    {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!isRunning() || m_txBuffer.size() + length > MaxQueuedBytes)
+    {
+        return;
+    }
+    m_txBuffer.append(bytes, static_cast<int>(length));
+    // Writes from one turn of the sender's loop go out together
+    if (!m_flushPosted)
+    {
+        m_flushPosted = true;
+        QMetaObject::invokeMethod(this, "flushWrites", Qt::QueuedConnection);
+    }
+}
+
+void BluetoothLink::flushWrites()
+{
+    QByteArray batch;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_flushPosted = false;
+        if (!m_connected)
+        {
+            // socketConnected() sends what was written while connecting
+            return;
+        }
+        batch.swap(m_txBuffer);
+    }
+    if (batch.isEmpty() || !m_socket)
+    {
+        return;
+    }
+    qint64 written = m_socket->write(batch);
+    if (written > 0)
+    {
+        outTraffic.add(written, 1, GroundClock::msecs());
+    }
+}
@@ -0,0 +1,127 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief BluetoothLink
+ *          Telemetry radios with a Bluetooth serial port (SPP), over RFCOMM
+ *          with QtBluetooth. The socket lives on the link's own thread like
+ *          TCPLink's. Reads are not taken per notification: the Android
+ *          backend signals every few bytes the radio sends, so reads wait up
+ *          to ReadCoalesceMs for ReadChunkBytes to gather and go to
+ *          bytesReceived() in one piece, straight to the ingest path.
+ *
+ */
+
+#ifndef BLUETOOTHLINK_H
+#define BLUETOOTHLINK_H
+
+#include <QBluetoothSocket>
+#include <QByteArray>
+#include <QMutex>
+#include <QTimer>
+#include "LinkInterface.h"
+
+class BluetoothLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    enum {
+        ReadChunkBytes = 4096,      ///< Read at once when this much is waiting
+        ReadCoalesceMs = 5,         ///< Longest the first waiting byte is held back
+        ConnectTimeoutMs = 10000,   ///< Paging a radio that is off takes a while to fail
+        MaxQueuedBytes = 64 * 1024  ///< Writes past this are dropped, an SPP radio is far slower
+    };
+
+    /** @brief Read side of the link */
+    struct RxStats
+    {
+        quint32 notifications;      ///< readyRead() signals of the socket
+        quint32 reads;              ///< Chunks they were gathered into
+        qint64 largestRead;
+        RxStats() : notifications(0), reads(0), largestRead(0) { }
+    };
+
+    /** @brief address "00:11:22:33:44:55" of a paired radio, name only for display */
+    explicit BluetoothLink(const QString &address, const QString &deviceName = QString());
+    ~BluetoothLink();
+
+    void disableTimeouts() { }
+    void enableTimeouts() { }
+    void requestReset() { }
+
+    int getId() const { return m_id; }
+    QString getName() const { return m_name; }
+    bool isConnected() const { return m_connected; }
+    /** @brief What SPP radios are usually set to, the air rate is much higher */
+    qint64 getConnectionSpeed() const { return 115200; }
+    qint64 bytesAvailable();
+    LinkType getLinkType() { return BLUETOOTH_LINK; }
+
+    QString getAddress() const { return m_address; }
+    QString getDeviceName() const { return m_deviceName; }
+    RxStats rxStats() const;
+
+public slots:
+    /** @brief Start connecting and return at once; connected() or error() tells how it went */
+    bool connect();
+    bool disconnect();
+    /** @brief Queue bytes for the socket, from any thread */
+    void writeBytes(const char *bytes, qint64 length);
+
+protected slots:
+    void readBytes();
+
+protected:
+    // From LinkInterface->QThread, its event loop services the socket
+    void run();
+
+private slots:
+    // On the link's thread
+    void hardwareConnect();
+    void hardwareDisconnect();
+    void socketConnected();
+    void socketDisconnected();
+    void socketError(QBluetoothSocket::SocketError socketError);
+    void socketReadyRead();
+    void connectTimeout();
+    void flushWrites();
+
+private:
+    void connectFailed(const QString &reason);
+
+    int m_id;
+    QString m_name;
+    QString m_address;
+    QString m_deviceName;
+    QBluetoothSocket *m_socket;
+    bool m_connected;
+    QTimer m_readTimer;
+    QTimer m_connectTimer;
+
+    mutable QMutex m_mutex;     ///< Guards the members below, writers are on any thread
+    QByteArray m_txBuffer;
+    bool m_flushPosted;
+    RxStats m_rxStats;
+};
+
+#endif // BLUETOOTHLINK_H
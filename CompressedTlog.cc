@@ -0,0 +1,292 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief CompressedTlog
+ *          See CompressedTlog.h
+ *
+ */
+
+#include "CompressedTlog.h"
+#include "QsLog.h"
+#include <QtEndian>
+#include <cstring>
+#include "configuration.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+static const char compressedMagic[] = "CTLG";
+static const quint16 compressedVersion = 1;
+static const int timestampBytes = 8;
+static const int convertBlockBytes = 64 * 1024;
+
+bool CompressedTlog::isCompressedFileName(const QString &fileName)
+{
+    return fileName.endsWith(MAVLINK_COMPRESSED_LOGFILE_EXT, Qt::CaseInsensitive);
+}
+
+bool CompressedTlog::isCompressedFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return file.read(4) == QByteArray(compressedMagic, 4);
+}
+
+QByteArray CompressedTlog::fileHeader()
+{
+    QByteArray header(compressedMagic, 4);
+    uchar version[2];
+    qToBigEndian(compressedVersion, version);
+    header.append((const char*)version, 2);
+    return header;
+}
+
+QByteArray CompressedTlog::encodeBlock(const QByteArray &records, int level)
+{
+    // Walk the records for the time span, the block is always whole records
+    quint64 firstTime = 0;
+    quint64 lastTime = 0;
+    const uchar *data = (const uchar*)records.constData();
+    int offset = 0;
+    while (offset + timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES <= records.size())
+    {
+        quint64 time = qFromBigEndian<quint64>(data + offset);
+        if (offset == 0)
+        {
+            firstTime = time;
+        }
+        lastTime = qMax(lastTime, time);
+        offset += timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES + data[offset + timestampBytes + 1];
+    }
+
+    QByteArray packed = qCompress(records, level);
+    QByteArray block(BlockHeaderBytes, Qt::Uninitialized);
+    uchar *header = (uchar*)block.data();
+    qToBigEndian<quint32>(packed.size(), header);
+    qToBigEndian<quint32>(records.size(), header + 4);
+    qToBigEndian<quint64>(firstTime, header + 8);
+    qToBigEndian<quint64>(lastTime, header + 16);
+    block.append(packed);
+    return block;
+}
+
+bool CompressedTlog::open(const QString &fileName)
+{
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+    if (m_file.read(HeaderBytes) != fileHeader())
+    {
+        m_error = QObject::tr("%1 is not a compressed telemetry log").arg(fileName);
+        m_file.close();
+        return false;
+    }
+
+    // Only the block headers are read, a truncated last block is ignored
+    qint64 size = m_file.size();
+    qint64 offset = HeaderBytes;
+    while (offset + BlockHeaderBytes <= size)
+    {
+        m_file.seek(offset);
+        QByteArray raw = m_file.read(BlockHeaderBytes);
+        if (raw.size() != BlockHeaderBytes)
+        {
+            break;
+        }
+        const uchar *header = (const uchar*)raw.constData();
+        Block block;
+        block.offset = offset;
+        block.compressedSize = qFromBigEndian<quint32>(header);
+        block.rawSize = qFromBigEndian<quint32>(header + 4);
+        block.firstTime = qFromBigEndian<quint64>(header + 8);
+        block.lastTime = qFromBigEndian<quint64>(header + 16);
+        if (offset + BlockHeaderBytes + block.compressedSize > size)
+        {
+            QLOG_WARN() << "CompressedTlog: truncated block at" << offset << "in" << fileName;
+            break;
+        }
+        m_blocks.append(block);
+        offset += BlockHeaderBytes + block.compressedSize;
+    }
+    return true;
+}
+
+void CompressedTlog::close()
+{
+    m_blocks.clear();
+    m_error.clear();
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+}
+
+int CompressedTlog::blockForTime(quint64 timeUsec) const
+{
+    int low = 0;
+    int high = m_blocks.size() - 1;
+    while (low < high)
+    {
+        int mid = (low + high + 1) / 2;
+        if (m_blocks.at(mid).firstTime <= timeUsec)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+QByteArray CompressedTlog::readBlock(int index)
+{
+    if (index < 0 || index >= m_blocks.size())
+    {
+        return QByteArray();
+    }
+    const Block &block = m_blocks.at(index);
+    m_file.seek(block.offset + BlockHeaderBytes);
+    QByteArray records = qUncompress(m_file.read(block.compressedSize));
+    if ((quint32)records.size() != block.rawSize)
+    {
+        QLOG_WARN() << "CompressedTlog: damaged block" << index << "in" << m_file.fileName();
+        return QByteArray();
+    }
+    return records;
+}
+
+bool CompressedTlog::convert(const QString &inputFileName, const QString &outputFileName, QString *error)
+{
+    QFile output(outputFileName);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        if (error) *error = output.errorString();
+        return false;
+    }
+    bool ok;
+    if (isCompressedFile(inputFileName))
+    {
+        CompressedTlog input;
+        ok = input.open(inputFileName);
+        if (!ok)
+        {
+            if (error) *error = input.errorString();
+        }
+        else
+        {
+            ok = decompress(input, output, error);
+        }
+    }
+    else
+    {
+        QFile input(inputFileName);
+        ok = input.open(QIODevice::ReadOnly);
+        if (!ok)
+        {
+            if (error) *error = input.errorString();
+        }
+        else
+        {
+            ok = compress(input, output, error);
+        }
+    }
+    output.close();
+    if (!ok)
+    {
+        output.remove();
+    }
+    return ok;
+}
+
+bool CompressedTlog::compress(QFile &input, QFile &output, QString *error)
+{
+    if (output.write(fileHeader()) != HeaderBytes)
+    {
+        if (error) *error = output.errorString();
+        return false;
+    }
+    // Cut the plain log at record boundaries so every block stands on its own
+    QByteArray pending;
+    forever
+    {
+        QByteArray chunk = input.read(convertBlockBytes);
+        pending.append(chunk);
+        const uchar *data = (const uchar*)pending.constData();
+        int whole = 0;
+        while (whole + timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES <= pending.size())
+        {
+            int length = timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES + data[whole + timestampBytes + 1];
+            if (data[whole + timestampBytes] != MAVLINK_STX)
+            {
+                if (error) *error = QObject::tr("%1 is damaged at offset %2").arg(input.fileName())
+                                        .arg(input.pos() - pending.size() + whole);
+                return false;
+            }
+            if (whole + length > pending.size() || whole + length > convertBlockBytes)
+            {
+                break;
+            }
+            whole += length;
+        }
+        if (whole == 0)
+        {
+            // Only a truncated record left at the end of the input
+            break;
+        }
+        QByteArray block = encodeBlock(pending.left(whole));
+        if (output.write(block) != block.size())
+        {
+            if (error) *error = output.errorString();
+            return false;
+        }
+        pending.remove(0, whole);
+    }
+    return true;
+}
+
+bool CompressedTlog::decompress(CompressedTlog &input, QFile &output, QString *error)
+{
+    for (int i = 0; i < input.blocks().size(); i++)
+    {
+        QByteArray records = input.readBlock(i);
+        if (records.isEmpty())
+        {
+            if (error) *error = QObject::tr("Block %1 of %2 is damaged").arg(i).arg(input.m_file.fileName());
+            return false;
+        }
+        if (output.write(records) != records.size())
+        {
+            if (error) *error = output.errorString();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief CompressedTlog
+ *          Block compressed telemetry log (.ctlog). The payload is the plain
+ *          .tlog record stream cut into blocks of up to 64 KiB, each deflated
+ *          with qCompress(). A "CTLG" header is followed by the blocks, every
+ *          block starting with a big endian header (compressed size, raw size,
+ *          first and last timestamp), so a reader can build a time index by
+ *          hopping from header to header and inflate only the block it needs.
+ *
+ */
+
+#ifndef COMPRESSEDTLOG_H
+#define COMPRESSEDTLOG_H
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <QString>
+
+class CompressedTlog
+{
+public:
+    struct Block
+    {
+        qint64 offset;          ///< File offset of the block header
+        quint32 compressedSize;
+        quint32 rawSize;
+        quint64 firstTime;
+        quint64 lastTime;
+    };
+
+    enum { HeaderBytes = 6, BlockHeaderBytes = 24, CompressionLevel = 6 };
+
+    static bool isCompressedFileName(const QString &fileName);
+    /** @brief True if the file starts with the compressed log header */
+    static bool isCompressedFile(const QString &fileName);
+
+    static QByteArray fileHeader();
+    /** @brief Deflate a run of whole tlog records into one block, header included */
+    static QByteArray encodeBlock(const QByteArray &records, int level = CompressionLevel);
+
+    /** @brief Convert between .tlog and .ctlog, the direction follows the input */
+    static bool convert(const QString &inputFileName, const QString &outputFileName, QString *error);
+
+    // Reader
+    bool open(const QString &fileName);
+    void close();
+    QString errorString() const { return m_error; }
+    const QVector<Block> &blocks() const { return m_blocks; }
+    /** @brief Last block starting at or before timeUsec */
+    int blockForTime(quint64 timeUsec) const;
+    /** @brief Inflated records of block index, empty on a damaged block */
+    QByteArray readBlock(int index);
+
+private:
+    static bool compress(QFile &input, QFile &output, QString *error);
+    static bool decompress(CompressedTlog &input, QFile &output, QString *error);
+
+    QFile m_file;
+    QVector<Block> m_blocks;
+    QString m_error;
+};
+
+#endif // COMPRESSEDTLOG_H
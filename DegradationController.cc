@@ -0,0 +1,294 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief DegradationController
+ *          See DegradationController.h
+ *
+ */
+
+#include "DegradationController.h"
+#include "FramePacer.h"
+#include "GStreamerPlayer.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "TelemetryHistory.h"
+#include "UAS1.h"
+#include "UASManager1.h"
+#include "StreamRateTuner.h"
+#include "QsLog.h"
+#include <QThread>
+#include <sys/times.h>
+#include <unistd.h>
+#ifdef Q_OS_ANDROID
+#include <QtAndroidExtras/QAndroidJniObject>
+#include <QtAndroidExtras/QAndroidJniEnvironment>
+
+static const char *ThermalStatusClass = "org/qtproject/qt5/android/bindings/ThermalStatus";
+#endif
+
+static const char * const levelNames[DegradationController::LevelCount] = {
+    "Normal",
+    "Reduced HUD rate",
+    "Reduced history resolution",
+    "Reduced video resolution",
+    "Reduced stream rates"
+};
+
+DegradationController::DegradationController(const QList<GStreamerPlayer*> &players, QObject *parent) :
+    QObject(parent),
+    m_level(Normal),
+    m_settleSamples(0),
+    m_calmSamples(0),
+    m_thermalStatus(ThermalUnknown),
+    m_cpuPercent(0),
+    m_frameMs95(0),
+    m_cpuCount(qMax(1, QThread::idealThreadCount())),
+    m_lastCpuMs(0),
+    m_lastSampleMs(0),
+    m_savedPowerSave(false),
+    m_savedTargetFps(0),
+    m_savedHistorySpacingMs(TelemetryHistory::MinSpacingMs)
+{
+    foreach (GStreamerPlayer *player, players)
+    {
+        m_players.append(player);
+    }
+    m_clock.start();
+    m_timer.setInterval(SampleMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(sample()));
+    connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(onUasCreated(UASInterface*)));
+}
+
+QString DegradationController::levelName() const
+{
+    return QString::fromLatin1(levelNames[m_level]);
+}
+
+void DegradationController::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled())
+    {
+        return;
+    }
+    if (enabled)
+    {
+        m_settleSamples = 0;
+        m_calmSamples = 0;
+        m_lastCpuMs = readCpuMs();
+        m_lastSampleMs = m_clock.elapsed();
+        m_timer.start();
+    }
+    else
+    {
+        m_timer.stop();
+        setLevel(Normal);
+    }
+    emit enabledChanged(enabled);
+}
+
+int DegradationController::readThermalStatus()
+{
+#ifdef Q_OS_ANDROID
+    jint status = QAndroidJniObject::callStaticMethod<jint>(ThermalStatusClass, "status", "()I");
+    QAndroidJniEnvironment env;
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        return ThermalUnknown;
+    }
+    return status;
+#else
+    return ThermalUnknown;
+#endif
+}
+
+qint64 DegradationController::readCpuMs()
+{
+    struct tms usage;
+    if (times(&usage) == static_cast<clock_t>(-1))
+    {
+        return 0;
+    }
+    const long ticks = sysconf(_SC_CLK_TCK);
+    return ticks > 0 ? static_cast<qint64>(usage.tms_utime + usage.tms_stime) * 1000 / ticks : 0;
+}
+
+void DegradationController::sample()
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 cpuMs = readCpuMs();
+    if (now > m_lastSampleMs)
+    {
+        m_cpuPercent = static_cast<int>((cpuMs - m_lastCpuMs) * 100 / ((now - m_lastSampleMs) * m_cpuCount));
+    }
+    m_lastCpuMs = cpuMs;
+    m_lastSampleMs = now;
+    m_thermalStatus = readThermalStatus();
+    // No frames in the last second is an idle HUD, not a slow one
+    FramePacer *pacer = FramePacer::instance();
+    m_frameMs95 = pacer->fps() > 0 ? pacer->frameMs95() : 0;
+    emit sampled();
+
+    const bool severe = m_thermalStatus >= ThermalSevere;
+    const bool pressure = m_thermalStatus >= ThermalModerate || m_cpuPercent >= HighCpuPercent
+            || m_frameMs95 >= OverrunFrameMs;
+    const bool calm = m_thermalStatus <= ThermalLight && m_cpuPercent < LowCpuPercent
+            && m_frameMs95 < OverrunFrameMs;
+
+    if (pressure)
+    {
+        m_calmSamples = 0;
+        if (m_settleSamples > 0 && !severe)
+        {
+            --m_settleSamples;
+            return;
+        }
+        if (m_level < LevelCount - 1)
+        {
+            QLOG_WARN() << "Degrading, thermal status" << m_thermalStatus << "CPU" << m_cpuPercent
+                        << "% frame time" << m_frameMs95 << "ms";
+            setLevel(qMin(static_cast<int>(StreamRates), m_level + (severe ? 2 : 1)));
+            m_settleSamples = SettleSamples;
+        }
+        return;
+    }
+    m_settleSamples = 0;
+    if (!calm)
+    {
+        m_calmSamples = 0;
+        return;
+    }
+    if (m_level > Normal && ++m_calmSamples >= RecoverSamples)
+    {
+        m_calmSamples = 0;
+        setLevel(m_level - 1);
+    }
+}
+
+void DegradationController::setLevel(int level)
+{
+    level = qBound(static_cast<int>(Normal), level, static_cast<int>(StreamRates));
+    if (level == m_level)
+    {
+        return;
+    }
+    // Steps are taken and given back in order, even when skipping one
+    while (m_level < level)
+    {
+        apply(++m_level, true);
+    }
+    while (m_level > level)
+    {
+        apply(m_level--, false);
+    }
+    QLOG_WARN() << "Degradation level" << m_level << levelName();
+    emit levelChanged(m_level);
+}
+
+void DegradationController::apply(int level, bool degraded)
+{
+    switch (level)
+    {
+    case HudRate:
+    {
+        FramePacer *pacer = FramePacer::instance();
+        if (degraded)
+        {
+            m_savedPowerSave = pacer->powerSave();
+            m_savedTargetFps = pacer->targetFps();
+            pacer->setTargetFps(m_savedPowerSave ? qMin(m_savedTargetFps, static_cast<int>(ReducedFps)) : ReducedFps);
+            pacer->setPowerSave(true);
+        }
+        else
+        {
+            pacer->setTargetFps(m_savedTargetFps);
+            pacer->setPowerSave(m_savedPowerSave);
+        }
+        break;
+    }
+    case HistoryResolution:
+    {
+        TelemetryHistory *history = LinkManager::instance()->getMavlinkProtocol()->history();
+        if (degraded)
+        {
+            m_savedHistorySpacingMs = history->spacingMs();
+            history->setSpacingMs(qMax(m_savedHistorySpacingMs, static_cast<int>(ReducedHistorySpacingMs)));
+        }
+        else
+        {
+            history->setSpacingMs(m_savedHistorySpacingMs);
+        }
+        break;
+    }
+    case DecodeResolution:
+        if (degraded)
+        {
+            m_savedVideoHeight.fill(0, m_players.size());
+        }
+        for (int i = 0; i < m_players.size(); ++i)
+        {
+            GStreamerPlayer *player = m_players.at(i);
+            if (!player)
+            {
+                continue;
+            }
+            if (degraded)
+            {
+                m_savedVideoHeight[i] = player->getMaxVideoHeight();
+                player->setMaxVideoHeight(m_savedVideoHeight[i] > 0
+                                          ? qMin(m_savedVideoHeight[i], static_cast<int>(ReducedVideoHeight))
+                                          : ReducedVideoHeight);
+            }
+            else if (i < m_savedVideoHeight.size())
+            {
+                player->setMaxVideoHeight(m_savedVideoHeight.at(i));
+            }
+        }
+        break;
+    case StreamRates:
+        foreach (UASInterface *uas, UASManager::instance()->getUASList())
+        {
+            limitStreamRates(uas, degraded);
+        }
+        break;
+    }
+}
+
+void DegradationController::limitStreamRates(UASInterface *uas, bool limited)
+{
+    UAS *vehicle = qobject_cast<UAS*>(uas);
+    if (vehicle && vehicle->getStreamRateTuner())
+    {
+        vehicle->getStreamRateTuner()->setLoadLimited(limited);
+    }
+}
+
+void DegradationController::onUasCreated(UASInterface *uas)
+{
+    if (m_level >= StreamRates)
+    {
+        limitStreamRates(uas, true);
+    }
+}
@@ -0,0 +1,151 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief DegradationController
+ *          Sheds load in a fixed order when the device runs hot or out of
+ *          CPU and frame time, and gives it back the same way once there
+ *          is headroom.
+ *
+ */
+
+#ifndef DEGRADATIONCONTROLLER_H
+#define DEGRADATIONCONTROLLER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+class GStreamerPlayer;
+class UASInterface;
+
+/**
+ * @brief Thermal and load aware degradation, one step at a time
+ *
+ * Every SampleMs the Android thermal status (ThermalStatus.java), the
+ * process's share of all CPUs and the 95th percentile frame time of the
+ * HUD (FramePacer) are read. Any of them over its limit raises the level
+ * by one, two at a severe thermal status, then waits SettleSamples for
+ * the step to show. RecoverSamples without pressure lower it by one.
+ *
+ * Each level keeps what the ones below it do:
+ *  - HudRate: FramePacer's powerSave at ReducedFps, which the players' maxFps follow
+ *  - HistoryResolution: telemetry history keeps a sample per ReducedHistorySpacingMs
+ *  - DecodeResolution: the players scale frames to ReducedVideoHeight
+ *  - StreamRates: the vehicles are asked for half their stream rates
+ *
+ * Settings changed by hand while degraded are overwritten when the level
+ * comes back down; the values from before the step are restored.
+ */
+class DegradationController : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int level READ level NOTIFY levelChanged)
+    Q_PROPERTY(QString levelName READ levelName NOTIFY levelChanged)
+    Q_PROPERTY(int thermalStatus READ thermalStatus NOTIFY sampled)
+    Q_PROPERTY(int cpuPercent READ cpuPercent NOTIFY sampled)
+    Q_PROPERTY(int frameMs95 READ frameMs95 NOTIFY sampled)
+public:
+    enum Level {
+        Normal,
+        HudRate,
+        HistoryResolution,
+        DecodeResolution,
+        StreamRates,
+        LevelCount
+    };
+    /** @brief PowerManager.THERMAL_STATUS_*, Unknown without a sensor */
+    enum ThermalStatus {
+        ThermalUnknown = -1,
+        ThermalNone,
+        ThermalLight,
+        ThermalModerate,
+        ThermalSevere
+    };
+    enum {
+        SampleMs = 2000,
+        SettleSamples = 2,
+        RecoverSamples = 15,            ///< Half a minute without pressure per step down
+        HighCpuPercent = 85,
+        LowCpuPercent = 60,
+        OverrunFrameMs = 34,            ///< Two frames at 60 Hz
+        ReducedFps = 20,
+        ReducedHistorySpacingMs = 500,
+        ReducedVideoHeight = 480
+    };
+
+    DegradationController(const QList<GStreamerPlayer*> &players, QObject *parent = 0);
+
+    bool isEnabled() const { return m_timer.isActive(); }
+    int level() const { return m_level; }
+    QString levelName() const;
+    int thermalStatus() const { return m_thermalStatus; }
+    int cpuPercent() const { return m_cpuPercent; }
+    int frameMs95() const { return m_frameMs95; }
+
+public slots:
+    /** @brief Off restores everything at once */
+    void setEnabled(bool enabled);
+    void sample();
+
+signals:
+    void enabledChanged(bool enabled);
+    void levelChanged(int level);
+    void sampled();
+
+private slots:
+    void onUasCreated(UASInterface *uas);
+
+private:
+    void setLevel(int level);
+    void apply(int level, bool degraded);
+    void limitStreamRates(UASInterface *uas, bool limited);
+    static int readThermalStatus();
+    /** @brief CPU time of the process in ms, all threads */
+    static qint64 readCpuMs();
+
+    QList<QPointer<GStreamerPlayer> > m_players;
+    QTimer m_timer;
+    int m_level;
+    int m_settleSamples;
+    int m_calmSamples;
+    int m_thermalStatus;
+    int m_cpuPercent;
+    int m_frameMs95;
+    int m_cpuCount;
+    QElapsedTimer m_clock;
+    qint64 m_lastCpuMs;
+    qint64 m_lastSampleMs;
+
+    // What the steps changed, to restore
+    bool m_savedPowerSave;
+    int m_savedTargetFps;
+    QVector<int> m_savedVideoHeight;
+    int m_savedHistorySpacingMs;
+};
+
+#endif // DEGRADATIONCONTROLLER_H
@@ -0,0 +1,169 @@
+#include "DerivedMetrics.h"
+#include "VehicleStateSnapshot.h"
+
+#include <cmath>
+
+static const double EarthRadius = 6371000.0;      // m, mean
+static const double DegToRad = M_PI / 180.0;
+// GPS noise while standing still, steps below this are not flown distance
+static const double MinStep = 1.0;                // m
+
+// Haversine distance with the cosines of both latitudes already known
+static double distance(double lat1, double lon1, double cosLat1,
+                       double lat2, double lon2, double cosLat2)
+{
+    const double sinDLat = sin((lat2 - lat1) * 0.5);
+    const double sinDLon = sin((lon2 - lon1) * 0.5);
+    const double a = sinDLat * sinDLat + cosLat1 * cosLat2 * sinDLon * sinDLon;
+    return 2.0 * EarthRadius * asin(qMin(1.0, sqrt(a)));
+}
+
+DerivedMetrics::DerivedMetrics() :
+    m_hasHome(false),
+    m_homeLat(0),
+    m_homeLon(0),
+    m_homeSinLat(0),
+    m_homeCosLat(1),
+    m_hasLast(false),
+    m_lastLat(0),
+    m_lastLon(0),
+    m_lastCosLat(1),
+    m_wasArmed(false),
+    m_inAirMs(0),
+    m_powerMs(0),
+    m_lastWatts(0)
+{
+}
+
+void DerivedMetrics::update(VehicleState &state, quint32 section, qint64 nowMs)
+{
+    switch (section)
+    {
+    case VehicleState::HasHeartbeat:
+    {
+        const bool armed = (state.baseMode & MAV_MODE_FLAG_SAFETY_ARMED) != 0;
+        if (armed && !m_wasArmed && (state.sections & VehicleState::HasGlobalPosition))
+        {
+            // Home is where the vehicle was armed
+            setHome(state);
+        }
+        m_wasArmed = armed;
+        updateInAir(state, nowMs);
+        break;
+    }
+    case VehicleState::HasGlobalPosition:
+        updatePosition(state);
+        updateInAir(state, nowMs);
+        break;
+    case VehicleState::HasSysStatus:
+        updatePower(state, nowMs);
+        break;
+    default:
+        break;
+    }
+}
+
+void DerivedMetrics::setHome(VehicleState &state)
+{
+    m_hasHome = true;
+    m_homeLat = state.lat * DegToRad;
+    m_homeLon = state.lon * DegToRad;
+    m_homeSinLat = sin(m_homeLat);
+    m_homeCosLat = cos(m_homeLat);
+    state.homeLat = state.lat;
+    state.homeLon = state.lon;
+    state.sections |= VehicleState::HasHome;
+}
+
+void DerivedMetrics::updatePosition(VehicleState &state)
+{
+    if (state.lat == 0 && state.lon == 0)
+    {
+        // No fix yet
+        return;
+    }
+    const double lat = state.lat * DegToRad;
+    const double lon = state.lon * DegToRad;
+    const double cosLat = cos(lat);
+    if (!m_hasHome)
+    {
+        // Until the vehicle is armed the first fix stands in for home
+        setHome(state);
+    }
+
+    if (!m_hasLast)
+    {
+        m_hasLast = true;
+        m_lastLat = lat;
+        m_lastLon = lon;
+        m_lastCosLat = cosLat;
+    }
+    else
+    {
+        const double step = distance(m_lastLat, m_lastLon, m_lastCosLat, lat, lon, cosLat);
+        // The anchor only moves once the step counts, so noise cannot add up
+        if (step >= MinStep)
+        {
+            if (m_wasArmed)
+            {
+                state.distTraveled += static_cast<float>(step);
+            }
+            m_lastLat = lat;
+            m_lastLon = lon;
+            m_lastCosLat = cosLat;
+        }
+    }
+
+    state.distToHome = static_cast<float>(distance(m_homeLat, m_homeLon, m_homeCosLat, lat, lon, cosLat));
+    const double dLon = lon - m_homeLon;
+    const double y = sin(dLon) * cosLat;
+    const double x = m_homeCosLat * sin(lat) - m_homeSinLat * cosLat * cos(dLon);
+    double bearing = atan2(y, x) / DegToRad;
+    if (bearing < 0)
+    {
+        bearing += 360.0;
+    }
+    state.azToMav = static_cast<float>(bearing);
+}
+
+void DerivedMetrics::updateInAir(VehicleState &state, qint64 nowMs)
+{
+    if (!m_wasArmed || state.systemStatus != MAV_STATE_ACTIVE)
+    {
+        m_inAirMs = 0;
+        return;
+    }
+    if (m_inAirMs != 0)
+    {
+        const qint64 dt = nowMs - m_inAirMs;
+        if (dt > 0 && dt <= MaxGapMs)
+        {
+            state.timeInAir += dt / 1000.0f;
+        }
+    }
+    m_inAirMs = nowMs;
+}
+
+void DerivedMetrics::updatePower(VehicleState &state, qint64 nowMs)
+{
+    if (state.currentBattery < 0)
+    {
+        // No current sensor
+        state.watts = 0;
+        m_powerMs = 0;
+        return;
+    }
+    const float watts = state.voltageBattery / 1000.0f * state.currentBattery / 100.0f;
+    if (m_powerMs != 0)
+    {
+        const qint64 dt = nowMs - m_powerMs;
+        if (dt > 0 && dt <= MaxGapMs)
+        {
+            // Trapezoid between the two samples
+            state.energyUsed += (m_lastWatts + watts) * 0.5f * dt / 3600000.0f;
+        }
+    }
+    m_powerMs = nowMs;
+    m_lastWatts = watts;
+    state.watts = watts;
+}
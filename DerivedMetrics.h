@@ -0,0 +1,79 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief DerivedMetrics
+ *          Quantities the HUD shows but no message carries: distance flown,
+ *          distance and bearing from home, time in the air, power and the
+ *          energy used. They are updated from the last sample instead of
+ *          recomputed over the flight; the cosine of a latitude is computed
+ *          once per sample and kept for the next step, and time in the air
+ *          and energy are running integrals. Runs on the ingest thread inside
+ *          VehicleStateSnapshot::apply(), so the values are published with
+ *          the rest of the state.
+ *
+ */
+
+#ifndef DERIVEDMETRICS_H
+#define DERIVEDMETRICS_H
+
+#include <QtGlobal>
+
+struct VehicleState;
+
+class DerivedMetrics
+{
+public:
+    enum {
+        MaxGapMs = 2000     ///< Longer gaps between samples are link loss, not integrated
+    };
+
+    DerivedMetrics();
+
+    /** @brief Writer only. Updates the derived fields of state after section was applied at nowMs */
+    void update(VehicleState &state, quint32 section, qint64 nowMs);
+
+private:
+    void updatePosition(VehicleState &state);
+    void updateInAir(VehicleState &state, qint64 nowMs);
+    void updatePower(VehicleState &state, qint64 nowMs);
+    void setHome(VehicleState &state);
+
+    bool m_hasHome;
+    double m_homeLat;           ///< radians
+    double m_homeLon;
+    double m_homeSinLat;
+    double m_homeCosLat;
+
+    bool m_hasLast;             ///< Last point counted into the distance flown
+    double m_lastLat;           ///< radians
+    double m_lastLon;
+    double m_lastCosLat;
+
+    bool m_wasArmed;
+    qint64 m_inAirMs;           ///< Time of the last in-air sample, 0 on the ground
+    qint64 m_powerMs;           ///< Time of the last power sample, 0 before the first
+    float m_lastWatts;
+};
+
+#endif // DERIVEDMETRICS_H
@@ -0,0 +1,415 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief EventLoopMonitor
+ *          See EventLoopMonitor.h
+ *
+ */
+
+#include "EventLoopMonitor.h"
+#include "QsLog.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QThreadStorage>
+#include <QtAlgorithms>
+
+QAtomicInt EventLoopMonitor::s_active;
+QElapsedTimer EventLoopMonitor::s_clock;
+
+bool HudApplication::notify(QObject *receiver, QEvent *event)
+{
+    if (!EventLoopMonitor::isActive())
+    {
+        return QGuiApplication::notify(receiver, event);
+    }
+    EventLoopMonitor *monitor = EventLoopMonitor::instance();
+    const QMetaObject *metaObject = receiver->metaObject();
+    const QEvent::Type type = event->type();
+    monitor->begin();
+    const qint64 start = EventLoopMonitor::clockNs();
+    const bool result = QGuiApplication::notify(receiver, event);
+    monitor->delivered(metaObject, type, EventLoopMonitor::clockNs() - start);
+    return result;
+}
+
+struct EventLoopMonitor::ReceiverStats
+{
+    ReceiverStats() : events(0), totalNs(0), maxNs(0) {}
+    int events;
+    qint64 totalNs;
+    qint64 maxNs;
+};
+
+struct EventLoopMonitor::ThreadStats
+{
+    ThreadStats() : depth(0), events(0), busyNs(0), frameTelemetryNs(0) {}
+    QPointer<QThread> thread;
+    QString name;
+    int depth;                  ///< Owner thread only, nested deliveries
+    QMutex mutex;               ///< The rest, against publish()
+    int events;
+    qint64 busyNs;              ///< Outermost deliveries only
+    qint64 frameTelemetryNs;    ///< Watched receivers since the last frame
+    QHash<QPair<const QMetaObject*, int>, ReceiverStats> receivers;
+};
+
+// Never freed: a thread's stats outlive it until publish() has seen them,
+// and threads are few
+struct StatsHandle
+{
+    StatsHandle() : stats(0) {}
+    EventLoopMonitor::ThreadStats *stats;
+};
+static QThreadStorage<StatsHandle> threadStats;
+static QMutex allStatsMutex;
+static QList<EventLoopMonitor::ThreadStats*> allStats;
+
+class EventLoopMonitor::Probe : public QObject
+{
+public:
+    enum { ProbeEvent = QEvent::User + 0x454c };
+
+    explicit Probe(QThread *thread) : m_thread(thread), m_postedNs(-1), m_waitNs(0) {}
+
+    /** @brief Null once the thread is gone, a thread not running yet has no loop to probe */
+    QThread *watchedThread() const { return m_thread && m_thread->isRunning() ? m_thread.data() : 0; }
+
+    /** @brief UI thread. A probe still queued is not posted again */
+    void post()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_postedNs >= 0)
+        {
+            return;
+        }
+        m_postedNs = EventLoopMonitor::clockNs();
+        QCoreApplication::postEvent(this, new QEvent(static_cast<QEvent::Type>(ProbeEvent)));
+    }
+
+    /** @brief The last wait, or the age of the one still queued if that is longer */
+    qint64 waitNs(qint64 now)
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_postedNs >= 0 ? qMax(m_waitNs, now - m_postedNs) : m_waitNs;
+    }
+
+protected:
+    virtual bool event(QEvent *event)
+    {
+        if (event->type() != ProbeEvent)
+        {
+            return QObject::event(event);
+        }
+        QMutexLocker locker(&m_mutex);
+        m_waitNs = EventLoopMonitor::clockNs() - m_postedNs;
+        m_postedNs = -1;
+        return true;
+    }
+
+private:
+    QPointer<QThread> m_thread;
+    QMutex m_mutex;
+    qint64 m_postedNs;
+    qint64 m_waitNs;
+};
+
+EventLoopMonitor *EventLoopMonitor::instance()
+{
+    static EventLoopMonitor *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new EventLoopMonitor();
+    }
+    return _instance;
+}
+
+EventLoopMonitor::EventLoopMonitor() :
+    m_enabled(false),
+    m_budgetMs(4.0),
+    m_uiTelemetryMs(0),
+    m_overBudgetFrames(0),
+    m_frameMaxNs(0),
+    m_frameOverBudget(0)
+{
+    s_clock.start();
+    m_classCount.store(0);
+    m_publishTimer.setInterval(PublishMs);
+    connect(&m_publishTimer, SIGNAL(timeout()), this, SLOT(publish()));
+    watchThread(QCoreApplication::instance()->thread());
+}
+
+void EventLoopMonitor::watchClass(const QMetaObject *metaObject)
+{
+    const int count = m_classCount.load();
+    if (count >= MaxWatchedClasses)
+    {
+        QLOG_WARN() << "EventLoopMonitor: cannot watch" << metaObject->className() << ", too many classes";
+        return;
+    }
+    // Readers take the count with acquire, the entry is written before it
+    m_classes[count] = metaObject;
+    m_classCount.storeRelease(count + 1);
+}
+
+void EventLoopMonitor::watchThread(QThread *thread)
+{
+    Probe *probe = new Probe(thread);
+    probe->moveToThread(thread);
+    // Runs on the ending thread, which still processes deferred deletes after finished()
+    connect(thread, SIGNAL(finished()), probe, SLOT(deleteLater()), Qt::DirectConnection);
+    m_probes.append(probe);
+}
+
+void EventLoopMonitor::attach(QObject *window)
+{
+    if (m_window)
+    {
+        disconnect(m_window, 0, this, 0);
+    }
+    m_window = window;
+    if (m_window && m_enabled)
+    {
+        connect(m_window, SIGNAL(afterAnimating()), this, SLOT(onFrame()));
+    }
+}
+
+void EventLoopMonitor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+    m_enabled = enabled;
+    s_active.storeRelease(enabled ? 1 : 0);
+    if (enabled)
+    {
+        m_frameMaxNs = 0;
+        m_frameOverBudget = 0;
+        m_publishTimer.start();
+    }
+    else
+    {
+        m_publishTimer.stop();
+    }
+    attach(m_window);
+    emit enabledChanged(enabled);
+}
+
+void EventLoopMonitor::setBudgetMs(double budgetMs)
+{
+    if (budgetMs > 0 && m_budgetMs != budgetMs)
+    {
+        m_budgetMs = budgetMs;
+        emit budgetMsChanged(budgetMs);
+    }
+}
+
+EventLoopMonitor::ThreadStats *EventLoopMonitor::currentStats()
+{
+    StatsHandle &handle = threadStats.localData();
+    if (handle.stats == 0)
+    {
+        QThread *thread = QThread::currentThread();
+        handle.stats = new ThreadStats;
+        handle.stats->thread = thread;
+        handle.stats->name = thread == QCoreApplication::instance()->thread() ? QString("UI")
+                : !thread->objectName().isEmpty() ? thread->objectName()
+                : QString::fromLatin1(thread->metaObject()->className());
+        QMutexLocker locker(&allStatsMutex);
+        allStats.append(handle.stats);
+    }
+    return handle.stats;
+}
+
+bool EventLoopMonitor::isWatched(const QMetaObject *metaObject) const
+{
+    const int count = m_classCount.loadAcquire();
+    for (const QMetaObject *m = metaObject; m; m = m->superClass())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (m_classes[i] == m)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void EventLoopMonitor::begin()
+{
+    currentStats()->depth++;
+}
+
+void EventLoopMonitor::delivered(const QMetaObject *metaObject, QEvent::Type type, qint64 elapsedNs)
+{
+    ThreadStats *stats = currentStats();
+    const bool outermost = --stats->depth == 0;
+    const bool watched = isWatched(metaObject);
+
+    QMutexLocker locker(&stats->mutex);
+    stats->events++;
+    if (outermost)
+    {
+        stats->busyNs += elapsedNs;
+    }
+    if (watched)
+    {
+        ReceiverStats &receiver = stats->receivers[qMakePair(metaObject, int(type))];
+        receiver.events++;
+        receiver.totalNs += elapsedNs;
+        receiver.maxNs = qMax(receiver.maxNs, elapsedNs);
+        if (outermost)
+        {
+            stats->frameTelemetryNs += elapsedNs;
+        }
+    }
+}
+
+// UI thread, once per frame
+void EventLoopMonitor::onFrame()
+{
+    ThreadStats *stats = currentStats();
+    qint64 telemetryNs;
+    {
+        QMutexLocker locker(&stats->mutex);
+        telemetryNs = stats->frameTelemetryNs;
+        stats->frameTelemetryNs = 0;
+    }
+    m_frameMaxNs = qMax(m_frameMaxNs, telemetryNs);
+    if (telemetryNs > m_budgetMs * 1000000.0)
+    {
+        m_frameOverBudget++;
+    }
+}
+
+static bool busier(const QPair<qint64, QString> &a, const QPair<qint64, QString> &b)
+{
+    return a.first > b.first;
+}
+
+static QString eventName(int type)
+{
+    switch (type)
+    {
+    case QEvent::MetaCall:
+        return "queued call";
+    case QEvent::Timer:
+        return "timer";
+    default:
+        return QString("event %1").arg(type);
+    }
+}
+
+void EventLoopMonitor::publish()
+{
+    const qint64 now = clockNs();
+    const double seconds = PublishMs / 1000.0;
+    QStringList lines;
+    QList<QPair<qint64, QString> > receivers;
+
+    QList<ThreadStats*> all;
+    {
+        QMutexLocker locker(&allStatsMutex);
+        all = allStats;
+    }
+    foreach (ThreadStats *stats, all)
+    {
+        int events;
+        qint64 busyNs;
+        QHash<QPair<const QMetaObject*, int>, ReceiverStats> counted;
+        {
+            QMutexLocker locker(&stats->mutex);
+            events = stats->events;
+            busyNs = stats->busyNs;
+            counted.swap(stats->receivers);
+            stats->events = 0;
+            stats->busyNs = 0;
+        }
+        qint64 waitNs = -1;
+        foreach (const QPointer<Probe> &probe, m_probes)
+        {
+            if (probe && probe->watchedThread() && probe->watchedThread() == stats->thread.data())
+            {
+                waitNs = probe->waitNs(now);
+            }
+        }
+        if (events > 0 || waitNs >= 0)
+        {
+            QString line = QString("%1 %2 ev/s, busy %3%").arg(stats->name).arg(qRound(events / seconds))
+                    .arg(busyNs / (seconds * 10000000.0), 0, 'f', 0);
+            if (waitNs >= 0)
+            {
+                // Little's law: depth = arrival rate x time in the queue
+                line += QString(", wait %1 ms, depth ~%2").arg(waitNs / 1000000.0, 0, 'f', 1)
+                        .arg(qRound(events / seconds * waitNs / 1e9));
+            }
+            lines << line;
+        }
+        for (QHash<QPair<const QMetaObject*, int>, ReceiverStats>::const_iterator it = counted.constBegin();
+             it != counted.constEnd(); ++it)
+        {
+            const ReceiverStats &r = it.value();
+            receivers.append(qMakePair(r.totalNs, QString("%1 %2 (%3): %4/s, avg %5 us, max %6 ms")
+                    .arg(it.key().first->className(), eventName(it.key().second), stats->name)
+                    .arg(qRound(r.events / seconds)).arg(r.totalNs / qMax(1, r.events) / 1000)
+                    .arg(r.maxNs / 1000000.0, 0, 'f', 1)));
+        }
+    }
+    qSort(receivers.begin(), receivers.end(), busier);
+    for (int i = 0; i < receivers.size() && i < ReportedReceivers; ++i)
+    {
+        lines << receivers[i].second;
+    }
+
+    for (int i = m_probes.size() - 1; i >= 0; --i)
+    {
+        if (m_probes[i])
+        {
+            if (m_probes[i]->watchedThread())
+            {
+                m_probes[i]->post();
+            }
+        }
+        else
+        {
+            m_probes.removeAt(i);
+        }
+    }
+
+    m_uiTelemetryMs = m_frameMaxNs / 1000000.0;
+    m_overBudgetFrames = m_frameOverBudget;
+    if (m_frameOverBudget > 0)
+    {
+        QLOG_WARN() << "EventLoopMonitor:" << m_frameOverBudget << "frames over the" << m_budgetMs
+                    << "ms telemetry budget, worst" << m_uiTelemetryMs << "ms";
+    }
+    m_frameMaxNs = 0;
+    m_frameOverBudget = 0;
+    m_report = lines.join("\n");
+    emit statsChanged();
+}
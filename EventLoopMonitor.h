@@ -0,0 +1,149 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief EventLoopMonitor
+ *          Where the event loops spend their time: queue wait and depth per
+ *          thread, time per hot receiver, and how much of each UI frame
+ *          went to telemetry. Shown in the performance overlay.
+ *
+ */
+
+#ifndef EVENTLOOPMONITOR_H
+#define EVENTLOOPMONITOR_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QGuiApplication>
+#include <QList>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+/**
+ * @brief Delivers every event of every thread through EventLoopMonitor
+ *
+ * Only notify() sees the events of all threads, an event filter on the
+ * application sees the UI thread's. Costs one flag test per event while
+ * the monitor is off.
+ */
+class HudApplication : public QGuiApplication
+{
+public:
+    HudApplication(int &argc, char **argv) : QGuiApplication(argc, argv) {}
+    virtual bool notify(QObject *receiver, QEvent *event);
+};
+
+/**
+ * @brief Event loop instrumentation, sampled while the overlay shows
+ *
+ * Qt does not tell how many events a thread has queued, so each watched
+ * thread gets a probe object and once a second a probe event is posted to
+ * it: the time it waited is the queue wait, and the thread's event rate
+ * times that wait the depth (Little's law). A probe not answered by the
+ * next second counts its age, a thread that is stuck shows as such.
+ *
+ * Events to receivers of the watched classes are timed per class and
+ * event type, inclusive of everything they call; a queued connection
+ * shows as a "queued call" of its receiver. Those on the UI thread add up
+ * to the telemetry time of the frame, checked against budgetMs at
+ * afterAnimating and logged once a second when over it.
+ */
+class EventLoopMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(double budgetMs READ budgetMs WRITE setBudgetMs NOTIFY budgetMsChanged)
+    Q_PROPERTY(double uiTelemetryMs READ uiTelemetryMs NOTIFY statsChanged)
+    Q_PROPERTY(int overBudgetFrames READ overBudgetFrames NOTIFY statsChanged)
+    Q_PROPERTY(QString report READ report NOTIFY statsChanged)
+public:
+    enum { MaxWatchedClasses = 32, ReportedReceivers = 8, PublishMs = 1000 };
+
+    static EventLoopMonitor *instance();
+
+    /** @brief Time events to receivers of this class and its subclasses. Call before enabling */
+    void watchClass(const QMetaObject *metaObject);
+    /** @brief Probe the queue of thread, which needs to run an event loop */
+    void watchThread(QThread *thread);
+    /** @brief Check the UI thread's telemetry time once per frame of window, a QQuickWindow */
+    void attach(QObject *window);
+
+    bool isEnabled() const { return m_enabled; }
+    double budgetMs() const { return m_budgetMs; }
+
+    /** @brief Most telemetry time of a UI frame over the last second */
+    double uiTelemetryMs() const { return m_uiTelemetryMs; }
+    int overBudgetFrames() const { return m_overBudgetFrames; }
+    /** @brief One line per thread, then the busiest receivers */
+    QString report() const { return m_report; }
+
+    /** @brief From HudApplication::notify, any thread */
+    static bool isActive() { return s_active.load() != 0; }
+    static qint64 clockNs() { return s_clock.nsecsElapsed(); }
+    void begin();
+    /** @brief Ends the begin() before, metaObject is taken before delivery since the receiver may not survive it */
+    void delivered(const QMetaObject *metaObject, QEvent::Type type, qint64 elapsedNs);
+
+public slots:
+    void setEnabled(bool enabled);
+    void setBudgetMs(double budgetMs);
+
+signals:
+    void enabledChanged(bool enabled);
+    void budgetMsChanged(double budgetMs);
+    void statsChanged();
+
+private slots:
+    void publish();
+    void onFrame();
+
+private:
+    EventLoopMonitor();
+
+    class Probe;
+    struct ThreadStats;
+    struct ReceiverStats;
+    ThreadStats *currentStats();
+    bool isWatched(const QMetaObject *metaObject) const;
+
+    static QAtomicInt s_active;
+    static QElapsedTimer s_clock;
+
+    const QMetaObject *m_classes[MaxWatchedClasses];
+    QAtomicInt m_classCount;
+    QList<QPointer<Probe> > m_probes;
+    QPointer<QObject> m_window;
+    QTimer m_publishTimer;
+    bool m_enabled;
+    double m_budgetMs;
+    double m_uiTelemetryMs;
+    int m_overBudgetFrames;
+    qint64 m_frameMaxNs;        ///< UI thread, over the running second
+    int m_frameOverBudget;
+    QString m_report;
+};
+
+#endif // EVENTLOOPMONITOR_H
@@ -0,0 +1,418 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief FlightReview
+ *          See FlightReview.h
+ *
+ */
+
+#include "FlightReview.h"
+#include "PrimaryFlightDisplayQML.h"
+#include "GStreamerRecorder.h"
+#include "GStreamerRecordingIndexer.h"
+#include "LinkManager1.h"
+#include "TlogReplayLink.h"
+#include "TlogIndex.h"
+#include "TelemetryCache.h"
+#include "configuration.h"
+#include "QsLog.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QUrl>
+#include <QtAlgorithms>
+
+FlightReview::FlightReview(PrimaryFlightDisplayQML *display, QObject *parent) :
+    QObject(parent),
+    m_display(display),
+    m_active(false),
+    m_startUsec(0),
+    m_duration(0),
+    m_position(0),
+    m_paused(false),
+    m_speed(1.0),
+    m_driftMs(0),
+    m_linkId(-1),
+    m_replay(NULL),
+    m_tlogStart(0),
+    m_tlogEnd(0),
+    m_thumbnailIntervalMs(0),
+    m_thumbnailColumns(0),
+    m_thumbnailCount(0),
+    m_seeking(false),
+    m_pendingSeek(-1),
+    m_pendingAccurate(true)
+{
+    m_syncTimer.setInterval(SyncIntervalMs);
+    connect(&m_syncTimer, SIGNAL(timeout()), this, SLOT(checkSync()));
+    connect(m_display->player(), SIGNAL(asyncDone()), this, SLOT(onAsyncDone()));
+    connect(GStreamerRecordingIndexer::instance(), SIGNAL(indexed(QString)), this, SLOT(onIndexed(QString)));
+}
+
+FlightReview::~FlightReview()
+{
+    m_syncTimer.stop();
+}
+
+qint64 FlightReview::videoStartTime(const QString &videoFile)
+{
+    QSettings sync(GStreamerRecorder::syncFileName(videoFile), QSettings::IniFormat);
+    qint64 start = sync.value("startTime", 0).toLongLong();
+    if (start > 0)
+    {
+        return start;
+    }
+    // Recordings from before the sidecar are only named after the local time they started
+    QDateTime named = QDateTime::fromString(QFileInfo(videoFile).completeBaseName(), "yyyy-MM-dd hh-mm-ss");
+    return named.isValid() ? named.toMSecsSinceEpoch() * 1000 : 0;
+}
+
+QString FlightReview::findTlog(qint64 timeUsec)
+{
+    QDir dir(QGC::MAVLinkLogDirectory());
+    QStringList filters;
+    filters << QString("*") + MAVLINK_LOGFILE_EXT << QString("*") + MAVLINK_COMPRESSED_LOGFILE_EXT;
+    foreach (const QFileInfo &info, dir.entryInfoList(filters, QDir::Files, QDir::Time))
+    {
+        TlogIndex index;
+        if (index.load(info.filePath()) && qint64(index.firstTime) <= timeUsec && timeUsec <= qint64(index.lastTime))
+        {
+            return info.filePath();
+        }
+    }
+    return QString();
+}
+
+bool FlightReview::open(const QString &videoFile, const QString &tlogFile)
+{
+    close();
+    if (!QFile::exists(videoFile))
+    {
+        emit messageBox(tr("%1 does not exist").arg(videoFile));
+        return false;
+    }
+    qint64 start = videoStartTime(videoFile);
+    if (start == 0)
+    {
+        emit messageBox(tr("%1 has no sync file and no time in its name, it cannot be matched to a tlog").arg(videoFile));
+        return false;
+    }
+    QString tlog = tlogFile.isEmpty() ? findTlog(start) : tlogFile;
+    if (tlog.isEmpty())
+    {
+        QLOG_WARN() << "No tlog covers" << QDateTime::fromMSecsSinceEpoch(start / 1000).toString() << ", reviewing the video only";
+    }
+
+    GStreamerPlayer *player = m_display->player();
+    m_livePipeline = m_display->getPipelineString();
+    m_liveLatencyProfile = player->getLatencyProfile();
+    // The only profile with a synchronized sink, the file plays at its own pace
+    player->setLatencyProfile("robust");
+    m_display->setPipelineString(GStreamerRecorder::readerPipeline(videoFile, true));
+
+    m_videoFile = videoFile;
+    m_tlogFile = tlog;
+    m_startUsec = start;
+    m_duration = 0;
+    m_position = 0;
+    m_paused = false;
+    m_speed = 1.0;
+    m_driftMs = 0;
+    m_seeking = true;       // until the file has prerolled
+    m_pendingSeek = -1;
+    player->play();
+
+    loadIndex();
+    if (m_keyFrames.isEmpty())
+    {
+        GStreamerRecordingIndexer::instance()->enqueue(videoFile);
+    }
+    if (!tlog.isEmpty())
+    {
+        TelemetryCacheBuilder::instance()->enqueue(tlog);
+        m_linkId = LinkManager::instance()->addTlogReplay(tlog);
+        m_replay = LinkManager::instance()->getReplayLink(m_linkId);
+        connect(m_replay, SIGNAL(indexReady(quint64,quint64)), this, SLOT(onIndexReady(quint64,quint64)));
+    }
+    m_syncTimer.start();
+    m_active = true;
+    QLOG_INFO() << "Reviewing" << videoFile << "with" << tlog;
+
+    emit activeChanged();
+    emit durationChanged();
+    emit positionChanged();
+    emit pausedChanged();
+    emit speedChanged();
+    return true;
+}
+
+void FlightReview::close()
+{
+    if (!m_active)
+    {
+        return;
+    }
+    m_syncTimer.stop();
+    if (m_linkId >= 0)
+    {
+        LinkManager::instance()->removeLink(m_linkId);
+    }
+    m_linkId = -1;
+    m_replay = NULL;
+    m_tlogStart = 0;
+    m_tlogEnd = 0;
+    m_seeking = false;
+    m_pendingSeek = -1;
+    m_keyFrames.clear();
+    m_thumbnails.clear();
+    m_thumbnailCount = 0;
+    emit thumbnailsChanged();
+
+    GStreamerPlayer *player = m_display->player();
+    player->setLatencyProfile(m_liveLatencyProfile);
+    m_display->setPipelineString(m_livePipeline);
+    if (m_display->isVideoEnabled())
+    {
+        player->play();
+    }
+    m_active = false;
+    emit activeChanged();
+}
+
+void FlightReview::loadIndex()
+{
+    m_keyFrames = GStreamerRecordingIndexer::loadKeyFrames(m_videoFile);
+
+    QSettings sync(GStreamerRecorder::syncFileName(m_videoFile), QSettings::IniFormat);
+    sync.beginGroup("thumbnails");
+    m_thumbnailIntervalMs = sync.value("intervalMs", 0).toInt();
+    m_thumbnailSize = QSize(sync.value("width", 0).toInt(), sync.value("height", 0).toInt());
+    m_thumbnailColumns = sync.value("columns", 0).toInt();
+    m_thumbnailCount = sync.value("count", 0).toInt();
+    sync.endGroup();
+
+    QString sprite = GStreamerRecordingIndexer::thumbnailFileName(m_videoFile);
+    bool valid = m_thumbnailIntervalMs > 0 && m_thumbnailColumns > 0 && m_thumbnailCount > 0 && QFile::exists(sprite);
+    m_thumbnails = valid ? QUrl::fromLocalFile(sprite).toString() : QString();
+    emit thumbnailsChanged();
+}
+
+void FlightReview::onIndexed(QString videoFile)
+{
+    if (m_active && videoFile == m_videoFile)
+    {
+        loadIndex();
+    }
+}
+
+QRect FlightReview::thumbnailRect(double seconds) const
+{
+    if (m_thumbnails.isEmpty())
+    {
+        return QRect();
+    }
+    int tile = qBound(0, int(seconds * 1000 / m_thumbnailIntervalMs), m_thumbnailCount - 1);
+    return QRect(QPoint((tile % m_thumbnailColumns) * m_thumbnailSize.width(),
+                        (tile / m_thumbnailColumns) * m_thumbnailSize.height()), m_thumbnailSize);
+}
+
+void FlightReview::seek(double seconds, bool scrubbing)
+{
+    if (!m_active)
+    {
+        return;
+    }
+    seconds = qMax(0.0, m_duration > 0 ? qMin(seconds, m_duration) : seconds);
+    if (m_seeking)
+    {
+        // Only the newest position matters, it is seeked to once the current seek is done
+        m_pendingSeek = seconds;
+        m_pendingAccurate = !scrubbing;
+        m_position = seconds;
+        emit positionChanged();
+        return;
+    }
+    startSeek(seconds, !scrubbing);
+}
+
+void FlightReview::startSeek(double seconds, bool accurate)
+{
+    GStreamerPlayer *player = m_display->player();
+    m_position = seconds;
+    emit positionChanged();
+    if (player->getStopped())
+    {
+        // Stopped at the end of the file, seek once it has prerolled again
+        m_pendingSeek = seconds;
+        m_pendingAccurate = accurate;
+        m_seeking = true;
+        player->play();
+        return;
+    }
+    qint64 positionNs = qint64(seconds * 1e9);
+    if (!accurate && !m_keyFrames.isEmpty())
+    {
+        // To the indexed key frame's own time, decoding it is all the seek costs
+        QVector<qint64>::const_iterator next = qUpperBound(m_keyFrames.constBegin(), m_keyFrames.constEnd(), positionNs);
+        positionNs = (next == m_keyFrames.constBegin()) ? m_keyFrames.first() : *(next - 1);
+        accurate = true;
+    }
+    m_seeking = player->seek(positionNs, accurate, m_speed);
+    syncTelemetry(m_startUsec + qint64(seconds * 1e6));
+}
+
+void FlightReview::syncTelemetry(qint64 videoUsec)
+{
+    // Before indexReady() the replay does not know its span yet
+    if (m_replay == NULL || m_tlogEnd == 0)
+    {
+        return;
+    }
+    quint64 time = qBound(m_tlogStart, quint64(qMax(Q_INT64_C(0), videoUsec)), m_tlogEnd);
+    if (m_paused)
+    {
+        m_replay->seekPaused(time, PrimeLeadMs * 1000);
+    }
+    else
+    {
+        m_replay->seek(time);
+    }
+}
+
+void FlightReview::onIndexReady(quint64 startTime, quint64 endTime)
+{
+    m_tlogStart = startTime;
+    m_tlogEnd = endTime;
+    if (m_replay != NULL)
+    {
+        m_replay->setSpeed(m_speed);
+    }
+    syncTelemetry(m_startUsec + qint64(m_position * 1e6));
+}
+
+void FlightReview::onAsyncDone()
+{
+    if (!m_active)
+    {
+        return;
+    }
+    GStreamerPlayer *player = m_display->player();
+    qint64 duration = player->queryDuration();
+    if (duration > 0 && duration / 1e9 != m_duration)
+    {
+        m_duration = duration / 1e9;
+        emit durationChanged();
+    }
+
+    m_seeking = false;
+    if (m_pendingSeek >= 0)
+    {
+        double seconds = m_pendingSeek;
+        m_pendingSeek = -1;
+        startSeek(seconds, m_pendingAccurate);
+        return;
+    }
+    if (m_paused && player->getPlaying())
+    {
+        player->pause();
+    }
+}
+
+void FlightReview::checkSync()
+{
+    if (m_seeking)
+    {
+        return;
+    }
+    qint64 position = m_display->player()->queryPosition();
+    if (position < 0)
+    {
+        return;
+    }
+    m_position = position / 1e9;
+
+    // The video is the clock, the telemetry follows it
+    qint64 videoUsec = m_startUsec + position / 1000;
+    m_driftMs = 0;
+    if (m_replay != NULL && m_tlogEnd > 0 && !m_paused
+            && videoUsec >= qint64(m_tlogStart) && videoUsec <= qint64(m_tlogEnd))
+    {
+        m_driftMs = int((qint64(m_replay->getCurrentTime()) - videoUsec) / 1000);
+        if (qAbs(m_driftMs) > MaxDriftMs)
+        {
+            QLOG_DEBUG() << "Review telemetry" << m_driftMs << "ms off the video, seeking it back";
+            m_replay->seek(videoUsec);
+        }
+    }
+    emit positionChanged();
+}
+
+void FlightReview::setPaused(bool paused)
+{
+    if (m_paused == paused)
+    {
+        return;
+    }
+    m_paused = paused;
+    if (m_active)
+    {
+        GStreamerPlayer *player = m_display->player();
+        if (paused)
+        {
+            player->pause();
+        }
+        else
+        {
+            player->play();
+        }
+        if (m_replay != NULL)
+        {
+            m_replay->setPaused(paused);
+        }
+    }
+    emit pausedChanged();
+}
+
+void FlightReview::setSpeed(double speed)
+{
+    // Beyond this the demuxer and decoder, not the rate, set the pace
+    speed = qBound(0.1, speed, 16.0);
+    if (qFuzzyCompare(m_speed, speed))
+    {
+        return;
+    }
+    m_speed = speed;
+    if (m_active)
+    {
+        if (m_replay != NULL)
+        {
+            m_replay->setSpeed(speed);
+        }
+        // A new rate only takes effect with a seek
+        seek(m_position);
+    }
+    emit speedChanged();
+}
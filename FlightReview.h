@@ -0,0 +1,172 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief FlightReview
+ *          A recorded video played back together with the tlog of the same
+ *          flight, seeking both to one position and driving the HUD from
+ *          the replayed telemetry.
+ *
+ */
+
+#ifndef FLIGHTREVIEW_H
+#define FLIGHTREVIEW_H
+
+#include <QObject>
+#include <QRect>
+#include <QSize>
+#include <QTimer>
+#include <QVector>
+
+class PrimaryFlightDisplayQML;
+class TlogReplayLink;
+
+/**
+ * @brief Review mode of a recording and its tlog
+ *
+ * The wall clock time of the first frame comes from the recording's sync
+ * sidecar (see GStreamerRecorder::syncFileName()), or from its file name
+ * for older recordings. The tlog is the one in the MAVLink log directory
+ * whose index covers that time, unless one is given.
+ *
+ * The video is the clock: it plays synchronized to the pipeline clock and
+ * the tlog is replayed through LinkManager next to it, re-seeked when it
+ * drifts more than MaxDriftMs from the video position. A seek goes to the
+ * key frame before the position while scrubbing and to the exact frame on
+ * release, using the demuxer's index; seeks that arrive while one is in
+ * flight are coalesced into the newest. While paused the telemetry of the
+ * PrimeLeadMs before the position is replayed at once, so the HUD shows
+ * the state at the paused frame.
+ *
+ * Once GStreamerRecordingIndexer has processed the recording (it is queued
+ * on open if not), scrubbing goes straight to the times in its key frame
+ * index and the timeline shows tiles of its thumbnail sprite.
+ *
+ * Positions are in seconds from the first frame of the video.
+ */
+class FlightReview : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+    Q_PROPERTY(QString videoFile READ getVideoFile NOTIFY activeChanged)
+    Q_PROPERTY(QString tlogFile READ getTlogFile NOTIFY activeChanged)
+    Q_PROPERTY(double duration READ getDuration NOTIFY durationChanged)
+    Q_PROPERTY(double position READ getPosition NOTIFY positionChanged)
+    Q_PROPERTY(bool paused READ isPaused WRITE setPaused NOTIFY pausedChanged)
+    Q_PROPERTY(double speed READ getSpeed WRITE setSpeed NOTIFY speedChanged)
+    Q_PROPERTY(int driftMs READ getDriftMs NOTIFY positionChanged)
+    /** @brief URL of the thumbnail sprite, empty until the recording is indexed */
+    Q_PROPERTY(QString thumbnails READ getThumbnails NOTIFY thumbnailsChanged)
+
+public:
+    enum {
+        SyncIntervalMs = 250,
+        MaxDriftMs = 200,       ///< Telemetry further off the video is seeked back to it
+        PrimeLeadMs = 1000
+    };
+
+    explicit FlightReview(PrimaryFlightDisplayQML *display, QObject *parent = 0);
+    ~FlightReview();
+
+    bool isActive() const { return m_active; }
+    QString getVideoFile() const { return m_videoFile; }
+    QString getTlogFile() const { return m_tlogFile; }
+    double getDuration() const { return m_duration; }
+    double getPosition() const { return m_position; }
+    bool isPaused() const { return m_paused; }
+    double getSpeed() const { return m_speed; }
+    int getDriftMs() const { return m_driftMs; }
+    QString getThumbnails() const { return m_thumbnails; }
+
+    /** @brief Tile of the thumbnail sprite showing seconds, a null rect without thumbnails */
+    Q_INVOKABLE QRect thumbnailRect(double seconds) const;
+
+    /** @brief Wall clock time of the first frame of a recording in microseconds since the epoch, 0 if unknown */
+    static qint64 videoStartTime(const QString &videoFile);
+    /** @brief The tlog in the MAVLink log directory covering timeUsec, empty if none does */
+    static QString findTlog(qint64 timeUsec);
+
+public slots:
+    /** @brief Play videoFile with tlogFile, or the tlog found for it. The live video is restored by close() */
+    bool open(const QString &videoFile, const QString &tlogFile = QString());
+    void close();
+    /** @brief Go to seconds, to the exact frame; while scrubbing to the key frame before it */
+    void seek(double seconds, bool scrubbing = false);
+    void setPaused(bool paused);
+    /** @brief Playback rate of video and telemetry, 1 is real time */
+    void setSpeed(double speed);
+
+signals:
+    void activeChanged();
+    void durationChanged();
+    void positionChanged();
+    void pausedChanged();
+    void speedChanged();
+    void thumbnailsChanged();
+    void messageBox(QString text);
+
+private slots:
+    void onAsyncDone();
+    void onIndexReady(quint64 startTime, quint64 endTime);
+    void checkSync();
+    void onIndexed(QString videoFile);
+
+private:
+    void loadIndex();
+    void startSeek(double seconds, bool accurate);
+    void syncTelemetry(qint64 videoUsec);
+
+    PrimaryFlightDisplayQML *m_display;
+    bool m_active;
+    QString m_videoFile;
+    QString m_tlogFile;
+    qint64 m_startUsec;         ///< Wall clock time of the first frame
+    double m_duration;
+    double m_position;
+    bool m_paused;
+    double m_speed;
+    int m_driftMs;
+
+    int m_linkId;
+    TlogReplayLink *m_replay;
+    quint64 m_tlogStart;
+    quint64 m_tlogEnd;
+
+    QVector<qint64> m_keyFrames;    ///< Nanoseconds, empty until indexed
+    QString m_thumbnails;
+    int m_thumbnailIntervalMs;
+    QSize m_thumbnailSize;
+    int m_thumbnailColumns;
+    int m_thumbnailCount;
+
+    bool m_seeking;             ///< A video seek is in flight, until asyncDone()
+    double m_pendingSeek;       ///< Newest seek that came in meanwhile, < 0 if none
+    bool m_pendingAccurate;
+    QTimer m_syncTimer;
+
+    // Restored by close()
+    QString m_livePipeline;
+    QString m_liveLatencyProfile;
+};
+
+#endif // FLIGHTREVIEW_H
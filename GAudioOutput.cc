@@ -35,7 +35,8 @@ This file is part of the QGROUNDCONTROL project
 #include "MG.h"
 
 #include <QApplication>
-#include <QSettings>
+#include <QFile>
+#include "SettingsStore.h"
 #include <QTemporaryFile>
 
 #ifdef Q_OS_MAC
@@ -93,12 +94,16 @@ GAudioOutput* GAudioOutput::instance()
 GAudioOutput::GAudioOutput(QObject* parent) : QObject(parent),
     voiceIndex(0),
     emergency(false),
-    muted(false)
+    muted(false),
+    alertQueue(new AudioAlertQueue()),
+    audioEngine(NULL),
+    speechVoice(0)
 {
     // Load settings
-    QSettings settings;
-    settings.sync();
+    StoredSettings settings;
     muted = settings.value(QGC_GAUDIOOUTPUT_KEY+"muted", muted).toBool();
+    // "gstreamer" plays through a pipeline on the video runtime, empty uses the platform device
+    audioEngine = new AudioEngine(settings.value(QGC_GAUDIOOUTPUT_KEY+"backend").toString());
 
 #ifdef Q_OS_LINUX
 //    // Remove Phonon Audio for linux and use alsa
@@ -153,6 +158,16 @@ GAudioOutput::GAudioOutput(QObject* parent) : QObject(parent),
     }
 #endif
 
+    // The queue thread only decides, speaking stays with the platform code here
+    connect(alertQueue, SIGNAL(speak(QString,int)), this, SLOT(speakNow(QString,int)));
+    connect(alertQueue, SIGNAL(interrupt()), this, SLOT(stopSpeaking()));
+    // Recorded clips are only used once the engine has a device
+    connect(alertQueue, SIGNAL(play(QByteArray,int)), this, SLOT(playClip(QByteArray,int)));
+    connect(audioEngine, SIGNAL(opened(bool)), this, SLOT(engineOpened(bool)));
+    connect(audioEngine, SIGNAL(finished(int)), this, SLOT(voiceFinished(int)));
+    // Mixing must not wait behind the GUI
+    audioEngine->start(QThread::TimeCriticalPriority);
+
     // Prepare regular emergency signal, will be fired off on calling startEmergency()
     emergencyTimer = new QTimer();
     connect(emergencyTimer, SIGNAL(timeout()), this, SLOT(beep()));
@@ -171,10 +186,14 @@ GAudioOutput::GAudioOutput(QObject* parent) : QObject(parent),
 GAudioOutput::~GAudioOutput()
 {
     QLOG_INFO() << "~GAudioOutput()";
-#ifdef Q_OS_LINUX
-    // wait until thread is running before terminate AlsaAudio thread
-    //AlsaAudio::instance(this)->wait();
-#endif
+    AudioAlertQueue::Stats stats = alertQueue->stats();
+    QLOG_INFO() << "Audio alerts spoken" << stats.spoken << "from clips" << stats.clips << "duplicates" << stats.duplicates
+                << "overflows" << stats.overflows << "stale" << stats.stale
+                << "interrupted" << stats.interrupted;
+    delete alertQueue;
+    alertQueue = NULL;
+    delete audioEngine;
+    audioEngine = NULL;
 #ifdef Q_OS_MAC
     if(m_speech_channel)
     {
@@ -193,9 +212,12 @@ void GAudioOutput::mute(bool mute)
     if (mute != muted)
     {
         this->muted = mute;
-        QSettings settings;
+        if (muted)
+        {
+            alertQueue->clear();
+        }
+        StoredSettings settings;
         settings.setValue(QGC_GAUDIOOUTPUT_KEY+"muted", this->muted);
-        settings.sync();
         emit mutedChanged(muted);
     }
 }
@@ -213,67 +235,118 @@ bool GAudioOutput::say(QString text, int severity)
             //don't say system %1 [HACK] :(
             return true;
 
-        // TODO Add severity filter
-        Q_UNUSED(severity);
-        bool res = false;
-        if (!emergency)
+        if (emergency)
         {
+            return false;
+        }
+        alertQueue->post(text, AudioAlertQueue::priorityForSeverity(severity));
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
 
-            // Speech synthesis is only supported with MSVC compiler
+void GAudioOutput::speakNow(QString text, int priority)
+{
+    Q_UNUSED(priority);
+    bool res = false;
+    if (!muted && !emergency)
+    {
+        // Speech synthesis is only supported with MSVC compiler
 #ifdef _MSC_VER2
-            SpeechSynthesizer synth = new SpeechSynthesizer();
-            synth.SelectVoice("Microsoft Anna");
-            synth.SpeakText(text.toStdString().c_str());
-            res = true;
+        SpeechSynthesizer synth = new SpeechSynthesizer();
+        synth.SelectVoice("Microsoft Anna");
+        synth.SpeakText(text.toStdString().c_str());
+        res = true;
 #endif
 
-#ifdef Q_OS_LINUX
-//            // spokenfilename is the filename created from spoken text
-//            QString spokenFilename = text;
-//            spokenFilename.replace(QRegExp(" "), "_");
-//            spokenFilename = QGC::appDataDirectory() + "/tmp_audio/" + spokenFilename + ".wav";
-
-//            // alsadriver is a qthread. tmp. files dont work here
-//            QFile file( spokenFilename );
-//            if (!file.exists(spokenFilename)){ // if file not exist we create a new one
-//                if (file.open(QIODevice::ReadWrite))
-//                {
-//                    QLOG_INFO() << file.fileName() << " file not exist, create a new one";
-//                    cst_voice *v = register_cmu_us_kal(NULL);
-//                    cst_wave *wav = flite_text_to_wave(text.toStdString().c_str(), v);
-//                    cst_wave_save(wav, file.fileName().toStdString().c_str(), "riff");
-//                    file.close();
-//                    AlsaAudio::instance(this)->enqueueFilname(file.fileName());
-//                    if(!AlsaAudio::instance(this)->isRunning())
-//                        AlsaAudio::instance(this)->start();
-//                    res = true;
-//                }
-//            }else // we open existing file
-//            {
-//                QLOG_INFO() << file.fileName() << " file exist, playing this file";
-//                AlsaAudio::instance(this)->enqueueFilname(file.fileName());
-//                if(!AlsaAudio::instance(this)->isRunning())
-//                    AlsaAudio::instance(this)->start();
-//                res = true;
-//            }
+#ifdef Q_OS_MAC
+        if(m_speech_channel)
+        {
+            SpeakCFString(*m_speech_channel, text.toCFString(), NULL);
+        }
+        res = true;
 #endif
+    }
+    if (!res)
+    {
+        // Nothing will report the end, the queue moves on when its estimate runs out
+        QLOG_DEBUG() << "No speech output for" << text;
+    }
+}
 
-#ifdef Q_OS_MAC
-            if(m_speech_channel)
+void GAudioOutput::playClip(QByteArray pcm, int priority)
+{
+    Q_UNUSED(priority);
+    if (muted || emergency)
+    {
+        alertQueue->speakingFinished();
+        return;
+    }
+    speechVoice = audioEngine->play(pcm, AudioEngine::ChannelSpeech);
+    if (speechVoice == 0)
+    {
+        alertQueue->speakingFinished();
+    }
+}
+
+void GAudioOutput::engineOpened(bool ok)
+{
+    alertQueue->setClipsEnabled(ok);
+}
+
+void GAudioOutput::voiceFinished(int voice)
+{
+    if (voice != 0 && voice == speechVoice)
+    {
+        speechVoice = 0;
+        alertQueue->speakingFinished();
+    }
+}
+
+void GAudioOutput::playTone(const QString& file)
+{
+    QHash<QString, QByteArray>::const_iterator it = tones.constFind(file);
+    if (it == tones.constEnd())
+    {
+        // Decoded on first use and kept; a missing file is remembered as empty
+        QByteArray pcm;
+        QFile f(file);
+        if (f.open(QIODevice::ReadOnly))
+        {
+            QString error;
+            if (!AudioClipCache::decodeWav(f.readAll(), &pcm, &error))
             {
-                SpeakCFString(*m_speech_channel, text.toCFString(), NULL);
+                QLOG_WARN() << "Audio tone" << file << "skipped:" << error;
+                pcm.clear();
             }
-            res = true;
-#endif
         }
-        return res;
+        it = tones.insert(file, pcm);
     }
-    else
+    if (!it.value().isEmpty())
     {
-        return false;
+        audioEngine->play(it.value(), AudioEngine::ChannelTone);
     }
 }
 
+void GAudioOutput::stopSpeaking()
+{
+    if (speechVoice != 0)
+    {
+        // Forgotten first, its finished() must not end the alert that replaces it
+        audioEngine->stop(speechVoice);
+        speechVoice = 0;
+    }
+#ifdef Q_OS_MAC
+    if(m_speech_channel)
+    {
+        StopSpeech(*m_speech_channel);
+    }
+#endif
+}
+
 /**
  * @param text This message will be played after the alert beep
  */
@@ -297,10 +370,7 @@ void GAudioOutput::notifyPositive()
 {
     if (!muted)
     {
-        // Use QFile to transform path for all OS
-        QFile f(QGC::shareDirectory()+QString("/files/audio/double_notify.wav"));
-        //m_media->setCurrentSource(Phonon::MediaSource(f.fileName().toStdString().c_str()));
-        //m_media->play();
+        playTone(QGC::shareDirectory()+QString("/files/audio/double_notify.wav"));
     }
 }
 
@@ -308,10 +378,7 @@ void GAudioOutput::notifyNegative()
 {
     if (!muted)
     {
-        // Use QFile to transform path for all OS
-        QFile f(QGC::shareDirectory()+QString("/files/audio/flat_notify.wav"));
-        //m_media->setCurrentSource(Phonon::MediaSource(f.fileName().toStdString().c_str()));
-        //m_media->play();
+        playTone(QGC::shareDirectory()+QString("/files/audio/flat_notify.wav"));
     }
 }
 
@@ -354,15 +421,7 @@ void GAudioOutput::beep()
 {
     if (!muted)
     {
-        // Use QFile to transform path for all OS
-        QFile f(QGC::shareDirectory()+QString("/files/audio/alert.wav"));
-
-#ifdef Q_OS_LINUX
-//        AlsaAudio::instance(this)->enqueueFilname(f.fileName());
-//        if(!AlsaAudio::instance(this)->isRunning())
-//            AlsaAudio::instance(this)->start();
-#endif
-
+        playTone(QGC::shareDirectory()+QString("/files/audio/alert.wav"));
     }
 }
 
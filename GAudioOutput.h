@@ -35,7 +35,9 @@ This file is part of the PIXHAWK project
 #include <QObject>
 #include <QTimer>
 #include <QStringList>
-#include "audio/AlsaAudio.h"
+#include <QHash>
+#include "audio/AudioEngine.h"
+#include "audio/AudioAlertQueue.h"
 #ifdef Q_OS_MAC
 #include <QtMultimedia>
 #endif
@@ -75,8 +77,8 @@ public:
     bool isMuted();
 
 public slots:
-    /** @brief Say this text if current output priority matches */
-    bool say(QString text, int severity=1);
+    /** @brief Queue this text, severity is a MAV_SEVERITY and sets its priority (6 is info) */
+    bool say(QString text, int severity=6);
     /** @brief Play alert sound and say notification message */
     bool alert(QString text);
     /** @brief Start emergency sound */
@@ -96,6 +98,16 @@ public slots:
     /** @brief Mute/unmute sound */
     void mute(bool mute);
 
+private slots:
+    /** @brief Speak an alert the queue picked, on the GUI thread */
+    void speakNow(QString text, int priority);
+    /** @brief Play an alert made of recorded clips */
+    void playClip(QByteArray pcm, int priority);
+    /** @brief Cut the current alert short */
+    void stopSpeaking();
+    void engineOpened(bool ok);
+    void voiceFinished(int voice);
+
 signals:
     void mutedChanged(bool);
 
@@ -112,7 +124,12 @@ protected:
     bool emergency;   ///< Emergency status flag
     QTimer* emergencyTimer;
     bool muted;
+    AudioAlertQueue* alertQueue;   ///< Orders, de-duplicates and paces what is said
+    AudioEngine* audioEngine;      ///< Mixes clips and tones on the open device
+    int speechVoice;               ///< Engine voice of the alert being played, 0 if none
+    QHash<QString, QByteArray> tones; ///< Decoded notification sounds by file
 private:
+    void playTone(const QString& file);
     GAudioOutput(QObject* parent=NULL);
     ~GAudioOutput();
 };
@@ -0,0 +1,306 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerDecoderProbe.h"
+#include <QSettings>
+#include <QSysInfo>
+#include <QRegExp>
+#include <QDebug>
+#include <gst/gst.h>
+
+struct ProbedCodec
+{
+    const char *codec;
+    const char *caps;
+};
+
+static const ProbedCodec ProbedCodecs[] = {
+    { "h264", "video/x-h264" },
+    { "h265", "video/x-h265" },
+    { NULL, NULL }
+};
+
+// Element name prefixes of hardware decoders that do not say "Hardware" in their klass
+static const char * const HardwarePrefixes[] = {
+    "amcviddec", "omx", "vaapi", "v4l2", "nv", "vtdec", "msdk", "d3d11", "imx",
+    NULL
+};
+
+// Decoders recognised in a pipeline string even when this device does not have them
+static const ProbedCodec KnownDecoders[] = {
+    { "h264", "avdec_h264" },
+    { "h264", "openh264dec" },
+    { "h265", "avdec_h265" },
+    { "h265", "libde265dec" },
+    { NULL, NULL }
+};
+
+GStreamerDecoderProbe* GStreamerDecoderProbe::instance()
+{
+    static GStreamerDecoderProbe* _instance = 0;
+    if(_instance == 0)
+    {
+        _instance = new GStreamerDecoderProbe();
+    }
+    return _instance;
+}
+
+GStreamerDecoderProbe::GStreamerDecoderProbe(QObject *parent) :
+    QObject(parent)
+{
+    if (!loadCache())
+    {
+        probe();
+        saveCache();
+    }
+
+    Q_FOREACH(const QString & codec, codecs())
+    {
+        qDebug() << "Video decoders for" << codec << "=" << m_decoders.value(codec);
+    }
+}
+
+QStringList GStreamerDecoderProbe::codecs()
+{
+    QStringList result;
+    for (int i = 0; ProbedCodecs[i].codec != NULL; i++)
+    {
+        result << ProbedCodecs[i].codec;
+    }
+    return result;
+}
+
+QStringList GStreamerDecoderProbe::decoders(const QString & codec) const
+{
+    QStringList result;
+    Q_FOREACH(const QString & decoder, m_decoders.value(codec))
+    {
+        if (!m_failed.contains(decoder)) result << decoder;
+    }
+    return result;
+}
+
+QString GStreamerDecoderProbe::bestDecoder(const QString & codec) const
+{
+    QStringList working = decoders(codec);
+    return working.isEmpty() ? QString() : working.first();
+}
+
+QString GStreamerDecoderProbe::codecOf(const QString & decoder) const
+{
+    for (QMap<QString, QStringList>::const_iterator it = m_decoders.constBegin(); it != m_decoders.constEnd(); ++it)
+    {
+        if (it.value().contains(decoder)) return it.key();
+    }
+    for (int i = 0; KnownDecoders[i].codec != NULL; i++)
+    {
+        if (decoder == KnownDecoders[i].caps) return KnownDecoders[i].codec;
+    }
+    return QString();
+}
+
+bool GStreamerDecoderProbe::isHardware(const QString & decoder) const
+{
+    return m_hardware.contains(decoder);
+}
+
+QStringList GStreamerDecoderProbe::profiles(const QString & decoder) const
+{
+    return m_profiles.value(decoder);
+}
+
+void GStreamerDecoderProbe::markFailed(const QString & decoder)
+{
+    if (m_failed.contains(decoder)) return;
+
+    // Session only: a decoder failing on one stream may well work on the next launch
+    m_failed.insert(decoder);
+    qCritical() << "Video decoder" << decoder << "failed, falling back to" << bestDecoder(codecOf(decoder));
+}
+
+QString GStreamerDecoderProbe::substituteDecoders(const QString & pipelineString) const
+{
+    QStringList elements = pipelineString.split('!');
+    for (int i = 0; i < elements.size(); i++)
+    {
+        QString element = elements[i].trimmed();
+        QString factory = element.section(' ', 0, 0);
+        QString codec = codecOf(factory);
+        QString best = codec.isEmpty() ? QString() : bestDecoder(codec);
+
+        if (best.isEmpty() || best == factory)
+        {
+            elements[i] = element;
+            continue;
+        }
+
+        // Properties belong to the old decoder, only keep its name so references still resolve
+        elements[i] = best;
+        QRegExp name("(^|\\s)(name\\s*=\\s*\\S+)");
+        if (name.indexIn(element) >= 0) elements[i] += " " + name.cap(2);
+    }
+    return elements.join(" ! ");
+}
+
+void GStreamerDecoderProbe::reprobe()
+{
+    m_failed.clear();
+    probe();
+    saveCache();
+}
+
+// Changes whenever the firmware, GStreamer or its set of plugins change
+QString GStreamerDecoderProbe::fingerprint()
+{
+    gchar *version = gst_version_string();
+    GList *plugins = gst_registry_get_plugin_list(gst_registry_get());
+
+    QString result = QString("%1|%2|%3|%4").arg(QSysInfo::kernelVersion(), QSysInfo::productVersion(),
+                                                QString(version)).arg(g_list_length(plugins));
+
+    gst_plugin_list_free(plugins);
+    g_free(version);
+    return result;
+}
+
+void GStreamerDecoderProbe::probe()
+{
+    m_decoders.clear();
+    m_profiles.clear();
+    m_hardware.clear();
+
+    GList *factories = gst_element_factory_list_get_elements(
+                GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO, GST_RANK_MARGINAL);
+    factories = g_list_sort(factories, (GCompareFunc)gst_plugin_feature_rank_compare_func);
+
+    for (int c = 0; ProbedCodecs[c].codec != NULL; c++)
+    {
+        GstCaps *caps = gst_caps_from_string(ProbedCodecs[c].caps);
+        GList *matching = gst_element_factory_list_filter(factories, caps, GST_PAD_SINK, FALSE);
+
+        QStringList hardware;
+        QStringList software;
+        for (GList *l = matching; l != NULL; l = l->next)
+        {
+            GstElementFactory *factory = GST_ELEMENT_FACTORY(l->data);
+            QString name = GST_OBJECT_NAME(factory);
+            const gchar *klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+
+            bool isHardware = klass && g_strstr_len(klass, -1, "Hardware");
+            for (int p = 0; !isHardware && HardwarePrefixes[p] != NULL; p++)
+            {
+                isHardware = name.startsWith(HardwarePrefixes[p]);
+            }
+
+            // Profiles the sink pad template accepts, a plain string or a list
+            QStringList profileList;
+            for (const GList *t = gst_element_factory_get_static_pad_templates(factory); t != NULL; t = t->next)
+            {
+                GstStaticPadTemplate *padTemplate = (GstStaticPadTemplate*)t->data;
+                if (padTemplate->direction != GST_PAD_SINK) continue;
+
+                GstCaps *templateCaps = gst_static_caps_get(&padTemplate->static_caps);
+                for (guint i = 0; i < gst_caps_get_size(templateCaps); i++)
+                {
+                    GstStructure *structure = gst_caps_get_structure(templateCaps, i);
+                    if (!gst_structure_has_name(structure, ProbedCodecs[c].caps)) continue;
+
+                    const GValue *value = gst_structure_get_value(structure, "profile");
+                    if (value && G_VALUE_HOLDS_STRING(value))
+                    {
+                        profileList << g_value_get_string(value);
+                    }
+                    else if (value && GST_VALUE_HOLDS_LIST(value))
+                    {
+                        for (guint v = 0; v < gst_value_list_get_size(value); v++)
+                        {
+                            const GValue *item = gst_value_list_get_value(value, v);
+                            if (G_VALUE_HOLDS_STRING(item)) profileList << g_value_get_string(item);
+                        }
+                    }
+                }
+                gst_caps_unref(templateCaps);
+            }
+            profileList.removeDuplicates();
+            m_profiles[name] = profileList;
+
+            if (isHardware)
+            {
+                hardware << name;
+                m_hardware.insert(name);
+            }
+            else
+            {
+                software << name;
+            }
+        }
+
+        // Ranked order within each group, hardware always first
+        m_decoders[ProbedCodecs[c].codec] = hardware + software;
+
+        gst_plugin_feature_list_free(matching);
+        gst_caps_unref(caps);
+    }
+
+    gst_plugin_feature_list_free(factories);
+}
+
+bool GStreamerDecoderProbe::loadCache()
+{
+    QSettings settings;
+    settings.beginGroup("VIDEO_DECODERS");
+    if (settings.value("FINGERPRINT").toString() != fingerprint()) return false;
+
+    Q_FOREACH(const QString & codec, codecs())
+    {
+        m_decoders[codec] = settings.value(codec.toUpper()).toStringList();
+    }
+    m_hardware = settings.value("HARDWARE").toStringList().toSet();
+
+    settings.beginGroup("PROFILES");
+    Q_FOREACH(const QString & decoder, settings.childKeys())
+    {
+        m_profiles[decoder] = settings.value(decoder).toStringList();
+    }
+    settings.endGroup();
+    settings.endGroup();
+    return true;
+}
+
+void GStreamerDecoderProbe::saveCache()
+{
+    QSettings settings;
+    settings.beginGroup("VIDEO_DECODERS");
+    settings.remove("");
+    settings.setValue("FINGERPRINT", fingerprint());
+
+    Q_FOREACH(const QString & codec, codecs())
+    {
+        settings.setValue(codec.toUpper(), m_decoders.value(codec));
+    }
+    settings.setValue("HARDWARE", QStringList(m_hardware.toList()));
+
+    settings.beginGroup("PROFILES");
+    for (QMap<QString, QStringList>::const_iterator it = m_profiles.constBegin(); it != m_profiles.constEnd(); ++it)
+    {
+        settings.setValue(it.key(), it.value());
+    }
+    settings.endGroup();
+    settings.endGroup();
+    settings.sync();
+}
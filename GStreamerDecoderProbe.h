@@ -0,0 +1,78 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerDecoderProbe_H
+#define GStreamerDecoderProbe_H
+
+#include <QObject>
+#include <QStringList>
+#include <QMap>
+#include <QSet>
+
+/**
+ * @brief Which H.264/H.265 decoders this device has, and which one to use
+ *
+ * The GStreamer registry is scanned once per device/firmware and the result
+ * cached in the settings: decoders for each codec ordered hardware first,
+ * then by rank, with the profiles their sink caps advertise. GStreamerPlayer
+ * uses it to put the fastest decoder into the user's pipeline string, and
+ * marks a decoder failed when it errors out so the next build falls back.
+ */
+class GStreamerDecoderProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    static GStreamerDecoderProbe* instance();
+
+    /** @brief Codecs handled, "h264" and "h265" */
+    static QStringList codecs();
+
+    /** @brief Working decoders for the codec, best first */
+    QStringList decoders(const QString & codec) const;
+    /** @brief Best working decoder for the codec, empty if there is none */
+    QString bestDecoder(const QString & codec) const;
+    /** @brief Codec decoded by this element factory, empty if it is not a probed decoder */
+    QString codecOf(const QString & decoder) const;
+    bool isHardware(const QString & decoder) const;
+    QStringList profiles(const QString & decoder) const;
+
+    /** @brief Stop using the decoder for the rest of the session */
+    void markFailed(const QString & decoder);
+
+    /** @brief Replace every H.264/H.265 decoder in the pipeline with the best working one */
+    QString substituteDecoders(const QString & pipelineString) const;
+
+    /** @brief Forget the cache and scan the registry again */
+    void reprobe();
+
+private:
+    explicit GStreamerDecoderProbe(QObject *parent = 0);
+
+    static QString fingerprint();
+    void probe();
+    bool loadCache();
+    void saveCache();
+
+    QMap<QString, QStringList> m_decoders;  ///< codec -> factory names, best first
+    QMap<QString, QStringList> m_profiles;  ///< factory name -> profiles
+    QSet<QString> m_hardware;
+    QSet<QString> m_failed;
+};
+
+#endif // GStreamerDecoderProbe_H
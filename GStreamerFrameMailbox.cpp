@@ -0,0 +1,128 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerFrameMailbox.h"
+#include "GStreamerFramePacer.h"
+
+// How long the streaming thread waits for the renderer before it lets the next frame through
+static const unsigned long MaxRenderWaitMs = 100;
+
+QMutex GStreamerFrameMailbox::s_mutex;
+QHash<GstElement*, GStreamerFrameMailbox::Slot*> GStreamerFrameMailbox::s_slots;
+
+GStreamerFrameMailbox::Slot* GStreamerFrameMailbox::slot(GstElement *sink)
+{
+    Slot *result = s_slots.value(sink);
+    if (!result)
+    {
+        result = new Slot;
+        s_slots.insert(sink, result);
+    }
+    return result;
+}
+
+GstElement* GStreamerFrameMailbox::createQueue()
+{
+    GstElement *queue = gst_element_factory_make("queue", "framemailbox");
+    g_object_set(queue, "max-size-buffers", 1, "max-size-bytes", 0, "max-size-time", (guint64)0,
+                 "leaky", 2 /* downstream, drop the oldest */, NULL);
+    g_signal_connect(queue, "overrun", G_CALLBACK(&GStreamerFrameMailbox::onQueueOverrun), NULL);
+    return queue;
+}
+
+void GStreamerFrameMailbox::attachSink(GstElement *sink)
+{
+    Slot *sinkSlot;
+    {
+        QMutexLocker locker(&s_mutex);
+        sinkSlot = slot(sink);
+    }
+
+    GstPad *pad = gst_element_get_static_pad(sink, "sink");
+    if (pad)
+    {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerFrameMailbox::sinkBufferProbe, sinkSlot, NULL);
+        gst_object_unref(pad);
+    }
+}
+
+void GStreamerFrameMailbox::frameRendered(void *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value((GstElement*)sink);
+    if (sinkSlot)
+    {
+        sinkSlot->inFlight = false;
+        sinkSlot->rendered.wakeAll();
+    }
+}
+
+int GStreamerFrameMailbox::droppedFrames(GstElement *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value(sink);
+    return sinkSlot ? sinkSlot->dropped.load() : 0;
+}
+
+void GStreamerFrameMailbox::resetDroppedFrames(GstElement *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value(sink);
+    if (sinkSlot) sinkSlot->dropped = 0;
+}
+
+// Runs on the mailbox queue's streaming thread
+GstPadProbeReturn GStreamerFrameMailbox::sinkBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Slot *sinkSlot = static_cast<Slot*>(userData);
+
+    QMutexLocker locker(&s_mutex);
+    if (sinkSlot->inFlight)
+    {
+        sinkSlot->rendered.wait(&s_mutex, MaxRenderWaitMs);
+    }
+    sinkSlot->inFlight = true;
+    locker.unlock();
+
+    // Held here until its vsync in PaceSmooth, the leaky queue keeps taking newer frames meanwhile
+    GStreamerFramePacer::pace(GST_ELEMENT(GST_PAD_PARENT(pad)), GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+// Emitted by the leaky queue when a new frame pushes out the one waiting in the slot.
+// The queue may be moved in front of another sink (standby switch), so the
+// slot is looked up from whatever it is linked to right now.
+void GStreamerFrameMailbox::onQueueOverrun(GstElement *queue, gpointer userData)
+{
+    Q_UNUSED(userData);
+
+    GstPad *src = gst_element_get_static_pad(queue, "src");
+    GstPad *peer = src ? gst_pad_get_peer(src) : NULL;
+    GstElement *sink = peer ? gst_pad_get_parent_element(peer) : NULL;
+
+    if (sink)
+    {
+        QMutexLocker locker(&s_mutex);
+        Slot *sinkSlot = s_slots.value(sink);
+        if (sinkSlot) sinkSlot->dropped.ref();
+    }
+
+    if (sink) gst_object_unref(sink);
+    if (peer) gst_object_unref(peer);
+    if (src) gst_object_unref(src);
+}
@@ -0,0 +1,76 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerFrameMailbox_H
+#define GStreamerFrameMailbox_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QHash>
+#include <gst/gst.h>
+
+/**
+ * @brief Single slot "latest frame wins" hand-over between decoder and renderer
+ *
+ * The slot is a leaky queue holding one buffer in front of the video sink.
+ * A probe on the sink pad lets the next frame in only once update_node() has
+ * drawn the previous one (or after a short timeout, so a hidden window never
+ * stalls the pipeline). While the renderer is behind, the queue keeps
+ * replacing its buffer with the newest decoded frame, so the scene graph is
+ * never more than one frame behind the decoder.
+ *
+ * Every video sink has its own slot, so concurrent streams do not wait on
+ * each other's renderer. GStreamerFramePacer may hold the frame let in until
+ * the vsync it belongs to.
+ */
+class GStreamerFrameMailbox
+{
+public:
+    /** @brief Create the mailbox queue element, the caller adds it before the sink */
+    static GstElement* createQueue();
+    /** @brief Install the hand-over probe on the video sink, once per sink */
+    static void attachSink(GstElement *sink);
+
+    /** @brief Called from the render thread by update_node() with the sink that was drawn */
+    static void frameRendered(void *sink);
+
+    /** @brief Frames replaced in the sink's slot before they were rendered */
+    static int droppedFrames(GstElement *sink);
+    static void resetDroppedFrames(GstElement *sink);
+
+private:
+    struct Slot
+    {
+        Slot() : inFlight(false) {}
+        QWaitCondition rendered;
+        bool inFlight;          ///< A frame was handed to the sink and not yet drawn
+        QAtomicInt dropped;
+    };
+
+    /** @brief The sink's slot, created on first use. Call with s_mutex held */
+    static Slot* slot(GstElement *sink);
+
+    static GstPadProbeReturn sinkBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+    static void onQueueOverrun(GstElement *queue, gpointer userData);
+
+    static QMutex s_mutex;
+    static QHash<GstElement*, Slot*> s_slots;   ///< Sinks live as long as the application, slots are never freed
+};
+
+#endif // GStreamerFrameMailbox_H
@@ -0,0 +1,213 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerFramePacer.h"
+#include <QQuickWindow>
+#include <QScreen>
+#include <math.h>
+
+QMutex GStreamerFramePacer::s_mutex;
+QHash<GstElement*, GStreamerFramePacer::Slot*> GStreamerFramePacer::s_slots;
+gint64 GStreamerFramePacer::s_lastSwapUs = 0;
+double GStreamerFramePacer::s_periodUs = 0;
+
+GStreamerFramePacer::GStreamerFramePacer(QQuickWindow *window)
+    : QObject(window)
+{
+    double hz = window->screen() ? window->screen()->refreshRate() : 0;
+    if (hz < 10 || hz > 500) hz = DefaultRefreshHz;
+    {
+        QMutexLocker locker(&s_mutex);
+        s_periodUs = 1000000.0 / hz;
+    }
+    // Emitted on the render thread right after the swap, which returns at the vsync
+    connect(window, SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()), Qt::DirectConnection);
+}
+
+void GStreamerFramePacer::watchWindow(QQuickWindow *window)
+{
+    static GStreamerFramePacer *watcher = NULL;
+    if (!watcher && window) watcher = new GStreamerFramePacer(window);
+}
+
+GStreamerFramePacer::Slot* GStreamerFramePacer::slot(GstElement *sink)
+{
+    Slot *result = s_slots.value(sink);
+    if (!result)
+    {
+        result = new Slot;
+        s_slots.insert(sink, result);
+    }
+    return result;
+}
+
+gint64 GStreamerFramePacer::vsyncAfter(gint64 us)
+{
+    if (s_periodUs <= 0 || s_lastSwapUs == 0) return us;
+    return s_lastSwapUs + (gint64)(ceil((us - s_lastSwapUs) / s_periodUs) * s_periodUs);
+}
+
+void GStreamerFramePacer::setMode(GstElement *sink, int mode)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = slot(sink);
+    sinkSlot->mode = mode;
+    sinkSlot->anchored = false;
+}
+
+int GStreamerFramePacer::mode(GstElement *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value(sink);
+    return sinkSlot ? sinkSlot->mode : (int)PaceMinLatency;
+}
+
+double GStreamerFramePacer::refreshHz()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_periodUs > 0 ? 1000000.0 / s_periodUs : 0;
+}
+
+// Render thread
+void GStreamerFramePacer::onFrameSwapped()
+{
+    gint64 now = g_get_monotonic_time();
+    QMutexLocker locker(&s_mutex);
+    if (s_lastSwapUs != 0 && s_periodUs > 0)
+    {
+        // Only back to back swaps measure the refresh, the scene graph idles between changes
+        gint64 interval = now - s_lastSwapUs;
+        if (interval > s_periodUs / 2 && interval < s_periodUs * 3 / 2)
+        {
+            s_periodUs = s_periodUs * 0.95 + interval * 0.05;
+        }
+    }
+    s_lastSwapUs = now;
+}
+
+// Streaming thread, s_mutex is not held while the frame waits
+void GStreamerFramePacer::pace(GstElement *sink, GstBuffer *buffer)
+{
+    if (!GST_BUFFER_PTS_IS_VALID(buffer)) return;
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    gint64 releaseUs;
+    Slot *sinkSlot;
+    {
+        QMutexLocker locker(&s_mutex);
+        sinkSlot = slot(sink);
+        if (sinkSlot->mode != PaceSmooth || s_lastSwapUs == 0)
+        {
+            sinkSlot->anchored = false;
+            sinkSlot->releasedPts = pts;
+            return;
+        }
+
+        gint64 now = g_get_monotonic_time();
+        gint64 period = (gint64)s_periodUs;
+        gint64 target = 0;
+        if (sinkSlot->anchored && (pts <= sinkSlot->lastPts || pts - sinkSlot->lastPts > GST_SECOND))
+        {
+            // New pipeline, seek or a gap in the stream
+            sinkSlot->anchored = false;
+        }
+        if (sinkSlot->anchored)
+        {
+            gint64 ideal = sinkSlot->anchorUs + (gint64)((pts - sinkSlot->anchorPts) / GST_USECOND);
+            target = vsyncAfter(ideal - period / 2);
+            // Never two frames on one vsync, the first would not be seen
+            if (target <= sinkSlot->lastTargetUs) target = sinkSlot->lastTargetUs + period;
+
+            gint64 slack = target - ReleaseMarginUs - now;
+            if (slack < 0)
+            {
+                sinkSlot->stats.lateFrames++;
+                sinkSlot->anchored = false;
+            }
+            else if (slack > MaxHoldUs)
+            {
+                sinkSlot->anchored = false;
+            }
+            else
+            {
+                sinkSlot->minSlackUs = qMin(sinkSlot->minSlackUs, slack);
+                if (++sinkSlot->slackFrames >= SlackWindowFrames)
+                {
+                    // A whole refresh to spare on every frame is latency nobody needs
+                    if (sinkSlot->minSlackUs > period) sinkSlot->anchorUs -= period;
+                    sinkSlot->minSlackUs = MaxHoldUs;
+                    sinkSlot->slackFrames = 0;
+                }
+            }
+        }
+        if (!sinkSlot->anchored)
+        {
+            target = vsyncAfter(now + ReleaseMarginUs);
+            sinkSlot->anchored = true;
+            sinkSlot->anchorUs = target;
+            sinkSlot->anchorPts = pts;
+            sinkSlot->minSlackUs = MaxHoldUs;
+            sinkSlot->slackFrames = 0;
+        }
+        sinkSlot->lastTargetUs = target;
+        sinkSlot->lastPts = pts;
+        releaseUs = target - ReleaseMarginUs;
+    }
+
+    gint64 wait = releaseUs - g_get_monotonic_time();
+    if (wait > 0) g_usleep(wait);
+
+    // Only now, a redraw while the frame waited must not count it as shown
+    QMutexLocker locker(&s_mutex);
+    sinkSlot->releasedPts = pts;
+}
+
+// Render thread
+void GStreamerFramePacer::frameRendered(void *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value((GstElement*)sink);
+    if (!sinkSlot || !GST_CLOCK_TIME_IS_VALID(sinkSlot->releasedPts)) return;
+
+    GstClockTime pts = sinkSlot->releasedPts;
+    if (pts == sinkSlot->shownPts) return;   // Redrawn for a resize or the HUD
+
+    gint64 shown = vsyncAfter(g_get_monotonic_time());
+    if (GST_CLOCK_TIME_IS_VALID(sinkSlot->shownPts) && pts > sinkSlot->shownPts
+            && pts - sinkSlot->shownPts < GST_SECOND)
+    {
+        double error = (shown - sinkSlot->shownUs) - (double)(pts - sinkSlot->shownPts) / GST_USECOND;
+        sinkSlot->errorSumUs2 += error * error;
+        sinkSlot->stats.frames++;
+        if (fabs(error) > s_periodUs / 2) sinkSlot->stats.cadenceErrors++;
+    }
+    sinkSlot->shownUs = shown;
+    sinkSlot->shownPts = pts;
+}
+
+GStreamerFramePacer::Stats GStreamerFramePacer::takeStats(GstElement *sink)
+{
+    QMutexLocker locker(&s_mutex);
+    Slot *sinkSlot = s_slots.value(sink);
+    if (!sinkSlot) return Stats();
+
+    Stats result = sinkSlot->stats;
+    result.judderMs = result.frames > 0 ? sqrt(sinkSlot->errorSumUs2 / result.frames) / 1000.0 : 0;
+    sinkSlot->stats = Stats();
+    sinkSlot->errorSumUs2 = 0;
+    return result;
+}
@@ -0,0 +1,133 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerFramePacer_H
+#define GStreamerFramePacer_H
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <gst/gst.h>
+
+class QQuickWindow;
+
+/**
+ * @brief Assigns decoded frames to display refreshes
+ *
+ * The video sinks run with sync=false, so a frame is drawn on whatever vsync
+ * follows its decoding and 25/30 fps video on a 60 Hz display shows the
+ * network and decoder jitter as uneven cadence and double frames. The
+ * window's frameSwapped() gives the vsync phase and, averaged over back to
+ * back swaps, the refresh period.
+ *
+ * PaceMinLatency hands each frame on as soon as the mailbox lets it in.
+ * PaceSmooth places frame n on the vsync nearest anchor + (pts(n) - pts(0))
+ * and holds it in the mailbox probe until just before that vsync. The anchor
+ * is taken again when a frame misses its vsync or the timestamps jump, and
+ * moved one refresh earlier when every frame of a window had that much slack,
+ * so the camera's clock drifting against ours never builds up latency.
+ *
+ * update_node() reports each drawn frame; the gap between the vsyncs two
+ * frames were shown on against their timestamp gap gives the judder, and
+ * gaps off by more than half a refresh count as cadence errors (a frame
+ * shown one vsync too long or too short).
+ */
+class GStreamerFramePacer : public QObject
+{
+    Q_OBJECT
+public:
+    enum PacingMode {
+        PaceMinLatency = 0,
+        PaceSmooth
+    };
+
+    enum {
+        ReleaseMarginUs = 6000,     ///< A held frame goes this long before its vsync, for the GUI and render threads
+        MaxHoldUs = 100000,         ///< Never hold longer, the anchor is taken again
+        SlackWindowFrames = 60,
+        DefaultRefreshHz = 60
+    };
+
+    struct Stats
+    {
+        Stats() : judderMs(0), cadenceErrors(0), lateFrames(0), frames(0) {}
+        double judderMs;            ///< RMS of displayed minus timestamp frame intervals
+        int cadenceErrors;
+        int lateFrames;             ///< PaceSmooth frames that missed their vsync
+        int frames;
+    };
+
+    /** @brief Measure the refresh of the window the video is drawn in, one window per application */
+    static void watchWindow(QQuickWindow *window);
+
+    static void setMode(GstElement *sink, int mode);
+    static int mode(GstElement *sink);
+
+    /** @brief Called by the frame mailbox probe on the streaming thread, may sleep until the frame's vsync */
+    static void pace(GstElement *sink, GstBuffer *buffer);
+    /** @brief Called from the render thread by update_node() with the sink that was drawn */
+    static void frameRendered(void *sink);
+
+    /** @brief Statistics since the last call, then resets them */
+    static Stats takeStats(GstElement *sink);
+    /** @brief Display refresh, from the screen and then measured, 0 before watchWindow() */
+    static double refreshHz();
+
+private Q_SLOTS:
+    void onFrameSwapped();
+
+private:
+    explicit GStreamerFramePacer(QQuickWindow *window);
+
+    struct Slot
+    {
+        Slot() : mode(PaceMinLatency), anchored(false), anchorUs(0), anchorPts(0), lastTargetUs(0), lastPts(0),
+            minSlackUs(0), slackFrames(0), releasedPts(GST_CLOCK_TIME_NONE), shownUs(0), shownPts(GST_CLOCK_TIME_NONE),
+            errorSumUs2(0) {}
+        int mode;
+
+        // Streaming thread
+        bool anchored;
+        gint64 anchorUs;
+        GstClockTime anchorPts;
+        gint64 lastTargetUs;
+        GstClockTime lastPts;
+        gint64 minSlackUs;
+        int slackFrames;
+
+        GstClockTime releasedPts;   ///< Of the frame handed to the sink, read by the render thread
+
+        // Render thread
+        gint64 shownUs;
+        GstClockTime shownPts;
+        double errorSumUs2;
+        Stats stats;
+    };
+
+    /** @brief The sink's slot, created on first use. Call with s_mutex held */
+    static Slot* slot(GstElement *sink);
+    /** @brief First vsync at or after the given time. Call with s_mutex held */
+    static gint64 vsyncAfter(gint64 us);
+
+    static QMutex s_mutex;
+    static QHash<GstElement*, Slot*> s_slots;   ///< Sinks live as long as the application, slots are never freed
+    static gint64 s_lastSwapUs;
+    static double s_periodUs;                   ///< 0 until measured or read from the screen
+};
+
+#endif // GStreamerFramePacer_H
@@ -0,0 +1,272 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerPipelineBuilder.h"
+#include "GStreamerFrameMailbox.h"
+#include <QDebug>
+#include <QGst/ElementFactory>
+#include <QGlib/Error>
+#include <QGst/Caps>
+#include <QGst/Pad>
+#include <gst/gst.h>
+
+GStreamerPipelineBuilder::GStreamerPipelineBuilder(QObject *parent)
+    : QThread(parent),
+      m_sync(false)
+{
+}
+
+GStreamerPipelineBuilder::~GStreamerPipelineBuilder()
+{
+    wait();
+}
+
+void GStreamerPipelineBuilder::setup(const QGst::PipelinePtr & oldPipeline, const QGst::ElementPtr & videoSink,
+                                     const QString & pipelineString, const QStringList & capsList, bool sync)
+{
+    m_oldPipeline = oldPipeline;
+    m_videoSink = videoSink;
+    m_pipelineString = pipelineString;
+    m_capsList = capsList;
+    m_sync = sync;
+
+    m_pipeline.clear();
+    m_tailElement.clear();
+    m_recordingTee.clear();
+    m_depayloaderName = "";
+    m_linkedCaps = "";
+    m_errorString = "";
+}
+
+QGst::PipelinePtr GStreamerPipelineBuilder::takePipeline()
+{
+    QGst::PipelinePtr pipeline = m_pipeline;
+    m_pipeline.clear();
+    return pipeline;
+}
+
+void GStreamerPipelineBuilder::run()
+{
+    // Teardown of the previous pipeline, the video sink is reused if it was part of it
+    if (!m_oldPipeline.isNull())
+    {
+        m_oldPipeline->setState(QGst::StateNull);
+        QByteArray sinkName = m_videoSink->name().toUtf8();
+        if (!m_oldPipeline->getElementByName(sinkName.constData()).isNull())
+        {
+            m_oldPipeline->remove(m_videoSink);
+        }
+        m_oldPipeline.clear();
+    }
+
+    QByteArray data = m_pipelineString.toUtf8();
+    const char *pData = data.constData();
+
+    QGst::PipelinePtr pipeline;
+    try
+    {
+        pipeline = QGst::ElementFactory::parseLaunch(pData).dynamicCast<QGst::Pipeline>();
+    }
+    catch (const QGlib::Error & error)
+    {
+        qCritical() << error;
+    }
+
+    if (pipeline.isNull())
+    {
+        m_errorString = "Failed to create the pipeline '" + m_pipelineString + "'!";
+        return;
+    }
+
+    QGst::PadPtr src = pipeline->findUnlinkedPad(QGst::PadSrc);
+    if (src.isNull())
+    {
+        m_errorString = "The Pipeline command string has no unlinked video source element, cannot link pipeline. String = " + m_pipelineString;
+        return;
+    }
+
+    m_videoSink->setProperty("sync", m_sync);
+    pipeline->add(m_videoSink);
+
+    // Frames reach the sink through a one slot mailbox, see GStreamerFrameMailbox
+    GstElement *queue = GStreamerFrameMailbox::createQueue();
+    gst_object_ref_sink(queue);
+    QGst::ElementPtr mailbox = QGst::ElementPtr::wrap(queue, false);
+    pipeline->add(mailbox);
+
+    // videoscale in front of the mailbox, passthrough until GStreamerPlayer
+    // narrows the caps of the filter behind it. It only scales system
+    // memory frames, GL and EGL ones go through untouched
+    QGst::ElementPtr head = src->parentElement();
+    QGst::ElementPtr scale = QGst::ElementFactory::make("videoscale", "downscale");
+    QGst::ElementPtr scaleFilter = QGst::ElementFactory::make("capsfilter", scaleFilterName());
+    if (!scale.isNull() && !scaleFilter.isNull())
+    {
+        pipeline->add(scale);
+        pipeline->add(scaleFilter);
+        if (head->link(scale) && scale->link(scaleFilter))
+        {
+            head = scaleFilter;
+        }
+        else
+        {
+            pipeline->remove(scale);
+            pipeline->remove(scaleFilter);
+        }
+    }
+    head->link(mailbox);
+
+    m_tailElement = mailbox;
+    if (!linkVideoSink(src->parentElement()))
+    {
+        m_errorString = "Unable to link the video sink to the pipeline. String = " + m_pipelineString;
+        pipeline->remove(m_videoSink);
+        m_tailElement.clear();
+        return;
+    }
+
+    insertRecordingTee(pipeline);
+    connectFecStorage(pipeline);
+
+    // Bring the pipeline to READY here as well, this is where elements open
+    // devices and sockets
+    pipeline->setState(QGst::StateReady);
+    m_pipeline = pipeline;
+}
+
+/**
+ * Splice a tee between the RTP depayloader and whatever follows it, so the
+ * still compressed stream can be muxed to file without re-encoding. The
+ * display branch is linked straight to the tee, only the recording branch
+ * gets a queue, so this adds no latency to the display path.
+ */
+void GStreamerPipelineBuilder::insertRecordingTee(const QGst::PipelinePtr & pipeline)
+{
+    GstElement *depay = NULL;
+
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (depay == NULL && gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(element);
+        const gchar *klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : NULL;
+        if (klass && g_strstr_len(klass, -1, "Depayloader"))
+        {
+            depay = GST_ELEMENT(gst_object_ref(element));
+            m_depayloaderName = GST_OBJECT_NAME(factory);
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    if (depay == NULL) return;
+
+    GstPad *src = gst_element_get_static_pad(depay, "src");
+    GstPad *peer = src ? gst_pad_get_peer(src) : NULL;
+    if (peer != NULL)
+    {
+        GstElement *tee = gst_element_factory_make("tee", "recordtee");
+        gst_bin_add(GST_BIN(GST_ELEMENT_PARENT(depay)), tee);
+
+        gst_pad_unlink(src, peer);
+        GstPad *teeSink = gst_element_get_static_pad(tee, "sink");
+        GstPad *teeSrc = gst_element_get_request_pad(tee, "src_%u");
+        if (gst_pad_link(src, teeSink) == GST_PAD_LINK_OK && gst_pad_link(teeSrc, peer) == GST_PAD_LINK_OK)
+        {
+            m_recordingTee = QGst::ElementPtr::wrap(tee);
+        }
+        else
+        {
+            // Put things back the way they were
+            qCritical() << "Unable to insert recording tee after" << m_depayloaderName;
+            gst_pad_unlink(src, teeSink);
+            gst_pad_unlink(teeSrc, peer);
+            gst_element_release_request_pad(tee, teeSrc);
+            gst_bin_remove(GST_BIN(GST_ELEMENT_PARENT(depay)), tee);
+            gst_pad_link(src, peer);
+        }
+        gst_object_unref(teeSink);
+        gst_object_unref(teeSrc);
+        gst_object_unref(peer);
+    }
+
+    if (src) gst_object_unref(src);
+    gst_object_unref(depay);
+}
+
+/**
+ * rtpulpfecdec rebuilds lost packets from the ones an rtpstorage ahead of
+ * it keeps, but the storage is an object property a pipeline string cannot
+ * set. Hand each decoder the storage of the first rtpstorage.
+ */
+void GStreamerPipelineBuilder::connectFecStorage(const QGst::PipelinePtr & pipeline)
+{
+    GObject *storage = NULL;
+    QList<GstElement*> decoders;
+
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(element);
+        if (factory && storage == NULL && g_strcmp0(GST_OBJECT_NAME(factory), "rtpstorage") == 0)
+        {
+            g_object_get(element, "internal-storage", &storage, NULL);
+        }
+        else if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "rtpulpfecdec") == 0)
+        {
+            decoders << GST_ELEMENT(gst_object_ref(element));
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    Q_FOREACH(GstElement *decoder, decoders)
+    {
+        if (storage != NULL)
+        {
+            g_object_set(decoder, "storage", storage, NULL);
+        }
+        else
+        {
+            qWarning() << "rtpulpfecdec without an rtpstorage ahead of it cannot recover packets";
+        }
+        gst_object_unref(decoder);
+    }
+    if (storage != NULL) g_object_unref(storage);
+}
+
+// element carries the caps property, the sink is linked behind the mailbox (m_tailElement)
+bool GStreamerPipelineBuilder::linkVideoSink(const QGst::ElementPtr & element)
+{
+    Q_FOREACH(const QString & caps, m_capsList)
+    {
+        element->setProperty("caps", QGst::Caps::fromString(caps));
+        if (m_tailElement->link(m_videoSink))
+        {
+            qDebug() << "Video sink linked with caps" << caps;
+            m_linkedCaps = caps;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerPipelineBuilder_H
+#define GStreamerPipelineBuilder_H
+
+#include <QThread>
+#include <QStringList>
+#include <QGst/Pipeline>
+#include <QGst/Element>
+
+/**
+ * @brief Builds (and tears down) a GStreamer pipeline on a worker thread
+ *
+ * parseLaunch, element probing and setting the previous pipeline to NULL can
+ * block for hundreds of milliseconds with network sources. The builder does
+ * all of that off the UI thread; GStreamerPlayer picks the result up from the
+ * finished() signal. The setters and getters must only be used while the
+ * thread is not running.
+ */
+class GStreamerPipelineBuilder : public QThread
+{
+    Q_OBJECT
+public:
+    explicit GStreamerPipelineBuilder(QObject *parent = 0);
+    ~GStreamerPipelineBuilder();
+
+    /** @brief Prepare a build. oldPipeline is stopped and released on the worker */
+    void setup(const QGst::PipelinePtr & oldPipeline, const QGst::ElementPtr & videoSink,
+               const QString & pipelineString, const QStringList & capsList, bool sync);
+
+    /** @brief The pipeline built by the last run, NULL on failure */
+    QGst::PipelinePtr takePipeline();
+    /** @brief The element the video sink was linked to */
+    QGst::ElementPtr tailElement() const { return m_tailElement; }
+    /** @brief Tee inserted after the RTP depayloader for pass-through recording, NULL if none */
+    QGst::ElementPtr recordingTee() const { return m_recordingTee; }
+    /** @brief Factory name of the depayloader the tee follows, e.g. rtph264depay */
+    QString depayloaderName() const { return m_depayloaderName; }
+    /** @brief The caps the video sink was linked with */
+    QString linkedCaps() const { return m_linkedCaps; }
+    /** @brief Name of the capsfilter that limits the frame size, see GStreamerPlayer::setDisplaySize */
+    static const char *scaleFilterName() { return "downscalecaps"; }
+    /** @brief Why the last build failed */
+    QString errorString() const { return m_errorString; }
+
+protected:
+    void run();
+
+private:
+    bool linkVideoSink(const QGst::ElementPtr & element);
+    void insertRecordingTee(const QGst::PipelinePtr & pipeline);
+    void connectFecStorage(const QGst::PipelinePtr & pipeline);
+
+    QGst::PipelinePtr m_oldPipeline;
+    QGst::PipelinePtr m_pipeline;
+    QGst::ElementPtr m_videoSink;
+    QGst::ElementPtr m_tailElement;
+    QGst::ElementPtr m_recordingTee;
+    QString m_depayloaderName;
+    QString m_pipelineString;
+    QStringList m_capsList;
+    bool m_sync;
+
+    QString m_linkedCaps;
+    QString m_errorString;
+};
+
+#endif // GStreamerPipelineBuilder_H
@@ -18,16 +18,111 @@
  */
 #include "GStreamerPlayer.h"
 #include <QUrl>
+#include <QRegExp>
 #include <QDebug>
 #include <QGlib/Connect>
 #include <QGlib/Error>
 #include <QGst/ElementFactory>
+#include <QGst/Caps>
 #include <QGst/Bus>
 #include <QGst/Pad>
 #include <QGst/Event>
+#include <gst/video/video.h>
 #include <QtQuick/QQuickView>
-#include <QDialog>
-#include "PrimaryFlightDisplayQML.h"
+#include "GStreamerFrameMailbox.h"
+#include "GStreamerFramePacer.h"
+#include "GStreamerDecoderProbe.h"
+#include "ThreadRoles.h"
+#include "TraceMarkers.h"
+
+// Caps tried, in order, when zero-copy is enabled. GL/EGL memory lets a hardware
+// decoder (androidmedia) hand its output texture straight to the sink, plain
+// video/x-raw at least lets the decoder pick a format the sink draws natively
+// without a videoconvert pass.
+static const char * const ZeroCopyCaps[] = {
+    "video/x-raw(memory:GLMemory)",
+    "video/x-raw(memory:EGLImage)",
+    "video/x-raw",
+    NULL
+};
+
+// System memory fallback, always negotiates with qt5videosink
+static const char * const FallbackCaps = "video/x-raw, format=I420";
+
+// Frame dimensions a scaled stream is rounded up to, see setDisplaySize()
+static const int SizeSteps[] = { 180, 240, 360, 480, 720, 1080, 0 };
+
+// Latency profiles: properties appended to matching elements of the user's
+// pipeline string. A property the user already typed is never overridden.
+struct LatencyProfile
+{
+    const char *name;
+    const char *jitterBuffer;   ///< rtpjitterbuffer and rtspsrc
+    const char *srt;            ///< srtsrc, its latency bounds the retransmissions
+    const char *queue;
+    const char *decoder;        ///< avdec_*
+    bool sync;                  ///< video sink sync property
+};
+
+static const LatencyProfile LatencyProfiles[] = {
+    { "ultra-low", "latency=30 drop-on-latency=true", "latency=80",
+      "leaky=downstream max-size-buffers=1 max-size-bytes=0 max-size-time=0",
+      "max-threads=1", false },
+    { "balanced", "latency=120 drop-on-latency=true", "latency=200",
+      "leaky=downstream max-size-buffers=3 max-size-bytes=0 max-size-time=0",
+      "max-threads=2", false },
+    { "robust", "latency=400", "latency=500",
+      "max-size-buffers=30 max-size-bytes=0 max-size-time=0",
+      "", true },
+    { NULL, NULL, NULL, NULL, NULL, false }
+};
+
+static const char * const CustomLatencyProfile = "custom";
+
+// Sources that recover lost packets, %1 is the sender's address. The
+// decoder is substituted as for any other pipeline string
+struct SourcePreset
+{
+    const char *name;
+    const char *pipeline;
+};
+
+static const SourcePreset SourcePresets[] = {
+    // SRT retransmits what is lost within its latency, MPEG-TS inside
+    { "srt-caller", "srtsrc uri=\"srt://%1:5600?mode=caller\" ! tsdemux ! h264parse ! queue ! avdec_h264" },
+    { "srt-listener", "srtsrc uri=\"srt://:5600?mode=listener\" ! tsdemux ! h264parse ! queue ! avdec_h264" },
+    // RTP with ULPFEC (payload 122) from rtpulpfecenc, the builder hands the storage to the decoder
+    { "rtp-ulpfec", "udpsrc port=5600 buffer-size=200000 caps=\"application/x-rtp, media=video, clock-rate=90000, "
+                    "encoding-name=H264, payload=96\" ! rtpstorage size-time=250000000 ! rtpjitterbuffer latency=150 "
+                    "do-lost=true ! rtpulpfecdec pt=122 ! rtph264depay ! h264parse ! queue ! avdec_h264" },
+    // RIST simple profile, RTP with NACK based retransmission
+    { "rist", "ristsrc address=0.0.0.0 port=5004 encoding-name=H264 ! rtph264depay ! h264parse ! queue ! avdec_h264" },
+    { NULL, NULL }
+};
+
+static const LatencyProfile * findLatencyProfile(const QString & name)
+{
+    for (int i = 0; LatencyProfiles[i].name != NULL; i++)
+    {
+        if (name == LatencyProfiles[i].name) return &LatencyProfiles[i];
+    }
+    return NULL;
+}
+
+// Append each "key=value" of props to element unless the key is already set
+static QString appendMissingProperties(const QString & element, const char *props)
+{
+    QString result = element.trimmed();
+    Q_FOREACH(const QString & prop, QString(props).split(' ', QString::SkipEmptyParts))
+    {
+        QString key = prop.section('=', 0, 0);
+        if (!result.contains(QRegExp("(^|\\s)" + QRegExp::escape(key) + "\\s*=")))
+        {
+            result += " " + prop;
+        }
+    }
+    return result;
+}
 
 GStreamerPlayer::GStreamerPlayer(QObject *parent)
     : QObject(parent)
@@ -35,110 +130,1469 @@ GStreamerPlayer::GStreamerPlayer(QObject *parent)
     m_playing = false;
     m_stopped = true;
     m_paused = false;
+    m_brightness = 0;
+    m_contrast = 0;
+    m_hue = 0;
+    m_saturation = 0;
+    m_zeroCopy = true;
+    m_zeroCopyFailed = false;
+    m_latencyProfile = CustomLatencyProfile;
+    m_targetState = QGst::StateNull;
+    m_suspendMode = SuspendPaused;
+    m_suspended = false;
+    m_decodePriority = 0;
+    m_degradeLevel = DegradeNone;
+    m_hidden = false;
+    m_hiddenMode = HiddenDropAll;
+    m_framePacing = GStreamerFramePacer::PaceMinLatency;
+    m_decodeGate = GateOpen;
+    m_degradeFrames = 0;
+    m_maxFps = 0;
+    m_maxFpsLastPts = GST_CLOCK_TIME_NONE;
+    m_autoDecoder = true;
+    m_stopTimeout = 5000;
+    m_autoKeyFrame = true;
+    m_lowMemory = false;
+    m_adaptiveSize = true;
+    m_maxVideoHeight = 0;
+    m_minPoolBuffers = 4;
+    m_maxPoolBuffers = 8;
+    m_adaptiveJitter = false;
+    m_minJitterLatency = 30;
+    m_maxJitterLatency = 500;
+    m_jitterLatency = 0;
+    m_jitterCleanSamples = 0;
+    m_jitterLate = 0;
+    m_keyFrameRequests = 0;
+    m_watchdogLost = 0;
+    m_stallTimeoutMs = DefaultStallTimeoutMs;
+    m_stalled = false;
+    m_stallRestarts = 0;
+    m_nextRestartMs = 0;
+    m_sourceRestarts = 0;
+    m_bufferClock.start();
+    m_lastBufferMs = 0;
+
+    m_stallTimer.start(StallCheckMs);
+    connect(&m_stallTimer, SIGNAL(timeout()), this, SLOT(checkStall()));
+
+    m_stopTimer.setSingleShot(true);
+    connect(&m_stopTimer, SIGNAL(timeout()), this, SLOT(onStopTimer()));
+
+    m_standbyReady = false;
+    m_switchPending = false;
+    m_stats = new GStreamerStats(this);
+    m_recorder = new GStreamerRecorder(this);
+    m_restreamer = new GStreamerRestreamer(this);
+    m_snapshot = new GStreamerSnapshot(this);
+    connect(m_stats, SIGNAL(statsChanged()), this, SLOT(checkDecodeHealth()));
+    connect(m_stats, SIGNAL(statsChanged()), this, SLOT(adaptJitterLatency()));
+    connect(m_restreamer, SIGNAL(keyFrameNeeded()), this, SLOT(requestKeyFrame()));
+
+    connect(&m_builder, SIGNAL(finished()), this, SLOT(onPipelineBuilt()));
+    connect(&m_standbyBuilder, SIGNAL(finished()), this, SLOT(onStandbyBuilt()));
+}
+
+GStreamerPlayer::~GStreamerPlayer()
+{
+    m_builder.wait();
+    m_standbyBuilder.wait();
+    releaseStandby();
+    stop();
+}
+
+void GStreamerPlayer::setVideoSink(const QGst::ElementPtr & sink)
+{
+    m_videoSink = sink;
+    m_brightness = m_videoSink->property("brightness").toInt();
+    m_contrast = m_videoSink->property("contrast").toInt();
+    m_hue = m_videoSink->property("hue").toInt();
+    m_saturation = m_videoSink->property("saturation").toInt();
+    m_stats->setVideoSink(sink);
+    GStreamerFrameMailbox::attachSink((GstElement*)m_videoSink);
+    applyFramePacing();
+
+    // Seen after the sink answered, so its own pool can be bounded too
+    GstPad *pad = gst_element_get_static_pad((GstElement*)m_videoSink, "sink");
+    if (pad)
+    {
+        gst_pad_add_probe(pad, GstPadProbeType(GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM | GST_PAD_PROBE_TYPE_PULL),
+                          &GStreamerPlayer::onAllocationQuery, this, NULL);
+        // The stall watchdog's heartbeat, on the sink so a standby pipeline does not count
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerPlayer::onSinkBuffer, this, NULL);
+        gst_object_unref(pad);
+    }
+}
+
+bool GStreamerPlayer::play()
+{
+    m_targetState = QGst::StatePlaying;
+    // Connecting gets a whole stall timeout before the watchdog steps in
+    m_lastBufferMs = (int)m_bufferClock.elapsed();
+    initialize();
+
+    // Pipeline is being built, it is started from onPipelineBuilt()
+    if (m_builder.isRunning()) {
+        return true;
+    }
+
+    if (!m_pipeline.isNull()) {
+        m_pipeline->setState(QGst::StatePlaying);
+        return true;
+    }
+
+    return false;
+}
+
+void GStreamerPlayer::pause()
+{
+    m_targetState = QGst::StatePaused;
+    if (!m_pipeline.isNull()) {
+        m_pipeline->setState(QGst::StatePaused);
+    }
+}
+
+bool GStreamerPlayer::seek(qint64 positionNs, bool accurate, double rate)
+{
+    if (m_pipeline.isNull() || positionNs < 0 || rate <= 0) return false;
+
+    int flags = GST_SEEK_FLAG_FLUSH;
+    flags |= accurate ? GST_SEEK_FLAG_ACCURATE : (GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE);
+    return gst_element_seek(GST_ELEMENT((GstPipeline*)m_pipeline), rate, GST_FORMAT_TIME, GstSeekFlags(flags),
+                            GST_SEEK_TYPE_SET, positionNs, GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+}
+
+qint64 GStreamerPlayer::queryPosition()
+{
+    gint64 position = -1;
+    if (m_pipeline.isNull()
+            || !gst_element_query_position(GST_ELEMENT((GstPipeline*)m_pipeline), GST_FORMAT_TIME, &position))
+    {
+        return -1;
+    }
+    return position;
+}
+
+qint64 GStreamerPlayer::queryDuration()
+{
+    gint64 duration = -1;
+    if (m_pipeline.isNull()
+            || !gst_element_query_duration(GST_ELEMENT((GstPipeline*)m_pipeline), GST_FORMAT_TIME, &duration))
+    {
+        return -1;
+    }
+    return duration;
+}
+
+void GStreamerPlayer::stop()
+{
+    m_targetState = QGst::StateNull;
+    if (!m_pipeline.isNull()) {
+        m_pipeline->setState(QGst::StateNull);
+    }
+}
+
+/**
+ * Used when the application is sent to the background. Depending on the
+ * suspend mode the pipeline is kept constructed so resume() does not have to
+ * renegotiate caps and reopen the decoder.
+ */
+void GStreamerPlayer::suspend()
+{
+    if (m_suspended) return;
+    m_suspended = true;
+
+    switch (m_suspendMode)
+    {
+    case SuspendStop:
+        stop();
+        break;
+    case SuspendReady:
+        m_targetState = QGst::StateReady;
+        if (!m_pipeline.isNull()) {
+            m_pipeline->setState(QGst::StateReady);
+        }
+        break;
+    case SuspendPaused:
+        pause();
+        break;
+    }
+
+    if (!m_standbyPipeline.isNull()) {
+        m_standbyPipeline->setState(m_suspendMode == SuspendStop ? QGst::StateNull : QGst::StatePaused);
+    }
+}
+
+void GStreamerPlayer::resume()
+{
+    if (m_suspended && m_suspendMode == SuspendPaused && !m_pipeline.isNull()
+            && m_pipelineString == m_currentPipelineString)
+    {
+        // Drop whatever was queued before the suspend so the first frame shown is current
+        m_pipeline->sendEvent(QGst::FlushStartEvent::create());
+        m_pipeline->sendEvent(QGst::FlushStopEvent::create(true));
+    }
+    m_suspended = false;
+
+    if (!m_standbyPipeline.isNull()) {
+        m_standbyPipeline->setState(QGst::StatePlaying);
+    }
+
+    play();
+}
+
+QStringList GStreamerPlayer::getLatencyProfiles()
+{
+    QStringList profiles;
+    profiles << CustomLatencyProfile;
+    for (int i = 0; LatencyProfiles[i].name != NULL; i++)
+    {
+        profiles << LatencyProfiles[i].name;
+    }
+    return profiles;
+}
+
+QStringList GStreamerPlayer::getSourcePresets()
+{
+    QStringList presets;
+    for (int i = 0; SourcePresets[i].name != NULL; i++)
+    {
+        presets << SourcePresets[i].name;
+    }
+    return presets;
+}
+
+QString GStreamerPlayer::sourcePreset(const QString & name, const QString & host) const
+{
+    for (int i = 0; SourcePresets[i].name != NULL; i++)
+    {
+        if (name == SourcePresets[i].name)
+        {
+            QString pipeline = SourcePresets[i].pipeline;
+            if (!pipeline.contains("%1")) return pipeline;
+            return pipeline.arg(host.isEmpty() ? QString("127.0.0.1") : host);
+        }
+    }
+    return QString();
+}
+
+void GStreamerPlayer::setLatencyProfile(const QString & profile)
+{
+    if (profile != CustomLatencyProfile && findLatencyProfile(profile) == NULL)
+    {
+        qCritical() << "Unknown latency profile" << profile;
+        return;
+    }
+
+    if (m_latencyProfile != profile)
+    {
+        m_latencyProfile = profile;
+        emit latencyProfileChanged(m_latencyProfile);
+        applyFramePacing();
+
+        // Rebuild the pipeline with the new tuning on next play()
+        m_currentPipelineString = "";
+    }
+}
+
+void GStreamerPlayer::setFramePacing(int mode)
+{
+    mode = qBound((int)GStreamerFramePacer::PaceMinLatency, mode, (int)GStreamerFramePacer::PaceSmooth);
+    if (m_framePacing != mode)
+    {
+        m_framePacing = mode;
+        emit framePacingChanged(m_framePacing);
+        applyFramePacing();
+    }
+}
+
+void GStreamerPlayer::applyFramePacing()
+{
+    if (m_videoSink.isNull()) return;
+
+    // A sink with sync=true already waits for the frame's clock time, holding it twice only adds latency
+    const LatencyProfile *profile = findLatencyProfile(m_latencyProfile);
+    bool sinkSyncs = profile != NULL && profile->sync;
+    GStreamerFramePacer::setMode((GstElement*)m_videoSink, sinkSyncs ? (int)GStreamerFramePacer::PaceMinLatency : m_framePacing);
+}
+
+QString GStreamerPlayer::applyLatencyProfile(const QString & pipelineString) const
+{
+    const LatencyProfile *profile = findLatencyProfile(m_latencyProfile);
+    if (profile == NULL) return pipelineString;
+
+    QStringList elements = pipelineString.split('!');
+    for (int i = 0; i < elements.size(); i++)
+    {
+        QString factory = elements[i].trimmed().section(' ', 0, 0);
+        if (factory == "rtpjitterbuffer" || factory == "rtspsrc")
+        {
+            elements[i] = appendMissingProperties(elements[i], profile->jitterBuffer);
+        }
+        else if (factory == "srtsrc")
+        {
+            elements[i] = appendMissingProperties(elements[i], profile->srt);
+        }
+        else if (factory == "queue")
+        {
+            elements[i] = appendMissingProperties(elements[i], profile->queue);
+        }
+        else if (factory.startsWith("avdec_"))
+        {
+            elements[i] = appendMissingProperties(elements[i], profile->decoder);
+        }
+        else
+        {
+            elements[i] = elements[i].trimmed();
+        }
+    }
+    return elements.join(" ! ");
+}
+
+// Decoder substitution first, the latency profile then tunes whichever decoder was chosen
+QString GStreamerPlayer::tunePipelineString(const QString & pipelineString) const
+{
+    QString result = pipelineString;
+    if (m_autoDecoder)
+    {
+        result = GStreamerDecoderProbe::instance()->substituteDecoders(result);
+    }
+    return applyLatencyProfile(result);
+}
+
+void GStreamerPlayer::updateVideoDecoder()
+{
+    QString decoder;
+    if (!m_pipeline.isNull())
+    {
+        GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)m_pipeline));
+        GValue item = G_VALUE_INIT;
+        while (decoder.isEmpty() && gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+        {
+            GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(g_value_get_object(&item)));
+            if (factory && !GStreamerDecoderProbe::instance()->codecOf(GST_OBJECT_NAME(factory)).isEmpty())
+            {
+                decoder = GST_OBJECT_NAME(factory);
+            }
+            g_value_reset(&item);
+        }
+        g_value_unset(&item);
+        gst_iterator_free(it);
+    }
+
+    if (m_videoDecoder != decoder)
+    {
+        m_videoDecoder = decoder;
+        emit videoDecoderChanged(m_videoDecoder);
+    }
+}
+
+void GStreamerPlayer::toggleFullScreen()
+{
+}
+
+void GStreamerPlayer::initialize()
+{
+    // A build is in flight, the pipeline string is checked again once it is done
+    if (m_builder.isRunning()) {
+        return;
+    }
+
+    if (!m_pipelineString.isEmpty() && m_pipelineString != m_currentPipelineString)
+    {
+        m_currentPipelineString = "";
+        m_buildingPipelineString = m_pipelineString;
+
+        // Hand the old pipeline to the builder, it is set to NULL on the worker
+        QGst::PipelinePtr oldPipeline = m_pipeline;
+        m_recorder->setPipeline(QGst::PipelinePtr(), QGst::ElementPtr(), "");
+        m_restreamer->setPipeline(QGst::PipelinePtr(), QGst::ElementPtr(), "");
+        m_snapshot->setTailElement(QGst::ElementPtr());
+        m_pipeline.clear();
+        m_tailElement.clear();
+        m_recordingTee.clear();
+        if (!oldPipeline.isNull())
+        {
+            QGlib::disconnect(oldPipeline->bus(), "message", this, &GStreamerPlayer::onBusMessage);
+            oldPipeline->bus()->removeSignalWatch();
+        }
+
+        QString tunedString = tunePipelineString(m_pipelineString);
+        qDebug() << "Latency profile" << m_latencyProfile << "pipeline =" << tunedString;
+
+        const LatencyProfile *profile = findLatencyProfile(m_latencyProfile);
+        m_builder.setup(oldPipeline, m_videoSink, tunedString, videoCapsCandidates(),
+                        profile != NULL ? profile->sync : false);
+        m_builder.start(QThread::LowPriority);
+    }
+}
+
+void GStreamerPlayer::onPipelineBuilt()
+{
+    QGst::PipelinePtr pipeline = m_builder.takePipeline();
+    bool success = !pipeline.isNull();
+
+    if (success)
+    {
+        m_pipeline = pipeline;
+
+        //watch the bus for messages
+        QGst::BusPtr bus = m_pipeline->bus();
+        bus->addSignalWatch();
+        QGlib::connect(bus, "message", this, &GStreamerPlayer::onBusMessage);
+        watchStreamingThreads(bus);
+        m_currentPipelineString = m_buildingPipelineString;
+        m_tailElement = m_builder.tailElement();
+        m_recordingTee = m_builder.recordingTee();
+        m_depayloaderName = m_builder.depayloaderName();
+        m_stats->setPipeline(m_pipeline);
+        resetKeyFrameWatchdog();
+        m_lastBufferMs = (int)m_bufferClock.elapsed();
+        m_recorder->setPipeline(m_pipeline, m_recordingTee, m_depayloaderName);
+        m_restreamer->setPipeline(m_pipeline, m_recordingTee, m_depayloaderName);
+        installDegradeProbe(m_tailElement);
+        installDecodeGate(m_pipeline);
+        applyDegradeLevel(m_pipeline);
+        applyLowMemory(m_pipeline);
+        m_snapshot->setTailElement(m_tailElement);
+
+        m_videoCaps = m_builder.linkedCaps();
+        emit videoCapsChanged(m_videoCaps);
+        applySizeLimit(m_pipeline);
+        updateVideoDecoder();
+    }
+    else
+    {
+        emit messageBox(m_builder.errorString());
+    }
+
+    emit initialized(success);
+
+    // The pipeline string changed while we were building, start over
+    if (m_pipelineString != m_buildingPipelineString)
+    {
+        if (m_targetState != QGst::StateNull) play();
+        return;
+    }
+
+    if (success && m_targetState != QGst::StateNull)
+    {
+        m_pipeline->setState(m_targetState);
+    }
+    else if (!success)
+    {
+        m_playing = false;
+        emit playingChanged(m_playing);
+    }
+}
+
+void GStreamerPlayer::prepareStandby(const QString & pipelineString)
+{
+    if (m_standbyBuilder.isRunning() || pipelineString.isEmpty()) return;
+
+    QGst::PipelinePtr oldPipeline = m_standbyPipeline;
+    m_standbyPipeline.clear();
+    m_standbyTailElement.clear();
+    if (!oldPipeline.isNull())
+    {
+        QGlib::disconnect(oldPipeline->bus(), "message", this, &GStreamerPlayer::onStandbyBusMessage);
+        oldPipeline->bus()->removeSignalWatch();
+    }
+
+    m_standbyPipelineString = pipelineString;
+    m_standbyReady = false;
+    m_standbyFrameSeen = 0;
+    emit standbyChanged();
+
+    m_standbySink = QGst::ElementFactory::make("fakesink");
+    m_standbySink->setProperty("sync", false);
+    m_standbySink->setProperty("signal-handoffs", true);
+    QGlib::connect(m_standbySink, "handoff", this, &GStreamerPlayer::onStandbyHandoff);
+
+    // Use caps the real sink is known to accept, so the swap does not renegotiate
+    QStringList capsList;
+    capsList << (m_videoCaps.isEmpty() ? QString(FallbackCaps) : m_videoCaps);
+
+    m_standbyBuilder.setup(oldPipeline, m_standbySink, tunePipelineString(pipelineString), capsList, false);
+    m_standbyBuilder.start(QThread::LowPriority);
+}
+
+void GStreamerPlayer::onStandbyBuilt()
+{
+    QGst::PipelinePtr pipeline = m_standbyBuilder.takePipeline();
+    if (pipeline.isNull())
+    {
+        emit messageBox(m_standbyBuilder.errorString());
+        m_standbyPipelineString = "";
+        m_switchPending = false;
+        emit standbyChanged();
+        return;
+    }
+
+    m_standbyPipeline = pipeline;
+    m_standbyTailElement = m_standbyBuilder.tailElement();
+    m_standbyRecordingTee = m_standbyBuilder.recordingTee();
+    m_standbyDepayloaderName = m_standbyBuilder.depayloaderName();
+    installDegradeProbe(m_standbyTailElement);
+    installDecodeGate(m_standbyPipeline);
+    applyDegradeLevel(m_standbyPipeline);
+    applyLowMemory(m_standbyPipeline);
+    applySizeLimit(m_standbyPipeline);
+
+    QGst::BusPtr bus = m_standbyPipeline->bus();
+    bus->addSignalWatch();
+    QGlib::connect(bus, "message", this, &GStreamerPlayer::onStandbyBusMessage);
+    watchStreamingThreads(bus);
+
+    m_standbyPipeline->setState(m_suspended ? QGst::StatePaused : QGst::StatePlaying);
+}
+
+void GStreamerPlayer::switchToStandby()
+{
+    if (m_standbyPipelineString.isEmpty()) return;
+
+    if (m_standbyReady) swapPipelines();
+    else m_switchPending = true;
+}
+
+void GStreamerPlayer::releaseStandby()
+{
+    m_switchPending = false;
+    if (!m_standbyPipeline.isNull())
+    {
+        QGlib::disconnect(m_standbyPipeline->bus(), "message", this, &GStreamerPlayer::onStandbyBusMessage);
+        m_standbyPipeline->bus()->removeSignalWatch();
+        m_standbyPipeline->setState(QGst::StateNull);
+        m_standbyPipeline.clear();
+    }
+    m_standbyTailElement.clear();
+    m_standbyRecordingTee.clear();
+    m_standbySink.clear();
+    m_standbyPipelineString = "";
+    m_standbyReady = false;
+    emit standbyChanged();
+}
+
+// Called on the streaming thread of the standby pipeline
+void GStreamerPlayer::onStandbyHandoff(const QGst::BufferPtr & buffer, const QGst::PadPtr & pad)
+{
+    Q_UNUSED(buffer);
+    Q_UNUSED(pad);
+    if (m_standbyFrameSeen.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "onStandbyFirstFrame", Qt::QueuedConnection);
+    }
+}
+
+void GStreamerPlayer::onStandbyFirstFrame()
+{
+    if (m_standbySink.isNull()) return;
+
+    // Only the first frame is interesting, stop paying for the signal
+    m_standbySink->setProperty("signal-handoffs", false);
+    m_standbyReady = true;
+    emit standbyChanged();
+
+    if (m_switchPending) swapPipelines();
+}
+
+void GStreamerPlayer::onStandbyBusMessage(const QGst::MessagePtr & message)
+{
+    if (message->type() == QGst::MessageError)
+    {
+        qCritical() << "Standby pipeline:" << message.staticCast<QGst::ErrorMessage>()->error();
+        releaseStandby();
+    }
+}
+
+/**
+ * Both pipelines are parked in PAUSED so nothing is pushed on the pads being
+ * relinked, the sinks are exchanged and both are restarted. Decoders keep
+ * their state in PAUSED so the new stream shows without waiting for a keyframe.
+ */
+void GStreamerPlayer::swapPipelines()
+{
+    m_switchPending = false;
+    if (m_standbyPipeline.isNull() || m_builder.isRunning()) return;
+
+    m_standbyPipeline->setState(QGst::StatePaused);
+    m_standbyTailElement->unlink(m_standbySink);
+    m_standbyPipeline->remove(m_standbySink);
+
+    if (!m_pipeline.isNull())
+    {
+        m_pipeline->setState(QGst::StatePaused);
+        m_tailElement->unlink(m_videoSink);
+        m_pipeline->remove(m_videoSink);
+
+        m_pipeline->add(m_standbySink);
+        m_tailElement->link(m_standbySink);
+        m_standbySink->setProperty("signal-handoffs", true);
+
+        QGlib::disconnect(m_pipeline->bus(), "message", this, &GStreamerPlayer::onBusMessage);
+        QGlib::connect(m_pipeline->bus(), "message", this, &GStreamerPlayer::onStandbyBusMessage);
+    }
+
+    m_standbyPipeline->add(m_videoSink);
+    m_standbyTailElement->link(m_videoSink);
+    QGlib::disconnect(m_standbyPipeline->bus(), "message", this, &GStreamerPlayer::onStandbyBusMessage);
+    QGlib::connect(m_standbyPipeline->bus(), "message", this, &GStreamerPlayer::onBusMessage);
+
+    qSwap(m_pipeline, m_standbyPipeline);
+    qSwap(m_tailElement, m_standbyTailElement);
+    qSwap(m_recordingTee, m_standbyRecordingTee);
+    qSwap(m_depayloaderName, m_standbyDepayloaderName);
+    qSwap(m_currentPipelineString, m_standbyPipelineString);
+    m_pipelineString = m_currentPipelineString;
+    m_stats->setPipeline(m_pipeline);
+    resetKeyFrameWatchdog();
+    m_recorder->setPipeline(m_pipeline, m_recordingTee, m_depayloaderName);
+    m_restreamer->setPipeline(m_pipeline, m_recordingTee, m_depayloaderName);
+    m_snapshot->setTailElement(m_tailElement);
+    updateVideoDecoder();
+
+    m_standbyFrameSeen = 0;
+    m_standbyReady = false;
+    emit standbyChanged();
+    emit pipelineSwitched(m_currentPipelineString);
+
+    if (m_targetState == QGst::StateNull) m_targetState = QGst::StatePlaying;
+    m_pipeline->setState(m_targetState);
+    if (!m_standbyPipeline.isNull()) m_standbyPipeline->setState(QGst::StatePlaying);
+}
+
+void GStreamerPlayer::setHidden(bool hidden)
+{
+    // Showing again also starts a player that was never played or was stopped
+    bool changed = m_hidden != hidden;
+    if (!changed && hidden) return;
+    m_hidden = hidden;
+
+    if (hidden)
+    {
+        if (m_hiddenMode == HiddenStop)
+        {
+            stop();
+        }
+        else
+        {
+            // Decoders a decodebin plugged in since the build get their gate now
+            installDecodeGate(m_pipeline);
+            m_decodeGate = m_hiddenMode == HiddenKeyFrames ? GateKeyFrames : GateClosed;
+        }
+    }
+    else
+    {
+        if (m_decodeGate.testAndSetOrdered(GateClosed, GateWaitKeyFrame))
+        {
+            // The decoder's references are gone, start from the next key frame
+            requestKeyFrame();
+            QTimer::singleShot(KeyFrameWaitMs, this, SLOT(openDecodeGate()));
+        }
+        else
+        {
+            m_decodeGate = GateOpen;
+        }
+        if (m_pipeline.isNull() || m_targetState != QGst::StatePlaying)
+        {
+            play();
+        }
+    }
+    if (changed) emit hiddenChanged(hidden);
+}
+
+void GStreamerPlayer::openDecodeGate()
+{
+    if (m_decodeGate.testAndSetOrdered(GateWaitKeyFrame, GateOpen))
+    {
+        qDebug() << "No key frame after" << KeyFrameWaitMs << "ms, decoding delta frames again";
+    }
+}
+
+void GStreamerPlayer::setDegradeLevel(int level)
+{
+    level = qBound((int)DegradeNone, level, (int)DegradeHalfRate);
+    if (m_degradeLevel.load() == level) return;
+
+    m_degradeLevel = level;
+    applyDegradeLevel(m_pipeline);
+    applyDegradeLevel(m_standbyPipeline);
+    emit degradeLevelChanged(level);
+}
+
+// Where applyLowMemory keeps a queue's own max-size-buffers, plus one so 0 means unset
+static const char * const SavedQueueBuffers = "qmlplayer2-max-size-buffers";
+
+void GStreamerPlayer::setLowMemory(bool lowMemory)
+{
+    if (m_lowMemory == lowMemory) return;
+
+    m_lowMemory = lowMemory;
+    if (lowMemory)
+    {
+        releaseStandby();
+    }
+    applyLowMemory(m_pipeline);
+    applyLowMemory(m_standbyPipeline);
+    requestReallocation();
+    emit lowMemoryChanged(lowMemory);
+}
+
+void GStreamerPlayer::setMinPoolBuffers(int buffers)
+{
+    buffers = qMax(1, buffers);
+    if (m_minPoolBuffers.load() == buffers) return;
 
-    m_stopTimer.setSingleShot(true);
-    connect(&m_stopTimer, SIGNAL(timeout()), this, SLOT(onStopTimer()));
+    m_minPoolBuffers = buffers;
+    requestReallocation();
+    emit poolBuffersChanged();
+}
+
+void GStreamerPlayer::setMaxPoolBuffers(int buffers)
+{
+    buffers = qMax(0, buffers);
+    if (m_maxPoolBuffers.load() == buffers) return;
 
+    m_maxPoolBuffers = buffers;
+    requestReallocation();
+    emit poolBuffersChanged();
 }
 
-GStreamerPlayer::~GStreamerPlayer()
+void GStreamerPlayer::requestReallocation()
 {
-    stop();
+    if (m_videoSink.isNull()) return;
+
+    // Upstream answers a reconfigure with a new allocation query
+    GstPad *pad = gst_element_get_static_pad((GstElement*)m_videoSink, "sink");
+    if (pad)
+    {
+        gst_pad_push_event(pad, gst_event_new_reconfigure());
+        gst_object_unref(pad);
+    }
 }
 
-void GStreamerPlayer::setVideoSink(const QGst::ElementPtr & sink)
+GstPadProbeReturn GStreamerPlayer::onAllocationQuery(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
 {
-    m_videoSink = sink;
+    Q_UNUSED(pad);
+    GStreamerPlayer *player = static_cast<GStreamerPlayer*>(user_data);
+    GstQuery *query = GST_PAD_PROBE_INFO_QUERY(info);
+    if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION) return GST_PAD_PROBE_OK;
+
+    GstCaps *caps = NULL;
+    gboolean needPool = FALSE;
+    gst_query_parse_allocation(query, &caps, &needPool);
+    GstVideoInfo videoInfo;
+    if (caps == NULL || !gst_video_info_from_caps(&videoInfo, caps)) return GST_PAD_PROBE_OK;
+
+    // GL and EGL memory is pooled by the elements that allocate it
+    GstCapsFeatures *features = gst_caps_get_features(caps, 0);
+    if (features && !gst_caps_features_is_equal(features, GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    // Frames the snapshot ring holds are out of the pool until they are replaced.
+    // m_lowMemory and the ring size are read unlocked, a stale value lasts until the next query
+    guint minBuffers = player->m_minPoolBuffers.load();
+    guint maxBuffers = player->m_maxPoolBuffers.load();
+    guint held = qMax(0, player->m_snapshot->getRingSize());
+    if (player->m_lowMemory) maxBuffers = minBuffers;
+    minBuffers += held;
+    if (maxBuffers != 0) maxBuffers = qMax(maxBuffers + held, minBuffers);
+
+    if (gst_query_get_n_allocation_pools(query) > 0)
+    {
+        // The sink brought a pool of its own, only its size is bounded
+        GstBufferPool *pool = NULL;
+        guint size = 0, min = 0, max = 0;
+        gst_query_parse_nth_allocation_pool(query, 0, &pool, &size, &min, &max);
+        gst_query_set_nth_allocation_pool(query, 0, pool, qMax(size, (guint)videoInfo.size),
+                                          qMax(min, minBuffers), maxBuffers);
+        if (pool) gst_object_unref(pool);
+        return GST_PAD_PROBE_OK;
+    }
+
+    // Default strides, the sink maps frames from the caps alone
+    GstAllocationParams params;
+    gst_allocation_params_init(&params);
+    params.align = PoolMemoryAlign - 1;
+
+    GstBufferPool *pool = gst_video_buffer_pool_new();
+    GstStructure *config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, caps, videoInfo.size, minBuffers, maxBuffers);
+    gst_buffer_pool_config_set_allocator(config, NULL, &params);
+    if (!gst_buffer_pool_set_config(pool, config))
+    {
+        qWarning() << "Video buffer pool rejected" << minBuffers << "-" << maxBuffers << "buffers of" << videoInfo.size;
+        gst_object_unref(pool);
+        return GST_PAD_PROBE_OK;
+    }
+    gst_query_add_allocation_pool(query, pool, videoInfo.size, minBuffers, maxBuffers);
+    gst_query_add_allocation_param(query, NULL, &params);
+    gst_object_unref(pool);
+    return GST_PAD_PROBE_OK;
 }
 
-bool GStreamerPlayer::play()
+void GStreamerPlayer::applyLowMemory(const QGst::PipelinePtr & pipeline)
 {
-    initialize();
+    if (pipeline.isNull()) return;
 
-    if (!m_pipeline.isNull()) {
-        m_pipeline->setState(QGst::StatePlaying);
-        return true;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GObject *element = G_OBJECT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(element));
+        if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "queue") == 0)
+        {
+            guint saved = GPOINTER_TO_UINT(g_object_get_data(element, SavedQueueBuffers));
+            if (m_lowMemory)
+            {
+                guint buffers = 0;
+                g_object_get(element, "max-size-buffers", &buffers, NULL);
+                if (saved == 0)
+                {
+                    g_object_set_data(element, SavedQueueBuffers, GUINT_TO_POINTER(buffers + 1));
+                }
+                // 0 is unlimited
+                if (buffers == 0 || buffers > LowMemoryQueueBuffers)
+                {
+                    g_object_set(element, "max-size-buffers", (guint)LowMemoryQueueBuffers, NULL);
+                }
+            }
+            else if (saved != 0)
+            {
+                g_object_set(element, "max-size-buffers", saved - 1, NULL);
+                g_object_set_data(element, SavedQueueBuffers, NULL);
+            }
+        }
+        g_value_reset(&item);
     }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+}
 
-    return false;
+void GStreamerPlayer::setDisplaySize(const QSize & size)
+{
+    if (m_displaySize == size) return;
+
+    m_displaySize = size;
+    updateSizeLimit();
+    emit displaySizeChanged();
 }
 
-void GStreamerPlayer::pause()
+void GStreamerPlayer::setAdaptiveSize(bool adaptive)
 {
-    if (!m_pipeline.isNull()) {
-        m_pipeline->setState(QGst::StatePaused);
+    if (m_adaptiveSize == adaptive) return;
+
+    m_adaptiveSize = adaptive;
+    updateSizeLimit();
+    emit displaySizeChanged();
+}
+
+void GStreamerPlayer::setMaxVideoHeight(int height)
+{
+    height = qMax(0, height);
+    if (m_maxVideoHeight == height) return;
+
+    m_maxVideoHeight = height;
+    updateSizeLimit();
+    emit displaySizeChanged();
+}
+
+// Rounds a view dimension up to a step, 0 above the largest
+static int sizeStep(int pixels)
+{
+    for (int i = 0; SizeSteps[i] != 0; i++)
+    {
+        if (pixels <= SizeSteps[i]) return SizeSteps[i];
     }
+    return 0;
 }
 
-void GStreamerPlayer::stop()
+void GStreamerPlayer::updateSizeLimit()
 {
-    if (!m_pipeline.isNull()) {
-        m_pipeline->setState(QGst::StateNull);
+    QSize limit;
+    if (m_adaptiveSize && !m_displaySize.isEmpty())
+    {
+        int width = sizeStep(m_displaySize.width());
+        int height = sizeStep(m_displaySize.height());
+        if (width != 0 || height != 0)
+        {
+            limit = QSize(width != 0 ? width : G_MAXINT, height != 0 ? height : G_MAXINT);
+        }
+    }
+    if (m_maxVideoHeight > 0)
+    {
+        limit = QSize(limit.isValid() ? limit.width() : G_MAXINT,
+                      limit.isValid() ? qMin(limit.height(), m_maxVideoHeight) : m_maxVideoHeight);
     }
+    if (m_sizeLimit == limit) return;
+
+    m_sizeLimit = limit;
+    qDebug() << "Video frames limited to" << limit << "for a view of" << m_displaySize;
+    applySizeLimit(m_pipeline);
+    applySizeLimit(m_standbyPipeline);
 }
 
-void GStreamerPlayer::toggleFullScreen()
+void GStreamerPlayer::applySizeLimit(const QGst::PipelinePtr & pipeline)
+{
+    if (pipeline.isNull()) return;
+    QGst::ElementPtr filter = pipeline->getElementByName(GStreamerPipelineBuilder::scaleFilterName());
+    if (filter.isNull()) return;
+
+    // The pixel aspect ratio is fixed so videoscale keeps the display aspect
+    // ratio inside the box. A new caps property renegotiates on the next frame
+    QString caps = "ANY";
+    if (m_sizeLimit.isValid() && !m_videoCaps.contains("memory:"))
+    {
+        caps = QString("video/x-raw, width=(int)[16, %1], height=(int)[16, %2], pixel-aspect-ratio=(fraction)1/1")
+                .arg(m_sizeLimit.width()).arg(m_sizeLimit.height());
+    }
+    filter->setProperty("caps", QGst::Caps::fromString(caps));
+}
+
+qint64 GStreamerPlayer::queuedBytes()
 {
+    return queuedBytes(m_pipeline) + queuedBytes(m_standbyPipeline);
 }
 
-void GStreamerPlayer::initialize()
+qint64 GStreamerPlayer::queuedBytes(const QGst::PipelinePtr & pipeline)
 {
-    if (!m_pipelineString.isEmpty() && m_pipelineString != m_currentPipelineString)
+    if (pipeline.isNull()) return 0;
+
+    // queue and queue2 report what they hold
+    qint64 bytes = 0;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
     {
-        m_currentPipelineString = "";
+        GObject *element = G_OBJECT(g_value_get_object(&item));
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), "current-level-bytes"))
+        {
+            guint level = 0;
+            g_object_get(element, "current-level-bytes", &level, NULL);
+            bytes += level;
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return bytes;
+}
 
-        stop();
+void GStreamerPlayer::applyDegradeLevel(const QGst::PipelinePtr & pipeline)
+{
+    if (pipeline.isNull()) return;
 
-        if (!m_pipeline.isNull())
+    // avdec_* and most software decoders expose "skip-frame", 1 skips B-frames
+    // and 0 decodes everything. Hardware decoders without it only get DegradeHalfRate.
+    gint skipFrame = m_degradeLevel.load() >= DegradeSkipFrames ? 1 : 0;
+
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(element);
+        const gchar *klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : NULL;
+        if (klass && g_strstr_len(klass, -1, "Decoder") && g_strstr_len(klass, -1, "Video")
+                && g_object_class_find_property(G_OBJECT_GET_CLASS(element), "skip-frame"))
         {
-            m_pipeline->remove(m_videoSink);
-            m_pipeline.clear();
+            g_object_set(element, "skip-frame", skipFrame, NULL);
         }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+}
+
+bool GStreamerPlayer::isVideoDecoder(GstObject *object)
+{
+    if (object == NULL || !GST_IS_ELEMENT(object)) return false;
+    GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(object));
+    const gchar *klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : NULL;
+    return klass && g_strstr_len(klass, -1, "Decoder") && g_strstr_len(klass, -1, "Video");
+}
+
+void GStreamerPlayer::resetKeyFrameWatchdog()
+{
+    m_keyFrameRequests = 0;
+    m_watchdogLost = 0;
+    // A new pipeline starts from the latency its string asks for
+    m_jitterLatency = 0;
+    m_jitterCleanSamples = 0;
+    m_jitterLate = 0;
+    m_lastKeyFrameRequest.invalidate();
+    emit keyFrameRequested(m_keyFrameRequests);
+}
+
+bool GStreamerPlayer::requestKeyFrame()
+{
+    if (m_videoSink.isNull() || m_pipeline.isNull()) return false;
+
+    // Give the encoder time to answer before asking again
+    if (m_lastKeyFrameRequest.isValid() && m_lastKeyFrameRequest.elapsed() < KeyFrameRequestIntervalMs) return false;
+    m_lastKeyFrameRequest.start();
+
+    // all-headers so SPS/PPS are resent too, the decoder may have lost them
+    GstEvent *event = gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, ++m_keyFrameRequests);
+    gst_element_send_event((GstElement*)m_videoSink, event);
+
+    qDebug() << "Requested a key frame to recover the video, request" << m_keyFrameRequests;
+    emit keyFrameRequested(m_keyFrameRequests);
+    return true;
+}
+
+// Once per stats sample
+void GStreamerPlayer::checkDecodeHealth()
+{
+    if (!m_autoKeyFrame || !m_playing) return;
 
-        QByteArray data = m_pipelineString.toUtf8();
-        const char *pData = data.constData();
+    quint64 lost = m_stats->getJitterLost();
+    bool corrupt = lost > m_watchdogLost;
+    m_watchdogLost = lost;
 
-        m_pipeline = QGst::ElementFactory::parseLaunch(pData).dynamicCast<QGst::Pipeline>();
-        if (!m_pipeline.isNull())
+    // Packets keep arriving but nothing comes out: the decoder waits for a reference frame
+    bool starved = m_stats->getBitrateKbps() > 0 && m_stats->getDecodedFps() == 0;
+
+    if (corrupt || starved)
+    {
+        requestKeyFrame();
+    }
+}
+
+GstPadProbeReturn GStreamerPlayer::onSinkBuffer(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    Q_UNUSED(info);
+    GStreamerPlayer *player = static_cast<GStreamerPlayer*>(user_data);
+    player->m_lastBufferMs = (int)player->m_bufferClock.elapsed();
+    return GST_PAD_PROBE_OK;
+}
+
+void GStreamerPlayer::checkStall()
+{
+    // Hidden, suspended or paused streams are not expected to deliver
+    bool watching = m_stallTimeoutMs > 0 && !m_pipeline.isNull() && !m_builder.isRunning()
+            && m_targetState == QGst::StatePlaying && !m_hidden && !m_suspended && !m_stopTimer.isActive();
+    int silentMs = (int)m_bufferClock.elapsed() - m_lastBufferMs.load();
+
+    if (!watching || silentMs < m_stallTimeoutMs)
+    {
+        if (m_stalled)
         {
-            QGst::PadPtr src = m_pipeline->findUnlinkedPad(QGst::PadSrc);
-            if (!src.isNull())
+            if (watching)
             {
-                src->parentElement()->setProperty("caps", QGst::Caps::fromString("video/x-raw, format=I420"));
-                m_videoSink->setProperty("sync", false);
-                m_pipeline->add(m_videoSink);
-                src->parentElement()->link(m_videoSink);
-
-                //watch the bus for messages
-                QGst::BusPtr bus = m_pipeline->bus();
-                bus->addSignalWatch();
-                QGlib::connect(bus, "message", this, &GStreamerPlayer::onBusMessage);
-                m_currentPipelineString = m_pipelineString;
+                qDebug() << "Video recovered after" << m_stallTime.elapsed() << "ms and" << m_stallRestarts
+                         << "source restarts";
             }
-            else
+            m_stalled = false;
+            emit stalledChanged(m_stalled);
+        }
+        return;
+    }
+
+    if (!m_stalled)
+    {
+        qWarning() << "No video frame for" << silentMs << "ms, restarting the source";
+        m_stalled = true;
+        m_stallTime.start();
+        m_stallRestarts = 0;
+        m_nextRestartMs = 0;
+        emit stalledChanged(m_stalled);
+    }
+    if (m_stallTime.elapsed() < m_nextRestartMs) return;
+
+    if (m_stallRestarts < MaxSourceRestarts && restartSource())
+    {
+        m_stallRestarts++;
+        m_sourceRestarts++;
+        // Each attempt gets longer to deliver, a camera rebooting takes a while
+        m_nextRestartMs = m_stallTime.elapsed() + (qint64)m_stallTimeoutMs * m_stallRestarts;
+        emit stalledChanged(m_stalled);
+    }
+    else
+    {
+        qWarning() << "Source restarts did not bring the video back, rebuilding the pipeline";
+        m_stallRestarts = 0;
+        m_nextRestartMs = m_stallTime.elapsed() + (qint64)m_stallTimeoutMs * MaxSourceRestarts;
+        m_currentPipelineString = "";
+        play();
+    }
+}
+
+/**
+ * Flushing from the sources' peers down makes every push return FLUSHING, so
+ * the source threads can be joined even while a decoder or the mailbox
+ * blocks. NULL closes the sockets and ends RTSP sessions; back in the
+ * pipeline's state they reconnect. The flush resets the jitterbuffers too,
+ * the decoder is asked for a key frame as its references are stale.
+ */
+bool GStreamerPlayer::restartSource()
+{
+    if (m_pipeline.isNull()) return false;
+
+    QList<GstElement*> sources;
+    GstIterator *it = gst_bin_iterate_sources(GST_BIN((GstPipeline*)m_pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        sources << GST_ELEMENT(gst_object_ref(g_value_get_object(&item)));
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    if (sources.isEmpty()) return false;
+
+    foreach (GstElement *source, sources)
+    {
+        QList<GstPad*> peers;
+        GList *pads;
+        GST_OBJECT_LOCK(source);
+        for (pads = source->srcpads; pads != NULL; pads = pads->next)
+        {
+            GstPad *peer = gst_pad_get_peer(GST_PAD(pads->data));
+            if (peer) peers << peer;
+        }
+        GST_OBJECT_UNLOCK(source);
+
+        // Sometimes pads (rtspsrc) come back as new pads, parse-launch only linked the first ones
+        if (!g_object_get_data(G_OBJECT(source), "stall-relink"))
+        {
+            g_object_set_data(G_OBJECT(source), "stall-relink", GINT_TO_POINTER(1));
+            g_signal_connect(source, "pad-added", G_CALLBACK(&GStreamerPlayer::onSourcePadAdded), NULL);
+        }
+        if (!peers.isEmpty())
+        {
+            // Remembered for onSourcePadAdded(), the element keeps the reference
+            g_object_set_data_full(G_OBJECT(source), "stall-peer", gst_object_ref(peers.first()), gst_object_unref);
+        }
+
+        foreach (GstPad *peer, peers) gst_pad_send_event(peer, gst_event_new_flush_start());
+        gst_element_set_state(source, GST_STATE_NULL);
+        foreach (GstPad *peer, peers)
+        {
+            gst_pad_send_event(peer, gst_event_new_flush_stop(TRUE));
+            gst_object_unref(peer);
+        }
+        if (!gst_element_sync_state_with_parent(source))
+        {
+            qWarning() << "Source" << GST_OBJECT_NAME(source) << "did not restart";
+        }
+        gst_object_unref(source);
+    }
+
+    m_lastKeyFrameRequest.invalidate();
+    requestKeyFrame();
+    return true;
+}
+
+void GStreamerPlayer::onSourcePadAdded(GstElement *source, GstPad *pad, gpointer user_data)
+{
+    Q_UNUSED(user_data);
+    GstPad *peer = static_cast<GstPad*>(g_object_get_data(G_OBJECT(source), "stall-peer"));
+    if (peer == NULL || gst_pad_is_linked(peer) || GST_PAD_DIRECTION(pad) != GST_PAD_SRC) return;
+
+    GstPadLinkReturn result = gst_pad_link(pad, peer);
+    if (GST_PAD_LINK_FAILED(result))
+    {
+        qWarning() << "Could not relink the restarted source" << GST_OBJECT_NAME(source) << result;
+    }
+}
+
+void GStreamerPlayer::setAdaptiveJitter(bool adaptive)
+{
+    if (m_adaptiveJitter == adaptive) return;
+
+    // Turning it off leaves the last latency until the pipeline is rebuilt
+    m_adaptiveJitter = adaptive;
+    m_jitterCleanSamples = 0;
+    emit jitterLatencyChanged();
+}
+
+void GStreamerPlayer::setMinJitterLatency(int ms)
+{
+    ms = qBound(0, ms, m_maxJitterLatency);
+    if (m_minJitterLatency == ms) return;
+
+    m_minJitterLatency = ms;
+    emit jitterLatencyChanged();
+}
+
+void GStreamerPlayer::setMaxJitterLatency(int ms)
+{
+    ms = qMax(m_minJitterLatency, ms);
+    if (m_maxJitterLatency == ms) return;
+
+    m_maxJitterLatency = ms;
+    emit jitterLatencyChanged();
+}
+
+// Once per stats sample
+void GStreamerPlayer::adaptJitterLatency()
+{
+    quint64 late = m_stats->getJitterLate();
+    quint64 newLate = late >= m_jitterLate ? late - m_jitterLate : 0;
+    m_jitterLate = late;
+
+    if (!m_adaptiveJitter || !m_playing || m_pipeline.isNull()) return;
+
+    int current = m_jitterLatency > 0 ? m_jitterLatency : readJitterLatency();
+    if (current <= 0) return;   // no jitterbuffer in this pipeline
+
+    // RFC 3550 interarrival jitter is a mean deviation, a few of them cover nearly every packet
+    int target = qBound(m_minJitterLatency, qRound(JitterMultiplier * m_stats->getJitterMs()) + JitterMarginMs,
+                        m_maxJitterLatency);
+    int latency = current;
+    if (newLate > 0)
+    {
+        m_jitterCleanSamples = 0;
+        latency = qMax(target, current + current / 2);
+    }
+    else if (target > current)
+    {
+        m_jitterCleanSamples = 0;
+        latency = target;
+    }
+    else if (++m_jitterCleanSamples >= JitterShrinkSamples)
+    {
+        latency = current - (current - target + 3) / 4;
+    }
+    latency = qBound(m_minJitterLatency, latency, m_maxJitterLatency);
+
+    if (latency != m_jitterLatency)
+    {
+        if (latency != current)
+        {
+            qDebug() << "Jitterbuffer latency" << current << "->" << latency << "ms, jitter"
+                     << m_stats->getJitterMs() << "ms," << newLate << "late packets";
+        }
+        applyJitterLatency(latency);
+        m_jitterLatency = latency;
+        emit jitterLatencyChanged();
+    }
+}
+
+// Latency of the first jitterbuffer in the displayed pipeline, 0 without one
+int GStreamerPlayer::readJitterLatency()
+{
+    guint latency = 0;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)m_pipeline));
+    GValue item = G_VALUE_INIT;
+    while (latency == 0 && gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GObject *element = G_OBJECT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(element));
+        if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "rtpjitterbuffer") == 0)
+        {
+            g_object_get(element, "latency", &latency, NULL);
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return (int)latency;
+}
+
+void GStreamerPlayer::applyJitterLatency(int ms)
+{
+    // Jitterbuffers may be nested (rtpbin, rtspsrc), each posts a latency
+    // message and onBusMessage has the pipeline latency recalculated
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)m_pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GObject *element = G_OBJECT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(element));
+        if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "rtpjitterbuffer") == 0)
+        {
+            g_object_set(element, "latency", (guint)ms, NULL);
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+}
+
+void GStreamerPlayer::watchStreamingThreads(const QGst::BusPtr & bus)
+{
+    // Sync messages are emitted on the thread that posts them
+    gst_bus_enable_sync_message_emission((GstBus*)bus);
+    g_signal_connect((GstBus*)bus, "sync-message::stream-status", G_CALLBACK(&GStreamerPlayer::onStreamStatus), NULL);
+}
+
+void GStreamerPlayer::onStreamStatus(GstBus *bus, GstMessage *message, gpointer user_data)
+{
+    Q_UNUSED(bus);
+    Q_UNUSED(user_data);
+    GstStreamStatusType type;
+    GstElement *owner = NULL;
+    gst_message_parse_stream_status(message, &type, &owner);
+    // ENTER is posted by the new streaming thread itself, before its first buffer
+    if (type == GST_STREAM_STATUS_TYPE_ENTER)
+    {
+        ThreadRoles::enter(ThreadRoles::VideoStreaming);
+    }
+}
+
+void GStreamerPlayer::installDegradeProbe(const QGst::ElementPtr & tail)
+{
+    if (tail.isNull()) return;
+
+    // Frames are thinned out before the mailbox so they are never uploaded
+    GstPad *pad = gst_element_get_static_pad((GstElement*)tail, "sink");
+    if (pad)
+    {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerPlayer::onDegradeProbe, this, NULL);
+        gst_object_unref(pad);
+    }
+}
+
+GstPadProbeReturn GStreamerPlayer::onDegradeProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    GStreamerPlayer *player = static_cast<GStreamerPlayer*>(user_data);
+
+    int maxFps = player->m_maxFps.load();
+    GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+    if (maxFps > 0 && GST_CLOCK_TIME_IS_VALID(pts))
+    {
+        // A quarter interval of slack so a stream exactly at the cap is not halved by jitter
+        GstClockTime interval = GST_SECOND / maxFps;
+        GstClockTime last = player->m_maxFpsLastPts;
+        if (GST_CLOCK_TIME_IS_VALID(last) && pts > last && pts - last < interval - interval / 4)
+        {
+            return GST_PAD_PROBE_DROP;
+        }
+        player->m_maxFpsLastPts = pts;
+    }
+
+    // Hidden: the key frames only keep the decoder's references, nobody looks at them
+    if (player->m_decodeGate.load() == GateKeyFrames) return GST_PAD_PROBE_DROP;
+
+    if (player->m_degradeLevel.load() < DegradeHalfRate) return GST_PAD_PROBE_OK;
+    return (player->m_degradeFrames.fetchAndAddRelaxed(1) & 1) ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+}
+
+void GStreamerPlayer::installDecodeGate(const QGst::PipelinePtr & pipeline)
+{
+    if (pipeline.isNull()) return;
+
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GstPad *pad = isVideoDecoder(GST_OBJECT(element)) ? gst_element_get_static_pad(element, "sink") : NULL;
+        if (pad)
+        {
+            if (!g_object_get_data(G_OBJECT(pad), "decode-gate"))
             {
-               QString msg = "The Pipeline command string has no unlinked video source element, cannot link pipeline. String = " + m_pipelineString;
-               emit messageBox(msg);
-               m_pipeline.clear();
+                g_object_set_data(G_OBJECT(pad), "decode-gate", GINT_TO_POINTER(1));
+                gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerPlayer::onDecodeGate, this, NULL);
             }
+            gst_object_unref(pad);
         }
-        else
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+}
+
+GstPadProbeReturn GStreamerPlayer::onDecodeGate(GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+{
+    Q_UNUSED(pad);
+    GStreamerPlayer *player = static_cast<GStreamerPlayer*>(user_data);
+
+    // Events, caps and segments included, still pass, only buffers are gated
+    int gate = player->m_decodeGate.load();
+    if (gate == GateOpen) return GST_PAD_PROBE_OK;
+    if (gate == GateClosed) return GST_PAD_PROBE_DROP;
+    if (GST_BUFFER_FLAG_IS_SET(GST_PAD_PROBE_INFO_BUFFER(info), GST_BUFFER_FLAG_DELTA_UNIT)) return GST_PAD_PROBE_DROP;
+    if (gate == GateWaitKeyFrame) player->m_decodeGate.testAndSetOrdered(GateWaitKeyFrame, GateOpen);
+    return GST_PAD_PROBE_OK;
+}
+
+QStringList GStreamerPlayer::videoCapsCandidates() const
+{
+    QStringList capsList;
+    if (m_zeroCopy && !m_zeroCopyFailed)
+    {
+        for (int i = 0; ZeroCopyCaps[i] != NULL; i++)
         {
-            QString msg = "Failed to create the pipeline '" + m_pipelineString + "'!";
-            emit messageBox(msg);
+            capsList << ZeroCopyCaps[i];
         }
     }
+    capsList << FallbackCaps;
+    return capsList;
 }
 
 void GStreamerPlayer::onBusMessage(const QGst::MessagePtr & message)
 {
+    HUD_TRACE_SCOPE("GStreamerPlayer::onBusMessage");
     switch (message->type()) {
     case QGst::MessageEos: //End of stream. We reached the end of the file.
-        stop();
+        if (m_stopTimer.isActive() && message->source() == m_pipeline)
+        {
+            // The EOS sent by setStopped() drained through every sink
+            finishStop();
+        }
+        else
+        {
+            stop();
+        }
+        break;
+    case QGst::MessageWarning:
+        // Decoders warn about each corrupt frame (avdec "decoding error") and carry on
+        if (m_autoKeyFrame && isVideoDecoder(GST_MESSAGE_SRC((GstMessage*)message)))
+        {
+            requestKeyFrame();
+        }
         break;
     case QGst::MessageError: //Some error occurred.
-        qCritical() << message.staticCast<QGst::ErrorMessage>()->error();
+    {
+        QGst::ErrorMessagePtr errorMessage = message.staticCast<QGst::ErrorMessage>();
+        qCritical() << errorMessage->error();
         stop();
+
+        // Link succeeded but the decoder could not agree on a format with the
+        // zero-copy caps, rebuild the pipeline with system memory I420
+        if (m_videoCaps != FallbackCaps && errorMessage->debugMessage().contains("not-negotiated"))
+        {
+            qCritical() << "Caps" << m_videoCaps << "failed to negotiate, falling back to" << FallbackCaps;
+            m_zeroCopyFailed = true;
+            m_currentPipelineString = "";
+            QTimer::singleShot(0, this, SLOT(play()));
+            break;
+        }
+
+        // The chosen decoder errored out (typically a hardware decoder that
+        // cannot handle this stream), rebuild with the next best one
+        GstObject *source = GST_MESSAGE_SRC((GstMessage*)message);
+        GstElementFactory *factory = (source && GST_IS_ELEMENT(source)) ? gst_element_get_factory(GST_ELEMENT(source)) : NULL;
+        GStreamerDecoderProbe *probe = GStreamerDecoderProbe::instance();
+        QString decoder = factory ? QString(GST_OBJECT_NAME(factory)) : QString();
+        if (m_autoDecoder && !decoder.isEmpty() && probe->decoders(probe->codecOf(decoder)).size() > 1)
+        {
+            probe->markFailed(decoder);
+            m_currentPipelineString = "";
+            QTimer::singleShot(0, this, SLOT(play()));
+        }
+        break;
+    }
+    case QGst::MessageQos:
+        m_stats->handleQos(message.staticCast<QGst::QosMessage>());
+        break;
+    case QGst::MessageLatency:
+        // An element's latency changed, e.g. applyJitterLatency()
+        if (!m_pipeline.isNull()) gst_bin_recalculate_latency(GST_BIN((GstPipeline*)m_pipeline));
+        break;
+    case QGst::MessageAsyncDone:
+        if (!m_pipeline.isNull() && message->source() == m_pipeline)
+        {
+            emit asyncDone();
+        }
         break;
     case QGst::MessageStateChanged:
         if (!m_pipeline.isNull() && message->source() == m_pipeline)
@@ -192,6 +1646,12 @@ void GStreamerPlayer::sendEOS()
 }
 
 void GStreamerPlayer::onStopTimer()
+{
+    qCritical() << "EOS did not drain within" << m_stopTimeout << "ms, forcing stop";
+    finishStop();
+}
+
+void GStreamerPlayer::finishStop()
 {
     m_stopTimer.stop();
     m_stopped = true;
@@ -21,13 +21,49 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QStringList>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSize>
 #include <QGst/Pipeline>
 #include <QGst/Message>
+#include <QGst/Buffer>
+#include <QGst/Pad>
+#include <gst/gst.h>
+#include "GStreamerPipelineBuilder.h"
+#include "GStreamerStats.h"
+#include "GStreamerRecorder.h"
+#include "GStreamerRestreamer.h"
+#include "GStreamerSnapshot.h"
 
 class GStreamerPlayer : public QObject
 {
     Q_OBJECT
+    Q_ENUMS(SuspendMode)
+    Q_ENUMS(DegradeLevel)
+    Q_ENUMS(HiddenMode)
 public:
+    /** @brief What suspend() keeps alive, trading memory/battery for resume time */
+    enum SuspendMode {
+        SuspendStop = 0,    ///< Tear down to NULL, slowest resume
+        SuspendReady,       ///< Keep the pipeline constructed, elements release their streams
+        SuspendPaused       ///< Keep decoder and sink allocated, resume only restarts the source
+    };
+
+    /** @brief How much decoding/rendering work a lower priority stream gives up */
+    enum DegradeLevel {
+        DegradeNone = 0,    ///< Decode and show every frame
+        DegradeSkipFrames,  ///< Decoder skips non-reference frames where it supports "skip-frame"
+        DegradeHalfRate     ///< As above, and only every other decoded frame is handed to the sink
+    };
+
+    /** @brief What setHidden() keeps of the stream while the video is not shown */
+    enum HiddenMode {
+        HiddenStop = 0,     ///< Tear down to NULL, showing again rebuilds and reconnects
+        HiddenDropAll,      ///< Source and depayloader run, nothing reaches the decoder
+        HiddenKeyFrames     ///< Only key frames are decoded, none is handed to the sink
+    };
+
     Q_PROPERTY(int brightness READ getBrightness WRITE setBrightness NOTIFY brightnessChanged)
     Q_PROPERTY(int contrast READ getContrast WRITE setContrast NOTIFY contrastChanged)
     Q_PROPERTY(int hue READ getHue WRITE setHue NOTIFY hueChanged)
@@ -35,33 +71,93 @@ public:
     Q_PROPERTY(bool playing READ getPlaying WRITE setPlaying NOTIFY playingChanged)
     Q_PROPERTY(bool paused READ getPaused WRITE setPaused NOTIFY pausedChanged)
     Q_PROPERTY(bool stopped READ getStopped WRITE setStopped NOTIFY stoppedChanged)
+    Q_PROPERTY(bool zeroCopy READ getZeroCopy WRITE setZeroCopy NOTIFY zeroCopyChanged)
+    Q_PROPERTY(QString videoCaps READ getVideoCaps NOTIFY videoCapsChanged)
+    Q_PROPERTY(QString latencyProfile READ getLatencyProfile WRITE setLatencyProfile NOTIFY latencyProfileChanged)
+    Q_PROPERTY(QStringList latencyProfiles READ getLatencyProfiles CONSTANT)
+    Q_PROPERTY(QStringList sourcePresets READ getSourcePresets CONSTANT)
+    Q_PROPERTY(int suspendMode READ getSuspendMode WRITE setSuspendMode NOTIFY suspendModeChanged)
+    Q_PROPERTY(QString standbyPipelineString READ getStandbyPipelineString NOTIFY standbyChanged)
+    Q_PROPERTY(bool standbyReady READ getStandbyReady NOTIFY standbyChanged)
+    Q_PROPERTY(QObject* stats READ getStats CONSTANT)
+    Q_PROPERTY(QObject* recorder READ getRecorder CONSTANT)
+    Q_PROPERTY(QObject* restreamer READ getRestreamer CONSTANT)
+    Q_PROPERTY(QObject* snapshot READ getSnapshot CONSTANT)
+    Q_PROPERTY(int decodePriority READ getDecodePriority WRITE setDecodePriority NOTIFY decodePriorityChanged)
+    Q_PROPERTY(int degradeLevel READ getDegradeLevel WRITE setDegradeLevel NOTIFY degradeLevelChanged)
+    Q_PROPERTY(int maxFps READ getMaxFps WRITE setMaxFps NOTIFY maxFpsChanged)
+    Q_PROPERTY(bool hidden READ getHidden WRITE setHidden NOTIFY hiddenChanged)
+    Q_PROPERTY(int hiddenMode READ getHiddenMode WRITE setHiddenMode NOTIFY hiddenChanged)
+    Q_PROPERTY(int framePacing READ getFramePacing WRITE setFramePacing NOTIFY framePacingChanged)
+    Q_PROPERTY(int stallTimeoutMs READ getStallTimeoutMs WRITE setStallTimeoutMs NOTIFY stallTimeoutMsChanged)
+    Q_PROPERTY(bool stalled READ getStalled NOTIFY stalledChanged)
+    Q_PROPERTY(int sourceRestarts READ getSourceRestarts NOTIFY stalledChanged)
+    Q_PROPERTY(bool autoDecoder READ getAutoDecoder WRITE setAutoDecoder NOTIFY autoDecoderChanged)
+    Q_PROPERTY(QString videoDecoder READ getVideoDecoder NOTIFY videoDecoderChanged)
+    Q_PROPERTY(int stopTimeout READ getStopTimeout WRITE setStopTimeout NOTIFY stopTimeoutChanged)
+    Q_PROPERTY(bool autoKeyFrame READ getAutoKeyFrame WRITE setAutoKeyFrame NOTIFY autoKeyFrameChanged)
+    Q_PROPERTY(int keyFrameRequests READ getKeyFrameRequests NOTIFY keyFrameRequested)
+    Q_PROPERTY(bool lowMemory READ getLowMemory WRITE setLowMemory NOTIFY lowMemoryChanged)
+    Q_PROPERTY(QSize displaySize READ getDisplaySize WRITE setDisplaySize NOTIFY displaySizeChanged)
+    Q_PROPERTY(bool adaptiveSize READ getAdaptiveSize WRITE setAdaptiveSize NOTIFY displaySizeChanged)
+    Q_PROPERTY(int maxVideoHeight READ getMaxVideoHeight WRITE setMaxVideoHeight NOTIFY displaySizeChanged)
+    Q_PROPERTY(QSize sizeLimit READ getSizeLimit NOTIFY displaySizeChanged)
+    Q_PROPERTY(bool adaptiveJitter READ getAdaptiveJitter WRITE setAdaptiveJitter NOTIFY jitterLatencyChanged)
+    Q_PROPERTY(int minJitterLatency READ getMinJitterLatency WRITE setMinJitterLatency NOTIFY jitterLatencyChanged)
+    Q_PROPERTY(int maxJitterLatency READ getMaxJitterLatency WRITE setMaxJitterLatency NOTIFY jitterLatencyChanged)
+    Q_PROPERTY(int jitterLatency READ getJitterLatency NOTIFY jitterLatencyChanged)
+    Q_PROPERTY(int minPoolBuffers READ getMinPoolBuffers WRITE setMinPoolBuffers NOTIFY poolBuffersChanged)
+    Q_PROPERTY(int maxPoolBuffers READ getMaxPoolBuffers WRITE setMaxPoolBuffers NOTIFY poolBuffersChanged)
 
     explicit GStreamerPlayer(QObject *parent = 0);
     ~GStreamerPlayer();
 
     void setVideoSink(const QGst::ElementPtr & sink);
 
+    /** @brief Live frame rate / drop / latency statistics, see GStreamerStats */
+    QObject* getStats()
+    {
+        return m_stats;
+    }
+
+    /** @brief Pass-through recording of the displayed stream, see GStreamerRecorder */
+    QObject* getRecorder()
+    {
+        return m_recorder;
+    }
+
+    /** @brief RTSP server forwarding the displayed stream undecoded, see GStreamerRestreamer */
+    QObject* getRestreamer()
+    {
+        return m_restreamer;
+    }
+
+    /** @brief Stills from the last decoded frames, see GStreamerSnapshot */
+    QObject* getSnapshot()
+    {
+        return m_snapshot;
+    }
+
+    // Colour balance values are cached, the sink is only read once in
+    // setVideoSink() and written when a value actually changes. qt5videosink
+    // applies them as the colour matrix uniform of its video shader.
     int getBrightness()
     {
-        m_brightness = m_videoSink->property("brightness").toInt();
         return m_brightness;
     }
 
     int getContrast()
     {
-        m_contrast = m_videoSink->property("contrast").toInt();
         return m_contrast;
     }
 
     int getHue()
     {
-        m_hue = m_videoSink->property("hue").toInt();
         return m_hue;
     }
 
     int getSaturation()
     {
-        m_saturation = m_videoSink->property("saturation").toInt();
         return m_saturation;
     }
 
@@ -80,6 +176,392 @@ public:
         return m_stopped;
     }
 
+    bool getZeroCopy()
+    {
+        return m_zeroCopy;
+    }
+
+    /** @brief The caps the video sink was actually linked with */
+    QString getVideoCaps()
+    {
+        return m_videoCaps;
+    }
+
+    QString getLatencyProfile()
+    {
+        return m_latencyProfile;
+    }
+
+    /** @brief Names of the available latency profiles, "custom" leaves the pipeline string untouched */
+    static QStringList getLatencyProfiles();
+
+    void setLatencyProfile(const QString & profile);
+
+    /** @brief Names of the pipeline strings for sources that recover lost packets: SRT, RTP with FEC, RIST */
+    static QStringList getSourcePresets();
+    /** @brief The pipeline string of a preset receiving from host, empty for an unknown name */
+    Q_INVOKABLE QString sourcePreset(const QString & name, const QString & host) const;
+
+    int getSuspendMode()
+    {
+        return m_suspendMode;
+    }
+
+    void setSuspendMode(int mode)
+    {
+        if (mode < SuspendStop || mode > SuspendPaused) return;
+        if (m_suspendMode != mode)
+        {
+            m_suspendMode = (SuspendMode)mode;
+            emit suspendModeChanged(m_suspendMode);
+        }
+    }
+
+    QString getStandbyPipelineString()
+    {
+        return m_standbyPipelineString;
+    }
+
+    /** @brief True once the standby pipeline has decoded its first frame */
+    bool getStandbyReady()
+    {
+        return m_standbyReady;
+    }
+
+    /** @brief 0 is the most important stream, higher values are degraded first when decoding saturates */
+    int getDecodePriority()
+    {
+        return m_decodePriority;
+    }
+
+    void setDecodePriority(int priority)
+    {
+        if (m_decodePriority != priority)
+        {
+            m_decodePriority = priority;
+            emit decodePriorityChanged(m_decodePriority);
+        }
+    }
+
+    int getDegradeLevel()
+    {
+        return m_degradeLevel.load();
+    }
+
+    void setDegradeLevel(int level);
+
+    /** @brief Frames per second handed to the sink at most, by buffer timestamp. 0 shows every frame */
+    int getMaxFps()
+    {
+        return m_maxFps.load();
+    }
+
+    void setMaxFps(int fps)
+    {
+        fps = qMax(0, fps);
+        if (m_maxFps.load() != fps)
+        {
+            m_maxFps = fps;
+            emit maxFpsChanged(fps);
+        }
+    }
+
+    /**
+     * @brief Keep the stream connected but skip decoding while the video is not shown
+     *
+     * Buffers are dropped in front of the decoders, after the recording and
+     * restreaming tee, so recordings go on and showing the video again does
+     * not renegotiate with the camera. HiddenDropAll asks for a key frame
+     * when shown and holds back delta frames until one arrives, at most
+     * KeyFrameWaitMs; HiddenKeyFrames keeps the decoder's references warm
+     * for about one frame per GOP.
+     */
+    bool getHidden()
+    {
+        return m_hidden;
+    }
+
+    void setHidden(bool hidden);
+
+    int getHiddenMode()
+    {
+        return m_hiddenMode;
+    }
+
+    void setHiddenMode(int mode)
+    {
+        mode = qBound((int)HiddenStop, mode, (int)HiddenKeyFrames);
+        if (m_hiddenMode != mode)
+        {
+            // Takes effect the next time the video is hidden
+            m_hiddenMode = mode;
+            emit hiddenChanged(m_hidden);
+        }
+    }
+
+    /**
+     * @brief GStreamerFramePacer::PacingMode of the video sink
+     *
+     * Latency profiles with a synchronised sink leave the timing to the sink
+     * and always get PaceMinLatency.
+     */
+    int getFramePacing()
+    {
+        return m_framePacing;
+    }
+
+    void setFramePacing(int mode);
+
+    /** @brief Replace H.264/H.265 decoders in the pipeline string with the best one found, see GStreamerDecoderProbe */
+    bool getAutoDecoder()
+    {
+        return m_autoDecoder;
+    }
+
+    void setAutoDecoder(bool autoDecoder)
+    {
+        if (m_autoDecoder != autoDecoder)
+        {
+            m_autoDecoder = autoDecoder;
+            emit autoDecoderChanged(m_autoDecoder);
+
+            // Rebuild the pipeline with the other decoder on next play()
+            m_currentPipelineString = "";
+        }
+    }
+
+    /** @brief Longest wait in ms for the EOS to drain (and finalize muxers) before forcing a stop */
+    int getStopTimeout()
+    {
+        return m_stopTimeout;
+    }
+
+    void setStopTimeout(int stopTimeout)
+    {
+        if (m_stopTimeout != stopTimeout && stopTimeout > 0)
+        {
+            m_stopTimeout = stopTimeout;
+            emit stopTimeoutChanged(m_stopTimeout);
+        }
+    }
+
+    /**
+     * @brief Ask upstream for a key frame when the picture is likely corrupt
+     *
+     * Triggered by decoder warnings/errors, new jitterbuffer losses and
+     * packets arriving without frames coming out of the decoder.
+     */
+    bool getAutoKeyFrame()
+    {
+        return m_autoKeyFrame;
+    }
+
+    void setAutoKeyFrame(bool autoKeyFrame)
+    {
+        if (m_autoKeyFrame != autoKeyFrame)
+        {
+            m_autoKeyFrame = autoKeyFrame;
+            emit autoKeyFrameChanged(m_autoKeyFrame);
+        }
+    }
+
+    /**
+     * @brief Restart the source when no buffer reached the video sink for this long, 0 turns the watchdog off
+     *
+     * A frozen RTSP or UDP stream posts no error, the last frame just stays
+     * on screen. Only the source elements are flushed and cycled through NULL,
+     * the decoder and sink keep their state. After MaxSourceRestarts such
+     * restarts without a frame the whole pipeline is rebuilt.
+     */
+    int getStallTimeoutMs()
+    {
+        return m_stallTimeoutMs;
+    }
+
+    void setStallTimeoutMs(int ms)
+    {
+        ms = qMax(0, ms);
+        if (m_stallTimeoutMs != ms)
+        {
+            m_stallTimeoutMs = ms;
+            emit stallTimeoutMsChanged(m_stallTimeoutMs);
+        }
+    }
+
+    /** @brief No frame for stallTimeoutMs while playing and shown */
+    bool getStalled()
+    {
+        return m_stalled;
+    }
+
+    /** @brief Source restarts done by the stall watchdog since the player was created */
+    int getSourceRestarts()
+    {
+        return m_sourceRestarts;
+    }
+
+    /** @brief Key frame requests sent upstream since the pipeline was built */
+    int getKeyFrameRequests()
+    {
+        return m_keyFrameRequests;
+    }
+
+    /**
+     * @brief Hold as little video as possible, see MemoryBudget
+     *
+     * Caps every queue of the pipelines to LowMemoryQueueBuffers buffers
+     * and frees the standby pipeline. Turning it off restores the queues;
+     * a standby pipeline has to be prepared again.
+     */
+    bool getLowMemory()
+    {
+        return m_lowMemory;
+    }
+
+    void setLowMemory(bool lowMemory);
+
+    /**
+     * @brief Device pixels the video is shown in, set from the item's size
+     *
+     * With adaptiveSize the decoded frames are scaled down before the
+     * mailbox to the smallest of SizeSteps that still covers the view, so
+     * a picture-in-picture stream is not uploaded at 1080p. The steps keep
+     * a resizing item from renegotiating on every pixel. Only system
+     * memory frames can be scaled; GL and EGL frames are not uploaded and
+     * stay as decoded. Snapshots are taken from the scaled frames.
+     */
+    QSize getDisplaySize()
+    {
+        return m_displaySize;
+    }
+
+    void setDisplaySize(const QSize & size);
+
+    bool getAdaptiveSize()
+    {
+        return m_adaptiveSize;
+    }
+
+    void setAdaptiveSize(bool adaptive);
+
+    /**
+     * @brief Frames taller than this are scaled down before the mailbox, 0 does not cap them
+     *
+     * Applies with or without adaptiveSize, the smaller limit wins. Like
+     * adaptiveSize it only scales system memory frames.
+     */
+    int getMaxVideoHeight()
+    {
+        return m_maxVideoHeight;
+    }
+
+    void setMaxVideoHeight(int height);
+
+    /** @brief Largest frame the sink is given, invalid while frames are not scaled */
+    QSize getSizeLimit()
+    {
+        return m_sizeLimit;
+    }
+
+    /**
+     * @brief Size the rtpjitterbuffer latency from the measured network jitter
+     *
+     * Once per stats sample the latency of every jitterbuffer is set to
+     * JitterMultiplier times the average arrival jitter plus JitterMarginMs,
+     * within minJitterLatency..maxJitterLatency. Late packets raise it at
+     * once by half; it only comes down after JitterShrinkSamples samples
+     * without late packets, a quarter of the way per sample, so latency is
+     * added quickly and given back slowly. The pipeline string's latency is
+     * the starting point.
+     */
+    bool getAdaptiveJitter()
+    {
+        return m_adaptiveJitter;
+    }
+
+    void setAdaptiveJitter(bool adaptive);
+
+    /** @brief Bounds of the adaptive latency in ms */
+    int getMinJitterLatency()
+    {
+        return m_minJitterLatency;
+    }
+
+    void setMinJitterLatency(int ms);
+
+    int getMaxJitterLatency()
+    {
+        return m_maxJitterLatency;
+    }
+
+    void setMaxJitterLatency(int ms);
+
+    /** @brief Latency in ms the jitterbuffers were last set to, 0 before the first sample */
+    int getJitterLatency()
+    {
+        return m_jitterLatency;
+    }
+
+    /**
+     * @brief Buffers of the pool proposed to the decoder for the sink's frames
+     *
+     * The sink's allocation query is answered with a video buffer pool of
+     * frames sized from the negotiated caps and PoolMemoryAlign aligned, so
+     * decoders write into preallocated memory instead of allocating a frame
+     * each time. minPoolBuffers are allocated when the pool starts; it grows
+     * up to maxPoolBuffers, 0 is unlimited, and the decoder waits for a free
+     * frame beyond that. The maximum is kept above what the snapshot ring
+     * holds; in lowMemory it is the minimum. GL and EGL frames come from
+     * the GL elements' own pools. A change applies at the next allocation
+     * query, which is asked for at once.
+     */
+    int getMinPoolBuffers()
+    {
+        return m_minPoolBuffers.load();
+    }
+
+    void setMinPoolBuffers(int buffers);
+
+    int getMaxPoolBuffers()
+    {
+        return m_maxPoolBuffers.load();
+    }
+
+    void setMaxPoolBuffers(int buffers);
+
+    /** @brief Bytes waiting in the queues of the displayed and standby pipelines */
+    qint64 queuedBytes();
+
+    /**
+     * @brief Flushing seek of a file pipeline, to the key frame before positionNs unless accurate
+     *
+     * rate scales the playback speed from there. The seek completes with
+     * asyncDone(), once the frame at the new position is shown.
+     */
+    Q_INVOKABLE bool seek(qint64 positionNs, bool accurate, double rate = 1.0);
+    /** @brief Stream position and length in nanoseconds, -1 when unknown (live sources) */
+    qint64 queryPosition();
+    qint64 queryDuration();
+
+    /** @brief The decoder element factory in the displayed pipeline */
+    QString getVideoDecoder()
+    {
+        return m_videoDecoder;
+    }
+
+    void setZeroCopy(bool zeroCopy)
+    {
+        if (m_zeroCopy != zeroCopy)
+        {
+            m_zeroCopy = zeroCopy;
+            m_zeroCopyFailed = false;
+            emit zeroCopyChanged(m_zeroCopy);
+
+            // Force the pipeline to be rebuilt with the new caps on next play()
+            m_currentPipelineString = "";
+        }
+    }
+
     void setPlaying(bool play)
     {
         play ? m_playing = this->play() : m_playing = false;
@@ -95,16 +577,23 @@ public:
 
     void setStopped(bool)
     {
-        // First send EOS in case the stream is going to a file
-        if (!m_stopTimer.isActive())
+        // First send EOS in case the stream is going to a file, the stop
+        // completes when it is seen on the bus or after stopTimeout
+        if (m_stopTimer.isActive()) return;
+
+        if (m_pipeline.isNull() || !m_playing)
         {
-            sendEOS();
-            m_stopTimer.start(1000);
+            // Nothing flows in PAUSED/NULL, the EOS would never arrive
+            finishStop();
+            return;
         }
+        sendEOS();
+        m_stopTimer.start(m_stopTimeout);
     }
 
     void setBrightness(int brightness)
     {
+        if (m_brightness == brightness) return;
         m_brightness = brightness;
         emit brightnessChanged(brightness);
         m_videoSink->setProperty("brightness", brightness);
@@ -112,6 +601,7 @@ public:
 
     void setContrast(int contrast)
     {
+        if (m_contrast == contrast) return;
         m_contrast = contrast;
         emit contrastChanged(contrast);
         m_videoSink->setProperty("contrast", contrast);
@@ -119,6 +609,7 @@ public:
 
     void setHue(int hue)
     {
+        if (m_hue == hue) return;
         m_hue = hue;
         emit hueChanged(hue);
         m_videoSink->setProperty("hue", hue);
@@ -126,6 +617,7 @@ public:
 
     void setSaturation(int saturation)
     {
+        if (m_saturation == saturation) return;
         m_saturation = saturation;
         emit saturationChanged(saturation);
         m_videoSink->setProperty("saturation", saturation);
@@ -135,10 +627,35 @@ public Q_SLOTS:
     bool play();
     void pause();
     void stop();
+    void suspend();
+    void resume();
 	void toggleFullScreen();
     void onStopTimer();
 
     void initialize();
+    void onPipelineBuilt();
+
+    /** @brief Build a second pipeline and keep it running, not displayed, for an instant switch */
+    void prepareStandby(const QString & pipelineString);
+    /** @brief Show the standby pipeline, as soon as it has produced a frame. The active one becomes standby */
+    void switchToStandby();
+    /** @brief Stop and free the standby pipeline */
+    void releaseStandby();
+    void onStandbyBuilt();
+    void checkDecodeHealth();
+    void adaptJitterLatency();
+    void onStandbyFirstFrame();
+    /** @brief Let delta frames through again although no key frame came, see setHidden() */
+    void openDecodeGate();
+    /** @brief Stall watchdog, every StallCheckMs */
+    void checkStall();
+    /**
+     * @brief Send a GstForceKeyUnit event up from the video sink, at most once per KeyFrameRequestIntervalMs
+     *
+     * Encoders and rtspsrc honour it directly. An rtpbin session (with
+     * rtp-profile=avpf) turns it into an RTCP PLI, or a FIR.
+     */
+    bool requestKeyFrame();
     void setPipelineString(const QString & pipelineString)
     {
         m_pipelineString = pipelineString;
@@ -152,20 +669,107 @@ signals:
     void playingChanged(bool);
     void pausedChanged(bool);
     void stoppedChanged(bool);
+    void zeroCopyChanged(bool);
+    void videoCapsChanged(QString);
+    void latencyProfileChanged(QString);
+    void suspendModeChanged(int);
+    void decodePriorityChanged(int);
+    void degradeLevelChanged(int);
+    void maxFpsChanged(int);
+    void hiddenChanged(bool);
+    void framePacingChanged(int);
+    void stallTimeoutMsChanged(int);
+    void stalledChanged(bool);
+    void autoDecoderChanged(bool);
+    void stopTimeoutChanged(int);
+    void autoKeyFrameChanged(bool);
+    void keyFrameRequested(int count);
+    void videoDecoderChanged(QString);
+    void lowMemoryChanged(bool);
+    void displaySizeChanged();
+    void jitterLatencyChanged();
+    void poolBuffersChanged();
     void messageBox(QString text);
+    /** @brief Emitted on the UI thread when an asynchronous pipeline build completed */
+    void initialized(bool success);
+    void standbyChanged();
+    /** @brief The displayed pipeline was swapped with the standby one */
+    void pipelineSwitched(QString pipelineString);
+    /** @brief A state change or flushing seek of the displayed pipeline completed */
+    void asyncDone();
 
 private:
     void onBusMessage(const QGst::MessagePtr & message);
     void handlePipelineStateChange(const QGst::StateChangedMessagePtr & scm);
     void sendEOS();
+    void finishStop();
+    QStringList videoCapsCandidates() const;
+    QString applyLatencyProfile(const QString & pipelineString) const;
+    QString tunePipelineString(const QString & pipelineString) const;
+    void updateVideoDecoder();
+    void onStandbyBusMessage(const QGst::MessagePtr & message);
+    void onStandbyHandoff(const QGst::BufferPtr & buffer, const QGst::PadPtr & pad);
+    void swapPipelines();
+    void applyDegradeLevel(const QGst::PipelinePtr & pipeline);
+    void applyLowMemory(const QGst::PipelinePtr & pipeline);
+    void updateSizeLimit();
+    void applySizeLimit(const QGst::PipelinePtr & pipeline);
+    int readJitterLatency();
+    void applyJitterLatency(int ms);
+    static qint64 queuedBytes(const QGst::PipelinePtr & pipeline);
+    void installDegradeProbe(const QGst::ElementPtr & tail);
+    /** @brief Put the setHidden() gate on the sink pad of each video decoder, once per pad */
+    void installDecodeGate(const QGst::PipelinePtr & pipeline);
+    void applyFramePacing();
+    /** @brief Flush and cycle the source elements through NULL, see getStallTimeoutMs() */
+    bool restartSource();
+    static void onSourcePadAdded(GstElement *source, GstPad *pad, gpointer user_data);
+    static GstPadProbeReturn onSinkBuffer(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn onDecodeGate(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static void watchStreamingThreads(const QGst::BusPtr & bus);
+    static void onStreamStatus(GstBus *bus, GstMessage *message, gpointer user_data);
+    static GstPadProbeReturn onDegradeProbe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static bool isVideoDecoder(GstObject *object);
+    static GstPadProbeReturn onAllocationQuery(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    void requestReallocation();
+    void resetKeyFrameWatchdog();
+
+    enum { KeyFrameRequestIntervalMs = 1000, LowMemoryQueueBuffers = 2, KeyFrameWaitMs = 2000 };
+    enum { StallCheckMs = 250, DefaultStallTimeoutMs = 2000, MaxSourceRestarts = 3 };
+    /** @brief What onDecodeGate() lets through to the decoders */
+    enum DecodeGate { GateOpen = 0, GateClosed, GateKeyFrames, GateWaitKeyFrame };
+    enum { JitterMultiplier = 4, JitterMarginMs = 10, JitterShrinkSamples = 10 };
+    enum { PoolMemoryAlign = 64 };
 
     QTimer m_stopTimer;
 
     QGst::PipelinePtr m_pipeline;
     QGst::ElementPtr m_videoSink;
+    GStreamerPipelineBuilder m_builder;
+    GStreamerStats *m_stats;
+    GStreamerRecorder *m_recorder;
+    GStreamerRestreamer *m_restreamer;
+    GStreamerSnapshot *m_snapshot;
+    QGst::State m_targetState;  ///< State requested while a pipeline is (re)built
+    QGst::ElementPtr m_tailElement;
+    QGst::ElementPtr m_recordingTee;
+    QString m_depayloaderName;
+
+    // Hot standby: a second pipeline streaming into a fakesink
+    GStreamerPipelineBuilder m_standbyBuilder;
+    QGst::PipelinePtr m_standbyPipeline;
+    QGst::ElementPtr m_standbySink;
+    QGst::ElementPtr m_standbyTailElement;
+    QGst::ElementPtr m_standbyRecordingTee;
+    QString m_standbyDepayloaderName;
+    QString m_standbyPipelineString;
+    QAtomicInt m_standbyFrameSeen;
+    bool m_standbyReady;
+    bool m_switchPending;
 
     QString m_currentPipelineString;
     QString m_pipelineString;
+    QString m_buildingPipelineString;
 
     int m_brightness;
     int m_contrast;
@@ -176,6 +780,56 @@ private:
     bool m_paused;
     bool m_stopped;
 
+    bool m_zeroCopy;        ///< Try to hand decoder buffers to the sink without a system memory copy
+    bool m_zeroCopyFailed;  ///< Zero-copy caps failed to negotiate, only use I420 until re-enabled
+    QString m_videoCaps;
+    QString m_latencyProfile;
+    SuspendMode m_suspendMode;
+    bool m_suspended;
+    int m_decodePriority;
+    QAtomicInt m_degradeLevel;   ///< DegradeLevel, read by the streaming thread
+    bool m_hidden;
+    int m_hiddenMode;            ///< HiddenMode
+    int m_framePacing;           ///< GStreamerFramePacer::PacingMode
+    QAtomicInt m_decodeGate;     ///< DecodeGate, read by the streaming thread
+    QAtomicInt m_degradeFrames;
+    QAtomicInt m_maxFps;         ///< Read by the streaming thread
+    quint64 m_maxFpsLastPts;     ///< Streaming thread only, pts of the last frame let through
+    bool m_autoDecoder;
+    int m_stopTimeout;
+    QString m_videoDecoder;
+    bool m_lowMemory;
+    QSize m_displaySize;
+    bool m_adaptiveSize;
+    int m_maxVideoHeight;
+    QSize m_sizeLimit;
+    QAtomicInt m_minPoolBuffers;    ///< Read by the streaming thread
+    QAtomicInt m_maxPoolBuffers;
+
+    // Adaptive jitterbuffer latency
+    bool m_adaptiveJitter;
+    int m_minJitterLatency;
+    int m_maxJitterLatency;
+    int m_jitterLatency;
+    int m_jitterCleanSamples;
+    quint64 m_jitterLate;       ///< late packets at the last sample
+
+    // Decoder starvation watchdog
+    bool m_autoKeyFrame;
+    int m_keyFrameRequests;
+    QElapsedTimer m_lastKeyFrameRequest;
+    quint64 m_watchdogLost;     ///< jitterbuffer losses at the last stats sample
+
+    // Stall watchdog
+    QTimer m_stallTimer;
+    QElapsedTimer m_bufferClock;
+    QAtomicInt m_lastBufferMs;  ///< m_bufferClock time of the last buffer at the sink, set by the streaming thread
+    int m_stallTimeoutMs;
+    bool m_stalled;
+    QElapsedTimer m_stallTime;  ///< Since the stall was noticed
+    int m_stallRestarts;        ///< Source restarts during this stall
+    qint64 m_nextRestartMs;     ///< m_stallTime of the next attempt
+    int m_sourceRestarts;
 
 };
 
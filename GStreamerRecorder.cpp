@@ -0,0 +1,374 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerRecorder.h"
+#include "GStreamerRecordingIndexer.h"
+#include "configuration.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <qmath.h>
+
+GStreamerRecorder::GStreamerRecorder(QObject *parent)
+    : QObject(parent),
+      m_format("mp4"),
+      m_branch(NULL),
+      m_teePad(NULL),
+      m_stopping(false),
+      m_telemetryTrack(true),
+      m_telemetrySrc(NULL),
+      m_telemetryPool(NULL),
+      m_lastTelemetryPts(GST_CLOCK_TIME_NONE)
+{
+}
+
+GStreamerRecorder::~GStreamerRecorder()
+{
+    removeBranch();
+}
+
+void GStreamerRecorder::setPipeline(const QGst::PipelinePtr & pipeline, const QGst::ElementPtr & tee, const QString & depayloaderName)
+{
+    // A recording cannot follow the stream into another pipeline, close it
+    if (m_branch != NULL && pipeline != m_pipeline)
+    {
+        removeBranch();
+    }
+
+    m_pipeline = pipeline;
+    m_tee = tee;
+    m_depayloaderName = depayloaderName;
+    emit availableChanged(isAvailable());
+}
+
+void GStreamerRecorder::setFormat(const QString & format)
+{
+    if (format != "mp4" && format != "mkv")
+    {
+        qCritical() << "Unsupported recording format" << format;
+        return;
+    }
+    if (m_format != format)
+    {
+        m_format = format;
+        emit formatChanged(m_format);
+    }
+}
+
+void GStreamerRecorder::setTelemetryTrack(bool enabled)
+{
+    if (m_telemetryTrack != enabled)
+    {
+        m_telemetryTrack = enabled;
+        emit telemetryTrackChanged(enabled);
+    }
+}
+
+void GStreamerRecorder::setTelemetry(const Telemetry & telemetry)
+{
+    QMutexLocker locker(&m_telemetryMutex);
+    m_telemetry = telemetry;
+}
+
+bool GStreamerRecorder::muxerHasTextPad(const QString & muxer)
+{
+    GstElementFactory *factory = gst_element_factory_find(muxer.toUtf8().constData());
+    if (factory == NULL) return false;
+
+    bool found = false;
+    const GList *templates = gst_element_factory_get_static_pad_templates(factory);
+    for (const GList *item = templates; item != NULL && !found; item = item->next)
+    {
+        GstStaticPadTemplate *padTemplate = static_cast<GstStaticPadTemplate*>(item->data);
+        found = padTemplate->direction == GST_PAD_SINK && g_str_has_prefix(padTemplate->name_template, "subtitle_");
+    }
+    gst_object_unref(factory);
+    return found;
+}
+
+QString GStreamerRecorder::parserFor(const QString & depayloaderName)
+{
+    if (depayloaderName == "rtph264depay") return "h264parse";
+    if (depayloaderName == "rtph265depay") return "h265parse";
+    if (depayloaderName == "rtpmp4vdepay") return "mpeg4videoparse";
+    if (depayloaderName == "rtpjpegdepay") return "jpegparse";
+    return "";
+}
+
+QString GStreamerRecorder::readerPipeline(const QString & videoFileName, bool decode)
+{
+    // Recordings without a sidecar predate the other codecs
+    QSettings sync(syncFileName(videoFileName), QSettings::IniFormat);
+    QString parser = sync.value("parser", "h264parse").toString();
+    QString demuxer = QFileInfo(videoFileName).suffix().toLower() == "mkv" ? "matroskademux" : "qtdemux";
+    QString description = QString("filesrc location=\"%1\" ! %2 ! %3")
+            .arg(QDir::fromNativeSeparators(videoFileName), demuxer, parser);
+    if (!decode) return description;
+
+    QString decoder = "avdec_h264";
+    if (parser == "h265parse") decoder = "avdec_h265";
+    else if (parser == "mpeg4videoparse") decoder = "avdec_mpeg4";
+    else if (parser == "jpegparse") decoder = "jpegdec";
+    return description + " ! queue ! " + decoder;
+}
+
+bool GStreamerRecorder::startRecording()
+{
+    if (m_branch != NULL || !isAvailable()) return false;
+
+    m_fileName = QGC::videoDirectory() + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss") + "." + m_format;
+    QString muxer = (m_format == "mkv") ? "matroskamux" : "mp4mux";
+
+    // async=false so the branch never holds up state changes of the display pipeline
+    QString description = QString("queue ! %1 ! %2 name=recordmux ! filesink name=recordsink async=false location=\"%3\"")
+            .arg(parserFor(m_depayloaderName), muxer, m_fileName);
+
+    // Timestamps are copied from the video buffers, so the text track stays in step with the frames
+    bool telemetry = m_telemetryTrack && muxerHasTextPad(muxer);
+    if (telemetry)
+    {
+        description += " appsrc name=telemetrysrc format=time is-live=true do-timestamp=false"
+                       " caps=\"text/x-raw,format=(string)utf8\" ! queue ! recordmux.";
+    }
+    else if (m_telemetryTrack)
+    {
+        qDebug() << muxer << "has no text track, recording without telemetry";
+    }
+
+    GError *error = NULL;
+    GstElement *branch = gst_parse_bin_from_description(description.toUtf8().constData(), TRUE, &error);
+    if (branch == NULL)
+    {
+        qCritical() << "Failed to create recording branch:" << (error ? error->message : "");
+        if (error) g_error_free(error);
+        return false;
+    }
+
+    gst_bin_add(GST_BIN((GstPipeline*)m_pipeline), branch);
+
+    GstPad *teePad = gst_element_get_request_pad((GstElement*)m_tee, "src_%u");
+    GstPad *sinkPad = gst_element_get_static_pad(branch, "sink");
+    if (gst_pad_link(teePad, sinkPad) != GST_PAD_LINK_OK)
+    {
+        qCritical() << "Failed to link recording branch";
+        gst_object_unref(sinkPad);
+        gst_element_release_request_pad((GstElement*)m_tee, teePad);
+        gst_object_unref(teePad);
+        gst_bin_remove(GST_BIN((GstPipeline*)m_pipeline), branch);
+        return false;
+    }
+    if (telemetry)
+    {
+        m_telemetrySrc = gst_bin_get_by_name(GST_BIN(branch), "telemetrysrc");
+        GstCaps *caps = gst_caps_new_simple("text/x-raw", "format", G_TYPE_STRING, "utf8", NULL);
+        m_telemetryPool = gst_buffer_pool_new();
+        GstStructure *config = gst_buffer_pool_get_config(m_telemetryPool);
+        gst_buffer_pool_config_set_params(config, caps, TelemetryLineSize, TelemetryPoolBuffers, 0);
+        gst_buffer_pool_set_config(m_telemetryPool, config);
+        gst_buffer_pool_set_active(m_telemetryPool, TRUE);
+        gst_caps_unref(caps);
+        m_lastTelemetryPts = GST_CLOCK_TIME_NONE;
+        gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerRecorder::telemetryProbe, this, NULL);
+    }
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerRecorder::firstBufferProbe, this, NULL);
+    gst_object_unref(sinkPad);
+
+    // Know when the EOS has made it through the muxer, the file is complete then
+    GstElement *fileSink = gst_bin_get_by_name(GST_BIN(branch), "recordsink");
+    GstPad *fileSinkPad = gst_element_get_static_pad(fileSink, "sink");
+    gst_pad_add_probe(fileSinkPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, &GStreamerRecorder::fileSinkEventProbe, this, NULL);
+    gst_object_unref(fileSinkPad);
+    gst_object_unref(fileSink);
+
+    gst_element_sync_state_with_parent(branch);
+
+    m_branch = branch;
+    m_teePad = teePad;
+    m_stopping = false;
+
+    qDebug() << "Recording video to" << m_fileName;
+    emit recordingChanged(true);
+    return true;
+}
+
+void GStreamerRecorder::stopRecording()
+{
+    if (m_branch == NULL || m_stopping) return;
+    m_stopping = true;
+
+    gst_pad_add_probe(m_teePad, GST_PAD_PROBE_TYPE_IDLE, &GStreamerRecorder::teeIdleProbe, this, NULL);
+}
+
+// Runs on the streaming thread (or right away if the pad is idle)
+GstPadProbeReturn GStreamerRecorder::teeIdleProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Q_UNUSED(info);
+    GStreamerRecorder *self = static_cast<GStreamerRecorder*>(userData);
+
+    GstPad *peer = gst_pad_get_peer(pad);
+    if (peer != NULL)
+    {
+        gst_pad_unlink(pad, peer);
+        gst_pad_send_event(peer, gst_event_new_eos());
+        gst_object_unref(peer);
+    }
+    // The muxer only finalizes once every track has ended
+    self->endTelemetry();
+
+    QMetaObject::invokeMethod(self, "releaseTeePad", Qt::QueuedConnection);
+    return GST_PAD_PROBE_REMOVE;
+}
+
+GstPadProbeReturn GStreamerRecorder::telemetryProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Q_UNUSED(pad);
+    static_cast<GStreamerRecorder*>(userData)->pushTelemetry(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+// Streaming thread, once per video frame
+void GStreamerRecorder::pushTelemetry(GstBuffer *video)
+{
+    GstClockTime pts = GST_BUFFER_PTS(video);
+    // Depayloaders may push a frame in several buffers sharing one timestamp
+    if (m_telemetrySrc == NULL || !GST_CLOCK_TIME_IS_VALID(pts) || pts == m_lastTelemetryPts) return;
+    m_lastTelemetryPts = pts;
+
+    Telemetry t;
+    {
+        QMutexLocker locker(&m_telemetryMutex);
+        t = m_telemetry;
+    }
+
+    GstBuffer *text = NULL;
+    if (gst_buffer_pool_acquire_buffer(m_telemetryPool, &text, NULL) != GST_FLOW_OK) return;
+
+    GstMapInfo map;
+    if (!gst_buffer_map(text, &map, GST_MAP_WRITE))
+    {
+        gst_buffer_unref(text);
+        return;
+    }
+    int length = qsnprintf(reinterpret_cast<char*>(map.data), map.maxsize,
+                           "t=%u lat=%.7f lon=%.7f alt=%.1f ralt=%.1f roll=%.2f pitch=%.2f yaw=%.2f hdg=%.0f gs=%.1f",
+                           t.timeBootMs, t.lat, t.lon, t.alt, t.relativeAlt,
+                           t.roll * 180.0 / M_PI, t.pitch * 180.0 / M_PI, t.yaw * 180.0 / M_PI,
+                           t.heading, t.groundspeed);
+    gst_buffer_unmap(text, &map);
+    gst_buffer_set_size(text, qBound(0, length, int(map.maxsize) - 1));
+
+    GST_BUFFER_PTS(text) = pts;
+    GST_BUFFER_DURATION(text) = GST_BUFFER_DURATION(video);
+
+    GstFlowReturn ret;
+    g_signal_emit_by_name(m_telemetrySrc, "push-buffer", text, &ret);
+    gst_buffer_unref(text);
+}
+
+void GStreamerRecorder::endTelemetry()
+{
+    if (m_telemetrySrc == NULL) return;
+    GstFlowReturn ret;
+    g_signal_emit_by_name(m_telemetrySrc, "end-of-stream", &ret);
+}
+
+// Streaming thread, the muxer starts the file at this frame
+GstPadProbeReturn GStreamerRecorder::firstBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Q_UNUSED(pad);
+    Q_UNUSED(info);
+    qint64 startUsec = QDateTime::currentMSecsSinceEpoch() * 1000;
+    QMetaObject::invokeMethod(static_cast<GStreamerRecorder*>(userData), "writeSyncFile", Qt::QueuedConnection,
+                              Q_ARG(qint64, startUsec));
+    return GST_PAD_PROBE_REMOVE;
+}
+
+void GStreamerRecorder::writeSyncFile(qint64 startUsec)
+{
+    if (m_branch == NULL) return;
+    QSettings sync(syncFileName(m_fileName), QSettings::IniFormat);
+    sync.setValue("startTime", startUsec);
+    sync.setValue("parser", parserFor(m_depayloaderName));
+}
+
+GstPadProbeReturn GStreamerRecorder::fileSinkEventProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Q_UNUSED(pad);
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_EOS)
+    {
+        QMetaObject::invokeMethod(static_cast<GStreamerRecorder*>(userData), "onBranchEos", Qt::QueuedConnection);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void GStreamerRecorder::releaseTeePad()
+{
+    if (m_teePad != NULL && !m_tee.isNull())
+    {
+        gst_element_release_request_pad((GstElement*)m_tee, m_teePad);
+        gst_object_unref(m_teePad);
+        m_teePad = NULL;
+    }
+}
+
+void GStreamerRecorder::onBranchEos()
+{
+    QString fileName = m_fileName;
+    removeBranch();
+    qDebug() << "Recording finalized" << fileName;
+    GStreamerRecordingIndexer::instance()->enqueue(fileName);
+    emit recordingFinished(fileName);
+}
+
+void GStreamerRecorder::removeBranch()
+{
+    if (m_branch == NULL) return;
+
+    if (m_teePad != NULL)
+    {
+        GstPad *peer = gst_pad_get_peer(m_teePad);
+        if (peer != NULL)
+        {
+            gst_pad_unlink(m_teePad, peer);
+            gst_object_unref(peer);
+        }
+        releaseTeePad();
+    }
+
+    gst_element_set_state(m_branch, GST_STATE_NULL);
+    if (m_telemetrySrc != NULL)
+    {
+        gst_object_unref(m_telemetrySrc);
+        m_telemetrySrc = NULL;
+    }
+    if (m_telemetryPool != NULL)
+    {
+        gst_buffer_pool_set_active(m_telemetryPool, FALSE);
+        gst_object_unref(m_telemetryPool);
+        m_telemetryPool = NULL;
+    }
+    if (!m_pipeline.isNull())
+    {
+        gst_bin_remove(GST_BIN((GstPipeline*)m_pipeline), m_branch);
+    }
+    m_branch = NULL;
+    m_stopping = false;
+    emit recordingChanged(false);
+}
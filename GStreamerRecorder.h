@@ -0,0 +1,149 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerRecorder_H
+#define GStreamerRecorder_H
+
+#include <QObject>
+#include <QStringList>
+#include <QMutex>
+#include <QGst/Pipeline>
+#include <QGst/Element>
+#include <gst/gst.h>
+
+/**
+ * @brief Pass-through recording of the compressed video stream
+ *
+ * A branch "queue ! parser ! muxer ! filesink" is attached to the tee the
+ * pipeline builder inserted after the RTP depayloader. Stopping blocks just
+ * that tee pad, sends EOS down the branch and removes it once the EOS has
+ * reached the filesink, so the muxer can finalize the file while the display
+ * branch keeps running.
+ *
+ * When the muxer accepts a text track, the latest telemetry is written next
+ * to the video as one UTF-8 line per frame, stamped with that frame's PTS.
+ * The lines are formatted on the streaming thread into buffers from a pool
+ * allocated when the recording starts.
+ *
+ * The wall clock time of the first recorded frame is written to a sidecar
+ * (see syncFileName()), so a review can line the video up with the tlog
+ * of the same flight.
+ */
+class GStreamerRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availableChanged)
+    Q_PROPERTY(QString fileName READ getFileName NOTIFY recordingChanged)
+    Q_PROPERTY(QString format READ getFormat WRITE setFormat NOTIFY formatChanged)
+    Q_PROPERTY(bool telemetryTrack READ getTelemetryTrack WRITE setTelemetryTrack NOTIFY telemetryTrackChanged)
+
+    /** @brief Vehicle state muxed into the recording, angles in radians */
+    struct Telemetry
+    {
+        Telemetry() : timeBootMs(0), lat(0), lon(0), alt(0), relativeAlt(0),
+            roll(0), pitch(0), yaw(0), heading(0), groundspeed(0) {}
+        quint32 timeBootMs;
+        double lat;             ///< Degrees
+        double lon;             ///< Degrees
+        double alt;             ///< Meters MSL
+        double relativeAlt;     ///< Meters above home
+        double roll;
+        double pitch;
+        double yaw;
+        double heading;         ///< Degrees
+        double groundspeed;     ///< m/s
+    };
+
+    explicit GStreamerRecorder(QObject *parent = 0);
+    ~GStreamerRecorder();
+
+    /** @brief Select the pipeline (and its recording tee) recordings are taken from */
+    void setPipeline(const QGst::PipelinePtr & pipeline, const QGst::ElementPtr & tee, const QString & depayloaderName);
+
+    bool isRecording() { return m_branch != NULL; }
+    bool isAvailable() { return !m_tee.isNull() && !parserFor(m_depayloaderName).isEmpty(); }
+    QString getFileName() { return m_fileName; }
+
+    /** @brief Container, "mp4" or "mkv" */
+    QString getFormat() { return m_format; }
+    void setFormat(const QString & format);
+
+    /** @brief Write a telemetry track when the container supports one, applies to the next recording */
+    bool getTelemetryTrack() { return m_telemetryTrack; }
+    void setTelemetryTrack(bool enabled);
+
+    /** @brief Latest vehicle state, written with the next recorded frame */
+    void setTelemetry(const Telemetry & telemetry);
+
+    /** @brief Sidecar of a recording: "startTime", microseconds since the epoch, and "parser" */
+    static QString syncFileName(const QString & videoFileName) { return videoFileName + ".sync"; }
+    /** @brief "filesrc ! demuxer ! parser" reading a recording back, followed by a software decoder if decode */
+    static QString readerPipeline(const QString & videoFileName, bool decode);
+
+public slots:
+    bool startRecording();
+    void stopRecording();
+
+signals:
+    void recordingChanged(bool);
+    void availableChanged(bool);
+    void formatChanged(QString);
+    void telemetryTrackChanged(bool);
+    /** @brief The file was finalized and closed */
+    void recordingFinished(QString fileName);
+
+private slots:
+    void releaseTeePad();
+    void onBranchEos();
+    void writeSyncFile(qint64 startUsec);
+
+private:
+    enum { TelemetryLineSize = 256, TelemetryPoolBuffers = 8 };
+
+    static QString parserFor(const QString & depayloaderName);
+    static bool muxerHasTextPad(const QString & muxer);
+    static GstPadProbeReturn telemetryProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+    static GstPadProbeReturn teeIdleProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+    static GstPadProbeReturn firstBufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+    static GstPadProbeReturn fileSinkEventProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+
+    void removeBranch();
+    void pushTelemetry(GstBuffer *video);
+    void endTelemetry();
+
+    QGst::PipelinePtr m_pipeline;
+    QGst::ElementPtr m_tee;
+    QString m_depayloaderName;
+    QString m_format;
+    QString m_fileName;
+
+    GstElement *m_branch;       ///< Recording bin, owned by the pipeline
+    GstPad *m_teePad;           ///< Request pad the branch is fed from
+    bool m_stopping;
+
+    bool m_telemetryTrack;
+    QMutex m_telemetryMutex;
+    Telemetry m_telemetry;
+    GstElement *m_telemetrySrc;         ///< appsrc of the text track, NULL when not written
+    GstBufferPool *m_telemetryPool;
+    GstClockTime m_lastTelemetryPts;    ///< Streaming thread only
+};
+
+#endif // GStreamerRecorder_H
@@ -0,0 +1,318 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerRecordingIndexer.h"
+#include "GStreamerRecorder.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPainter>
+#include <QSettings>
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <cstring>
+
+static const char KeyFrameMagic[4] = { 'K', 'E', 'Y', 'S' };
+
+// Written beside the target and renamed over it, a file on disk is never half written
+static bool replaceFile(const QString & fileName, const QByteArray & data)
+{
+    QString temporary = fileName + ".tmp";
+    QFile file(temporary);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate) || file.write(data) != data.size())
+    {
+        qCritical() << "Could not write" << temporary << file.errorString();
+        return false;
+    }
+    file.close();
+    QFile::remove(fileName);
+    return QFile::rename(temporary, fileName);
+}
+
+GStreamerRecordingIndexer* GStreamerRecordingIndexer::instance()
+{
+    static GStreamerRecordingIndexer* _instance = 0;
+    if(_instance == 0)
+    {
+        _instance = new GStreamerRecordingIndexer();
+    }
+    return _instance;
+}
+
+GStreamerRecordingIndexer::GStreamerRecordingIndexer()
+    : m_stopping(false),
+      m_lastEndNs(0)
+{
+}
+
+GStreamerRecordingIndexer::~GStreamerRecordingIndexer()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    wait();
+}
+
+void GStreamerRecordingIndexer::enqueue(const QString & videoFileName)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_queue.contains(videoFileName)) return;
+    m_queue.append(videoFileName);
+    m_wake.wakeAll();
+    if (!isRunning()) start(QThread::IdlePriority);
+}
+
+bool GStreamerRecordingIndexer::shouldStop()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stopping;
+}
+
+QVector<qint64> GStreamerRecordingIndexer::loadKeyFrames(const QString & videoFileName)
+{
+    QVector<qint64> keyFrames;
+    QFile file(keyFrameFileName(videoFileName));
+    if (!file.open(QFile::ReadOnly)) return keyFrames;
+
+    QByteArray data = file.readAll();
+    if (data.size() < int(sizeof(KeyFrameMagic)) || memcmp(data.constData(), KeyFrameMagic, sizeof(KeyFrameMagic)) != 0
+            || (data.size() - sizeof(KeyFrameMagic)) % 8 != 0)
+    {
+        qCritical() << file.fileName() << "is not a key frame index";
+        return keyFrames;
+    }
+    const uchar *entries = reinterpret_cast<const uchar*>(data.constData()) + sizeof(KeyFrameMagic);
+    int count = (data.size() - sizeof(KeyFrameMagic)) / 8;
+    keyFrames.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        keyFrames.append(qFromBigEndian<qint64>(entries + i * 8));
+    }
+    return keyFrames;
+}
+
+void GStreamerRecordingIndexer::run()
+{
+    forever
+    {
+        QString videoFileName;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_stopping)
+            {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_stopping) return;
+            videoFileName = m_queue.takeFirst();
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<qint64> keyFrames;
+        qint64 durationNs = 0;
+        if (!indexKeyFrames(videoFileName, &keyFrames, &durationNs))
+        {
+            qCritical() << "Could not index the key frames of" << videoFileName;
+            continue;
+        }
+
+        QByteArray data(KeyFrameMagic, sizeof(KeyFrameMagic));
+        data.reserve(sizeof(KeyFrameMagic) + keyFrames.size() * 8);
+        foreach (qint64 keyFrame, keyFrames)
+        {
+            uchar entry[8];
+            qToBigEndian<qint64>(keyFrame, entry);
+            data.append(reinterpret_cast<const char*>(entry), sizeof(entry));
+        }
+        if (!replaceFile(keyFrameFileName(videoFileName), data)) continue;
+
+        bool thumbnails = makeThumbnails(videoFileName, keyFrames, durationNs);
+        qDebug() << "Indexed" << videoFileName << ":" << keyFrames.size() << "key frames,"
+                 << (thumbnails ? "with" : "without") << "thumbnails, in" << timer.elapsed() << "ms";
+        emit indexed(videoFileName);
+    }
+}
+
+bool GStreamerRecordingIndexer::waitFor(GstElement *pipeline, GstMessageType type, int timeoutMs)
+{
+    GstBus *bus = gst_element_get_bus(pipeline);
+    QElapsedTimer waited;
+    waited.start();
+    bool success = false;
+    while (!shouldStop() && (timeoutMs < 0 || waited.elapsed() < timeoutMs))
+    {
+        GstMessage *message = gst_bus_timed_pop_filtered(bus, PollMs * GST_MSECOND, GstMessageType(type | GST_MESSAGE_ERROR));
+        if (message == NULL) continue;
+
+        success = GST_MESSAGE_TYPE(message) != GST_MESSAGE_ERROR;
+        if (!success)
+        {
+            GError *error = NULL;
+            gst_message_parse_error(message, &error, NULL);
+            qCritical() << "Indexing failed:" << (error ? error->message : "");
+            if (error) g_error_free(error);
+        }
+        gst_message_unref(message);
+        break;
+    }
+    gst_object_unref(bus);
+    return success;
+}
+
+// First pass, nothing is decoded: the parser flags every frame that is not a key frame
+bool GStreamerRecordingIndexer::indexKeyFrames(const QString & videoFileName, QVector<qint64> *keyFrames, qint64 *durationNs)
+{
+    QString description = GStreamerRecorder::readerPipeline(videoFileName, false)
+            + " ! fakesink name=sink sync=false signal-handoffs=true";
+    GError *error = NULL;
+    GstElement *pipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+    if (error) g_error_free(error);
+    if (pipeline == NULL) return false;
+
+    m_keyFrames.clear();
+    m_lastEndNs = 0;
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    g_signal_connect(sink, "handoff", G_CALLBACK(&GStreamerRecordingIndexer::onKeyFrameHandoff), this);
+    gst_object_unref(sink);
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    bool complete = waitFor(pipeline, GST_MESSAGE_EOS, -1);
+    // Joins the streaming threads, m_keyFrames is ours from here
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    *keyFrames = m_keyFrames;
+    *durationNs = m_lastEndNs;
+    return complete && !keyFrames->isEmpty();
+}
+
+void GStreamerRecordingIndexer::onKeyFrameHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userData)
+{
+    Q_UNUSED(sink);
+    Q_UNUSED(pad);
+    GStreamerRecordingIndexer *self = static_cast<GStreamerRecordingIndexer*>(userData);
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+
+    if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)
+            && (self->m_keyFrames.isEmpty() || qint64(pts) > self->m_keyFrames.last()))
+    {
+        self->m_keyFrames.append(pts);
+    }
+    GstClockTime duration = GST_BUFFER_DURATION(buffer);
+    self->m_lastEndNs = qMax(self->m_lastEndNs, qint64(pts + (GST_CLOCK_TIME_IS_VALID(duration) ? duration : 0)));
+}
+
+// Second pass, a key unit seek per tile decodes just the key frame it lands on
+bool GStreamerRecordingIndexer::makeThumbnails(const QString & videoFileName, const QVector<qint64> & keyFrames, qint64 durationNs)
+{
+    if (durationNs <= 0) return false;
+    qint64 intervalNs = qMax<qint64>(qint64(MinThumbnailIntervalSec) * GST_SECOND, durationNs / MaxThumbnails + 1);
+    int count = int((durationNs + intervalNs - 1) / intervalNs);
+    int rows = (count + ThumbnailColumns - 1) / ThumbnailColumns;
+
+    QString description = GStreamerRecorder::readerPipeline(videoFileName, true)
+            + QString(" ! videoconvert ! videoscale ! video/x-raw,format=BGRx,width=%1,height=%2,pixel-aspect-ratio=1/1"
+                      " ! fakesink name=sink sync=false signal-handoffs=true").arg(int(ThumbnailWidth)).arg(int(ThumbnailHeight));
+    GError *error = NULL;
+    GstElement *pipeline = gst_parse_launch(description.toUtf8().constData(), &error);
+    if (error) g_error_free(error);
+    if (pipeline == NULL) return false;
+
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    g_signal_connect(sink, "preroll-handoff", G_CALLBACK(&GStreamerRecordingIndexer::onThumbnailHandoff), this);
+    gst_object_unref(sink);
+
+    QImage sprite(ThumbnailColumns * ThumbnailWidth, rows * ThumbnailHeight, QImage::Format_RGB32);
+    sprite.fill(Qt::black);
+    QPainter painter(&sprite);
+
+    gst_element_set_state(pipeline, GST_STATE_PAUSED);
+    bool success = waitFor(pipeline, GST_MESSAGE_ASYNC_DONE, StepTimeoutMs);
+    qint64 lastKeyFrame = -1;
+    QImage frame;
+    for (int i = 0; success && i < count; ++i)
+    {
+        // The key frame at or before the tile's time, tiles within one GOP share it
+        const qint64 *next = qUpperBound(keyFrames.constBegin(), keyFrames.constEnd(), i * intervalNs);
+        qint64 keyFrame = (next == keyFrames.constBegin()) ? keyFrames.first() : *(next - 1);
+        if (keyFrame != lastKeyFrame)
+        {
+            {
+                QMutexLocker locker(&m_frameMutex);
+                m_frame = QImage();
+            }
+            success = gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
+                                              GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT), keyFrame)
+                    && waitFor(pipeline, GST_MESSAGE_ASYNC_DONE, StepTimeoutMs);
+            QMutexLocker locker(&m_frameMutex);
+            frame = m_frame;
+            lastKeyFrame = keyFrame;
+        }
+        if (!frame.isNull())
+        {
+            painter.drawImage((i % ThumbnailColumns) * ThumbnailWidth, (i / ThumbnailColumns) * ThumbnailHeight, frame);
+        }
+    }
+    painter.end();
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_frame = QImage();
+    }
+    if (!success) return false;
+
+    QString temporary = thumbnailFileName(videoFileName) + ".tmp";
+    if (!sprite.save(temporary, "JPG", JpegQuality))
+    {
+        qCritical() << "Could not write" << temporary;
+        return false;
+    }
+    QFile::remove(thumbnailFileName(videoFileName));
+    if (!QFile::rename(temporary, thumbnailFileName(videoFileName))) return false;
+
+    QSettings sync(GStreamerRecorder::syncFileName(videoFileName), QSettings::IniFormat);
+    sync.beginGroup("thumbnails");
+    sync.setValue("intervalMs", intervalNs / GST_MSECOND);
+    sync.setValue("width", int(ThumbnailWidth));
+    sync.setValue("height", int(ThumbnailHeight));
+    sync.setValue("columns", int(ThumbnailColumns));
+    sync.setValue("count", count);
+    sync.endGroup();
+    return true;
+}
+
+// Streaming thread, once per preroll
+void GStreamerRecordingIndexer::onThumbnailHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userData)
+{
+    Q_UNUSED(sink);
+    Q_UNUSED(pad);
+    GStreamerRecordingIndexer *self = static_cast<GStreamerRecordingIndexer*>(userData);
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return;
+    if (map.size >= gsize(ThumbnailWidth * ThumbnailHeight * 4))
+    {
+        QImage frame(map.data, ThumbnailWidth, ThumbnailHeight, ThumbnailWidth * 4, QImage::Format_RGB32);
+        QMutexLocker locker(&self->m_frameMutex);
+        self->m_frame = frame.copy();
+    }
+    gst_buffer_unmap(buffer, &map);
+}
@@ -0,0 +1,103 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerRecordingIndexer_H
+#define GStreamerRecordingIndexer_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QVector>
+#include <QImage>
+#include <gst/gst.h>
+
+/**
+ * @brief Key frame index and thumbnail timeline of finished recordings
+ *
+ * Recordings are processed one after the other on a thread at idle
+ * priority, the GStreamer streaming threads it creates inherit that. A
+ * first pass parses the file without decoding and keeps the timestamp of
+ * every key frame in "<video>.keys". A second pass decodes one key frame
+ * every few seconds, found by a key unit seek, and tiles them scaled down
+ * into "<video>.thumbs.jpg", left to right and top to bottom. The layout
+ * goes to the recording's sync sidecar, group "thumbnails": intervalMs
+ * between tiles, the tile width and height, columns and count.
+ *
+ * Nothing is written until a pass is complete, so an index on disk is
+ * always whole.
+ */
+class GStreamerRecordingIndexer : public QThread
+{
+    Q_OBJECT
+public:
+    enum {
+        ThumbnailWidth = 160,
+        ThumbnailHeight = 90,
+        ThumbnailColumns = 10,
+        MinThumbnailIntervalSec = 5,
+        MaxThumbnails = 240,
+        JpegQuality = 75,
+        StepTimeoutMs = 5000,   ///< A pipeline that does not get on in this time is given up
+        PollMs = 100
+    };
+
+    static GStreamerRecordingIndexer* instance();
+    ~GStreamerRecordingIndexer();
+
+    /** @brief Index videoFileName once the ones before it are done. Any thread */
+    void enqueue(const QString & videoFileName);
+
+    static QString keyFrameFileName(const QString & videoFileName) { return videoFileName + ".keys"; }
+    static QString thumbnailFileName(const QString & videoFileName) { return videoFileName + ".thumbs.jpg"; }
+
+    /** @brief Key frame timestamps in nanoseconds, ascending; empty if the recording is not indexed */
+    static QVector<qint64> loadKeyFrames(const QString & videoFileName);
+
+signals:
+    /** @brief The index and thumbnails of videoFileName are on disk (thumbnails only if it could be decoded) */
+    void indexed(QString videoFileName);
+
+protected:
+    void run();
+
+private:
+    GStreamerRecordingIndexer();
+
+    bool indexKeyFrames(const QString & videoFileName, QVector<qint64> *keyFrames, qint64 *durationNs);
+    bool makeThumbnails(const QString & videoFileName, const QVector<qint64> & keyFrames, qint64 durationNs);
+    /** @brief Pump the bus until a message of type, false on an error, stop or after timeoutMs (-1 waits) */
+    bool waitFor(GstElement *pipeline, GstMessageType type, int timeoutMs);
+    bool shouldStop();
+
+    static void onKeyFrameHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userData);
+    static void onThumbnailHandoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer userData);
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QStringList m_queue;
+    bool m_stopping;
+
+    // Streaming thread of the running pass, read by the worker once it is over
+    QVector<qint64> m_keyFrames;
+    qint64 m_lastEndNs;
+    QMutex m_frameMutex;
+    QImage m_frame;
+};
+
+#endif // GStreamerRecordingIndexer_H
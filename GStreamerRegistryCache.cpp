@@ -0,0 +1,164 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerRegistryCache.h"
+#include "configuration.h"
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QSet>
+#include <QDebug>
+#include <gst/gst.h>
+
+// Remembered elements, the oldest beyond this are forgotten
+static const int MaxRemembered = 48;
+
+// Every pipeline ends in these, preload them even before one was remembered
+static const char * const CommonElements[] = {
+    "queue", "videoconvert", "qt5videosink", "udpsrc", "rtph264depay", "h264parse",
+    NULL
+};
+
+QString GStreamerRegistryCache::versionKey()
+{
+    return QString("%1|%2.%3.%4").arg(QGC_APPLICATION_VERSION)
+            .arg(GST_VERSION_MAJOR).arg(GST_VERSION_MINOR).arg(GST_VERSION_MICRO);
+}
+
+void GStreamerRegistryCache::prepare()
+{
+    // Leave a registry chosen from outside alone
+    if (qEnvironmentVariableIsSet("GST_REGISTRY"))
+    {
+        return;
+    }
+    QDir dir(QGC::appDataDirectory());
+    dir.mkpath("gstreamer");
+    const QString registry = dir.filePath("gstreamer/registry.bin");
+
+    QSettings settings;
+    settings.beginGroup("GSTREAMER_REGISTRY");
+    const bool current = settings.value("VERSION").toString() == versionKey() && QFile::exists(registry);
+    if (!current)
+    {
+        // Built by another version, the plugins may differ; scan once and keep the result
+        QFile::remove(registry);
+        settings.setValue("VERSION", versionKey());
+    }
+    settings.endGroup();
+
+    qputenv("GST_REGISTRY", QFile::encodeName(registry));
+    qputenv("GST_REGISTRY_UPDATE", current ? "no" : "yes");
+    // Forking the scanner helper is the slow part on Android, scan in process
+    qputenv("GST_REGISTRY_FORK", "no");
+    qDebug() << "GStreamer registry" << registry << (current ? "reused" : "rebuilt");
+}
+
+void GStreamerRegistryCache::preload()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList elements;
+    for (int i = 0; CommonElements[i]; ++i)
+    {
+        elements << QLatin1String(CommonElements[i]);
+    }
+    QSettings settings;
+    elements << settings.value("GSTREAMER_REGISTRY/ELEMENTS").toStringList();
+
+    QSet<QString> seen;
+    int loaded = 0;
+    Q_FOREACH(const QString & name, elements)
+    {
+        if (seen.contains(name))
+        {
+            continue;
+        }
+        seen.insert(name);
+        GstElementFactory *factory = gst_element_factory_find(name.toUtf8().constData());
+        if (!factory)
+        {
+            continue;
+        }
+        // Loads the plugin's shared object and resolves the factory's type
+        GstPluginFeature *feature = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+        if (feature)
+        {
+            ++loaded;
+            gst_object_unref(feature);
+        }
+        gst_object_unref(factory);
+    }
+    qDebug() << "GStreamer preloaded" << loaded << "of" << seen.size() << "elements in" << timer.elapsed() << "ms";
+}
+
+void GStreamerRegistryCache::remember(const QString & pipelineString)
+{
+    const QStringList elements = elementsOf(pipelineString);
+    if (elements.isEmpty())
+    {
+        return;
+    }
+    QSettings settings;
+    QStringList remembered = settings.value("GSTREAMER_REGISTRY/ELEMENTS").toStringList();
+    QStringList updated = elements;
+    Q_FOREACH(const QString & name, remembered)
+    {
+        if (!updated.contains(name))
+        {
+            updated << name;
+        }
+    }
+    while (updated.size() > MaxRemembered)
+    {
+        updated.removeLast();
+    }
+    if (updated != remembered)
+    {
+        settings.setValue("GSTREAMER_REGISTRY/ELEMENTS", updated);
+    }
+}
+
+QStringList GStreamerRegistryCache::elementsOf(const QString & pipelineString)
+{
+    // Each link starts with the element, then its properties; caps ("video/x-raw,...")
+    // and references to named elements ("t.", "demux.video_0") are not factories
+    QRegExp factoryName("^[a-z0-9][a-z0-9_-]*$");
+    QStringList result;
+    Q_FOREACH(const QString & link, pipelineString.split('!', QString::SkipEmptyParts))
+    {
+        const QStringList words = link.trimmed().split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        Q_FOREACH(const QString & word, words)
+        {
+            // A link may start with a named reference before the element
+            if (word.endsWith('.') || word.contains(QRegExp("^[^=/]+\\.[^=/]+$")))
+            {
+                continue;
+            }
+            if (factoryName.exactMatch(word) && !result.contains(word))
+            {
+                result << word;
+            }
+            break;
+        }
+    }
+    return result;
+}
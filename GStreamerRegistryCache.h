@@ -0,0 +1,54 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerRegistryCache_H
+#define GStreamerRegistryCache_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Predictable GStreamer start up: a kept registry and preloaded elements
+ *
+ * The registry is written to the application data directory and reused
+ * without rescanning the plugin directories, until the application or
+ * GStreamer version changes; then it is deleted and rebuilt once, with the
+ * scan done in this process instead of a forked helper.
+ *
+ * The elements of every pipeline the display was given are remembered in
+ * the settings. The next start loads their plugins during the splash, so
+ * the first parseLaunch finds every factory resolved.
+ */
+class GStreamerRegistryCache
+{
+public:
+    /** @brief Point GStreamer at the kept registry. Call before QGst::init, on the main thread */
+    static void prepare();
+    /** @brief Load the plugins of the remembered elements. Call after QGst::init, any thread */
+    static void preload();
+    /** @brief Remember the elements of a pipeline string for the next start */
+    static void remember(const QString & pipelineString);
+
+    /** @brief Element factory names of a gst-launch pipeline string */
+    static QStringList elementsOf(const QString & pipelineString);
+
+private:
+    static QString versionKey();
+};
+
+#endif // GStreamerRegistryCache_H
@@ -0,0 +1,408 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerRestreamer.h"
+#include <QDebug>
+#include <gst/rtsp-server/rtsp-server.h>
+
+GStreamerRestreamer::GStreamerRestreamer(QObject *parent)
+    : QObject(parent),
+      m_enabled(false),
+      m_port(DefaultPort),
+      m_mountPoint("/video"),
+      m_clients(0),
+      m_branch(NULL),
+      m_teePad(NULL),
+      m_context(NULL),
+      m_loop(NULL),
+      m_loopThread(NULL),
+      m_server(NULL),
+      m_serverSource(0),
+      m_source(NULL),
+      m_caps(NULL)
+{
+}
+
+GStreamerRestreamer::~GStreamerRestreamer()
+{
+    removeBranch();
+    stopServer();
+    if (m_caps != NULL)
+    {
+        gst_caps_unref(m_caps);
+    }
+}
+
+void GStreamerRestreamer::setPipeline(const QGst::PipelinePtr & pipeline, const QGst::ElementPtr & tee, const QString & depayloaderName)
+{
+    if (m_branch != NULL && (pipeline != m_pipeline || tee != m_tee))
+    {
+        removeBranch();
+    }
+
+    m_pipeline = pipeline;
+    m_tee = tee;
+    m_depayloaderName = depayloaderName;
+    // Clients keep their session across a rebuild or standby switch, unless the codec changed
+    if (m_server != NULL && !depayloaderName.isEmpty() && depayloaderName != m_serverDepayloader)
+    {
+        stopServer();
+    }
+    update();
+    emit availableChanged(isAvailable());
+}
+
+void GStreamerRestreamer::setEnabled(bool enabled)
+{
+    if (m_enabled != enabled)
+    {
+        m_enabled = enabled;
+        update();
+        emit enabledChanged(enabled);
+    }
+}
+
+void GStreamerRestreamer::setPort(int port)
+{
+    if (port <= 0 || port > 65535)
+    {
+        qCritical() << "Invalid RTSP port" << port;
+        return;
+    }
+    if (m_port != port)
+    {
+        m_port = port;
+        stopServer();
+        update();
+        emit portChanged(port);
+    }
+}
+
+void GStreamerRestreamer::setMountPoint(const QString & mountPoint)
+{
+    if (!mountPoint.startsWith("/"))
+    {
+        qCritical() << "RTSP mount point must start with /:" << mountPoint;
+        return;
+    }
+    if (m_mountPoint != mountPoint)
+    {
+        m_mountPoint = mountPoint;
+        stopServer();
+        update();
+        emit mountPointChanged(mountPoint);
+    }
+}
+
+QString GStreamerRestreamer::payloaderFor(const QString & depayloaderName)
+{
+    // config-interval resends SPS/PPS, clients may join at any time
+    if (depayloaderName == "rtph264depay") return "rtph264pay config-interval=1";
+    if (depayloaderName == "rtph265depay") return "rtph265pay config-interval=1";
+    if (depayloaderName == "rtpmp4vdepay") return "rtpmp4vpay";
+    if (depayloaderName == "rtpjpegdepay") return "rtpjpegpay";
+    return "";
+}
+
+QString GStreamerRestreamer::parserFor(const QString & depayloaderName)
+{
+    if (depayloaderName == "rtph264depay") return "h264parse";
+    if (depayloaderName == "rtph265depay") return "h265parse";
+    if (depayloaderName == "rtpmp4vdepay") return "mpeg4videoparse";
+    if (depayloaderName == "rtpjpegdepay") return "jpegparse";
+    return "";
+}
+
+void GStreamerRestreamer::update()
+{
+    if (!m_enabled)
+    {
+        removeBranch();
+        stopServer();
+        return;
+    }
+    // Without a stream the server stays up, the media just gets no buffers
+    if (!isAvailable())
+    {
+        removeBranch();
+        return;
+    }
+    if (m_server == NULL && !startServer())
+    {
+        return;
+    }
+    if (m_branch == NULL)
+    {
+        addBranch();
+    }
+}
+
+bool GStreamerRestreamer::startServer()
+{
+    // The buffers keep the timestamps of the display pipeline's clock, the media restamps them
+    QString launch = QString("( appsrc name=restreamsrc is-live=true format=time do-timestamp=true"
+                             " ! %1 ! %2 name=pay0 pt=96 )")
+            .arg(parserFor(m_depayloaderName), payloaderFor(m_depayloaderName));
+
+    m_server = gst_rtsp_server_new();
+    gst_rtsp_server_set_service(m_server, QByteArray::number(m_port).constData());
+    g_signal_connect(m_server, "client-connected", G_CALLBACK(&GStreamerRestreamer::onClientConnected), this);
+
+    GstRTSPMediaFactory *factory = gst_rtsp_media_factory_new();
+    gst_rtsp_media_factory_set_launch(factory, launch.toUtf8().constData());
+    // One media for every client, so the stream is forwarded once
+    gst_rtsp_media_factory_set_shared(factory, TRUE);
+    g_signal_connect(factory, "media-configure", G_CALLBACK(&GStreamerRestreamer::onMediaConfigure), this);
+    GstRTSPMountPoints *mounts = gst_rtsp_server_get_mount_points(m_server);
+    gst_rtsp_mount_points_add_factory(mounts, m_mountPoint.toUtf8().constData(), factory);
+    g_object_unref(mounts);
+
+    m_context = g_main_context_new();
+    m_serverSource = gst_rtsp_server_attach(m_server, m_context);
+    if (m_serverSource == 0)
+    {
+        qCritical() << "Unable to start the RTSP server on port" << m_port;
+        g_object_unref(m_server);
+        m_server = NULL;
+        g_main_context_unref(m_context);
+        m_context = NULL;
+        return false;
+    }
+    m_loop = g_main_loop_new(m_context, FALSE);
+    m_loopThread = new MainLoop(m_loop);
+    m_loopThread->start(QThread::LowPriority);
+    m_serverDepayloader = m_depayloaderName;
+
+    qDebug() << "Re-streaming video on port" << m_port << "at" << m_mountPoint << launch;
+    return true;
+}
+
+static GstRTSPFilterResult closeClient(GstRTSPServer *, GstRTSPClient *, gpointer)
+{
+    return GST_RTSP_FILTER_REMOVE;
+}
+
+void GStreamerRestreamer::stopServer()
+{
+    if (m_server == NULL) return;
+
+    GSource *source = g_main_context_find_source_by_id(m_context, m_serverSource);
+    if (source != NULL)
+    {
+        g_source_destroy(source);
+    }
+    gst_rtsp_server_client_filter(m_server, &closeClient, NULL);
+    g_main_loop_quit(m_loop);
+    m_loopThread->wait();
+    delete m_loopThread;
+    m_loopThread = NULL;
+    g_main_loop_unref(m_loop);
+    m_loop = NULL;
+    g_object_unref(m_server);
+    m_server = NULL;
+    g_main_context_unref(m_context);
+    m_context = NULL;
+    m_serverSource = 0;
+    m_serverDepayloader = "";
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_source != NULL)
+        {
+            gst_object_unref(m_source);
+            m_source = NULL;
+        }
+    }
+    if (m_clients != 0)
+    {
+        m_clients = 0;
+        emit clientsChanged(0);
+    }
+}
+
+bool GStreamerRestreamer::addBranch()
+{
+    // Leaky and unsynchronized, a slow client never holds up the tee
+    QString description = QString("queue leaky=downstream max-size-buffers=%1 max-size-bytes=0 max-size-time=0"
+                                  " ! appsink name=restreamsink sync=false async=false emit-signals=true"
+                                  " max-buffers=%1 drop=true").arg(int(QueueBuffers));
+    GError *error = NULL;
+    GstElement *branch = gst_parse_bin_from_description(description.toUtf8().constData(), TRUE, &error);
+    if (branch == NULL)
+    {
+        qCritical() << "Failed to create re-streaming branch:" << (error ? error->message : "");
+        if (error) g_error_free(error);
+        return false;
+    }
+
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(branch), "restreamsink");
+    g_signal_connect(sink, "new-sample", G_CALLBACK(&GStreamerRestreamer::onNewSample), this);
+    gst_object_unref(sink);
+
+    gst_bin_add(GST_BIN((GstPipeline*)m_pipeline), branch);
+
+    GstPad *teePad = gst_element_get_request_pad((GstElement*)m_tee, "src_%u");
+    GstPad *sinkPad = gst_element_get_static_pad(branch, "sink");
+    bool linked = gst_pad_link(teePad, sinkPad) == GST_PAD_LINK_OK;
+    gst_object_unref(sinkPad);
+    if (!linked)
+    {
+        qCritical() << "Failed to link re-streaming branch";
+        gst_element_release_request_pad((GstElement*)m_tee, teePad);
+        gst_object_unref(teePad);
+        gst_bin_remove(GST_BIN((GstPipeline*)m_pipeline), branch);
+        return false;
+    }
+    gst_element_sync_state_with_parent(branch);
+
+    m_branch = branch;
+    m_teePad = teePad;
+    return true;
+}
+
+void GStreamerRestreamer::removeBranch()
+{
+    if (m_branch == NULL) return;
+
+    if (m_teePad != NULL)
+    {
+        GstPad *peer = gst_pad_get_peer(m_teePad);
+        if (peer != NULL)
+        {
+            gst_pad_unlink(m_teePad, peer);
+            gst_object_unref(peer);
+        }
+        if (!m_tee.isNull())
+        {
+            gst_element_release_request_pad((GstElement*)m_tee, m_teePad);
+        }
+        gst_object_unref(m_teePad);
+        m_teePad = NULL;
+    }
+
+    gst_element_set_state(m_branch, GST_STATE_NULL);
+    if (!m_pipeline.isNull())
+    {
+        gst_bin_remove(GST_BIN((GstPipeline*)m_pipeline), m_branch);
+    }
+    m_branch = NULL;
+}
+
+// Streaming thread of the display pipeline
+GstFlowReturn GStreamerRestreamer::onNewSample(GstElement *sink, gpointer userData)
+{
+    GstSample *sample = NULL;
+    g_signal_emit_by_name(sink, "pull-sample", &sample);
+    if (sample != NULL)
+    {
+        static_cast<GStreamerRestreamer*>(userData)->forward(sample);
+        gst_sample_unref(sample);
+    }
+    return GST_FLOW_OK;
+}
+
+void GStreamerRestreamer::forward(GstSample *sample)
+{
+    GstCaps *caps = gst_sample_get_caps(sample);
+    GstElement *source = NULL;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (caps != NULL && (m_caps == NULL || !gst_caps_is_equal(caps, m_caps)))
+        {
+            gst_caps_replace(&m_caps, caps);
+            if (m_source != NULL)
+            {
+                g_object_set(m_source, "caps", caps, NULL);
+            }
+        }
+        if (m_source != NULL)
+        {
+            source = GST_ELEMENT(gst_object_ref(m_source));
+        }
+    }
+    if (source == NULL) return;
+
+    // Copies the metadata only, the memory is shared with the display branch
+    GstBuffer *buffer = gst_buffer_copy(gst_sample_get_buffer(sample));
+    GST_BUFFER_PTS(buffer) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DTS(buffer) = GST_CLOCK_TIME_NONE;
+    GstFlowReturn ret;
+    g_signal_emit_by_name(source, "push-buffer", buffer, &ret);
+    gst_buffer_unref(buffer);
+    gst_object_unref(source);
+}
+
+// Server thread, when the shared media is first prepared
+void GStreamerRestreamer::onMediaConfigure(GstRTSPMediaFactory *factory, GstRTSPMedia *media, gpointer userData)
+{
+    Q_UNUSED(factory);
+    GStreamerRestreamer *self = static_cast<GStreamerRestreamer*>(userData);
+
+    GstElement *element = gst_rtsp_media_get_element(media);
+    GstElement *source = gst_bin_get_by_name_recurse_up(GST_BIN(element), "restreamsrc");
+    gst_object_unref(element);
+    if (source == NULL) return;
+    {
+        QMutexLocker locker(&self->m_mutex);
+        if (self->m_caps != NULL)
+        {
+            g_object_set(source, "caps", self->m_caps, NULL);
+        }
+        if (self->m_source != NULL)
+        {
+            gst_object_unref(self->m_source);
+        }
+        self->m_source = source;
+    }
+    g_signal_connect(media, "unprepared", G_CALLBACK(&GStreamerRestreamer::onMediaUnprepared), self);
+    QMetaObject::invokeMethod(self, "keyFrameNeeded", Qt::QueuedConnection);
+}
+
+// Server thread, the last client left
+void GStreamerRestreamer::onMediaUnprepared(GstRTSPMedia *media, gpointer userData)
+{
+    Q_UNUSED(media);
+    GStreamerRestreamer *self = static_cast<GStreamerRestreamer*>(userData);
+    QMutexLocker locker(&self->m_mutex);
+    if (self->m_source != NULL)
+    {
+        gst_object_unref(self->m_source);
+        self->m_source = NULL;
+    }
+}
+
+void GStreamerRestreamer::onClientConnected(GstRTSPServer *server, GstRTSPClient *client, gpointer userData)
+{
+    Q_UNUSED(server);
+    g_signal_connect(client, "closed", G_CALLBACK(&GStreamerRestreamer::onClientClosed), userData);
+    QMetaObject::invokeMethod(static_cast<GStreamerRestreamer*>(userData), "updateClients", Qt::QueuedConnection, Q_ARG(int, 1));
+}
+
+void GStreamerRestreamer::onClientClosed(GstRTSPClient *client, gpointer userData)
+{
+    Q_UNUSED(client);
+    QMetaObject::invokeMethod(static_cast<GStreamerRestreamer*>(userData), "updateClients", Qt::QueuedConnection, Q_ARG(int, -1));
+}
+
+void GStreamerRestreamer::updateClients(int delta)
+{
+    // Closures queued before stopServer() reset the count arrive late
+    if (m_server == NULL) return;
+    m_clients = qMax(0, m_clients + delta);
+    emit clientsChanged(m_clients);
+}
@@ -0,0 +1,144 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerRestreamer_H
+#define GStreamerRestreamer_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThread>
+#include <QGst/Pipeline>
+#include <QGst/Element>
+#include <gst/gst.h>
+
+typedef struct _GstRTSPServer GstRTSPServer;
+typedef struct _GstRTSPMediaFactory GstRTSPMediaFactory;
+typedef struct _GstRTSPMedia GstRTSPMedia;
+typedef struct _GstRTSPClient GstRTSPClient;
+
+/**
+ * @brief RTSP server re-publishing the compressed video stream
+ *
+ * A branch "queue ! appsink" is attached to the same tee the recorder uses,
+ * after the RTP depayloader, and its buffers are handed to the appsrc of
+ * one shared gst-rtsp-server media "appsrc ! parser ! payloader". Packets
+ * are only parsed and payloaded again, never decoded, so the display
+ * pipeline's frame rate does not depend on how many clients pull.
+ *
+ * The queue is leaky and the branch never syncs to the clock: clients
+ * that fall behind lose frames, the HUD does not wait for them. The
+ * server runs its own GMainContext on a thread of its own, since Qt on
+ * Android does not dispatch the default one.
+ */
+class GStreamerRestreamer : public QObject
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(bool enabled READ getEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool available READ isAvailable NOTIFY availableChanged)
+    Q_PROPERTY(int port READ getPort WRITE setPort NOTIFY portChanged)
+    Q_PROPERTY(QString mountPoint READ getMountPoint WRITE setMountPoint NOTIFY mountPointChanged)
+    Q_PROPERTY(int clients READ getClients NOTIFY clientsChanged)
+
+    enum { DefaultPort = 8554, QueueBuffers = 64 };
+
+    explicit GStreamerRestreamer(QObject *parent = 0);
+    ~GStreamerRestreamer();
+
+    /** @brief Select the pipeline (and its recording tee) the stream is taken from */
+    void setPipeline(const QGst::PipelinePtr & pipeline, const QGst::ElementPtr & tee, const QString & depayloaderName);
+
+    bool getEnabled() { return m_enabled; }
+    /** @brief Start or stop the server, it follows the displayed pipeline while enabled */
+    void setEnabled(bool enabled);
+
+    bool isAvailable() { return !m_tee.isNull() && !payloaderFor(m_depayloaderName).isEmpty(); }
+
+    /** @brief TCP port of the server, applies from the next start */
+    int getPort() { return m_port; }
+    void setPort(int port);
+
+    /** @brief Path of the stream, rtsp://<address>:<port><mountPoint> */
+    QString getMountPoint() { return m_mountPoint; }
+    void setMountPoint(const QString & mountPoint);
+
+    int getClients() { return m_clients; }
+
+signals:
+    void enabledChanged(bool);
+    void availableChanged(bool);
+    void portChanged(int);
+    void mountPointChanged(QString);
+    void clientsChanged(int);
+    /** @brief A client started playing, it cannot decode before the next key frame */
+    void keyFrameNeeded();
+
+private slots:
+    void updateClients(int delta);
+
+private:
+    class MainLoop : public QThread
+    {
+    public:
+        explicit MainLoop(GMainLoop *loop) : m_loop(loop) {}
+    protected:
+        virtual void run() { g_main_loop_run(m_loop); }
+    private:
+        GMainLoop *m_loop;
+    };
+
+    static QString payloaderFor(const QString & depayloaderName);
+    static QString parserFor(const QString & depayloaderName);
+    static GstFlowReturn onNewSample(GstElement *sink, gpointer userData);
+    static void onMediaConfigure(GstRTSPMediaFactory *factory, GstRTSPMedia *media, gpointer userData);
+    static void onMediaUnprepared(GstRTSPMedia *media, gpointer userData);
+    static void onClientConnected(GstRTSPServer *server, GstRTSPClient *client, gpointer userData);
+    static void onClientClosed(GstRTSPClient *client, gpointer userData);
+
+    void update();
+    bool startServer();
+    void stopServer();
+    bool addBranch();
+    void removeBranch();
+    void forward(GstSample *sample);
+
+    QGst::PipelinePtr m_pipeline;
+    QGst::ElementPtr m_tee;
+    QString m_depayloaderName;
+    bool m_enabled;
+    int m_port;
+    QString m_mountPoint;
+    int m_clients;
+
+    GstElement *m_branch;       ///< queue ! appsink, owned by the pipeline
+    GstPad *m_teePad;
+
+    GMainContext *m_context;
+    GMainLoop *m_loop;
+    MainLoop *m_loopThread;
+    GstRTSPServer *m_server;
+    guint m_serverSource;
+    QString m_serverDepayloader;    ///< Codec the mounted media was made for
+
+    // Shared between the display pipeline's streaming thread and the server's
+    QMutex m_mutex;
+    GstElement *m_source;       ///< appsrc of the prepared media, NULL while no client plays
+    GstCaps *m_caps;            ///< Of the last sample, the appsrc starts with them
+};
+
+#endif // GStreamerRestreamer_H
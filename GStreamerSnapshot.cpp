@@ -0,0 +1,256 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerSnapshot.h"
+#include "configuration.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+#include <gst/video/video.h>
+
+// Encodes still queued or running at once, further captures are refused
+static const int MaxPendingEncodes = 2;
+
+// Time allowed for one conversion/encode in gst_video_convert_sample()
+static const GstClockTime EncodeTimeout = 5 * GST_SECOND;
+
+/** @brief Converts one sample to an image file on a thread pool thread */
+class SnapshotEncoder : public QRunnable
+{
+public:
+    SnapshotEncoder(GStreamerSnapshot *owner, GstSample *sample, const QString & fileName, const QString & format)
+        : m_owner(owner), m_sample(sample), m_fileName(fileName), m_format(format)
+    {
+    }
+
+    ~SnapshotEncoder()
+    {
+        gst_sample_unref(m_sample);
+    }
+
+    void run()
+    {
+        QString error = encode();
+        if (m_owner)
+        {
+            QMetaObject::invokeMethod(m_owner, "onEncoded", Qt::QueuedConnection,
+                                      Q_ARG(QString, error.isEmpty() ? m_fileName : QString()), Q_ARG(QString, error));
+        }
+    }
+
+private:
+    QString encode()
+    {
+        GstCaps *caps = gst_caps_from_string(m_format == "png" ? "image/png" : "image/jpeg");
+        GError *gerror = NULL;
+        GstSample *image = gst_video_convert_sample(m_sample, caps, EncodeTimeout, &gerror);
+        gst_caps_unref(caps);
+
+        if (image == NULL)
+        {
+            QString error = QString("Snapshot encoding failed: %1").arg(gerror ? gerror->message : "");
+            if (gerror) g_error_free(gerror);
+            return error;
+        }
+
+        QString error;
+        GstMapInfo map;
+        GstBuffer *buffer = gst_sample_get_buffer(image);
+        if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ))
+        {
+            QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+            QFile file(m_fileName);
+            if (!file.open(QIODevice::WriteOnly) || file.write((const char*)map.data, map.size) != (qint64)map.size)
+            {
+                error = QString("Could not write snapshot %1: %2").arg(m_fileName, file.errorString());
+            }
+            gst_buffer_unmap(buffer, &map);
+        }
+        else
+        {
+            error = "Snapshot encoder produced no data";
+        }
+
+        gst_sample_unref(image);
+        return error;
+    }
+
+    QPointer<GStreamerSnapshot> m_owner;
+    GstSample *m_sample;
+    QString m_fileName;
+    QString m_format;
+};
+
+GStreamerSnapshot::GStreamerSnapshot(QObject *parent)
+    : QObject(parent),
+      m_pad(NULL),
+      m_probeId(0),
+      m_next(0),
+      m_ringSize(3),
+      m_format("jpg")
+{
+    m_ring.fill(NULL, m_ringSize);
+}
+
+GStreamerSnapshot::~GStreamerSnapshot()
+{
+    setTailElement(QGst::ElementPtr());
+}
+
+void GStreamerSnapshot::setTailElement(const QGst::ElementPtr & tail)
+{
+    if (m_pad)
+    {
+        gst_pad_remove_probe(m_pad, m_probeId);
+        gst_object_unref(m_pad);
+        m_pad = NULL;
+        m_probeId = 0;
+    }
+    clearRing();
+
+    if (!tail.isNull())
+    {
+        m_pad = gst_element_get_static_pad((GstElement*)tail, "sink");
+        if (m_pad)
+        {
+            m_probeId = gst_pad_add_probe(m_pad, GST_PAD_PROBE_TYPE_BUFFER, &GStreamerSnapshot::bufferProbe, this, NULL);
+        }
+    }
+}
+
+void GStreamerSnapshot::setRingSize(int size)
+{
+    size = qBound(1, size, 16);
+    if (m_ringSize == size) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        Q_FOREACH(GstSample *sample, m_ring)
+        {
+            if (sample) gst_sample_unref(sample);
+        }
+        m_ringSize = size;
+        m_ring.fill(NULL, m_ringSize);
+        m_next = 0;
+    }
+    emit ringSizeChanged(m_ringSize);
+}
+
+qint64 GStreamerSnapshot::heldBytes()
+{
+    qint64 bytes = 0;
+    QMutexLocker locker(&m_mutex);
+    Q_FOREACH(GstSample *sample, m_ring)
+    {
+        GstBuffer *buffer = sample ? gst_sample_get_buffer(sample) : NULL;
+        if (buffer) bytes += gst_buffer_get_size(buffer);
+    }
+    return bytes;
+}
+
+void GStreamerSnapshot::setFormat(const QString & format)
+{
+    if (format != "jpg" && format != "png")
+    {
+        qCritical() << "Unsupported snapshot format" << format;
+        return;
+    }
+
+    if (m_format != format)
+    {
+        m_format = format;
+        emit formatChanged(m_format);
+    }
+}
+
+void GStreamerSnapshot::clearRing()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_ring.size(); i++)
+    {
+        if (m_ring[i]) gst_sample_unref(m_ring[i]);
+        m_ring[i] = NULL;
+    }
+    m_next = 0;
+}
+
+// Runs on the streaming thread, only swaps references
+GstPadProbeReturn GStreamerSnapshot::bufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    GStreamerSnapshot *self = static_cast<GStreamerSnapshot*>(userData);
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    if (caps == NULL) return GST_PAD_PROBE_OK;
+
+    GstSample *sample = gst_sample_new(GST_PAD_PROBE_INFO_BUFFER(info), caps, NULL, NULL);
+    gst_caps_unref(caps);
+
+    GstSample *old;
+    {
+        QMutexLocker locker(&self->m_mutex);
+        old = self->m_ring[self->m_next];
+        self->m_ring[self->m_next] = sample;
+        self->m_next = (self->m_next + 1) % self->m_ring.size();
+    }
+    if (old) gst_sample_unref(old);
+
+    return GST_PAD_PROBE_OK;
+}
+
+bool GStreamerSnapshot::capture(int framesBack)
+{
+    if (m_pending.load() >= MaxPendingEncodes) return false;
+
+    GstSample *sample = NULL;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (framesBack >= 0 && framesBack < m_ring.size())
+        {
+            int index = (m_next - 1 - framesBack + 2 * m_ring.size()) % m_ring.size();
+            sample = m_ring[index];
+            if (sample) gst_sample_ref(sample);
+        }
+    }
+    if (sample == NULL) return false;
+
+    QString fileName = QGC::videoDirectory() + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss-zzz") + "." + m_format;
+
+    if (m_pending.fetchAndAddOrdered(1) == 0) emit busyChanged(true);
+    QThreadPool::globalInstance()->start(new SnapshotEncoder(this, sample, fileName, m_format));
+    return true;
+}
+
+void GStreamerSnapshot::onEncoded(QString fileName, QString error)
+{
+    if (m_pending.fetchAndAddOrdered(-1) == 1) emit busyChanged(false);
+
+    if (error.isEmpty())
+    {
+        qDebug() << "Snapshot saved to" << fileName;
+        emit snapshotSaved(fileName);
+    }
+    else
+    {
+        qCritical() << error;
+        emit snapshotFailed(error);
+    }
+}
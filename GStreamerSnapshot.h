@@ -0,0 +1,98 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerSnapshot_H
+#define GStreamerSnapshot_H
+
+#include <QObject>
+#include <QMutex>
+#include <QVector>
+#include <QAtomicInt>
+#include <QGst/Element>
+#include <gst/gst.h>
+
+/**
+ * @brief Full resolution stills from the last few decoded frames
+ *
+ * A probe in front of the frame mailbox keeps references to the most recent
+ * decoded buffers in a small ring. capture() picks one of them and encodes it
+ * to JPEG or PNG with gst_video_convert_sample() on the global thread pool,
+ * so neither the streaming nor the render thread ever waits for the encoder.
+ *
+ * Holding a buffer keeps it out of the decoder's pool, keep the ring small
+ * for hardware decoders with few output buffers. Buffers in GL memory
+ * (zero-copy) cannot be read back here, capture() then fails.
+ */
+class GStreamerSnapshot : public QObject
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(int ringSize READ getRingSize WRITE setRingSize NOTIFY ringSizeChanged)
+    Q_PROPERTY(QString format READ getFormat WRITE setFormat NOTIFY formatChanged)
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+
+    explicit GStreamerSnapshot(QObject *parent = 0);
+    ~GStreamerSnapshot();
+
+    /** @brief Start keeping frames arriving at the element's sink pad, null stops */
+    void setTailElement(const QGst::ElementPtr & tail);
+
+    int getRingSize() { return m_ringSize; }
+    void setRingSize(int size);
+
+    /** @brief Image format, "jpg" or "png" */
+    QString getFormat() { return m_format; }
+    void setFormat(const QString & format);
+
+    /** @brief Bytes of the decoded frames the ring holds */
+    qint64 heldBytes();
+
+    /** @brief An encode is running on the thread pool */
+    bool isBusy() { return m_pending.load() > 0; }
+
+public slots:
+    /** @brief Encode the frame framesBack frames before the newest one, false if there is none */
+    bool capture(int framesBack = 0);
+
+signals:
+    void ringSizeChanged(int);
+    void formatChanged(QString);
+    void busyChanged(bool);
+    void snapshotSaved(QString fileName);
+    void snapshotFailed(QString error);
+
+private slots:
+    void onEncoded(QString fileName, QString error);
+
+private:
+    static GstPadProbeReturn bufferProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+    void clearRing();
+
+    GstPad *m_pad;
+    gulong m_probeId;
+
+    QMutex m_mutex;             ///< Guards the ring, filled from the streaming thread
+    QVector<GstSample*> m_ring;
+    int m_next;                 ///< Slot the next frame goes to
+    int m_ringSize;
+
+    QString m_format;
+    QAtomicInt m_pending;
+};
+
+#endif // GStreamerSnapshot_H
@@ -0,0 +1,346 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GStreamerStats.h"
+#include "GStreamerFrameMailbox.h"
+#include "GStreamerFramePacer.h"
+#include <QDebug>
+#include <QGlib/Connect>
+#include <gst/gst.h>
+
+QElapsedTimer GStreamerStats::s_clock;
+QMutex GStreamerStats::s_sinksMutex;
+QHash<void*, GStreamerStats::RenderCounters*> GStreamerStats::s_sinks;
+
+GStreamerStats::GStreamerStats(QObject *parent)
+    : QObject(parent),
+      m_decodedFrames(0),
+      m_logging(false)
+{
+    if (!s_clock.isValid()) s_clock.start();
+    reset();
+
+    connect(&m_sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    m_sampleTimer.start(1000);
+    m_interval.start();
+}
+
+GStreamerStats::~GStreamerStats()
+{
+    setVideoSink(QGst::ElementPtr());
+    removeByteProbes();
+}
+
+void GStreamerStats::reset()
+{
+    m_decodedFrames = 0;
+    m_render.renderedFrames = 0;
+    m_decodedFps = 0;
+    m_renderedFps = 0;
+    m_droppedFrames = 0;
+    m_staleFrames = 0;
+    if (!m_videoSink.isNull()) GStreamerFrameMailbox::resetDroppedFrames((GstElement*)m_videoSink);
+    m_jitterLost = 0;
+    m_jitterLate = 0;
+    m_jitterDuplicates = 0;
+    m_jitterMs = 0;
+    m_bitrateKbps = 0;
+    m_jitterBytes = 0;
+    m_udpBytes = 0;
+    m_latencyMs = 0;
+    m_frameAgeMs = 0;
+    m_srtLost = 0;
+    m_srtRetransmitRequests = 0;
+    m_srtRttMs = 0;
+    m_fecRecovered = 0;
+    m_fecUnrecovered = 0;
+    m_judderMs = 0;
+    m_cadenceErrors = 0;
+    m_lateFrames = 0;
+    m_refreshHz = 0;
+    if (!m_videoSink.isNull()) GStreamerFramePacer::takeStats((GstElement*)m_videoSink);
+    emit statsChanged();
+}
+
+void GStreamerStats::setPipeline(const QGst::PipelinePtr & pipeline)
+{
+    removeByteProbes();
+    m_pipeline = pipeline;
+    reset();
+}
+
+void GStreamerStats::setVideoSink(const QGst::ElementPtr & sink)
+{
+    QMutexLocker locker(&s_sinksMutex);
+    if (!m_videoSink.isNull())
+    {
+        QGlib::disconnect(m_videoSink, "update", this, &GStreamerStats::onSinkUpdate);
+        s_sinks.remove((GstElement*)m_videoSink);
+    }
+    m_videoSink = sink;
+    if (!m_videoSink.isNull())
+    {
+        QGlib::connect(m_videoSink, "update", this, &GStreamerStats::onSinkUpdate);
+        s_sinks.insert((GstElement*)m_videoSink, &m_render);
+    }
+}
+
+void GStreamerStats::handleQos(const QGst::QosMessagePtr & message)
+{
+    // Sinks report the running total of dropped buffers
+    if (message->source() == m_videoSink)
+    {
+        m_droppedFrames = message->dropped();
+    }
+}
+
+void GStreamerStats::onSinkUpdate()
+{
+    m_decodedFrames++;
+    m_render.lastArrivalMs = (int)s_clock.elapsed();
+}
+
+void GStreamerStats::frameRendered(void *sink)
+{
+    QMutexLocker locker(&s_sinksMutex);
+    RenderCounters *counters = s_sinks.value(sink);
+    if (!counters) return;
+
+    counters->renderedFrames.ref();
+    counters->lastRenderedArrivalMs = counters->lastArrivalMs.load();
+    counters->lastRenderMs = (int)s_clock.elapsed();
+}
+
+void GStreamerStats::sample()
+{
+    qint64 elapsed = m_interval.restart();
+    if (elapsed <= 0) return;
+
+    m_decodedFps = m_decodedFrames * 1000.0 / elapsed;
+    m_decodedFrames = 0;
+    m_renderedFps = m_render.renderedFrames.fetchAndStoreOrdered(0) * 1000.0 / elapsed;
+    m_frameAgeMs = m_render.lastRenderMs.load() - m_render.lastRenderedArrivalMs.load();
+    m_staleFrames = m_videoSink.isNull() ? 0 : GStreamerFrameMailbox::droppedFrames((GstElement*)m_videoSink);
+    if (!m_videoSink.isNull())
+    {
+        GStreamerFramePacer::Stats pacing = GStreamerFramePacer::takeStats((GstElement*)m_videoSink);
+        m_judderMs = pacing.judderMs;
+        m_cadenceErrors = pacing.cadenceErrors;
+        m_lateFrames = pacing.lateFrames;
+    }
+    m_refreshHz = GStreamerFramePacer::refreshHz();
+
+    if (!m_pipeline.isNull())
+    {
+        sampleJitterBuffers(elapsed);
+        sampleLatency();
+    }
+
+    emit statsChanged();
+
+    if (m_logging)
+    {
+        qDebug() << "Video stats: decoded" << m_decodedFps << "fps, rendered" << m_renderedFps
+                 << "fps, dropped" << m_droppedFrames << ", stale" << m_staleFrames << ", lost" << m_jitterLost
+                 << ", late" << m_jitterLate << ", duplicates" << m_jitterDuplicates << ", jitter"
+                 << m_jitterMs << "ms," << m_bitrateKbps << "kbit/s, latency" << m_latencyMs << "ms, frame age"
+                 << m_frameAgeMs << "ms, judder" << m_judderMs << "ms, cadence errors" << m_cadenceErrors
+                 << ", late" << m_lateFrames << "at" << m_refreshHz << "Hz";
+        if (m_srtRttMs > 0)
+        {
+            qDebug() << "SRT stats: lost" << m_srtLost << ", retransmit requests" << m_srtRetransmitRequests
+                     << ", rtt" << m_srtRttMs << "ms";
+        }
+        if (m_fecRecovered > 0 || m_fecUnrecovered > 0)
+        {
+            qDebug() << "FEC stats: recovered" << m_fecRecovered << ", unrecovered" << m_fecUnrecovered;
+        }
+    }
+}
+
+void GStreamerStats::sampleJitterBuffers(qint64 elapsed)
+{
+    quint64 lost = 0;
+    quint64 late = 0;
+    quint64 duplicates = 0;
+    guint64 jitterSum = 0;
+    int jitterBuffers = 0;
+    quint64 fecRecovered = 0;
+    quint64 fecUnrecovered = 0;
+    m_srtLost = 0;
+    m_srtRetransmitRequests = 0;
+    m_srtRttMs = 0;
+
+    // Jitterbuffers may be nested (rtpbin) or created on the fly, walk the whole pipeline
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN((GstPipeline*)m_pipeline));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK)
+    {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory *factory = gst_element_get_factory(element);
+        if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "rtpjitterbuffer") == 0)
+        {
+            watchBytes(element, "sink", &m_jitterBytes);
+
+            GstStructure *stats = NULL;
+            g_object_get(element, "stats", &stats, NULL);
+            if (stats)
+            {
+                guint64 value = 0;
+                if (gst_structure_get_uint64(stats, "num-lost", &value)) lost += value;
+                if (gst_structure_get_uint64(stats, "num-late", &value)) late += value;
+                if (gst_structure_get_uint64(stats, "num-duplicates", &value)) duplicates += value;
+                if (gst_structure_get_uint64(stats, "avg-jitter", &value))
+                {
+                    jitterSum += value;
+                    jitterBuffers++;
+                }
+                gst_structure_free(stats);
+            }
+        }
+        else if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "udpsrc") == 0)
+        {
+            watchBytes(element, "src", &m_udpBytes);
+        }
+        else if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "srtsrc") == 0)
+        {
+            watchBytes(element, "src", &m_udpBytes);
+            sampleSrt(element);
+        }
+        else if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "rtpulpfecdec") == 0)
+        {
+            guint recovered = 0;
+            guint unrecovered = 0;
+            g_object_get(element, "recovered", &recovered, "unrecovered", &unrecovered, NULL);
+            fecRecovered += recovered;
+            fecUnrecovered += unrecovered;
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    m_jitterLost = lost;
+    m_jitterLate = late;
+    m_jitterDuplicates = duplicates;
+    m_jitterMs = jitterBuffers ? (double)jitterSum / jitterBuffers / GST_MSECOND : 0;
+    m_fecRecovered = fecRecovered;
+    m_fecUnrecovered = fecUnrecovered;
+
+    // Prefer the jitterbuffer inputs, udpsrc also carries RTCP there
+    int jitterBytes = m_jitterBytes.fetchAndStoreOrdered(0);
+    int udpBytes = m_udpBytes.fetchAndStoreOrdered(0);
+    int bytes = jitterBytes > 0 ? jitterBytes : udpBytes;
+    m_bitrateKbps = (int)(bytes * 8LL / elapsed);
+}
+
+// The SRT plugin's field types changed between releases, take any number
+static double statsNumber(const GstStructure *stats, const char *field)
+{
+    const GValue *value = gst_structure_get_value(stats, field);
+    if (value == NULL || !g_value_type_transformable(G_VALUE_TYPE(value), G_TYPE_DOUBLE)) return 0;
+
+    GValue number = G_VALUE_INIT;
+    g_value_init(&number, G_TYPE_DOUBLE);
+    g_value_transform(value, &number);
+    double result = g_value_get_double(&number);
+    g_value_unset(&number);
+    return result;
+}
+
+void GStreamerStats::sampleSrt(GstElement *element)
+{
+    GstStructure *stats = NULL;
+    g_object_get(element, "stats", &stats, NULL);
+    if (stats == NULL) return;
+
+    // A listener reports each caller in an array, the first one is the stream
+    const GstStructure *source = stats;
+    const GValue *callers = gst_structure_get_value(stats, "callers");
+    if (callers != NULL && G_VALUE_HOLDS(callers, G_TYPE_VALUE_ARRAY))
+    {
+        GValueArray *array = (GValueArray*)g_value_get_boxed(callers);
+        if (array != NULL && array->n_values > 0 && GST_VALUE_HOLDS_STRUCTURE(&array->values[0]))
+        {
+            source = gst_value_get_structure(&array->values[0]);
+        }
+    }
+
+    m_srtLost += (quint64)statsNumber(source, "packets-received-lost");
+    m_srtRetransmitRequests += (quint64)statsNumber(source, "packet-nack-sent");
+    m_srtRttMs = qMax(m_srtRttMs, statsNumber(source, "rtt-ms"));
+    gst_structure_free(stats);
+}
+
+void GStreamerStats::watchBytes(GstElement *element, const char *padName, QAtomicInt *counter)
+{
+    GstPad *pad = gst_element_get_static_pad(element, padName);
+    if (pad == NULL) return;
+
+    for (int i = 0; i < m_byteProbes.size(); i++)
+    {
+        if (m_byteProbes.at(i).first == pad)
+        {
+            gst_object_unref(pad);
+            return;
+        }
+    }
+
+    gulong id = gst_pad_add_probe(pad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                  &GStreamerStats::countBytesProbe, counter, NULL);
+    // Keep the reference, the probe is removed with the next pipeline
+    m_byteProbes.append(qMakePair(pad, id));
+}
+
+void GStreamerStats::removeByteProbes()
+{
+    for (int i = 0; i < m_byteProbes.size(); i++)
+    {
+        gst_pad_remove_probe(m_byteProbes.at(i).first, m_byteProbes.at(i).second);
+        gst_object_unref(m_byteProbes.at(i).first);
+    }
+    m_byteProbes.clear();
+}
+
+GstPadProbeReturn GStreamerStats::countBytesProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData)
+{
+    Q_UNUSED(pad);
+    QAtomicInt *counter = static_cast<QAtomicInt*>(userData);
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    {
+        counter->fetchAndAddRelaxed((int)gst_buffer_list_calculate_size(GST_PAD_PROBE_INFO_BUFFER_LIST(info)));
+    }
+    else
+    {
+        counter->fetchAndAddRelaxed((int)gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info)));
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void GStreamerStats::sampleLatency()
+{
+    GstQuery *query = gst_query_new_latency();
+    if (gst_element_query(GST_ELEMENT((GstPipeline*)m_pipeline), query))
+    {
+        gboolean live = FALSE;
+        GstClockTime minLatency = 0;
+        gst_query_parse_latency(query, &live, &minLatency, NULL);
+        m_latencyMs = (int)(minLatency / GST_MSECOND);
+    }
+    gst_query_unref(query);
+}
@@ -0,0 +1,191 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GStreamerStats_H
+#define GStreamerStats_H
+
+#include <QObject>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QGst/Pipeline>
+#include <QGst/Message>
+
+/**
+ * @brief Live statistics of the video path, sampled once per second
+ *
+ * Frames arriving at the sink are counted from its "update" signal, frames
+ * drawn by the scene graph from frameRendered() which is called by the
+ * update_node callback on the render thread. Dropped frames come from the
+ * sink QoS messages, lost/late/duplicate packets and jitter from the
+ * rtpjitterbuffer stats (including those rtpbin and rtspsrc create) and the
+ * latency from a pipeline latency query. The stream bitrate is counted at the
+ * jitterbuffer inputs, or at the udpsrc/srtsrc outputs of pipelines without
+ * one. SRT sources add their loss, retransmission requests and round trip
+ * time, rtpulpfecdec its recovered and unrecoverable packets. Judder and
+ * cadence come from GStreamerFramePacer.
+ */
+class GStreamerStats : public QObject
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(double decodedFps READ getDecodedFps NOTIFY statsChanged)
+    Q_PROPERTY(double renderedFps READ getRenderedFps NOTIFY statsChanged)
+    Q_PROPERTY(quint64 droppedFrames READ getDroppedFrames NOTIFY statsChanged)
+    Q_PROPERTY(int staleFrames READ getStaleFrames NOTIFY statsChanged)
+    Q_PROPERTY(quint64 jitterLost READ getJitterLost NOTIFY statsChanged)
+    Q_PROPERTY(quint64 jitterLate READ getJitterLate NOTIFY statsChanged)
+    Q_PROPERTY(quint64 jitterDuplicates READ getJitterDuplicates NOTIFY statsChanged)
+    Q_PROPERTY(double jitterMs READ getJitterMs NOTIFY statsChanged)
+    Q_PROPERTY(int bitrateKbps READ getBitrateKbps NOTIFY statsChanged)
+    Q_PROPERTY(int latencyMs READ getLatencyMs NOTIFY statsChanged)
+    Q_PROPERTY(int frameAgeMs READ getFrameAgeMs NOTIFY statsChanged)
+    Q_PROPERTY(quint64 srtLost READ getSrtLost NOTIFY statsChanged)
+    Q_PROPERTY(quint64 srtRetransmitRequests READ getSrtRetransmitRequests NOTIFY statsChanged)
+    Q_PROPERTY(double srtRttMs READ getSrtRttMs NOTIFY statsChanged)
+    Q_PROPERTY(quint64 fecRecovered READ getFecRecovered NOTIFY statsChanged)
+    Q_PROPERTY(quint64 fecUnrecovered READ getFecUnrecovered NOTIFY statsChanged)
+    Q_PROPERTY(double judderMs READ getJudderMs NOTIFY statsChanged)
+    Q_PROPERTY(int cadenceErrors READ getCadenceErrors NOTIFY statsChanged)
+    Q_PROPERTY(int lateFrames READ getLateFrames NOTIFY statsChanged)
+    Q_PROPERTY(double refreshHz READ getRefreshHz NOTIFY statsChanged)
+    Q_PROPERTY(bool logging READ getLogging WRITE setLogging NOTIFY loggingChanged)
+
+    explicit GStreamerStats(QObject *parent = 0);
+    ~GStreamerStats();
+
+    void setPipeline(const QGst::PipelinePtr & pipeline);
+    void setVideoSink(const QGst::ElementPtr & sink);
+    void handleQos(const QGst::QosMessagePtr & message);
+
+    /** @brief Called from the render thread each time the given sink's frame is drawn */
+    static void frameRendered(void *sink);
+
+    double getDecodedFps() { return m_decodedFps; }
+    double getRenderedFps() { return m_renderedFps; }
+    quint64 getDroppedFrames() { return m_droppedFrames; }
+    /** @brief Frames replaced in the frame mailbox before the renderer got to them */
+    int getStaleFrames() { return m_staleFrames; }
+    quint64 getJitterLost() { return m_jitterLost; }
+    quint64 getJitterLate() { return m_jitterLate; }
+    quint64 getJitterDuplicates() { return m_jitterDuplicates; }
+    /** @brief Average packet arrival jitter over all jitterbuffers */
+    double getJitterMs() { return m_jitterMs; }
+    /** @brief Received RTP payload rate, 0 for non network sources */
+    int getBitrateKbps() { return m_bitrateKbps; }
+    int getLatencyMs() { return m_latencyMs; }
+    int getFrameAgeMs() { return m_frameAgeMs; }
+    /** @brief Packets the SRT receiver saw missing, most are then retransmitted */
+    quint64 getSrtLost() { return m_srtLost; }
+    /** @brief NAKs the SRT receiver sent */
+    quint64 getSrtRetransmitRequests() { return m_srtRetransmitRequests; }
+    double getSrtRttMs() { return m_srtRttMs; }
+    /** @brief Media packets rebuilt by rtpulpfecdec */
+    quint64 getFecRecovered() { return m_fecRecovered; }
+    quint64 getFecUnrecovered() { return m_fecUnrecovered; }
+    /** @brief Displayed against timestamp frame intervals, see GStreamerFramePacer */
+    double getJudderMs() { return m_judderMs; }
+    /** @brief Frames shown at least half a refresh too long or too short, last second */
+    int getCadenceErrors() { return m_cadenceErrors; }
+    /** @brief Paced frames that missed their vsync, last second */
+    int getLateFrames() { return m_lateFrames; }
+    double getRefreshHz() { return m_refreshHz; }
+
+    bool getLogging() { return m_logging; }
+    void setLogging(bool logging)
+    {
+        if (m_logging != logging)
+        {
+            m_logging = logging;
+            emit loggingChanged(m_logging);
+        }
+    }
+
+public slots:
+    void reset();
+
+signals:
+    void statsChanged();
+    void loggingChanged(bool);
+
+private slots:
+    void sample();
+
+private:
+    void onSinkUpdate();
+    void sampleJitterBuffers(qint64 elapsed);
+    void sampleSrt(GstElement *element);
+    void sampleLatency();
+    void watchBytes(GstElement *element, const char *padName, QAtomicInt *counter);
+    void removeByteProbes();
+    static GstPadProbeReturn countBytesProbe(GstPad *pad, GstPadProbeInfo *info, gpointer userData);
+
+    QTimer m_sampleTimer;
+    QElapsedTimer m_interval;
+    QGst::PipelinePtr m_pipeline;
+    QGst::ElementPtr m_videoSink;
+
+    int m_decodedFrames;    ///< Since last sample, UI thread only
+
+    double m_decodedFps;
+    double m_renderedFps;
+    quint64 m_droppedFrames;
+    int m_staleFrames;
+    quint64 m_jitterLost;
+    quint64 m_jitterLate;
+    quint64 m_jitterDuplicates;
+    double m_jitterMs;
+    int m_bitrateKbps;
+    int m_latencyMs;
+    int m_frameAgeMs;
+    quint64 m_srtLost;
+    quint64 m_srtRetransmitRequests;
+    double m_srtRttMs;
+    quint64 m_fecRecovered;
+    quint64 m_fecUnrecovered;
+    double m_judderMs;
+    int m_cadenceErrors;
+    int m_lateFrames;
+    double m_refreshHz;
+    bool m_logging;
+
+    // Shared with the render thread, found there through the sink being drawn
+    struct RenderCounters
+    {
+        QAtomicInt renderedFrames;
+        QAtomicInt lastArrivalMs;
+        QAtomicInt lastRenderedArrivalMs;
+        QAtomicInt lastRenderMs;
+    };
+    RenderCounters m_render;
+
+    // Bytes since the last sample, counted on the streaming threads
+    QAtomicInt m_jitterBytes;
+    QAtomicInt m_udpBytes;         ///< udpsrc and srtsrc outputs
+    QList<QPair<GstPad*, gulong> > m_byteProbes;
+
+    static QElapsedTimer s_clock;
+    static QMutex s_sinksMutex;
+    static QHash<void*, RenderCounters*> s_sinks;
+};
+
+#endif // GStreamerStats_H
@@ -0,0 +1,129 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief GroundClock
+ *          See GroundClock.h
+ *
+ */
+
+#include "GroundClock.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#ifdef Q_OS_UNIX
+#include <time.h>
+#endif
+
+QAtomicInt GroundClock::s_sequence;
+QAtomicInt GroundClock::s_calibrateAt(-1);
+qint64 GroundClock::s_offsetUs = 0;
+
+#ifdef Q_OS_UNIX
+static qint64 readClock(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return qint64(ts.tv_sec) * Q_INT64_C(1000000000) + ts.tv_nsec;
+}
+
+// Started before main, the link threads may read it before anything else ran
+static const qint64 s_startNs = readClock(CLOCK_MONOTONIC);
+
+qint64 GroundClock::nsecs()
+{
+    return readClock(CLOCK_MONOTONIC) - s_startNs;
+}
+
+static qint64 wallClockUs()
+{
+    return readClock(CLOCK_REALTIME) / 1000;
+}
+#else
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+static const QElapsedTimer s_clock = startedClock();
+
+qint64 GroundClock::nsecs()
+{
+    return s_clock.nsecsElapsed();
+}
+
+static qint64 wallClockUs()
+{
+    return QDateTime::currentMSecsSinceEpoch() * 1000;
+}
+#endif
+
+void GroundClock::calibrate()
+{
+    // One thread measures, the others go on with the offset they have
+    static QMutex calibrating;
+    if (!calibrating.tryLock())
+    {
+        return;
+    }
+    // The wall clock read is bracketed by two monotonic ones, its middle is the best match
+    const qint64 before = nsecs();
+    const qint64 wall = wallClockUs();
+    const qint64 after = nsecs();
+    const qint64 offset = wall - (before + after) / 2000;
+
+    s_sequence.fetchAndAddAcquire(1);
+    s_offsetUs = offset;
+    s_sequence.fetchAndAddRelease(1);
+    s_calibrateAt.storeRelease(int(after / Q_INT64_C(1000000000)) + CalibrateSeconds);
+    calibrating.unlock();
+}
+
+qint64 GroundClock::offsetUs()
+{
+    qint64 offset;
+    int sequence;
+    do
+    {
+        sequence = s_sequence.loadAcquire();
+        offset = s_offsetUs;
+    } while ((sequence & 1) || sequence != s_sequence.loadAcquire());
+    return offset;
+}
+
+quint64 GroundClock::wallUsecs(qint64 monotonicNs)
+{
+    const int calibrateAt = s_calibrateAt.loadAcquire();
+    if (calibrateAt < 0 || monotonicNs / Q_INT64_C(1000000000) >= calibrateAt)
+    {
+        calibrate();
+        // Only the first call may find no offset yet, while another thread measures it
+        while (s_calibrateAt.loadAcquire() < 0)
+        {
+            calibrate();
+        }
+    }
+    return static_cast<quint64>(monotonicNs / 1000 + offsetUs());
+}
@@ -0,0 +1,85 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief GroundClock
+ *          The one clock of the ground station. A monotonic nanosecond
+ *          reading is a single clock_gettime(), wall time is that reading
+ *          plus an offset to UTC that is measured again every
+ *          CalibrateSeconds, so the hot path never builds a QDateTime and
+ *          wall time has microsecond resolution. A Stamp takes one reading
+ *          for a whole batch, e.g. every frame of a link read.
+ *
+ */
+
+#ifndef GROUNDCLOCK_H
+#define GROUNDCLOCK_H
+
+#include <QAtomicInt>
+#include <QtGlobal>
+
+class GroundClock
+{
+public:
+    enum { CalibrateSeconds = 10 };
+
+    /** @brief Monotonic nanoseconds since the process started, any thread */
+    static qint64 nsecs();
+    static qint64 usecs() { return nsecs() / 1000; }
+    static qint64 msecs() { return nsecs() / 1000000; }
+
+    /** @brief UTC microseconds since the epoch, now */
+    static quint64 wallUsecs() { return wallUsecs(nsecs()); }
+    /** @brief UTC microseconds since the epoch of an earlier nsecs() reading */
+    static quint64 wallUsecs(qint64 monotonicNs);
+    static quint64 wallMsecs() { return wallUsecs() / 1000; }
+
+    /** @brief Measure the offset to UTC again, e.g. after the system time was set */
+    static void calibrate();
+
+    /** @brief One reading shared by everything of a batch */
+    class Stamp
+    {
+    public:
+        Stamp() : m_ns(GroundClock::nsecs()) {}
+        /** @brief An nsecs() reading taken before, 0 or less takes one now */
+        explicit Stamp(qint64 monotonicNs) : m_ns(monotonicNs > 0 ? monotonicNs : GroundClock::nsecs()) {}
+
+        qint64 nsecs() const { return m_ns; }
+        qint64 msecs() const { return m_ns / 1000000; }
+        quint64 wallUsecs() const { return GroundClock::wallUsecs(m_ns); }
+        quint64 wallMsecs() const { return wallUsecs() / 1000; }
+
+    private:
+        qint64 m_ns;
+    };
+
+private:
+    static qint64 offsetUs();
+
+    static QAtomicInt s_sequence;       ///< Odd while the offset is written
+    static QAtomicInt s_calibrateAt;    ///< Monotonic second the offset is due again
+    static qint64 s_offsetUs;           ///< UTC minus monotonic
+};
+
+#endif // GROUNDCLOCK_H
@@ -0,0 +1,407 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HilBridge
+ *          See HilBridge.h
+ *
+ */
+
+#include "HilBridge.h"
+#include "MAVLinkSender.h"
+#include "GroundClock.h"
+#include "QsLog.h"
+#include <QUdpSocket>
+#include <QtEndian>
+#include <cstring>
+#include <qmath.h>
+
+static const double deg2rad = M_PI / 180.0;
+static const double gravity = 9.80665;
+// Roughly central Europe, the autopilots only need a plausible direction
+static const float earthFieldNorth = 0.21f, earthFieldEast = 0.015f, earthFieldDown = 0.42f;
+// HIL_SENSOR fields_updated: acceleration, gyro, mag, both pressures, pressure altitude, temperature
+static const quint32 allSensorFields = 0x1fff;
+
+static double readDouble(const uchar *data)
+{
+    const quint64 bits = qFromBigEndian<quint64>(data);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static float readFloat(const uchar *data)
+{
+    const quint32 bits = qFromBigEndian<quint32>(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void writeFloat(float value, uchar *data)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToBigEndian<quint32>(bits, data);
+}
+
+HilBridge::HilBridge(MAVLinkSender *sender, QObject *parent) :
+    QThread(parent),
+    m_sender(sender),
+    m_simPort(0),
+    m_localPort(0),
+    m_gcsSystem(0),
+    m_gcsComponent(0),
+    m_targetSystem(0),
+    m_rateHz(DefaultRateHz),
+    m_output(StateOutput),
+    m_controlsSerial(0),
+    m_controlsNs(0),
+    m_stopping(false)
+{
+    Controls neutral = { 0, 0, 0, 0 };
+    m_controls = neutral;
+    memset(&m_stateMessage, 0, sizeof(m_stateMessage));
+    memset(&m_gpsMessage, 0, sizeof(m_gpsMessage));
+}
+
+HilBridge::~HilBridge()
+{
+    close();
+}
+
+bool HilBridge::open(const QHostAddress &simHost, quint16 simPort, quint16 localPort)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isRunning())
+    {
+        return false;
+    }
+    m_simHost = simHost;
+    m_simPort = simPort;
+    m_localPort = localPort;
+    m_controlsSerial = 0;
+    m_stats = Stats();
+    m_stopping = false;
+    start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void HilBridge::close()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+    }
+    wait();
+}
+
+bool HilBridge::isOpen() const
+{
+    return isRunning();
+}
+
+void HilBridge::setTarget(int gcsSystem, int gcsComponent, int targetSystem, const QList<int> &linkIds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_gcsSystem = gcsSystem;
+    m_gcsComponent = gcsComponent;
+    m_targetSystem = targetSystem;
+    m_links = linkIds;
+}
+
+void HilBridge::setRate(int hz)
+{
+    QMutexLocker locker(&m_mutex);
+    m_rateHz = qBound(static_cast<int>(MinRateHz), hz, static_cast<int>(MaxRateHz));
+}
+
+void HilBridge::setOutput(Output output)
+{
+    QMutexLocker locker(&m_mutex);
+    m_output = output;
+}
+
+HilBridge::Stats HilBridge::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void HilBridge::record(const mavlink_message_t &message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_HIL_CONTROLS)
+    {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (message.sysid != m_targetSystem)
+    {
+        return;
+    }
+    m_controls.aileron = mavlink_msg_hil_controls_get_roll_ailerons(&message);
+    m_controls.elevator = mavlink_msg_hil_controls_get_pitch_elevator(&message);
+    m_controls.rudder = mavlink_msg_hil_controls_get_yaw_rudder(&message);
+    m_controls.throttle = mavlink_msg_hil_controls_get_throttle(&message);
+    m_controlsNs = GroundClock::nsecs();
+    m_controlsSerial++;
+    m_stats.controlsReceived++;
+}
+
+bool HilBridge::decode(const uchar *data, SimState *state)
+{
+    state->lat = readDouble(data);
+    state->lon = readDouble(data + 8);
+    state->alt = readFloat(data + 16);
+    state->roll = readFloat(data + 20);
+    state->pitch = readFloat(data + 24);
+    state->yaw = readFloat(data + 28);
+    state->p = readFloat(data + 32);
+    state->q = readFloat(data + 36);
+    state->r = readFloat(data + 40);
+    state->vn = readFloat(data + 44);
+    state->ve = readFloat(data + 48);
+    state->vd = readFloat(data + 52);
+    state->ax = readFloat(data + 56);
+    state->ay = readFloat(data + 60);
+    state->az = readFloat(data + 64);
+    state->airspeed = readFloat(data + 68);
+    return !qIsNaN(state->lat) && !qIsNaN(state->lon) && qAbs(state->lat) <= 90.0 && qAbs(state->lon) <= 180.0;
+}
+
+void HilBridge::packState(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent)
+{
+    mavlink_msg_hil_state_pack(gcsSystem, gcsComponent, &m_stateMessage, timeUsec,
+                               state.roll * deg2rad, state.pitch * deg2rad, state.yaw * deg2rad,
+                               state.p * deg2rad, state.q * deg2rad, state.r * deg2rad,
+                               static_cast<int32_t>(qRound64(state.lat * 1E7)),
+                               static_cast<int32_t>(qRound64(state.lon * 1E7)),
+                               static_cast<int32_t>(qRound(state.alt * 1000.0f)),
+                               static_cast<int16_t>(qRound(state.vn * 100.0f)),
+                               static_cast<int16_t>(qRound(state.ve * 100.0f)),
+                               static_cast<int16_t>(qRound(state.vd * 100.0f)),
+                               static_cast<int16_t>(qRound(state.ax / gravity * 1000.0)),
+                               static_cast<int16_t>(qRound(state.ay / gravity * 1000.0)),
+                               static_cast<int16_t>(qRound(state.az / gravity * 1000.0)));
+}
+
+void HilBridge::packSensor(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent)
+{
+    // Earth field into the body frame, rows of the NED to body rotation
+    const double sr = sin(state.roll * deg2rad), cr = cos(state.roll * deg2rad);
+    const double sp = sin(state.pitch * deg2rad), cp = cos(state.pitch * deg2rad);
+    const double sy = sin(state.yaw * deg2rad), cy = cos(state.yaw * deg2rad);
+    const float xmag = cp * cy * earthFieldNorth + cp * sy * earthFieldEast - sp * earthFieldDown;
+    const float ymag = (sr * sp * cy - cr * sy) * earthFieldNorth + (sr * sp * sy + cr * cy) * earthFieldEast
+            + sr * cp * earthFieldDown;
+    const float zmag = (cr * sp * cy + sr * sy) * earthFieldNorth + (cr * sp * sy - sr * cy) * earthFieldEast
+            + cr * cp * earthFieldDown;
+
+    // Standard atmosphere, hPa
+    const float absPressure = 1013.25 * pow(1.0 - 2.25577E-5 * state.alt, 5.25588);
+    const float diffPressure = 0.5f * 1.225f * state.airspeed * state.airspeed / 100.0f;
+    const float temperature = 15.0f - 0.0065f * state.alt;
+
+    mavlink_msg_hil_sensor_pack(gcsSystem, gcsComponent, &m_stateMessage, timeUsec,
+                                state.ax, state.ay, state.az,
+                                state.p * deg2rad, state.q * deg2rad, state.r * deg2rad,
+                                xmag, ymag, zmag, absPressure, diffPressure, state.alt, temperature,
+                                allSensorFields);
+}
+
+void HilBridge::packGps(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent)
+{
+    const double groundSpeed = sqrt(state.vn * state.vn + state.ve * state.ve);
+    double course = atan2(state.ve, state.vn) / deg2rad;
+    if (course < 0)
+    {
+        course += 360.0;
+    }
+    mavlink_msg_hil_gps_pack(gcsSystem, gcsComponent, &m_gpsMessage, timeUsec, 3,
+                             static_cast<int32_t>(qRound64(state.lat * 1E7)),
+                             static_cast<int32_t>(qRound64(state.lon * 1E7)),
+                             static_cast<int32_t>(qRound(state.alt * 1000.0f)),
+                             100, 100, static_cast<uint16_t>(qRound(groundSpeed * 100.0)),
+                             static_cast<int16_t>(qRound(state.vn * 100.0f)),
+                             static_cast<int16_t>(qRound(state.ve * 100.0f)),
+                             static_cast<int16_t>(qRound(state.vd * 100.0f)),
+                             static_cast<uint16_t>(qRound(course * 100.0)) % 36000, 10);
+}
+
+void HilBridge::run()
+{
+    QUdpSocket socket;
+    m_mutex.lock();
+    const quint16 localPort = m_localPort;
+    m_mutex.unlock();
+    if (!socket.bind(QHostAddress::Any, localPort))
+    {
+        QLOG_ERROR() << "HIL bridge cannot listen on port" << localPort << socket.errorString();
+        emit error(tr("HIL bridge cannot listen on port %1: %2").arg(localPort).arg(socket.errorString()));
+        return;
+    }
+    QLOG_INFO() << "HIL bridge listening on port" << localPort;
+
+    SimState state;
+    memset(&state, 0, sizeof(state));
+    bool stateFresh = false;
+    qint64 lastDatagram = 0;
+    qint64 nextGps = 0;
+    qint64 jitterSumUs = 0;
+    quint32 sentSerial = 0;
+    qint64 next = GroundClock::nsecs();
+
+    forever
+    {
+        m_mutex.lock();
+        if (m_stopping)
+        {
+            m_mutex.unlock();
+            break;
+        }
+        // Copied once per tick, the socket and the links are used outside the lock
+        const qint64 periodNs = Q_INT64_C(1000000000) / m_rateHz;
+        const QHostAddress simHost = m_simHost;
+        const quint16 simPort = m_simPort;
+        const int gcsSystem = m_gcsSystem;
+        const int gcsComponent = m_gcsComponent;
+        const QList<int> links = m_links;
+        const Output output = m_output;
+        const Controls controls = m_controls;
+        const quint32 controlsSerial = m_controlsSerial;
+        const qint64 controlsNs = m_controlsNs;
+        m_mutex.unlock();
+
+        const qint64 now = GroundClock::nsecs();
+        const qint64 jitterUs = qMax(Q_INT64_C(0), (now - next) / 1000);
+        quint32 received = 0;
+        quint32 bad = 0;
+        qint64 intervalUs = -1;
+
+        // Only the newest state matters, a backlog is read and dropped
+        while (socket.hasPendingDatagrams())
+        {
+            const qint64 size = socket.readDatagram(reinterpret_cast<char*>(m_received), sizeof(m_received));
+            if (size == StateDatagramSize && decode(m_received, &state))
+            {
+                const qint64 arrived = GroundClock::nsecs();
+                if (lastDatagram)
+                {
+                    intervalUs = (arrived - lastDatagram) / 1000;
+                }
+                lastDatagram = arrived;
+                stateFresh = true;
+                received++;
+            }
+            else if (size >= 0)
+            {
+                bad++;
+            }
+        }
+
+        bool stateSent = false;
+        if (stateFresh && !links.isEmpty())
+        {
+            const quint64 timeUsec = GroundClock::wallUsecs(now);
+            if (output == StateOutput)
+            {
+                packState(state, timeUsec, gcsSystem, gcsComponent);
+            }
+            else
+            {
+                packSensor(state, timeUsec, gcsSystem, gcsComponent);
+            }
+            foreach (int link, links)
+            {
+                m_sender->sendNow(link, m_stateMessage);
+            }
+            if (output == SensorOutput && now >= nextGps)
+            {
+                packGps(state, timeUsec, gcsSystem, gcsComponent);
+                foreach (int link, links)
+                {
+                    m_sender->sendNow(link, m_gpsMessage);
+                }
+                nextGps = now + Q_INT64_C(1000000000) / GpsRateHz;
+            }
+            stateFresh = false;
+            stateSent = true;
+        }
+
+        // The simulator gets the controls every tick once the vehicle sent any
+        bool controlsSent = false;
+        if (controlsSerial != 0 && simPort != 0)
+        {
+            writeFloat(controls.aileron, m_controlsDatagram);
+            writeFloat(controls.elevator, m_controlsDatagram + 4);
+            writeFloat(controls.rudder, m_controlsDatagram + 8);
+            writeFloat(controls.throttle, m_controlsDatagram + 12);
+            controlsSent = socket.writeDatagram(reinterpret_cast<const char*>(m_controlsDatagram),
+                                                ControlsDatagramSize, simHost, simPort) == ControlsDatagramSize;
+        }
+        const qint64 sent = GroundClock::nsecs();
+
+        m_mutex.lock();
+        m_stats.ticks++;
+        jitterSumUs += jitterUs;
+        m_stats.maxJitterUs = qMax(m_stats.maxJitterUs, jitterUs);
+        m_stats.meanJitterUs = jitterSumUs / m_stats.ticks;
+        m_stats.statesReceived += received;
+        m_stats.badDatagrams += bad;
+        if (intervalUs >= 0)
+        {
+            m_stats.simIntervalUs = intervalUs;
+            m_stats.maxSimIntervalUs = qMax(m_stats.maxSimIntervalUs, intervalUs);
+        }
+        if (stateSent)
+        {
+            m_stats.statesSent++;
+        }
+        if (controlsSent)
+        {
+            m_stats.controlsSent++;
+            if (controlsSerial != sentSerial)
+            {
+                m_stats.controlLatencyUs = (sent - controlsNs) / 1000;
+                m_stats.maxControlLatencyUs = qMax(m_stats.maxControlLatencyUs, m_stats.controlLatencyUs);
+                sentSerial = controlsSerial;
+            }
+        }
+        m_mutex.unlock();
+
+        // Fixed ticks, a late one is not made up for
+        next += periodNs;
+        const qint64 after = GroundClock::nsecs();
+        if (next <= after)
+        {
+            next = after + periodNs;
+        }
+        QThread::usleep(static_cast<unsigned long>((next - after) / 1000));
+    }
+
+    const Stats stats = this->stats();
+    QLOG_INFO() << "HIL bridge stopped," << stats.ticks << "ticks," << stats.statesReceived << "states in,"
+                << stats.statesSent << "sent," << stats.controlsReceived << "controls in," << stats.controlsSent
+                << "sent, jitter mean" << stats.meanJitterUs << "us max" << stats.maxJitterUs << "us";
+}
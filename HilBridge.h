@@ -0,0 +1,166 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HilBridge
+ *          Hardware in the loop between a simulator on UDP and the vehicle,
+ *          on its own thread at RateHz (200 to 400 Hz). Every tick the
+ *          newest simulator state is sent to the vehicle as HIL_STATE, or
+ *          as HIL_SENSOR with HIL_GPS at GpsRateHz, through
+ *          MAVLinkSender::sendNow(); the newest HIL_CONTROLS, taken on the
+ *          ingest thread by record(), goes back to the simulator. Neither
+ *          direction passes the UI thread, and the messages and datagrams
+ *          are packed into buffers allocated once.
+ *
+ *          Datagrams are big endian, the byte order of the FlightGear
+ *          generic binary protocol, so a protocol file listing the same
+ *          fields drives FlightGear directly and other simulators (JSBSim,
+ *          X-Plane plugins) need only a small adapter. From the simulator,
+ *          StateDatagramSize bytes:
+ *            double latitude, longitude (deg), float altitude AMSL (m),
+ *            float roll, pitch, heading (deg), float p, q, r (deg/s),
+ *            float north, east, down speed (m/s),
+ *            float x, y, z body acceleration (m/s^2), float airspeed (m/s)
+ *          To the simulator, ControlsDatagramSize bytes:
+ *            float aileron, elevator, rudder (-1..1), throttle (0..1)
+ *
+ */
+
+#ifndef HILBRIDGE_H
+#define HILBRIDGE_H
+
+#include <QThread>
+#include <QHostAddress>
+#include <QList>
+#include <QMutex>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class MAVLinkSender;
+
+class HilBridge : public QThread
+{
+    Q_OBJECT
+public:
+    enum {
+        DefaultRateHz = 250,
+        MinRateHz = 50,
+        MaxRateHz = 400,
+        GpsRateHz = 10,
+        StateDatagramSize = 72,
+        ControlsDatagramSize = 16
+    };
+    enum Output {
+        StateOutput,        ///< HIL_STATE, e.g. ArduPilot
+        SensorOutput        ///< HIL_SENSOR and HIL_GPS, e.g. PX4
+    };
+
+    struct Stats
+    {
+        quint32 ticks;
+        quint32 statesReceived;     ///< Simulator datagrams
+        quint32 statesSent;         ///< Ticks that sent a new state to the vehicle
+        quint32 controlsReceived;   ///< HIL_CONTROLS
+        quint32 controlsSent;       ///< Datagrams to the simulator
+        quint32 badDatagrams;
+        qint64 maxJitterUs;         ///< Latest a tick ran after its time
+        qint64 meanJitterUs;
+        qint64 simIntervalUs;       ///< Between the last two simulator datagrams
+        qint64 maxSimIntervalUs;
+        qint64 controlLatencyUs;    ///< HIL_CONTROLS parsed to its datagram sent, of the last one
+        qint64 maxControlLatencyUs;
+        Stats() : ticks(0), statesReceived(0), statesSent(0), controlsReceived(0), controlsSent(0),
+            badDatagrams(0), maxJitterUs(0), meanJitterUs(0), simIntervalUs(0), maxSimIntervalUs(0),
+            controlLatencyUs(0), maxControlLatencyUs(0) { }
+    };
+
+    explicit HilBridge(MAVLinkSender *sender, QObject *parent = 0);
+    ~HilBridge();
+
+    /**
+     * @brief Start exchanging with the simulator at simHost:simPort, listening on localPort
+     * @return false if already open
+     */
+    bool open(const QHostAddress &simHost, quint16 simPort, quint16 localPort);
+    void close();
+    bool isOpen() const;
+
+    /** @brief Who the HIL messages are from and go to, links by id */
+    void setTarget(int gcsSystem, int gcsComponent, int targetSystem, const QList<int> &linkIds);
+    void setRate(int hz);
+    void setOutput(Output output);
+    /** @brief Takes HIL_CONTROLS of the target system. Ingest thread */
+    void record(const mavlink_message_t &message);
+    Stats stats() const;
+
+signals:
+    /** @brief The socket could not be bound, from the bridge thread */
+    void error(const QString &message);
+
+protected:
+    void run();
+
+private:
+    struct SimState
+    {
+        double lat, lon;
+        float alt;
+        float roll, pitch, yaw;
+        float p, q, r;
+        float vn, ve, vd;
+        float ax, ay, az;
+        float airspeed;
+    };
+    struct Controls
+    {
+        float aileron, elevator, rudder, throttle;
+    };
+    static bool decode(const uchar *data, SimState *state);
+    void packState(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent);
+    void packSensor(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent);
+    void packGps(const SimState &state, quint64 timeUsec, int gcsSystem, int gcsComponent);
+
+    MAVLinkSender *m_sender;
+    mutable QMutex m_mutex;
+    QHostAddress m_simHost;
+    quint16 m_simPort;
+    quint16 m_localPort;
+    int m_gcsSystem;
+    int m_gcsComponent;
+    int m_targetSystem;
+    QList<int> m_links;
+    int m_rateHz;
+    Output m_output;
+    Controls m_controls;
+    quint32 m_controlsSerial;   ///< Bumped by every HIL_CONTROLS
+    qint64 m_controlsNs;        ///< GroundClock of the last HIL_CONTROLS
+    bool m_stopping;
+    Stats m_stats;
+
+    // Bridge thread only, allocated once
+    mavlink_message_t m_stateMessage;
+    mavlink_message_t m_gpsMessage;
+    uchar m_received[512];
+    uchar m_controlsDatagram[ControlsDatagramSize];
+};
+
+#endif // HILBRIDGE_H
@@ -0,0 +1,290 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudBurnInRecorder
+ *          See HudBurnInRecorder.h
+ *
+ */
+
+#include "HudBurnInRecorder.h"
+#include "configuration.h"
+#include "QsLog.h"
+#include <QDateTime>
+#include <QQuickWindow>
+#ifdef Q_OS_ANDROID
+#include <QtAndroidExtras/QAndroidJniObject>
+#include <QtAndroidExtras/QAndroidJniEnvironment>
+#include <android/native_window.h>
+#include <android/native_window_jni.h>
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+static const char *HudEncoderClass = "org/qtproject/qt5/android/bindings/HudEncoder";
+
+// GLES 3 and EGL_ANDROID_presentation_time, looked up at run time so a GLES 2 build still links
+typedef void (GL_APIENTRY *BlitFramebufferFunc)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum);
+typedef EGLBoolean (EGLAPIENTRY *PresentationTimeFunc)(EGLDisplay, EGLSurface, qint64);
+
+static void clearException(QAndroidJniEnvironment &env)
+{
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+#endif
+
+HudBurnInRecorder::HudBurnInRecorder(QQuickWindow *window, QObject *parent) :
+    QObject(parent),
+    m_window(window),
+    m_state(Idle),
+    m_nativeWindow(NULL),
+    m_eglSurface(NULL),
+    m_nextFrameNs(0)
+{
+    // One atomic load per frame while not recording
+    connect(m_window, SIGNAL(afterRendering()), this, SLOT(onAfterRendering()), Qt::DirectConnection);
+}
+
+HudBurnInRecorder::~HudBurnInRecorder()
+{
+    disconnect(m_window, SIGNAL(afterRendering()), this, SLOT(onAfterRendering()));
+    if (m_state.load() != Idle)
+    {
+        releaseSurface();
+#ifdef Q_OS_ANDROID
+        QAndroidJniObject::callStaticMethod<void>(HudEncoderClass, "stop", "()V");
+        QAndroidJniEnvironment env;
+        clearException(env);
+#endif
+    }
+}
+
+bool HudBurnInRecorder::start()
+{
+    if (m_state.load() != Idle)
+    {
+        return false;
+    }
+#ifdef Q_OS_ANDROID
+    QSize window = m_window->size() * m_window->devicePixelRatio();
+    double scale = qMin(1.0, double(MaxWidth) / qMax(1, window.width()));
+    m_size = QSize(int(window.width() * scale) / SizeAlignment * SizeAlignment,
+                   int(window.height() * scale) / SizeAlignment * SizeAlignment);
+    if (m_size.isEmpty())
+    {
+        return false;
+    }
+    m_fileName = QGC::videoDirectory() + "/" + QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss") + " hud.mp4";
+
+    QAndroidJniObject path = QAndroidJniObject::fromString(m_fileName);
+    QAndroidJniObject surface = QAndroidJniObject::callStaticObjectMethod(HudEncoderClass, "start",
+            "(Ljava/lang/String;IIII)Landroid/view/Surface;", path.object<jstring>(),
+            m_size.width(), m_size.height(), int(BitRate), int(FrameRate));
+    QAndroidJniEnvironment env;
+    clearException(env);
+    if (surface.isValid())
+    {
+        m_nativeWindow = ANativeWindow_fromSurface(env, surface.object());
+    }
+    if (m_nativeWindow == NULL)
+    {
+        QAndroidJniObject::callStaticMethod<void>(HudEncoderClass, "stop", "()V");
+        clearException(env);
+        emit messageBox(tr("The hardware encoder could not be started, recording with the HUD needs Android 4.3"));
+        return false;
+    }
+
+    QLOG_INFO() << "Recording the HUD at" << m_size.width() << "x" << m_size.height() << "to" << m_fileName;
+    // The render thread takes the window over from here
+    m_state.storeRelease(Starting);
+    m_window->update();
+    emit recordingChanged();
+    return true;
+#else
+    emit messageBox(tr("Recording with the HUD needs the Android hardware encoder"));
+    return false;
+#endif
+}
+
+void HudBurnInRecorder::stop()
+{
+    if (!m_state.testAndSetOrdered(Recording, Stopping) && !m_state.testAndSetOrdered(Starting, Stopping))
+    {
+        return;
+    }
+    if (!m_window->isExposed())
+    {
+        // Nothing renders, so the render thread is not using the surface either
+        releaseSurface();
+        m_state.storeRelease(Idle);
+        finishStop();
+        return;
+    }
+    m_window->update();
+}
+
+// Render thread, the frame is drawn and not swapped yet
+void HudBurnInRecorder::onAfterRendering()
+{
+    int state = m_state.loadAcquire();
+    if (state == Idle)
+    {
+        return;
+    }
+    if (state == Stopping)
+    {
+        releaseSurface();
+        m_state.storeRelease(Idle);
+        QMetaObject::invokeMethod(this, "finishStop", Qt::QueuedConnection);
+        return;
+    }
+
+    const qint64 intervalNs = Q_INT64_C(1000000000) / FrameRate;
+    if (state == Starting)
+    {
+        m_clock.start();
+        m_nextFrameNs = 0;
+        m_state.testAndSetOrdered(Starting, Recording);
+    }
+    // A quarter of a frame early still counts, a 60 Hz HUD gives every other frame
+    qint64 now = m_clock.nsecsElapsed();
+    if (now < m_nextFrameNs - intervalNs / 4)
+    {
+        return;
+    }
+    m_nextFrameNs = (now - m_nextFrameNs > intervalNs) ? now + intervalNs : m_nextFrameNs + intervalNs;
+
+    if (!encodeFrame())
+    {
+        releaseSurface();
+        m_state.storeRelease(Idle);
+        QMetaObject::invokeMethod(this, "onEncodeFailed", Qt::QueuedConnection,
+                                  Q_ARG(QString, tr("Recording with the HUD failed, it needs OpenGL ES 3")));
+    }
+}
+
+bool HudBurnInRecorder::encodeFrame()
+{
+#ifdef Q_OS_ANDROID
+    static BlitFramebufferFunc blitFramebuffer = reinterpret_cast<BlitFramebufferFunc>(eglGetProcAddress("glBlitFramebuffer"));
+    static PresentationTimeFunc presentationTime = reinterpret_cast<PresentationTimeFunc>(eglGetProcAddress("eglPresentationTimeANDROID"));
+    if (blitFramebuffer == NULL)
+    {
+        return false;
+    }
+
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext context = eglGetCurrentContext();
+    EGLSurface draw = eglGetCurrentSurface(EGL_DRAW);
+    EGLSurface read = eglGetCurrentSurface(EGL_READ);
+    if (m_eglSurface == NULL)
+    {
+        // Same config as the scene graph's context, so that context can draw into it
+        EGLint configId = 0;
+        eglQueryContext(display, context, EGL_CONFIG_ID, &configId);
+        const EGLint attributes[] = { EGL_CONFIG_ID, configId, EGL_NONE };
+        EGLConfig config;
+        EGLint count = 0;
+        if (!eglChooseConfig(display, attributes, &config, 1, &count) || count < 1)
+        {
+            return false;
+        }
+        EGLSurface surface = eglCreateWindowSurface(display, config, static_cast<ANativeWindow*>(m_nativeWindow), NULL);
+        if (surface == EGL_NO_SURFACE)
+        {
+            QLOG_ERROR() << "Cannot create the encoder's EGL surface, error" << eglGetError();
+            return false;
+        }
+        m_eglSurface = surface;
+    }
+
+    EGLint width = 0;
+    EGLint height = 0;
+    eglQuerySurface(display, read, EGL_WIDTH, &width);
+    eglQuerySurface(display, read, EGL_HEIGHT, &height);
+    // Framebuffer 0 reads from the window and draws to the encoder now
+    if (!eglMakeCurrent(display, m_eglSurface, read, context))
+    {
+        return false;
+    }
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDisable(GL_SCISSOR_TEST);
+    blitFramebuffer(0, 0, width, height, 0, 0, m_size.width(), m_size.height(), GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    if (presentationTime != NULL)
+    {
+        presentationTime(display, m_eglSurface, m_clock.nsecsElapsed());
+    }
+    bool swapped = eglSwapBuffers(display, m_eglSurface);
+
+    if (scissor)
+    {
+        glEnable(GL_SCISSOR_TEST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    eglMakeCurrent(display, draw, read, context);
+    return swapped;
+#else
+    return false;
+#endif
+}
+
+void HudBurnInRecorder::releaseSurface()
+{
+#ifdef Q_OS_ANDROID
+    if (m_eglSurface != NULL)
+    {
+        eglDestroySurface(eglGetDisplay(EGL_DEFAULT_DISPLAY), m_eglSurface);
+        m_eglSurface = NULL;
+    }
+    if (m_nativeWindow != NULL)
+    {
+        ANativeWindow_release(static_cast<ANativeWindow*>(m_nativeWindow));
+        m_nativeWindow = NULL;
+    }
+#endif
+}
+
+void HudBurnInRecorder::finishStop()
+{
+#ifdef Q_OS_ANDROID
+    // Drains the encoder and finalizes the file, the surface is gone by now
+    QAndroidJniObject::callStaticMethod<void>(HudEncoderClass, "stop", "()V");
+    QAndroidJniEnvironment env;
+    clearException(env);
+#endif
+    QLOG_INFO() << "HUD recording finalized" << m_fileName;
+    emit recordingChanged();
+    emit recordingFinished(m_fileName);
+}
+
+void HudBurnInRecorder::onEncodeFailed(QString error)
+{
+    emit messageBox(error);
+    finishStop();
+}
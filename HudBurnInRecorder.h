@@ -0,0 +1,110 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudBurnInRecorder
+ *          Records what the HUD window shows, video and overlay together,
+ *          through the hardware encoder without the frames passing the CPU.
+ *
+ */
+
+#ifndef HUDBURNINRECORDER_H
+#define HUDBURNINRECORDER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSize>
+#include <QString>
+
+class QQuickWindow;
+
+/**
+ * @brief Burn-in recording of the composited HUD
+ *
+ * The scene graph already composites the video and the overlay on the GPU
+ * for the window. After each frame is rendered, and before it is swapped,
+ * the render thread binds an EGL surface of the encoder's input (Android
+ * MediaCodec, see HudEncoder.java) as draw surface, keeps the window as
+ * read surface and blits the frame across, scaled to the recording size.
+ * The encoder takes the frame straight from GPU memory.
+ *
+ * Frames are taken at most FrameRate times a second and stamped with the
+ * time they were rendered, so a HUD that renders faster or slower than
+ * that still plays back at the right pace. This needs OpenGL ES 3 for the
+ * blit and Android 4.3 for input surfaces; start() fails without them, and
+ * on other platforms.
+ */
+class HudBurnInRecorder : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+    Q_PROPERTY(QString fileName READ getFileName NOTIFY recordingChanged)
+
+public:
+    enum {
+        FrameRate = 30,
+        BitRate = 8000000,
+        MaxWidth = 1920,        ///< Larger windows are scaled down
+        SizeAlignment = 16      ///< Macroblocks, some encoders reject other sizes
+    };
+
+    explicit HudBurnInRecorder(QQuickWindow *window, QObject *parent = 0);
+    ~HudBurnInRecorder();
+
+    bool isRecording() const { return m_state.load() != Idle; }
+    QString getFileName() const { return m_fileName; }
+
+public slots:
+    bool start();
+    void stop();
+
+signals:
+    void recordingChanged();
+    void recordingFinished(QString fileName);
+    void messageBox(QString text);
+
+private slots:
+    void onAfterRendering();
+    void finishStop();
+    void onEncodeFailed(QString error);
+
+private:
+    enum State { Idle, Starting, Recording, Stopping };
+
+    bool encodeFrame();
+    void releaseSurface();
+
+    QQuickWindow *m_window;
+    QString m_fileName;
+    QSize m_size;
+    QAtomicInt m_state;
+
+    // Render thread
+    void *m_nativeWindow;       ///< ANativeWindow of the encoder input, handed over by start()
+    void *m_eglSurface;
+    QElapsedTimer m_clock;
+    qint64 m_nextFrameNs;
+};
+
+#endif // HUDBURNINRECORDER_H
@@ -0,0 +1,164 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudImageProvider
+ *          See HudImageProvider.h
+ *
+ */
+
+#include "HudImageProvider.h"
+#include "QsLog.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QSvgRenderer>
+
+HudImageProvider::HudImageProvider() :
+    QQuickImageProvider(QQuickImageProvider::Image),
+    m_root(QLatin1String("assets:/qml/resources/components/"))
+{
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/hud-images");
+    if (!QDir().mkpath(m_cacheDir))
+    {
+        QLOG_WARN() << "No HUD image cache at" << m_cacheDir;
+        m_cacheDir.clear();
+    }
+}
+
+QImage HudImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    QString key = id + QLatin1Char('@') + QString::number(requestedSize.width())
+            + QLatin1Char('x') + QString::number(requestedSize.height());
+    QImage image;
+    {
+        QMutexLocker locker(&m_mutex);
+        image = m_images.value(key);
+    }
+    if (image.isNull())
+    {
+        // Two loaders may race on the same key, both produce the same image
+        image = load(id, requestedSize);
+        QMutexLocker locker(&m_mutex);
+        m_images.insert(key, image);
+    }
+    if (size)
+    {
+        *size = image.size();
+    }
+    return image;
+}
+
+qint64 HudImageProvider::cacheBytes()
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes = 0;
+    foreach (const QImage &image, m_images)
+    {
+        bytes += image.byteCount();
+    }
+    return bytes;
+}
+
+void HudImageProvider::clearCache()
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.clear();
+}
+
+QString HudImageProvider::cachePath(const QString &path, const QSize &size) const
+{
+    if (m_cacheDir.isEmpty())
+    {
+        return QString();
+    }
+    // The source's size and date in the name, a new APK invalidates the entry
+    QFileInfo info(m_root + path);
+    QString name = path;
+    name.replace(QLatin1Char('/'), QLatin1Char('_'));
+    return QString(QLatin1String("%1/%2-%3x%4-%5-%6.png")).arg(m_cacheDir, name)
+            .arg(size.width()).arg(size.height())
+            .arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+QImage HudImageProvider::load(const QString &path, const QSize &requestedSize) const
+{
+    QString file = m_root + path;
+    if (!path.endsWith(QLatin1String(".svg"), Qt::CaseInsensitive))
+    {
+        QImage image(file);
+        if (image.isNull())
+        {
+            QLOG_WARN() << "Could not load HUD image" << file;
+            return image;
+        }
+        if (requestedSize.isValid() && image.size() != requestedSize)
+        {
+            image = image.scaled(requestedSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    QSvgRenderer renderer(file);
+    if (!renderer.isValid())
+    {
+        QLOG_WARN() << "Could not load HUD image" << file;
+        return QImage();
+    }
+    QSize size = renderer.defaultSize();
+    if (requestedSize.width() > 0 && requestedSize.height() > 0)
+    {
+        size = requestedSize;
+    }
+    else if (requestedSize.width() > 0)
+    {
+        size = QSize(requestedSize.width(), size.height() * requestedSize.width() / qMax(1, size.width()));
+    }
+    else if (requestedSize.height() > 0)
+    {
+        size = QSize(size.width() * requestedSize.height() / qMax(1, size.height()), requestedSize.height());
+    }
+
+    QString cached = cachePath(path, size);
+    if (!cached.isEmpty())
+    {
+        QImage image(cached);
+        if (!image.isNull())
+        {
+            return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }
+    }
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    renderer.render(&painter);
+    painter.end();
+    if (!cached.isEmpty() && !image.save(cached, "PNG"))
+    {
+        QLOG_WARN() << "Could not cache HUD image" << cached;
+    }
+    return image;
+}
@@ -0,0 +1,71 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Shared image provider of the PFD resources
+ *
+ */
+
+#ifndef HUDIMAGEPROVIDER_H
+#define HUDIMAGEPROVIDER_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QtQuick/QQuickImageProvider>
+
+/**
+ * @brief Serves image://hud/<path> from assets:/qml/resources/components/<path>
+ *
+ * Every instrument image goes through here so that each is rasterized once
+ * per size: SVGs are rendered at the requested sourceSize and kept both in
+ * memory and as a PNG in the cache directory, so later launches skip the
+ * SVG parse entirely. The images come back premultiplied and small, which
+ * lets the scene graph pack them all into its shared texture atlas (sized
+ * in main) and draw the instruments without a texture bind per image.
+ *
+ * requestImage() runs on the QML image loader threads.
+ */
+class HudImageProvider : public QQuickImageProvider
+{
+public:
+    HudImageProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+
+    /** @brief Bytes of the images kept in memory. Shared with QML's pixmap cache while an item shows them */
+    qint64 cacheBytes();
+    /** @brief Forget the images in memory, later requests load the PNGs of the disk cache */
+    void clearCache();
+
+private:
+    QImage load(const QString &path, const QSize &requestedSize) const;
+    QString cachePath(const QString &path, const QSize &size) const;
+
+    QString m_root;
+    QString m_cacheDir;
+    QMutex m_mutex;
+    QHash<QString, QImage> m_images;    ///< By id and requested size
+};
+
+#endif // HUDIMAGEPROVIDER_H
@@ -0,0 +1,451 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudInstruments
+ *          See HudInstruments.h
+ *
+ */
+
+#include "HudInstruments.h"
+#include "TraceMarkers.h"
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGVertexColorMaterial>
+#include <qmath.h>
+#include <string.h>
+
+// Segments of a full circle of the dial
+static const int DialSegments = 72;
+
+HudGeometryItem::HudGeometryItem(QQuickItem *parent) :
+    QQuickItem(parent),
+    m_color(Qt::white),
+    m_backgroundColor(Qt::transparent),
+    m_lineWidth(1),
+    m_dirty(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void HudGeometryItem::setColor(const QColor &color)
+{
+    if (color == m_color)
+    {
+        return;
+    }
+    m_color = color;
+    markDirty();
+    emit colorChanged();
+}
+
+void HudGeometryItem::setBackgroundColor(const QColor &color)
+{
+    if (color == m_backgroundColor)
+    {
+        return;
+    }
+    m_backgroundColor = color;
+    markDirty();
+    emit backgroundColorChanged();
+}
+
+void HudGeometryItem::setLineWidth(qreal width)
+{
+    if (qFuzzyCompare(width, m_lineWidth))
+    {
+        return;
+    }
+    m_lineWidth = width;
+    markDirty();
+    emit lineWidthChanged();
+}
+
+void HudGeometryItem::markDirty()
+{
+    m_dirty = true;
+    update();
+}
+
+void HudGeometryItem::addRect(QVector<QSGGeometry::ColoredPoint2D> &vertices,
+                              float x0, float y0, float x1, float y1, const QColor &color)
+{
+    if (color.alpha() == 0)
+    {
+        return;
+    }
+    // QSGVertexColorMaterial wants premultiplied colors
+    float alpha = color.alphaF();
+    uchar r = static_cast<uchar>(color.red() * alpha);
+    uchar g = static_cast<uchar>(color.green() * alpha);
+    uchar b = static_cast<uchar>(color.blue() * alpha);
+    uchar a = static_cast<uchar>(color.alpha());
+    QSGGeometry::ColoredPoint2D corner[4];
+    corner[0].set(x0, y0, r, g, b, a);
+    corner[1].set(x1, y0, r, g, b, a);
+    corner[2].set(x0, y1, r, g, b, a);
+    corner[3].set(x1, y1, r, g, b, a);
+    vertices << corner[0] << corner[1] << corner[2] << corner[2] << corner[1] << corner[3];
+}
+
+void HudGeometryItem::addLine(QVector<QSGGeometry::ColoredPoint2D> &vertices,
+                              float x0, float y0, float x1, float y1, float width, const QColor &color)
+{
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float length = qSqrt(dx * dx + dy * dy);
+    if (length <= 0 || color.alpha() == 0)
+    {
+        return;
+    }
+    // Half the width along the normal
+    float nx = -dy / length * width / 2;
+    float ny = dx / length * width / 2;
+    float alpha = color.alphaF();
+    uchar r = static_cast<uchar>(color.red() * alpha);
+    uchar g = static_cast<uchar>(color.green() * alpha);
+    uchar b = static_cast<uchar>(color.blue() * alpha);
+    uchar a = static_cast<uchar>(color.alpha());
+    QSGGeometry::ColoredPoint2D corner[4];
+    corner[0].set(x0 + nx, y0 + ny, r, g, b, a);
+    corner[1].set(x1 + nx, y1 + ny, r, g, b, a);
+    corner[2].set(x0 - nx, y0 - ny, r, g, b, a);
+    corner[3].set(x1 - nx, y1 - ny, r, g, b, a);
+    vertices << corner[0] << corner[1] << corner[2] << corner[2] << corner[1] << corner[3];
+}
+
+QSGNode *HudGeometryItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    HUD_TRACE_SCOPE("HudGeometryItem::updatePaintNode");
+    Q_UNUSED(data);
+    QSGGeometryNode *node = static_cast<QSGGeometryNode *>(oldNode);
+    if (!node)
+    {
+        node = new QSGGeometryNode;
+        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(GL_TRIANGLES);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+        m_dirty = true;
+    }
+    if (!m_dirty)
+    {
+        return node;
+    }
+    m_dirty = false;
+
+    QVector<QSGGeometry::ColoredPoint2D> vertices;
+    buildGeometry(vertices);
+    QSGGeometry *geometry = node->geometry();
+    geometry->allocate(vertices.size());
+    if (!vertices.isEmpty())
+    {
+        memcpy(geometry->vertexDataAsColoredPoint2D(), vertices.constData(),
+               vertices.size() * sizeof(QSGGeometry::ColoredPoint2D));
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
+
+void HudGeometryItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        markDirty();
+    }
+}
+
+HudTapeItem::HudTapeItem(QQuickItem *parent) :
+    HudGeometryItem(parent),
+    m_value(0),
+    m_step(10),
+    m_spacing(9),
+    m_borderColor(Qt::black),
+    m_firstLabel(0),
+    m_labelOffset(0),
+    m_labelCount(0)
+{
+}
+
+void HudTapeItem::setValue(qreal value)
+{
+    if (qFuzzyCompare(value, m_value))
+    {
+        return;
+    }
+    m_value = value;
+    updateLabels();
+    emit valueChanged();
+}
+
+void HudTapeItem::setStep(qreal step)
+{
+    if (qFuzzyCompare(step, m_step))
+    {
+        return;
+    }
+    m_step = step;
+    updateLabels();
+    emit stepChanged();
+}
+
+void HudTapeItem::setSpacing(qreal spacing)
+{
+    if (qFuzzyCompare(spacing, m_spacing))
+    {
+        return;
+    }
+    m_spacing = spacing;
+    updateLabels();
+    emit spacingChanged();
+}
+
+void HudTapeItem::setBorderColor(const QColor &color)
+{
+    if (color == m_borderColor)
+    {
+        return;
+    }
+    m_borderColor = color;
+    markDirty();
+    emit borderColorChanged();
+}
+
+void HudTapeItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    HudGeometryItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.height() != oldGeometry.height())
+    {
+        updateLabels();
+    }
+}
+
+void HudTapeItem::updateLabels()
+{
+    int count = 0;
+    qreal first = 0;
+    qreal offset = 0;
+    if (m_step > 0 && m_spacing > 0)
+    {
+        qreal pixelsPerUnit = m_spacing / m_step;
+        qreal half = height() / 2;
+        // The value at the top edge, rounded down to a graticule
+        first = qFloor((m_value + half / pixelsPerUnit) / m_step) * m_step;
+        offset = half - (first - m_value) * pixelsPerUnit;
+        count = qFloor(height() / m_spacing) + 2;
+    }
+    if (count != m_labelCount)
+    {
+        m_labelCount = count;
+        emit labelCountChanged();
+    }
+    markDirty();
+    if (first != m_firstLabel || offset != m_labelOffset)
+    {
+        m_firstLabel = first;
+        m_labelOffset = offset;
+        emit labelsChanged();
+    }
+}
+
+void HudTapeItem::buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const
+{
+    float w = width();
+    float h = height();
+    float half = getLineWidth() / 2;
+    vertices.reserve(6 * (m_labelCount + 5));
+
+    addRect(vertices, 0, 0, w, h, getBackgroundColor());
+    for (int i = 0; i < m_labelCount; ++i)
+    {
+        float y = m_labelOffset + i * m_spacing;
+        if (y - half > h)
+        {
+            break;
+        }
+        addRect(vertices, 0, y - half, w, y + half, getColor());
+    }
+    // Border on top, one pixel like a Rectangle's
+    addRect(vertices, 0, 0, w, 1, m_borderColor);
+    addRect(vertices, 0, h - 1, w, h, m_borderColor);
+    addRect(vertices, 0, 1, 1, h - 1, m_borderColor);
+    addRect(vertices, w - 1, 1, w, h - 1, m_borderColor);
+}
+
+HudLadderItem::HudLadderItem(QQuickItem *parent) :
+    HudGeometryItem(parent),
+    m_steps(6),
+    m_spacing(10),
+    m_rungWidth(40)
+{
+}
+
+void HudLadderItem::setSteps(int steps)
+{
+    if (steps == m_steps)
+    {
+        return;
+    }
+    m_steps = steps;
+    markDirty();
+    emit stepsChanged();
+}
+
+void HudLadderItem::setSpacing(qreal spacing)
+{
+    if (qFuzzyCompare(spacing, m_spacing))
+    {
+        return;
+    }
+    m_spacing = spacing;
+    markDirty();
+    emit spacingChanged();
+}
+
+void HudLadderItem::setRungWidth(qreal width)
+{
+    if (qFuzzyCompare(width, m_rungWidth))
+    {
+        return;
+    }
+    m_rungWidth = width;
+    markDirty();
+    emit rungWidthChanged();
+}
+
+void HudLadderItem::buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const
+{
+    float cx = width() / 2;
+    float cy = height() / 2;
+    float half = getLineWidth() / 2;
+    float x0 = cx - m_rungWidth / 2;
+    float x1 = cx + m_rungWidth / 2;
+    vertices.reserve(6 * (2 * m_steps + 2));
+
+    addRect(vertices, 0, 0, width(), height(), getBackgroundColor());
+    for (int i = -m_steps; i <= m_steps; ++i)
+    {
+        float y = cy + i * m_spacing;
+        addRect(vertices, x0, y - half, x1, y + half, getColor());
+    }
+}
+
+HudDialItem::HudDialItem(QQuickItem *parent) :
+    HudGeometryItem(parent),
+    m_majorStep(45),
+    m_minorStep(15),
+    m_tickLength(4)
+{
+}
+
+void HudDialItem::setMajorStep(qreal step)
+{
+    if (qFuzzyCompare(step, m_majorStep))
+    {
+        return;
+    }
+    m_majorStep = step;
+    markDirty();
+    emit majorStepChanged();
+}
+
+void HudDialItem::setMinorStep(qreal step)
+{
+    if (qFuzzyCompare(step, m_minorStep))
+    {
+        return;
+    }
+    m_minorStep = step;
+    markDirty();
+    emit minorStepChanged();
+}
+
+void HudDialItem::setTickLength(qreal length)
+{
+    if (qFuzzyCompare(length, m_tickLength))
+    {
+        return;
+    }
+    m_tickLength = length;
+    markDirty();
+    emit tickLengthChanged();
+}
+
+void HudDialItem::buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const
+{
+    float cx = width() / 2;
+    float cy = height() / 2;
+    float radius = qMin(width(), height()) / 2 - getLineWidth() / 2;
+    if (radius <= 0)
+    {
+        return;
+    }
+    int ticks = m_minorStep > 0 ? qCeil(360 / m_minorStep) : 0;
+    vertices.reserve(3 * DialSegments + 6 * (DialSegments + ticks));
+
+    QColor background = getBackgroundColor();
+    if (background.alpha() > 0)
+    {
+        // A fan of triangles around the center
+        float alpha = background.alphaF();
+        QSGGeometry::ColoredPoint2D center;
+        center.set(cx, cy, static_cast<uchar>(background.red() * alpha),
+                   static_cast<uchar>(background.green() * alpha),
+                   static_cast<uchar>(background.blue() * alpha),
+                   static_cast<uchar>(background.alpha()));
+        QSGGeometry::ColoredPoint2D previous = center;
+        previous.x = cx;
+        previous.y = cy - radius;
+        for (int i = 1; i <= DialSegments; ++i)
+        {
+            float angle = 2 * M_PI * i / DialSegments;
+            QSGGeometry::ColoredPoint2D next = center;
+            next.x = cx + qSin(angle) * radius;
+            next.y = cy - qCos(angle) * radius;
+            vertices << center << previous << next;
+            previous = next;
+        }
+    }
+
+    for (int i = 0; i < DialSegments; ++i)
+    {
+        float a0 = 2 * M_PI * i / DialSegments;
+        float a1 = 2 * M_PI * (i + 1) / DialSegments;
+        addLine(vertices, cx + qSin(a0) * radius, cy - qCos(a0) * radius,
+                cx + qSin(a1) * radius, cy - qCos(a1) * radius, getLineWidth(), getColor());
+    }
+
+    for (int i = 0; i < ticks; ++i)
+    {
+        qreal degrees = i * m_minorStep;
+        bool major = m_majorStep > 0 && qAbs(degrees - qRound(degrees / m_majorStep) * m_majorStep) < 0.001;
+        float length = major ? 2 * m_tickLength : m_tickLength;
+        float angle = qDegreesToRadians(degrees);
+        float s = qSin(angle);
+        float c = qCos(angle);
+        addLine(vertices, cx + s * radius, cy - c * radius,
+                cx + s * (radius - length), cy - c * (radius - length), getLineWidth(), getColor());
+    }
+}
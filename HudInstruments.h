@@ -0,0 +1,223 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HUD instruments drawn as scene graph geometry
+ *
+ *   Counterpart of HudVideoItem for the instruments around the horizon:
+ *   tape, ladder and dial graticules are emitted as one vertex colored
+ *   triangle list per item instead of a Repeater of Rectangle and Image
+ *   items each with its own bindings.
+ */
+
+#ifndef HUDINSTRUMENTS_H
+#define HUDINSTRUMENTS_H
+
+#include <QColor>
+#include <QVector>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QSGGeometry>
+
+/**
+ * @brief Base of the instruments: one geometry node, rebuilt only when marked dirty
+ *
+ * Subclasses fill the vertex list in buildGeometry() and call markDirty()
+ * from their setters. Motion that does not change the shape, like the
+ * compass rotation or the ladder pitch, belongs in a QML transform on the
+ * item, which the scene graph applies without touching the vertices.
+ */
+class HudGeometryItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QColor color READ getColor WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor backgroundColor READ getBackgroundColor WRITE setBackgroundColor NOTIFY backgroundColorChanged)
+    Q_PROPERTY(qreal lineWidth READ getLineWidth WRITE setLineWidth NOTIFY lineWidthChanged)
+public:
+    explicit HudGeometryItem(QQuickItem *parent = 0);
+
+    QColor getColor() const { return m_color; }
+    void setColor(const QColor &color);
+    QColor getBackgroundColor() const { return m_backgroundColor; }
+    void setBackgroundColor(const QColor &color);
+    qreal getLineWidth() const { return m_lineWidth; }
+    void setLineWidth(qreal width);
+
+signals:
+    void colorChanged();
+    void backgroundColorChanged();
+    void lineWidthChanged();
+
+protected:
+    /** @brief Rebuild the vertices on the next sync */
+    void markDirty();
+    virtual void buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const = 0;
+
+    /** @brief Two triangles covering the rectangle */
+    static void addRect(QVector<QSGGeometry::ColoredPoint2D> &vertices,
+                        float x0, float y0, float x1, float y1, const QColor &color);
+    /** @brief Two triangles along the line from (x0, y0) to (x1, y1) */
+    static void addLine(QVector<QSGGeometry::ColoredPoint2D> &vertices,
+                        float x0, float y0, float x1, float y1, float width, const QColor &color);
+
+    virtual QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+    virtual void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private:
+    QColor m_color;
+    QColor m_backgroundColor;
+    qreal m_lineWidth;
+    bool m_dirty;
+};
+
+/**
+ * @brief Vertical speed or altitude tape
+ *
+ * A graticule every step units, spacing pixels apart, scrolled so value
+ * sits at the vertical center; higher values are above. Only the
+ * graticules in view are emitted. The labels stay QML Text, a fixed
+ * Repeater of labelCount delegates placed from firstLabel and labelOffset,
+ * so scrolling moves the same few items instead of re-creating them.
+ */
+class HudTapeItem : public HudGeometryItem
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal value READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(qreal step READ getStep WRITE setStep NOTIFY stepChanged)
+    Q_PROPERTY(qreal spacing READ getSpacing WRITE setSpacing NOTIFY spacingChanged)
+    Q_PROPERTY(QColor borderColor READ getBorderColor WRITE setBorderColor NOTIFY borderColorChanged)
+    Q_PROPERTY(qreal firstLabel READ getFirstLabel NOTIFY labelsChanged)
+    Q_PROPERTY(qreal labelOffset READ getLabelOffset NOTIFY labelsChanged)
+    Q_PROPERTY(int labelCount READ getLabelCount NOTIFY labelCountChanged)
+public:
+    explicit HudTapeItem(QQuickItem *parent = 0);
+
+    qreal getValue() const { return m_value; }
+    void setValue(qreal value);
+    qreal getStep() const { return m_step; }
+    void setStep(qreal step);
+    qreal getSpacing() const { return m_spacing; }
+    void setSpacing(qreal spacing);
+    QColor getBorderColor() const { return m_borderColor; }
+    void setBorderColor(const QColor &color);
+
+    /** @brief Value of the topmost graticule in view */
+    qreal getFirstLabel() const { return m_firstLabel; }
+    /** @brief y of the topmost graticule in view, the others follow spacing apart */
+    qreal getLabelOffset() const { return m_labelOffset; }
+    /** @brief Graticules that fit in the height, plus the partly visible one */
+    int getLabelCount() const { return m_labelCount; }
+
+signals:
+    void valueChanged();
+    void stepChanged();
+    void spacingChanged();
+    void borderColorChanged();
+    void labelsChanged();
+    void labelCountChanged();
+
+protected:
+    void buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private:
+    void updateLabels();
+
+    qreal m_value;
+    qreal m_step;
+    qreal m_spacing;
+    QColor m_borderColor;
+    qreal m_firstLabel;
+    qreal m_labelOffset;
+    int m_labelCount;
+};
+
+/**
+ * @brief Pitch ladder rungs, a rung every spacing pixels, steps above and below the center one
+ */
+class HudLadderItem : public HudGeometryItem
+{
+    Q_OBJECT
+    Q_PROPERTY(int steps READ getSteps WRITE setSteps NOTIFY stepsChanged)
+    Q_PROPERTY(qreal spacing READ getSpacing WRITE setSpacing NOTIFY spacingChanged)
+    Q_PROPERTY(qreal rungWidth READ getRungWidth WRITE setRungWidth NOTIFY rungWidthChanged)
+public:
+    explicit HudLadderItem(QQuickItem *parent = 0);
+
+    int getSteps() const { return m_steps; }
+    void setSteps(int steps);
+    qreal getSpacing() const { return m_spacing; }
+    void setSpacing(qreal spacing);
+    qreal getRungWidth() const { return m_rungWidth; }
+    void setRungWidth(qreal width);
+
+signals:
+    void stepsChanged();
+    void spacingChanged();
+    void rungWidthChanged();
+
+protected:
+    void buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const;
+
+private:
+    int m_steps;
+    qreal m_spacing;
+    qreal m_rungWidth;
+};
+
+/**
+ * @brief Compass rose: a filled disk, its rim and a tick every minorStep degrees
+ *
+ * Every majorStep degrees the tick is twice as long. North is up; rotate
+ * the item by -heading.
+ */
+class HudDialItem : public HudGeometryItem
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal majorStep READ getMajorStep WRITE setMajorStep NOTIFY majorStepChanged)
+    Q_PROPERTY(qreal minorStep READ getMinorStep WRITE setMinorStep NOTIFY minorStepChanged)
+    Q_PROPERTY(qreal tickLength READ getTickLength WRITE setTickLength NOTIFY tickLengthChanged)
+public:
+    explicit HudDialItem(QQuickItem *parent = 0);
+
+    qreal getMajorStep() const { return m_majorStep; }
+    void setMajorStep(qreal step);
+    qreal getMinorStep() const { return m_minorStep; }
+    void setMinorStep(qreal step);
+    qreal getTickLength() const { return m_tickLength; }
+    void setTickLength(qreal length);
+
+signals:
+    void majorStepChanged();
+    void minorStepChanged();
+    void tickLengthChanged();
+
+protected:
+    void buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const;
+
+private:
+    qreal m_majorStep;
+    qreal m_minorStep;
+    qreal m_tickLength;
+};
+
+#endif // HUDINSTRUMENTS_H
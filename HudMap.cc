@@ -0,0 +1,510 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudMap
+ *          See HudMap.h
+ *
+ */
+
+#include "HudMap.h"
+#include "TraceMarkers.h"
+#include "QsLog.h"
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QPointer>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/QSGFlatColorMaterial>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGSimpleTextureNode>
+#include <QtQuick/QSGTexture>
+#include <qmath.h>
+
+// Ground resolution of zoom 0 at the equator, m per pixel
+static const double equatorMetresPerPixel = 156543.03392;
+// Web mercator ends here, the map is square
+static const double maxLatitude = 85.05112878;
+
+namespace {
+
+/** @brief Reads and decodes one tile on a pool thread */
+class TileDecoder : public QRunnable
+{
+public:
+    TileDecoder(MapTileLoader *owner, quint64 key, const QString &basePath, int generation)
+        : m_owner(owner), m_key(key), m_basePath(basePath), m_generation(generation)
+    {
+    }
+
+    void run()
+    {
+        static const char *const suffixes[] = { ".png", ".jpg", ".jpeg" };
+        QImage image;
+        for (unsigned i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]) && image.isNull(); ++i)
+        {
+            const QString path = m_basePath + QLatin1String(suffixes[i]);
+            if (QFile::exists(path))
+            {
+                QImageReader reader(path);
+                image = reader.read();
+            }
+        }
+        // The format the scene graph uploads without converting
+        if (!image.isNull())
+        {
+            image = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                                  : QImage::Format_RGB32);
+        }
+        if (m_owner)
+        {
+            QMetaObject::invokeMethod(m_owner, "onDecoded", Qt::QueuedConnection,
+                                      Q_ARG(quint64, m_key), Q_ARG(QImage, image), Q_ARG(int, m_generation));
+        }
+    }
+
+private:
+    QPointer<MapTileLoader> m_owner;
+    quint64 m_key;
+    QString m_basePath;
+    int m_generation;
+};
+
+}
+
+MapTileLoader::MapTileLoader(QObject *parent) :
+    QObject(parent),
+    m_generation(0)
+{
+    m_pool.setMaxThreadCount(Threads);
+}
+
+MapTileLoader::~MapTileLoader()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void MapTileLoader::setDirectory(const QString &directory)
+{
+    if (directory == m_directory)
+    {
+        return;
+    }
+    m_directory = directory;
+    m_pool.clear();
+    m_pending.clear();
+    m_missing.clear();
+    ++m_generation;
+}
+
+void MapTileLoader::request(quint64 key)
+{
+    if (m_directory.isEmpty() || m_pending.contains(key) || m_missing.contains(key))
+    {
+        return;
+    }
+    m_pending.insert(key);
+    const QString basePath = QString("%1/%2/%3/%4").arg(m_directory).arg(zoomOf(key)).arg(xOf(key)).arg(yOf(key));
+    m_pool.start(new TileDecoder(this, key, basePath, m_generation));
+}
+
+void MapTileLoader::onDecoded(quint64 key, const QImage &image, int generation)
+{
+    if (generation != m_generation)
+    {
+        return;
+    }
+    m_pending.remove(key);
+    if (image.isNull())
+    {
+        m_missing.insert(key);
+        return;
+    }
+    emit tileLoaded(key, image);
+}
+
+
+/** @brief Root of the map: the tile textures, the nodes showing them and the track */
+class HudMapItem::MapNode : public QSGNode
+{
+public:
+    MapNode() : track(NULL), tiles(new QSGNode)
+    {
+        appendChildNode(tiles);
+    }
+    ~MapNode()
+    {
+        qDeleteAll(textures);
+    }
+
+    QSGTexture *texture(quint64 key)
+    {
+        QHash<quint64, QSGTexture*>::const_iterator it = textures.constFind(key);
+        if (it == textures.constEnd())
+        {
+            return NULL;
+        }
+        used.removeOne(key);
+        used.prepend(key);
+        return it.value();
+    }
+    void insert(quint64 key, QSGTexture *texture)
+    {
+        delete textures.take(key);
+        used.removeOne(key);
+        textures.insert(key, texture);
+        used.prepend(key);
+    }
+    /** @brief Drops the least recently used textures beyond MaxTextures, none of those shown */
+    void evict(QSet<quint64> *resident)
+    {
+        while (used.size() > MaxTextures)
+        {
+            const quint64 key = used.takeLast();
+            delete textures.take(key);
+            resident->remove(key);
+        }
+    }
+    void clear()
+    {
+        qDeleteAll(textures);
+        textures.clear();
+        used.clear();
+    }
+
+    QHash<quint64, QSGTexture*> textures;
+    QList<quint64> used;            ///< Most recently used first
+    QSGGeometryNode *track;
+    QSGNode *tiles;
+};
+
+HudMapItem::HudMapItem(QQuickItem *parent) :
+    QQuickItem(parent),
+    m_latitude(0),
+    m_longitude(0),
+    m_zoom(16),
+    m_track(NULL),
+    m_trackSysid(-1),
+    m_trackColor(Qt::magenta),
+    m_trackWidth(2),
+    m_flush(false)
+{
+    setFlag(ItemHasContents, true);
+    m_loader.setDirectory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tiles");
+    connect(&m_loader, SIGNAL(tileLoaded(quint64,QImage)), this, SLOT(onTileLoaded(quint64,QImage)));
+}
+
+void HudMapItem::setLatitude(double latitude)
+{
+    latitude = qBound(-maxLatitude, latitude, maxLatitude);
+    if (qFuzzyCompare(latitude, m_latitude))
+    {
+        return;
+    }
+    m_latitude = latitude;
+    requestTiles();
+    update();
+    emit positionChanged();
+}
+
+void HudMapItem::setLongitude(double longitude)
+{
+    if (qFuzzyCompare(longitude, m_longitude))
+    {
+        return;
+    }
+    m_longitude = longitude;
+    requestTiles();
+    update();
+    emit positionChanged();
+}
+
+void HudMapItem::setZoom(int zoom)
+{
+    zoom = qBound(int(MinZoom), zoom, int(MaxZoom));
+    if (zoom == m_zoom)
+    {
+        return;
+    }
+    m_zoom = zoom;
+    requestTiles();
+    update();
+    emit zoomChanged();
+}
+
+void HudMapItem::setTileDirectory(const QString &directory)
+{
+    if (directory == m_loader.directory())
+    {
+        return;
+    }
+    m_loader.setDirectory(directory);
+    m_decoded.clear();
+    m_flush = true;
+    requestTiles();
+    update();
+    emit tileDirectoryChanged();
+}
+
+void HudMapItem::setTrack(QObject *track)
+{
+    TrackHistory *history = qobject_cast<TrackHistory*>(track);
+    if (history == m_track)
+    {
+        return;
+    }
+    m_track = history;
+    update();
+    emit trackChanged();
+}
+
+void HudMapItem::setTrackSysid(int sysid)
+{
+    if (sysid == m_trackSysid)
+    {
+        return;
+    }
+    m_trackSysid = sysid;
+    update();
+    emit trackChanged();
+}
+
+void HudMapItem::setTrackColor(const QColor &color)
+{
+    if (color == m_trackColor)
+    {
+        return;
+    }
+    m_trackColor = color;
+    update();
+    emit trackChanged();
+}
+
+void HudMapItem::setTrackWidth(qreal width)
+{
+    if (qFuzzyCompare(width, m_trackWidth))
+    {
+        return;
+    }
+    m_trackWidth = width;
+    update();
+    emit trackChanged();
+}
+
+double HudMapItem::metresPerPixel() const
+{
+    return equatorMetresPerPixel * qCos(qDegreesToRadians(m_latitude)) / (1 << m_zoom);
+}
+
+void HudMapItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        requestTiles();
+        update();
+    }
+}
+
+QPointF HudMapItem::project(double latitude, double longitude, int zoom)
+{
+    const double world = double(TileSize) * (1 << zoom);
+    const double phi = qDegreesToRadians(qBound(-maxLatitude, latitude, maxLatitude));
+    const double x = (longitude + 180.0) / 360.0 * world;
+    const double y = (1.0 - qLn(qTan(phi) + 1.0 / qCos(phi)) / M_PI) / 2.0 * world;
+    return QPointF(x, y);
+}
+
+QPointF HudMapItem::centre() const
+{
+    return project(m_latitude, m_longitude, m_zoom);
+}
+
+QVector<quint64> HudMapItem::visibleTiles() const
+{
+    QVector<quint64> keys;
+    if (width() <= 0 || height() <= 0)
+    {
+        return keys;
+    }
+    const int tiles = 1 << m_zoom;
+    const QPointF c = centre();
+    const int x0 = qFloor((c.x() - width() / 2) / TileSize);
+    const int x1 = qFloor((c.x() + width() / 2) / TileSize);
+    const int y0 = qMax(0, qFloor((c.y() - height() / 2) / TileSize));
+    const int y1 = qMin(tiles - 1, qFloor((c.y() + height() / 2) / TileSize));
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            // Longitude wraps around
+            keys.append(MapTileLoader::key(m_zoom, ((x % tiles) + tiles) % tiles, y));
+        }
+    }
+    return keys;
+}
+
+void HudMapItem::requestTiles()
+{
+    foreach (quint64 key, visibleTiles())
+    {
+        if (!m_resident.contains(key) && !m_decoded.contains(key))
+        {
+            m_loader.request(key);
+        }
+    }
+}
+
+void HudMapItem::onTileLoaded(quint64 key, const QImage &image)
+{
+    m_decoded.insert(key, image);
+    update();
+}
+
+QSGNode *HudMapItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    HUD_TRACE_SCOPE("HudMapItem::updatePaintNode");
+    Q_UNUSED(data);
+    MapNode *node = static_cast<MapNode *>(oldNode);
+    if (!node)
+    {
+        node = new MapNode;
+    }
+    if (m_flush)
+    {
+        m_flush = false;
+        node->clear();
+        m_resident.clear();
+    }
+
+    // Upload what the workers decoded, the images are not kept
+    for (QHash<quint64, QImage>::const_iterator it = m_decoded.constBegin(); it != m_decoded.constEnd(); ++it)
+    {
+        QSGTexture *texture = window()->createTextureFromImage(it.value());
+        texture->setFiltering(QSGTexture::Linear);
+        node->insert(it.key(), texture);
+        m_resident.insert(it.key());
+    }
+    m_decoded.clear();
+
+    // The few tile nodes are rebuilt; the textures they show are not
+    while (QSGNode *child = node->tiles->firstChild())
+    {
+        node->tiles->removeChildNode(child);
+        delete child;
+    }
+    const QPointF c = centre();
+    const QPointF origin(c.x() - width() / 2, c.y() - height() / 2);
+    const int tiles = 1 << m_zoom;
+    const int x0 = qFloor(origin.x() / TileSize);
+    foreach (quint64 key, visibleTiles())
+    {
+        QSGTexture *texture = node->texture(key);
+        if (!texture)
+        {
+            continue;
+        }
+        // Column relative to x0, undoing the wrap of the key
+        int column = MapTileLoader::xOf(key) - (((x0 % tiles) + tiles) % tiles);
+        column = ((column % tiles) + tiles) % tiles;
+        QSGSimpleTextureNode *tile = new QSGSimpleTextureNode;
+        tile->setTexture(texture);
+        tile->setFiltering(QSGTexture::Linear);
+        tile->setRect(QRectF((x0 + column) * TileSize - origin.x(),
+                             MapTileLoader::yOf(key) * TileSize - origin.y(), TileSize, TileSize));
+        node->tiles->appendChildNode(tile);
+    }
+    // After the shown tiles were touched, so none of them goes
+    node->evict(&m_resident);
+
+    updateTrack(node, c);
+    return node;
+}
+
+void HudMapItem::updateTrack(MapNode *node, const QPointF &centre)
+{
+    int count = 0;
+    if (m_track && m_trackSysid >= 0)
+    {
+        // The coarsest level that still follows the track to about a pixel
+        const double pixel = metresPerPixel();
+        int level = 0;
+        for (int i = TrackHistory::LevelCount - 1; i > 0; --i)
+        {
+            if (m_track->tolerance(m_trackSysid, i) <= pixel)
+            {
+                level = i;
+                break;
+            }
+        }
+        if (m_track->copy(m_trackSysid, level, m_trackPoints))
+        {
+            count = m_trackPoints.size();
+        }
+    }
+    if (count < 2)
+    {
+        if (node->track)
+        {
+            node->removeChildNode(node->track);
+            delete node->track;
+            node->track = NULL;
+        }
+        return;
+    }
+
+    if (!node->track)
+    {
+        node->track = new QSGGeometryNode;
+        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        geometry->setDrawingMode(GL_LINE_STRIP);
+        node->track->setGeometry(geometry);
+        node->track->setFlag(QSGNode::OwnsGeometry);
+        node->track->setMaterial(new QSGFlatColorMaterial);
+        node->track->setFlag(QSGNode::OwnsMaterial);
+        node->appendChildNode(node->track);
+    }
+    QSGFlatColorMaterial *material = static_cast<QSGFlatColorMaterial *>(node->track->material());
+    if (material->color() != m_trackColor)
+    {
+        material->setColor(m_trackColor);
+        node->track->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    QSGGeometry *geometry = node->track->geometry();
+    geometry->setLineWidth(m_trackWidth);
+    geometry->allocate(count);
+    QSGGeometry::Point2D *vertices = geometry->vertexDataAsPoint2D();
+    const double left = centre.x() - width() / 2;
+    const double top = centre.y() - height() / 2;
+    for (int i = 0; i < count; ++i)
+    {
+        const TrackHistory::Point &point = m_trackPoints.at(i);
+        const QPointF p = project(point.lat * 1E-7, point.lon * 1E-7, m_zoom);
+        vertices[i].set(float(p.x() - left), float(p.y() - top));
+    }
+    node->track->markDirty(QSGNode::DirtyGeometry);
+}
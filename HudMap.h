@@ -0,0 +1,180 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Minimap of offline map tiles with the flown track
+ *
+ *   Tiles come from a directory cache in the usual {zoom}/{x}/{y}.png
+ *   (or .jpg) layout of web mercator tiles. Reading and decoding run on a
+ *   small thread pool, never on the UI or render thread; a decoded image
+ *   is uploaded once and dropped, the texture stays in a least recently
+ *   used set of MaxTextures on the GPU. The track is the TrackHistory
+ *   level whose tolerance fits a pixel at the current zoom, so a long
+ *   flight costs a few hundred vertices whatever its length.
+ */
+
+#ifndef HUDMAP_H
+#define HUDMAP_H
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QtQuick/QQuickItem>
+#include "TrackHistory.h"
+
+/**
+ * @brief Reads and decodes tiles on worker threads
+ *
+ * A tile is requested at most once while it is pending; one that has no
+ * file is remembered and not asked for again until the directory changes.
+ */
+class MapTileLoader : public QObject
+{
+    Q_OBJECT
+public:
+    enum { Threads = 2 };
+
+    explicit MapTileLoader(QObject *parent = 0);
+    ~MapTileLoader();
+
+    QString directory() const { return m_directory; }
+    /** @brief Forgets the missing tiles, results still decoding from the old one are dropped */
+    void setDirectory(const QString &directory);
+
+    void request(quint64 key);
+    bool isPending(quint64 key) const { return m_pending.contains(key); }
+
+    static quint64 key(int zoom, int x, int y) { return (quint64(zoom) << 48) | (quint64(x) << 24) | quint64(y); }
+    static int zoomOf(quint64 key) { return int(key >> 48); }
+    static int xOf(quint64 key) { return int((key >> 24) & 0xffffff); }
+    static int yOf(quint64 key) { return int(key & 0xffffff); }
+
+signals:
+    /** @brief A tile is decoded, ready to upload */
+    void tileLoaded(quint64 key, const QImage &image);
+
+private slots:
+    void onDecoded(quint64 key, const QImage &image, int generation);
+
+private:
+    QThreadPool m_pool;
+    QString m_directory;
+    QSet<quint64> m_pending;
+    QSet<quint64> m_missing;
+    int m_generation;
+};
+
+/**
+ * @brief North up map centred on latitude, longitude at an integer zoom
+ *
+ * Bind the position to activeVehicle.absPosition and track to the
+ * trackHistory context property. The tiles are in tiles/ of the app data
+ * unless tileDirectory says otherwise. Tiles not in the cache are left
+ * transparent, so the item draws over whatever background it is given.
+ */
+class HudMapItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(double latitude READ getLatitude WRITE setLatitude NOTIFY positionChanged)
+    Q_PROPERTY(double longitude READ getLongitude WRITE setLongitude NOTIFY positionChanged)
+    Q_PROPERTY(int zoom READ getZoom WRITE setZoom NOTIFY zoomChanged)
+    Q_PROPERTY(QString tileDirectory READ getTileDirectory WRITE setTileDirectory NOTIFY tileDirectoryChanged)
+    Q_PROPERTY(QObject* track READ getTrack WRITE setTrack NOTIFY trackChanged)
+    Q_PROPERTY(int trackSysid READ getTrackSysid WRITE setTrackSysid NOTIFY trackChanged)
+    Q_PROPERTY(QColor trackColor READ getTrackColor WRITE setTrackColor NOTIFY trackChanged)
+    Q_PROPERTY(qreal trackWidth READ getTrackWidth WRITE setTrackWidth NOTIFY trackChanged)
+public:
+    enum {
+        TileSize = 256,
+        MinZoom = 1,
+        MaxZoom = 19,
+        MaxTextures = 64        ///< More than a screen full of tiles, some zoom levels back
+    };
+
+    explicit HudMapItem(QQuickItem *parent = 0);
+
+    double getLatitude() const { return m_latitude; }
+    void setLatitude(double latitude);
+    double getLongitude() const { return m_longitude; }
+    void setLongitude(double longitude);
+    int getZoom() const { return m_zoom; }
+    void setZoom(int zoom);
+    QString getTileDirectory() const { return m_loader.directory(); }
+    void setTileDirectory(const QString &directory);
+    QObject *getTrack() const { return m_track; }
+    void setTrack(QObject *track);
+    int getTrackSysid() const { return m_trackSysid; }
+    void setTrackSysid(int sysid);
+    QColor getTrackColor() const { return m_trackColor; }
+    void setTrackColor(const QColor &color);
+    qreal getTrackWidth() const { return m_trackWidth; }
+    void setTrackWidth(qreal width);
+
+    /** @brief m covered by one pixel at the centre */
+    Q_INVOKABLE double metresPerPixel() const;
+    /** @brief World pixel of a position at zoom, for items drawn over the map */
+    static QPointF project(double latitude, double longitude, int zoom);
+
+signals:
+    void positionChanged();
+    void zoomChanged();
+    void tileDirectoryChanged();
+    void trackChanged();
+
+protected:
+    virtual QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+    virtual void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private slots:
+    void onTileLoaded(quint64 key, const QImage &image);
+
+private:
+    class MapNode;
+
+    /** @brief The centre in world pixels of the current zoom */
+    QPointF centre() const;
+    /** @brief Keys of the tiles the item covers */
+    QVector<quint64> visibleTiles() const;
+    /** @brief Ask for the visible tiles that are neither uploaded nor waiting to be */
+    void requestTiles();
+    void updateTrack(MapNode *node, const QPointF &centre);
+
+    double m_latitude;
+    double m_longitude;
+    int m_zoom;
+    MapTileLoader m_loader;
+    TrackHistory *m_track;
+    int m_trackSysid;
+    QColor m_trackColor;
+    qreal m_trackWidth;
+    QHash<quint64, QImage> m_decoded;   ///< Waiting for the next sync to become textures
+    QSet<quint64> m_resident;           ///< Textures on the GPU, written during the sync
+    bool m_flush;                       ///< Drop every texture on the next sync
+    QVector<TrackHistory::Point> m_trackPoints;
+};
+
+#endif // HUDMAP_H
@@ -0,0 +1,209 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudPerformanceMonitor
+ *          See HudPerformanceMonitor.h
+ *
+ */
+
+#include "HudPerformanceMonitor.h"
+#include "RelPositionOverview.h"
+#include "AbsPositionOverview.h"
+#include "AttitudeHistory.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkMessageRef.h"
+#include "Arena.h"
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QQuickWindow>
+
+HudPerformanceMonitor::HudPerformanceMonitor(QObject *parent) :
+    QObject(parent),
+    m_enabled(false),
+    m_attitudeAge(-1),
+    m_attitudeAgeMax(-1),
+    m_positionAge(-1),
+    m_positionAgeMax(-1),
+    m_peakReads(0),
+    m_peakMessages(0),
+    m_pendingReads(0),
+    m_pendingMessages(0),
+    m_droppedMessages(0),
+    m_arenaAllocations(0),
+    m_arenaHeapBlocks(0),
+    m_arenaReservedBytes(0),
+    m_messageHeapAllocations(0),
+    m_coveredPercent(0),
+    m_contentItems(0),
+    m_cachedLayers(0),
+    m_lastArenaAllocations(Arena::allocations()),
+    m_lastArenaHeapBlocks(Arena::heapBlocks()),
+    m_lastMessageHeapAllocations(MAVLinkMessageRef::heapAllocations())
+{
+    m_attitudeSum.total = m_attitudeSum.count = m_attitudeSum.max = 0;
+    m_positionSum = m_attitudeSum;
+    connect(&m_publishTimer, SIGNAL(timeout()), this, SLOT(publish()));
+}
+
+void HudPerformanceMonitor::attach(QObject *window)
+{
+    if (m_window)
+    {
+        disconnect(m_window, 0, this, 0);
+    }
+    m_window = window;
+    if (m_window && m_enabled)
+    {
+        // Same point FramePacer flushes at, the values are final for this frame
+        connect(m_window, SIGNAL(afterAnimating()), this, SLOT(sampleFrame()));
+    }
+}
+
+void HudPerformanceMonitor::setSources(RelPositionOverview *relPosition, AbsPositionOverview *absPosition)
+{
+    m_relPosition = relPosition;
+    m_absPosition = absPosition;
+}
+
+void HudPerformanceMonitor::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+    m_enabled = enabled;
+    if (enabled)
+    {
+        m_publishTimer.start(1000);
+    }
+    else
+    {
+        m_publishTimer.stop();
+    }
+    attach(m_window);
+    emit enabledChanged(enabled);
+}
+
+void HudPerformanceMonitor::add(AgeSum &sum, qint64 receivedMs, qint64 now)
+{
+    if (receivedMs < 0)
+    {
+        return;
+    }
+    int age = static_cast<int>(now - receivedMs);
+    sum.total += age;
+    sum.count++;
+    sum.max = qMax(sum.max, age);
+}
+
+void HudPerformanceMonitor::sampleFrame()
+{
+    qint64 now = AttitudeHistory::now();
+    if (m_relPosition)
+    {
+        add(m_attitudeSum, m_relPosition->attitudeReceivedMs(), now);
+    }
+    if (m_absPosition)
+    {
+        add(m_positionSum, m_absPosition->positionReceivedMs(), now);
+    }
+    MAVLinkIngest *ingest = LinkManager::instance()->getMavlinkProtocol()->ingest();
+    if (ingest)
+    {
+        m_peakReads = qMax(m_peakReads, ingest->pendingReads());
+        m_peakMessages = qMax(m_peakMessages, ingest->pendingMessages());
+    }
+}
+
+void HudPerformanceMonitor::publish()
+{
+    m_attitudeAge = m_attitudeSum.count > 0 ? static_cast<int>(m_attitudeSum.total / m_attitudeSum.count) : -1;
+    m_attitudeAgeMax = m_attitudeSum.count > 0 ? m_attitudeSum.max : -1;
+    m_positionAge = m_positionSum.count > 0 ? static_cast<int>(m_positionSum.total / m_positionSum.count) : -1;
+    m_positionAgeMax = m_positionSum.count > 0 ? m_positionSum.max : -1;
+    m_attitudeSum.total = m_attitudeSum.count = m_attitudeSum.max = 0;
+    m_positionSum = m_attitudeSum;
+
+    // Depths are the peak of each second
+    m_pendingReads = m_peakReads;
+    m_pendingMessages = m_peakMessages;
+    m_peakReads = 0;
+    m_peakMessages = 0;
+
+    MAVLinkIngest *ingest = LinkManager::instance()->getMavlinkProtocol()->ingest();
+    m_droppedMessages = ingest ? ingest->droppedMessages() : 0;
+
+    const int allocations = Arena::allocations();
+    const int heapBlocks = Arena::heapBlocks();
+    const int messageHeap = MAVLinkMessageRef::heapAllocations();
+    m_arenaAllocations = allocations - m_lastArenaAllocations;
+    m_arenaHeapBlocks = heapBlocks - m_lastArenaHeapBlocks;
+    m_messageHeapAllocations = messageHeap - m_lastMessageHeapAllocations;
+    m_arenaReservedBytes = Arena::reservedBytes();
+    m_lastArenaAllocations = allocations;
+    m_lastArenaHeapBlocks = heapBlocks;
+    m_lastMessageHeapAllocations = messageHeap;
+
+    QQuickWindow *window = qobject_cast<QQuickWindow*>(m_window);
+    m_contentItems = 0;
+    m_cachedLayers = 0;
+    m_coveredPercent = 0;
+    if (window && window->width() > 0 && window->height() > 0)
+    {
+        QRectF bounds(0, 0, window->width(), window->height());
+        qreal area = 0;
+        addCoverage(window->contentItem(), bounds, &area);
+        m_coveredPercent = qRound(100 * area / (bounds.width() * bounds.height()));
+    }
+    emit statsChanged();
+}
+
+void HudPerformanceMonitor::addCoverage(QQuickItem *item, const QRectF &clip, qreal *area)
+{
+    if (!item || !item->isVisible() || item->opacity() <= 0)
+    {
+        return;
+    }
+    QRectF rect = item->mapRectToScene(item->boundingRect()) & clip;
+    // Declared by StaticLayer.qml; asking others for their layer would create one
+    QVariant cached = item->property("staticLayerCached");
+    if (cached.isValid() && cached.toBool())
+    {
+        m_cachedLayers++;
+        m_contentItems++;
+        *area += rect.width() * rect.height();
+        return;
+    }
+    if (item->flags() & QQuickItem::ItemHasContents)
+    {
+        m_contentItems++;
+        *area += rect.width() * rect.height();
+    }
+    const QRectF childClip = item->clip() ? rect : clip;
+    foreach (QQuickItem *child, item->childItems())
+    {
+        addCoverage(child, childClip, area);
+    }
+}
@@ -0,0 +1,153 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Numbers behind the PFD performance overlay
+ *
+ */
+
+#ifndef HUDPERFORMANCEMONITOR_H
+#define HUDPERFORMANCEMONITOR_H
+
+#include <QObject>
+#include <QRectF>
+#include <QPointer>
+#include <QTimer>
+
+class RelPositionOverview;
+class AbsPositionOverview;
+class QQuickItem;
+
+/**
+ * @brief Telemetry age at draw time and ingest queue depths, published once a second
+ *
+ * Right before each frame is synchronized the age of the newest ATTITUDE
+ * and GLOBAL_POSITION_INT is taken, so the figures say how old the data
+ * on screen was, not how old it was when it arrived. Frame times come
+ * from FramePacer and the video rates from the players' stats.
+ *
+ * Once a second the item tree is walked for the area the items with
+ * content cover, a fill rate estimate: the window is 100%, every overlay
+ * on top of the video adds its share. A StaticLayer counts once for its
+ * rectangle while it is cached, so turning the caching off and on shows
+ * what it saves on the device at hand. Rotated items count for their
+ * bounding box.
+ *
+ * Nothing is sampled while disabled.
+ */
+class HudPerformanceMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int attitudeAgeMs READ getAttitudeAgeMs NOTIFY statsChanged)
+    Q_PROPERTY(int attitudeAgeMaxMs READ getAttitudeAgeMaxMs NOTIFY statsChanged)
+    Q_PROPERTY(int positionAgeMs READ getPositionAgeMs NOTIFY statsChanged)
+    Q_PROPERTY(int positionAgeMaxMs READ getPositionAgeMaxMs NOTIFY statsChanged)
+    Q_PROPERTY(int ingestPendingReads READ getIngestPendingReads NOTIFY statsChanged)
+    Q_PROPERTY(int ingestPendingMessages READ getIngestPendingMessages NOTIFY statsChanged)
+    Q_PROPERTY(int ingestDroppedMessages READ getIngestDroppedMessages NOTIFY statsChanged)
+    Q_PROPERTY(int arenaAllocations READ getArenaAllocations NOTIFY statsChanged)
+    Q_PROPERTY(int arenaHeapBlocks READ getArenaHeapBlocks NOTIFY statsChanged)
+    Q_PROPERTY(int arenaReservedBytes READ getArenaReservedBytes NOTIFY statsChanged)
+    Q_PROPERTY(int messageHeapAllocations READ getMessageHeapAllocations NOTIFY statsChanged)
+    Q_PROPERTY(int coveredPercent READ getCoveredPercent NOTIFY statsChanged)
+    Q_PROPERTY(int contentItems READ getContentItems NOTIFY statsChanged)
+    Q_PROPERTY(int cachedLayers READ getCachedLayers NOTIFY statsChanged)
+public:
+    explicit HudPerformanceMonitor(QObject *parent = 0);
+
+    /** @brief Sample before each frame of window, a QQuickWindow */
+    void attach(QObject *window);
+    /** @brief Overviews of the active vehicle, NULL when there is none */
+    void setSources(RelPositionOverview *relPosition, AbsPositionOverview *absPosition);
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    /** @brief Average over the frames of the last second, -1 without data */
+    int getAttitudeAgeMs() const { return m_attitudeAge; }
+    int getAttitudeAgeMaxMs() const { return m_attitudeAgeMax; }
+    int getPositionAgeMs() const { return m_positionAge; }
+    int getPositionAgeMaxMs() const { return m_positionAgeMax; }
+    int getIngestPendingReads() const { return m_pendingReads; }
+    int getIngestPendingMessages() const { return m_pendingMessages; }
+    int getIngestDroppedMessages() const { return m_droppedMessages; }
+    /** @brief Per second: arena allocations, heap blocks the arenas took, and
+     *  decoded messages that did not fit the MAVLinkMessageRef pool */
+    int getArenaAllocations() const { return m_arenaAllocations; }
+    int getArenaHeapBlocks() const { return m_arenaHeapBlocks; }
+    int getArenaReservedBytes() const { return m_arenaReservedBytes; }
+    int getMessageHeapAllocations() const { return m_messageHeapAllocations; }
+    /** @brief Area drawn per frame in % of the window, items that draw and cached layers in it */
+    int getCoveredPercent() const { return m_coveredPercent; }
+    int getContentItems() const { return m_contentItems; }
+    int getCachedLayers() const { return m_cachedLayers; }
+
+signals:
+    void enabledChanged(bool enabled);
+    void statsChanged();
+
+private slots:
+    void sampleFrame();
+    void publish();
+
+private:
+    struct AgeSum
+    {
+        qint64 total;
+        int count;
+        int max;
+    };
+    static void add(AgeSum &sum, qint64 receivedMs, qint64 now);
+    /** @brief Add the area item and its children draw inside clip, in scene coordinates */
+    void addCoverage(QQuickItem *item, const QRectF &clip, qreal *area);
+
+    QPointer<QObject> m_window;
+    QPointer<RelPositionOverview> m_relPosition;
+    QPointer<AbsPositionOverview> m_absPosition;
+    bool m_enabled;
+    QTimer m_publishTimer;
+    AgeSum m_attitudeSum;
+    AgeSum m_positionSum;
+    int m_attitudeAge;
+    int m_attitudeAgeMax;
+    int m_positionAge;
+    int m_positionAgeMax;
+    int m_peakReads;                ///< Most seen in the running second
+    int m_peakMessages;
+    int m_pendingReads;             ///< Most seen over the last second
+    int m_pendingMessages;
+    int m_droppedMessages;
+    int m_arenaAllocations;
+    int m_arenaHeapBlocks;
+    int m_arenaReservedBytes;
+    int m_messageHeapAllocations;
+    int m_coveredPercent;
+    int m_contentItems;
+    int m_cachedLayers;
+    int m_lastArenaAllocations;     ///< Totals at the previous publish
+    int m_lastArenaHeapBlocks;
+    int m_lastMessageHeapAllocations;
+};
+
+#endif // HUDPERFORMANCEMONITOR_H
@@ -0,0 +1,501 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudReadoutItem
+ *          See HudReadout.h
+ *
+ */
+
+#include "HudReadout.h"
+#include "TraceMarkers.h"
+#include <QFont>
+#include <QFontInfo>
+#include <QFontMetrics>
+#include <QImage>
+#include <QMutex>
+#include <QPainter>
+#include <QVector4D>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGSimpleMaterial>
+#include <QtQuick/QSGTexture>
+#include <qmath.h>
+#include <qnumeric.h>
+#include <string.h>
+
+namespace {
+
+// The first one is the blank cell, anything not listed shows as it
+static const char Charset[] = " 0123456789.-+:%/AVWmskhftnoe";
+static const int Columns = 9;
+
+/** @brief The glyph cells, metrics at once, the distance field the first time it is asked for */
+class GlyphAtlas
+{
+public:
+    static GlyphAtlas &instance()
+    {
+        static GlyphAtlas atlas;
+        return atlas;
+    }
+
+    int advance;        ///< Of every cell, the widest glyph
+    int height;         ///< Ascent and descent
+    int ascent;
+    int cellWidth;      ///< advance and height plus the spread on either side
+    int cellHeight;
+    int glyphCount;
+
+    /** @brief Cell of c, the blank one if there is no glyph for it */
+    int cell(char c) const { return m_cells[static_cast<uchar>(c)]; }
+
+    /** @brief Any thread */
+    QImage image()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_image.isNull())
+        {
+            m_image = render();
+        }
+        return m_image;
+    }
+
+private:
+    GlyphAtlas() :
+        m_font(QFont())
+    {
+        m_font.setPixelSize(HudReadoutItem::AtlasPixelSize);
+        m_font.setBold(true);
+        QFontMetrics metrics(m_font);
+        glyphCount = static_cast<int>(strlen(Charset));
+        advance = 1;
+        for (int i = 0; i < glyphCount; i++)
+        {
+            advance = qMax(advance, metrics.width(QLatin1Char(Charset[i])));
+        }
+        ascent = metrics.ascent();
+        height = metrics.ascent() + metrics.descent();
+        cellWidth = advance + 2 * HudReadoutItem::Spread;
+        cellHeight = height + 2 * HudReadoutItem::Spread;
+        memset(m_cells, 0, sizeof(m_cells));
+        for (int i = 0; i < glyphCount; i++)
+        {
+            m_cells[static_cast<uchar>(Charset[i])] = i;
+        }
+    }
+
+    QImage render() const
+    {
+        const int rows = (glyphCount + Columns - 1) / Columns;
+        QImage mask(Columns * cellWidth, rows * cellHeight, QImage::Format_ARGB32_Premultiplied);
+        mask.fill(Qt::transparent);
+        {
+            QPainter painter(&mask);
+            painter.setFont(m_font);
+            painter.setPen(Qt::white);
+            QFontMetrics metrics(m_font);
+            for (int i = 0; i < glyphCount; i++)
+            {
+                const QLatin1Char c(Charset[i]);
+                const int x = (i % Columns) * cellWidth + HudReadoutItem::Spread + (advance - metrics.width(c)) / 2;
+                const int y = (i / Columns) * cellHeight + HudReadoutItem::Spread + ascent;
+                painter.drawText(x, y, QString(c));
+            }
+        }
+
+        // Brute force signed distance within Spread of each pixel, once at start up,
+        // 0.5 on the outline, 0 and 1 Spread pixels out and in
+        const int spread = HudReadoutItem::Spread;
+        QImage field(mask.size(), QImage::Format_ARGB32);
+        for (int cell = 0; cell < glyphCount; cell++)
+        {
+            const int left = (cell % Columns) * cellWidth;
+            const int top = (cell / Columns) * cellHeight;
+            for (int y = top; y < top + cellHeight; y++)
+            {
+                for (int x = left; x < left + cellWidth; x++)
+                {
+                    const bool inside = qAlpha(mask.pixel(x, y)) > 127;
+                    int nearest = spread * spread;
+                    for (int dy = -spread; dy <= spread; dy++)
+                    {
+                        const int sy = y + dy;
+                        if (sy < top || sy >= top + cellHeight) continue;
+                        const QRgb *line = reinterpret_cast<const QRgb*>(mask.constScanLine(sy));
+                        for (int dx = -spread; dx <= spread; dx++)
+                        {
+                            const int sx = x + dx;
+                            if (sx < left || sx >= left + cellWidth) continue;
+                            if ((qAlpha(line[sx]) > 127) != inside && dx * dx + dy * dy < nearest)
+                            {
+                                nearest = dx * dx + dy * dy;
+                            }
+                        }
+                    }
+                    // The edge lies half way to the nearest pixel of the other side
+                    const double distance = qSqrt(nearest) - 0.5;
+                    const double value = 0.5 + (inside ? distance : -distance) / (2.0 * spread);
+                    field.setPixel(x, y, qRgba(255, 255, 255, qBound(0, qRound(value * 255), 255)));
+                }
+            }
+        }
+        // Cells past the last glyph stay blank
+        for (int cell = glyphCount; cell < rows * Columns; cell++)
+        {
+            for (int y = (cell / Columns) * cellHeight; y < (cell / Columns + 1) * cellHeight; y++)
+            {
+                for (int x = (cell % Columns) * cellWidth; x < (cell % Columns + 1) * cellWidth; x++)
+                {
+                    field.setPixel(x, y, qRgba(255, 255, 255, 0));
+                }
+            }
+        }
+        return field;
+    }
+
+    QFont m_font;
+    int m_cells[256];
+    QMutex m_mutex;
+    QImage m_image;
+};
+
+struct ReadoutState
+{
+    QSGTexture *texture;
+    QVector4D color;        ///< Premultiplied
+    QVector4D outlineColor;
+    float smoothing;        ///< Half the antialiased edge, in field units
+    float outlineWidth;     ///< Field units, 0 without an outline
+};
+
+static const char *ReadoutVertexShader =
+        "attribute highp vec4 qt_VertexPosition;\n"
+        "attribute highp vec2 qt_VertexTexCoord;\n"
+        "uniform highp mat4 qt_Matrix;\n"
+        "varying highp vec2 texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    texCoord = qt_VertexTexCoord;\n"
+        "    gl_Position = qt_Matrix * qt_VertexPosition;\n"
+        "}\n";
+
+static const char *ReadoutFragmentShader =
+        "uniform sampler2D atlas;\n"
+        "uniform lowp float qt_Opacity;\n"
+        "uniform lowp vec4 color;\n"
+        "uniform lowp vec4 outlineColor;\n"
+        "uniform mediump float smoothing;\n"
+        "uniform mediump float outlineWidth;\n"
+        "varying highp vec2 texCoord;\n"
+        "void main()\n"
+        "{\n"
+        "    mediump float d = texture2D(atlas, texCoord).a;\n"
+        "    lowp float fill = smoothstep(0.5 - smoothing, 0.5 + smoothing, d);\n"
+        "    lowp float edge = smoothstep(0.5 - outlineWidth - smoothing, 0.5 - outlineWidth + smoothing, d);\n"
+        "    gl_FragColor = mix(outlineColor * edge, color, fill) * qt_Opacity;\n"
+        "}\n";
+
+class ReadoutShader : public QSGSimpleMaterialShader<ReadoutState>
+{
+    QSG_DECLARE_SIMPLE_SHADER(ReadoutShader, ReadoutState)
+public:
+    const char *vertexShader() const { return ReadoutVertexShader; }
+    const char *fragmentShader() const { return ReadoutFragmentShader; }
+
+    QList<QByteArray> attributes() const
+    {
+        return QList<QByteArray>() << "qt_VertexPosition" << "qt_VertexTexCoord";
+    }
+
+    void resolveUniforms()
+    {
+        m_atlas = program()->uniformLocation("atlas");
+        m_color = program()->uniformLocation("color");
+        m_outlineColor = program()->uniformLocation("outlineColor");
+        m_smoothing = program()->uniformLocation("smoothing");
+        m_outlineWidth = program()->uniformLocation("outlineWidth");
+    }
+
+    void updateState(const ReadoutState *state, const ReadoutState *)
+    {
+        state->texture->bind();
+        program()->setUniformValue(m_atlas, 0);
+        program()->setUniformValue(m_color, state->color);
+        program()->setUniformValue(m_outlineColor, state->outlineColor);
+        program()->setUniformValue(m_smoothing, state->smoothing);
+        program()->setUniformValue(m_outlineWidth, state->outlineWidth);
+    }
+
+private:
+    int m_atlas;
+    int m_color;
+    int m_outlineColor;
+    int m_smoothing;
+    int m_outlineWidth;
+};
+
+/** @brief Keeps the atlas texture as long as the node */
+class ReadoutNode : public QSGGeometryNode
+{
+public:
+    ReadoutNode() : texture(NULL) {}
+    ~ReadoutNode() { delete texture; }
+
+    QSGTexture *texture;
+};
+
+static QVector4D premultiplied(const QColor &color)
+{
+    const float alpha = color.alphaF();
+    return QVector4D(color.redF() * alpha, color.greenF() * alpha, color.blueF() * alpha, alpha);
+}
+
+}
+
+HudReadoutItem::HudReadoutItem(QQuickItem *parent) :
+    QQuickItem(parent),
+    m_value(0),
+    m_decimals(0),
+    m_cells(5),
+    m_pixelSize(QFontInfo(QFont()).pixelSize()),
+    m_color(Qt::white),
+    m_outlineColor(Qt::transparent),
+    m_layoutDirty(true),
+    m_charsDirty(true)
+{
+    setFlag(ItemHasContents, true);
+    updateChars();
+    updateImplicitSize();
+}
+
+void HudReadoutItem::setValue(qreal value)
+{
+    if (m_value == value) return;
+    m_value = value;
+    emit valueChanged();
+    if (m_text.isEmpty()) updateChars();
+}
+
+void HudReadoutItem::setDecimals(int decimals)
+{
+    decimals = qBound(0, decimals, MaxCells - 1);
+    if (m_decimals == decimals) return;
+    m_decimals = decimals;
+    emit decimalsChanged();
+    updateChars();
+}
+
+void HudReadoutItem::setText(const QString &text)
+{
+    if (m_text == text) return;
+    m_text = text;
+    emit textChanged();
+    updateChars();
+}
+
+void HudReadoutItem::setCells(int cells)
+{
+    cells = qBound(1, cells, static_cast<int>(MaxCells));
+    if (m_cells == cells) return;
+    m_cells = cells;
+    emit cellsChanged();
+    m_layoutDirty = true;
+    updateChars();
+    updateImplicitSize();
+    update();
+}
+
+void HudReadoutItem::setPixelSize(qreal pixelSize)
+{
+    if (m_pixelSize == pixelSize || pixelSize <= 0) return;
+    m_pixelSize = pixelSize;
+    emit pixelSizeChanged();
+    m_layoutDirty = true;
+    updateImplicitSize();
+    update();
+}
+
+void HudReadoutItem::setColor(const QColor &color)
+{
+    if (m_color == color) return;
+    m_color = color;
+    emit colorChanged();
+    update();
+}
+
+void HudReadoutItem::setOutlineColor(const QColor &color)
+{
+    if (m_outlineColor == color) return;
+    m_outlineColor = color;
+    emit outlineColorChanged();
+    update();
+}
+
+void HudReadoutItem::updateImplicitSize()
+{
+    const GlyphAtlas &atlas = GlyphAtlas::instance();
+    const qreal scale = m_pixelSize / AtlasPixelSize;
+    setImplicitWidth(m_cells * atlas.advance * scale);
+    setImplicitHeight(atlas.height * scale);
+}
+
+void HudReadoutItem::updateChars()
+{
+    char text[MaxCells + 1];
+    int length = -1;
+    if (!m_text.isEmpty())
+    {
+        const QByteArray latin1 = m_text.toLatin1();
+        if (latin1.size() <= m_cells)
+        {
+            length = latin1.size();
+            memcpy(text, latin1.constData(), length);
+        }
+    }
+    else if (!qIsNaN(m_value) && !qIsInf(m_value))
+    {
+        // Fewer decimals before giving up on the value
+        char formatted[64];
+        for (int decimals = m_decimals; decimals >= 0 && length < 0; decimals--)
+        {
+            const int size = qsnprintf(formatted, sizeof(formatted), "%.*f", decimals, double(m_value));
+            if (size > 0 && size <= m_cells)
+            {
+                length = size;
+                memcpy(text, formatted, length);
+            }
+        }
+    }
+
+    QByteArray chars(m_cells, length < 0 ? '-' : ' ');
+    if (length > 0)
+    {
+        memcpy(chars.data() + m_cells - length, text, length);
+    }
+    if (chars == m_chars)
+    {
+        return;
+    }
+    m_chars = chars;
+    m_charsDirty = true;
+    update();
+}
+
+void HudReadoutItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+    {
+        m_layoutDirty = true;
+        update();
+    }
+}
+
+// Render thread, the GUI thread is blocked meanwhile
+QSGNode *HudReadoutItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    HUD_TRACE_SCOPE("HudReadoutItem::updatePaintNode");
+    Q_UNUSED(data);
+    GlyphAtlas &atlas = GlyphAtlas::instance();
+    ReadoutNode *node = static_cast<ReadoutNode *>(oldNode);
+    if (!node)
+    {
+        node = new ReadoutNode;
+        // Shared with the other readouts and images through the scene graph's atlas
+        node->texture = window()->createTextureFromImage(atlas.image(), QQuickWindow::TextureCanUseAtlas);
+        node->texture->setFiltering(QSGTexture::Linear);
+        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+        geometry->setDrawingMode(GL_TRIANGLES);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        QSGSimpleMaterial<ReadoutState> *material = ReadoutShader::createMaterial();
+        material->setFlag(QSGMaterial::Blending);
+        material->state()->texture = node->texture;
+        node->setMaterial(material);
+        node->setFlag(QSGNode::OwnsMaterial);
+        m_layoutDirty = true;
+    }
+
+    const qreal scale = m_pixelSize / AtlasPixelSize;
+    QSGGeometry *geometry = node->geometry();
+    QSGGeometry::TexturedPoint2D *vertices;
+    if (m_layoutDirty)
+    {
+        // Two triangles per cell, covering the glyph and its spread
+        geometry->allocate(m_cells * 6);
+        vertices = geometry->vertexDataAsTexturedPoint2D();
+        const float cellWidth = atlas.advance * scale;
+        const float pad = Spread * scale;
+        const float x0 = width() - m_cells * cellWidth;
+        const float top = (height() - atlas.height * scale) / 2 - pad;
+        const float bottom = top + atlas.cellHeight * scale;
+        for (int i = 0; i < m_cells; i++)
+        {
+            const float left = x0 + i * cellWidth - pad;
+            const float right = left + atlas.cellWidth * scale;
+            QSGGeometry::TexturedPoint2D *v = vertices + i * 6;
+            v[0].x = left;  v[0].y = top;
+            v[1].x = right; v[1].y = top;
+            v[2].x = left;  v[2].y = bottom;
+            v[3].x = right; v[3].y = top;
+            v[4].x = right; v[4].y = bottom;
+            v[5].x = left;  v[5].y = bottom;
+        }
+        m_charsDirty = true;
+    }
+    if (m_charsDirty)
+    {
+        // Only the texture coordinates follow the value
+        vertices = geometry->vertexDataAsTexturedPoint2D();
+        const QRectF sub = node->texture->normalizedTextureSubRect();
+        const QSize size = node->texture->textureSize();
+        const float du = sub.width() * atlas.cellWidth / size.width();
+        const float dv = sub.height() * atlas.cellHeight / size.height();
+        for (int i = 0; i < m_cells && i < m_chars.size(); i++)
+        {
+            const int cell = atlas.cell(m_chars.at(i));
+            const float u0 = sub.x() + (cell % Columns) * du;
+            const float v0 = sub.y() + (cell / Columns) * dv;
+            QSGGeometry::TexturedPoint2D *v = vertices + i * 6;
+            v[0].tx = u0;      v[0].ty = v0;
+            v[1].tx = u0 + du; v[1].ty = v0;
+            v[2].tx = u0;      v[2].ty = v0 + dv;
+            v[3].tx = u0 + du; v[3].ty = v0;
+            v[4].tx = u0 + du; v[4].ty = v0 + dv;
+            v[5].tx = u0;      v[5].ty = v0 + dv;
+        }
+        node->markDirty(QSGNode::DirtyGeometry);
+    }
+    m_layoutDirty = false;
+    m_charsDirty = false;
+
+    ReadoutState *state = static_cast<QSGSimpleMaterial<ReadoutState>*>(node->material())->state();
+    state->color = premultiplied(m_color);
+    state->outlineColor = premultiplied(m_outlineColor);
+    // A field unit is 2 * Spread atlas pixels, half a screen pixel either side of the edge is smoothed
+    state->smoothing = 0.25 / (scale * Spread);
+    state->outlineWidth = m_outlineColor.alpha() > 0 ? 1.5 / (scale * 2 * Spread) : 0;
+    node->markDirty(QSGNode::DirtyMaterial);
+    return node;
+}
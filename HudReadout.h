@@ -0,0 +1,113 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Numeric HUD readouts drawn from a distance field glyph atlas
+ *
+ *   The digits, the separators and the few unit letters the readouts use
+ *   are rasterized once, at AtlasPixelSize, into a signed distance field
+ *   image that the scene graph keeps in its texture atlas. A readout is a
+ *   fixed row of character cells: the quads only move when the size or the
+ *   cell count changes, a new value rewrites their texture coordinates.
+ *   There is no text layout and no glyph node, and one atlas scales to
+ *   every pixel size crisply.
+ */
+
+#ifndef HUDREADOUT_H
+#define HUDREADOUT_H
+
+#include <QColor>
+#include <QByteArray>
+#include <QString>
+#include <QtQuick/QQuickItem>
+
+/**
+ * @brief A right aligned, fixed width number or short text
+ *
+ * Shows value with decimals digits after the point, or text when that is
+ * set. Characters the atlas has no glyph for are left blank; a value that
+ * does not fit the cells loses decimals first, then shows dashes.
+ */
+class HudReadoutItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal value READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(int decimals READ getDecimals WRITE setDecimals NOTIFY decimalsChanged)
+    Q_PROPERTY(QString text READ getText WRITE setText NOTIFY textChanged)
+    Q_PROPERTY(int cells READ getCells WRITE setCells NOTIFY cellsChanged)
+    Q_PROPERTY(qreal pixelSize READ getPixelSize WRITE setPixelSize NOTIFY pixelSizeChanged)
+    Q_PROPERTY(QColor color READ getColor WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(QColor outlineColor READ getOutlineColor WRITE setOutlineColor NOTIFY outlineColorChanged)
+public:
+    enum { AtlasPixelSize = 48, Spread = 6, MaxCells = 16 };
+
+    explicit HudReadoutItem(QQuickItem *parent = 0);
+
+    qreal getValue() const { return m_value; }
+    void setValue(qreal value);
+    int getDecimals() const { return m_decimals; }
+    void setDecimals(int decimals);
+    QString getText() const { return m_text; }
+    /** @brief Shown instead of value unless empty */
+    void setText(const QString &text);
+    int getCells() const { return m_cells; }
+    void setCells(int cells);
+    qreal getPixelSize() const { return m_pixelSize; }
+    void setPixelSize(qreal pixelSize);
+    QColor getColor() const { return m_color; }
+    void setColor(const QColor &color);
+    QColor getOutlineColor() const { return m_outlineColor; }
+    /** @brief Transparent, the default, draws no outline */
+    void setOutlineColor(const QColor &color);
+
+signals:
+    void valueChanged();
+    void decimalsChanged();
+    void textChanged();
+    void cellsChanged();
+    void pixelSizeChanged();
+    void colorChanged();
+    void outlineColorChanged();
+
+protected:
+    virtual QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+    virtual void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+
+private:
+    /** @brief Lays value or text out into m_chars, schedules a repaint only if a cell changed */
+    void updateChars();
+    void updateImplicitSize();
+
+    qreal m_value;
+    int m_decimals;
+    QString m_text;
+    int m_cells;
+    qreal m_pixelSize;
+    QColor m_color;
+    QColor m_outlineColor;
+    QByteArray m_chars;         ///< One Latin-1 character per cell, right aligned
+    bool m_layoutDirty;         ///< Quad positions, on a size or cell count change
+    bool m_charsDirty;          ///< Texture coordinates only
+};
+
+#endif // HUDREADOUT_H
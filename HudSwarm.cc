@@ -0,0 +1,262 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief HudSwarm
+ *          See HudSwarm.h
+ *
+ */
+
+#include "HudSwarm.h"
+#include "HudMap.h"
+#include "SwarmModel.h"
+#include <qmath.h>
+
+// Ground resolution of zoom 0 at the equator, m per pixel
+static const double equatorMetresPerPixel = 156543.03392;
+
+// One triangle in a premultiplied color, as QSGVertexColorMaterial wants
+static void addTriangle(QVector<QSGGeometry::ColoredPoint2D> &vertices, const QPointF &a, const QPointF &b,
+                        const QPointF &c, const QColor &color)
+{
+    const float alpha = color.alphaF();
+    const uchar r = static_cast<uchar>(color.red() * alpha);
+    const uchar g = static_cast<uchar>(color.green() * alpha);
+    const uchar bl = static_cast<uchar>(color.blue() * alpha);
+    const uchar al = static_cast<uchar>(color.alpha());
+    QSGGeometry::ColoredPoint2D corner[3];
+    corner[0].set(a.x(), a.y(), r, g, bl, al);
+    corner[1].set(b.x(), b.y(), r, g, bl, al);
+    corner[2].set(c.x(), c.y(), r, g, bl, al);
+    vertices << corner[0] << corner[1] << corner[2];
+}
+
+HudSwarmItem::HudSwarmItem(QQuickItem *parent) :
+    HudGeometryItem(parent),
+    m_latitude(0),
+    m_longitude(0),
+    m_zoom(16),
+    m_activeSysid(-1),
+    m_highlightColor(Qt::red),
+    m_staleColor(Qt::gray),
+    m_staleMs(5000),
+    m_iconSize(12),
+    m_velocityLead(0)
+{
+    m_staleTimer.setInterval(1000);
+    connect(&m_staleTimer, SIGNAL(timeout()), this, SLOT(onTableChanged()));
+}
+
+QObject *HudSwarmItem::getModel() const
+{
+    return m_swarm.data();
+}
+
+void HudSwarmItem::setModel(QObject *swarm)
+{
+    SwarmModel *model = qobject_cast<SwarmModel*>(swarm);
+    if (model == m_swarm)
+    {
+        return;
+    }
+    if (m_swarm)
+    {
+        disconnect(m_swarm, SIGNAL(tableChanged()), this, SLOT(onTableChanged()));
+    }
+    m_swarm = model;
+    if (m_swarm)
+    {
+        connect(m_swarm, SIGNAL(tableChanged()), this, SLOT(onTableChanged()));
+        m_staleTimer.start();
+    }
+    else
+    {
+        m_staleTimer.stop();
+    }
+    markDirty();
+    emit modelChanged();
+}
+
+void HudSwarmItem::setLatitude(double latitude)
+{
+    if (qFuzzyCompare(latitude, m_latitude))
+    {
+        return;
+    }
+    m_latitude = latitude;
+    markDirty();
+    emit positionChanged();
+}
+
+void HudSwarmItem::setLongitude(double longitude)
+{
+    if (qFuzzyCompare(longitude, m_longitude))
+    {
+        return;
+    }
+    m_longitude = longitude;
+    markDirty();
+    emit positionChanged();
+}
+
+void HudSwarmItem::setZoom(int zoom)
+{
+    zoom = qBound(int(HudMapItem::MinZoom), zoom, int(HudMapItem::MaxZoom));
+    if (zoom == m_zoom)
+    {
+        return;
+    }
+    m_zoom = zoom;
+    markDirty();
+    emit zoomChanged();
+}
+
+void HudSwarmItem::setActiveSysid(int sysid)
+{
+    if (sysid == m_activeSysid)
+    {
+        return;
+    }
+    m_activeSysid = sysid;
+    markDirty();
+    emit activeSysidChanged();
+}
+
+void HudSwarmItem::setHighlightColor(const QColor &color)
+{
+    if (color == m_highlightColor)
+    {
+        return;
+    }
+    m_highlightColor = color;
+    markDirty();
+    emit highlightColorChanged();
+}
+
+void HudSwarmItem::setStaleColor(const QColor &color)
+{
+    if (color == m_staleColor)
+    {
+        return;
+    }
+    m_staleColor = color;
+    markDirty();
+    emit staleColorChanged();
+}
+
+void HudSwarmItem::setStaleMs(int ms)
+{
+    if (ms == m_staleMs)
+    {
+        return;
+    }
+    m_staleMs = ms;
+    markDirty();
+    emit staleMsChanged();
+}
+
+void HudSwarmItem::setIconSize(qreal size)
+{
+    if (qFuzzyCompare(size, m_iconSize))
+    {
+        return;
+    }
+    m_iconSize = size;
+    markDirty();
+    emit iconSizeChanged();
+}
+
+void HudSwarmItem::setVelocityLead(qreal seconds)
+{
+    if (qFuzzyCompare(seconds, m_velocityLead))
+    {
+        return;
+    }
+    m_velocityLead = seconds;
+    markDirty();
+    emit velocityLeadChanged();
+}
+
+void HudSwarmItem::buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const
+{
+    if (!m_swarm)
+    {
+        return;
+    }
+    const QVector<SwarmModel::Vehicle> &table = m_swarm->vehicles();
+    // Arrow of two triangles plus a velocity line, two more
+    vertices.reserve(table.size() * 12);
+
+    const QPointF centre = HudMapItem::project(m_latitude, m_longitude, m_zoom);
+    const QPointF origin(centre.x() - width() / 2, centre.y() - height() / 2);
+    const double pixelsPerMetre = (1 << m_zoom) / (equatorMetresPerPixel * qCos(qDegreesToRadians(m_latitude)));
+    const qint64 now = m_swarm->now();
+    const float half = m_iconSize / 2;
+    const QRectF bounds(-m_iconSize, -m_iconSize, width() + 2 * m_iconSize, height() + 2 * m_iconSize);
+
+    foreach (const SwarmModel::Vehicle &vehicle, table)
+    {
+        if (vehicle.lat == 0 && vehicle.lon == 0)
+        {
+            // No fix yet
+            continue;
+        }
+        const QPointF p = HudMapItem::project(vehicle.lat * 1E-7, vehicle.lon * 1E-7, m_zoom) - origin;
+        const bool visible = bounds.contains(p);
+        const double heading = qDegreesToRadians(vehicle.heading / 100.0);
+        // Screen y grows down, heading is clockwise from north
+        const QPointF forward(qSin(heading), -qCos(heading));
+        const QPointF right(-forward.y(), forward.x());
+
+        QColor color = getColor();
+        if (vehicle.sysid == m_activeSysid)
+        {
+            color = m_highlightColor;
+        }
+        else if (now - vehicle.lastSeen > m_staleMs)
+        {
+            color = m_staleColor;
+        }
+
+        if (m_velocityLead > 0 && vehicle.groundSpeed > 0)
+        {
+            const double length = vehicle.groundSpeed / 100.0 * m_velocityLead * pixelsPerMetre;
+            const QPointF end = p + forward * length;
+            if (visible || bounds.contains(end))
+            {
+                addLine(vertices, p.x(), p.y(), end.x(), end.y(), getLineWidth(), color);
+            }
+        }
+        if (!visible)
+        {
+            continue;
+        }
+        // Chevron: tip ahead, notch behind the centre
+        const QPointF tip = p + forward * half;
+        const QPointF notch = p - forward * (half * 0.4f);
+        const QPointF leftWing = p - forward * half - right * (half * 0.8f);
+        const QPointF rightWing = p - forward * half + right * (half * 0.8f);
+        addTriangle(vertices, tip, notch, leftWing, color);
+        addTriangle(vertices, tip, rightWing, notch, color);
+    }
+}
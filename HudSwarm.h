@@ -0,0 +1,120 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Every vehicle of the swarm as one scene graph geometry node
+ *
+ *   Counterpart of a Repeater of icon items over a SwarmModel: the icons
+ *   and velocity vectors of all vehicles are one vertex colored triangle
+ *   list, rebuilt from the model's table when it publishes, so the swarm
+ *   costs one node and one draw call however many vehicles it has.
+ */
+
+#ifndef HUDSWARM_H
+#define HUDSWARM_H
+
+#include <QPointer>
+#include <QTimer>
+#include "HudInstruments.h"
+
+class SwarmModel;
+
+/**
+ * @brief Vehicles drawn over a HudMapItem of the same centre and zoom
+ *
+ * Each vehicle is an arrow pointing along its heading, the active one in
+ * highlightColor, those without a heartbeat for staleMs in staleColor.
+ * With velocityLead set a line shows where the vehicle will be after
+ * that many seconds at its ground speed. The model's vehicles without a
+ * fix are left out.
+ */
+class HudSwarmItem : public HudGeometryItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QObject* model READ getModel WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(double latitude READ getLatitude WRITE setLatitude NOTIFY positionChanged)
+    Q_PROPERTY(double longitude READ getLongitude WRITE setLongitude NOTIFY positionChanged)
+    Q_PROPERTY(int zoom READ getZoom WRITE setZoom NOTIFY zoomChanged)
+    Q_PROPERTY(int activeSysid READ getActiveSysid WRITE setActiveSysid NOTIFY activeSysidChanged)
+    Q_PROPERTY(QColor highlightColor READ getHighlightColor WRITE setHighlightColor NOTIFY highlightColorChanged)
+    Q_PROPERTY(QColor staleColor READ getStaleColor WRITE setStaleColor NOTIFY staleColorChanged)
+    Q_PROPERTY(int staleMs READ getStaleMs WRITE setStaleMs NOTIFY staleMsChanged)
+    Q_PROPERTY(qreal iconSize READ getIconSize WRITE setIconSize NOTIFY iconSizeChanged)
+    Q_PROPERTY(qreal velocityLead READ getVelocityLead WRITE setVelocityLead NOTIFY velocityLeadChanged)
+public:
+    explicit HudSwarmItem(QQuickItem *parent = 0);
+
+    QObject *getModel() const;
+    void setModel(QObject *swarm);
+    double getLatitude() const { return m_latitude; }
+    void setLatitude(double latitude);
+    double getLongitude() const { return m_longitude; }
+    void setLongitude(double longitude);
+    int getZoom() const { return m_zoom; }
+    void setZoom(int zoom);
+    int getActiveSysid() const { return m_activeSysid; }
+    void setActiveSysid(int sysid);
+    QColor getHighlightColor() const { return m_highlightColor; }
+    void setHighlightColor(const QColor &color);
+    QColor getStaleColor() const { return m_staleColor; }
+    void setStaleColor(const QColor &color);
+    int getStaleMs() const { return m_staleMs; }
+    void setStaleMs(int ms);
+    qreal getIconSize() const { return m_iconSize; }
+    void setIconSize(qreal size);
+    /** @brief Seconds ahead the velocity line reaches, 0 draws none */
+    qreal getVelocityLead() const { return m_velocityLead; }
+    void setVelocityLead(qreal seconds);
+
+signals:
+    void modelChanged();
+    void positionChanged();
+    void zoomChanged();
+    void activeSysidChanged();
+    void highlightColorChanged();
+    void staleColorChanged();
+    void staleMsChanged();
+    void iconSizeChanged();
+    void velocityLeadChanged();
+
+protected:
+    void buildGeometry(QVector<QSGGeometry::ColoredPoint2D> &vertices) const;
+
+private slots:
+    void onTableChanged() { markDirty(); }
+
+private:
+    QPointer<SwarmModel> m_swarm;
+    double m_latitude;
+    double m_longitude;
+    int m_zoom;
+    int m_activeSysid;
+    QColor m_highlightColor;
+    QColor m_staleColor;
+    int m_staleMs;
+    qreal m_iconSize;
+    qreal m_velocityLead;
+    QTimer m_staleTimer;    ///< Vehicles that went quiet never publish, so recolor them on a timer
+};
+
+#endif // HUDSWARM_H
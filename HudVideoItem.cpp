@@ -0,0 +1,570 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "HudVideoItem.h"
+#include "TraceMarkers.h"
+#include <QtQuick/QSGNode>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGOpacityNode>
+#include <QtQuick/QSGSimpleMaterial>
+#include <QtQuick/QSGTransformNode>
+#include <QVector2D>
+#include <QVector4D>
+#include <qmath.h>
+
+namespace {
+
+struct HudOverlayState
+{
+    QVector4D color;        ///< Premultiplied
+    QVector2D center;
+    QVector2D rotation;     ///< cos/sin of the roll angle
+    QVector2D enabled;      ///< Roll scale, pitch ladder
+    float pitchOffset;      ///< Pixels
+    float pixelsPerDegree;
+    float radius;
+    float lineWidth;
+};
+
+// Everything is computed in item pixels relative to the item center, y down
+static const char *HudOverlayVertexShader =
+        "attribute highp vec4 qt_VertexPosition;\n"
+        "uniform highp mat4 qt_Matrix;\n"
+        "uniform highp vec2 center;\n"
+        "varying highp vec2 pos;\n"
+        "void main()\n"
+        "{\n"
+        "    pos = qt_VertexPosition.xy - center;\n"
+        "    gl_Position = qt_Matrix * qt_VertexPosition;\n"
+        "}\n";
+
+static const char *HudOverlayFragmentShader =
+        "uniform lowp float qt_Opacity;\n"
+        "uniform lowp vec4 color;\n"
+        "uniform highp vec2 rotation;\n"
+        "uniform lowp vec2 enabled;\n"
+        "uniform highp float pitchOffset;\n"
+        "uniform highp float pixelsPerDegree;\n"
+        "uniform highp float radius;\n"
+        "uniform highp float lineWidth;\n"
+        "varying highp vec2 pos;\n"
+        "\n"
+        "lowp float stroke(highp float d)\n"
+        "{\n"
+        "    return 1.0 - smoothstep(0.5 * lineWidth - 0.5, 0.5 * lineWidth + 0.5, abs(d));\n"
+        "}\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "    highp float r = length(pos);\n"
+        "    // Horizon frame: undo the roll rotation, then the pitch translation\n"
+        "    highp vec2 g = vec2(rotation.x * pos.x - rotation.y * pos.y, rotation.y * pos.x + rotation.x * pos.y);\n"
+        "    highp float y = g.y - pitchOffset;\n"
+        "\n"
+        "    // Crosshair, fixed to the airframe\n"
+        "    lowp float a = enabled.x * stroke(pos.y) * step(0.12 * radius, abs(pos.x)) * step(abs(pos.x), 0.4 * radius);\n"
+        "    a = max(a, enabled.x * (1.0 - smoothstep(lineWidth, lineWidth + 1.0, r)));\n"
+        "\n"
+        "    // Horizon and a rung every 5 degrees up to 60, long ones on the tens\n"
+        "    highp float rung = floor(y / pixelsPerDegree / 5.0 + 0.5) * 5.0;\n"
+        "    highp float halfWidth = abs(rung) < 0.5 ? 1.2 * radius : (mod(rung, 10.0) < 0.5 ? 0.3 : 0.15) * radius;\n"
+        "    highp float gap = abs(rung) < 0.5 ? 0.0 : 0.1 * radius;\n"
+        "    a = max(a, enabled.y * stroke(y - rung * pixelsPerDegree) * step(gap, abs(g.x)) * step(abs(g.x), halfWidth)\n"
+        "               * step(abs(rung), 60.5));\n"
+        "\n"
+        "    // Roll scale rotating with the horizon: arc to +-60, ticks at 10/20/30/45/60\n"
+        "    highp float angle = abs(degrees(atan(g.x, -g.y)));\n"
+        "    highp float tick = angle < 37.5 ? floor(angle / 10.0 + 0.5) * 10.0 : (angle < 52.5 ? 45.0 : 60.0);\n"
+        "    highp float tickLength = mod(tick, 30.0) < 0.5 ? 0.12 : 0.06;\n"
+        "    a = max(a, enabled.x * stroke(r - radius) * step(angle, 60.0));\n"
+        "    a = max(a, enabled.x * stroke(radians(angle - tick) * r) * step(radius, r) * step(r, radius * (1.0 + tickLength)));\n"
+        "\n"
+        "    // Roll pointer, fixed at the top just inside the arc\n"
+        "    highp float t = (pos.y + radius - lineWidth) / (0.1 * radius);\n"
+        "    a = max(a, enabled.x * step(0.0, t) * step(t, 1.0) * step(abs(pos.x), t * 0.06 * radius));\n"
+        "\n"
+        "    gl_FragColor = color * (a * qt_Opacity);\n"
+        "}\n";
+
+class HudOverlayShader : public QSGSimpleMaterialShader<HudOverlayState>
+{
+    QSG_DECLARE_SIMPLE_SHADER(HudOverlayShader, HudOverlayState)
+public:
+    const char *vertexShader() const { return HudOverlayVertexShader; }
+    const char *fragmentShader() const { return HudOverlayFragmentShader; }
+
+    QList<QByteArray> attributes() const
+    {
+        return QList<QByteArray>() << "qt_VertexPosition";
+    }
+
+    void resolveUniforms()
+    {
+        m_color = program()->uniformLocation("color");
+        m_center = program()->uniformLocation("center");
+        m_rotation = program()->uniformLocation("rotation");
+        m_enabled = program()->uniformLocation("enabled");
+        m_pitchOffset = program()->uniformLocation("pitchOffset");
+        m_pixelsPerDegree = program()->uniformLocation("pixelsPerDegree");
+        m_radius = program()->uniformLocation("radius");
+        m_lineWidth = program()->uniformLocation("lineWidth");
+    }
+
+    void updateState(const HudOverlayState *state, const HudOverlayState *)
+    {
+        program()->setUniformValue(m_color, state->color);
+        program()->setUniformValue(m_center, state->center);
+        program()->setUniformValue(m_rotation, state->rotation);
+        program()->setUniformValue(m_enabled, state->enabled);
+        program()->setUniformValue(m_pitchOffset, state->pitchOffset);
+        program()->setUniformValue(m_pixelsPerDegree, state->pixelsPerDegree);
+        program()->setUniformValue(m_radius, state->radius);
+        program()->setUniformValue(m_lineWidth, state->lineWidth);
+    }
+
+private:
+    int m_color;
+    int m_center;
+    int m_rotation;
+    int m_enabled;
+    int m_pitchOffset;
+    int m_pixelsPerDegree;
+    int m_radius;
+    int m_lineWidth;
+};
+
+/** @brief Root node: the sink's video node below the stabilizer first, the overlay quad drawn over it */
+class HudNode : public QSGNode
+{
+public:
+    HudNode() : stabilizer(new QSGTransformNode), source(new QSGOpacityNode), lens(NULL), lensRevision(-1),
+        video(NULL), overlay(NULL)
+    {
+        appendChildNode(stabilizer);
+        stabilizer->appendChildNode(source);
+    }
+
+    bool hasVideo(QSGNode *node)
+    {
+        for (QSGNode *child = source->firstChild(); child != NULL; child = child->nextSibling())
+        {
+            if (child == node) return true;
+        }
+        return false;
+    }
+
+    QSGTransformNode *stabilizer;   ///< Identity unless stabilizing, owned as a child
+    QSGOpacityNode *source;         ///< Holds the sink's node, transparent while the lens grid draws it
+    QSGGeometryNode *lens;          ///< Lens corrected grid sharing the sink's material
+    int lensRevision;
+    QSGGeometry::TexturedPoint2D lensCorners[2];    ///< The sink's quad the grid was built for
+    QSGNode *video;
+    QSGGeometryNode *overlay;
+};
+
+// The video node and its quad if the sink draws a textured frame, else NULL
+QSGGeometryNode *texturedVideo(QSGNode *video, QSGGeometry::TexturedPoint2D *topLeft, QSGGeometry::TexturedPoint2D *bottomRight)
+{
+    if (video == NULL || video->type() != QSGNode::GeometryNodeType) return NULL;
+    QSGGeometryNode *node = static_cast<QSGGeometryNode*>(video);
+    const QSGGeometry *geometry = node->geometry();
+    if (node->material() == NULL || geometry == NULL || geometry->vertexCount() != 4
+            || geometry->attributeCount() != 2 || geometry->sizeOfVertex() != sizeof(QSGGeometry::TexturedPoint2D))
+    {
+        return NULL;
+    }
+    // updateTexturedRectGeometry order: top left, bottom left, top right, bottom right
+    const QSGGeometry::TexturedPoint2D *vertices = geometry->vertexDataAsTexturedPoint2D();
+    *topLeft = vertices[0];
+    *bottomRight = vertices[3];
+    return node;
+}
+
+bool sameCorner(const QSGGeometry::TexturedPoint2D &a, const QSGGeometry::TexturedPoint2D &b)
+{
+    return a.x == b.x && a.y == b.y && a.tx == b.tx && a.ty == b.ty;
+}
+
+QSGGeometry *createLensGrid()
+{
+    const int n = HudVideoItem::LensGridSize;
+    QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(),
+                                            (n + 1) * (n + 1), n * n * 6, GL_UNSIGNED_SHORT);
+    geometry->setDrawingMode(GL_TRIANGLES);
+    quint16 *index = geometry->indexDataAsUShort();
+    for (int row = 0; row < n; ++row)
+    {
+        for (int column = 0; column < n; ++column)
+        {
+            quint16 topLeft = row * (n + 1) + column;
+            quint16 bottomLeft = topLeft + n + 1;
+            *index++ = topLeft;
+            *index++ = bottomLeft;
+            *index++ = topLeft + 1;
+            *index++ = topLeft + 1;
+            *index++ = bottomLeft;
+            *index++ = bottomLeft + 1;
+        }
+    }
+    return geometry;
+}
+
+// Positions spread evenly over the sink's quad, texture coordinates where
+// the profile finds each of them in the camera image
+void updateLensGrid(QSGGeometry *geometry, const LensProfile &profile,
+                    const QSGGeometry::TexturedPoint2D &topLeft, const QSGGeometry::TexturedPoint2D &bottomRight)
+{
+    const int n = HudVideoItem::LensGridSize;
+    QSGGeometry::TexturedPoint2D *vertex = geometry->vertexDataAsTexturedPoint2D();
+    for (int row = 0; row <= n; ++row)
+    {
+        qreal y = qreal(row) / n;
+        for (int column = 0; column <= n; ++column)
+        {
+            qreal x = qreal(column) / n;
+            // Past the camera image the edge repeats, a zoom in the profile keeps that out of view
+            QPointF source = profile.sourcePoint(x, y);
+            qreal tx = qBound<qreal>(0, source.x(), 1);
+            qreal ty = qBound<qreal>(0, source.y(), 1);
+            vertex->set(topLeft.x + x * (bottomRight.x - topLeft.x),
+                        topLeft.y + y * (bottomRight.y - topLeft.y),
+                        topLeft.tx + tx * (bottomRight.tx - topLeft.tx),
+                        topLeft.ty + ty * (bottomRight.ty - topLeft.ty));
+            ++vertex;
+        }
+    }
+}
+
+// Difference of two headings in degrees, -180..180
+qreal headingDelta(qreal a, qreal b)
+{
+    qreal delta = fmod(a - b, 360.0);
+    if (delta > 180) delta -= 360;
+    if (delta < -180) delta += 360;
+    return delta;
+}
+
+}
+
+HudVideoItem::HudVideoItem(QQuickItem *parent)
+    : QGst::Quick::VideoItem(parent),
+      m_overlay(true),
+      m_rollEnabled(true),
+      m_pitchEnabled(true),
+      m_rollAngle(0),
+      m_pitchAngle(0),
+      m_pixelsPerDegree(4.5),
+      m_graticuleRadius(150),
+      m_lineWidth(2),
+      m_overlayColor(Qt::white),
+      m_stabilize(false),
+      m_yawAngle(0),
+      m_fieldOfView(90),
+      m_stabilizeLimit(6),
+      m_smoothRoll(0),
+      m_smoothPitch(0),
+      m_smoothYaw(0),
+      m_smoothValid(false),
+      m_lensCorrection(false),
+      m_lensRevision(0)
+{
+}
+
+void HudVideoItem::setOverlay(bool overlay)
+{
+    if (m_overlay == overlay) return;
+    m_overlay = overlay;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setRollEnabled(bool enabled)
+{
+    if (m_rollEnabled == enabled) return;
+    m_rollEnabled = enabled;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setPitchEnabled(bool enabled)
+{
+    if (m_pitchEnabled == enabled) return;
+    m_pitchEnabled = enabled;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setRollAngle(qreal angle)
+{
+    if (m_rollAngle == angle) return;
+    m_rollAngle = angle;
+    emit attitudeChanged();
+    update();
+}
+
+void HudVideoItem::setPitchAngle(qreal angle)
+{
+    if (m_pitchAngle == angle) return;
+    m_pitchAngle = angle;
+    emit attitudeChanged();
+    update();
+}
+
+void HudVideoItem::setPixelsPerDegree(qreal pixels)
+{
+    if (m_pixelsPerDegree == pixels || pixels <= 0) return;
+    m_pixelsPerDegree = pixels;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setGraticuleRadius(qreal radius)
+{
+    if (m_graticuleRadius == radius || radius <= 0) return;
+    m_graticuleRadius = radius;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setLineWidth(qreal width)
+{
+    if (m_lineWidth == width || width <= 0) return;
+    m_lineWidth = width;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setOverlayColor(const QColor & color)
+{
+    if (m_overlayColor == color) return;
+    m_overlayColor = color;
+    emit overlayChanged();
+    update();
+}
+
+void HudVideoItem::setStabilize(bool stabilize)
+{
+    if (m_stabilize == stabilize) return;
+    m_stabilize = stabilize;
+    m_smoothValid = false;
+    // The zoomed frame reaches past the item
+    setClip(stabilize);
+    emit stabilizeChanged();
+    update();
+}
+
+void HudVideoItem::setYawAngle(qreal angle)
+{
+    if (m_yawAngle == angle) return;
+    m_yawAngle = angle;
+    emit attitudeChanged();
+    if (m_stabilize) update();
+}
+
+void HudVideoItem::setFieldOfView(qreal degrees)
+{
+    if (m_fieldOfView == degrees || degrees <= 0 || degrees >= 180) return;
+    m_fieldOfView = degrees;
+    emit stabilizeChanged();
+    update();
+}
+
+void HudVideoItem::setStabilizeLimit(qreal degrees)
+{
+    if (m_stabilizeLimit == degrees || degrees < 0 || degrees > 30) return;
+    m_stabilizeLimit = degrees;
+    emit stabilizeChanged();
+    update();
+}
+
+void HudVideoItem::setLensCorrection(bool enabled)
+{
+    if (m_lensCorrection == enabled) return;
+    m_lensCorrection = enabled;
+    emit lensChanged();
+    update();
+}
+
+void HudVideoItem::setLensProfile(const QString &name)
+{
+    if (m_lensProfile.name == name) return;
+    m_lensProfile = LensProfile::load(name);
+    ++m_lensRevision;
+    emit lensChanged();
+    update();
+}
+
+// Render thread, the GUI thread is blocked meanwhile
+QSGNode* HudVideoItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    HUD_TRACE_SCOPE("HudVideoItem::updatePaintNode");
+    HudNode *root = static_cast<HudNode*>(oldNode);
+    if (root == NULL) root = new HudNode;
+
+    QSGNode *video = QGst::Quick::VideoItem::updatePaintNode(root->video, data);
+    if (video != root->video)
+    {
+        // A node the sink deleted has already detached itself
+        if (root->video != NULL && root->hasVideo(root->video))
+        {
+            root->source->removeChildNode(root->video);
+            delete root->video;
+        }
+        if (video != NULL) root->source->appendChildNode(video);
+        root->video = video;
+    }
+
+    // Checked every frame, the sink may have swapped its material or node
+    QSGGeometry::TexturedPoint2D corners[2];
+    QSGGeometryNode *textured = NULL;
+    if (m_lensCorrection && m_lensProfile.isValid())
+    {
+        textured = texturedVideo(video, &corners[0], &corners[1]);
+    }
+    if (textured != NULL)
+    {
+        if (root->lens == NULL)
+        {
+            root->lens = new QSGGeometryNode;
+            root->lens->setGeometry(createLensGrid());
+            root->lens->setFlag(QSGNode::OwnsGeometry);
+            root->stabilizer->appendChildNode(root->lens);
+            root->lensRevision = -1;
+        }
+        if (root->lensRevision != m_lensRevision || !sameCorner(root->lensCorners[0], corners[0])
+                || !sameCorner(root->lensCorners[1], corners[1]))
+        {
+            updateLensGrid(root->lens->geometry(), m_lensProfile, corners[0], corners[1]);
+            root->lensCorners[0] = corners[0];
+            root->lensCorners[1] = corners[1];
+            root->lensRevision = m_lensRevision;
+            root->lens->markDirty(QSGNode::DirtyGeometry);
+        }
+        // Owned by the sink's node
+        if (root->lens->material() != textured->material()) root->lens->setMaterial(textured->material());
+        if (root->lens->opaqueMaterial() != textured->opaqueMaterial()) root->lens->setOpaqueMaterial(textured->opaqueMaterial());
+        root->lens->markDirty(QSGNode::DirtyMaterial);
+        root->source->setOpacity(0);
+    }
+    else
+    {
+        if (root->lens != NULL)
+        {
+            root->stabilizer->removeChildNode(root->lens);
+            delete root->lens;
+            root->lens = NULL;
+        }
+        root->source->setOpacity(1);
+    }
+
+    QMatrix4x4 stabilization;
+    if (m_stabilize && video != NULL)
+    {
+        // Low pass the attitude per frame, the rest of it is the shake
+        qreal dt = m_smoothClock.isValid() ? m_smoothClock.restart() : 0;
+        if (!m_smoothClock.isValid()) m_smoothClock.start();
+        if (!m_smoothValid || dt > 10 * StabilizeTimeConstantMs)
+        {
+            m_smoothRoll = m_rollAngle;
+            m_smoothPitch = m_pitchAngle;
+            m_smoothYaw = m_yawAngle;
+            m_smoothValid = true;
+        }
+        else
+        {
+            qreal k = dt / (dt + StabilizeTimeConstantMs);
+            m_smoothRoll += k * (m_rollAngle - m_smoothRoll);
+            m_smoothPitch += k * (m_pitchAngle - m_smoothPitch);
+            m_smoothYaw += k * headingDelta(m_yawAngle, m_smoothYaw);
+        }
+        qreal limit = m_stabilizeLimit;
+        qreal roll = qBound(-limit, m_rollAngle - m_smoothRoll, limit);
+        qreal pitch = qBound(-limit, m_pitchAngle - m_smoothPitch, limit);
+        qreal yaw = qBound(-limit, headingDelta(m_yawAngle, m_smoothYaw), limit);
+
+        // Zoom so the frame still covers the item at the largest correction,
+        // constant so the picture does not pump
+        QRectF rect = boundingRect();
+        qreal pixelsPerDegree = rect.width() / m_fieldOfView;
+        qreal shortSide = qMax<qreal>(1, qMin(rect.width(), rect.height()));
+        qreal aspect = qMax(rect.width(), rect.height()) / shortSide;
+        qreal maxAngle = qDegreesToRadians(limit);
+        qreal zoom = qCos(maxAngle) + aspect * qSin(maxAngle) + 2 * limit * pixelsPerDegree / shortSide;
+
+        // Rolling right turns the picture left, pitching up moves it down
+        // and yawing right moves it left; undo each around the center
+        QPointF center = rect.center();
+        stabilization.translate(center.x() + yaw * pixelsPerDegree, center.y() - pitch * pixelsPerDegree);
+        stabilization.rotate(roll, 0, 0, 1);
+        stabilization.scale(zoom, zoom);
+        stabilization.translate(-center.x(), -center.y());
+    }
+    else
+    {
+        m_smoothValid = false;
+    }
+    if (root->stabilizer->matrix() != stabilization)
+    {
+        root->stabilizer->setMatrix(stabilization);
+    }
+
+    if (!m_overlay)
+    {
+        if (root->overlay != NULL)
+        {
+            root->removeChildNode(root->overlay);
+            delete root->overlay;
+            root->overlay = NULL;
+        }
+        return root;
+    }
+
+    if (root->overlay == NULL)
+    {
+        root->overlay = new QSGGeometryNode;
+        QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 4);
+        geometry->setDrawingMode(GL_TRIANGLE_STRIP);
+        root->overlay->setGeometry(geometry);
+        root->overlay->setFlag(QSGNode::OwnsGeometry);
+
+        QSGSimpleMaterial<HudOverlayState> *material = HudOverlayShader::createMaterial();
+        material->setFlag(QSGMaterial::Blending);
+        root->overlay->setMaterial(material);
+        root->overlay->setFlag(QSGNode::OwnsMaterial);
+        root->appendChildNode(root->overlay);
+    }
+
+    QRectF rect = boundingRect();
+    QSGGeometry::updateRectGeometry(root->overlay->geometry(), rect);
+
+    QSGSimpleMaterial<HudOverlayState> *material = static_cast<QSGSimpleMaterial<HudOverlayState>*>(root->overlay->material());
+    HudOverlayState *state = material->state();
+    qreal alpha = m_overlayColor.alphaF();
+    qreal roll = qDegreesToRadians(m_rollAngle);
+    state->color = QVector4D(m_overlayColor.redF() * alpha, m_overlayColor.greenF() * alpha, m_overlayColor.blueF() * alpha, alpha);
+    state->center = QVector2D(rect.center());
+    state->rotation = QVector2D(qCos(roll), qSin(roll));
+    state->enabled = QVector2D(m_rollEnabled ? 1 : 0, m_pitchEnabled ? 1 : 0);
+    state->pitchOffset = m_pitchAngle * m_pixelsPerDegree;
+    state->pixelsPerDegree = m_pixelsPerDegree;
+    state->radius = m_graticuleRadius;
+    state->lineWidth = m_lineWidth;
+    root->overlay->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+
+    return root;
+}
@@ -0,0 +1,159 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HudVideoItem_H
+#define HudVideoItem_H
+
+#include <QColor>
+#include <QElapsedTimer>
+#include <QGst/Quick/VideoItem>
+#include "LensProfile.h"
+
+/**
+ * @brief VideoItem that draws the attitude overlay in the same scene graph subtree as the video
+ *
+ * The horizon, pitch ladder, roll scale and crosshair are generated by one
+ * fragment shader on a single quad above the sink's video node, driven by
+ * the attitude uniforms. This replaces the stack of rotated Image and
+ * Rectangle items of RollPitchIndicator/PitchIndicator while video is shown,
+ * so every frame costs one extra batch instead of one per graticule element.
+ *
+ * With stabilize set the video node hangs below a transform node that
+ * counter-rotates and shifts the frame by how far the attitude is off its
+ * low passed value, so a fixed camera's shake is taken out while turns
+ * still show. The frame is zoomed by a constant factor that keeps the
+ * largest correction inside the item. The attitude should be aligned to
+ * the frame on screen (PrimaryFlightDisplayQML::alignTelemetry), else the
+ * correction lags the shake by the video latency.
+ *
+ * With lensCorrection set and a lensProfile from the settings, the sink's
+ * quad is hidden and its material drawn on a LensGridSize square grid
+ * whose texture coordinates come from the profile. The remap is worked out
+ * per vertex only when the profile or the video rectangle changes, so the
+ * correction costs no fragment work and works with every sink format.
+ */
+class HudVideoItem : public QGst::Quick::VideoItem
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(bool overlay READ getOverlay WRITE setOverlay NOTIFY overlayChanged)
+    Q_PROPERTY(bool rollEnabled READ getRollEnabled WRITE setRollEnabled NOTIFY overlayChanged)
+    Q_PROPERTY(bool pitchEnabled READ getPitchEnabled WRITE setPitchEnabled NOTIFY overlayChanged)
+    Q_PROPERTY(qreal rollAngle READ getRollAngle WRITE setRollAngle NOTIFY attitudeChanged)
+    Q_PROPERTY(qreal pitchAngle READ getPitchAngle WRITE setPitchAngle NOTIFY attitudeChanged)
+    Q_PROPERTY(qreal pixelsPerDegree READ getPixelsPerDegree WRITE setPixelsPerDegree NOTIFY overlayChanged)
+    Q_PROPERTY(qreal graticuleRadius READ getGraticuleRadius WRITE setGraticuleRadius NOTIFY overlayChanged)
+    Q_PROPERTY(qreal lineWidth READ getLineWidth WRITE setLineWidth NOTIFY overlayChanged)
+    Q_PROPERTY(QColor overlayColor READ getOverlayColor WRITE setOverlayColor NOTIFY overlayChanged)
+    Q_PROPERTY(bool stabilize READ getStabilize WRITE setStabilize NOTIFY stabilizeChanged)
+    Q_PROPERTY(qreal yawAngle READ getYawAngle WRITE setYawAngle NOTIFY attitudeChanged)
+    Q_PROPERTY(qreal fieldOfView READ getFieldOfView WRITE setFieldOfView NOTIFY stabilizeChanged)
+    Q_PROPERTY(qreal stabilizeLimit READ getStabilizeLimit WRITE setStabilizeLimit NOTIFY stabilizeChanged)
+    Q_PROPERTY(bool lensCorrection READ getLensCorrection WRITE setLensCorrection NOTIFY lensChanged)
+    Q_PROPERTY(QString lensProfile READ getLensProfile WRITE setLensProfile NOTIFY lensChanged)
+    Q_PROPERTY(QStringList lensProfiles READ getLensProfiles NOTIFY lensChanged)
+
+    enum { StabilizeTimeConstantMs = 300, LensGridSize = 32 };
+
+    explicit HudVideoItem(QQuickItem *parent = 0);
+
+    /** @brief Draw the attitude overlay at all */
+    bool getOverlay() { return m_overlay; }
+    void setOverlay(bool overlay);
+
+    /** @brief Roll scale, roll pointer and crosshair */
+    bool getRollEnabled() { return m_rollEnabled; }
+    void setRollEnabled(bool enabled);
+
+    /** @brief Horizon line and pitch ladder */
+    bool getPitchEnabled() { return m_pitchEnabled; }
+    void setPitchEnabled(bool enabled);
+
+    /** @brief Degrees, same sign as RollPitchIndicator */
+    qreal getRollAngle() { return m_rollAngle; }
+    void setRollAngle(qreal angle);
+    qreal getPitchAngle() { return m_pitchAngle; }
+    void setPitchAngle(qreal angle);
+
+    qreal getPixelsPerDegree() { return m_pixelsPerDegree; }
+    void setPixelsPerDegree(qreal pixels);
+    qreal getGraticuleRadius() { return m_graticuleRadius; }
+    void setGraticuleRadius(qreal radius);
+    qreal getLineWidth() { return m_lineWidth; }
+    void setLineWidth(qreal width);
+    QColor getOverlayColor() { return m_overlayColor; }
+    void setOverlayColor(const QColor & color);
+
+    /** @brief Counter the airframe's shake in the video */
+    bool getStabilize() { return m_stabilize; }
+    void setStabilize(bool stabilize);
+    /** @brief Degrees, only used by the stabilization */
+    qreal getYawAngle() { return m_yawAngle; }
+    void setYawAngle(qreal angle);
+    /** @brief Horizontal field of view of the camera in degrees */
+    qreal getFieldOfView() { return m_fieldOfView; }
+    void setFieldOfView(qreal degrees);
+    /** @brief Largest correction in degrees, also sets the zoom */
+    qreal getStabilizeLimit() { return m_stabilizeLimit; }
+    void setStabilizeLimit(qreal degrees);
+
+    /** @brief Undo the lens distortion of lensProfile */
+    bool getLensCorrection() { return m_lensCorrection; }
+    void setLensCorrection(bool enabled);
+    /** @brief Name of a LensProfile in the settings */
+    QString getLensProfile() { return m_lensProfile.name; }
+    void setLensProfile(const QString &name);
+    QStringList getLensProfiles() { return LensProfile::names(); }
+
+signals:
+    void overlayChanged();
+    void attitudeChanged();
+    void stabilizeChanged();
+    void lensChanged();
+
+protected:
+    virtual QSGNode* updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+
+private:
+    bool m_overlay;
+    bool m_rollEnabled;
+    bool m_pitchEnabled;
+    qreal m_rollAngle;
+    qreal m_pitchAngle;
+    qreal m_pixelsPerDegree;
+    qreal m_graticuleRadius;
+    qreal m_lineWidth;
+    QColor m_overlayColor;
+
+    bool m_stabilize;
+    qreal m_yawAngle;
+    qreal m_fieldOfView;
+    qreal m_stabilizeLimit;
+    // low passed attitude, updated on the render thread while the GUI thread waits
+    qreal m_smoothRoll;
+    qreal m_smoothPitch;
+    qreal m_smoothYaw;
+    bool m_smoothValid;
+    QElapsedTimer m_smoothClock;
+
+    bool m_lensCorrection;
+    LensProfile m_lensProfile;
+    int m_lensRevision;     ///< Changes with the profile, the grid is rebuilt
+};
+
+#endif // HudVideoItem_H
@@ -0,0 +1,353 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ImpairedLink
+ *          See ImpairedLink.h
+ *
+ */
+
+#include "ImpairedLink.h"
+#include "QsLog.h"
+#include "GroundClock.h"
+#include <QStringList>
+#include <cmath>
+
+// A reordered packet is held back this long beyond its due time, at least
+static const qint64 MinReorderDelayUs = 5000;
+
+bool LinkImpairment::Settings::isNull() const
+{
+    return latencyMs <= 0 && jitterMs <= 0 && lossPercent <= 0 && bitErrorRate <= 0
+            && reorderPercent <= 0 && bandwidth <= 0;
+}
+
+LinkImpairment::Settings LinkImpairment::Settings::fromString(const QString &spec, bool *ok)
+{
+    Settings settings;
+    bool valid = true;
+    foreach (const QString &item, spec.split(',', QString::SkipEmptyParts))
+    {
+        QString key = item.section('=', 0, 0).trimmed();
+        QString value = item.section('=', 1).trimmed();
+        bool number = false;
+        double parsed = value.toDouble(&number);
+        valid &= number && parsed >= 0;
+        if (key == "latency") settings.latencyMs = static_cast<int>(parsed);
+        else if (key == "jitter") settings.jitterMs = static_cast<int>(parsed);
+        else if (key == "loss") settings.lossPercent = qMin(parsed, 100.0);
+        else if (key == "ber") settings.bitErrorRate = qMin(parsed, 1.0);
+        else if (key == "reorder") settings.reorderPercent = qMin(parsed, 100.0);
+        else if (key == "bandwidth") settings.bandwidth = static_cast<qint64>(parsed);
+        else if (key == "packet") settings.packetBytes = qMax(1, static_cast<int>(parsed));
+        else valid = false;
+    }
+    if (ok)
+    {
+        *ok = valid;
+    }
+    return settings;
+}
+
+QString LinkImpairment::Settings::toString() const
+{
+    return QString("latency=%1,jitter=%2,loss=%3,ber=%4,reorder=%5,bandwidth=%6,packet=%7")
+            .arg(latencyMs).arg(jitterMs).arg(lossPercent).arg(bitErrorRate)
+            .arg(reorderPercent).arg(bandwidth).arg(packetBytes);
+}
+
+LinkImpairment::LinkImpairment(quint32 seed) :
+    m_state(seed ? seed : 1),
+    m_bitsToError(-1),
+    m_lineFreeUs(0),
+    m_lastDueUs(0)
+{
+}
+
+void LinkImpairment::setSettings(const Settings &settings)
+{
+    m_settings = settings;
+    m_settings.packetBytes = qMax(1, settings.packetBytes);
+    m_bitsToError = nextBitError();
+}
+
+quint32 LinkImpairment::random()
+{
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+}
+
+double LinkImpairment::uniform()
+{
+    return random() / 4294967296.0;
+}
+
+qint64 LinkImpairment::nextBitError()
+{
+    double p = m_settings.bitErrorRate;
+    if (p <= 0)
+    {
+        return -1;
+    }
+    if (p >= 1)
+    {
+        return 0;
+    }
+    // Skip straight to the next error instead of rolling for every bit
+    double u = qMax(uniform(), 1e-12);
+    return static_cast<qint64>(std::log(u) / std::log(1.0 - p));
+}
+
+void LinkImpairment::corrupt(QByteArray *data)
+{
+    if (m_bitsToError < 0)
+    {
+        return;
+    }
+    qint64 bits = static_cast<qint64>(data->size()) * 8;
+    bool corrupted = false;
+    qint64 position = m_bitsToError;
+    while (position < bits)
+    {
+        (*data)[static_cast<int>(position / 8)] = (*data)[static_cast<int>(position / 8)] ^ (1 << (position % 8));
+        corrupted = true;
+        position += 1 + nextBitError();
+    }
+    m_bitsToError = position - bits;
+    if (corrupted)
+    {
+        m_stats.corrupted++;
+    }
+}
+
+void LinkImpairment::process(const QByteArray &data, qint64 nowUs, QList<Packet> *out)
+{
+    for (int offset = 0; offset < data.size(); offset += m_settings.packetBytes)
+    {
+        Packet packet;
+        packet.data = data.mid(offset, m_settings.packetBytes);
+        m_stats.packets++;
+        m_stats.bytes += packet.data.size();
+
+        // The line is busy with whatever went before, lost packets used it too
+        qint64 sentUs = nowUs;
+        if (m_settings.bandwidth > 0)
+        {
+            sentUs = qMax(nowUs, m_lineFreeUs) + packet.data.size() * Q_INT64_C(8000000) / m_settings.bandwidth;
+            m_lineFreeUs = sentUs;
+        }
+        if (m_settings.lossPercent > 0 && uniform() * 100 < m_settings.lossPercent)
+        {
+            m_stats.dropped++;
+            continue;
+        }
+        corrupt(&packet.data);
+
+        qint64 dueUs = sentUs + m_settings.latencyMs * Q_INT64_C(1000);
+        if (m_settings.jitterMs > 0)
+        {
+            dueUs += static_cast<qint64>(uniform() * m_settings.jitterMs * 1000);
+        }
+        if (m_settings.reorderPercent > 0 && uniform() * 100 < m_settings.reorderPercent)
+        {
+            // Behind the next few packets, without holding them back
+            packet.dueUs = qMax(dueUs, m_lastDueUs) + qMax(MinReorderDelayUs, m_settings.jitterMs * Q_INT64_C(2000));
+            m_stats.reordered++;
+        }
+        else
+        {
+            packet.dueUs = qMax(dueUs, m_lastDueUs);
+            m_lastDueUs = packet.dueUs;
+        }
+        out->append(packet);
+    }
+}
+
+ImpairedLink::ImpairedLink(LinkInterface *link, quint32 seed) :
+    m_link(link),
+    m_sequence(0),
+    m_stopping(false)
+{
+    m_impairment[Received] = LinkImpairment(seed);
+    m_impairment[Sent] = LinkImpairment(seed * 2654435761u + 1);
+    m_queued[Received] = 0;
+    m_queued[Sent] = 0;
+    m_clock.start();
+    // Reads are picked up on the wrapped link's thread and released on ours
+    QObject::connect(link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)),
+                     this, SLOT(innerBytesReceived(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    QObject::connect(link, SIGNAL(connected()), this, SLOT(innerConnected()));
+    QObject::connect(link, SIGNAL(disconnected()), this, SLOT(innerDisconnected()));
+    QObject::connect(link, SIGNAL(error(LinkInterface*,QString)), this, SLOT(innerError(LinkInterface*,QString)));
+    QObject::connect(link, SIGNAL(nameChanged(QString)), this, SIGNAL(nameChanged(QString)));
+    QLOG_INFO() << "Impairment simulator on link" << link->getId();
+    start(QThread::HighPriority);
+}
+
+ImpairedLink::~ImpairedLink()
+{
+    QObject::disconnect(m_link, 0, this, 0);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    wait();
+    delete m_link;
+}
+
+void ImpairedLink::setImpairment(Direction direction, const LinkImpairment::Settings &settings)
+{
+    QMutexLocker locker(&m_mutex);
+    m_impairment[direction].setSettings(settings);
+    QLOG_INFO() << "Link" << getId() << (direction == Received ? "received" : "sent") << "impairment" << settings.toString();
+}
+
+LinkImpairment::Settings ImpairedLink::impairment(Direction direction) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_impairment[direction].settings();
+}
+
+LinkImpairment::Stats ImpairedLink::impairmentStats(Direction direction) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_impairment[direction].stats();
+}
+
+qint64 ImpairedLink::queuedBytes(Direction direction) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queued[direction];
+}
+
+void ImpairedLink::writeBytes(const char *bytes, qint64 length)
+{
+    submit(Sent, QByteArray(bytes, static_cast<int>(length)));
+}
+
+void ImpairedLink::innerBytesReceived(LinkInterface *link, QByteArray data)
+{
+    Q_UNUSED(link);
+    submit(Received, data);
+}
+
+void ImpairedLink::submit(Direction direction, const QByteArray &data)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_impairment[direction].settings().isNull() && m_queued[direction] == 0)
+    {
+        // Nothing to simulate and nothing to overtake, pass it on right here
+        locker.unlock();
+        Pending pending;
+        pending.direction = direction;
+        pending.data = data;
+        deliver(pending);
+        return;
+    }
+    QList<LinkImpairment::Packet> packets;
+    m_impairment[direction].process(data, nowUs(), &packets);
+    bool wake = false;
+    foreach (const LinkImpairment::Packet &packet, packets)
+    {
+        Pending pending;
+        pending.direction = direction;
+        pending.data = packet.data;
+        QPair<qint64, quint32> key(packet.dueUs, m_sequence++);
+        wake |= m_pending.isEmpty() || key < m_pending.firstKey();
+        m_pending.insert(key, pending);
+        m_queued[direction] += packet.data.size();
+    }
+    if (wake)
+    {
+        m_wake.wakeOne();
+    }
+}
+
+void ImpairedLink::deliver(const Pending &pending)
+{
+    if (pending.direction == Sent)
+    {
+        m_link->writeBytes(pending.data.constData(), pending.data.size());
+        outTraffic.add(pending.data.size(), 1, GroundClock::msecs());
+        return;
+    }
+    inTraffic.add(pending.data.size(), 1, GroundClock::msecs());
+    emit bytesReceived(this, pending.data);
+}
+
+void ImpairedLink::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping)
+    {
+        if (m_pending.isEmpty())
+        {
+            m_wake.wait(&m_mutex);
+            continue;
+        }
+        qint64 waitUs = m_pending.firstKey().first - nowUs();
+        if (waitUs > 0)
+        {
+            m_wake.wait(&m_mutex, static_cast<unsigned long>(qMax(Q_INT64_C(1), waitUs / 1000)));
+            continue;
+        }
+        // Everything due goes out in one go, unlocked so the links never wait on us
+        QList<Pending> due;
+        qint64 now = nowUs();
+        while (!m_pending.isEmpty() && m_pending.firstKey().first <= now)
+        {
+            Pending pending = m_pending.take(m_pending.firstKey());
+            m_queued[pending.direction] -= pending.data.size();
+            due.append(pending);
+        }
+        locker.unlock();
+        foreach (const Pending &pending, due)
+        {
+            deliver(pending);
+        }
+        locker.relock();
+    }
+}
+
+void ImpairedLink::innerConnected()
+{
+    emit connected(true);
+    emit connected(this);
+    emit connected();
+}
+
+void ImpairedLink::innerDisconnected()
+{
+    emit connected(false);
+    emit disconnected(this);
+    emit disconnected();
+}
+
+void ImpairedLink::innerError(LinkInterface *link, QString message)
+{
+    Q_UNUSED(link);
+    emit error(this, message);
+}
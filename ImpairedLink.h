@@ -0,0 +1,186 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ImpairedLink
+ *          Network impairment simulator. Wraps any link and puts latency,
+ *          jitter, packet loss, bit errors, reordering and a bandwidth cap
+ *          between it and the rest of the stack, in either direction. The
+ *          impairments come from a seeded generator, so a run with the same
+ *          settings and traffic degrades the same way every time.
+ *
+ *          LinkImpairment is the model of one direction on its own, the
+ *          benchmark uses it without a link or a clock.
+ *
+ */
+
+#ifndef IMPAIREDLINK_H
+#define IMPAIREDLINK_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QPointer>
+#include "LinkInterface.h"
+
+class LinkImpairment
+{
+public:
+    struct Settings
+    {
+        int latencyMs;
+        int jitterMs;           ///< Uniform 0..jitterMs on top of the latency, order is kept
+        double lossPercent;     ///< Packets dropped
+        double bitErrorRate;    ///< Probability of each bit being flipped
+        double reorderPercent;  ///< Packets held back behind the ones after them
+        qint64 bandwidth;       ///< Bits per second, 0 for no cap
+        int packetBytes;        ///< The stream is cut into packets this long, as a radio would
+
+        Settings() : latencyMs(0), jitterMs(0), lossPercent(0), bitErrorRate(0), reorderPercent(0),
+            bandwidth(0), packetBytes(DefaultPacketBytes) { }
+        /** @brief True if nothing is impaired */
+        bool isNull() const;
+        /** @brief "latency=120,jitter=40,loss=2,ber=1e-6,reorder=1,bandwidth=57600,packet=64", ok false on a bad key */
+        static Settings fromString(const QString &spec, bool *ok = 0);
+        QString toString() const;
+    };
+
+    struct Stats
+    {
+        quint64 packets;
+        quint64 bytes;
+        quint64 dropped;
+        quint64 corrupted;      ///< Packets with at least one flipped bit
+        quint64 reordered;
+        Stats() : packets(0), bytes(0), dropped(0), corrupted(0), reordered(0) { }
+    };
+
+    struct Packet
+    {
+        qint64 dueUs;           ///< When it comes out, on the clock process() was given
+        QByteArray data;
+    };
+
+    enum { DefaultPacketBytes = 252 };  ///< A SiK radio frame
+
+    explicit LinkImpairment(quint32 seed = 1);
+
+    void setSettings(const Settings &settings);
+    Settings settings() const { return m_settings; }
+    Stats stats() const { return m_stats; }
+
+    /** @brief Cut data into packets, drop and corrupt some, and append the rest with their due time */
+    void process(const QByteArray &data, qint64 nowUs, QList<Packet> *out);
+
+private:
+    quint32 random();
+    /** @brief Uniform in [0, 1) */
+    double uniform();
+    /** @brief Bits until the next flipped one, geometric for the bit error rate */
+    qint64 nextBitError();
+    void corrupt(QByteArray *data);
+
+    Settings m_settings;
+    Stats m_stats;
+    quint32 m_state;            ///< xorshift32
+    qint64 m_bitsToError;       ///< -1 without bit errors
+    qint64 m_lineFreeUs;        ///< When the bandwidth capped line has sent everything before
+    qint64 m_lastDueUs;         ///< Packets in order leave no earlier than the previous one
+};
+
+class ImpairedLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    enum Direction { Received, Sent };
+
+    /** @brief Takes ownership of link, which keeps its ID */
+    explicit ImpairedLink(LinkInterface *link, quint32 seed = 1);
+    ~ImpairedLink();
+
+    LinkInterface *inner() const { return m_link; }
+
+    void setImpairment(Direction direction, const LinkImpairment::Settings &settings);
+    LinkImpairment::Settings impairment(Direction direction) const;
+    LinkImpairment::Stats impairmentStats(Direction direction) const;
+    /** @brief Bytes held back by latency or the bandwidth cap */
+    qint64 queuedBytes(Direction direction) const;
+
+    void disableTimeouts() { m_link->disableTimeouts(); }
+    void enableTimeouts() { m_link->enableTimeouts(); }
+    void requestReset() { m_link->requestReset(); }
+
+    int getId() const { return m_link->getId(); }
+    QString getName() const { return m_link->getName(); }
+    bool isConnected() const { return m_link->isConnected(); }
+    qint64 getConnectionSpeed() const { return m_link->getConnectionSpeed(); }
+    qint64 bytesAvailable() { return m_link->bytesAvailable(); }
+    LinkType getLinkType() { return SIM_LINK; }
+    bool isWriteCongested() const { return m_link->isWriteCongested(); }
+
+public slots:
+    bool connect() { return m_link->connect(); }
+    bool disconnect() { return m_link->disconnect(); }
+    /** @brief Through the sent impairment to the wrapped link */
+    void writeBytes(const char *bytes, qint64 length);
+
+protected:
+    /** @brief Releases packets when they are due */
+    void run();
+
+protected slots:
+    void readBytes() { }
+
+private slots:
+    /** @brief The wrapped link's reads, on its thread */
+    void innerBytesReceived(LinkInterface *link, QByteArray data);
+    void innerConnected();
+    void innerDisconnected();
+    void innerError(LinkInterface *link, QString message);
+
+private:
+    struct Pending
+    {
+        Direction direction;
+        QByteArray data;
+    };
+    void submit(Direction direction, const QByteArray &data);
+    void deliver(const Pending &pending);
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    LinkInterface *m_link;
+    QElapsedTimer m_clock;
+    mutable QMutex m_mutex;             ///< Guards the members below
+    QWaitCondition m_wake;
+    LinkImpairment m_impairment[2];
+    QMap<QPair<qint64, quint32>, Pending> m_pending;   ///< By due time then arrival, both directions
+    quint32 m_sequence;
+    qint64 m_queued[2];
+    bool m_stopping;
+};
+
+#endif // IMPAIREDLINK_H
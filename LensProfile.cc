@@ -0,0 +1,147 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief LensProfile
+ *          See LensProfile.h
+ *
+ */
+
+#include "LensProfile.h"
+#include "SettingsStore.h"
+#include <qmath.h>
+
+static const char *const ProfilesGroup = "lensProfiles";
+
+LensProfile::LensProfile()
+    : model(None),
+      fx(0.5),
+      fy(0.5),
+      cx(0.5),
+      cy(0.5),
+      zoom(1)
+{
+    for (int i = 0; i < 4; ++i) k[i] = 0;
+}
+
+QString LensProfile::modelName(Model model)
+{
+    switch (model)
+    {
+    case Radial: return "radial";
+    case Fisheye: return "fisheye";
+    default: return "none";
+    }
+}
+
+LensProfile::Model LensProfile::modelFromName(const QString &name)
+{
+    if (name == "radial") return Radial;
+    if (name == "fisheye") return Fisheye;
+    return None;
+}
+
+QStringList LensProfile::names()
+{
+    StoredSettings settings;
+    settings.beginGroup(ProfilesGroup);
+    QStringList names = settings.childGroups();
+    settings.endGroup();
+    return names;
+}
+
+LensProfile LensProfile::load(const QString &name)
+{
+    LensProfile profile;
+    profile.name = name;
+    if (name.isEmpty()) return profile;
+
+    StoredSettings settings;
+    settings.beginGroup(ProfilesGroup);
+    settings.beginGroup(name);
+    profile.model = modelFromName(settings.value("model").toString());
+    profile.fx = settings.value("fx", profile.fx).toDouble();
+    profile.fy = settings.value("fy", profile.fy).toDouble();
+    profile.cx = settings.value("cx", profile.cx).toDouble();
+    profile.cy = settings.value("cy", profile.cy).toDouble();
+    for (int i = 0; i < 4; ++i)
+    {
+        profile.k[i] = settings.value(QString("k%1").arg(i + 1), 0).toDouble();
+    }
+    profile.zoom = settings.value("zoom", profile.zoom).toDouble();
+    settings.endGroup();
+    settings.endGroup();
+    return profile;
+}
+
+void LensProfile::save() const
+{
+    if (name.isEmpty()) return;
+    StoredSettings settings;
+    settings.beginGroup(ProfilesGroup);
+    settings.beginGroup(name);
+    settings.setValue("model", modelName(model));
+    settings.setValue("fx", fx);
+    settings.setValue("fy", fy);
+    settings.setValue("cx", cx);
+    settings.setValue("cy", cy);
+    for (int i = 0; i < 4; ++i)
+    {
+        settings.setValue(QString("k%1").arg(i + 1), k[i]);
+    }
+    settings.setValue("zoom", zoom);
+    settings.endGroup();
+    settings.endGroup();
+}
+
+QPointF LensProfile::sourcePoint(qreal x, qreal y) const
+{
+    if (!isValid()) return QPointF(x, y);
+
+    // Ray of the ideal pinhole camera, the corrected picture keeps the
+    // principal point and the focal length over zoom
+    qreal u = (x - cx) / (fx * zoom);
+    qreal v = (y - cy) / (fy * zoom);
+    qreal r2 = u * u + v * v;
+    qreal scale;
+    if (model == Radial)
+    {
+        scale = 1 + r2 * (k[0] + r2 * (k[1] + r2 * k[2]));
+    }
+    else
+    {
+        qreal r = qSqrt(r2);
+        if (r < 1e-9)
+        {
+            scale = 1;
+        }
+        else
+        {
+            qreal theta = qAtan(r);
+            qreal theta2 = theta * theta;
+            qreal thetaD = theta * (1 + theta2 * (k[0] + theta2 * (k[1] + theta2 * (k[2] + theta2 * k[3]))));
+            scale = thetaD / r;
+        }
+    }
+    return QPointF(cx + fx * u * scale, cy + fy * v * scale);
+}
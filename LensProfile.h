@@ -0,0 +1,77 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief LensProfile
+ *          Distortion model of a camera, as calibrated with OpenCV, kept
+ *          in the settings under lensProfiles/<name>. The focal lengths and
+ *          the principal point are fractions of the image width and height,
+ *          so one profile serves every resolution the camera streams at.
+ *          sourcePoint() maps a point of the corrected picture to where it
+ *          lies in the camera image; HudVideoItem evaluates it once per
+ *          vertex of a grid when the profile or the video size changes.
+ *
+ */
+
+#ifndef LENSPROFILE_H
+#define LENSPROFILE_H
+
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+
+class LensProfile
+{
+public:
+    enum Model {
+        None,       ///< No correction
+        Radial,     ///< Brown, k1..k3, cv::undistort
+        Fisheye     ///< Equidistant, k1..k4, cv::fisheye
+    };
+
+    LensProfile();
+
+    /** @brief A profile the settings do not know is None */
+    static LensProfile load(const QString &name);
+    static QStringList names();
+    void save() const;
+
+    bool isValid() const { return model != None && fx > 0 && fy > 0 && zoom > 0; }
+
+    /** @brief x, y 0..1 over the corrected picture, the result 0..1 over the camera image */
+    QPointF sourcePoint(qreal x, qreal y) const;
+
+    static QString modelName(Model model);
+    static Model modelFromName(const QString &name);
+
+    QString name;
+    Model model;
+    qreal fx;       ///< Focal length over the image width
+    qreal fy;       ///< Over the height
+    qreal cx;       ///< Principal point, 0..1
+    qreal cy;
+    qreal k[4];
+    qreal zoom;     ///< Above 1 crops the corners the correction pulls in
+};
+
+#endif // LENSPROFILE_H
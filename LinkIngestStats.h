@@ -0,0 +1,137 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief LinkIngestStats
+ *          Parser counters of one link. The ingest thread is the only writer and
+ *          updates them with relaxed atomics; LinkManager samples them once a
+ *          second on the UI thread to derive the per second rates.
+ *
+ */
+
+#ifndef LINKINGESTSTATS_H
+#define LINKINGESTSTATS_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+class LinkIngestStats
+{
+public:
+    struct Snapshot
+    {
+        quint32 bytes;
+        quint32 frames;
+        quint32 crcErrors;
+        quint32 framingErrors;
+        quint32 resyncs;
+        quint32 nonMavlinkBytes;
+        quint32 mavlink2Frames;
+        quint32 unsupportedFrames;  ///< v2 frames with a message ID or flag we cannot decode
+        double bytesPerSecond;
+        double framesPerSecond;
+        double errorsPerSecond;
+        Snapshot() :
+            bytes(0), frames(0), crcErrors(0), framingErrors(0), resyncs(0), nonMavlinkBytes(0),
+            mavlink2Frames(0), unsupportedFrames(0),
+            bytesPerSecond(0), framesPerSecond(0), errorsPerSecond(0) { }
+    };
+
+    LinkIngestStats() :
+        mavlink09Count(0),
+        nonmavlinkCount(0),
+        decodedFirstPacket(false),
+        warnedUser(false),
+        checkedUserNonMavlink(false),
+        warnedUserNonMavlink(false),
+        mavlink2(false)
+    {
+    }
+
+    // Ingest thread
+    void addBytes(int count) { m_bytes.fetchAndAddRelaxed(count); }
+    void addFrame() { m_frames.fetchAndAddRelaxed(1); }
+    void addCrcError() { m_crcErrors.fetchAndAddRelaxed(1); }
+    void addFramingError() { m_framingErrors.fetchAndAddRelaxed(1); }
+    void addResync() { m_resyncs.fetchAndAddRelaxed(1); }
+    void addNonMavlinkBytes(int count) { m_nonMavlinkBytes.fetchAndAddRelaxed(count); }
+    void addMavlink2Frame() { m_mavlink2Frames.fetchAndAddRelaxed(1); }
+    void addUnsupportedFrame() { m_unsupportedFrames.fetchAndAddRelaxed(1); }
+
+    /** @brief Read the totals and the rates since the previous sample. UI thread only */
+    Snapshot sample()
+    {
+        Snapshot now;
+        now.bytes = m_bytes.load();
+        now.frames = m_frames.load();
+        now.crcErrors = m_crcErrors.load();
+        now.framingErrors = m_framingErrors.load();
+        now.resyncs = m_resyncs.load();
+        now.nonMavlinkBytes = m_nonMavlinkBytes.load();
+        now.mavlink2Frames = m_mavlink2Frames.load();
+        now.unsupportedFrames = m_unsupportedFrames.load();
+        if (m_clock.isValid())
+        {
+            double seconds = m_clock.restart() / 1000.0;
+            if (seconds > 0)
+            {
+                // Unsigned differences stay correct when a total wraps
+                now.bytesPerSecond = quint32(now.bytes - m_last.bytes) / seconds;
+                now.framesPerSecond = quint32(now.frames - m_last.frames) / seconds;
+                now.errorsPerSecond = quint32(now.crcErrors + now.framingErrors
+                                              - m_last.crcErrors - m_last.framingErrors) / seconds;
+            }
+        }
+        else
+        {
+            m_clock.start();
+        }
+        m_last = now;
+        return now;
+    }
+
+    // Link detection heuristics, touched by the ingest thread only
+    int mavlink09Count;
+    int nonmavlinkCount;
+    bool decodedFirstPacket;
+    bool warnedUser;
+    bool checkedUserNonMavlink;
+    bool warnedUserNonMavlink;
+    bool mavlink2;            ///< A v2 frame has been seen on the link
+    QByteArray partial;       ///< Start of a v2 frame that continues in the next read
+
+private:
+    QAtomicInt m_bytes;
+    QAtomicInt m_frames;
+    QAtomicInt m_crcErrors;
+    QAtomicInt m_framingErrors;
+    QAtomicInt m_resyncs;
+    QAtomicInt m_nonMavlinkBytes;
+    QAtomicInt m_mavlink2Frames;
+    QAtomicInt m_unsupportedFrames;
+    Snapshot m_last;
+    QElapsedTimer m_clock;
+};
+
+#endif // LINKINGESTSTATS_H
@@ -37,18 +37,72 @@ This file is part of the APM_PLANNER project
 #include "UASManager1.h"
 #include "UDPLink1.h"
 #include "TCPLink1.h"
-#include <QSettings>
+#include "TlogReplayLink.h"
+#include "TlogWriter.h"
+#include "ImpairedLink.h"
+#include "GroundClock.h"
+#include "EventLoopMonitor.h"
+#ifdef Q_OS_ANDROID
+#include "AndroidSerialLink.h"
+#include "BluetoothLink.h"
+#endif
+#include "SettingsStore.h"
+#include <QTimer>
 #include "UASObject.h"
+#include "SwarmModel.h"
+#include "MAVLinkDispatcher.h"
+#include "MAVLinkSender.h"
+#include "MAVLinkRouter.h"
+#include "MAVLinkFusion.h"
+#include "MAVLinkLatencyTracer.h"
+
+// What a vehicle that is not on the HUD still handles in swarm mode: link state, text, parameters, commands and missions
+static const int swarmVehicleMessages[] = {
+    MAVLINK_MSG_ID_HEARTBEAT,
+    MAVLINK_MSG_ID_SYS_STATUS,
+    MAVLINK_MSG_ID_STATUSTEXT,
+    MAVLINK_MSG_ID_PARAM_VALUE,
+    MAVLINK_MSG_ID_COMMAND_ACK,
+    MAVLINK_MSG_ID_MISSION_COUNT,
+    MAVLINK_MSG_ID_MISSION_ITEM,
+    MAVLINK_MSG_ID_MISSION_REQUEST,
+    MAVLINK_MSG_ID_MISSION_ACK,
+    -1
+};
+
+// Vehicles only see their own system's traffic. Each registers UAS's handler
+// and those of its autopilot for the message ids that autopilot adds.
+static void subscribeVehicle(MAVLinkProtocol *mavlink, UASInterface *mav, bool full = true)
+{
+    mav->subscribe(mavlink->dispatcher(), full ? 0 : swarmVehicleMessages);
+}
 
 LinkManager::LinkManager(QObject *parent) :
     QObject(parent)
 {
+    memset(m_uasById, 0, sizeof(m_uasById));
     m_mavlinkLoggingEnabled = true;
+    m_compressedLogging = false;
+    m_swarmMode = false;
+    m_focusedSysid = -1;
     m_mavlinkDecoder = new MAVLinkDecoder(this);
+    m_reconnector = new LinkReconnector(this);
+    connect(m_reconnector,SIGNAL(attempt(int)),this,SLOT(reconnectLink(int)));
+    connect(m_reconnector,SIGNAL(stateChanged(int,int,int)),this,SIGNAL(linkStateChanged(int,int,int)));
     m_mavlinkProtocol = new MAVLinkProtocol();
     m_mavlinkProtocol->setConnectionManager(this);
-    connect(m_mavlinkProtocol,SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)),m_mavlinkDecoder,SLOT(receiveMessage(LinkInterface*,mavlink_message_t)));
+    m_mavlinkProtocol->dispatcher()->subscribe(MAVLinkDispatcher::AnySystem, MAVLinkDispatcher::AnyMessage,
+                                               &MAVLinkDispatcher::callRef<MAVLinkDecoder, &MAVLinkDecoder::receiveMessageRef>, m_mavlinkDecoder);
+    m_swarmModel = new SwarmModel(this);
+    m_swarmModel->subscribe(m_mavlinkProtocol->dispatcher());
+    connect(UASManager::instance(),SIGNAL(activeUASSet(UASInterface*)),this,SLOT(focusVehicle(UASInterface*)));
     connect(m_mavlinkProtocol,SIGNAL(protocolStatusMessage(QString,QString)),this,SLOT(protocolStatusMessageRec(QString,QString)));
+    connect(m_mavlinkProtocol,SIGNAL(linkResetRequested(int)),this,SLOT(linkResetRequested(int)));
+    connect(m_mavlinkProtocol->latencyProbe(),SIGNAL(roundTripTimeChanged(int,int,double)),
+            m_mavlinkDecoder,SLOT(setRoundTripTime(int,int,double)));
+    m_ingestStatsTimer = new QTimer(this);
+    connect(m_ingestStatsTimer,SIGNAL(timeout()),this,SLOT(sampleIngestStats()));
+    m_ingestStatsTimer->start(1000);
     loadSettings();
     //Check to see if we have a single UDP connection, since they are the defaults
 
@@ -84,20 +138,43 @@ LinkManager::~LinkManager()
 
 void LinkManager::loadSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup("LINKMANAGER");
     m_mavlinkLoggingEnabled = settings.value("LOGGING",true).toBool();
+    m_compressedLogging = settings.value("COMPRESSEDLOGGING",false).toBool();
+    m_swarmMode = settings.value("SWARMMODE",false).toBool();
+    m_reconnector->setEnabled(settings.value("AUTORECONNECT",true).toBool());
+    m_mavlinkProtocol->router()->setEnabled(settings.value("ROUTING",false).toBool());
+    m_mavlinkProtocol->latencyProbe()->setInterval(settings.value("PINGINTERVAL",m_mavlinkProtocol->latencyProbe()->interval()).toInt());
+    MAVLinkLatencyTracer::instance()->setMessageId(settings.value("LATENCYTRACE_MSGID",MAVLINK_MSG_ID_ATTITUDE).toInt());
+    MAVLinkLatencyTracer::instance()->setEnabled(settings.value("LATENCYTRACE",false).toBool());
+    if (settings.value("FANOUT_TCPPORT",0).toInt() > 0)
+    {
+        m_mavlinkProtocol->fanout()->setTcpPort(settings.value("FANOUT_TCPPORT").toInt());
+    }
+    if (settings.value("STATESERVER_PORT",0).toInt() > 0)
+    {
+        m_mavlinkProtocol->stateServer()->setPort(settings.value("STATESERVER_PORT").toInt());
+    }
+    int fanoutsize = settings.beginReadArray("FANOUT_UDP");
+    for (int i=0;i<fanoutsize;i++)
+    {
+        settings.setArrayIndex(i);
+        m_mavlinkProtocol->fanout()->addUdpSubscriber(QHostAddress(settings.value("host").toString()),settings.value("port").toInt());
+    }
+    settings.endArray();
     int linkssize = settings.beginReadArray("LINKS");
     for (int i=0;i<linkssize;i++)
     {
         settings.setArrayIndex(i);
         QString type = settings.value("type").toString();
+        int linkid = -1;
 
         if (type == "UDP_LINK")
         {
             int port = settings.value("port").toInt();
-            int linkid = addUdpConnection(QHostAddress::Any,port);
-            UDPLink *iface = qobject_cast<UDPLink*>(m_connectionMap.value(linkid));
+            linkid = addUdpConnection(QHostAddress::Any,port);
+            UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
 
             int hostcount = settings.beginReadArray("HOSTS");
             for (int j=0;j<hostcount;++j)
@@ -108,15 +185,38 @@ void LinkManager::loadSettings()
                 iface->addHost(tr("%1:%2").arg(host, port));
             }
             settings.endArray();
+            QHostAddress group(settings.value("multicast").toString());
+            if (!group.isNull())
+            {
+                iface->setMulticast(group,settings.value("ttl",1).toInt(),settings.value("interface").toString());
+            }
+            if (settings.contains("rcvbuf"))
+            {
+                iface->setSocketBuffers(settings.value("rcvbuf").toInt(),settings.value("sndbuf").toInt());
+            }
         }
         else if (type == "TCP_LINK")
         {
             QString host = settings.value("host").toString();
             int port = settings.value("port").toInt();
             bool asServer = settings.value("asServer").toBool();
-            addTcpConnection(QHostAddress(host),port,asServer);
+            linkid = addTcpConnection(host,port,asServer);
+        }
+        else if (type == "SERIAL_LINK")
+        {
+            linkid = addUsbSerialConnection(settings.value("device").toString(),settings.value("baud").toInt(),
+                                   settings.value("latency").toInt());
+        }
+        else if (type == "BLUETOOTH_LINK")
+        {
+            linkid = addBluetoothConnection(settings.value("address").toString(),settings.value("device").toString());
+        }
+        if (linkid >= 0 && settings.value("group",0).toInt() > 0)
+        {
+            m_mavlinkProtocol->fusion()->setGroup(m_connectionMap.value(linkid),settings.value("group").toInt());
         }
     }
+    settings.endArray();
 
     int portsize = settings.beginReadArray("PORTBAUDPAIRS");
     for (int i=0;i<portsize;i++)
@@ -125,23 +225,48 @@ void LinkManager::loadSettings()
         m_portToBaudMap[settings.value("port").toString()] = settings.value("baud").toInt();
     }
     settings.endArray();
-    settings.endArray();
 }
 
 void LinkManager::saveSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup("LINKMANAGER");
     settings.setValue("LOGGING",m_mavlinkLoggingEnabled);
+    settings.setValue("COMPRESSEDLOGGING",m_compressedLogging);
+    settings.setValue("SWARMMODE",m_swarmMode);
+    settings.setValue("AUTORECONNECT",m_reconnector->isEnabled());
+    settings.setValue("ROUTING",m_mavlinkProtocol->router()->isEnabled());
+    settings.setValue("PINGINTERVAL",m_mavlinkProtocol->latencyProbe()->interval());
+    settings.setValue("LATENCYTRACE",MAVLinkLatencyTracer::instance()->isEnabled());
+    settings.setValue("LATENCYTRACE_MSGID",MAVLinkLatencyTracer::instance()->messageId());
+    settings.setValue("FANOUT_TCPPORT",m_mavlinkProtocol->fanout()->tcpPort());
+    settings.setValue("STATESERVER_PORT",m_mavlinkProtocol->stateServer()->port());
+    QList<QPair<QHostAddress,quint16> > fanout = m_mavlinkProtocol->fanout()->udpSubscribers();
+    settings.beginWriteArray("FANOUT_UDP");
+    for (int i=0;i<fanout.size();i++)
+    {
+        settings.setArrayIndex(i);
+        settings.setValue("host",fanout.at(i).first.toString());
+        settings.setValue("port",fanout.at(i).second);
+    }
+    settings.endArray();
     settings.beginWriteArray("LINKS");
     int index = 0;
     for (QMap<int,LinkInterface*>::const_iterator i= m_connectionMap.constBegin();i!=m_connectionMap.constEnd();i++)
     {
+        if (i.value()->getLinkType() == LinkInterface::REPLAY_LINK)
+        {
+            // Replays are opened on demand, not restored
+            continue;
+        }
         settings.setArrayIndex(index++);
         settings.setValue("linkid",i.value()->getId());
-        if (i.value()->getLinkType() == LinkInterface::UDP_LINK)
+        settings.setValue("group",m_mavlinkProtocol->fusion()->group(i.value()->getId()));
+        // Impairments are for testing and not saved, the link behind them is
+        LinkInterface *base = baseLink(i.key());
+        if (base->getLinkType() == LinkInterface::UDP_LINK)
         {
-            UDPLink *link = qobject_cast<UDPLink*>(i.value());
+            UDPLink *link = qobject_cast<UDPLink*>(base);
             settings.setValue("type","UDP_LINK");
             settings.beginWriteArray("HOSTS");
             for (int j=0;j<link->getHosts().size();j++)
@@ -152,15 +277,37 @@ void LinkManager::saveSettings()
             }
             settings.endArray();
             settings.setValue("port",link->getPort());
+            settings.setValue("multicast",link->getMulticastGroup().toString());
+            settings.setValue("ttl",link->getMulticastTtl());
+            settings.setValue("interface",link->getMulticastInterface());
+            settings.setValue("rcvbuf",link->getReceiveBufferSize());
+            settings.setValue("sndbuf",link->getSendBufferSize());
         }
-        else if (i.value()->getLinkType() == LinkInterface::TCP_LINK)
+        else if (base->getLinkType() == LinkInterface::TCP_LINK)
         {
-            TCPLink *link = qobject_cast<TCPLink*>(i.value());
+            TCPLink *link = qobject_cast<TCPLink*>(base);
             settings.setValue("type","TCP_LINK");
-            settings.setValue("host",link->getHostAddress().toString());
+            settings.setValue("host",link->getHostName());
             settings.setValue("port",link->getPort());
             settings.setValue("asServer",link->isServer());
         }
+#ifdef Q_OS_ANDROID
+        else if (base->getLinkType() == LinkInterface::SERIAL_LINK)
+        {
+            AndroidSerialLink *link = qobject_cast<AndroidSerialLink*>(base);
+            settings.setValue("type","SERIAL_LINK");
+            settings.setValue("device",link->getDeviceName());
+            settings.setValue("baud",link->getBaudRate());
+            settings.setValue("latency",link->getLatencyTimer());
+        }
+        else if (base->getLinkType() == LinkInterface::BLUETOOTH_LINK)
+        {
+            BluetoothLink *link = qobject_cast<BluetoothLink*>(base);
+            settings.setValue("type","BLUETOOTH_LINK");
+            settings.setValue("address",link->getAddress());
+            settings.setValue("device",link->getDeviceName());
+        }
+#endif
     }
     settings.endArray();
     settings.beginWriteArray("PORTBAUDPAIRS");
@@ -173,7 +320,6 @@ void LinkManager::saveSettings()
     }
     settings.endArray();
     settings.endGroup();
-    settings.sync();
 }
 void LinkManager::setLogSubDirectory(QString dir)
 {
@@ -215,13 +361,137 @@ bool LinkManager::loggingEnabled()
     return m_mavlinkLoggingEnabled;
 }
 
+void LinkManager::setCompressedLogging(bool enabled)
+{
+    if (m_compressedLogging == enabled)
+    {
+        return;
+    }
+    m_compressedLogging = enabled;
+    saveSettings();
+    // Takes effect with the next log file
+    if (m_mavlinkLoggingEnabled && m_mavlinkProtocol->loggingEnabled())
+    {
+        stopLogging();
+        startLogging();
+    }
+}
+
+void LinkManager::setRoutingEnabled(bool enabled)
+{
+    m_mavlinkProtocol->router()->setEnabled(enabled);
+    if (enabled)
+    {
+        foreach (LinkInterface *link, m_connectionMap)
+        {
+            if (link->isConnected())
+            {
+                m_mavlinkProtocol->router()->addLink(link);
+            }
+        }
+    }
+    saveSettings();
+}
+
+bool LinkManager::routingEnabled()
+{
+    return m_mavlinkProtocol->router()->isEnabled();
+}
+
+void LinkManager::setPingInterval(int intervalMs)
+{
+    m_mavlinkProtocol->latencyProbe()->setInterval(intervalMs);
+    saveSettings();
+}
+
+void LinkManager::setLinkGroup(int linkid, int group)
+{
+    if (!m_connectionMap.contains(linkid))
+    {
+        return;
+    }
+    m_mavlinkProtocol->fusion()->setGroup(m_connectionMap.value(linkid),group);
+    emit linkChanged(linkid);
+    saveSettings();
+}
+
+int LinkManager::getLinkGroup(int linkid)
+{
+    return m_mavlinkProtocol->fusion()->group(linkid);
+}
+
+MAVLinkFusion::LinkStats LinkManager::getLinkFusionStats(int linkid)
+{
+    return m_mavlinkProtocol->fusion()->stats(linkid);
+}
+
+void LinkManager::setFanoutTcpPort(int port)
+{
+    m_mavlinkProtocol->fanout()->setTcpPort(static_cast<quint16>(qMax(0, port)));
+    saveSettings();
+}
+
+int LinkManager::fanoutTcpPort()
+{
+    return m_mavlinkProtocol->fanout()->tcpPort();
+}
+
+void LinkManager::addFanoutUdpSubscriber(const QHostAddress &address, int port)
+{
+    m_mavlinkProtocol->fanout()->addUdpSubscriber(address,static_cast<quint16>(port));
+    saveSettings();
+}
+
+void LinkManager::removeFanoutUdpSubscriber(const QHostAddress &address, int port)
+{
+    m_mavlinkProtocol->fanout()->removeUdpSubscriber(address,static_cast<quint16>(port));
+    saveSettings();
+}
+
+MAVLinkFanout::Stats LinkManager::getFanoutStats()
+{
+    return m_mavlinkProtocol->fanout()->stats();
+}
+
+void LinkManager::setStateServerPort(int port)
+{
+    m_mavlinkProtocol->stateServer()->setPort(static_cast<quint16>(qMax(0, port)));
+    saveSettings();
+}
+
+int LinkManager::stateServerPort()
+{
+    return m_mavlinkProtocol->stateServer()->port();
+}
+
+StateWebSocketServer::Stats LinkManager::getStateServerStats()
+{
+    return m_mavlinkProtocol->stateServer()->stats();
+}
+
+MAVLinkLatencyProbe::Stats LinkManager::getLinkLatency(int linkid)
+{
+    return m_mavlinkProtocol->latencyProbe()->stats(linkid);
+}
+
 void LinkManager::startLogging()
 {
     if (!m_mavlinkLoggingEnabled)
     {
         return;
     }
+    // A log the system killed us in the middle of is still mapped length
+    const int recovered = TlogWriter::recoverUnfinished(QGC::MAVLinkLogDirectory() + m_logSubDir);
+    if (recovered > 0)
+    {
+        QLOG_INFO() << "LinkManager: finished" << recovered << "log(s) of a run that was killed";
+    }
     QString logFileName = QGC::MAVLinkLogDirectory() + m_logSubDir + QGC::fileNameAsTime();
+    if (m_compressedLogging)
+    {
+        logFileName.chop(QString(MAVLINK_LOGFILE_EXT).size());
+        logFileName += MAVLINK_COMPRESSED_LOGFILE_EXT;
+    }
     QLOG_DEBUG() << "LinkManger::startLogging()" << logFileName;
     m_mavlinkProtocol->startLogging(logFileName);
 }
@@ -232,39 +502,217 @@ LinkInterface::LinkType LinkManager::getLinkType(int linkid)
     {
         return LinkInterface::UNKNOWN_LINK;
     }
-    return m_connectionMap.value(linkid)->getLinkType();
+    return baseLink(linkid)->getLinkType();
+}
+
+LinkInterface *LinkManager::baseLink(int linkid) const
+{
+    LinkInterface *link = m_connectionMap.value(linkid);
+    ImpairedLink *impaired = qobject_cast<ImpairedLink*>(link);
+    return impaired ? impaired->inner() : link;
+}
+
+ImpairedLink *LinkManager::impairLink(int linkid)
+{
+    LinkInterface *link = m_connectionMap.value(linkid);
+    if (!link)
+    {
+        return NULL;
+    }
+    ImpairedLink *impaired = qobject_cast<ImpairedLink*>(link);
+    if (impaired)
+    {
+        return impaired;
+    }
+    impaired = new ImpairedLink(link);
+    // Reads come out of the simulator from now on
+    disconnect(link,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    disconnect(link,0,this,0);
+    connect(impaired,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)),Qt::DirectConnection);
+    connect(impaired,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
+    connect(impaired,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
+    connect(impaired,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    m_connectionMap.insert(linkid,impaired);
+
+    // And whoever sends on the link goes through it too
+    for (int i = 0; i < 256; i++)
+    {
+        UAS *uas = qobject_cast<UAS*>(m_uasById[i]);
+        if (uas && uas->getLinks()->contains(link))
+        {
+            uas->addLink(impaired);
+            uas->removeLink(link);
+        }
+    }
+    if (m_mavlinkProtocol->router()->isEnabled())
+    {
+        m_mavlinkProtocol->router()->removeLink(linkid);
+        m_mavlinkProtocol->router()->addLink(impaired);
+    }
+    int group = m_mavlinkProtocol->fusion()->group(linkid);
+    if (group > 0)
+    {
+        m_mavlinkProtocol->fusion()->setGroup(impaired,0);
+        m_mavlinkProtocol->fusion()->setGroup(impaired,group);
+    }
+    emit linkChanged(linkid);
+    return impaired;
+}
+
+void LinkManager::setLinkImpairment(int linkid, const LinkImpairment::Settings &received, const LinkImpairment::Settings &sent)
+{
+    if (received.isNull() && sent.isNull() && !getImpairedLink(linkid))
+    {
+        return;
+    }
+    ImpairedLink *impaired = impairLink(linkid);
+    if (!impaired)
+    {
+        return;
+    }
+    impaired->setImpairment(ImpairedLink::Received,received);
+    impaired->setImpairment(ImpairedLink::Sent,sent);
+}
+
+ImpairedLink *LinkManager::getImpairedLink(int linkid)
+{
+    return qobject_cast<ImpairedLink*>(m_connectionMap.value(linkid));
 }
 
 int LinkManager::addUdpConnection(QHostAddress addr,int port)
 {
     UDPLink* udpLink = new UDPLink(addr,port);
-    connect(udpLink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    // Reads go from the link's I/O thread straight to the ingest thread
+    connect(udpLink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)),Qt::DirectConnection);
     connect(udpLink,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
     connect(udpLink,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
     connect(udpLink,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    EventLoopMonitor::instance()->watchThread(udpLink);
     m_connectionMap.insert(udpLink->getId(),udpLink);
     emit newLink(udpLink->getId());
     saveSettings();
-    udpLink->connect();
+    connectLink(udpLink->getId());
     return udpLink->getId();
 
 }
 int LinkManager::addTcpConnection(QHostAddress addr,int port,bool asServer)
 {
-    TCPLink *tcplink = new TCPLink(addr,port,asServer);
-    connect(tcplink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    return addTcpConnection(addr.toString(),port,asServer);
+}
+
+int LinkManager::addTcpConnection(const QString &host,int port,bool asServer)
+{
+    TCPLink *tcplink = new TCPLink(QHostAddress(),port,asServer);
+    tcplink->setHostName(host);
+    // Reads go from the link's I/O thread straight to the ingest thread
+    connect(tcplink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)),Qt::DirectConnection);
     connect(tcplink,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
     connect(tcplink,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
+    connect(tcplink,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    EventLoopMonitor::instance()->watchThread(tcplink);
     m_connectionMap.insert(tcplink->getId(),tcplink);
     emit newLink(tcplink->getId());
     saveSettings();
     if (asServer)
     {
-        tcplink->connect();
+        connectLink(tcplink->getId());
     }
     return tcplink->getId();
 }
 
+int LinkManager::addUsbSerialConnection(const QString &deviceName,int baud,int latencyMs)
+{
+#ifdef Q_OS_ANDROID
+    if (baud <= 0)
+    {
+        baud = m_portToBaudMap.value(deviceName,AndroidSerialLink::DefaultBaudRate);
+    }
+    AndroidSerialLink *serialLink = new AndroidSerialLink(deviceName,baud);
+    if (latencyMs > 0)
+    {
+        serialLink->setLatencyTimer(latencyMs);
+    }
+    // Reads go from the Java reader thread straight to the ingest thread
+    connect(serialLink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)),Qt::DirectConnection);
+    connect(serialLink,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
+    connect(serialLink,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
+    connect(serialLink,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    m_connectionMap.insert(serialLink->getId(),serialLink);
+    m_portToBaudMap[deviceName] = baud;
+    emit newLink(serialLink->getId());
+    saveSettings();
+    connectLink(serialLink->getId());
+    return serialLink->getId();
+#else
+    Q_UNUSED(deviceName);
+    Q_UNUSED(baud);
+    Q_UNUSED(latencyMs);
+    QLOG_WARN() << "USB serial links need Android";
+    return -1;
+#endif
+}
+
+int LinkManager::addBluetoothConnection(const QString &address,const QString &deviceName)
+{
+#ifdef Q_OS_ANDROID
+    BluetoothLink *bluetoothLink = new BluetoothLink(address,deviceName);
+    // Reads go from the link's I/O thread straight to the ingest thread
+    connect(bluetoothLink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)),Qt::DirectConnection);
+    connect(bluetoothLink,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
+    connect(bluetoothLink,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
+    connect(bluetoothLink,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    EventLoopMonitor::instance()->watchThread(bluetoothLink);
+    m_connectionMap.insert(bluetoothLink->getId(),bluetoothLink);
+    emit newLink(bluetoothLink->getId());
+    saveSettings();
+    connectLink(bluetoothLink->getId());
+    return bluetoothLink->getId();
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(deviceName);
+    QLOG_WARN() << "Bluetooth links need Android";
+    return -1;
+#endif
+}
+
+void LinkManager::setSerialLinkBaud(int linkid,int baud)
+{
+#ifdef Q_OS_ANDROID
+    AndroidSerialLink *serialLink = qobject_cast<AndroidSerialLink*>(baseLink(linkid));
+    if (!serialLink || baud <= 0)
+    {
+        return;
+    }
+    serialLink->setBaudRate(baud);
+    m_portToBaudMap[serialLink->getDeviceName()] = baud;
+    emit linkChanged(linkid);
+    saveSettings();
+#else
+    Q_UNUSED(linkid);
+    Q_UNUSED(baud);
+#endif
+}
+
+int LinkManager::addTlogReplay(const QString &fileName)
+{
+    TlogReplayLink *replayLink = new TlogReplayLink(fileName);
+    connect(replayLink,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),m_mavlinkProtocol,SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    connect(replayLink,SIGNAL(connected(LinkInterface*)),this,SLOT(linkConnected(LinkInterface*)));
+    connect(replayLink,SIGNAL(disconnected(LinkInterface*)),this,SLOT(linkDisonnected(LinkInterface*)));
+    connect(replayLink,SIGNAL(error(LinkInterface*,QString)),this,SLOT(linkErrorRec(LinkInterface*,QString)));
+    m_connectionMap.insert(replayLink->getId(),replayLink);
+    // A replayed log may contain our own traffic, see MAVLinkProtocol::handleMessage
+    m_mavlinkProtocol->setThrowAwayGCSPackets(true);
+    emit newLink(replayLink->getId());
+    replayLink->connect();
+    return replayLink->getId();
+}
+
+TlogReplayLink *LinkManager::getReplayLink(int linkid)
+{
+    return qobject_cast<TlogReplayLink*>(m_connectionMap.value(linkid));
+}
+
 void LinkManager::addLink(LinkInterface *link)
 {
     m_connectionMap.insert(link->getId(),link);
@@ -279,38 +727,108 @@ void LinkManager::removeLink(int linkId)
 {
     if (m_connectionMap.contains(linkId))
     {
+        m_reconnector->remove(linkId);
+        // Before the delete, ManualControl may be writing to it through the sender
+        m_mavlinkProtocol->sender()->removeLink(linkId);
         if (m_connectionMap.value(linkId)->isConnected())
         {
             m_connectionMap.value(linkId)->disconnect();
         }
         delete m_connectionMap.value(linkId);
         m_connectionMap.remove(linkId);
+        m_mavlinkProtocol->removeLinkStats(linkId);
+        m_mavlinkProtocol->router()->removeLink(linkId);
+        m_mavlinkProtocol->latencyProbe()->removeLink(linkId);
+        m_mavlinkProtocol->fusion()->removeLink(linkId);
+        m_ingestSnapshots.remove(linkId);
+        bool replaying = false;
+        foreach (LinkInterface *link, m_connectionMap)
+        {
+            replaying |= (link->getLinkType() == LinkInterface::REPLAY_LINK);
+        }
+        m_mavlinkProtocol->setThrowAwayGCSPackets(replaying);
         saveSettings();
     }
 }
 
 bool LinkManager::connectLink(int index)
 {
-    if (m_connectionMap.contains(index))
+    if (!m_connectionMap.contains(index))
     {
+        return false;
+    }
+    if (getLinkType(index) == LinkInterface::REPLAY_LINK)
+    {
+        // A replay that ends is done, not lost
         return m_connectionMap.value(index)->connect();
     }
-    return false;
+    m_reconnector->start(index);
+    if (!m_connectionMap.value(index)->connect())
+    {
+        m_reconnector->linkFailed(index);
+        return false;
+    }
+    return true;
 }
 void LinkManager::disconnectLink(int index)
 {
     if (m_connectionMap.contains(index))
     {
+        m_reconnector->stop(index);
         m_connectionMap.value(index)->disconnect();
     }
 }
+
+void LinkManager::reconnectLink(int linkid)
+{
+    LinkInterface *link = m_connectionMap.value(linkid);
+    if (!link)
+    {
+        m_reconnector->remove(linkid);
+        return;
+    }
+    if (link->isConnected())
+    {
+        // Came up after all, the drop that scheduled this was stale
+        m_reconnector->linkConnected(linkid);
+        return;
+    }
+    QLOG_INFO() << "Reconnecting" << link->getName();
+    if (!link->connect())
+    {
+        m_reconnector->linkFailed(linkid);
+    }
+}
+
+void LinkManager::setAutoReconnect(bool enabled)
+{
+    m_reconnector->setEnabled(enabled);
+    saveSettings();
+}
+
+void LinkManager::setLatencyTracing(bool enabled, int msgid)
+{
+    MAVLinkLatencyTracer::instance()->setMessageId(msgid);
+    MAVLinkLatencyTracer::instance()->setEnabled(enabled);
+    saveSettings();
+}
+
+QString LinkManager::getLatencyTrace()
+{
+    return MAVLinkLatencyTracer::instance()->summary();
+}
+
+int LinkManager::getLinkState(int linkid)
+{
+    return m_reconnector->state(linkid);
+}
 void LinkManager::modifyTcpConnection(int index,QHostAddress addr,int port,bool asServer)
 {
     if (!m_connectionMap.contains(index))
     {
         return;
     }
-    TCPLink *iface = qobject_cast<TCPLink*>(m_connectionMap.value(index));
+    TCPLink *iface = qobject_cast<TCPLink*>(baseLink(index));
     if (!iface)
     {
         return;
@@ -331,6 +849,26 @@ QString LinkManager::getLinkName(int linkid)
     return m_connectionMap.value(linkid)->getName();
 }
 
+qint64 LinkManager::getLinkInDataRate(int linkid)
+{
+    if (!m_connectionMap.contains(linkid))
+    {
+        return 0;
+    }
+    return m_connectionMap.value(linkid)->getCurrentInDataRate();
+}
+
+QVector<quint32> LinkManager::getLinkTrafficHistory(int linkid, bool received, int seconds)
+{
+    if (!m_connectionMap.contains(linkid))
+    {
+        return QVector<quint32>();
+    }
+    LinkInterface *link = m_connectionMap.value(linkid);
+    const LinkTrafficStats &traffic = received ? link->getInTraffic() : link->getOutTraffic();
+    return traffic.history(GroundClock::msecs(), seconds);
+}
+
 bool LinkManager::getLinkConnected(int linkid)
 {
     if (!m_connectionMap.contains(linkid))
@@ -346,20 +884,29 @@ int LinkManager::getUdpLinkPort(int linkid)
     {
         return 0;
     }
-    UDPLink *iface = qobject_cast<UDPLink*>(m_connectionMap.value(linkid));
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
     if (!iface)
     {
         return 0;
     }
     return iface->getPort();
 }
+quint32 LinkManager::getUdpReceiveOverflows(int linkid)
+{
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
+    if (!iface)
+    {
+        return 0;
+    }
+    return iface->getReceiveOverflows();
+}
 int LinkManager::getTcpLinkPort(int linkid)
 {
     if (!m_connectionMap.contains(linkid))
     {
         return 0;
     }
-    TCPLink *iface = qobject_cast<TCPLink*>(m_connectionMap.value(linkid));
+    TCPLink *iface = qobject_cast<TCPLink*>(baseLink(linkid));
     if (!iface)
     {
         return 0;
@@ -373,7 +920,7 @@ QHostAddress LinkManager::getTcpLinkHost(int linkid)
     {
         return QHostAddress::Null;
     }
-    TCPLink *iface = qobject_cast<TCPLink*>(m_connectionMap.value(linkid));
+    TCPLink *iface = qobject_cast<TCPLink*>(baseLink(linkid));
     if (!iface)
     {
         return QHostAddress::Null;
@@ -381,12 +928,22 @@ QHostAddress LinkManager::getTcpLinkHost(int linkid)
     return iface->getHostAddress();
 }
 
+QString LinkManager::getTcpLinkHostName(int linkid)
+{
+    TCPLink *iface = qobject_cast<TCPLink*>(baseLink(linkid));
+    if (!iface)
+    {
+        return QString();
+    }
+    return iface->getHostName();
+}
+
 bool LinkManager::isTcpServer(int linkid)
 {
     if (!m_connectionMap.contains(linkid))
         return false;
 
-    TCPLink *iface = qobject_cast<TCPLink*>(m_connectionMap.value(linkid));
+    TCPLink *iface = qobject_cast<TCPLink*>(baseLink(linkid));
     if (!iface)
         return false;
 
@@ -399,7 +956,7 @@ void LinkManager::setUdpLinkPort(int linkid, int port)
     {
         return;
     }
-    UDPLink *iface = qobject_cast<UDPLink*>(m_connectionMap.value(linkid));
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
     if (!iface)
     {
         return;
@@ -408,13 +965,37 @@ void LinkManager::setUdpLinkPort(int linkid, int port)
     emit linkChanged(linkid);
     saveSettings();
 }
+void LinkManager::setUdpMulticast(int linkid, const QHostAddress &group, int ttl, const QString &interfaceName)
+{
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
+    if (!iface)
+    {
+        return;
+    }
+    iface->setMulticast(group,ttl,interfaceName);
+    emit linkChanged(linkid);
+    saveSettings();
+}
+
+void LinkManager::setUdpSocketBuffers(int linkid, int receiveBytes, int sendBytes)
+{
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
+    if (!iface)
+    {
+        return;
+    }
+    iface->setSocketBuffers(receiveBytes,sendBytes);
+    emit linkChanged(linkid);
+    saveSettings();
+}
+
 void LinkManager::addUdpHost(int linkid,QString hostname)
 {
     if (!m_connectionMap.contains(linkid))
     {
         return;
     }
-    UDPLink *iface = qobject_cast<UDPLink*>(m_connectionMap.value(linkid));
+    UDPLink *iface = qobject_cast<UDPLink*>(baseLink(linkid));
     if (!iface)
     {
         return;
@@ -429,9 +1010,9 @@ void LinkManager::messageReceived(LinkInterface* ,mavlink_message_t )
 
 UASInterface* LinkManager::getUas(int id)
 {
-    if (m_uasMap.contains(id))
+    if (id >= 0 && id < 256)
     {
-        return m_uasMap.value(id);
+        return m_uasById[id];
     }
     return 0;
 }
@@ -459,6 +1040,8 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
     }
 
     UASInterface* uas;
+    // In swarm mode only the vehicle on the HUD decodes everything
+    bool full = !m_swarmMode || sysid == m_focusedSysid;
 
     switch (heartbeat->autopilot)
     {
@@ -468,7 +1051,7 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
         // Set the system type
         mav->setSystemType((int)heartbeat->type);
         // Connect this robot to the UAS object
-        connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+        subscribeVehicle(mavlink, mav, full);
 #ifdef QGC_PROTOBUF_ENABLED
         connect(mavlink, SIGNAL(extendedMessageReceived(LinkInterface*, std::tr1::shared_ptr<google::protobuf::Message>)), mav, SLOT(receiveExtendedMessage(LinkInterface*, std::tr1::shared_ptr<google::protobuf::Message>)));
 #endif
@@ -481,10 +1064,7 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
         // Set the system type
         mav->setSystemType((int)heartbeat->type);
         // Connect this robot to the UAS object
-        // it is IMPORTANT here to use the right object type,
-        // else the slot of the parent object is called (and thus the special
-        // packets never reach their goal)
-        connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+        subscribeVehicle(mavlink, mav, full);
 #ifdef QGC_PROTOBUF_ENABLED
         connect(mavlink, SIGNAL(extendedMessageReceived(LinkInterface*, std::tr1::shared_ptr<google::protobuf::Message>)), mav, SLOT(receiveExtendedMessage(LinkInterface*, std::tr1::shared_ptr<google::protobuf::Message>)));
 #endif
@@ -497,10 +1077,7 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
         // Set the system type
         mav->setSystemType((int)heartbeat->type);
         // Connect this robot to the UAS object
-        // it is IMPORTANT here to use the right object type,
-        // else the slot of the parent object is called (and thus the special
-        // packets never reach their goal)
-        connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+        subscribeVehicle(mavlink, mav, full);
         uas = mav;
     }
     break;
@@ -508,16 +1085,16 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
     {
         ArduPilotMegaMAV* mav = new ArduPilotMegaMAV(0, sysid);
         UASObject *obj = new UASObject();
-        connect(mavlink,SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)),obj,SLOT(messageReceived(LinkInterface*,mavlink_message_t)));
+        if (full)
+        {
+            obj->subscribe(mavlink->dispatcher(), sysid);
+        }
         m_uasObjectMap[sysid] = obj;
 
         // Set the system type
         mav->setSystemType((int)heartbeat->type);
         // Connect this robot to the UAS object
-        // it is IMPORTANT here to use the right object type,
-        // else the slot of the parent object is called (and thus the special
-        // packets never reach their goal)
-        connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+        subscribeVehicle(mavlink, mav, full);
         uas = mav;
     }
     break;
@@ -526,7 +1103,7 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
         {
             senseSoarMAV* mav = new senseSoarMAV(0,sysid);
             mav->setSystemType((int)heartbeat->type);
-            connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+            subscribeVehicle(mavlink, mav, full);
             uas = mav;
             break;
         }
@@ -536,16 +1113,13 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
         UAS* mav = new UAS(0, sysid);
         mav->setSystemType((int)heartbeat->type);
         // Connect this robot to the UAS object
-        // it is IMPORTANT here to use the right object type,
-        // else the slot of the parent object is called (and thus the special
-        // packets never reach their goal)
-        connect(mavlink, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
+        subscribeVehicle(mavlink, mav, full);
         uas = mav;
     }
     break;
     }
 
-    m_uasMap.insert(sysid,uas);
+    m_uasById[sysid & 0xFF] = uas;
 
     // Set the autopilot type
     uas->setAutopilotType((int)heartbeat->autopilot);
@@ -559,6 +1133,56 @@ UASInterface* LinkManager::createUAS(MAVLinkProtocol* mavlink, LinkInterface* li
     return uas;
 
 }
+void LinkManager::setSwarmMode(bool enabled)
+{
+    if (m_swarmMode == enabled)
+    {
+        return;
+    }
+    m_swarmMode = enabled;
+    QLOG_INFO() << "Swarm mode" << (enabled ? "on" : "off");
+    updateVehicleSubscriptions();
+    saveSettings();
+}
+
+void LinkManager::focusVehicle(UASInterface *uas)
+{
+    int sysid = uas ? uas->getUASID() : -1;
+    if (m_focusedSysid == sysid)
+    {
+        return;
+    }
+    m_focusedSysid = sysid;
+    if (m_swarmMode)
+    {
+        updateVehicleSubscriptions();
+    }
+}
+
+void LinkManager::updateVehicleSubscriptions()
+{
+    MAVLinkDispatcher *dispatcher = m_mavlinkProtocol->dispatcher();
+    for (int sysid = 0; sysid < 256; ++sysid)
+    {
+        if (!m_uasById[sysid])
+        {
+            continue;
+        }
+        bool full = !m_swarmMode || sysid == m_focusedSysid;
+        dispatcher->unsubscribe(m_uasById[sysid]);
+        subscribeVehicle(m_mavlinkProtocol, m_uasById[sysid], full);
+        UASObject *obj = m_uasObjectMap.value(sysid);
+        if (obj)
+        {
+            obj->unsubscribe(dispatcher);
+            if (full)
+            {
+                obj->subscribe(dispatcher, sysid);
+            }
+        }
+    }
+}
+
 UASObject *LinkManager::getUasObject(int uasid)
 {
     if (m_uasObjectMap.contains(uasid))
@@ -575,15 +1199,26 @@ void LinkManager::protocolStatusMessageRec(QString title,QString text)
 }
 void LinkManager::linkConnected(LinkInterface* link)
 {
+    m_mavlinkProtocol->router()->addLink(link);
+    m_reconnector->linkConnected(link->getId());
     emit linkChanged(link->getId());
 }
 
 void LinkManager::linkDisonnected(LinkInterface* link)
 {
+    if (link->getLinkType() != LinkInterface::REPLAY_LINK)
+    {
+        m_reconnector->linkFailed(link->getId());
+    }
     emit linkChanged(link->getId());
 }
 void LinkManager::linkErrorRec(LinkInterface *link,QString errorstring)
 {
+    if (!link->isConnected() && link->getLinkType() != LinkInterface::REPLAY_LINK)
+    {
+        // The attempt failed, no disconnected() follows
+        m_reconnector->linkFailed(link->getId());
+    }
     emit linkError(link->getId(),errorstring);
 }
 void LinkManager::linkTimeoutTriggered(LinkInterface *)
@@ -593,6 +1228,38 @@ void LinkManager::linkTimeoutTriggered(LinkInterface *)
     //emit linkError(link->getId(),"Connected to link, but unable to receive any mavlink packets, (link is silent). Disconnecting");
     //link->disconnect();
 }
+LinkIngestStats::Snapshot LinkManager::getLinkIngestStats(int linkid)
+{
+    return m_ingestSnapshots.value(linkid);
+}
+
+QMap<int,float> LinkManager::getComponentLoss(int sysid)
+{
+    return m_mavlinkProtocol->componentLoss(sysid);
+}
+
+void LinkManager::sampleIngestStats()
+{
+    for (QMap<int,LinkInterface*>::const_iterator i = m_connectionMap.constBegin(); i != m_connectionMap.constEnd(); i++)
+    {
+        QSharedPointer<LinkIngestStats> stats = m_mavlinkProtocol->linkStats(i.key());
+        if (!stats.isNull())
+        {
+            m_ingestSnapshots.insert(i.key(), stats->sample());
+        }
+    }
+    m_mavlinkProtocol->fusion()->sample();
+}
+
+void LinkManager::linkResetRequested(int linkid)
+{
+    if (!m_connectionMap.contains(linkid))
+    {
+        return;
+    }
+    m_connectionMap.value(linkid)->requestReset();
+}
+
 void LinkManager::disableTimeouts(int index)
 {
     if (!m_connectionMap.contains(index))
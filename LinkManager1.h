@@ -39,13 +39,24 @@ This file is part of the APM_PLANNER project
  * It will create (on request) UDP links, connect the links to the associated mavlink parsers,
  * and emit signals upwards when mavlink messages come in.
  * This class lives in the UI thread
- * The mavlink decoder lives in its own thread
+ * MAVLink framing runs on the MAVLinkIngest thread, decoded messages are
+ * dispatched back on the UI thread
  * the UAS Class lives in the UI thread
  */
 #include "MAVLinkDecoder1.h"
 #include "MAVLinkProtocol1.h"
 #include <QMap>
 #include <QHostAddress>
+#include "LinkIngestStats.h"
+#include "MAVLinkLatencyProbe.h"
+#include "MAVLinkFusion.h"
+#include "ImpairedLink.h"
+#include "LinkReconnector.h"
+#include "MAVLinkFanout.h"
+#include "StateWebSocketServer.h"
+class QTimer;
+class TlogReplayLink;
+class SwarmModel;
 #include "UASInterface1.h"
 #include "UAS1.h"
 #include "UASObject.h"
@@ -72,9 +83,31 @@ public:
     void saveSettings();
     int addUdpConnection(QHostAddress addr,int port);
     int addTcpConnection(QHostAddress addr,int port,bool asServer);
+    /** @brief TCP client or server by host name, looked up when it connects */
+    int addTcpConnection(const QString &host,int port,bool asServer);
+    /** @brief USB-serial adapter through Android USB host, baud 0 for the one last used on the device */
+    int addUsbSerialConnection(const QString &deviceName,int baud = 0,int latencyMs = 0);
+    void setSerialLinkBaud(int linkid,int baud);
+    /** @brief Serial port profile radio by Bluetooth address, it has to be paired already */
+    int addBluetoothConnection(const QString &address,const QString &deviceName = QString());
     void modifyTcpConnection(int index,QHostAddress addr,int port,bool asServer);
+    /** @brief Open a .tlog as a replay link feeding the normal ingest path */
+    int addTlogReplay(const QString &fileName);
+    TlogReplayLink *getReplayLink(int linkid);
+    /** @brief Put a network impairment simulator in front of a link, or change what it does; stays until the link goes */
+    void setLinkImpairment(int linkid, const LinkImpairment::Settings &received, const LinkImpairment::Settings &sent);
+    /** @brief The simulator in front of a link, NULL if there is none */
+    ImpairedLink *getImpairedLink(int linkid);
+    /** @brief Start connecting and keep the link up, retried with backoff if auto reconnect is on */
     bool connectLink(int index);
     void disconnectLink(int index);
+    void setAutoReconnect(bool enabled);
+    bool autoReconnect() const { return m_reconnector->isEnabled(); }
+    /** @brief Trace msgid from socket to frame, see MAVLinkLatencyTracer */
+    void setLatencyTracing(bool enabled, int msgid = MAVLINK_MSG_ID_ATTITUDE);
+    QString getLatencyTrace();
+    /** @brief LinkReconnector::State of a link */
+    int getLinkState(int linkid);
     UASInterface* getUas(int id);
     UASInterface* createUAS(MAVLinkProtocol* mavlink, LinkInterface* link, int sysid, mavlink_heartbeat_t* heartbeat, QObject* parent=NULL);
     void addLink(LinkInterface *link);
@@ -88,38 +121,105 @@ public:
     LinkInterface::LinkType getLinkType(int linkid);
     bool getLinkConnected(int linkid);
     QString getLinkName(int linkid);
+    /** @brief Received bits per second over the last second */
+    qint64 getLinkInDataRate(int linkid);
+    /** @brief Bytes received (or sent) in each of the last seconds, oldest first, at most five minutes */
+    QVector<quint32> getLinkTrafficHistory(int linkid, bool received, int seconds);
+    /** @brief Parser totals and per second rates of a link, sampled once a second */
+    LinkIngestStats::Snapshot getLinkIngestStats(int linkid);
+    /** @brief Recent packet loss in percent per component of a system */
+    QMap<int,float> getComponentLoss(int sysid);
     int getUdpLinkPort(int linkid);
+    /** @brief Datagrams a UDP link's kernel buffer dropped since it connected, see UDPLink::getReceiveOverflows() */
+    quint32 getUdpReceiveOverflows(int linkid);
     int getTcpLinkPort(int linkid);
     QHostAddress getTcpLinkHost(int linkid);
+    QString getTcpLinkHostName(int linkid);
     bool isTcpServer(int linkid);
     void setUdpLinkPort(int linkid, int port);
     void addUdpHost(int linkid,QString hostname);
+    /** @brief Receive a multicast group (or broadcasts) on the link's port, a null group for unicast */
+    void setUdpMulticast(int linkid, const QHostAddress &group, int ttl = 1, const QString &interfaceName = QString());
+    /** @brief SO_RCVBUF and SO_SNDBUF of a UDP link, 0 for the system default */
+    void setUdpSocketBuffers(int linkid, int receiveBytes, int sendBytes = 0);
     QList<QString> getCurrentPorts();
     void stopLogging();
     void startLogging();
     void setLogSubDirectory(QString dir);
     bool loggingEnabled();
+    /** @brief Log to block compressed .ctlog files instead of plain .tlog */
+    void setCompressedLogging(bool enabled);
+    bool compressedLogging() const { return m_compressedLogging; }
+    /** @brief Relay frames between the links, e.g. radio to a companion computer over UDP */
+    void setRoutingEnabled(bool enabled);
+    bool routingEnabled();
+    /** @brief Milliseconds between round trip PINGs on every link, 0 to stop */
+    void setPingInterval(int intervalMs);
+    /** @brief Round trip histogram and min / max / smoothed RTT of a link */
+    MAVLinkLatencyProbe::Stats getLinkLatency(int linkid);
+    /** @brief Join redundant links to one vehicle, frames seen on several are processed once; 0 for none */
+    void setLinkGroup(int linkid, int group);
+    int getLinkGroup(int linkid);
+    /** @brief Duplicates, first arrivals and loss of a link within its group */
+    MAVLinkFusion::LinkStats getLinkFusionStats(int linkid);
+    /** @brief Serve the received stream to TCP subscribers on port, 0 to stop */
+    void setFanoutTcpPort(int port);
+    int fanoutTcpPort();
+    /** @brief Send the received stream to a UDP consumer, e.g. a logging box */
+    void addFanoutUdpSubscriber(const QHostAddress &address, int port);
+    void removeFanoutUdpSubscriber(const QHostAddress &address, int port);
+    MAVLinkFanout::Stats getFanoutStats();
+    /** @brief Serve the decoded vehicle state to WebSocket clients on port, 0 to stop */
+    void setStateServerPort(int port);
+    int stateServerPort();
+    StateWebSocketServer::Stats getStateServerStats();
     UASObject *getUasObject(int uasid);
+    MAVLinkProtocol *getMavlinkProtocol() { return m_mavlinkProtocol; }
+    /** @brief Where plots and inspectors subscribe to the values they show */
+    MAVLinkDecoder *getMavlinkDecoder() { return m_mavlinkDecoder; }
+    /** @brief One row per vehicle, always filled, for swarm overviews */
+    SwarmModel *getSwarmModel() { return m_swarmModel; }
+    /** @brief Only the active vehicle decodes every message, the others keep link state and the swarm row */
+    void setSwarmMode(bool enabled);
+    bool swarmMode() const { return m_swarmMode; }
+    QList<LinkInterface*> getLinks() const { return m_connectionMap.values(); }
     QMap<int,UASObject*> m_uasObjectMap;
 private:
     QMap<int,LinkInterface*> m_connectionMap;
-    QMap<int,UASInterface*> m_uasMap;
+    UASInterface* m_uasById[256]; ///< By system ID, vehicles are never deleted
     QMap<QString,int> m_portToBaudMap;
     MAVLinkDecoder *m_mavlinkDecoder;
     MAVLinkProtocol *m_mavlinkProtocol;
     QString m_logSubDir;
     bool m_mavlinkLoggingEnabled;
+    bool m_compressedLogging;
+    SwarmModel *m_swarmModel;
+    bool m_swarmMode;
+    int m_focusedSysid;         ///< The active UAS, -1 for none
+    void updateVehicleSubscriptions();
+    /** @brief The link itself, behind a simulator if there is one */
+    LinkInterface *baseLink(int linkid) const;
+    ImpairedLink *impairLink(int linkid);
+    LinkReconnector *m_reconnector;
+    QTimer *m_ingestStatsTimer;
+    QMap<int,LinkIngestStats::Snapshot> m_ingestSnapshots;
 signals:
     //void newLink(LinkInterface* link);
     void newLink(int linkid);
     void protocolStatusMessage(QString title,QString text);
     void linkChanged(int linkid);
     void linkError(int linkid, QString message);
+    /** @brief Connecting, connected or waiting retryInMs for the next attempt, see LinkReconnector::State */
+    void linkStateChanged(int linkid, int state, int retryInMs);
 private slots:
     void linkConnected(LinkInterface* link);
     void linkDisonnected(LinkInterface* link);
     void linkErrorRec(LinkInterface* link,QString error);
     void linkTimeoutTriggered(LinkInterface*);
+    void linkResetRequested(int linkid);
+    void reconnectLink(int linkid);
+    void sampleIngestStats();
+    void focusVehicle(UASInterface *uas);
 public slots:
     void messageReceived(LinkInterface* link,mavlink_message_t message);
     void protocolStatusMessageRec(QString title,QString text);
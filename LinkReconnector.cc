@@ -0,0 +1,187 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief LinkReconnector
+ *          See LinkReconnector.h
+ *
+ */
+
+#include "LinkReconnector.h"
+#include "QsLog.h"
+#include <QDateTime>
+
+LinkReconnector::LinkReconnector(QObject *parent) :
+    QObject(parent),
+    m_timer(this),
+    m_enabled(true)
+{
+    m_clock.start();
+    qsrand(static_cast<uint>(QDateTime::currentMSecsSinceEpoch()));
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+void LinkReconnector::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (enabled)
+    {
+        return;
+    }
+    for (QMap<int,Entry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+    {
+        if (i.value().state == Waiting)
+        {
+            i.value().dueMs = -1;
+            setState(i.key(), i.value(), Idle);
+        }
+    }
+    rearm();
+}
+
+void LinkReconnector::start(int linkId)
+{
+    Entry &entry = m_entries[linkId];
+    entry.dueMs = -1;
+    if (entry.state != Connected)
+    {
+        setState(linkId, entry, Connecting);
+    }
+    rearm();
+}
+
+void LinkReconnector::stop(int linkId)
+{
+    if (!m_entries.contains(linkId))
+    {
+        return;
+    }
+    Entry &entry = m_entries[linkId];
+    entry.dueMs = -1;
+    entry.backoffMs = InitialBackoffMs;
+    setState(linkId, entry, Stopped);
+    rearm();
+}
+
+void LinkReconnector::remove(int linkId)
+{
+    m_entries.remove(linkId);
+    rearm();
+}
+
+void LinkReconnector::linkConnected(int linkId)
+{
+    Entry &entry = m_entries[linkId];
+    entry.dueMs = -1;
+    entry.backoffMs = InitialBackoffMs;
+    setState(linkId, entry, Connected);
+    rearm();
+}
+
+void LinkReconnector::linkFailed(int linkId)
+{
+    if (!m_entries.contains(linkId))
+    {
+        return;
+    }
+    Entry &entry = m_entries[linkId];
+    if (entry.state == Stopped || entry.state == Idle || entry.state == Waiting)
+    {
+        // Not wanted, or a late report of the attempt that already failed
+        return;
+    }
+    if (!m_enabled)
+    {
+        setState(linkId, entry, Idle);
+        return;
+    }
+    // A quarter either way
+    int jitter = entry.backoffMs / 2;
+    int delay = entry.backoffMs - jitter / 2 + (jitter > 0 ? qrand() % (jitter + 1) : 0);
+    entry.dueMs = m_clock.elapsed() + delay;
+    entry.backoffMs = qMin(entry.backoffMs * 2, static_cast<int>(MaxBackoffMs));
+    QLOG_DEBUG() << "Link" << linkId << "down, retrying in" << delay << "ms";
+    setState(linkId, entry, Waiting);
+    rearm();
+}
+
+LinkReconnector::State LinkReconnector::state(int linkId) const
+{
+    return m_entries.value(linkId).state;
+}
+
+int LinkReconnector::retryIn(int linkId) const
+{
+    qint64 due = m_entries.value(linkId).dueMs;
+    return due < 0 ? -1 : static_cast<int>(qMax(Q_INT64_C(0), due - m_clock.elapsed()));
+}
+
+void LinkReconnector::setState(int linkId, Entry &entry, State state)
+{
+    bool changed = entry.state != state || state == Waiting;
+    entry.state = state;
+    if (changed)
+    {
+        emit stateChanged(linkId, state, retryIn(linkId));
+    }
+}
+
+void LinkReconnector::rearm()
+{
+    qint64 earliest = -1;
+    for (QMap<int,Entry>::const_iterator i = m_entries.constBegin(); i != m_entries.constEnd(); ++i)
+    {
+        if (i.value().dueMs >= 0 && (earliest < 0 || i.value().dueMs < earliest))
+        {
+            earliest = i.value().dueMs;
+        }
+    }
+    if (earliest < 0)
+    {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start(static_cast<int>(qMax(Q_INT64_C(0), earliest - m_clock.elapsed())));
+}
+
+void LinkReconnector::timeout()
+{
+    qint64 now = m_clock.elapsed();
+    QList<int> due;
+    for (QMap<int,Entry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+    {
+        if (i.value().dueMs >= 0 && i.value().dueMs <= now)
+        {
+            i.value().dueMs = -1;
+            setState(i.key(), i.value(), Connecting);
+            due.append(i.key());
+        }
+    }
+    rearm();
+    // The owner may report back from within, so the map is not walked while it does
+    foreach (int linkId, due)
+    {
+        emit attempt(linkId);
+    }
+}
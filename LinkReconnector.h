@@ -0,0 +1,110 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief LinkReconnector
+ *          Keeps the links the user connected connected. A link that drops
+ *          or fails to connect is tried again after a backoff that starts at
+ *          InitialBackoffMs and doubles up to MaxBackoffMs, with a quarter of
+ *          random jitter either way so links that fail together do not retry
+ *          in lock step. A link that connects starts over at the shortest.
+ *
+ *          The reconnector only decides when; attempt() asks the owner to
+ *          call the link's connect(), which returns at once, and the owner
+ *          reports back what the link signalled. Nothing here blocks the UI
+ *          thread, one single shot timer covers all links.
+ *
+ */
+
+#ifndef LINKRECONNECTOR_H
+#define LINKRECONNECTOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class LinkReconnector : public QObject
+{
+    Q_OBJECT
+public:
+    enum State {
+        Idle,           ///< Not wanted, never connected
+        Connecting,     ///< An attempt is under way
+        Connected,
+        Waiting,        ///< Backing off before the next attempt
+        Stopped         ///< Disconnected on purpose
+    };
+    enum {
+        InitialBackoffMs = 500,
+        MaxBackoffMs = 30000
+    };
+
+    explicit LinkReconnector(QObject *parent = 0);
+
+    /** @brief Retry links that fail, otherwise they stay down until connected again */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /** @brief The link is wanted up, the caller starts the first attempt */
+    void start(int linkId);
+    /** @brief The link is wanted down, cancels a pending retry */
+    void stop(int linkId);
+    void remove(int linkId);
+
+    /** @brief The link came up */
+    void linkConnected(int linkId);
+    /** @brief The link went down or an attempt failed, schedules the next if it is wanted */
+    void linkFailed(int linkId);
+
+    State state(int linkId) const;
+    /** @brief Milliseconds until the next attempt, -1 if none is scheduled */
+    int retryIn(int linkId) const;
+
+signals:
+    /** @brief Time to call connect() on the link again */
+    void attempt(int linkId);
+    void stateChanged(int linkId, int state, int retryInMs);
+
+private slots:
+    void timeout();
+
+private:
+    struct Entry
+    {
+        Entry() : state(Idle), backoffMs(InitialBackoffMs), dueMs(-1) {}
+        State state;
+        int backoffMs;  ///< Wait before the next attempt after this one fails
+        qint64 dueMs;   ///< m_clock time of the next attempt, -1 for none
+    };
+    void setState(int linkId, Entry &entry, State state);
+    /** @brief Arm the timer for the earliest due attempt */
+    void rearm();
+
+    QMap<int,Entry> m_entries;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    bool m_enabled;
+};
+
+#endif // LINKRECONNECTOR_H
@@ -0,0 +1,91 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLink2
+ *          Wire format of MAVLink 2 frames, which the bundled v1.0 headers do not
+ *          know. A v2 frame carries a 24 bit message ID and drops the trailing
+ *          zero bytes of its payload; the receiver zero extends it again. Only
+ *          message IDs of the v1.0 dialect fit mavlink_message_t, so received
+ *          frames are rebuilt as the equivalent v1 frame and everything past
+ *          the parser keeps working on v1 frames.
+ *
+ */
+
+#ifndef MAVLINK2_H
+#define MAVLINK2_H
+
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+#define MAVLINK2_STX 0xFD
+#define MAVLINK2_NUM_HEADER_BYTES 10     ///< STX, len, incompat, compat, seq, sysid, compid, msgid[3]
+#define MAVLINK2_NUM_NON_PAYLOAD_BYTES (MAVLINK2_NUM_HEADER_BYTES + MAVLINK_NUM_CHECKSUM_BYTES)
+#define MAVLINK2_SIGNATURE_LEN 13
+#define MAVLINK2_IFLAG_SIGNED 0x01
+
+/** @brief Length of the whole frame from its first three bytes, v1 or v2 */
+static inline int mavlink_frame_length(const uint8_t *frame)
+{
+    if (frame[0] == MAVLINK2_STX)
+    {
+        return MAVLINK2_NUM_NON_PAYLOAD_BYTES + frame[1]
+                + ((frame[2] & MAVLINK2_IFLAG_SIGNED) ? MAVLINK2_SIGNATURE_LEN : 0);
+    }
+    return MAVLINK_NUM_NON_PAYLOAD_BYTES + frame[1];
+}
+
+/**
+ * @brief Write message as an unsigned v2 frame with its trailing zeros cut off
+ * @param out At least MAVLINK2_NUM_NON_PAYLOAD_BYTES + message.len bytes
+ * @return The frame length
+ */
+static inline int mavlink2_pack(const mavlink_message_t &message, uint8_t *out)
+{
+    static const uint8_t crcExtra[256] = MAVLINK_MESSAGE_CRCS;
+    const uint8_t *payload = (const uint8_t*)_MAV_PAYLOAD(&message);
+    int length = message.len;
+    // The first payload byte always goes out, an empty payload is not allowed
+    while (length > 1 && payload[length - 1] == 0)
+    {
+        length--;
+    }
+    out[0] = MAVLINK2_STX;
+    out[1] = (uint8_t)length;
+    out[2] = 0;
+    out[3] = 0;
+    out[4] = message.seq;
+    out[5] = message.sysid;
+    out[6] = message.compid;
+    out[7] = message.msgid;
+    out[8] = 0;
+    out[9] = 0;
+    memcpy(out + MAVLINK2_NUM_HEADER_BYTES, payload, length);
+
+    uint16_t checksum = crc_calculate(out + 1, MAVLINK2_NUM_HEADER_BYTES - 1 + length);
+    crc_accumulate(crcExtra[message.msgid], &checksum);
+    out[MAVLINK2_NUM_HEADER_BYTES + length] = (uint8_t)(checksum & 0xFF);
+    out[MAVLINK2_NUM_HEADER_BYTES + length + 1] = (uint8_t)(checksum >> 8);
+    return MAVLINK2_NUM_NON_PAYLOAD_BYTES + length;
+}
+
+#endif // MAVLINK2_H
@@ -0,0 +1,136 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkCrc
+ *          See MAVLinkCrc.h
+ *
+ */
+
+#include "MAVLinkCrc.h"
+
+namespace {
+
+// s_tables[0] is the classic byte table, s_tables[k] advances a byte that is
+// followed by k more: s_tables[k][i] = s_tables[k - 1][i] shifted through one zero byte
+uint16_t s_tables[8][256];
+
+struct TableInit
+{
+    TableInit()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint16_t crc = 0;
+            crc_accumulate((uint8_t)i, &crc);
+            s_tables[0][i] = crc;
+        }
+        for (int k = 1; k < 8; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                uint16_t previous = s_tables[k - 1][i];
+                s_tables[k][i] = (previous >> 8) ^ s_tables[0][previous & 0xFF];
+            }
+        }
+    }
+};
+// Before main(), so no frame is ever checked against empty tables
+TableInit s_tableInit;
+
+uint16_t calculateBytewise(const uint8_t *data, int length, uint16_t crc)
+{
+    while (length-- > 0)
+    {
+        crc_accumulate(*data++, &crc);
+    }
+    return crc;
+}
+
+uint16_t calculateTable(const uint8_t *data, int length, uint16_t crc)
+{
+    while (length-- > 0)
+    {
+        crc = (crc >> 8) ^ s_tables[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+uint16_t calculateSlicing8(const uint8_t *data, int length, uint16_t crc)
+{
+    // Bytes are loaded one at a time, so neither alignment nor byte order matter
+    while (length >= 8)
+    {
+        crc = s_tables[7][(data[0] ^ crc) & 0xFF] ^ s_tables[6][data[1] ^ (crc >> 8)]
+            ^ s_tables[5][data[2]] ^ s_tables[4][data[3]]
+            ^ s_tables[3][data[4]] ^ s_tables[2][data[5]]
+            ^ s_tables[1][data[6]] ^ s_tables[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    return calculateTable(data, length, crc);
+}
+
+const MAVLinkCrc::CalculateFunction *kernels()
+{
+    static const MAVLinkCrc::CalculateFunction functions[MAVLinkCrc::KernelCount] =
+    {
+        calculateBytewise, calculateTable, calculateSlicing8
+    };
+    return functions;
+}
+
+}
+
+MAVLinkCrc::CalculateFunction MAVLinkCrc::s_calculate = calculateSlicing8;
+MAVLinkCrc::Kernel MAVLinkCrc::s_kernel = MAVLinkCrc::Slicing8;
+
+void MAVLinkCrc::setKernel(Kernel kernel)
+{
+    if (kernel < 0 || kernel >= KernelCount)
+    {
+        return;
+    }
+    s_kernel = kernel;
+    s_calculate = kernels()[kernel];
+}
+
+const char *MAVLinkCrc::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Bytewise: return "bytewise";
+    case Table: return "table";
+    case Slicing8: return "slicing8";
+    default: return "unknown";
+    }
+}
+
+uint16_t MAVLinkCrc::calculateWith(Kernel kernel, const uint8_t *data, int length, uint16_t crc)
+{
+    if (kernel < 0 || kernel >= KernelCount)
+    {
+        kernel = s_kernel;
+    }
+    return kernels()[kernel](data, length, crc);
+}
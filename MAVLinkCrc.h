@@ -0,0 +1,79 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkCrc
+ *          Table driven X.25 (CRC-16/MCRF4XX) checksums for whole frames. The
+ *          bundled crc_accumulate() shifts and xors once per byte; the frame
+ *          scanner checks complete frames, so it takes eight bytes per step
+ *          through eight lookup tables (slicing-by-8) instead. Results are
+ *          bit for bit those of crc_calculate() / crc_accumulate().
+ *
+ */
+
+#ifndef MAVLINKCRC_H
+#define MAVLINKCRC_H
+
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class MAVLinkCrc
+{
+public:
+    enum Kernel
+    {
+        Bytewise,   ///< crc_accumulate() per byte, the MAVLink reference
+        Table,      ///< One 256 entry lookup per byte
+        Slicing8,   ///< Eight bytes per step through eight tables, the default
+        KernelCount
+    };
+
+    /** @brief CRC of length bytes continuing from crc, crc_calculate() for the default start */
+    static uint16_t calculate(const uint8_t *data, int length, uint16_t crc = X25_INIT_CRC)
+    {
+        return s_calculate(data, length, crc);
+    }
+
+    /** @brief Frame checksum: LEN through the payload, then the message's CRC_EXTRA byte */
+    static uint16_t frame(const uint8_t *data, int length, uint8_t crcExtra)
+    {
+        uint16_t crc = s_calculate(data, length, X25_INIT_CRC);
+        crc_accumulate(crcExtra, &crc);
+        return crc;
+    }
+
+    /** @brief Select the kernel, for benchmarks; not while frames are being checked */
+    static void setKernel(Kernel kernel);
+    static Kernel kernel() { return s_kernel; }
+    static const char *kernelName(Kernel kernel);
+
+    /** @brief One kernel directly, whatever is selected */
+    static uint16_t calculateWith(Kernel kernel, const uint8_t *data, int length, uint16_t crc = X25_INIT_CRC);
+
+    typedef uint16_t (*CalculateFunction)(const uint8_t *data, int length, uint16_t crc);
+
+private:
+    static CalculateFunction s_calculate;
+    static Kernel s_kernel;
+};
+
+#endif // MAVLINKCRC_H
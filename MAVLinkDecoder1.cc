@@ -35,15 +35,56 @@ This file is part of the APM_PLANNER project
 #include "MAVLinkDecoder1.h"
 #include "QGC.h"
 #include <QDataStream>
+#include <cstring>
 #include "LinkManager1.h"
 #include "UASManager1.h"
 #include "UASInterface1.h"
-MAVLinkDecoder::MAVLinkDecoder(QObject *parent) : QObject(parent)
+#include "StringPool.h"
+
+// SYSTEM_TIME clock offset filter: weight of a new sample, and what counts as a clock step
+static const double clockSmoothing = 0.125;
+static const double clockStepMs = 1000;
+static const int clockStepSamples = 3;
+
+// Payload fields are packed, read them without assuming alignment
+template<typename T> static inline T readField(const uint8_t *p)
 {
-    mavlink_message_info_t msg[256] = MAVLINK_MESSAGE_INFO;
-    memcpy(messageInfo, msg, sizeof(mavlink_message_info_t)*256);
-    memset(receivedMessages, 0, sizeof(mavlink_message_t)*256);
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
 
+static QVariant fieldValue(uint8_t type, const uint8_t *p)
+{
+    switch (type)
+    {
+    case MAVLINK_TYPE_CHAR:
+        return (int)readField<char>(p);
+    case MAVLINK_TYPE_UINT8_T:
+        return (int)readField<uint8_t>(p);
+    case MAVLINK_TYPE_INT8_T:
+        return (int)readField<int8_t>(p);
+    case MAVLINK_TYPE_UINT16_T:
+        return (int)readField<uint16_t>(p);
+    case MAVLINK_TYPE_INT16_T:
+        return (int)readField<int16_t>(p);
+    case MAVLINK_TYPE_UINT32_T:
+        return (uint)readField<uint32_t>(p);
+    case MAVLINK_TYPE_INT32_T:
+        return (int)readField<int32_t>(p);
+    case MAVLINK_TYPE_FLOAT:
+        return readField<float>(p);
+    case MAVLINK_TYPE_DOUBLE:
+        return readField<double>(p);
+    case MAVLINK_TYPE_UINT64_T:
+        return (quint64)readField<uint64_t>(p);
+    default:
+        return (qint64)readField<int64_t>(p);
+    }
+}
+
+MAVLinkDecoder::MAVLinkDecoder(QObject *parent) : QObject(parent)
+{
     // Allow system status
 //    messageFilter.insert(MAVLINK_MSG_ID_HEARTBEAT, false);
 //    messageFilter.insert(MAVLINK_MSG_ID_SYS_STATUS, false);
@@ -70,7 +111,16 @@ MAVLinkDecoder::MAVLinkDecoder(QObject *parent) : QObject(parent)
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, false);
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_INT, false);
 //    textMessageFilter.insert(MAVLINK_MSG_ID_HIGHRES_IMU, false);
+
+    // Everything the per message path needs, so it does no string work
+    buildDescriptors();
+}
+void MAVLinkDecoder::setRoundTripTime(int linkId, int sysid, double milliseconds)
+{
+    Q_UNUSED(linkId);
+    roundTripTime[sysid] = milliseconds;
 }
+
 void MAVLinkDecoder::sendMessage(mavlink_message_t )
 {
 
@@ -78,9 +128,14 @@ void MAVLinkDecoder::sendMessage(mavlink_message_t )
 
 
 void MAVLinkDecoder::receiveMessage(LinkInterface* link, mavlink_message_t message)
+{
+    receiveMessageRef(link, MAVLinkMessageRef::create(message));
+}
+
+void MAVLinkDecoder::receiveMessageRef(LinkInterface* link, const MAVLinkMessageRef &ref)
 {
     Q_UNUSED(link);
-    memcpy(receivedMessages+message.msgid, &message, sizeof(mavlink_message_t));
+    const mavlink_message_t &message = ref.message();
 
     uint8_t msgid = message.msgid;
 
@@ -93,357 +148,472 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link, mavlink_message_t messa
 #endif
     if (message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME)
     {
-        mavlink_system_time_t timebase;
-        mavlink_msg_system_time_decode(&message, &timebase);
-        onboardTimeOffset[message.sysid] = (timebase.time_unix_usec+500)/1000 - timebase.time_boot_ms;
-        onboardToGCSUnixTimeOffsetAndDelay[message.sysid] = static_cast<qint64>(QGC::groundTimeMilliseconds() - (timebase.time_unix_usec+500)/1000);
+        mavlink::SystemTime timebase(message);
+        onboardTimeOffset[message.sysid] = (timebase.time_unix_usec()+500)/1000 - timebase.time_boot_ms();
+        if (timebase.time_unix_usec() != 0)
+        {
+            // The message is half a round trip old when it arrives
+            double sample = (double)QGC::groundTimeMilliseconds() - (double)((timebase.time_unix_usec()+500)/1000)
+                            - roundTripTime.value(message.sysid, 0) / 2;
+            QMap<int,double>::iterator offset = clockOffset.find(message.sysid);
+            if (offset == clockOffset.end())
+            {
+                clockOffset.insert(message.sysid, sample);
+            }
+            else if (qAbs(sample - offset.value()) > clockStepMs)
+            {
+                // A few samples in a row that far off mean the onboard clock was set
+                if (++clockOffsetOutliers[message.sysid] >= clockStepSamples)
+                {
+                    offset.value() = sample;
+                    clockOffsetOutliers[message.sysid] = 0;
+                }
+            }
+            else
+            {
+                offset.value() += clockSmoothing * (sample - offset.value());
+                clockOffsetOutliers[message.sysid] = 0;
+            }
+            onboardToGCSUnixTimeOffsetAndDelay[message.sysid] = static_cast<qint64>(clockOffset.value(message.sysid));
+        }
     }
     else
     {
+        // Nothing plots or inspects this message, skip it before any decoding
+        const MessageDescriptor &descriptor = m_descriptors[msgid];
+        if (!descriptor.known || descriptor.filtered || descriptor.subscribed == 0)
+        {
+            return;
+        }
+        UASInterface *uas = UASManager::instance()->getUASForId(message.sysid);
+        if (!uas)
+        {
+            //No active UAS for the incomign message.
+            return;
+        }
+        bool multi = trackComponent(msgid, message.compid);
 
-        QString messageName("%1 (#%2)");
-        messageName = messageName.arg(messageInfo[msgid].name).arg(msgid);
-
-        // See if first value is a time value
+        // See if first value is a time value; if not it is sent out with the time of arrival
+        const uint8_t *payload = (const uint8_t*)_MAV_PAYLOAD(&message);
         quint64 time = 0;
-        uint8_t fieldid = 0;
-        uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
-        if (QString(messageInfo[msgid].fields[fieldid].name) == QString("time_boot_ms") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
+        int first = 1;
+        if (descriptor.time == TimeBootMs)
         {
-            time = *((quint32*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
+            time = readField<quint32>(payload + descriptor.timeOffset);
         }
-        else if (QString(messageInfo[msgid].fields[fieldid].name).contains("usec") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
+        else if (descriptor.time == TimeUsec)
         {
-            time = *((quint64*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            time = (time+500)/1000; // Scale to milliseconds, round up/down correctly
+            time = (readField<quint64>(payload + descriptor.timeOffset)+500)/1000; // Scale to milliseconds, round up/down correctly
         }
         else
         {
-            // First value is not time, send out value 0
-            emitFieldValue(&message, fieldid, getUnixTimeFromMs(message.sysid, 0));
+            first = 0;
         }
 
         // Align time to global time
         time = getUnixTimeFromMs(message.sysid, time);
 
-        // Send out field values from 1..n
-        for (unsigned int i = 1; i < messageInfo[msgid].num_fields; ++i)
+        if (descriptor.named)
+        {
+            QVector<QString> names = payloadNames(message, &time);
+            for (int i = first; i < descriptor.fields.size(); ++i)
+            {
+                if (descriptor.fields[i].subscribers > 0)
+                {
+                    emitField(uas, message, i, time, names);
+                }
+            }
+            return;
+        }
+        const QVector<QString> &names = prefixedNames(message.sysid, message.compid, msgid, multi);
+        for (int i = first; i < descriptor.fields.size(); ++i)
+        {
+            if (descriptor.fields[i].subscribers > 0)
+            {
+                emitField(uas, message, i, time, names);
+            }
+        }
+    }
+}
+
+void MAVLinkDecoder::buildDescriptors()
+{
+    static const char *typeNames[] = { "char", "uint8_t", "int8_t", "uint16_t", "int16_t",
+                                       "uint32_t", "int32_t", "uint64_t", "int64_t", "float", "double" };
+    static const uint8_t typeSizes[] = { 1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+
+    for (int msgid = 0; msgid < 256; msgid++)
+    {
+        // Generated read only tables, nothing is copied per decoder
+        const mavlink::MessageLayout &info = mavlink::messageLayout(msgid);
+        MessageDescriptor &descriptor = m_descriptors[msgid];
+        componentID[msgid] = -1;
+        componentMulti[msgid] = false;
+        if (info.name == NULL || info.numFields == 0)
+        {
+            continue;
+        }
+        descriptor.known = true;
+        m_messageIds.insert(QString(info.name), msgid);
+        descriptor.filtered = messageFilter.contains(msgid);
+        descriptor.textFiltered = textMessageFilter.contains(msgid);
+        descriptor.named = (msgid == MAVLINK_MSG_ID_DEBUG_VECT || msgid == MAVLINK_MSG_ID_DEBUG
+                            || msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT || msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT);
+
+        const mavlink::MessageTables &tables = mavlink::messageTables();
+        if (tables.timeType[msgid] == MAVLINK_TYPE_UINT32_T)
+        {
+            descriptor.time = TimeBootMs;
+        }
+        else if (tables.timeType[msgid] == MAVLINK_TYPE_UINT64_T)
+        {
+            descriptor.time = TimeUsec;
+        }
+        descriptor.timeOffset = tables.timeOffset[msgid];
+
+        for (unsigned int i = 0; i < info.numFields; ++i)
+        {
+            const mavlink::FieldLayout &fieldInfo = info.fields[i];
+            if (fieldInfo.type > MAVLINK_TYPE_DOUBLE)
+            {
+                QLOG_DEBUG() << "WARNING: UNKNOWN MAVLINK TYPE";
+                descriptor.known = false;
+                break;
+            }
+            FieldDescriptor field;
+            field.offset = fieldInfo.wireOffset;
+            field.type = fieldInfo.type;
+            field.arrayLength = fieldInfo.arrayLength;
+            field.typeSize = typeSizes[fieldInfo.type];
+            field.nameIndex = descriptor.names.size();
+            field.subscribers = 0;
+            field.unit = INTERNED(typeNames[fieldInfo.type]);
+            QString name = QString("%1.%2").arg(info.name).arg(fieldInfo.name);
+            if (field.arrayLength > 0 && field.type != MAVLINK_TYPE_CHAR)
+            {
+                field.unit = StringPool::instance()->intern(field.unit + QString("[%1]").arg(field.arrayLength));
+                for (unsigned int j = 0; j < field.arrayLength; ++j)
+                {
+                    descriptor.names.append(QString("%1.%2").arg(name).arg(j));
+                }
+            }
+            else
+            {
+                descriptor.names.append(name);
+            }
+            descriptor.fields.append(field);
+        }
+    }
+}
+
+int MAVLinkDecoder::fieldIndex(int msgid, const QString &field) const
+{
+    const mavlink::MessageLayout &info = mavlink::messageLayout(msgid);
+    for (int i = 0; i < m_descriptors[msgid].fields.size(); ++i)
+    {
+        if (field == QLatin1String(info.fields[i].name))
         {
-            emitFieldValue(&message, i, time);
+            return i;
         }
     }
+    return -1;
 }
 
+bool MAVLinkDecoder::parseFieldName(const QString &name, int *msgid, QString *field) const
+{
+    // With or without the M<sysid>: prefix, the subscription covers every system
+    QString bare = name.section(':', -1);
+    QHash<QString, int>::const_iterator it = m_messageIds.find(bare.section('.', 0, 0));
+    if (it == m_messageIds.end())
+    {
+        return false;
+    }
+    *msgid = it.value();
+    *field = bare.section('.', 1, 1);
+    return true;
+}
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+void MAVLinkDecoder::addSubscribers(int msgid, int fieldid, int count)
 {
-    UASInterface *uas = UASManager::instance()->getUASForId(msg->sysid);
-    if (!uas)
+    MessageDescriptor &descriptor = m_descriptors[msgid];
+    int &subscribers = descriptor.fields[fieldid].subscribers;
+    bool was = subscribers > 0;
+    subscribers = qMax(0, subscribers + count);
+    if (was != (subscribers > 0))
     {
-        //No active UAS for the incomign message.
-        return;
+        descriptor.subscribed += was ? -1 : 1;
     }
-    bool multiComponentSourceDetected = false;
+}
 
-    // Store component ID
-    if (!componentID.contains(msg->msgid))
+bool MAVLinkDecoder::subscribe(int msgid, const QString &field)
+{
+    if (msgid < 0 || msgid > 255 || !m_descriptors[msgid].known)
+    {
+        return false;
+    }
+    if (field.isEmpty())
     {
-        componentID[msg->msgid] = msg->compid;
+        for (int i = 0; i < m_descriptors[msgid].fields.size(); ++i)
+        {
+            addSubscribers(msgid, i, 1);
+        }
     }
     else
     {
-        // Got this message already
-        if (componentID[msg->msgid] != msg->compid)
+        int fieldid = fieldIndex(msgid, field);
+        if (fieldid < 0)
         {
-            componentMulti[msg->msgid] = true;
+            QLOG_WARN() << "MAVLinkDecoder: no field" << field << "in" << mavlink::messageLayout(msgid).name;
+            return false;
         }
+        addSubscribers(msgid, fieldid, 1);
     }
+    emit subscriptionsChanged();
+    return true;
+}
 
-    if (componentMulti[msg->msgid] == true) multiComponentSourceDetected = true;
+void MAVLinkDecoder::unsubscribe(int msgid, const QString &field)
+{
+    if (msgid < 0 || msgid > 255 || !m_descriptors[msgid].known)
+    {
+        return;
+    }
+    if (field.isEmpty())
+    {
+        for (int i = 0; i < m_descriptors[msgid].fields.size(); ++i)
+        {
+            addSubscribers(msgid, i, -1);
+        }
+    }
+    else
+    {
+        int fieldid = fieldIndex(msgid, field);
+        if (fieldid < 0)
+        {
+            return;
+        }
+        addSubscribers(msgid, fieldid, -1);
+    }
+    emit subscriptionsChanged();
+}
+
+bool MAVLinkDecoder::isSubscribed(int msgid, const QString &field) const
+{
+    if (msgid < 0 || msgid > 255)
+    {
+        return false;
+    }
+    int fieldid = fieldIndex(msgid, field);
+    return fieldid >= 0 && m_descriptors[msgid].fields[fieldid].subscribers > 0;
+}
+
+bool MAVLinkDecoder::subscribeField(const QString &name)
+{
+    int msgid;
+    QString field;
+    if (!parseFieldName(name, &msgid, &field))
+    {
+        QLOG_WARN() << "MAVLinkDecoder: no message for" << name;
+        return false;
+    }
+    return subscribe(msgid, field);
+}
+
+void MAVLinkDecoder::unsubscribeField(const QString &name)
+{
+    int msgid;
+    QString field;
+    if (parseFieldName(name, &msgid, &field))
+    {
+        unsubscribe(msgid, field);
+    }
+}
+
+const QVector<QString> &MAVLinkDecoder::prefixedNames(uint8_t sysid, uint8_t compid, uint8_t msgid, bool multi)
+{
+    quint32 key = (multi ? (1u << 24) | (compid << 8) : 0) | (sysid << 16) | msgid;
+    QHash<quint32, QVector<QString> >::iterator it = m_prefixedNames.find(key);
+    if (it == m_prefixedNames.end())
+    {
+        QString prefix = QString("M%1:").arg(sysid);
+        if (multi)
+        {
+            prefix += QString("C%1:").arg(compid);
+        }
+        QVector<QString> names;
+        foreach (const QString &name, m_descriptors[msgid].names)
+        {
+            names.append(StringPool::instance()->intern(prefix + name));
+        }
+        it = m_prefixedNames.insert(key, names);
+    }
+    return it.value();
+}
 
-    // Add field tree widget item
-    uint8_t msgid = msg->msgid;
-    if (messageFilter.contains(msgid)) return;
-    QString fieldName(messageInfo[msgid].fields[fieldid].name);
-    QString fieldType;
-    uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
-    QString name("%1.%2");
-    QString unit("");
+QVector<QString> MAVLinkDecoder::payloadNames(const mavlink_message_t &msg, quint64 *time)
+{
+    const MessageDescriptor &descriptor = m_descriptors[msg.msgid];
+    const mavlink::MessageLayout &info = mavlink::messageLayout(msg.msgid);
+    const bool multi = componentMulti[msg.msgid];
+    bool perField = false;
+    // sysid, compid when it is part of the name, msgid, then the name (or DEBUG index) in the payload
+    char key[4 + 10];
+    key[0] = static_cast<char>(msg.sysid);
+    key[1] = static_cast<char>(multi ? msg.compid : 0);
+    key[2] = static_cast<char>(msg.msgid);
+    key[3] = multi ? 1 : 0;
+    int keySize = 4;
 
     // Debug vector messages
-    if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
+    if (msg.msgid == MAVLINK_MSG_ID_DEBUG_VECT)
     {
         mavlink_debug_vect_t debug;
-        mavlink_msg_debug_vect_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString("%1.%2").arg(buf).arg(fieldName);
-        time = getUnixTimeFromMs(msg->sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
+        mavlink_msg_debug_vect_decode(&msg, &debug);
+        keySize += qstrnlen(debug.name, 10);
+        memcpy(key + 4, debug.name, keySize - 4);
+        perField = true;
+        *time = getUnixTimeFromMs(msg.sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
     }
-    else if (msgid == MAVLINK_MSG_ID_DEBUG)
+    else if (msg.msgid == MAVLINK_MSG_ID_DEBUG)
     {
         mavlink_debug_t debug;
-        mavlink_msg_debug_decode(msg, &debug);
-        name = name.arg(QString("debug")).arg(debug.ind);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        mavlink_msg_debug_decode(&msg, &debug);
+        key[keySize++] = static_cast<char>(debug.ind);
+        *time = getUnixTimeFromMs(msg.sysid, debug.time_boot_ms);
     }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
+    else if (msg.msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
     {
         mavlink_named_value_float_t debug;
-        mavlink_msg_named_value_float_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        mavlink_msg_named_value_float_decode(&msg, &debug);
+        keySize += qstrnlen(debug.name, 10);
+        memcpy(key + 4, debug.name, keySize - 4);
+        *time = getUnixTimeFromMs(msg.sysid, debug.time_boot_ms);
     }
-    else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
+    else
     {
         mavlink_named_value_int_t debug;
-        mavlink_msg_named_value_int_decode(msg, &debug);
-        char buf[11];
-        strncpy(buf, debug.name, 10);
-        buf[10] = '\0';
-        name = QString(buf);
-        time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
+        mavlink_msg_named_value_int_decode(&msg, &debug);
+        keySize += qstrnlen(debug.name, 10);
+        memcpy(key + 4, debug.name, keySize - 4);
+        *time = getUnixTimeFromMs(msg.sysid, debug.time_boot_ms);
     }
-    else
+
+    // The same few names arrive many times a second, only a new one builds strings
+    QHash<QByteArray, QVector<QString> >::const_iterator it = m_payloadNames.constFind(QByteArray::fromRawData(key, keySize));
+    if (it != m_payloadNames.constEnd())
     {
-        name = name.arg(messageInfo[msgid].name).arg(fieldName);
+        return it.value();
     }
 
-    if (multiComponentSourceDetected)
+    QString name;
+    if (msg.msgid == MAVLINK_MSG_ID_DEBUG)
     {
-        name = name.prepend(QString("C%1:").arg(msg->compid));
+        name = QString("debug.%1").arg(static_cast<uint8_t>(key[4]));
     }
+    else
+    {
+        name = QString::fromUtf8(key + 4, keySize - 4);
+    }
+    if (multi)
+    {
+        name.prepend(QString("C%1:").arg(msg.compid));
+    }
+    name.prepend(QString("M%1:").arg(msg.sysid));
 
-    name = name.prepend(QString("M%1:").arg(msg->sysid));
-
-    switch (messageInfo[msgid].fields[fieldid].type)
+    StringPool *pool = StringPool::instance();
+    QVector<QString> names;
+    for (int i = 0; i < descriptor.fields.size(); ++i)
     {
-    case MAVLINK_TYPE_CHAR:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            char* str = (char*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[messageInfo[msgid].fields[fieldid].array_length-1] = '\0';
-            QString string(name + ": " + str);
-            if (!textMessageFilter.contains(msgid)) emit textMessageReceived(msg->sysid, msg->compid, 0, string);
-        }
-        else
-        {
-            // Single char
-            char b = *((char*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            unit = QString("char[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            //emit valueChanged(msg->sysid, name, unit, b, time);
-            uas->valueChangedRec(msg->sysid,name,unit,b,time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint8_t* nums = m+messageInfo[msgid].fields[fieldid].wire_offset;
-            fieldType = QString("uint8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = "uint8_t";
-            //emit valueChanged(msg->sysid, name, fieldType, u, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, u, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int8_t";
-            //emit valueChanged(msg->sysid, name, fieldType, n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint16_t";
-            //emit valueChanged(msg->sysid, name, fieldType, n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int16_t";
-            //emit valueChanged(msg->sysid, name, fieldType, n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint32_t n = *((uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint32_t";
-            //emit valueChanged(msg->sysid, name, fieldType, n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int32_t* nums = (int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int32_t";
-            //emit valueChanged(msg->sysid, name, fieldType, n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-        }
-        break;
-    case MAVLINK_TYPE_FLOAT:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
+        const FieldDescriptor &field = descriptor.fields[i];
+        QString fieldName = perField ? QString("%1.%2").arg(name).arg(info.fields[i].name) : name;
+        if (field.arrayLength > 0 && field.type != MAVLINK_TYPE_CHAR)
         {
-            float* nums = (float*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("float[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
+            for (unsigned int j = 0; j < field.arrayLength; ++j)
             {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
+                names.append(pool->intern(QString("%1.%2").arg(fieldName).arg(j)));
             }
         }
         else
         {
-            // Single value
-            float f = *((float*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "float";
-            //emit valueChanged(msg->sysid, name, fieldType, f, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, f, time);
+            names.append(pool->intern(fieldName));
         }
-        break;
-    case MAVLINK_TYPE_DOUBLE:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("double[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "double";
-            //emit valueChanged(msg->sysid, name, fieldType, f, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, f, time);
-        }
-        break;
-    case MAVLINK_TYPE_UINT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint64_t* nums = (uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint64_t n = *((uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint64_t";
-            //emit valueChanged(msg->sysid, name, fieldType, (quint64) n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, (quint64) n, time);
-        }
-        break;
-    case MAVLINK_TYPE_INT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                //emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-                uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-            }
-        }
-        else
+    }
+    // Names that change all the time would otherwise grow it without bound
+    if (m_payloadNames.size() >= MaxPayloadNames)
+    {
+        m_payloadNames.clear();
+    }
+    m_payloadNames.insert(QByteArray(key, keySize), names);
+    return names;
+}
+
+bool MAVLinkDecoder::trackComponent(uint8_t msgid, uint8_t compid)
+{
+    // Store component ID
+    if (componentID[msgid] < 0)
+    {
+        componentID[msgid] = compid;
+    }
+    else if (componentID[msgid] != compid)
+    {
+        // Got this message already
+        componentMulti[msgid] = true;
+    }
+    return componentMulti[msgid];
+}
+
+void MAVLinkDecoder::emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time)
+{
+    const MessageDescriptor &descriptor = m_descriptors[msg->msgid];
+    if (!descriptor.known || descriptor.filtered || fieldid >= descriptor.fields.size())
+    {
+        return;
+    }
+    UASInterface *uas = UASManager::instance()->getUASForId(msg->sysid);
+    if (!uas)
+    {
+        //No active UAS for the incomign message.
+        return;
+    }
+    bool multi = trackComponent(msg->msgid, msg->compid);
+    if (descriptor.named)
+    {
+        emitField(uas, *msg, fieldid, time, payloadNames(*msg, &time));
+    }
+    else
+    {
+        emitField(uas, *msg, fieldid, time, prefixedNames(msg->sysid, msg->compid, msg->msgid, multi));
+    }
+}
+
+void MAVLinkDecoder::emitField(UASInterface *uas, const mavlink_message_t &msg, int fieldid, quint64 time, const QVector<QString> &names)
+{
+    const MessageDescriptor &descriptor = m_descriptors[msg.msgid];
+    const FieldDescriptor &field = descriptor.fields[fieldid];
+    const uint8_t *m = (const uint8_t*)_MAV_PAYLOAD(&msg) + field.offset;
+    const QString &name = names[field.nameIndex];
+
+    if (field.type == MAVLINK_TYPE_CHAR && field.arrayLength > 0)
+    {
+        // The record is shared with the other consumers, terminate a copy
+        if (!descriptor.textFiltered)
         {
-            // Single value
-            int64_t n = *((int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int64_t";
-            //emit valueChanged(msg->sysid, name, fieldType, (qint64) n, time);
-            uas->valueChangedRec(msg->sysid, name, fieldType, (qint64) n, time);
+            QByteArray str((const char*)m, qstrnlen((const char*)m, field.arrayLength - 1));
+            emit textMessageReceived(msg.sysid, msg.compid, 0, name + ": " + QString::fromUtf8(str));
         }
-        break;
-    default:
-        QLOG_DEBUG() << "WARNING: UNKNOWN MAVLINK TYPE";
+        return;
+    }
+    if (field.arrayLength == 0)
+    {
+        uas->valueChangedRec(msg.sysid, name, field.unit, fieldValue(field.type, m), time);
+        return;
+    }
+    for (unsigned int j = 0; j < field.arrayLength; ++j)
+    {
+        uas->valueChangedRec(msg.sysid, names[field.nameIndex + j], field.unit, fieldValue(field.type, m + j * field.typeSize), time);
     }
 }
+
 quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
 {
     quint64 ret = 0;
@@ -24,7 +24,9 @@ This file is part of the APM_PLANNER project
  * @file
  *   @brief MAVLinkDecoder
  *          This class decodes value fields from incoming mavlink_message_t packets
- *          It emits valueChanged, which is passed up to the UAS class to emit to the UI
+ *          It emits valueChanged, which is passed up to the UAS class to emit to the UI.
+ *          Only fields somebody subscribed to are decoded, a message without any
+ *          costs a table lookup.
  *
  *   @author Michael Carpenter <malcom2073@gmail.com>
  *   @author QGROUNDCONTROL PROJECT - This code has GPLv3+ snippets from QGROUNDCONTROL, (c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
@@ -39,17 +41,31 @@ This file is part of the APM_PLANNER project
 #include <QThread>
 #include <QFile>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include "QsLog.h"
 //#include "MAVLinkDecoder1.h"
 #include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+#include "MAVLinkMessageRef.h"
 
 class ConnectionManager;
+class UASInterface;
 class MAVLinkDecoder : public QObject
 {
     Q_OBJECT
 public:
     MAVLinkDecoder(QObject *parent=0);
     void passManager(ConnectionManager *manager) { m_connectionManager = manager; }
+    /** @brief Emit a field of msgid from now on, reference counted; an empty name subscribes every field */
+    bool subscribe(int msgid, const QString &field = QString());
+    void unsubscribe(int msgid, const QString &field = QString());
+    bool isSubscribed(int msgid, const QString &field) const;
+    /** @brief Any field of msgid is subscribed */
+    bool isSubscribed(int msgid) const { return msgid >= 0 && msgid < 256 && m_descriptors[msgid].subscribed > 0; }
+    /** @brief Same by "MESSAGE.field" or "MESSAGE" name, for plots and inspectors in QML */
+    Q_INVOKABLE bool subscribeField(const QString &name);
+    Q_INVOKABLE void unsubscribeField(const QString &name);
 private:
     int getSystemId() { return 252; }
     int getComponentId() { return 1; }
@@ -66,15 +82,57 @@ private:
     QMap<int,qint64> currLossCounter;
     bool m_multiplexingEnabled;
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
-    QMap<int,int> componentID;
-    QMap<int,bool> componentMulti;
+    /** @brief What emitting one field needs, resolved from mavlink::messageLayout() once */
+    struct FieldDescriptor
+    {
+        QString unit;            ///< C type, "float[4]" for arrays
+        int nameIndex;           ///< First of its names in MessageDescriptor::names
+        uint16_t offset;         ///< Into the payload
+        uint8_t type;
+        uint8_t arrayLength;
+        uint8_t typeSize;
+        int subscribers;
+    };
+    enum TimeField { TimeNone, TimeBootMs, TimeUsec };
+    struct MessageDescriptor
+    {
+        bool known;
+        bool filtered;           ///< In messageFilter
+        bool textFiltered;       ///< In textMessageFilter
+        bool named;              ///< DEBUG and NAMED_VALUE_*: names come from the payload
+        int subscribed;          ///< Fields with at least one subscriber
+        TimeField time;          ///< Kind of the first field, which then is not emitted
+        uint16_t timeOffset;
+        QVector<FieldDescriptor> fields;
+        QVector<QString> names;  ///< MESSAGE.field, MESSAGE.field.N per array element
+        MessageDescriptor() : known(false), filtered(false), textFiltered(false), named(false), subscribed(0), time(TimeNone), timeOffset(0) { }
+    };
+    void buildDescriptors();
+    int fieldIndex(int msgid, const QString &field) const;
+    bool parseFieldName(const QString &name, int *msgid, QString *field) const;
+    void addSubscribers(int msgid, int fieldid, int count);
+    /** @brief names of msgid with the M<sysid>: and C<compid>: prefixes, built on first use */
+    const QVector<QString> &prefixedNames(uint8_t sysid, uint8_t compid, uint8_t msgid, bool multi);
+    /** @brief Names and time of the payload named messages, cached by the raw name in the payload */
+    QVector<QString> payloadNames(const mavlink_message_t &msg, quint64 *time);
+    /** @brief True once a message ID has come from more than one component */
+    bool trackComponent(uint8_t msgid, uint8_t compid);
+    void emitField(UASInterface *uas, const mavlink_message_t &msg, int fieldid, quint64 time, const QVector<QString> &names);
+    MessageDescriptor m_descriptors[256];
+    QHash<quint32, QVector<QString> > m_prefixedNames;
+    enum { MaxPayloadNames = 512 };                   ///< Distinct named values kept before the cache starts over
+    QHash<QByteArray, QVector<QString> > m_payloadNames;
+    QHash<QString, int> m_messageIds;
+    qint16 componentID[256];                          ///< First component a message ID came from, -1 for none yet
+    bool componentMulti[256];
     QMap<uint16_t, bool> messageFilter;               ///< Message/field names not to emit
     QMap<uint16_t, bool> textMessageFilter;           ///< Message/field names not to emit in text mode
-    mavlink_message_t receivedMessages[256]; ///< Available / known messages
-    mavlink_message_info_t messageInfo[256]; ///< Message information
     QMap<int,quint64> onboardTimeOffset;
     QMap<int,quint64> firstOnboardTime;
-    QMap<int,quint64> onboardToGCSUnixTimeOffsetAndDelay;
+    QMap<int,quint64> onboardToGCSUnixTimeOffsetAndDelay; ///< Filtered GCS minus onboard clock, half the round trip removed
+    QMap<int,double> clockOffset;                        ///< Unrounded filter state of the above
+    QMap<int,int> clockOffsetOutliers;                   ///< Consecutive samples far off the estimate
+    QMap<int,double> roundTripTime;
 
 signals:
 
@@ -83,10 +141,15 @@ signals:
     void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
     void receiveLossChanged(int id,float value);
+    void subscriptionsChanged();
 public slots:
     void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    /** @brief Decode a shared record without copying it */
+    void receiveMessageRef(LinkInterface* link, const MAVLinkMessageRef &ref);
     void sendMessage(mavlink_message_t msg);
-    void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    void emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time);
+    /** @brief Latest smoothed round trip to a system, used to compensate SYSTEM_TIME */
+    void setRoundTripTime(int linkId, int sysid, double milliseconds);
 };
 
 #endif // NEW_MAVLINKDECODER_H
@@ -0,0 +1,127 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkDispatcher
+ *          See MAVLinkDispatcher.h
+ *
+ */
+
+#include "MAVLinkDispatcher.h"
+
+MAVLinkDispatcher::MAVLinkDispatcher(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void MAVLinkDispatcher::subscribe(int sysid, int msgid, Handler handler, QObject *receiver)
+{
+    Q_ASSERT_X(msgid >= AnyMessage && msgid < 256, "MAVLinkDispatcher::subscribe", "msgid out of range");
+    Subscription subscription;
+    subscription.sysid = sysid;
+    subscription.handler = handler;
+    subscription.receiver = receiver;
+    if (msgid == AnyMessage)
+    {
+        m_anyMessage.append(subscription);
+    }
+    else
+    {
+        m_table[msgid].append(subscription);
+    }
+    connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(unsubscribe(QObject*)), Qt::UniqueConnection);
+    emit subscriptionsChanged();
+}
+
+void MAVLinkDispatcher::require(int sysid, int msgid, QObject *receiver)
+{
+    Q_ASSERT_X(msgid >= 0 && msgid < 256, "MAVLinkDispatcher::require", "msgid out of range");
+    Subscription subscription;
+    subscription.sysid = sysid;
+    subscription.handler = NULL;
+    subscription.receiver = receiver;
+    m_required[msgid].append(subscription);
+    connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(unsubscribe(QObject*)), Qt::UniqueConnection);
+    emit subscriptionsChanged();
+}
+
+bool MAVLinkDispatcher::isWanted(int sysid, int msgid) const
+{
+    if (msgid < 0 || msgid > 255)
+    {
+        return false;
+    }
+    for (int list = 0; list < 2; list++)
+    {
+        const QVector<Subscription> &subscriptions = list == 0 ? m_table[msgid] : m_required[msgid];
+        for (int i = 0; i < subscriptions.size(); i++)
+        {
+            if (subscriptions.at(i).sysid == AnySystem || subscriptions.at(i).sysid == sysid) return true;
+        }
+    }
+    return false;
+}
+
+void MAVLinkDispatcher::unsubscribe(QObject *receiver)
+{
+    for (int i = m_anyMessage.size() - 1; i >= 0; i--)
+    {
+        if (m_anyMessage.at(i).receiver == receiver) m_anyMessage.remove(i);
+    }
+    for (int msgid = 0; msgid < 256; msgid++)
+    {
+        QVector<Subscription> &subscriptions = m_table[msgid];
+        for (int i = subscriptions.size() - 1; i >= 0; i--)
+        {
+            if (subscriptions.at(i).receiver == receiver) subscriptions.remove(i);
+        }
+        QVector<Subscription> &required = m_required[msgid];
+        for (int i = required.size() - 1; i >= 0; i--)
+        {
+            if (required.at(i).receiver == receiver) required.remove(i);
+        }
+    }
+    disconnect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(unsubscribe(QObject*)));
+    emit subscriptionsChanged();
+}
+
+void MAVLinkDispatcher::dispatch(LinkInterface *link, const MAVLinkMessageRef &message) const
+{
+    // Catch-all consumers first, they track links and components the others rely on
+    deliver(m_anyMessage, link, message);
+    deliver(m_table[message->msgid], link, message);
+}
+
+void MAVLinkDispatcher::deliver(const QVector<Subscription> &subscriptions, LinkInterface *link, const MAVLinkMessageRef &message)
+{
+    // Iterate a shallow copy so a handler may (un)subscribe while we deliver
+    const QVector<Subscription> current = subscriptions;
+    for (int i = 0; i < current.size(); i++)
+    {
+        const Subscription &subscription = current.at(i);
+        if (subscription.sysid == AnySystem || subscription.sysid == message->sysid)
+        {
+            subscription.handler(subscription.receiver, link, message);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkDispatcher
+ *          Routes decoded messages to the consumers that asked for them. A consumer
+ *          subscribes to a message ID (or all of them) from one system (or any),
+ *          and each frame only visits the 256 entry table slot of its own ID.
+ *
+ */
+
+#ifndef MAVLINKDISPATCHER_H
+#define MAVLINKDISPATCHER_H
+
+#include <QObject>
+#include <QVector>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+#include "MAVLinkMessageRef.h"
+
+class MAVLinkDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    enum { AnySystem = -1, AnyMessage = -1 };
+    typedef void (*Handler)(QObject *receiver, LinkInterface *link, const MAVLinkMessageRef &message);
+
+    /** @brief Handler calling a by-value member slot, e.g. call<UASObject, &UASObject::messageReceived> */
+    template <class T, void (T::*Method)(LinkInterface*, mavlink_message_t)>
+    static void call(QObject *receiver, LinkInterface *link, const MAVLinkMessageRef &message)
+    {
+        (static_cast<T*>(receiver)->*Method)(link, message.message());
+    }
+
+    /** @brief Handler for members that take the shared record and may keep it */
+    template <class T, void (T::*Method)(LinkInterface*, const MAVLinkMessageRef&)>
+    static void callRef(QObject *receiver, LinkInterface *link, const MAVLinkMessageRef &message)
+    {
+        (static_cast<T*>(receiver)->*Method)(link, message);
+    }
+
+    explicit MAVLinkDispatcher(QObject *parent = 0);
+
+    /** @brief Deliver msgid (or AnyMessage) from sysid (or AnySystem) to receiver until it is destroyed */
+    void subscribe(int sysid, int msgid, Handler handler, QObject *receiver);
+    void dispatch(LinkInterface *link, const MAVLinkMessageRef &message) const;
+
+    /**
+     * @brief Ask for msgid from sysid without a handler, until receiver is destroyed or unsubscribed
+     *
+     * For consumers that read a message through another object's signals,
+     * e.g. UAS's, so the stream is not turned off under them.
+     */
+    void require(int sysid, int msgid, QObject *receiver);
+    /** @brief Somebody subscribed to or required msgid itself, catch-all subscriptions do not count */
+    bool isWanted(int sysid, int msgid) const;
+
+public slots:
+    void unsubscribe(QObject *receiver);
+
+signals:
+    /** @brief A subscription was added or removed, see isWanted() */
+    void subscriptionsChanged();
+
+private:
+    struct Subscription
+    {
+        int sysid;
+        Handler handler;
+        QObject *receiver;
+    };
+    static void deliver(const QVector<Subscription> &subscriptions, LinkInterface *link, const MAVLinkMessageRef &message);
+
+    QVector<Subscription> m_anyMessage;
+    QVector<Subscription> m_table[256];
+    QVector<Subscription> m_required[256];  ///< require(), no handler
+};
+
+#endif // MAVLINKDISPATCHER_H
@@ -0,0 +1,341 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkFanout
+ *          See MAVLinkFanout.h
+ *
+ */
+
+#include "MAVLinkFanout.h"
+#include "QsLog.h"
+#include "ThreadRoles.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QMutexLocker>
+#include <cstring>
+
+MAVLinkFanout::MAVLinkFanout() :
+    m_ring(new char[RingBytes]),
+    m_head(0),
+    m_active(0),
+    m_wakePending(0),
+    m_tcpCount(0),
+    m_udpCount(0),
+    m_dropped(0),
+    m_skipped(0),
+    m_tcpPort(0),
+    m_server(NULL),
+    m_udpSocket(NULL)
+{
+    // Sockets are created, written and serviced on the fan-out thread
+    moveToThread(this);
+    start();
+}
+
+MAVLinkFanout::~MAVLinkFanout()
+{
+    quit();
+    wait();
+    delete[] m_ring;
+}
+
+void MAVLinkFanout::run()
+{
+    ThreadRoles::enter(ThreadRoles::LinkIo);
+    exec();
+}
+
+void MAVLinkFanout::setTcpPort(quint16 port)
+{
+    m_tcpPort = port;
+    QMetaObject::invokeMethod(this, "listen", Qt::QueuedConnection, Q_ARG(int, port));
+}
+
+void MAVLinkFanout::addUdpSubscriber(const QHostAddress &address, quint16 port)
+{
+    {
+        QMutexLocker locker(&m_udpListMutex);
+        QPair<QHostAddress,quint16> subscriber(address, port);
+        if (m_udpList.contains(subscriber))
+        {
+            return;
+        }
+        m_udpList.append(subscriber);
+    }
+    QMetaObject::invokeMethod(this, "addUdp", Qt::QueuedConnection, Q_ARG(QString, address.toString()), Q_ARG(int, port));
+}
+
+void MAVLinkFanout::removeUdpSubscriber(const QHostAddress &address, quint16 port)
+{
+    {
+        QMutexLocker locker(&m_udpListMutex);
+        m_udpList.removeAll(QPair<QHostAddress,quint16>(address, port));
+    }
+    QMetaObject::invokeMethod(this, "removeUdp", Qt::QueuedConnection, Q_ARG(QString, address.toString()), Q_ARG(int, port));
+}
+
+QList<QPair<QHostAddress,quint16> > MAVLinkFanout::udpSubscribers() const
+{
+    QMutexLocker locker(&m_udpListMutex);
+    return m_udpList;
+}
+
+void MAVLinkFanout::publish(const char *data, int size)
+{
+    if (!isActive() || size <= 0 || size > RingBytes)
+    {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_ringMutex);
+        int position = static_cast<int>(m_head % RingBytes);
+        int first = qMin(size, RingBytes - position);
+        memcpy(m_ring + position, data, first);
+        memcpy(m_ring, data + first, size - first);
+        m_head += size;
+    }
+    // One queued drain() however many frames arrive before it runs
+    if (m_wakePending.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    }
+}
+
+MAVLinkFanout::Stats MAVLinkFanout::stats() const
+{
+    Stats stats;
+    stats.tcpSubscribers = m_tcpCount.loadAcquire();
+    stats.udpSubscribers = m_udpCount.loadAcquire();
+    stats.publishedBytes = head();
+    stats.dropped = m_dropped.loadAcquire();
+    stats.skipped = m_skipped.loadAcquire();
+    return stats;
+}
+
+qint64 MAVLinkFanout::head() const
+{
+    QMutexLocker locker(&m_ringMutex);
+    return m_head;
+}
+
+void MAVLinkFanout::read(qint64 from, qint64 to, QByteArray *out) const
+{
+    int size = static_cast<int>(to - from);
+    out->resize(size);
+    QMutexLocker locker(&m_ringMutex);
+    int position = static_cast<int>(from % RingBytes);
+    int first = qMin(size, RingBytes - position);
+    memcpy(out->data(), m_ring + position, first);
+    memcpy(out->data() + first, m_ring, size - first);
+}
+
+void MAVLinkFanout::updateActive()
+{
+    m_tcpCount.storeRelease(m_tcp.size());
+    m_udpCount.storeRelease(m_udp.size());
+    m_active.storeRelease(m_tcp.isEmpty() && m_udp.isEmpty() ? 0 : 1);
+}
+
+void MAVLinkFanout::listen(int port)
+{
+    while (!m_tcp.isEmpty())
+    {
+        m_tcp.first().socket->abort();
+        m_tcp.first().socket->deleteLater();
+        m_tcp.removeFirst();
+    }
+    updateActive();
+    if (!m_server)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+    }
+    m_server->close();
+    if (port == 0)
+    {
+        return;
+    }
+    if (!m_server->listen(QHostAddress::Any, port))
+    {
+        QLOG_ERROR() << "Telemetry fan-out cannot listen on port" << port << m_server->errorString();
+        return;
+    }
+    QLOG_INFO() << "Telemetry fan-out listening on TCP port" << port;
+}
+
+void MAVLinkFanout::addUdp(QString address, int port)
+{
+    if (!m_udpSocket)
+    {
+        m_udpSocket = new QUdpSocket(this);
+    }
+    UdpSubscriber subscriber;
+    // Queued as text, QHostAddress is no registered meta type
+    subscriber.address = QHostAddress(address);
+    subscriber.port = static_cast<quint16>(port);
+    subscriber.cursor = head();
+    m_udp.append(subscriber);
+    updateActive();
+}
+
+void MAVLinkFanout::removeUdp(QString address, int port)
+{
+    for (int i = m_udp.size() - 1; i >= 0; --i)
+    {
+        if (m_udp.at(i).address == QHostAddress(address) && m_udp.at(i).port == port)
+        {
+            m_udp.removeAt(i);
+        }
+    }
+    updateActive();
+}
+
+void MAVLinkFanout::newConnection()
+{
+    while (m_server->hasPendingConnections())
+    {
+        TcpSubscriber subscriber;
+        subscriber.socket = m_server->nextPendingConnection();
+        subscriber.socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(subscriber.socket, SIGNAL(disconnected()), this, SLOT(subscriberDisconnected()));
+        connect(subscriber.socket, SIGNAL(readyRead()), this, SLOT(subscriberRead()));
+        // Joins at a frame boundary, the next frame published
+        subscriber.cursor = head();
+        m_tcp.append(subscriber);
+        QLOG_INFO() << "Telemetry fan-out subscriber" << subscriber.socket->peerAddress().toString()
+                    << subscriber.socket->peerPort();
+    }
+    updateActive();
+}
+
+void MAVLinkFanout::subscriberDisconnected()
+{
+    for (int i = 0; i < m_tcp.size(); ++i)
+    {
+        if (m_tcp.at(i).socket == sender())
+        {
+            m_tcp.at(i).socket->deleteLater();
+            m_tcp.removeAt(i);
+            break;
+        }
+    }
+    updateActive();
+}
+
+void MAVLinkFanout::subscriberRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    if (socket)
+    {
+        socket->readAll();
+    }
+}
+
+void MAVLinkFanout::dropTcp(int index)
+{
+    QTcpSocket *socket = m_tcp.at(index).socket;
+    QLOG_WARN() << "Telemetry fan-out dropped slow subscriber" << socket->peerAddress().toString() << socket->peerPort();
+    QObject::disconnect(socket, 0, this, 0);
+    socket->abort();
+    socket->deleteLater();
+    m_tcp.removeAt(index);
+    m_dropped.ref();
+}
+
+void MAVLinkFanout::drain()
+{
+    // Cleared first, frames published from here on queue another drain()
+    m_wakePending.storeRelease(0);
+    qint64 end = head();
+    qint64 oldest = end - RingBytes;
+
+    // Anyone a whole ring behind has lost frames; TCP would get a broken stream
+    for (int i = m_tcp.size() - 1; i >= 0; --i)
+    {
+        if (m_tcp.at(i).cursor < oldest || m_tcp.at(i).socket->bytesToWrite() > MaxQueuedBytes)
+        {
+            dropTcp(i);
+        }
+    }
+    qint64 start = end;
+    for (int i = 0; i < m_tcp.size(); ++i)
+    {
+        start = qMin(start, m_tcp.at(i).cursor);
+    }
+    for (int i = 0; i < m_udp.size(); ++i)
+    {
+        if (m_udp.at(i).cursor < oldest)
+        {
+            // The frame boundaries in between are gone, go on with the next frame
+            m_udp[i].cursor = end;
+            m_skipped.ref();
+        }
+        start = qMin(start, m_udp.at(i).cursor);
+    }
+    updateActive();
+    if (start >= end)
+    {
+        return;
+    }
+
+    // One copy out of the ring, every subscriber sends its tail of it
+    QByteArray chunk;
+    read(start, end, &chunk);
+    for (int i = 0; i < m_tcp.size(); ++i)
+    {
+        TcpSubscriber &subscriber = m_tcp[i];
+        int offset = static_cast<int>(subscriber.cursor - start);
+        subscriber.socket->write(chunk.constData() + offset, chunk.size() - offset);
+        subscriber.cursor = end;
+    }
+    for (int i = 0; i < m_udp.size(); ++i)
+    {
+        sendDatagrams(m_udp.at(i), chunk, static_cast<int>(m_udp.at(i).cursor - start));
+        m_udp[i].cursor = end;
+    }
+}
+
+void MAVLinkFanout::sendDatagrams(const UdpSubscriber &subscriber, const QByteArray &chunk, int offset)
+{
+    // The ring only holds whole v1 frames, see MAVLinkProtocol::parseBytes
+    const char *data = chunk.constData();
+    int size = chunk.size();
+    int datagram = offset;
+    while (offset < size)
+    {
+        int frame = (offset + 1 < size) ? MAVLINK_NUM_NON_PAYLOAD_BYTES + static_cast<quint8>(data[offset + 1]) : size - offset;
+        if (offset + frame - datagram > DatagramBytes && offset > datagram)
+        {
+            m_udpSocket->writeDatagram(data + datagram, offset - datagram, subscriber.address, subscriber.port);
+            datagram = offset;
+        }
+        offset = qMin(size, offset + frame);
+    }
+    if (offset > datagram)
+    {
+        m_udpSocket->writeDatagram(data + datagram, offset - datagram, subscriber.address, subscriber.port);
+    }
+}
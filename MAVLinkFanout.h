@@ -0,0 +1,142 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkFanout
+ *          Serves the received MAVLink stream to further consumers, such as
+ *          a second GCS or a logging box, over TCP and UDP. The ingest
+ *          thread copies every accepted frame once into a shared ring; each
+ *          subscriber only has a read cursor into it. The fan-out thread
+ *          writes the new bytes to the subscribers, so the ingest path pays
+ *          a memcpy per frame however many there are.
+ *
+ *          A subscriber that falls a whole ring behind, or whose socket has
+ *          MaxQueuedBytes waiting, is dropped instead of holding anything up.
+ *          UDP subscribers get whole frames per datagram and skip ahead.
+ *
+ */
+
+#ifndef MAVLINKFANOUT_H
+#define MAVLINKFANOUT_H
+
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QList>
+#include <QPair>
+#include <QHostAddress>
+
+class QTcpServer;
+class QTcpSocket;
+class QUdpSocket;
+
+class MAVLinkFanout : public QThread
+{
+    Q_OBJECT
+public:
+    enum {
+        RingBytes = 1 << 20,            ///< About a minute of a busy 115200 baud link
+        MaxQueuedBytes = 256 * 1024,    ///< Unsent bytes a TCP subscriber may have
+        DatagramBytes = 1400            ///< Largest UDP datagram, frames are not split
+    };
+
+    struct Stats
+    {
+        int tcpSubscribers;
+        int udpSubscribers;
+        qint64 publishedBytes;
+        int dropped;            ///< TCP subscribers dropped for being too slow
+        int skipped;            ///< Times a UDP subscriber skipped ahead
+        Stats() : tcpSubscribers(0), udpSubscribers(0), publishedBytes(0), dropped(0), skipped(0) {}
+    };
+
+    /** @brief Moves itself to its own thread, so it cannot have a parent */
+    MAVLinkFanout();
+    ~MAVLinkFanout();
+
+    /** @brief Accept TCP subscribers on port, 0 to stop listening and drop them */
+    void setTcpPort(quint16 port);
+    quint16 tcpPort() const { return m_tcpPort; }
+    void addUdpSubscriber(const QHostAddress &address, quint16 port);
+    void removeUdpSubscriber(const QHostAddress &address, quint16 port);
+    QList<QPair<QHostAddress,quint16> > udpSubscribers() const;
+
+    /** @brief True while anyone could be listening, publish() is a no-op otherwise */
+    bool isActive() const { return m_active.loadAcquire() != 0; }
+    /** @brief Append one frame. Ingest thread */
+    void publish(const char *data, int size);
+    Stats stats() const;
+
+protected:
+    void run();
+
+private slots:
+    void listen(int port);
+    void addUdp(QString address, int port);
+    void removeUdp(QString address, int port);
+    void newConnection();
+    void subscriberDisconnected();
+    /** @brief Subscribers only listen, what they send is dropped */
+    void subscriberRead();
+    void drain();
+
+private:
+    struct TcpSubscriber
+    {
+        QTcpSocket *socket;
+        qint64 cursor;          ///< Ring position of the next byte to send
+    };
+    struct UdpSubscriber
+    {
+        QHostAddress address;
+        quint16 port;
+        qint64 cursor;
+    };
+    /** @brief Copy ring bytes [from, to) out, they must be less than a ring behind */
+    void read(qint64 from, qint64 to, QByteArray *out) const;
+    qint64 head() const;
+    void sendDatagrams(const UdpSubscriber &subscriber, const QByteArray &chunk, int offset);
+    void dropTcp(int index);
+    void updateActive();
+
+    mutable QMutex m_ringMutex;     ///< Guards m_ring and m_head, held for a memcpy
+    char *m_ring;
+    qint64 m_head;                  ///< Bytes published so far, the write position
+    QAtomicInt m_active;
+    QAtomicInt m_wakePending;       ///< A drain() is queued
+    QAtomicInt m_tcpCount;
+    QAtomicInt m_udpCount;
+    QAtomicInt m_dropped;
+    QAtomicInt m_skipped;
+
+    // Owned by the fan-out thread
+    quint16 m_tcpPort;
+    QTcpServer *m_server;
+    QUdpSocket *m_udpSocket;
+    QList<TcpSubscriber> m_tcp;
+    QList<UdpSubscriber> m_udp;
+    mutable QMutex m_udpListMutex;  ///< udpSubscribers() reads the list from the UI thread
+    QList<QPair<QHostAddress,quint16> > m_udpList;
+};
+
+#endif // MAVLINKFANOUT_H
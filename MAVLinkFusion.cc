@@ -0,0 +1,339 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkFusion
+ *          See MAVLinkFusion.h
+ *
+ */
+
+#include "MAVLinkFusion.h"
+#include "MAVLinkLatencyProbe.h"
+#include "MAVLinkSender.h"
+#include "QsLog.h"
+#include <QPointer>
+#include <QSet>
+#include <cstring>
+
+// A better link has to beat the current one by this much to take over the outbound traffic
+static const double SwitchMargin = 2.0;
+// Round trip milliseconds that weigh as much as one percent of loss
+static const double RoundTripPerLossPercent = 50.0;
+
+/** @brief The last 256 sequence numbers of one system / component in a group */
+struct MAVLinkFusion::Window
+{
+    bool started;
+    quint8 head;                ///< Newest sequence number seen
+    quint32 seen[256 / 32];
+    quint16 checksum[256];      ///< Tells a copy from a different frame after a reboot
+    quint8 msgid[256];
+
+    Window() : started(false), head(0)
+    {
+        memset(seen, 0, sizeof(seen));
+    }
+    bool test(quint8 seq) const { return seen[seq >> 5] & (1u << (seq & 31)); }
+    void set(quint8 seq) { seen[seq >> 5] |= 1u << (seq & 31); }
+    void clear(quint8 seq) { seen[seq >> 5] &= ~(1u << (seq & 31)); }
+};
+
+struct MAVLinkFusion::Group
+{
+    int id;
+    QList<int> links;
+    int best;                           ///< Link ID of the outbound link, -1 before the first sample
+    QHash<int, Window*> windows;        ///< By sysid / compid, ingest thread only
+
+    explicit Group(int id) : id(id), best(-1) { }
+    ~Group() { qDeleteAll(windows); }
+};
+
+struct MAVLinkFusion::Member
+{
+    int linkId;
+    QPointer<LinkInterface> link;
+    QSharedPointer<Group> group;
+    QAtomicInt frames;
+    QAtomicInt first;
+    QAtomicInt duplicates;
+    QAtomicInt lost;
+    QHash<int, qint16> lastSeq;         ///< By sysid / compid, ingest thread only
+    // UI thread
+    quint32 sampledFrames;
+    quint32 sampledLost;
+    float recentLoss;
+
+    Member() : linkId(-1), sampledFrames(0), sampledLost(0), recentLoss(0) { }
+};
+
+MAVLinkFusion::MAVLinkFusion(MAVLinkLatencyProbe *latencyProbe, QObject *parent) :
+    QObject(parent),
+    m_latencyProbe(latencyProbe)
+{
+}
+
+MAVLinkFusion::~MAVLinkFusion()
+{
+}
+
+void MAVLinkFusion::leave(int linkId)
+{
+    QSharedPointer<Member> member = m_members.take(linkId);
+    if (!member)
+    {
+        return;
+    }
+    Group &group = *member->group;
+    group.links.removeAll(linkId);
+    if (group.links.isEmpty())
+    {
+        m_groups.remove(group.id);
+    }
+    else if (group.best == linkId)
+    {
+        group.best = -1;
+    }
+}
+
+void MAVLinkFusion::setGroup(LinkInterface *link, int group)
+{
+    int linkId = link->getId();
+    QMutexLocker locker(&m_mutex);
+    QSharedPointer<Member> old = m_members.value(linkId);
+    if (old ? old->group->id == group : group <= 0)
+    {
+        return;
+    }
+    leave(linkId);
+    if (group <= 0)
+    {
+        QLOG_INFO() << "Link" << linkId << "left its link group";
+        return;
+    }
+    QSharedPointer<Group> &target = m_groups[group];
+    if (!target)
+    {
+        target = QSharedPointer<Group>(new Group(group));
+    }
+    // A fresh member, so reads still in flight on the ingest thread keep the old state
+    QSharedPointer<Member> member(new Member);
+    member->linkId = linkId;
+    member->link = link;
+    member->group = target;
+    target->links.append(linkId);
+    m_members.insert(linkId, member);
+    QLOG_INFO() << "Link" << linkId << "joined link group" << group;
+}
+
+int MAVLinkFusion::group(int linkId) const
+{
+    QMutexLocker locker(&m_mutex);
+    QSharedPointer<Member> member = m_members.value(linkId);
+    return member ? member->group->id : 0;
+}
+
+void MAVLinkFusion::removeLink(int linkId)
+{
+    QMutexLocker locker(&m_mutex);
+    leave(linkId);
+}
+
+QSharedPointer<MAVLinkFusion::Member> MAVLinkFusion::member(int linkId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_members.value(linkId);
+}
+
+bool MAVLinkFusion::accept(Member *member, const mavlink_message_t &message)
+{
+    member->frames.fetchAndAddRelaxed(1);
+    int key = (message.sysid << 8) | message.compid;
+
+    // Loss of this link on its own
+    QHash<int, qint16>::iterator last = member->lastSeq.find(key);
+    if (last == member->lastSeq.end())
+    {
+        member->lastSeq.insert(key, message.seq);
+    }
+    else
+    {
+        quint8 gap = static_cast<quint8>(message.seq - last.value() - 1);
+        if (gap < 128)
+        {
+            member->lost.fetchAndAddRelaxed(gap);
+        }
+        last.value() = message.seq;
+    }
+
+    Window *&slot = member->group->windows[key];
+    if (!slot)
+    {
+        slot = new Window;
+    }
+    Window &window = *slot;
+    quint8 seq = message.seq;
+    if (!window.started)
+    {
+        window.started = true;
+        window.head = seq;
+    }
+    quint8 ahead = static_cast<quint8>(seq - window.head);
+    if (ahead > 0 && ahead < 128)
+    {
+        // Newer than anything seen, the numbers skipped over are free again
+        for (quint8 s = window.head + 1; s != seq; ++s)
+        {
+            window.clear(s);
+        }
+        window.head = seq;
+    }
+    else if (window.test(seq) && window.checksum[seq] == message.checksum && window.msgid[seq] == message.msgid)
+    {
+        member->duplicates.fetchAndAddRelaxed(1);
+        // Round trip probes measure each link, their replies count everywhere
+        return message.msgid == MAVLINK_MSG_ID_PING;
+    }
+    window.set(seq);
+    window.checksum[seq] = message.checksum;
+    window.msgid[seq] = message.msgid;
+    member->first.fetchAndAddRelaxed(1);
+    return true;
+}
+
+QList<LinkInterface*> MAVLinkFusion::sendLinks(const QList<LinkInterface*> &links, int msgid) const
+{
+    bool control = MAVLinkSender::priorityOf(msgid) == MAVLinkSender::ControlPriority;
+    QList<LinkInterface*> result;
+    QSet<int> groupsDone;
+    QMutexLocker locker(&m_mutex);
+    foreach (LinkInterface *link, links)
+    {
+        QSharedPointer<Member> member = m_members.value(link->getId());
+        if (!member)
+        {
+            result.append(link);
+            continue;
+        }
+        const Group &group = *member->group;
+        if (groupsDone.contains(group.id))
+        {
+            continue;
+        }
+        groupsDone.insert(group.id);
+        // The whole group, also links the vehicle was never heard on first
+        LinkInterface *fallback = 0;
+        bool added = false;
+        foreach (int linkId, group.links)
+        {
+            QSharedPointer<Member> other = m_members.value(linkId);
+            if (!other || !other->link || !other->link->isConnected())
+            {
+                continue;
+            }
+            if (control || linkId == group.best)
+            {
+                result.append(other->link);
+                added = true;
+            }
+            else if (!fallback)
+            {
+                fallback = other->link;
+            }
+        }
+        if (!added && fallback)
+        {
+            result.append(fallback);
+        }
+    }
+    return result;
+}
+
+void MAVLinkFusion::sample()
+{
+    QMutexLocker locker(&m_mutex);
+    foreach (QSharedPointer<Member> member, m_members)
+    {
+        quint32 frames = member->frames.load();
+        quint32 lost = member->lost.load();
+        quint32 newFrames = frames - member->sampledFrames;
+        quint32 newLost = lost - member->sampledLost;
+        member->sampledFrames = frames;
+        member->sampledLost = lost;
+        member->recentLoss = (newFrames + newLost) > 0 ? 100.0f * newLost / (newFrames + newLost)
+                                                       : (newFrames == 0 ? 100.0f : 0.0f);
+    }
+    foreach (QSharedPointer<Group> group, m_groups)
+    {
+        int best = -1;
+        double bestScore = 0;
+        double currentScore = -1;
+        foreach (int linkId, group->links)
+        {
+            QSharedPointer<Member> member = m_members.value(linkId);
+            if (!member || !member->link || !member->link->isConnected())
+            {
+                continue;
+            }
+            double score = member->recentLoss + m_latencyProbe->stats(linkId).smoothed / RoundTripPerLossPercent;
+            if (linkId == group->best)
+            {
+                currentScore = score;
+            }
+            if (best < 0 || score < bestScore)
+            {
+                best = linkId;
+                bestScore = score;
+            }
+        }
+        if (currentScore >= 0 && currentScore - bestScore < SwitchMargin)
+        {
+            continue;
+        }
+        if (best != group->best)
+        {
+            QLOG_INFO() << "Link group" << group->id << "now sends on link" << best;
+            group->best = best;
+        }
+    }
+}
+
+MAVLinkFusion::LinkStats MAVLinkFusion::stats(int linkId) const
+{
+    LinkStats stats;
+    QMutexLocker locker(&m_mutex);
+    QSharedPointer<Member> member = m_members.value(linkId);
+    if (!member)
+    {
+        return stats;
+    }
+    stats.group = member->group->id;
+    stats.frames = member->frames.load();
+    stats.first = member->first.load();
+    stats.duplicates = member->duplicates.load();
+    stats.lost = member->lost.load();
+    stats.recentLoss = member->recentLoss;
+    stats.roundTrip = m_latencyProbe->stats(linkId).smoothed;
+    stats.best = member->group->best == linkId;
+    return stats;
+}
@@ -0,0 +1,107 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkFusion
+ *          Redundant links to the same vehicle, e.g. a 900 MHz radio and LTE
+ *          over UDP, joined into a group. A frame that arrives on several
+ *          links of a group, same system, component, sequence number and
+ *          checksum, is passed on once, by whichever link delivered it first;
+ *          the UAS objects, the log and the loss statistics see one stream.
+ *          De-duplication is a 256 entry window per system / component and O(1)
+ *          per frame on the ingest thread.
+ *
+ *          Outbound traffic of a group goes on its best link, the one with the
+ *          least loss and round trip over the last second; control messages
+ *          (commands, mission and parameter handshakes) go on all of them.
+ *
+ */
+
+#ifndef MAVLINKFUSION_H
+#define MAVLINKFUSION_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+
+class MAVLinkLatencyProbe;
+
+class MAVLinkFusion : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief One link of a group */
+    struct LinkStats
+    {
+        int group;              ///< 0 if the link is on its own
+        quint32 frames;         ///< Frames received, duplicates included
+        quint32 first;          ///< Frames this link delivered before any other
+        quint32 duplicates;     ///< Frames another link had delivered already
+        quint32 lost;           ///< Sequence gaps on this link alone
+        float recentLoss;       ///< Percent over the last second
+        double roundTrip;       ///< Smoothed PING round trip in ms, 0 if unknown
+        bool best;              ///< Carries the group's outbound traffic
+        LinkStats() : group(0), frames(0), first(0), duplicates(0), lost(0),
+            recentLoss(0), roundTrip(0), best(false) { }
+    };
+
+    /** @brief Opaque per link state, see member() */
+    struct Member;
+
+    MAVLinkFusion(MAVLinkLatencyProbe *latencyProbe, QObject *parent = 0);
+    ~MAVLinkFusion();
+
+    /** @brief Put link in group, 0 takes it out of any. UI thread */
+    void setGroup(LinkInterface *link, int group);
+    int group(int linkId) const;
+    void removeLink(int linkId);
+
+    /** @brief State of a grouped link for accept(), null if the link is on its own. Once per read */
+    QSharedPointer<Member> member(int linkId) const;
+    /** @brief False if the frame is a copy another link of the group already delivered. Ingest thread only */
+    bool accept(Member *member, const mavlink_message_t &message);
+
+    /** @brief Where a message for links goes: the best link of each group, all of them for control messages */
+    QList<LinkInterface*> sendLinks(const QList<LinkInterface*> &links, int msgid) const;
+
+    /** @brief Re-rate the links of every group, once a second. UI thread */
+    void sample();
+    LinkStats stats(int linkId) const;
+
+private:
+    struct Window;
+    struct Group;
+    /** @brief Take a link out of its group, m_mutex held */
+    void leave(int linkId);
+
+    MAVLinkLatencyProbe *m_latencyProbe;
+    mutable QMutex m_mutex;             ///< Guards the maps, the ingest thread looks members up once per read
+    QHash<int, QSharedPointer<Member> > m_members;
+    QHash<int, QSharedPointer<Group> > m_groups;
+};
+
+#endif // MAVLINKFUSION_H
@@ -0,0 +1,251 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkIngest
+ *          See MAVLinkIngest.h
+ *
+ */
+
+#include "MAVLinkIngest.h"
+#include "MAVLinkProtocol1.h"
+#include "SharedTelemetry.h"
+#include "LogDownload.h"
+#include "QsLog.h"
+#include "ThreadRoles.h"
+#include "TraceMarkers.h"
+#include <QtAlgorithms>
+
+// Messages that only carry the current state of the vehicle. When several of
+// them queue up for the same system and component only the newest is dispatched.
+static const int coalescedMessages[] = {
+    MAVLINK_MSG_ID_ATTITUDE,
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+    MAVLINK_MSG_ID_LOCAL_POSITION_NED,
+    MAVLINK_MSG_ID_VFR_HUD,
+    MAVLINK_MSG_ID_GPS_RAW_INT,
+    MAVLINK_MSG_ID_SYS_STATUS,
+    MAVLINK_MSG_ID_RAW_IMU,
+    MAVLINK_MSG_ID_SCALED_IMU,
+    MAVLINK_MSG_ID_SCALED_PRESSURE,
+    MAVLINK_MSG_ID_RC_CHANNELS_RAW,
+    MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
+    MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT,
+    MAVLINK_MSG_ID_AHRS,
+    MAVLINK_MSG_ID_HWSTATUS,
+    MAVLINK_MSG_ID_RADIO,
+    -1
+};
+
+MAVLinkIngest::MAVLinkIngest(MAVLinkProtocol *protocol, QObject *parent) :
+    QThread(parent),
+    m_protocol(protocol),
+    m_drainScheduled(0),
+    m_stopping(0),
+    m_droppedReads(0),
+    m_droppedMessages(0),
+    m_parsedReads(0)
+{
+}
+
+MAVLinkIngest::~MAVLinkIngest()
+{
+    stop();
+    for (int i = 0; i < 256; i++)
+    {
+        delete m_vehicleStates[i].load();
+    }
+}
+
+void MAVLinkIngest::postBytes(LinkInterface *link, const QByteArray &bytes, const QSharedPointer<LinkIngestStats> &stats,
+                              qint64 readTime)
+{
+    Read read;
+    read.link = link;
+    read.linkId = link->getId();
+    read.bytes = bytes;
+    read.stats = stats;
+    read.readTime = readTime;
+    if (!m_reads.push(read))
+    {
+        if (m_droppedReads.fetchAndAddRelaxed(1) % 100 == 0)
+        {
+            QLOG_WARN() << "MAVLinkIngest: parser behind, dropped" << m_droppedReads.load() << "reads";
+        }
+        return;
+    }
+    m_readsPending.release();
+}
+
+void MAVLinkIngest::postMessage(const QPointer<LinkInterface> &link, const mavlink_message_t &message,
+                                const GroundClock::Stamp &read)
+{
+    // Straight to the file of a running download, it would flood the UI queue
+    if (message.msgid == MAVLINK_MSG_ID_LOG_DATA && LogDownload::write(message))
+    {
+        return;
+    }
+    VehicleStateSnapshot *state = m_vehicleStates[message.sysid].load();
+    if (!state)
+    {
+        state = new VehicleStateSnapshot;
+        m_vehicleStates[message.sysid].storeRelease(state);
+    }
+    // Published before the UI thread sees the message, so a reader is never behind the overviews
+    if (state->apply(message, read.wallMsecs()))
+    {
+        SharedTelemetry::instance()->publish(message.sysid, state->current());
+    }
+
+    Message entry;
+    entry.link = link;
+    entry.message = MAVLinkMessageRef::create(message);
+    entry.readTime = read.nsecs();
+    if (!m_messages.push(entry))
+    {
+        if (m_droppedMessages.fetchAndAddRelaxed(1) % 100 == 0)
+        {
+            QLOG_WARN() << "MAVLinkIngest: UI behind, dropped" << m_droppedMessages.load() << "messages";
+        }
+        return;
+    }
+    // One queued drain covers everything pushed until the drain starts
+    if (m_drainScheduled.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "drainMessages", Qt::QueuedConnection);
+    }
+}
+
+void MAVLinkIngest::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    m_stopping.storeRelease(1);
+    m_readsPending.release();
+    wait();
+}
+
+void MAVLinkIngest::run()
+{
+    ThreadRoles::enter(ThreadRoles::Ingest);
+    QLOG_DEBUG() << "MAVLinkIngest: started";
+    Read read;
+    forever
+    {
+        m_readsPending.acquire();
+        if (m_stopping.loadAcquire())
+        {
+            break;
+        }
+        if (m_reads.pop(&read))
+        {
+            m_protocol->parseBytes(read.link, read.linkId, read.stats.data(), read.bytes, read.readTime);
+            // One wakeup for companion apps per read, however many messages it held
+            SharedTelemetry::instance()->notify();
+            read.bytes.clear();
+            read.stats.clear();
+            m_parsedReads.fetchAndAddRelease(1);
+        }
+    }
+    QLOG_DEBUG() << "MAVLinkIngest: stopped";
+}
+
+bool MAVLinkIngest::isCoalesced(int msgid)
+{
+    for (int i = 0; coalescedMessages[i] != -1; i++)
+    {
+        if (coalescedMessages[i] == msgid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MAVLinkIngest::drainMessages()
+{
+    HUD_TRACE_SCOPE("MAVLinkIngest::drainMessages");
+    // Clear first so a message pushed while we drain schedules the next pass
+    m_drainScheduled.storeRelease(0);
+
+    Arena::Scope scratch(m_scratch);
+    Message entry;
+    while (m_messages.pop(&entry))
+    {
+        m_batch.append(entry);
+    }
+    const int count = m_batch.size();
+
+    // Walk backwards so the newest sample of each coalesced stream is the one kept.
+    // The streams seen go into an open addressed set, never more than half full.
+    bool *dispatch = m_scratch.allocate<bool>(count, true);
+    int slots = 16;
+    while (slots < count * 2)
+    {
+        slots *= 2;
+    }
+    quint32 *seen = m_scratch.allocate<quint32>(slots, EmptyKey);
+    for (int i = count - 1; i >= 0; i--)
+    {
+        const mavlink_message_t &message = m_batch.at(i).message.message();
+        if (!isCoalesced(message.msgid))
+        {
+            continue;
+        }
+        quint32 key = (quint32(message.sysid) << 16) | (quint32(message.compid) << 8) | message.msgid;
+        int slot = int((key * 2654435761u) >> 16) & (slots - 1);
+        while (seen[slot] != EmptyKey && seen[slot] != key)
+        {
+            slot = (slot + 1) & (slots - 1);
+        }
+        if (seen[slot] == key)
+        {
+            dispatch[i] = false;
+        }
+        else
+        {
+            seen[slot] = key;
+        }
+    }
+
+    // Every message is still logged and counted for loss, only dispatch is coalesced.
+    // A batch comes from a handful of links, a list is enough
+    LinkInterface **abandoned = m_scratch.allocate<LinkInterface*>(count);
+    int abandonedCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        LinkInterface *link = m_batch[i].link.data();
+        if (link == NULL || qFind(abandoned, abandoned + abandonedCount, link) != abandoned + abandonedCount)
+        {
+            continue;
+        }
+        if (!m_protocol->handleMessage(link, m_batch[i].message, GroundClock::Stamp(m_batch[i].readTime), dispatch[i]))
+        {
+            abandoned[abandonedCount++] = link;
+        }
+    }
+    // Keeps the capacity, the records go back to the pool now
+    m_batch.resize(0);
+}
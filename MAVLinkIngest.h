@@ -0,0 +1,126 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkIngest
+ *          Moves MAVLink framing off the UI thread. Links hand their raw reads
+ *          to the ingest thread through a single producer / single consumer ring,
+ *          MAVLinkProtocol parses them there, and the decoded messages come back
+ *          to the UI thread in batches, with high rate state messages coalesced
+ *          to the latest sample before they are dispatched to the UAS objects.
+ *
+ */
+
+#ifndef MAVLINKINGEST_H
+#define MAVLINKINGEST_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QSemaphore>
+#include <QPointer>
+#include <QByteArray>
+#include <QSharedPointer>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+#include "LinkIngestStats.h"
+#include "MAVLinkMessageRef.h"
+#include "SpscRing.h"
+#include "Arena.h"
+#include <QVector>
+#include "VehicleStateSnapshot.h"
+#include "GroundClock.h"
+
+class MAVLinkProtocol;
+
+class MAVLinkIngest : public QThread
+{
+    Q_OBJECT
+public:
+    explicit MAVLinkIngest(MAVLinkProtocol *protocol, QObject *parent = 0);
+    ~MAVLinkIngest();
+
+    /** @brief Queue one read of a link for parsing. One producer at a time, see MAVLinkProtocol::receiveBytes */
+    void postBytes(LinkInterface *link, const QByteArray &bytes, const QSharedPointer<LinkIngestStats> &stats,
+                   qint64 readTime = 0);
+    /** @brief Queue one decoded message for the UI thread, read is the GroundClock reading of its link read. Ingest thread only */
+    void postMessage(const QPointer<LinkInterface> &link, const mavlink_message_t &message, const GroundClock::Stamp &read);
+    /** @brief State of sysid as parsed so far, 0 before its first message. Any thread */
+    const VehicleStateSnapshot *vehicleState(int sysid) const { return m_vehicleStates[sysid & 0xFF].loadAcquire(); }
+    void stop();
+
+    /** @brief Reads dropped because the ingest thread fell behind */
+    int droppedReads() const { return m_droppedReads.load(); }
+    /** @brief Messages dropped because the UI thread fell behind */
+    int droppedMessages() const { return m_droppedMessages.load(); }
+    /** @brief Reads parsed since the thread started */
+    int parsedReads() const { return m_parsedReads.load(); }
+    /** @brief Reads waiting for the ingest thread */
+    int pendingReads() const { return m_reads.count(); }
+    /** @brief Messages waiting for the UI thread drain */
+    int pendingMessages() const { return m_messages.count(); }
+    /** @brief msgid only carries the current state, a newer one replaces it */
+    static bool isCoalesced(int msgid);
+
+protected:
+    void run();
+
+private slots:
+    void drainMessages();
+
+private:
+    struct Read
+    {
+        QPointer<LinkInterface> link;
+        int linkId;
+        QByteArray bytes;
+        QSharedPointer<LinkIngestStats> stats;
+        qint64 readTime;            ///< See LinkInterface::getReadTime()
+        Read() : linkId(-1), readTime(0) { }
+    };
+    struct Message
+    {
+        QPointer<LinkInterface> link;
+        MAVLinkMessageRef message;
+        qint64 readTime;            ///< GroundClock::nsecs() of the link read
+        Message() : readTime(0) { }
+    };
+    enum { EmptyKey = 0xFFFFFFFFu };   ///< Stream keys use 24 bits
+
+    MAVLinkProtocol *m_protocol;
+    SpscRing<Read, 256> m_reads;
+    SpscRing<Message, 1024> m_messages;
+    QSemaphore m_readsPending;
+    QAtomicInt m_drainScheduled;
+    QAtomicInt m_stopping;
+    QAtomicInt m_droppedReads;
+    QAtomicInt m_droppedMessages;
+    QAtomicInt m_parsedReads;
+    /** @brief UI thread, drainMessages() only: the batch and its per-batch temporaries */
+    QVector<Message> m_batch;
+    Arena m_scratch;
+    /** @brief Created by the ingest thread on a system's first message, deleted with this */
+    QAtomicPointer<VehicleStateSnapshot> m_vehicleStates[256];
+};
+
+#endif // MAVLINKINGEST_H
@@ -0,0 +1,140 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkLatencyProbe
+ *          See MAVLinkLatencyProbe.h
+ *
+ */
+
+#include "MAVLinkLatencyProbe.h"
+#include "MAVLinkProtocol1.h"
+#include "LinkManager1.h"
+#include "QGC.h"
+
+static const double bucketLimits[MAVLinkLatencyProbe::HistogramBuckets - 1] = {
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+// Weight of a new reply in the smoothed round trip
+static const double smoothing = 0.125;
+
+MAVLinkLatencyProbe::MAVLinkLatencyProbe(MAVLinkProtocol *protocol, QObject *parent) :
+    QObject(parent),
+    m_protocol(protocol),
+    m_interval(0),
+    m_seq(0)
+{
+    for (int i = 0; i < PendingProbes; i++)
+    {
+        m_pending[i].seq = 0;
+        m_pending[i].linkId = -1;
+    }
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(probe()));
+    setInterval(DefaultIntervalMs);
+}
+
+double MAVLinkLatencyProbe::bucketLimit(int bucket)
+{
+    return (bucket >= 0 && bucket < HistogramBuckets - 1) ? bucketLimits[bucket] : -1;
+}
+
+void MAVLinkLatencyProbe::setInterval(int intervalMs)
+{
+    m_interval = qMax(0, intervalMs);
+    if (m_interval > 0)
+    {
+        m_timer.start(m_interval);
+    }
+    else
+    {
+        m_timer.stop();
+    }
+}
+
+void MAVLinkLatencyProbe::probe()
+{
+    LinkManager *manager = LinkManager::instance();
+    foreach (LinkInterface *link, manager->getLinks())
+    {
+        if (!link->isConnected() || link->getLinkType() == LinkInterface::REPLAY_LINK)
+        {
+            continue;
+        }
+        // Target 0 / 0 asks every system on the link to answer
+        quint32 seq = ++m_seq;
+        Pending &pending = m_pending[seq % PendingProbes];
+        pending.seq = seq;
+        pending.linkId = link->getId();
+        mavlink_message_t message;
+        mavlink_msg_ping_pack(m_protocol->getSystemId(), m_protocol->getComponentId(), &message, QGC::groundTimeUsecs(), seq, 0, 0);
+        m_protocol->sendMessage(link, message);
+        m_stats[link->getId()].sent++;
+    }
+}
+
+bool MAVLinkLatencyProbe::pingReceived(LinkInterface *link, const mavlink_message_t &message)
+{
+    mavlink_ping_t ping;
+    mavlink_msg_ping_decode(&message, &ping);
+    if (ping.target_system != m_protocol->getSystemId())
+    {
+        return false;
+    }
+    const Pending &pending = m_pending[ping.seq % PendingProbes];
+    if (pending.seq != ping.seq || pending.linkId != link->getId())
+    {
+        return false;
+    }
+
+    // The reply echoes our send time, so no lookup of when it left
+    quint64 now = QGC::groundTimeUsecs();
+    if (ping.time_usec > now || now - ping.time_usec > TimeoutMs * 1000ull)
+    {
+        return false;
+    }
+    double rtt = (now - ping.time_usec) / 1000.0;
+
+    Stats &stats = m_stats[link->getId()];
+    stats.received++;
+    stats.last = rtt;
+    stats.smoothed = (stats.received == 1) ? rtt : stats.smoothed + smoothing * (rtt - stats.smoothed);
+    stats.min = (stats.received == 1) ? rtt : qMin(stats.min, rtt);
+    stats.max = qMax(stats.max, rtt);
+    int bucket = 0;
+    while (bucket < HistogramBuckets - 1 && rtt > bucketLimits[bucket])
+    {
+        bucket++;
+    }
+    stats.histogram[bucket]++;
+
+    double &systemRtt = m_systemRtt[message.sysid];
+    systemRtt = (systemRtt == 0) ? rtt : systemRtt + smoothing * (rtt - systemRtt);
+    emit roundTripTimeChanged(link->getId(), message.sysid, systemRtt);
+    return true;
+}
+
+void MAVLinkLatencyProbe::removeLink(int linkId)
+{
+    m_stats.remove(linkId);
+}
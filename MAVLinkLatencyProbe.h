@@ -0,0 +1,105 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkLatencyProbe
+ *          Measures the round trip time of every link. A PING addressed to all
+ *          systems goes out on each link at a configurable interval; replies
+ *          addressed to us are matched by sequence number and their echoed
+ *          send time gives the round trip. Per link the probe keeps a fixed
+ *          bucket histogram, min / max and a smoothed value, and per system
+ *          the smoothed round trip that clock offset estimates compensate for.
+ *
+ */
+
+#ifndef MAVLINKLATENCYPROBE_H
+#define MAVLINKLATENCYPROBE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMap>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+
+class MAVLinkProtocol;
+
+class MAVLinkLatencyProbe : public QObject
+{
+    Q_OBJECT
+public:
+    enum { HistogramBuckets = 10 };
+
+    struct Stats
+    {
+        quint32 sent;
+        quint32 received;
+        double last;          ///< Milliseconds
+        double smoothed;
+        double min;
+        double max;
+        /** @brief Replies up to 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 ms and above */
+        quint32 histogram[HistogramBuckets];
+        Stats() : sent(0), received(0), last(0), smoothed(0), min(0), max(0)
+        {
+            for (int i = 0; i < HistogramBuckets; i++) histogram[i] = 0;
+        }
+    };
+
+    MAVLinkLatencyProbe(MAVLinkProtocol *protocol, QObject *parent = 0);
+
+    /** @brief Milliseconds between probes, 0 stops probing */
+    void setInterval(int intervalMs);
+    int interval() const { return m_interval; }
+
+    /** @brief Offer a received PING, true if it answered one of ours */
+    bool pingReceived(LinkInterface *link, const mavlink_message_t &message);
+    Stats stats(int linkId) const { return m_stats.value(linkId); }
+    /** @brief Smoothed round trip to a system in milliseconds, 0 before the first reply */
+    double roundTripTime(int sysid) const { return m_systemRtt.value(sysid, 0); }
+    static double bucketLimit(int bucket);
+    void removeLink(int linkId);
+
+signals:
+    void roundTripTimeChanged(int linkId, int sysid, double milliseconds);
+
+private slots:
+    void probe();
+
+private:
+    enum { DefaultIntervalMs = 1000, PendingProbes = 16, TimeoutMs = 10000 };
+    struct Pending
+    {
+        quint32 seq;
+        int linkId;
+    };
+
+    MAVLinkProtocol *m_protocol;
+    QTimer m_timer;
+    int m_interval;
+    quint32 m_seq;
+    Pending m_pending[PendingProbes];   ///< Most recent probes, by seq modulo PendingProbes
+    QMap<int, Stats> m_stats;
+    QMap<int, double> m_systemRtt;
+};
+
+#endif // MAVLINKLATENCYPROBE_H
@@ -0,0 +1,235 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkLatencyTracer
+ *          See MAVLinkLatencyTracer.h
+ *
+ */
+
+#include "MAVLinkLatencyTracer.h"
+#include "QsLog.h"
+#include "GroundClock.h"
+
+static const int LogIntervalMs = 10000;
+static const double BucketLimits[MAVLinkLatencyTracer::HistogramBuckets - 1] =
+{
+    1, 2, 5, 10, 20, 50, 100, 200, 500
+};
+static const char *StageNames[MAVLinkLatencyTracer::StageCount] =
+{
+    "total", "parse", "queue", "property", "render"
+};
+
+MAVLinkLatencyTracer *MAVLinkLatencyTracer::instance()
+{
+    static MAVLinkLatencyTracer* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new MAVLinkLatencyTracer();
+    }
+    return _instance;
+}
+
+qint64 MAVLinkLatencyTracer::now()
+{
+    return GroundClock::nsecs();
+}
+
+double MAVLinkLatencyTracer::bucketLimit(int bucket)
+{
+    return bucket < HistogramBuckets - 1 ? BucketLimits[bucket] : -1;
+}
+
+MAVLinkLatencyTracer::MAVLinkLatencyTracer(QObject *parent) :
+    QObject(parent),
+    m_enabled(0),
+    m_messageId(MAVLINK_MSG_ID_ATTITUDE)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        m_traces[i].reached = -1;
+    }
+    connect(&m_logTimer, SIGNAL(timeout()), this, SLOT(logSummary()));
+}
+
+void MAVLinkLatencyTracer::setEnabled(bool enabled)
+{
+    if (isEnabled() == enabled)
+    {
+        return;
+    }
+    reset();
+    m_enabled.store(enabled ? 1 : 0);
+    if (enabled)
+    {
+        m_logTimer.start(LogIntervalMs);
+    }
+    else
+    {
+        m_logTimer.stop();
+    }
+    QLOG_INFO() << "Latency tracing of message" << messageId() << (enabled ? "enabled" : "disabled");
+}
+
+void MAVLinkLatencyTracer::setMessageId(int msgid)
+{
+    m_messageId.store(msgid);
+    reset();
+}
+
+void MAVLinkLatencyTracer::attach(QObject *window)
+{
+    if (m_window)
+    {
+        disconnect(m_window, 0, this, 0);
+    }
+    m_window = window;
+    if (m_window)
+    {
+        // GUI thread, right before the render thread takes the new property values
+        connect(m_window, SIGNAL(afterAnimating()), this, SLOT(frame()));
+    }
+}
+
+void MAVLinkLatencyTracer::parsed(const mavlink_message_t &message, qint64 readNs)
+{
+    qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    // A newer message replaces a trace still in flight, the coalescing drain would skip the older one
+    Trace &trace = m_traces[message.sysid];
+    trace.seq = message.seq;
+    trace.reached = StageParsed;
+    trace.time[StageRead] = readNs > 0 ? readNs : time;
+    trace.time[StageParsed] = time;
+}
+
+void MAVLinkLatencyTracer::reached(const mavlink_message_t &message, Stage stage)
+{
+    qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    Trace &trace = m_traces[message.sysid];
+    if (trace.reached < StageParsed || trace.reached >= stage || trace.seq != message.seq)
+    {
+        return;
+    }
+    // A stage the message does not pass, e.g. no UAS subscribed in swarm mode, takes no time
+    for (int skipped = trace.reached + 1; skipped < stage; skipped++)
+    {
+        trace.time[skipped] = trace.time[trace.reached];
+    }
+    trace.reached = stage;
+    trace.time[stage] = time;
+    if (stage == StageProperty)
+    {
+        m_ready.append(message.sysid);
+    }
+}
+
+void MAVLinkLatencyTracer::add(Histogram &histogram, qint64 ns)
+{
+    double ms = ns / 1e6;
+    int bucket = 0;
+    while (bucket < HistogramBuckets - 1 && ms > BucketLimits[bucket])
+    {
+        bucket++;
+    }
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sum += ms;
+    histogram.max = qMax(histogram.max, ms);
+}
+
+void MAVLinkLatencyTracer::frame()
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    qint64 time = now();
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_ready.size(); i++)
+    {
+        Trace &trace = m_traces[m_ready.at(i)];
+        if (trace.reached != StageProperty)
+        {
+            // Replaced by a newer message since
+            continue;
+        }
+        trace.time[StageFrame] = time;
+        for (int stage = StageParsed; stage < StageCount; stage++)
+        {
+            add(m_histograms[stage], trace.time[stage] - trace.time[stage - 1]);
+        }
+        add(m_histograms[StageRead], time - trace.time[StageRead]);
+        trace.reached = -1;
+    }
+    m_ready.clear();
+}
+
+MAVLinkLatencyTracer::Histogram MAVLinkLatencyTracer::histogram(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms[stage];
+}
+
+void MAVLinkLatencyTracer::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < StageCount; i++)
+    {
+        m_histograms[i] = Histogram();
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        m_traces[i].reached = -1;
+    }
+    m_ready.clear();
+}
+
+QString MAVLinkLatencyTracer::summary() const
+{
+    QString text;
+    for (int stage = StageParsed; stage <= StageCount; stage++)
+    {
+        // The total last
+        Stage index = static_cast<Stage>(stage % StageCount);
+        Histogram h = histogram(index);
+        text += QString(QLatin1String("%1 avg %2 max %3 ms [")).arg(QLatin1String(StageNames[index]))
+                .arg(h.count ? h.sum / h.count : 0, 0, 'f', 2).arg(h.max, 0, 'f', 2);
+        for (int i = 0; i < HistogramBuckets; i++)
+        {
+            text += QString::number(h.buckets[i]) + (i < HistogramBuckets - 1 ? QLatin1String(" ") : QLatin1String("]"));
+        }
+        if (stage < StageCount)
+        {
+            text += QLatin1String(", ");
+        }
+    }
+    return text;
+}
+
+void MAVLinkLatencyTracer::logSummary()
+{
+    QLOG_INFO() << "Latency of message" << messageId() << summary();
+}
@@ -0,0 +1,132 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkLatencyTracer
+ *          Follows one message type from the socket read to the frame that
+ *          displays it. The read time is taken by the link, then each stage
+ *          stamps the newest traced message of its system: framed on the
+ *          ingest thread, dispatched to the UAS, applied to the overview
+ *          properties, and the next frame synchronized after that. Per stage
+ *          the delay from the previous one goes into a fixed bucket
+ *          histogram, so it shows whether the time is spent in the radio and
+ *          socket, the parser, the queue to the UI thread or waiting for the
+ *          renderer.
+ *
+ */
+
+#ifndef MAVLINKLATENCYTRACER_H
+#define MAVLINKLATENCYTRACER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class MAVLinkLatencyTracer : public QObject
+{
+    Q_OBJECT
+public:
+    enum Stage
+    {
+        StageRead,          ///< Link read the bytes, see LinkInterface::getReadTime()
+        StageParsed,        ///< Frame complete in MAVLinkProtocol::parseBytes
+        StageUas,           ///< UAS::receiveMessage
+        StageProperty,      ///< Overview properties set
+        StageFrame,         ///< Next frame about to be synchronized
+        StageCount
+    };
+    enum { HistogramBuckets = 10 };
+
+    struct Histogram
+    {
+        quint32 count;
+        double sum;         ///< Milliseconds
+        double max;
+        /** @brief Up to 1, 2, 5, 10, 20, 50, 100, 200, 500 ms and above */
+        quint32 buckets[HistogramBuckets];
+        Histogram() : count(0), sum(0), max(0)
+        {
+            for (int i = 0; i < HistogramBuckets; i++) buckets[i] = 0;
+        }
+    };
+
+    static MAVLinkLatencyTracer *instance();
+    /** @brief GroundClock::nsecs(), all stages are stamped with it */
+    static qint64 now();
+    static double bucketLimit(int bucket);
+
+    bool isEnabled() const { return m_enabled.load() != 0; }
+    void setEnabled(bool enabled);
+    /** @brief Message traced, ATTITUDE by default */
+    int messageId() const { return m_messageId.load(); }
+    void setMessageId(int msgid);
+    /** @brief Close traces at the frames of window, a QQuickWindow */
+    void attach(QObject *window);
+
+    /** @brief True if message is traced, cheap enough for every message */
+    bool traces(const mavlink_message_t &message) const
+    {
+        return m_enabled.load() && message.msgid == m_messageId.load();
+    }
+    /** @brief Start a trace, from the ingest thread. readNs 0 if the link does not stamp reads */
+    void parsed(const mavlink_message_t &message, qint64 readNs);
+    /** @brief The traced message of its system reached stage, UI thread */
+    void reached(const mavlink_message_t &message, Stage stage);
+
+    /** @brief Delay from the previous stage to stage, StageRead gives read to frame */
+    Histogram histogram(Stage stage) const;
+    void reset();
+    QString summary() const;
+
+public slots:
+    void frame();
+
+private slots:
+    void logSummary();
+
+private:
+    struct Trace
+    {
+        quint8 seq;
+        int reached;        ///< Last stage stamped, -1 when idle
+        qint64 time[StageCount];
+    };
+
+    explicit MAVLinkLatencyTracer(QObject *parent = 0);
+    static void add(Histogram &histogram, qint64 ns);
+
+    QAtomicInt m_enabled;
+    QAtomicInt m_messageId;
+    mutable QMutex m_mutex;
+    Trace m_traces[256];            ///< By sysid
+    QVector<int> m_ready;           ///< Systems whose trace reached StageProperty
+    Histogram m_histograms[StageCount];
+    QPointer<QObject> m_window;
+    QTimer m_logTimer;
+};
+
+#endif // MAVLINKLATENCYTRACER_H
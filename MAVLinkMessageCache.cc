@@ -0,0 +1,256 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkMessageCache
+ *          See MAVLinkMessageCache.h
+ *
+ */
+
+#include "MAVLinkMessageCache.h"
+#include "QsLog.h"
+#include <cstring>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+
+template<typename T> static inline T readField(const char *p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+static QVariant fieldValue(uint8_t type, const char *p)
+{
+    switch (type)
+    {
+    case MAVLINK_TYPE_CHAR:
+        return (int)readField<char>(p);
+    case MAVLINK_TYPE_UINT8_T:
+        return (int)readField<uint8_t>(p);
+    case MAVLINK_TYPE_INT8_T:
+        return (int)readField<int8_t>(p);
+    case MAVLINK_TYPE_UINT16_T:
+        return (int)readField<uint16_t>(p);
+    case MAVLINK_TYPE_INT16_T:
+        return (int)readField<int16_t>(p);
+    case MAVLINK_TYPE_UINT32_T:
+        return (uint)readField<uint32_t>(p);
+    case MAVLINK_TYPE_INT32_T:
+        return (int)readField<int32_t>(p);
+    case MAVLINK_TYPE_FLOAT:
+        return readField<float>(p);
+    case MAVLINK_TYPE_DOUBLE:
+        return readField<double>(p);
+    case MAVLINK_TYPE_UINT64_T:
+        return (quint64)readField<uint64_t>(p);
+    default:
+        return (qint64)readField<int64_t>(p);
+    }
+}
+
+static int typeSize(uint8_t type)
+{
+    static const int sizes[] = { 1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+    return type <= MAVLINK_TYPE_DOUBLE ? sizes[type] : 1;
+}
+
+MAVLinkMessageCache::MAVLinkMessageCache(QObject *parent) :
+    QObject(parent),
+    m_generation(0),
+    m_overflow(0),
+    m_paused(false)
+{
+    memset(m_table, -1, sizeof(m_table));
+    m_entries.reserve(MaxEntries);
+    m_clock.start();
+    m_notifyTimer.setSingleShot(true);
+    m_notifyTimer.setInterval(NotifyIntervalMs);
+    connect(&m_notifyTimer, SIGNAL(timeout()), this, SLOT(notify()));
+}
+
+int MAVLinkMessageCache::slotOf(quint32 key) const
+{
+    // Linear probing, the table never fills past half
+    int slot = (key * 2654435761u) >> 22;
+    while (m_table[slot] >= 0)
+    {
+        if (m_entries[m_table[slot]].key == key)
+        {
+            return slot;
+        }
+        slot = (slot + 1) % TableSize;
+    }
+    return slot;
+}
+
+void MAVLinkMessageCache::insert(const MAVLinkMessageRef &ref)
+{
+    quint32 key = entryKey(ref->sysid, ref->compid, ref->msgid);
+    int slot = slotOf(key);
+    int index = m_table[slot];
+    if (index < 0)
+    {
+        if (m_entries.size() == MaxEntries)
+        {
+            if (m_overflow++ == 0)
+            {
+                QLOG_WARN() << "MAVLinkMessageCache: more than" << MaxEntries << "streams, ignoring the rest";
+            }
+            return;
+        }
+        index = m_entries.size();
+        m_entries.resize(index + 1);
+        m_entries[index].key = key;
+        m_table[slot] = index;
+    }
+    Entry &entry = m_entries[index];
+    entry.message = ref;
+    entry.generation = ++m_generation;
+    entry.received = m_clock.elapsed();
+    if (!m_paused && !m_notifyTimer.isActive())
+    {
+        m_notifyTimer.start();
+    }
+}
+
+void MAVLinkMessageCache::notify()
+{
+    emit changed();
+}
+
+void MAVLinkMessageCache::setPaused(bool paused)
+{
+    if (m_paused == paused)
+    {
+        return;
+    }
+    m_paused = paused;
+    if (paused)
+    {
+        m_notifyTimer.stop();
+    }
+    else
+    {
+        emit changed();
+    }
+}
+
+void MAVLinkMessageCache::clear()
+{
+    memset(m_table, -1, sizeof(m_table));
+    m_entries.clear();
+    m_overflow = 0;
+    emit changed();
+}
+
+const MAVLinkMessageCache::Entry *MAVLinkMessageCache::find(int sysid, int compid, int msgid) const
+{
+    int index = m_table[slotOf(entryKey(sysid, compid, msgid))];
+    return index < 0 ? NULL : &m_entries[index];
+}
+
+MAVLinkMessageRef MAVLinkMessageCache::latest(int sysid, int compid, int msgid) const
+{
+    const Entry *entry = find(sysid, compid, msgid);
+    return entry ? entry->message : MAVLinkMessageRef();
+}
+
+QVector<MAVLinkMessageRef> MAVLinkMessageCache::changedSince(quint32 generation) const
+{
+    QVector<MAVLinkMessageRef> changed;
+    for (int i = 0; i < m_entries.size(); i++)
+    {
+        // Unsigned difference, still right once the counter wraps
+        if (qint32(m_entries[i].generation - generation) > 0)
+        {
+            changed.append(m_entries[i].message);
+        }
+    }
+    return changed;
+}
+
+QVariantMap MAVLinkMessageCache::fields(int sysid, int compid, int msgid) const
+{
+    QVariantMap values;
+    const Entry *entry = find(sysid, compid, msgid);
+    if (!entry)
+    {
+        return values;
+    }
+    const mavlink_message_t &message = entry->message.message();
+    const mavlink::MessageLayout &layout = mavlink::messageLayout(message.msgid);
+    const char *payload = _MAV_PAYLOAD(&message);
+    for (int i = 0; i < layout.numFields; i++)
+    {
+        const mavlink::FieldLayout &field = layout.fields[i];
+        const char *p = payload + field.wireOffset;
+        if (field.arrayLength == 0)
+        {
+            values.insert(field.name, fieldValue(field.type, p));
+        }
+        else if (field.type == MAVLINK_TYPE_CHAR)
+        {
+            values.insert(field.name, QString::fromUtf8(p, qstrnlen(p, field.arrayLength)));
+        }
+        else
+        {
+            QVariantList list;
+            for (int j = 0; j < field.arrayLength; j++)
+            {
+                list.append(fieldValue(field.type, p + j * typeSize(field.type)));
+            }
+            values.insert(field.name, list);
+        }
+    }
+    return values;
+}
+
+qint64 MAVLinkMessageCache::age(int sysid, int compid, int msgid) const
+{
+    const Entry *entry = find(sysid, compid, msgid);
+    return entry ? m_clock.elapsed() - entry->received : -1;
+}
+
+quint32 MAVLinkMessageCache::generationOf(int sysid, int compid, int msgid) const
+{
+    const Entry *entry = find(sysid, compid, msgid);
+    return entry ? entry->generation : 0;
+}
+
+QVariantList MAVLinkMessageCache::messageIds(int sysid, int compid) const
+{
+    QVariantList ids;
+    for (int i = 0; i < m_entries.size(); i++)
+    {
+        quint32 key = m_entries[i].key;
+        if (int(key >> 16) == sysid && (compid < 0 || int((key >> 8) & 0xFF) == compid))
+        {
+            int msgid = key & 0xFF;
+            if (!ids.contains(msgid))
+            {
+                ids.append(msgid);
+            }
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,106 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkMessageCache
+ *          Latest message of every system / component / message ID, as the
+ *          shared record, with the time it arrived and a generation number.
+ *          A view or consumer that starts late reads the current state from
+ *          here instead of waiting for the next message of each stream, and
+ *          polls changedSince() to pick up only what moved.
+ *
+ */
+
+#ifndef MAVLINKMESSAGECACHE_H
+#define MAVLINKMESSAGECACHE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QVariant>
+#include "MAVLinkMessageRef.h"
+
+class MAVLinkMessageCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(quint32 generation READ generation NOTIFY changed)
+public:
+    struct Entry
+    {
+        quint32 key;
+        quint32 generation;    ///< Cache generation of the last update
+        qint64 received;       ///< Milliseconds on the cache clock
+        MAVLinkMessageRef message;
+    };
+
+    explicit MAVLinkMessageCache(QObject *parent = 0);
+
+    /** @brief Keep ref as the latest of its stream. UI thread, called for every message */
+    void insert(const MAVLinkMessageRef &ref);
+    void clear();
+
+    /** @brief Null until the stream has been seen; valid until the next clear() */
+    const Entry *find(int sysid, int compid, int msgid) const;
+    MAVLinkMessageRef latest(int sysid, int compid, int msgid) const;
+    /** @brief Latest messages updated after generation, for consumers that poll */
+    QVector<MAVLinkMessageRef> changedSince(quint32 generation) const;
+    /** @brief Counts every insert, so an unchanged value means nothing arrived */
+    quint32 generation() const { return m_generation; }
+    /** @brief Paused keeps inserting but does not emit changed(), resuming emits it once */
+    void setPaused(bool paused);
+
+    /** @brief Decoded fields of the latest message, name to value, arrays as lists */
+    Q_INVOKABLE QVariantMap fields(int sysid, int compid, int msgid) const;
+    /** @brief Milliseconds since the latest message arrived, -1 if it never did */
+    Q_INVOKABLE qint64 age(int sysid, int compid, int msgid) const;
+    Q_INVOKABLE quint32 generationOf(int sysid, int compid, int msgid) const;
+    /** @brief Message IDs seen from a system, compid -1 for any component */
+    Q_INVOKABLE QVariantList messageIds(int sysid, int compid = -1) const;
+
+signals:
+    /** @brief At most every NotifyIntervalMs while messages arrive */
+    void changed();
+
+private slots:
+    void notify();
+
+private:
+    enum {
+        MaxEntries = 512,
+        TableSize = 1024,       ///< Open addressed index, twice MaxEntries
+        NotifyIntervalMs = 100
+    };
+    static quint32 entryKey(int sysid, int compid, int msgid) { return (quint32(sysid) << 16) | (quint32(compid) << 8) | quint32(msgid); }
+    int slotOf(quint32 key) const;
+
+    QVector<Entry> m_entries;
+    qint16 m_table[TableSize];  ///< Entry of each hashed key, -1 when free
+    quint32 m_generation;
+    int m_overflow;
+    bool m_paused;
+    QElapsedTimer m_clock;
+    QTimer m_notifyTimer;
+};
+
+#endif // MAVLINKMESSAGECACHE_H
@@ -0,0 +1,145 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkMessageRef
+ *          See MAVLinkMessageRef.h
+ *
+ */
+
+#include "MAVLinkMessageRef.h"
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief Fixed pool of message records behind a lock-free free list.
+ * Records are taken on the ingest thread and usually returned on the UI
+ * thread, so the list is a tagged Treiber stack: any thread may push or pop.
+ */
+class MAVLinkMessagePool
+{
+public:
+    enum { Size = 2048 };
+
+    static MAVLinkMessagePool *instance()
+    {
+        static MAVLinkMessagePool *_instance = 0;
+        if (_instance == 0)
+        {
+            _instance = new MAVLinkMessagePool();
+        }
+        return _instance;
+    }
+
+    MAVLinkMessageRef::Record *acquire()
+    {
+        forever
+        {
+            quint32 head = quint32(m_freeHead.loadAcquire());
+            int index = int(head & 0xFFFF) - 1;
+            if (index < 0)
+            {
+                return 0;
+            }
+            // The tag in the upper half changes on every update, a stale head always fails
+            quint32 next = ((head + 0x10000) & 0xFFFF0000) | quint32(m_next[index]);
+            if (m_freeHead.testAndSetOrdered(int(head), int(next)))
+            {
+                m_inUse.fetchAndAddRelaxed(1);
+                return &m_records[index];
+            }
+        }
+    }
+
+    void release(MAVLinkMessageRef::Record *record)
+    {
+        forever
+        {
+            quint32 head = quint32(m_freeHead.loadAcquire());
+            m_next[record->index] = int(head & 0xFFFF);
+            quint32 next = ((head + 0x10000) & 0xFFFF0000) | quint32(record->index + 1);
+            if (m_freeHead.testAndSetOrdered(int(head), int(next)))
+            {
+                m_inUse.fetchAndAddRelaxed(-1);
+                return;
+            }
+        }
+    }
+
+    QAtomicInt m_inUse;
+    QAtomicInt m_heapAllocations;
+
+private:
+    MAVLinkMessagePool()
+    {
+        // Chain every record, entries are stored as index + 1 so 0 ends the list
+        for (int i = 0; i < Size; i++)
+        {
+            m_records[i].index = i;
+            m_next[i] = (i + 1 < Size) ? i + 2 : 0;
+        }
+        m_freeHead.storeRelease(1);
+    }
+
+    MAVLinkMessageRef::Record m_records[Size];
+    int m_next[Size];
+    QAtomicInt m_freeHead;
+};
+
+MAVLinkMessageRef MAVLinkMessageRef::create(const mavlink_message_t &message)
+{
+    Record *record = MAVLinkMessagePool::instance()->acquire();
+    if (record == 0)
+    {
+        record = new Record();
+        record->index = -1;
+        MAVLinkMessagePool::instance()->m_heapAllocations.fetchAndAddRelaxed(1);
+    }
+    record->ref.store(1);
+    // Header plus the payload actually used and its checksum, not the whole 263 byte buffer
+    memcpy(&record->message, &message, offsetof(mavlink_message_t, payload64) + message.len + MAVLINK_NUM_CHECKSUM_BYTES);
+
+    MAVLinkMessageRef ref;
+    ref.d = record;
+    return ref;
+}
+
+void MAVLinkMessageRef::recycle(Record *record)
+{
+    if (record->index < 0)
+    {
+        delete record;
+        return;
+    }
+    MAVLinkMessagePool::instance()->release(record);
+}
+
+int MAVLinkMessageRef::pooledInUse()
+{
+    return MAVLinkMessagePool::instance()->m_inUse.load();
+}
+
+int MAVLinkMessageRef::heapAllocations()
+{
+    return MAVLinkMessagePool::instance()->m_heapAllocations.load();
+}
@@ -0,0 +1,88 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkMessageRef
+ *          Shared, immutable handle on a decoded message. Records come from a
+ *          preallocated pool, so a frame is stored once when it is decoded and
+ *          every consumer downstream only copies the handle.
+ *
+ */
+
+#ifndef MAVLINKMESSAGEREF_H
+#define MAVLINKMESSAGEREF_H
+
+#include <QAtomicInt>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class MAVLinkMessageRef
+{
+public:
+    MAVLinkMessageRef() : d(0) { }
+    MAVLinkMessageRef(const MAVLinkMessageRef &other) : d(other.d)
+    {
+        if (d) d->ref.ref();
+    }
+    ~MAVLinkMessageRef()
+    {
+        release();
+    }
+    MAVLinkMessageRef &operator=(const MAVLinkMessageRef &other)
+    {
+        if (other.d) other.d->ref.ref();
+        release();
+        d = other.d;
+        return *this;
+    }
+
+    /** @brief Copy message into a pooled record; falls back to the heap when the pool is empty */
+    static MAVLinkMessageRef create(const mavlink_message_t &message);
+
+    bool isNull() const { return d == 0; }
+    const mavlink_message_t &message() const { return d->message; }
+    const mavlink_message_t *operator->() const { return &d->message; }
+
+    /** @brief Records currently handed out from the pool, and records that had to be heap allocated */
+    static int pooledInUse();
+    static int heapAllocations();
+
+private:
+    struct Record
+    {
+        QAtomicInt ref;
+        int index; ///< Slot in the pool, -1 for a heap record
+        mavlink_message_t message;
+    };
+    friend class MAVLinkMessagePool;
+
+    void release()
+    {
+        if (d && !d->ref.deref()) recycle(d);
+        d = 0;
+    }
+    static void recycle(Record *record);
+
+    Record *d;
+};
+
+#endif // MAVLINKMESSAGEREF_H
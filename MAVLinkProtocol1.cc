@@ -35,353 +35,684 @@ This file is part of the APM_PLANNER project
 
 #include "MAVLinkProtocol1.h"
 #include "LinkManager1.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkDispatcher.h"
+#include "MAVLinkStreamModel.h"
+#include "MAVLinkMessageCache.h"
+#include "MAVLinkSender.h"
+#include "MAVLinkRouter.h"
+#include "MAVLinkLatencyProbe.h"
+#include "MAVLinkLatencyTracer.h"
+#include "MAVLinkFusion.h"
+#include "MAVLinkFanout.h"
+#include "StateWebSocketServer.h"
+#include "TelemetryHistory.h"
+#include "TrackHistory.h"
+#include "TerrainCache.h"
+#include "HilBridge.h"
+#include "TraceMarkers.h"
+#include "TlogWriter.h"
+#include "TelemetryCache.h"
+#include "MAVLink2.h"
+#include "MAVLinkCrc.h"
+#include "QsLogBinary.h"
+#include <cstring>
+
+// Dispatched while the app is in the background: what the audio alerts are
+// made of (HEARTBEAT for failsafe and arming, SYS_STATUS and BATTERY_STATUS
+// for the battery, STATUSTEXT), and replies to requests of ours, whose
+// protocols would otherwise time out and retry.
+static const int backgroundMessages[] = {
+    MAVLINK_MSG_ID_HEARTBEAT,
+    MAVLINK_MSG_ID_SYS_STATUS,
+    MAVLINK_MSG_ID_BATTERY_STATUS,
+    MAVLINK_MSG_ID_STATUSTEXT,
+    MAVLINK_MSG_ID_COMMAND_ACK,
+    MAVLINK_MSG_ID_PARAM_VALUE,
+    MAVLINK_MSG_ID_MISSION_COUNT,
+    MAVLINK_MSG_ID_MISSION_ITEM,
+    MAVLINK_MSG_ID_MISSION_REQUEST,
+    MAVLINK_MSG_ID_MISSION_ACK,
+    MAVLINK_MSG_ID_LOG_ENTRY,
+    -1
+};
 
 MAVLinkProtocol::MAVLinkProtocol():
     m_loggingEnabled(false),
     m_logfile(NULL),
-    m_connectionManager(NULL)
+    m_throwAwayGCSPackets(false),
+    m_connectionManager(NULL),
+    m_background(false),
+    m_backgroundGeneration(0),
+    m_backgroundHeld(0)
 {
+    for (int i = 0; i < 256; i++)
+    {
+        m_sequences[i] = NULL;
+    }
+    m_dispatcher = new MAVLinkDispatcher(this);
+    m_streamModel = new MAVLinkStreamModel(this);
+    m_messageCache = new MAVLinkMessageCache(this);
+    m_sender = new MAVLinkSender(this);
+    m_router = new MAVLinkRouter(m_sender, this);
+    m_latencyProbe = new MAVLinkLatencyProbe(this, this);
+    m_fusion = new MAVLinkFusion(m_latencyProbe, this);
+    // Lives on its own thread, so it has no parent
+    m_fanout = new MAVLinkFanout();
+    m_stateServer = new StateWebSocketServer(this);
+    m_history = new TelemetryHistory(this);
+    m_track = new TrackHistory(this);
+    m_terrain = new TerrainCache(this);
+    m_hil = new HilBridge(m_sender, this);
+    // Answer in the version the far end speaks; queued, the signal comes from the ingest thread
+    connect(this, SIGNAL(linkProtocolVersionChanged(int,int)), m_sender, SLOT(setProtocolVersion(int,int)));
+    m_ingest = new MAVLinkIngest(this, this);
+    m_ingest->start(QThread::HighPriority);
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
+    m_ingest->stop();
+    // Its thread writes through the sender, which goes first with the children
+    m_hil->close();
+    delete m_fanout;
+    m_fanout = NULL;
+    delete m_stateServer;
+    m_stateServer = NULL;
     stopLogging();
     m_connectionManager = NULL;
+    for (int i = 0; i < 256; i++)
+    {
+        delete[] m_sequences[i];
+    }
+}
+
+MAVLinkProtocol::SequenceState &MAVLinkProtocol::sequenceState(uint8_t sysid, uint8_t compid)
+{
+    SequenceState *components = m_sequences[sysid];
+    if (components == NULL)
+    {
+        components = new SequenceState[256];
+        m_sequences[sysid] = components;
+    }
+    return components[compid];
+}
+
+QMap<int,float> MAVLinkProtocol::componentLoss(int sysid) const
+{
+    QMap<int,float> loss;
+    if (sysid < 0 || sysid > 255 || m_sequences[sysid] == NULL)
+    {
+        return loss;
+    }
+    for (int compid = 0; compid < 256; compid++)
+    {
+        const SequenceState &sequence = m_sequences[sysid][compid];
+        if (sequence.received > 0)
+        {
+            loss.insert(compid, sequence.recentLoss);
+        }
+    }
+    return loss;
 }
 
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
-    mavlink_message_t message;
-    mavlink_status_t status;
+    // Called directly from the I/O threads of the links
+    QMutexLocker locker(&m_linkStatsMutex);
+    QSharedPointer<LinkIngestStats> &stats = m_linkStats[link->getId()];
+    if (stats.isNull())
+    {
+        stats = QSharedPointer<LinkIngestStats>(new LinkIngestStats());
+    }
+    // Links that do not stamp their reads get one here, every frame of the read shares it
+    const qint64 readTime = link->getReadTime();
+    m_ingest->postBytes(link, b, stats, readTime > 0 ? readTime : GroundClock::nsecs());
+}
 
-    // Cache the link ID for common use.
-    int linkId = link->getId();
+QSharedPointer<LinkIngestStats> MAVLinkProtocol::linkStats(int linkId) const
+{
+    QMutexLocker locker(&m_linkStatsMutex);
+    return m_linkStats.value(linkId);
+}
 
-    static int mavlink09Count = 0;
-    static int nonmavlinkCount = 0;
-    static bool decodedFirstPacket = false;
-    static bool warnedUser = false;
-    static bool checkedUserNonMavlink = false;
-    static bool warnedUserNonMavlink = false;
+bool MAVLinkProtocol::vehicleState(int sysid, VehicleState *state) const
+{
+    const VehicleStateSnapshot *snapshot = m_ingest->vehicleState(sysid);
+    return snapshot && snapshot->read(state);
+}
 
-    // FIXME: Add check for if link->getId() >= MAVLINK_COMM_NUM_BUFFERS
-    for (int position = 0; position < b.size(); position++) {
-        unsigned int decodeState = mavlink_parse_char(linkId, (uint8_t)(b[position]), &message, &status);
+void MAVLinkProtocol::removeLinkStats(int linkId)
+{
+    // Reads still queued keep their own reference
+    QMutexLocker locker(&m_linkStatsMutex);
+    m_linkStats.remove(linkId);
+}
 
-        if ((uint8_t)b[position] == 0x55) mavlink09Count++;
-        if ((mavlink09Count > 100) && !decodedFirstPacket && !warnedUser)
-        {
-            warnedUser = true;
-            // Obviously the user tries to use a 0.9 autopilot
-            // with QGroundControl built for version 1.0
-            emit protocolStatusMessage("MAVLink Version or Baud Rate Mismatch", "Your MAVLink device seems to use the deprecated version 0.9, while APM Planner only supports version 1.0+. Please upgrade the MAVLink version of your autopilot. If your autopilot is using version 1.0, check if the baud rates of APM Planner and your autopilot are the same.");
-        }
+void MAVLinkProtocol::parseBytes(const QPointer<LinkInterface> &link, int linkId, LinkIngestStats *stats, const QByteArray &b,
+                                 qint64 readTime)
+{
+    HUD_TRACE_SCOPE("MAVLinkProtocol::parseBytes");
+    MAVLinkLatencyTracer *tracer = MAVLinkLatencyTracer::instance();
+    const GroundClock::Stamp read(readTime);
+    mavlink_message_t message;
+    mavlink_status_t status;
 
-        if (decodeState == 0 && !decodedFirstPacket)
+    // FIXME: Add check for if link->getId() >= MAVLINK_COMM_NUM_BUFFERS
+    stats->addBytes(b.size());
+    QByteArray joined;
+    if (!stats->partial.isEmpty())
+    {
+        // A v2 frame split over reads, the v1 state machine cannot take it
+        joined = stats->partial + b;
+        stats->partial.clear();
+    }
+    const QByteArray &buffer = joined.isEmpty() ? b : joined;
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(buffer.constData());
+    const int size = buffer.size();
+    mavlink_status_t *channel = mavlink_get_channel_status(linkId);
+    // Copies of frames another link of the group delivered stop here
+    QSharedPointer<MAVLinkFusion::Member> fused = m_fusion->member(linkId);
+
+    int position = 0;
+    int nextStx = -1;
+    while (position < size)
+    {
+        // Fast path: between frames, jump to the next STX and take whole frames
+        // straight out of the buffer. The byte state machine only runs for a
+        // frame that continues in the next read.
+        if (channel->parse_state <= MAVLINK_PARSE_STATE_IDLE)
         {
-            nonmavlinkCount++;
-            if (nonmavlinkCount > 2000 && !warnedUserNonMavlink)
+            // The next v1 STX is remembered, a v2 only stream would rescan the rest of the read per frame
+            if (nextStx < position)
+            {
+                const uint8_t *found = static_cast<const uint8_t*>(memchr(data + position, MAVLINK_STX, size - position));
+                nextStx = found ? (int)(found - data) : size;
+            }
+            const uint8_t *stx = (nextStx < size) ? data + nextStx : NULL;
+            int end = nextStx;
+            // A v2 frame may come first; between v1 frames this scans nothing
+            const uint8_t *stx2 = static_cast<const uint8_t*>(memchr(data + position, MAVLINK2_STX, end - position));
+            if (stx2)
+            {
+                stx = stx2;
+                end = (int)(stx - data);
+            }
+
+            // Only bytes outside of frames count towards the v0.9 / non MAVLink heuristics
+            if (end > position)
             {
-                //500 bytes with no mavlink message. Are we connected to a mavlink capable device?
-                if (!checkedUserNonMavlink)
+                for (int i = position; i < end; i++)
                 {
-                    link->requestReset();
-                    nonmavlinkCount=0;
-                    checkedUserNonMavlink = true;
+                    if (data[i] == 0x55) stats->mavlink09Count++;
                 }
-                else
+                if (!stats->decodedFirstPacket) stats->nonmavlinkCount += end - position;
+                stats->addNonMavlinkBytes(end - position);
+                if (stx) stats->addResync();
+            }
+            position = end;
+            if (stx == NULL) break;
+
+            bool v2 = (*stx == MAVLINK2_STX);
+            int length = v2 ? scanFrame2(data + position, size - position, &message)
+                            : scanFrame(data + position, size - position, &message);
+            if (length > 0)
+            {
+                channel->current_rx_seq = message.seq;
+                channel->packet_rx_success_count++;
+                position += length;
+                stats->decodedFirstPacket = true;
+                stats->addFrame();
+                if (v2)
                 {
-                    warnedUserNonMavlink = true;
-                    emit protocolStatusMessage("MAVLink Baud Rate Mismatch", "Please check if the baud rates of APM Planner and your autopilot are the same.");
+                    stats->addMavlink2Frame();
+                    if (!stats->mavlink2)
+                    {
+                        stats->mavlink2 = true;
+                        QLOG_INFO() << "MAVLink 2 detected on link" << linkId;
+                        emit linkProtocolVersionChanged(linkId, 2);
+                    }
                 }
+                if (!fused || m_fusion->accept(fused.data(), message))
+                {
+                    if (tracer->traces(message)) tracer->parsed(message, readTime);
+                    m_history->record(message);
+                    m_track->record(message);
+                    m_terrain->record(message);
+                    m_hil->record(message);
+                    m_fanout->publish((const char*)&message.magic, MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len);
+                    m_ingest->postMessage(link, message, read);
+                }
+                continue;
+            }
+            if (length == ScanIncomplete && v2)
+            {
+                stats->partial = QByteArray(reinterpret_cast<const char*>(data + position), size - position);
+                break;
+            }
+            if (length < 0)
+            {
+                // Not a frame start after all, resync on the next STX
+                channel->parse_error++;
+                if (length == ScanBadCrc) stats->addCrcError();
+                else if (length == ScanUnsupported) stats->addUnsupportedFrame();
+                else stats->addFramingError();
+                if (!stats->decodedFirstPacket) stats->nonmavlinkCount++;
+                stats->addNonMavlinkBytes(1);
+                position++;
+                continue;
             }
         }
+
+        uint8_t parseState = channel->parse_state;
+        uint8_t parseErrors = channel->parse_error;
+        unsigned int decodeState = mavlink_parse_char(linkId, data[position], &message, &status);
+        position++;
+        if (channel->parse_error != parseErrors)
+        {
+            // The state machine drops back to idle on a bad length or checksum
+            if (parseState >= MAVLINK_PARSE_STATE_GOT_PAYLOAD) stats->addCrcError();
+            else stats->addFramingError();
+        }
+        if (decodeState == 0 && !stats->decodedFirstPacket) stats->nonmavlinkCount++;
         if (decodeState == 1)
         {
-            decodedFirstPacket = true;
-
-            if(message.msgid == MAVLINK_MSG_ID_PING)
+            stats->decodedFirstPacket = true;
+            stats->addFrame();
+            if (!fused || m_fusion->accept(fused.data(), message))
             {
-                // process ping requests (tgt_system and tgt_comp must be zero)
-                mavlink_ping_t ping;
-                mavlink_msg_ping_decode(&message, &ping);
-                if(!ping.target_system && !ping.target_component)
-                {
-                    mavlink_message_t msg;
-                    mavlink_msg_ping_pack(getSystemId(), getComponentId(), &msg, ping.time_usec, ping.seq, message.sysid, message.compid);
-                    sendMessage(msg);
-                }
+                if (tracer->traces(message)) tracer->parsed(message, readTime);
+                m_history->record(message);
+                m_track->record(message);
+                m_terrain->record(message);
+                m_hil->record(message);
+                m_fanout->publish((const char*)&message.magic, MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len);
+                m_ingest->postMessage(link, message, read);
             }
+        }
+    }
 
-#if defined(QGC_PROTOBUF_ENABLED)
-
-            if (message.msgid == MAVLINK_MSG_ID_EXTENDED_MESSAGE)
-            {
-                mavlink_extended_message_t extended_message;
+    if ((stats->mavlink09Count > 100) && !stats->decodedFirstPacket && !stats->warnedUser)
+    {
+        stats->warnedUser = true;
+        // Obviously the user tries to use a 0.9 autopilot
+        // with QGroundControl built for version 1.0
+        emit protocolStatusMessage("MAVLink Version or Baud Rate Mismatch", "Your MAVLink device seems to use the deprecated version 0.9, while APM Planner only supports version 1.0+. Please upgrade the MAVLink version of your autopilot. If your autopilot is using version 1.0, check if the baud rates of APM Planner and your autopilot are the same.");
+    }
 
-                extended_message.base_msg = message;
+    if (!stats->decodedFirstPacket && stats->nonmavlinkCount > 2000 && !stats->warnedUserNonMavlink)
+    {
+        //500 bytes with no mavlink message. Are we connected to a mavlink capable device?
+        if (!stats->checkedUserNonMavlink)
+        {
+            emit linkResetRequested(linkId);
+            stats->nonmavlinkCount = 0;
+            stats->checkedUserNonMavlink = true;
+        }
+        else
+        {
+            stats->warnedUserNonMavlink = true;
+            emit protocolStatusMessage("MAVLink Baud Rate Mismatch", "Please check if the baud rates of APM Planner and your autopilot are the same.");
+        }
+    }
+}
 
-                // read extended header
-                uint8_t* payload = reinterpret_cast<uint8_t*>(message.payload64);
+int MAVLinkProtocol::scanFrame(const uint8_t *frame, int available, mavlink_message_t *message)
+{
+    if (available < MAVLINK_NUM_NON_PAYLOAD_BYTES) return ScanIncomplete;
 
-                memcpy(&extended_message.extended_payload_len, payload + 3, 4);
+    uint8_t length = frame[1];
+#if (MAVLINK_MAX_PAYLOAD_LEN < 255)
+    if (length > MAVLINK_MAX_PAYLOAD_LEN) return ScanBadLength;
+#endif
+    int frameLength = length + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (available < frameLength) return ScanIncomplete;
 
-                // Check if message is valid
-                if
-                 (b.size() != MAVLINK_NUM_NON_PAYLOAD_BYTES+MAVLINK_EXTENDED_HEADER_LEN+ extended_message.extended_payload_len)
-                {
-                    //invalid message
-                    QLOG_DEBUG() << "GOT INVALID EXTENDED MESSAGE, ABORTING";
-                    return;
-                }
+    uint8_t msgid = frame[5];
+#if MAVLINK_CHECK_MESSAGE_LENGTH
+    static const uint8_t lengths[256] = MAVLINK_MESSAGE_LENGTHS;
+    if (length != lengths[msgid]) return ScanBadLength;
+#endif
 
-                const uint8_t* extended_payload = reinterpret_cast<const uint8_t*>(b.constData()) + MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_EXTENDED_HEADER_LEN;
+    // Same checksum as mavlink_parse_char, over LEN..payload plus CRC_EXTRA
+#if MAVLINK_CRC_EXTRA
+    static const uint8_t crcs[256] = MAVLINK_MESSAGE_CRCS;
+    uint16_t checksum = MAVLinkCrc::frame(frame + 1, MAVLINK_CORE_HEADER_LEN + length, crcs[msgid]);
+#else
+    uint16_t checksum = MAVLinkCrc::calculate(frame + 1, MAVLINK_CORE_HEADER_LEN + length);
+#endif
+    const uint8_t *crc = frame + MAVLINK_NUM_HEADER_BYTES + length;
+    if (crc[0] != (checksum & 0xFF) || crc[1] != (checksum >> 8)) return ScanBadCrc;
+
+    message->magic = frame[0];
+    message->len = length;
+    message->seq = frame[2];
+    message->sysid = frame[3];
+    message->compid = frame[4];
+    message->msgid = msgid;
+    message->checksum = checksum;
+    // The checksum bytes follow the payload, as mavlink_parse_char leaves them
+    memcpy(_MAV_PAYLOAD_NON_CONST(message), frame + MAVLINK_NUM_HEADER_BYTES, length + MAVLINK_NUM_CHECKSUM_BYTES);
+    return frameLength;
+}
 
-                // copy extended payload data
-                memcpy(extended_message.extended_payload, extended_payload, extended_message.extended_payload_len);
+int MAVLinkProtocol::scanFrame2(const uint8_t *frame, int available, mavlink_message_t *message)
+{
+    if (available < MAVLINK2_NUM_HEADER_BYTES) return ScanIncomplete;
+
+    // Signing is the only incompatibility flag defined; the signature goes unchecked
+    uint8_t incompat = frame[2];
+    if (incompat & ~MAVLINK2_IFLAG_SIGNED) return ScanUnsupported;
+    uint8_t length = frame[1];
+    int frameLength = mavlink_frame_length(frame);
+    if (available < frameLength) return ScanIncomplete;
+
+    uint32_t msgid = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+    static const uint8_t lengths[256] = MAVLINK_MESSAGE_LENGTHS;
+    if (msgid > 255 || lengths[msgid] == 0) return ScanUnsupported;
+
+    static const uint8_t crcs[256] = MAVLINK_MESSAGE_CRCS;
+    uint16_t checksum = MAVLinkCrc::frame(frame + 1, MAVLINK2_NUM_HEADER_BYTES - 1 + length, crcs[msgid]);
+    const uint8_t *crc = frame + MAVLINK2_NUM_HEADER_BYTES + length;
+    if (crc[0] != (checksum & 0xFF) || crc[1] != (checksum >> 8)) return ScanBadCrc;
+
+    // Zero extend the truncated payload; extension fields beyond the v1.0 message are dropped
+    uint8_t fullLength = lengths[msgid];
+    uint8_t copied = qMin(length, fullLength);
+    uint8_t *payload = (uint8_t*)_MAV_PAYLOAD_NON_CONST(message);
+    memcpy(payload, frame + MAVLINK2_NUM_HEADER_BYTES, copied);
+    memset(payload + copied, 0, fullLength - copied);
+
+    // Rebuilt as the v1 frame, so logs and routed copies stay valid MAVLink 1
+    message->magic = MAVLINK_STX;
+    message->len = fullLength;
+    message->seq = frame[4];
+    message->sysid = frame[5];
+    message->compid = frame[6];
+    message->msgid = (uint8_t)msgid;
+    checksum = MAVLinkCrc::frame((const uint8_t*)&message->len, MAVLINK_CORE_HEADER_LEN + fullLength, crcs[msgid]);
+    message->checksum = checksum;
+    payload[fullLength] = (uint8_t)(checksum & 0xFF);
+    payload[fullLength + 1] = (uint8_t)(checksum >> 8);
+    return frameLength;
+}
 
-#if defined(QGC_USE_PIXHAWK_MESSAGES)
+bool MAVLinkProtocol::handleMessage(LinkInterface *link, const MAVLinkMessageRef &ref, const GroundClock::Stamp &read,
+                                    bool dispatch)
+{
+    int linkId = link->getId();
+    const mavlink_message_t &message = ref.message();
+    // Kept in the background too, leaving it replays the state from the cache
+    m_messageCache->insert(ref);
+    if (m_background)
+    {
+        if (dispatch && !isBackgroundMessage(message.msgid))
+        {
+            dispatch = false;
+            m_backgroundHeld++;
+        }
+    }
+    else
+    {
+        m_streamModel->addMessage(message.sysid, message.compid, message.msgid, MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len);
+    }
+    if (m_router->isEnabled())
+    {
+        m_router->route(link, message);
+    }
 
-                if (protobufManager.cacheFragment(extended_message))
-                {
-                    std::tr1::shared_ptr<google::protobuf::Message> protobuf_msg;
+    if(message.msgid == MAVLINK_MSG_ID_PING)
+    {
+        // process ping requests (tgt_system and tgt_comp must be zero)
+        mavlink_ping_t ping;
+        mavlink_msg_ping_decode(&message, &ping);
+        if(!ping.target_system && !ping.target_component)
+        {
+            mavlink_message_t msg;
+            mavlink_msg_ping_pack(getSystemId(), getComponentId(), &msg, ping.time_usec, ping.seq, message.sysid, message.compid);
+            sendMessage(link, msg);
+        }
+        else if (ping.target_system == getSystemId())
+        {
+            m_latencyProbe->pingReceived(link, message);
+        }
+    }
 
-                    if (protobufManager.getMessage(protobuf_msg))
-                    {
-                        const google::protobuf::Descriptor* descriptor = protobuf_msg->GetDescriptor();
-                        if (!descriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
-                        if (!headerField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
-                        if (!headerDescriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
-                        if (!sourceSysIdField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Reflection* reflection = protobuf_msg->GetReflection();
-                        const google::protobuf::Message& headerMsg = reflection->GetMessage(*protobuf_msg, headerField);
-                        const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
-
-                        int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
-
-                        UASInterface* uas = UASManager::instance()->getUASForId(source_sysid);
-
-                        if (uas != NULL)
-                        {
-                            emit extendedMessageReceived(link, protobuf_msg);
-                        }
-                    }
-                }
-#endif
+    // Log data
+    if (m_loggingEnabled && m_logfile)
+    {
+        // write headers, payload (incs CRC); the writer thread does the disk I/O
+        m_logfile->append(read.wallUsecs(), (const char*)&message.magic,
+                          static_cast<int>(MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len));
+    }
 
-                position += extended_message.extended_payload_len;
+    // ORDER MATTERS HERE!
+    // If the matching UAS object does not yet exist, it has to be created
+    // before emitting the packetReceived signal
 
-                continue;
-            }
-#endif
+    //UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
+    Q_ASSERT_X(m_connectionManager != NULL, "MAVLinkProtocol::handleMessage", " error:m_connectionManager == NULL");
+    UASInterface* uas = m_connectionManager->getUas(message.sysid);
+    //qDebug() << "MAVLinkProtocol::handleMessage" << uas;
 
-            // Log data
-            if (m_loggingEnabled && m_logfile)
+    // Check and (if necessary) create UAS object
+    if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+    {
+        // ORDER MATTERS HERE!
+        // The UAS object has first to be created and connected,
+        // only then the rest of the application can be made aware
+        // of its existence, as it only then can send and receive
+        // it's first messages.
+
+        // Check if the UAS has the same id like this system
+        if (message.sysid == getSystemId())
+        {
+            if (m_throwAwayGCSPackets)
             {
-                quint64 time = QGC::groundTimeUsecs();
-
-                QDataStream outStream(m_logfile);
-                outStream.setByteOrder(QDataStream::BigEndian);
-                outStream << time; // write time stamp
-                // write headers, payload (incs CRC)
-                int bytesWritten = outStream.writeRawData((const char*)&message.magic,
-                                     static_cast<uint>(MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len));
-
-                if(bytesWritten != (MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len))
-                {
-                    emit protocolStatusMessage(tr("MAVLink Logging failed"),
-                                               tr("Could not write to file %1, disabling logging.")
-                                               .arg(m_logfile->fileName()));
-                    // Stop logging
-                    stopLogging();
-                }
+                //If replaying, we have to assume that it's just hearing ground control traffic
+                return false;
             }
+            emit protocolStatusMessage(tr("SYSTEM ID CONFLICT!"), tr("Warning: A second system is using the same system id (%1)").arg(getSystemId()));
+        }
 
-            // ORDER MATTERS HERE!
-            // If the matching UAS object does not yet exist, it has to be created
-            // before emitting the packetReceived signal
+        // Create a new UAS based on the heartbeat received
+        // Todo dynamically load plugin at run-time for MAV
+        // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
 
-            //UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
-            Q_ASSERT_X(m_connectionManager != NULL, "MAVLinkProtocol::receiveBytes", " error:m_connectionManager == NULL");
-            UASInterface* uas = m_connectionManager->getUas(message.sysid);
-            //qDebug() << "MAVLinkProtocol::receiveBytes" << uas;
+        // First create new UAS object
+        // Decode heartbeat message
+        mavlink_heartbeat_t heartbeat;
+        // Reset version field to 0
+        heartbeat.mavlink_version = 0;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
 
-            // Check and (if necessary) create UAS object
-            if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+        // Check if the UAS has a different protocol version
+        if (m_enable_version_check && (heartbeat.mavlink_version != MAVLINK_VERSION))
+        {
+            // Bring up dialog to inform user
+            if (!versionMismatchIgnore)
             {
-                // ORDER MATTERS HERE!
-                // The UAS object has first to be created and connected,
-                // only then the rest of the application can be made aware
-                // of its existence, as it only then can send and receive
-                // it's first messages.
-
-                // Check if the UAS has the same id like this system
-                if (message.sysid == getSystemId())
-                {
-                    if (m_throwAwayGCSPackets)
-                    {
-                        //If replaying, we have to assume that it's just hearing ground control traffic
-                        return;
-                    }
-                    emit protocolStatusMessage(tr("SYSTEM ID CONFLICT!"), tr("Warning: A second system is using the same system id (%1)").arg(getSystemId()));
-                }
-
-                // Create a new UAS based on the heartbeat received
-                // Todo dynamically load plugin at run-time for MAV
-                // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
+                emit protocolStatusMessage(tr("The MAVLink protocol version on the MAV and APM Planner mismatch!"),
+                                           tr("It is unsafe to use different MAVLink versions. APM Planner therefore refuses to connect to system %1, which sends MAVLink version %2 (APM Planner uses version %3).").arg(message.sysid).arg(heartbeat.mavlink_version).arg(MAVLINK_VERSION));
+                versionMismatchIgnore = true;
+            }
 
-                // First create new UAS object
-                // Decode heartbeat message
-                mavlink_heartbeat_t heartbeat;
-                // Reset version field to 0
-                heartbeat.mavlink_version = 0;
-                mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            // Ignore this message and continue gracefully
+            return true;
+        }
 
-                // Check if the UAS has a different protocol version
-                if (m_enable_version_check && (heartbeat.mavlink_version != MAVLINK_VERSION))
-                {
-                    // Bring up dialog to inform user
-                    if (!versionMismatchIgnore)
-                    {
-                        emit protocolStatusMessage(tr("The MAVLink protocol version on the MAV and APM Planner mismatch!"),
-                                                   tr("It is unsafe to use different MAVLink versions. APM Planner therefore refuses to connect to system %1, which sends MAVLink version %2 (APM Planner uses version %3).").arg(message.sysid).arg(heartbeat.mavlink_version).arg(MAVLINK_VERSION));
-                        versionMismatchIgnore = true;
-                    }
+        // Create a new UAS object
+        uas = m_connectionManager->createUAS(this,link,message.sysid,&heartbeat); //QGCMAVLinkUASFactory::createUAS(this, link, message.sysid, &heartbeat);
+    }
 
-                    // Ignore this message and continue gracefully
-                    continue;
-                }
+    // Only count message if UAS exists for this message
+    if (uas != NULL)
+    {
 
-                // Create a new UAS object
-                uas = m_connectionManager->createUAS(this,link,message.sysid,&heartbeat); //QGCMAVLinkUASFactory::createUAS(this, link, message.sysid, &heartbeat);
-            }
+        // Increase receive counter
+        totalReceiveCounter[linkId]++;
+        currReceiveCounter[linkId]++;
 
-            // Only count message if UAS exists for this message
-            if (uas != NULL)
+        // Sequence tracking, one flat table per system so every frame costs one lookup
+        SequenceState &sequence = sequenceState(message.sysid, message.compid);
+        uint8_t lostMessages = 0;
+        if (sequence.lastSeq >= 0)
+        {
+            // Gap to the expected sequence ID, accounting for 0-wraparound. A gap of more
+            // than half the sequence space is an out of order or repeated packet, not loss
+            lostMessages = uint8_t(message.seq - uint8_t(sequence.lastSeq + 1));
+            if (lostMessages > 128)
             {
+                lostMessages = 0;
+            }
+        }
+        // Binary, a text line per gap loads the console at high loss rates
+        if (lostMessages)
+        {
+            QLOG_BIN_DEBUG("Sequence gap of %1:%2 msgid %3, %4 lost at %5")
+                    << message.sysid << message.compid << message.msgid << lostMessages << message.seq;
+        }
+        sequence.lastSeq = message.seq;
+        sequence.received++;
+        sequence.lost += lostMessages;
+        sequence.windowReceived++;
+        sequence.windowLost += lostMessages;
+        totalLossCounter[linkId] += lostMessages;
+        currLossCounter[linkId] += lostMessages;
+
+        // Per component loss over windows of 32 received packets
+        if (sequence.windowReceived == 32)
+        {
+            sequence.recentLoss = 100.0f * sequence.windowLost / (sequence.windowReceived + sequence.windowLost);
+            sequence.windowReceived = 0;
+            sequence.windowLost = 0;
+            emit componentLossChanged(message.sysid, message.compid, sequence.recentLoss);
+        }
 
-                // Increase receive counter
-                totalReceiveCounter[linkId]++;
-                currReceiveCounter[linkId]++;
-
-                // Update last message sequence ID
-                uint8_t expectedIndex;
-                if (lastIndex.contains(message.sysid))
-                {
-                    if (lastIndex.value(message.sysid).contains(message.compid))
-                    {
-                        if (lastIndex.value(message.sysid).value(message.compid) == -1)
-                        {
-                            lastIndex[message.sysid][message.compid] = message.seq;
-                            expectedIndex = message.seq;
-                        }
-                        else
-                        {
-                            expectedIndex = lastIndex[message.sysid][message.compid] + 1;
-                        }
-                    }
-                    else
-                    {
-                        lastIndex[message.sysid].insert(message.compid,message.seq);
-                        expectedIndex = message.seq;
-                    }
-                }
-                else
-                {
-                    lastIndex.insert(message.sysid,QMap<int,uint8_t>());
-                    lastIndex[message.sysid].insert(message.compid,message.seq);
-                    expectedIndex = message.seq;
-                }
+        // Update on every 32th packet
+        if (totalReceiveCounter[linkId] % 32 == 0)
+        {
+            // Calculate new loss ratio
+            // Receive loss
+            float receiveLoss = (double)currLossCounter[linkId]/(double)(currReceiveCounter[linkId]+currLossCounter[linkId]);
+            receiveLoss *= 100.0f;
+            currLossCounter[linkId] = 0;
+            currReceiveCounter[linkId] = 0;
+            emit receiveLossChanged(message.sysid, receiveLoss);
+        }
 
-                // Make some noise if a message was skipped
-                //QLOG_DEBUG() << "SYSID" << message.sysid << "COMPID" << message.compid << "MSGID" << message.msgid << "EXPECTED INDEX:" << expectedIndex << "SEQ" << message.seq;
-                if (message.seq != expectedIndex)
-                {
-                    // Determine how many messages were skipped accounting for 0-wraparound
-                    int16_t lostMessages = message.seq - expectedIndex;
-                    if (lostMessages < 0)
-                    {
-                        // Usually, this happens in the case of an out-of order packet
-                        lostMessages = 0;
-                    }
-                    else
-                    {
-                        // Console generates excessive load at high loss rates, needs better GUI visualization
-                        //QLOG_DEBUG() << QString("Lost %1 messages for comp %4: expected sequence ID %2 but received %3.").arg(lostMessages).arg(expectedIndex).arg(message.seq).arg(message.compid);
-                    }
-                    totalLossCounter[linkId] += lostMessages;
-                    currLossCounter[linkId] += lostMessages;
-                }
+        // Subscribers share the pooled record. The by-value signal is only
+        // paid for when something outside the dispatcher still listens
+        if (dispatch)
+        {
+            if (receivers(SIGNAL(messageReceived(LinkInterface*,mavlink_message_t))) > 0)
+            {
+                emit messageReceived(link, message);
+            }
+            m_dispatcher->dispatch(link, ref);
+        }
+    }
+    return true;
+}
 
-                // Update the last sequence ID
-                lastIndex[message.sysid][message.compid] = message.seq;
+bool MAVLinkProtocol::isBackgroundMessage(int msgid)
+{
+    for (int i = 0; backgroundMessages[i] != -1; i++)
+    {
+        if (backgroundMessages[i] == msgid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-                // Update on every 32th packet
-                if (totalReceiveCounter[linkId] % 32 == 0)
-                {
-                    // Calculate new loss ratio
-                    // Receive loss
-                    float receiveLoss = (double)currLossCounter[linkId]/(double)(currReceiveCounter[linkId]+currLossCounter[linkId]);
-                    receiveLoss *= 100.0f;
-                    currLossCounter[linkId] = 0;
-                    currReceiveCounter[linkId] = 0;
-                    emit receiveLossChanged(message.sysid, receiveLoss);
-                }
+void MAVLinkProtocol::setBackground(bool background)
+{
+    if (m_background == background)
+    {
+        return;
+    }
+    m_background = background;
+    m_messageCache->setPaused(background);
+    if (background)
+    {
+        m_backgroundGeneration = m_messageCache->generation();
+        m_backgroundHeld = 0;
+        m_backgroundClock.start();
+        QLOG_INFO() << "MAVLinkProtocol: background, only alerts are dispatched";
+        return;
+    }
 
-                // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-                // kind of inefficient, but no issue for a groundstation pc.
-                // It buys as reentrancy for the whole code over all threads
-                emit messageReceived(link, message);
+    // Only the state messages, replaying an event (a mission item, an ack) would repeat it;
+    // the ones dispatched in the background are current already
+    int replayed = 0;
+    QVector<MAVLinkMessageRef> changed = m_messageCache->changedSince(m_backgroundGeneration);
+    foreach (const MAVLinkMessageRef &ref, changed)
+    {
+        const mavlink_message_t &message = ref.message();
+        if (!MAVLinkIngest::isCoalesced(message.msgid) || isBackgroundMessage(message.msgid) || m_connectionManager == NULL)
+        {
+            continue;
+        }
+        UASInterface *uas = m_connectionManager->getUas(message.sysid);
+        QList<LinkInterface*> *links = uas ? uas->getLinks() : NULL;
+        if (links == NULL || links->isEmpty())
+        {
+            continue;
+        }
+        m_dispatcher->dispatch(links->first(), ref);
+        replayed++;
+    }
+    QLOG_INFO() << "MAVLinkProtocol: foreground after" << m_backgroundClock.elapsed() << "ms," << m_backgroundHeld
+                << "messages held back," << replayed << "state messages replayed";
+}
 
-                // Multiplex message if enabled
-                //if (m_multiplexingEnabled)
-                //{
-                    // Get all links connected to this unit
-                    //QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
-
-                    // Emit message on all links that are currently connected
-                    //foreach (LinkInterface* currLink, links)
-                    //{
-                        // Only forward this message to the other links,
-                        // not the link the message was received on
-                     //   if (currLink != link) sendMessage(currLink, message, message.sysid, message.compid);
-                    //}
-                //}
-            }
+void MAVLinkProtocol::sendMessage(const mavlink_message_t &message)
+{
+    if (m_connectionManager == NULL)
+    {
+        return;
+    }
+    foreach (LinkInterface *link, m_connectionManager->getLinks())
+    {
+        if (link->isConnected() && link->getLinkType() != LinkInterface::REPLAY_LINK)
+        {
+            m_sender->send(link, message);
         }
     }
 }
+
+void MAVLinkProtocol::sendMessage(LinkInterface *link, const mavlink_message_t &message)
+{
+    m_sender->send(link, message);
+}
+
 void MAVLinkProtocol::stopLogging()
 {
     if (m_logfile && m_logfile->isOpen()){
         QLOG_DEBUG() << "Stop MAVLink logging" << m_logfile->fileName();
-        // Close the current open file
+        // Close the current open file, this waits for the buffered frames
         m_logfile->close();
-        delete m_logfile;
-        m_logfile = NULL;
+        TlogWriter::Stats stats = m_logfile->stats();
+        QLOG_DEBUG() << "MAVLink log:" << stats.bytesWritten << "bytes (" << stats.rawBytes << "raw) in" << stats.blocksWritten << "blocks,"
+                     << stats.syncs << "syncs, slowest write" << stats.maxWriteMs << "ms, dropped" << stats.droppedBytes << "bytes";
+        // The whole flight plots from the columnar cache, built while nobody waits for it
+        TelemetryCacheBuilder::instance()->enqueue(m_logfile->fileName());
     }
+    delete m_logfile;
+    m_logfile = NULL;
     m_loggingEnabled = false;
 }
 
+void MAVLinkProtocol::logWriteFailed(const QString &fileName, const QString &error)
+{
+    emit protocolStatusMessage(tr("MAVLink Logging failed"),
+                               tr("Could not write to file %1, disabling logging.").arg(fileName) + " " + error);
+    // Stop logging
+    stopLogging();
+}
+
 bool MAVLinkProtocol::startLogging(const QString& filename)
 {
     if (m_logfile && m_logfile->isOpen())
@@ -393,13 +724,14 @@ bool MAVLinkProtocol::startLogging(const QString& filename)
 
     Q_ASSERT_X(m_logfile == NULL, "startLogging", "m_logFile == NULL");
 
-    m_logfile = new QFile(filename);
-    if (m_logfile->open(QIODevice::WriteOnly | QIODevice::Append)){
+    m_logfile = new TlogWriter(this);
+    connect(m_logfile, SIGNAL(writeFailed(QString,QString)), this, SLOT(logWriteFailed(QString,QString)));
+    if (m_logfile->open(filename)){
          m_loggingEnabled = true;
 
     } else {
         emit protocolStatusMessage(tr("Started MAVLink logging"),
-                                   tr("FAILED: MAVLink cannot start logging to.").arg(m_logfile->fileName()));
+                                   tr("FAILED: MAVLink cannot start logging to.").arg(filename));
         m_loggingEnabled = false;
         delete m_logfile;
         m_logfile = NULL;
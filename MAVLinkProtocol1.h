@@ -44,8 +44,31 @@ This file is part of the APM_PLANNER project
 #include "QGC.h"
 #include <QDataStream>
 #include "UASInterface1.h"
+#include <QPointer>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include "LinkIngestStats.h"
+#include "MAVLinkMessageRef.h"
+#include "GroundClock.h"
 //#include "MAVLinkDecoder1.h"
 class LinkManager;
+class MAVLinkIngest;
+class MAVLinkStreamModel;
+class MAVLinkMessageCache;
+class MAVLinkSender;
+class MAVLinkRouter;
+class MAVLinkLatencyProbe;
+class MAVLinkFusion;
+class MAVLinkFanout;
+class StateWebSocketServer;
+class TelemetryHistory;
+class TrackHistory;
+class TerrainCache;
+class HilBridge;
+class MAVLinkDispatcher;
+class TlogWriter;
+struct VehicleState;
 class MAVLinkProtocol : public QObject
 {
     Q_OBJECT
@@ -54,35 +77,134 @@ public:
     ~MAVLinkProtocol();
 
     void setConnectionManager(LinkManager *manager) { m_connectionManager = manager; }
-    void sendMessage(mavlink_message_t) { }
+    int getSystemId() { return 252; }
+    int getComponentId() { return 1; }
+    /** @brief Queue a packed message on every connected link */
+    void sendMessage(const mavlink_message_t &message);
+    /** @brief Queue a packed message on one link, see MAVLinkSender for ordering and rate caps */
+    void sendMessage(LinkInterface *link, const mavlink_message_t &message);
     void stopLogging();
     bool startLogging(const QString& filename);
     bool loggingEnabled() { return m_loggingEnabled; }
+    /** @brief While replaying, frames carrying our own system ID are GCS traffic and dropped */
+    void setThrowAwayGCSPackets(bool enabled) { m_throwAwayGCSPackets = enabled; }
+    /** @brief Where consumers subscribe to the messages they handle */
+    MAVLinkDispatcher *dispatcher() { return m_dispatcher; }
+    MAVLinkIngest *ingest() { return m_ingest; }
+    /** @brief Lock free copy of sysid's state as parsed, false before its first message. Any thread */
+    bool vehicleState(int sysid, VehicleState *state) const;
+    /** @brief Per stream rate and bandwidth of everything received */
+    MAVLinkStreamModel *streamModel() { return m_streamModel; }
+    /** @brief Latest message of every stream, for views that open late */
+    MAVLinkMessageCache *messageCache() { return m_messageCache; }
+    MAVLinkSender *sender() { return m_sender; }
+    /** @brief Relays frames between links when enabled */
+    MAVLinkRouter *router() { return m_router; }
+    /** @brief Round trip times of the links, from our own PINGs */
+    MAVLinkLatencyProbe *latencyProbe() { return m_latencyProbe; }
+    /** @brief Link groups of redundant links to the same vehicle */
+    MAVLinkFusion *fusion() { return m_fusion; }
+    /** @brief Serves the received stream to TCP and UDP subscribers */
+    MAVLinkFanout *fanout() { return m_fanout; }
+    /** @brief Serves the decoded vehicle state to browser dashboards over WebSocket */
+    StateWebSocketServer *stateServer() { return m_stateServer; }
+    /** @brief Recent altitude, speed and battery of every vehicle, recorded as frames are parsed */
+    TelemetryHistory *history() { return m_history; }
+    /** @brief Simplified flown track of every vehicle, recorded as frames are parsed */
+    TrackHistory *track() { return m_track; }
+    /** @brief Terrain height under every vehicle from offline tiles, sampled as frames are parsed */
+    TerrainCache *terrain() { return m_terrain; }
+    /** @brief Hardware in the loop with a simulator, gets HIL_CONTROLS as frames are parsed */
+    HilBridge *hil() { return m_hil; }
+    /** @brief Frame one read of a link. Runs on the ingest thread, never touches UAS objects */
+    void parseBytes(const QPointer<LinkInterface> &link, int linkId, LinkIngestStats *stats, const QByteArray &b,
+                    qint64 readTime = 0);
+    /** @brief Parser counters of a link, null until it delivered its first read */
+    QSharedPointer<LinkIngestStats> linkStats(int linkId) const;
+    void removeLinkStats(int linkId);
+    /** @brief Packet loss in percent over the last 32 packets, per component of a system that has sent any */
+    QMap<int,float> componentLoss(int sysid) const;
+    /** @brief App in the background: links, logging, loss accounting and the state snapshots go on,
+     *         but only alerting messages and replies to our own requests are dispatched, and the stream
+     *         model and message cache stop notifying. Leaving it dispatches the latest state message of
+     *         every stream that moved meanwhile, so the overviews are current before the next frame */
+    void setBackground(bool background);
+    bool isBackground() const { return m_background; }
+    /** @brief Log (stamped with read), account and (if dispatch) emit one decoded message on the UI thread;
+     *         false drops the rest of the batch for this link */
+    bool handleMessage(LinkInterface *link, const MAVLinkMessageRef &ref, const GroundClock::Stamp &read,
+                       bool dispatch = true);
 private:
-    int getSystemId() { return 252; }
-    int getComponentId() { return 1; }
+    /** @brief Sequence tracking of one system / component pair */
+    struct SequenceState
+    {
+        qint16 lastSeq;
+        quint32 received;
+        quint32 lost;
+        quint16 windowReceived;
+        quint16 windowLost;
+        float recentLoss;
+        SequenceState() : lastSeq(-1), received(0), lost(0), windowReceived(0), windowLost(0), recentLoss(0) { }
+    };
+    SequenceState &sequenceState(uint8_t sysid, uint8_t compid);
+    /** @brief Dispatched in the background: failsafe, battery, STATUSTEXT and protocol replies */
+    static bool isBackgroundMessage(int msgid);
+
+    enum { ScanIncomplete = 0, ScanBadLength = -1, ScanBadCrc = -2, ScanUnsupported = -3 };
+    /** @brief Validate a complete frame starting at STX in place; returns its length or one of the Scan codes */
+    static int scanFrame(const uint8_t *frame, int available, mavlink_message_t *message);
+    /** @brief Same for a MAVLink 2 frame, which comes out zero extended as the equivalent v1 frame */
+    static int scanFrame2(const uint8_t *frame, int available, mavlink_message_t *message);
     bool m_loggingEnabled;
-    QFile *m_logfile;
+    TlogWriter *m_logfile;
 
     bool m_throwAwayGCSPackets;
     LinkManager *m_connectionManager;
     bool versionMismatchIgnore;
     QMap<int,qint64> totalReceiveCounter;
     QMap<int,qint64> currReceiveCounter;
-    QMap<int,QMap<int,uint8_t> > lastIndex;
+    SequenceState *m_sequences[256]; ///< 256 components per system, allocated when the system first sends
     QMap<int,qint64> totalLossCounter;
     QMap<int,qint64> currLossCounter;
     bool m_enable_version_check;
+    bool m_background;
+    quint32 m_backgroundGeneration;     ///< Message cache generation when the background started
+    int m_backgroundHeld;               ///< Messages not dispatched since then
+    QElapsedTimer m_backgroundClock;
+    MAVLinkIngest *m_ingest;
+    MAVLinkDispatcher *m_dispatcher;
+    MAVLinkStreamModel *m_streamModel;
+    MAVLinkMessageCache *m_messageCache;
+    MAVLinkSender *m_sender;
+    MAVLinkRouter *m_router;
+    MAVLinkLatencyProbe *m_latencyProbe;
+    MAVLinkFusion *m_fusion;
+    MAVLinkFanout *m_fanout;
+    StateWebSocketServer *m_stateServer;
+    TelemetryHistory *m_history;
+    TrackHistory *m_track;
+    TerrainCache *m_terrain;
+    HilBridge *m_hil;
+    QMap<int,QSharedPointer<LinkIngestStats> > m_linkStats;
+    mutable QMutex m_linkStatsMutex; ///< Links read on their own threads, also serialises postBytes
 
 signals:
     void protocolStatusMessage(const QString& title, const QString& message);
     void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
     void receiveLossChanged(int id,float value);
+    void componentLossChanged(int sysid, int compid, float loss);
+    /** @brief The first MAVLink 2 frame arrived on a link. Emitted from the ingest thread */
+    void linkProtocolVersionChanged(int linkId, int version);
     void messageReceived(LinkInterface *link,mavlink_message_t message);
+    /** @brief Emitted from the ingest thread when a link only seems to carry garbage */
+    void linkResetRequested(int linkId);
 
 public slots:
+    /** @brief Hand a link read to the ingest thread. Safe from any thread */
     void receiveBytes(LinkInterface* link, QByteArray b);
+private slots:
+    void logWriteFailed(const QString &fileName, const QString &error);
 };
 
 #endif // NEW_MAVLINKPARSER_H
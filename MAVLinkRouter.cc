@@ -0,0 +1,201 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkRouter
+ *          See MAVLinkRouter.h
+ *
+ */
+
+#include "MAVLinkRouter.h"
+#include "MAVLinkSender.h"
+#include "QsLog.h"
+#include <cstring>
+
+const MAVLinkRouter::Target &MAVLinkRouter::targetOf(int msgid)
+{
+    // Target field offsets from the message definitions, looked up once
+    static Target targets[256];
+    static bool initialised = false;
+    if (!initialised)
+    {
+        static const mavlink_message_info_t info[256] = MAVLINK_MESSAGE_INFO;
+        for (int i = 0; i < 256; i++)
+        {
+            targets[i].system = -1;
+            targets[i].component = -1;
+            for (unsigned f = 0; f < info[i].num_fields; f++)
+            {
+                if (strcmp(info[i].fields[f].name, "target_system") == 0)
+                {
+                    targets[i].system = info[i].fields[f].wire_offset;
+                }
+                else if (strcmp(info[i].fields[f].name, "target_component") == 0)
+                {
+                    targets[i].component = info[i].fields[f].wire_offset;
+                }
+            }
+        }
+        initialised = true;
+    }
+    return targets[msgid & 0xFF];
+}
+
+MAVLinkRouter::MAVLinkRouter(MAVLinkSender *sender, QObject *parent) :
+    QObject(parent),
+    m_sender(sender),
+    m_enabled(false)
+{
+}
+
+void MAVLinkRouter::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+    {
+        return;
+    }
+    m_enabled = enabled;
+    m_routes.clear();
+    QLOG_INFO() << "MAVLinkRouter:" << (enabled ? "enabled" : "disabled");
+}
+
+LinkInterface *MAVLinkRouter::linkById(int linkId) const
+{
+    foreach (const QPointer<LinkInterface> &link, m_links)
+    {
+        if (link && link->getId() == linkId)
+        {
+            return link;
+        }
+    }
+    return NULL;
+}
+
+void MAVLinkRouter::addLink(LinkInterface *link)
+{
+    if (link && link->getLinkType() != LinkInterface::REPLAY_LINK && !linkById(link->getId()))
+    {
+        m_links.append(link);
+    }
+}
+
+void MAVLinkRouter::route(LinkInterface *link, const mavlink_message_t &message)
+{
+    if (!m_enabled || link->getLinkType() == LinkInterface::REPLAY_LINK)
+    {
+        return;
+    }
+    int linkId = link->getId();
+    addLink(link);
+
+    // Learn the source, or recognise a copy that came round through another relay
+    int key = routeKey(message.sysid, message.compid);
+    QHash<int, int>::iterator route = m_routes.find(key);
+    if (route == m_routes.end())
+    {
+        m_routes.insert(key, linkId);
+    }
+    else if (route.value() != linkId)
+    {
+        if (linkById(route.value()))
+        {
+            m_stats.suppressed++;
+            return;
+        }
+        // The old link is gone, the component moved
+        route.value() = linkId;
+    }
+
+    const Target &target = targetOf(message.msgid);
+    const uint8_t *payload = (const uint8_t*)_MAV_PAYLOAD(&message);
+    int targetSystem = (target.system >= 0 && target.system < message.len) ? payload[target.system] : 0;
+    if (targetSystem != 0)
+    {
+        int targetComponent = (target.component >= 0 && target.component < message.len) ? payload[target.component] : 0;
+        int destination = m_routes.value(routeKey(targetSystem, targetComponent), -1);
+        if (destination < 0)
+        {
+            destination = linkForSystem(targetSystem);
+        }
+        if (destination >= 0)
+        {
+            // Known target: its link only, and not back where it came from
+            LinkInterface *out = linkById(destination);
+            if (out && destination != linkId && out->isConnected())
+            {
+                m_sender->forward(out, message);
+                m_stats.forwarded++;
+                m_stats.targeted++;
+            }
+            return;
+        }
+    }
+    forward(link, message);
+}
+
+void MAVLinkRouter::forward(LinkInterface *exclude, const mavlink_message_t &message)
+{
+    foreach (const QPointer<LinkInterface> &link, m_links)
+    {
+        if (link && link != exclude && link->isConnected())
+        {
+            m_sender->forward(link, message);
+            m_stats.forwarded++;
+        }
+    }
+}
+
+int MAVLinkRouter::linkForSystem(int sysid) const
+{
+    for (QHash<int, int>::const_iterator it = m_routes.constBegin(); it != m_routes.constEnd(); ++it)
+    {
+        if ((it.key() >> 8) == sysid)
+        {
+            return it.value();
+        }
+    }
+    return -1;
+}
+
+void MAVLinkRouter::removeLink(int linkId)
+{
+    for (int i = m_links.size() - 1; i >= 0; i--)
+    {
+        if (!m_links.at(i) || m_links.at(i)->getId() == linkId)
+        {
+            m_links.removeAt(i);
+        }
+    }
+    QHash<int, int>::iterator it = m_routes.begin();
+    while (it != m_routes.end())
+    {
+        if (it.value() == linkId)
+        {
+            it = m_routes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
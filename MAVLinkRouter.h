@@ -0,0 +1,92 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkRouter
+ *          Forwards received frames between links, byte for byte, so the
+ *          tablet can relay between a radio and a companion computer. Which
+ *          link a system / component lives on is learned from its traffic.
+ *          Targeted messages go only to the link of their target, the rest to
+ *          every other link; a frame is never sent back where it came from,
+ *          and copies of a component heard on a second link are dropped so two
+ *          relays cannot ping-pong traffic between each other.
+ *
+ */
+
+#ifndef MAVLINKROUTER_H
+#define MAVLINKROUTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+
+class MAVLinkSender;
+
+class MAVLinkRouter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats
+    {
+        quint32 forwarded;    ///< Frames queued on another link, once per destination
+        quint32 targeted;     ///< Frames that went only to their target's link
+        quint32 suppressed;   ///< Copies of a component heard on a second link
+        Stats() : forwarded(0), targeted(0), suppressed(0) { }
+    };
+
+    MAVLinkRouter(MAVLinkSender *sender, QObject *parent = 0);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /** @brief Learn the source of a frame received on link and forward it. UI thread */
+    void route(LinkInterface *link, const mavlink_message_t &message);
+    /** @brief Make a link a destination before it has sent anything */
+    void addLink(LinkInterface *link);
+    void removeLink(int linkId);
+    /** @brief Link a system was last heard on, -1 if none */
+    int linkForSystem(int sysid) const;
+    Stats stats() const { return m_stats; }
+
+private:
+    struct Target
+    {
+        qint16 system;     ///< Payload offset of target_system, -1 if the message has none
+        qint16 component;
+    };
+    static const Target &targetOf(int msgid);
+    static int routeKey(int sysid, int compid) { return (sysid << 8) | compid; }
+    void forward(LinkInterface *exclude, const mavlink_message_t &message);
+    LinkInterface *linkById(int linkId) const;
+
+    MAVLinkSender *m_sender;
+    bool m_enabled;
+    QHash<int, int> m_routes;          ///< sysid / compid to link ID
+    QList<QPointer<LinkInterface> > m_links;
+    Stats m_stats;
+};
+
+#endif // MAVLINKROUTER_H
@@ -0,0 +1,369 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkSender
+ *          See MAVLinkSender.h
+ *
+ */
+
+#include "MAVLinkSender.h"
+#include "MAVLink2.h"
+#include "QsLog.h"
+
+// Commands, mode changes, manual control and link keepalive
+static const int controlMessages[] = {
+    MAVLINK_MSG_ID_HEARTBEAT,
+    MAVLINK_MSG_ID_PING,
+    MAVLINK_MSG_ID_SET_MODE,
+    MAVLINK_MSG_ID_COMMAND_LONG,
+    MAVLINK_MSG_ID_COMMAND_ACK,
+    MAVLINK_MSG_ID_MANUAL_CONTROL,
+    MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE,
+    MAVLINK_MSG_ID_MISSION_SET_CURRENT,
+    MAVLINK_MSG_ID_SYSTEM_TIME,
+    -1
+};
+
+// Transfers that may take all the bandwidth they are given
+static const int bulkMessages[] = {
+    MAVLINK_MSG_ID_LOG_REQUEST_LIST,
+    MAVLINK_MSG_ID_LOG_REQUEST_DATA,
+    MAVLINK_MSG_ID_LOG_ERASE,
+    MAVLINK_MSG_ID_GPS_INJECT_DATA,
+    MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE,
+    MAVLINK_MSG_ID_ENCAPSULATED_DATA,
+    MAVLINK_MSG_ID_SERIAL_CONTROL,
+    -1
+};
+
+static bool contains(const int *table, int msgid)
+{
+    for (int i = 0; table[i] != -1; i++)
+    {
+        if (table[i] == msgid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int MAVLinkSender::Queue::frontLength() const
+{
+    return mavlink_frame_length((const uint8_t*)frames.constData() + offset);
+}
+
+void MAVLinkSender::Queue::pop(QByteArray *out)
+{
+    int length = frontLength();
+    out->append(frames.constData() + offset, length);
+    offset += length;
+    if (offset == frames.size())
+    {
+        frames.resize(0);
+        offset = 0;
+    }
+    else if (offset > frames.size() / 2)
+    {
+        frames.remove(0, offset);
+        offset = 0;
+    }
+}
+
+MAVLinkSender::MAVLinkSender(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+MAVLinkSender::~MAVLinkSender()
+{
+    qDeleteAll(m_links);
+}
+
+MAVLinkSender::Priority MAVLinkSender::priorityOf(int msgid)
+{
+    if (contains(controlMessages, msgid))
+    {
+        return ControlPriority;
+    }
+    if (contains(bulkMessages, msgid))
+    {
+        return BulkPriority;
+    }
+    return NormalPriority;
+}
+
+int MAVLinkSender::maxQueued(int priority)
+{
+    switch (priority)
+    {
+    case ControlPriority:
+        return 4 * 1024;
+    case NormalPriority:
+        return 32 * 1024;
+    default:
+        return 64 * 1024;
+    }
+}
+
+int MAVLinkSender::mtu(LinkInterface *link)
+{
+    return (link->getLinkType() == LinkInterface::UDP_LINK) ? UdpMtu : StreamMtu;
+}
+
+MAVLinkSender::LinkQueue *MAVLinkSender::linkQueue(int linkId)
+{
+    LinkQueue *&q = m_links[linkId];
+    if (q == NULL)
+    {
+        q = new LinkQueue();
+        q->lastRefill = m_clock.elapsed();
+    }
+    return q;
+}
+
+MAVLinkSender::LinkQueue *MAVLinkSender::linkQueue(LinkInterface *link)
+{
+    LinkQueue *q = linkQueue(link->getId());
+    q->link = link;
+    return q;
+}
+
+int MAVLinkSender::frame(const LinkQueue *q, const mavlink_message_t &message, uint8_t *buffer, const char **data)
+{
+    if (q->version >= 2)
+    {
+        // Re-framing keeps the sequence, so forwarded frames still show loss end to end
+        *data = (const char*)buffer;
+        return mavlink2_pack(message, buffer);
+    }
+    *data = (const char*)&message.magic;
+    return MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+}
+
+bool MAVLinkSender::enqueue(LinkQueue *q, const mavlink_message_t &message)
+{
+    Queue &queue = q->queues[priorityOf(message.msgid)];
+    uint8_t buffer[MAVLINK2_NUM_NON_PAYLOAD_BYTES + MAVLINK_MAX_PAYLOAD_LEN];
+    const char *data;
+    const int length = frame(q, message, buffer, &data);
+    if (queue.frames.size() - queue.offset + length > maxQueued(priorityOf(message.msgid)))
+    {
+        if (q->stats.dropped++ % 100 == 0)
+        {
+            QLOG_WARN() << "MAVLinkSender: queue full on" << q->link->getName() << ", dropped" << q->stats.dropped << "frames";
+        }
+        return false;
+    }
+    queue.frames.append(data, length);
+
+    // Everything sent in this turn of the event loop goes out together
+    if (!m_timer.isActive())
+    {
+        m_timer.start(0);
+    }
+    return true;
+}
+
+void MAVLinkSender::stamp(LinkQueue *q, mavlink_message_t *message)
+{
+    // One sequence per link, as the receiving end counts loss per link
+    static const uint8_t crcExtra[256] = MAVLINK_MESSAGE_CRCS;
+    message->seq = q->txSeq++;
+    uint16_t checksum = crc_calculate((uint8_t*)&message->len, message->len + MAVLINK_CORE_HEADER_LEN);
+    crc_accumulate(crcExtra[message->msgid], &checksum);
+    mavlink_ck_a(message) = (uint8_t)(checksum & 0xFF);
+    mavlink_ck_b(message) = (uint8_t)(checksum >> 8);
+}
+
+bool MAVLinkSender::send(LinkInterface *link, mavlink_message_t message)
+{
+    if (!link)
+    {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = linkQueue(link);
+    stamp(q, &message);
+    return enqueue(q, message);
+}
+
+bool MAVLinkSender::sendNow(int linkId, mavlink_message_t message)
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = m_links.value(linkId);
+    // removeLink() runs before the link is deleted, so a link seen here is alive
+    if (!q || q->link.isNull() || !q->link->isConnected())
+    {
+        return false;
+    }
+    stamp(q, &message);
+    uint8_t buffer[MAVLINK2_NUM_NON_PAYLOAD_BYTES + MAVLINK_MAX_PAYLOAD_LEN];
+    const char *data;
+    const int length = frame(q, message, buffer, &data);
+    // Links take writes from any thread
+    q->link->writeBytes(data, length);
+    q->stats.frames++;
+    q->stats.writes++;
+    q->stats.bytes += length;
+    return true;
+}
+
+bool MAVLinkSender::forward(LinkInterface *link, const mavlink_message_t &message)
+{
+    if (!link)
+    {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    return enqueue(linkQueue(link), message);
+}
+
+bool MAVLinkSender::flushLink(LinkQueue &q, qint64 now)
+{
+    if (q.rateLimit > 0)
+    {
+        double burst = qMax((double)mtu(q.link), q.rateLimit / 10.0);
+        q.tokens = qMin(burst, q.tokens + q.rateLimit * (now - q.lastRefill) / 1000.0);
+    }
+    q.lastRefill = now;
+
+    QByteArray batch;
+    int limit = mtu(q.link);
+    // A backed up link takes control traffic only, the rest waits in our queues
+    bool congested = q.link->isWriteCongested();
+    forever
+    {
+        // Fill one write, highest class first, whole frames only
+        for (int priority = ControlPriority; priority < PriorityCount; priority++)
+        {
+            Queue &queue = q.queues[priority];
+            while (!queue.isEmpty() && batch.size() + queue.frontLength() <= limit)
+            {
+                if (priority != ControlPriority && (congested || (q.rateLimit > 0 && q.tokens < queue.frontLength())))
+                {
+                    break;
+                }
+                if (q.rateLimit > 0)
+                {
+                    q.tokens -= queue.frontLength();
+                }
+                queue.pop(&batch);
+                q.stats.frames++;
+            }
+        }
+        if (batch.isEmpty())
+        {
+            break;
+        }
+        if (q.link->isConnected())
+        {
+            q.link->writeBytes(batch.constData(), batch.size());
+            q.stats.writes++;
+            q.stats.bytes += batch.size();
+        }
+        batch.resize(0);
+    }
+
+    for (int priority = ControlPriority; priority < PriorityCount; priority++)
+    {
+        if (!q.queues[priority].isEmpty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MAVLinkSender::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 now = m_clock.elapsed();
+    bool pending = false;
+    QMap<int, LinkQueue*>::iterator it = m_links.begin();
+    while (it != m_links.end())
+    {
+        LinkQueue *q = it.value();
+        // A link deleted with frames queued keeps its entry until removeLink()
+        if (!q->link.isNull())
+        {
+            pending |= flushLink(*q, now);
+        }
+        ++it;
+    }
+    // Only a rate capped or congested link keeps frames back, come back for them shortly
+    if (pending)
+    {
+        m_timer.start(TickIntervalMs);
+    }
+}
+
+void MAVLinkSender::setRateLimit(int linkId, int bytesPerSecond)
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = linkQueue(linkId);
+    q->rateLimit = qMax(0, bytesPerSecond);
+    q->tokens = 0;
+}
+
+int MAVLinkSender::rateLimit(int linkId) const
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = m_links.value(linkId);
+    return q ? q->rateLimit : 0;
+}
+
+void MAVLinkSender::setProtocolVersion(int linkId, int version)
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = linkQueue(linkId);
+    if (q->version != version)
+    {
+        QLOG_INFO() << "MAVLinkSender: link" << linkId << "now sends MAVLink" << version;
+        q->version = version;
+    }
+}
+
+int MAVLinkSender::protocolVersion(int linkId) const
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = m_links.value(linkId);
+    return q ? q->version : 1;
+}
+
+void MAVLinkSender::removeLink(int linkId)
+{
+    QMutexLocker locker(&m_mutex);
+    delete m_links.take(linkId);
+}
+
+MAVLinkSender::Stats MAVLinkSender::stats(int linkId) const
+{
+    QMutexLocker locker(&m_mutex);
+    LinkQueue *q = m_links.value(linkId);
+    return q ? q->stats : Stats();
+}
@@ -0,0 +1,140 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkSender
+ *          Outbound half of the protocol. Messages are stamped with the link's
+ *          own sequence number and queued per link in one of three priority
+ *          classes (control, parameter / mission, bulk). Everything queued in
+ *          one turn of the event loop leaves as few writes as possible: whole
+ *          frames, highest class first, packed up to the link MTU, so a command
+ *          never waits behind a log download. A per link byte rate cap throttles
+ *          the lower two classes; control traffic is never held back by it,
+ *          nor by a link reporting LinkInterface::isWriteCongested().
+ *          Links whose far end has been heard speaking MAVLink 2 get v2 frames
+ *          with truncated payloads. sendNow() writes a control frame from any
+ *          thread without waiting for the event loop, see ManualControl.
+ *
+ */
+
+#ifndef MAVLINKSENDER_H
+#define MAVLINKSENDER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QMap>
+#include <QMutex>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+
+class MAVLinkSender : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority { ControlPriority = 0, NormalPriority, BulkPriority, PriorityCount };
+
+    struct Stats
+    {
+        quint32 frames;
+        quint32 writes;        ///< Datagrams / write calls, frames per write shows the coalescing
+        quint64 bytes;
+        quint32 dropped;       ///< Frames refused because their queue was full
+        Stats() : frames(0), writes(0), bytes(0), dropped(0) { }
+    };
+
+    explicit MAVLinkSender(QObject *parent = 0);
+    ~MAVLinkSender();
+
+    static Priority priorityOf(int msgid);
+
+    /** @brief Queue a packed message for link; false if its queue is full */
+    bool send(LinkInterface *link, mavlink_message_t message);
+    /**
+     * @brief Write message to linkId right away, ahead of the queues. Any thread
+     * @return false if the link is unknown, gone or not connected
+     */
+    bool sendNow(int linkId, mavlink_message_t message);
+    /** @brief Queue a received frame as is, sequence and CRC untouched, for routing */
+    bool forward(LinkInterface *link, const mavlink_message_t &message);
+    /** @brief Bytes per second for the normal and bulk classes, 0 for no cap */
+    void setRateLimit(int linkId, int bytesPerSecond);
+    int rateLimit(int linkId) const;
+    /** @brief Drop everything queued for a link that is going away */
+    void removeLink(int linkId);
+    Stats stats(int linkId) const;
+    int protocolVersion(int linkId) const;
+
+public slots:
+    /** @brief Frame everything queued for the link from now on as MAVLink 1 or 2 */
+    void setProtocolVersion(int linkId, int version);
+
+private slots:
+    void flush();
+
+private:
+    enum {
+        TickIntervalMs = 10,   ///< While a capped link still has frames queued
+        UdpMtu = 1472,         ///< Ethernet MTU less IP and UDP headers
+        StreamMtu = 1024       ///< Serial and TCP writes
+    };
+    struct Queue
+    {
+        QByteArray frames;     ///< Back to back frames, consumed from offset
+        int offset;
+        Queue() : offset(0) { }
+        bool isEmpty() const { return offset >= frames.size(); }
+        int frontLength() const;
+        void pop(QByteArray *out);
+    };
+    struct LinkQueue
+    {
+        QPointer<LinkInterface> link;
+        Queue queues[PriorityCount];
+        quint8 txSeq;
+        int version;
+        int rateLimit;
+        double tokens;         ///< Byte budget of the rate cap
+        qint64 lastRefill;
+        Stats stats;
+        LinkQueue() : txSeq(0), version(1), rateLimit(0), tokens(0), lastRefill(0) { }
+    };
+    LinkQueue *linkQueue(LinkInterface *link);
+    LinkQueue *linkQueue(int linkId);
+    bool enqueue(LinkQueue *q, const mavlink_message_t &message);
+    static void stamp(LinkQueue *q, mavlink_message_t *message);
+    static int frame(const LinkQueue *q, const mavlink_message_t &message, uint8_t *buffer, const char **data);
+    static int maxQueued(int priority);
+    static int mtu(LinkInterface *link);
+    /** @brief Write one packed batch for q, returns true if frames are left over */
+    bool flushLink(LinkQueue &q, qint64 now);
+
+    QMap<int, LinkQueue*> m_links;   ///< Under m_mutex, sendNow() comes from other threads
+    mutable QMutex m_mutex;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+};
+
+#endif // MAVLINKSENDER_H
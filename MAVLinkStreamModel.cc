@@ -0,0 +1,204 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkStreamModel
+ *          See MAVLinkStreamModel.h
+ *
+ */
+
+#include "MAVLinkStreamModel.h"
+#include "QsLog.h"
+#include <cstring>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+static const char *messageName(int msgid)
+{
+    static const mavlink_message_info_t info[256] = MAVLINK_MESSAGE_INFO;
+    return info[msgid & 0xFF].name;
+}
+
+MAVLinkStreamModel::MAVLinkStreamModel(QObject *parent) :
+    QAbstractListModel(parent),
+    m_count(0),
+    m_bucket(0),
+    m_buckets(0),
+    m_overflow(0),
+    m_totalBytesPerSecond(0),
+    m_totalRate(0)
+{
+    memset(m_table, -1, sizeof(m_table));
+    m_clock.start();
+    m_timer.setInterval(SampleIntervalMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(sample()));
+    m_timer.start();
+}
+
+int MAVLinkStreamModel::find(quint32 key) const
+{
+    // Linear probing, the table never fills past half
+    int slot = (key * 2654435761u) >> 23;
+    while (m_table[slot] >= 0)
+    {
+        if (m_streams[m_table[slot]].key == key)
+        {
+            return slot;
+        }
+        slot = (slot + 1) % TableSize;
+    }
+    return slot;
+}
+
+void MAVLinkStreamModel::addMessage(int sysid, int compid, int msgid, int frameBytes)
+{
+    quint32 key = streamKey(sysid, compid, msgid);
+    int slot = find(key);
+    int row = m_table[slot];
+    if (row < 0)
+    {
+        if (m_count == MaxStreams)
+        {
+            if (m_overflow++ == 0)
+            {
+                QLOG_WARN() << "MAVLinkStreamModel: more than" << MaxStreams << "streams, ignoring the rest";
+            }
+            return;
+        }
+        row = m_count;
+        Stream &stream = m_streams[row];
+        memset(&stream, 0, sizeof(stream));
+        stream.key = key;
+        beginInsertRows(QModelIndex(), row, row);
+        m_table[slot] = row;
+        m_count++;
+        endInsertRows();
+    }
+    Stream &stream = m_streams[row];
+    stream.messages[m_bucket]++;
+    stream.bytes[m_bucket] += frameBytes;
+    stream.lastSeen = m_clock.elapsed();
+}
+
+void MAVLinkStreamModel::clear()
+{
+    beginResetModel();
+    memset(m_table, -1, sizeof(m_table));
+    m_count = 0;
+    m_bucket = 0;
+    m_buckets = 0;
+    m_overflow = 0;
+    m_totalBytesPerSecond = 0;
+    m_totalRate = 0;
+    endResetModel();
+    emit updated();
+}
+
+void MAVLinkStreamModel::sample()
+{
+    // The bucket just finished counts, the rates average the filled ones
+    m_buckets = qMin(m_buckets + 1, (int)WindowSeconds);
+    double seconds = m_buckets * (SampleIntervalMs / 1000.0);
+    m_totalBytesPerSecond = 0;
+    m_totalRate = 0;
+    int next = (m_bucket + 1) % WindowSeconds;
+    for (int row = 0; row < m_count; row++)
+    {
+        Stream &stream = m_streams[row];
+        quint32 messages = 0;
+        quint32 bytes = 0;
+        for (int i = 0; i < WindowSeconds; i++)
+        {
+            messages += stream.messages[i];
+            bytes += stream.bytes[i];
+        }
+        stream.rate = messages / seconds;
+        stream.bytesPerSecond = bytes / seconds;
+        m_totalRate += stream.rate;
+        m_totalBytesPerSecond += stream.bytesPerSecond;
+        stream.messages[next] = 0;
+        stream.bytes[next] = 0;
+    }
+    m_bucket = next;
+
+    if (m_count > 0)
+    {
+        emit dataChanged(index(0), index(m_count - 1));
+    }
+    emit updated();
+}
+
+int MAVLinkStreamModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant MAVLinkStreamModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count)
+    {
+        return QVariant();
+    }
+    const Stream &stream = m_streams[index.row()];
+    switch (role)
+    {
+    case SystemIdRole:
+        return (int)(stream.key >> 16);
+    case ComponentIdRole:
+        return (int)((stream.key >> 8) & 0xFF);
+    case MessageIdRole:
+        return (int)(stream.key & 0xFF);
+    case Qt::DisplayRole:
+    case NameRole:
+        return QString(messageName(stream.key & 0xFF));
+    case RateRole:
+        return stream.rate;
+    case BytesPerSecondRole:
+        return stream.bytesPerSecond;
+    case ShareRole:
+        return (m_totalBytesPerSecond > 0) ? 100.0 * stream.bytesPerSecond / m_totalBytesPerSecond : 0.0;
+    case LastSeenRole:
+        return m_clock.elapsed() - stream.lastSeen;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> MAVLinkStreamModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[SystemIdRole] = "sysid";
+    roles[ComponentIdRole] = "compid";
+    roles[MessageIdRole] = "msgid";
+    roles[NameRole] = "name";
+    roles[RateRole] = "rate";
+    roles[BytesPerSecondRole] = "bytesPerSecond";
+    roles[ShareRole] = "share";
+    roles[LastSeenRole] = "lastSeen";
+    return roles;
+}
+
+double MAVLinkStreamModel::rate(int sysid, int compid, int msgid) const
+{
+    int row = m_table[find(streamKey(sysid, compid, msgid))];
+    return (row < 0) ? 0.0 : m_streams[row].rate;
+}
@@ -0,0 +1,111 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkStreamModel
+ *          Rate, bandwidth and last seen time of every message stream, one row
+ *          per system / component / message ID. The counters live in a fixed
+ *          table filled on the UI thread as messages are handled; once a
+ *          second the rates over the last few seconds are recomputed and the
+ *          view is told, so which streams fill the radio link can be read
+ *          straight off the HUD.
+ *
+ */
+
+#ifndef MAVLINKSTREAMMODEL_H
+#define MAVLINKSTREAMMODEL_H
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class MAVLinkStreamModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(double totalBytesPerSecond READ totalBytesPerSecond NOTIFY updated)
+    Q_PROPERTY(double totalRate READ totalRate NOTIFY updated)
+public:
+    enum Roles {
+        SystemIdRole = Qt::UserRole + 1,
+        ComponentIdRole,
+        MessageIdRole,
+        NameRole,
+        RateRole,            ///< Messages per second
+        BytesPerSecondRole,  ///< Whole frames, header and CRC included
+        ShareRole,           ///< Percent of all received bytes
+        LastSeenRole         ///< Milliseconds since the last message
+    };
+
+    explicit MAVLinkStreamModel(QObject *parent = 0);
+
+    /** @brief Account one received frame. UI thread, called for every message */
+    void addMessage(int sysid, int compid, int msgid, int frameBytes);
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    double totalBytesPerSecond() const { return m_totalBytesPerSecond; }
+    double totalRate() const { return m_totalRate; }
+    /** @brief Rate of one stream in Hz, 0 if it was never seen */
+    Q_INVOKABLE double rate(int sysid, int compid, int msgid) const;
+
+signals:
+    void updated();
+
+private slots:
+    void sample();
+
+private:
+    enum {
+        MaxStreams = 256,
+        TableSize = 512,        ///< Open addressed index, twice MaxStreams
+        WindowSeconds = 4,      ///< Rates average this many one second buckets
+        SampleIntervalMs = 1000
+    };
+    struct Stream
+    {
+        quint32 key;
+        quint32 messages[WindowSeconds];
+        quint32 bytes[WindowSeconds];
+        qint64 lastSeen;
+        float rate;
+        float bytesPerSecond;
+    };
+    static quint32 streamKey(int sysid, int compid, int msgid) { return (quint32(sysid) << 16) | (quint32(compid) << 8) | quint32(msgid); }
+    int find(quint32 key) const;
+
+    Stream m_streams[MaxStreams];
+    qint16 m_table[TableSize];  ///< Row of each hashed key, -1 when free
+    int m_count;
+    int m_bucket;               ///< Current one second bucket
+    int m_buckets;              ///< Buckets filled so far, up to WindowSeconds
+    int m_overflow;             ///< Streams that did not fit in the table
+    double m_totalBytesPerSecond;
+    double m_totalRate;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
+
+#endif // MAVLINKSTREAMMODEL_H
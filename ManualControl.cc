@@ -0,0 +1,215 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ManualControl
+ *          See ManualControl.h
+ *
+ */
+
+#include "ManualControl.h"
+#include "MAVLinkSender.h"
+#include "GroundClock.h"
+#include "QsLog.h"
+#include <qmath.h>
+
+ManualControl::ManualControl(MAVLinkSender *sender, QObject *parent) :
+    QThread(parent),
+    m_sender(sender),
+    m_active(false),
+    m_changedNs(0),
+    m_gcsSystem(0),
+    m_gcsComponent(0),
+    m_targetSystem(0),
+    m_deadBand(0.02),
+    m_stopping(false)
+{
+    Sample center = { 0, 0, 0, 0, 0 };
+    m_input = center;
+}
+
+ManualControl::~ManualControl()
+{
+    stop();
+}
+
+double ManualControl::applyDeadBand(double value) const
+{
+    const double magnitude = qAbs(value);
+    if (magnitude <= m_deadBand)
+    {
+        return 0;
+    }
+    // Rescaled, so the axis still reaches full deflection
+    const double scaled = qMin(1.0, (magnitude - m_deadBand) / (1.0 - m_deadBand));
+    return value < 0 ? -scaled : scaled;
+}
+
+void ManualControl::setInput(double roll, double pitch, double yaw, double thrust, int buttons)
+{
+    QMutexLocker locker(&m_mutex);
+    Sample sample;
+    sample.x = static_cast<qint16>(qRound(applyDeadBand(pitch) * 1000));
+    sample.y = static_cast<qint16>(qRound(applyDeadBand(roll) * 1000));
+    sample.z = static_cast<qint16>(qRound(qBound(-1.0, thrust, 1.0) * 1000));
+    sample.r = static_cast<qint16>(qRound(applyDeadBand(yaw) * 1000));
+    sample.buttons = static_cast<quint16>(buttons);
+    if (!m_active || sample != m_input)
+    {
+        m_input = sample;
+        m_changedNs = GroundClock::nsecs();
+    }
+    if (!m_active)
+    {
+        m_active = true;
+        if (!isRunning())
+        {
+            m_stopping = false;
+            start(QThread::TimeCriticalPriority);
+        }
+        m_wake.wakeAll();
+    }
+}
+
+void ManualControl::clearInput()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_active)
+    {
+        m_active = false;
+        QLOG_DEBUG() << "Manual control to system" << m_targetSystem << "stopped," << m_stats.sent << "sent,"
+                     << m_stats.unchanged << "unchanged, latency max" << m_stats.maxLatencyUs
+                     << "us, jitter max" << m_stats.maxJitterUs << "us";
+    }
+}
+
+void ManualControl::setTarget(int gcsSystem, int gcsComponent, int targetSystem, const QList<int> &linkIds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_gcsSystem = gcsSystem;
+    m_gcsComponent = gcsComponent;
+    m_targetSystem = targetSystem;
+    m_links = linkIds;
+}
+
+void ManualControl::setDeadBand(double deadBand)
+{
+    QMutexLocker locker(&m_mutex);
+    m_deadBand = qBound(0.0, deadBand, 0.5);
+}
+
+ManualControl::Stats ManualControl::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void ManualControl::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    wait();
+}
+
+void ManualControl::run()
+{
+    const qint64 periodNs = Q_INT64_C(1000000000) / RateHz;
+    const qint64 keepaliveNs = Q_INT64_C(1000000) * KeepaliveMs;
+    Sample last = m_input;
+    bool sentAny = false;
+    qint64 lastSent = 0;
+    qint64 lastChange = -1;
+    qint64 next = GroundClock::nsecs();
+
+    m_mutex.lock();
+    forever
+    {
+        if (m_stopping)
+        {
+            break;
+        }
+        if (!m_active)
+        {
+            // Idle until a stick moves again, then start a fresh schedule
+            m_wake.wait(&m_mutex);
+            sentAny = false;
+            next = GroundClock::nsecs();
+            continue;
+        }
+
+        const qint64 now = GroundClock::nsecs();
+        m_stats.maxJitterUs = qMax(m_stats.maxJitterUs, (now - next) / 1000);
+        const Sample sample = m_input;
+        const bool changed = !sentAny || sample != last || m_changedNs != lastChange;
+        if (changed || now - lastSent >= keepaliveNs)
+        {
+            // Packed and written outside the lock, setInput() never waits on the link
+            const qint64 changedNs = m_changedNs;
+            const QList<int> links = m_links;
+            const int gcsSystem = m_gcsSystem;
+            const int gcsComponent = m_gcsComponent;
+            const int target = m_targetSystem;
+            m_mutex.unlock();
+
+            mavlink_message_t message;
+            mavlink_msg_manual_control_pack(gcsSystem, gcsComponent, &message, target,
+                                            sample.x, sample.y, sample.z, sample.r, sample.buttons);
+            foreach (int link, links)
+            {
+                m_sender->sendNow(link, message);
+            }
+            const qint64 sent = GroundClock::nsecs();
+
+            m_mutex.lock();
+            if (changed)
+            {
+                m_stats.latencyUs = (sent - changedNs) / 1000;
+                m_stats.maxLatencyUs = qMax(m_stats.maxLatencyUs, m_stats.latencyUs);
+            }
+            m_stats.sent++;
+            last = sample;
+            lastChange = changedNs;
+            lastSent = sent;
+            sentAny = true;
+        }
+        else
+        {
+            m_stats.unchanged++;
+        }
+
+        // Fixed ticks, a late one is not made up for
+        next += periodNs;
+        const qint64 after = GroundClock::nsecs();
+        if (next <= after)
+        {
+            next = after + periodNs;
+        }
+        m_mutex.unlock();
+        QThread::usleep(static_cast<unsigned long>((next - after) / 1000));
+        m_mutex.lock();
+    }
+    m_mutex.unlock();
+}
@@ -0,0 +1,110 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ManualControl
+ *          Sends MANUAL_CONTROL from its own thread at a fixed rate. Sticks and
+ *          gamepads only store their latest position; the thread samples it
+ *          every 1/RateHz seconds, sends it when a quantized axis or a button
+ *          changed, and repeats it every KeepaliveMs otherwise. Frames go
+ *          through MAVLinkSender::sendNow(), so neither rendering nor a burst
+ *          of telemetry on the UI thread delays them.
+ *
+ */
+
+#ifndef MANUALCONTROL_H
+#define MANUALCONTROL_H
+
+#include <QThread>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+class MAVLinkSender;
+
+class ManualControl : public QThread
+{
+    Q_OBJECT
+public:
+    enum { RateHz = 50, KeepaliveMs = 250 };
+
+    struct Stats
+    {
+        quint32 sent;           ///< Samples sent, each to every target link
+        quint32 unchanged;      ///< Samples skipped as equal to the last sent
+        qint64 latencyUs;       ///< Input change to send, of the last change sent
+        qint64 maxLatencyUs;
+        qint64 maxJitterUs;     ///< Latest a sample was taken after its tick
+        Stats() : sent(0), unchanged(0), latencyUs(0), maxLatencyUs(0), maxJitterUs(0) { }
+    };
+
+    explicit ManualControl(MAVLinkSender *sender, QObject *parent = 0);
+    ~ManualControl();
+
+    /**
+     * @brief The latest stick position, any thread
+     *
+     * roll, pitch and yaw in -1..1 get the dead band, thrust is sent as is.
+     * Starts the sending until clearInput().
+     */
+    void setInput(double roll, double pitch, double yaw, double thrust, int buttons);
+    /** @brief Stop sending, e.g. the vehicle left a manual mode */
+    void clearInput();
+    /** @brief Who the frames are from and go to, links by id */
+    void setTarget(int gcsSystem, int gcsComponent, int targetSystem, const QList<int> &linkIds);
+    /** @brief Fraction of the half axis around center that reads 0 */
+    void setDeadBand(double deadBand);
+    Stats stats() const;
+    void stop();
+
+protected:
+    void run();
+
+private:
+    struct Sample
+    {
+        qint16 x, y, z, r;      ///< As sent, -1000..1000
+        quint16 buttons;
+        bool operator!=(const Sample &other) const
+        {
+            return x != other.x || y != other.y || z != other.z || r != other.r || buttons != other.buttons;
+        }
+    };
+    double applyDeadBand(double value) const;
+
+    MAVLinkSender *m_sender;
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    Sample m_input;
+    bool m_active;
+    qint64 m_changedNs;         ///< GroundClock of the last input change
+    int m_gcsSystem;
+    int m_gcsComponent;
+    int m_targetSystem;
+    QList<int> m_links;
+    double m_deadBand;
+    bool m_stopping;
+    Stats m_stats;
+};
+
+#endif // MANUALCONTROL_H
@@ -0,0 +1,306 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MemoryBudget
+ *          See MemoryBudget.h
+ *
+ */
+
+#include "MemoryBudget.h"
+#include "Arena.h"
+#include "GStreamerPlayer.h"
+#include "GStreamerSnapshot.h"
+#include "HudImageProvider.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "TelemetryHistory.h"
+#include "TrackHistory.h"
+#include "QsLog.h"
+#include <QFile>
+#include <QQuickWindow>
+#include <unistd.h>
+
+static const char * const subsystemNames[MemoryBudget::SubsystemCount] = {
+    "Video queues",
+    "Snapshot frames",
+    "HUD images",
+    "Telemetry history",
+    "Breadcrumb track",
+    "Arenas",
+    "Log buffers"
+};
+
+#ifdef Q_OS_ANDROID
+static const char * const ActivityClass = "org/qtproject/qt5/android/bindings/QtActivityEx";
+
+// Called on the Android main thread
+static void nativeTrimMemory(JNIEnv *, jclass, jint level)
+{
+    QMetaObject::invokeMethod(MemoryBudget::instance(), "trimMemory", Qt::QueuedConnection, Q_ARG(int, level));
+}
+
+void MemoryBudget::registerNatives(JNIEnv *env)
+{
+    static JNINativeMethod methods[] = {
+        { const_cast<char*>("nativeTrimMemory"), const_cast<char*>("(I)V"), reinterpret_cast<void*>(nativeTrimMemory) }
+    };
+    jclass activity = env->FindClass(ActivityClass);
+    if (!activity || env->RegisterNatives(activity, methods, sizeof(methods) / sizeof(methods[0])) < 0)
+    {
+        QLOG_ERROR() << "Cannot register the memory trim native";
+        env->ExceptionClear();
+    }
+}
+#endif
+
+MemoryBudget *MemoryBudget::instance()
+{
+    // Reached from the activity before the PFD exists, lives until the process ends
+    static MemoryBudget *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new MemoryBudget();
+    }
+    return _instance;
+}
+
+MemoryBudget::MemoryBudget() :
+    m_imageProvider(NULL),
+    m_residentBytes(0),
+    m_lowMemory(false),
+    m_lastTrimLevel(0)
+{
+    for (int i = 0; i < SubsystemCount; ++i)
+    {
+        m_bytes[i] = 0;
+        m_peakBytes[i] = 0;
+    }
+    m_timer.setInterval(SampleMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(sample()));
+    m_holdTimer.setSingleShot(true);
+    m_holdTimer.setInterval(LowMemoryHoldMs);
+    connect(&m_holdTimer, SIGNAL(timeout()), this, SLOT(endLowMemory()));
+}
+
+void MemoryBudget::setPlayers(const QList<GStreamerPlayer*> &players)
+{
+    m_players.clear();
+    foreach (GStreamerPlayer *player, players)
+    {
+        m_players.append(player);
+    }
+}
+
+void MemoryBudget::setImageProvider(HudImageProvider *provider)
+{
+    m_imageProvider = provider;
+}
+
+void MemoryBudget::setWindow(QQuickWindow *window)
+{
+    m_window = window;
+}
+
+void MemoryBudget::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled())
+    {
+        return;
+    }
+    if (enabled)
+    {
+        m_timer.start();
+        sample();
+    }
+    else
+    {
+        m_timer.stop();
+    }
+    emit enabledChanged(enabled);
+}
+
+qint64 MemoryBudget::readResidentBytes()
+{
+    // statm: total and resident size, in pages
+    QFile statm(QLatin1String("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+void MemoryBudget::sample()
+{
+    m_bytes[VideoQueues] = 0;
+    m_bytes[VideoFrames] = 0;
+    foreach (const QPointer<GStreamerPlayer> &player, m_players)
+    {
+        if (!player)
+        {
+            continue;
+        }
+        m_bytes[VideoQueues] += player->queuedBytes();
+        GStreamerSnapshot *snapshot = qobject_cast<GStreamerSnapshot*>(player->getSnapshot());
+        if (snapshot)
+        {
+            m_bytes[VideoFrames] += snapshot->heldBytes();
+        }
+    }
+    m_bytes[HudImages] = m_imageProvider ? m_imageProvider->cacheBytes() : 0;
+    MAVLinkProtocol *protocol = LinkManager::instance()->getMavlinkProtocol();
+    m_bytes[TelemetryHistoryRings] = protocol->history()->memoryBytes();
+    m_bytes[TrackHistoryPoints] = protocol->track()->memoryBytes();
+    m_bytes[Arenas] = Arena::reservedBytes();
+    m_bytes[LogBuffers] = QsLogging::Logger::instance().bufferedBytes();
+    for (int i = 0; i < SubsystemCount; ++i)
+    {
+        m_peakBytes[i] = qMax(m_peakBytes[i], m_bytes[i]);
+    }
+    m_residentBytes = readResidentBytes();
+    emit dataChanged(index(0), index(SubsystemCount - 1));
+    emit sampled();
+}
+
+double MemoryBudget::trackedBytes() const
+{
+    qint64 total = 0;
+    for (int i = 0; i < SubsystemCount; ++i)
+    {
+        total += m_bytes[i];
+    }
+    return total;
+}
+
+void MemoryBudget::trimMemory(int level)
+{
+    QLOG_WARN() << "Memory trim level" << level << ", resident" << readResidentBytes() / 1024 << "kB";
+    m_lastTrimLevel = level;
+    // Hidden or in the background nothing is drawn, the textures come back when shown
+    if (level >= TrimRunningModerate)
+    {
+        releaseCaches();
+    }
+    // UI_HIDDEN and BACKGROUND alone are not pressure, RUNNING_LOW and MODERATE are
+    if ((level >= TrimRunningLow && level < TrimUiHidden) || level >= TrimModerate)
+    {
+        setLowMemory(true);
+        m_holdTimer.start();
+    }
+    emit trimmed(level);
+    sample();
+}
+
+void MemoryBudget::releaseCaches()
+{
+    if (m_imageProvider)
+    {
+        m_imageProvider->clearCache();
+    }
+    if (m_window)
+    {
+        m_window->releaseResources();
+    }
+}
+
+void MemoryBudget::setLowMemory(bool lowMemory)
+{
+    if (m_lowMemory == lowMemory)
+    {
+        return;
+    }
+    m_lowMemory = lowMemory;
+    QLOG_WARN() << (lowMemory ? "Entering" : "Leaving") << "low memory mode";
+    if (!lowMemory)
+    {
+        m_holdTimer.stop();
+    }
+
+    MAVLinkProtocol *protocol = LinkManager::instance()->getMavlinkProtocol();
+    protocol->history()->setCapacity(lowMemory ? TelemetryHistory::LowMemoryCapacity : TelemetryHistory::Capacity);
+    protocol->track()->setMaxPoints(lowMemory ? TrackHistory::LowMemoryMaxPoints : TrackHistory::MaxPoints);
+
+    if (lowMemory)
+    {
+        m_savedRingSizes.fill(0, m_players.size());
+    }
+    for (int i = 0; i < m_players.size(); ++i)
+    {
+        GStreamerPlayer *player = m_players.at(i);
+        if (!player)
+        {
+            continue;
+        }
+        player->setLowMemory(lowMemory);
+        GStreamerSnapshot *snapshot = qobject_cast<GStreamerSnapshot*>(player->getSnapshot());
+        if (!snapshot)
+        {
+            continue;
+        }
+        if (lowMemory)
+        {
+            m_savedRingSizes[i] = snapshot->getRingSize();
+            snapshot->setRingSize(1);
+        }
+        else if (i < m_savedRingSizes.size() && m_savedRingSizes.at(i) > 0)
+        {
+            snapshot->setRingSize(m_savedRingSizes.at(i));
+        }
+    }
+    if (lowMemory)
+    {
+        releaseCaches();
+    }
+    emit lowMemoryChanged(lowMemory);
+}
+
+int MemoryBudget::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : SubsystemCount;
+}
+
+QVariant MemoryBudget::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= SubsystemCount)
+    {
+        return QVariant();
+    }
+    switch (role)
+    {
+    case NameRole: return QString::fromLatin1(subsystemNames[index.row()]);
+    case BytesRole: return double(m_bytes[index.row()]);
+    case PeakBytesRole: return double(m_peakBytes[index.row()]);
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> MemoryBudget::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[BytesRole] = "bytes";
+    roles[PeakBytesRole] = "peakBytes";
+    return roles;
+}
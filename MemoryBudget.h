@@ -0,0 +1,161 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MemoryBudget
+ *          What the big consumers of memory hold, video queues and frames,
+ *          HUD images, telemetry and track history, arenas and log buffers,
+ *          as one row each for a diagnostic view, and a low memory mode that
+ *          shrinks them when Android reports memory pressure through
+ *          QtActivityEx.onTrimMemory().
+ *
+ */
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#ifdef Q_OS_ANDROID
+#include <jni.h>
+#endif
+
+class GStreamerPlayer;
+class HudImageProvider;
+class QQuickWindow;
+
+/**
+ * @brief Memory accounting per subsystem and the low memory mode
+ *
+ * Rows are sampled every SampleMs while enabled, the performance overlay
+ * turns it on; a trim always samples once. The figures are what each
+ * subsystem knows it holds, not allocator overhead, next to the resident
+ * size of the process.
+ *
+ * Low memory mode shrinks the telemetry history rings to
+ * TelemetryHistory::LowMemoryCapacity, thins the breadcrumb tracks to
+ * TrackHistory::LowMemoryMaxPoints, caps the video queues and frees the
+ * standby pipeline (GStreamerPlayer::setLowMemory), keeps a single
+ * snapshot frame and drops the HUD image cache and the scene graph's
+ * unused textures. Android never says the pressure is over, so the mode
+ * ends LowMemoryHoldMs after the last trim that asked for it, or when it
+ * is turned off by hand.
+ */
+class MemoryBudget : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool lowMemory READ isLowMemory WRITE setLowMemory NOTIFY lowMemoryChanged)
+    Q_PROPERTY(int lastTrimLevel READ lastTrimLevel NOTIFY trimmed)
+    Q_PROPERTY(double trackedBytes READ trackedBytes NOTIFY sampled)
+    Q_PROPERTY(double residentBytes READ residentBytes NOTIFY sampled)
+public:
+    enum Subsystem {
+        VideoQueues,            ///< Buffers in the pipelines' queues
+        VideoFrames,            ///< Decoded frames kept for snapshots
+        HudImages,              ///< Rasterized instrument images
+        TelemetryHistoryRings,
+        TrackHistoryPoints,
+        Arenas,                 ///< See Arena
+        LogBuffers,             ///< QsLog ring and destination blocks
+        SubsystemCount
+    };
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        BytesRole,
+        PeakBytesRole           ///< Most seen since the start
+    };
+    /** @brief ComponentCallbacks2 levels, see onTrimMemory() */
+    enum TrimLevel {
+        TrimRunningModerate = 5,
+        TrimRunningLow = 10,
+        TrimRunningCritical = 15,
+        TrimUiHidden = 20,
+        TrimBackground = 40,
+        TrimModerate = 60,
+        TrimComplete = 80
+    };
+    enum { SampleMs = 2000, LowMemoryHoldMs = 5 * 60 * 1000 };
+
+    static MemoryBudget *instance();
+
+    /** @brief Players whose queues and snapshot rings are counted and trimmed */
+    void setPlayers(const QList<GStreamerPlayer*> &players);
+    /** @brief The provider of image://hud/, owned by the QML engine */
+    void setImageProvider(HudImageProvider *provider);
+    /** @brief Window whose scene graph releases its unused resources on a trim */
+    void setWindow(QQuickWindow *window);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    bool isEnabled() const { return m_timer.isActive(); }
+    bool isLowMemory() const { return m_lowMemory; }
+    int lastTrimLevel() const { return m_lastTrimLevel; }
+    double trackedBytes() const;
+    double residentBytes() const { return m_residentBytes; }
+
+#ifdef Q_OS_ANDROID
+    /** @brief Register QtActivityEx's natives, from JNI_OnLoad */
+    static void registerNatives(JNIEnv *env);
+#endif
+
+public slots:
+    void setEnabled(bool enabled);
+    void setLowMemory(bool lowMemory);
+    /** @brief Android's onTrimMemory level. Run on the UI thread, the activity posts it there */
+    void trimMemory(int level);
+    void sample();
+
+signals:
+    void enabledChanged(bool enabled);
+    void lowMemoryChanged(bool lowMemory);
+    void trimmed(int level);
+    void sampled();
+
+private slots:
+    void endLowMemory() { setLowMemory(false); }
+
+private:
+    MemoryBudget();
+    void releaseCaches();
+    static qint64 readResidentBytes();
+
+    QList<QPointer<GStreamerPlayer> > m_players;
+    HudImageProvider *m_imageProvider;
+    QPointer<QQuickWindow> m_window;
+    QTimer m_timer;
+    QTimer m_holdTimer;
+    qint64 m_bytes[SubsystemCount];
+    qint64 m_peakBytes[SubsystemCount];
+    double m_residentBytes;
+    bool m_lowMemory;
+    int m_lastTrimLevel;
+    QVector<int> m_savedRingSizes;  ///< Snapshot ring of each player before low memory, 0 without one
+};
+
+#endif // MEMORYBUDGET_H
@@ -0,0 +1,327 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MetricsExporter
+ *          See MetricsExporter.h
+ *
+ */
+
+#include "MetricsExporter.h"
+#include "LinkManager1.h"
+#include "UASInterface1.h"
+#include "UASManager1.h"
+#include "SettingsStore.h"
+#include "QsLog.h"
+#include <QMetaProperty>
+#include <qmath.h>
+
+static const char *SettingsGroup = "METRICS_EXPORT";
+
+MetricsExporter::MetricsExporter(QObject *parent) :
+    QObject(parent),
+    m_port(DefaultPort),
+    m_prefix("qmlplayer"),
+    m_lookup(-1),
+    m_sentPackets(0)
+{
+    m_sampleTimer.setInterval(SampleMs);
+    m_exportTimer.setInterval(ExportMs);
+    connect(&m_sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    connect(&m_exportTimer, SIGNAL(timeout()), this, SLOT(send()));
+
+    StoredSettings settings;
+    settings.beginGroup(SettingsGroup);
+    m_host = settings.value("HOST").toString();
+    m_port = settings.value("PORT", m_port).toInt();
+    m_prefix = settings.value("PREFIX", m_prefix).toString();
+    bool enabled = settings.value("ENABLED", false).toBool();
+    settings.endGroup();
+
+    lookUp();
+    setEnabled(enabled);
+}
+
+void MetricsExporter::addSource(const QString &name, QObject *object)
+{
+    Source source;
+    source.name = metricName(name);
+    source.object = object;
+    m_sources.append(source);
+}
+
+void MetricsExporter::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled())
+    {
+        return;
+    }
+    if (enabled)
+    {
+        m_aggregates.clear();
+        m_sampleTimer.start();
+        m_exportTimer.start();
+    }
+    else
+    {
+        m_sampleTimer.stop();
+        m_exportTimer.stop();
+    }
+    saveSettings();
+    emit enabledChanged(enabled);
+}
+
+void MetricsExporter::setHost(const QString &host)
+{
+    if (host.trimmed() == m_host)
+    {
+        return;
+    }
+    m_host = host.trimmed();
+    lookUp();
+    saveSettings();
+    emit collectorChanged();
+}
+
+void MetricsExporter::setPort(int port)
+{
+    if (port == m_port || port <= 0 || port > 65535)
+    {
+        return;
+    }
+    m_port = port;
+    saveSettings();
+    emit collectorChanged();
+}
+
+void MetricsExporter::setPrefix(const QString &prefix)
+{
+    if (prefix == m_prefix)
+    {
+        return;
+    }
+    m_prefix = prefix;
+    saveSettings();
+    emit collectorChanged();
+}
+
+void MetricsExporter::lookUp()
+{
+    if (m_lookup >= 0)
+    {
+        QHostInfo::abortHostLookup(m_lookup);
+        m_lookup = -1;
+    }
+    m_address = QHostAddress(m_host);
+    if (m_address.isNull() && !m_host.isEmpty())
+    {
+        // Never block the UI thread on DNS, samples are dropped until it answers
+        m_lookup = QHostInfo::lookupHost(m_host, this, SLOT(hostLookedUp(QHostInfo)));
+    }
+}
+
+void MetricsExporter::hostLookedUp(const QHostInfo &info)
+{
+    if (info.lookupId() != m_lookup)
+    {
+        return;
+    }
+    m_lookup = -1;
+    if (info.error() != QHostInfo::NoError || info.addresses().isEmpty())
+    {
+        QLOG_WARN() << "Metrics: could not look up" << m_host << info.errorString();
+        return;
+    }
+    m_address = info.addresses().first();
+}
+
+void MetricsExporter::saveSettings() const
+{
+    StoredSettings settings;
+    settings.beginGroup(SettingsGroup);
+    settings.setValue("ENABLED", isEnabled());
+    settings.setValue("HOST", m_host);
+    settings.setValue("PORT", m_port);
+    settings.setValue("PREFIX", m_prefix);
+    settings.endGroup();
+}
+
+QByteArray MetricsExporter::metricName(const QString &name)
+{
+    // statsd reserves ':' and '|', and dashboards split on '.'
+    QByteArray result = name.toLatin1();
+    for (int i = 0; i < result.size(); i++)
+    {
+        char c = result[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.'))
+        {
+            result[i] = '_';
+        }
+    }
+    return result;
+}
+
+void MetricsExporter::add(const QByteArray &name, double value)
+{
+    if (qIsNaN(value) || qIsInf(value))
+    {
+        return;
+    }
+    Aggregate &aggregate = m_aggregates[name];
+    aggregate.max = aggregate.count ? qMax(aggregate.max, value) : value;
+    aggregate.sum += value;
+    aggregate.count++;
+}
+
+void MetricsExporter::sample()
+{
+    foreach (const Source &source, m_sources)
+    {
+        sampleObject(source);
+    }
+    sampleLinks();
+}
+
+void MetricsExporter::sampleObject(const Source &source)
+{
+    QObject *object = source.object;
+    if (!object)
+    {
+        return;
+    }
+    const QMetaObject *meta = object->metaObject();
+    int enabled = meta->indexOfProperty("enabled");
+    if (enabled >= 0 && !meta->property(enabled).read(object).toBool())
+    {
+        return;
+    }
+    for (int i = QObject::staticMetaObject.propertyCount(); i < meta->propertyCount(); i++)
+    {
+        QMetaProperty property = meta->property(i);
+        if (i == enabled || !property.isReadable())
+        {
+            continue;
+        }
+        switch (property.userType())
+        {
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            add(source.name + '.' + property.name(), property.read(object).toDouble());
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void MetricsExporter::sampleLinks()
+{
+    LinkManager *links = LinkManager::instance();
+    foreach (int linkid, links->getLinks())
+    {
+        if (!links->getLinkConnected(linkid))
+        {
+            continue;
+        }
+        QByteArray name = "link." + QByteArray::number(linkid) + '.';
+        LinkIngestStats::Snapshot ingest = links->getLinkIngestStats(linkid);
+        add(name + "rx_bps", links->getLinkInDataRate(linkid));
+        add(name + "frames_s", ingest.framesPerSecond);
+        add(name + "errors_s", ingest.errorsPerSecond);
+        add(name + "crc_errors", ingest.crcErrors);
+        if (links->getLinkType(linkid) == LinkInterface::UDP_LINK)
+        {
+            add(name + "rx_overflows", links->getUdpReceiveOverflows(linkid));
+        }
+    }
+    // The worst component of each vehicle, as the HUD's link health shows it
+    foreach (UASInterface *uas, UASManager::instance()->getUASList())
+    {
+        float loss = 0;
+        foreach (float componentLoss, links->getComponentLoss(uas->getUASID()))
+        {
+            loss = qMax(loss, componentLoss);
+        }
+        add("vehicle." + QByteArray::number(uas->getUASID()) + ".loss_percent", loss);
+    }
+}
+
+static QByteArray formatValue(double value)
+{
+    if (value == qFloor(value) && qAbs(value) < 1e15)
+    {
+        return QByteArray::number(static_cast<qint64>(value));
+    }
+    return QByteArray::number(value, 'f', 2);
+}
+
+void MetricsExporter::send()
+{
+    QMap<QByteArray, Aggregate> aggregates;
+    aggregates.swap(m_aggregates);
+    if (m_address.isNull() || aggregates.isEmpty())
+    {
+        return;
+    }
+
+    QByteArray prefix = metricName(m_prefix);
+    if (!prefix.isEmpty())
+    {
+        prefix += '.';
+    }
+    QByteArray datagram;
+    datagram.reserve(MaxDatagram);
+    int packets = 0;
+    for (QMap<QByteArray, Aggregate>::const_iterator it = aggregates.constBegin(); it != aggregates.constEnd(); ++it)
+    {
+        const Aggregate &aggregate = it.value();
+        double mean = aggregate.sum / aggregate.count;
+        QByteArray lines = prefix + it.key() + ':' + formatValue(mean) + "|g\n";
+        if (aggregate.max != mean)
+        {
+            lines += prefix + it.key() + ".max:" + formatValue(aggregate.max) + "|g\n";
+        }
+        if (!datagram.isEmpty() && datagram.size() + lines.size() > MaxDatagram)
+        {
+            // statsd takes one metric per line, the last newline is optional
+            datagram.chop(1);
+            m_socket.writeDatagram(datagram, m_address, m_port);
+            packets++;
+            datagram.resize(0);
+        }
+        datagram += lines;
+    }
+    if (!datagram.isEmpty())
+    {
+        datagram.chop(1);
+        m_socket.writeDatagram(datagram, m_address, m_port);
+        packets++;
+    }
+    m_sentPackets += packets;
+    emit exported();
+}
@@ -0,0 +1,136 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Internal metrics sent to a fleet collector
+ *
+ */
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QTimer>
+#include <QUdpSocket>
+
+/**
+ * @brief Link, ingest, HUD, video, memory and thermal figures as statsd gauges
+ *
+ * Every SampleMs the numeric properties of each source and the rates of
+ * each link are read and folded into a running mean and maximum. Every
+ * ExportMs the aggregates go to the collector as statsd gauges,
+ *
+ *     <prefix>.<source>.<property>:<mean>|g
+ *     <prefix>.<source>.<property>.max:<max>|g
+ *
+ * the second line only when the maximum differs from the mean, packed
+ * into datagrams of at most MaxDatagram bytes. A collector that is down
+ * costs nothing but the datagrams; nothing is queued or resent.
+ *
+ * A source with a false "enabled" property is not sampled, its figures
+ * would be stale. Host, port and prefix are kept in the settings.
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString host READ host WRITE setHost NOTIFY collectorChanged)
+    Q_PROPERTY(int port READ port WRITE setPort NOTIFY collectorChanged)
+    Q_PROPERTY(QString prefix READ prefix WRITE setPrefix NOTIFY collectorChanged)
+    Q_PROPERTY(int sentPackets READ sentPackets NOTIFY exported)
+public:
+    enum {
+        SampleMs = 1000,
+        ExportMs = 10000,
+        MaxDatagram = 1400,     ///< Below the usual path MTU, no fragments
+        DefaultPort = 8125      ///< statsd
+    };
+
+    explicit MetricsExporter(QObject *parent = 0);
+
+    /** @brief Reports the numeric properties of object as <name>.<property> */
+    void addSource(const QString &name, QObject *object);
+
+    bool isEnabled() const { return m_sampleTimer.isActive(); }
+    QString host() const { return m_host; }
+    int port() const { return m_port; }
+    QString prefix() const { return m_prefix; }
+    int sentPackets() const { return m_sentPackets; }
+
+public slots:
+    void setEnabled(bool enabled);
+    void setHost(const QString &host);
+    void setPort(int port);
+    void setPrefix(const QString &prefix);
+    void sample();
+    void send();
+
+signals:
+    void enabledChanged(bool enabled);
+    void collectorChanged();
+    void exported();
+
+private slots:
+    void hostLookedUp(const QHostInfo &info);
+
+private:
+    struct Aggregate
+    {
+        double sum;
+        double max;
+        int count;
+        Aggregate() : sum(0), max(0), count(0) { }
+    };
+    struct Source
+    {
+        QByteArray name;
+        QPointer<QObject> object;
+    };
+
+    void add(const QByteArray &name, double value);
+    void sampleObject(const Source &source);
+    void sampleLinks();
+    void lookUp();
+    void saveSettings() const;
+    static QByteArray metricName(const QString &name);
+
+    QList<Source> m_sources;
+    QMap<QByteArray, Aggregate> m_aggregates;
+    QTimer m_sampleTimer;
+    QTimer m_exportTimer;
+    QUdpSocket m_socket;
+    QHostAddress m_address;     ///< Null until the host is looked up
+    QString m_host;
+    int m_port;
+    QString m_prefix;
+    int m_lookup;
+    int m_sentPackets;
+};
+
+#endif // METRICSEXPORTER_H
@@ -31,13 +31,66 @@ This file is part of the APM_PLANNER project
 #include <QStandardPaths>
 #include <QDesktopServices>
 #include <QGst/Quick/VideoItem>
+#include <QGlib/Connect>
 #include <QtAndroidExtras/QAndroidJniObject>
 #include "LinkManager1.h"
 #include "UASManager1.h"
+#include "MAVLinkStreamModel.h"
+#include "MAVLinkMessageCache.h"
+#include "SwarmModel.h"
+#include "TelemetryHistory.h"
+#include "TrackHistory.h"
+#include "TerrainCache.h"
+#include "VehicleStateSnapshot.h"
+#include "FramePacer.h"
+#include "HudImageProvider.h"
+#include "MemoryBudget.h"
+#include "MAVLinkLatencyTracer.h"
+#include "EventLoopMonitor.h"
+#include "QmlSettings.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkDecoder1.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkFanout.h"
+#include "StateWebSocketServer.h"
+#include "SettingsStore.h"
+#include "UASInterface1.h"
+#include "UAS1.h"
+#include "QsLogLimit.h"
+#include "StartupProfiler.h"
+#include "GStreamerRegistryCache.h"
+#include "GStreamerFramePacer.h"
+#include "FlightReview.h"
+#include "HudBurnInRecorder.h"
+#include "DegradationController.h"
+#include "MetricsExporter.h"
+#include "TelemetryCache.h"
+#include "TelemetryExporter.h"
+#include "ThreadRoles.h"
 
 #define ToRad(x) (x*0.01745329252)      // *pi/180
 #define ToDeg(x) (x*57.2957795131)      // *180/pi
 
+// Seconds without lost frames before a degraded stream gets one level back
+static const int DecodeRecoverSamples = 5;
+// A vehicle repeating STATUSTEXT, or a link flapping, must not flood the log
+static QsLogging::LogModule statusTextLog("STATUSTEXT", 2, 10);
+static QsLogging::LogModule messageBoxLog("MESSAGEBOX", 1, 5);
+
+static bool allowLog(QsLogging::LogModule &module)
+{
+    if (!module.allow())
+    {
+        return false;
+    }
+    int suppressed = module.takeSuppressed();
+    if (suppressed)
+    {
+        qCritical() << module.name() << "rate limited," << suppressed << "messages suppressed";
+    }
+    return true;
+}
+
 // Callback to update the custom plugin
 void* update_node(void* surface,  void* node, qreal x, qreal y, qreal w, qreal h);
 
@@ -48,11 +101,37 @@ PrimaryFlightDisplayQML::PrimaryFlightDisplayQML(QObject *parent) :
     m_player(NULL),
     m_showToolAction(NULL),
     m_surface(NULL),
+    m_secondaryPlayer(NULL),
+    m_secondarySurface(NULL),
+    m_cleanSamples(0),
+    m_relPosition(NULL),
+    m_absPosition(NULL),
+    m_alignTelemetry(false),
+    m_telemetryOffsetMs(0),
+    m_telemetryDelayMs(0),
+    m_alignedRoll(0),
+    m_alignedPitch(0),
+    m_alignedYaw(0),
+    m_telemetryInRate(0),
+    m_telemetryLoss(0),
+    m_rateController(NULL),
+    m_performance(NULL),
+    m_activeVehicle(NULL),
+    m_parameterModel(NULL),
+    m_vibration(NULL),
+    m_statusTexts(NULL),
+    m_review(NULL),
+    m_hudRecorder(NULL),
+    m_degradation(NULL),
+    m_metrics(NULL),
     m_currentState(NULL),
     m_enableGStreamer(true),
     m_videoEnabled(true),
-    m_uasConnected(false)
+    m_uasConnected(false),
+    m_startupPhase(StartupHud),
+    m_waitingForVideoFrame(false)
 {
+    m_startupTimer.start();
 
     m_enableVideoTimer.setSingleShot(true);
     connect(&m_enableVideoTimer, SIGNAL(timeout()), this, SLOT(onVideoEnabledTimer()));
@@ -63,10 +142,75 @@ PrimaryFlightDisplayQML::PrimaryFlightDisplayQML(QObject *parent) :
     m_player = new GStreamerPlayer(m_declarativeView);
     m_player->setVideoSink(m_surface->videoSink());
 
+    m_secondarySurface = new QGst::Quick::VideoSurface;
+    m_secondaryPlayer = new GStreamerPlayer(m_declarativeView);
+    m_secondaryPlayer->setVideoSink(m_secondarySurface->videoSink());
+    m_secondaryPlayer->setDecodePriority(1);
+    GStreamerFramePacer::watchWindow(m_declarativeView);
+
+    m_players << m_player << m_secondaryPlayer;
+    m_rateController = new VideoRateController(m_player, this);
+    m_performance = new HudPerformanceMonitor(this);
+    m_activeVehicle = new ActiveVehicle(this);
+    m_parameterModel = new ParameterListModel(this);
+    m_vibration = new VibrationAnalyzer(this);
+    m_statusTexts = new StatusTextModel(this);
+    m_review = new FlightReview(this, this);
+    connect(m_review, SIGNAL(messageBox(QString)), this, SLOT(messageBox(QString)));
+    m_hudRecorder = new HudBurnInRecorder(m_declarativeView, this);
+    connect(m_hudRecorder, SIGNAL(messageBox(QString)), this, SLOT(messageBox(QString)));
+    m_degradation = new DegradationController(m_players, this);
+    m_metrics = new MetricsExporter(this);
+    m_metrics->addSource("hud", m_performance);
+    m_metrics->addSource("frame", FramePacer::instance());
+    m_metrics->addSource("video", m_player->getStats());
+    m_metrics->addSource("video2", m_secondaryPlayer->getStats());
+    m_metrics->addSource("memory", MemoryBudget::instance());
+    m_metrics->addSource("degradation", m_degradation);
+
+    // "update" is emitted on the UI thread for every frame the main sink receives
+    QGlib::connect(m_surface->videoSink(), "update", this, &PrimaryFlightDisplayQML::onVideoFrame);
+    connect(&m_decodeBalanceTimer, SIGNAL(timeout()), this, SLOT(balanceDecodeLoad()));
+    connect(m_player->getStats(), SIGNAL(statsChanged()), this, SLOT(updateLinkHealth()));
+    m_decodeBalanceTimer.start(1000);
+
     m_declarativeView->setResizeMode(QQuickView::SizeRootObjectToView);
+    // image://hud/ sources, rasterized once and shared through the atlas
+    HudImageProvider *imageProvider = new HudImageProvider;
+    m_declarativeView->engine()->addImageProvider(QLatin1String("hud"), imageProvider);
+    // Overview properties notify QML once per frame instead of once per message
+    FramePacer::instance()->attach(m_declarativeView);
+    m_performance->attach(m_declarativeView);
+    MAVLinkLatencyTracer::instance()->attach(m_declarativeView);
+    // Counted while the overlay shows, trimmed when Android is short of memory
+    MemoryBudget::instance()->setPlayers(m_players);
+    MemoryBudget::instance()->setImageProvider(imageProvider);
+    MemoryBudget::instance()->setWindow(m_declarativeView);
+    connect(m_performance, SIGNAL(enabledChanged(bool)), MemoryBudget::instance(), SLOT(setEnabled(bool)));
+    // Telemetry work that lands on the UI thread is timed against the frame budget
+    EventLoopMonitor *eventLoop = EventLoopMonitor::instance();
+    eventLoop->watchClass(&LinkManager::staticMetaObject);
+    eventLoop->watchClass(&MAVLinkProtocol::staticMetaObject);
+    eventLoop->watchClass(&MAVLinkIngest::staticMetaObject);
+    eventLoop->watchClass(&MAVLinkDecoder::staticMetaObject);
+    eventLoop->watchClass(&UASManager::staticMetaObject);
+    eventLoop->watchClass(&UASInterface::staticMetaObject);
+    eventLoop->watchClass(&FramePacer::staticMetaObject);
+    eventLoop->watchThread(SettingsStore::instance());
+    eventLoop->watchThread(LinkManager::instance()->getMavlinkProtocol()->fanout());
+    eventLoop->watchThread(LinkManager::instance()->getMavlinkProtocol()->stateServer());
+    eventLoop->attach(m_declarativeView);
+    connect(m_performance, SIGNAL(enabledChanged(bool)), eventLoop, SLOT(setEnabled(bool)));
+    // The UI and render threads take their roles here, the rest where they start
+    ThreadRoles::instance()->attach(m_declarativeView);
+    connect(m_performance, SIGNAL(enabledChanged(bool)), ThreadRoles::instance(), SLOT(setEnabled(bool)));
 
     connect(m_player, SIGNAL(messageBox(QString)), this,
             SLOT(messageBox(QString)), Qt::UniqueConnection);
+    connect(m_player, SIGNAL(pipelineSwitched(QString)), this,
+            SLOT(onPipelineSwitched(QString)), Qt::UniqueConnection);
+    connect(m_secondaryPlayer, SIGNAL(messageBox(QString)), this,
+            SLOT(messageBox(QString)), Qt::UniqueConnection);
 
     // Default to video display until user selects
     InitializeDisplayWithVideo();
@@ -79,6 +223,15 @@ PrimaryFlightDisplayQML::PrimaryFlightDisplayQML(QObject *parent) :
 
 PrimaryFlightDisplayQML::~PrimaryFlightDisplayQML()
 {
+    m_decodeBalanceTimer.stop();
+    m_players.clear();
+    // The engine deletes the image provider
+    MemoryBudget::instance()->setImageProvider(NULL);
+    MemoryBudget::instance()->setPlayers(m_players);
+
+    delete m_secondaryPlayer;
+    m_secondaryPlayer = NULL;
+
     delete m_player;
     m_player = NULL;
 
@@ -92,13 +245,17 @@ PrimaryFlightDisplayQML::~PrimaryFlightDisplayQML()
 void PrimaryFlightDisplayQML::setActiveUAS(UASInterface *uas)
 {
     if (m_uasInterface) {
-        disconnect(uas,SIGNAL(textMessageReceived(int,int,int,QString)),
+        disconnect(m_uasInterface,SIGNAL(textMessageReceived(int,int,int,QString)),
                 this,SLOT(uasTextMessage(int,int,int,QString)));
 
-        disconnect(uas, SIGNAL(navModeChanged(int, int, QString)),
+        disconnect(m_uasInterface, SIGNAL(navModeChanged(int, int, QString)),
                    this, SLOT(updateNavMode(int, int, QString)));
 
     }
+    if (uas != m_uasInterface)
+    {
+        m_statusTexts->clear();
+    }
     m_uasInterface = uas;
 
     if (m_uasInterface) {
@@ -107,24 +264,31 @@ void PrimaryFlightDisplayQML::setActiveUAS(UASInterface *uas)
         connect(uas, SIGNAL(navModeChanged(int, int, QString)),
                 this, SLOT(updateNavMode(int, int, QString)));
 
-        VehicleOverview *obj = LinkManager::instance()->getUasObject(uas->getUASID())->getVehicleOverview();
-        RelPositionOverview *rel = LinkManager::instance()->getUasObject(uas->getUASID())->getRelPositionOverview();
-        AbsPositionOverview *abs = LinkManager::instance()->getUasObject(uas->getUASID())->getAbsPositionOverview();
-        if (m_declarativeView)
-        {
-            m_declarativeView->rootContext()->setContextProperty("vehicleoverview",obj);
-            m_declarativeView->rootContext()->setContextProperty("relpositionoverview",rel);
-            m_declarativeView->rootContext()->setContextProperty("abspositionoverview",abs);
-            QMetaObject::invokeMethod(m_declarativeView->rootObject(),"activeUasSet");
-        }
+        UASObject *object = LinkManager::instance()->getUasObject(uas->getUASID());
+        RelPositionOverview *rel = object->getRelPositionOverview();
+        AbsPositionOverview *abs = object->getAbsPositionOverview();
+        m_relPosition = rel;
+        m_absPosition = abs;
+        m_performance->setSources(rel, abs);
+        m_rateController->setUas(uas);
+        // The bindings read through activeVehicle, only those re-evaluate
+        UAS *mav = qobject_cast<UAS*>(uas);
+        m_activeVehicle->setSource(object, uas->getUASID(), mav ? mav->getLogDownload() : 0);
+        m_parameterModel->setUas(uas);
+        m_vibration->setUas(uas);
+        LinkManager::instance()->getMavlinkProtocol()->terrain()->setSysid(uas->getUASID());
     }
 }
 
 void PrimaryFlightDisplayQML::uasTextMessage(int uasid, int componentid, int severity, QString text)
 {
     Q_UNUSED(uasid);
-    Q_UNUSED(componentid);
-    if (text.contains("PreArm") || severity == 3)
+    // A repeat only bumps the count of its row, no banner and no log line
+    if (!m_statusTexts->add(componentid, severity, text))
+    {
+        return;
+    }
+    if (text.contains("PreArm") || severity <= MAV_SEVERITY_ERROR)
     {
         if (m_declarativeView)
         {
@@ -133,7 +297,10 @@ void PrimaryFlightDisplayQML::uasTextMessage(int uasid, int componentid, int sev
             root->setProperty("showStatusMessage", true);
         }
     }
-    qCritical() << text;
+    if (allowLog(statusTextLog))
+    {
+        qCritical() << text;
+    }
 }
 
 void PrimaryFlightDisplayQML::messageBox(QString text)
@@ -145,7 +312,10 @@ void PrimaryFlightDisplayQML::messageBox(QString text)
         root->setProperty("showMessageBox", true);
     }
 
-    qCritical() << text;
+    if (allowLog(messageBoxLog))
+    {
+        qCritical() << text;
+    }
 }
 
 void PrimaryFlightDisplayQML::updateNavMode(int uasid, int mode, const QString& text)
@@ -162,24 +332,129 @@ void PrimaryFlightDisplayQML::updateNavMode(int uasid, int mode, const QString&
 void PrimaryFlightDisplayQML::InitializeDisplayWithVideo()
 {
     QUrl url = QUrl(QLatin1String("assets:/qml/PrimaryFlightDisplayWithVideoQML.qml"));
-    m_declarativeView->engine()->clearComponentCache();
+    // Only a reload needs the cache dropped, the first load has nothing cached
+    if (!m_declarativeView->source().isEmpty())
+    {
+        m_declarativeView->engine()->clearComponentCache();
+    }
     m_declarativeView->rootContext()->setContextProperty(QLatin1String("videoSurface1"), m_surface);
     m_declarativeView->rootContext()->setContextProperty(QLatin1String("player"), m_player);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("videoSurface2"), m_secondarySurface);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("player2"), m_secondaryPlayer);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("videoRate"), m_rateController);
     m_declarativeView->rootContext()->setContextProperty(QLatin1String("container"), this);
     m_declarativeView->rootContext()->setContextProperty(QLatin1String("currentState"), m_currentState);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("mavlinkStreams"),
+                                                         LinkManager::instance()->getMavlinkProtocol()->streamModel());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("mavlinkMessages"),
+                                                         LinkManager::instance()->getMavlinkProtocol()->messageCache());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("mavlinkFields"),
+                                                         LinkManager::instance()->getMavlinkDecoder());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("framePacer"), FramePacer::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("hudPerformance"), m_performance);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("swarm"),
+                                                         LinkManager::instance()->getSwarmModel());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("telemetryHistory"),
+                                                         LinkManager::instance()->getMavlinkProtocol()->history());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("trackHistory"),
+                                                         LinkManager::instance()->getMavlinkProtocol()->track());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("terrain"),
+                                                         LinkManager::instance()->getMavlinkProtocol()->terrain());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("startupProfiler"), StartupProfiler::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("memoryBudget"), MemoryBudget::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("eventLoopMonitor"), EventLoopMonitor::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("qmlSettings"), QmlSettings::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("telemetryCache"), TelemetryCacheBuilder::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("telemetryExporter"), TelemetryExporter::instance());
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("activeVehicle"), m_activeVehicle);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("parameters"), m_parameterModel);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("vibration"), m_vibration);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("statusTexts"), m_statusTexts);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("review"), m_review);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("hudRecorder"), m_hudRecorder);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("degradation"), m_degradation);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("metricsExporter"), m_metrics);
+    m_declarativeView->rootContext()->setContextProperty(QLatin1String("threadRoles"), ThreadRoles::instance());
+    // The instruments come up on their own, video and the extra panels follow the first frame
+    setStartupPhase(StartupHud);
+    StartupProfiler::instance()->begin("hud");
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    StartupProfiler::instance()->begin("qml load");
     m_declarativeView->setSource(url);
+    StartupProfiler::instance()->end("qml load");
+    qCritical() << "PFD QML loaded in" << loadTimer.elapsed() << "ms," << m_startupTimer.elapsed() << "ms after start";
+    setActiveUAS(UASManager::instance()->getActiveUAS());
+    connect(m_declarativeView, SIGNAL(frameSwapped()), this, SLOT(firstFrameSwapped()), Qt::UniqueConnection);
     m_declarativeView->show();
+}
+
+void PrimaryFlightDisplayQML::startVideo()
+{
+    StartupProfiler::instance()->begin("video");
+    // Wire up video surfaces manually, the second one is loaded on demand
+    wireVideoItem("video", m_surface);
+    wireSecondaryVideo();
+
+    // Going to PLAYING is asynchronous, the stage ends with the first decoded frame
+    m_waitingForVideoFrame = true;
+    m_player->play();
+    if (!m_secondaryPipelineString.isEmpty()) m_secondaryPlayer->play();
+    setStartupPhase(StartupVideo);
+    qCritical() << "Showing Video," << m_startupTimer.elapsed() << "ms after start";
+
+    // Next pass of the event loop, so the pipeline's own work goes first
+    QTimer::singleShot(0, this, SLOT(loadSecondaryPanels()));
+}
 
-    // Wire up video surface manually
+void PrimaryFlightDisplayQML::loadSecondaryPanels()
+{
+    StartupProfiler::instance()->begin("panels");
+    setStartupPhase(StartupPanels);
+}
+
+void PrimaryFlightDisplayQML::secondaryPanelsLoaded()
+{
+    StartupProfiler::instance()->end("panels");
+    qCritical() << "Secondary panels loaded" << m_startupTimer.elapsed() << "ms after start";
+}
+
+void PrimaryFlightDisplayQML::setStartupPhase(int phase)
+{
+    if (m_startupPhase == phase) return;
+    m_startupPhase = phase; emit startupPhaseChanged();
+}
+
+void PrimaryFlightDisplayQML::wireSecondaryVideo()
+{
     QQuickItem *item = m_declarativeView->rootObject();
-    QQuickItem *videoObj = item->findChild<QQuickItem*>("video");
+    if (item && item->findChild<QQuickItem*>(QLatin1String("video2")))
+    {
+        wireVideoItem("video2", m_secondarySurface);
+    }
+}
+
+void PrimaryFlightDisplayQML::firstFrameSwapped()
+{
+    disconnect(m_declarativeView, SIGNAL(frameSwapped()), this, SLOT(firstFrameSwapped()));
+    qCritical() << "First HUD frame" << m_startupTimer.elapsed() << "ms after start";
+    StartupProfiler::instance()->end("hud");
+    StartupProfiler::instance()->interactive();
+    // Lets this frame's swap finish before the pipelines take the CPU
+    QTimer::singleShot(0, this, SLOT(startVideo()));
+}
+
+void PrimaryFlightDisplayQML::wireVideoItem(const QString & objectName, QGst::Quick::VideoSurface *surface)
+{
+    QQuickItem *item = m_declarativeView->rootObject();
+    QQuickItem *videoObj = item ? item->findChild<QQuickItem*>(objectName) : NULL;
     if (videoObj)
     {
-        qCritical() << "Initializing Video Object in QML";
+        qCritical() << "Initializing Video Object" << objectName << "in QML";
         QGst::Quick::VideoItem *pItem = dynamic_cast<QGst::Quick::VideoItem*>(videoObj);
         if (pItem)
         {
-            pItem->setSurface(m_surface);
+            pItem->setSurface(surface);
             pItem->setUpdateNodeCallback(&update_node);
         }
         else
@@ -189,18 +464,143 @@ void PrimaryFlightDisplayQML::InitializeDisplayWithVideo()
     }
     else
     {
-         qCritical() << "Failed to find video object in QML!";
+         qCritical() << "Failed to find video object" << objectName << "in QML!";
     }
-
-    m_player->play();
-    setActiveUAS(UASManager::instance()->getActiveUAS());
-    qCritical() << "Showing Video";
 }
 
 void PrimaryFlightDisplayQML::enableVideo(bool enabled)
 {
-    if (enabled) m_player->play();
-    else m_player->stop();
+    // Hidden players keep their stream unless the hidden mode is HiddenStop
+    m_player->setHidden(!enabled);
+
+    if (!m_secondaryPipelineString.isEmpty()) m_secondaryPlayer->setHidden(!enabled);
+    else m_secondaryPlayer->stop();
+}
+
+void PrimaryFlightDisplayQML::setAlignTelemetry(bool value)
+{
+    if (m_alignTelemetry == value) return;
+    m_alignTelemetry = value; emit alignTelemetryChanged();
+}
+
+void PrimaryFlightDisplayQML::setTelemetryOffsetMs(int value)
+{
+    if (m_telemetryOffsetMs == value) return;
+    m_telemetryOffsetMs = value; emit telemetryOffsetMsChanged();
+}
+
+void PrimaryFlightDisplayQML::onVideoFrame()
+{
+    if (m_waitingForVideoFrame)
+    {
+        m_waitingForVideoFrame = false;
+        StartupProfiler::instance()->end("video");
+    }
+    if (!m_relPosition) return;
+
+    GStreamerRecorder *recorder = static_cast<GStreamerRecorder*>(m_player->getRecorder());
+    if (recorder->isRecording() && m_absPosition)
+    {
+        GStreamerRecorder::Telemetry telemetry;
+        telemetry.timeBootMs = m_relPosition->getTimeBootMs();
+        telemetry.lat = m_absPosition->getLat() / 1e7;
+        telemetry.lon = m_absPosition->getLon() / 1e7;
+        telemetry.alt = m_absPosition->getAlt() / 1000.0;
+        telemetry.relativeAlt = m_absPosition->getRelativeAlt() / 1000.0;
+        telemetry.roll = m_relPosition->getRoll();
+        telemetry.pitch = m_relPosition->getPitch();
+        telemetry.yaw = m_relPosition->getYaw();
+        telemetry.heading = m_relPosition->getHeading();
+        telemetry.groundspeed = m_relPosition->getGroundspeed();
+        recorder->setTelemetry(telemetry);
+    }
+
+    if (!m_alignTelemetry) return;
+
+    // The frame on screen left the camera roughly the pipeline latency (plus
+    // whatever the offset accounts for) ago, draw the attitude of that moment
+    GStreamerStats *stats = static_cast<GStreamerStats*>(m_player->getStats());
+    m_telemetryDelayMs = qMax(0, stats->getLatencyMs() + m_telemetryOffsetMs);
+
+    AttitudeHistory::Sample sample;
+    if (m_relPosition->attitudeHistory().sampleAt(AttitudeHistory::now() - m_telemetryDelayMs, sample))
+    {
+        m_alignedRoll = sample.roll;
+        m_alignedPitch = sample.pitch;
+        m_alignedYaw = sample.yaw;
+        m_alignedHorizon = AttitudeMatrix::horizon(AttitudeMatrix::fromEuler(sample.roll * M_PI / 180.0,
+                                                                             sample.pitch * M_PI / 180.0,
+                                                                             sample.yaw * M_PI / 180.0));
+        emit alignedAttitudeChanged();
+    }
+}
+
+void PrimaryFlightDisplayQML::updateLinkHealth()
+{
+    // Sampled with the video stats so both sides of the link read from the same second
+    qint64 rate = 0;
+    foreach (int linkid, LinkManager::instance()->getLinks())
+    {
+        rate += LinkManager::instance()->getLinkInDataRate(linkid);
+    }
+    // The worst component of the active vehicle, the autopilot and a camera can fare differently
+    float loss = 0;
+    if (m_uasInterface)
+    {
+        foreach (float componentLoss, LinkManager::instance()->getComponentLoss(m_uasInterface->getUASID()))
+        {
+            loss = qMax(loss, componentLoss);
+        }
+    }
+    if (rate != m_telemetryInRate || loss != m_telemetryLoss)
+    {
+        m_telemetryInRate = (int)rate;
+        m_telemetryLoss = loss;
+        emit linkHealthChanged();
+    }
+    m_rateController->sample(m_telemetryInRate);
+}
+
+void PrimaryFlightDisplayQML::balanceDecodeLoad()
+{
+    // Any stream dropping frames (QoS or mailbox) means the device is saturated
+    bool saturated = false;
+    foreach (GStreamerPlayer *player, m_players)
+    {
+        GStreamerStats *stats = static_cast<GStreamerStats*>(player->getStats());
+        quint64 lost = stats->getDroppedFrames() + stats->getStaleFrames();
+        if (lost > m_lostFrames.value(player, lost)) saturated = true;
+        m_lostFrames[player] = lost;
+    }
+
+    if (saturated)
+    {
+        // Take work away from the least important stream first, never the primary one
+        m_cleanSamples = 0;
+        for (int i = m_players.size() - 1; i > 0; i--)
+        {
+            GStreamerPlayer *player = m_players[i];
+            if (player->getDegradeLevel() < GStreamerPlayer::DegradeHalfRate)
+            {
+                player->setDegradeLevel(player->getDegradeLevel() + 1);
+                qDebug() << "Decoding saturated, degrading stream" << i << "to level" << player->getDegradeLevel();
+                break;
+            }
+        }
+    }
+    else if (++m_cleanSamples >= DecodeRecoverSamples)
+    {
+        // Give it back to the most important degraded stream first
+        m_cleanSamples = 0;
+        foreach (GStreamerPlayer *player, m_players)
+        {
+            if (player->getDegradeLevel() > GStreamerPlayer::DegradeNone)
+            {
+                player->setDegradeLevel(player->getDegradeLevel() - 1);
+                break;
+            }
+        }
+    }
 }
 
 void PrimaryFlightDisplayQML::onVideoEnabledTimer()
@@ -212,6 +612,13 @@ void PrimaryFlightDisplayQML::onVideoEnabledTimer()
 void PrimaryFlightDisplayQML::setVideoEnabled(bool value) {
 
     this->m_videoEnabled = value;
+    // Only tearing down and rebuilding pipelines needs the debounce, the decode gate is cheap
+    if (m_player->getHiddenMode() != GStreamerPlayer::HiddenStop)
+    {
+        m_enableVideoTimer.stop();
+        onVideoEnabledTimer();
+        return;
+    }
     if (!m_enableVideoTimer.isActive())
     {
         m_enableVideoTimer.start(1000);
@@ -249,26 +656,39 @@ void PrimaryFlightDisplayQML::setOpenHelp(bool value)
 void PrimaryFlightDisplayQML::applicationStateChanged(Qt::ApplicationState state)
 {
     QString strState = "Unknown";
+    bool background = false;
     switch (state)
     {
         case Qt::ApplicationState::ApplicationSuspended:
             strState = "Suspended";
-            if (m_player) m_player->stop();
+            background = true;
+            if (m_player) m_player->suspend();
+            if (m_secondaryPlayer) m_secondaryPlayer->suspend();
             break;
         case Qt::ApplicationState::ApplicationHidden:
             strState = "Hidden";
-            if (m_player) m_player->stop();
+            background = true;
+            if (m_player) m_player->suspend();
+            if (m_secondaryPlayer) m_secondaryPlayer->suspend();
             break;
         case Qt::ApplicationState::ApplicationInactive:
             strState = "Inactive";
-            if (m_player) m_player->stop();
+            background = true;
+            if (m_player) m_player->suspend();
+            if (m_secondaryPlayer) m_secondaryPlayer->suspend();
             break;
         case Qt::ApplicationState::ApplicationActive:
             strState = "Active";
-            if (m_player) m_player->play();
+            if (m_player) m_player->resume();
+            if (m_secondaryPlayer && !m_secondaryPipelineString.isEmpty()) m_secondaryPlayer->resume();
             break;
     }
 
+    // Links and logging keep running, only alerts reach the UAS objects until the HUD is back
+    LinkManager::instance()->getMavlinkProtocol()->setBackground(background);
+    if (background) m_decodeBalanceTimer.stop();
+    else if (!m_decodeBalanceTimer.isActive()) m_decodeBalanceTimer.start(1000);
+
     qDebug() << "Application State Changed to " + strState;
 }
 
@@ -353,19 +773,30 @@ void PrimaryFlightDisplayQML::setUasConnected(bool value) {
                 iToken++;
                 break;
             }
+            if (isUDP)
+            {
+                // UDP:port:group shares a multicast stream with other displays
+                ipOrHost = token;
+                iToken++;
+                break;
+            }
             break;
         }
     }
 
     if (isTCP)
     {
-        QHostAddress addr(ipOrHost);
-        iLinkId = pLinkMgr->addTcpConnection(addr, iPort, false);
+        // A name is looked up as the link connects, not here
+        iLinkId = pLinkMgr->addTcpConnection(ipOrHost, iPort, false);
         m_connectionMap.insert(m_ipOrHost, iLinkId);
     }
     else if (isUDP)
     {
         iLinkId = pLinkMgr->addUdpConnection(QHostAddress::Any, iPort);
+        if (!ipOrHost.isEmpty())
+        {
+            pLinkMgr->setUdpMulticast(iLinkId, QHostAddress(ipOrHost));
+        }
         m_connectionMap.insert(m_ipOrHost, iLinkId);
     }
 
@@ -384,10 +815,33 @@ void PrimaryFlightDisplayQML::setPipelineString(QString pipelineString)
 { 
     m_pipelineString = pipelineString; emit pipelineStringChanged();
     if (m_player) m_player->setPipelineString(m_pipelineString);
+    GStreamerRegistryCache::remember(m_pipelineString);
 
     qDebug() << "GStreamer Pipeline String = " << m_pipelineString;
 }
 
+void PrimaryFlightDisplayQML::setSecondaryPipelineString(QString pipelineString)
+{
+    if (m_secondaryPipelineString == pipelineString) return;
+
+    m_secondaryPipelineString = pipelineString; emit secondaryPipelineStringChanged();
+    m_secondaryPlayer->setPipelineString(m_secondaryPipelineString);
+    GStreamerRegistryCache::remember(m_secondaryPipelineString);
+
+    if (m_secondaryPipelineString.isEmpty()) m_secondaryPlayer->stop();
+    // Before the video phase startVideo() plays it
+    else if (m_videoEnabled && m_startupPhase != StartupHud) m_secondaryPlayer->play();
+
+    qDebug() << "GStreamer Secondary Pipeline String = " << m_secondaryPipelineString;
+}
+
+void PrimaryFlightDisplayQML::onPipelineSwitched(QString pipelineString)
+{
+    // The player swapped to its standby pipeline, keep our copy in step
+    m_pipelineString = pipelineString; emit pipelineStringChanged();
+    qDebug() << "Switched to GStreamer Pipeline String = " << m_pipelineString;
+}
+
 void PrimaryFlightDisplayQML::setIpOrHost(QString ipOrHost)
 {
     m_ipOrHost = ipOrHost; emit ipOrHostChanged();
@@ -396,7 +850,9 @@ void PrimaryFlightDisplayQML::setIpOrHost(QString ipOrHost)
 
 void PrimaryFlightDisplayQML::SetCurrentState(CCurrentState &theState)
 {
-	// This method will update the bound state variables in the QML
+	// This method will update the bound state variables in the QML,
+	// signalled together once all of them are set
+	m_currentState->beginUpdate();
 	m_currentState->setRoll(theState.getRoll());
 	m_currentState->setPitch(theState.getPitch());
 	m_currentState->setYaw(theState.getYaw());
@@ -407,16 +863,31 @@ void PrimaryFlightDisplayQML::SetCurrentState(CCurrentState &theState)
 	m_currentState->setBatteryRemaining(theState.getBatteryRemaining());
 	m_currentState->setAltitude(theState.getAltitude());
 
-	m_currentState->setWatts(theState.getWatts());
 	m_currentState->setGpsstatus(theState.getGpsStatus());
 	m_currentState->setGpshdop(theState.getGpsHdop());
 	m_currentState->setSatcount(theState.getSatCount());
 	m_currentState->setWp_dist(theState.getWpDist());
 	m_currentState->setCh3percent(theState.getCh3Percent());
-	m_currentState->setTimeInAir(theState.getTimeInAir());
-	m_currentState->setDistToHome(theState.getDistToHome());
-	m_currentState->setDistTraveled(theState.getDistTravled());
-	m_currentState->setAZToMAV(theState.getAzToMav());
+
+	// The ingest thread keeps these up to date for a connected vehicle
+	VehicleState vehicle;
+	if (m_uasInterface && LinkManager::instance()->getMavlinkProtocol()->vehicleState(m_uasInterface->getUASID(), &vehicle)
+	        && (vehicle.sections & VehicleState::HasHome))
+	{
+		m_currentState->setWatts(vehicle.watts);
+		m_currentState->setTimeInAir(vehicle.timeInAir);
+		m_currentState->setDistToHome(vehicle.distToHome);
+		m_currentState->setDistTraveled(vehicle.distTraveled);
+		m_currentState->setAZToMAV(vehicle.azToMav);
+	}
+	else
+	{
+		m_currentState->setWatts(theState.getWatts());
+		m_currentState->setTimeInAir(theState.getTimeInAir());
+		m_currentState->setDistToHome(theState.getDistToHome());
+		m_currentState->setDistTraveled(theState.getDistTravled());
+		m_currentState->setAZToMAV(theState.getAzToMav());
+	}
 	
 	m_currentState->setLat(theState.getLat());
 	m_currentState->setLng(theState.getLng());
@@ -427,6 +898,7 @@ void PrimaryFlightDisplayQML::SetCurrentState(CCurrentState &theState)
 	m_currentState->setSpeedUnit(QString::fromWCharArray(theState.getSpeedUnit()));
 	m_currentState->setMessage(QString::fromWCharArray(theState.getMessage()));
 	m_currentState->setFlightMode(QString::fromWCharArray(theState.getFlightMode()));
+	m_currentState->endUpdate();
 
 }
 
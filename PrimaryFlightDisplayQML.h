@@ -28,9 +28,23 @@ This file is part of the APM_PLANNER project
 #include "CCurrentState.h"
 #include <QWidget>
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QtQuick/QQuickView>
 #include <QGst/Quick/VideoSurface>
 #include "GStreamerPlayer.h"
+#include "RelPositionOverview.h"
+#include "AbsPositionOverview.h"
+#include "VideoRateController.h"
+#include "HudPerformanceMonitor.h"
+#include "ActiveVehicle.h"
+#include "ParameterListModel.h"
+#include "VibrationAnalyzer.h"
+#include "StatusTextModel.h"
+
+class FlightReview;
+class HudBurnInRecorder;
+class DegradationController;
+class MetricsExporter;
 
 
 class PrimaryFlightDisplayQML : public QObject
@@ -49,15 +63,33 @@ private slots:
     void applicationStateChanged(Qt::ApplicationState state);
     void messageBox(QString text);
     void onVideoEnabledTimer();
+    void onPipelineSwitched(QString pipelineString);
+    void balanceDecodeLoad();
+    void updateLinkHealth();
+    void firstFrameSwapped();
+    void startVideo();
+    void loadSecondaryPanels();
 
 signals:
     void videoEnabledChanged();
     void pipelineStringChanged();
+    void secondaryPipelineStringChanged();
+    void alignTelemetryChanged();
+    void telemetryOffsetMsChanged();
+    void alignedAttitudeChanged();
+    void linkHealthChanged();
     void ipOrHostChanged();
     void uasConnectedChanged();
     void openHelpChanged();
+    void startupPhaseChanged();
 
 public:
+    /** @brief Order the display comes up in, each phase is a StartupProfiler stage */
+    enum StartupPhase {
+        StartupHud,         ///< Attitude, altitude and the other instruments on live telemetry
+        StartupVideo,       ///< Pipelines started, after the first HUD frame
+        StartupPanels       ///< Overlays and dialogs only used later, loaded asynchronously
+    };
 
     Q_PROPERTY(bool videoEnabled READ isVideoEnabled WRITE setVideoEnabled NOTIFY videoEnabledChanged)
     Q_PROPERTY(bool uasConnected READ isUasConnected WRITE setUasConnected NOTIFY uasConnectedChanged)
@@ -76,17 +108,63 @@ public:
 	void setPipelineString(QString pipelineString); 
 	QString getPipelineString() const { return m_pipelineString; }
 
+    /** @brief Second camera (e.g. thermal), shown picture-in-picture. Empty disables it */
+    Q_PROPERTY(QString secondaryPipelineString READ getSecondaryPipelineString WRITE setSecondaryPipelineString NOTIFY secondaryPipelineStringChanged)
+    void setSecondaryPipelineString(QString pipelineString);
+    QString getSecondaryPipelineString() const { return m_secondaryPipelineString; }
+
+    /** @brief Draw the attitude sampled when the displayed frame was captured, not the newest one */
+    Q_PROPERTY(bool alignTelemetry READ getAlignTelemetry WRITE setAlignTelemetry NOTIFY alignTelemetryChanged)
+    void setAlignTelemetry(bool value);
+    bool getAlignTelemetry() const { return m_alignTelemetry; }
+
+    /** @brief Camera/encoder/network delay not covered by the pipeline latency query */
+    Q_PROPERTY(int telemetryOffsetMs READ getTelemetryOffsetMs WRITE setTelemetryOffsetMs NOTIFY telemetryOffsetMsChanged)
+    void setTelemetryOffsetMs(int value);
+    int getTelemetryOffsetMs() const { return m_telemetryOffsetMs; }
+
+    Q_PROPERTY(int telemetryDelayMs READ getTelemetryDelayMs NOTIFY alignedAttitudeChanged)
+    Q_PROPERTY(double alignedRoll READ getAlignedRoll NOTIFY alignedAttitudeChanged)
+    Q_PROPERTY(double alignedPitch READ getAlignedPitch NOTIFY alignedAttitudeChanged)
+    Q_PROPERTY(double alignedYaw READ getAlignedYaw NOTIFY alignedAttitudeChanged)
+    /** @brief Artificial horizon transform of the aligned attitude, see AttitudeMatrix */
+    Q_PROPERTY(QMatrix4x4 alignedHorizon READ getAlignedHorizon NOTIFY alignedAttitudeChanged)
+    int getTelemetryDelayMs() const { return m_telemetryDelayMs; }
+    double getAlignedRoll() const { return m_alignedRoll; }
+    double getAlignedPitch() const { return m_alignedPitch; }
+    double getAlignedYaw() const { return m_alignedYaw; }
+    QMatrix4x4 getAlignedHorizon() const { return m_alignedHorizon; }
+
+    /** @brief Bytes per second received on all MAVLink links, shown next to the video stream stats */
+    Q_PROPERTY(int telemetryInRate READ getTelemetryInRate NOTIFY linkHealthChanged)
+    int getTelemetryInRate() const { return m_telemetryInRate; }
+    Q_PROPERTY(float telemetryLoss READ getTelemetryLoss NOTIFY linkHealthChanged)
+    float getTelemetryLoss() const { return m_telemetryLoss; }
+
+    /** @brief A StartupPhase, the QML activates its deferred Loaders from it */
+    Q_PROPERTY(int startupPhase READ getStartupPhase NOTIFY startupPhaseChanged)
+    int getStartupPhase() const { return m_startupPhase; }
+
     Q_PROPERTY(QString ipOrHost READ getIpOrHost WRITE setIpOrHost NOTIFY ipOrHostChanged)
     void setIpOrHost(QString ipOrHost);
     QString getIpOrHost() const { return m_ipOrHost; }
 
     GStreamerPlayer * player() { return m_player; }
+    GStreamerPlayer * secondaryPlayer() { return m_secondaryPlayer; }
+    QQuickView * view() { return m_declarativeView; }
 
     void InitializeDisplayWithVideo();
+    /** @brief Hand the second surface to "video2", called by its Loader once it exists */
+    Q_INVOKABLE void wireSecondaryVideo();
+    /** @brief Called by the deferred panels' Loader, ends the last startup phase */
+    Q_INVOKABLE void secondaryPanelsLoaded();
     void SetCurrentState(CCurrentState &theState);
     void setShowToolAction(QAction *action) { m_showToolAction = action; }
 
 private:
+    void wireVideoItem(const QString & objectName, QGst::Quick::VideoSurface *surface);
+    void onVideoFrame();
+    void setStartupPhase(int phase);
 
     QQuickView* m_declarativeView;
     UASInterface *m_uasInterface;
@@ -95,9 +173,44 @@ private:
     QString m_ipOrHost;
     QAction *m_showToolAction;
     QGst::Quick::VideoSurface *m_surface;
+
+    // Additional streams share the view, and so the scene graph GL context
+    GStreamerPlayer *m_secondaryPlayer;
+    QGst::Quick::VideoSurface *m_secondarySurface;
+    QString m_secondaryPipelineString;
+    QList<GStreamerPlayer*> m_players;              ///< All streams, in decodePriority order
+    QMap<GStreamerPlayer*, quint64> m_lostFrames;   ///< dropped + stale frames at the last balance
+    int m_cleanSamples;                             ///< Balance samples without any lost frame
+    QTimer m_decodeBalanceTimer;
+
+    // Telemetry aligned to the displayed frame
+    RelPositionOverview *m_relPosition;
+    AbsPositionOverview *m_absPosition;
+    bool m_alignTelemetry;
+    int m_telemetryOffsetMs;
+    int m_telemetryDelayMs;
+    double m_alignedRoll;
+    double m_alignedPitch;
+    double m_alignedYaw;
+    QMatrix4x4 m_alignedHorizon;
+    int m_telemetryInRate;
+    float m_telemetryLoss;
+    VideoRateController *m_rateController;
+    HudPerformanceMonitor *m_performance;
+    ActiveVehicle *m_activeVehicle;     ///< The one context property the overview bindings read through
+    ParameterListModel *m_parameterModel; ///< Searchable parameters of the active vehicle
+    VibrationAnalyzer *m_vibration;     ///< Accelerometer spectra of the active vehicle
+    StatusTextModel *m_statusTexts;     ///< De-duplicated STATUSTEXT messages of the active vehicle
+    FlightReview *m_review;             ///< Recorded video played back with its tlog
+    HudBurnInRecorder *m_hudRecorder;   ///< Recording of the window, HUD burnt in
+    DegradationController *m_degradation;   ///< Sheds load when the device runs hot
+    MetricsExporter *m_metrics;         ///< Aggregated figures for the fleet dashboard
     QCurrentState *m_currentState;
     QMap<QString,int> m_connectionMap;
     QTimer m_enableVideoTimer;
+    QElapsedTimer m_startupTimer;   ///< Since construction, reports the time to the first HUD frame
+    int m_startupPhase;
+    bool m_waitingForVideoFrame;    ///< Between play() and the first frame of the main sink
 
     bool m_enableGStreamer;
     bool m_videoEnabled;
@@ -0,0 +1,189 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ProximityGrid
+ *          See ProximityGrid.h
+ *
+ */
+
+#include "ProximityGrid.h"
+#include <cmath>
+#include <cstring>
+
+ProximityGrid::ProximityGrid(double cellSize) :
+    m_cellSize(cellSize > 0.0 ? cellSize : 50.0),
+    m_count(0)
+{
+    memset(m_entries, 0, sizeof(m_entries));
+}
+
+quint64 ProximityGrid::key(qint32 x, qint32 y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+quint64 ProximityGrid::cellOf(double east, double north) const
+{
+    return key(static_cast<qint32>(floor(east / m_cellSize)),
+               static_cast<qint32>(floor(north / m_cellSize)));
+}
+
+void ProximityGrid::setCellSize(double cellSize)
+{
+    if (cellSize <= 0.0 || cellSize == m_cellSize)
+    {
+        return;
+    }
+    m_cellSize = cellSize;
+    m_cells.clear();
+    for (int sysid = 0; sysid < MaxVehicles; ++sysid)
+    {
+        Entry &entry = m_entries[sysid];
+        if (entry.valid)
+        {
+            entry.cell = cellOf(entry.east, entry.north);
+            m_cells[entry.cell].append(static_cast<quint8>(sysid));
+        }
+    }
+}
+
+void ProximityGrid::unlink(int sysid, quint64 cell)
+{
+    QHash<quint64, Bucket>::iterator it = m_cells.find(cell);
+    if (it == m_cells.end())
+    {
+        return;
+    }
+    Bucket &bucket = it.value();
+    for (int i = 0; i < bucket.size(); ++i)
+    {
+        if (bucket[i] == sysid)
+        {
+            bucket[i] = bucket[bucket.size() - 1];
+            bucket.removeLast();
+            break;
+        }
+    }
+    if (bucket.isEmpty())
+    {
+        m_cells.erase(it);
+    }
+}
+
+void ProximityGrid::update(int sysid, double east, double north, double up)
+{
+    if (sysid < 0 || sysid >= MaxVehicles || std::isnan(east) || std::isnan(north))
+    {
+        return;
+    }
+    Entry &entry = m_entries[sysid];
+    const quint64 cell = cellOf(east, north);
+    if (!entry.valid)
+    {
+        entry.valid = true;
+        ++m_count;
+        m_cells[cell].append(static_cast<quint8>(sysid));
+    }
+    else if (entry.cell != cell)
+    {
+        unlink(sysid, entry.cell);
+        m_cells[cell].append(static_cast<quint8>(sysid));
+    }
+    entry.east = east;
+    entry.north = north;
+    entry.up = up;
+    entry.cell = cell;
+}
+
+void ProximityGrid::remove(int sysid)
+{
+    if (!contains(sysid))
+    {
+        return;
+    }
+    unlink(sysid, m_entries[sysid].cell);
+    m_entries[sysid].valid = false;
+    --m_count;
+}
+
+void ProximityGrid::clear()
+{
+    memset(m_entries, 0, sizeof(m_entries));
+    m_cells.clear();
+    m_count = 0;
+}
+
+bool ProximityGrid::contains(int sysid) const
+{
+    return sysid >= 0 && sysid < MaxVehicles && m_entries[sysid].valid;
+}
+
+void ProximityGrid::neighbours(int sysid, double radius, double maxVertical, Neighbours *result) const
+{
+    result->clear();
+    if (!contains(sysid) || radius <= 0.0)
+    {
+        return;
+    }
+    const Entry &self = m_entries[sysid];
+    const qint32 cx = static_cast<qint32>(floor(self.east / m_cellSize));
+    const qint32 cy = static_cast<qint32>(floor(self.north / m_cellSize));
+    const qint32 reach = static_cast<qint32>(ceil(radius / m_cellSize));
+    const double radius2 = radius * radius;
+
+    for (qint32 x = cx - reach; x <= cx + reach; ++x)
+    {
+        for (qint32 y = cy - reach; y <= cy + reach; ++y)
+        {
+            QHash<quint64, Bucket>::const_iterator it = m_cells.constFind(key(x, y));
+            if (it == m_cells.constEnd())
+            {
+                continue;
+            }
+            const Bucket &bucket = it.value();
+            for (int i = 0; i < bucket.size(); ++i)
+            {
+                const int other = bucket[i];
+                if (other == sysid)
+                {
+                    continue;
+                }
+                const Entry &entry = m_entries[other];
+                const double de = entry.east - self.east;
+                const double dn = entry.north - self.north;
+                const double dh2 = de * de + dn * dn;
+                const double dv = fabs(entry.up - self.up);
+                if (dh2 > radius2 || dv > maxVertical)
+                {
+                    continue;
+                }
+                Neighbour neighbour;
+                neighbour.sysid = other;
+                neighbour.horizontal = sqrt(dh2);
+                neighbour.vertical = dv;
+                result->append(neighbour);
+            }
+        }
+    }
+}
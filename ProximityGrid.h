@@ -0,0 +1,99 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ProximityGrid
+ *          Vehicle positions in the local east-north-up frame, bucketed in
+ *          a uniform grid of square cells so that finding the vehicles near
+ *          one only looks at the cells around it, not at every vehicle.
+ *          A position update moves the vehicle between buckets only when it
+ *          crosses a cell border. Heights are kept but not gridded, vertical
+ *          separation is checked on the few horizontal candidates.
+ *
+ */
+
+#ifndef PROXIMITYGRID_H
+#define PROXIMITYGRID_H
+
+#include <QHash>
+#include <QVarLengthArray>
+
+class ProximityGrid
+{
+public:
+    enum { MaxVehicles = 256 };
+
+    struct Neighbour
+    {
+        int sysid;
+        double horizontal;  ///< Meters
+        double vertical;    ///< Meters, absolute
+    };
+    typedef QVarLengthArray<Neighbour, 16> Neighbours;
+
+    /** @param cellSize edge of a cell, queries within this radius scan 3x3 cells */
+    explicit ProximityGrid(double cellSize = 50.0);
+
+    double cellSize() const { return m_cellSize; }
+    /** @brief Changes the cell size and rebuckets every vehicle */
+    void setCellSize(double cellSize);
+
+    void update(int sysid, double east, double north, double up);
+    void remove(int sysid);
+    /** @brief Forgets every position, e.g. once the frame origin moved */
+    void clear();
+
+    bool contains(int sysid) const;
+    int count() const { return m_count; }
+
+    /**
+     * @brief Every other vehicle within radius horizontally and maxVertical vertically
+     *
+     * The result is in no particular order. A sysid without a position has
+     * no neighbours.
+     */
+    void neighbours(int sysid, double radius, double maxVertical, Neighbours *result) const;
+
+private:
+    typedef QVarLengthArray<quint8, 4> Bucket;
+
+    struct Entry
+    {
+        double east;
+        double north;
+        double up;
+        quint64 cell;
+        bool valid;
+    };
+
+    quint64 cellOf(double east, double north) const;
+    static quint64 key(qint32 x, qint32 y);
+    void unlink(int sysid, quint64 cell);
+
+    double m_cellSize;
+    int m_count;
+    Entry m_entries[MaxVehicles];
+    QHash<quint64, Bucket> m_cells;
+};
+
+#endif // PROXIMITYGRID_H
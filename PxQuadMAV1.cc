@@ -21,6 +21,7 @@ This file is part of the QGROUNDCONTROL project
 ======================================================================*/
 
 #include "PxQuadMAV1.h"
+#include "MAVLinkDispatcher.h"
 #include "GAudioOutput.h"
 
 PxQuadMAV::PxQuadMAV(MAVLinkProtocol* mavlink, int id) :
@@ -28,78 +29,106 @@ PxQuadMAV::PxQuadMAV(MAVLinkProtocol* mavlink, int id) :
 {
 }
 
+// Only compile this portion if matching MAVLink packets have been compiled
+#ifdef MAVLINK_ENABLED_PIXHAWK
+// The Pixhawk messages on top of the ones UAS handles
+static const int pixhawkMessages[] = {
+    MAVLINK_MSG_ID_RAW_AUX,
+    MAVLINK_MSG_ID_IMAGE_TRIGGERED,
+    MAVLINK_MSG_ID_PATTERN_DETECTED,
+    MAVLINK_MSG_ID_WATCHDOG_HEARTBEAT,
+    MAVLINK_MSG_ID_WATCHDOG_PROCESS_INFO,
+    MAVLINK_MSG_ID_WATCHDOG_PROCESS_STATUS,
+    -1
+};
+#endif
+
+void PxQuadMAV::subscribe(MAVLinkDispatcher *dispatcher, const int *msgids)
+{
+    UAS::subscribe(dispatcher, msgids);
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    if (msgids)
+    {
+        return;
+    }
+    for (const int *msgid = pixhawkMessages; *msgid != -1; ++msgid)
+    {
+        dispatcher->subscribe(uasId, *msgid,
+                              &MAVLinkDispatcher::call<PxQuadMAV, &PxQuadMAV::receivePixhawkMessage>, this);
+    }
+#endif
+}
+
 /**
- * This function is called by MAVLink once a complete, uncorrupted (CRC check valid)
- * mavlink packet is received.
+ * Called by the dispatcher for the pixhawkMessages of this MAV, after UAS
+ * tracked the link and component.
  *
  * @param link Hardware link the message came from (e.g. /dev/ttyUSB0 or UDP port).
  *             messages can be sent back to the system via this link
  * @param message MAVLink message, as received from the MAVLink protocol stack
  */
-void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
+void PxQuadMAV::receivePixhawkMessage(LinkInterface* link, mavlink_message_t message)
 {
-    // Only compile this portion if matching MAVLink packets have been compiled
+    Q_UNUSED(link);
 #ifdef MAVLINK_ENABLED_PIXHAWK
     mavlink_message_t* msg = &message;
 
-    if (message.sysid == uasId)
+    switch (message.msgid)
     {
-        switch (message.msgid)
-        {
-        case MAVLINK_MSG_ID_RAW_AUX:
-            {
-            mavlink_raw_aux_t raw;
-            mavlink_msg_raw_aux_decode(&message, &raw);
-            quint64 time = getUnixTime(0);
-            emit valueChanged(uasId, "Pressure", "raw", raw.baro, time);
-            emit valueChanged(uasId, "Temperature", "raw", raw.temp, time);
-        }
-        break;
-        case MAVLINK_MSG_ID_IMAGE_TRIGGERED:
+    case MAVLINK_MSG_ID_RAW_AUX:
         {
-            // FIXME Kind of a hack to load data from disk
-            mavlink_image_triggered_t img;
-            mavlink_msg_image_triggered_decode(&message, &img);
-            emit imageStarted(img.timestamp);
-        }
-        break;
-        case MAVLINK_MSG_ID_PATTERN_DETECTED:
-        {
-            mavlink_pattern_detected_t detected;
-            mavlink_msg_pattern_detected_decode(&message, &detected);
-            QByteArray b;
-            b.resize(256);
-            mavlink_msg_pattern_detected_get_file(&message, b.data());
-            b.append('\0');
-            QString name = QString(b);
-            if (detected.type == 0)
-                emit patternDetected(uasId, name, detected.confidence, detected.detected);
-            else if (detected.type == 1)
-                emit letterDetected(uasId, name, detected.confidence, detected.detected);
-        }
-        break;
-        case MAVLINK_MSG_ID_WATCHDOG_HEARTBEAT: {
-            mavlink_watchdog_heartbeat_t payload;
-            mavlink_msg_watchdog_heartbeat_decode(msg, &payload);
+        mavlink_raw_aux_t raw;
+        mavlink_msg_raw_aux_decode(&message, &raw);
+        quint64 time = getUnixTime(0);
+        emit valueChanged(uasId, INTERNED("Pressure"), INTERNED("raw"), raw.baro, time);
+        emit valueChanged(uasId, INTERNED("Temperature"), INTERNED("raw"), raw.temp, time);
+    }
+    break;
+    case MAVLINK_MSG_ID_IMAGE_TRIGGERED:
+    {
+        // FIXME Kind of a hack to load data from disk
+        mavlink_image_triggered_t img;
+        mavlink_msg_image_triggered_decode(&message, &img);
+        emit imageStarted(img.timestamp);
+    }
+    break;
+    case MAVLINK_MSG_ID_PATTERN_DETECTED:
+    {
+        mavlink_pattern_detected_t detected;
+        mavlink_msg_pattern_detected_decode(&message, &detected);
+        QByteArray b;
+        b.resize(256);
+        mavlink_msg_pattern_detected_get_file(&message, b.data());
+        b.append('\0');
+        QString name = QString(b);
+        if (detected.type == 0)
+            emit patternDetected(uasId, name, detected.confidence, detected.detected);
+        else if (detected.type == 1)
+            emit letterDetected(uasId, name, detected.confidence, detected.detected);
+    }
+    break;
+    case MAVLINK_MSG_ID_WATCHDOG_HEARTBEAT: {
+        mavlink_watchdog_heartbeat_t payload;
+        mavlink_msg_watchdog_heartbeat_decode(msg, &payload);
 
-            emit watchdogReceived(this->uasId, payload.watchdog_id, payload.process_count);
-        }
-        break;
+        emit watchdogReceived(this->uasId, payload.watchdog_id, payload.process_count);
+    }
+    break;
 
-        case MAVLINK_MSG_ID_WATCHDOG_PROCESS_INFO: {
-            mavlink_watchdog_process_info_t payload;
-            mavlink_msg_watchdog_process_info_decode(msg, &payload);
+    case MAVLINK_MSG_ID_WATCHDOG_PROCESS_INFO: {
+        mavlink_watchdog_process_info_t payload;
+        mavlink_msg_watchdog_process_info_decode(msg, &payload);
 
-            emit processReceived(this->uasId, payload.watchdog_id, payload.process_id, QString((const char*)payload.name), QString((const char*)payload.arguments), payload.timeout);
-        }
-        break;
+        emit processReceived(this->uasId, payload.watchdog_id, payload.process_id, QString((const char*)payload.name), QString((const char*)payload.arguments), payload.timeout);
+    }
+    break;
 
-        case MAVLINK_MSG_ID_WATCHDOG_PROCESS_STATUS: {
-            mavlink_watchdog_process_status_t payload;
-            mavlink_msg_watchdog_process_status_decode(msg, &payload);
-            emit processChanged(this->uasId, payload.watchdog_id, payload.process_id, payload.state, (payload.muted == 1) ? true : false, payload.crashes, payload.pid);
-        }
-        break;
+    case MAVLINK_MSG_ID_WATCHDOG_PROCESS_STATUS: {
+        mavlink_watchdog_process_status_t payload;
+        mavlink_msg_watchdog_process_status_decode(msg, &payload);
+        emit processChanged(this->uasId, payload.watchdog_id, payload.process_id, payload.state, (payload.muted == 1) ? true : false, payload.crashes, payload.pid);
+    }
+    break;
 //        case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE: {
 //            mavlink_vision_position_estimate_t pos;
 //            mavlink_msg_vision_position_estimate_decode(&message, &pos);
@@ -191,17 +220,10 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
 //            emit valueChanged(uasId, "Load", "%", ((float)status.load)/10.0f, getUnixTime());
 //        }
 //        break;
-        default:
-            // Let UAS handle the default message set
-            UAS::receiveMessage(link, message);
-            break;
-        }
+    default:
+        break;
     }
-
 #else
-    // Let UAS handle the default message set
-    UAS::receiveMessage(link, message);
-    Q_UNUSED(link);
     Q_UNUSED(message);
 #endif
 }
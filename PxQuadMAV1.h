@@ -35,10 +35,11 @@ public:
 
     QString getCustomModeAudioText();
     QString getCustomModeText();
+    void subscribe(MAVLinkDispatcher *dispatcher, const int *msgids = 0);
 
 public slots:
-    /** @brief Receive a MAVLink message from this MAV */
-    void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    /** @brief Receive a Pixhawk specific MAVLink message from this MAV */
+    void receivePixhawkMessage(LinkInterface* link, mavlink_message_t message);
 #if defined(QGC_PROTOBUF_ENABLED)
     /** @brief Receive a Protobuf message from this MAV */
     void receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<google::protobuf::Message> message);
@@ -1,6 +1,22 @@
 #include "QCurrentState.h"
+#include <cmath>
 
-QCurrentState::QCurrentState(QObject *parent) : QObject(parent)
+// Changes below these are noise as far as the display goes
+static const float AngleEpsilon = 0.01f;        // degrees
+static const float SpeedEpsilon = 0.01f;
+static const float DistanceEpsilon = 0.01f;
+static const float VoltageEpsilon = 0.001f;
+static const float CurrentEpsilon = 0.001f;
+static const float PercentEpsilon = 0.01f;
+static const float PowerEpsilon = 0.01f;
+static const float HdopEpsilon = 0.001f;
+static const float TimeEpsilon = 0.5f;          // seconds, shown as whole seconds
+static const float ExactEpsilon = 0.0f;
+static const double CoordinateEpsilon = 1e-8;   // degrees, about a millimetre
+
+QCurrentState::QCurrentState(QObject *parent) : QObject(parent),
+    m_dirty(0),
+    m_updateDepth(0)
 {
     m_roll= 0;
     m_pitch = 0;
@@ -33,4 +49,252 @@ QCurrentState::~QCurrentState()
 {
 }
 
+void QCurrentState::setRoll(float roll)
+{
+    if (changed(m_roll, roll, AngleEpsilon, RollField)) emit rollChanged(m_roll);
+}
+
+void QCurrentState::setPitch(float pitch)
+{
+    if (changed(m_pitch, pitch, AngleEpsilon, PitchField)) emit pitchChanged(m_pitch);
+}
+
+void QCurrentState::setYaw(float yaw)
+{
+    if (changed(m_yaw, yaw, AngleEpsilon, YawField)) emit yawChanged(m_yaw);
+}
+
+void QCurrentState::setGroundspeed(float speed)
+{
+    if (changed(m_groundspeed, speed, SpeedEpsilon, GroundspeedField)) emit groundspeedChanged(m_groundspeed);
+}
+
+void QCurrentState::setAirspeed(float speed)
+{
+    if (changed(m_airspeed, speed, SpeedEpsilon, AirspeedField)) emit airspeedChanged(m_airspeed);
+}
+
+void QCurrentState::setBatteryVoltage(float v)
+{
+    if (changed(m_batteryVoltage, v, VoltageEpsilon, BatteryVoltageField)) emit batteryVoltageChanged(m_batteryVoltage);
+}
+
+void QCurrentState::setBatteryCurrent(float i)
+{
+    if (changed(m_batteryCurrent, i, CurrentEpsilon, BatteryCurrentField)) emit batteryCurrentChanged(m_batteryCurrent);
+}
+
+void QCurrentState::setBatteryRemaining(float percent)
+{
+    if (changed(m_batteryRemaining, percent, PercentEpsilon, BatteryRemainingField)) emit batteryRemainingChanged(m_batteryRemaining);
+}
+
+void QCurrentState::setAltitude(float alt)
+{
+    if (changed(m_altitude, alt, DistanceEpsilon, AltitudeField)) emit altitudeChanged(m_altitude);
+}
+
+void QCurrentState::setWatts(float watts)
+{
+    if (changed(m_watts, watts, PowerEpsilon, WattsField)) emit wattsChanged(m_watts);
+}
+
+void QCurrentState::setGpsstatus(float status)
+{
+    if (changed(m_gpsstatus, status, ExactEpsilon, GpsstatusField)) emit gpsstatusChanged(m_gpsstatus);
+}
+
+void QCurrentState::setGpshdop(float hdop)
+{
+    if (changed(m_gpshdop, hdop, HdopEpsilon, GpshdopField)) emit gpshdopChanged(m_gpshdop);
+}
+
+void QCurrentState::setSatcount(float count)
+{
+    if (changed(m_satcount, count, ExactEpsilon, SatcountField)) emit satcountChanged(m_satcount);
+}
+
+void QCurrentState::setWp_dist(float dist)
+{
+    if (changed(m_wp_dist, dist, DistanceEpsilon, Wp_distField)) emit wp_distChanged(m_wp_dist);
+}
+
+void QCurrentState::setCh3percent(float percent)
+{
+    if (changed(m_ch3percent, percent, PercentEpsilon, Ch3percentField)) emit ch3percentChanged(m_ch3percent);
+}
+
+void QCurrentState::setTimeInAir(float time)
+{
+    if (changed(m_timeInAir, time, TimeEpsilon, TimeInAirField)) emit timeInAirChanged(m_timeInAir);
+}
+
+void QCurrentState::setDistToHome(float dist)
+{
+    if (changed(m_DistToHome, dist, DistanceEpsilon, DistToHomeField)) emit DistToHomeChanged(m_DistToHome);
+}
 
+void QCurrentState::setDistTraveled(float dist)
+{
+    if (changed(m_distTraveled, dist, DistanceEpsilon, DistTraveledField)) emit distTraveledChanged(m_distTraveled);
+}
+
+void QCurrentState::setAZToMAV(float deg)
+{
+    if (changed(m_AZToMAV, deg, AngleEpsilon, AZToMAVField)) emit AZToMAVChanged(m_AZToMAV);
+}
+
+void QCurrentState::setLat(double lat)
+{
+    if (changed(m_lat, lat, CoordinateEpsilon, LatField)) emit latChanged(m_lat);
+}
+
+void QCurrentState::setLng(double lng)
+{
+    if (changed(m_lng, lng, CoordinateEpsilon, LngField)) emit lngChanged(m_lng);
+}
+
+void QCurrentState::setArmed(bool armed)
+{
+    if (changed(m_armed, armed, ArmedField)) emit armedChanged(m_armed);
+}
+
+void QCurrentState::setDistUnit(const QString& unit)
+{
+    if (changed(m_distUnit, unit, DistUnitField)) emit distUnitChanged(m_distUnit);
+}
+
+void QCurrentState::setSpeedUnit(const QString& unit)
+{
+    if (changed(m_speedUnit, unit, SpeedUnitField)) emit speedUnitChanged(m_speedUnit);
+}
+
+void QCurrentState::setMessage(const QString& message)
+{
+    if (changed(m_message, message, MessageField)) emit messageChanged(m_message);
+}
+
+void QCurrentState::setFlightMode(const QString& mode)
+{
+    if (changed(m_flightMode, mode, FlightModeField)) emit flightModeChanged(m_flightMode);
+}
+
+void QCurrentState::beginUpdate()
+{
+    m_updateDepth++;
+}
+
+void QCurrentState::endUpdate()
+{
+    if (m_updateDepth == 0 || --m_updateDepth > 0)
+    {
+        return;
+    }
+    quint32 dirty = m_dirty;
+    m_dirty = 0;
+    if (dirty == 0)
+    {
+        return;
+    }
+    for (quint32 bit = 1; bit != 0 && bit <= dirty; bit <<= 1)
+    {
+        if (dirty & bit)
+        {
+            emitField(static_cast<Field>(bit));
+        }
+    }
+    emit stateChanged();
+}
+
+bool QCurrentState::changed(float &field, float value, float epsilon, Field bit)
+{
+    if (std::fabs(value - field) <= epsilon)
+    {
+        return false;
+    }
+    field = value;
+    if (m_updateDepth > 0)
+    {
+        m_dirty |= bit;
+        return false;
+    }
+    return true;
+}
+
+bool QCurrentState::changed(double &field, double value, double epsilon, Field bit)
+{
+    if (std::fabs(value - field) <= epsilon)
+    {
+        return false;
+    }
+    field = value;
+    if (m_updateDepth > 0)
+    {
+        m_dirty |= bit;
+        return false;
+    }
+    return true;
+}
+
+bool QCurrentState::changed(bool &field, bool value, Field bit)
+{
+    if (value == field)
+    {
+        return false;
+    }
+    field = value;
+    if (m_updateDepth > 0)
+    {
+        m_dirty |= bit;
+        return false;
+    }
+    return true;
+}
+
+bool QCurrentState::changed(QString &field, const QString &value, Field bit)
+{
+    if (value == field)
+    {
+        return false;
+    }
+    field = value;
+    if (m_updateDepth > 0)
+    {
+        m_dirty |= bit;
+        return false;
+    }
+    return true;
+}
+
+void QCurrentState::emitField(Field bit)
+{
+    switch (bit)
+    {
+    case RollField: emit rollChanged(m_roll); break;
+    case PitchField: emit pitchChanged(m_pitch); break;
+    case YawField: emit yawChanged(m_yaw); break;
+    case GroundspeedField: emit groundspeedChanged(m_groundspeed); break;
+    case AirspeedField: emit airspeedChanged(m_airspeed); break;
+    case BatteryVoltageField: emit batteryVoltageChanged(m_batteryVoltage); break;
+    case BatteryCurrentField: emit batteryCurrentChanged(m_batteryCurrent); break;
+    case BatteryRemainingField: emit batteryRemainingChanged(m_batteryRemaining); break;
+    case AltitudeField: emit altitudeChanged(m_altitude); break;
+    case WattsField: emit wattsChanged(m_watts); break;
+    case GpsstatusField: emit gpsstatusChanged(m_gpsstatus); break;
+    case GpshdopField: emit gpshdopChanged(m_gpshdop); break;
+    case SatcountField: emit satcountChanged(m_satcount); break;
+    case Wp_distField: emit wp_distChanged(m_wp_dist); break;
+    case Ch3percentField: emit ch3percentChanged(m_ch3percent); break;
+    case TimeInAirField: emit timeInAirChanged(m_timeInAir); break;
+    case DistToHomeField: emit DistToHomeChanged(m_DistToHome); break;
+    case DistTraveledField: emit distTraveledChanged(m_distTraveled); break;
+    case AZToMAVField: emit AZToMAVChanged(m_AZToMAV); break;
+    case LatField: emit latChanged(m_lat); break;
+    case LngField: emit lngChanged(m_lng); break;
+    case ArmedField: emit armedChanged(m_armed); break;
+    case DistUnitField: emit distUnitChanged(m_distUnit); break;
+    case SpeedUnitField: emit speedUnitChanged(m_speedUnit); break;
+    case MessageField: emit messageChanged(m_message); break;
+    case FlightModeField: emit flightModeChanged(m_flightMode); break;
+    }
+}
@@ -90,35 +90,44 @@ public:
 	QString getMessage() { return m_message; }
 	QString getFlightMode() { return m_flightMode; }
 
-    void setRoll(float roll) { m_roll = roll; emit rollChanged(roll); }
-    void setPitch(float pitch) { m_pitch = pitch; emit pitchChanged(pitch); }
-    void setYaw(float yaw) { m_yaw = yaw; emit yawChanged(yaw); }
-    void setGroundspeed(float speed) { m_groundspeed = speed; emit groundspeedChanged(speed); }
-    void setAirspeed(float speed) { m_airspeed = speed; emit airspeedChanged(speed); }
-    void setBatteryVoltage(float v) { m_batteryVoltage = v; emit batteryVoltageChanged(v); }
-    void setBatteryCurrent(float i) { m_batteryCurrent = i; emit batteryCurrentChanged(i); }
-    void setBatteryRemaining(float percent) { m_batteryRemaining = percent; emit batteryRemainingChanged(percent); }
-    void setAltitude(float alt) { m_altitude = alt; emit altitudeChanged(alt); }
-	void setWatts(float watts) { m_watts = watts; emit wattsChanged(watts); }
-	void setGpsstatus(float status) { m_gpsstatus = status; emit gpsstatusChanged(status); }
-	void setGpshdop(float hdop) { m_gpshdop = hdop; emit gpshdopChanged(hdop); }
-	void setSatcount(float count) { m_satcount = count; emit satcountChanged(count); }
-	void setWp_dist(float dist) { m_wp_dist = dist; emit wp_distChanged(dist); }
-	void setCh3percent(float percent) { m_ch3percent = percent; emit ch3percentChanged(percent); }
-	void setTimeInAir(float time) { m_timeInAir = time; emit timeInAirChanged(time); }
-	void setDistToHome(float dist) { m_DistToHome = dist; emit DistToHomeChanged(dist); }
-	void setDistTraveled(float dist) { m_distTraveled = dist; emit distTraveledChanged(dist); }
-	void setAZToMAV(float deg) { m_AZToMAV = deg; emit AZToMAVChanged(deg); }
-	
-	void setLat(double lat) { m_lat = lat; emit latChanged(lat); }
-	void setLng(double lng) { m_lng = lng; emit lngChanged(lng); }
-
-	void setArmed(bool armed) { m_armed = armed; emit armedChanged(armed); }
-
-	void setDistUnit(QString unit) { m_distUnit = unit; emit distUnitChanged(unit); }
-	void setSpeedUnit(QString unit) { m_speedUnit = unit; emit speedUnitChanged(unit); }
-	void setMessage(QString message) { m_message = message; emit messageChanged(message); }
-    void setFlightMode(QString mode) { m_flightMode = mode; emit flightModeChanged(mode); }
+    void setRoll(float roll);
+    void setPitch(float pitch);
+    void setYaw(float yaw);
+    void setGroundspeed(float speed);
+    void setAirspeed(float speed);
+    void setBatteryVoltage(float v);
+    void setBatteryCurrent(float i);
+    void setBatteryRemaining(float percent);
+    void setAltitude(float alt);
+    void setWatts(float watts);
+    void setGpsstatus(float status);
+    void setGpshdop(float hdop);
+    void setSatcount(float count);
+    void setWp_dist(float dist);
+    void setCh3percent(float percent);
+    void setTimeInAir(float time);
+    void setDistToHome(float dist);
+    void setDistTraveled(float dist);
+    void setAZToMAV(float deg);
+
+    void setLat(double lat);
+    void setLng(double lng);
+
+    void setArmed(bool armed);
+
+    void setDistUnit(const QString& unit);
+    void setSpeedUnit(const QString& unit);
+    void setMessage(const QString& message);
+    void setFlightMode(const QString& mode);
+
+    /**
+     * @brief Hold back the change signals until the matching endUpdate()
+     *
+     * Bindings then see one consistent state instead of every field as it
+     * is set. Calls nest; fields that did not change are not signalled.
+     */
+    void beginUpdate();
+    void endUpdate();
 
 signals:
     void rollChanged(float);
@@ -150,8 +159,47 @@ signals:
 	void speedUnitChanged(QString);
 	void messageChanged(QString);
 	void flightModeChanged(QString);
+	/** @brief After the per field signals of an endUpdate() that changed anything */
+	void stateChanged();
 
 private:
+    enum Field {
+        RollField = 1u << 0,
+        PitchField = 1u << 1,
+        YawField = 1u << 2,
+        GroundspeedField = 1u << 3,
+        AirspeedField = 1u << 4,
+        BatteryVoltageField = 1u << 5,
+        BatteryCurrentField = 1u << 6,
+        BatteryRemainingField = 1u << 7,
+        AltitudeField = 1u << 8,
+        WattsField = 1u << 9,
+        GpsstatusField = 1u << 10,
+        GpshdopField = 1u << 11,
+        SatcountField = 1u << 12,
+        Wp_distField = 1u << 13,
+        Ch3percentField = 1u << 14,
+        TimeInAirField = 1u << 15,
+        DistToHomeField = 1u << 16,
+        DistTraveledField = 1u << 17,
+        AZToMAVField = 1u << 18,
+        LatField = 1u << 19,
+        LngField = 1u << 20,
+        ArmedField = 1u << 21,
+        DistUnitField = 1u << 22,
+        SpeedUnitField = 1u << 23,
+        MessageField = 1u << 24,
+        FlightModeField = 1u << 25
+    };
+    bool changed(float &field, float value, float epsilon, Field bit);
+    bool changed(double &field, double value, double epsilon, Field bit);
+    bool changed(bool &field, bool value, Field bit);
+    bool changed(QString &field, const QString &value, Field bit);
+    void emitField(Field bit);
+
+    quint32 m_dirty;        ///< Fields changed since beginUpdate()
+    int m_updateDepth;
+
 	float m_roll;
 	float m_pitch;
 	float m_yaw;
@@ -22,37 +22,27 @@ This file is part of the QGROUNDCONTROL project
 ======================================================================*/
 
 #include "QGC.h"
+#include "GroundClock.h"
 #include <qmath.h>
 #include <float.h>
 
 namespace QGC
 {
 
+// Called per frame on the hot path, see GroundClock
 quint64 groundTimeUsecs()
 {
-    QDateTime time = QDateTime::currentDateTime();
-    time = time.toUTC();
-    /* Return seconds and milliseconds, in milliseconds unit */
-    quint64 microseconds = time.toTime_t() * static_cast<quint64>(1000000);
-    return static_cast<quint64>(microseconds + (time.time().msec()*1000));
+    return GroundClock::wallUsecs();
 }
 
 quint64 groundTimeMilliseconds()
 {
-    QDateTime time = QDateTime::currentDateTime();
-    time = time.toUTC();
-    /* Return seconds and milliseconds, in milliseconds unit */
-    quint64 seconds = time.toTime_t() * static_cast<quint64>(1000);
-    return static_cast<quint64>(seconds + (time.time().msec()));
+    return GroundClock::wallUsecs() / 1000;
 }
 
 qreal groundTimeSeconds()
 {
-    QDateTime time = QDateTime::currentDateTime();
-    time = time.toUTC();
-    /* Return time in seconds unit */
-    quint64 seconds = time.toTime_t();
-    return static_cast<qreal>(seconds + (time.time().msec() / 1000.0));
+    return static_cast<qreal>(GroundClock::wallUsecs()) / 1000000.0;
 }
 
 float limitAngleToPMPIf(float angle)
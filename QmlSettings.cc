@@ -0,0 +1,92 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief QmlSettings
+ *          See QmlSettings.h
+ *
+ */
+
+#include "QmlSettings.h"
+#include "SettingsStore.h"
+
+QmlSettings* QmlSettings::instance()
+{
+    static QmlSettings* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new QmlSettings();
+    }
+    return _instance;
+}
+
+QmlSettings::QmlSettings()
+{
+}
+
+QString QmlSettings::storeKey(const QString &key)
+{
+    return QLatin1String("qml/") + key;
+}
+
+QVariant QmlSettings::get(const QString &key, const QVariant &defaultValue)
+{
+    QHash<QString, QVariant>::const_iterator it = m_cache.constFind(key);
+    if (it == m_cache.constEnd())
+    {
+        it = m_cache.insert(key, SettingsStore::instance()->value(storeKey(key)));
+    }
+    const QVariant &value = it.value();
+    // Storage.js treated an empty value as a missing one
+    if (!value.isValid() || value.toString().isEmpty())
+    {
+        return defaultValue;
+    }
+    return value;
+}
+
+void QmlSettings::set(const QString &key, const QVariant &value)
+{
+    // The SQL table stored booleans as integers, the pages compare them with 0
+    QVariant stored = value.type() == QVariant::Bool ? QVariant(value.toBool() ? 1 : 0) : value;
+    QHash<QString, QVariant>::iterator it = m_cache.find(key);
+    if (it != m_cache.end() && it.value() == stored)
+    {
+        // Sliders set on every step, unchanged values need no write
+        return;
+    }
+    m_cache.insert(key, stored);
+    SettingsStore::instance()->setValue(storeKey(key), stored);
+    emit valueChanged(key, stored);
+}
+
+bool QmlSettings::contains(const QString &key)
+{
+    return get(key).isValid();
+}
+
+void QmlSettings::remove(const QString &key)
+{
+    m_cache.insert(key, QVariant());
+    SettingsStore::instance()->remove(storeKey(key));
+}
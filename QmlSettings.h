@@ -0,0 +1,66 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief QmlSettings
+ *          The settings of the QML pages, for Storage.js. Values live in
+ *          SettingsStore under the "qml" group, so a get() from a binding is
+ *          a hash lookup on the UI thread and a set() is written to disk by
+ *          the store thread together with the other changes of the burst.
+ *          Values are kept the way the LocalStorage table returned them,
+ *          booleans as 1 and 0, so the pages read them back unchanged.
+ *
+ */
+
+#ifndef QMLSETTINGS_H
+#define QMLSETTINGS_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+
+class QmlSettings : public QObject
+{
+    Q_OBJECT
+public:
+    static QmlSettings* instance();
+
+    /** @brief The stored value, defaultValue if there is none or it is empty */
+    Q_INVOKABLE QVariant get(const QString &key, const QVariant &defaultValue = QVariant());
+    Q_INVOKABLE void set(const QString &key, const QVariant &value);
+    Q_INVOKABLE bool contains(const QString &key);
+    Q_INVOKABLE void remove(const QString &key);
+
+signals:
+    void valueChanged(const QString &key, const QVariant &value);
+
+private:
+    QmlSettings();
+    static QString storeKey(const QString &key);
+
+    /** UI thread only: what the store held or was given, an invalid value for a missing key */
+    QHash<QString, QVariant> m_cache;
+};
+
+#endif // QMLSETTINGS_H
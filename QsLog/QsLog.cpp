@@ -25,12 +25,13 @@
 
 #include "QsLog.h"
 #include "QsLogDest.h"
+#include "QsLogBinary.h"
 #ifdef QS_LOG_SEPARATE_THREAD
-#include <QThreadPool>
-#include <QRunnable>
-#else
-#include <QMutex>
+#include "QsLogRing.h"
+#include <QThread>
+#include <QWaitCondition>
 #endif
+#include <QMutex>
 #include <QVector>
 #include <QDateTime>
 #include <QtGlobal>
@@ -76,64 +77,142 @@ static const char* LevelToText(Level theLevel)
     }
 }
 
+static QString formatMessage(const QString& message, Level level, qint64 timestamp)
+{
+    return QString("%1 %2 %3")
+            .arg(LevelToText(level), 5)
+            .arg(QDateTime::fromMSecsSinceEpoch(timestamp).toString(fmtDateTime))
+            .arg(message);
+}
+
 #ifdef QS_LOG_SEPARATE_THREAD
-class LogWriterRunnable : public QRunnable
+//! Drains the ring, formats the records and hands them to the destinations.
+//! Wakes up every WaitMs, or right away for errors.
+class LogWriterThread : public QThread
 {
 public:
-    LogWriterRunnable(const QString &message, Level level)
-        : mMessage(message)
-        , mLevel(level) {}
+    enum { WaitMs = 50 };
+
+    LogWriterThread(Logger *logger, LogRing *ring)
+        : mLogger(logger)
+        , mRing(ring)
+        , mStop(false)
+        , mReportedDrops(0)
+    {
+        // the thread's name, so the application can find it
+        setObjectName(QLatin1String("QsLogWriter"));
+    }
+
+    void wake()
+    {
+        QMutexLocker lock(&mWaitMutex);
+        mWake.wakeOne();
+    }
+
+    void stop()
+    {
+        {
+            QMutexLocker lock(&mWaitMutex);
+            mStop = true;
+            mWake.wakeOne();
+        }
+        wait();
+        drain();
+    }
 
+protected:
     virtual void run()
     {
-        Logger::instance().write(mMessage, mLevel);
+        forever {
+            drain();
+            QMutexLocker lock(&mWaitMutex);
+            if (mStop)
+                return;
+            mWake.wait(&mWaitMutex, WaitMs);
+        }
     }
 
 private:
-    QString mMessage;
-    Level mLevel;
+    void drain()
+    {
+        Level level;
+        qint64 timestamp;
+        QString message;
+        while (mRing->pop(&level, &timestamp, &message))
+            mLogger->write(formatMessage(message, level, timestamp), level);
+
+        const int dropped = mRing->dropped();
+        if (dropped != mReportedDrops) {
+            const QString report = QString("QsLog: %1 messages dropped, the log ring was full")
+                    .arg(dropped - mReportedDrops);
+            mReportedDrops = dropped;
+            mLogger->write(formatMessage(report, WarnLevel, QDateTime::currentMSecsSinceEpoch()),
+                           WarnLevel);
+        }
+    }
+
+    Logger *mLogger;
+    LogRing *mRing;
+    QMutex mWaitMutex;
+    QWaitCondition mWake;
+    bool mStop;
+    int mReportedDrops;
 };
 #endif
 
 class LoggerImpl
 {
 public:
-    LoggerImpl() :
-        level(InfoLevel)
+    explicit LoggerImpl(Logger *logger) :
+        level(InfoLevel),
+        binaryLevel(OffLevel)
+#ifdef QS_LOG_SEPARATE_THREAD
+        , writer(logger, &ring)
+#endif
     {
+        Q_UNUSED(logger);
         // assume at least file + console
         destList.reserve(2);
-#ifdef QS_LOG_SEPARATE_THREAD
-        threadPool.setMaxThreadCount(1);
-        threadPool.setExpiryTimeout(-1);
-#endif
     }
 #ifdef QS_LOG_SEPARATE_THREAD
-    QThreadPool threadPool;
-#else
-    QMutex logMutex;
+    LogRing ring;
+    LogWriterThread writer;
 #endif
+    //! Held while writing to the destinations and while changing them
+    QMutex logMutex;
     Level level;
     DestinationList destList;
+    //! Held while writing a binary record and while changing the destination
+    QMutex binaryMutex;
+    volatile Level binaryLevel;
+    BinaryDestinationPtr binaryDest;
 };
 
 Logger::Logger() :
-    d(new LoggerImpl)
+    d(new LoggerImpl(this))
 {
+#ifdef QS_LOG_SEPARATE_THREAD
+    d->writer.start(QThread::LowPriority);
+#endif
 }
 
 Logger::~Logger()
 {
+#ifdef QS_LOG_SEPARATE_THREAD
+    d->writer.stop();
+#endif
     delete d;
 }
 
 void Logger::addDestination(DestinationPtr destination)
 {
     assert(destination.data());
+    QMutexLocker lock(&d->logMutex);
     d->destList.push_back(destination);
 }
 void Logger::delDestination(Destination *destination)
 {
+    QMutexLocker lock(&d->logMutex);
     for (int i=0;i<d->destList.size();i++)
     {
         if (d->destList[i] == destination)
@@ -154,17 +233,10 @@ Level Logger::loggingLevel() const
     return d->level;
 }
 
-//! creates the complete log message and passes it to the logger
+//! passes the message to the logger, which formats it
 void Logger::Helper::writeToLog()
 {
-    const char* const levelName = LevelToText(level);
-    const QString completeMessage(QString("%1 %2 %3")
-                                  .arg(levelName, 5)
-                                  .arg(QDateTime::currentDateTime().toString(fmtDateTime))
-                                  .arg(buffer)
-                                  );
-
-    Logger::instance().enqueueWrite(completeMessage, level);
+    Logger::instance().enqueueWrite(buffer, level);
 }
 
 Logger::Helper::~Helper()
@@ -179,15 +251,60 @@ Logger::Helper::~Helper()
     }
 }
 
-//! directs the message to the task queue or writes it directly
-void Logger::enqueueWrite(const QString& message, Level level)
+void Logger::setBinaryDestination(BinaryDestinationPtr destination, Level level)
+{
+    QMutexLocker lock(&d->binaryMutex);
+    if (d->binaryDest)
+        d->binaryDest->flush();
+    d->binaryDest = destination;
+    d->binaryLevel = destination ? level : OffLevel;
+}
+
+Level Logger::binaryLoggingLevel() const
+{
+    return d->binaryLevel;
+}
+
+//! The level was checked by the QLOG_BIN_* macro, the destination may be gone since
+void Logger::writeBinary(const BinaryRecord& record)
+{
+    QMutexLocker lock(&d->binaryMutex);
+    if (d->binaryDest && record.level() >= d->binaryLevel)
+        d->binaryDest->write(record);
+}
+
+int Logger::droppedMessages() const
 {
 #ifdef QS_LOG_SEPARATE_THREAD
-    LogWriterRunnable *r = new LogWriterRunnable(message, level);
-    d->threadPool.start(r);
+    return d->ring.dropped();
 #else
+    return 0;
+#endif
+}
+
+qint64 Logger::bufferedBytes() const
+{
+    qint64 bytes = 0;
+#ifdef QS_LOG_SEPARATE_THREAD
+    bytes += sizeof(LogRing);
+#endif
     QMutexLocker lock(&d->logMutex);
-    write(message, level);
+    for (DestinationList::iterator it = d->destList.begin(), end = d->destList.end(); it != end; ++it)
+        bytes += (*it)->bufferedBytes();
+    return bytes;
+}
+
+//! directs the message to the ring for the writer thread or writes it directly
+void Logger::enqueueWrite(const QString& message, Level level)
+{
+    // the time the message was logged, not the time it was written
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+#ifdef QS_LOG_SEPARATE_THREAD
+    d->ring.push(level, timestamp, message);
+    if (level >= ErrorLevel)
+        d->writer.wake();
+#else
+    write(formatMessage(message, level, timestamp), level);
 #endif
 }
 
@@ -195,6 +312,7 @@ void Logger::enqueueWrite(const QString& message, Level level)
 //! it's useful for processing in the destination.
 void Logger::write(const QString& message, Level level)
 {
+    QMutexLocker lock(&d->logMutex);
     for (DestinationList::iterator it = d->destList.begin(),
         endIt = d->destList.end();it != endIt;++it) {
         (*it)->write(message, level);
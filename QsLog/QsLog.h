@@ -36,6 +36,7 @@
 namespace QsLogging
 {
 class Destination;
+class BinaryRecord;
 class LoggerImpl; // d pointer
 
 class Logger
@@ -55,6 +56,18 @@ public:
     void setLoggingLevel(Level newLevel);
     //! The default level is INFO
     Level loggingLevel() const;
+    //! Messages lost because the writer thread fell behind, always 0 without
+    //! QS_LOG_SEPARATE_THREAD
+    int droppedMessages() const;
+    //! Memory held for messages on their way to the destinations: the ring
+    //! of the writer thread and what the destinations buffer
+    qint64 bufferedBytes() const;
+
+    //! Sets where QLOG_BIN_* records go, those below 'level' are ignored.
+    //! A null destination turns binary logging off, the default.
+    void setBinaryDestination(BinaryDestinationPtr destination, Level level = DebugLevel);
+    //! OffLevel while there is no binary destination
+    Level binaryLoggingLevel() const;
 
     //! The helper forwards the streaming to QDebug and builds the final
     //! log message.
@@ -83,53 +96,61 @@ private:
 
     void enqueueWrite(const QString& message, Level level);
     void write(const QString& message, Level level);
+    void writeBinary(const BinaryRecord& record);
 
     LoggerImpl* d;
 
-    friend class LogWriterRunnable;
+    friend class LogWriterThread;
+    friend class BinaryRecord;
 };
 
 } // end namespace
 
+//! Build time minimum level, 0 (trace) to 6 (off). Statements below it are
+//! constant false conditions the compiler removes, arguments and all.
+#ifndef QS_LOG_MIN_LEVEL
+#define QS_LOG_MIN_LEVEL 0
+#endif
+
 //! Logging macros: define QS_LOG_LINE_NUMBERS to get the file and line number
 //! in the log output.
 #ifndef QS_LOG_LINE_NUMBERS
 #define QLOG_TRACE() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::TraceLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::TraceLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::TraceLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::TraceLevel).stream()
 #define QLOG_DEBUG() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::DebugLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::DebugLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::DebugLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::DebugLevel).stream()
 #define QLOG_INFO()  \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::InfoLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::InfoLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::InfoLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::InfoLevel).stream()
 #define QLOG_WARN()  \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::WarnLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::WarnLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::WarnLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::WarnLevel).stream()
 #define QLOG_ERROR() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::ErrorLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::ErrorLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::ErrorLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::ErrorLevel).stream()
 #define QLOG_FATAL() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::FatalLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::FatalLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::FatalLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::FatalLevel).stream()
 #else
 #define QLOG_TRACE() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::TraceLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::TraceLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::TraceLevel) {} \
     else  QsLogging::Logger::Helper(QsLogging::TraceLevel).stream() << __FILE__ << '@' << __LINE__
 #define QLOG_DEBUG() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::DebugLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::DebugLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::DebugLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::DebugLevel).stream() << __FILE__ << '@' << __LINE__
 #define QLOG_INFO()  \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::InfoLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::InfoLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::InfoLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::InfoLevel).stream() << __FILE__ << '@' << __LINE__
 #define QLOG_WARN()  \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::WarnLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::WarnLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::WarnLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::WarnLevel).stream() << __FILE__ << '@' << __LINE__
 #define QLOG_ERROR() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::ErrorLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::ErrorLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::ErrorLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::ErrorLevel).stream() << __FILE__ << '@' << __LINE__
 #define QLOG_FATAL() \
-    if (QsLogging::Logger::instance().loggingLevel() > QsLogging::FatalLevel) {} \
+    if (QS_LOG_MIN_LEVEL > QsLogging::FatalLevel || QsLogging::Logger::instance().loggingLevel() > QsLogging::FatalLevel) {} \
     else QsLogging::Logger::Helper(QsLogging::FatalLevel).stream() << __FILE__ << '@' << __LINE__
 #endif
 
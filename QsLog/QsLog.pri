@@ -1,19 +1,28 @@
 INCLUDEPATH += $$PWD
 #DEFINES += QS_LOG_LINE_NUMBERS    # automatically writes the file and line for each log message
 #DEFINES += QS_LOG_DISABLE         # logging code is replaced with a no-op
-#DEFINES += QS_LOG_SEPARATE_THREAD # messages are queued and written from a separate thread
+#DEFINES += QS_LOG_MIN_LEVEL=2      # statements below info are compiled out, see QsLogLevel.h for the values
+#DEFINES += QS_LOG_SEPARATE_THREAD # messages are queued in a lock-free ring and written from a separate thread
 
 SOURCES += $$PWD/QsLogDest.cpp \
     $$PWD/QsLog.cpp \
     $$PWD/QsLogDestConsole.cpp \
-    $$PWD/QsLogDestFile.cpp
+    $$PWD/QsLogDestFile.cpp \
+    $$PWD/QsLogBinary.cpp \
+    $$PWD/QsLogDestBufferedFile.cpp \
+    $$PWD/QsLogLimit.cpp \
+    $$PWD/QsLogRing.cpp
 
 HEADERS += $$PWD/QSLogDest.h \
     $$PWD/QsLog.h \
     $$PWD/QsLogDestConsole.h \
     $$PWD/QsLogLevel.h \
     $$PWD/QsLogDestFile.h \
-    $$PWD/QsLogDisableForThisFile.h
+    $$PWD/QsLogDisableForThisFile.h \
+    $$PWD/QsLogBinary.h \
+    $$PWD/QsLogDestBufferedFile.h \
+    $$PWD/QsLogLimit.h \
+    $$PWD/QsLogRing.h
 
 OTHER_FILES += \
     $$PWD/QsLogChanges.txt \
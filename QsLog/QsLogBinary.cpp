@@ -0,0 +1,379 @@
+#include "QsLogBinary.h"
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+#include <iostream>
+
+namespace QsLogging
+{
+
+static const char Magic[4] = { 'Q', 'S', 'L', 'B' };
+static const quint8 Version = 1;
+static const char FormatTag = 'F';
+static const char RecordTag = 'R';
+
+// not using Qt::ISODate because we need the milliseconds too
+static const QString fmtDateTime("yyyy-MM-ddThh:mm:ss.zzz");
+
+static const char *const LevelNames[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "" };
+
+template <typename T>
+static void append(QByteArray *buffer, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    buffer->append(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+static void appendString(QByteArray *buffer, const char *text)
+{
+    const quint16 size = static_cast<quint16>(qMin<size_t>(text ? std::strlen(text) : 0, 0xffff));
+    append<quint16>(buffer, size);
+    buffer->append(text, size);
+}
+
+BinaryRecord::BinaryRecord(Level level, const char *format, const char *file, int line)
+    : mLevel(level)
+    , mFormat(format)
+    , mFile(file)
+    , mLine(line)
+    , mTimestamp(QDateTime::currentMSecsSinceEpoch())
+    , mSize(0)
+    , mFull(false)
+{
+}
+
+BinaryRecord::~BinaryRecord()
+{
+    Logger::instance().writeBinary(*this);
+}
+
+bool BinaryRecord::reserve(int size)
+{
+    if (mFull)
+        return false;
+    // one byte is always kept for the Truncated marker
+    if (mSize + size > MaxPayload - 1) {
+        mPayload[mSize++] = Truncated;
+        mFull = true;
+        return false;
+    }
+    return true;
+}
+
+BinaryRecord& BinaryRecord::putInt(Type type, qint64 value)
+{
+    const int size = (type == Int32 || type == UInt32) ? 4 : 8;
+    if (!reserve(1 + size))
+        return *this;
+    mPayload[mSize++] = static_cast<uchar>(type);
+    if (size == 4)
+        qToLittleEndian<quint32>(static_cast<quint32>(value), mPayload + mSize);
+    else
+        qToLittleEndian<quint64>(static_cast<quint64>(value), mPayload + mSize);
+    mSize += size;
+    return *this;
+}
+
+BinaryRecord& BinaryRecord::operator<<(double value)
+{
+    if (!reserve(1 + 8))
+        return *this;
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    mPayload[mSize++] = Double;
+    qToLittleEndian<quint64>(bits, mPayload + mSize);
+    mSize += 8;
+    return *this;
+}
+
+BinaryRecord& BinaryRecord::operator<<(const char *value)
+{
+    return putString(QByteArray::fromRawData(value, value ? static_cast<int>(std::strlen(value)) : 0));
+}
+
+BinaryRecord& BinaryRecord::operator<<(const QString& value)
+{
+    return putString(value.toUtf8());
+}
+
+BinaryRecord& BinaryRecord::putString(const QByteArray& utf8)
+{
+    const int size = qMin(utf8.size(), static_cast<int>(MaxString));
+    if (!reserve(2 + size))
+        return *this;
+    mPayload[mSize++] = String;
+    mPayload[mSize++] = static_cast<uchar>(size);
+    std::memcpy(mPayload + mSize, utf8.constData(), size);
+    mSize += size;
+    return *this;
+}
+
+
+BinaryFileDestination::BinaryFileDestination(const QString& filePath)
+    : mStart(QDateTime::currentMSecsSinceEpoch())
+    , mLastFlush(mStart)
+{
+    mBuffer.reserve(BlockSize * 2);
+    mFile.setFileName(filePath);
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        std::cerr << "QsLog: could not open binary log file " << qPrintable(filePath);
+        return;
+    }
+    mBuffer.append(Magic, sizeof(Magic));
+    append<quint8>(&mBuffer, Version);
+    mBuffer.append(3, '\0');
+    append<qint64>(&mBuffer, mStart);
+}
+
+BinaryFileDestination::~BinaryFileDestination()
+{
+    flush();
+}
+
+quint16 BinaryFileDestination::formatId(const BinaryRecord& record)
+{
+    QHash<const char*, quint16>::const_iterator it = mFormats.constFind(record.format());
+    if (it != mFormats.constEnd())
+        return it.value();
+
+    const quint16 id = static_cast<quint16>(mFormats.size());
+    mFormats.insert(record.format(), id);
+    mBuffer.append(FormatTag);
+    append<quint16>(&mBuffer, id);
+    append<quint16>(&mBuffer, static_cast<quint16>(record.line()));
+    appendString(&mBuffer, record.format());
+    appendString(&mBuffer, record.file());
+    return id;
+}
+
+void BinaryFileDestination::write(const BinaryRecord& record)
+{
+    QMutexLocker lock(&mMutex);
+    if (!mFile.isOpen())
+        return;
+
+    const quint16 id = formatId(record);
+    mBuffer.append(RecordTag);
+    append<quint16>(&mBuffer, id);
+    append<quint8>(&mBuffer, static_cast<quint8>(record.level()));
+    append<quint32>(&mBuffer, static_cast<quint32>(qMax(Q_INT64_C(0), record.timestamp() - mStart)));
+    append<quint8>(&mBuffer, static_cast<quint8>(record.payloadSize()));
+    mBuffer.append(reinterpret_cast<const char*>(record.payload()), record.payloadSize());
+
+    if (mBuffer.size() >= BlockSize || record.timestamp() - mLastFlush >= FlushMs)
+        flushLocked();
+}
+
+void BinaryFileDestination::flush()
+{
+    QMutexLocker lock(&mMutex);
+    flushLocked();
+}
+
+void BinaryFileDestination::flushLocked()
+{
+    mLastFlush = QDateTime::currentMSecsSinceEpoch();
+    if (mBuffer.isEmpty() || !mFile.isOpen())
+        return;
+    if (mFile.write(mBuffer) != mBuffer.size())
+        std::cerr << "QsLog: could not write binary log file " << qPrintable(mFile.fileName());
+    mFile.flush();
+    // keeps the capacity, so appending does not allocate
+    mBuffer.resize(0);
+}
+
+bool BinaryFileDestination::isValid()
+{
+    return mFile.isOpen();
+}
+
+
+BinaryLogReader::BinaryLogReader()
+    : mStart(0)
+{
+}
+
+bool BinaryLogReader::open(const QString& filePath)
+{
+    mFormats.clear();
+    mError.clear();
+    mFile.close();
+    mFile.setFileName(filePath);
+    if (!mFile.open(QFile::ReadOnly)) {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    uchar header[16];
+    if (mFile.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)
+            || std::memcmp(header, Magic, sizeof(Magic)) != 0) {
+        mError = QString("%1 is not a binary log").arg(filePath);
+        return false;
+    }
+    if (header[4] != Version) {
+        mError = QString("%1 has unknown version %2").arg(filePath).arg(header[4]);
+        return false;
+    }
+    mStart = qFromLittleEndian<qint64>(header + 8);
+    return true;
+}
+
+bool BinaryLogReader::readBytes(void *data, int size)
+{
+    if (mFile.read(static_cast<char*>(data), size) == size)
+        return true;
+    mError = QString("%1 ends in the middle of a record").arg(mFile.fileName());
+    return false;
+}
+
+bool BinaryLogReader::readFormat()
+{
+    uchar fixed[4];
+    if (!readBytes(fixed, sizeof(fixed)))
+        return false;
+
+    Format format;
+    format.line = qFromLittleEndian<quint16>(fixed + 2);
+    QByteArray text;
+    for (int i = 0; i < 2; ++i) {
+        uchar sizeBytes[2];
+        if (!readBytes(sizeBytes, sizeof(sizeBytes)))
+            return false;
+        const quint16 size = qFromLittleEndian<quint16>(sizeBytes);
+        text = mFile.read(size);
+        if (text.size() != size) {
+            mError = QString("%1 ends in the middle of a format").arg(mFile.fileName());
+            return false;
+        }
+        if (i == 0)
+            format.format = QString::fromUtf8(text);
+        else
+            format.file = QString::fromUtf8(text);
+    }
+    mFormats.insert(qFromLittleEndian<quint16>(fixed), format);
+    return true;
+}
+
+bool BinaryLogReader::next(QString *line, Level *level)
+{
+    if (!mFile.isOpen() || !mError.isEmpty())
+        return false;
+
+    forever {
+        char tag;
+        if (!mFile.getChar(&tag))
+            return false;
+        if (tag == FormatTag) {
+            if (!readFormat())
+                return false;
+            continue;
+        }
+        if (tag != RecordTag) {
+            mError = QString("%1 has an unknown record at offset %2").arg(mFile.fileName()).arg(mFile.pos() - 1);
+            return false;
+        }
+
+        uchar fixed[8];
+        if (!readBytes(fixed, sizeof(fixed)))
+            return false;
+        const quint16 id = qFromLittleEndian<quint16>(fixed);
+        const int recordLevel = qMin<int>(fixed[2], OffLevel);
+        const qint64 timestamp = mStart + qFromLittleEndian<quint32>(fixed + 3);
+        const QByteArray payload = mFile.read(fixed[7]);
+        if (payload.size() != fixed[7]) {
+            mError = QString("%1 ends in the middle of a record").arg(mFile.fileName());
+            return false;
+        }
+
+        Format format;
+        if (mFormats.contains(id)) {
+            format = mFormats.value(id);
+        } else {
+            format.format = QString("<unknown format %1>").arg(id);
+            format.line = 0;
+        }
+        *line = QString("%1 %2 %3")
+                .arg(LevelNames[recordLevel], 5)
+                .arg(QDateTime::fromMSecsSinceEpoch(timestamp).toString(fmtDateTime))
+                .arg(render(format, payload));
+        if (level)
+            *level = static_cast<Level>(recordLevel);
+        return true;
+    }
+}
+
+QString BinaryLogReader::render(const Format& format, const QByteArray& payload) const
+{
+    QString text = format.format;
+    const uchar *data = reinterpret_cast<const uchar*>(payload.constData());
+    const int size = payload.size();
+    int pos = 0;
+    while (pos < size) {
+        const int type = data[pos++];
+        // QString::arg fills the lowest placeholder left
+        switch (type) {
+        case BinaryRecord::Int32:
+            if (pos + 4 > size)
+                return text;
+            text = text.arg(static_cast<qint32>(qFromLittleEndian<quint32>(data + pos)));
+            pos += 4;
+            break;
+        case BinaryRecord::UInt32:
+            if (pos + 4 > size)
+                return text;
+            text = text.arg(qFromLittleEndian<quint32>(data + pos));
+            pos += 4;
+            break;
+        case BinaryRecord::Int64:
+            if (pos + 8 > size)
+                return text;
+            text = text.arg(static_cast<qlonglong>(qFromLittleEndian<quint64>(data + pos)));
+            pos += 8;
+            break;
+        case BinaryRecord::UInt64:
+            if (pos + 8 > size)
+                return text;
+            text = text.arg(static_cast<qulonglong>(qFromLittleEndian<quint64>(data + pos)));
+            pos += 8;
+            break;
+        case BinaryRecord::Double: {
+            if (pos + 8 > size)
+                return text;
+            const quint64 bits = qFromLittleEndian<quint64>(data + pos);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            text = text.arg(value);
+            pos += 8;
+            break;
+        }
+        case BinaryRecord::String: {
+            if (pos + 1 > size || pos + 1 + data[pos] > size)
+                return text;
+            const int length = data[pos++];
+            text = text.arg(QString::fromUtf8(reinterpret_cast<const char*>(data + pos), length));
+            pos += length;
+            break;
+        }
+        case BinaryRecord::Truncated:
+            return text + " ...";
+        default:
+            return text + QString(" <unknown argument type %1>").arg(type);
+        }
+    }
+    return text;
+}
+
+QStringList BinaryLogReader::formats() const
+{
+    QList<quint16> ids = mFormats.keys();
+    qSort(ids);
+    QStringList result;
+    foreach (quint16 id, ids) {
+        const Format& format = mFormats[id];
+        result << QString("%1 %2:%3 %4").arg(id).arg(format.file).arg(format.line).arg(format.format);
+    }
+    return result;
+}
+
+} // end namespace
@@ -0,0 +1,188 @@
+#ifndef QSLOGBINARY_H
+#define QSLOGBINARY_H
+
+#include "QsLog.h"
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// Binary structured logging. A QLOG_BIN_* statement records the address of
+// its format string and its arguments as typed binary values, nothing is
+// formatted; qslogdecode (apps/qslogdecode) renders the file to text later.
+//
+//     QLOG_BIN_DEBUG("Sequence gap of %1:%2, %3 lost") << sysid << compid << lost;
+//
+// The format uses QString::arg() placeholders, one per argument in order.
+// Statements are dropped unless a binary destination is set with
+// Logger::setBinaryDestination(), at the level given there.
+//
+// File layout, little endian:
+//   header  "QSLB", u8 version, 3 reserved bytes, i64 start, ms since the epoch
+//   'F'     u16 id, u16 line, u16 n + n bytes format, u16 n + n bytes file,
+//           written the first time a format is used
+//   'R'     u16 format id, u8 level, u32 ms since start, u8 n + n bytes of
+//           arguments, each a u8 type followed by its value; strings are
+//           u8 n + n bytes of UTF-8
+
+namespace QsLogging
+{
+
+class BinaryRecord
+{
+public:
+    enum { MaxPayload = 96, MaxString = 32 };
+    enum Type {
+        Int32 = 1,
+        UInt32,
+        Int64,
+        UInt64,
+        Double,
+        String,
+        Truncated   //!< marks that arguments did not fit, has no value
+    };
+
+    BinaryRecord(Level level, const char *format, const char *file, int line);
+    //! hands the record to the binary destination
+    ~BinaryRecord();
+
+    BinaryRecord& operator<<(bool value) { return putInt(UInt32, value ? 1 : 0); }
+    BinaryRecord& operator<<(char value) { return putInt(Int32, value); }
+    BinaryRecord& operator<<(signed char value) { return putInt(Int32, value); }
+    BinaryRecord& operator<<(unsigned char value) { return putInt(UInt32, value); }
+    BinaryRecord& operator<<(short value) { return putInt(Int32, value); }
+    BinaryRecord& operator<<(unsigned short value) { return putInt(UInt32, value); }
+    BinaryRecord& operator<<(int value) { return putInt(Int32, value); }
+    BinaryRecord& operator<<(unsigned int value) { return putInt(UInt32, value); }
+    BinaryRecord& operator<<(long value) { return putInt(Int64, value); }
+    BinaryRecord& operator<<(unsigned long value) { return putInt(UInt64, value); }
+    BinaryRecord& operator<<(qint64 value) { return putInt(Int64, value); }
+    BinaryRecord& operator<<(quint64 value) { return putInt(UInt64, static_cast<qint64>(value)); }
+    BinaryRecord& operator<<(float value) { return operator<<(static_cast<double>(value)); }
+    BinaryRecord& operator<<(double value);
+    BinaryRecord& operator<<(const char *value);
+    BinaryRecord& operator<<(const QString& value);
+
+    Level level() const { return mLevel; }
+    const char *format() const { return mFormat; }
+    const char *file() const { return mFile; }
+    int line() const { return mLine; }
+    qint64 timestamp() const { return mTimestamp; }
+    const uchar *payload() const { return mPayload; }
+    int payloadSize() const { return mSize; }
+
+private:
+    BinaryRecord(const BinaryRecord&);
+    BinaryRecord& operator=(const BinaryRecord&);
+
+    BinaryRecord& putInt(Type type, qint64 value);
+    BinaryRecord& putString(const QByteArray& utf8);
+    bool reserve(int size);
+
+    Level mLevel;
+    const char *mFormat;
+    const char *mFile;
+    int mLine;
+    qint64 mTimestamp;
+    int mSize;
+    bool mFull;
+    uchar mPayload[MaxPayload];
+};
+
+//! Receives the binary records, called on the logging thread
+class BinaryDestination
+{
+public:
+    virtual ~BinaryDestination() {}
+    virtual void write(const BinaryRecord& record) = 0;
+    virtual void flush() = 0;
+    virtual bool isValid() = 0;
+};
+
+//! Writes records to a file in the layout above, in blocks of BlockSize
+//! or at least once a second while records come in
+class BinaryFileDestination : public BinaryDestination
+{
+public:
+    enum { BlockSize = 16384, FlushMs = 1000 };
+
+    explicit BinaryFileDestination(const QString& filePath);
+    virtual ~BinaryFileDestination();
+    virtual void write(const BinaryRecord& record);
+    virtual void flush();
+    virtual bool isValid();
+
+private:
+    quint16 formatId(const BinaryRecord& record);
+    void flushLocked();
+
+    QMutex mMutex;
+    QFile mFile;
+    QByteArray mBuffer;
+    QHash<const char*, quint16> mFormats;
+    qint64 mStart;
+    qint64 mLastFlush;
+};
+
+//! Reads a binary log back and renders its records as text lines, the
+//! same layout as the text destinations write
+class BinaryLogReader
+{
+public:
+    BinaryLogReader();
+
+    bool open(const QString& filePath);
+    //! The next record as text, false at the end of the file or on an error
+    bool next(QString *line, Level *level = 0);
+    //! Empty unless the file was not a binary log or is corrupt
+    QString errorString() const { return mError; }
+    //! Formats seen so far, as "file:line format"
+    QStringList formats() const;
+
+private:
+    struct Format
+    {
+        QString format;
+        QString file;
+        int line;
+    };
+    bool readBytes(void *data, int size);
+    bool readFormat();
+    QString render(const Format& format, const QByteArray& payload) const;
+
+    QFile mFile;
+    qint64 mStart;
+    QHash<quint16, Format> mFormats;
+    QString mError;
+};
+
+} // end namespace
+
+//! Build time minimum level of the binary statements, the text one unless set
+#ifndef QS_LOG_BIN_MIN_LEVEL
+#define QS_LOG_BIN_MIN_LEVEL QS_LOG_MIN_LEVEL
+#endif
+
+#ifndef QS_LOG_DISABLE
+#define QLOG_BIN_TRACE(format) \
+    if (QS_LOG_BIN_MIN_LEVEL > QsLogging::TraceLevel || QsLogging::Logger::instance().binaryLoggingLevel() > QsLogging::TraceLevel) {} \
+    else QsLogging::BinaryRecord(QsLogging::TraceLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_DEBUG(format) \
+    if (QS_LOG_BIN_MIN_LEVEL > QsLogging::DebugLevel || QsLogging::Logger::instance().binaryLoggingLevel() > QsLogging::DebugLevel) {} \
+    else QsLogging::BinaryRecord(QsLogging::DebugLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_INFO(format) \
+    if (QS_LOG_BIN_MIN_LEVEL > QsLogging::InfoLevel || QsLogging::Logger::instance().binaryLoggingLevel() > QsLogging::InfoLevel) {} \
+    else QsLogging::BinaryRecord(QsLogging::InfoLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_WARN(format) \
+    if (QS_LOG_BIN_MIN_LEVEL > QsLogging::WarnLevel || QsLogging::Logger::instance().binaryLoggingLevel() > QsLogging::WarnLevel) {} \
+    else QsLogging::BinaryRecord(QsLogging::WarnLevel, format, __FILE__, __LINE__)
+#else
+#define QLOG_BIN_TRACE(format) if (1) {} else QsLogging::BinaryRecord(QsLogging::TraceLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_DEBUG(format) if (1) {} else QsLogging::BinaryRecord(QsLogging::DebugLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_INFO(format)  if (1) {} else QsLogging::BinaryRecord(QsLogging::InfoLevel, format, __FILE__, __LINE__)
+#define QLOG_BIN_WARN(format)  if (1) {} else QsLogging::BinaryRecord(QsLogging::WarnLevel, format, __FILE__, __LINE__)
+#endif
+
+#endif // QSLOGBINARY_H
@@ -26,6 +26,8 @@
 #include "QsLogDest.h"
 #include "QsLogDestConsole.h"
 #include "QsLogDestFile.h"
+#include "QsLogDestBufferedFile.h"
+#include "QsLogBinary.h"
 #include <QString>
 
 namespace QsLogging
@@ -59,4 +61,16 @@ DestinationPtr DestinationFactory::MakeDebugOutputDestination()
     return DestinationPtr(new DebugOutputDestination);
 }
 
+DestinationPtr DestinationFactory::MakeBufferedFileDestination(const QString& filePath, qint64 sizeInBytesToRotateAfter,
+                                                               int oldLogsToKeep, bool compressOldLogs)
+{
+    return DestinationPtr(new BufferedFileDestination(filePath, sizeInBytesToRotateAfter, oldLogsToKeep,
+                                                      compressOldLogs));
+}
+
+BinaryDestinationPtr DestinationFactory::MakeBinaryFileDestination(const QString& filePath)
+{
+    return BinaryDestinationPtr(new BinaryFileDestination(filePath));
+}
+
 } // end namespace
@@ -40,9 +40,14 @@ public:
     virtual ~Destination(){}
     virtual void write(const QString& message, Level level) = 0;
     virtual bool isValid() = 0; // returns whether the destination was created correctly
+    //! memory held for messages not written yet, for memory accounting
+    virtual qint64 bufferedBytes() { return 0; }
 };
 typedef QSharedPointer<Destination> DestinationPtr;
 
+class BinaryDestination;
+typedef QSharedPointer<BinaryDestination> BinaryDestinationPtr;
+
 //! Creates logging destinations/sinks. The caller will have ownership of 
 //! the newly created destinations.
 class DestinationFactory
@@ -50,6 +55,11 @@ class DestinationFactory
 public:
     static DestinationPtr MakeFileDestination(const QString& filePath, bool enableRotation = false, qint64 sizeInBytesToRotateAfter = 0, int oldLogsToKeep = 0);
     static DestinationPtr MakeDebugOutputDestination();
+    //! Writes and rotates on a background thread, see QsLogDestBufferedFile.h
+    static DestinationPtr MakeBufferedFileDestination(const QString& filePath, qint64 sizeInBytesToRotateAfter = 0,
+                                                      int oldLogsToKeep = 0, bool compressOldLogs = false);
+    //! Binary records of QLOG_BIN_* statements, see QsLogBinary.h
+    static BinaryDestinationPtr MakeBinaryFileDestination(const QString& filePath);
 };
 
 } // end namespace
@@ -0,0 +1,195 @@
+#include "QsLogDestBufferedFile.h"
+#include <QtEndian>
+#include <iostream>
+
+namespace QsLogging
+{
+
+static const char CompressedMagic[4] = { 'Q', 'S', 'L', 'Z' };
+
+BufferedFileDestination::BufferedFileDestination(const QString& filePath, qint64 maxSizeInBytes,
+                                                 int backupCount, bool compressBackups)
+    : mFilePath(filePath)
+    , mMaxSizeInBytes(qMax(Q_INT64_C(0), maxSizeInBytes))
+    , mBackupCount(qBound(0, backupCount, static_cast<int>(MaxBackupCount)))
+    , mCompressBackups(compressBackups)
+    , mFlushNow(false)
+    , mStopping(false)
+    , mDropped(0)
+    , mBackCapacity(0)
+    , mSize(0)
+    , mWriter(this)
+{
+    mFront.reserve(BlockSize * 2);
+    mBack.reserve(BlockSize * 2);
+    mFile.setFileName(filePath);
+    if (!mFile.open(QFile::WriteOnly | QFile::Append)) {
+        std::cerr << "QsLog: could not open log file " << qPrintable(filePath);
+        return;
+    }
+    mSize = mFile.size();
+    mWriter.setObjectName(QLatin1String("QsLogFile"));
+    mWriter.start(QThread::LowPriority);
+}
+
+BufferedFileDestination::~BufferedFileDestination()
+{
+    {
+        QMutexLocker lock(&mMutex);
+        mStopping = true;
+        mWake.wakeOne();
+    }
+    mWriter.wait();
+    mFile.close();
+}
+
+void BufferedFileDestination::write(const QString& message, Level level)
+{
+    const QByteArray utf8 = message.toUtf8();
+    QMutexLocker lock(&mMutex);
+    if (mFront.size() + utf8.size() + 1 > MaxPendingBytes) {
+        ++mDropped;
+        return;
+    }
+    mFront.append(utf8);
+    mFront.append('\n');
+    if (level >= ErrorLevel) {
+        mFlushNow = true;
+        mWake.wakeOne();
+    } else if (mFront.size() >= BlockSize) {
+        mWake.wakeOne();
+    }
+}
+
+bool BufferedFileDestination::isValid()
+{
+    return mFile.isOpen();
+}
+
+qint64 BufferedFileDestination::bufferedBytes()
+{
+    QMutexLocker lock(&mMutex);
+    return mFront.capacity() + qMax(mBackCapacity, static_cast<int>(BlockSize * 2));
+}
+
+void BufferedFileDestination::run()
+{
+    forever {
+        int dropped;
+        bool stopping;
+        {
+            QMutexLocker lock(&mMutex);
+            if (!mStopping && !mFlushNow && mFront.size() < BlockSize)
+                mWake.wait(&mMutex, FlushMs);
+            // both keep their capacity, neither side allocates once warmed up
+            mFront.swap(mBack);
+            mBackCapacity = mBack.capacity();
+            dropped = mDropped;
+            mDropped = 0;
+            mFlushNow = false;
+            stopping = mStopping;
+        }
+        if (dropped) {
+            mBack.append(QString("QsLog: %1 messages dropped, the log file fell behind\n")
+                         .arg(dropped).toUtf8());
+        }
+        writeBlock(mBack);
+        mBack.resize(0);
+        if (stopping)
+            return;
+    }
+}
+
+void BufferedFileDestination::writeBlock(const QByteArray& block)
+{
+    if (block.isEmpty() || !mFile.isOpen())
+        return;
+    if (mFile.write(block) != block.size())
+        std::cerr << "QsLog: could not write log file " << qPrintable(mFilePath);
+    mFile.flush();
+    mSize += block.size();
+    if (mMaxSizeInBytes > 0 && mSize > mMaxSizeInBytes)
+        rotate();
+}
+
+QString BufferedFileDestination::backupName(int index) const
+{
+    return QString("%1.%2%3").arg(mFilePath).arg(index).arg(mCompressBackups ? ".qz" : "");
+}
+
+// Backups are named filename.X, 1 <= X <= mBackupCount, the newest is 1
+void BufferedFileDestination::rotate()
+{
+    mFile.close();
+    if (!mBackupCount) {
+        if (!QFile::remove(mFilePath))
+            std::cerr << "QsLog: backup delete failed " << qPrintable(mFilePath);
+    } else {
+        QFile::remove(backupName(mBackupCount));
+        for (int i = mBackupCount - 1; i >= 1; --i) {
+            if (QFile::exists(backupName(i)) && !QFile::rename(backupName(i), backupName(i + 1))) {
+                std::cerr << "QsLog: could not rename backup " << qPrintable(backupName(i))
+                          << " to " << qPrintable(backupName(i + 1));
+            }
+        }
+        if (mCompressBackups ? compress(mFilePath, backupName(1))
+                             : QFile::rename(mFilePath, backupName(1))) {
+            QFile::remove(mFilePath);
+        } else {
+            std::cerr << "QsLog: could not back up log " << qPrintable(mFilePath)
+                      << " to " << qPrintable(backupName(1));
+        }
+    }
+
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate))
+        std::cerr << "QsLog: could not reopen log file " << qPrintable(mFilePath);
+    mSize = 0;
+}
+
+// "QSLZ", then blocks of a big endian u32 size and that many bytes of qCompress() output
+bool BufferedFileDestination::compress(const QString& source, const QString& target)
+{
+    QFile input(source);
+    const QString partial = target + ".part";
+    QFile output(partial);
+    if (!input.open(QFile::ReadOnly) || !output.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    bool ok = output.write(CompressedMagic, sizeof(CompressedMagic)) == sizeof(CompressedMagic);
+    while (ok && !input.atEnd()) {
+        const QByteArray packed = qCompress(input.read(CompressedBlockSize));
+        uchar size[4];
+        qToBigEndian<quint32>(packed.size(), size);
+        ok = output.write(reinterpret_cast<const char*>(size), sizeof(size)) == sizeof(size)
+                && output.write(packed) == packed.size();
+    }
+    output.close();
+    if (!ok || input.error() != QFile::NoError) {
+        QFile::remove(partial);
+        return false;
+    }
+    QFile::remove(target);
+    return QFile::rename(partial, target);
+}
+
+bool BufferedFileDestination::readCompressed(const QString& filePath, QByteArray *text)
+{
+    QFile input(filePath);
+    if (!input.open(QFile::ReadOnly) || input.read(sizeof(CompressedMagic)) != QByteArray(CompressedMagic, sizeof(CompressedMagic)))
+        return false;
+
+    text->clear();
+    while (!input.atEnd()) {
+        uchar size[4];
+        if (input.read(reinterpret_cast<char*>(size), sizeof(size)) != sizeof(size))
+            return false;
+        const QByteArray packed = input.read(qFromBigEndian<quint32>(size));
+        const QByteArray block = qUncompress(packed);
+        if (block.isEmpty())
+            return false;
+        text->append(block);
+    }
+    return true;
+}
+
+} // end namespace
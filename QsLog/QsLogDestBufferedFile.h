@@ -0,0 +1,87 @@
+#ifndef QSLOGDESTBUFFEREDFILE_H
+#define QSLOGDESTBUFFEREDFILE_H
+
+#include "QsLogDest.h"
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace QsLogging
+{
+
+//! File sink that never touches the file on the logging thread.
+//! Messages are appended to a memory block; a writer thread writes the
+//! block in one call when it reaches BlockSize, at least every FlushMs, and
+//! right away after an error or fatal message. The same thread rotates the
+//! file once it exceeds the maximum size and, if asked to, deflates the
+//! backups to name.N.qz (see readCompressed()), so a slow flash device only
+//! ever delays that thread. A backlog beyond MaxPendingBytes is dropped and
+//! reported in the log rather than growing without bound.
+class BufferedFileDestination : public Destination
+{
+public:
+    enum {
+        BlockSize = 64 * 1024,
+        FlushMs = 1000,
+        MaxPendingBytes = 1024 * 1024,
+        MaxBackupCount = 10,
+        CompressedBlockSize = 256 * 1024
+    };
+
+    //! maxSizeInBytes 0 never rotates. The file is appended to.
+    BufferedFileDestination(const QString& filePath, qint64 maxSizeInBytes, int backupCount,
+                            bool compressBackups);
+    virtual ~BufferedFileDestination();
+
+    virtual void write(const QString& message, Level level);
+    virtual bool isValid();
+    //! capacity of both blocks, they are kept once grown
+    virtual qint64 bufferedBytes();
+
+    //! Inflates a name.N.qz backup, false if the file is not one or damaged
+    static bool readCompressed(const QString& filePath, QByteArray *text);
+
+private:
+    class Writer : public QThread
+    {
+    public:
+        explicit Writer(BufferedFileDestination *destination) : mDestination(destination) {}
+    protected:
+        virtual void run() { mDestination->run(); }
+    private:
+        BufferedFileDestination *mDestination;
+    };
+
+    void run();
+    void writeBlock(const QByteArray& block);
+    void rotate();
+    bool compress(const QString& source, const QString& target);
+    QString backupName(int index) const;
+
+    QString mFilePath;
+    qint64 mMaxSizeInBytes;
+    int mBackupCount;
+    bool mCompressBackups;
+
+    // producer side, under mMutex
+    QMutex mMutex;
+    QWaitCondition mWake;
+    QByteArray mFront;
+    bool mFlushNow;
+    bool mStopping;
+    int mDropped;
+    int mBackCapacity;      //!< of mBack, taken at the swap
+
+    // writer thread only
+    QFile mFile;
+    QByteArray mBack;
+    qint64 mSize;
+    Writer mWriter;
+};
+
+} // end namespace
+
+#endif // QSLOGDESTBUFFEREDFILE_H
@@ -19,4 +19,9 @@
 #define QLOG_ERROR() if (1) {} else qDebug()
 #define QLOG_FATAL() if (1) {} else qDebug()
 
+#ifdef QSLOGLIMIT_H
+#undef QLOG_LIMITED
+#define QLOG_LIMITED(level, module) if (1) {} else qDebug()
+#endif
+
 #endif // QSLOGDISABLEFORTHISFILE_H
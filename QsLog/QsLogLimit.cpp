@@ -0,0 +1,85 @@
+#include "QsLogLimit.h"
+#include <QElapsedTimer>
+
+namespace QsLogging
+{
+
+// Started during static initialisation, so every thread reads the same clock
+// without a race. LogModule constructors never read it, modules in other
+// files may be constructed first.
+static QElapsedTimer s_clock;
+static bool startClock()
+{
+    s_clock.start();
+    return true;
+}
+static const bool s_clockStarted = startClock();
+
+// Microseconds wrap after 71 minutes as an int; the arrival time is only
+// ever compared with now by difference, which survives the wrap as long as
+// the burst window is far shorter than that
+static inline int nowUs()
+{
+    return static_cast<int>(static_cast<quint32>(s_clock.nsecsElapsed() / 1000));
+}
+
+static inline int distance(int a, int b)
+{
+    return static_cast<int>(static_cast<quint32>(a) - static_cast<quint32>(b));
+}
+
+LogModule::LogModule(const char *name, int perSecond, int burst)
+    : mName(name)
+    , mIntervalUs(0)
+    , mBurstUs(0)
+    , mArrival(0)
+    , mSuppressed(0)
+{
+    Q_UNUSED(s_clockStarted);
+    setRate(perSecond, burst);
+}
+
+void LogModule::setRate(int perSecond, int burst)
+{
+    const int interval = perSecond > 0 ? 1000000 / perSecond : 0;
+    mIntervalUs.store(interval);
+    mBurstUs.store(interval * qMax(0, burst - 1));
+}
+
+bool LogModule::allow()
+{
+    const int interval = mIntervalUs.load();
+    if (!interval)
+        return true;
+
+    const int burst = mBurstUs.load();
+    const int now = nowUs();
+    int arrival = mArrival.load();
+    forever {
+        // A bucket that refilled completely starts again from now. So does
+        // an arrival time further ahead than a full burst can push it, which
+        // is one from before the first statement or from a clock lap ago.
+        const int ahead = distance(arrival, now);
+        const int start = (ahead < 0 || ahead > burst + interval) ? now : arrival;
+        if (distance(start, now) > burst) {
+            mSuppressed.fetchAndAddRelaxed(1);
+            return false;
+        }
+        if (mArrival.testAndSetRelaxed(arrival, start + interval))
+            break;
+        arrival = mArrival.load();
+    }
+    return true;
+}
+
+bool LogModule::allowAndReport()
+{
+    if (!allow())
+        return false;
+    const int suppressed = takeSuppressed();
+    if (suppressed && Logger::instance().loggingLevel() <= WarnLevel)
+        Logger::Helper(WarnLevel).stream() << "Log module" << mName << "over its rate limit," << suppressed << "messages suppressed";
+    return true;
+}
+
+} // end namespace
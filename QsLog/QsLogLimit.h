@@ -0,0 +1,54 @@
+#ifndef QSLOGLIMIT_H
+#define QSLOGLIMIT_H
+
+#include "QsLog.h"
+#include <QAtomicInt>
+
+namespace QsLogging
+{
+
+//! Rate limit shared by the QLOG_*_LIMITED statements of one module.
+//! A token bucket of 'burst' tokens refilled at 'perSecond', kept as the
+//! theoretical arrival time of the next message in one atomic, so a check
+//! is a clock read and a compare and swap. Statements over the limit are
+//! counted; the QLOG_*_LIMITED macros report them in one line once the
+//! module may log again.
+//!
+//!     static QsLogging::LogModule statusLog("STATUSTEXT", 2, 10);
+//!     QLOG_INFO_LIMITED(statusLog) << "STATUSTEXT" << text;
+class LogModule
+{
+public:
+    LogModule(const char *name, int perSecond, int burst);
+
+    //! perSecond 0 never limits
+    void setRate(int perSecond, int burst);
+    //! Takes a token, false and counted as suppressed if the module is over its limit
+    bool allow();
+    //! allow(), and logs how many were suppressed before this one
+    bool allowAndReport();
+    //! Suppressed since the last call
+    int takeSuppressed() { return mSuppressed.fetchAndStoreRelaxed(0); }
+    const char *name() const { return mName; }
+
+private:
+    const char *mName;
+    QAtomicInt mIntervalUs;     //!< between tokens, 0 for no limit
+    QAtomicInt mBurstUs;        //!< how far ahead of now the arrival time may run
+    QAtomicInt mArrival;        //!< theoretical arrival time, microseconds of a wrapping clock
+    QAtomicInt mSuppressed;
+};
+
+} // end namespace
+
+#define QLOG_LIMITED(level, module) \
+    if (QS_LOG_MIN_LEVEL > level || QsLogging::Logger::instance().loggingLevel() > level || !module.allowAndReport()) {} \
+    else QsLogging::Logger::Helper(level).stream()
+
+#define QLOG_TRACE_LIMITED(module) QLOG_LIMITED(QsLogging::TraceLevel, module)
+#define QLOG_DEBUG_LIMITED(module) QLOG_LIMITED(QsLogging::DebugLevel, module)
+#define QLOG_INFO_LIMITED(module)  QLOG_LIMITED(QsLogging::InfoLevel, module)
+#define QLOG_WARN_LIMITED(module)  QLOG_LIMITED(QsLogging::WarnLevel, module)
+#define QLOG_ERROR_LIMITED(module) QLOG_LIMITED(QsLogging::ErrorLevel, module)
+
+#endif // QSLOGLIMIT_H
@@ -0,0 +1,76 @@
+#include "QsLogRing.h"
+#include <cstring>
+
+namespace QsLogging
+{
+
+// Each slot's sequence tells producers and the reader whose turn it is:
+// equal to the push position it is free, one past it it holds a record the
+// reader may take, Capacity past it the reader is done and the slot is free
+// for the next lap. Positions wrap, so they are only ever compared by
+// difference.
+static inline int distance(int a, int b)
+{
+    return static_cast<int>(static_cast<quint32>(a) - static_cast<quint32>(b));
+}
+
+LogRing::LogRing() :
+    mPushPos(0),
+    mPopPos(0),
+    mDropped(0)
+{
+    for (int i = 0; i < Capacity; ++i) {
+        mRecords[i].sequence.store(i);
+        mRecords[i].timestamp = 0;
+        mRecords[i].level = InfoLevel;
+        mRecords[i].length = 0;
+        mRecords[i].truncated = false;
+    }
+}
+
+bool LogRing::push(Level level, qint64 timestamp, const QString& message)
+{
+    int pos = mPushPos.load();
+    LogRecord *record;
+    forever {
+        record = &mRecords[pos & (Capacity - 1)];
+        const int diff = distance(record->sequence.loadAcquire(), pos);
+        if (diff == 0) {
+            if (mPushPos.testAndSetRelaxed(pos, pos + 1))
+                break;
+            pos = mPushPos.load();
+        } else if (diff < 0) {
+            // the reader has not freed this slot from the previous lap
+            mDropped.fetchAndAddRelaxed(1);
+            return false;
+        } else {
+            pos = mPushPos.load();
+        }
+    }
+
+    record->timestamp = timestamp;
+    record->level = level;
+    record->length = qMin(message.size(), static_cast<int>(LogRecord::MaxChars));
+    record->truncated = message.size() > LogRecord::MaxChars;
+    std::memcpy(record->text, message.constData(), record->length * sizeof(QChar));
+    record->sequence.storeRelease(pos + 1);
+    return true;
+}
+
+bool LogRing::pop(Level *level, qint64 *timestamp, QString *message)
+{
+    LogRecord *record = &mRecords[mPopPos & (Capacity - 1)];
+    if (distance(record->sequence.loadAcquire(), mPopPos + 1) != 0)
+        return false;
+
+    *level = record->level;
+    *timestamp = record->timestamp;
+    message->setUnicode(record->text, record->length);
+    if (record->truncated)
+        message->append(QString::fromLatin1("..."));
+    record->sequence.storeRelease(mPopPos + Capacity);
+    ++mPopPos;
+    return true;
+}
+
+} // end namespace
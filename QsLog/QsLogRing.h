@@ -0,0 +1,58 @@
+#ifndef QSLOGRING_H
+#define QSLOGRING_H
+
+#include "QsLogLevel.h"
+#include <QAtomicInt>
+#include <QChar>
+#include <QString>
+#include <QtGlobal>
+
+namespace QsLogging
+{
+
+//! Fixed size log record, the text is cut at MaxChars
+struct LogRecord
+{
+    enum { MaxChars = 240 };
+
+    QAtomicInt sequence;    //!< Slot state, see LogRing
+    qint64 timestamp;       //!< Milliseconds since the epoch, formatted by the reader
+    Level level;
+    int length;
+    bool truncated;
+    QChar text[MaxChars];
+};
+
+//! Bounded multi producer, single consumer queue of log records.
+//! All slots are allocated up front; a producer claims one with a single
+//! compare and swap and copies its message in, nothing is allocated and no
+//! lock is taken. When the ring is full the message is counted and dropped
+//! rather than waiting for the reader.
+class LogRing
+{
+public:
+    enum { Capacity = 512 }; // power of two
+
+    LogRing();
+
+    //! Any thread. Returns false and counts a drop if the ring is full.
+    bool push(Level level, qint64 timestamp, const QString& message);
+    //! Reader thread only. Copies the oldest record out, false if empty.
+    bool pop(Level *level, qint64 *timestamp, QString *message);
+
+    //! Messages dropped since the start
+    int dropped() const { return mDropped.load(); }
+
+private:
+    LogRing(const LogRing&);
+    LogRing& operator=(const LogRing&);
+
+    LogRecord mRecords[Capacity];
+    QAtomicInt mPushPos;
+    int mPopPos;
+    QAtomicInt mDropped;
+};
+
+} // end namespace
+
+#endif // QSLOGRING_H
@@ -0,0 +1,375 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ReplayBenchmark
+ *          See ReplayBenchmark.h
+ *
+ */
+
+#include "ReplayBenchmark.h"
+#include "PrimaryFlightDisplayQML.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkMessageRef.h"
+#include "TlogReplayLink.h"
+#include "Arena.h"
+#include "QsLog.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMetaMethod>
+#include <QMutex>
+#include <QPair>
+#include <QQuickView>
+#include <QtAlgorithms>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <malloc.h>
+#endif
+
+// QtCore's signal spy hook from qobject_p.h, as QtTest's signal dumper uses it
+struct QSignalSpyCallbackSet
+{
+    typedef void (*BeginCallback)(QObject *caller, int signal_or_method_index, void **argv);
+    typedef void (*EndCallback)(QObject *caller, int signal_or_method_index);
+    BeginCallback signal_begin_callback, slot_begin_callback;
+    EndCallback signal_end_callback, slot_end_callback;
+};
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+void Q_CORE_EXPORT qt_register_signal_spy_callbacks(QSignalSpyCallbackSet *callback_set);
+#else
+void Q_CORE_EXPORT qt_register_signal_spy_callbacks(const QSignalSpyCallbackSet &callback_set);
+#endif
+
+typedef QPair<const QMetaObject*, int> SignalKey;
+static QMutex signalMutex;
+static QHash<SignalKey, qint64> signalCounts;
+
+// Any thread, on every emission. The index counts signals only
+static void countSignal(QObject *caller, int signalIndex, void **)
+{
+    QMutexLocker locker(&signalMutex);
+    signalCounts[SignalKey(caller->metaObject(), signalIndex)]++;
+}
+
+static void registerSignalSpy(bool enabled)
+{
+    static QSignalSpyCallbackSet callbacks;
+    callbacks.signal_begin_callback = enabled ? countSignal : 0;
+    callbacks.slot_begin_callback = 0;
+    callbacks.signal_end_callback = 0;
+    callbacks.slot_end_callback = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    qt_register_signal_spy_callbacks(&callbacks);
+#else
+    qt_register_signal_spy_callbacks(callbacks);
+#endif
+}
+
+// moc lists each class's signals before its other methods, so the n-th
+// signal of the whole method table is signal index n
+static QString signalName(const QMetaObject *metaObject, int signalIndex)
+{
+    int signal = 0;
+    for (int i = 0; i < metaObject->methodCount(); ++i)
+    {
+        QMetaMethod method = metaObject->method(i);
+        if (method.methodType() == QMetaMethod::Signal && signal++ == signalIndex)
+        {
+            return QString("%1::%2").arg(metaObject->className(), QString::fromLatin1(method.methodSignature()));
+        }
+    }
+    return QString("%1::<signal %2>").arg(metaObject->className()).arg(signalIndex);
+}
+
+static bool countGreater(const QPair<qint64, QString> &a, const QPair<qint64, QString> &b)
+{
+    return a.first > b.first;
+}
+
+QStringList ReplayBenchmark::arguments(int argc, char **argv)
+{
+    QStringList result;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--benchmark-replay") != 0)
+        {
+            continue;
+        }
+        for (int j = i + 1; j < argc && j <= i + 2 && qstrncmp(argv[j], "--", 2) != 0; ++j)
+        {
+            result << QString::fromLocal8Bit(argv[j]);
+        }
+        if (result.isEmpty())
+        {
+            // The flag without a log still selects the mode, start() reports it
+            result << QString();
+        }
+        break;
+    }
+    return result;
+}
+
+ReplayBenchmark::ReplayBenchmark(PrimaryFlightDisplayQML *display, const QStringList &arguments, QObject *parent) :
+    QObject(parent),
+    m_display(display),
+    m_tlog(arguments.value(0)),
+    m_video(arguments.value(1)),
+    m_linkId(-1),
+    m_startCpuUsec(0),
+    m_startHeap(0),
+    m_startArenaAllocations(0),
+    m_startArenaBlocks(0),
+    m_startMessageAllocations(0),
+    m_startParsedReads(0)
+{
+    for (int i = 0; i <= MaxFrameMs; ++i)
+    {
+        m_frameBuckets[i].store(0);
+    }
+    m_frames.store(0);
+    m_drainTimer.setInterval(DrainPollMs);
+    connect(&m_drainTimer, SIGNAL(timeout()), this, SLOT(checkDrained()));
+}
+
+ReplayBenchmark::~ReplayBenchmark()
+{
+    registerSignalSpy(false);
+}
+
+QString ReplayBenchmark::pipelineFor(const QString &video)
+{
+    if (video.contains('!'))
+    {
+        return video;
+    }
+    QString demuxer = QFileInfo(video).suffix().toLower() == "mkv" ? "matroskademux" : "qtdemux";
+    return QString("filesrc location=\"%1\" ! %2 ! h264parse ! avdec_h264").arg(QDir::fromNativeSeparators(video), demuxer);
+}
+
+bool ReplayBenchmark::start()
+{
+    if (m_tlog.isEmpty() || !QFile::exists(m_tlog))
+    {
+        fprintf(stderr, "usage: --benchmark-replay <tlog> [video file or pipeline]\n");
+        return false;
+    }
+
+    if (m_video.isEmpty())
+    {
+        m_display->setVideoEnabled(false);
+    }
+    else
+    {
+        m_display->setPipelineString(pipelineFor(m_video));
+        // An unsynchronized sink, decoded as fast as it goes rather than at the pace of the file
+        m_display->player()->setLatencyProfile("balanced");
+        m_display->player()->play();
+    }
+    connect(m_display->view(), SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()), Qt::DirectConnection);
+
+    MAVLinkIngest *ingest = LinkManager::instance()->getMavlinkProtocol()->ingest();
+    m_startThreads = threadTimes();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    m_startCpuUsec = qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    m_startHeap = heapBytes();
+    m_startArenaAllocations = Arena::allocations();
+    m_startArenaBlocks = Arena::heapBlocks();
+    m_startMessageAllocations = MAVLinkMessageRef::heapAllocations();
+    m_startParsedReads = ingest ? ingest->parsedReads() : 0;
+    registerSignalSpy(true);
+    m_wall.start();
+
+    m_linkId = LinkManager::instance()->addTlogReplay(m_tlog);
+    TlogReplayLink *link = LinkManager::instance()->getReplayLink(m_linkId);
+    if (!link || !link->isConnected())
+    {
+        registerSignalSpy(false);
+        fprintf(stderr, "Cannot replay %s\n", qPrintable(m_tlog));
+        return false;
+    }
+    link->setSpeed(0);
+    connect(link, SIGNAL(replayFinished()), this, SLOT(onReplayFinished()));
+    QLOG_INFO() << "ReplayBenchmark: replaying" << m_tlog << (m_video.isEmpty() ? "without video" : "with video") << m_video;
+    return true;
+}
+
+// Render thread
+void ReplayBenchmark::onFrameSwapped()
+{
+    if (!m_frameClock.isValid())
+    {
+        m_frameClock.start();
+        return;
+    }
+    m_frameBuckets[qMin<qint64>(m_frameClock.restart(), MaxFrameMs)].fetchAndAddRelaxed(1);
+    m_frames.fetchAndAddRelaxed(1);
+}
+
+void ReplayBenchmark::onReplayFinished()
+{
+    m_drainTimer.start();
+}
+
+void ReplayBenchmark::checkDrained()
+{
+    MAVLinkIngest *ingest = LinkManager::instance()->getMavlinkProtocol()->ingest();
+    if (ingest && (ingest->pendingReads() > 0 || ingest->pendingMessages() > 0))
+    {
+        return;
+    }
+    m_drainTimer.stop();
+    report();
+    QCoreApplication::exit(0);
+}
+
+QMap<QString, ReplayBenchmark::ThreadTime> ReplayBenchmark::threadTimes()
+{
+    QMap<QString, ThreadTime> times;
+#ifdef Q_OS_LINUX
+    QDir tasks("/proc/self/task");
+    foreach (const QString &tid, tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QFile statFile(tasks.filePath(tid + "/stat"));
+        if (!statFile.open(QIODevice::ReadOnly))
+        {
+            continue;
+        }
+        QByteArray stat = statFile.readAll();
+        // "tid (name) state ..." and the name may hold spaces or parentheses
+        int open = stat.indexOf('(');
+        int close = stat.lastIndexOf(')');
+        if (open < 0 || close < open)
+        {
+            continue;
+        }
+        QString name = QString::fromUtf8(stat.mid(open + 1, close - open - 1));
+        QList<QByteArray> fields = stat.mid(close + 2).split(' ');
+        // utime and stime are fields 14 and 15, the 12th and 13th after the name
+        if (fields.size() < 13)
+        {
+            continue;
+        }
+        ThreadTime &time = times[name];
+        time.ticks += fields[11].toLongLong() + fields[12].toLongLong();
+        time.threads++;
+    }
+#endif
+    return times;
+}
+
+qint64 ReplayBenchmark::heapBytes()
+{
+#ifdef Q_OS_LINUX
+    struct mallinfo info = mallinfo();
+    return qint64(info.uordblks) + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+void ReplayBenchmark::report()
+{
+    registerSignalSpy(false);
+    const qint64 wallMs = m_wall.elapsed();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const qint64 cpuUsec = qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec - m_startCpuUsec;
+    MAVLinkIngest *ingest = LinkManager::instance()->getMavlinkProtocol()->ingest();
+
+    printf("benchmark-replay %s%s%s\n", qPrintable(m_tlog), m_video.isEmpty() ? "" : " video ", qPrintable(m_video));
+    printf("  wall %lld ms, cpu %lld ms, %d reads parsed, %d messages dropped\n",
+           wallMs, cpuUsec / 1000, ingest ? ingest->parsedReads() - m_startParsedReads : 0,
+           ingest ? ingest->droppedMessages() : 0);
+
+    printf("cpu per thread (ms)\n");
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    QMap<QString, ThreadTime> threads = threadTimes();
+    for (QMap<QString, ThreadTime>::const_iterator it = threads.constBegin(); it != threads.constEnd(); ++it)
+    {
+        const qint64 ticks = it.value().ticks - m_startThreads.value(it.key()).ticks;
+        if (ticks > 0 && ticksPerSecond > 0)
+        {
+            printf("  %-24s %8lld  (%d threads)\n", qPrintable(it.key()), ticks * 1000 / ticksPerSecond, it.value().threads);
+        }
+    }
+
+    const int frames = m_frames.load();
+    printf("frames %d", frames);
+    if (frames > 0)
+    {
+        static const int percentiles[] = { 50, 90, 95, 99, 100 };
+        int bucket = 0;
+        int seen = m_frameBuckets[0].load();
+        for (int i = 0; i < int(sizeof(percentiles) / sizeof(percentiles[0])); ++i)
+        {
+            const int wanted = (frames * percentiles[i] + 99) / 100;
+            while (seen < wanted && bucket < MaxFrameMs)
+            {
+                seen += m_frameBuckets[++bucket].load();
+            }
+            printf(", p%d %d ms", percentiles[i], bucket);
+        }
+        int longFrames = 0;
+        for (int ms = 17; ms <= MaxFrameMs; ++ms)
+        {
+            longFrames += m_frameBuckets[ms].load();
+        }
+        printf(", %d over 16 ms", longFrames);
+    }
+    printf("\n");
+
+    printf("allocations: arena %d (%d heap blocks), message records off the pool %d, heap %+lld bytes\n",
+           Arena::allocations() - m_startArenaAllocations, Arena::heapBlocks() - m_startArenaBlocks,
+           MAVLinkMessageRef::heapAllocations() - m_startMessageAllocations, heapBytes() - m_startHeap);
+
+    QList<QPair<qint64, QString> > signals_;
+    qint64 totalSignals = 0;
+    {
+        QMutexLocker locker(&signalMutex);
+        for (QHash<SignalKey, qint64>::const_iterator it = signalCounts.constBegin(); it != signalCounts.constEnd(); ++it)
+        {
+            signals_.append(qMakePair(it.value(), signalName(it.key().first, it.key().second)));
+            totalSignals += it.value();
+        }
+        signalCounts.clear();
+    }
+    qSort(signals_.begin(), signals_.end(), countGreater);
+    printf("signals %lld, most emitted\n", totalSignals);
+    for (int i = 0; i < signals_.size() && i < ReportedSignals; ++i)
+    {
+        printf("  %10lld  %s\n", signals_[i].first, qPrintable(signals_[i].second));
+    }
+    // One line to compare between builds
+    printf("score %lld ms wall, %lld ms cpu\n", wallMs, cpuUsec / 1000);
+    fflush(stdout);
+}
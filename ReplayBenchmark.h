@@ -0,0 +1,117 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ReplayBenchmark
+ *          --benchmark-replay <tlog> [video]: the whole application run on
+ *          a recorded flight as fast as it goes, with a report of CPU time
+ *          per thread, frame times, allocations and signal counts printed
+ *          when the log ends. Same log, same build, comparable numbers.
+ *
+ */
+
+#ifndef REPLAYBENCHMARK_H
+#define REPLAYBENCHMARK_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QStringList>
+#include <QTimer>
+
+class PrimaryFlightDisplayQML;
+
+/**
+ * @brief Drives and measures one benchmark run
+ *
+ * The tlog is replayed at speed 0 through LinkManager, so it takes the
+ * normal ingest path, and the HUD renders into an offscreen window (see
+ * main.cpp). A video argument is either a pipeline or an .mp4/.mkv file
+ * of H.264, decoded unsynchronized; without one the video is off and only
+ * telemetry and HUD are measured.
+ *
+ * The run ends once the replay finished and the ingest queues are empty.
+ * CPU time is read per thread name from /proc, so threads that ended
+ * during the run are missing. Signal counting hooks every emission of the
+ * process and costs a lock per signal; it is part of what is measured and
+ * is the same in every run.
+ */
+class ReplayBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        MaxFrameMs = 250,       ///< Histogram range, longer frames land in the last bucket
+        DrainPollMs = 50,
+        ReportedSignals = 20
+    };
+
+    /** @brief Arguments after "--benchmark-replay", empty if the flag is not in argv */
+    static QStringList arguments(int argc, char **argv);
+
+    ReplayBenchmark(PrimaryFlightDisplayQML *display, const QStringList &arguments, QObject *parent = 0);
+    ~ReplayBenchmark();
+
+    /** @brief Opens the replay and starts measuring, false if the log cannot be opened.
+     *  The application exits with 0 after the report */
+    bool start();
+
+private slots:
+    void onReplayFinished();
+    void checkDrained();
+    void onFrameSwapped();
+
+private:
+    struct ThreadTime
+    {
+        ThreadTime() : ticks(0), threads(0) {}
+        qint64 ticks;
+        int threads;
+    };
+    static QMap<QString, ThreadTime> threadTimes();
+    static qint64 heapBytes();
+    static QString pipelineFor(const QString &video);
+    void report();
+
+    PrimaryFlightDisplayQML *m_display;
+    QString m_tlog;
+    QString m_video;
+    int m_linkId;
+    QTimer m_drainTimer;
+    QElapsedTimer m_wall;
+    qint64 m_startCpuUsec;
+    QMap<QString, ThreadTime> m_startThreads;
+    qint64 m_startHeap;
+    int m_startArenaAllocations;
+    int m_startArenaBlocks;
+    int m_startMessageAllocations;
+    int m_startParsedReads;
+
+    // Render thread
+    QElapsedTimer m_frameClock;
+    QAtomicInt m_frames;
+    QAtomicInt m_frameBuckets[MaxFrameMs + 1];
+};
+
+#endif // REPLAYBENCHMARK_H
@@ -0,0 +1,428 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SettingsStore
+ *          See SettingsStore.h
+ *
+ */
+
+#include "SettingsStore.h"
+#include "QsLog.h"
+#include <QSettings>
+#include <QTimer>
+
+SettingsStore* SettingsStore::instance()
+{
+    // A thread of its own, it cannot have the application as parent
+    static SettingsStore* _instance = 0;
+    if(_instance == 0)
+    {
+        _instance = new SettingsStore();
+    }
+    return _instance;
+}
+
+SettingsStore::SettingsStore() :
+    m_loaded(false),
+    m_stopped(false),
+    m_settings(NULL),
+    m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    moveToThread(this);
+    start(QThread::LowPriority);
+}
+
+void SettingsStore::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_settings = new QSettings();
+    QMap<QString, QVariant> values;
+    foreach (const QString &key, m_settings->allKeys())
+    {
+        values.insert(key, m_settings->value(key));
+    }
+    {
+        QMutexLocker lock(&m_mutex);
+        m_values = values;
+        m_loaded = true;
+        m_loadedCondition.wakeAll();
+    }
+    QLOG_DEBUG() << "Settings loaded," << values.size() << "keys in" << timer.elapsed() << "ms";
+
+    exec();
+
+    flush();
+    delete m_settings;
+    m_settings = NULL;
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    QMutexLocker lock(&m_mutex);
+    while (!m_loaded)
+    {
+        m_loadedCondition.wait(&m_mutex);
+    }
+    return m_values.value(key, defaultValue);
+}
+
+bool SettingsStore::contains(const QString &key) const
+{
+    QMutexLocker lock(&m_mutex);
+    while (!m_loaded)
+    {
+        m_loadedCondition.wait(&m_mutex);
+    }
+    return m_values.contains(key);
+}
+
+QStringList SettingsStore::childKeys(const QString &group) const
+{
+    const QString prefix = group.isEmpty() ? QString() : group + "/";
+    QMutexLocker lock(&m_mutex);
+    while (!m_loaded)
+    {
+        m_loadedCondition.wait(&m_mutex);
+    }
+    QStringList keys;
+    for (QMap<QString, QVariant>::const_iterator it = m_values.lowerBound(prefix);
+         it != m_values.constEnd() && it.key().startsWith(prefix); ++it)
+    {
+        const QString rest = it.key().mid(prefix.size());
+        if (!rest.contains('/'))
+        {
+            keys << rest;
+        }
+    }
+    return keys;
+}
+
+QStringList SettingsStore::childGroups(const QString &group) const
+{
+    const QString prefix = group.isEmpty() ? QString() : group + "/";
+    QMutexLocker lock(&m_mutex);
+    while (!m_loaded)
+    {
+        m_loadedCondition.wait(&m_mutex);
+    }
+    QStringList groups;
+    for (QMap<QString, QVariant>::const_iterator it = m_values.lowerBound(prefix);
+         it != m_values.constEnd() && it.key().startsWith(prefix); ++it)
+    {
+        const QString rest = it.key().mid(prefix.size());
+        const int slash = rest.indexOf('/');
+        // Keys are sorted, a group's keys are next to each other
+        if (slash > 0 && (groups.isEmpty() || groups.last() != rest.left(slash)))
+        {
+            groups << rest.left(slash);
+        }
+    }
+    return groups;
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    bool direct;
+    {
+        QMutexLocker lock(&m_mutex);
+        while (!m_loaded)
+        {
+            m_loadedCondition.wait(&m_mutex);
+        }
+        QMap<QString, QVariant>::iterator it = m_values.find(key);
+        if (it != m_values.end() && it.value() == value)
+        {
+            return;
+        }
+        m_values.insert(key, value);
+        direct = m_stopped;
+        if (!direct)
+        {
+            m_pending.append(qMakePair(key, value));
+        }
+    }
+    if (direct)
+    {
+        QSettings settings;
+        settings.setValue(key, value);
+        return;
+    }
+    QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+}
+
+void SettingsStore::remove(const QString &key)
+{
+    bool direct;
+    {
+        QMutexLocker lock(&m_mutex);
+        while (!m_loaded)
+        {
+            m_loadedCondition.wait(&m_mutex);
+        }
+        removeLocked(key);
+        direct = m_stopped;
+        if (!direct)
+        {
+            m_pending.append(qMakePair(key, QVariant()));
+        }
+    }
+    if (direct)
+    {
+        QSettings settings;
+        settings.remove(key);
+        return;
+    }
+    QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+}
+
+void SettingsStore::removeLocked(const QString &key)
+{
+    if (key.isEmpty())
+    {
+        m_values.clear();
+        return;
+    }
+    m_values.remove(key);
+    const QString prefix = key + "/";
+    QMap<QString, QVariant>::iterator it = m_values.lowerBound(prefix);
+    while (it != m_values.end() && it.key().startsWith(prefix))
+    {
+        it = m_values.erase(it);
+    }
+}
+
+void SettingsStore::flushSoon()
+{
+    QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+}
+
+void SettingsStore::scheduleFlush()
+{
+    if (!m_firstPending.isValid())
+    {
+        m_firstPending.start();
+    }
+    // Each change restarts the debounce, but a steady stream still gets written
+    const qint64 remaining = MaxDelayMs - m_firstPending.elapsed();
+    m_flushTimer->start(static_cast<int>(qBound(Q_INT64_C(0), remaining, static_cast<qint64>(DebounceMs))));
+}
+
+void SettingsStore::flush()
+{
+    m_flushTimer->stop();
+    m_firstPending.invalidate();
+    QList<QPair<QString, QVariant> > pending;
+    {
+        QMutexLocker lock(&m_mutex);
+        pending.swap(m_pending);
+    }
+    if (pending.isEmpty() || !m_settings)
+    {
+        return;
+    }
+    for (int i = 0; i < pending.size(); ++i)
+    {
+        if (pending[i].second.isValid())
+        {
+            m_settings->setValue(pending[i].first, pending[i].second);
+        }
+        else
+        {
+            m_settings->remove(pending[i].first);
+        }
+    }
+    m_settings->sync();
+}
+
+void SettingsStore::shutdown()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    quit();
+    wait();
+    // Whatever came in while the thread flushed its last batch
+    QList<QPair<QString, QVariant> > pending;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopped = true;
+        pending.swap(m_pending);
+    }
+    if (!pending.isEmpty())
+    {
+        QSettings settings;
+        for (int i = 0; i < pending.size(); ++i)
+        {
+            if (pending[i].second.isValid())
+            {
+                settings.setValue(pending[i].first, pending[i].second);
+            }
+            else
+            {
+                settings.remove(pending[i].first);
+            }
+        }
+    }
+}
+
+
+StoredSettings::StoredSettings() :
+    m_store(SettingsStore::instance())
+{
+}
+
+QString StoredSettings::prefix() const
+{
+    QString result;
+    foreach (const Level &level, m_levels)
+    {
+        result += level.name + "/";
+        if (level.array && level.index >= 0)
+        {
+            result += QString::number(level.index + 1) + "/";
+        }
+    }
+    return result;
+}
+
+QString StoredSettings::key(const QString &name) const
+{
+    return prefix() + name;
+}
+
+void StoredSettings::beginGroup(const QString &prefix)
+{
+    Level level;
+    level.name = prefix;
+    level.array = false;
+    level.writing = false;
+    level.index = -1;
+    level.size = 0;
+    m_levels.append(level);
+}
+
+void StoredSettings::endGroup()
+{
+    if (!m_levels.isEmpty() && !m_levels.last().array)
+    {
+        m_levels.removeLast();
+    }
+}
+
+int StoredSettings::beginReadArray(const QString &prefix)
+{
+    Level level;
+    level.name = prefix;
+    level.array = true;
+    level.writing = false;
+    level.index = -1;
+    level.size = m_store->value(key(prefix + "/size")).toInt();
+    m_levels.append(level);
+    return level.size;
+}
+
+void StoredSettings::beginWriteArray(const QString &prefix, int size)
+{
+    Level level;
+    level.name = prefix;
+    level.array = true;
+    level.writing = true;
+    level.index = -1;
+    level.size = qMax(0, size);
+    m_levels.append(level);
+}
+
+void StoredSettings::setArrayIndex(int i)
+{
+    if (m_levels.isEmpty() || !m_levels.last().array)
+    {
+        return;
+    }
+    m_levels.last().index = i;
+    if (m_levels.last().writing)
+    {
+        m_levels.last().size = qMax(m_levels.last().size, i + 1);
+    }
+}
+
+void StoredSettings::endArray()
+{
+    if (m_levels.isEmpty() || !m_levels.last().array)
+    {
+        return;
+    }
+    const Level level = m_levels.takeLast();
+    if (level.writing)
+    {
+        setValue(level.name + "/size", level.size);
+    }
+}
+
+QVariant StoredSettings::value(const QString &name, const QVariant &defaultValue) const
+{
+    return m_store->value(key(name), defaultValue);
+}
+
+void StoredSettings::setValue(const QString &name, const QVariant &value)
+{
+    m_store->setValue(key(name), value);
+}
+
+bool StoredSettings::contains(const QString &name) const
+{
+    return m_store->contains(key(name));
+}
+
+void StoredSettings::remove(const QString &name)
+{
+    QString full = key(name);
+    if (full.endsWith('/'))
+    {
+        full.chop(1);
+    }
+    m_store->remove(full);
+}
+
+QStringList StoredSettings::childKeys() const
+{
+    QString group = prefix();
+    group.chop(1);
+    return m_store->childKeys(group);
+}
+
+QStringList StoredSettings::childGroups() const
+{
+    QString group = prefix();
+    group.chop(1);
+    return m_store->childGroups(group);
+}
+
+void StoredSettings::sync()
+{
+    m_store->flushSoon();
+}
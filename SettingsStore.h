@@ -0,0 +1,153 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SettingsStore
+ *          The application settings held in memory. The store reads every
+ *          key once, on its own thread, when it is created at start up.
+ *          Reads are then served from memory. Writes change the copy at
+ *          once and reach QSettings together, DebounceMs after the first
+ *          change of a burst and never later than MaxDelayMs, written and
+ *          synced on the store thread. Toggling an option therefore never
+ *          waits for the flash.
+ *
+ *          StoredSettings gives the QSettings group and array calls on top,
+ *          so loadSettings()/saveSettings() code keeps its shape.
+ *
+ */
+
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QThread>
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVariant>
+#include <QStringList>
+#include <QElapsedTimer>
+
+class QTimer;
+class QSettings;
+
+class SettingsStore : public QThread
+{
+    Q_OBJECT
+public:
+    enum { DebounceMs = 500, MaxDelayMs = 2000 };
+
+    /** @brief Created early in main(), the load starts right away */
+    static SettingsStore* instance();
+
+    /** @brief Any thread, waits for the initial load the first time */
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    bool contains(const QString &key) const;
+    /** @brief Keys directly below group, "" for the top level */
+    QStringList childKeys(const QString &group) const;
+    QStringList childGroups(const QString &group) const;
+
+    /** @brief Any thread, persisted after the debounce */
+    void setValue(const QString &key, const QVariant &value);
+    /** @brief Removes key and everything below it */
+    void remove(const QString &key);
+    /** @brief Persist what is pending without waiting for the debounce */
+    void flushSoon();
+
+    /** @brief Write everything pending and stop the thread, at exit. Later
+     *  writes go to QSettings directly on the calling thread */
+    void shutdown();
+
+protected:
+    void run();
+
+private slots:
+    void scheduleFlush();
+    void flush();
+
+private:
+    SettingsStore();
+    void waitLoaded() const;
+    void removeLocked(const QString &key);
+
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_loadedCondition;
+    bool m_loaded;
+    bool m_stopped;
+    QMap<QString, QVariant> m_values;
+    /** Changes not yet in QSettings, in order. An invalid value removes the key and its children */
+    QList<QPair<QString, QVariant> > m_pending;
+
+    // Store thread only
+    QSettings *m_settings;
+    QTimer *m_flushTimer;
+    QElapsedTimer m_firstPending;   ///< Started by the first change since the last flush
+};
+
+/**
+ * @brief QSettings calls over the SettingsStore
+ *
+ * Supports the subset the settings code uses: groups, read and write
+ * arrays, value, setValue, contains, remove, childKeys and childGroups.
+ * Array layout is the one QSettings writes, "name/size" and "name/1/key",
+ * so settings written by either read back in the other.
+ */
+class StoredSettings
+{
+public:
+    StoredSettings();
+
+    void beginGroup(const QString &prefix);
+    void endGroup();
+    int beginReadArray(const QString &prefix);
+    void beginWriteArray(const QString &prefix, int size = -1);
+    void setArrayIndex(int i);
+    void endArray();
+
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    void setValue(const QString &key, const QVariant &value);
+    bool contains(const QString &key) const;
+    void remove(const QString &key);
+    QStringList childKeys() const;
+    QStringList childGroups() const;
+    /** @brief Asks for the pending changes to be written soon, does not wait */
+    void sync();
+
+private:
+    struct Level
+    {
+        QString name;
+        bool array;
+        bool writing;
+        int index;
+        int size;       ///< Write arrays, the highest index set plus one
+    };
+    QString prefix() const;
+    QString key(const QString &name) const;
+
+    SettingsStore *m_store;
+    QList<Level> m_levels;
+};
+
+#endif // SETTINGSSTORE_H
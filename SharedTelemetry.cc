@@ -0,0 +1,187 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SharedTelemetry
+ *          See SharedTelemetry.h
+ *
+ */
+
+#include "SharedTelemetry.h"
+#include "SharedTelemetryLayout.h"
+#include "QsLog.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef Q_OS_LINUX
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
+#ifdef Q_OS_ANDROID
+#include <sys/ioctl.h>
+#include <linux/ashmem.h>
+#endif
+
+static const char * const SegmentName = "qmlplayer-telemetry";
+
+#ifdef Q_OS_ANDROID
+static const char * const ProviderClass = "org/qtproject/qt5/android/bindings/TelemetryShareProvider";
+
+// Called on a binder thread of the provider
+static jint nativeSharedFd(JNIEnv *, jclass, jint which)
+{
+    return SharedTelemetry::instance()->duplicate(static_cast<SharedTelemetry::Descriptor>(which));
+}
+
+void SharedTelemetry::registerNatives(JNIEnv *env)
+{
+    static JNINativeMethod methods[] = {
+        { const_cast<char*>("nativeSharedFd"), const_cast<char*>("(I)I"), reinterpret_cast<void*>(nativeSharedFd) }
+    };
+    jclass provider = env->FindClass(ProviderClass);
+    if (!provider || env->RegisterNatives(provider, methods, sizeof(methods) / sizeof(methods[0])) < 0)
+    {
+        QLOG_ERROR() << "Cannot register the shared telemetry native";
+        env->ExceptionClear();
+    }
+}
+#endif
+
+SharedTelemetry *SharedTelemetry::instance()
+{
+    // Created by the first publish or provider call, lives until the process ends
+    static SharedTelemetry *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new SharedTelemetry();
+    }
+    return _instance;
+}
+
+SharedTelemetry::SharedTelemetry() :
+    m_segmentFd(-1),
+    m_notifyFd(-1),
+    m_segment(0),
+    m_pending(false)
+{
+    const long long size = sharedTelemetrySize();
+    m_segmentFd = createSegment(size);
+    if (m_segmentFd < 0)
+    {
+        return;
+    }
+    void *segment = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_segmentFd, 0);
+    if (segment == MAP_FAILED)
+    {
+        QLOG_WARN() << "SharedTelemetry: cannot map the segment";
+        close(m_segmentFd);
+        m_segmentFd = -1;
+        return;
+    }
+#ifdef Q_OS_ANDROID
+    // Later mappings, the consumers', can only read
+    ioctl(m_segmentFd, ASHMEM_SET_PROT_MASK, PROT_READ);
+#endif
+#ifdef Q_OS_LINUX
+    m_notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+    // Fresh ashmem and memfd pages are zero, every slot starts at sequence 0
+    SharedTelemetryHeader *header = static_cast<SharedTelemetryHeader*>(segment);
+    header->headerSize = sizeof(SharedTelemetryHeader);
+    header->slotSize = sizeof(SharedTelemetrySlot);
+    header->stateSize = sizeof(VehicleState);
+    header->vehicleCount = SharedTelemetryVehicles;
+    header->version = SharedTelemetryVersion;
+    __atomic_store_n(&header->magic, static_cast<uint32_t>(SharedTelemetryMagic), __ATOMIC_RELEASE);
+    m_segment = segment;
+    QLOG_INFO() << "SharedTelemetry: publishing" << size << "bytes for companion apps";
+}
+
+int SharedTelemetry::createSegment(long long size)
+{
+#if defined(Q_OS_ANDROID)
+    const int fd = open("/dev/ashmem", O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        QLOG_WARN() << "SharedTelemetry: no ashmem";
+        return -1;
+    }
+    if (ioctl(fd, ASHMEM_SET_NAME, SegmentName) < 0 || ioctl(fd, ASHMEM_SET_SIZE, static_cast<size_t>(size)) < 0)
+    {
+        QLOG_WARN() << "SharedTelemetry: cannot size the ashmem region";
+        close(fd);
+        return -1;
+    }
+    return fd;
+#elif defined(Q_OS_LINUX) && defined(SYS_memfd_create)
+    const int fd = static_cast<int>(syscall(SYS_memfd_create, SegmentName, 1 /* MFD_CLOEXEC */));
+    if (fd < 0 || ftruncate(fd, size) < 0)
+    {
+        QLOG_WARN() << "SharedTelemetry: cannot create the memfd";
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(size);
+    return -1;
+#endif
+}
+
+void SharedTelemetry::publish(int sysid, const VehicleState &state)
+{
+    if (!m_segment)
+    {
+        return;
+    }
+    sharedTelemetryWrite(m_segment, sysid, state);
+    m_pending = true;
+}
+
+void SharedTelemetry::notify()
+{
+    if (!m_pending)
+    {
+        return;
+    }
+    m_pending = false;
+    SharedTelemetryHeader *header = static_cast<SharedTelemetryHeader*>(m_segment);
+    __atomic_add_fetch(&header->publications, 1, __ATOMIC_RELEASE);
+    if (m_notifyFd >= 0)
+    {
+        // Non blocking, a counter nobody reads saturates rather than stalling ingest
+        const uint64_t one = 1;
+        const ssize_t written = write(m_notifyFd, &one, sizeof(one));
+        Q_UNUSED(written);
+    }
+}
+
+int SharedTelemetry::duplicate(Descriptor which) const
+{
+    const int fd = which == StateDescriptor ? m_segmentFd : m_notifyFd;
+    return fd >= 0 ? dup(fd) : -1;
+}
@@ -0,0 +1,86 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SharedTelemetry
+ *          Publishes every vehicle's VehicleState into a shared memory
+ *          segment for companion apps, in the layout of
+ *          SharedTelemetryLayout.h, and signals an eventfd once per parsed
+ *          read that changed it. Android hands both descriptors out
+ *          through TelemetryShareProvider.java.
+ *
+ */
+
+#ifndef SHAREDTELEMETRY_H
+#define SHAREDTELEMETRY_H
+
+#include "VehicleState.h"
+#ifdef Q_OS_ANDROID
+#include <jni.h>
+#endif
+
+/**
+ * @brief Writer of the shared segment
+ *
+ * The segment is an ashmem region on Android and a memfd on desktop Linux,
+ * elsewhere it is not created and publish() does nothing. Only the ingest
+ * thread publishes and notifies; readers never take a lock and the writer
+ * never waits for them, a reader that loses the race retries as with
+ * VehicleStateSnapshot.
+ */
+class SharedTelemetry
+{
+public:
+    enum Descriptor { StateDescriptor = 0, NotifyDescriptor = 1 };
+
+    static SharedTelemetry *instance();
+
+    bool isValid() const { return m_segment != 0; }
+
+    /** @brief Ingest thread only. Copies state into the slot of sysid */
+    void publish(int sysid, const VehicleState &state);
+    /** @brief Ingest thread only. Signals the eventfd if anything was published since the last call */
+    void notify();
+
+    /** @brief A new descriptor of the segment or the eventfd, the caller owns it. -1 if there is none */
+    int duplicate(Descriptor which) const;
+
+#ifdef Q_OS_ANDROID
+    /** @brief Register TelemetryShareProvider's natives, from JNI_OnLoad */
+    static void registerNatives(JNIEnv *env);
+#endif
+
+private:
+    SharedTelemetry();
+    SharedTelemetry(const SharedTelemetry&);
+    SharedTelemetry& operator=(const SharedTelemetry&);
+
+    int createSegment(long long size);
+
+    int m_segmentFd;
+    int m_notifyFd;
+    void *m_segment;
+    bool m_pending;     ///< Ingest thread only
+};
+
+#endif // SHAREDTELEMETRY_H
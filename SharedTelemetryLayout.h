@@ -0,0 +1,136 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SharedTelemetryLayout
+ *          Layout of the shared memory segment SharedTelemetry publishes the
+ *          vehicle state in, and the seqlock both sides use on it. Plain C++
+ *          without Qt; a companion app includes this and VehicleState.h,
+ *          maps the segment read only and calls sharedTelemetryRead().
+ *
+ *          The segment and an eventfd come from the content provider
+ *          content://<package>.telemetry/state and .../notify (see
+ *          TelemetryShareProvider.java). The eventfd counts publications,
+ *          a consumer may block in read() on it instead of polling.
+ *
+ */
+
+#ifndef SHAREDTELEMETRYLAYOUT_H
+#define SHAREDTELEMETRYLAYOUT_H
+
+#include <stdint.h>
+#include <string.h>
+#include "VehicleState.h"
+
+enum {
+    SharedTelemetryMagic = 0x53545051,     ///< "QPTS" as read little endian
+    SharedTelemetryVersion = 1,
+    SharedTelemetryVehicles = 256,         ///< One slot per system ID
+    SharedTelemetryMaxReadAttempts = 4
+};
+
+/** @brief At offset 0. A consumer checks magic, version and the sizes before it reads slots */
+struct SharedTelemetryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;            ///< Offset of the first slot
+    uint32_t slotSize;              ///< Slot stride
+    uint32_t stateSize;             ///< sizeof(VehicleState) of the publisher
+    uint32_t vehicleCount;
+    uint32_t vehicles[SharedTelemetryVehicles / 32];    ///< Bit per system ID that has published
+    uint32_t publications;          ///< Incremented with every notification
+    uint32_t reserved;
+};
+
+/** @brief One vehicle. sequence is odd while the publisher writes state */
+struct SharedTelemetrySlot
+{
+    uint32_t sequence;
+    uint32_t reserved;
+    VehicleState state;
+};
+
+inline int64_t sharedTelemetrySize()
+{
+    return sizeof(SharedTelemetryHeader) + int64_t(SharedTelemetryVehicles) * sizeof(SharedTelemetrySlot);
+}
+
+inline SharedTelemetrySlot *sharedTelemetrySlot(void *segment, int sysid)
+{
+    SharedTelemetryHeader *header = static_cast<SharedTelemetryHeader*>(segment);
+    return reinterpret_cast<SharedTelemetrySlot*>(static_cast<char*>(segment) + header->headerSize
+                                                  + sysid * header->slotSize);
+}
+
+/** @brief Publisher side, one writer per segment */
+inline void sharedTelemetryWrite(void *segment, int sysid, const VehicleState &state)
+{
+    SharedTelemetryHeader *header = static_cast<SharedTelemetryHeader*>(segment);
+    SharedTelemetrySlot *slot = sharedTelemetrySlot(segment, sysid);
+    const uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    // The odd sequence is visible before any byte of the state changes
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->state, &state, sizeof(state));
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_or_fetch(&header->vehicles[sysid / 32], 1u << (sysid % 32), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Consumer side. Copies the state of sysid, false if it never
+ * published or no consistent copy was had in SharedTelemetryMaxReadAttempts,
+ * which only happens while the publisher writes that very slot.
+ */
+inline bool sharedTelemetryRead(const void *segment, int sysid, VehicleState *state)
+{
+    const SharedTelemetryHeader *header = static_cast<const SharedTelemetryHeader*>(segment);
+    if (header->magic != SharedTelemetryMagic || header->version != SharedTelemetryVersion
+            || header->stateSize != sizeof(VehicleState) || sysid < 0 || sysid >= int(header->vehicleCount))
+    {
+        return false;
+    }
+    if (!(__atomic_load_n(&header->vehicles[sysid / 32], __ATOMIC_ACQUIRE) & (1u << (sysid % 32))))
+    {
+        return false;
+    }
+    const SharedTelemetrySlot *slot = sharedTelemetrySlot(const_cast<void*>(segment), sysid);
+    for (int attempt = 0; attempt < SharedTelemetryMaxReadAttempts; attempt++)
+    {
+        const uint32_t before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1)
+        {
+            continue;
+        }
+        memcpy(state, &slot->state, sizeof(*state));
+        // The copy's loads complete before the sequence is read again
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // SHAREDTELEMETRYLAYOUT_H
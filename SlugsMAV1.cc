@@ -1,4 +1,5 @@
 #include "SlugsMAV1.h"
+#include "MAVLinkDispatcher.h"
 
 
 
@@ -38,119 +39,155 @@ SlugsMAV::SlugsMAV(MAVLinkProtocol* mavlink, int id) :
 #endif
 }
 
+#ifdef MAVLINK_ENABLED_SLUGS
+// The messages SLUGS keeps for its widgets, on top of UAS's handling
+static const int slugsMessages[] = {
+    MAVLINK_MSG_ID_RAW_IMU,
+    MAVLINK_MSG_ID_BOOT,
+    MAVLINK_MSG_ID_ATTITUDE,
+    MAVLINK_MSG_ID_GPS_RAW,
+    MAVLINK_MSG_ID_CPU_LOAD,
+    MAVLINK_MSG_ID_AIR_DATA,
+    MAVLINK_MSG_ID_SENSOR_BIAS,
+    MAVLINK_MSG_ID_DIAGNOSTIC,
+    MAVLINK_MSG_ID_SLUGS_NAVIGATION,
+    MAVLINK_MSG_ID_DATA_LOG,
+    MAVLINK_MSG_ID_GPS_DATE_TIME,
+    MAVLINK_MSG_ID_MID_LVL_CMDS,
+    MAVLINK_MSG_ID_CTRL_SRFC_PT,
+    MAVLINK_MSG_ID_SLUGS_ACTION,
+    MAVLINK_MSG_ID_SCALED_IMU,
+    MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
+    MAVLINK_MSG_ID_RC_CHANNELS_RAW,
+    -1
+};
+#endif
+
+void SlugsMAV::subscribe(MAVLinkDispatcher *dispatcher, const int *msgids)
+{
+    UAS::subscribe(dispatcher, msgids);
+#ifdef MAVLINK_ENABLED_SLUGS
+    if (msgids) {
+        return;
+    }
+    for (const int *msgid = slugsMessages; *msgid != -1; ++msgid) {
+        dispatcher->subscribe(UAS::getUASID(), *msgid,
+                              &MAVLinkDispatcher::call<SlugsMAV, &SlugsMAV::receiveSlugsMessage>, this);
+    }
+#endif
+}
+
 /**
- * This function is called by MAVLink once a complete, uncorrupted (CRC check valid)
- * mavlink packet is received.
+ * Called by the dispatcher for the slugsMessages of this MAV, after UAS
+ * handled the default message set.
  *
  * @param link Hardware link the message came from (e.g. /dev/ttyUSB0 or UDP port).
  *             messages can be sent back to the system via this link
  * @param message MAVLink message, as received from the MAVLink protocol stack
  */
-void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
+void SlugsMAV::receiveSlugsMessage(LinkInterface* link, mavlink_message_t message)
 {
-    UAS::receiveMessage(link, message);// Let UAS handle the default message set
+    Q_UNUSED(link);
+#ifdef MAVLINK_ENABLED_SLUGS
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_RAW_IMU:
+        mavlink_msg_raw_imu_decode(&message, &mlRawImuData);
+        break;
 
-    if (message.sysid == uasId) {
-#ifdef MAVLINK_ENABLED_SLUGS// Handle your special messages mavlink_message_t* msg = &message;
+    case MAVLINK_MSG_ID_BOOT:
+        mavlink_msg_boot_decode(&message,&mlBoot);
+        emit slugsBootMsg(uasId, mlBoot);
+        break;
 
-        switch (message.msgid) {
-        case MAVLINK_MSG_ID_RAW_IMU:
-            mavlink_msg_raw_imu_decode(&message, &mlRawImuData);
-            break;
+    case MAVLINK_MSG_ID_ATTITUDE:
+        mavlink_msg_attitude_decode(&message, &mlAttitude);
+        break;
 
-        case MAVLINK_MSG_ID_BOOT:
-            mavlink_msg_boot_decode(&message,&mlBoot);
-            emit slugsBootMsg(uasId, mlBoot);
-            break;
+    case MAVLINK_MSG_ID_GPS_RAW:
+        mavlink_msg_gps_raw_decode(&message, &mlGpsData);
+        break;
 
-        case MAVLINK_MSG_ID_ATTITUDE:
-            mavlink_msg_attitude_decode(&message, &mlAttitude);
-            break;
+    case MAVLINK_MSG_ID_CPU_LOAD:       //170
+        mavlink_msg_cpu_load_decode(&message,&mlCpuLoadData);
+        break;
 
-        case MAVLINK_MSG_ID_GPS_RAW:
-            mavlink_msg_gps_raw_decode(&message, &mlGpsData);
-            break;
+    case MAVLINK_MSG_ID_AIR_DATA:       //171
+        mavlink_msg_air_data_decode(&message,&mlAirData);
+        break;
 
-        case MAVLINK_MSG_ID_CPU_LOAD:       //170
-            mavlink_msg_cpu_load_decode(&message,&mlCpuLoadData);
-            break;
+    case MAVLINK_MSG_ID_SENSOR_BIAS:    //172
+        mavlink_msg_sensor_bias_decode(&message,&mlSensorBiasData);
+        break;
 
-        case MAVLINK_MSG_ID_AIR_DATA:       //171
-            mavlink_msg_air_data_decode(&message,&mlAirData);
-            break;
+    case MAVLINK_MSG_ID_DIAGNOSTIC:     //173
+        mavlink_msg_diagnostic_decode(&message,&mlDiagnosticData);
+        break;
 
-        case MAVLINK_MSG_ID_SENSOR_BIAS:    //172
-            mavlink_msg_sensor_bias_decode(&message,&mlSensorBiasData);
-            break;
+    case MAVLINK_MSG_ID_SLUGS_NAVIGATION://176
+        mavlink_msg_slugs_navigation_decode(&message,&mlNavigation);
+        break;
 
-        case MAVLINK_MSG_ID_DIAGNOSTIC:     //173
-            mavlink_msg_diagnostic_decode(&message,&mlDiagnosticData);
-            break;
+    case MAVLINK_MSG_ID_DATA_LOG:       //177
+        mavlink_msg_data_log_decode(&message,&mlDataLog);
+        break;
 
-        case MAVLINK_MSG_ID_SLUGS_NAVIGATION://176
-            mavlink_msg_slugs_navigation_decode(&message,&mlNavigation);
-            break;
+    case MAVLINK_MSG_ID_GPS_DATE_TIME:    //179
+        mavlink_msg_gps_date_time_decode(&message,&mlGpsDateTime);
+        break;
 
-        case MAVLINK_MSG_ID_DATA_LOG:       //177
-            mavlink_msg_data_log_decode(&message,&mlDataLog);
-            break;
+    case MAVLINK_MSG_ID_MID_LVL_CMDS:     //180
+        mavlink_msg_mid_lvl_cmds_decode(&message, &mlMidLevelCommands);
+        break;
 
-        case MAVLINK_MSG_ID_GPS_DATE_TIME:    //179
-            mavlink_msg_gps_date_time_decode(&message,&mlGpsDateTime);
-            break;
+    case MAVLINK_MSG_ID_CTRL_SRFC_PT:     //181
+        mavlink_msg_ctrl_srfc_pt_decode(&message, &mlPassthrough);
+        break;
 
-        case MAVLINK_MSG_ID_MID_LVL_CMDS:     //180
-            mavlink_msg_mid_lvl_cmds_decode(&message, &mlMidLevelCommands);
-            break;
+    case MAVLINK_MSG_ID_SLUGS_ACTION:     //183
+        mavlink_msg_slugs_action_decode(&message, &mlAction);
+        break;
 
-        case MAVLINK_MSG_ID_CTRL_SRFC_PT:     //181
-            mavlink_msg_ctrl_srfc_pt_decode(&message, &mlPassthrough);
-            break;
+    case MAVLINK_MSG_ID_SCALED_IMU:
+        mavlink_msg_scaled_imu_decode(&message, &mlScaled);
+        break;
 
-        case MAVLINK_MSG_ID_SLUGS_ACTION:     //183
-            mavlink_msg_slugs_action_decode(&message, &mlAction);
-            break;
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        mavlink_msg_servo_output_raw_decode(&message, &mlServo);
+        break;
 
-        case MAVLINK_MSG_ID_SCALED_IMU:
-            mavlink_msg_scaled_imu_decode(&message, &mlScaled);
-            break;
+    case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+        mavlink_msg_rc_channels_raw_decode(&message, &mlChannels);
+        break;
 
-        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
-            mavlink_msg_servo_output_raw_decode(&message, &mlServo);
+        switch (mlAction.actionId) {
+        case SLUGS_ACTION_EEPROM:
+            if (mlAction.actionVal == SLUGS_ACTION_FAIL) {
+                emit textMessageReceived(message.sysid, message.compid, 255, "EEPROM Write Fail, Data was not saved in Memory!");
+            }
             break;
 
-        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-            mavlink_msg_rc_channels_raw_decode(&message, &mlChannels);
+        case SLUGS_ACTION_PT_CHANGE:
+            if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
+                emit textMessageReceived(message.sysid, message.compid, 0, "Passthrough Succesfully Changed");
+            }
             break;
 
-            switch (mlAction.actionId) {
-            case SLUGS_ACTION_EEPROM:
-                if (mlAction.actionVal == SLUGS_ACTION_FAIL) {
-                    emit textMessageReceived(message.sysid, message.compid, 255, "EEPROM Write Fail, Data was not saved in Memory!");
-                }
-                break;
-
-            case SLUGS_ACTION_PT_CHANGE:
-                if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
-                    emit textMessageReceived(message.sysid, message.compid, 0, "Passthrough Succesfully Changed");
-                }
-                break;
-
-            case SLUGS_ACTION_MLC_CHANGE:
-                if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
-                    emit textMessageReceived(message.sysid, message.compid, 0, "Mid-level Commands Succesfully Changed");
-                }
-                break;
+        case SLUGS_ACTION_MLC_CHANGE:
+            if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
+                emit textMessageReceived(message.sysid, message.compid, 0, "Mid-level Commands Succesfully Changed");
             }
-
-            //break;
-
-        default:
-            //        QLOG_DEBUG() << "\nSLUGS RECEIVED MESSAGE WITH ID" << message.msgid;
             break;
         }
-#endif
+
+        //break;
+
+    default:
+        //        QLOG_DEBUG() << "\nSLUGS RECEIVED MESSAGE WITH ID" << message.msgid;
+        break;
     }
+#else
+    Q_UNUSED(message);
+#endif
 }
 
 
@@ -54,10 +54,11 @@ class SlugsMAV : public UAS
 
 public:
     SlugsMAV(MAVLinkProtocol* mavlink, int id = 0);
+    void subscribe(MAVLinkDispatcher *dispatcher, const int *msgids = 0);
 
 public slots:
-    /** @brief Receive a MAVLink message from this MAV */
-    void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    /** @brief Receive a SLUGS specific MAVLink message from this MAV */
+    void receiveSlugsMessage(LinkInterface* link, mavlink_message_t message);
 
     void emitSignals (void);
 
@@ -0,0 +1,87 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SpscRing
+ *          Lock free hand over between the ingest thread and the UI thread, and
+ *          from the UI thread to the telemetry consumers.
+ *
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <QAtomicInt>
+
+/**
+ * @brief Fixed size ring for exactly one producer and one consumer thread.
+ * One slot is kept free to tell full from empty.
+ */
+template <typename T, int Size>
+class SpscRing
+{
+public:
+    SpscRing() : m_head(0), m_tail(0) { }
+
+    /** @brief Producer side; false if the ring is full */
+    bool push(const T &item)
+    {
+        int head = m_head.load();
+        int next = (head + 1) % Size;
+        if (next == m_tail.loadAcquire())
+        {
+            return false;
+        }
+        m_items[head] = item;
+        m_head.storeRelease(next);
+        return true;
+    }
+
+    /** @brief Consumer side; false if the ring is empty */
+    bool pop(T *item)
+    {
+        int tail = m_tail.load();
+        if (tail == m_head.loadAcquire())
+        {
+            return false;
+        }
+        *item = m_items[tail];
+        // Drop the slot's references now rather than when it is next overwritten
+        m_items[tail] = T();
+        m_tail.storeRelease((tail + 1) % Size);
+        return true;
+    }
+
+    /** @brief Items queued, exact only on the consumer or producer thread */
+    int count() const
+    {
+        return (m_head.loadAcquire() - m_tail.loadAcquire() + Size) % Size;
+    }
+
+private:
+    QAtomicInt m_head;
+    T m_items[Size];
+    QAtomicInt m_tail;
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,126 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StartupProfiler
+ *          See StartupProfiler.h
+ *
+ */
+
+#include "StartupProfiler.h"
+#include "QsLog.h"
+#include <QCoreApplication>
+#include <QThread>
+
+StartupProfiler* StartupProfiler::instance()
+{
+    // Created before the application object, it lives until the process ends
+    static StartupProfiler* _instance = 0;
+    if(_instance == 0)
+    {
+        _instance = new StartupProfiler();
+    }
+    return _instance;
+}
+
+StartupProfiler::StartupProfiler() :
+    m_interactiveMs(-1)
+{
+    m_clock.start();
+}
+
+void StartupProfiler::begin(const QString &stage)
+{
+    Stage entry;
+    entry.name = stage;
+    entry.startMs = m_clock.elapsed();
+    entry.endMs = -1;
+    // Before the application exists everything runs on the main thread
+    entry.parallel = QCoreApplication::instance()
+            && QThread::currentThread() != QCoreApplication::instance()->thread();
+    QMutexLocker lock(&m_mutex);
+    m_stages.append(entry);
+}
+
+void StartupProfiler::end(const QString &stage)
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 startMs = -1;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (int i = m_stages.size() - 1; i >= 0; --i)
+        {
+            if (m_stages[i].name == stage && m_stages[i].endMs < 0)
+            {
+                m_stages[i].endMs = now;
+                startMs = m_stages[i].startMs;
+                break;
+            }
+        }
+        if (startMs < 0 || m_interactiveMs < 0)
+        {
+            return;
+        }
+    }
+    // Stages after the first frame (video, deferred panels) were not in the logged timeline
+    QLOG_INFO() << "Startup stage" << stage << startMs << "+" << (now - startMs) << "ms";
+    // Any thread, the overlay reads the timeline on the UI thread
+    QMetaObject::invokeMethod(this, "timelineChanged", Qt::QueuedConnection);
+}
+
+void StartupProfiler::interactive()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_interactiveMs >= 0)
+        {
+            return;
+        }
+        m_interactiveMs = static_cast<int>(m_clock.elapsed());
+    }
+    QLOG_INFO() << "Startup timeline, interactive after" << m_interactiveMs << "ms";
+    foreach (const QString &line, timeline().split('\n'))
+    {
+        QLOG_INFO() << " " << line;
+    }
+    emit timelineChanged();
+}
+
+QString StartupProfiler::timeline() const
+{
+    QMutexLocker lock(&m_mutex);
+    QStringList lines;
+    foreach (const Stage &stage, m_stages)
+    {
+        const QString duration = stage.endMs < 0 ? QString("...") : QString::number(stage.endMs - stage.startMs);
+        lines << QString("%1 %2+%3 ms%4").arg(stage.name).arg(stage.startMs).arg(duration)
+                 .arg(stage.parallel ? " (parallel)" : "");
+    }
+    return lines.join("\n");
+}
+
+int StartupProfiler::interactiveMs() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_interactiveMs;
+}
@@ -0,0 +1,104 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StartupProfiler
+ *          Timeline of the start of the application, stage by stage, from
+ *          main() to the first HUD frame and on to the stages the display
+ *          defers past it. Stages may run on other threads; those
+ *          overlapping the main thread are marked parallel. The timeline is
+ *          logged once the HUD is interactive, later stages as they end, and
+ *          shown in the performance overlay.
+ *
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QString>
+
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString timeline READ timeline NOTIFY timelineChanged)
+    Q_PROPERTY(int interactiveMs READ interactiveMs NOTIFY timelineChanged)
+public:
+    /** @brief The clock starts with the first call, make it at the top of main() */
+    static StartupProfiler* instance();
+
+    /** @brief Stage started, any thread */
+    void begin(const QString &stage);
+    /** @brief Stage ended, any thread. After interactive() it is logged on its own */
+    void end(const QString &stage);
+    /** @brief The first HUD frame is on screen, logs the timeline */
+    void interactive();
+
+    /** @brief One stage per line, "name start+duration ms" */
+    QString timeline() const;
+    /** @brief Milliseconds to the first HUD frame, -1 before it */
+    int interactiveMs() const;
+    qint64 elapsed() const { return m_clock.elapsed(); }
+
+signals:
+    void timelineChanged();
+
+private:
+    StartupProfiler();
+
+    struct Stage
+    {
+        QString name;
+        qint64 startMs;
+        qint64 endMs;       ///< -1 while running
+        bool parallel;      ///< Ran off the main thread
+    };
+
+    mutable QMutex m_mutex;
+    QList<Stage> m_stages;
+    QElapsedTimer m_clock;
+    int m_interactiveMs;
+};
+
+/** @brief Times the enclosing scope as one stage */
+class StartupStage
+{
+public:
+    explicit StartupStage(const QString &stage) : m_stage(stage)
+    {
+        StartupProfiler::instance()->begin(m_stage);
+    }
+    ~StartupStage()
+    {
+        StartupProfiler::instance()->end(m_stage);
+    }
+
+private:
+    QString m_stage;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,546 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StateWebSocketServer
+ *          See StateWebSocketServer.h
+ *
+ */
+
+#include "StateWebSocketServer.h"
+#include "MAVLinkProtocol1.h"
+#include "QsLog.h"
+#include "ThreadRoles.h"
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+#include <cstddef>
+#include <cstring>
+
+// RFC 6455, appended to the client's key for the accept hash
+static const char WebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+enum Opcode {
+    ContinuationFrame = 0x0,
+    TextFrame = 0x1,
+    BinaryFrame = 0x2,
+    CloseFrame = 0x8,
+    PingFrame = 0x9,
+    PongFrame = 0xA
+};
+
+struct Field
+{
+    const char *name;
+    const char *type;
+    int offset;
+    int size;
+};
+
+#define STATE_FIELD(member, type) \
+    { #member, type, static_cast<int>(offsetof(VehicleState, member)), static_cast<int>(sizeof(((VehicleState*)0)->member)) }
+
+// The schema, in the order of VehicleState; at most 64 for the mask
+static const Field Fields[] = {
+    STATE_FIELD(sections, "u32"),
+    STATE_FIELD(updates, "u32"),
+    STATE_FIELD(updatedMs, "i64"),
+    STATE_FIELD(customMode, "u32"),
+    STATE_FIELD(type, "u8"),
+    STATE_FIELD(autopilot, "u8"),
+    STATE_FIELD(baseMode, "u8"),
+    STATE_FIELD(systemStatus, "u8"),
+    STATE_FIELD(voltageBattery, "u16"),
+    STATE_FIELD(currentBattery, "i16"),
+    STATE_FIELD(batteryRemaining, "i8"),
+    STATE_FIELD(dropRateComm, "u16"),
+    STATE_FIELD(attitudeTimeBootMs, "u32"),
+    STATE_FIELD(roll, "f32"),
+    STATE_FIELD(pitch, "f32"),
+    STATE_FIELD(yaw, "f32"),
+    STATE_FIELD(rollspeed, "f32"),
+    STATE_FIELD(pitchspeed, "f32"),
+    STATE_FIELD(yawspeed, "f32"),
+    STATE_FIELD(airspeed, "f32"),
+    STATE_FIELD(groundspeed, "f32"),
+    STATE_FIELD(alt, "f32"),
+    STATE_FIELD(climb, "f32"),
+    STATE_FIELD(heading, "i16"),
+    STATE_FIELD(throttle, "u16"),
+    STATE_FIELD(fixType, "u8"),
+    STATE_FIELD(satellitesVisible, "u8"),
+    STATE_FIELD(eph, "u16"),
+    STATE_FIELD(epv, "u16"),
+    STATE_FIELD(lat, "f64"),
+    STATE_FIELD(lon, "f64"),
+    STATE_FIELD(altMsl, "f32"),
+    STATE_FIELD(relativeAlt, "f32"),
+    STATE_FIELD(vx, "f32"),
+    STATE_FIELD(vy, "f32"),
+    STATE_FIELD(vz, "f32"),
+    STATE_FIELD(homeLat, "f64"),
+    STATE_FIELD(homeLon, "f64"),
+    STATE_FIELD(distTraveled, "f32"),
+    STATE_FIELD(distToHome, "f32"),
+    STATE_FIELD(azToMav, "f32"),
+    STATE_FIELD(timeInAir, "f32"),
+    STATE_FIELD(watts, "f32"),
+    STATE_FIELD(energyUsed, "f32")
+};
+static const int FieldCount = sizeof(Fields) / sizeof(Fields[0]);
+
+// Copies a field out little endian, whatever its type
+static void appendField(QByteArray *out, const VehicleState &state, const Field &field)
+{
+    const uchar *value = reinterpret_cast<const uchar*>(&state) + field.offset;
+    uchar bytes[8];
+    switch (field.size)
+    {
+    case 2: { quint16 v; memcpy(&v, value, 2); qToLittleEndian<quint16>(v, bytes); break; }
+    case 4: { quint32 v; memcpy(&v, value, 4); qToLittleEndian<quint32>(v, bytes); break; }
+    case 8: { quint64 v; memcpy(&v, value, 8); qToLittleEndian<quint64>(v, bytes); break; }
+    default: bytes[0] = value[0]; break;
+    }
+    out->append(reinterpret_cast<const char*>(bytes), field.size);
+}
+
+StateWebSocketServer::StateWebSocketServer(const MAVLinkProtocol *protocol) :
+    m_protocol(protocol),
+    m_port(0),
+    m_clientCount(0),
+    m_sentFrames(0),
+    m_sentKBytes(0),
+    m_skipped(0),
+    m_sentBytes(0),
+    m_server(NULL),
+    m_tickTimer(NULL)
+{
+    Q_ASSERT(FieldCount <= 64);
+    // Sockets are created, written and serviced on the server thread
+    moveToThread(this);
+    start();
+}
+
+StateWebSocketServer::~StateWebSocketServer()
+{
+    quit();
+    wait();
+    qDeleteAll(m_clients);
+}
+
+void StateWebSocketServer::run()
+{
+    ThreadRoles::enter(ThreadRoles::LinkIo);
+    m_clock.start();
+    exec();
+}
+
+void StateWebSocketServer::setPort(quint16 port)
+{
+    m_port = port;
+    QMetaObject::invokeMethod(this, "listen", Qt::QueuedConnection, Q_ARG(int, port));
+}
+
+StateWebSocketServer::Stats StateWebSocketServer::stats() const
+{
+    Stats stats;
+    stats.clients = m_clientCount.loadAcquire();
+    stats.sentFrames = m_sentFrames.loadAcquire();
+    stats.sentKBytes = m_sentKBytes.loadAcquire();
+    stats.skipped = m_skipped.loadAcquire();
+    return stats;
+}
+
+void StateWebSocketServer::listen(int port)
+{
+    while (!m_clients.isEmpty())
+    {
+        drop(m_clients.first());
+    }
+    if (!m_server)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+        m_tickTimer = new QTimer(this);
+        connect(m_tickTimer, SIGNAL(timeout()), this, SLOT(tick()));
+    }
+    m_server->close();
+    if (port == 0)
+    {
+        return;
+    }
+    if (!m_server->listen(QHostAddress::Any, port))
+    {
+        QLOG_ERROR() << "State server cannot listen on port" << port << m_server->errorString();
+        return;
+    }
+    QLOG_INFO() << "State server listening for WebSocket clients on port" << port;
+}
+
+void StateWebSocketServer::newConnection()
+{
+    while (m_server->hasPendingConnections())
+    {
+        Client *client = new Client;
+        client->socket = m_server->nextPendingConnection();
+        client->upgraded = false;
+        client->intervalMs = 1000 / DefaultRateHz;
+        client->nextMs = 0;
+        client->sysid = 0;
+        client->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(client->socket, SIGNAL(readyRead()), this, SLOT(clientRead()));
+        connect(client->socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        m_clients.append(client);
+    }
+    m_clientCount.storeRelease(m_clients.size());
+}
+
+StateWebSocketServer::Client *StateWebSocketServer::find(QTcpSocket *socket) const
+{
+    for (int i = 0; i < m_clients.size(); i++)
+    {
+        if (m_clients.at(i)->socket == socket)
+        {
+            return m_clients.at(i);
+        }
+    }
+    return NULL;
+}
+
+void StateWebSocketServer::clientDisconnected()
+{
+    Client *client = find(qobject_cast<QTcpSocket*>(sender()));
+    if (client)
+    {
+        drop(client);
+    }
+}
+
+void StateWebSocketServer::drop(Client *client)
+{
+    m_clients.removeAll(client);
+    QObject::disconnect(client->socket, 0, this, 0);
+    client->socket->abort();
+    client->socket->deleteLater();
+    delete client;
+    m_clientCount.storeRelease(m_clients.size());
+    if (m_clients.isEmpty() && m_tickTimer)
+    {
+        m_tickTimer->stop();
+    }
+}
+
+void StateWebSocketServer::clientRead()
+{
+    Client *client = find(qobject_cast<QTcpSocket*>(sender()));
+    if (!client)
+    {
+        return;
+    }
+    client->input.append(client->socket->readAll());
+    if (!client->upgraded && !handshake(client))
+    {
+        return;
+    }
+    readFrames(client);
+}
+
+bool StateWebSocketServer::handshake(Client *client)
+{
+    int end = client->input.indexOf("\r\n\r\n");
+    if (end < 0)
+    {
+        if (client->input.size() > MaxRequestBytes)
+        {
+            drop(client);
+        }
+        return false;
+    }
+    QList<QByteArray> lines = client->input.left(end).split('\n');
+    client->input.remove(0, end + 4);
+
+    QByteArray key;
+    bool upgrade = false;
+    for (int i = 1; i < lines.size(); i++)
+    {
+        int colon = lines.at(i).indexOf(':');
+        if (colon < 0) continue;
+        QByteArray name = lines.at(i).left(colon).trimmed().toLower();
+        QByteArray value = lines.at(i).mid(colon + 1).trimmed();
+        if (name == "sec-websocket-key")
+        {
+            key = value;
+        }
+        else if (name == "upgrade")
+        {
+            upgrade = value.toLower() == "websocket";
+        }
+    }
+    if (!lines.first().startsWith("GET ") || !upgrade || key.isEmpty())
+    {
+        client->socket->write("HTTP/1.1 426 Upgrade Required\r\nUpgrade: websocket\r\nConnection: close\r\n"
+                              "Content-Length: 0\r\n\r\n");
+        client->socket->disconnectFromHost();
+        return false;
+    }
+
+    QByteArray accept = QCryptographicHash::hash(key + WebSocketGuid, QCryptographicHash::Sha1).toBase64();
+    client->socket->write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: " + accept + "\r\n\r\n");
+    client->upgraded = true;
+    sendFrame(client, TextFrame, schema());
+    QLOG_INFO() << "State server: WebSocket client" << client->socket->peerAddress().toString() << "connected";
+    if (!m_tickTimer->isActive())
+    {
+        m_tickTimer->start(TickMs);
+    }
+    return true;
+}
+
+void StateWebSocketServer::readFrames(Client *client)
+{
+    forever
+    {
+        const uchar *data = reinterpret_cast<const uchar*>(client->input.constData());
+        int size = client->input.size();
+        if (size < 2)
+        {
+            return;
+        }
+        int opcode = data[0] & 0x0F;
+        bool masked = (data[1] & 0x80) != 0;
+        qint64 length = data[1] & 0x7F;
+        int header = 2;
+        if (length == 126)
+        {
+            if (size < 4) return;
+            length = qFromBigEndian<quint16>(data + 2);
+            header = 4;
+        }
+        else if (length == 127)
+        {
+            if (size < 10) return;
+            length = static_cast<qint64>(qFromBigEndian<quint64>(data + 2));
+            header = 10;
+        }
+        // Clients must mask, and have nothing long to say
+        if (!masked || length < 0 || length > MaxClientFrame)
+        {
+            drop(client);
+            return;
+        }
+        if (size < header + 4 + length)
+        {
+            return;
+        }
+        const uchar *mask = data + header;
+        QByteArray payload(static_cast<int>(length), Qt::Uninitialized);
+        for (int i = 0; i < length; i++)
+        {
+            payload[i] = static_cast<char>(data[header + 4 + i] ^ mask[i % 4]);
+        }
+        client->input.remove(0, header + 4 + static_cast<int>(length));
+
+        switch (opcode)
+        {
+        case TextFrame:
+            command(client, payload);
+            break;
+        case PingFrame:
+            sendFrame(client, PongFrame, payload);
+            break;
+        case CloseFrame:
+            sendFrame(client, CloseFrame, payload.left(2));
+            client->socket->disconnectFromHost();
+            return;
+        default:
+            // Pongs, binary and continuations carry nothing for us
+            break;
+        }
+    }
+}
+
+void StateWebSocketServer::command(Client *client, const QByteArray &text)
+{
+    QJsonObject object = QJsonDocument::fromJson(text).object();
+    if (object.contains("rate"))
+    {
+        int rate = qBound(1, object.value("rate").toInt(DefaultRateHz), static_cast<int>(MaxRateHz));
+        client->intervalMs = 1000 / rate;
+        client->nextMs = 0;
+    }
+    if (object.contains("sysid"))
+    {
+        client->sysid = qBound(0, object.value("sysid").toInt(), 255);
+    }
+    if (object.value("refresh").toBool())
+    {
+        client->sent.clear();
+    }
+}
+
+void StateWebSocketServer::sendFrame(Client *client, int opcode, const QByteArray &payload)
+{
+    QByteArray frame;
+    frame.reserve(payload.size() + 10);
+    frame.append(static_cast<char>(0x80 | opcode));
+    uchar length[8];
+    if (payload.size() < 126)
+    {
+        frame.append(static_cast<char>(payload.size()));
+    }
+    else if (payload.size() < 65536)
+    {
+        frame.append(static_cast<char>(126));
+        qToBigEndian<quint16>(static_cast<quint16>(payload.size()), length);
+        frame.append(reinterpret_cast<const char*>(length), 2);
+    }
+    else
+    {
+        frame.append(static_cast<char>(127));
+        qToBigEndian<quint64>(static_cast<quint64>(payload.size()), length);
+        frame.append(reinterpret_cast<const char*>(length), 8);
+    }
+    frame.append(payload);
+    client->socket->write(frame);
+
+    m_sentBytes += frame.size();
+    m_sentFrames.fetchAndAddRelaxed(1);
+    m_sentKBytes.storeRelease(static_cast<int>(m_sentBytes / 1024));
+}
+
+void StateWebSocketServer::tick()
+{
+    qint64 now = m_clock.elapsed();
+    // Each snapshot is read once per tick, however many clients are due
+    QMap<int, VehicleState> states;
+    bool read = false;
+    for (int i = 0; i < m_clients.size(); i++)
+    {
+        Client *client = m_clients.at(i);
+        if (!client->upgraded || now < client->nextMs)
+        {
+            continue;
+        }
+        client->nextMs = qMax(client->nextMs + client->intervalMs, now);
+        if (client->socket->bytesToWrite() > MaxQueuedBytes)
+        {
+            m_skipped.fetchAndAddRelaxed(1);
+            continue;
+        }
+        if (!read)
+        {
+            read = true;
+            VehicleState state;
+            for (int sysid = 1; sysid < 256; sysid++)
+            {
+                if (m_protocol->vehicleState(sysid, &state))
+                {
+                    states.insert(sysid, state);
+                }
+            }
+        }
+
+        QByteArray payload;
+        payload.append(static_cast<char>(ProtocolVersion));
+        payload.append('\0');
+        int records = 0;
+        for (QMap<int, VehicleState>::const_iterator it = states.constBegin(); it != states.constEnd(); ++it)
+        {
+            if ((client->sysid != 0 && client->sysid != it.key()) || records == 255)
+            {
+                continue;
+            }
+            QMap<int, VehicleState>::iterator sent = client->sent.find(it.key());
+            const VehicleState *previous = sent != client->sent.end() ? &sent.value() : NULL;
+            if (previous && previous->updates == it.value().updates)
+            {
+                continue;
+            }
+            payload.append(static_cast<char>(it.key()));
+            if (appendDelta(it.value(), previous, &payload) == 0)
+            {
+                // Messages came in but changed nothing we send
+                payload.chop(1);
+                continue;
+            }
+            client->sent.insert(it.key(), it.value());
+            records++;
+        }
+        if (records > 0)
+        {
+            payload[1] = static_cast<char>(records);
+            sendFrame(client, BinaryFrame, payload);
+        }
+    }
+}
+
+int StateWebSocketServer::appendDelta(const VehicleState &state, const VehicleState *sent, QByteArray *out)
+{
+    const char *now = reinterpret_cast<const char*>(&state);
+    const char *before = reinterpret_cast<const char*>(sent);
+    quint64 mask = 0;
+    for (int i = 0; i < FieldCount; i++)
+    {
+        if (!sent || memcmp(now + Fields[i].offset, before + Fields[i].offset, Fields[i].size) != 0)
+        {
+            mask |= Q_UINT64_C(1) << i;
+        }
+    }
+    // updates and updatedMs, fields 1 and 2, change with every message; alone they are no news
+    const quint64 bookkeeping = (Q_UINT64_C(1) << 1) | (Q_UINT64_C(1) << 2);
+    if ((mask & ~bookkeeping) == 0)
+    {
+        return 0;
+    }
+    uchar bytes[8];
+    qToLittleEndian<quint64>(mask, bytes);
+    out->append(reinterpret_cast<const char*>(bytes), 8);
+    int fields = 0;
+    for (int i = 0; i < FieldCount; i++)
+    {
+        if (mask & (Q_UINT64_C(1) << i))
+        {
+            appendField(out, state, Fields[i]);
+            fields++;
+        }
+    }
+    return fields;
+}
+
+QByteArray StateWebSocketServer::schema()
+{
+    QByteArray json = "{\"version\":" + QByteArray::number(ProtocolVersion)
+            + ",\"rateHz\":" + QByteArray::number(DefaultRateHz) + ",\"fields\":[";
+    for (int i = 0; i < FieldCount; i++)
+    {
+        if (i > 0) json.append(',');
+        json.append("[\"").append(Fields[i].name).append("\",\"").append(Fields[i].type).append("\"]");
+    }
+    json.append("]}");
+    return json;
+}
@@ -0,0 +1,146 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StateWebSocketServer
+ *          Serves the decoded state of every vehicle (VehicleState, not
+ *          MAVLink) to browser dashboards over WebSocket. Every client asks
+ *          for its own rate and is sent, at that rate, only the fields that
+ *          changed since the last frame it was sent; the first frame of a
+ *          vehicle carries every field. The server thread reads the lock
+ *          free snapshots once per tick for all clients due in it, so
+ *          clients add nothing to the ingest path however many connect.
+ *
+ *          On connecting the client is sent a text frame with the schema,
+ *
+ *              {"version":1,"rateHz":5,"fields":[["sections","u32"],...]}
+ *
+ *          and may send text frames such as {"rate":10,"sysid":1} (sysid 0
+ *          for every vehicle) or {"refresh":true} for a full frame. State
+ *          arrives in binary frames, little endian:
+ *
+ *              u8 version, u8 n, then n times
+ *              u8 sysid, u64 field mask, the masked fields in schema order
+ *
+ *          A client whose socket has MaxQueuedBytes waiting skips ticks
+ *          instead of queueing more; its next frame holds what changed
+ *          meanwhile.
+ *
+ */
+
+#ifndef STATEWEBSOCKETSERVER_H
+#define STATEWEBSOCKETSERVER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QThread>
+#include "VehicleState.h"
+
+class MAVLinkProtocol;
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+class StateWebSocketServer : public QThread
+{
+    Q_OBJECT
+public:
+    enum {
+        ProtocolVersion = 1,
+        DefaultRateHz = 5,
+        MaxRateHz = 50,
+        TickMs = 1000 / MaxRateHz,
+        MaxQueuedBytes = 64 * 1024,
+        MaxRequestBytes = 8192,     ///< Of the HTTP upgrade request
+        MaxClientFrame = 4096       ///< Clients only send short commands
+    };
+
+    struct Stats
+    {
+        int clients;
+        int sentFrames;
+        int sentKBytes;
+        int skipped;            ///< Ticks a client was skipped for being slow
+        Stats() : clients(0), sentFrames(0), sentBytes(0), skipped(0) {}
+    };
+
+    /** @brief Moves itself to its own thread, so it cannot have a parent */
+    explicit StateWebSocketServer(const MAVLinkProtocol *protocol);
+    ~StateWebSocketServer();
+
+    /** @brief Accept clients on port, 0 to stop listening and drop them */
+    void setPort(quint16 port);
+    quint16 port() const { return m_port; }
+    Stats stats() const;
+
+protected:
+    void run();
+
+private slots:
+    void listen(int port);
+    void newConnection();
+    void clientRead();
+    void clientDisconnected();
+    void tick();
+
+private:
+    struct Client
+    {
+        QTcpSocket *socket;
+        QByteArray input;
+        bool upgraded;
+        int intervalMs;
+        qint64 nextMs;
+        int sysid;                      ///< 0 for every vehicle
+        QMap<int, VehicleState> sent;   ///< Last state sent of each vehicle
+    };
+
+    Client *find(QTcpSocket *socket) const;
+    bool handshake(Client *client);
+    void readFrames(Client *client);
+    void command(Client *client, const QByteArray &text);
+    void sendFrame(Client *client, int opcode, const QByteArray &payload);
+    void drop(Client *client);
+    /** @brief Fields of state that differ from sent, appended to out with their mask */
+    static int appendDelta(const VehicleState &state, const VehicleState *sent, QByteArray *out);
+    static QByteArray schema();
+
+    const MAVLinkProtocol *m_protocol;
+    quint16 m_port;
+    QAtomicInt m_clientCount;
+    QAtomicInt m_sentFrames;
+    QAtomicInt m_sentKBytes;
+    QAtomicInt m_skipped;
+    qint64 m_sentBytes;             ///< Server thread, published as m_sentKBytes
+
+    // Owned by the server thread
+    QTcpServer *m_server;
+    QTimer *m_tickTimer;
+    QElapsedTimer m_clock;
+    QList<Client*> m_clients;
+};
+
+#endif // STATEWEBSOCKETSERVER_H
@@ -0,0 +1,132 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StringPool
+ *          See StringPool.h
+ *
+ */
+
+#include "StringPool.h"
+
+StringPool* StringPool::instance()
+{
+    // Never destroyed, strings handed out may outlive any other object
+    static StringPool* _instance = new StringPool();
+    return _instance;
+}
+
+StringPool::StringPool()
+{
+    m_strings.reserve(256);
+}
+
+int StringPool::insertLocked(const QString &text, bool always)
+{
+    QHash<QString, int>::const_iterator it = m_ids.constFind(text);
+    if (it != m_ids.constEnd())
+    {
+        return it.value();
+    }
+    if (!always && m_strings.size() >= MaxStrings)
+    {
+        return -1;
+    }
+    const int id = m_strings.size();
+    m_strings.append(text);
+    m_ids.insert(text, id);
+    return id;
+}
+
+QString StringPool::intern(const QString &text)
+{
+    {
+        QReadLocker lock(&m_lock);
+        QHash<QString, int>::const_iterator it = m_ids.constFind(text);
+        if (it != m_ids.constEnd())
+        {
+            return m_strings.at(it.value());
+        }
+    }
+    QWriteLocker lock(&m_lock);
+    const int id = insertLocked(text, false);
+    return id < 0 ? text : m_strings.at(id);
+}
+
+QString StringPool::intern(const QByteArray &utf8)
+{
+    {
+        QReadLocker lock(&m_lock);
+        QHash<QByteArray, int>::const_iterator it = m_utf8Ids.constFind(utf8);
+        if (it != m_utf8Ids.constEnd())
+        {
+            return m_strings.at(it.value());
+        }
+    }
+    const QString text = QString::fromUtf8(utf8);
+    QWriteLocker lock(&m_lock);
+    const int id = insertLocked(text, false);
+    if (id < 0)
+    {
+        return text;
+    }
+    // A deep copy, the caller's bytes may be a raw view of a message buffer
+    m_utf8Ids.insert(QByteArray(utf8.constData(), utf8.size()), id);
+    return m_strings.at(id);
+}
+
+QString StringPool::literal(const char *text)
+{
+    {
+        QReadLocker lock(&m_lock);
+        QHash<const char*, int>::const_iterator it = m_literals.constFind(text);
+        if (it != m_literals.constEnd())
+        {
+            return m_strings.at(it.value());
+        }
+    }
+    // The same text at another address, from another translation unit, shares the string
+    const QString string = QString::fromUtf8(text);
+    QWriteLocker lock(&m_lock);
+    const int id = insertLocked(string, true);
+    m_literals.insert(text, id);
+    return m_strings.at(id);
+}
+
+int StringPool::id(const QString &text) const
+{
+    QReadLocker lock(&m_lock);
+    return m_ids.value(text, -1);
+}
+
+QString StringPool::string(int id) const
+{
+    QReadLocker lock(&m_lock);
+    return id >= 0 && id < m_strings.size() ? m_strings.at(id) : QString();
+}
+
+int StringPool::size() const
+{
+    QReadLocker lock(&m_lock);
+    return m_strings.size();
+}
@@ -0,0 +1,86 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief StringPool
+ *          One shared, immutable copy of each recurring telemetry string:
+ *          value names and units, mode names, repeated STATUSTEXT. A pooled
+ *          QString is handed out by reference count, so emitting it does
+ *          not allocate, and two pooled strings with equal text share their
+ *          data, so identical() is a pointer comparison. Each string also
+ *          has a small integer id for tables keyed by name.
+ *
+ *          Literals go through INTERNED("m/s"), which finds them by address
+ *          after the first call. Text arriving at run time is limited to
+ *          MaxStrings entries; past that intern() returns an unpooled copy
+ *          and id() is -1 for it. Strings are never removed. Any thread.
+ *
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+class StringPool
+{
+public:
+    enum { MaxStrings = 4096 };
+
+    static StringPool* instance();
+
+    /** @brief The pooled copy of text, text itself once the pool is full */
+    QString intern(const QString &text);
+    /** @brief Same for UTF-8 bytes, no QString is built when the text is pooled already */
+    QString intern(const QByteArray &utf8);
+    /** @brief A string literal, looked up by its address; always pooled */
+    QString literal(const char *text);
+
+    /** @brief Id of a pooled string, -1 if text is not in the pool */
+    int id(const QString &text) const;
+    /** @brief The string of an id, empty for an unknown one */
+    QString string(int id) const;
+    int size() const;
+
+    /** @brief Same data; for two pooled strings the same as equal text */
+    static bool identical(const QString &a, const QString &b) { return a.constData() == b.constData(); }
+
+private:
+    StringPool();
+    int insertLocked(const QString &text, bool always);
+
+    mutable QReadWriteLock m_lock;
+    QVector<QString> m_strings;             ///< By id
+    QHash<QString, int> m_ids;
+    QHash<QByteArray, int> m_utf8Ids;       ///< Text interned from bytes, by those bytes
+    QHash<const char*, int> m_literals;
+};
+
+/** @brief The pooled QString of a string literal, e.g. INTERNED("deg") */
+#define INTERNED(text) StringPool::instance()->literal(text)
+
+#endif // STRINGPOOL_H
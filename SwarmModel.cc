@@ -0,0 +1,218 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SwarmModel
+ *          See SwarmModel.h
+ *
+ */
+
+#include "SwarmModel.h"
+#include "MAVLinkDispatcher.h"
+#include "MAVLinkMessageRef.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+#include <cstring>
+
+static const int DefaultUpdateIntervalMs = 250;
+
+SwarmModel::SwarmModel(QObject *parent) :
+    QAbstractListModel(parent),
+    m_firstDirty(-1),
+    m_lastDirty(-1)
+{
+    memset(m_rows, -1, sizeof(m_rows));
+    m_clock.start();
+    m_timer.setInterval(DefaultUpdateIntervalMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(publish()));
+    m_timer.start();
+}
+
+const int *SwarmModel::messageIds()
+{
+    static const int ids[] = {
+        MAVLINK_MSG_ID_HEARTBEAT,
+        MAVLINK_MSG_ID_SYS_STATUS,
+        MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+        MAVLINK_MSG_ID_VFR_HUD,
+        -1
+    };
+    return ids;
+}
+
+void SwarmModel::subscribe(MAVLinkDispatcher *dispatcher)
+{
+    MAVLinkDispatcher::Handler handler = &MAVLinkDispatcher::callRef<SwarmModel, &SwarmModel::messageReceived>;
+    for (const int *id = messageIds(); *id != -1; ++id)
+    {
+        dispatcher->subscribe(MAVLinkDispatcher::AnySystem, *id, handler, this);
+    }
+}
+
+void SwarmModel::setUpdateInterval(int ms)
+{
+    ms = qMax(ms, 16);
+    if (ms == m_timer.interval())
+    {
+        return;
+    }
+    m_timer.setInterval(ms);
+    emit updateIntervalChanged(ms);
+}
+
+int SwarmModel::rowFor(int sysid)
+{
+    if (m_rows[sysid] >= 0)
+    {
+        return m_rows[sysid];
+    }
+    int row = m_vehicles.size();
+    Vehicle vehicle;
+    memset(&vehicle, 0, sizeof(vehicle));
+    vehicle.sysid = sysid;
+    vehicle.batteryRemaining = -1;
+    beginInsertRows(QModelIndex(), row, row);
+    m_vehicles.append(vehicle);
+    m_rows[sysid] = row;
+    endInsertRows();
+    emit countChanged();
+    return row;
+}
+
+void SwarmModel::messageReceived(LinkInterface *link, const MAVLinkMessageRef &message)
+{
+    Q_UNUSED(link);
+    const mavlink_message_t &msg = message.message();
+    int row = m_rows[msg.sysid];
+    if (row < 0)
+    {
+        // Only a heartbeat makes a vehicle, GCS and companion traffic has none from an autopilot
+        if (msg.msgid != MAVLINK_MSG_ID_HEARTBEAT || mavlink::Heartbeat(msg).autopilot() == MAV_AUTOPILOT_INVALID)
+        {
+            return;
+        }
+        row = rowFor(msg.sysid);
+    }
+    Vehicle &vehicle = m_vehicles[row];
+    switch (msg.msgid)
+    {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink::Heartbeat heartbeat(msg);
+        if (heartbeat.autopilot() == MAV_AUTOPILOT_INVALID)
+        {
+            // A gimbal or camera of the same system
+            return;
+        }
+        vehicle.lastSeen = m_clock.elapsed();
+        vehicle.customMode = heartbeat.custom_mode();
+        vehicle.armed = heartbeat.base_mode() & MAV_MODE_FLAG_SAFETY_ARMED;
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+        vehicle.batteryRemaining = mavlink::SysStatus(msg).battery_remaining();
+        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink::GlobalPositionInt position(msg);
+        vehicle.lat = position.lat();
+        vehicle.lon = position.lon();
+        vehicle.relativeAlt = position.relative_alt();
+        if (position.hdg() != 0xFFFF)
+        {
+            vehicle.heading = position.hdg();
+        }
+        break;
+    }
+    case MAVLINK_MSG_ID_VFR_HUD:
+        vehicle.groundSpeed = static_cast<quint16>(qBound(0.0f, mavlink::VfrHud(msg).groundspeed() * 100.0f, 65535.0f));
+        break;
+    default:
+        return;
+    }
+    if (!vehicle.dirty)
+    {
+        vehicle.dirty = true;
+        m_firstDirty = m_firstDirty < 0 ? row : qMin(m_firstDirty, row);
+        m_lastDirty = qMax(m_lastDirty, row);
+    }
+}
+
+void SwarmModel::publish()
+{
+    if (m_firstDirty < 0)
+    {
+        return;
+    }
+    for (int row = m_firstDirty; row <= m_lastDirty; ++row)
+    {
+        m_vehicles[row].dirty = false;
+    }
+    emit dataChanged(index(m_firstDirty), index(m_lastDirty));
+    m_firstDirty = -1;
+    m_lastDirty = -1;
+    emit tableChanged();
+}
+
+int SwarmModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_vehicles.size();
+}
+
+QVariant SwarmModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_vehicles.size())
+    {
+        return QVariant();
+    }
+    const Vehicle &vehicle = m_vehicles.at(index.row());
+    switch (role)
+    {
+    case SystemIdRole: return vehicle.sysid;
+    case LatitudeRole: return vehicle.lat / 1E7;
+    case LongitudeRole: return vehicle.lon / 1E7;
+    case AltitudeRole: return vehicle.relativeAlt / 1000.0;
+    case HeadingRole: return vehicle.heading / 100.0;
+    case GroundSpeedRole: return vehicle.groundSpeed / 100.0;
+    case BatteryRemainingRole: return vehicle.batteryRemaining;
+    case CustomModeRole: return vehicle.customMode;
+    case ArmedRole: return vehicle.armed;
+    case LastSeenRole: return m_clock.elapsed() - vehicle.lastSeen;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SwarmModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[SystemIdRole] = "systemId";
+    roles[LatitudeRole] = "latitude";
+    roles[LongitudeRole] = "longitude";
+    roles[AltitudeRole] = "altitude";
+    roles[HeadingRole] = "heading";
+    roles[GroundSpeedRole] = "groundSpeed";
+    roles[BatteryRemainingRole] = "batteryRemaining";
+    roles[CustomModeRole] = "customMode";
+    roles[ArmedRole] = "armed";
+    roles[LastSeenRole] = "lastSeen";
+    return roles;
+}
@@ -0,0 +1,127 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SwarmModel
+ *          One row per vehicle with the few values a swarm overview shows:
+ *          position, heading, speed, battery, mode and link age. Every
+ *          vehicle's state is a small struct in a fixed table indexed by
+ *          system ID, decoded straight from the dispatched messages, and
+ *          the view is told about changed rows a few times a second, so
+ *          the cost per vehicle stays a handful of field reads per message.
+ *
+ */
+
+#ifndef SWARMMODEL_H
+#define SWARMMODEL_H
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+
+class LinkInterface;
+class MAVLinkDispatcher;
+class MAVLinkMessageRef;
+
+class SwarmModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+public:
+    enum Roles {
+        SystemIdRole = Qt::UserRole + 1,
+        LatitudeRole,           ///< Degrees
+        LongitudeRole,          ///< Degrees
+        AltitudeRole,           ///< Meters above home
+        HeadingRole,            ///< Degrees
+        GroundSpeedRole,        ///< m/s
+        BatteryRemainingRole,   ///< Percent, -1 when unknown
+        CustomModeRole,
+        ArmedRole,
+        LastSeenRole            ///< Milliseconds since the last heartbeat
+    };
+
+    struct Vehicle
+    {
+        qint64 lastSeen;
+        qint32 lat;             ///< 1E7 degrees
+        qint32 lon;
+        qint32 relativeAlt;     ///< mm
+        quint32 customMode;
+        quint16 heading;        ///< cdeg
+        quint16 groundSpeed;    ///< cm/s
+        qint8 batteryRemaining;
+        quint8 sysid;
+        bool armed;
+        bool dirty;
+    };
+
+    explicit SwarmModel(QObject *parent = 0);
+
+    /** @brief Fill the table from the messages of every system */
+    void subscribe(MAVLinkDispatcher *dispatcher);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    int count() const { return m_vehicles.size(); }
+    /** @brief Row of sysid, -1 if it was never seen */
+    Q_INVOKABLE int rowOf(int sysid) const { return (sysid >= 0 && sysid < 256) ? m_rows[sysid] : -1; }
+
+    int updateInterval() const { return m_timer.interval(); }
+    void setUpdateInterval(int ms);
+
+    /** @brief Messages the table needs, LinkManager keeps these for vehicles not shown on the HUD */
+    static const int *messageIds();
+
+    /** @brief The table itself, one entry per row, for views that draw every vehicle at once */
+    const QVector<Vehicle> &vehicles() const { return m_vehicles; }
+    /** @brief Clock of Vehicle::lastSeen, ms */
+    qint64 now() const { return m_clock.elapsed(); }
+
+    void messageReceived(LinkInterface *link, const MAVLinkMessageRef &message);
+
+signals:
+    void countChanged();
+    void updateIntervalChanged(int ms);
+    /** @brief Rows changed or were added, at most once per updateInterval */
+    void tableChanged();
+
+private slots:
+    void publish();
+
+private:
+    int rowFor(int sysid);
+
+    QVector<Vehicle> m_vehicles;
+    qint16 m_rows[256];         ///< Row of each system ID, -1 when unseen
+    int m_firstDirty;
+    int m_lastDirty;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
+
+#endif // SWARMMODEL_H
@@ -28,9 +28,14 @@
 #include <iostream>
 #include "TCPLink1.h"
 #include "LinkManager1.h"
+#include "MAVLinkSender.h"
+#include "MAVLink2.h"
+#include "QsLog.h"
 #include "QGC.h"
+#include "GroundClock.h"
+#include "ThreadRoles.h"
+#include "TraceMarkers.h"
 #include <QHostInfo>
-#include <QSignalSpy>
 
 /// @file
 ///     @brief TCP link type for SITL support
@@ -39,12 +44,28 @@
 
 TCPLink::TCPLink(QHostAddress hostAddress, quint16 socketPort, bool asServer) :
     _hostAddress(hostAddress),
+    _hostName(hostAddress.toString()),
     _port(socketPort),
     _asServer(asServer),
     _socket(NULL),
-    _socketIsConnected(false)
+    _server(this),
+    _socketIsConnected(false),
+    _lowDelay(true),
+    _maxInFlight(DefaultMaxInFlight),
+    _txSocketPending(0),
+    _txUrgent(false),
+    _flushPosted(false),
+    _coalesceTimer(this),
+    _connectTimer(this)
 {
     _server.setMaxPendingConnections(1);
+    _coalesceTimer.setSingleShot(true);
+    QObject::connect(&_coalesceTimer, SIGNAL(timeout()), this, SLOT(_coalesceTimeout()));
+    _connectTimer.setSingleShot(true);
+    QObject::connect(&_connectTimer, SIGNAL(timeout()), this, SLOT(_connectTimeout()));
+
+    // Server and socket are serviced on this link's own thread, see connect()
+    moveToThread(this);
 
     _linkId = getNextLinkId();
     _resetName();
@@ -62,6 +83,7 @@ TCPLink::~TCPLink()
 
 void TCPLink::run()
 {
+	ThreadRoles::enter(ThreadRoles::LinkIo);
 	exec();
 }
 
@@ -75,6 +97,7 @@ void TCPLink::setHostAddress(QHostAddress hostAddress)
 	}
 
 	_hostAddress = hostAddress;
+    _hostName = hostAddress.toString();
     _resetName();
 
 	if (reconnect) {
@@ -84,7 +107,26 @@ void TCPLink::setHostAddress(QHostAddress hostAddress)
 
 void TCPLink::setHostAddress(const QString& hostAddress)
 {
-    setHostAddress(QHostAddress(hostAddress));
+    setHostName(hostAddress);
+}
+
+void TCPLink::setHostName(const QString& hostName)
+{
+    bool reconnect = false;
+
+    if (this->isConnected()) {
+        disconnect();
+        reconnect = true;
+    }
+
+    _hostName = hostName.trimmed();
+    // Null for a name, the socket looks it up when it connects
+    _hostAddress = QHostAddress(_hostName);
+    _resetName();
+
+    if (reconnect) {
+        connect();
+    }
 }
 
 void TCPLink::setPort(int port)
@@ -149,16 +191,182 @@ void TCPLink::_writeDebugBytes(const char *data, qint16 size)
 }
 #endif
 
+/**
+ * @brief Queue bytes for the socket, from any thread.
+ *
+ * Writes are collected and go out together once CoalesceMs passed or
+ * CoalesceBytes are waiting, so a cellular bridge sees full segments rather
+ * than one per message. A write that leads with a control message, which
+ * MAVLinkSender always puts first, goes out on the next turn of the link's
+ * event loop instead.
+ **/
 void TCPLink::writeBytes(const char* data, qint64 size)
 {
+    bool urgent = _isUrgent(data, size);
+    QMutexLocker locker(&_txMutex);
+    if (!isRunning())
+    {
+        return;
+    }
+    if (_txBuffer.size() + _txSocketPending + size > HardInFlightFactor * _maxInFlight)
+    {
+        // The sender ignored isWriteCongested(), only control traffic should get here
+        if (_txStats.dropped++ % 100 == 0)
+        {
+            QLOG_WARN() << _name << ": send buffer full, dropped" << _txStats.dropped << "writes";
+        }
+        return;
+    }
+    if (_txBuffer.isEmpty())
+    {
+        _txAge.start();
+    }
+    _txBuffer.append(data, size);
+    _txStats.appends++;
+    _noteQueued();
+    bool post = !_flushPosted || (urgent && !_txUrgent);
+    _txUrgent = _txUrgent || urgent;
+    if (post)
+    {
+        _flushPosted = true;
+        QMetaObject::invokeMethod(this, "_flushWrites", Qt::QueuedConnection);
+    }
+}
+
+bool TCPLink::_isUrgent(const char* data, qint64 size)
+{
+    int msgid = -1;
+    if (size >= MAVLINK_NUM_HEADER_BYTES && (quint8)data[0] == MAVLINK_STX)
+    {
+        msgid = (quint8)data[5];
+    }
+    else if (size >= MAVLINK2_NUM_HEADER_BYTES && (quint8)data[0] == MAVLINK2_STX)
+    {
+        msgid = (quint8)data[7] | ((quint8)data[8] << 8) | ((quint8)data[9] << 16);
+    }
+    return msgid >= 0 && MAVLinkSender::priorityOf(msgid) == MAVLinkSender::ControlPriority;
+}
+
+void TCPLink::_flushWrites(void)
+{
+    QByteArray batch;
+    {
+        QMutexLocker locker(&_txMutex);
+        _flushPosted = false;
+        if (_txBuffer.isEmpty())
+        {
+            return;
+        }
+        qint64 age = _txAge.elapsed();
+        if (!_txUrgent && _txBuffer.size() < CoalesceBytes && age < CoalesceMs)
+        {
+            // Wait for more, the timer comes back for it
+            _flushPosted = true;
+            _coalesceTimer.start(static_cast<int>(CoalesceMs - age));
+            return;
+        }
+        batch.swap(_txBuffer);
+        _txUrgent = false;
+    }
+    _coalesceTimer.stop();
+    if (!_socket)
+    {
+        return;
+    }
 #ifdef TCPLINK_READWRITE_DEBUG
-    _writeDebugBytes(data, size);
+    _writeDebugBytes(batch.constData(), batch.size());
 #endif
-    _socket->write(data, size);
+    _socket->write(batch);
+
+    {
+        QMutexLocker locker(&_txMutex);
+        _txStats.writes++;
+        _txSocketPending = _socket->bytesToWrite();
+        _noteQueued();
+    }
 
     // Log the amount and time written out for future data rate calculations.
-    QMutexLocker dataRateLocker(&dataRateMutex);
-    logDataRateToBuffer(outDataWriteAmounts, outDataWriteTimes, &outDataIndex, size, QDateTime::currentMSecsSinceEpoch());
+    outTraffic.add(batch.size(), 1, GroundClock::msecs());
+}
+
+void TCPLink::_coalesceTimeout(void)
+{
+    {
+        QMutexLocker locker(&_txMutex);
+        // Past CoalesceMs now, whatever is waiting goes
+        _txUrgent = true;
+    }
+    _flushWrites();
+}
+
+void TCPLink::_bytesWritten(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+    QMutexLocker locker(&_txMutex);
+    _txSocketPending = _socket ? _socket->bytesToWrite() : 0;
+}
+
+void TCPLink::_noteQueued(void)
+{
+    qint64 queued = _txBuffer.size() + _txSocketPending;
+    _txStats.queued = queued;
+    _txStats.peakQueued = qMax(_txStats.peakQueued, queued);
+}
+
+bool TCPLink::isWriteCongested() const
+{
+    QMutexLocker locker(&_txMutex);
+    return _txBuffer.size() + _txSocketPending > _maxInFlight;
+}
+
+void TCPLink::setMaxInFlight(int bytes)
+{
+    QMutexLocker locker(&_txMutex);
+    _maxInFlight = qMax(1024, bytes);
+}
+
+int TCPLink::maxInFlight() const
+{
+    QMutexLocker locker(&_txMutex);
+    return _maxInFlight;
+}
+
+TCPLink::TxStats TCPLink::txStats() const
+{
+    QMutexLocker locker(&_txMutex);
+    return _txStats;
+}
+
+void TCPLink::setLowDelay(bool lowDelay)
+{
+    _lowDelay = lowDelay;
+    if (isRunning())
+    {
+        QMetaObject::invokeMethod(this, "_applySocketOptions", Qt::QueuedConnection);
+    }
+}
+
+void TCPLink::_applySocketOptions(void)
+{
+    if (_socket)
+    {
+        // Our own coalescing replaces Nagle, which would hold commands back for an ACK
+        _socket->setSocketOption(QAbstractSocket::LowDelayOption, _lowDelay ? 1 : 0);
+    }
+}
+
+void TCPLink::_setupSocket(void)
+{
+    QObject::connect(_socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
+    QObject::connect(_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(_socketError(QAbstractSocket::SocketError)));
+    QObject::connect(_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(_bytesWritten(qint64)));
+    _applySocketOptions();
+
+    QMutexLocker locker(&_txMutex);
+    _txBuffer.clear();
+    _txSocketPending = 0;
+    _txUrgent = false;
+    _txStats = TxStats();
 }
 
 /**
@@ -169,6 +377,7 @@ void TCPLink::writeBytes(const char* data, qint64 size)
  **/
 void TCPLink::readBytes()
 {
+    HUD_TRACE_SCOPE("TCPLink::readBytes");
     qint64 byteCount = _socket->bytesAvailable();
 
     if (byteCount)
@@ -177,12 +386,12 @@ void TCPLink::readBytes()
         buffer.resize(byteCount);
 
         _socket->read(buffer.data(), buffer.size());
+        readTime = GroundClock::nsecs();
 
         emit bytesReceived(this, buffer);
 
         // Log the amount and time received for future data rate calculations.
-        QMutexLocker dataRateLocker(&dataRateMutex);
-        logDataRateToBuffer(inDataWriteAmounts, inDataWriteTimes, &inDataIndex, byteCount, QDateTime::currentMSecsSinceEpoch());
+        inTraffic.add(byteCount, 1, readTime / 1000000);
 
 #ifdef TCPLINK_READWRITE_DEBUG
         writeDebugBytes(buffer.data(), buffer.size());
@@ -207,16 +416,43 @@ qint64 TCPLink::bytesAvailable()
  **/
 bool TCPLink::disconnect()
 {
-	quit();
-	wait();
+    if (isRunning()) {
+        // Socket and server belong to the I/O thread
+        if (QThread::currentThread() == this) {
+            _hardwareDisconnect();
+        } else {
+            QMetaObject::invokeMethod(this, "_hardwareDisconnect", Qt::BlockingQueuedConnection);
+        }
+        quit();
+        wait();
+    }
 
+    return true;
+}
+
+void TCPLink::_hardwareDisconnect(void)
+{
     if (_socket) {
+        // Whatever waits for coalescing still goes out
+        {
+            QMutexLocker locker(&_txMutex);
+            _txUrgent = true;
+        }
+        _flushWrites();
         _socket->disconnectFromHost();
-	}
+        if (_socket && _socket->state() != QAbstractSocket::UnconnectedState) {
+            _socket->waitForDisconnected(1000);
+        }
+        if (_socket && !_socketIsConnected) {
+            // Still connecting, no disconnected() will come for it
+            QObject::disconnect(_socket, 0, this, 0);
+            delete _socket;
+            _socket = NULL;
+        }
+    }
+    _connectTimer.stop();
 
     _server.close();
-
-    return true;
 }
 
 void TCPLink::_socketDisconnected()
@@ -238,20 +474,17 @@ void TCPLink::_socketDisconnected()
 /**
  * @brief Connect the connection.
  *
- * @return True if connection has been established, false if connection couldn't be established.
+ * Returns as soon as the attempt is under way, name lookup and the TCP
+ * handshake run on the link's thread. connected() follows on success,
+ * error() if the attempt failed or timed out.
+ *
+ * @return False if the attempt could not be started.
  **/
 bool TCPLink::connect()
 {
-	if (isRunning())
-	{
-		quit();
-		wait();
-	}
-    bool connected = _hardwareConnect();
-    if (connected) {
-        start(HighPriority);
-    }
-    return connected;
+    disconnect();
+    start(HighPriority);
+    return QMetaObject::invokeMethod(this, "_hardwareConnect", Qt::QueuedConnection);
 }
 
 void TCPLink::newConnection()
@@ -262,8 +495,7 @@ void TCPLink::newConnection()
 
     _socket = _server.nextPendingConnection();
 
-    QObject::connect(_socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
-    QObject::connect(_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(_socketError(QAbstractSocket::SocketError)));
+    _setupSocket();
     QObject::connect(_socket, SIGNAL(disconnected()), this, SLOT(_socketDisconnected()));
 
     _socketIsConnected = true;
@@ -272,63 +504,74 @@ void TCPLink::newConnection()
     emit connected(this);
 }
 
-bool TCPLink::_hardwareConnect(void)
+void TCPLink::_hardwareConnect(void)
 {
     Q_ASSERT(_socket == NULL);
 
     if (_asServer)
     {
         if (!_server.isListening() && !_server.listen(QHostAddress::Any, _port)) {
-            return false;
+            _connectFailed(_server.errorString());
         }
-
-        // this wait isn't necessary but it gives visual feedback
-        // that the server is actually waiting for connection
-        // and listen() didn't fail.
-        if (!_server.waitForNewConnection(5000))
-            return false;
-
-        // let the newConnection signal handle the new connection
-
-        return true;
+        // newConnection() takes it from here
+        return;
     }
-    else
-    {
-    	_socket = new QTcpSocket();
-
-        QSignalSpy errorSpy(_socket, SIGNAL(error(QAbstractSocket::SocketError)));
-
-        _socket->connectToHost(_hostAddress, _port);
 
-        QObject::connect(_socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
-        QObject::connect(_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(_socketError(QAbstractSocket::SocketError)));
+    _socket = new QTcpSocket();
+    _setupSocket();
+    QObject::connect(_socket, SIGNAL(connected()), this, SLOT(_socketConnected()));
+    QObject::connect(_socket, SIGNAL(disconnected()), this, SLOT(_socketDisconnected()));
+    _connectTimer.start(ConnectTimeoutMs);
+    // Looks the name up without blocking, a failure comes back through _socketError()
+    _socket->connectToHost(_hostName, _port);
+}
 
-        // Give the socket five seconds to connect to the other side otherwise error out
-        if (!_socket->waitForConnected(5000))
-        {
-            // Whether a failed connection emits an error signal or not is platform specific.
-            // So in cases where it is not emitted, we emit one ourselves.
-            if (errorSpy.count() == 0) {
-                emit communicationError(getName(), "Connection failed");
-            }
-            delete _socket;
-            _socket = NULL;
-            return false;
-        }
+void TCPLink::_socketConnected(void)
+{
+    _connectTimer.stop();
+    _applySocketOptions();
+    _socketIsConnected = true;
+    emit connected(true);
+    emit connected();
+    emit connected(this);
+}
 
-        _socketIsConnected = true;
-        emit connected(true);
-        emit connected();
-        emit connected(this);
+void TCPLink::_connectTimeout(void)
+{
+    if (!_socketIsConnected) {
+        _connectFailed(tr("Connection timed out"));
+    }
+}
 
-        return true;
+void TCPLink::_connectFailed(const QString& reason)
+{
+    _connectTimer.stop();
+    if (_socket) {
+        QObject::disconnect(_socket, 0, this, 0);
+        _socket->deleteLater();
+        _socket = NULL;
     }
+    _server.close();
+    QLOG_WARN() << _name << ": connection failed," << reason;
+    emit communicationError(getName(), reason);
+    emit error(this, reason);
+    // The next connect() starts the thread again
+    quit();
 }
 
 void TCPLink::_socketError(QAbstractSocket::SocketError socketError)
 {
     Q_UNUSED(socketError);
-    emit communicationError(getName(), "Error on socket: " + _socket->errorString());
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || socket != _socket) {
+        return;
+    }
+    if (!_socketIsConnected) {
+        // Lookup, refusal or unreachable host while connecting
+        _connectFailed(socket->errorString());
+        return;
+    }
+    emit communicationError(getName(), "Error on socket: " + socket->errorString());
 }
 
 /**
@@ -356,18 +599,9 @@ qint64 TCPLink::getConnectionSpeed() const
     return 54000000; // 54 Mbit
 }
 
-qint64 TCPLink::getCurrentInDataRate() const
-{
-    return 0;
-}
-
-qint64 TCPLink::getCurrentOutDataRate() const
-{
-    return 0;
-}
 
 void TCPLink::_resetName(void)
 {
-    _name = QString("TCP %1 (host:%2 port:%3)").arg(_asServer ? "Server" : "Link").arg(_hostAddress.toString()).arg(_port);
+    _name = QString("TCP %1 (host:%2 port:%3)").arg(_asServer ? "Server" : "Link").arg(_hostName).arg(_port);
     emit nameChanged(_name);
 }
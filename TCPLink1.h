@@ -34,6 +34,8 @@
 #include <QMap>
 #include <QMutex>
 #include <QHostAddress>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <LinkInterface.h>
 #include <configuration.h>
 
@@ -57,8 +59,11 @@ public:
     void enableTimeouts() { }
 
     void setHostAddress(QHostAddress hostAddress);
+    /** @brief Host name or address literal, resolved asynchronously on connect */
+    void setHostName(const QString& hostName);
 
     QHostAddress getHostAddress(void) const { return _hostAddress; }
+    QString getHostName(void) const { return _hostName; }
     quint16 getPort(void) const { return _port; }
     bool isServer(void) const { return _asServer; }
     QTcpSocket* getSocket(void) { return _socket; }
@@ -67,6 +72,7 @@ public:
     virtual int     getId(void) const;
     virtual QString getName(void) const;
     virtual bool    isConnected(void) const;
+    /** @brief Start connecting and return at once; connected() or error() tells how it went */
     virtual bool    connect(void);
     virtual bool    disconnect(void);
     virtual qint64  bytesAvailable(void);
@@ -74,10 +80,29 @@ public:
 
     // Extensive statistics for scientific purposes
     qint64 getConnectionSpeed() const;
-    qint64 getCurrentInDataRate() const;
-    qint64 getCurrentOutDataRate() const;
     LinkType getLinkType() { return TCP_LINK; }
 
+    /** @brief Send queue of the link */
+    struct TxStats
+    {
+        qint64 queued;          ///< Bytes waiting, coalesce buffer and socket together
+        qint64 peakQueued;
+        quint32 appends;        ///< writeBytes() calls
+        quint32 writes;         ///< Socket writes they were coalesced into
+        quint32 dropped;        ///< Writes refused past the hard limit
+        TxStats() : queued(0), peakQueued(0), appends(0), writes(0), dropped(0) { }
+    };
+    TxStats txStats() const;
+
+    /** @brief Bytes in flight above which isWriteCongested() holds back the sender */
+    void setMaxInFlight(int bytes);
+    int maxInFlight() const;
+    bool isWriteCongested() const;
+
+    /** @brief TCP_NODELAY, on by default */
+    void setLowDelay(bool lowDelay);
+    bool lowDelay() const { return _lowDelay; }
+
 public slots:
     void setHostAddress(const QString& hostAddress);
     void setPort(int port);
@@ -95,18 +120,45 @@ protected slots:
     virtual void readBytes(void);
 
 protected:
-    // From LinkInterface->QThread
+    // From LinkInterface->QThread, its event loop services the socket
     virtual void run(void);
 
+private slots:
+    /** @brief Start connecting or listening, on the link's thread */
+    void _hardwareConnect(void);
+    void _socketConnected(void);
+    void _connectTimeout(void);
+    void _hardwareDisconnect(void);
+    /** @brief Hand the coalesced writes to the socket, on the link's thread */
+    void _flushWrites(void);
+    void _coalesceTimeout(void);
+    void _bytesWritten(qint64 bytes);
+    void _applySocketOptions(void);
+
 private:
+    enum {
+        CoalesceMs = 10,                ///< Longest a write waits for company
+        CoalesceBytes = 1400,           ///< About one segment, sent without waiting
+        DefaultMaxInFlight = 64 * 1024,
+        HardInFlightFactor = 4,         ///< Writes past this many times maxInFlight are dropped
+        ConnectTimeoutMs = 5000
+    };
+
     void _resetName(void);
-	bool _hardwareConnect(void);
+    /** @brief Drop a connection attempt and report it, on the link's thread */
+    void _connectFailed(const QString& reason);
+    void _setupSocket(void);
+    /** @brief True if the write leads with a control priority frame */
+    static bool _isUrgent(const char* data, qint64 size);
+    /** @brief Update the queue depth statistics, _txMutex held */
+    void _noteQueued(void);
 #ifdef TCPLINK_READWRITE_DEBUG
     void _writeDebugBytes(const char *data, qint16 size);
 #endif
 
     QString         _name;
     QHostAddress    _hostAddress;
+    QString         _hostName;          ///< What the user gave, may need a DNS lookup
     quint16         _port;
     bool            _asServer;
     int             _linkId;
@@ -122,6 +174,18 @@ private:
     quint64 _bitsReceivedMax;
     quint64 _connectionStartTime;
     QMutex  _statisticsMutex;
+
+    bool            _lowDelay;
+    mutable QMutex  _txMutex;           ///< Guards the members below, writers are on any thread
+    int             _maxInFlight;
+    QByteArray      _txBuffer;          ///< Written but not yet handed to the socket
+    qint64          _txSocketPending;   ///< Bytes the socket has not written out yet
+    bool            _txUrgent;          ///< _txBuffer holds a control message
+    bool            _flushPosted;       ///< A _flushWrites() call or the coalesce timer is pending
+    QElapsedTimer   _txAge;             ///< Since the oldest byte in _txBuffer was written
+    TxStats         _txStats;
+    QTimer          _coalesceTimer;
+    QTimer          _connectTimer;
 };
 
 #endif // TCPLINK_H
@@ -0,0 +1,828 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryCache
+ *          See TelemetryCache.h
+ *
+ */
+
+#include "TelemetryCache.h"
+#include "CompressedTlog.h"
+#include "MAVLinkCrc.h"
+#include "QsLog.h"
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+
+static const char cacheMagic[] = "TCCH";
+static const quint16 cacheVersion = 1;
+static const int timestampBytes = 8;
+
+// Payload fields are packed, read them without assuming alignment
+template<typename T> static inline double readField(const uchar *p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return (double)value;
+}
+
+static double fieldValue(quint8 type, const uchar *p)
+{
+    switch (type)
+    {
+    case MAVLINK_TYPE_UINT8_T:  return readField<uint8_t>(p);
+    case MAVLINK_TYPE_INT8_T:   return readField<int8_t>(p);
+    case MAVLINK_TYPE_UINT16_T: return readField<uint16_t>(p);
+    case MAVLINK_TYPE_INT16_T:  return readField<int16_t>(p);
+    case MAVLINK_TYPE_UINT32_T: return readField<uint32_t>(p);
+    case MAVLINK_TYPE_INT32_T:  return readField<int32_t>(p);
+    case MAVLINK_TYPE_FLOAT:    return readField<float>(p);
+    case MAVLINK_TYPE_DOUBLE:   return readField<double>(p);
+    case MAVLINK_TYPE_UINT64_T: return readField<uint64_t>(p);
+    default:                    return readField<int64_t>(p);
+    }
+}
+
+static int fieldSize(quint8 type)
+{
+    static const int sizes[] = { 1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+    return type <= MAVLINK_TYPE_DOUBLE ? sizes[type] : 0;
+}
+
+static void appendU8(QByteArray *out, quint8 value) { out->append((char)value); }
+
+template<typename T> static void appendBE(QByteArray *out, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToBigEndian<T>(value, bytes);
+    out->append((const char*)bytes, sizeof(T));
+}
+
+static void appendDouble(QByteArray *out, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    appendBE<quint64>(out, bits);
+}
+
+static double readDouble(const uchar *p)
+{
+    quint64 bits = qFromBigEndian<quint64>(p);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void appendString(QByteArray *out, const QString &text)
+{
+    QByteArray utf8 = text.toUtf8().left(0xFFFF);
+    appendBE<quint16>(out, utf8.size());
+    out->append(utf8);
+}
+
+namespace {
+
+/** @brief Decodes frames into per channel blocks and writes them out as they fill */
+class CacheWriter
+{
+public:
+    explicit CacheWriter(QFile *output) : m_output(output), m_started(false), m_startTime(0), m_lastMs(0), m_failed(false) { }
+
+    void addRecords(const uchar *data, qint64 size);
+    bool finish(qint64 tlogSize);
+    bool failed() const { return m_failed; }
+    int channelCount() const { return m_channels.size(); }
+
+private:
+    struct Pending
+    {
+        Pending() : lastMs(0) { }
+        QVector<quint32> times;
+        QVector<double> values;
+        quint32 lastMs;
+    };
+
+    void addFrame(quint64 timeUsec, const uchar *frame);
+    int channel(quint8 sysid, quint8 msgid, int field, int element, const mavlink::MessageLayout &layout);
+    void flush(int channel);
+
+    QFile *m_output;
+    bool m_started;
+    quint64 m_startTime;
+    quint32 m_lastMs;
+    bool m_failed;
+    QHash<quint32, int> m_keys;     ///< sysid, msgid, field and element to channel
+    QVector<TelemetryCache::Channel> m_channels;
+    QVector<Pending> m_pending;
+};
+
+void CacheWriter::addRecords(const uchar *data, qint64 size)
+{
+    qint64 offset = 0;
+    while (offset + timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES <= size)
+    {
+        const uchar *frame = data + offset + timestampBytes;
+        int length = MAVLINK_NUM_NON_PAYLOAD_BYTES + frame[1];
+        if (frame[0] != MAVLINK_STX || offset + timestampBytes + length > size)
+        {
+            // Damaged record, look for the next frame start a byte further on
+            offset++;
+            continue;
+        }
+        const mavlink::MessageLayout &layout = mavlink::messageLayout(frame[5]);
+        quint16 crc = frame[6 + frame[1]] | (frame[7 + frame[1]] << 8);
+        if (layout.name == NULL || layout.length != frame[1]
+                || MAVLinkCrc::frame(frame + 1, 5 + frame[1], layout.crcExtra) != crc)
+        {
+            offset++;
+            continue;
+        }
+        addFrame(qFromBigEndian<quint64>(data + offset), frame);
+        offset += timestampBytes + length;
+    }
+}
+
+void CacheWriter::addFrame(quint64 timeUsec, const uchar *frame)
+{
+    if (!m_started)
+    {
+        m_started = true;
+        m_startTime = timeUsec;
+    }
+    quint64 ms = timeUsec > m_startTime ? (timeUsec - m_startTime) / 1000 : 0;
+    quint32 timeMs = (quint32)qMin<quint64>(ms, 0xFFFFFFFFu);
+    m_lastMs = qMax(m_lastMs, timeMs);
+
+    quint8 sysid = frame[3];
+    quint8 msgid = frame[5];
+    const uchar *payload = frame + 6;
+    const mavlink::MessageLayout &layout = mavlink::messageLayout(msgid);
+    const mavlink::MessageTables &tables = mavlink::messageTables();
+    for (int i = 0; i < layout.numFields; i++)
+    {
+        const mavlink::FieldLayout &field = layout.fields[i];
+        // Text is not plotted, the leading time field is the sample time already
+        if (field.type == MAVLINK_TYPE_CHAR || fieldSize(field.type) == 0
+                || (tables.timeType[msgid] != 0 && field.wireOffset == tables.timeOffset[msgid]))
+        {
+            continue;
+        }
+        int elements = field.arrayLength > 0 ? field.arrayLength : 1;
+        for (int j = 0; j < elements; j++)
+        {
+            int id = channel(sysid, msgid, i, field.arrayLength > 0 ? j : -1, layout);
+            Pending &pending = m_pending[id];
+            // Out of order records keep the time column sorted
+            quint32 sampleMs = qMax(timeMs, pending.lastMs);
+            pending.lastMs = sampleMs;
+            pending.times.append(sampleMs);
+            pending.values.append(fieldValue(field.type, payload + field.wireOffset + j * fieldSize(field.type)));
+            if (pending.times.size() >= TelemetryCache::BlockSamples)
+            {
+                flush(id);
+            }
+        }
+    }
+}
+
+int CacheWriter::channel(quint8 sysid, quint8 msgid, int field, int element, const mavlink::MessageLayout &layout)
+{
+    quint32 key = (sysid << 24) | (msgid << 16) | (field << 8) | (element & 0xFF);
+    QHash<quint32, int>::const_iterator it = m_keys.constFind(key);
+    if (it != m_keys.constEnd())
+    {
+        return it.value();
+    }
+
+    const mavlink::FieldLayout &info = layout.fields[field];
+    TelemetryCache::Channel channel;
+    channel.name = QString("M%1:%2.%3").arg(sysid).arg(layout.name).arg(info.name);
+    if (element >= 0)
+    {
+        channel.name += QString(".%1").arg(element);
+    }
+    static const char *typeNames[] = { "char", "uint8_t", "int8_t", "uint16_t", "int16_t",
+                                       "uint32_t", "int32_t", "uint64_t", "int64_t", "float", "double" };
+    channel.unit = typeNames[info.type];
+    // A float keeps 24 bits, so wide integers (lat/lon in 1e-7 degrees) are kept as doubles
+    channel.type = (info.type == MAVLINK_TYPE_FLOAT || fieldSize(info.type) < 4) ? TelemetryCache::Float32
+                                                                                : TelemetryCache::Float64;
+    channel.sysid = sysid;
+    channel.count = 0;
+    channel.min = 0;
+    channel.max = 0;
+    channel.sum = 0;
+    int id = m_channels.size();
+    m_channels.append(channel);
+    m_pending.append(Pending());
+    m_keys.insert(key, id);
+    return id;
+}
+
+void CacheWriter::flush(int id)
+{
+    Pending &pending = m_pending[id];
+    int count = pending.times.size();
+    if (count == 0 || m_failed)
+    {
+        return;
+    }
+    TelemetryCache::Channel &channel = m_channels[id];
+
+    TelemetryCache::Block block;
+    block.count = count;
+    block.firstMs = pending.times.first();
+    block.lastMs = pending.times.last();
+    block.min = std::numeric_limits<double>::infinity();
+    block.max = -std::numeric_limits<double>::infinity();
+    block.sum = 0;
+
+    // Time deltas first, then the values: each column deflates on its own patterns
+    QByteArray raw;
+    raw.reserve(count * (channel.type == TelemetryCache::Float64 ? 12 : 8));
+    quint32 previous = block.firstMs;
+    for (int i = 0; i < count; i++)
+    {
+        appendBE<quint32>(&raw, pending.times.at(i) - previous);
+        previous = pending.times.at(i);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        double value = pending.values.at(i);
+        block.min = qMin(block.min, value);
+        block.max = qMax(block.max, value);
+        block.sum += value;
+        if (channel.type == TelemetryCache::Float64)
+        {
+            appendDouble(&raw, value);
+        }
+        else
+        {
+            float single = (float)value;
+            quint32 bits;
+            memcpy(&bits, &single, sizeof(bits));
+            appendBE<quint32>(&raw, bits);
+        }
+    }
+
+    QByteArray packed = qCompress(raw, TelemetryCache::CompressionLevel);
+    block.offset = m_output->pos();
+    block.compressedSize = packed.size();
+    if (m_output->write(packed) != packed.size())
+    {
+        m_failed = true;
+        return;
+    }
+    channel.blocks.append(block);
+    pending.times.resize(0);
+    pending.values.resize(0);
+}
+
+bool CacheWriter::finish(qint64 tlogSize)
+{
+    for (int i = 0; i < m_channels.size(); i++)
+    {
+        flush(i);
+    }
+    if (m_failed)
+    {
+        return false;
+    }
+
+    QByteArray directory;
+    appendBE<quint32>(&directory, m_lastMs);
+    appendBE<quint32>(&directory, m_channels.size());
+    for (int i = 0; i < m_channels.size(); i++)
+    {
+        const TelemetryCache::Channel &channel = m_channels.at(i);
+        appendString(&directory, channel.name);
+        appendString(&directory, channel.unit);
+        appendU8(&directory, channel.type);
+        appendU8(&directory, channel.sysid);
+        appendBE<quint32>(&directory, channel.blocks.size());
+        for (int j = 0; j < channel.blocks.size(); j++)
+        {
+            const TelemetryCache::Block &block = channel.blocks.at(j);
+            appendBE<quint64>(&directory, block.offset);
+            appendBE<quint32>(&directory, block.compressedSize);
+            appendBE<quint32>(&directory, block.count);
+            appendBE<quint32>(&directory, block.firstMs);
+            appendBE<quint32>(&directory, block.lastMs);
+            appendDouble(&directory, block.min);
+            appendDouble(&directory, block.max);
+            appendDouble(&directory, block.sum);
+        }
+    }
+    qint64 directoryOffset = m_output->pos();
+    if (m_output->write(directory) != directory.size())
+    {
+        return false;
+    }
+
+    QByteArray header(cacheMagic, 4);
+    appendBE<quint16>(&header, cacheVersion);
+    appendBE<quint16>(&header, 0);
+    appendBE<quint64>(&header, tlogSize);
+    appendBE<quint64>(&header, m_startTime);
+    appendBE<quint64>(&header, directoryOffset);
+    return m_output->seek(0) && m_output->write(header) == header.size();
+}
+
+} // namespace
+
+TelemetryCache::TelemetryCache() :
+    m_startTime(0),
+    m_durationMs(0)
+{
+}
+
+bool TelemetryCache::isCurrent(const QString &tlogFileName)
+{
+    QFile file(cacheFileName(tlogFileName));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QByteArray header = file.read(HeaderBytes);
+    if (header.size() != HeaderBytes || !header.startsWith(cacheMagic)
+            || qFromBigEndian<quint16>((const uchar*)header.constData() + 4) != cacheVersion)
+    {
+        return false;
+    }
+    // A log still being written grows, its cache is then out of date
+    return qFromBigEndian<quint64>((const uchar*)header.constData() + 8) == (quint64)QFileInfo(tlogFileName).size();
+}
+
+bool TelemetryCache::build(const QString &tlogFileName, QString *error, const QAtomicInt *stop)
+{
+    QString cacheName = cacheFileName(tlogFileName);
+    QFile output(cacheName + ".part");
+    if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        if (error) *error = output.errorString();
+        return false;
+    }
+    // Header written last, once the directory offset is known
+    output.write(QByteArray(HeaderBytes, '\0'));
+
+    CacheWriter writer(&output);
+    qint64 tlogSize = QFileInfo(tlogFileName).size();
+    bool stopped = false;
+    if (CompressedTlog::isCompressedFile(tlogFileName))
+    {
+        CompressedTlog input;
+        if (!input.open(tlogFileName))
+        {
+            if (error) *error = input.errorString();
+            output.remove();
+            return false;
+        }
+        for (int i = 0; i < input.blocks().size() && !stopped; i++)
+        {
+            QByteArray records = input.readBlock(i);
+            writer.addRecords((const uchar*)records.constData(), records.size());
+            stopped = stop && stop->load();
+        }
+    }
+    else
+    {
+        QFile input(tlogFileName);
+        if (!input.open(QIODevice::ReadOnly))
+        {
+            if (error) *error = input.errorString();
+            output.remove();
+            return false;
+        }
+        // Mapped like the replay does, in slices so a stop request is seen
+        const uchar *data = input.map(0, tlogSize);
+        QByteArray slice;
+        const qint64 sliceBytes = 1024 * 1024;
+        qint64 offset = 0;
+        while (offset < tlogSize && !stopped)
+        {
+            qint64 length = qMin(sliceBytes, tlogSize - offset);
+            if (data == NULL)
+            {
+                input.seek(offset);
+                slice = input.read(length);
+            }
+            const uchar *records = data ? data + offset : (const uchar*)slice.constData();
+            // Slices end on the last whole record, the rest starts the next slice
+            qint64 consumed = length;
+            if (offset + length < tlogSize)
+            {
+                qint64 position = 0;
+                while (position + timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES <= length
+                       && records[position + timestampBytes] == MAVLINK_STX
+                       && position + timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES + records[position + timestampBytes + 1] <= length)
+                {
+                    position += timestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES + records[position + timestampBytes + 1];
+                }
+                consumed = position > 0 ? position : length;
+            }
+            writer.addRecords(records, consumed);
+            offset += consumed;
+            stopped = stop && stop->load();
+        }
+        if (data)
+        {
+            input.unmap((uchar*)data);
+        }
+    }
+
+    bool ok = !stopped && writer.finish(tlogSize);
+    if (!ok)
+    {
+        if (error) *error = stopped ? QString("stopped") : output.errorString();
+        output.remove();
+        return false;
+    }
+    output.close();
+    QFile::remove(cacheName);
+    if (!output.rename(cacheName))
+    {
+        if (error) *error = output.errorString();
+        output.remove();
+        return false;
+    }
+    return true;
+}
+
+bool TelemetryCache::open(const QString &cacheFileName)
+{
+    close();
+    m_file.setFileName(cacheFileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+    QByteArray header = m_file.read(HeaderBytes);
+    const uchar *h = (const uchar*)header.constData();
+    if (header.size() != HeaderBytes || !header.startsWith(cacheMagic) || qFromBigEndian<quint16>(h + 4) != cacheVersion)
+    {
+        m_error = QObject::tr("%1 is not a telemetry cache").arg(cacheFileName);
+        m_file.close();
+        return false;
+    }
+    m_startTime = qFromBigEndian<quint64>(h + 16);
+    qint64 directoryOffset = qFromBigEndian<quint64>(h + 24);
+    m_file.seek(directoryOffset);
+    QByteArray directory = m_file.readAll();
+
+    const uchar *p = (const uchar*)directory.constData();
+    const uchar *end = p + directory.size();
+    bool ok = end - p >= 8;
+    if (ok)
+    {
+        m_durationMs = qFromBigEndian<quint32>(p);
+        quint32 channelCount = qFromBigEndian<quint32>(p + 4);
+        p += 8;
+        for (quint32 i = 0; i < channelCount && ok; i++)
+        {
+            Channel channel;
+            for (int n = 0; n < 2 && ok; n++)
+            {
+                ok = end - p >= 2 && end - p >= 2 + qFromBigEndian<quint16>(p);
+                if (!ok) break;
+                int length = qFromBigEndian<quint16>(p);
+                QString text = QString::fromUtf8((const char*)p + 2, length);
+                (n == 0 ? channel.name : channel.unit) = text;
+                p += 2 + length;
+            }
+            ok = ok && end - p >= 6;
+            if (!ok) break;
+            channel.type = p[0];
+            channel.sysid = p[1];
+            quint32 blockCount = qFromBigEndian<quint32>(p + 2);
+            p += 6;
+            ok = (quint64)(end - p) >= (quint64)blockCount * TelemetryCache::BlockEntryBytes;
+            if (!ok) break;
+            channel.blocks.resize(blockCount);
+            channel.count = 0;
+            channel.sum = 0;
+            channel.min = std::numeric_limits<double>::infinity();
+            channel.max = -std::numeric_limits<double>::infinity();
+            for (quint32 j = 0; j < blockCount; j++)
+            {
+                Block &block = channel.blocks[j];
+                block.offset = qFromBigEndian<quint64>(p);
+                block.compressedSize = qFromBigEndian<quint32>(p + 8);
+                block.count = qFromBigEndian<quint32>(p + 12);
+                block.firstMs = qFromBigEndian<quint32>(p + 16);
+                block.lastMs = qFromBigEndian<quint32>(p + 20);
+                block.min = readDouble(p + 24);
+                block.max = readDouble(p + 32);
+                block.sum = readDouble(p + 40);
+                p += TelemetryCache::BlockEntryBytes;
+                channel.count += block.count;
+                channel.sum += block.sum;
+                channel.min = qMin(channel.min, block.min);
+                channel.max = qMax(channel.max, block.max);
+            }
+            m_ids.insert(channel.name, m_channels.size());
+            m_channels.append(channel);
+        }
+    }
+    if (!ok)
+    {
+        close();
+        m_error = QObject::tr("%1 has a damaged directory").arg(cacheFileName);
+        return false;
+    }
+    return true;
+}
+
+void TelemetryCache::close()
+{
+    m_channels.clear();
+    m_ids.clear();
+    m_error.clear();
+    m_startTime = 0;
+    m_durationMs = 0;
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+}
+
+bool TelemetryCache::readBlock(int channel, int block, QVector<quint32> *timesMs, QVector<double> *values)
+{
+    if (channel < 0 || channel >= m_channels.size() || block < 0 || block >= m_channels.at(channel).blocks.size())
+    {
+        return false;
+    }
+    const Channel &info = m_channels.at(channel);
+    const Block &entry = info.blocks.at(block);
+    int valueBytes = info.type == Float64 ? 8 : 4;
+    m_file.seek(entry.offset);
+    QByteArray raw = qUncompress(m_file.read(entry.compressedSize));
+    if ((quint32)raw.size() != entry.count * (4 + valueBytes))
+    {
+        QLOG_WARN() << "TelemetryCache: damaged block" << block << "of" << info.name << "in" << m_file.fileName();
+        return false;
+    }
+
+    const uchar *p = (const uchar*)raw.constData();
+    timesMs->resize(entry.count);
+    values->resize(entry.count);
+    quint32 time = entry.firstMs;
+    for (quint32 i = 0; i < entry.count; i++)
+    {
+        time += qFromBigEndian<quint32>(p + i * 4);
+        (*timesMs)[i] = time;
+    }
+    p += entry.count * 4;
+    for (quint32 i = 0; i < entry.count; i++)
+    {
+        if (info.type == Float64)
+        {
+            (*values)[i] = readDouble(p + i * 8);
+        }
+        else
+        {
+            quint32 bits = qFromBigEndian<quint32>(p + i * 4);
+            float single;
+            memcpy(&single, &bits, sizeof(single));
+            (*values)[i] = single;
+        }
+    }
+    return true;
+}
+
+bool TelemetryCache::summarize(int channel, qint64 fromMs, qint64 toMs, int buckets, Series &out)
+{
+    if (channel < 0 || channel >= m_channels.size() || buckets <= 0 || toMs <= fromMs)
+    {
+        return false;
+    }
+    const Channel &info = m_channels.at(channel);
+    out.startMs = fromMs;
+    out.bucketMs = (int)qMax<qint64>(1, (toMs - fromMs + buckets - 1) / buckets);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    QVector<double> minimum(buckets, inf);
+    QVector<double> maximum(buckets, -inf);
+    QVector<double> sum(buckets, 0);
+    QVector<quint32> count(buckets, 0);
+    QVector<quint32> times;
+    QVector<double> values;
+
+    for (int i = 0; i < info.blocks.size(); i++)
+    {
+        const Block &block = info.blocks.at(i);
+        if ((qint64)block.lastMs < fromMs || (qint64)block.firstMs >= toMs)
+        {
+            continue;
+        }
+        qint64 first = ((qint64)block.firstMs - fromMs) / out.bucketMs;
+        qint64 last = ((qint64)block.lastMs - fromMs) / out.bucketMs;
+        if ((qint64)block.firstMs >= fromMs && first == last && last < buckets)
+        {
+            // The whole block is in one bucket, its summary is enough
+            minimum[first] = qMin(minimum[first], block.min);
+            maximum[first] = qMax(maximum[first], block.max);
+            sum[first] += block.sum;
+            count[first] += block.count;
+            continue;
+        }
+        if (!readBlock(channel, i, &times, &values))
+        {
+            continue;
+        }
+        for (int j = 0; j < times.size(); j++)
+        {
+            qint64 bucket = ((qint64)times.at(j) - fromMs);
+            if (bucket < 0 || times.at(j) >= toMs)
+            {
+                continue;
+            }
+            bucket /= out.bucketMs;
+            if (bucket >= buckets)
+            {
+                continue;
+            }
+            double value = values.at(j);
+            minimum[bucket] = qMin(minimum[bucket], value);
+            maximum[bucket] = qMax(maximum[bucket], value);
+            sum[bucket] += value;
+            count[bucket]++;
+        }
+    }
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    out.min.resize(buckets);
+    out.max.resize(buckets);
+    out.mean.resize(buckets);
+    for (int i = 0; i < buckets; i++)
+    {
+        bool empty = count.at(i) == 0;
+        out.min[i] = empty ? nan : (float)minimum.at(i);
+        out.max[i] = empty ? nan : (float)maximum.at(i);
+        out.mean[i] = empty ? nan : (float)(sum.at(i) / count.at(i));
+    }
+    return true;
+}
+
+
+TelemetryCacheBuilder *TelemetryCacheBuilder::instance()
+{
+    static TelemetryCacheBuilder *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new TelemetryCacheBuilder();
+    }
+    return _instance;
+}
+
+TelemetryCacheBuilder::TelemetryCacheBuilder()
+{
+    m_stopping = 0;
+}
+
+TelemetryCacheBuilder::~TelemetryCacheBuilder()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = 1;
+        m_wake.wakeAll();
+    }
+    wait();
+}
+
+void TelemetryCacheBuilder::enqueue(const QString &tlogFileName)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_queue.contains(tlogFileName)) return;
+    m_queue.append(tlogFileName);
+    m_wake.wakeAll();
+    if (!isRunning()) start(QThread::IdlePriority);
+}
+
+void TelemetryCacheBuilder::run()
+{
+    forever
+    {
+        QString tlogFileName;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_stopping.load())
+            {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_stopping.load()) return;
+            tlogFileName = m_queue.takeFirst();
+        }
+        if (TelemetryCache::isCurrent(tlogFileName))
+        {
+            emit built(tlogFileName);
+            continue;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (!TelemetryCache::build(tlogFileName, &error, &m_stopping))
+        {
+            QLOG_WARN() << "TelemetryCache: could not build the cache of" << tlogFileName << error;
+            continue;
+        }
+        QLOG_INFO() << "TelemetryCache: built the cache of" << tlogFileName << "in" << timer.elapsed() << "ms";
+        emit built(tlogFileName);
+    }
+}
+
+TelemetryCache *TelemetryCacheBuilder::reader(const QString &tlogFile)
+{
+    if (m_readerTlog != tlogFile || !m_reader.isOpen())
+    {
+        m_reader.close();
+        m_readerTlog.clear();
+        if (!TelemetryCache::isCurrent(tlogFile) || !m_reader.open(TelemetryCache::cacheFileName(tlogFile)))
+        {
+            return NULL;
+        }
+        m_readerTlog = tlogFile;
+    }
+    return &m_reader;
+}
+
+QStringList TelemetryCacheBuilder::channelNames(const QString &tlogFile)
+{
+    QStringList names;
+    TelemetryCache *cache = reader(tlogFile);
+    if (cache)
+    {
+        for (int i = 0; i < cache->channels().size(); i++)
+        {
+            names.append(cache->channels().at(i).name);
+        }
+    }
+    return names;
+}
+
+QVariantMap TelemetryCacheBuilder::series(const QString &tlogFile, const QString &channel, int buckets)
+{
+    QVariantMap result;
+    TelemetryCache *cache = reader(tlogFile);
+    TelemetryCache::Series series;
+    if (!cache || !cache->summarize(cache->find(channel), 0, (qint64)cache->durationMs() + 1, buckets, series))
+    {
+        return result;
+    }
+    QVariantList minimum, maximum, mean;
+    for (int i = 0; i < series.min.size(); i++)
+    {
+        minimum.append(series.min.at(i));
+        maximum.append(series.max.at(i));
+        mean.append(series.mean.at(i));
+    }
+    result.insert("startMs", series.startMs);
+    result.insert("bucketMs", series.bucketMs);
+    result.insert("min", minimum);
+    result.insert("max", maximum);
+    result.insert("mean", mean);
+    return result;
+}
+
+QVariantMap TelemetryCacheBuilder::statistics(const QString &tlogFile, const QString &channel)
+{
+    QVariantMap result;
+    TelemetryCache *cache = reader(tlogFile);
+    int id = cache ? cache->find(channel) : -1;
+    if (id < 0)
+    {
+        return result;
+    }
+    const TelemetryCache::Channel &info = cache->channels().at(id);
+    result.insert("count", info.count);
+    result.insert("min", info.count ? info.min : 0);
+    result.insert("max", info.count ? info.max : 0);
+    result.insert("mean", info.count ? info.sum / info.count : 0);
+    return result;
+}
@@ -0,0 +1,187 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryCache
+ *          Columnar sidecar of a .tlog or .ctlog ("<name>.tcache") for plots
+ *          and statistics over a whole flight. Every numeric field of every
+ *          system is a channel ("M<sysid>:MESSAGE.field", ".N" per array
+ *          element) stored as deflated blocks of up to BlockSamples samples:
+ *          millisecond offsets from the start of the log, delta coded, then
+ *          the values. The directory at the end of the file keeps the time
+ *          span, min, max and sum of every block, so a plot whose buckets are
+ *          wider than a block never inflates it and statistics never inflate
+ *          anything. All numbers are big endian.
+ *
+ */
+
+#ifndef TELEMETRYCACHE_H
+#define TELEMETRYCACHE_H
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVariantMap>
+#include <QVector>
+#include <QWaitCondition>
+
+class TelemetryCache
+{
+public:
+    enum ValueType { Float32 = 0, Float64 };
+    enum {
+        BlockSamples = 256,
+        CompressionLevel = 6,
+        HeaderBytes = 32,
+        BlockEntryBytes = 48
+    };
+
+    struct Block
+    {
+        qint64 offset;          ///< Of the deflated block in the file
+        quint32 compressedSize;
+        quint32 count;
+        quint32 firstMs;        ///< From the start of the log
+        quint32 lastMs;
+        double min;
+        double max;
+        double sum;
+    };
+    struct Channel
+    {
+        QString name;
+        QString unit;           ///< C type of the field, as MAVLinkDecoder reports it
+        quint8 type;            ///< ValueType
+        quint8 sysid;
+        QVector<Block> blocks;
+        quint64 count;
+        double min;
+        double max;
+        double sum;
+    };
+    /** @brief min, max and mean of equal time buckets, NaN where a bucket is empty */
+    struct Series
+    {
+        qint64 startMs;
+        int bucketMs;
+        QVector<float> min;
+        QVector<float> max;
+        QVector<float> mean;
+    };
+
+    TelemetryCache();
+
+    static QString cacheFileName(const QString &tlogFileName) { return tlogFileName + ".tcache"; }
+    /** @brief The cache of tlogFileName exists and was built from the log as it is now */
+    static bool isCurrent(const QString &tlogFileName);
+    /**
+     * @brief Decode every frame of tlogFileName into its cache
+     *
+     * Written to "<cache>.part" and renamed when complete, so a cache on
+     * disk is always whole. stop is polled between blocks of frames.
+     */
+    static bool build(const QString &tlogFileName, QString *error, const QAtomicInt *stop = 0);
+
+    // Reader
+    bool open(const QString &cacheFileName);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+    QString errorString() const { return m_error; }
+    /** @brief Microseconds since the epoch of the first frame of the log */
+    quint64 startTime() const { return m_startTime; }
+    quint32 durationMs() const { return m_durationMs; }
+    const QVector<Channel> &channels() const { return m_channels; }
+    /** @brief -1 if the log has no such channel */
+    int find(const QString &name) const { return m_ids.value(name, -1); }
+
+    /** @brief Inflate one block, false on a damaged one */
+    bool readBlock(int channel, int block, QVector<quint32> *timesMs, QVector<double> *values);
+    /**
+     * @brief Summarize [fromMs, toMs) of a channel into buckets
+     *
+     * out keeps its vectors between calls. Blocks that fall into one bucket
+     * are taken from the directory, only the others are inflated.
+     */
+    bool summarize(int channel, qint64 fromMs, qint64 toMs, int buckets, Series &out);
+
+private:
+    QFile m_file;
+    QString m_error;
+    quint64 m_startTime;
+    quint32 m_durationMs;
+    QVector<Channel> m_channels;
+    QHash<QString, int> m_ids;
+};
+
+/**
+ * @brief Builds caches on a thread at idle priority, one log after the other
+ *
+ * MAVLinkProtocol queues every log it closes and FlightReview the log it
+ * opens, so the cache is usually there by the time somebody plots the
+ * flight. The QML side reads caches through series() and statistics(),
+ * which open a cache once and keep it until another log is asked for.
+ */
+class TelemetryCacheBuilder : public QThread
+{
+    Q_OBJECT
+public:
+    static TelemetryCacheBuilder *instance();
+    ~TelemetryCacheBuilder();
+
+    /** @brief Build the cache of tlogFileName unless it is current. Any thread */
+    void enqueue(const QString &tlogFileName);
+
+    /** @brief "M<sysid>:MESSAGE.field" names in the cache of tlogFile, empty until it is built */
+    Q_INVOKABLE QStringList channelNames(const QString &tlogFile);
+    /** @brief {startMs, bucketMs, min, max, mean} over the whole log, see TelemetryCache::summarize */
+    Q_INVOKABLE QVariantMap series(const QString &tlogFile, const QString &channel, int buckets);
+    /** @brief {count, min, max, mean} of the whole log, from the directory only */
+    Q_INVOKABLE QVariantMap statistics(const QString &tlogFile, const QString &channel);
+
+signals:
+    /** @brief The cache of tlogFileName is on disk */
+    void built(QString tlogFileName);
+
+protected:
+    void run();
+
+private:
+    TelemetryCacheBuilder();
+    /** @brief The reader holding tlogFile's cache, NULL if there is none yet. UI thread */
+    TelemetryCache *reader(const QString &tlogFile);
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QStringList m_queue;
+    QAtomicInt m_stopping;
+
+    TelemetryCache m_reader;
+    QString m_readerTlog;
+};
+
+#endif // TELEMETRYCACHE_H
@@ -0,0 +1,154 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryChannels
+ *          See TelemetryChannels.h
+ *
+ */
+
+#include "TelemetryChannels.h"
+#include "QsLog.h"
+
+TelemetryChannels *TelemetryChannels::instance()
+{
+    static TelemetryChannels *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new TelemetryChannels();
+    }
+    return _instance;
+}
+
+TelemetryChannels::TelemetryChannels(QObject *parent) :
+    QObject(parent)
+{
+}
+
+int TelemetryChannels::registerChannel(const QString &name, const QString &unit)
+{
+    QMutexLocker locker(&m_channelsLock);
+    QHash<QString, int>::const_iterator it = m_ids.find(name);
+    if (it != m_ids.end())
+    {
+        return it.value();
+    }
+    // Samples carry the id in 16 bits
+    if (m_channels.size() > 0xFFFF)
+    {
+        QLOG_WARN() << "TelemetryChannels: no id left for" << name;
+        return -1;
+    }
+    Channel channel;
+    channel.name = name;
+    channel.unit = unit;
+    m_channels.append(channel);
+    m_ids.insert(name, m_channels.size() - 1);
+    return m_channels.size() - 1;
+}
+
+int TelemetryChannels::registerChannels(const ChannelInfo *channels, int count)
+{
+    QMutexLocker locker(&m_channelsLock);
+    // A table registered before keeps its ids
+    QHash<QString, int>::const_iterator it = m_ids.find(QString(channels[0].name));
+    if (it != m_ids.end())
+    {
+        return it.value();
+    }
+    int first = m_channels.size();
+    for (int i = 0; i < count; i++)
+    {
+        Channel channel;
+        channel.name = channels[i].name;
+        channel.unit = channels[i].unit;
+        m_channels.append(channel);
+        m_ids.insert(channel.name, first + i);
+    }
+    return first;
+}
+
+int TelemetryChannels::find(const QString &name) const
+{
+    QMutexLocker locker(&m_channelsLock);
+    return m_ids.value(name, -1);
+}
+
+int TelemetryChannels::channelCount() const
+{
+    QMutexLocker locker(&m_channelsLock);
+    return m_channels.size();
+}
+
+QString TelemetryChannels::name(int channel) const
+{
+    QMutexLocker locker(&m_channelsLock);
+    return (channel >= 0 && channel < m_channels.size()) ? m_channels[channel].name : QString();
+}
+
+QString TelemetryChannels::unit(int channel) const
+{
+    QMutexLocker locker(&m_channelsLock);
+    return (channel >= 0 && channel < m_channels.size()) ? m_channels[channel].unit : QString();
+}
+
+QString TelemetryChannels::qualifiedName(int uasId, int channel) const
+{
+    return QString("M%1:%2").arg(uasId).arg(name(channel));
+}
+
+void TelemetryChannels::attachReader()
+{
+    if (m_readers.fetchAndAddOrdered(1) != 0)
+    {
+        QLOG_WARN() << "TelemetryChannels: more than one reader attached, they will split the samples";
+    }
+}
+
+void TelemetryChannels::detachReader()
+{
+    if (!m_readers.deref())
+    {
+        // Nobody drains the ring any more, so drop what is queued
+        TelemetrySample sample;
+        while (m_samples.pop(&sample))
+        {
+        }
+    }
+}
+
+int TelemetryChannels::read(TelemetrySample *out, int max)
+{
+    int count = 0;
+    while (count < max && m_samples.pop(out + count))
+    {
+        count++;
+    }
+    return count;
+}
+
+void TelemetryChannels::notify()
+{
+    m_notifyScheduled.store(0);
+    emit samplesAvailable();
+}
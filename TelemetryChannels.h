@@ -0,0 +1,133 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryChannels
+ *          Registry of the numeric values the UAS objects publish. A channel
+ *          (name and unit) is registered once and from then on is an integer;
+ *          the per message path pushes (vehicle, channel, value, time) into a
+ *          lock free ring and never builds a string. Whoever reads the ring
+ *          resolves names when it needs them, and nothing is queued at all
+ *          while no reader is attached.
+ *
+ */
+
+#ifndef TELEMETRYCHANNELS_H
+#define TELEMETRYCHANNELS_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include "SpscRing.h"
+
+struct TelemetrySample
+{
+    quint64 time;      ///< Unix milliseconds, as the UAS time stamps
+    double value;
+    quint16 uasId;
+    quint16 channel;
+};
+
+class TelemetryChannels : public QObject
+{
+    Q_OBJECT
+public:
+    struct ChannelInfo
+    {
+        const char *name;  ///< Without the M<sysid>: prefix, e.g. "GCS Status.Roll"
+        const char *unit;
+    };
+
+    static TelemetryChannels *instance();
+
+    /** @brief Id of name, registered on the first call; a name keeps its id */
+    int registerChannel(const QString &name, const QString &unit);
+    /** @brief Register a table of channels under consecutive ids, returns the first */
+    int registerChannels(const ChannelInfo *channels, int count);
+    /** @brief -1 if name was never registered */
+    int find(const QString &name) const;
+    int channelCount() const;
+    QString name(int channel) const;
+    QString unit(int channel) const;
+    /** @brief "M<sysid>:name", the names valueChanged used to carry */
+    QString qualifiedName(int uasId, int channel) const;
+
+    /** @brief Hot path on the UI thread; drops the sample if no reader is attached or the ring is full */
+    void post(int uasId, int channel, double value, quint64 time)
+    {
+        if (m_readers.load() == 0)
+        {
+            return;
+        }
+        TelemetrySample sample;
+        sample.time = time;
+        sample.value = value;
+        sample.uasId = uasId;
+        sample.channel = channel;
+        if (!m_samples.push(sample))
+        {
+            m_dropped.ref();
+            return;
+        }
+        if (m_notifyScheduled.testAndSetRelaxed(0, 1))
+        {
+            QMetaObject::invokeMethod(this, "notify", Qt::QueuedConnection);
+        }
+    }
+
+    /** @brief There is one reader of the ring at a time; it attaches before its first read */
+    void attachReader();
+    void detachReader();
+    /** @brief Reader side, from any one thread: take up to max samples, oldest first */
+    int read(TelemetrySample *out, int max);
+    /** @brief Samples lost because the reader fell behind */
+    int dropped() const { return m_dropped.load(); }
+
+signals:
+    /** @brief Samples are waiting, emitted once per burst of posts */
+    void samplesAvailable();
+
+private slots:
+    void notify();
+
+private:
+    explicit TelemetryChannels(QObject *parent = 0);
+    struct Channel
+    {
+        QString name;
+        QString unit;
+    };
+
+    mutable QMutex m_channelsLock;    ///< Readers resolve names from their own thread
+    QVector<Channel> m_channels;
+    QHash<QString, int> m_ids;
+    SpscRing<TelemetrySample, 8192> m_samples;
+    QAtomicInt m_readers;
+    QAtomicInt m_notifyScheduled;
+    QAtomicInt m_dropped;
+};
+
+#endif // TELEMETRYCHANNELS_H
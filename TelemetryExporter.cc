@@ -0,0 +1,438 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryExporter
+ *          See TelemetryExporter.h
+ *
+ */
+
+#include "TelemetryExporter.h"
+#include "TelemetryCache.h"
+#include "TelemetryHistory.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "QsLog.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <cstring>
+
+template<typename T> static void appendLE(QByteArray *out, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out->append((const char*)bytes, sizeof(T));
+}
+
+static void appendName(QByteArray *out, const QString &text)
+{
+    QByteArray utf8 = text.toUtf8().left(0xff);
+    out->append((char)utf8.size());
+    out->append(utf8);
+}
+
+TelemetryExporter *TelemetryExporter::instance()
+{
+    static TelemetryExporter *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new TelemetryExporter();
+    }
+    return _instance;
+}
+
+TelemetryExporter::TelemetryExporter() :
+    m_format(Csv),
+    m_sysid(0),
+    m_history(NULL),
+    m_cache(NULL),
+    m_baseMs(0),
+    m_endMs(0),
+    m_total(0)
+{
+    m_cancel = 0;
+    m_permille = 0;
+    m_exported = 0;
+    connect(this, SIGNAL(started()), this, SIGNAL(busyChanged()));
+    connect(this, SIGNAL(finished()), this, SIGNAL(busyChanged()));
+}
+
+TelemetryExporter::~TelemetryExporter()
+{
+    m_cancel = 1;
+    wait();
+}
+
+bool TelemetryExporter::exportHistory(const QString &fileName, int sysid, const QStringList &channels, int format)
+{
+    if (isRunning() || fileName.isEmpty())
+    {
+        return false;
+    }
+    m_history = LinkManager::instance()->getMavlinkProtocol()->history();
+    m_fileName = fileName;
+    m_format = format;
+    m_sysid = sysid;
+    m_tlogFile.clear();
+    m_channels = channels;
+    // Ring times are the ground clock, the file gets wall clock times
+    qint64 now = m_history->now();
+    m_endMs = (quint32)now;
+    m_baseMs = QDateTime::currentMSecsSinceEpoch() - now;
+    m_cancel = 0;
+    start(QThread::LowPriority);
+    return true;
+}
+
+bool TelemetryExporter::exportCache(const QString &fileName, const QString &tlogFile, const QStringList &channels, int format)
+{
+    if (isRunning() || fileName.isEmpty() || !TelemetryCache::isCurrent(tlogFile))
+    {
+        return false;
+    }
+    m_history = NULL;
+    m_fileName = fileName;
+    m_format = format;
+    m_tlogFile = tlogFile;
+    m_channels = channels;
+    m_cancel = 0;
+    start(QThread::LowPriority);
+    return true;
+}
+
+void TelemetryExporter::cancel()
+{
+    m_cancel = 1;
+}
+
+void TelemetryExporter::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_error.clear();
+    m_exported = 0;
+    m_permille = 0;
+    m_total = 0;
+    m_names.clear();
+    m_units.clear();
+    m_double.clear();
+    emit progressChanged();
+
+    QVector<Cursor> cursors;
+    Cursor cursor;
+    cursor.block = 0;
+    cursor.nextMs = 0;
+    cursor.done = false;
+    cursor.pos = 0;
+
+    TelemetryCache cache;
+    m_cache = NULL;
+    if (m_history)
+    {
+        for (int i = 0; i < TelemetryHistory::ChannelCount; i++)
+        {
+            QString name = TelemetryHistory::channelName(i);
+            if (!m_channels.isEmpty() && !m_channels.contains(name)) continue;
+            cursor.channel = i;
+            cursors.append(cursor);
+            m_names.append(name);
+            m_units.append(TelemetryHistory::channelUnit(i));
+            m_double.append(false);
+            m_total += m_history->count(m_sysid, i);
+        }
+    }
+    else if (cache.open(TelemetryCache::cacheFileName(m_tlogFile)))
+    {
+        m_cache = &cache;
+        m_baseMs = cache.startTime() / 1000;
+        for (int i = 0; i < cache.channels().size(); i++)
+        {
+            const TelemetryCache::Channel &channel = cache.channels().at(i);
+            if (!m_channels.isEmpty() && !m_channels.contains(channel.name)) continue;
+            cursor.channel = i;
+            cursors.append(cursor);
+            m_names.append(channel.name);
+            m_units.append(channel.unit);
+            m_double.append(channel.type == TelemetryCache::Float64);
+            m_total += channel.count;
+        }
+    }
+    else
+    {
+        m_error = cache.errorString();
+    }
+    if (m_error.isEmpty() && cursors.isEmpty())
+    {
+        m_error = "None of the channels exist";
+    }
+
+    QString partName = m_fileName + ".part";
+    bool ok = m_error.isEmpty();
+    if (ok)
+    {
+        m_file.setFileName(partName);
+        if (!m_file.open(QFile::WriteOnly | QFile::Truncate))
+        {
+            m_error = m_file.errorString();
+            ok = false;
+        }
+    }
+    if (ok)
+    {
+        m_buffer.reserve(WriteBytes * 2);
+        ok = (m_format == Binary ? exportBinary(cursors) : exportCsv(cursors)) && write(true);
+        m_file.close();
+        // Replace an older export only with a whole one
+        if (ok && QFile::exists(m_fileName) && !QFile::remove(m_fileName))
+        {
+            m_error = "Cannot replace " + m_fileName;
+            ok = false;
+        }
+        if (ok && !QFile::rename(partName, m_fileName))
+        {
+            m_error = "Cannot rename " + partName;
+            ok = false;
+        }
+        if (!ok)
+        {
+            QFile::remove(partName);
+        }
+    }
+    m_buffer.clear();
+    m_cache = NULL;
+
+    if (ok)
+    {
+        m_permille = 1000;
+        emit progressChanged();
+        QLOG_INFO() << "TelemetryExporter: wrote" << m_exported.load() << "samples to" << m_fileName
+                    << "in" << timer.elapsed() << "ms";
+    }
+    else
+    {
+        QLOG_WARN() << "TelemetryExporter: could not export to" << m_fileName << m_error;
+    }
+    emit exported(m_fileName, ok);
+}
+
+bool TelemetryExporter::fill(Cursor &cursor)
+{
+    cursor.pos = 0;
+    cursor.times.resize(0);
+    cursor.values.resize(0);
+    if (m_cancel.load())
+    {
+        m_error = "Cancelled";
+        cursor.done = true;
+        return false;
+    }
+    if (cursor.done)
+    {
+        return false;
+    }
+
+    if (m_history)
+    {
+        quint32 times[ChunkSamples];
+        float values[ChunkSamples];
+        int count = cursor.nextMs > m_endMs ? 0
+                : m_history->copy(m_sysid, cursor.channel, cursor.nextMs, ChunkSamples, times, values);
+        for (int i = 0; i < count && times[i] <= m_endMs; i++)
+        {
+            cursor.times.append(times[i]);
+            cursor.values.append(values[i]);
+        }
+        if (cursor.times.isEmpty())
+        {
+            cursor.done = true;
+            return false;
+        }
+        cursor.nextMs = cursor.times.last() + 1;
+        return true;
+    }
+
+    if (cursor.block >= m_cache->channels().at(cursor.channel).blocks.size())
+    {
+        cursor.done = true;
+        return false;
+    }
+    if (!m_cache->readBlock(cursor.channel, cursor.block++, &cursor.times, &cursor.values))
+    {
+        m_error = "Damaged cache " + m_cache->fileName();
+        cursor.done = true;
+        return false;
+    }
+    return true;
+}
+
+bool TelemetryExporter::exportCsv(QVector<Cursor> &cursors)
+{
+    m_buffer.append("time_ms");
+    for (int i = 0; i < m_names.size(); i++)
+    {
+        m_buffer.append(',');
+        m_buffer.append(m_names.at(i).toUtf8());
+    }
+    m_buffer.append('\n');
+
+    // Merge the channels on their time stamps, a row per distinct time
+    qint64 rows = 0;
+    forever
+    {
+        bool any = false;
+        quint32 time = 0;
+        for (int i = 0; i < cursors.size(); i++)
+        {
+            Cursor &cursor = cursors[i];
+            while (cursor.pos >= cursor.times.size() && !cursor.done)
+            {
+                fill(cursor);
+            }
+            if (!m_error.isEmpty())
+            {
+                return false;
+            }
+            if (cursor.pos < cursor.times.size() && (!any || cursor.times.at(cursor.pos) < time))
+            {
+                time = cursor.times.at(cursor.pos);
+                any = true;
+            }
+        }
+        if (!any)
+        {
+            return true;
+        }
+
+        m_buffer.append(QByteArray::number(m_baseMs + time));
+        int samples = 0;
+        for (int i = 0; i < cursors.size(); i++)
+        {
+            Cursor &cursor = cursors[i];
+            m_buffer.append(',');
+            if (cursor.pos < cursor.times.size() && cursor.times.at(cursor.pos) == time)
+            {
+                m_buffer.append(QByteArray::number(cursor.values.at(cursor.pos++), 'g', m_double.at(i) ? 17 : 9));
+                samples++;
+            }
+        }
+        m_buffer.append('\n');
+        advance(samples);
+        if (!write(false))
+        {
+            return false;
+        }
+        if (++rows % ChunkSamples == 0 && m_cancel.load())
+        {
+            m_error = "Cancelled";
+            return false;
+        }
+    }
+}
+
+bool TelemetryExporter::exportBinary(QVector<Cursor> &cursors)
+{
+    m_buffer.append("TLEX", 4);
+    appendLE<quint8>(&m_buffer, Version);
+    appendLE<quint8>(&m_buffer, 0);
+    appendLE<quint16>(&m_buffer, (quint16)cursors.size());
+    appendLE<qint64>(&m_buffer, m_baseMs);
+    for (int i = 0; i < cursors.size(); i++)
+    {
+        appendName(&m_buffer, m_names.at(i));
+        appendName(&m_buffer, m_units.at(i));
+        appendLE<quint8>(&m_buffer, m_double.at(i) ? 1 : 0);
+    }
+
+    // A channel after the other, each chunk as read
+    for (int i = 0; i < cursors.size(); i++)
+    {
+        Cursor &cursor = cursors[i];
+        while (fill(cursor))
+        {
+            int count = cursor.times.size();
+            m_buffer.append('C');
+            appendLE<quint16>(&m_buffer, (quint16)i);
+            appendLE<quint32>(&m_buffer, (quint32)count);
+            for (int j = 0; j < count; j++)
+            {
+                appendLE<quint32>(&m_buffer, cursor.times.at(j));
+            }
+            for (int j = 0; j < count; j++)
+            {
+                if (m_double.at(i))
+                {
+                    double value = cursor.values.at(j);
+                    quint64 bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    appendLE<quint64>(&m_buffer, bits);
+                }
+                else
+                {
+                    float value = (float)cursor.values.at(j);
+                    quint32 bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    appendLE<quint32>(&m_buffer, bits);
+                }
+            }
+            advance(count);
+            if (!write(false))
+            {
+                return false;
+            }
+        }
+        if (!m_error.isEmpty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TelemetryExporter::write(bool force)
+{
+    if (m_buffer.isEmpty() || (!force && m_buffer.size() < WriteBytes))
+    {
+        return true;
+    }
+    if (m_file.write(m_buffer) != m_buffer.size())
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+    // Keeps the capacity, appending does not allocate
+    m_buffer.resize(0);
+    return true;
+}
+
+void TelemetryExporter::advance(qint64 samples)
+{
+    m_exported.fetchAndAddRelaxed((int)samples);
+    // The rings may have grown since counting them
+    int permille = m_total > 0 ? (int)qMin<qint64>(999, (qint64)m_exported.load() * 1000 / m_total) : 0;
+    if (permille >= m_permille.load() + 10)
+    {
+        m_permille = permille;
+        emit progressChanged();
+    }
+}
@@ -0,0 +1,150 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryExporter
+ *          Writes channels of the live history rings (TelemetryHistory) or
+ *          of a flight's columnar cache (TelemetryCache) to a file on a
+ *          thread at low priority. Channels are read one chunk at a time,
+ *          so neither the rings' lock nor memory is held for a whole export,
+ *          and written in blocks of WriteBytes to "<file>.part", which is
+ *          renamed when complete and removed on a cancel or an error.
+ *
+ *          Csv: one row per time stamp, "time_ms" in ms since the epoch and
+ *          a column per channel, empty where a channel has no sample then.
+ *
+ *          Binary, little endian:
+ *            header  "TLEX", u8 version, u8 reserved, u16 channels,
+ *                    i64 base, ms since the epoch
+ *            channel u8 n + n bytes name, u8 n + n bytes unit, u8 type,
+ *                    0 float32 or 1 float64, once per channel
+ *            'C'     u16 channel, u32 n, n u32 ms since base, n values
+ *
+ */
+
+#ifndef TELEMETRYEXPORTER_H
+#define TELEMETRYEXPORTER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+class TelemetryCache;
+class TelemetryHistory;
+
+class TelemetryExporter : public QThread
+{
+    Q_OBJECT
+    Q_ENUMS(Format)
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(int exportedSamples READ exportedSamples NOTIFY progressChanged)
+    Q_PROPERTY(QString fileName READ fileName NOTIFY busyChanged)
+    Q_PROPERTY(QString error READ error NOTIFY busyChanged)
+
+public:
+    enum Format { Csv, Binary };
+    enum { ChunkSamples = 4096, WriteBytes = 64 * 1024, Version = 1 };
+
+    static TelemetryExporter *instance();
+    ~TelemetryExporter();
+
+    bool busy() const { return isRunning(); }
+    /** @brief 0 to 1 of the export running or the last one */
+    double progress() const { return m_permille.load() / 1000.0; }
+    int exportedSamples() const { return m_exported.load(); }
+    QString fileName() const { return m_fileName; }
+    /** @brief Why the last export failed, empty if it did not */
+    QString error() const { return m_error; }
+
+    /**
+     * @brief Export what the rings of sysid hold now
+     *
+     * channels are TelemetryHistory::channelName()s, all of them if empty.
+     * Samples recorded after the call are left out. False while busy.
+     */
+    Q_INVOKABLE bool exportHistory(const QString &fileName, int sysid, const QStringList &channels, int format);
+    /** @brief Export channels of the cache of tlogFile, "M<sysid>:MESSAGE.field" names */
+    Q_INVOKABLE bool exportCache(const QString &fileName, const QString &tlogFile, const QStringList &channels, int format);
+    /** @brief Stop the running export and remove its file */
+    Q_INVOKABLE void cancel();
+
+signals:
+    void busyChanged();
+    void progressChanged();
+    /** @brief The export ended, fileName exists if ok */
+    void exported(QString fileName, bool ok);
+
+protected:
+    void run();
+
+private:
+    /** @brief The unread samples of a channel, refilled one chunk at a time */
+    struct Cursor
+    {
+        int channel;            ///< TelemetryHistory::Channel or TelemetryCache channel index
+        int block;              ///< Next cache block to read
+        quint32 nextMs;         ///< Of the next history sample to read
+        bool done;
+        int pos;
+        QVector<quint32> times; ///< ms since the base
+        QVector<double> values;
+    };
+
+    TelemetryExporter();
+    bool fill(Cursor &cursor);
+    bool exportCsv(QVector<Cursor> &cursors);
+    bool exportBinary(QVector<Cursor> &cursors);
+    bool write(bool force);
+    void advance(qint64 samples);
+
+    // Set before start(), read by the thread
+    QString m_fileName;
+    int m_format;
+    int m_sysid;
+    QString m_tlogFile;
+    QStringList m_channels;
+
+    // Worker thread
+    TelemetryHistory *m_history;
+    TelemetryCache *m_cache;
+    qint64 m_baseMs;            ///< ms since the epoch the times count from
+    quint32 m_endMs;            ///< History samples after it are left out
+    QStringList m_names;        ///< Per cursor
+    QStringList m_units;
+    QVector<bool> m_double;     ///< Per cursor, values are float64
+    QFile m_file;
+    QByteArray m_buffer;
+    qint64 m_total;
+
+    QAtomicInt m_cancel;
+    QAtomicInt m_permille;
+    QAtomicInt m_exported;
+    QString m_error;
+};
+
+#endif // TELEMETRYEXPORTER_H
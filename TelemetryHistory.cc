@@ -0,0 +1,424 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryHistory
+ *          See TelemetryHistory.h
+ *
+ */
+
+#include "TelemetryHistory.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+#include <QVariantList>
+#include <limits>
+
+TelemetryHistory::Vehicle::Vehicle(int capacity)
+{
+    for (int channel = 0; channel < ChannelCount; ++channel)
+    {
+        resize(rings[channel], capacity);
+    }
+}
+
+TelemetryHistory::TelemetryHistory(QObject *parent) :
+    QObject(parent),
+    m_capacity(Capacity),
+    m_spacingMs(MinSpacingMs)
+{
+    m_clock.start();
+}
+
+TelemetryHistory::~TelemetryHistory()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        delete m_vehicles[i].loadAcquire();
+    }
+}
+
+TelemetryHistory::Vehicle *TelemetryHistory::vehicle(int sysid)
+{
+    Vehicle *state = m_vehicles[sysid].loadAcquire();
+    if (state)
+    {
+        return state;
+    }
+    QMutexLocker locker(&m_allocLock);
+    state = m_vehicles[sysid].loadAcquire();
+    if (!state)
+    {
+        state = new Vehicle(m_capacity.load());
+        m_vehicles[sysid].storeRelease(state);
+    }
+    return state;
+}
+
+const TelemetryHistory::Vehicle *TelemetryHistory::find(int sysid) const
+{
+    if (sysid < 0 || sysid > 255)
+    {
+        return 0;
+    }
+    return m_vehicles[sysid].loadAcquire();
+}
+
+void TelemetryHistory::append(Ring &ring, quint32 time, float value) const
+{
+    if (ring.count > 0 && time - ring.times[(ring.head - 1) & ring.mask] < static_cast<quint32>(m_spacingMs.load()))
+    {
+        return;
+    }
+    ring.times[ring.head] = time;
+    ring.values[ring.head] = value;
+    ring.head = (ring.head + 1) & ring.mask;
+    if (ring.count <= ring.mask)
+    {
+        ++ring.count;
+    }
+}
+
+void TelemetryHistory::resize(Ring &ring, int capacity)
+{
+    quint32 *times = new quint32[capacity];
+    float *values = new float[capacity];
+    // Oldest kept sample first, so the ring starts over at slot 0
+    const int count = qMin(ring.count, capacity);
+    for (int i = 0; i < count; ++i)
+    {
+        const int slot = (ring.head - count + i) & ring.mask;
+        times[i] = ring.times[slot];
+        values[i] = ring.values[slot];
+    }
+    delete[] ring.times;
+    delete[] ring.values;
+    ring.times = times;
+    ring.values = values;
+    ring.mask = capacity - 1;
+    ring.count = count;
+    ring.head = count & ring.mask;
+}
+
+void TelemetryHistory::setSpacingMs(int ms)
+{
+    m_spacingMs.store(qMax(0, ms));
+}
+
+void TelemetryHistory::setCapacity(int samples)
+{
+    int capacity = 16;
+    while (capacity < samples && capacity < Capacity)
+    {
+        capacity *= 2;
+    }
+    QMutexLocker allocLocker(&m_allocLock);
+    if (capacity == m_capacity.load())
+    {
+        return;
+    }
+    m_capacity.store(capacity);
+    for (int i = 0; i < 256; ++i)
+    {
+        Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        for (int channel = 0; channel < ChannelCount; ++channel)
+        {
+            resize(state->rings[channel], capacity);
+        }
+    }
+}
+
+qint64 TelemetryHistory::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        const Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        bytes += sizeof(Vehicle);
+        for (int channel = 0; channel < ChannelCount; ++channel)
+        {
+            bytes += (state->rings[channel].mask + 1) * qint64(sizeof(quint32) + sizeof(float));
+        }
+    }
+    return bytes;
+}
+
+void TelemetryHistory::record(const mavlink_message_t &message)
+{
+    switch (message.msgid)
+    {
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    case MAVLINK_MSG_ID_VFR_HUD:
+    case MAVLINK_MSG_ID_SYS_STATUS:
+        break;
+    default:
+        return;
+    }
+    quint32 time = static_cast<quint32>(now());
+    Vehicle *state = vehicle(message.sysid);
+    QMutexLocker locker(&state->lock);
+    switch (message.msgid)
+    {
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        append(state->rings[AltitudeChannel], time, mavlink::GlobalPositionInt(message).relative_alt() / 1000.0f);
+        break;
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink::VfrHud hud(message);
+        append(state->rings[ClimbRateChannel], time, hud.climb());
+        append(state->rings[GroundSpeedChannel], time, hud.groundspeed());
+        append(state->rings[AirSpeedChannel], time, hud.airspeed());
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink::SysStatus status(message);
+        if (status.battery_remaining() >= 0)
+        {
+            append(state->rings[BatteryChannel], time, status.battery_remaining());
+        }
+        if (status.voltage_battery() != 0xFFFF)
+        {
+            append(state->rings[VoltageChannel], time, status.voltage_battery() / 1000.0f);
+        }
+        break;
+    }
+    }
+}
+
+void TelemetryHistory::record(int sysid, int channel, float value)
+{
+    if (sysid < 0 || sysid > 255 || channel < 0 || channel >= ChannelCount)
+    {
+        return;
+    }
+    Vehicle *state = vehicle(sysid);
+    QMutexLocker locker(&state->lock);
+    append(state->rings[channel], static_cast<quint32>(now()), value);
+}
+
+void TelemetryHistory::clear()
+{
+    // Rings stay allocated, a reader on the UI thread may hold a vehicle
+    for (int i = 0; i < 256; ++i)
+    {
+        Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        for (int channel = 0; channel < ChannelCount; ++channel)
+        {
+            state->rings[channel].head = 0;
+            state->rings[channel].count = 0;
+        }
+    }
+}
+
+bool TelemetryHistory::decimate(int sysid, int channel, int spanMs, int buckets, Series &out) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || channel < 0 || channel >= ChannelCount || spanMs <= 0 || buckets <= 0)
+    {
+        return false;
+    }
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    out.bucketMs = qMax(1, spanMs / buckets);
+    out.endMs = now();
+    out.min.fill(nan, buckets);
+    out.max.fill(nan, buckets);
+    out.mean.fill(0, buckets);
+    QVector<int> counts(buckets, 0);
+    quint32 end = static_cast<quint32>(out.endMs);
+    quint32 span = static_cast<quint32>(out.bucketMs) * buckets;
+
+    {
+        QMutexLocker locker(&state->lock);
+        const Ring &ring = state->rings[channel];
+        // Newest first, stop at the first sample older than the span
+        for (int i = 0, slot = ring.head; i < ring.count; ++i)
+        {
+            slot = (slot - 1) & ring.mask;
+            quint32 age = end - ring.times[slot];
+            if (age >= span)
+            {
+                break;
+            }
+            int bucket = buckets - 1 - static_cast<int>(age / out.bucketMs);
+            float value = ring.values[slot];
+            if (counts.at(bucket) == 0)
+            {
+                out.min[bucket] = value;
+                out.max[bucket] = value;
+            }
+            else
+            {
+                out.min[bucket] = qMin(out.min.at(bucket), value);
+                out.max[bucket] = qMax(out.max.at(bucket), value);
+            }
+            out.mean[bucket] += value;
+            ++counts[bucket];
+        }
+    }
+
+    for (int bucket = 0; bucket < buckets; ++bucket)
+    {
+        out.mean[bucket] = counts.at(bucket) ? out.mean.at(bucket) / counts.at(bucket) : nan;
+    }
+    return true;
+}
+
+QVariantMap TelemetryHistory::series(int sysid, int channel, int spanSeconds, int buckets) const
+{
+    QVariantMap map;
+    Series series;
+    if (!decimate(sysid, channel, spanSeconds * 1000, buckets, series))
+    {
+        return map;
+    }
+    QVariantList min;
+    QVariantList max;
+    QVariantList mean;
+    for (int i = 0; i < buckets; ++i)
+    {
+        min.append(series.min.at(i));
+        max.append(series.max.at(i));
+        mean.append(series.mean.at(i));
+    }
+    map.insert("bucketMs", series.bucketMs);
+    map.insert("min", min);
+    map.insert("max", max);
+    map.insert("mean", mean);
+    return map;
+}
+
+int TelemetryHistory::count(int sysid, int channel) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || channel < 0 || channel >= ChannelCount)
+    {
+        return 0;
+    }
+    QMutexLocker locker(&state->lock);
+    return state->rings[channel].count;
+}
+
+int TelemetryHistory::copy(int sysid, int channel, quint32 fromMs, int max, quint32 *times, float *values) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || channel < 0 || channel >= ChannelCount || max <= 0)
+    {
+        return 0;
+    }
+    QMutexLocker locker(&state->lock);
+    const Ring &ring = state->rings[channel];
+    int copied = 0;
+    // Oldest first; the times of a ring only grow
+    for (int i = 0, slot = (ring.head - ring.count) & ring.mask; i < ring.count && copied < max; ++i)
+    {
+        if (ring.times[slot] >= fromMs)
+        {
+            times[copied] = ring.times[slot];
+            values[copied] = ring.values[slot];
+            ++copied;
+        }
+        slot = (slot + 1) & ring.mask;
+    }
+    return copied;
+}
+
+const char *TelemetryHistory::channelName(int channel)
+{
+    static const char *names[ChannelCount] = { "altitude", "climb_rate", "ground_speed", "air_speed", "battery", "voltage" };
+    return channel >= 0 && channel < ChannelCount ? names[channel] : "";
+}
+
+const char *TelemetryHistory::channelUnit(int channel)
+{
+    static const char *units[ChannelCount] = { "m", "m/s", "m/s", "m/s", "%", "V" };
+    return channel >= 0 && channel < ChannelCount ? units[channel] : "";
+}
+
+double TelemetryHistory::latest(int sysid, int channel) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || channel < 0 || channel >= ChannelCount)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    QMutexLocker locker(&state->lock);
+    const Ring &ring = state->rings[channel];
+    if (ring.count == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return ring.values[(ring.head - 1) & ring.mask];
+}
+
+double TelemetryHistory::trend(int sysid, int channel, int seconds) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || channel < 0 || channel >= ChannelCount || seconds <= 0)
+    {
+        return 0;
+    }
+    quint32 end = static_cast<quint32>(now());
+    quint32 span = static_cast<quint32>(seconds) * 1000;
+    // Sums relative to the newest sample keep the numbers small
+    double n = 0, sumT = 0, sumV = 0, sumTT = 0, sumTV = 0;
+    {
+        QMutexLocker locker(&state->lock);
+        const Ring &ring = state->rings[channel];
+        for (int i = 0, slot = ring.head; i < ring.count; ++i)
+        {
+            slot = (slot - 1) & ring.mask;
+            quint32 age = end - ring.times[slot];
+            if (age >= span)
+            {
+                break;
+            }
+            double t = -(age / 1000.0);
+            double v = ring.values[slot];
+            n += 1;
+            sumT += t;
+            sumV += v;
+            sumTT += t * t;
+            sumTV += t * v;
+        }
+    }
+    double denominator = n * sumTT - sumT * sumT;
+    if (n < 2 || denominator <= 0)
+    {
+        return 0;
+    }
+    return (n * sumTV - sumT * sumV) / denominator;
+}
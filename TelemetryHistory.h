@@ -0,0 +1,170 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryHistory
+ *          The last ten minutes of a few slow vehicle values (altitude,
+ *          battery, speeds) for plots and trend arrows. Every vehicle and
+ *          channel has a fixed ring of timestamps and a separate ring of
+ *          values, allocated on the vehicle's first message and only resized
+ *          by setCapacity(), so recording is two stores and decimating walks
+ *          two flat arrays.
+ *          Recording happens on the ingest thread, before the UI thread
+ *          coalesces bursts, so no sample is lost to a busy frame.
+ *
+ */
+
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVariantMap>
+#include <QVector>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class TelemetryHistory : public QObject
+{
+    Q_OBJECT
+    Q_ENUMS(Channel)
+public:
+    enum Channel {
+        AltitudeChannel,        ///< m above home, GLOBAL_POSITION_INT
+        ClimbRateChannel,       ///< m/s, VFR_HUD
+        GroundSpeedChannel,     ///< m/s, VFR_HUD
+        AirSpeedChannel,        ///< m/s, VFR_HUD
+        BatteryChannel,         ///< Percent remaining, SYS_STATUS
+        VoltageChannel,         ///< V, SYS_STATUS
+        ChannelCount
+    };
+    /** @brief Samples per ring, a power of two; at MinSpacingMs this is over ten minutes.
+     *  LowMemoryCapacity is what MemoryBudget shrinks the rings to, under two minutes */
+    enum { Capacity = 8192, LowMemoryCapacity = 1024, MinSpacingMs = 100 };
+
+    /** @brief min, max and mean of equal time buckets, NaN where a bucket is empty */
+    struct Series
+    {
+        qint64 endMs;           ///< Ground clock at the end of the last bucket
+        int bucketMs;
+        QVector<float> min;
+        QVector<float> max;
+        QVector<float> mean;
+    };
+
+    explicit TelemetryHistory(QObject *parent = 0);
+    ~TelemetryHistory();
+
+    /** @brief Record what message carries for its system. Ingest thread, called for every message */
+    void record(const mavlink_message_t &message);
+    /** @brief Record one value by hand, e.g. from a replay. Any thread */
+    void record(int sysid, int channel, float value);
+    void clear();
+
+    /**
+     * @brief Samples each ring keeps, rounded up to a power of two up to Capacity
+     *
+     * Existing rings are reallocated and keep their newest samples, so
+     * shrinking frees memory right away at the cost of the oldest history.
+     */
+    void setCapacity(int samples);
+    int capacity() const { return m_capacity.load(); }
+    /**
+     * @brief Least time between two samples of a channel, MinSpacingMs by default
+     *
+     * A coarser spacing stretches the rings over more time and costs the
+     * ingest thread fewer stores; samples already recorded are kept.
+     */
+    void setSpacingMs(int ms);
+    int spacingMs() const { return m_spacingMs.load(); }
+    /** @brief Bytes held by the rings of every vehicle */
+    qint64 memoryBytes() const;
+
+    /** @brief Monotonic ground clock in ms the samples are stamped with */
+    qint64 now() const { return m_clock.elapsed(); }
+
+    /**
+     * @brief Summarize the last spanMs of a channel into buckets
+     *
+     * out keeps its vectors between calls, so a plot refreshing at a fixed
+     * width does not allocate. False when the vehicle has no history.
+     */
+    bool decimate(int sysid, int channel, int spanMs, int buckets, Series &out) const;
+
+    /** @brief {bucketMs, min, max, mean} for QML, see decimate */
+    Q_INVOKABLE QVariantMap series(int sysid, int channel, int spanSeconds, int buckets) const;
+    /** @brief Samples the ring of a channel holds now */
+    int count(int sysid, int channel) const;
+    /**
+     * @brief Copy up to max samples from fromMs on, oldest first
+     *
+     * For exports: the lock is held for one chunk, so recording goes on
+     * between chunks. Returns the number of samples copied.
+     */
+    int copy(int sysid, int channel, quint32 fromMs, int max, quint32 *times, float *values) const;
+    /** @brief Short name and unit of a channel, e.g. "altitude" and "m" */
+    static const char *channelName(int channel);
+    static const char *channelUnit(int channel);
+
+    /** @brief Newest value, NaN when there is none */
+    Q_INVOKABLE double latest(int sysid, int channel) const;
+    /** @brief Least squares slope over the last seconds in units per second, 0 with fewer than two samples */
+    Q_INVOKABLE double trend(int sysid, int channel, int seconds) const;
+
+private:
+    Q_DISABLE_COPY(TelemetryHistory)
+
+    struct Ring
+    {
+        Ring() : times(0), values(0), mask(0), head(0), count(0) { }
+        ~Ring() { delete[] times; delete[] values; }
+        quint32 *times;             ///< Ground clock ms
+        float *values;
+        int mask;                   ///< Capacity of the ring - 1
+        int head;                   ///< Next slot written
+        int count;
+    };
+    struct Vehicle
+    {
+        explicit Vehicle(int capacity);
+        mutable QMutex lock;        ///< Ingest thread writes, UI thread reads
+        Ring rings[ChannelCount];
+    };
+
+    Vehicle *vehicle(int sysid);
+    void append(Ring &ring, quint32 time, float value) const;
+    /** @brief Reallocate ring for capacity samples, keeping the newest */
+    static void resize(Ring &ring, int capacity);
+
+    const Vehicle *find(int sysid) const;
+
+    QAtomicPointer<Vehicle> m_vehicles[256];   ///< Allocated on first sample, then kept
+    QMutex m_allocLock;
+    QAtomicInt m_capacity;      ///< Of the rings of new vehicles, under m_allocLock when changed
+    QAtomicInt m_spacingMs;     ///< Read by the ingest thread
+    QElapsedTimer m_clock;
+};
+
+#endif // TELEMETRYHISTORY_H
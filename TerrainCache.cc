@@ -0,0 +1,316 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TerrainCache
+ *          See TerrainCache.h
+ *
+ */
+
+#include "TerrainCache.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+#include "QsLog.h"
+#include <QDir>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cmath>
+
+// A changed agl below this is not worth a property notification
+static const float minAglStep = 0.1f;
+static const double defaultMinClearance = 30.0;
+
+TerrainCache::TerrainCache(QObject *parent) :
+    QObject(parent),
+    m_directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/terrain"),
+    m_sysid(-1),
+    m_minClearance(defaultMinClearance)
+{
+}
+
+TerrainCache::~TerrainCache()
+{
+    clearTiles();
+}
+
+void TerrainCache::clearTiles()
+{
+    foreach (Tile *entry, m_tiles)
+    {
+        entry->file.unmap(const_cast<uchar*>(entry->data));
+        delete entry;
+    }
+    m_tiles.clear();
+    m_missing.clear();
+}
+
+QString TerrainCache::tileName(int latDegree, int lonDegree)
+{
+    return QString("%1%2%3%4.hgt")
+            .arg(latDegree < 0 ? 'S' : 'N')
+            .arg(qAbs(latDegree), 2, 10, QLatin1Char('0'))
+            .arg(lonDegree < 0 ? 'W' : 'E')
+            .arg(qAbs(lonDegree), 3, 10, QLatin1Char('0'));
+}
+
+QString TerrainCache::directory() const
+{
+    QMutexLocker locker(&m_tilesLock);
+    return m_directory;
+}
+
+void TerrainCache::setDirectory(const QString &directory)
+{
+    {
+        QMutexLocker locker(&m_tilesLock);
+        if (directory == m_directory)
+        {
+            return;
+        }
+        m_directory = directory;
+        clearTiles();
+    }
+    emit directoryChanged();
+}
+
+TerrainCache::Tile *TerrainCache::tile(int latDegree, int lonDegree)
+{
+    const int key = tileKey(latDegree, lonDegree);
+    for (int i = 0; i < m_tiles.size(); ++i)
+    {
+        if (m_tiles.at(i)->key == key)
+        {
+            if (i > 0)
+            {
+                m_tiles.move(i, 0);
+            }
+            return m_tiles.first();
+        }
+    }
+    if (m_missing.contains(key))
+    {
+        return 0;
+    }
+
+    Tile *entry = new Tile;
+    entry->key = key;
+    entry->data = 0;
+    entry->size = 0;
+    entry->file.setFileName(QDir(m_directory).filePath(tileName(latDegree, lonDegree)));
+    const qint64 bytes = entry->file.size();
+    const int side = static_cast<int>(std::sqrt(bytes / 2.0) + 0.5);
+    if (side >= 2 && qint64(side) * side * 2 == bytes && entry->file.open(QIODevice::ReadOnly))
+    {
+        entry->data = entry->file.map(0, bytes);
+        entry->size = side;
+    }
+    if (!entry->data)
+    {
+        if (entry->file.exists())
+        {
+            QLOG_WARN() << "Terrain tile" << entry->file.fileName() << "is not a square int16 grid";
+        }
+        m_missing.insert(key);
+        delete entry;
+        return 0;
+    }
+    QLOG_DEBUG() << "Terrain tile" << entry->file.fileName() << "mapped," << side << "samples a side";
+
+    if (m_tiles.size() == MaxResidentTiles)
+    {
+        Tile *oldest = m_tiles.takeLast();
+        oldest->file.unmap(const_cast<uchar*>(oldest->data));
+        delete oldest;
+    }
+    m_tiles.prepend(entry);
+    return entry;
+}
+
+bool TerrainCache::height(qint32 lat, qint32 lon, float *metres)
+{
+    const double latitude = lat * 1E-7;
+    const double longitude = lon * 1E-7;
+    const int latDegree = static_cast<int>(std::floor(latitude));
+    const int lonDegree = static_cast<int>(std::floor(longitude));
+    if (latDegree < -90 || latDegree >= 90 || lonDegree < -180 || lonDegree >= 180)
+    {
+        return false;
+    }
+
+    QMutexLocker locker(&m_tilesLock);
+    const Tile *entry = tile(latDegree, lonDegree);
+    if (!entry)
+    {
+        return false;
+    }
+
+    // Row 0 is the northern edge, column 0 the western one
+    const int last = entry->size - 1;
+    const double y = (latDegree + 1 - latitude) * last;
+    const double x = (longitude - lonDegree) * last;
+    const int row = qBound(0, static_cast<int>(y), last - 1);
+    const int col = qBound(0, static_cast<int>(x), last - 1);
+    const double fy = y - row;
+    const double fx = x - col;
+
+    const uchar *base = entry->data + (qint64(row) * entry->size + col) * 2;
+    const qint16 samples[4] = {
+        qFromBigEndian<qint16>(base),
+        qFromBigEndian<qint16>(base + 2),
+        qFromBigEndian<qint16>(base + entry->size * 2),
+        qFromBigEndian<qint16>(base + entry->size * 2 + 2)
+    };
+    const double weights[4] = { (1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy };
+    // Voids drop out and the others are weighted up
+    double sum = 0;
+    double weight = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (samples[i] != NoData)
+        {
+            sum += samples[i] * weights[i];
+            weight += weights[i];
+        }
+    }
+    if (weight <= 0)
+    {
+        return false;
+    }
+    *metres = static_cast<float>(sum / weight);
+    return true;
+}
+
+void TerrainCache::record(const mavlink_message_t &message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_GLOBAL_POSITION_INT)
+    {
+        return;
+    }
+    mavlink::GlobalPositionInt position(message);
+    if (position.lat() == 0 && position.lon() == 0)
+    {
+        // No fix yet
+        return;
+    }
+
+    Result result;
+    result.valid = height(position.lat(), position.lon(), &result.terrain);
+    if (result.valid)
+    {
+        result.agl = position.alt() / 1000.0f - result.terrain;
+        result.low = result.agl < m_minClearance;
+    }
+
+    bool changed;
+    bool crossed;
+    {
+        QMutexLocker locker(&m_resultsLock);
+        Result &previous = m_results[message.sysid];
+        crossed = previous.low != result.low;
+        changed = previous.valid != result.valid || crossed
+                || std::fabs(previous.agl - result.agl) >= minAglStep;
+        // Small steps accumulate until they are worth a notification
+        if (changed || !result.valid)
+        {
+            previous = result;
+        }
+    }
+    if (crossed)
+    {
+        emit clearanceChanged(message.sysid, result.low);
+    }
+    if (changed && message.sysid == m_sysid)
+    {
+        emit terrainChanged();
+    }
+}
+
+void TerrainCache::setSysid(int sysid)
+{
+    if (sysid == m_sysid)
+    {
+        return;
+    }
+    m_sysid = sysid;
+    emit terrainChanged();
+}
+
+bool TerrainCache::valid() const
+{
+    if (m_sysid < 0 || m_sysid > 255)
+    {
+        return false;
+    }
+    QMutexLocker locker(&m_resultsLock);
+    return m_results[m_sysid].valid;
+}
+
+double TerrainCache::terrainHeight() const
+{
+    if (m_sysid < 0 || m_sysid > 255)
+    {
+        return 0;
+    }
+    QMutexLocker locker(&m_resultsLock);
+    return m_results[m_sysid].terrain;
+}
+
+double TerrainCache::agl() const
+{
+    if (m_sysid < 0 || m_sysid > 255)
+    {
+        return 0;
+    }
+    QMutexLocker locker(&m_resultsLock);
+    return m_results[m_sysid].agl;
+}
+
+bool TerrainCache::lowClearance() const
+{
+    if (m_sysid < 0 || m_sysid > 255)
+    {
+        return false;
+    }
+    QMutexLocker locker(&m_resultsLock);
+    return m_results[m_sysid].valid && m_results[m_sysid].low;
+}
+
+void TerrainCache::setMinClearance(double metres)
+{
+    if (metres == m_minClearance)
+    {
+        return;
+    }
+    m_minClearance = metres;
+    emit minClearanceChanged();
+}
+
+qint64 TerrainCache::mappedBytes() const
+{
+    QMutexLocker locker(&m_tilesLock);
+    qint64 bytes = 0;
+    foreach (const Tile *entry, m_tiles)
+    {
+        bytes += qint64(entry->size) * entry->size * 2;
+    }
+    return bytes;
+}
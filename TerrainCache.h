@@ -0,0 +1,140 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TerrainCache
+ *          Terrain height under every vehicle from offline SRTM tiles, for
+ *          an above ground level readout and a terrain clearance warning
+ *          without network access. Tiles are the plain one degree .hgt
+ *          files (N47E008.hgt: big endian int16 metres on a square grid,
+ *          rows from north to south, 1201 or 3601 a side) in directory().
+ *          They are memory mapped, not read, so only the pages a flight
+ *          touches become resident; at most MaxResidentTiles stay mapped,
+ *          the least recently used is unmapped first.
+ *          Sampling is bilinear and happens on the ingest thread for every
+ *          GLOBAL_POSITION_INT, like TrackHistory. The displayed vehicle's
+ *          result is published through the properties.
+ *
+ */
+
+#ifndef TERRAINCACHE_H
+#define TERRAINCACHE_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class TerrainCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int sysid READ sysid WRITE setSysid NOTIFY terrainChanged)
+    Q_PROPERTY(bool valid READ valid NOTIFY terrainChanged)
+    Q_PROPERTY(double terrainHeight READ terrainHeight NOTIFY terrainChanged)
+    Q_PROPERTY(double agl READ agl NOTIFY terrainChanged)
+    Q_PROPERTY(bool lowClearance READ lowClearance NOTIFY terrainChanged)
+    Q_PROPERTY(double minClearance READ minClearance WRITE setMinClearance NOTIFY minClearanceChanged)
+    Q_PROPERTY(QString directory READ directory WRITE setDirectory NOTIFY directoryChanged)
+public:
+    enum {
+        MaxResidentTiles = 16,
+        NoData = -32768         ///< SRTM void
+    };
+
+    explicit TerrainCache(QObject *parent = 0);
+    ~TerrainCache();
+
+    /** @brief Sample the terrain under a GLOBAL_POSITION_INT. Ingest thread, called for every message */
+    void record(const mavlink_message_t &message);
+    /** @brief Terrain height in m AMSL at lat, lon in degrees * 1E7, false without a tile or on a void. Any thread */
+    bool height(qint32 lat, qint32 lon, float *metres);
+
+    /** @brief Where the .hgt tiles are, by default terrain/ in the app data */
+    QString directory() const;
+    void setDirectory(const QString &directory);
+
+    /** @brief The vehicle the properties describe */
+    int sysid() const { return m_sysid; }
+    void setSysid(int sysid);
+    /** @brief False while the vehicle flies where no tile covers it */
+    bool valid() const;
+    double terrainHeight() const;
+    /** @brief m above the terrain */
+    double agl() const;
+    /** @brief agl below minClearance */
+    bool lowClearance() const;
+
+    double minClearance() const { return m_minClearance; }
+    void setMinClearance(double metres);
+
+    /** @brief Bytes mapped by the resident tiles, only the touched part of it is in memory */
+    qint64 mappedBytes() const;
+
+signals:
+    /** @brief Emitted from the ingest thread when the displayed vehicle's values changed */
+    void terrainChanged();
+    /** @brief A vehicle went below or back above minClearance. Emitted from the ingest thread */
+    void clearanceChanged(int sysid, bool low);
+    void minClearanceChanged();
+    void directoryChanged();
+
+private:
+    Q_DISABLE_COPY(TerrainCache)
+
+    struct Tile
+    {
+        int key;
+        QFile file;
+        const uchar *data;
+        int size;           ///< Samples a side
+    };
+    struct Result
+    {
+        Result() : valid(false), low(false), terrain(0), agl(0) { }
+        bool valid;
+        bool low;
+        float terrain;      ///< m AMSL
+        float agl;          ///< m
+    };
+
+    Tile *tile(int latDegree, int lonDegree);
+    void clearTiles();
+    static int tileKey(int latDegree, int lonDegree) { return (latDegree + 90) * 360 + (lonDegree + 180); }
+    static QString tileName(int latDegree, int lonDegree);
+
+    mutable QMutex m_tilesLock;         ///< Ingest thread samples, UI thread may change the directory
+    QString m_directory;
+    QList<Tile*> m_tiles;               ///< Most recently used first
+    QSet<int> m_missing;                ///< Keys without a file, not looked up again
+
+    mutable QMutex m_resultsLock;
+    Result m_results[256];
+    volatile int m_sysid;
+    volatile double m_minClearance;
+};
+
+#endif // TERRAINCACHE_H
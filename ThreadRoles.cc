@@ -0,0 +1,302 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ThreadRoles
+ *          See ThreadRoles.h
+ *
+ */
+
+#include "ThreadRoles.h"
+#include "QsLog.h"
+#include <QDir>
+#include <QFile>
+#include <QPair>
+#include <QSettings>
+#include <QStringList>
+#include <QThread>
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct RoleInfo
+{
+    const char *key;                ///< THREAD_ROLES setting prefix
+    const char *name;
+    int nice;
+    ThreadRoles::Affinity affinity;
+};
+
+// Video and render share the frame deadline, logging only has to keep up
+static const RoleInfo roles[ThreadRoles::RoleCount] =
+{
+    { "LINK_IO", "link I/O", -4, ThreadRoles::BigCores },
+    { "INGEST", "ingest", -4, ThreadRoles::BigCores },
+    { "VIDEO", "video", -8, ThreadRoles::BigCores },
+    { "RENDER", "render", -8, ThreadRoles::BigCores },
+    { "UI", "UI", -4, ThreadRoles::BigCores },
+    { "LOGGING", "logging", 10, ThreadRoles::LittleCores },
+    { "AUDIO", "audio", -16, ThreadRoles::AnyCore }
+};
+
+static const char * const affinityNames[] = { "any", "big", "little" };
+
+ThreadRoles *ThreadRoles::instance()
+{
+    static ThreadRoles *_instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new ThreadRoles();
+    }
+    return _instance;
+}
+
+ThreadRoles::ThreadRoles() :
+    m_refusedRoles(0),
+    m_lastPublish(0)
+{
+    loadPolicies();
+    findCores();
+    m_clock.start();
+    m_timer.setInterval(PublishMs);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(publish()));
+}
+
+void ThreadRoles::loadPolicies()
+{
+    QSettings settings;
+    settings.beginGroup("THREAD_ROLES");
+    for (int i = 0; i < RoleCount; ++i)
+    {
+        const QString key = QLatin1String(roles[i].key);
+        m_nice[i] = qBound(-20, settings.value(key + "_NICE", roles[i].nice).toInt(), 19);
+        const QString affinity = settings.value(key + "_AFFINITY", affinityNames[roles[i].affinity]).toString();
+        m_affinity[i] = roles[i].affinity;
+        for (int a = AnyCore; a <= LittleCores; ++a)
+        {
+            if (affinity == QLatin1String(affinityNames[a]))
+            {
+                m_affinity[i] = static_cast<Affinity>(a);
+            }
+        }
+    }
+    settings.endGroup();
+}
+
+void ThreadRoles::findCores()
+{
+    QList<QPair<int, qint64> > cores;
+    qint64 highest = 0;
+    for (int cpu = 0; cpu < QThread::idealThreadCount(); ++cpu)
+    {
+        QFile file(QString("/sys/devices/system/cpu/cpu%1/cpufreq/cpuinfo_max_freq").arg(cpu));
+        const qint64 frequency = file.open(QIODevice::ReadOnly) ? file.readAll().trimmed().toLongLong() : 0;
+        cores.append(qMakePair(cpu, frequency));
+        highest = qMax(highest, frequency);
+    }
+    for (int i = 0; i < cores.size(); ++i)
+    {
+        (cores.at(i).second == highest ? m_bigCores : m_littleCores).append(cores.at(i).first);
+    }
+    if (m_littleCores.isEmpty())
+    {
+        m_littleCores = m_bigCores;
+    }
+    QLOG_INFO() << "Big cores" << m_bigCores << "little cores" << m_littleCores;
+}
+
+int ThreadRoles::currentTid()
+{
+#ifdef Q_OS_LINUX
+    return static_cast<int>(syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+}
+
+void ThreadRoles::enter(Role role)
+{
+    ThreadRoles *self = instance();
+    const int tid = currentTid();
+    {
+        QMutexLocker locker(&self->m_mutex);
+        if (self->m_threads.value(tid, -1) == role)
+        {
+            return;
+        }
+        self->m_threads.insert(tid, role);
+    }
+    self->apply(tid, role);
+}
+
+void ThreadRoles::apply(int tid, Role role)
+{
+#ifdef Q_OS_LINUX
+    bool ok = setpriority(PRIO_PROCESS, tid, m_nice[role]) == 0;
+    const QList<int> &cores = m_affinity[role] == BigCores ? m_bigCores : m_littleCores;
+    if (m_affinity[role] != AnyCore && !cores.isEmpty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        foreach (int cpu, cores)
+        {
+            CPU_SET(cpu, &set);
+        }
+        ok = sched_setaffinity(tid, sizeof(set), &set) == 0 && ok;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!ok && !(m_refusedRoles & (1 << role)))
+    {
+        m_refusedRoles |= 1 << role;
+        QLOG_WARN() << "Thread role" << roles[role].name << "policy, nice" << m_nice[role]
+                    << affinityNames[m_affinity[role]] << "cores, refused:" << strerror(errno);
+    }
+#else
+    Q_UNUSED(tid);
+    Q_UNUSED(role);
+#endif
+}
+
+void ThreadRoles::adopt(Role role, const QString &name)
+{
+    const QString kernelName = name.left(15);
+    QDir tasks(QLatin1String("/proc/self/task"));
+    foreach (const QString &task, tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QFile comm(tasks.filePath(task + "/comm"));
+        if (!comm.open(QIODevice::ReadOnly) || QString::fromLocal8Bit(comm.readAll()).trimmed() != kernelName)
+        {
+            continue;
+        }
+        const int tid = task.toInt();
+        {
+            QMutexLocker locker(&m_mutex);
+            m_threads.insert(tid, role);
+        }
+        apply(tid, role);
+    }
+}
+
+void ThreadRoles::attach(QObject *window)
+{
+    enter(Ui);
+    // Emitted on the render thread, which with the basic render loop is this one
+    connect(window, SIGNAL(sceneGraphInitialized()), this, SLOT(enterRender()), Qt::DirectConnection);
+}
+
+void ThreadRoles::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled())
+    {
+        return;
+    }
+    if (enabled)
+    {
+        m_ticks.clear();
+        m_lastPublish = m_clock.elapsed();
+        publish();
+        m_timer.start();
+    }
+    else
+    {
+        m_timer.stop();
+    }
+    emit enabledChanged(enabled);
+}
+
+qint64 ThreadRoles::readTicks(int tid)
+{
+    QFile stat(QString("/proc/self/task/%1/stat").arg(tid));
+    if (!stat.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+    // The name in parentheses may hold spaces, the fields after it do not
+    const QByteArray line = stat.readAll();
+    const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    // utime and stime are fields 14 and 15, the 12th and 13th after the name
+    return fields.size() > 12 ? fields.at(11).toLongLong() + fields.at(12).toLongLong() : -1;
+}
+
+void ThreadRoles::publish()
+{
+    QHash<int, int> threads;
+    {
+        QMutexLocker locker(&m_mutex);
+        threads = m_threads;
+    }
+    const qint64 now = m_clock.elapsed();
+    const qint64 elapsedMs = qMax(Q_INT64_C(1), now - m_lastPublish);
+    m_lastPublish = now;
+#ifdef Q_OS_LINUX
+    const long ticksPerSecond = qMax(1L, sysconf(_SC_CLK_TCK));
+#else
+    const long ticksPerSecond = 100;
+#endif
+
+    qint64 ticks[RoleCount] = { 0 };
+    int counts[RoleCount] = { 0 };
+    QList<int> exited;
+    for (QHash<int, int>::const_iterator it = threads.constBegin(); it != threads.constEnd(); ++it)
+    {
+        const qint64 total = readTicks(it.key());
+        if (total < 0)
+        {
+            exited.append(it.key());
+            continue;
+        }
+        // A thread seen for the first time only counts from now on
+        ticks[it.value()] += total - m_ticks.value(it.key(), total);
+        ++counts[it.value()];
+        m_ticks.insert(it.key(), total);
+    }
+    if (!exited.isEmpty())
+    {
+        QMutexLocker locker(&m_mutex);
+        foreach (int tid, exited)
+        {
+            m_threads.remove(tid);
+            m_ticks.remove(tid);
+        }
+    }
+
+    QStringList lines;
+    for (int i = 0; i < RoleCount; ++i)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+        const double percent = ticks[i] * 1000.0 / ticksPerSecond * 100.0 / elapsedMs;
+        lines << QString("%1 %2% CPU, %3 thread%4, nice %5 %6")
+                 .arg(QLatin1String(roles[i].name)).arg(percent, 0, 'f', 1).arg(counts[i])
+                 .arg(counts[i] == 1 ? "" : "s").arg(m_nice[i]).arg(QLatin1String(affinityNames[m_affinity[i]]));
+    }
+    m_report = lines.join("\n");
+    emit statsChanged();
+}
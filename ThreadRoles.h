@@ -0,0 +1,141 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ThreadRoles
+ *          Named roles for the threads that carry latency: link I/O,
+ *          MAVLink ingest, video streaming, render, UI, logging and audio,
+ *          each with a nice value and a core affinity applied when the
+ *          thread starts, and their CPU time for the performance overlay.
+ *
+ */
+
+#ifndef THREADROLES_H
+#define THREADROLES_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+/**
+ * @brief Priority and core placement of the threads by what they do
+ *
+ * QThread priorities do nothing for SCHED_OTHER threads on Linux, so the
+ * policy is the thread's nice value and its CPU set. On big.LITTLE SoCs
+ * the big cores are those with the highest cpuinfo_max_freq; with one
+ * cluster every core is both big and little. Defaults can be overridden
+ * per role in the THREAD_ROLES settings group, "<ROLE>_NICE" and
+ * "<ROLE>_AFFINITY" (any, big or little), read once at start.
+ *
+ * A thread takes its role by calling enter() first thing; GStreamer
+ * streaming threads do it from the pipelines' stream-status messages and
+ * the render thread when its scene graph is initialized. Threads started
+ * before the roles existed are adopted by their name. A policy the system
+ * refuses, e.g. a negative nice value where raising priority is not
+ * allowed, is logged once and the thread keeps running as it was.
+ *
+ * While enabled the CPU time of each role's threads is read from
+ * /proc/self/task every PublishMs and published as report(). Linux and
+ * Android only, elsewhere the roles are recorded but nothing is applied.
+ */
+class ThreadRoles : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(QString report READ report NOTIFY statsChanged)
+public:
+    enum Role {
+        LinkIo,
+        Ingest,
+        VideoStreaming,
+        Render,
+        Ui,
+        Logging,
+        Audio,
+        RoleCount
+    };
+    enum Affinity {
+        AnyCore,
+        BigCores,
+        LittleCores
+    };
+    enum { PublishMs = 1000 };
+
+    static ThreadRoles *instance();
+
+    /** @brief Give the calling thread role, any thread */
+    static void enter(Role role);
+    /** @brief Give role to running threads named name, as the kernel has it (15 characters) */
+    void adopt(Role role, const QString &name);
+    /** @brief The UI thread, and the window's render thread once its scene graph is up */
+    void attach(QObject *window);
+
+    bool isEnabled() const { return m_timer.isActive(); }
+    /** @brief One line per role with threads: CPU share, thread count and the policy */
+    QString report() const { return m_report; }
+
+    int nice(Role role) const { return m_nice[role]; }
+    Affinity affinity(Role role) const { return m_affinity[role]; }
+
+public slots:
+    void setEnabled(bool enabled);
+
+signals:
+    void enabledChanged(bool enabled);
+    void statsChanged();
+
+private slots:
+    void publish();
+    /** @brief Render thread, direct connection */
+    void enterRender() { enter(Render); }
+
+private:
+    ThreadRoles();
+    void loadPolicies();
+    void findCores();
+    void apply(int tid, Role role);
+    static int currentTid();
+    /** @brief utime + stime of a thread in clock ticks, -1 once it has exited */
+    static qint64 readTicks(int tid);
+
+    int m_nice[RoleCount];
+    Affinity m_affinity[RoleCount];
+    QList<int> m_bigCores;
+    QList<int> m_littleCores;
+
+    QMutex m_mutex;                 ///< enter() is called from any thread
+    QHash<int, int> m_threads;      ///< tid to role
+    QHash<int, qint64> m_ticks;     ///< tid to ticks at the last publish, UI thread only
+    int m_refusedRoles;             ///< Bit per role whose policy failed, logged once
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastPublish;
+    QString m_report;
+};
+
+#endif // THREADROLES_H
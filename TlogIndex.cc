@@ -0,0 +1,207 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogIndex
+ *          See TlogIndex.h
+ *
+ */
+
+#include "TlogIndex.h"
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+static const char indexMagic[] = "TLIX";
+
+// Record types
+static const char OffsetRecord = 'O';
+static const char ModeRecord = 'M';
+static const char StatusTextRecord = 'S';
+static const char SummaryRecord = 'C';
+
+static void putU8(QByteArray *out, quint8 value) { out->append((char)value); }
+static void putU16(QByteArray *out, quint16 value) { uchar b[2]; qToBigEndian(value, b); out->append((const char*)b, 2); }
+static void putU32(QByteArray *out, quint32 value) { uchar b[4]; qToBigEndian(value, b); out->append((const char*)b, 4); }
+static void putU64(QByteArray *out, quint64 value) { uchar b[8]; qToBigEndian(value, b); out->append((const char*)b, 8); }
+
+TlogIndex::TlogIndex()
+{
+    clear();
+}
+
+void TlogIndex::clear()
+{
+    offsets.clear();
+    modeChanges.clear();
+    statusTexts.clear();
+    firstTime = 0;
+    lastTime = 0;
+    memset(messageCounts, 0, sizeof(messageCounts));
+    m_nextOffsetTime = 0;
+    m_nextSummaryTime = 0;
+    m_modes.clear();
+}
+
+void TlogIndex::writeHeader(QByteArray *out)
+{
+    out->append(indexMagic, MagicBytes);
+    putU16(out, Version);
+}
+
+void TlogIndex::addFrame(quint64 timeUsec, qint64 offset, const char *frame, int length, QByteArray *out)
+{
+    if (length < MAVLINK_NUM_NON_PAYLOAD_BYTES)
+    {
+        return;
+    }
+    const uchar *bytes = (const uchar*)frame;
+    quint8 sysid = bytes[3];
+    quint8 msgid = bytes[5];
+    const uchar *payload = bytes + MAVLINK_NUM_HEADER_BYTES;
+
+    if (firstTime == 0)
+    {
+        firstTime = timeUsec;
+        m_nextSummaryTime = timeUsec + SummaryIntervalUsec;
+    }
+    lastTime = qMax(lastTime, timeUsec);
+    messageCounts[msgid]++;
+
+    if (timeUsec >= m_nextOffsetTime)
+    {
+        Offset entry = { timeUsec, offset };
+        offsets.append(entry);
+        putU8(out, OffsetRecord);
+        putU64(out, timeUsec);
+        putU64(out, offset);
+        m_nextOffsetTime = timeUsec + OffsetIntervalUsec;
+    }
+
+    if (msgid == MAVLINK_MSG_ID_HEARTBEAT && bytes[1] >= MAVLINK_MSG_ID_HEARTBEAT_LEN)
+    {
+        // Wire order: custom_mode (little endian), type, autopilot, base_mode, ...
+        ModeChange change = { timeUsec, offset, sysid, payload[6], qFromLittleEndian<quint32>(payload) };
+        quint64 mode = (quint64(change.baseMode) << 32) | change.customMode;
+        if (!m_modes.contains(sysid) || m_modes.value(sysid) != mode)
+        {
+            m_modes.insert(sysid, mode);
+            modeChanges.append(change);
+            putU8(out, ModeRecord);
+            putU64(out, timeUsec);
+            putU64(out, offset);
+            putU8(out, change.sysid);
+            putU8(out, change.baseMode);
+            putU32(out, change.customMode);
+        }
+    }
+    else if (msgid == MAVLINK_MSG_ID_STATUSTEXT && bytes[1] > 0)
+    {
+        StatusText text = { timeUsec, offset, sysid, payload[0] };
+        statusTexts.append(text);
+        putU8(out, StatusTextRecord);
+        putU64(out, timeUsec);
+        putU64(out, offset);
+        putU8(out, text.sysid);
+        putU8(out, text.severity);
+    }
+
+    if (timeUsec >= m_nextSummaryTime)
+    {
+        writeSummary(out);
+        m_nextSummaryTime = timeUsec + SummaryIntervalUsec;
+    }
+}
+
+void TlogIndex::writeSummary(QByteArray *out) const
+{
+    putU8(out, SummaryRecord);
+    putU64(out, firstTime);
+    putU64(out, lastTime);
+    for (int i = 0; i < 256; i++)
+    {
+        putU32(out, messageCounts[i]);
+    }
+}
+
+bool TlogIndex::load(const QString &tlogFileName)
+{
+    clear();
+    QFile file(indexFileName(tlogFileName));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    if (data.size() < HeaderBytes || memcmp(data.constData(), indexMagic, MagicBytes) != 0
+            || qFromBigEndian<quint16>((const uchar*)data.constData() + MagicBytes) != Version)
+    {
+        return false;
+    }
+
+    const uchar *p = (const uchar*)data.constData() + HeaderBytes;
+    const uchar *end = (const uchar*)data.constData() + data.size();
+    // A record cut short by a crash ends the index, everything before it is valid
+    while (p < end)
+    {
+        char type = (char)*p;
+        int length = (type == OffsetRecord) ? 17
+                   : (type == ModeRecord) ? 23
+                   : (type == StatusTextRecord) ? 19
+                   : (type == SummaryRecord) ? 17 + 256 * 4
+                   : 0;
+        if (length == 0 || end - p < length)
+        {
+            break;
+        }
+        const uchar *r = p + 1;
+        if (type == OffsetRecord)
+        {
+            Offset entry = { qFromBigEndian<quint64>(r), (qint64)qFromBigEndian<quint64>(r + 8) };
+            offsets.append(entry);
+        }
+        else if (type == ModeRecord)
+        {
+            ModeChange change = { qFromBigEndian<quint64>(r), (qint64)qFromBigEndian<quint64>(r + 8),
+                                  r[16], r[17], qFromBigEndian<quint32>(r + 18) };
+            modeChanges.append(change);
+        }
+        else if (type == StatusTextRecord)
+        {
+            StatusText text = { qFromBigEndian<quint64>(r), (qint64)qFromBigEndian<quint64>(r + 8), r[16], r[17] };
+            statusTexts.append(text);
+        }
+        else
+        {
+            firstTime = qFromBigEndian<quint64>(r);
+            lastTime = qFromBigEndian<quint64>(r + 8);
+            for (int i = 0; i < 256; i++)
+            {
+                messageCounts[i] = qFromBigEndian<quint32>(r + 16 + i * 4);
+            }
+        }
+        p += length;
+    }
+    return true;
+}
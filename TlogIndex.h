@@ -0,0 +1,95 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogIndex
+ *          Sidecar index of a .tlog ("<name>.tlog.idx"). TlogWriter appends to it
+ *          while logging, so even a log cut short by a crash keeps an index up to
+ *          its last block. The file is a "TLIX" header followed by big endian
+ *          records: periodic time/offset pairs, mode changes, STATUSTEXT positions
+ *          and a summary (time span, per message ID counts) that is repeated every
+ *          minute and at close; readers keep the last one.
+ *
+ */
+
+#ifndef TLOGINDEX_H
+#define TLOGINDEX_H
+
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+
+class TlogIndex
+{
+public:
+    struct Offset
+    {
+        quint64 timeUsec;
+        qint64 offset;
+    };
+    struct ModeChange
+    {
+        quint64 timeUsec;
+        qint64 offset;
+        quint8 sysid;
+        quint8 baseMode;
+        quint32 customMode;
+    };
+    struct StatusText
+    {
+        quint64 timeUsec;
+        qint64 offset;
+        quint8 sysid;
+        quint8 severity;
+    };
+
+    enum { OffsetIntervalUsec = 1000000, SummaryIntervalUsec = 60000000 };
+
+    TlogIndex();
+    static QString indexFileName(const QString &tlogFileName) { return tlogFileName + ".idx"; }
+
+    /** @brief Read the sidecar of tlogFileName; false if it is missing or not an index */
+    bool load(const QString &tlogFileName);
+
+    // Writer side, the encoded records are appended to out
+    void clear();
+    static void writeHeader(QByteArray *out);
+    void addFrame(quint64 timeUsec, qint64 offset, const char *frame, int length, QByteArray *out);
+    void writeSummary(QByteArray *out) const;
+
+    QVector<Offset> offsets;
+    QVector<ModeChange> modeChanges;
+    QVector<StatusText> statusTexts;
+    quint64 firstTime;
+    quint64 lastTime;
+    quint32 messageCounts[256];
+
+private:
+    enum { MagicBytes = 4, HeaderBytes = 6, Version = 1 };
+    quint64 m_nextOffsetTime;
+    quint64 m_nextSummaryTime;
+    QHash<int,quint64> m_modes; ///< Last (base_mode << 32 | custom_mode) per system
+};
+
+#endif // TLOGINDEX_H
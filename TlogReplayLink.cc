@@ -0,0 +1,489 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogReplayLink
+ *          See TlogReplayLink.h
+ *
+ */
+
+#include "TlogReplayLink.h"
+#include "TlogIndex.h"
+#include "CompressedTlog.h"
+#include "QsLog.h"
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include "GroundClock.h"
+#include <QtEndian>
+#include <cstring>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+TlogReplayLink::TlogReplayLink(const QString &fileName) :
+    m_data(NULL),
+    m_size(0),
+    m_startTime(0),
+    m_endTime(0),
+    m_connected(false),
+    m_stopping(false),
+    m_paused(false),
+    m_speed(1.0),
+    m_rebase(true),
+    m_seekOffset(-1),
+    m_pauseAt(0),
+    m_currentTime(0)
+{
+    m_id = getNextLinkId();
+    m_file.setFileName(fileName);
+    m_name = tr("Replay (%1)").arg(QFileInfo(fileName).fileName());
+    QLOG_INFO() << "Replay Created " << m_name;
+}
+
+TlogReplayLink::~TlogReplayLink()
+{
+    disconnect();
+}
+
+bool TlogReplayLink::isConnected() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_connected;
+}
+
+quint64 TlogReplayLink::getStartTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_startTime;
+}
+
+quint64 TlogReplayLink::getEndTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_endTime;
+}
+
+quint64 TlogReplayLink::getCurrentTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentTime;
+}
+
+double TlogReplayLink::getSpeed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_speed;
+}
+
+bool TlogReplayLink::isPaused() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_paused;
+}
+
+bool TlogReplayLink::connect()
+{
+    disconnect();
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        emit error(this, tr("Cannot open %1: %2").arg(m_file.fileName(), m_file.errorString()));
+        return false;
+    }
+    if (CompressedTlog::isCompressedFile(m_file.fileName()))
+    {
+        // Compressed logs are inflated up front, the replay then runs from memory
+        CompressedTlog log;
+        if (!log.open(m_file.fileName()))
+        {
+            emit error(this, tr("Cannot open %1: %2").arg(m_file.fileName(), log.errorString()));
+            m_file.close();
+            return false;
+        }
+        for (int i = 0; i < log.blocks().size(); i++)
+        {
+            m_inflated.append(log.readBlock(i));
+        }
+        m_size = m_inflated.size();
+        m_data = (const uchar*)m_inflated.constData();
+    }
+    else
+    {
+        m_size = m_file.size();
+        m_data = m_file.map(0, m_size);
+    }
+    if (m_data == NULL)
+    {
+        emit error(this, tr("Cannot map %1: %2").arg(m_file.fileName(), m_file.errorString()));
+        m_file.close();
+        return false;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        m_connected = true;
+        m_stopping = false;
+        m_seekOffset = -1;
+        m_rebase = true;
+    }
+    start(LowPriority);
+    emit connected(true);
+    emit connected(this);
+    emit connected();
+    return true;
+}
+
+bool TlogReplayLink::disconnect()
+{
+    if (isRunning())
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_wake.wakeAll();
+        }
+        wait();
+    }
+    if (m_data && m_data != (const uchar*)m_inflated.constData())
+    {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+    m_data = NULL;
+    m_inflated.clear();
+    m_file.close();
+
+    bool wasConnected;
+    {
+        QMutexLocker locker(&m_mutex);
+        wasConnected = m_connected;
+        m_connected = false;
+    }
+    if (wasConnected)
+    {
+        emit connected(false);
+        emit disconnected(this);
+        emit disconnected();
+    }
+    return true;
+}
+
+void TlogReplayLink::setSpeed(double speed)
+{
+    QMutexLocker locker(&m_mutex);
+    m_speed = qMax(0.0, speed);
+    m_rebase = true;
+    m_wake.wakeAll();
+}
+
+void TlogReplayLink::setPaused(bool paused)
+{
+    QMutexLocker locker(&m_mutex);
+    m_paused = paused;
+    m_pauseAt = 0;
+    m_rebase = true;
+    m_wake.wakeAll();
+}
+
+void TlogReplayLink::seek(quint64 timeUsec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_seekOffset = offsetForTime(timeUsec);
+    m_pauseAt = 0;
+    m_rebase = true;
+    m_wake.wakeAll();
+}
+
+void TlogReplayLink::seekPaused(quint64 timeUsec, quint64 leadUsec)
+{
+    QMutexLocker locker(&m_mutex);
+    m_seekOffset = offsetForTime(timeUsec > leadUsec ? timeUsec - leadUsec : 0);
+    m_pauseAt = qMax<quint64>(timeUsec, 1);
+    m_paused = false;
+    m_rebase = true;
+    m_wake.wakeAll();
+}
+
+quint64 TlogReplayLink::timestampAt(qint64 offset) const
+{
+    return qFromBigEndian<quint64>(m_data + offset);
+}
+
+int TlogReplayLink::recordLength(qint64 offset) const
+{
+    if (offset + TimestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES > m_size)
+    {
+        return 0;
+    }
+    const uchar *frame = m_data + offset + TimestampBytes;
+    if (frame[0] != MAVLINK_STX)
+    {
+        return 0;
+    }
+    int length = TimestampBytes + MAVLINK_NUM_NON_PAYLOAD_BYTES + frame[1];
+    return (offset + length <= m_size) ? length : 0;
+}
+
+qint64 TlogReplayLink::resync(qint64 offset) const
+{
+    // A record starts eight bytes before an STX, look for the next one that fits
+    qint64 search = offset + TimestampBytes + 1;
+    while (search < m_size)
+    {
+        const uchar *stx = static_cast<const uchar*>(memchr(m_data + search, MAVLINK_STX, m_size - search));
+        if (stx == NULL)
+        {
+            break;
+        }
+        qint64 candidate = (stx - m_data) - TimestampBytes;
+        if (recordLength(candidate) > 0)
+        {
+            return candidate;
+        }
+        search = (stx - m_data) + 1;
+    }
+    return -1;
+}
+
+bool TlogReplayLink::buildIndex()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QVector<IndexEntry> index;
+    quint64 startTime = 0;
+    quint64 endTime = 0;
+    quint64 nextEntry = 0;
+    qint64 offset = (recordLength(0) > 0) ? 0 : resync(0);
+
+    // Take what the sidecar index written with the log covers, scan only the rest
+    TlogIndex sidecar;
+    if (sidecar.load(m_file.fileName()) && !sidecar.offsets.isEmpty())
+    {
+        const TlogIndex::Offset &last = sidecar.offsets.last();
+        if (last.offset < m_size && recordLength(last.offset) > 0 && timestampAt(last.offset) == last.timeUsec)
+        {
+            index.reserve(sidecar.offsets.size());
+            for (int i = 0; i < sidecar.offsets.size() - 1; i++)
+            {
+                IndexEntry entry;
+                entry.timeUsec = sidecar.offsets.at(i).timeUsec;
+                entry.offset = sidecar.offsets.at(i).offset;
+                index.append(entry);
+                endTime = qMax(endTime, entry.timeUsec);
+            }
+            startTime = sidecar.offsets.first().timeUsec;
+            offset = last.offset;
+        }
+        else
+        {
+            QLOG_DEBUG() << "TlogReplayLink: sidecar index does not match" << m_file.fileName();
+        }
+    }
+    int length;
+    int records = 0;
+    while (offset >= 0 && (length = recordLength(offset)) > 0)
+    {
+        quint64 time = timestampAt(offset);
+        if (index.isEmpty() && startTime == 0)
+        {
+            startTime = time;
+        }
+        if (index.isEmpty() || time >= nextEntry)
+        {
+            IndexEntry entry;
+            entry.timeUsec = time;
+            entry.offset = offset;
+            index.append(entry);
+            nextEntry = time + IndexIntervalUsec;
+        }
+        endTime = qMax(endTime, time);
+        offset += length;
+        if (offset < m_size && recordLength(offset) == 0)
+        {
+            offset = resync(offset);
+        }
+        if ((++records & 0xFFFF) == 0)
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping)
+            {
+                return false;
+            }
+        }
+    }
+    QLOG_DEBUG() << "TlogReplayLink: indexed" << m_size << "bytes," << index.size() << "entries in" << timer.elapsed() << "ms";
+
+    QMutexLocker locker(&m_mutex);
+    m_index = index;
+    m_startTime = startTime;
+    m_endTime = endTime;
+    m_currentTime = startTime;
+    return !index.isEmpty();
+}
+
+qint64 TlogReplayLink::offsetForTime(quint64 timeUsec) const
+{
+    if (m_index.isEmpty())
+    {
+        return 0;
+    }
+    // Last index entry not after timeUsec, then walk forward to the exact frame
+    int low = 0;
+    int high = m_index.size() - 1;
+    while (low < high)
+    {
+        int middle = (low + high + 1) / 2;
+        if (m_index.at(middle).timeUsec <= timeUsec) low = middle;
+        else high = middle - 1;
+    }
+    qint64 offset = m_index.at(low).offset;
+    int length;
+    while ((length = recordLength(offset)) > 0 && timestampAt(offset) < timeUsec)
+    {
+        offset += length;
+    }
+    return offset;
+}
+
+void TlogReplayLink::flush(QByteArray &batch)
+{
+    if (batch.isEmpty())
+    {
+        return;
+    }
+    emit bytesReceived(this, batch);
+    inTraffic.add(batch.size(), 1, GroundClock::msecs());
+    batch.clear();
+}
+
+void TlogReplayLink::run()
+{
+    if (!buildIndex())
+    {
+        if (!m_stopping)
+        {
+            emit error(this, tr("%1 contains no MAVLink frames").arg(m_file.fileName()));
+        }
+        return;
+    }
+    emit indexReady(m_startTime, m_endTime);
+
+    QByteArray batch;
+    QElapsedTimer wall;
+    QElapsedTimer sincePosition;
+    sincePosition.start();
+    quint64 logAnchor = 0;
+    quint64 lastTime = 0;
+    qint64 offset = m_index.first().offset;
+    bool finished = false;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping)
+    {
+        if (m_seekOffset >= 0)
+        {
+            offset = m_seekOffset;
+            m_seekOffset = -1;
+            finished = false;
+            batch.clear();
+        }
+        if (m_paused || finished)
+        {
+            m_wake.wait(&m_mutex);
+            continue;
+        }
+        int length = recordLength(offset);
+        if (length == 0)
+        {
+            offset = (offset < m_size) ? resync(offset) : -1;
+            if (offset < 0)
+            {
+                locker.unlock();
+                flush(batch);
+                emit positionChanged(m_endTime);
+                emit replayFinished();
+                locker.relock();
+                finished = true;
+            }
+            continue;
+        }
+
+        quint64 time = timestampAt(offset);
+        if (m_pauseAt > 0 && time >= m_pauseAt)
+        {
+            // seekPaused() got there, the frames up to here are the state at its time
+            m_pauseAt = 0;
+            m_paused = true;
+            m_currentTime = time;
+            locker.unlock();
+            flush(batch);
+            emit positionChanged(time);
+            locker.relock();
+            continue;
+        }
+        double speed = m_pauseAt > 0 ? 0 : m_speed;
+        if (m_rebase || time < lastTime || time - lastTime > MaxGapUsec)
+        {
+            // Restart the clock here after a seek, speed change, pause or gap in the log
+            logAnchor = time;
+            wall.restart();
+            m_rebase = false;
+        }
+        lastTime = time;
+
+        if (speed > 0)
+        {
+            qint64 due = qint64((time - logAnchor) / speed) - wall.nsecsElapsed() / 1000;
+            if (due > 1000)
+            {
+                locker.unlock();
+                flush(batch);
+                locker.relock();
+                // Sleep on the condition so seek, pause and stop interrupt it
+                if (!m_rebase && !m_stopping && m_seekOffset < 0)
+                {
+                    m_wake.wait(&m_mutex, (unsigned long)qMin<qint64>(due / 1000, 50));
+                }
+                continue;
+            }
+        }
+
+        batch.append((const char*)m_data + offset + TimestampBytes, length - TimestampBytes);
+        offset += length;
+        m_currentTime = time;
+
+        if (batch.size() >= (speed > 0 ? int(BatchBytes) : int(FastBatchBytes)) || sincePosition.elapsed() > PositionIntervalMs)
+        {
+            locker.unlock();
+            flush(batch);
+            if (sincePosition.elapsed() > PositionIntervalMs)
+            {
+                sincePosition.restart();
+                emit positionChanged(time);
+            }
+            // As fast as possible still leaves the ingest ring room to drain
+            if (speed <= 0)
+            {
+                msleep(2);
+            }
+            locker.relock();
+        }
+    }
+    locker.unlock();
+    flush(batch);
+}
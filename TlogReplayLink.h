@@ -0,0 +1,140 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogReplayLink
+ *          Plays a .tlog back as if it were a live link. The file is memory
+ *          mapped rather than loaded, a sparse time index is built on connect,
+ *          and frames are emitted through bytesReceived() at the recorded pace
+ *          times a speed factor (0 = as fast as the parser keeps up), so the
+ *          normal ingest path, UAS objects and HUD see exactly what they saw live.
+ *          Compressed .ctlog files are inflated into memory on connect.
+ *
+ */
+
+#ifndef TLOGREPLAYLINK_H
+#define TLOGREPLAYLINK_H
+
+#include <QFile>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include "LinkInterface.h"
+
+class TlogReplayLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    explicit TlogReplayLink(const QString &fileName);
+    ~TlogReplayLink();
+
+    void disableTimeouts() { }
+    void enableTimeouts() { }
+    void requestReset() { }
+
+    int getId() const { return m_id; }
+    QString getName() const { return m_name; }
+    bool isConnected() const;
+    qint64 getConnectionSpeed() const { return 0; }
+    qint64 bytesAvailable() { return 0; }
+    LinkType getLinkType() { return REPLAY_LINK; }
+
+    QString getFileName() const { return m_file.fileName(); }
+    /** @brief First and last timestamp of the log in microseconds, valid after indexReady() */
+    quint64 getStartTime() const;
+    quint64 getEndTime() const;
+    quint64 getCurrentTime() const;
+    double getSpeed() const;
+    bool isPaused() const;
+
+    void run();
+
+public slots:
+    bool connect();
+    bool disconnect();
+    /** @brief Replay is receive only */
+    void writeBytes(const char *bytes, qint64 length) { Q_UNUSED(bytes); Q_UNUSED(length); }
+    /** @brief 1.0 plays in real time, 0 as fast as possible */
+    void setSpeed(double speed);
+    void setPaused(bool paused);
+    /** @brief Continue from the first frame at or after timeUsec */
+    void seek(quint64 timeUsec);
+    /** @brief Replay the leadUsec before timeUsec as fast as possible and pause at timeUsec,
+     *  so the vehicle state shown is the one logged at that time */
+    void seekPaused(quint64 timeUsec, quint64 leadUsec);
+
+signals:
+    void indexReady(quint64 startTime, quint64 endTime);
+    void positionChanged(quint64 timeUsec);
+    void replayFinished();
+
+protected slots:
+    void readBytes() { }
+
+private:
+    struct IndexEntry
+    {
+        quint64 timeUsec;
+        qint64 offset;
+    };
+    enum {
+        TimestampBytes = 8,
+        IndexIntervalUsec = 1000000,  ///< One index entry per second of log
+        MaxGapUsec = 2000000,         ///< Longer pauses in the log are skipped
+        BatchBytes = 4096,
+        FastBatchBytes = 16384,
+        PositionIntervalMs = 250
+    };
+
+    quint64 timestampAt(qint64 offset) const;
+    /** @brief Length of the timestamp + frame record at offset, 0 if none fits there */
+    int recordLength(qint64 offset) const;
+    /** @brief Offset of the next plausible record after a damaged one, -1 at the end */
+    qint64 resync(qint64 offset) const;
+    bool buildIndex();
+    qint64 offsetForTime(quint64 timeUsec) const;
+    void flush(QByteArray &batch);
+
+    int m_id;
+    QString m_name;
+    QFile m_file;
+    const uchar *m_data;      ///< Mapped file, or m_inflated for a compressed log
+    QByteArray m_inflated;
+    qint64 m_size;
+    QVector<IndexEntry> m_index;
+    quint64 m_startTime;
+    quint64 m_endTime;
+
+    mutable QMutex m_mutex;   ///< Guards the controls below, the replay thread waits on m_wake
+    QWaitCondition m_wake;
+    bool m_connected;
+    bool m_stopping;
+    bool m_paused;
+    double m_speed;
+    bool m_rebase;            ///< Speed or position changed, re-anchor the clock
+    qint64 m_seekOffset;
+    quint64 m_pauseAt;        ///< seekPaused() target, 0 if none
+    quint64 m_currentTime;
+};
+
+#endif // TLOGREPLAYLINK_H
@@ -0,0 +1,517 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogWriter
+ *          See TlogWriter.h
+ *
+ */
+
+#include "TlogWriter.h"
+#include "CompressedTlog.h"
+#include "QsLog.h"
+#include "ThreadRoles.h"
+#include <QDir>
+#include <QtEndian>
+#include <string.h>
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+TlogWriter::TlogWriter(QObject *parent) :
+    QThread(parent),
+    m_offset(0),
+    m_compressed(false),
+    m_indexing(false),
+    m_indexFailed(false),
+    m_backPending(false),
+    m_stopping(false),
+    m_failed(false),
+    m_mapped(false),
+    m_startOffset(0),
+    m_segment(NULL),
+    m_segmentStart(0),
+    m_spare(NULL),
+    m_spareStart(0),
+    m_spareWanted(false),
+    m_retired(NULL),
+    m_commit(NULL)
+{
+    // Reserved capacity survives resize(0), so the blocks are allocated once
+    m_front.reserve(BlockSize);
+    m_back.reserve(BlockSize);
+}
+
+TlogWriter::~TlogWriter()
+{
+    close();
+}
+
+bool TlogWriter::open(const QString &fileName)
+{
+    close();
+    m_compressed = CompressedTlog::isCompressedFileName(fileName);
+    if (!m_compressed)
+    {
+        // A log appended to may still be mapped length from a killed run
+        recover(fileName);
+    }
+    m_file.setFileName(fileName);
+    // Mapping for writing needs read access too
+    if (!m_file.open(m_compressed ? QIODevice::WriteOnly | QIODevice::Append : QIODevice::ReadWrite))
+    {
+        return false;
+    }
+    m_offset = m_file.size();
+    m_file.seek(m_offset);
+    m_mapped = !m_compressed && openMapped();
+    m_index.clear();
+    m_indexing = false;
+    m_indexFailed = false;
+    if (m_compressed)
+    {
+        // Block headers index a compressed log, no sidecar
+        if (m_offset == 0 && m_file.write(CompressedTlog::fileHeader()) != CompressedTlog::HeaderBytes)
+        {
+            m_file.close();
+            return false;
+        }
+    }
+    else
+    {
+        // The index is optional, logging goes on without it
+        m_indexFile.setFileName(TlogIndex::indexFileName(fileName));
+        m_indexing = m_indexFile.open(QIODevice::WriteOnly | QIODevice::Append);
+        if (!m_indexing)
+        {
+            QLOG_WARN() << "TlogWriter: cannot write index" << m_indexFile.fileName() << m_indexFile.errorString();
+        }
+        else if (m_indexFile.size() == 0)
+        {
+            TlogIndex::writeHeader(&m_indexFront);
+        }
+    }
+    m_stopping = false;
+    m_failed = false;
+    m_sinceHandOff.start();
+    m_sinceSync.start();
+    start(LowPriority);
+    return true;
+}
+
+void TlogWriter::close()
+{
+    if (!isRunning())
+    {
+        closeMapped();
+        if (m_file.isOpen()) m_file.close();
+        if (m_indexFile.isOpen()) m_indexFile.close();
+        m_indexFront.resize(0);
+        m_indexing = false;
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        // Wait for the block in flight, then queue what is left
+        while (m_backPending && !m_failed)
+        {
+            m_wake.wait(&m_mutex);
+        }
+        if (m_indexing)
+        {
+            m_index.writeSummary(&m_indexFront);
+        }
+        if ((!m_front.isEmpty() || !m_indexFront.isEmpty()) && !m_failed)
+        {
+            qSwap(m_front, m_back);
+            qSwap(m_indexFront, m_indexBack);
+            m_backPending = true;
+        }
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    wait();
+    m_front.resize(0);
+    m_indexFront.resize(0);
+    closeMapped();
+    m_file.close();
+    m_indexFile.close();
+    m_indexing = false;
+}
+
+void TlogWriter::append(quint64 timeUsec, const char *data, int length)
+{
+    if (m_mapped)
+    {
+        const qint64 offset = m_offset;
+        if (!appendMapped(timeUsec, data, length))
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stats.droppedBytes == 0)
+            {
+                QLOG_WARN() << "TlogWriter: next segment not mapped in time, dropping frames from" << m_file.fileName();
+            }
+            m_stats.droppedBytes += length + 8;
+            return;
+        }
+        if (m_indexing)
+        {
+            m_index.addFrame(timeUsec, offset, data, length, &m_indexFront);
+        }
+        // Only the index is handed off, the frames are in the page cache already
+        if (m_sinceHandOff.elapsed() > FlushIntervalMs)
+        {
+            handOff();
+        }
+        return;
+    }
+
+    if (length + 8 > BlockSize - m_front.size())
+    {
+        if (!handOff())
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stats.droppedBytes == 0)
+            {
+                QLOG_WARN() << "TlogWriter: storage too slow, dropping frames from" << m_file.fileName();
+            }
+            m_stats.droppedBytes += length + 8;
+            return;
+        }
+    }
+
+    if (m_indexing)
+    {
+        m_index.addFrame(timeUsec, m_offset + m_front.size(), data, length, &m_indexFront);
+    }
+
+    uchar stamp[8];
+    qToBigEndian<quint64>(timeUsec, stamp);
+    m_front.append((const char*)stamp, 8);
+    m_front.append(data, length);
+
+    // Do not let a quiet link keep frames in memory for long
+    if (m_sinceHandOff.elapsed() > (m_compressed ? CompressedFlushIntervalMs : FlushIntervalMs))
+    {
+        handOff();
+    }
+}
+
+bool TlogWriter::handOff()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_backPending || m_failed)
+    {
+        return false;
+    }
+    m_offset += m_front.size();
+    if (m_mapped)
+    {
+        m_stats.bytesWritten = m_stats.rawBytes = m_offset - m_startOffset;
+    }
+    qSwap(m_front, m_back);
+    qSwap(m_indexFront, m_indexBack);
+    m_backPending = true;
+    m_sinceHandOff.restart();
+    m_wake.wakeAll();
+    return true;
+}
+
+TlogWriter::Stats TlogWriter::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void TlogWriter::sync()
+{
+    m_file.flush();
+    if (m_indexFile.isOpen()) m_indexFile.flush();
+#ifdef Q_OS_UNIX
+    ::fsync(m_file.handle());
+    if (m_indexFile.isOpen()) ::fsync(m_indexFile.handle());
+#endif
+}
+
+void TlogWriter::run()
+{
+    ThreadRoles::enter(ThreadRoles::Logging);
+    bool unsynced = false;
+    QMutexLocker locker(&m_mutex);
+    forever
+    {
+        while (!m_backPending && !m_stopping && !m_spareWanted && !m_retired)
+        {
+            m_wake.wait(&m_mutex, SyncIntervalMs);
+            if (!m_backPending && unsynced && m_sinceSync.elapsed() > SyncIntervalMs)
+            {
+                locker.unlock();
+                sync();
+                locker.relock();
+                unsynced = false;
+                m_sinceSync.restart();
+                m_stats.syncs++;
+            }
+        }
+        if (m_spareWanted || m_retired)
+        {
+            // Segment switches come first, the producer drops frames while it has no spare
+            uchar *retired = m_retired;
+            const bool wanted = m_spareWanted;
+            const qint64 start = m_spareStart;
+            locker.unlock();
+            if (retired)
+            {
+                m_file.unmap(retired);
+            }
+            uchar *spare = wanted ? mapSegment(start) : NULL;
+            locker.relock();
+            m_retired = NULL;
+            if (wanted)
+            {
+                m_spareWanted = false;
+                m_spare = spare;
+                if (!spare)
+                {
+                    m_failed = true;
+                    m_wake.wakeAll();
+                    emit writeFailed(m_file.fileName(), m_file.errorString());
+                    break;
+                }
+            }
+            continue;
+        }
+        if (!m_backPending)
+        {
+            break;
+        }
+
+        // The producer never touches m_back while it is pending, write it unlocked
+        locker.unlock();
+        QElapsedTimer timer;
+        timer.start();
+        const QByteArray block = (m_compressed && !m_back.isEmpty()) ? CompressedTlog::encodeBlock(m_back) : m_back;
+        qint64 written = m_file.write(block);
+        bool ok = (written == block.size());
+        // Index records always follow the data they point at
+        if (ok && !m_indexBack.isEmpty() && m_indexing && !m_indexFailed
+                && m_indexFile.write(m_indexBack) != m_indexBack.size())
+        {
+            QLOG_WARN() << "TlogWriter: index write failed" << m_indexFile.fileName() << m_indexFile.errorString();
+            m_indexFailed = true;
+        }
+        bool synced = false;
+        if (ok && m_sinceSync.elapsed() > SyncIntervalMs)
+        {
+            sync();
+            synced = true;
+        }
+        int elapsed = (int)timer.elapsed();
+        locker.relock();
+
+        if (ok)
+        {
+            m_stats.bytesWritten += written;
+            m_stats.rawBytes += m_back.size();
+            m_stats.blocksWritten++;
+            m_stats.maxWriteMs = qMax(m_stats.maxWriteMs, elapsed);
+            unsynced = !synced;
+            if (synced)
+            {
+                m_sinceSync.restart();
+                m_stats.syncs++;
+            }
+        }
+        m_back.resize(0);
+        m_indexBack.resize(0);
+        m_backPending = false;
+        m_wake.wakeAll();
+
+        if (!ok)
+        {
+            m_failed = true;
+            emit writeFailed(m_file.fileName(), m_file.errorString());
+            break;
+        }
+    }
+    locker.unlock();
+    sync();
+}
+
+uchar *TlogWriter::mapSegment(qint64 start)
+{
+    if (m_file.size() < start + SegmentSize && !m_file.resize(start + SegmentSize))
+    {
+        return NULL;
+    }
+    return m_file.map(start, SegmentSize);
+}
+
+bool TlogWriter::openMapped()
+{
+    m_startOffset = m_offset;
+    m_segmentStart = m_offset / SegmentSize * SegmentSize;
+    m_segment = mapSegment(m_segmentStart);
+    m_spareStart = m_segmentStart + SegmentSize;
+    m_spare = m_segment ? mapSegment(m_spareStart) : NULL;
+    m_spareStart += SegmentSize;
+
+    m_commitFile.setFileName(commitFileName(m_file.fileName()));
+    if (m_spare && m_commitFile.open(QIODevice::ReadWrite | QIODevice::Truncate) && m_commitFile.resize(CommitBytes))
+    {
+        m_commit = m_commitFile.map(0, CommitBytes);
+    }
+    if (!m_commit)
+    {
+        QLOG_WARN() << "TlogWriter: cannot map" << m_file.fileName() << m_file.errorString() << m_commitFile.errorString()
+                    << "- buffering instead";
+        if (m_segment) m_file.unmap(m_segment);
+        if (m_spare) m_file.unmap(m_spare);
+        m_segment = NULL;
+        m_spare = NULL;
+        m_file.resize(m_offset);
+        m_file.seek(m_offset);
+        if (m_commitFile.isOpen()) m_commitFile.close();
+        m_commitFile.remove();
+        return false;
+    }
+    memcpy(m_commit, "TLCM", 4);
+    qToLittleEndian<quint32>(1, m_commit + 4);
+    qToLittleEndian<quint64>(quint64(m_offset), m_commit + 8);
+    qToLittleEndian<quint64>(quint64(SegmentSize), m_commit + 16);
+    return true;
+}
+
+bool TlogWriter::appendMapped(quint64 timeUsec, const char *data, int length)
+{
+    const int size = 8 + length;
+    if (size > MaxRecord)
+    {
+        return false;
+    }
+    const qint64 inSegment = m_offset - m_segmentStart;
+    const int first = int(qMin<qint64>(size, SegmentSize - inSegment));
+    uchar *next = NULL;
+    if (first < size)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_spare || m_retired || m_failed)
+        {
+            return false;
+        }
+        next = m_spare;
+        m_spare = NULL;
+    }
+
+    uchar record[MaxRecord];
+    qToBigEndian<quint64>(timeUsec, record);
+    memcpy(record + 8, data, length);
+    memcpy(m_segment + inSegment, record, first);
+    if (next)
+    {
+        // The rest goes to the start of the next segment, the thread unmaps this one and maps another
+        memcpy(next, record + first, size - first);
+        QMutexLocker locker(&m_mutex);
+        m_retired = m_segment;
+        m_spareWanted = true;
+        m_wake.wakeAll();
+        m_segment = next;
+        m_segmentStart += SegmentSize;
+        m_spareStart = m_segmentStart + SegmentSize;
+    }
+    m_offset += size;
+    // The frame is complete in the mapping before the length covers it
+    qToLittleEndian<quint64>(quint64(m_offset), m_commit + 8);
+    return true;
+}
+
+void TlogWriter::closeMapped()
+{
+    if (!m_mapped)
+    {
+        return;
+    }
+    m_mapped = false;
+    if (m_segment) m_file.unmap(m_segment);
+    if (m_spare) m_file.unmap(m_spare);
+    if (m_retired) m_file.unmap(m_retired);
+    m_segment = NULL;
+    m_spare = NULL;
+    m_retired = NULL;
+    m_spareWanted = false;
+    if (!m_file.resize(m_offset))
+    {
+        // recoverUnfinished() finishes it on the next start
+        QLOG_WARN() << "TlogWriter: cannot truncate" << m_file.fileName() << m_file.errorString();
+        m_commitFile.unmap(m_commit);
+        m_commit = NULL;
+        m_commitFile.close();
+        return;
+    }
+    m_stats.bytesWritten = m_stats.rawBytes = m_offset - m_startOffset;
+    sync();
+    m_commitFile.unmap(m_commit);
+    m_commit = NULL;
+    m_commitFile.close();
+    m_commitFile.remove();
+}
+
+bool TlogWriter::recover(const QString &tlogFileName)
+{
+    QFile commit(commitFileName(tlogFileName));
+    if (!commit.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    const QByteArray header = commit.read(CommitBytes);
+    commit.close();
+    if (header.size() == CommitBytes && header.startsWith("TLCM"))
+    {
+        const qint64 committed = qint64(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(header.constData()) + 8));
+        QFile tlog(tlogFileName);
+        if (tlog.size() > committed && !tlog.resize(committed))
+        {
+            QLOG_WARN() << "TlogWriter: cannot truncate unfinished log" << tlogFileName << tlog.errorString();
+            return false;
+        }
+        QLOG_INFO() << "TlogWriter: recovered" << tlogFileName << "," << committed << "bytes";
+    }
+    commit.remove();
+    return true;
+}
+
+int TlogWriter::recoverUnfinished(const QString &directory)
+{
+    QDir dir(directory);
+    int recovered = 0;
+    foreach (const QString &name, dir.entryList(QStringList() << "*.commit", QDir::Files))
+    {
+        QString tlog = dir.filePath(name);
+        tlog.chop(QString(".commit").size());
+        if (recover(tlog))
+        {
+            ++recovered;
+        }
+    }
+    return recovered;
+}
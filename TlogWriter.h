@@ -0,0 +1,150 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TlogWriter
+ *          Writes the .tlog telemetry log off the UI thread. Frames are appended
+ *          to one of two preallocated blocks; a full (or one second old) block is
+ *          handed to the writer thread, which writes it in one call and syncs the
+ *          file to storage every few seconds. The on-disk format is unchanged:
+ *          a big endian 64 bit microsecond timestamp followed by the raw frame.
+ *          A TlogIndex sidecar is written alongside, block for block.
+ *          A file name ending in .ctlog selects the CompressedTlog format
+ *          instead; blocks are then deflated on the writer thread and their
+ *          headers replace the sidecar.
+ *          A plain .tlog is not buffered at all but memory mapped in fixed
+ *          SegmentSize segments, frames are copied straight into the page
+ *          cache and a small mapped "<name>.tlog.commit" file records the
+ *          length written after every frame. A process that is killed loses
+ *          nothing the kernel already has; the file is longer than its data
+ *          until close() truncates it, or recoverUnfinished() on the next
+ *          start does. The writer thread maps the next segment ahead.
+ *
+ */
+
+#ifndef TLOGWRITER_H
+#define TLOGWRITER_H
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include "TlogIndex.h"
+
+class TlogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    struct Stats
+    {
+        qint64 bytesWritten;
+        qint64 rawBytes;      ///< Same as bytesWritten unless compressed
+        qint64 droppedBytes;  ///< Frames lost because both blocks were busy
+        int blocksWritten;
+        int syncs;
+        int maxWriteMs;       ///< Slowest single block write
+        Stats() : bytesWritten(0), rawBytes(0), droppedBytes(0), blocksWritten(0), syncs(0), maxWriteMs(0) { }
+    };
+
+    explicit TlogWriter(QObject *parent = 0);
+    ~TlogWriter();
+
+    bool open(const QString &fileName);
+    /** @brief Hand off what is buffered, wait for it to reach the disk and close */
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+    QString errorString() const { return m_file.errorString(); }
+
+    /** @brief Append one frame. Called from a single thread, never blocks on the disk */
+    void append(quint64 timeUsec, const char *data, int length);
+    /** @brief True while frames go to the mapped segments */
+    bool isMapped() const { return m_mapped; }
+
+    static QString commitFileName(const QString &tlogFileName) { return tlogFileName + ".commit"; }
+    /** @brief Truncate a log a killed process left mapped to its committed length, false if it was not one */
+    static bool recover(const QString &tlogFileName);
+    /** @brief recover() every unfinished log in directory, returns how many were */
+    static int recoverUnfinished(const QString &directory);
+
+    Stats stats() const;
+
+signals:
+    void writeFailed(const QString &fileName, const QString &error);
+
+protected:
+    void run();
+
+private:
+    enum {
+        BlockSize = 64 * 1024,
+        FlushIntervalMs = 1000,
+        CompressedFlushIntervalMs = 5000,  ///< Larger blocks deflate better
+        SyncIntervalMs = 5000,
+        SegmentSize = 4 * 1024 * 1024,  ///< A multiple of any page size
+        CommitBytes = 24,               ///< "TLCM", u32 version, u64 committed length, u64 segment size
+        MaxRecord = 8 + 512
+    };
+    bool handOff();
+    void sync();
+    bool openMapped();
+    void closeMapped();
+    /** @brief Grow the file to cover the segment at start and map it, null on failure */
+    uchar *mapSegment(qint64 start);
+    bool appendMapped(quint64 timeUsec, const char *data, int length);
+
+    QFile m_file;
+    QFile m_indexFile;
+    TlogIndex m_index;
+    qint64 m_offset;       ///< File offset of m_front, producer side
+    bool m_compressed;
+    bool m_indexing;       ///< Producer side: the sidecar opened
+    bool m_indexFailed;    ///< Writer side: stop writing the sidecar after an error
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QByteArray m_front;    ///< Filled by append(), owned by the producer
+    QByteArray m_back;     ///< Written by the thread while m_backPending
+    QByteArray m_indexFront; ///< Index records for m_front, swapped with it
+    QByteArray m_indexBack;
+    bool m_backPending;
+    bool m_stopping;
+    bool m_failed;
+    QElapsedTimer m_sinceHandOff;
+    QElapsedTimer m_sinceSync;
+    Stats m_stats;
+
+    bool m_mapped;
+    qint64 m_startOffset;  ///< File length at open
+    uchar *m_segment;      ///< Producer side, maps [m_segmentStart, m_segmentStart + SegmentSize)
+    qint64 m_segmentStart;
+    uchar *m_spare;        ///< The next segment, mapped by the thread; under m_mutex
+    qint64 m_spareStart;   ///< Where the thread maps the next spare; under m_mutex
+    bool m_spareWanted;    ///< under m_mutex
+    uchar *m_retired;      ///< A full segment for the thread to unmap; under m_mutex
+    QFile m_commitFile;
+    uchar *m_commit;       ///< Mapped commit header
+};
+
+#endif // TLOGWRITER_H
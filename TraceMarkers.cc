@@ -0,0 +1,154 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TraceMarkers
+ *          See TraceMarkers.h
+ *
+ */
+
+#include "TraceMarkers.h"
+
+#ifdef HUD_TRACE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#if defined(Q_OS_ANDROID)
+#include <dlfcn.h>
+#endif
+
+namespace {
+
+// Markers longer than this are cut, the kernel limits a write anyway
+enum { MaxMarker = 256 };
+
+struct Backend
+{
+    typedef void (*BeginSection)(const char *name);
+    typedef void (*EndSection)();
+    typedef bool (*IsEnabled)();
+    typedef void (*SetCounter)(const char *name, qint64 value);
+
+    BeginSection beginSection;
+    EndSection endSection;
+    IsEnabled isEnabled;
+    SetCounter setCounter;
+    int markerFd;
+    int pid;
+
+    Backend() : beginSection(0), endSection(0), isEnabled(0), setCounter(0), markerFd(-1), pid(getpid())
+    {
+#if defined(Q_OS_ANDROID)
+        // libandroid stays loaded for the life of the process
+        void *library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+        if (library)
+        {
+            beginSection = reinterpret_cast<BeginSection>(dlsym(library, "ATrace_beginSection"));
+            endSection = reinterpret_cast<EndSection>(dlsym(library, "ATrace_endSection"));
+            isEnabled = reinterpret_cast<IsEnabled>(dlsym(library, "ATrace_isEnabled"));
+            setCounter = reinterpret_cast<SetCounter>(dlsym(library, "ATrace_setCounter"));
+        }
+        if (beginSection && endSection && isEnabled)
+        {
+            return;
+        }
+        beginSection = 0;
+        endSection = 0;
+        isEnabled = 0;
+#endif
+        markerFd = open("/sys/kernel/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+        if (markerFd < 0)
+        {
+            markerFd = open("/sys/kernel/debug/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+        }
+    }
+
+    void write(const char *buffer, int length) const
+    {
+        if (length > 0)
+        {
+            // Nothing to do about a failed marker, the capture just misses it
+            ssize_t written = ::write(markerFd, buffer, qMin(length, static_cast<int>(MaxMarker) - 1));
+            Q_UNUSED(written);
+        }
+    }
+};
+
+const Backend &backend()
+{
+    // Set up by the first marker of any thread
+    static const Backend instance;
+    return instance;
+}
+
+}
+
+bool TraceMarkers::isEnabled()
+{
+    const Backend &b = backend();
+    return b.isEnabled ? b.isEnabled() : b.markerFd >= 0;
+}
+
+void TraceMarkers::begin(const char *name)
+{
+    const Backend &b = backend();
+    if (b.beginSection)
+    {
+        b.beginSection(name);
+        return;
+    }
+    char buffer[MaxMarker];
+    b.write(buffer, snprintf(buffer, sizeof(buffer), "B|%d|%s", b.pid, name));
+}
+
+void TraceMarkers::end()
+{
+    const Backend &b = backend();
+    if (b.endSection)
+    {
+        b.endSection();
+        return;
+    }
+    char buffer[32];
+    b.write(buffer, snprintf(buffer, sizeof(buffer), "E|%d", b.pid));
+}
+
+void TraceMarkers::counter(const char *name, qint64 value)
+{
+    const Backend &b = backend();
+    if (b.setCounter)
+    {
+        b.setCounter(name, value);
+        return;
+    }
+    if (b.markerFd < 0)
+    {
+        // ATrace before API 29 has no counters
+        return;
+    }
+    char buffer[MaxMarker];
+    b.write(buffer, snprintf(buffer, sizeof(buffer), "C|%d|%s|%lld", b.pid, name, static_cast<long long>(value)));
+}
+
+#endif // HUD_TRACE
@@ -0,0 +1,95 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TraceMarkers
+ *          Scoped systrace markers for one timeline of every thread: link
+ *          reads, frame parsing, UAS handling, property publication, the
+ *          GStreamer bus and the scene graph. Only built with CONFIG +=
+ *          hud_trace (cmake -DHUD_TRACE=ON), which defines HUD_TRACE;
+ *          otherwise every macro below expands to nothing.
+ *
+ *          On Android the markers go through the NDK's ATrace functions,
+ *          looked up at run time since they only exist from API 23, so a
+ *          capture with systrace or Perfetto ("atrace" category "app")
+ *          shows them. Elsewhere, and on older Android, they are written
+ *          to the kernel's trace_marker in the same "B|pid|name" format,
+ *          which Perfetto's ftrace source and trace-cmd both read.
+ *
+ */
+
+#ifndef TRACEMARKERS_H
+#define TRACEMARKERS_H
+
+#include <QtGlobal>
+
+#ifdef HUD_TRACE
+
+class TraceMarkers
+{
+public:
+    /** @brief Whether a capture is running, cheap; nothing is written when it is not */
+    static bool isEnabled();
+    /** @brief Open a slice on the calling thread, name must outlive the call only */
+    static void begin(const char *name);
+    /** @brief Close the innermost slice of the calling thread */
+    static void end();
+    /** @brief A value track, e.g. a queue depth */
+    static void counter(const char *name, qint64 value);
+};
+
+/** @brief One slice from construction to the end of the scope */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : m_active(TraceMarkers::isEnabled())
+    {
+        if (m_active) TraceMarkers::begin(name);
+    }
+    ~TraceScope()
+    {
+        if (m_active) TraceMarkers::end();
+    }
+private:
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+    bool m_active;
+};
+
+#define HUD_TRACE_CONCAT_(a, b) a##b
+#define HUD_TRACE_CONCAT(a, b) HUD_TRACE_CONCAT_(a, b)
+#define HUD_TRACE_SCOPE(name) TraceScope HUD_TRACE_CONCAT(hudTraceScope, __LINE__)(name)
+#define HUD_TRACE_BEGIN(name) do { if (TraceMarkers::isEnabled()) TraceMarkers::begin(name); } while (0)
+#define HUD_TRACE_END() do { if (TraceMarkers::isEnabled()) TraceMarkers::end(); } while (0)
+#define HUD_TRACE_COUNTER(name, value) do { if (TraceMarkers::isEnabled()) TraceMarkers::counter(name, value); } while (0)
+
+#else
+
+#define HUD_TRACE_SCOPE(name)
+#define HUD_TRACE_BEGIN(name) do { } while (0)
+#define HUD_TRACE_END() do { } while (0)
+#define HUD_TRACE_COUNTER(name, value) do { } while (0)
+
+#endif // HUD_TRACE
+
+#endif // TRACEMARKERS_H
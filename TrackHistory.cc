@@ -0,0 +1,423 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TrackHistory
+ *          See TrackHistory.h
+ *
+ */
+
+#include "TrackHistory.h"
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.hpp"
+#include <QPair>
+#include <cmath>
+
+// Tolerance of each level at the start, in m; thinning doubles it
+static const double initialTolerance[TrackHistory::LevelCount] = { 1.0, 5.0, 25.0, 100.0 };
+// A sample closer than this part of the tolerance to the previous one is jitter
+static const double minStepFraction = 0.25;
+static const double metresPerDegree = 111319.49;
+
+void TrackHistory::Level::append(const Point &point)
+{
+    if (count / ChunkPoints == chunks.size())
+    {
+        chunks.append(new Chunk);
+    }
+    chunks.at(count / ChunkPoints)->points[count % ChunkPoints] = point;
+    ++count;
+}
+
+void TrackHistory::Level::clear()
+{
+    qDeleteAll(chunks);
+    chunks.clear();
+    count = 0;
+    windowCount = 0;
+}
+
+TrackHistory::Vehicle::Vehicle() :
+    originLat(0),
+    originLon(0),
+    hasOrigin(false),
+    cosLat(1.0)
+{
+    for (int i = 0; i < LevelCount; ++i)
+    {
+        levels[i].tolerance = initialTolerance[i];
+    }
+}
+
+TrackHistory::TrackHistory(QObject *parent) :
+    QObject(parent),
+    m_maxPoints(MaxPoints)
+{
+    m_clock.start();
+}
+
+TrackHistory::~TrackHistory()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        delete m_vehicles[i].loadAcquire();
+    }
+}
+
+TrackHistory::Vehicle *TrackHistory::vehicle(int sysid)
+{
+    Vehicle *state = m_vehicles[sysid].loadAcquire();
+    if (state)
+    {
+        return state;
+    }
+    QMutexLocker locker(&m_allocLock);
+    state = m_vehicles[sysid].loadAcquire();
+    if (!state)
+    {
+        state = new Vehicle();
+        m_vehicles[sysid].storeRelease(state);
+    }
+    return state;
+}
+
+const TrackHistory::Vehicle *TrackHistory::find(int sysid) const
+{
+    if (sysid < 0 || sysid > 255)
+    {
+        return 0;
+    }
+    return m_vehicles[sysid].loadAcquire();
+}
+
+TrackHistory::Local TrackHistory::local(const Vehicle &vehicle, const Point &point)
+{
+    Local result;
+    result.x = (double(point.lon) - vehicle.originLon) * 1E-7 * metresPerDegree * vehicle.cosLat;
+    result.y = (double(point.lat) - vehicle.originLat) * 1E-7 * metresPerDegree;
+    return result;
+}
+
+double TrackHistory::deviation(const Local &a, const Local &b, const Local &p)
+{
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length2 = dx * dx + dy * dy;
+    double t = 0;
+    if (length2 > 0)
+    {
+        t = qBound(0.0, ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2, 1.0);
+    }
+    const double ex = a.x + t * dx - p.x;
+    const double ey = a.y + t * dy - p.y;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+void TrackHistory::record(const mavlink_message_t &message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_GLOBAL_POSITION_INT)
+    {
+        return;
+    }
+    mavlink::GlobalPositionInt position(message);
+    if (position.lat() == 0 && position.lon() == 0)
+    {
+        // No fix yet
+        return;
+    }
+    Point point;
+    point.lat = position.lat();
+    point.lon = position.lon();
+    point.alt = position.relative_alt() / 1000.0f;
+    point.timeMs = static_cast<quint32>(now());
+    record(message.sysid, point);
+}
+
+void TrackHistory::record(int sysid, const Point &point)
+{
+    if (sysid < 0 || sysid > 255)
+    {
+        return;
+    }
+    Vehicle *state = vehicle(sysid);
+    QMutexLocker locker(&state->lock);
+    if (!state->hasOrigin)
+    {
+        state->hasOrigin = true;
+        state->originLat = point.lat;
+        state->originLon = point.lon;
+        state->cosLat = std::cos(point.lat * 1E-7 * M_PI / 180.0);
+    }
+    for (int i = 0; i < LevelCount; ++i)
+    {
+        add(*state, state->levels[i], point);
+    }
+}
+
+void TrackHistory::add(Vehicle &vehicle, Level &level, const Point &point)
+{
+    if (level.count == 0)
+    {
+        level.append(point);
+        return;
+    }
+    const Local p = local(vehicle, point);
+    const Point &previous = level.windowCount ? level.window[level.windowCount - 1] : level.at(level.count - 1);
+    const Local last = local(vehicle, previous);
+    const double stepX = p.x - last.x;
+    const double stepY = p.y - last.y;
+    if (stepX * stepX + stepY * stepY < level.tolerance * level.tolerance * minStepFraction * minStepFraction)
+    {
+        return;
+    }
+
+    level.window[level.windowCount++] = point;
+    // Opening window: the samples since the kept point must stay within
+    // the tolerance of the line from it to the newest one
+    const Local anchor = local(vehicle, level.at(level.count - 1));
+    bool turned = level.windowCount == WindowPoints;
+    for (int i = 0; i < level.windowCount - 1 && !turned; ++i)
+    {
+        turned = deviation(anchor, p, local(vehicle, level.window[i])) > level.tolerance;
+    }
+    if (!turned)
+    {
+        return;
+    }
+    // The track was straight up to the sample before this one, keep that
+    level.append(level.window[level.windowCount - 2]);
+    level.window[0] = point;
+    level.windowCount = 1;
+    if (level.count >= m_maxPoints.load())
+    {
+        thin(vehicle, level);
+    }
+}
+
+void TrackHistory::thin(Vehicle &vehicle, Level &level)
+{
+    level.tolerance *= 2;
+    const int count = level.count;
+    QVector<Point> points(count);
+    QVector<Local> locals(count);
+    for (int i = 0; i < count; ++i)
+    {
+        points[i] = level.at(i);
+        locals[i] = local(vehicle, points.at(i));
+    }
+
+    // Douglas-Peucker without recursion, a flight has too many points for the stack
+    QVector<bool> keep(count, false);
+    keep[0] = true;
+    keep[count - 1] = true;
+    QVector<QPair<int, int> > spans;
+    spans.append(qMakePair(0, count - 1));
+    while (!spans.isEmpty())
+    {
+        const QPair<int, int> span = spans.last();
+        spans.removeLast();
+        double worst = 0;
+        int index = -1;
+        for (int i = span.first + 1; i < span.second; ++i)
+        {
+            const double d = deviation(locals.at(span.first), locals.at(span.second), locals.at(i));
+            if (d > worst)
+            {
+                worst = d;
+                index = i;
+            }
+        }
+        if (index >= 0 && worst > level.tolerance)
+        {
+            keep[index] = true;
+            spans.append(qMakePair(span.first, index));
+            spans.append(qMakePair(index, span.second));
+        }
+    }
+
+    // Rewrite in place, keeping the chunks that are still needed
+    level.count = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (keep.at(i))
+        {
+            level.append(points.at(i));
+        }
+    }
+    const int chunksNeeded = (level.count + ChunkPoints - 1) / ChunkPoints;
+    while (level.chunks.size() > chunksNeeded)
+    {
+        delete level.chunks.last();
+        level.chunks.removeLast();
+    }
+}
+
+void TrackHistory::clear()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        state->hasOrigin = false;
+        for (int j = 0; j < LevelCount; ++j)
+        {
+            state->levels[j].clear();
+            state->levels[j].tolerance = initialTolerance[j];
+        }
+    }
+}
+
+void TrackHistory::setMaxPoints(int points)
+{
+    points = qBound(2 * WindowPoints, points, static_cast<int>(MaxPoints));
+    m_maxPoints.store(points);
+    for (int i = 0; i < 256; ++i)
+    {
+        Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        for (int j = 0; j < LevelCount; ++j)
+        {
+            // Each pass doubles the tolerance, a long track may need a few
+            while (state->levels[j].count >= points)
+            {
+                thin(*state, state->levels[j]);
+            }
+        }
+    }
+}
+
+qint64 TrackHistory::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        const Vehicle *state = m_vehicles[i].loadAcquire();
+        if (!state)
+        {
+            continue;
+        }
+        QMutexLocker locker(&state->lock);
+        bytes += sizeof(Vehicle);
+        for (int j = 0; j < LevelCount; ++j)
+        {
+            bytes += state->levels[j].chunks.size() * qint64(sizeof(Chunk));
+        }
+    }
+    return bytes;
+}
+
+int TrackHistory::pointCount(int sysid, int level) const
+{
+    const Vehicle *state = find(sysid);
+    if (!state || level < 0 || level >= LevelCount)
+    {
+        return 0;
+    }
+    QMutexLocker locker(&state->lock);
+    const Level &track = state->levels[level];
+    return track.count + (track.windowCount ? 1 : 0);
+}
+
+double TrackHistory::tolerance(int sysid, int level) const
+{
+    if (level < 0 || level >= LevelCount)
+    {
+        return 0;
+    }
+    const Vehicle *state = find(sysid);
+    if (!state)
+    {
+        return initialTolerance[level];
+    }
+    QMutexLocker locker(&state->lock);
+    return state->levels[level].tolerance;
+}
+
+bool TrackHistory::copy(int sysid, int level, QVector<Point> &out) const
+{
+    out.resize(0);
+    const Vehicle *state = find(sysid);
+    if (!state || level < 0 || level >= LevelCount)
+    {
+        return false;
+    }
+    QMutexLocker locker(&state->lock);
+    const Level &track = state->levels[level];
+    if (track.count == 0)
+    {
+        return false;
+    }
+    out.reserve(track.count + 1);
+    for (int i = 0; i < track.count; ++i)
+    {
+        out.append(track.at(i));
+    }
+    // The newest sample, so the track reaches the vehicle
+    if (track.windowCount)
+    {
+        out.append(track.window[track.windowCount - 1]);
+    }
+    return true;
+}
+
+QVariantList TrackHistory::path(int sysid, int maxPoints) const
+{
+    QVariantList result;
+    const Vehicle *state = find(sysid);
+    if (!state)
+    {
+        return result;
+    }
+    int level = LevelCount - 1;
+    {
+        QMutexLocker locker(&state->lock);
+        for (int i = 0; i < LevelCount; ++i)
+        {
+            const Level &track = state->levels[i];
+            if (track.count + (track.windowCount ? 1 : 0) <= maxPoints)
+            {
+                level = i;
+                break;
+            }
+        }
+    }
+    QVector<Point> points;
+    if (!copy(sysid, level, points))
+    {
+        return result;
+    }
+    result.reserve(points.size() * 2);
+    for (int i = 0; i < points.size(); ++i)
+    {
+        result.append(points.at(i).lat * 1E-7);
+        result.append(points.at(i).lon * 1E-7);
+    }
+    return result;
+}
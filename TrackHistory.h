@@ -0,0 +1,147 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TrackHistory
+ *          The flown track of every vehicle at a few levels of detail, so a
+ *          long flight can be drawn on a map without walking every sample.
+ *          Each level simplifies GLOBAL_POSITION_INT online: samples closer
+ *          than a fraction of the level's tolerance are skipped, and a point
+ *          is only kept once the track has turned away from the line through
+ *          it by more than the tolerance. Points are stored in fixed chunks;
+ *          a level that reaches MaxPoints doubles its tolerance and thins
+ *          itself with Douglas-Peucker, so memory stays bounded however long
+ *          the flight. Recording happens on the ingest thread, like
+ *          TelemetryHistory.
+ *
+ */
+
+#ifndef TRACKHISTORY_H
+#define TRACKHISTORY_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVariantList>
+#include <QVector>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+
+class TrackHistory : public QObject
+{
+    Q_OBJECT
+public:
+    struct Point
+    {
+        qint32 lat;         ///< degrees * 1E7
+        qint32 lon;         ///< degrees * 1E7
+        float alt;          ///< m above home
+        quint32 timeMs;     ///< Ground clock, see now()
+    };
+    enum {
+        LevelCount = 4,
+        ChunkPoints = 1024,
+        MaxPoints = 32 * ChunkPoints,   ///< Per level, before it is thinned
+        LowMemoryMaxPoints = 4 * ChunkPoints,   ///< What MemoryBudget lowers the limit to
+        WindowPoints = 64               ///< Samples a level looks back over before it must keep one
+    };
+
+    explicit TrackHistory(QObject *parent = 0);
+    ~TrackHistory();
+
+    /** @brief Record a GLOBAL_POSITION_INT. Ingest thread, called for every message */
+    void record(const mavlink_message_t &message);
+    /** @brief Record one position by hand, e.g. from a replay. Any thread */
+    void record(int sysid, const Point &point);
+    void clear();
+
+    qint64 now() const { return m_clock.elapsed(); }
+
+    /** @brief Points a level keeps before it is thinned, up to MaxPoints. Levels above it are thinned now */
+    void setMaxPoints(int points);
+    int maxPoints() const { return m_maxPoints.load(); }
+    /** @brief Bytes held by the tracks of every vehicle */
+    qint64 memoryBytes() const;
+
+    /** @brief Points kept by level, 0 finest, including the newest sample */
+    int pointCount(int sysid, int level) const;
+    /** @brief Current tolerance of level in m, it grows as the level is thinned */
+    double tolerance(int sysid, int level) const;
+    /** @brief Copy the track of level into out, which keeps its capacity. False without a track */
+    bool copy(int sysid, int level, QVector<Point> &out) const;
+
+    /** @brief [lat, lon, lat, lon, ...] in degrees of the finest level with at most maxPoints points, for QML */
+    Q_INVOKABLE QVariantList path(int sysid, int maxPoints) const;
+
+private:
+    Q_DISABLE_COPY(TrackHistory)
+
+    struct Chunk
+    {
+        Point points[ChunkPoints];
+    };
+    struct Level
+    {
+        Level() : tolerance(0), count(0), windowCount(0) { }
+        ~Level() { qDeleteAll(chunks); }
+        double tolerance;               ///< m
+        QVector<Chunk*> chunks;
+        int count;                      ///< Points kept in chunks
+        Point window[WindowPoints];     ///< Samples since the last kept point, newest last
+        int windowCount;
+
+        const Point &at(int index) const { return chunks.at(index / ChunkPoints)->points[index % ChunkPoints]; }
+        void append(const Point &point);
+        void clear();
+    };
+    struct Vehicle
+    {
+        Vehicle();
+        mutable QMutex lock;        ///< Ingest thread writes, UI thread reads
+        qint32 originLat;           ///< First point, local metres are relative to it
+        qint32 originLon;
+        bool hasOrigin;
+        double cosLat;              ///< cos of the origin latitude, scales longitude to metres
+        Level levels[LevelCount];
+    };
+    struct Local
+    {
+        double x;
+        double y;
+    };
+
+    Vehicle *vehicle(int sysid);
+    const Vehicle *find(int sysid) const;
+    void add(Vehicle &vehicle, Level &level, const Point &point);
+    void thin(Vehicle &vehicle, Level &level);
+    static Local local(const Vehicle &vehicle, const Point &point);
+    static double deviation(const Local &a, const Local &b, const Local &p);
+
+    QAtomicPointer<Vehicle> m_vehicles[256];   ///< Allocated on first sample, then kept
+    QMutex m_allocLock;
+    QAtomicInt m_maxPoints;
+    QElapsedTimer m_clock;
+};
+
+#endif // TRACKHISTORY_H
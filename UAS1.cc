@@ -11,6 +11,7 @@
 
 #include "QsLog.h"
 #include "UAS1.h"
+#include "StreamNegotiator.h"
 #include "LinkInterface.h"
 #include "UASManager1.h"
 #include "QGC.h"
@@ -18,23 +19,103 @@
 //#include "MAVLinkProtocol.h"
 #include "QGCMAVLink.h"
 #include "LinkManager1.h"
+#include "MAVLinkFusion.h"
+#include "MAVLinkLatencyTracer.h"
+#include "MAVLinkDispatcher.h"
+#include "HilBridge.h"
+#include "TraceMarkers.h"
 
 #include <QList>
 #include <QMessageBox>
 #include <QTimer>
-#include <QSettings>
+#include "SettingsStore.h"
 #include <iostream>
 #include <QDesktopServices>
 
 #include <cmath>
+#include <cstring>
 #include <qmath.h>
 
 #ifdef QGC_PROTOBUF_ENABLED
 #include <google/protobuf/descriptor.h>
+#include <QHash>
 #endif
 
 #define UINT16_MAX 0xffff
 
+// Values published through TelemetryChannels, in the order of uasChannels
+enum {
+    ChBaseMode,
+    ChCustomMode,
+    ChSystemStatus,
+    ChSensorsEnabled,
+    ChSensorsHealth,
+    ChCommsErrors,
+    ChErrorsCount1,
+    ChErrorsCount2,
+    ChErrorsCount3,
+    ChErrorsCount4,
+    ChCpuLoad,
+    ChBattery,
+    ChVoltage,
+    ChCurrent,
+    ChCommsDropRate,
+    ChRoll,
+    ChPitch,
+    ChYaw,
+    ChLatitude,
+    ChLongitude,
+    ChAltitudeGps,
+    ChAltitudeRel,
+    ChHeadingGps,
+    ChClimb,
+    ChGpsVelocity,
+    ChGpsFix,
+    ChGpsSats,
+    ChGpsHdop,
+    ChGpsCog,
+    ChRadioRssi,
+    ChRadioRemRssi,
+    ChRadioNoise,
+    ChRadioRemNoise,
+    ChannelCount
+};
+static const TelemetryChannels::ChannelInfo uasChannels[] = {
+    { "HEARTBEAT.base_mode", "bits" },
+    { "HEARTBEAT.custom_mode", "bits" },
+    { "HEARTBEAT.system_status", "-" },
+    { "GCS Status.Sensors Enabled", "bits" },
+    { "GCS Status.Sensors Health", "bits" },
+    { "GCS Status.Comms Errors", "-" },
+    { "GCS Status.Errors Count 1", "-" },
+    { "GCS Status.Errors Count 2", "-" },
+    { "GCS Status.Errors Count 3", "-" },
+    { "GCS Status.Errors Count 4", "-" },
+    { "GCS Status.CPU Load", "%" },
+    { "GCS Status.Battery", "%" },
+    { "GCS Status.Voltage", "V" },
+    { "GCS Status.Current", "A" },
+    { "GCS Status.Comms Drop Rate", "%" },
+    { "GCS Status.Roll", "deg" },
+    { "GCS Status.Pitch", "deg" },
+    { "GCS Status.Yaw", "deg" },
+    { "GCS Status.Latitude", "deg" },
+    { "GCS Status.Longitude", "deg" },
+    { "GCS Status.Altitude (GPS)", "m" },
+    { "GCS Status.Altitude (REL)", "m" },
+    { "GCS Status.Heading (GPS)", "degs" },
+    { "GCS Status.Climb", "m/s" },
+    { "GCS Status.GPS Velocity", "m/s" },
+    { "GCS Status.GPS Fix", "" },
+    { "GCS Status.GPS Sats", "" },
+    { "GCS Status.GPS HDOP", "m" },
+    { "GCS Status.GPS COG", "" },
+    { "GCS Status.Radio RSSI", "" },
+    { "GCS Status.Radio REM RSSI", "" },
+    { "GCS Status.Radio noise", "" },
+    { "GCS Status.Radio REM noise", "" },
+};
+
 const double UAS::lipoFull = 4.2f;  ///< 100% charged voltage
 const double UAS::lipoEmpty = 3.5f; ///< Discharged voltage
 
@@ -52,7 +133,8 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
     commStatus(COMM_DISCONNECTED),
     receiveDropRate(0),
     sendDropRate(0),
-    statusTimeout(new QTimer(this)),
+    statusTimeout(TimerWheel::InvalidTimer),
+    heartbeatTimer(TimerWheel::InvalidTimer),
 
     name(""),
     type(-1),
@@ -102,6 +184,7 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
     manualPitchAngle(0),
     manualYawAngle(0),
     manualThrust(0),
+    m_manualControl(NULL),
 
     positionLock(false),
     isLocalPositionKnown(false),
@@ -145,13 +228,20 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
     roll(0.0),
     pitch(0.0),
     yaw(0.0),
+    attitudeQuaternion(AttitudeQuaternion::Identity()),
 
+    m_imageTransfer(NULL),
+    m_logDownload(NULL),
     blockHomePositionChanges(false),
     receivedMode(false),
 
 
     paramsOnceRequested(false),
     paramManager(NULL),
+    m_parameterSync(NULL),
+    m_parameterWriter(NULL),
+    m_commandTracker(NULL),
+    m_parameterCacheLoaded(false),
 
     // The protected members.
     connectionLost(false),
@@ -163,20 +253,47 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
     lastSendTimeGPS(0),
     lastSendTimeSensors(0)
 {
-    for (unsigned int i = 0; i<255;++i)
+    m_telemetry = TelemetryChannels::instance();
+    m_firstChannel = m_telemetry->registerChannels(uasChannels, ChannelCount);
+
+    m_parameterSync = new ParameterSync(this);
+    connect(m_parameterSync, SIGNAL(progress(int,int,int,int)), this, SIGNAL(parameterSyncProgress(int,int,int,int)));
+    connect(m_parameterSync, SIGNAL(finished(int,int,int)), this, SIGNAL(parameterListComplete(int,int,int)));
+    connect(m_parameterSync, SIGNAL(finished(int,int,int)), this, SLOT(parameterSyncFinished(int,int,int)));
+
+    m_parameterWriter = new ParameterWriter(this);
+    connect(m_parameterWriter, SIGNAL(progress(int,int,int)), this, SIGNAL(parameterWriteProgress(int,int,int)));
+    connect(m_parameterWriter, SIGNAL(finished(int,int,int)), this, SIGNAL(parameterWriteFinished(int,int,int)));
+    connect(m_parameterWriter, SIGNAL(finished(int,int,int)), this, SLOT(parameterWritesVerified(int,int,int)));
+
+    m_commandTracker = new CommandTracker(this);
+    connect(m_commandTracker, SIGNAL(commandFinished(int,int,int,int,int,int)), this, SIGNAL(commandFinished(int,int,int,int,int,int)));
+
+    m_missionSync = new MissionSync(this);
+    connect(m_missionSync, SIGNAL(progress(int,int,int)), this, SIGNAL(missionTransferProgress(int,int,int)));
+    connect(m_missionSync, SIGNAL(finished(int,bool,int)), this, SIGNAL(missionTransferFinished(int,bool,int)));
+
+    m_imageTransfer = new ImageTransfer(this);
+    connect(m_imageTransfer, SIGNAL(imageReady()), this, SLOT(imageTransferReady()));
+    m_logDownload = new LogDownload(this);
+    m_manualControl = new ManualControl(LinkManager::instance()->getMavlinkProtocol()->sender(), this);
+
+    m_streamRates = new StreamRateTuner(this);
+
+    for (unsigned int i = 0; i<256;++i)
     {
         componentID[i] = -1;
         componentMulti[i] = false;
     }
+    memset(m_componentBits, 0, sizeof(m_componentBits));
     
     color = UASInterface::getNextColor();
 
     // Read setting before setting up 'systemSpecChanged' to avoid writing while reading the settings
     readSettings();
 
-    connect(statusTimeout, SIGNAL(timeout()), this, SLOT(updateState()));
     connect(this, SIGNAL(systemSpecsChanged(int)), this, SLOT(writeSettings()));
-    statusTimeout->start(500);
+    statusTimeout = TimerWheel::instance()->start(this, SLOT(updateState()), 500);
     // Initial signals
     emit disarmed();
     emit armingChanged(false);  
@@ -185,9 +302,7 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
     componentId = QGC::defaultComponentId;
 
     m_heartbeatsEnabled = false; //MainWindow::instance()->heartbeatEnabled(); //Default to sending heartbeats
-    QTimer *heartbeattimer = new QTimer(this);
-    connect(heartbeattimer,SIGNAL(timeout()),this,SLOT(sendHeartbeat()));
-    heartbeattimer->start(MAVLINK_HEARTBEAT_DEFAULT_RATE * 1000);
+    heartbeatTimer = TimerWheel::instance()->start(this, SLOT(sendHeartbeat()), MAVLINK_HEARTBEAT_DEFAULT_RATE * 1000);
 }
 
 /**
@@ -197,8 +312,11 @@ UAS::UAS(MAVLinkProtocol* , int id) : UASInterface(),
 UAS::~UAS()
 {
     writeSettings();
+    // Before the links go, its thread sends to them
+    m_manualControl->stop();
     delete links;
-    delete statusTimeout;
+    // Also stops the timers of subclasses
+    TimerWheel::instance()->stopAll(this);
 }
 
 /**
@@ -207,14 +325,13 @@ UAS::~UAS()
 */
 void UAS::writeSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup(QString("MAV%1").arg(uasId));
     settings.setValue("NAME", this->name);
     settings.setValue("AIRFRAME", this->airframe);
     settings.setValue("AP_TYPE", this->autopilot);
     settings.setValue("BATTERY_SPECS", getBatterySpecs());
     settings.endGroup();
-    settings.sync();
 }
 
 /**
@@ -223,7 +340,7 @@ void UAS::writeSettings()
 */
 void UAS::readSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup(QString("MAV%1").arg(uasId));
     setUASName(settings.value("NAME", this->name).toString());
     setAirframe(settings.value("AIRFRAME", this->airframe).toInt());
@@ -268,7 +385,7 @@ void UAS::updateState()
         connectionLost = true;
         receivedMode = false;
         QString audiostring = QString("Link lost to system %1").arg(this->getUASID());
-        GAudioOutput::instance()->say(audiostring.toLower());
+        GAudioOutput::instance()->say(audiostring.toLower(), MAV_SEVERITY_WARNING);
     }
 
     // Update connection loss time on each iteration
@@ -324,45 +441,38 @@ bool UAS::getSelected() const
     return (UASManager::instance()->getActiveUAS() == this);
 }
 
+void UAS::subscribe(MAVLinkDispatcher *dispatcher, const int *msgids)
+{
+    // Catch-all, so links and components are tracked for every message.
+    // Autopilot classes do not override receiveMessage(), they subscribe
+    // their own members for the ids they add, which run after this one.
+    MAVLinkDispatcher::Handler handler = &MAVLinkDispatcher::call<UAS, &UAS::receiveMessage>;
+    if (!msgids)
+    {
+        dispatcher->subscribe(uasId, MAVLinkDispatcher::AnyMessage, handler, this);
+        return;
+    }
+    for (; *msgids != -1; ++msgids)
+    {
+        dispatcher->subscribe(uasId, *msgids, handler, this);
+    }
+}
+
 void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 {
+    HUD_TRACE_SCOPE("UAS::receiveMessage");
     if (!link) return;
-    if (!links->contains(link))
+    MAVLinkLatencyTracer *tracer = MAVLinkLatencyTracer::instance();
+    if (tracer->traces(message)) tracer->reached(message, MAVLinkLatencyTracer::StageUas);
+    // The first frame of a link or component registers it, every other one only tests a bit
+    if (!knowsLink(link))
     {
         addLink(link);
         QLOG_TRACE() << __FILE__ << __LINE__ << "ADDED LINK!" << link->getName();
     }
-
-    if (!components.contains(message.compid))
+    if (!knowsComponent(message.compid))
     {
-        QString componentName;
-
-        switch (message.compid)
-        {
-        case MAV_COMP_ID_ALL:
-        {
-            componentName = "ANONYMOUS";
-            break;
-        }
-        case MAV_COMP_ID_IMU:
-        {
-            componentName = "IMU #1";
-            break;
-        }
-        case MAV_COMP_ID_CAMERA:
-        {
-            componentName = "CAMERA";
-            break;
-        }
-        case MAV_COMP_ID_MISSIONPLANNER:
-        {
-            componentName = "MISSIONPLANNER";
-            break;
-        }
-        }
-
-        components.insert(message.compid, componentName);
-        emit componentCreated(uasId, message.compid, componentName);
+        registerComponent(message.compid);
     }
 
     //    QLOG_DEBUG() << "UAS RECEIVED from" << message.sysid << "component" << message.compid << "msg id" << message.msgid << "seq no" << message.seq;
@@ -424,14 +534,15 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 			// Send the base_mode and system_status values to the plotter. This uses the ground time
 			// so the Ground Time checkbox must be ticked for these values to display
             quint64 time = getUnixTime();
-			QString name = QString("M%1:HEARTBEAT.%2").arg(message.sysid);
-			emit valueChanged(uasId, name.arg("base_mode"), "bits", state.base_mode, time);
-			emit valueChanged(uasId, name.arg("custom_mode"), "bits", state.custom_mode, time);
-			emit valueChanged(uasId, name.arg("system_status"), "-", state.system_status, time);
+			publish(ChBaseMode, state.base_mode, time);
+			publish(ChCustomMode, state.custom_mode, time);
+			publish(ChSystemStatus, state.system_status, time);
 			
             // Set new type if it has changed
+            bool typeHasChanged = false;
             if (this->type != state.type)
             {
+                typeHasChanged = true;
                 this->type = state.type;
                 if (isFixedWing()) {
                     setAirframe(UASInterface::QGC_AIRFRAME_EASYSTAR);
@@ -451,6 +562,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 }
                 this->autopilot = state.autopilot;
                 emit systemTypeSet(this, type);
+                loadParameterCache();
             }
 
             bool currentlyArmed = state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
@@ -489,7 +601,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 modeHasChanged = true;
                 receivedMode = true;
                 base_mode = state.base_mode;
-                shortModeText = getShortModeTextFor(base_mode);
+                shortModeText = StringPool::instance()->intern(getShortModeTextFor(base_mode));
                 emit modeChanged(this->getUASID(), shortModeText, "");
             }
 
@@ -497,7 +609,16 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 QLOG_DEBUG() << "UAS: new custom mode " << state.custom_mode;
                 customModeHasChanged = true;
                 custom_mode = state.custom_mode;
-                emit navModeChanged(uasId, state.custom_mode, getCustomModeText());
+            }
+
+            // The text depends on the type too; modes that read the same,
+            // such as the reserved ones, leave the HUD alone
+            if (customModeHasChanged || typeHasChanged) {
+                const QString text = StringPool::instance()->intern(getCustomModeText());
+                if (text != navModeText) {
+                    navModeText = text;
+                    emit navModeChanged(uasId, custom_mode, navModeText);
+                }
             }
 
             // AUDIO
@@ -517,18 +638,17 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 
             // Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
             quint64 time = getUnixTime();
-            QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-            emit valueChanged(uasId, name.arg("Sensors Enabled"), "bits", state.onboard_control_sensors_enabled, time);
-            emit valueChanged(uasId, name.arg("Sensors Health"), "bits", state.onboard_control_sensors_health, time);
-            emit valueChanged(uasId, name.arg("Comms Errors"), "-", state.errors_comm, time);
-            emit valueChanged(uasId, name.arg("Errors Count 1"), "-", state.errors_count1, time);
-            emit valueChanged(uasId, name.arg("Errors Count 2"), "-", state.errors_count2, time);
-            emit valueChanged(uasId, name.arg("Errors Count 3"), "-", state.errors_count3, time);
-            emit valueChanged(uasId, name.arg("Errors Count 4"), "-", state.errors_count4, time);
+            publish(ChSensorsEnabled, state.onboard_control_sensors_enabled, time);
+            publish(ChSensorsHealth, state.onboard_control_sensors_health, time);
+            publish(ChCommsErrors, state.errors_comm, time);
+            publish(ChErrorsCount1, state.errors_count1, time);
+            publish(ChErrorsCount2, state.errors_count2, time);
+            publish(ChErrorsCount3, state.errors_count3, time);
+            publish(ChErrorsCount4, state.errors_count4, time);
 
 			// Process CPU load.
             emit loadChanged(this,state.load/10.0);
-            emit valueChanged(uasId, name.arg("CPU Load"), "%", state.load/10.0, time);
+            publish(ChCpuLoad, state.load/10.0, time);
 
 			// Battery charge/time remaining/voltage calculations
             currentVoltage = state.voltage_battery/1000.0;
@@ -551,7 +671,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     /* warn only every 12 seconds */
                     && (QGC::groundTimeUsecs() - lastVoltageWarning) > 12000000)
             {
-                GAudioOutput::instance()->say(QString("voltage warning: %1 volts").arg(lpVoltage, 0, 'f', 1, QChar(' ')));
+                GAudioOutput::instance()->say(QString("voltage warning: %1 volts").arg(lpVoltage, 0, 'f', 1, QChar(' ')), MAV_SEVERITY_WARNING);
                 lastVoltageWarning = QGC::groundTimeUsecs();
                 lastTickVoltageValue = tickLowpassVoltage;
             }
@@ -566,14 +686,14 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             emit batteryChanged(this, lpVoltage, currentCurrent, getChargeLevel(), timeRemaining);
             // emit voltageChanged(message.sysid, currentVoltage);
 
-            emit valueChanged(uasId, name.arg("Battery"), "%", state.battery_remaining, time);
-            emit valueChanged(uasId, name.arg("Voltage"), "V", state.voltage_battery/1000.0, time);
+            publish(ChBattery, state.battery_remaining, time);
+            publish(ChVoltage, state.voltage_battery/1000.0, time);
 
 			// And if the battery current draw is measured, log that also.
 			if (state.current_battery != -1)
 			{
                 currentCurrent = ((double)state.current_battery)/100.0;
-                emit valueChanged(uasId, name.arg("Current"), "A", currentCurrent, time);
+                publish(ChCurrent, currentCurrent, time);
 			}
 
             // LOW BATTERY ALARM
@@ -603,7 +723,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 				state.drop_rate_comm = 10000;
 			}
             emit dropRateChanged(this->getUASID(), state.drop_rate_comm/100.0);
-            emit valueChanged(uasId, name.arg("Comms Drop Rate"), "%", state.drop_rate_comm/100.0, time);
+            publish(ChCommsDropRate, state.drop_rate_comm/100.0, time);
 		}
             break;
         case MAVLINK_MSG_ID_ATTITUDE:
@@ -620,16 +740,15 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 setRoll(QGC::limitAngleToPMPIf(attitude.roll));
                 setPitch(QGC::limitAngleToPMPIf(attitude.pitch));
                 setYaw(QGC::limitAngleToPMPIf(attitude.yaw));
-
+                attitudeQuaternion = AttitudeMatrix::fromEuler(attitude.roll, attitude.pitch, attitude.yaw);
 
                 attitudeKnown = true;
                 emit attitudeChanged(this, getRoll(), getPitch(), getYaw(), time);
                 emit attitudeRotationRatesChanged(uasId, attitude.rollspeed, attitude.pitchspeed, attitude.yawspeed, time);
 
-                QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-                emit valueChanged(uasId,name.arg("Roll"),"deg",QVariant(getRoll() * (180.0/M_PI)),time);
-                emit valueChanged(uasId,name.arg("Pitch"),"deg",QVariant(getPitch() * (180.0/M_PI)),time);
-                emit valueChanged(uasId,name.arg("Yaw"),"deg",QVariant(getYaw() * (180.0/M_PI)),time);
+                publish(ChRoll, getRoll() * (180.0/M_PI), time);
+                publish(ChPitch, getPitch() * (180.0/M_PI), time);
+                publish(ChYaw, getYaw() * (180.0/M_PI), time);
             }
         }
             break;
@@ -639,43 +758,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_msg_attitude_quaternion_decode(&message, &attitude);
             quint64 time = getUnixReferenceTime(attitude.time_boot_ms);
 
-            double a = attitude.q1;
-            double b = attitude.q2;
-            double c = attitude.q3;
-            double d = attitude.q4;
-
-            double aSq = a * a;
-            double bSq = b * b;
-            double cSq = c * c;
-            double dSq = d * d;
-            float dcm[3][3];
-            dcm[0][0] = aSq + bSq - cSq - dSq;
-            dcm[0][1] = 2.0 * (b * c - a * d);
-            dcm[0][2] = 2.0 * (a * c + b * d);
-            dcm[1][0] = 2.0 * (b * c + a * d);
-            dcm[1][1] = aSq - bSq + cSq - dSq;
-            dcm[1][2] = 2.0 * (c * d - a * b);
-            dcm[2][0] = 2.0 * (b * d - a * c);
-            dcm[2][1] = 2.0 * (a * b + c * d);
-            dcm[2][2] = aSq - bSq - cSq + dSq;
-
+            const AttitudeQuaternion q = AttitudeMatrix::fromMavlink(attitude.q1, attitude.q2, attitude.q3, attitude.q4);
             float phi, theta, psi;
-            theta = asin(-dcm[2][0]);
-
-            if (fabs(theta - M_PI_2) < 1.0e-3f) {
-                phi = 0.0f;
-                psi = (atan2(dcm[1][2] - dcm[0][1],
-                        dcm[0][2] + dcm[1][1]) + phi);
-
-            } else if (fabs(theta + M_PI_2) < 1.0e-3f) {
-                phi = 0.0f;
-                psi = atan2f(dcm[1][2] - dcm[0][1],
-                          dcm[0][2] + dcm[1][1] - phi);
-
-            } else {
-                phi = atan2f(dcm[2][1], dcm[2][2]);
-                psi = atan2f(dcm[1][0], dcm[0][0]);
-            }
+            AttitudeMatrix::toEuler(q, &phi, &theta, &psi);
 
             emit attitudeChanged(this, message.compid, QGC::limitAngleToPMPIf(phi),
                                  QGC::limitAngleToPMPIf(theta),
@@ -687,6 +772,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 setRoll(QGC::limitAngleToPMPIf(phi));
                 setPitch(QGC::limitAngleToPMPIf(theta));
                 setYaw(QGC::limitAngleToPMPIf(psi));
+                attitudeQuaternion = q;
 
                 attitudeKnown = true;
                 emit attitudeChanged(this, getRoll(), getPitch(), getYaw(), time);
@@ -795,13 +881,12 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             setAltitudeRelative(pos.relative_alt/1000.0);
 			
             //valueChanged(uasId, str.arg(vect.address+(i*2)), "ui16", mem1[i], time);
-            QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-            emit valueChanged(uasId,name.arg("Latitude"),"deg",QVariant((double)pos.lat / (double(1E7))),time);
-            emit valueChanged(uasId,name.arg("Longitude"),"deg",QVariant((double)pos.lon / (double(1E7))),time);
-            emit valueChanged(uasId,name.arg("Altitude (GPS)"),"m",QVariant((double)pos.alt / 1000.0),time);
-            emit valueChanged(uasId,name.arg("Altitude (REL)"),"m",QVariant((double)pos.relative_alt / 1000.0),time);
-            emit valueChanged(uasId,name.arg("Heading (GPS)"),"degs",QVariant((double)pos.hdg),time);
-            emit valueChanged(uasId,name.arg("Climb"),"m/s",QVariant((double)pos.vz / 100.0),time);
+            publish(ChLatitude, (double)pos.lat / (double(1E7)), time);
+            publish(ChLongitude, (double)pos.lon / (double(1E7)), time);
+            publish(ChAltitudeGps, (double)pos.alt / 1000.0, time);
+            publish(ChAltitudeRel, (double)pos.relative_alt / 1000.0, time);
+            publish(ChHeadingGps, (double)pos.hdg, time);
+            publish(ChClimb, (double)pos.vz / 100.0, time);
 
             globalEstimatorActive = true;
 
@@ -835,7 +920,6 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_msg_gps_raw_int_decode(&message, &pos);
 
             quint64 time = getUnixTime(pos.time_usec);
-            QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
 
             emit gpsLocalizationChanged(this, pos.fix_type);
             // TODO: track localization state not only for gps but also for other loc. sources
@@ -877,7 +961,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     {
                         setGroundSpeed(vel);
                         emit speedChanged(this, groundSpeed, airSpeed, time);
-                        emit valueChanged(uasId,name.arg("GPS Velocity"),"m/s",QVariant(vel),time);
+                        publish(ChGpsVelocity, vel, time);
                     }
                     else
                     {
@@ -886,10 +970,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 }
             }
 
-            emit valueChanged(uasId,name.arg("GPS Fix"),"",pos.fix_type,time);
-            emit valueChanged(uasId,name.arg("GPS Sats"),"",pos.satellites_visible,time);
-            emit valueChanged(uasId,name.arg("GPS HDOP"),"m", pos.eph/100.0,time);
-            emit valueChanged(uasId,name.arg("GPS COG"),"",pos.cog/100.0,time);
+            publish(ChGpsFix, pos.fix_type, time);
+            publish(ChGpsSats, pos.satellites_visible, time);
+            publish(ChGpsHdop, pos.eph/100.0, time);
+            publish(ChGpsCog, pos.cog/100.0, time);
 
         }
             break;
@@ -897,10 +981,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
         {
             mavlink_gps_status_t pos;
             mavlink_msg_gps_status_decode(&message, &pos);
-            for(int i = 0; i < (int)pos.satellites_visible; i++)
-            {
-                emit gpsSatelliteStatusChanged(uasId, (unsigned char)pos.satellite_prn[i], (unsigned char)pos.satellite_elevation[i], (unsigned char)pos.satellite_azimuth[i], (unsigned char)pos.satellite_snr[i], static_cast<bool>(pos.satellite_used[i]));
-            }
+            const quint32 changed = m_gpsSatellites.update(pos.satellites_visible, pos.satellite_prn,
+                    pos.satellite_elevation, pos.satellite_azimuth, pos.satellite_snr, pos.satellite_used);
+            if (changed)
+                emit gpsSatellitesChanged(uasId, changed);
             setSatelliteCount(pos.satellites_visible);
         }
             break;
@@ -916,25 +1000,15 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_rc_channels_raw_t channels;
             mavlink_msg_rc_channels_raw_decode(&message, &channels);
 
-            const unsigned int portWidth = 8; // XXX magic number
+            const uint16_t raw[RadioChannels::PortWidth] = {
+                channels.chan1_raw, channels.chan2_raw, channels.chan3_raw, channels.chan4_raw,
+                channels.chan5_raw, channels.chan6_raw, channels.chan7_raw, channels.chan8_raw
+            };
 
             emit remoteControlRSSIChanged(channels.rssi/255.0f);
-            if (channels.chan1_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 0, channels.chan1_raw);
-            if (channels.chan2_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 1, channels.chan2_raw);
-            if (channels.chan3_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 2, channels.chan3_raw);
-            if (channels.chan4_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 3, channels.chan4_raw);
-            if (channels.chan5_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 4, channels.chan5_raw);
-            if (channels.chan6_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 5, channels.chan6_raw);
-            if (channels.chan7_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 6, channels.chan7_raw);
-            if (channels.chan8_raw != UINT16_MAX)
-                emit remoteControlChannelRawChanged(channels.port * portWidth + 7, channels.chan8_raw);
+            const quint32 changed = m_rcChannels.update(channels.port, raw);
+            if (changed)
+                emit remoteControlChannelsChanged(changed);
         }
             break;
         case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
@@ -942,25 +1016,15 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_rc_channels_scaled_t channels;
             mavlink_msg_rc_channels_scaled_decode(&message, &channels);
 
-            const unsigned int portWidth = 8; // XXX magic number
+            const int16_t scaled[RadioChannels::PortWidth] = {
+                channels.chan1_scaled, channels.chan2_scaled, channels.chan3_scaled, channels.chan4_scaled,
+                channels.chan5_scaled, channels.chan6_scaled, channels.chan7_scaled, channels.chan8_scaled
+            };
 
             emit remoteControlRSSIChanged(channels.rssi/255.0f);
-            if (static_cast<uint16_t>(channels.chan1_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 0, channels.chan1_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan2_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 1, channels.chan2_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan3_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 2, channels.chan3_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan4_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 3, channels.chan4_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan5_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 4, channels.chan5_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan6_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 5, channels.chan6_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan7_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 6, channels.chan7_scaled/10000.0f);
-            if (static_cast<uint16_t>(channels.chan8_scaled) != UINT16_MAX)
-                emit remoteControlChannelScaledChanged(channels.port * portWidth + 7, channels.chan8_scaled/10000.0f);
+            const quint32 changed = m_rcChannels.updateScaled(channels.port, scaled);
+            if (changed)
+                emit remoteControlChannelsScaledChanged(changed);
         }
             break;
         case MAVLINK_MSG_ID_PARAM_VALUE:
@@ -983,6 +1047,12 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
         {
             mavlink_command_ack_t ack;
             mavlink_msg_command_ack_decode(&message, &ack);
+            m_commandTracker->ackReceived(message.compid, ack.command, ack.result);
+            if (ack.command == StreamNegotiator::SetMessageIntervalCommand)
+            {
+                // Stream negotiation, one per message, nothing the pilot asked for
+                break;
+            }
             switch (ack.result)
             {
             case MAV_RESULT_ACCEPTED:
@@ -1012,6 +1082,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 break;
             }
         }
+            break;
         case MAVLINK_MSG_ID_ROLL_PITCH_YAW_THRUST_SETPOINT:
         {
             mavlink_roll_pitch_yaw_thrust_setpoint_t out;
@@ -1022,29 +1093,25 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             break;
         case MAVLINK_MSG_ID_MISSION_COUNT:
         {
-            mavlink_mission_count_t wpc;
-            mavlink_msg_mission_count_decode(&message, &wpc);
+            m_missionSync->received(message);
         }
             break;
 
         case MAVLINK_MSG_ID_MISSION_ITEM:
         {
-            mavlink_mission_item_t wp;
-            mavlink_msg_mission_item_decode(&message, &wp);
+            m_missionSync->received(message);
         }
             break;
 
         case MAVLINK_MSG_ID_MISSION_ACK:
         {
-            mavlink_mission_ack_t wpa;
-            mavlink_msg_mission_ack_decode(&message, &wpa);
+            m_missionSync->received(message);
         }
             break;
 
         case MAVLINK_MSG_ID_MISSION_REQUEST:
         {
-            mavlink_mission_request_t wpr;
-            mavlink_msg_mission_request_decode(&message, &wpr);
+            m_missionSync->received(message);
         }
             break;
 
@@ -1085,14 +1152,26 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             break;
         case MAVLINK_MSG_ID_STATUSTEXT:
         {
-            QByteArray b;
-            b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1);
-            mavlink_msg_statustext_get_text(&message, b.data());
+            char b[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1];
+            mavlink_msg_statustext_get_text(&message, b);
             // Ensure NUL-termination
-            b[b.length()-1] = '\0';
-            QString text = QString(b);
+            b[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN] = '\0';
+            // Autopilots repeat the same few texts, a repeat shares the first one's string
+            QString text = StringPool::instance()->intern(QByteArray::fromRawData(b, qstrlen(b)));
             int severity = mavlink_msg_statustext_get_severity(&message);
 
+            QString firmware = ParameterCache::firmwareFromText(text);
+            if (!firmware.isEmpty() && firmware != m_parameterCache.firmware())
+            {
+                if (m_parameterCacheLoaded && !m_parameterCache.firmware().isEmpty())
+                {
+                    // The download in progress replaces every value
+                    QLOG_INFO() << "Firmware changed from" << m_parameterCache.firmware() << "to" << firmware
+                                << ", cached parameters are stale";
+                }
+                m_parameterCache.setFirmware(firmware);
+            }
+
             if (text.startsWith("#audio:"))
             {
                 text.remove("#audio:");
@@ -1123,21 +1202,12 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                                  static_cast<float>(raw.servo7_raw), static_cast<float>(raw.servo8_raw));
         }
         break;
-#ifdef MAVLINK_ENABLED_PIXHAWK
+#ifdef MAVLINK_MSG_ID_ENCAPSULATED_DATA
         case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
         {
             mavlink_data_transmission_handshake_t p;
             mavlink_msg_data_transmission_handshake_decode(&message, &p);
-            imageSize = p.size;
-            imagePackets = p.packets;
-            imagePayload = p.payload;
-            imageQuality = p.jpg_quality;
-            imageType = p.type;
-            imageWidth = p.width;
-            imageHeight = p.height;
-            imageStart = QGC::groundTimeMilliseconds();
-            imagePacketsArrived = 0;
-
+            m_imageTransfer->handshake(p.type, p.size, p.width, p.height, p.packets, p.payload, p.jpg_quality);
         }
             break;
 
@@ -1145,39 +1215,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
         {
             mavlink_encapsulated_data_t img;
             mavlink_msg_encapsulated_data_decode(&message, &img);
-            int seq = img.seqnr;
-            int pos = seq * imagePayload;
-
-            // Check if we have a valid transaction
-            if (imagePackets == 0)
-            {
-                // NO VALID TRANSACTION - ABORT
-                // Restart statemachine
-                imagePacketsArrived = 0;
-            }
-
-            for (int i = 0; i < imagePayload; ++i)
-            {
-                if (pos <= imageSize) {
-                    imageRecBuffer[pos] = img.data[i];
-                }
-                ++pos;
-            }
-
-            ++imagePacketsArrived;
-
-            // emit signal if all packets arrived
-            if ((imagePacketsArrived >= imagePackets))
-            {
-                // Restart statemachine
-                emit imageReady(this);
-                //QLOG_DEBUG() << "imageReady emitted. all packets arrived";
-            }
+            m_imageTransfer->received(img.seqnr, img.data, sizeof(img.data));
         }
             break;
-
-
-
 #endif
             //        case MAVLINK_MSG_ID_OBJECT_DETECTION_EVENT:
             //        {
@@ -1317,10 +1357,19 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_radio_t radio;
             mavlink_msg_radio_decode(&message, &radio);
             emit radioMessageUpdate(this, radio);
-            emit valueChanged(uasId, name.arg("Radio RSSI"), "", radio.rssi, time);
-            emit valueChanged(uasId, name.arg("Radio REM RSSI"), "", radio.remrssi, time);
-            emit valueChanged(uasId, name.arg("Radio noise"), "", radio.noise, time);
-            emit valueChanged(uasId, name.arg("Radio REM noise"), "", radio.remnoise, time);
+            m_streamRates->radioReceived(radio);
+            publish(ChRadioRssi, radio.rssi, time);
+            publish(ChRadioRemRssi, radio.remrssi, time);
+            publish(ChRadioNoise, radio.noise, time);
+            publish(ChRadioRemNoise, radio.remnoise, time);
+        }
+            break;
+        case MAVLINK_MSG_ID_RADIO_STATUS:
+        {
+            // VehicleOverview shows it, the tuner sizes the link budget with it
+            mavlink_radio_status_t radio;
+            mavlink_msg_radio_status_decode(&message, &radio);
+            m_streamRates->radioReceived(radio);
         }
             break;
         // MAVLink Log donwload messages
@@ -1329,12 +1378,13 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             // we have revceived a log entry from the MAV
             mavlink_log_entry_t log_entry;
             mavlink_msg_log_entry_decode(&message, &log_entry);
+            m_logDownload->entryReceived(log_entry.id, log_entry.size);
             emit logEntry(uasId, log_entry.time_utc, log_entry.size, log_entry.id, log_entry.num_logs, log_entry.last_log_num);
         }
             break;
         case MAVLINK_MSG_ID_LOG_DATA:
         {
-            //data that is part of a paticular log
+            //data that is part of a paticular log, LogDownload takes it on the ingest thread while it runs
             mavlink_log_data_t log_data;
             mavlink_msg_log_data_decode(&message, &log_data);
             emit logData(uasId, log_data.ofs, log_data.id, log_data.count, (const char*)log_data.data);
@@ -1362,6 +1412,13 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             emit scaledImu2MessageUpdate(this, scaledImu2);
         }
             break;
+        case MAVLINK_MSG_ID_HIGHRES_IMU:
+        {
+            mavlink_highres_imu_t highresImu;
+            mavlink_msg_highres_imu_decode(&message, &highresImu);
+            emit highresImuMessageUpdate(this, highresImu);
+        }
+            break;
         case MAVLINK_MSG_ID_RANGEFINDER:
         {
             mavlink_rangefinder_t rangeFinder;
@@ -1378,7 +1435,6 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
         case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
         case MAVLINK_MSG_ID_NAMED_VALUE_INT:
         case MAVLINK_MSG_ID_MANUAL_CONTROL:
-        case MAVLINK_MSG_ID_HIGHRES_IMU:
             break;
         default:
         {
@@ -1401,6 +1457,37 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 
 
 #if defined(QGC_PROTOBUF_ENABLED)
+namespace {
+struct SourceFields
+{
+    const google::protobuf::FieldDescriptor* header;
+    const google::protobuf::FieldDescriptor* sourceSysId;
+};
+}
+
+/**
+ * The header and header.source_sysid fields of a message type. Looking
+ * them up by name walks the descriptor, so it is done once per type;
+ * descriptors live as long as the program.
+ */
+static const SourceFields& sourceFields(const google::protobuf::Descriptor* descriptor)
+{
+    static QHash<const google::protobuf::Descriptor*, SourceFields> cache;
+    QHash<const google::protobuf::Descriptor*, SourceFields>::iterator it = cache.find(descriptor);
+    if (it == cache.end())
+    {
+        SourceFields fields;
+        fields.header = descriptor->FindFieldByName("header");
+        fields.sourceSysId = NULL;
+        if (fields.header && fields.header->message_type())
+        {
+            fields.sourceSysId = fields.header->message_type()->FindFieldByName("source_sysid");
+        }
+        it = cache.insert(descriptor, fields);
+    }
+    return it.value();
+}
+
 /**
 * Receive an extended message.
 * @param link
@@ -1412,7 +1499,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
     {
         return;
     }
-    if (!links->contains(link))
+    if (!knowsLink(link))
     {
         addLink(link);
     }
@@ -1423,29 +1510,17 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
         return;
     }
 
-    const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
-    if (!headerField)
-    {
-        return;
-    }
-
-    const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
-    if (!headerDescriptor)
-    {
-        return;
-    }
-
-    const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
-    if (!sourceSysIdField)
+    const SourceFields& fields = sourceFields(descriptor);
+    if (!fields.header || !fields.sourceSysId)
     {
         return;
     }
 
     const google::protobuf::Reflection* reflection = message->GetReflection();
-    const google::protobuf::Message& headerMsg = reflection->GetMessage(*message, headerField);
+    const google::protobuf::Message& headerMsg = reflection->GetMessage(*message, fields.header);
     const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
 
-    int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
+    int source_sysid = headerReflection->GetInt32(headerMsg, fields.sourceSysId);
 
     if (source_sysid != uasId)
     {
@@ -1453,7 +1528,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
     }
 
 #ifdef QGC_USE_PIXHAWK_MESSAGES
-    if (message->GetTypeName() == overlay.GetTypeName())
+    if (descriptor == overlay.GetDescriptor())
     {
         receivedOverlayTimestamp = QGC::groundTimeSeconds();
         overlayMutex.lock();
@@ -1461,7 +1536,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
         overlayMutex.unlock();
         emit overlayChanged(this);
     }
-    else if (message->GetTypeName() == obstacleList.GetTypeName())
+    else if (descriptor == obstacleList.GetDescriptor())
     {
         receivedObstacleListTimestamp = QGC::groundTimeSeconds();
         obstacleListMutex.lock();
@@ -1469,7 +1544,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
         obstacleListMutex.unlock();
         emit obstacleListChanged(this);
     }
-    else if (message->GetTypeName() == path.GetTypeName())
+    else if (descriptor == path.GetDescriptor())
     {
         receivedPathTimestamp = QGC::groundTimeSeconds();
         pathMutex.lock();
@@ -1477,7 +1552,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
         pathMutex.unlock();
         emit pathChanged(this);
     }
-    else if (message->GetTypeName() == pointCloud.GetTypeName())
+    else if (descriptor == pointCloud.GetDescriptor())
     {
         receivedPointCloudTimestamp = QGC::groundTimeSeconds();
         pointCloudMutex.lock();
@@ -1485,7 +1560,7 @@ void UAS::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<googl
         pointCloudMutex.unlock();
         emit pointCloudChanged(this);
     }
-    else if (message->GetTypeName() == rgbdImage.GetTypeName())
+    else if (descriptor == rgbdImage.GetDescriptor())
     {
         receivedRGBDImageTimestamp = QGC::groundTimeSeconds();
         rgbdImageMutex.lock();
@@ -1527,12 +1602,10 @@ void UAS::setHomePosition(double lat, double lon, double alt)
 
     if (ret == QMessageBox::Yes)
     {
-        mavlink_message_t msg;
-        mavlink_msg_command_long_pack(systemId, componentId, &msg, this->getUASID(), 0, MAV_CMD_DO_SET_HOME, 1, 0, 0, 0, 0, lat, lon, alt);
-        // Send message twice to increase chance that it reaches its goal
-        sendMessage(msg);
+        executeCommand(MAV_CMD_DO_SET_HOME, 1, 0, 0, 0, 0, lat, lon, alt, 0);
 
         // Send new home position to UAS
+        mavlink_message_t msg;
         mavlink_set_gps_global_origin_t home;
         home.target_system = uasId;
         home.latitude = lat*1E7;
@@ -1565,10 +1638,7 @@ void UAS::setLocalOriginAtCurrentGPSPosition()
 
     if (ret == QMessageBox::Yes)
     {
-        mavlink_message_t msg;
-        mavlink_msg_command_long_pack(systemId, componentId, &msg, this->getUASID(), 0, MAV_CMD_DO_SET_HOME, 1, 1, 0, 0, 0, 0, 0, 0);
-        // Send message twice to increase chance that it reaches its goal
-        sendMessage(msg);
+        executeCommand(MAV_CMD_DO_SET_HOME, 1, 1, 0, 0, 0, 0, 0, 0, 0);
     }
 }
 
@@ -1619,6 +1689,8 @@ void UAS::startRadioControlCalibration(int param)
     // Param 1: gyro cal, param 2: mag cal, param 3: pressure cal, Param 4: radio
     mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, 0, MAV_CMD_PREFLIGHT_CALIBRATION, 1, 0, 0, 0, param, 0, 0, 0);
     sendMessage(msg);
+    if (param != 0)
+        m_rcChannels.startCalibration();
 }
 
 void UAS::endRadioControlCalibration()
@@ -1627,6 +1699,7 @@ void UAS::endRadioControlCalibration()
     // Param 1: gyro cal, param 2: mag cal, param 3: pressure cal, Param 4: radio
     mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, 0, MAV_CMD_PREFLIGHT_CALIBRATION, 1, 0, 0, 0, 0, 0, 0, 0);
     sendMessage(msg);
+    m_rcChannels.endCalibration();
 }
 
 void UAS::startDataRecording()
@@ -1808,19 +1881,12 @@ quint64 UAS::getUnixTime(quint64 time)
 */
 QList<QString> UAS::getParameterNames(int component)
 {
-    if (parameters.contains(component))
-    {
-        return parameters.value(component)->keys();
-    }
-    else
-    {
-        return QList<QString>();
-    }
+    return m_parameters.names(component);
 }
 
 QList<int> UAS::getComponentIds()
 {
-    return parameters.keys();
+    return m_parameters.components();
 }
 
 void UAS::setMode(int mode)
@@ -1910,8 +1976,9 @@ void UAS::sendMessage(mavlink_message_t message)
         QLOG_WARN() << "NO LINK AVAILABLE TO SEND!";
     }
 
-    // Emit message on all links that are currently connected
-    foreach (LinkInterface* link, *links)
+    // Emit message on all links that are currently connected, a link group only on its best link
+    QList<LinkInterface*> targets = LinkManager::instance()->getMavlinkProtocol()->fusion()->sendLinks(*links, message.msgid);
+    foreach (LinkInterface* link, targets)
     {
         //if (LinkManager::instance()->getLinks().contains(link))
         //{
@@ -1955,18 +2022,12 @@ void UAS::sendHeartbeat()
 void UAS::sendMessage(LinkInterface* link, mavlink_message_t message)
 {
     if(!link) return;
-    // Create buffer
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    // Write message into buffer, prepending start sign
-    int len = mavlink_msg_to_send_buffer(buffer, &message);
-    static uint8_t messageKeys[256] = MAVLINK_MESSAGE_CRCS;
-    mavlink_finalize_message_chan(&message, systemId, componentId, link->getId(), message.len, messageKeys[message.msgid]);
 
     // If link is connected
     if (link->isConnected())
     {
-        // Send the portion of the buffer now occupied by the message
-        link->writeBytes((const char*)buffer, len);
+        // Queued by priority and coalesced with whatever else goes out this turn
+        LinkManager::instance()->getMavlinkProtocol()->sendMessage(link, message);
     }
     else
     {
@@ -2057,73 +2118,32 @@ void UAS::getStatusForCode(int statusCode, QString& uasState, QString& stateDesc
 
 QImage UAS::getImage()
 {
-#ifdef MAVLINK_ENABLED_PIXHAWK
-
-//    QLOG_DEBUG() << "IMAGE TYPE:" << imageType;
-
-    // RAW greyscale
-    if (imageType == MAVLINK_DATA_STREAM_IMG_RAW8U)
-    {
-        int imgColors = 255;
-
-        // Construct PGM header
-        QString header("P5\n%1 %2\n%3\n");
-        header = header.arg(imageWidth).arg(imageHeight).arg(imgColors);
-
-        QByteArray tmpImage(header.toStdString().c_str(), header.toStdString().size());
-        tmpImage.append(imageRecBuffer);
-
-        //QLOG_DEBUG() << "IMAGE SIZE:" << tmpImage.size() << "HEADER SIZE: (15):" << header.size() << "HEADER: " << header;
-
-        if (imageRecBuffer.isNull())
-        {
-            QLOG_DEBUG()<< "could not convertToPGM()";
-            return QImage();
-        }
-
-        if (!image.loadFromData(tmpImage, "PGM"))
-        {
-            QLOG_DEBUG()<< __FILE__ << __LINE__ << "could not create extracted image";
-            return QImage();
-        }
-
-    }
-    // BMP with header
-    else if (imageType == MAVLINK_DATA_STREAM_IMG_BMP ||
-             imageType == MAVLINK_DATA_STREAM_IMG_JPEG ||
-             imageType == MAVLINK_DATA_STREAM_IMG_PGM ||
-             imageType == MAVLINK_DATA_STREAM_IMG_PNG)
-    {
-        if (!image.loadFromData(imageRecBuffer))
-        {
-            QLOG_DEBUG() << __FILE__ << __LINE__ << "Loading data from image buffer failed!";
-        }
-    }
-    // Restart statemachine
-    imagePacketsArrived = 0;
-    //imageRecBuffer.clear();
-    return image;
-#else
-    return QImage();
-#endif
-
+    return m_imageTransfer->image();
 }
 
 void UAS::requestImage()
 {
-#ifdef MAVLINK_ENABLED_PIXHAWK
     QLOG_DEBUG() << "trying to get an image from the uas...";
+    m_imageTransfer->start(MAVLINK_DATA_STREAM_IMG_JPEG, 50);
+}
 
-    // check if there is already an image transmission going on
-    if (imagePacketsArrived == 0)
-    {
-        mavlink_message_t msg;
-        mavlink_msg_data_transmission_handshake_pack(systemId, componentId, &msg, MAVLINK_DATA_STREAM_IMG_JPEG, 0, 0, 0, 0, 0, 50);
-        sendMessage(msg);
-    }
+void UAS::sendImageRequest(int type, int quality)
+{
+#ifdef MAVLINK_MSG_ID_ENCAPSULATED_DATA
+    mavlink_message_t msg;
+    mavlink_msg_data_transmission_handshake_pack(systemId, componentId, &msg, type, 0, 0, 0, 0, 0, quality);
+    sendMessage(msg);
+#else
+    Q_UNUSED(type);
+    Q_UNUSED(quality);
 #endif
 }
 
+void UAS::imageTransferReady()
+{
+    emit imageReady(this);
+}
+
 
 /* MANAGEMENT */
 
@@ -2150,6 +2170,11 @@ int UAS::getCommunicationStatus() const
 }
 
 void UAS::requestParameters()
+{
+    m_parameterSync->start();
+}
+
+void UAS::requestParameterList()
 {
     mavlink_message_t msg;
     mavlink_msg_param_request_list_pack(systemId, componentId, &msg, this->getUASID(), MAV_COMP_ID_ALL);
@@ -2157,21 +2182,54 @@ void UAS::requestParameters()
     QLOG_DEBUG() << __FILE__ << __LINE__ << "LOADING PARAM LIST";
 }
 
-void UAS::writeParametersToStorage()
+void UAS::requestMissionList()
 {
     mavlink_message_t msg;
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, 0, MAV_CMD_PREFLIGHT_STORAGE, 1, 1, -1, -1, -1, 0, 0, 0);
-    QLOG_DEBUG() << "SENT COMMAND" << MAV_CMD_PREFLIGHT_STORAGE;
+    mavlink_msg_mission_request_list_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_MISSIONPLANNER);
     sendMessage(msg);
 }
 
-void UAS::readParametersFromStorage()
+void UAS::requestMissionItem(int seq)
 {
     mavlink_message_t msg;
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, 0, MAV_CMD_PREFLIGHT_STORAGE, 1, 0, -1, -1, -1, 0, 0, 0);
+    mavlink_msg_mission_request_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_MISSIONPLANNER, seq);
     sendMessage(msg);
 }
 
+void UAS::sendMissionCount(int count)
+{
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_MISSIONPLANNER, count);
+    sendMessage(msg);
+}
+
+void UAS::sendMissionItem(const mavlink_mission_item_t &item)
+{
+    mavlink_mission_item_t addressed = item;
+    addressed.target_system = uasId;
+    addressed.target_component = MAV_COMP_ID_MISSIONPLANNER;
+    mavlink_message_t msg;
+    mavlink_msg_mission_item_encode(systemId, componentId, &msg, &addressed);
+    sendMessage(msg);
+}
+
+void UAS::sendMissionAck(int type)
+{
+    mavlink_message_t msg;
+    mavlink_msg_mission_ack_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_MISSIONPLANNER, type);
+    sendMessage(msg);
+}
+
+void UAS::writeParametersToStorage()
+{
+    executeCommand(MAV_CMD_PREFLIGHT_STORAGE, 1, 1, -1, -1, -1, 0, 0, 0, 0);
+}
+
+void UAS::readParametersFromStorage()
+{
+    executeCommand(MAV_CMD_PREFLIGHT_STORAGE, 1, 0, -1, -1, -1, 0, 0, 0, 0);
+}
+
 
 
 
@@ -2433,208 +2491,208 @@ void UAS::enableExtra3Transmission(int rate)
  */
 void UAS::setParameter(const int compId, const QString& paramId, const QVariant& value)
 {
-    if (!paramId.isNull())
+    mavlink_param_set_t p;
+    if (encodeParameter(compId, paramId, value, &p))
     {
-        mavlink_message_t msg;
-        mavlink_param_set_t p;
-        mavlink_param_union_t union_value;
+        sendParameterSet(p);
+    }
+}
+
+/**
+ * Fill a PARAM_SET, the value is encoded the way the autopilot expects it
+ *
+ * @return false if the name is empty or the value has no parameter type
+ */
+bool UAS::encodeParameter(const int compId, const QString& paramId, const QVariant& value, mavlink_param_set_t *set) const
+{
+    if (paramId.isNull())
+    {
+        return false;
+    }
+    mavlink_param_set_t &p = *set;
+    mavlink_param_union_t union_value;
 
-        // Assign correct value based on QVariant
-        // TODO: This is a hack for MAV_AUTOPILOT_ARDUPILOTMEGA until the new version of MAVLink and a fix for their param handling.
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA)
+    // Assign correct value based on QVariant
+    // TODO: This is a hack for MAV_AUTOPILOT_ARDUPILOTMEGA until the new version of MAVLink and a fix for their param handling.
+    if (autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA)
+    {
+        switch (value.type())
         {
-            switch (value.type())
-            {
-            case QVariant::Char:
-                union_value.param_float = static_cast<char>(value.toChar().toLatin1());
-                p.param_type = MAV_PARAM_TYPE_INT8;
-                break;
-            case QVariant::Int:
-                union_value.param_float = value.toInt();
-                p.param_type = MAV_PARAM_TYPE_INT32;
-                break;
-            case QVariant::UInt:
-                union_value.param_float = value.toUInt();
-                p.param_type = MAV_PARAM_TYPE_UINT32;
-                break;
-            case QVariant::Double:
-            case QMetaType::Float:
-                union_value.param_float = value.toFloat();
-                p.param_type = MAV_PARAM_TYPE_REAL32;
-                break;
-            default:
-                QLOG_ERROR() << "ABORTED PARAM SEND, NO VALID QVARIANT TYPE:" << paramId << "TYPE IS:" << value.type();
-                return;
-            }
+        case QVariant::Char:
+            union_value.param_float = static_cast<char>(value.toChar().toLatin1());
+            p.param_type = MAV_PARAM_TYPE_INT8;
+            break;
+        case QVariant::Int:
+            union_value.param_float = value.toInt();
+            p.param_type = MAV_PARAM_TYPE_INT32;
+            break;
+        case QVariant::UInt:
+            union_value.param_float = value.toUInt();
+            p.param_type = MAV_PARAM_TYPE_UINT32;
+            break;
+        case QVariant::Double:
+        case QMetaType::Float:
+            union_value.param_float = value.toFloat();
+            p.param_type = MAV_PARAM_TYPE_REAL32;
+            break;
+        default:
+            QLOG_ERROR() << "ABORTED PARAM SEND, NO VALID QVARIANT TYPE:" << paramId << "TYPE IS:" << value.type();
+            return false;
         }
-        else
+    }
+    else
+    {
+        switch (value.type())
         {
-            switch (value.type())
-            {
-            case QVariant::Char:
-                union_value.param_int8 = static_cast<unsigned char>(value.toChar().toLatin1());
-                p.param_type = MAV_PARAM_TYPE_INT8;
-                break;
-            case QVariant::Int:
-                union_value.param_int32 = value.toInt();
-                p.param_type = MAV_PARAM_TYPE_INT32;
-                break;
-            case QVariant::UInt:
-                union_value.param_uint32 = value.toUInt();
-                p.param_type = MAV_PARAM_TYPE_UINT32;
-                break;
-            case QVariant::Double:
-            case QMetaType::Float:
-                union_value.param_float = value.toFloat();
-                p.param_type = MAV_PARAM_TYPE_REAL32;
-                break;
-            default:
-                QLOG_ERROR() << "ABORTED PARAM SEND, NO VALID QVARIANT TYPE:" << paramId << "TYPE IS:" << value.type();
-                return;
-            }
+        case QVariant::Char:
+            union_value.param_int8 = static_cast<unsigned char>(value.toChar().toLatin1());
+            p.param_type = MAV_PARAM_TYPE_INT8;
+            break;
+        case QVariant::Int:
+            union_value.param_int32 = value.toInt();
+            p.param_type = MAV_PARAM_TYPE_INT32;
+            break;
+        case QVariant::UInt:
+            union_value.param_uint32 = value.toUInt();
+            p.param_type = MAV_PARAM_TYPE_UINT32;
+            break;
+        case QVariant::Double:
+        case QMetaType::Float:
+            union_value.param_float = value.toFloat();
+            p.param_type = MAV_PARAM_TYPE_REAL32;
+            break;
+        default:
+            QLOG_ERROR() << "ABORTED PARAM SEND, NO VALID QVARIANT TYPE:" << paramId << "TYPE IS:" << value.type();
+            return false;
         }
+    }
 
-        p.param_value = union_value.param_float;
-        p.target_system = (uint8_t)uasId;
-        p.target_component = (uint8_t)compId;
+    p.param_value = union_value.param_float;
+    p.target_system = (uint8_t)uasId;
+    p.target_component = (uint8_t)compId;
 
-        //QLOG_DEBUG() << "SENT PARAM:" << value;
+    // Copy string into buffer, ensuring not to exceed the buffer size
+    QByteArray latin = paramId.toLatin1();
+    for (unsigned int i = 0; i < sizeof(p.param_id); i++)
+    {
+        // String characters, the rest filled with zeros
+        p.param_id[i] = ((int)i < latin.size()) ? latin[i] : 0;
+    }
+    return true;
+}
 
-        // Copy string into buffer, ensuring not to exceed the buffer size
-        for (unsigned int i = 0; i < sizeof(p.param_id); i++)
+void UAS::sendParameterSet(const mavlink_param_set_t &set)
+{
+    mavlink_message_t msg;
+    mavlink_msg_param_set_encode(systemId, set.target_component, &msg, &set);
+    sendMessage(msg);
+}
+
+int UAS::writeParameters(int component, const QVariantMap &values, bool onlyChanged)
+{
+    if (onlyChanged)
+    {
+        return m_parameterWriter->writeChanged(component, values);
+    }
+    int queued = 0;
+    for (QVariantMap::const_iterator it = values.constBegin(); it != values.constEnd(); ++it)
+    {
+        if (m_parameterWriter->write(component, it.key(), it.value()))
         {
-            // String characters
-            if ((int)i < paramId.length())
-            {
-                p.param_id[i] = paramId.toLatin1()[i];
-            }
-            else
-            {
-                // Fill rest with zeros
-                p.param_id[i] = 0;
-            }
+            ++queued;
         }
-        mavlink_msg_param_set_encode(systemId, compId, &msg, &p);
-        sendMessage(msg);
     }
+    return queued;
 }
 
-
-
-
-//TODO update this to use the parameter manager / param data model instead
 void UAS::processParamValueMsg(mavlink_message_t& msg, const QString& paramName, const mavlink_param_value_t& rawValue,  mavlink_param_union_t& paramValue)
 {
     int compId = msg.compid;
 
-    // Insert component if necessary
-    if (!parameters.contains(compId)) {
-        parameters.insert(compId, new QMap<QString, QVariant>());
+    if (paramName == "_HASH_CHECK") {
+        // Sent by autopilots that hash their parameter list, a match confirms the cache
+        quint32 hash = paramValue.param_uint32;
+        bool confirmed = m_parameterCacheLoaded && m_parameterCache.hasHash() && m_parameterCache.hash() == hash;
+        m_parameterCache.setHash(hash);
+        if (confirmed && m_parameterSync->isActive()) {
+            QLOG_INFO() << "Parameter hash matches the cache of system" << uasId;
+            m_parameterSync->stop();
+            foreach (int component, m_parameters.components()) {
+                emit parameterSyncProgress(uasId, component, m_parameters.count(component), m_parameters.count(component));
+                emit parameterListComplete(uasId, component, 0);
+            }
+        }
+        return;
     }
 
-    // Insert parameter into registry
-    if (parameters.value(compId)->contains(paramName)) {
-        parameters.value(compId)->remove(paramName);
+    if (!ParameterStore::isSupportedType(rawValue.param_type)) {
+        QLOG_ERROR() << "INVALID DATA TYPE USED AS PARAMETER VALUE: " << rawValue.param_type;
+        return;
     }
+    // ArduPilot sends every type as a float
+    m_parameters.setFloatEncoded(getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA);
 
-    QVariant param;
+    bool changed = false;
+    ParameterStore::Handle handle = m_parameters.insert(compId, rawValue.param_index, rawValue.param_count,
+                                                        ParameterId(rawValue.param_id), rawValue.param_type,
+                                                        paramValue.param_uint32, &changed);
+    m_parameterSync->received(compId, rawValue.param_index, rawValue.param_count);
+    m_parameterWriter->received(compId, ParameterId(rawValue.param_id), rawValue.param_type, paramValue.param_uint32);
 
-    // Insert with correct type
-    // TODO: This is a hack for MAV_AUTOPILOT_ARDUPILOTMEGA until the new version of MAVLink and a fix for their param handling.
-    switch (rawValue.param_type)
-    {
-    case MAV_PARAM_TYPE_REAL32:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<double>(paramValue.param_float));
-        }
-        else {
-            param = QVariant(paramValue.param_float);
-        }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
-        //                QLOG_DEBUG() << "RECEIVED PARAM:" << param;
+    // Verifying the cached list, only what differs is news
+    if (handle < 0 || (!changed && m_parameterCacheLoaded && m_parameterSync->isActive())) {
+        return;
     }
-        break;
-    case MAV_PARAM_TYPE_UINT8:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<uint>(paramValue.param_float));
-        }
-        else {
-            param = QVariant(QChar((unsigned char)paramValue.param_uint8));
-        }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
-        //QLOG_DEBUG() << "RECEIVED PARAM:" << param;
+    QVariant param = m_parameters.toVariant(handle);
+    emit parameterChanged(uasId, compId, paramName, param);
+    emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
+}
+
+void UAS::loadParameterCache()
+{
+    // Values that already arrived are newer than any cache
+    if (m_parameterCacheLoaded || !m_parameters.components().isEmpty()) {
+        return;
     }
-        break;
-    case MAV_PARAM_TYPE_INT8:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<int>(paramValue.param_float));
-        }
-        else  {
-            param = QVariant(QChar((char)paramValue.param_int8));
-        }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
-        //QLOG_DEBUG() << "RECEIVED PARAM:" << param;
+    m_parameters.setFloatEncoded(autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA);
+    if (!m_parameterCache.load(ParameterCache::fileName(uasId, autopilot), m_parameters)) {
+        return;
     }
-        break;
-    case MAV_PARAM_TYPE_INT16:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<int>(paramValue.param_float));
-        }
-        else {
-            param = QVariant(paramValue.param_int16);
+    m_parameterCacheLoaded = true;
+    foreach (int compId, m_parameters.components()) {
+        int count = m_parameters.count(compId);
+        for (int slot = 0; slot < m_parameters.size(compId); ++slot) {
+            ParameterStore::Handle handle = m_parameters.handle(compId, slot);
+            if (handle < 0) {
+                continue;
+            }
+            QString name = m_parameters.name(handle);
+            QVariant value = m_parameters.toVariant(handle);
+            emit parameterChanged(uasId, compId, name, value);
+            emit parameterChanged(uasId, compId, count, m_parameters.index(handle), name, value);
         }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
-        //QLOG_DEBUG() << "RECEIVED PARAM:" << param;
     }
-        break;
-    case MAV_PARAM_TYPE_UINT32:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<uint>(paramValue.param_float));
-        }
-        else {
-            param = QVariant(paramValue.param_uint32);
-        }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
+    QLOG_INFO() << "Loaded cached parameters of system" << uasId << m_parameterCache.firmware();
+    // Verify in the background, only changed values are announced again
+    requestParameters();
+}
+
+void UAS::parameterSyncFinished(int uas, int component, int missing)
+{
+    Q_UNUSED(uas);
+    Q_UNUSED(component);
+    if (missing == 0 && !m_parameterSync->isActive()) {
+        m_parameterCache.save(ParameterCache::fileName(uasId, autopilot), m_parameters);
     }
-        break;
-    case MAV_PARAM_TYPE_INT32:
-    {
-        if (getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) {
-            param = QVariant(static_cast<int>(paramValue.param_float));
-        }
-        else {
-            param = QVariant(paramValue.param_int32);
-        }
-        parameters.value(compId)->insert(paramName, param);
-        // Emit change
-        emit parameterChanged(uasId, compId, paramName, param);
-        emit parameterChanged(uasId, compId, rawValue.param_count, rawValue.param_index, paramName, param);
-        //                QLOG_DEBUG() << "RECEIVED PARAM:" << param;
+}
+
+void UAS::parameterWritesVerified(int uas, int written, int failed)
+{
+    Q_UNUSED(uas);
+    // The echoes updated the store, unless it still holds an unverified cache
+    if (written > 0 && failed == 0 && !m_parameterSync->isActive()) {
+        m_parameterCache.save(ParameterCache::fileName(uasId, autopilot), m_parameters);
     }
-        break;
-    default:
-        QLOG_ERROR() << "INVALID DATA TYPE USED AS PARAMETER VALUE: " << rawValue.param_type;
-    } //switch (value.param_type)
 }
 
 /**
@@ -2721,7 +2779,6 @@ void UAS::setUASName(const QString& name)
 
 void UAS::executeCommand(MAV_CMD command)
 {
-    mavlink_message_t msg;
     mavlink_command_long_t cmd;
     cmd.command = (uint16_t)command;
     cmd.confirmation = 0;
@@ -2734,8 +2791,7 @@ void UAS::executeCommand(MAV_CMD command)
     cmd.param7 = 0.0f;
     cmd.target_system = uasId;
     cmd.target_component = 0;
-    mavlink_msg_command_long_encode(systemId, componentId, &msg, &cmd);
-    sendMessage(msg);
+    m_commandTracker->send(cmd);
 }
 void UAS::executeCommandAck(int num, bool success)
 {
@@ -2754,7 +2810,6 @@ void UAS::executeCommand(MAV_CMD command, int confirmation, float param1, float
                 << "param4" << param4 << "param5" << param5 << "param6" << param6
                 << "param7" << param7;
 
-    mavlink_message_t msg;
     mavlink_command_long_t cmd;
     cmd.command = (uint16_t)command;
     cmd.confirmation = confirmation;
@@ -2767,8 +2822,7 @@ void UAS::executeCommand(MAV_CMD command, int confirmation, float param1, float
     cmd.param7 = param7;
     cmd.target_system = uasId;
     cmd.target_component = component;
-    mavlink_msg_command_long_encode(systemId, componentId, &msg, &cmd);
-    sendMessage(msg);
+    m_commandTracker->send(cmd);
 }
 
 /**
@@ -2777,9 +2831,7 @@ void UAS::executeCommand(MAV_CMD command, int confirmation, float param1, float
  */
 void UAS::launch()
 {
-    mavlink_message_t msg;
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, this->getUASID(), 0, MAV_CMD_NAV_TAKEOFF, 1, 0, 0, 0, 0, 0, 0, 0);
-    sendMessage(msg);
+    executeCommand(MAV_CMD_NAV_TAKEOFF, 1, 0, 0, 0, 0, 0, 0, 0, 0);
 }
 
 /**
@@ -2842,17 +2894,51 @@ void UAS::setManualControlCommands(double roll, double pitch, double yaw, double
     // If system has manual inputs enabled and is armed
     if(((base_mode & MAV_MODE_FLAG_DECODE_POSITION_MANUAL) && (base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY)) || (base_mode & MAV_MODE_FLAG_HIL_ENABLED))
     {
-        mavlink_message_t message;
-        mavlink_msg_manual_control_pack(systemId, componentId, &message, this->uasId, (float)manualPitchAngle, (float)manualRollAngle, (float)manualThrust, (float)manualYawAngle, buttons);
-        sendMessage(message);
-        //QLOG_DEBUG() << __FILE__ << __LINE__ << ": SENT MANUAL CONTROL MESSAGE: roll" << manualRollAngle << " pitch: " << manualPitchAngle << " yaw: " << manualYawAngle << " thrust: " << manualThrust;
+        // The links of the moment, the input thread samples and sends
+        QList<int> linkIds;
+        foreach (LinkInterface *link, LinkManager::instance()->getMavlinkProtocol()->fusion()->sendLinks(*links, MAVLINK_MSG_ID_MANUAL_CONTROL))
+        {
+            linkIds.append(link->getId());
+        }
+        m_manualControl->setTarget(systemId, componentId, uasId, linkIds);
+        m_manualControl->setInput(roll, pitch, yaw, thrust, buttons);
 
         emit attitudeThrustSetPointChanged(this, roll, pitch, yaw, thrust, QGC::groundTimeMilliseconds());
     }
     else
     {
         //QLOG_DEBUG() << "JOYSTICK/MANUAL CONTROL: IGNORING COMMANDS: Set mode to MANUAL to send joystick commands first";
+        m_manualControl->clearInput();
+    }
+}
+
+/**
+* The bridge sends HIL_STATE, or HIL_SENSOR and HIL_GPS if sensors, to the
+* vehicle and its HIL_CONTROLS to the simulator. There is one bridge, starting
+* it for another vehicle fails until stopHil().
+*/
+bool UAS::startHil(const QString& host, int simPort, int localPort, bool sensors)
+{
+    QHostAddress address(host);
+    if (address.isNull())
+    {
+        QLOG_WARN() << "HIL: no simulator at" << host;
+        return false;
+    }
+    MAVLinkProtocol *protocol = LinkManager::instance()->getMavlinkProtocol();
+    QList<int> linkIds;
+    foreach (LinkInterface *link, protocol->fusion()->sendLinks(*links, MAVLINK_MSG_ID_HIL_STATE))
+    {
+        linkIds.append(link->getId());
     }
+    protocol->hil()->setTarget(systemId, componentId, uasId, linkIds);
+    protocol->hil()->setOutput(sensors ? HilBridge::SensorOutput : HilBridge::StateOutput);
+    return protocol->hil()->open(address, static_cast<quint16>(simPort), static_cast<quint16>(localPort));
+}
+
+void UAS::stopHil()
+{
+    LinkManager::instance()->getMavlinkProtocol()->hil()->close();
 }
 
 void UAS::setManual6DOFControlCommands(double x, double y, double z, double roll, double pitch, double yaw)
@@ -2943,9 +3029,7 @@ void UAS::receiveButton(int buttonIndex)
 */
 void UAS::halt()
 {
-    mavlink_message_t msg;
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_ALL, MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_HOLD, MAV_GOTO_HOLD_AT_CURRENT_POSITION, 0, 0, 0, 0, 0);
-    sendMessage(msg);
+    executeCommand(MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_HOLD, MAV_GOTO_HOLD_AT_CURRENT_POSITION, 0, 0, 0, 0, 0, MAV_COMP_ID_ALL);
 }
 
 /**
@@ -2953,9 +3037,7 @@ void UAS::halt()
 */
 void UAS::go()
 {
-    mavlink_message_t msg;
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_ALL, MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_CONTINUE, MAV_GOTO_HOLD_AT_CURRENT_POSITION, 0, 0, 0, 0, 0);
-    sendMessage(msg);
+    executeCommand(MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_CONTINUE, MAV_GOTO_HOLD_AT_CURRENT_POSITION, 0, 0, 0, 0, 0, MAV_COMP_ID_ALL);
 }
 
 /** 
@@ -2963,15 +3045,12 @@ void UAS::go()
 */
 void UAS::home()
 {
-    mavlink_message_t msg;
-
     double latitude = UASManager::instance()->getHomeLatitude();
     double longitude = UASManager::instance()->getHomeLongitude();
     double altitude = UASManager::instance()->getHomeAltitude();
     int frame = UASManager::instance()->getHomeFrame();
 
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_ALL, MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_CONTINUE, MAV_GOTO_HOLD_AT_CURRENT_POSITION, frame, 0, latitude, longitude, altitude);
-    sendMessage(msg);
+    executeCommand(MAV_CMD_OVERRIDE_GOTO, 1, MAV_GOTO_DO_CONTINUE, MAV_GOTO_HOLD_AT_CURRENT_POSITION, frame, 0, latitude, longitude, altitude, MAV_COMP_ID_ALL);
 }
 
 /**
@@ -2979,10 +3058,7 @@ void UAS::home()
 */
 void UAS::land()
 {
-    mavlink_message_t msg;
-
-    mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_ALL, MAV_CMD_NAV_LAND, 1, 0, 0, 0, 0, 0, 0, 0);
-    sendMessage(msg);
+    executeCommand(MAV_CMD_NAV_LAND, 1, 0, 0, 0, 0, 0, 0, 0, MAV_COMP_ID_ALL);
 }
 
 /**
@@ -3046,6 +3122,7 @@ bool UAS::emergencyKILL()
 
 void UAS::reboot()
 {
+    // Not tracked, a resend could reach the rebooted autopilot and reboot it again
     mavlink_message_t msg;
     mavlink_msg_command_long_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_ALL, MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN, 1, 1, 1, 0, 0, 0, 0, 0);
     sendMessage(msg);
@@ -3230,6 +3307,43 @@ const QString& UAS::getShortMode() const
     return shortModeText;
 }
 
+void UAS::registerComponent(uint8_t compid)
+{
+    m_componentBits[compid >> 5] |= 1u << (compid & 31);
+    if (components.contains(compid))
+    {
+        return;
+    }
+    QString componentName;
+
+    switch (compid)
+    {
+    case MAV_COMP_ID_ALL:
+    {
+        componentName = "ANONYMOUS";
+        break;
+    }
+    case MAV_COMP_ID_IMU:
+    {
+        componentName = "IMU #1";
+        break;
+    }
+    case MAV_COMP_ID_CAMERA:
+    {
+        componentName = "CAMERA";
+        break;
+    }
+    case MAV_COMP_ID_MISSIONPLANNER:
+    {
+        componentName = "MISSIONPLANNER";
+        break;
+    }
+    }
+
+    components.insert(compid, componentName);
+    emit componentCreated(uasId, compid, componentName);
+}
+
 /**
 * Add the link and connect a signal to it which will be set off when it is destroyed.
 */
@@ -3238,6 +3352,15 @@ void UAS::addLink(LinkInterface* link)
     if (!links->contains(link))
     {
         links->append(link);
+        int id = link->getId();
+        if (id >= 0)
+        {
+            if (id >= m_linkIds.size())
+            {
+                m_linkIds.resize(qMax(id + 1, m_linkIds.size() * 2));
+            }
+            m_linkIds.setBit(id);
+        }
         connect(link, SIGNAL(destroyed(QObject*)), this, SLOT(removeLink(QObject*)));
         connect(link,SIGNAL(disconnected()),this,SIGNAL(disconnected()));
         connect(link,SIGNAL(connected()),this,SIGNAL(connected()));
@@ -3257,6 +3380,13 @@ void UAS::removeLink(QObject* object)
         }
 
     }
+    // The link is being destroyed and cannot report its ID, rebuild from the ones left
+    m_linkIds.fill(false);
+    for (int i=0;i<links->size();i++)
+    {
+        int id = links->at(i)->getId();
+        if (id >= 0 && id < m_linkIds.size()) m_linkIds.setBit(id);
+    }
     disconnect(object,SIGNAL(disconnected()),this,SIGNAL(disconnected()));
     disconnect(object,SIGNAL(connected()),this,SIGNAL(connected()));
     if (links->size() == 0)
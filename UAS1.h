@@ -35,7 +35,21 @@ This file is part of the QGROUNDCONTROL project
 #include "UASInterface1.h"
 #include "MAVLinkProtocol1.h"
 #include <QVector3D>
+#include <QBitArray>
 #include "QGCMAVLink.h"
+#include "TelemetryChannels.h"
+#include "ParameterSync.h"
+#include "ParameterWriter.h"
+#include "MissionSync.h"
+#include "CommandTracker.h"
+#include "ImageTransfer.h"
+#include "LogDownload.h"
+#include "ManualControl.h"
+#include "StreamRateTuner.h"
+#include "ParameterCache.h"
+#include "TimerWheel.h"
+#include "AttitudeMatrix.h"
+#include "StringPool.h"
 
 /**
  * @brief A generic MAVLINK-connected MAV/UAV
@@ -83,6 +97,10 @@ public:
 
     /** @brief The time interval the robot is switched on */
     quint64 getUptime() const;
+    /** @brief Latest raw remote control channels */
+    const RadioChannels& getRemoteControlChannels() const { return m_rcChannels; }
+    /** @brief Satellites of the last GPS_STATUS */
+    const GpsSatellites& getGpsSatellites() const { return m_gpsSatellites; }
     /** @brief Get the status flag for the communication */
     int getCommunicationStatus() const;
     /** @brief Add one measurement and get low-passed voltage */
@@ -112,8 +130,8 @@ public:
     void setGroundSpeed(double val)
     {
         groundSpeed = val;
-        emit groundSpeedChanged(val,"groundSpeed");
-        emit valueChanged(this->uasId,"groundSpeed","m/s",QVariant(val),getUnixTime());
+        emit groundSpeedChanged(val,INTERNED("groundSpeed"));
+        emit valueChanged(this->uasId,INTERNED("groundSpeed"),INTERNED("m/s"),QVariant(val),getUnixTime());
     }
     double getGroundSpeed() const
     {
@@ -123,8 +141,8 @@ public:
     void setAirSpeed(double val)
     {
         airSpeed = val;
-        emit airSpeedChanged(val,"airSpeed");
-        emit valueChanged(this->uasId,"airSpeed","m/s",QVariant(val),getUnixTime());
+        emit airSpeedChanged(val,INTERNED("airSpeed"));
+        emit valueChanged(this->uasId,INTERNED("airSpeed"),INTERNED("m/s"),QVariant(val),getUnixTime());
     }
 
     double getAirSpeed() const
@@ -135,8 +153,8 @@ public:
     void setLocalX(double val)
     {
         localX = val;
-        emit localXChanged(val,"localX");
-        emit valueChanged(this->uasId,"localX","m",QVariant(val),getUnixTime());
+        emit localXChanged(val,INTERNED("localX"));
+        emit valueChanged(this->uasId,INTERNED("localX"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     double getLocalX() const
@@ -147,8 +165,8 @@ public:
     void setLocalY(double val)
     {
         localY = val;
-        emit localYChanged(val,"localY");
-        emit valueChanged(this->uasId,"localY","m",QVariant(val),getUnixTime());
+        emit localYChanged(val,INTERNED("localY"));
+        emit valueChanged(this->uasId,INTERNED("localY"),INTERNED("m"),QVariant(val),getUnixTime());
     }
     double getLocalY() const
     {
@@ -158,8 +176,8 @@ public:
     void setLocalZ(double val)
     {
         localZ = val;
-        emit localZChanged(val,"localZ");
-        emit valueChanged(this->uasId,"localZ","m",QVariant(val),getUnixTime());
+        emit localZChanged(val,INTERNED("localZ"));
+        emit valueChanged(this->uasId,INTERNED("localZ"),INTERNED("m"),QVariant(val),getUnixTime());
     }
     double getLocalZ() const
     {
@@ -169,8 +187,8 @@ public:
     void setLatitude(double val)
     {
         latitude = val;
-        emit latitudeChanged(val,"latitude");
-        emit valueChanged(this->uasId,"latitude","deg",QVariant(val),getUnixTime());
+        emit latitudeChanged(val,INTERNED("latitude"));
+        emit valueChanged(this->uasId,INTERNED("latitude"),INTERNED("deg"),QVariant(val),getUnixTime());
     }
 
     double getLatitude() const
@@ -181,8 +199,8 @@ public:
     void setLongitude(double val)
     {
         longitude = val;
-        emit longitudeChanged(val,"longitude");
-        emit valueChanged(this->uasId,"longitude","deg",QVariant(val),getUnixTime());
+        emit longitudeChanged(val,INTERNED("longitude"));
+        emit valueChanged(this->uasId,INTERNED("longitude"),INTERNED("deg"),QVariant(val),getUnixTime());
     }
 
     double getLongitude() const
@@ -193,8 +211,8 @@ public:
     void setAltitudeAMSL(double val)
     {
         altitudeAMSL = val;
-        emit altitudeAMSLChanged(val, "altitudeAMSL");
-        emit valueChanged(this->uasId,"altitudeAMSL","m",QVariant(val),getUnixTime());
+        emit altitudeAMSLChanged(val,INTERNED("altitudeAMSL"));
+        emit valueChanged(this->uasId,INTERNED("altitudeAMSL"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     double getAltitudeAMSL() const
@@ -205,8 +223,8 @@ public:
     void setAltitudeRelative(double val)
     {
         altitudeRelative = val;
-        emit altitudeRelativeChanged(val, "altitudeRelative");
-        emit valueChanged(this->uasId,"altitudeRelative","m",QVariant(val),getUnixTime());
+        emit altitudeRelativeChanged(val,INTERNED("altitudeRelative"));
+        emit valueChanged(this->uasId,INTERNED("altitudeRelative"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     double getAltitudeRelative() const
@@ -217,8 +235,8 @@ public:
     void setSatelliteCount(double val)
     {
         m_satelliteCount = val;
-        emit satelliteCountChanged(val,"satelliteCount");
-        emit valueChanged(this->uasId,"satelliteCount","m",QVariant(val),getUnixTime());
+        emit satelliteCountChanged(val,INTERNED("satelliteCount"));
+        emit valueChanged(this->uasId,INTERNED("satelliteCount"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     int getSatelliteCount() const
@@ -229,8 +247,8 @@ public:
     void setGpsHdop(double val)
     {
         m_gps_hdop = val;
-        emit gpsHdopChanged(val,"GPS HDOP");
-        emit valueChanged(this->uasId,"GPS HDOP","m",QVariant(val),getUnixTime());
+        emit gpsHdopChanged(val,INTERNED("GPS HDOP"));
+        emit valueChanged(this->uasId,INTERNED("GPS HDOP"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     double getGpsHdop() const
@@ -241,8 +259,8 @@ public:
     void setGpsFix(int val)
     {
         m_gps_fix = val;
-        emit gpsFixChanged(val,"GPS FIX");
-        emit valueChanged(this->uasId,"GPS FIX","",QVariant(val),getUnixTime());
+        emit gpsFixChanged(val,INTERNED("GPS FIX"));
+        emit valueChanged(this->uasId,INTERNED("GPS FIX"),INTERNED(""),QVariant(val),getUnixTime());
     }
 
     double getGpsFix() const
@@ -277,8 +295,8 @@ public:
     void setDistToWaypoint(double val)
     {
         distToWaypoint = val;
-        emit distToWaypointChanged(val,"distToWaypoint");
-        emit valueChanged(this->uasId,"distToWaypoint","m",QVariant(val),getUnixTime());
+        emit distToWaypointChanged(val,INTERNED("distToWaypoint"));
+        emit valueChanged(this->uasId,INTERNED("distToWaypoint"),INTERNED("m"),QVariant(val),getUnixTime());
     }
 
     double getDistToWaypoint() const
@@ -289,8 +307,8 @@ public:
     void setBearingToWaypoint(double val)
     {
         bearingToWaypoint = val;
-        emit bearingToWaypointChanged(val,"bearingToWaypoint");
-        emit valueChanged(this->uasId,"bearingToWaypoint","deg",QVariant(val),getUnixTime());
+        emit bearingToWaypointChanged(val,INTERNED("bearingToWaypoint"));
+        emit valueChanged(this->uasId,INTERNED("bearingToWaypoint"),INTERNED("deg"),QVariant(val),getUnixTime());
     }
 
     double getBearingToWaypoint() const
@@ -302,7 +320,7 @@ public:
     void setRoll(double val)
     {
         roll = val;
-        emit rollChanged(val,"roll");
+        emit rollChanged(val,INTERNED("roll"));
     }
 
     double getRoll() const
@@ -313,7 +331,7 @@ public:
     void setPitch(double val)
     {
         pitch = val;
-        emit pitchChanged(val,"pitch");
+        emit pitchChanged(val,INTERNED("pitch"));
     }
 
     double getPitch() const
@@ -324,7 +342,7 @@ public:
     void setYaw(double val)
     {
         yaw = val;
-        emit yawChanged(val,"yaw");
+        emit yawChanged(val,INTERNED("yaw"));
     }
 
     double getYaw() const
@@ -332,6 +350,12 @@ public:
         return yaw;
     }
 
+    /** @brief The attitude as received, a quaternion also when it came as Euler angles */
+    const AttitudeQuaternion &getAttitudeQuaternion() const
+    {
+        return attitudeQuaternion;
+    }
+
     bool getSelected() const;
     QVector3D getNedPosGlobalOffset() const
     {
@@ -404,17 +428,33 @@ public:
 
 protected: //COMMENTS FOR TEST UNIT
     bool m_heartbeatsEnabled;
+    /// TELEMETRY CHANNELS
+    TelemetryChannels *m_telemetry;
+    int m_firstChannel;           ///< Id of the first uasChannels entry, the table keeps its order
+    void publish(int channel, double value, quint64 time) { m_telemetry->post(uasId, m_firstChannel + channel, value, time); }
     /// LINK ID AND STATUS
     int uasId;                    ///< Unique system ID
     QMap<int, QString> components;///< IDs and names of all detected onboard components
     QList<LinkInterface*>* links; ///< List of links this UAS can be reached by
+    QBitArray m_linkIds;          ///< Bit per LinkInterface::getId() in links, tested for every frame
+    quint32 m_componentBits[8];   ///< Bit per component ID in components
+    /** @brief Whether link delivered before, two bit tests */
+    bool knowsLink(LinkInterface *link) const
+    {
+        int id = link->getId();
+        return id >= 0 && id < m_linkIds.size() && m_linkIds.testBit(id);
+    }
+    bool knowsComponent(uint8_t compid) const { return m_componentBits[compid >> 5] & (1u << (compid & 31)); }
+    /** @brief Name a component seen for the first time and announce it */
+    void registerComponent(uint8_t compid);
     QList<int> unknownPackets;    ///< Packet IDs which are unknown and have been received
     //MAVLinkProtocol* mavlink;     ///< Reference to the MAVLink instance
     CommStatus commStatus;        ///< Communication status
     double receiveDropRate;        ///< Percentage of packets that were dropped on the MAV's receiving link (from GCS and other MAVs)
     double sendDropRate;           ///< Percentage of packets that were not received from the MAV by the GCS
     quint64 lastHeartbeat;        ///< Time of the last heartbeat message
-    QTimer* statusTimeout;        ///< Timer for various status timeouts
+    TimerWheel::TimerId statusTimeout;    ///< Timer for various status timeouts
+    TimerWheel::TimerId heartbeatTimer;   ///< Timer sending the GCS heartbeat
 
     /// BASIC UAS TYPE, NAME AND STATE
     QString name;                 ///< Human-friendly name of the vehicle, e.g. bravo
@@ -424,6 +464,7 @@ protected: //COMMENTS FOR TEST UNIT
     bool systemIsArmed;           ///< If the system is armed
     uint8_t base_mode;                 ///< The current mode of the MAV
     uint32_t custom_mode;         ///< The current mode of the MAV
+    QString navModeText;          ///< getCustomModeText() last sent with navModeChanged()
     int status;                   ///< The current status of the MAV
     QString shortModeText;        ///< Short textual mode description
     QString shortStateText;       ///< Short textual state description
@@ -475,6 +516,7 @@ protected: //COMMENTS FOR TEST UNIT
     double manualPitchAngle;    ///< Pitch angle set by human pilot (radians)
     double manualYawAngle;      ///< Yaw angle set by human pilot (radians)
     double manualThrust;        ///< Thrust set by human pilot (radians)
+    ManualControl* m_manualControl; ///< Samples and sends the manual inputs off the UI thread
 
     /// POSITION
     bool positionLock;          ///< Status if position information is available or not
@@ -517,20 +559,11 @@ protected: //COMMENTS FOR TEST UNIT
     double roll;
     double pitch;
     double yaw;
+    AttitudeQuaternion attitudeQuaternion;
 
-    // dongfang: This looks like a candidate for being moved off to a separate class.
     /// IMAGING
-    int imageSize;              ///< Image size being transmitted (bytes)
-    int imagePackets;           ///< Number of data packets being sent for this image
-    int imagePacketsArrived;    ///< Number of data packets recieved
-    int imagePayload;           ///< Payload size per transmitted packet (bytes). Standard is 254, and decreases when image resolution increases.
-    int imageQuality;           ///< Quality of the transmitted image (percentage)
-    int imageType;              ///< Type of the transmitted image (BMP, PNG, JPEG, RAW 8 bit, RAW 32 bit)
-    int imageWidth;             ///< Width of the image stream
-    int imageHeight;            ///< Width of the image stream
-    QByteArray imageRecBuffer;  ///< Buffer for the incoming bytestream
-    QImage image;               ///< Image data of last completely transmitted image
-    quint64 imageStart;
+    ImageTransfer* m_imageTransfer; ///< Still image downlink
+    LogDownload* m_logDownload;     ///< Onboard log download
     bool blockHomePositionChanges;   ///< Block changes to the home position
     bool receivedMode;          ///< True if mode was retrieved from current conenction to UAS
 
@@ -557,9 +590,18 @@ protected: //COMMENTS FOR TEST UNIT
 #endif
 
     /// PARAMETERS
-    QMap<int, QMap<QString, QVariant>* > parameters; ///< All parameters
+    ParameterStore m_parameters;    ///< All parameters, shared with the param manager
     bool paramsOnceRequested;       ///< If the parameter list has been read at least once
     QGCUASParamManager* paramManager; ///< Parameter manager class
+    ParameterSync* m_parameterSync; ///< Parameter list download
+    ParameterWriter* m_parameterWriter; ///< Batched PARAM_SETs and their echoes
+    CommandTracker* m_commandTracker; ///< COMMAND_LONGs waiting for their ACK
+    MissionSync* m_missionSync;     ///< Mission download and upload
+    StreamRateTuner* m_streamRates; ///< REQUEST_DATA_STREAM rates for the link
+    ParameterCache m_parameterCache; ///< What the last connection downloaded, updated as values arrive
+    bool m_parameterCacheLoaded;    ///< m_parameters was filled from the cache, the download verifies it
+    RadioChannels m_rcChannels;     ///< RC_CHANNELS_RAW and _SCALED values, min and max while calibrating
+    GpsSatellites m_gpsSatellites;  ///< GPS_STATUS satellites
 
 public:
     void setHeartbeatEnabled(bool enabled) { m_heartbeatsEnabled = enabled; }
@@ -600,6 +642,31 @@ public:
     void setParamManager(QGCUASParamManager* manager) {
         paramManager = manager;
     }
+    const ParameterStore& getParameterStore() const {
+        return m_parameters;
+    }
+    /** @brief Mission transfers, see MissionSync */
+    MissionSync* getMissionSync() const {
+        return m_missionSync;
+    }
+    /** @brief Data stream rates, see StreamRateTuner */
+    StreamRateTuner* getStreamRateTuner() const {
+        return m_streamRates;
+    }
+    /** @brief Batched parameter writes, see ParameterWriter */
+    ParameterWriter* getParameterWriter() const {
+        return m_parameterWriter;
+    }
+    /** @brief Fill a PARAM_SET for paramId, false if value has no parameter type */
+    bool encodeParameter(const int compId, const QString& paramId, const QVariant& value, mavlink_param_set_t *set) const;
+    /** @brief Commands in flight and their round trips, see CommandTracker */
+    CommandTracker* getCommandTracker() const {
+        return m_commandTracker;
+    }
+    /** @brief Onboard log download, see LogDownload */
+    LogDownload* getLogDownload() const {
+        return m_logDownload;
+    }
     int getSystemType();
 
     /**
@@ -696,6 +763,7 @@ public:
         }
     }
 
+    /** @brief The last image received, see ImageTransfer */
     QImage getImage();
     void requestImage();
     int getAutopilotType(){
@@ -848,7 +916,7 @@ public slots:
      */
     void toggleAutonomy();
 
-    /** @brief Set the values for the manual control of the vehicle */
+    /** @brief Set the values for the manual control of the vehicle, sent at ManualControl::RateHz until the mode leaves manual */
     void setManualControlCommands(double roll, double pitch, double yaw, double thrust, int xHat, int yHat, int buttons);
     /** @brief Receive a button pressed event from an input device, e.g. joystick */
     void receiveButton(int buttonIndex);
@@ -856,6 +924,10 @@ public slots:
     /** @brief Set the values for the 6dof manual control of the vehicle */
     void setManual6DOFControlCommands(double x, double y, double z, double roll, double pitch, double yaw);
 
+    /** @brief Bridge the vehicle to a simulator at host:simPort off the UI thread, see HilBridge */
+    bool startHil(const QString& host, int simPort, int localPort, bool sensors);
+    void stopHil();
+
     /** @brief Add a link associated with this robot */
     void addLink(LinkInterface* link);
     /** @brief Remove a link associated with this robot */
@@ -863,6 +935,8 @@ public slots:
 
     /** @brief Receive a message from one of the communication links. */
     void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    /** @brief Subclasses add their own message ids after calling this */
+    virtual void subscribe(MAVLinkDispatcher *dispatcher, const int *msgids = 0);
 
 #ifdef QGC_PROTOBUF_ENABLED
     /** @brief Receive a message from one of the communication links. */
@@ -889,8 +963,24 @@ public slots:
     /** @brief Set current mode of operation, e.g. auto or manual, does not check the arming status, for anything else than arming/disarming operations use setMode instead */
     void setModeArm(uint8_t newBaseMode, uint32_t newCustomMode);
 
-    /** @brief Request all parameters */
+    /** @brief Request all parameters, missing ones are fetched until the list is complete */
     void requestParameters();
+    /** @brief Send a single PARAM_REQUEST_LIST, see ParameterSync */
+    void requestParameterList();
+
+    /** @brief Send DATA_TRANSMISSION_HANDSHAKE asking for an image, see ImageTransfer */
+    void sendImageRequest(int type, int quality);
+
+    /** @brief Send MISSION_REQUEST_LIST, see MissionSync */
+    void requestMissionList();
+    /** @brief Send MISSION_REQUEST for one item */
+    void requestMissionItem(int seq);
+    /** @brief Send MISSION_COUNT, starting an upload */
+    void sendMissionCount(int count);
+    /** @brief Send one MISSION_ITEM, addressed to this system */
+    void sendMissionItem(const mavlink_mission_item_t &item);
+    /** @brief Send MISSION_ACK with a MAV_MISSION_RESULT */
+    void sendMissionAck(int type);
 
     /** @brief Request a single parameter by name */
     void requestParameter(int component, const QString& parameter);
@@ -899,6 +989,14 @@ public slots:
 
     /** @brief Set a system parameter */
     void setParameter(const int compId, const QString& paramId, const QVariant& value);
+    /**
+     * @brief Queue writes of many parameters, each verified by its echo, see ParameterWriter
+     * @param onlyChanged skip values the parameter store already holds
+     * @return Writes queued
+     */
+    int writeParameters(int component, const QVariantMap &values, bool onlyChanged);
+    /** @brief Send one PARAM_SET */
+    void sendParameterSet(const mavlink_param_set_t &set);
 
     /** @brief Write parameters to permanent storage */
     void writeParametersToStorage();
@@ -945,7 +1043,7 @@ public slots:
     void stopDataRecording();
     void deleteSettings();
 	
-    // Log Download
+    // Log Download, see LogDownload
     void logRequestList(uint16_t start, uint16_t end);
     void logRequestData(uint16_t id, uint32_t ofs, uint32_t count);
     void logEraseAll();
@@ -1023,6 +1121,16 @@ protected slots:
     void writeSettings();
     /** @brief Read settings from disk */
     void readSettings();
+    /** @brief Save the parameter cache once a download completed */
+    void parameterSyncFinished(int uas, int component, int missing);
+    /** @brief Save the cache once written parameters are verified */
+    void parameterWritesVerified(int uas, int written, int failed);
+    /** @brief Forward a decoded image */
+    void imageTransferReady();
+
+protected:
+    /** @brief Fill the parameters from the last connection and verify them in the background */
+    void loadParameterCache();
 };
 
 
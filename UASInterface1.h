@@ -42,7 +42,10 @@ This file is part of the QGROUNDCONTROL project
 #include "ProtocolInterface.h"
 #include "QGCMAVLink.h"
 #include "QGCUASParamManager.h"
+#include "ParameterStore.h"
+#include "GpsSatellites.h"
 #include "RadioCalibration/RadioCalibrationData.h"
+#include "RadioCalibration/RadioChannels.h"
 
 #ifdef QGC_PROTOBUF_ENABLED
 #include <tr1/memory>
@@ -93,6 +96,8 @@ enum AltitudeMeasurementFrame
  * This interface is abstract and thus cannot be instantiated. It serves only as type definition.
  * It represents an unmanned aerial vehicle, e.g. a micro air vehicle.
  **/
+class MAVLinkDispatcher;
+
 class UASInterface : public QObject
 {
     Q_OBJECT
@@ -126,6 +131,10 @@ public:
     virtual int getUASID() const = 0; ///< Get the ID of the connected UAS
     /** @brief The time interval the robot is switched on **/
     virtual quint64 getUptime() const = 0;
+    /** @brief Latest raw remote control channels, see remoteControlChannelsChanged() **/
+    virtual const RadioChannels& getRemoteControlChannels() const = 0;
+    /** @brief Satellites of the last GPS_STATUS, see gpsSatellitesChanged() **/
+    virtual const GpsSatellites& getGpsSatellites() const = 0;
     /** @brief Get the status flag for the communication **/
     virtual int getCommunicationStatus() const = 0;
 
@@ -169,6 +178,8 @@ public:
     // TODO Will be removed
     /** @brief Set reference to the param manager **/
     virtual void setParamManager(QGCUASParamManager* manager) = 0;
+    /** @brief All parameters received from the MAV */
+    virtual const ParameterStore& getParameterStore() const = 0;
 
     /* COMMUNICATION FLAGS */
 
@@ -424,6 +435,12 @@ public slots:
 
     /** @brief Receive a message from one of the communication links. */
     virtual void receiveMessage(LinkInterface* link, mavlink_message_t message) = 0;
+    /**
+     * @brief Register this vehicle's message handlers with the dispatcher.
+     * msgids is a -1 terminated list to restrict receiveMessage() to, 0 for all
+     * messages; autopilot specific handlers are only registered for all.
+     */
+    virtual void subscribe(MAVLinkDispatcher *dispatcher, const int *msgids = 0) = 0;
 
     virtual int getSystemId()=0;
     virtual int getComponentId()=0;
@@ -536,6 +553,20 @@ signals:
     void autoModeChanged(bool autoMode);
     void parameterChanged(int uas, int component, QString parameterName, QVariant value);
     void parameterChanged(int uas, int component, int parameterCount, int parameterId, QString parameterName, QVariant value);
+    /** @brief Download progress of the parameter list of component */
+    void parameterSyncProgress(int uas, int component, int received, int count);
+    /** @brief The parameter list of component is downloaded, missing could not be fetched */
+    void parameterListComplete(int uas, int component, int missing);
+    /** @brief Parameter writes verified or given up so far, see UAS::writeParameters */
+    void parameterWriteProgress(int uas, int done, int count);
+    /** @brief All queued parameter writes ended, failed were not confirmed by their echo */
+    void parameterWriteFinished(int uas, int written, int failed);
+    /** @brief Items moved so far by the mission transfer in progress */
+    void missionTransferProgress(int uas, int transferred, int count);
+    /** @brief A mission transfer ended, result is a MAV_MISSION_RESULT or -1 on timeout */
+    void missionTransferFinished(int uas, bool upload, int result);
+    /** @brief A COMMAND_LONG ended, result is a MAV_RESULT or -1 when it was never acknowledged */
+    void commandFinished(int uas, int component, int command, int result, int attempts, int rttMs);
     void patternDetected(int uasId, QString patternPath, float confidence, bool detected);
     void letterDetected(int uasId, QString letter, float confidence, bool detected);
     /**
@@ -563,8 +594,8 @@ signals:
     void localPositionChanged(UASInterface*, int component, double x, double y, double z, quint64 usec);
     void globalPositionChanged(UASInterface*, double lat, double lon, double alt, quint64 usec);
     void altitudeChanged(UASInterface*, double altitudeAMSL, double altitudeRelative, double climbRate, quint64 usec);
-    /** @brief Update the status of one satellite used for localization */
-    void gpsSatelliteStatusChanged(int uasid, int satid, float azimuth, float direction, float snr, bool used);
+    /** @brief GPS_STATUS received, bit n of the mask set if satellite slot n changed */
+    void gpsSatellitesChanged(int uasid, quint32 changedSatellites);
 
     // The horizontal speed (a scalar)
     void speedChanged(UASInterface* uas, double groundSpeed, double airSpeed, quint64 usec);
@@ -610,10 +641,10 @@ signals:
     void groundTruthSensorStatusChanged(bool supported, bool enabled, bool ok);
 
 
-    /** @brief Value of a remote control channel (raw) */
-    void remoteControlChannelRawChanged(int channelId, float raw);
-    /** @brief Value of a remote control channel (scaled)*/
-    void remoteControlChannelScaledChanged(int channelId, float normalized);
+    /** @brief Raw remote control channels changed, bit n of the mask set for channel n */
+    void remoteControlChannelsChanged(quint32 changedChannels);
+    /** @brief Scaled remote control channels changed, bit n of the mask set for channel n */
+    void remoteControlChannelsScaledChanged(quint32 changedChannels);
     /** @brief Remote control RSSI changed */
     void remoteControlRSSIChanged(float rssi);
     /** @brief Radio Calibration Data has been received from the MAV*/
@@ -676,6 +707,8 @@ signals:
     void scaledImuMessageUpdate(UASInterface *uas, mavlink_scaled_imu_t scaledImu);
     /** @brief RAW IMU message used for calculating offsets etc */
     void scaledImu2MessageUpdate(UASInterface *uas, mavlink_scaled_imu2_t scaledImu2);
+    /** @brief HIGHRES IMU message, SI units, used for the vibration analysis */
+    void highresImuMessageUpdate(UASInterface *uas, mavlink_highres_imu_t highresImu);
     /** @brief Sensor Offset update message*/
     void sensorOffsetsMessageUpdate(UASInterface *uas, mavlink_sensor_offsets_t sensorOffsets);
     /** @brief Radio Status update message*/
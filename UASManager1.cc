@@ -12,16 +12,25 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QTimer>
-#include <QSettings>
+#include "SettingsStore.h"
+#include <cstring>
 #include "UAS1.h"
 #include "UASInterface1.h"
 #include "UASManager1.h"
+#include "GAudioOutput.h"
 #include "QGC.h"
+#include "QsLog.h"
 
 #define PI 3.1415926535897932384626433832795
 #define MEAN_EARTH_DIAMETER	12756274.0
 #define UMR	0.017453292519943295769236907684886
 
+static const double defaultSeparationHorizontal = 30.0;
+static const double defaultSeparationVertical = 10.0;
+// A conflict clears only this much farther out than it started, so a pair
+// flying along the limit is not announced over and over
+static const double separationHysteresis = 1.2;
+
 UASManager* UASManager::instance()
 {
     static UASManager* _instance = 0;
@@ -37,19 +46,19 @@ UASManager* UASManager::instance()
 
 void UASManager::storeSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup("QGC_UASMANAGER");
     settings.setValue("HOMELAT", homeLat);
     settings.setValue("HOMELON", homeLon);
     settings.setValue("HOMEALT", homeAlt);
+    settings.setValue("SEPARATION_H", separationHorizontal);
+    settings.setValue("SEPARATION_V", separationVertical);
     settings.endGroup();
-    settings.sync();
 }
 
 void UASManager::loadSettings()
 {
-    QSettings settings;
-    settings.sync();
+    StoredSettings settings;
     settings.beginGroup("QGC_UASMANAGER");
     bool changed =  setHomePosition(settings.value("HOMELAT", homeLat).toDouble(),
                                     settings.value("HOMELON", homeLon).toDouble(),
@@ -62,6 +71,9 @@ void UASManager::loadSettings()
         emit homePositionChanged(homeLat, homeLon, homeAlt);
     }
 
+    setSeparationMinimum(settings.value("SEPARATION_H", separationHorizontal).toDouble(),
+                         settings.value("SEPARATION_V", separationVertical).toDouble());
+
     settings.endGroup();
 }
 
@@ -87,6 +99,8 @@ bool UASManager::setHomePosition(double lat, double lon, double alt)
             homeLat = lat;
             homeLon = lon;
             homeAlt = alt;
+            // Positions were relative to the old home, they come back with the next updates
+            proximity.clear();
 
             emit homePositionChanged(homeLat, homeLon, homeAlt);
 
@@ -141,8 +155,12 @@ void UASManager::initReference(const double & latitude, const double & longitude
     R(2, 2) = s_lat;
 
     ecef_ref_orientation_ = Eigen::Quaterniond(R);
+    ecef_ref_rotation_ = R;
 
     ecef_ref_point_ = wgs84ToEcef(latitude, longitude, altitude);
+
+    enu_lat_scale_ = 360. / PI / MEAN_EARTH_DIAMETER;
+    enu_lon_scale_ = enu_lat_scale_ / cos(latitude * UMR);
 }
 
 Eigen::Vector3d UASManager::wgs84ToEcef(const double & latitude, const double & longitude, const double & altitude)
@@ -200,6 +218,62 @@ void UASManager::nedToWgs84(const double& x, const double& y, const double& z, d
     *alt=homeAlt-z;
 }
 
+// Positions per block, small enough for the temporaries to live on the stack
+static const int GeoBlock = 64;
+typedef Eigen::Array<double, GeoBlock, 1> GeoArray;
+typedef Eigen::Map<const Eigen::ArrayXd> ConstGeoMap;
+typedef Eigen::Map<Eigen::ArrayXd> GeoMap;
+
+void UASManager::wgs84ToEnu(const double *lat, const double *lon, const double *alt, int count,
+                            double *east, double *north, double *up) const
+{
+    const double a = 6378137.0; // semi-major axis
+    const double e_sq = 6.69437999014e-3; // first eccentricity squared
+
+    for (int start = 0; start < count; start += GeoBlock)
+    {
+        const int n = qMin(static_cast<int>(GeoBlock), count - start);
+        // A short last block is padded with the equator, the padding is never written out
+        GeoArray s_lat = GeoArray::Zero(), c_lat = GeoArray::Ones();
+        GeoArray s_long = GeoArray::Zero(), c_long = GeoArray::Ones();
+        GeoArray h = GeoArray::Zero();
+        for (int i = 0; i < n; ++i)
+        {
+            sincos(lat[start + i] * DEG2RAD, &s_lat[i], &c_lat[i]);
+            sincos(lon[start + i] * DEG2RAD, &s_long[i], &c_long[i]);
+        }
+        h.head(n) = ConstGeoMap(alt + start, n);
+
+        const GeoArray N = a * (1.0 - e_sq * s_lat.square()).sqrt().inverse();
+        Eigen::Matrix<double, 3, GeoBlock> ecef;
+        ecef.row(0) = ((N + h) * c_lat * c_long).matrix().transpose();
+        ecef.row(1) = ((N + h) * c_lat * s_long).matrix().transpose();
+        ecef.row(2) = ((N * (1 - e_sq) + h) * s_lat).matrix().transpose();
+        ecef.colwise() -= ecef_ref_point_;
+
+        const Eigen::Matrix<double, 3, GeoBlock> enu = ecef_ref_rotation_ * ecef;
+        GeoMap(east + start, n) = enu.row(0).head(n).transpose().array();
+        GeoMap(north + start, n) = enu.row(1).head(n).transpose().array();
+        GeoMap(up + start, n) = enu.row(2).head(n).transpose().array();
+    }
+}
+
+void UASManager::enuToWgs84(const double *x, const double *y, const double *z, int count,
+                            double *lat, double *lon, double *alt) const
+{
+    GeoMap(lat, count) = homeLat + ConstGeoMap(y, count) * enu_lat_scale_;
+    GeoMap(lon, count) = homeLon + ConstGeoMap(x, count) * enu_lon_scale_;
+    GeoMap(alt, count) = homeAlt + ConstGeoMap(z, count);
+}
+
+void UASManager::nedToWgs84(const double *x, const double *y, const double *z, int count,
+                            double *lat, double *lon, double *alt) const
+{
+    GeoMap(lat, count) = homeLat + ConstGeoMap(x, count) * enu_lat_scale_;
+    GeoMap(lon, count) = homeLon + ConstGeoMap(y, count) * enu_lon_scale_;
+    GeoMap(alt, count) = homeAlt - ConstGeoMap(z, count);
+}
+
 
 /**
  * This function will change QGC's home position on a number of conditions only
@@ -235,8 +309,14 @@ UASManager::UASManager() :
         homeLat(32.835354),
         homeLon(-117.162774),
         homeAlt(25.0),
-        homeFrame(MAV_FRAME_GLOBAL)
+        homeFrame(MAV_FRAME_GLOBAL),
+        proximity(defaultSeparationHorizontal * separationHysteresis),
+        separationHorizontal(defaultSeparationHorizontal),
+        separationVertical(defaultSeparationVertical)
 {
+    memset(systemsById, 0, sizeof(systemsById));
+    // Valid references even if the stored home position is rejected
+    initReference(homeLat, homeLon, homeAlt);
     loadSettings();
     setLocalNEDSafetyBorders(1, -1, 0, -1, 1, -1);
 }
@@ -268,11 +348,17 @@ void UASManager::addUAS(UASInterface* uas)
     if (!systems.contains(uas))
     {
         systems.append(uas);
+        int id = uas->getUASID();
+        if (id >= 0 && id < 256) {
+            systemsById[id] = uas;
+        }
         connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeUAS(QObject*)));
         // Set home position on UAV if set in UI
         // - this is done on a per-UAV basis
         // Set home position in UI if UAV chooses a new one (caution! if multiple UAVs are connected, take care!)
         connect(uas, SIGNAL(homePositionChanged(int,double,double,double)), this, SLOT(uavChangedHomePosition(int,double,double,double)));
+        connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)),
+                this, SLOT(updateProximity(UASInterface*,double,double,double,quint64)));
         emit UASCreated(uas);
     }
 
@@ -286,6 +372,17 @@ void UASManager::addUAS(UASInterface* uas)
 void UASManager::removeUAS(QObject* uas)
 {
     UASInterface* mav = qobject_cast<UASInterface*>(uas);
+    if (!mav) {
+        // From destroyed(), the UASInterface part is already gone, only compare pointers
+        // so getUASForId() does not hand it out any more
+        for (int id = 0; id < 256; ++id) {
+            if (systemsById[id] && static_cast<QObject*>(systemsById[id]) == uas) {
+                systemsById[id] = NULL;
+                proximity.remove(id);
+                clearConflicts(id);
+            }
+        }
+    }
     removeUAS(mav);
 }
 
@@ -295,6 +392,13 @@ void UASManager::removeUAS(UASInterface* uas)
 
     if (mav) {
         int listindex = systems.indexOf(mav);
+        for (int id = 0; id < 256; ++id) {
+            if (systemsById[id] == mav) {
+                systemsById[id] = NULL;
+                proximity.remove(id);
+                clearConflicts(id);
+            }
+        }
 
         if (mav == activeUAS)
         {
@@ -328,6 +432,104 @@ void UASManager::removeUAS(UASInterface* uas)
     }
 }
 
+void UASManager::setSeparationMinimum(double horizontal, double vertical)
+{
+    if (isnan(horizontal) || isnan(vertical) || horizontal < 0.0 || vertical < 0.0)
+    {
+        return;
+    }
+    separationHorizontal = horizontal;
+    separationVertical = vertical;
+    if (horizontal > 0.0)
+    {
+        // Cells as large as the clearing distance, a query only looks at 3x3 of them
+        proximity.setCellSize(horizontal * separationHysteresis);
+    }
+    else
+    {
+        QList<quint32> pairs = separationConflicts.toList();
+        separationConflicts.clear();
+        foreach (quint32 pair, pairs)
+        {
+            emit separationCleared(pair >> 8, pair & 0xff);
+        }
+    }
+}
+
+quint32 UASManager::conflictKey(int a, int b)
+{
+    return a < b ? ((a << 8) | b) : ((b << 8) | a);
+}
+
+void UASManager::clearConflicts(int sysid)
+{
+    QList<quint32> pairs = separationConflicts.toList();
+    foreach (quint32 pair, pairs)
+    {
+        if (static_cast<int>(pair >> 8) == sysid || static_cast<int>(pair & 0xff) == sysid)
+        {
+            separationConflicts.remove(pair);
+            emit separationCleared(pair >> 8, pair & 0xff);
+        }
+    }
+}
+
+void UASManager::updateProximity(UASInterface* uas, double lat, double lon, double alt, quint64 usec)
+{
+    Q_UNUSED(usec);
+    const int sysid = uas->getUASID();
+    if (sysid < 0 || sysid >= ProximityGrid::MaxVehicles)
+    {
+        return;
+    }
+    double east, north, up;
+    wgs84ToEnu(lat, lon, alt, &east, &north, &up);
+    proximity.update(sysid, east, north, up);
+    if (separationHorizontal <= 0.0)
+    {
+        return;
+    }
+
+    ProximityGrid::Neighbours near;
+    proximity.neighbours(sysid, separationHorizontal * separationHysteresis,
+                         separationVertical * separationHysteresis, &near);
+    QSet<quint32> stillNear;
+    for (int i = 0; i < near.size(); ++i)
+    {
+        const ProximityGrid::Neighbour &neighbour = near[i];
+        const quint32 pair = conflictKey(sysid, neighbour.sysid);
+        stillNear.insert(pair);
+        if (separationConflicts.contains(pair)
+                || neighbour.horizontal >= separationHorizontal
+                || neighbour.vertical >= separationVertical)
+        {
+            continue;
+        }
+        separationConflicts.insert(pair);
+        QLOG_WARN() << "Separation conflict between systems" << sysid << "and" << neighbour.sysid
+                    << neighbour.horizontal << "m horizontal" << neighbour.vertical << "m vertical";
+        GAudioOutput::instance()->say(tr("systems %1 and %2 are %3 meters apart")
+                                      .arg(sysid).arg(neighbour.sysid).arg(qRound(neighbour.horizontal)),
+                                      MAV_SEVERITY_WARNING);
+        emit separationConflict(sysid, neighbour.sysid, neighbour.horizontal, neighbour.vertical);
+    }
+
+    if (separationConflicts.isEmpty())
+    {
+        return;
+    }
+    QList<quint32> pairs = separationConflicts.toList();
+    foreach (quint32 pair, pairs)
+    {
+        const bool involved = static_cast<int>(pair >> 8) == sysid || static_cast<int>(pair & 0xff) == sysid;
+        if (involved && !stillNear.contains(pair))
+        {
+            separationConflicts.remove(pair);
+            emit separationCleared(pair >> 8, pair & 0xff);
+        }
+    }
+}
+
 QList<UASInterface*> UASManager::getUASList()
 {
     return systems;
@@ -402,13 +604,11 @@ UASInterface* UASManager::getUASForId(int id)
 {
     UASInterface* system = NULL;
 
-    foreach(UASInterface* sys, systems) {
-        if (sys->getUASID() == id) {
-            system = sys;
-        }
+    // Return NULL if not found
+    if (id >= 0 && id < 256) {
+        system = systemsById[id];
     }
 
-    // Return NULL if not found
     return system;
 }
 
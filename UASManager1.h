@@ -34,9 +34,11 @@ This file is part of the QGROUNDCONTROL project
 #include <QThread>
 #include <QList>
 #include <QMutex>
+#include <QSet>
 #include "UASInterface1.h"
 #include "libs/eigen/Eigen/Eigen"
 #include "QGCGeo.h"
+#include "ProximityGrid.h"
 
 /**
  * @brief Central manager for all connected aerial vehicles
@@ -102,6 +104,22 @@ public:
     /** @brief Convert x,y,z coordinates to lat / lon / alt coordinates in north-east-down frame */
     void nedToWgs84(const double& x, const double& y, const double& z, double* lat, double* lon, double* alt);
 
+    /**
+     * @brief wgs84ToEnu of count positions, e.g. a track or every vehicle of a swarm
+     *
+     * Arrays are one per coordinate and must not overlap. Positions are converted
+     * in fixed size blocks with Eigen, the rotation into the tangent plane at home
+     * is one 3x3 by 3xN product per block.
+     */
+    void wgs84ToEnu(const double *lat, const double *lon, const double *alt, int count,
+                    double *east, double *north, double *up) const;
+    /** @brief enuToWgs84 of count positions, same flat earth approximation */
+    void enuToWgs84(const double *x, const double *y, const double *z, int count,
+                    double *lat, double *lon, double *alt) const;
+    /** @brief nedToWgs84 of count positions, same flat earth approximation */
+    void nedToWgs84(const double *x, const double *y, const double *z, int count,
+                    double *lat, double *lon, double *alt) const;
+
     void getLocalNEDSafetyLimits(double* x1, double* y1, double* z1, double* x2, double* y2, double* z2)
     {
         *x1 = nedSafetyLimitPosition1.x();
@@ -133,6 +151,22 @@ public:
         }
     }
 
+    /** @brief Horizontal distance below which two vehicles raise a separation alert, meters */
+    double getSeparationHorizontal() const
+    {
+        return separationHorizontal;
+    }
+    /** @brief Vertical distance below which two vehicles raise a separation alert, meters */
+    double getSeparationVertical() const
+    {
+        return separationVertical;
+    }
+    /** @brief Vehicle positions in the local ENU frame of the home position */
+    const ProximityGrid& getProximityGrid() const
+    {
+        return proximity;
+    }
+
 //    void wgs84ToNed(const double& lat, const double& lon, const double& alt, double* north, double* east, double* down);
 
 
@@ -236,6 +270,9 @@ public slots:
     /** @brief Update home position based on the position from one of the UAVs */
     void uavChangedHomePosition(int uav, double lat, double lon, double alt);
 
+    /** @brief Set the minimum separation between vehicles, 0 horizontal disables the alerts */
+    void setSeparationMinimum(double horizontal, double vertical);
+
     /** @brief Load settings */
     void loadSettings();
     /** @brief Store settings */
@@ -245,6 +282,7 @@ public slots:
 protected:
     UASManager();
     QList<UASInterface*> systems;
+    UASInterface* systemsById[256]; ///< By system ID, for getUASForId() on every decoded field
     UASInterface* activeUAS;
     QMutex activeUASMutex;
     double homeLat;
@@ -253,10 +291,24 @@ protected:
     int homeFrame;
     Eigen::Quaterniond ecef_ref_orientation_;
     Eigen::Vector3d ecef_ref_point_;
+    Eigen::Matrix3d ecef_ref_rotation_;    ///< ecef_ref_orientation_ as matrix, for the batch conversions
+    double enu_lat_scale_;                 ///< Degrees latitude per meter north
+    double enu_lon_scale_;                 ///< Degrees longitude per meter east at the reference
     Eigen::Vector3d nedSafetyLimitPosition1;
     Eigen::Vector3d nedSafetyLimitPosition2;
 
+    ProximityGrid proximity;               ///< ENU positions of all systems, re-filled after a home change
+    QSet<quint32> separationConflicts;     ///< Pairs currently too close, see conflictKey()
+    double separationHorizontal;
+    double separationVertical;
+
     void initReference(const double & latitude, const double & longitude, const double & altitude);
+    static quint32 conflictKey(int a, int b);
+    void clearConflicts(int sysid);
+
+protected slots:
+    /** @brief Moves the system in the proximity grid and checks its separation to the others */
+    void updateProximity(UASInterface* uas, double lat, double lon, double alt, quint64 usec);
 
 signals:
 
@@ -276,6 +328,10 @@ signals:
     void activeUASStatusChanged(int systemId, bool active);
     /** @brief Current home position changed */
     void homePositionChanged(double lat, double lon, double alt);
+    /** @brief Two systems came closer than the separation minimum */
+    void separationConflict(int sysidA, int sysidB, double horizontal, double vertical);
+    /** @brief Two systems in conflict are apart again */
+    void separationCleared(int sysidA, int sysidB);
 public:
     /* Need to align struct pointer to prevent a memory assertion:
      * See http://eigen.tuxfamily.org/dox-devel/TopicUnalignedArrayAssert.html
@@ -32,16 +32,86 @@ This file is part of the QGROUNDCONTROL project
 #include "UDPLink1.h"
 #include "LinkManager1.h"
 #include "QGC.h"
+#include "GroundClock.h"
+#include "ThreadRoles.h"
+#include "TraceMarkers.h"
+#include "QsLogLimit.h"
 
 #include <QTimer>
 #include <QList>
 #include <QMutexLocker>
 #include <iostream>
 #include <QHostInfo>
+#include <QNetworkInterface>
 //#include <netinet/in.h>
 
+#if defined(Q_OS_LINUX) && (!defined(Q_OS_ANDROID) || __ANDROID_API__ >= 21)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+#include <time.h>
+#define UDPLINK_MMSG
+#endif
+
+// Datagrams read per batch and the room each gets, MAVLink routers stay below one MTU
+static const int RxBatchDatagrams = 32;
+static const int RxDatagramSize = 2048;
+static const int RxBufferSize = RxBatchDatagrams * RxDatagramSize;
+// Batches per readyRead, the rest waits for the next one so other sockets get their turn
+static const int RxMaxBatches = 8;
+// Peers per sendmmsg() call
+static const int TxBatchPeers = 32;
+// Learned peers silent this long stop getting traffic, they are added again when they talk
+static const qint64 PeerTimeoutMs = 10000;
+static const qint64 PeerPruneMs = 1000;
+// Rides out a stalled I/O thread, a few seconds of a busy router link
+static const int DefaultReceiveBufferBytes = 1024 * 1024;
+// Kernel receive times older than this are a stepped wall clock, not a queue
+static const qint64 MaxKernelAgeNs = Q_INT64_C(10000000000);
+
+#ifdef UDPLINK_MMSG
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+
+// Room for the receive time and the overflow counter of one datagram
+static const int RxControlSize = CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(quint32));
+
+/** @brief Wall time in ns (SCM_TIMESTAMPNS) and the drop counter (SO_RXQ_OVFL) of a received datagram */
+static void readControl(struct msghdr* header, qint64* wallNs, quint32* overflows)
+{
+    for (struct cmsghdr* control = CMSG_FIRSTHDR(header); control; control = CMSG_NXTHDR(header, control))
+    {
+        if (control->cmsg_level != SOL_SOCKET)
+        {
+            continue;
+        }
+        if (control->cmsg_type == SCM_TIMESTAMPNS && wallNs)
+        {
+            struct timespec stamp;
+            memcpy(&stamp, CMSG_DATA(control), sizeof(stamp));
+            *wallNs = qint64(stamp.tv_sec) * Q_INT64_C(1000000000) + stamp.tv_nsec;
+        }
+        else if (control->cmsg_type == SO_RXQ_OVFL && overflows)
+        {
+            quint32 count;
+            memcpy(&count, CMSG_DATA(control), sizeof(count));
+            *overflows = qMax(*overflows, count);
+        }
+    }
+}
+#endif
+
 UDPLink::UDPLink(QHostAddress host, quint16 port) :
-    socket(NULL)
+    socket(NULL),
+    lastPrune(0),
+    socketFamily(0),
+    multicastTtl(1),
+    rxBufferBytes(DefaultReceiveBufferBytes),
+    txBufferBytes(0),
+    rxTime(0),
+    rxOverflows(0)
 {
     this->host = host;
     this->port = port;
@@ -50,6 +120,9 @@ UDPLink::UDPLink(QHostAddress host, quint16 port) :
     this->id = getNextLinkId();
 	this->name = tr("UDP Link (port:%1)").arg(this->port);
 	emit nameChanged(this->name);
+    // The socket is created, read and written on this link's own thread,
+    // so a busy UI thread cannot delay reads until the kernel buffer overruns
+    moveToThread(this);
     // LinkManager::instance()->add(this);
     QLOG_INFO() << "UDP Created " << name;
 }
@@ -63,9 +136,11 @@ UDPLink::~UDPLink()
 /**
  * @brief Runs the thread
  *
+ * The event loop services the socket, see connect()
  **/
 void UDPLink::run()
 {
+	ThreadRoles::enter(ThreadRoles::LinkIo);
 	exec();
 }
 
@@ -84,6 +159,59 @@ void UDPLink::setAddress(QHostAddress host)
 	}
 }
 
+void UDPLink::setMulticast(const QHostAddress& group, int ttl, const QString& interfaceName)
+{
+    bool reconnect(false);
+    if(this->isConnected())
+    {
+        disconnect();
+        reconnect = true;
+    }
+    multicastGroup = group;
+    multicastTtl = qBound(1, ttl, 255);
+    multicastInterfaceName = interfaceName;
+    updateName();
+    if(reconnect)
+    {
+        connect();
+    }
+}
+
+void UDPLink::setSocketBuffers(int receiveBytes, int sendBytes)
+{
+    bool reconnect(false);
+    if(this->isConnected())
+    {
+        disconnect();
+        reconnect = true;
+    }
+    rxBufferBytes = qMax(0, receiveBytes);
+    txBufferBytes = qMax(0, sendBytes);
+    if(reconnect)
+    {
+        connect();
+    }
+}
+
+void UDPLink::updateName()
+{
+    if (isMulticast())
+    {
+        this->name = tr("UDP Multicast (%1 port:%2)").arg(multicastGroup.toString()).arg(this->port);
+    }
+    else
+    {
+        this->name = tr("UDP Link (port:%1)").arg(this->port);
+    }
+    emit nameChanged(this->name);
+}
+
+bool UDPLink::isMulticast() const
+{
+    return multicastGroup.protocol() == QAbstractSocket::IPv4Protocol
+            && multicastGroup.isInSubnet(QHostAddress("224.0.0.0"), 4);
+}
+
 void UDPLink::setPort(int port)
 {
 	bool reconnect(false);
@@ -93,54 +221,85 @@ void UDPLink::setPort(int port)
 		reconnect = true;
 	}
     this->port = port;
-	this->name = tr("UDP Link (port:%1)").arg(this->port);
-	emit nameChanged(this->name);
+    updateName();
 	if(reconnect)
 	{
 		connect();
 	}
 }
 
+/** @brief The address of a lookup to send to, IPv4 preferred as before */
+static QHostAddress pickAddress(const QList<QHostAddress>& hostAddresses)
+{
+    QHostAddress address;
+    for (int i = 0; i < hostAddresses.size(); i++)
+    {
+        // Exclude loopback IPv4 and all IPv6 addresses
+        if (!hostAddresses.at(i).toString().contains(":"))
+        {
+            address = hostAddresses.at(i);
+        }
+    }
+    if (address.isNull() && !hostAddresses.isEmpty())
+    {
+        address = hostAddresses.first();
+    }
+    return address;
+}
+
 /**
+ * Names are looked up in the background, the link sends to the host once
+ * the lookup comes back. Addresses are added at once.
+ *
  * @param host Hostname in standard formatting, e.g. localhost:14551 or 192.168.1.1:14551
  */
 void UDPLink::addHost(const QString& host)
 {
     QLOG_INFO() << "UDP:" << "ADDING HOST:" << host;
-    if (host.contains(":"))
+    QString name = host.trimmed();
+    quint16 peerPort = port;
+    if (name.contains(":"))
     {
-        QLOG_DEBUG() << "HOST: " << host.split(":").first();
-        QHostInfo info = QHostInfo::fromName(host.split(":").first());
-        if (info.error() == QHostInfo::NoError)
-        {
-            // Add host
-            QList<QHostAddress> hostAddresses = info.addresses();
-            QHostAddress address;
-            for (int i = 0; i < hostAddresses.size(); i++)
-            {
-                // Exclude loopback IPv4 and all IPv6 addresses
-                if (!hostAddresses.at(i).toString().contains(":"))
-                {
-                    address = hostAddresses.at(i);
-                }
-            }
-            hosts.append(address);
-            QLOG_DEBUG() << "Address:" << address.toString();
-            // Set port according to user input
-            ports.append(host.split(":").last().toInt());
-        }
+        // Port according to user input, otherwise the default (this port)
+        peerPort = name.split(":").last().toInt();
+        name = name.split(":").first();
     }
-    else
+    QHostAddress address(name);
+    if (!address.isNull())
     {
-        QHostInfo info = QHostInfo::fromName(host);
-        if (info.error() == QHostInfo::NoError)
+        setPeer(address, peerPort, GroundClock::msecs(), true);
+        return;
+    }
+    QLOG_DEBUG() << "HOST: " << name;
+    QMutexLocker locker(&dataMutex);
+    int lookup = QHostInfo::lookupHost(name, this, SLOT(hostLookedUp(QHostInfo)));
+    pendingLookups.insert(lookup, PendingHost(name, peerPort));
+}
+
+void UDPLink::hostLookedUp(const QHostInfo& info)
+{
+    PendingHost pending;
+    {
+        QMutexLocker locker(&dataMutex);
+        if (!pendingLookups.contains(info.lookupId()))
         {
-            // Add host
-            hosts.append(info.addresses().first());
-            // Set port according to default (this port)
-            ports.append(port);
+            // Removed again while it was looked up
+            return;
         }
+        pending = pendingLookups.take(info.lookupId());
+    }
+    QHostAddress address = pickAddress(info.addresses());
+    if (info.error() != QHostInfo::NoError || address.isNull())
+    {
+        QLOG_WARN() << "UDP: could not look up" << pending.first << info.errorString();
+        return;
     }
+    QLOG_DEBUG() << "Address:" << address.toString();
+    {
+        QMutexLocker locker(&dataMutex);
+        resolvedHosts.insert(pending.first, address);
+    }
+    setPeer(address, pending.second, GroundClock::msecs(), true);
 }
 
 void UDPLink::removeHost(const QString& hostname)
@@ -148,112 +307,473 @@ void UDPLink::removeHost(const QString& hostname)
     QString host = hostname;
     if (host.contains(":")) host = host.split(":").first();
     host = host.trimmed();
-    QHostInfo info = QHostInfo::fromName(host);
-    QHostAddress address;
-    QList<QHostAddress> hostAddresses = info.addresses();
-    for (int i = 0; i < hostAddresses.size(); i++)
+    QMutexLocker locker(&dataMutex);
+    QHash<int, PendingHost>::iterator it = pendingLookups.begin();
+    while (it != pendingLookups.end())
     {
-        // Exclude loopback IPv4 and all IPv6 addresses
-        if (!hostAddresses.at(i).toString().contains(":"))
+        it = it.value().first == host ? pendingLookups.erase(it) : it + 1;
+    }
+    // A name is never looked up again, it is whatever addHost() got for it
+    QHostAddress address(host);
+    if (address.isNull())
+    {
+        address = resolvedHosts.take(host);
+    }
+    int index = peerIndex.value(address, -1);
+    if (index >= 0)
+    {
+        removePeer(index);
+    }
+}
+
+QList<QHostAddress> UDPLink::getHosts() const
+{
+    QMutexLocker locker(&dataMutex);
+    QList<QHostAddress> hosts;
+    for (int i = 0; i < peers.size(); ++i)
+    {
+        hosts.append(peers.at(i).address);
+    }
+    return hosts;
+}
+
+QList<quint16> UDPLink::getPorts() const
+{
+    QMutexLocker locker(&dataMutex);
+    QList<quint16> ports;
+    for (int i = 0; i < peers.size(); ++i)
+    {
+        ports.append(peers.at(i).port);
+    }
+    return ports;
+}
+
+void UDPLink::writeBytes(const char* data, qint64 size)
+{
+    if (QThread::currentThread() != this)
+    {
+        // Senders run on the UI thread, the socket on ours
+        if (isRunning())
         {
-            address = hostAddresses.at(i);
+            QMetaObject::invokeMethod(this, "writeQueued", Qt::QueuedConnection, Q_ARG(QByteArray, QByteArray(data, size)));
         }
+        return;
+    }
+    qint64 now = GroundClock::msecs();
+    prunePeers(now);
+    if (!socket || peers.isEmpty())
+    {
+        return;
     }
-    for (int i = 0; i < hosts.count(); ++i)
+//#define UDPLINK_DEBUG
+#ifdef UDPLINK_DEBUG
+    QString bytes;
+    QString ascii;
+    for (int i=0; i<size; i++)
     {
-        if (hosts.at(i) == address)
+        unsigned char v = data[i];
+        bytes.append(QString().sprintf("%02x ", v));
+        if (data[i] > 31 && data[i] < 127)
         {
-            hosts.removeAt(i);
-            ports.removeAt(i);
+            ascii.append(data[i]);
+        }
+        else
+        {
+            ascii.append(219);
         }
     }
+    QLOG_TRACE() << "Sent" << size << "bytes to" << peers.size() << "hosts, data:";
+    QLOG_TRACE() << bytes;
+    QLOG_TRACE() << "ASCII:" << ascii;
+#endif
+    // Broadcast to all connected systems
+    int sent = sendToPeers(data, size);
+
+    // Log the amount and time written out for future data rate calculations.
+    outTraffic.add(size * sent, sent, now);
 }
 
-void UDPLink::writeBytes(const char* data, qint64 size)
+void UDPLink::writeQueued(QByteArray data)
 {
-    // Broadcast to all connected systems
-    for (int h = 0; h < hosts.size(); h++)
+    writeBytes(data.constData(), data.size());
+}
+
+int UDPLink::sendToPeers(const char* data, qint64 size)
+{
+    QMutexLocker locker(&dataMutex);
+    int sent = 0;
+    int next = 0;
+#ifdef UDPLINK_MMSG
+    int fd = static_cast<int>(socket->socketDescriptor());
+    if (fd >= 0 && socketFamily != 0)
     {
-        QHostAddress currentHost = hosts.at(h);
-        quint16 currentPort = ports.at(h);
-//#define UDPLINK_DEBUG
-#ifdef UDPLINK_DEBUG
-        QString bytes;
-        QString ascii;
-        for (int i=0; i<size; i++)
+        struct iovec vector;
+        vector.iov_base = const_cast<char*>(data);
+        vector.iov_len = size;
+        struct mmsghdr messages[TxBatchPeers];
+        while (next < peers.size())
         {
-            unsigned char v = data[i];
-            bytes.append(QString().sprintf("%02x ", v));
-            if (data[i] > 31 && data[i] < 127)
+            int count = 0;
+            for (; next < peers.size() && count < TxBatchPeers; ++next)
             {
-                ascii.append(data[i]);
+                const QByteArray &native = peers.at(next).native;
+                if (native.isEmpty())
+                {
+                    // Not reachable through this socket's address family
+                    continue;
+                }
+                memset(&messages[count], 0, sizeof(messages[count]));
+                messages[count].msg_hdr.msg_name = const_cast<char*>(native.constData());
+                messages[count].msg_hdr.msg_namelen = native.size();
+                messages[count].msg_hdr.msg_iov = &vector;
+                messages[count].msg_hdr.msg_iovlen = 1;
+                ++count;
             }
-            else
+            for (int offset = 0; offset < count;)
             {
-                ascii.append(219);
+                int result = ::sendmmsg(fd, messages + offset, count - offset, MSG_DONTWAIT);
+                if (result <= 0)
+                {
+                    // Like a failed writeDatagram(), this peer misses the datagram
+                    ++offset;
+                    continue;
+                }
+                sent += result;
+                offset += result;
             }
         }
-        QLOG_TRACE() << "Sent" << size << "bytes to" << currentHost.toString() << ":" << currentPort << "data:";
-        QLOG_TRACE() << bytes;
-        QLOG_TRACE() << "ASCII:" << ascii;
+        return sent;
+    }
 #endif
-        socket->writeDatagram(data, size, currentHost, currentPort);
-
-        // Log the amount and time written out for future data rate calculations.
-        QMutexLocker dataRateLocker(&dataRateMutex);
-        logDataRateToBuffer(outDataWriteAmounts, outDataWriteTimes, &outDataIndex, size, QDateTime::currentMSecsSinceEpoch());
+    for (; next < peers.size(); ++next)
+    {
+        const Peer &peer = peers.at(next);
+        if (socket->writeDatagram(data, size, peer.address, peer.port) >= 0)
+        {
+            ++sent;
+        }
     }
+    return sent;
 }
 
 /**
- * @brief Read a number of bytes from the interface.
+ * @brief Read the pending datagrams.
  *
- * @param data Pointer to the data byte array to write the bytes to
- * @param maxLength The maximum number of bytes to write
+ * Datagrams are read back to back into a pooled buffer, up to RxBatchDatagrams
+ * at a time, and each batch is passed on with one bytesReceived() and one
+ * statistics update. MAVLink frames never span datagrams, so the parser sees
+ * the same frames as before.
  **/
 void UDPLink::readBytes()
 {
-    while (socket->hasPendingDatagrams())
+    HUD_TRACE_SCOPE("UDPLink::readBytes");
+    for (int batches = 0; batches < RxMaxBatches && socket->hasPendingDatagrams(); ++batches)
     {
-        QByteArray datagram;
-        datagram.resize(socket->pendingDatagramSize());
+        QByteArray &batch = rxBuffer();
+        qint64 pending = socket->pendingDatagramSize();
+        batch.resize(qMax<qint64>(RxBufferSize, pending));
+        char *data = batch.data();
 
+        // When the oldest datagram of the batch arrived, not when this thread got to it
+        qint64 kernelTime = peekReceiveTime();
+
+        // The first one through Qt, reading a datagram rearms the socket's read notifier
         QHostAddress sender;
         quint16 senderPort;
-        socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        qint64 size = socket->readDatagram(data, batch.size(), &sender, &senderPort);
+        // One reading for the batch: latency tracing, traffic statistics and peers
+        readTime = kernelTime > 0 ? kernelTime : GroundClock::nsecs();
+        rxTime = readTime / 1000000;
+        if (size < 0)
+        {
+            batch.resize(0);
+            break;
+        }
+        notePeer(sender, senderPort);
+        int count = 1;
+        int length = static_cast<int>(size);
+        length += receiveBatch(data + length, batch.size() - length, &count);
+        batch.resize(length);
 
-        // FIXME TODO Check if this method is better than retrieving the data by individual processes
-        emit bytesReceived(this, datagram);
+#ifdef UDPLINK_DEBUG
+        // Echo data for debugging purposes
+        std::cerr << __FILE__ << __LINE__ << "Received" << count << "datagrams," << length << "bytes" << std::endl;
+#endif
 
         // Log this data reception for this timestep
-        QMutexLocker dataRateLocker(&dataRateMutex);
-        logDataRateToBuffer(inDataWriteAmounts, inDataWriteTimes, &inDataIndex, datagram.length(), QDateTime::currentMSecsSinceEpoch());
+        inTraffic.add(length, count, rxTime);
+        // The queued copy shares the buffer, rxBuffer() hands it out again once the parser is done
+        emit bytesReceived(this, batch);
+    }
+}
 
-#ifdef UDPLINK_DEBUG
-        // Echo data for debugging purposes
-        std::cerr << __FILE__ << __LINE__ << "Received datagram:" << std::endl;
-//        int i;
-//        for (i=0; i<s; i++)
-//        {
-//            unsigned int v=data[i];
-//            fprintf(stderr,"%02x ", v);
-//        }
-//        std::cerr << std::endl;
+qint64 UDPLink::peekReceiveTime()
+{
+#ifdef UDPLINK_MMSG
+    int fd = static_cast<int>(socket->socketDescriptor());
+    if (fd < 0)
+    {
+        return 0;
+    }
+    // A one byte peek leaves the datagram queued for readDatagram() and brings its control messages
+    char byte;
+    struct iovec vector;
+    vector.iov_base = &byte;
+    vector.iov_len = sizeof(byte);
+    char control[RxControlSize];
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &vector;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    if (::recvmsg(fd, &header, MSG_PEEK | MSG_DONTWAIT) < 0)
+    {
+        return 0;
+    }
+    qint64 wallNs = 0;
+    quint32 overflows = 0;
+    readControl(&header, &wallNs, &overflows);
+    noteOverflows(overflows);
+    if (wallNs <= 0)
+    {
+        return 0;
+    }
+    // The kernel stamps wall time, its age moves it onto the monotonic clock
+    const qint64 now = GroundClock::nsecs();
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    const qint64 age = qint64(wall.tv_sec) * Q_INT64_C(1000000000) + wall.tv_nsec - wallNs;
+    if (age < 0 || age > MaxKernelAgeNs)
+    {
+        return 0;
+    }
+    return qMax(Q_INT64_C(1), now - age);
+#else
+    return 0;
 #endif
+}
+
+void UDPLink::noteOverflows(quint32 overflows)
+{
+    // Only the I/O thread writes it
+    quint32 previous = static_cast<quint32>(rxOverflows.loadAcquire());
+    if (overflows <= previous)
+    {
+        return;
+    }
+    rxOverflows.storeRelease(static_cast<int>(overflows));
+    static QsLogging::LogModule overflowLog("UDP overflow", 1, 5);
+    QLOG_WARN_LIMITED(overflowLog) << "UDP:" << name << "receive buffer overflowed," << overflows - previous
+                                   << "datagrams dropped," << overflows << "since connect";
+}
+
+QByteArray& UDPLink::rxBuffer()
+{
+    for (int i = 0; i < RxBuffers; ++i)
+    {
+        if (rxBuffers[i].isNull())
+        {
+            rxBuffers[i].reserve(RxBufferSize);
+            return rxBuffers[i];
+        }
+        if (rxBuffers[i].isDetached())
+        {
+            return rxBuffers[i];
+        }
+    }
+    // Everything is still queued at the parser, this batch gets its own
+    rxSpare = QByteArray();
+    rxSpare.reserve(RxBufferSize);
+    return rxSpare;
+}
+
+int UDPLink::receiveBatch(char* data, int space, int* count)
+{
+    int length = 0;
+#ifdef UDPLINK_MMSG
+    int fd = static_cast<int>(socket->socketDescriptor());
+    int slots = qMin(RxBatchDatagrams - *count, space / RxDatagramSize);
+    if (fd < 0 || slots <= 0)
+    {
+        return 0;
+    }
+    struct mmsghdr messages[RxBatchDatagrams];
+    struct iovec vectors[RxBatchDatagrams];
+    struct sockaddr_storage senders[RxBatchDatagrams];
+    char controls[RxBatchDatagrams][RxControlSize];
+    memset(messages, 0, slots * sizeof(messages[0]));
+    for (int i = 0; i < slots; ++i)
+    {
+        vectors[i].iov_base = data + i * RxDatagramSize;
+        vectors[i].iov_len = RxDatagramSize;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &senders[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        messages[i].msg_hdr.msg_control = controls[i];
+        messages[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+    }
+    int received = ::recvmmsg(fd, messages, slots, MSG_DONTWAIT, NULL);
+    // The batch keeps the receive time of its first datagram, only the drop counter moves on
+    quint32 overflows = 0;
+    for (int i = 0; i < received; ++i)
+    {
+        readControl(&messages[i].msg_hdr, NULL, &overflows);
+    }
+    noteOverflows(overflows);
+    int previous = -1;
+    for (int i = 0; i < received; ++i)
+    {
+        if (messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+        {
+            QLOG_WARN() << "UDP: dropped a datagram larger than" << RxDatagramSize << "bytes";
+            continue;
+        }
+        int size = messages[i].msg_len;
+        // Pack the datagrams back to back
+        memmove(data + length, vectors[i].iov_base, size);
+        length += size;
+        ++*count;
+
+        // Consecutive datagrams mostly come from the same peer
+        socklen_t nameLength = messages[i].msg_hdr.msg_namelen;
+        if (previous >= 0 && nameLength == messages[previous].msg_hdr.msg_namelen
+                && memcmp(&senders[i], &senders[previous], nameLength) == 0)
+        {
+            continue;
+        }
+        previous = i;
+        const struct sockaddr *address = reinterpret_cast<const struct sockaddr*>(&senders[i]);
+        quint16 senderPort = address->sa_family == AF_INET6
+                ? ntohs(reinterpret_cast<const struct sockaddr_in6*>(address)->sin6_port)
+                : ntohs(reinterpret_cast<const struct sockaddr_in*>(address)->sin_port);
+        notePeer(QHostAddress(address), senderPort);
+    }
+#else
+    while (*count < RxBatchDatagrams && socket->hasPendingDatagrams())
+    {
+        if (socket->pendingDatagramSize() > space - length)
+        {
+            // Next batch
+            break;
+        }
+        QHostAddress sender;
+        quint16 senderPort;
+        qint64 size = socket->readDatagram(data + length, space - length, &sender, &senderPort);
+        if (size < 0)
+        {
+            break;
+        }
+        length += static_cast<int>(size);
+        ++*count;
+        notePeer(sender, senderPort);
+    }
+#endif
+    return length;
+}
+
+void UDPLink::notePeer(const QHostAddress& sender, quint16 senderPort)
+{
+    // Add host to broadcast list if not yet present
+    setPeer(sender, senderPort, rxTime, false);
+}
+
+void UDPLink::setPeer(const QHostAddress& address, quint16 peerPort, qint64 now, bool configured)
+{
+    // addHost() runs on the UI thread
+    QMutexLocker locker(&dataMutex);
+    QHash<QHostAddress, int>::const_iterator found = peerIndex.constFind(address);
+    if (found == peerIndex.constEnd())
+    {
+        Peer peer;
+        peer.address = address;
+        peer.port = peerPort;
+        peer.lastSeen = now;
+        peer.configured = configured;
+        updateNativeAddress(peer);
+        peerIndex.insert(address, peers.size());
+        peers.append(peer);
+        return;
+    }
+    Peer &peer = peers[found.value()];
+    peer.lastSeen = now;
+    peer.configured = peer.configured || configured;
+    if (peer.port != peerPort)
+    {
+        peer.port = peerPort;
+        updateNativeAddress(peer);
+    }
+}
+
+void UDPLink::removePeer(int index)
+{
+    peerIndex.remove(peers.at(index).address);
+    int last = peers.size() - 1;
+    if (index != last)
+    {
+        // Order does not matter, move the last one into the gap
+        peers[index] = peers.at(last);
+        peerIndex.insert(peers.at(index).address, index);
+    }
+    peers.resize(last);
+}
 
-        // Add host to broadcast list if not yet present
-        if (!hosts.contains(sender))
+void UDPLink::prunePeers(qint64 now)
+{
+    if (now - lastPrune < PeerPruneMs)
+    {
+        return;
+    }
+    lastPrune = now;
+    QMutexLocker locker(&dataMutex);
+    for (int i = peers.size() - 1; i >= 0; --i)
+    {
+        const Peer &peer = peers.at(i);
+        if (!peer.configured && now - peer.lastSeen > PeerTimeoutMs)
         {
-            hosts.append(sender);
-            ports.append(senderPort);
-            //        ports->insert(sender, senderPort);
+            QLOG_DEBUG() << "UDP: no longer sending to" << peer.address.toString() << ":" << peer.port;
+            removePeer(i);
+        }
+    }
+}
+
+void UDPLink::updateNativeAddress(Peer& peer) const
+{
+    peer.native.clear();
+#ifdef UDPLINK_MMSG
+    bool ipv4 = peer.address.protocol() == QAbstractSocket::IPv4Protocol;
+    if (socketFamily == AF_INET && ipv4)
+    {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(peer.port);
+        address.sin_addr.s_addr = htonl(peer.address.toIPv4Address());
+        peer.native = QByteArray(reinterpret_cast<const char*>(&address), sizeof(address));
+    }
+    else if (socketFamily == AF_INET6 && (ipv4 || peer.address.protocol() == QAbstractSocket::IPv6Protocol))
+    {
+        struct sockaddr_in6 address;
+        memset(&address, 0, sizeof(address));
+        address.sin6_family = AF_INET6;
+        address.sin6_port = htons(peer.port);
+        if (ipv4)
+        {
+            // A dual stack socket reaches IPv4 peers through mapped addresses
+            quint32 v4 = htonl(peer.address.toIPv4Address());
+            address.sin6_addr.s6_addr[10] = 0xff;
+            address.sin6_addr.s6_addr[11] = 0xff;
+            memcpy(&address.sin6_addr.s6_addr[12], &v4, sizeof(v4));
         }
         else
         {
-            int index = hosts.indexOf(sender);
-            ports.replace(index, senderPort);
+            Q_IPV6ADDR v6 = peer.address.toIPv6Address();
+            memcpy(address.sin6_addr.s6_addr, v6.c, sizeof(v6.c));
         }
+        peer.native = QByteArray(reinterpret_cast<const char*>(&address), sizeof(address));
     }
+#endif
 }
 
 
@@ -275,14 +795,13 @@ qint64 UDPLink::bytesAvailable()
 bool UDPLink::disconnect()
 {
     QLOG_INFO() << "UDP disconnect";
-	this->quit();
-	this->wait();
-
-    if(socket)
-	{
-		delete socket;
-		socket = NULL;
-	}
+    if (isRunning())
+    {
+        // The socket belongs to the I/O thread, which deletes it
+        QMetaObject::invokeMethod(this, "hardwareDisconnect", Qt::BlockingQueuedConnection);
+        this->quit();
+        this->wait();
+    }
 
     connectState = false;
 
@@ -301,59 +820,103 @@ bool UDPLink::connect()
 {
     disconnect();
     QLOG_INFO() << "UDPLink::UDP connect " << host << ":" << port;
-	if(this->isRunning())
-	{
-		this->quit();
-		this->wait();
-	}
-    bool connected = this->hardwareConnect();
-    start(LowPriority);
+    start(HighPriority);
+    // Created on the I/O thread, so its notifiers are serviced there
+    bool connected = false;
+    QMetaObject::invokeMethod(this, "hardwareConnect", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, connected));
     return connected;
 }
 
-bool UDPLink::hardwareConnect(void)
+void UDPLink::setSocketOptions()
 {
-	socket = new QUdpSocket();
-
-    //Check if we are using a multicast-address
-//    bool multicast = false;
-//    if (host.isInSubnet(QHostAddress("224.0.0.0"),4))
-//    {
-//        multicast = true;
-//        connectState = socket->bind(port, QUdpSocket::ShareAddress);
-//    }
-//    else
-//    {
-    connectState = socket->bind(host, port);
+    rxOverflows.storeRelease(0);
+    if (rxBufferBytes > 0)
+    {
+        socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, rxBufferBytes);
+    }
+    if (txBufferBytes > 0)
+    {
+        socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, txBufferBytes);
+    }
+    QLOG_INFO() << "UDP: socket buffers" << socket->socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt()
+                << "receive," << socket->socketOption(QAbstractSocket::SendBufferSizeSocketOption).toInt() << "send bytes";
+#ifdef UDPLINK_MMSG
+    int fd = static_cast<int>(socket->socketDescriptor());
+    int on = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+    {
+        QLOG_WARN() << "UDP: no kernel receive times, reads are stamped when they are read";
+    }
+    if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) != 0)
+    {
+        QLOG_WARN() << "UDP: the kernel does not count receive buffer overflows";
+    }
+#endif
+}
 
-    QLOG_ERROR() << "bind failed! " << host << ":" << port;// << " - " << errno << ": " << strerror(errno);
+void UDPLink::hardwareDisconnect()
+{
+    QMutexLocker locker(&dataMutex);
+    delete socket;
+    socket = NULL;
+}
 
-//    }
+bool UDPLink::hardwareConnect(void)
+{
+	socket = new QUdpSocket();
 
-    //Provides Multicast functionality to UdpSocket
-    /* not working yet
-    if (multicast)
+    bool shared = isMulticast() || multicastGroup == QHostAddress(QHostAddress::Broadcast);
+    if (shared)
+    {
+        // Every display on the machine and the network gets the one stream
+        connectState = socket->bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+    }
+    else
     {
-        int sendingFd = socket->socketDescriptor();
+        connectState = socket->bind(host, port);
+    }
+    if (!connectState)
+    {
+        QLOG_ERROR() << "bind failed! " << host << ":" << port << socket->errorString();
+    }
 
-        if (sendingFd != -1)
+    if (connectState && isMulticast())
+    {
+        QNetworkInterface iface = QNetworkInterface::interfaceFromName(multicastInterfaceName);
+        bool joined = iface.isValid() ? socket->joinMulticastGroup(multicastGroup, iface)
+                                      : socket->joinMulticastGroup(multicastGroup);
+        if (!joined)
         {
-            // set up destination address
-            struct sockaddr_in sendAddr;
-            memset(&sendAddr,0,sizeof(sendAddr));
-            sendAddr.sin_family=AF_INET;
-            sendAddr.sin_addr.s_addr=inet_addr(HELLO_GROUP);
-            sendAddr.sin_port=htons(port);
-
-            // set TTL
-            unsigned int ttl = 1; // restricted to the same subnet
-            if (setsockopt(sendingFd, IPPROTO_IP, IP_MULTICAST_TTL, (unsigned int*)&ttl, sizeof(ttl) ) < 0)
-            {
-                std::cout << "TTL failed\n";
-            }
+            QLOG_ERROR() << "UDP: could not join" << multicastGroup << socket->errorString();
+        }
+        else if (iface.isValid())
+        {
+            socket->setMulticastInterface(iface);
         }
+        socket->setSocketOption(QAbstractSocket::MulticastTtlOption, multicastTtl);
     }
-    */
+
+    if (connectState)
+    {
+        setSocketOptions();
+    }
+
+#ifdef UDPLINK_MMSG
+    // sendmmsg() needs addresses of the socket's own family
+    socketFamily = 0;
+    struct sockaddr_storage local;
+    socklen_t localLength = sizeof(local);
+    if (connectState && ::getsockname(static_cast<int>(socket->socketDescriptor()),
+                                      reinterpret_cast<struct sockaddr*>(&local), &localLength) == 0)
+    {
+        socketFamily = local.ss_family;
+    }
+    QMutexLocker locker(&dataMutex);
+    for (int i = 0; i < peers.size(); ++i)
+    {
+        updateNativeAddress(peers[i]);
+    }
+#endif
 
     //QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
     QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
@@ -402,12 +965,3 @@ qint64 UDPLink::getConnectionSpeed() const
     return 54000000; // 54 Mbit
 }
 
-qint64 UDPLink::getCurrentInDataRate() const
-{
-    return 0;
-}
-
-qint64 UDPLink::getCurrentOutDataRate() const
-{
-    return 0;
-}
@@ -34,8 +34,13 @@ This file is part of the QGROUNDCONTROL project
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QUdpSocket>
+#include <QHostInfo>
+#include <QPair>
 #include <LinkInterface.h>
 #include <configuration.h>
 
@@ -69,17 +74,43 @@ public:
     int getParityType() const;
     int getDataBitsType() const;
     int getStopBitsType() const;
-    QList<QHostAddress> getHosts() const {
-        return hosts;
-    }
-    QList<quint16> getPorts() const {
-        return ports;
-    }
+    /** @brief The systems messages are sent to, in the same order as getPorts() */
+    QList<QHostAddress> getHosts() const;
+    QList<quint16> getPorts() const;
+
+    /**
+     * @brief Receive a multicast group instead of unicast on the port
+     *
+     * Several displays can then share one stream from the air side. The
+     * port is bound shared, so they may run on the same machine too.
+     * QHostAddress::Broadcast binds shared without joining, for broadcast
+     * streams; a null group is plain unicast again.
+     *
+     * @param ttl Hops the link's own datagrams to the group may take
+     * @param interfaceName Interface to join on, empty for the system's choice
+     */
+    void setMulticast(const QHostAddress& group, int ttl = 1, const QString& interfaceName = QString());
+    bool isMulticast() const;
+    QHostAddress getMulticastGroup() const { return multicastGroup; }
+    int getMulticastTtl() const { return multicastTtl; }
+    QString getMulticastInterface() const { return multicastInterfaceName; }
+
+    /**
+     * @brief Kernel socket buffer sizes in bytes, 0 keeps the system default
+     *
+     * A receive buffer that holds a few seconds of the link rides out a
+     * stalled I/O thread instead of dropping datagrams. Linux doubles the
+     * value and caps it at net.core.rmem_max (wmem_max), the size the
+     * kernel settled on is logged at connect.
+     */
+    void setSocketBuffers(int receiveBytes, int sendBytes = 0);
+    int getReceiveBufferSize() const { return rxBufferBytes; }
+    int getSendBufferSize() const { return txBufferBytes; }
+    /** @brief Datagrams the kernel dropped on a full receive buffer since connect, 0 where unknown */
+    quint32 getReceiveOverflows() const { return static_cast<quint32>(rxOverflows.loadAcquire()); }
 
     // Extensive statistics for scientific purposes
     qint64 getConnectionSpeed() const;
-    qint64 getCurrentInDataRate() const;
-    qint64 getCurrentOutDataRate() const;
 
     void run();
 
@@ -114,15 +145,67 @@ protected:
     int id;
     QUdpSocket* socket;
     bool connectState;
-    QList<QHostAddress> hosts;
-    QList<quint16> ports;
 
-    QMutex dataMutex;
+    /** @brief A system messages are sent to */
+    struct Peer
+    {
+        QHostAddress address;
+        quint16 port;
+        qint64 lastSeen;            ///< ms since epoch of its last datagram
+        bool configured;            ///< Added with addHost(), never expires
+        QByteArray native;          ///< sockaddr for sendmmsg(), empty if not available
+    };
+    QVector<Peer> peers;
+    QHash<QHostAddress, int> peerIndex; ///< Address to index into peers
+    qint64 lastPrune;
+    int socketFamily;               ///< Address family of the bound socket, 0 if unknown
+    QHostAddress multicastGroup;    ///< Null for unicast
+    int multicastTtl;
+    QString multicastInterfaceName;
+    int rxBufferBytes;              ///< SO_RCVBUF asked for, 0 for the default
+    int txBufferBytes;              ///< SO_SNDBUF asked for, 0 for the default
+
+    typedef QPair<QString, quint16> PendingHost;
+    QHash<int, PendingHost> pendingLookups;     ///< Lookup id to host name and port
+    QHash<QString, QHostAddress> resolvedHosts; ///< What the names of configured peers looked up to
+
+    mutable QMutex dataMutex;       ///< Guards socket, peers and lookups, which the UI thread reads and adds to
 
     void setName(QString name);
+    void updateName();
 
-private:
+private slots:
+    /** @brief Create and bind the socket, on the link's thread */
 	bool hardwareConnect(void);
+    void hardwareDisconnect();
+    /** @brief writeBytes() from another thread */
+    void writeQueued(QByteArray data);
+    /** @brief A lookup addHost() started came back */
+    void hostLookedUp(const QHostInfo& info);
+
+private:
+    /** @brief A receive buffer no receiver holds on to any more */
+    QByteArray& rxBuffer();
+    /** @brief Append further pending datagrams to data, returns the bytes added */
+    int receiveBatch(char* data, int space, int* count);
+    /** @brief GroundClock::nsecs() the kernel received the next datagram at, 0 if not known */
+    qint64 peekReceiveTime();
+    void noteOverflows(quint32 overflows);
+    void setSocketOptions();
+    void notePeer(const QHostAddress& sender, quint16 senderPort);
+    void setPeer(const QHostAddress& address, quint16 peerPort, qint64 now, bool configured);
+    void removePeer(int index);
+    /** @brief Forget learned peers that went quiet */
+    void prunePeers(qint64 now);
+    void updateNativeAddress(Peer& peer) const;
+    /** @brief Send one datagram to every peer, returns how many went out */
+    int sendToPeers(const char* data, qint64 size);
+
+    enum { RxBuffers = 4 };
+    QByteArray rxBuffers[RxBuffers]; ///< Reused once the parser released them
+    QByteArray rxSpare;              ///< When all of rxBuffers are still queued
+    qint64 rxTime;                   ///< Time the current batch is read at
+    QAtomicInt rxOverflows;          ///< SO_RXQ_OVFL of the socket, read by the UI thread
 
 signals:
     //Signals are defined by LinkInterface
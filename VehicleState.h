@@ -0,0 +1,112 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief VehicleState
+ *          The decoded state of one vehicle as VehicleStateSnapshot keeps it.
+ *          Plain C++ without Qt, since the same struct is the layout of the
+ *          shared memory companion apps read, see SharedTelemetryLayout.h.
+ *          Fields are only ever appended, and SharedTelemetryLayout's
+ *          version changes when the layout does.
+ *
+ */
+
+#ifndef VEHICLESTATE_H
+#define VEHICLESTATE_H
+
+#include <stdint.h>
+
+/** @brief The state, POD so a snapshot is one memcpy. Units as in the overviews. */
+struct VehicleState
+{
+    enum Section {
+        HasHeartbeat = 1u << 0,
+        HasSysStatus = 1u << 1,
+        HasAttitude = 1u << 2,
+        HasVfrHud = 1u << 3,
+        HasGpsRaw = 1u << 4,
+        HasGlobalPosition = 1u << 5,
+        HasHome = 1u << 6
+    };
+
+    uint32_t sections;              ///< Section bits of what was received
+    uint32_t updates;               ///< Messages applied, tells two snapshots apart
+    int64_t updatedMs;              ///< Ground wall time of the last message, see GroundClock
+
+    // HEARTBEAT
+    uint32_t customMode;
+    uint8_t type;
+    uint8_t autopilot;
+    uint8_t baseMode;
+    uint8_t systemStatus;
+
+    // SYS_STATUS
+    uint16_t voltageBattery;        ///< mV
+    int16_t currentBattery;         ///< 10 mA, -1 unknown
+    int8_t batteryRemaining;        ///< %, -1 unknown
+    uint16_t dropRateComm;          ///< 0.01 %
+
+    // ATTITUDE, degrees and degrees/s
+    uint32_t attitudeTimeBootMs;
+    float roll;
+    float pitch;
+    float yaw;
+    float rollspeed;
+    float pitchspeed;
+    float yawspeed;
+
+    // VFR_HUD
+    float airspeed;
+    float groundspeed;
+    float alt;
+    float climb;
+    int16_t heading;                ///< degrees
+    uint16_t throttle;              ///< %
+
+    // GPS_RAW_INT
+    uint8_t fixType;
+    uint8_t satellitesVisible;
+    uint16_t eph;                   ///< cm
+    uint16_t epv;                   ///< cm
+
+    // GLOBAL_POSITION_INT
+    double lat;                     ///< degrees
+    double lon;                     ///< degrees
+    float altMsl;                   ///< m
+    float relativeAlt;              ///< m
+    float vx;                       ///< m/s
+    float vy;
+    float vz;
+
+    // Derived, see DerivedMetrics
+    double homeLat;                 ///< degrees, where the vehicle was armed
+    double homeLon;
+    float distTraveled;             ///< m, while armed
+    float distToHome;               ///< m
+    float azToMav;                  ///< degrees, bearing from home to the vehicle
+    float timeInAir;                ///< s, while armed and active
+    float watts;                    ///< W, 0 without a current sensor
+    float energyUsed;               ///< Wh
+};
+
+#endif // VEHICLESTATE_H
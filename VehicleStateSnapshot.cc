@@ -0,0 +1,144 @@
+#include "VehicleStateSnapshot.h"
+#include "QGC.h"
+
+#include <string.h>
+
+#define ToDeg(x) ((x)*57.2957795131f)
+
+VehicleStateSnapshot::VehicleStateSnapshot() :
+    m_latest(0)
+{
+    memset(&m_working, 0, sizeof(m_working));
+    m_working.currentBattery = -1;
+    m_working.batteryRemaining = -1;
+    for (int i = 0; i < 2; i++)
+    {
+        m_slots[i].sequence.store(0);
+        m_slots[i].state = m_working;
+    }
+}
+
+bool VehicleStateSnapshot::apply(const mavlink_message_t &message, quint64 receivedMs)
+{
+    VehicleState &s = m_working;
+    quint32 section;
+    switch (message.msgid)
+    {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        s.customMode = heartbeat.custom_mode;
+        s.type = heartbeat.type;
+        s.autopilot = heartbeat.autopilot;
+        s.baseMode = heartbeat.base_mode;
+        s.systemStatus = heartbeat.system_status;
+        section = VehicleState::HasHeartbeat;
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t status;
+        mavlink_msg_sys_status_decode(&message, &status);
+        s.voltageBattery = status.voltage_battery;
+        s.currentBattery = status.current_battery;
+        s.batteryRemaining = status.battery_remaining;
+        s.dropRateComm = status.drop_rate_comm;
+        section = VehicleState::HasSysStatus;
+        break;
+    }
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        mavlink_attitude_t attitude;
+        mavlink_msg_attitude_decode(&message, &attitude);
+        s.attitudeTimeBootMs = attitude.time_boot_ms;
+        s.roll = ToDeg(attitude.roll);
+        s.pitch = ToDeg(attitude.pitch);
+        s.yaw = ToDeg(attitude.yaw);
+        s.rollspeed = ToDeg(attitude.rollspeed);
+        s.pitchspeed = ToDeg(attitude.pitchspeed);
+        s.yawspeed = ToDeg(attitude.yawspeed);
+        section = VehicleState::HasAttitude;
+        break;
+    }
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t hud;
+        mavlink_msg_vfr_hud_decode(&message, &hud);
+        s.airspeed = hud.airspeed;
+        s.groundspeed = hud.groundspeed;
+        s.alt = hud.alt;
+        s.climb = hud.climb;
+        s.heading = hud.heading;
+        s.throttle = hud.throttle;
+        section = VehicleState::HasVfrHud;
+        break;
+    }
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    {
+        mavlink_gps_raw_int_t gps;
+        mavlink_msg_gps_raw_int_decode(&message, &gps);
+        s.fixType = gps.fix_type;
+        s.satellitesVisible = gps.satellites_visible;
+        s.eph = gps.eph;
+        s.epv = gps.epv;
+        section = VehicleState::HasGpsRaw;
+        break;
+    }
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t position;
+        mavlink_msg_global_position_int_decode(&message, &position);
+        s.lat = position.lat / 1E7;
+        s.lon = position.lon / 1E7;
+        s.altMsl = position.alt / 1000.0f;
+        s.relativeAlt = position.relative_alt / 1000.0f;
+        s.vx = position.vx / 100.0f;
+        s.vy = position.vy / 100.0f;
+        s.vz = position.vz / 100.0f;
+        section = VehicleState::HasGlobalPosition;
+        break;
+    }
+    default:
+        return false;
+    }
+    s.sections |= section;
+    s.updates++;
+    s.updatedMs = receivedMs;
+    m_derived.update(s, section, s.updatedMs);
+    publish();
+    return true;
+}
+
+void VehicleStateSnapshot::publish()
+{
+    const int index = 1 - m_latest.load();
+    Slot &slot = m_slots[index];
+    // Ordered: the copy may neither start before the sequence turns odd nor
+    // end after it turns even again
+    slot.sequence.fetchAndAddOrdered(1);
+    memcpy(&slot.state, &m_working, sizeof(m_working));
+    slot.sequence.fetchAndAddOrdered(1);
+    m_latest.storeRelease(index);
+}
+
+bool VehicleStateSnapshot::read(VehicleState *state) const
+{
+    for (int attempt = 0; attempt < MaxReadAttempts; attempt++)
+    {
+        const Slot &slot = m_slots[m_latest.loadAcquire()];
+        const int before = slot.sequence.loadAcquire();
+        if (before & 1)
+        {
+            continue;
+        }
+        memcpy(state, &slot.state, sizeof(*state));
+        // A full barrier, so the copy's loads complete before the check
+        const int after = const_cast<QAtomicInt&>(slot.sequence).fetchAndAddOrdered(0);
+        if (after == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,85 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief VehicleStateSnapshot
+ *          Plain copy of the state of one vehicle, published by the ingest
+ *          thread as messages are parsed and read from any thread without
+ *          taking a lock, so readers need not run on the thread that
+ *          dispatches messages to the overview objects.
+ *
+ */
+
+#ifndef VEHICLESTATESNAPSHOT_H
+#define VEHICLESTATESNAPSHOT_H
+
+#include <QAtomicInt>
+#include <QtGlobal>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "DerivedMetrics.h"
+#include "VehicleState.h"
+
+/**
+ * @brief Double buffered seqlock around one VehicleState
+ *
+ * The single writer applies a message to its private copy and publishes it
+ * into the slot readers are not pointed at, then points them at it. Each
+ * slot has a sequence that is odd while it is written; a reader copies the
+ * latest slot and retries only if the writer lapped both slots during the
+ * copy, so reads are lock free and in practice never retry.
+ */
+class VehicleStateSnapshot
+{
+public:
+    enum { MaxReadAttempts = 4 };
+
+    VehicleStateSnapshot();
+
+    /** @brief Ingest thread only. Applies message received at receivedMs (GroundClock wall time),
+     *         publishes and returns true if it is one of the state messages */
+    bool apply(const mavlink_message_t &message, quint64 receivedMs);
+
+    /** @brief Ingest thread only. The state last published, without a copy */
+    const VehicleState &current() const { return m_working; }
+
+    /** @brief Any thread. False only if no consistent copy was had in MaxReadAttempts */
+    bool read(VehicleState *state) const;
+
+private:
+    VehicleStateSnapshot(const VehicleStateSnapshot&);
+    VehicleStateSnapshot& operator=(const VehicleStateSnapshot&);
+
+    void publish();
+
+    struct Slot
+    {
+        QAtomicInt sequence;
+        VehicleState state;
+    };
+    Slot m_slots[2];
+    QAtomicInt m_latest;        ///< Slot readers copy
+    VehicleState m_working;     ///< Writer only
+    DerivedMetrics m_derived;   ///< Writer only
+};
+
+#endif // VEHICLESTATESNAPSHOT_H
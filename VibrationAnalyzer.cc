@@ -0,0 +1,479 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief VibrationAnalyzer
+ *          See VibrationAnalyzer.h
+ *
+ */
+
+#include "VibrationAnalyzer.h"
+#include "UASInterface1.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkDispatcher.h"
+#include "QsLog.h"
+#include <QMetaObject>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VIBRATION_SIMD "NEON"
+typedef float32x4_t Vec4;
+static inline Vec4 load4(const float *p) { return vld1q_f32(p); }
+static inline void store4(float *p, Vec4 v) { vst1q_f32(p, v); }
+static inline Vec4 add4(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+static inline Vec4 sub4(Vec4 a, Vec4 b) { return vsubq_f32(a, b); }
+static inline Vec4 mul4(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define VIBRATION_SIMD "SSE"
+typedef __m128 Vec4;
+// Callers only pass 16 byte aligned addresses
+static inline Vec4 load4(const float *p) { return _mm_load_ps(p); }
+static inline void store4(float *p, Vec4 v) { _mm_store_ps(p, v); }
+static inline Vec4 add4(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+static inline Vec4 sub4(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+static inline Vec4 mul4(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+#endif
+
+static const int Alignment = 16;
+static const double Gravity = 9.80665;
+// Accelerometers of ArduPilot boards end at 16 g, a sample this close counts as clipped
+static const double ClipLimit = 0.98 * 16 * Gravity;
+// A gap this long restarts the window, spectra across it would be smeared
+static const double MaxGapSeconds = 0.5;
+static const float AverageWeight = 0.25f;
+
+static float *allocate(int count)
+{
+    float *data = static_cast<float*>(qMallocAligned(count * sizeof(float), Alignment));
+    memset(data, 0, count * sizeof(float));
+    return data;
+}
+
+VibrationSpectrum::VibrationSpectrum() :
+    m_input(allocate(3 * WindowSize)),
+    m_posted(false),
+    m_average(allocate(3 * Bins)),
+    m_windows(0),
+    m_re(allocate(WindowSize)),
+    m_im(allocate(WindowSize)),
+    m_window(allocate(WindowSize)),
+    m_twiddles(allocate(2 * WindowSize)),
+    m_scale(0)
+{
+    m_rms[0] = m_rms[1] = m_rms[2] = 0;
+    double sum = 0;
+    for (int i = 0; i < WindowSize; ++i)
+    {
+        m_window[i] = 0.5f - 0.5f * static_cast<float>(cos(2 * M_PI * i / WindowSize));
+        sum += m_window[i];
+    }
+    m_scale = static_cast<float>(2 / sum);
+
+    int bits = 0;
+    while ((1 << bits) < WindowSize)
+    {
+        ++bits;
+    }
+    for (int i = 0; i < WindowSize; ++i)
+    {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit)
+        {
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_reverse[i] = reversed;
+    }
+
+    // Stage h combines transforms of size h, its twiddles start at 2h so
+    // they are aligned from h = 4 on
+    for (int h = 1; h < WindowSize; h *= 2)
+    {
+        for (int j = 0; j < h; ++j)
+        {
+            m_twiddles[2 * h + j] = static_cast<float>(cos(M_PI * j / h));
+            m_twiddles[3 * h + j] = static_cast<float>(-sin(M_PI * j / h));
+        }
+    }
+}
+
+VibrationSpectrum::~VibrationSpectrum()
+{
+    qFreeAligned(m_input);
+    qFreeAligned(m_average);
+    qFreeAligned(m_re);
+    qFreeAligned(m_im);
+    qFreeAligned(m_window);
+    qFreeAligned(m_twiddles);
+}
+
+bool VibrationSpectrum::post(const float *const axes[3], int first, int mask)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_posted)
+    {
+        return false;
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float *input = m_input + axis * WindowSize;
+        for (int i = 0; i < WindowSize; ++i)
+        {
+            input[i] = axes[axis][(first + i) & mask];
+        }
+    }
+    m_posted = true;
+    return true;
+}
+
+void VibrationSpectrum::result(float *amplitude, float *rms, int *windows) const
+{
+    QMutexLocker locker(&m_mutex);
+    memcpy(amplitude, m_average, 3 * Bins * sizeof(float));
+    memcpy(rms, m_rms, sizeof(m_rms));
+    *windows = m_windows;
+}
+
+void VibrationSpectrum::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    memset(m_average, 0, 3 * Bins * sizeof(float));
+    m_rms[0] = m_rms[1] = m_rms[2] = 0;
+    m_windows = 0;
+}
+
+void VibrationSpectrum::process()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_posted)
+        {
+            return;
+        }
+    }
+    // post() leaves m_input alone until m_posted is cleared below
+    float amplitude[3][Bins];
+    float rms[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float *input = m_input + axis * WindowSize;
+        double sum = 0;
+        for (int i = 0; i < WindowSize; ++i)
+        {
+            sum += input[i];
+        }
+        // Gravity and offsets are the mean, the vibration is what is left
+        float mean = static_cast<float>(sum / WindowSize);
+        double power = 0;
+        for (int i = 0; i < WindowSize; ++i)
+        {
+            float value = input[m_reverse[i]] - mean;
+            m_re[i] = value * m_window[m_reverse[i]];
+            m_im[i] = 0;
+            power += value * value;
+        }
+        rms[axis] = static_cast<float>(sqrt(power / WindowSize));
+        transform(m_re, m_im);
+        for (int k = 0; k < Bins; ++k)
+        {
+            amplitude[axis][k] = m_scale * sqrtf(m_re[k] * m_re[k] + m_im[k] * m_im[k]);
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_posted = false;
+        float weight = m_windows == 0 ? 1.0f : AverageWeight;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float *average = m_average + axis * Bins;
+            for (int k = 0; k < Bins; ++k)
+            {
+                average[k] += weight * (amplitude[axis][k] - average[k]);
+            }
+            m_rms[axis] += weight * (rms[axis] - m_rms[axis]);
+        }
+        ++m_windows;
+    }
+    emit ready();
+}
+
+/**
+ * In place radix 2 FFT of input in bit reversed order, real and imaginary
+ * parts in separate arrays so four butterflies of a stage are one vector
+ * operation each.
+ */
+void VibrationSpectrum::transform(float *re, float *im) const
+{
+    for (int h = 1; h < WindowSize; h *= 2)
+    {
+        const float *wr = m_twiddles + 2 * h;
+        const float *wi = m_twiddles + 3 * h;
+        for (int k = 0; k < WindowSize; k += 2 * h)
+        {
+            int j = 0;
+#ifdef VIBRATION_SIMD
+            for (; h >= 4 && j < h; j += 4)
+            {
+                int a = k + j;
+                int b = a + h;
+                Vec4 cr = load4(wr + j);
+                Vec4 ci = load4(wi + j);
+                Vec4 xr = load4(re + b);
+                Vec4 xi = load4(im + b);
+                Vec4 tr = sub4(mul4(xr, cr), mul4(xi, ci));
+                Vec4 ti = add4(mul4(xr, ci), mul4(xi, cr));
+                Vec4 ur = load4(re + a);
+                Vec4 ui = load4(im + a);
+                store4(re + a, add4(ur, tr));
+                store4(im + a, add4(ui, ti));
+                store4(re + b, sub4(ur, tr));
+                store4(im + b, sub4(ui, ti));
+            }
+#endif
+            for (; j < h; ++j)
+            {
+                int a = k + j;
+                int b = a + h;
+                float tr = re[b] * wr[j] - im[b] * wi[j];
+                float ti = re[b] * wi[j] + im[b] * wr[j];
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+
+VibrationAnalyzer::VibrationAnalyzer(QObject *parent) :
+    QObject(parent),
+    m_spectrumWorker(new VibrationSpectrum),
+    m_source(NoSource),
+    m_written(0),
+    m_sinceWindow(0),
+    m_lastTimeUs(0),
+    m_interval(0),
+    m_sampleRate(0),
+    m_windows(0),
+    m_peakFrequency(0),
+    m_peakAmplitude(0)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        m_ring[axis] = allocate(RingSize);
+        m_vibration[axis] = 0;
+        m_clipping[axis] = 0;
+    }
+    m_spectrumWorker->moveToThread(&m_thread);
+    connect(m_spectrumWorker, SIGNAL(ready()), this, SLOT(spectrumReady()));
+#ifdef VIBRATION_SIMD
+    QLOG_DEBUG() << "Vibration FFT uses" << VIBRATION_SIMD;
+#endif
+}
+
+VibrationAnalyzer::~VibrationAnalyzer()
+{
+    m_thread.quit();
+    m_thread.wait();
+    delete m_spectrumWorker;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        qFreeAligned(m_ring[axis]);
+    }
+}
+
+void VibrationAnalyzer::setUas(UASInterface *uas)
+{
+    if (m_uas == uas)
+    {
+        return;
+    }
+    MAVLinkDispatcher *dispatcher = LinkManager::instance()->getMavlinkProtocol()->dispatcher();
+    if (m_uas)
+    {
+        disconnect(m_uas, 0, this, 0);
+        dispatcher->unsubscribe(this);
+    }
+    m_uas = uas;
+    reset();
+    if (m_uas)
+    {
+        // Read through UAS's signals, so the stream negotiation has to be told
+        dispatcher->require(m_uas->getUASID(), MAVLINK_MSG_ID_RAW_IMU, this);
+        dispatcher->require(m_uas->getUASID(), MAVLINK_MSG_ID_SCALED_IMU, this);
+        dispatcher->require(m_uas->getUASID(), MAVLINK_MSG_ID_HIGHRES_IMU, this);
+        connect(m_uas, SIGNAL(rawImuMessageUpdate(UASInterface*,mavlink_raw_imu_t)),
+                this, SLOT(rawImu(UASInterface*,mavlink_raw_imu_t)));
+        connect(m_uas, SIGNAL(scaledImuMessageUpdate(UASInterface*,mavlink_scaled_imu_t)),
+                this, SLOT(scaledImu(UASInterface*,mavlink_scaled_imu_t)));
+        connect(m_uas, SIGNAL(highresImuMessageUpdate(UASInterface*,mavlink_highres_imu_t)),
+                this, SLOT(highresImu(UASInterface*,mavlink_highres_imu_t)));
+    }
+}
+
+void VibrationAnalyzer::reset()
+{
+    m_spectrumWorker->reset();
+    m_source = NoSource;
+    m_written = 0;
+    m_sinceWindow = 0;
+    m_lastTimeUs = 0;
+    m_interval = 0;
+    m_sampleRate = 0;
+    m_windows = 0;
+    m_peakFrequency = 0;
+    m_peakAmplitude = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        m_spectrum[axis].clear();
+        m_vibration[axis] = 0;
+        m_clipping[axis] = 0;
+    }
+    emit spectrumChanged();
+    emit clippingChanged();
+}
+
+void VibrationAnalyzer::rawImu(UASInterface *uas, mavlink_raw_imu_t imu)
+{
+    Q_UNUSED(uas);
+    // ArduPilot sends RAW_IMU acceleration in milli g like SCALED_IMU
+    const float scale = static_cast<float>(Gravity / 1000);
+    addSample(RawImu, imu.time_usec, imu.xacc * scale, imu.yacc * scale, imu.zacc * scale);
+}
+
+void VibrationAnalyzer::scaledImu(UASInterface *uas, mavlink_scaled_imu_t imu)
+{
+    Q_UNUSED(uas);
+    const float scale = static_cast<float>(Gravity / 1000);
+    addSample(ScaledImu, quint64(imu.time_boot_ms) * 1000, imu.xacc * scale, imu.yacc * scale, imu.zacc * scale);
+}
+
+void VibrationAnalyzer::highresImu(UASInterface *uas, mavlink_highres_imu_t imu)
+{
+    Q_UNUSED(uas);
+    addSample(HighresImu, imu.time_usec, imu.xacc, imu.yacc, imu.zacc);
+}
+
+void VibrationAnalyzer::addSample(Source source, quint64 timeUs, float x, float y, float z)
+{
+    if (source < m_source)
+    {
+        return;
+    }
+    bool restart = source != m_source;
+    m_source = source;
+    if (!restart && timeUs == m_lastTimeUs)
+    {
+        // The same sample twice, e.g. over two links
+        return;
+    }
+    double dt = (static_cast<qint64>(timeUs - m_lastTimeUs)) / 1e6;
+    if (!restart && (dt <= 0 || dt > MaxGapSeconds))
+    {
+        restart = true;
+    }
+    m_lastTimeUs = timeUs;
+    if (restart)
+    {
+        m_written = 0;
+        m_sinceWindow = 0;
+    }
+    else
+    {
+        m_interval = m_interval == 0 ? dt : 0.95 * m_interval + 0.05 * dt;
+    }
+
+    const float sample[3] = { x, y, z };
+    bool clipped = false;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        m_ring[axis][m_written & (RingSize - 1)] = sample[axis];
+        if (qAbs(sample[axis]) >= ClipLimit)
+        {
+            ++m_clipping[axis];
+            clipped = true;
+        }
+    }
+    ++m_written;
+    if (clipped)
+    {
+        emit clippingChanged();
+    }
+
+    if (m_written < WindowSize || ++m_sinceWindow < HopSize)
+    {
+        return;
+    }
+    m_sinceWindow = 0;
+    const float *const axes[3] = { m_ring[0], m_ring[1], m_ring[2] };
+    // A window the worker has no time for is skipped, the next one is as good
+    if (!m_spectrumWorker->post(axes, m_written - WindowSize, RingSize - 1))
+    {
+        return;
+    }
+    if (!m_thread.isRunning())
+    {
+        m_thread.start(QThread::LowPriority);
+    }
+    QMetaObject::invokeMethod(m_spectrumWorker, "process", Qt::QueuedConnection);
+}
+
+void VibrationAnalyzer::spectrumReady()
+{
+    float amplitude[3 * Bins];
+    float rms[3];
+    int windows;
+    m_spectrumWorker->result(amplitude, rms, &windows);
+    if (windows == 0)
+    {
+        // Reset while the window was on the worker
+        return;
+    }
+    m_windows = windows;
+    m_sampleRate = m_interval > 0 ? 1 / m_interval : 0;
+    m_peakFrequency = 0;
+    m_peakAmplitude = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        QVariantList &spectrum = m_spectrum[axis];
+        spectrum.clear();
+        spectrum.reserve(Bins);
+        for (int k = 0; k < Bins; ++k)
+        {
+            float value = amplitude[axis * Bins + k];
+            spectrum.append(value);
+            if (k > 0 && value > m_peakAmplitude)
+            {
+                m_peakAmplitude = value;
+                m_peakFrequency = k * binWidth();
+            }
+        }
+        m_vibration[axis] = rms[axis];
+    }
+    emit spectrumChanged();
+}
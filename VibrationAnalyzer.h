@@ -0,0 +1,180 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief VibrationAnalyzer
+ *          Spectra of the accelerometer stream of the active vehicle, for a
+ *          pre-flight vibration check on the tablet. IMU samples go into one
+ *          aligned ring per axis; every HopSize samples the last WindowSize
+ *          are handed to a worker thread, which removes the mean, applies a
+ *          Hann window and runs a radix 2 FFT with NEON or SSE butterflies
+ *          where available. The magnitudes are averaged over windows and
+ *          published with the RMS level, the strongest peak and the number
+ *          of samples at the accelerometer's range.
+ *
+ */
+
+#ifndef VIBRATIONANALYZER_H
+#define VIBRATIONANALYZER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QPointer>
+#include <QThread>
+#include <QVariantList>
+#include "QGCMAVLink.h"
+
+class UASInterface;
+
+/** @brief Fixed size FFT of three axes, runs on the analyzer's worker thread */
+class VibrationSpectrum : public QObject
+{
+    Q_OBJECT
+public:
+    enum { WindowSize = 256, Bins = WindowSize / 2 };
+
+    VibrationSpectrum();
+    ~VibrationSpectrum();
+
+    /** @brief Any thread, copies the window in; false while the last one is not taken */
+    bool post(const float *const axes[3], int first, int mask);
+    /** @brief Any thread, averaged over windows: per axis Bins amplitudes and the RMS */
+    void result(float *amplitude, float *rms, int *windows) const;
+    void reset();
+
+public slots:
+    void process();
+
+signals:
+    void ready();
+
+private:
+    Q_DISABLE_COPY(VibrationSpectrum)
+
+    void transform(float *re, float *im) const;
+
+    // window handed over, under m_mutex
+    mutable QMutex m_mutex;
+    float *m_input;             ///< 3 * WindowSize, 16 byte aligned
+    bool m_posted;
+    float *m_average;           ///< 3 * Bins
+    float m_rms[3];
+    int m_windows;
+
+    // worker thread only
+    float *m_re;
+    float *m_im;
+    float *m_window;            ///< Hann coefficients
+    float *m_twiddles;          ///< cos and -sin of stage h at 2h and 2h + h, see transform
+    int m_reverse[WindowSize];
+    float m_scale;              ///< Amplitude of a full scale sine from its bin
+};
+
+class VibrationAnalyzer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(double sampleRate READ sampleRate NOTIFY spectrumChanged)
+    Q_PROPERTY(double binWidth READ binWidth NOTIFY spectrumChanged)
+    Q_PROPERTY(int windows READ windows NOTIFY spectrumChanged)
+    Q_PROPERTY(QVariantList spectrumX READ spectrumX NOTIFY spectrumChanged)
+    Q_PROPERTY(QVariantList spectrumY READ spectrumY NOTIFY spectrumChanged)
+    Q_PROPERTY(QVariantList spectrumZ READ spectrumZ NOTIFY spectrumChanged)
+    Q_PROPERTY(double vibrationX READ vibrationX NOTIFY spectrumChanged)
+    Q_PROPERTY(double vibrationY READ vibrationY NOTIFY spectrumChanged)
+    Q_PROPERTY(double vibrationZ READ vibrationZ NOTIFY spectrumChanged)
+    Q_PROPERTY(double peakFrequency READ peakFrequency NOTIFY spectrumChanged)
+    Q_PROPERTY(double peakAmplitude READ peakAmplitude NOTIFY spectrumChanged)
+    Q_PROPERTY(int clippingX READ clippingX NOTIFY clippingChanged)
+    Q_PROPERTY(int clippingY READ clippingY NOTIFY clippingChanged)
+    Q_PROPERTY(int clippingZ READ clippingZ NOTIFY clippingChanged)
+public:
+    enum {
+        WindowSize = VibrationSpectrum::WindowSize,
+        Bins = VibrationSpectrum::Bins,
+        HopSize = WindowSize / 2,
+        RingSize = 2 * WindowSize       ///< power of two
+    };
+
+    explicit VibrationAnalyzer(QObject *parent = 0);
+    ~VibrationAnalyzer();
+
+    /** @brief Analyze the accelerometer of uas, null stops */
+    void setUas(UASInterface *uas);
+    /** @brief Forget spectra, levels and clipping counts */
+    Q_INVOKABLE void reset();
+
+    double sampleRate() const { return m_sampleRate; }
+    double binWidth() const { return m_sampleRate / WindowSize; }
+    int windows() const { return m_windows; }
+    /** @brief Amplitude per bin in m/s/s, bin i is at i * binWidth Hz */
+    QVariantList spectrumX() const { return m_spectrum[0]; }
+    QVariantList spectrumY() const { return m_spectrum[1]; }
+    QVariantList spectrumZ() const { return m_spectrum[2]; }
+    /** @brief RMS of the acceleration around its mean, m/s/s */
+    double vibrationX() const { return m_vibration[0]; }
+    double vibrationY() const { return m_vibration[1]; }
+    double vibrationZ() const { return m_vibration[2]; }
+    /** @brief The strongest bin of any axis, DC excluded */
+    double peakFrequency() const { return m_peakFrequency; }
+    double peakAmplitude() const { return m_peakAmplitude; }
+    /** @brief Samples at the range of the accelerometer, per axis */
+    int clippingX() const { return m_clipping[0]; }
+    int clippingY() const { return m_clipping[1]; }
+    int clippingZ() const { return m_clipping[2]; }
+
+signals:
+    void spectrumChanged();
+    void clippingChanged();
+
+private slots:
+    void rawImu(UASInterface *uas, mavlink_raw_imu_t imu);
+    void scaledImu(UASInterface *uas, mavlink_scaled_imu_t imu);
+    void highresImu(UASInterface *uas, mavlink_highres_imu_t imu);
+    void spectrumReady();
+
+private:
+    /** @brief The stream the samples come from, the best one seen wins */
+    enum Source { NoSource, RawImu, ScaledImu, HighresImu };
+
+    void addSample(Source source, quint64 timeUs, float x, float y, float z);
+
+    QPointer<UASInterface> m_uas;
+    VibrationSpectrum *m_spectrumWorker;
+    QThread m_thread;
+
+    Source m_source;
+    float *m_ring[3];           ///< RingSize each, 16 byte aligned
+    int m_written;              ///< Samples written since the reset, the ring position is this & mask
+    int m_sinceWindow;
+    quint64 m_lastTimeUs;
+    double m_interval;          ///< Average sample interval in seconds
+    double m_sampleRate;
+    int m_windows;
+    QVariantList m_spectrum[3];
+    double m_vibration[3];
+    double m_peakFrequency;
+    double m_peakAmplitude;
+    int m_clipping[3];
+};
+
+#endif // VIBRATIONANALYZER_H
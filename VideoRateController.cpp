@@ -0,0 +1,122 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VideoRateController.h"
+#include "GStreamerPlayer.h"
+#include "UASInterface1.h"
+#include <QDebug>
+
+// Terminated by a zero bitrate entry
+const VideoRateController::Step VideoRateController::Ladder[] =
+{
+    { 4000, 1920, 1080 },
+    { 2500, 1280, 720 },
+    { 1500, 1280, 720 },
+    { 800, 854, 480 },
+    { 400, 640, 360 },
+    { 0, 0, 0 }
+};
+
+VideoRateController::VideoRateController(GStreamerPlayer *player, QObject *parent)
+    : QObject(parent),
+      m_player(player),
+      m_uas(NULL),
+      m_enabled(false),
+      m_step(0),
+      m_cleanSamples(0),
+      m_lastLost(0),
+      m_telemetryAverage(0)
+{
+}
+
+void VideoRateController::setUas(UASInterface *uas)
+{
+    m_uas = uas;
+    m_telemetryAverage = 0;
+    m_lastChange.invalidate();
+}
+
+void VideoRateController::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+    m_cleanSamples = 0;
+    emit enabledChanged(m_enabled);
+
+    // Hand the encoder back its best setting when the controller lets go
+    if (!m_enabled) setStep(0);
+}
+
+void VideoRateController::sample(int telemetryInRate)
+{
+    GStreamerStats *stats = static_cast<GStreamerStats*>(m_player->getStats());
+    quint64 lost = stats->getJitterLost();
+    quint64 newLost = lost >= m_lastLost ? lost - m_lastLost : 0;
+    m_lastLost = lost;
+
+    if (!m_enabled || m_uas == NULL || !m_player->getPlaying()) return;
+
+    // The telemetry shares the radio, a sudden drop of its rate means the link is saturated
+    bool telemetryStarved = m_telemetryAverage > 0 && telemetryInRate < m_telemetryAverage / 2;
+    m_telemetryAverage = m_telemetryAverage > 0 ? m_telemetryAverage * 0.95 + telemetryInRate * 0.05 : telemetryInRate;
+
+    // Less than 70% of the requested rate arriving means packets are lost before RTP sees them
+    int received = stats->getBitrateKbps();
+    bool underrun = received > 0 && received < getBitrateKbps() * 7 / 10;
+
+    bool congested = newLost > LossThreshold || telemetryStarved || underrun;
+    bool settled = !m_lastChange.isValid() || m_lastChange.elapsed() >= HoldOffMs;
+
+    if (congested)
+    {
+        m_cleanSamples = 0;
+        if (settled && Ladder[m_step + 1].bitrateKbps != 0)
+        {
+            qDebug() << "Video link congested (lost" << newLost << ", received" << received
+                     << "kbit/s, telemetry" << telemetryInRate << "B/s), stepping down";
+            setStep(m_step + 1);
+        }
+    }
+    else if (++m_cleanSamples >= RecoverSamples && settled && m_step > 0)
+    {
+        m_cleanSamples = 0;
+        setStep(m_step - 1);
+    }
+}
+
+void VideoRateController::setStep(int step)
+{
+    if (step == m_step) return;
+    m_step = step;
+    m_lastChange.start();
+    sendStep();
+    emit rateChanged();
+}
+
+void VideoRateController::sendStep()
+{
+    if (m_uas == NULL) return;
+
+    const Step & step = Ladder[m_step];
+    qDebug() << "Requesting video" << step.width << "x" << step.height << "at" << step.bitrateKbps << "kbit/s";
+
+    // Camera -1 (all), transmission enabled compressed, video stream, recording left
+    // unchanged (-1); params 5-7 carry the encoder setting
+    m_uas->executeCommand(MAV_CMD_DO_CONTROL_VIDEO, 0, -1, 1, 0, -1,
+                          step.bitrateKbps, step.width, step.height, MAV_COMP_ID_CAMERA);
+}
@@ -0,0 +1,96 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VideoRateController_H
+#define VideoRateController_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class GStreamerPlayer;
+class UASInterface;
+
+/**
+ * @brief Closed loop video bitrate/resolution control of the air side encoder
+ *
+ * Once per stats sample the RTP loss, the received video bitrate and the
+ * MAVLink receive rate are checked. Congestion steps the encoder one rung
+ * down the ladder right away, a run of clean samples steps it back up.
+ * Requests go out as MAV_CMD_DO_CONTROL_VIDEO to the camera component with
+ * the bitrate (kbit/s), width and height in params 5-7, which the companion
+ * computer applies to its encoder.
+ */
+class VideoRateController : public QObject
+{
+    Q_OBJECT
+public:
+    Q_PROPERTY(bool enabled READ getEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int bitrateKbps READ getBitrateKbps NOTIFY rateChanged)
+    Q_PROPERTY(int width READ getWidth NOTIFY rateChanged)
+    Q_PROPERTY(int height READ getHeight NOTIFY rateChanged)
+
+    /** @brief One encoder setting, the ladder is ordered best first */
+    struct Step
+    {
+        int bitrateKbps;
+        int width;
+        int height;
+    };
+
+    explicit VideoRateController(GStreamerPlayer *player, QObject *parent = 0);
+
+    void setUas(UASInterface *uas);
+
+    bool getEnabled() { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    int getBitrateKbps() { return Ladder[m_step].bitrateKbps; }
+    int getWidth() { return Ladder[m_step].width; }
+    int getHeight() { return Ladder[m_step].height; }
+
+    /** @brief Run one control step, called after each video stats sample */
+    void sample(int telemetryInRate);
+
+signals:
+    void enabledChanged(bool);
+    void rateChanged();
+
+private:
+    enum
+    {
+        LossThreshold = 5,          ///< New lost packets per sample counted as congestion
+        RecoverSamples = 10,        ///< Clean samples before stepping up again
+        HoldOffMs = 3000            ///< Let the encoder settle between two changes
+    };
+
+    static const Step Ladder[];
+
+    void setStep(int step);
+    void sendStep();
+
+    GStreamerPlayer *m_player;
+    UASInterface *m_uas;
+    bool m_enabled;
+    int m_step;
+    int m_cleanSamples;
+    quint64 m_lastLost;
+    double m_telemetryAverage;  ///< Slow moving average of the MAVLink receive rate
+    QElapsedTimer m_lastChange;
+};
+
+#endif // VideoRateController_H
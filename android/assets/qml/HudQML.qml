@@ -218,7 +218,7 @@ Rectangle {
 		{
 			id: play
 			enabled: player.stopped || player.paused
-			iconSource: "../resources/components/primaryFlightDisplay/play.svg"
+			iconSource: "image://hud/primaryFlightDisplay/play.svg"
 			tooltip: "Play"
 			onTriggered: player.playing = true
 		}
@@ -227,7 +227,7 @@ Rectangle {
 		{
 			id: pause
 			enabled: player.playing
-			iconSource: "../resources/components/primaryFlightDisplay/pause.svg"
+			iconSource: "image://hud/primaryFlightDisplay/pause.svg"
 			tooltip: "Pause"
 			onTriggered: player.paused = true
 		}
@@ -236,7 +236,7 @@ Rectangle {
 		{
 			id: stop
 			enabled: player.playing
-			iconSource: "../resources/components/primaryFlightDisplay/stop.svg"
+			iconSource: "image://hud/primaryFlightDisplay/stop.svg"
 			tooltip: "Stop"
 			onTriggered: player.stopped = true
 		}
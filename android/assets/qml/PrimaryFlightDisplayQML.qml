@@ -41,29 +41,30 @@ Rectangle {
 	Binding { target: root; property: "enableConnect"; value: container.uasConnected }
 	
     function activeUasSet() {
-		rollPitchIndicator.rollAngle = Qt.binding(function() { return relpositionoverview.roll})
-        rollPitchIndicator.pitchAngle = Qt.binding(function() { return  relpositionoverview.pitch})
-        pitchIndicator.rollAngle = Qt.binding(function() { return relpositionoverview.roll})
-        pitchIndicator.pitchAngle = Qt.binding(function() { return  relpositionoverview.pitch})
-        speedIndicator.groundspeed = Qt.binding(function() { return relpositionoverview.groundspeed})
-        informationIndicator.groundSpeed = Qt.binding(function() { return relpositionoverview.groundspeed})
-        informationIndicator.airSpeed = Qt.binding(function() { return relpositionoverview.airspeed })
-        informationIndicator.batVoltage = Qt.binding(function() { return vehicleoverview.voltage_battery/1000.0 })
-        informationIndicator.batCurrent = Qt.binding(function() { return vehicleoverview.current_battery/100.0 })
-        informationIndicator.batPercent = Qt.binding(function() { return vehicleoverview.battery_remaining })
-		informationIndicator.lat = Qt.binding(function() { return abspositionoverview.lat})
-		informationIndicator.lng = Qt.binding(function() { return abspositionoverview.lon})
-		informationIndicator.satcount = Qt.binding(function() { return abspositionoverview.satellites_visible})
+		rollPitchIndicator.rollAngle = Qt.binding(function() { return activeVehicle.relPosition.roll})
+        rollPitchIndicator.pitchAngle = Qt.binding(function() { return  activeVehicle.relPosition.pitch})
+        rollPitchIndicator.horizonMatrix = Qt.binding(function() { return activeVehicle.relPosition.horizon})
+        pitchIndicator.rollAngle = Qt.binding(function() { return activeVehicle.relPosition.roll})
+        pitchIndicator.pitchAngle = Qt.binding(function() { return  activeVehicle.relPosition.pitch})
+        speedIndicator.groundspeed = Qt.binding(function() { return activeVehicle.relPosition.groundspeed})
+        informationIndicator.groundSpeed = Qt.binding(function() { return activeVehicle.relPosition.groundspeed})
+        informationIndicator.airSpeed = Qt.binding(function() { return activeVehicle.relPosition.airspeed })
+        informationIndicator.batVoltage = Qt.binding(function() { return activeVehicle.vehicle.sys_status.voltage_battery/1000.0 })
+        informationIndicator.batCurrent = Qt.binding(function() { return activeVehicle.vehicle.sys_status.current_battery/100.0 })
+        informationIndicator.batPercent = Qt.binding(function() { return activeVehicle.vehicle.sys_status.battery_remaining })
+		informationIndicator.lat = Qt.binding(function() { return activeVehicle.absPosition.lat})
+		informationIndicator.lng = Qt.binding(function() { return activeVehicle.absPosition.lon})
+		informationIndicator.satcount = Qt.binding(function() { return activeVehicle.absPosition.satellites_visible})
 
         compassIndicator.heading = Qt.binding(function() {
-            return (relpositionoverview.yaw < 0) ? relpositionoverview.yaw + 360 : relpositionoverview.yaw ;
+            return (activeVehicle.relPosition.yaw < 0) ? activeVehicle.relPosition.yaw + 360 : activeVehicle.relPosition.yaw ;
         })
-        speedIndicator.airspeed = Qt.binding(function() { return relpositionoverview.airspeed } )
-        altIndicator.alt = Qt.binding(function() { return abspositionoverview.relative_alt } )
+        speedIndicator.airspeed = Qt.binding(function() { return activeVehicle.relPosition.airspeed } )
+        altIndicator.alt = Qt.binding(function() { return activeVehicle.absPosition.relative_alt } )
 	
 		informationIndicator.gpsstatus = Qt.binding(function() 
 		{ 
-			switch (abspositionoverview.fix_type)
+			switch (activeVehicle.absPosition.fix_type)
 			{
 				case 0:
 				case 1:
@@ -101,6 +102,8 @@ Rectangle {
 	
 	Component.onCompleted:
 	{
+		// Installed once, a vehicle change swaps what activeVehicle reads from
+		activeUasSet()
 		rollPitchIndicator.enableRollPitch = Settings.get("enableRollPitchIndicator", true) == 0 ? false : true
 		pitchIndicator.visible = Settings.get("enablePitchIndicator", true) == 0 ? false : true
 		altIndicator.visible = Settings.get("enableAltIndicator", true) == 0 ? false : true
@@ -362,7 +365,7 @@ Rectangle {
 		{
 			id: connect
 			enabled: !container.uasConnected
-			iconSource: "./resources/components/primaryFlightDisplay/connect.svg"
+			iconSource: "image://hud/primaryFlightDisplay/connect.svg"
 			tooltip: "Connect to MavLink"
 			onTriggered: 
 			{
@@ -375,7 +378,7 @@ Rectangle {
 		{
 			id: disconnect
 			enabled: container.uasConnected
-			iconSource: "./resources/components/primaryFlightDisplay/disconnect.svg"
+			iconSource: "image://hud/primaryFlightDisplay/disconnect.svg"
 			tooltip: "Disconnect from MavLink"
 			onTriggered: 
 			{
@@ -446,7 +449,7 @@ Rectangle {
                     {
                         anchors.horizontalCenter: parent.horizontalCenter;
                         anchors.verticalCenter: parent.verticalCenter;
-                        source: "./resources/components/primaryFlightDisplay/display.png"
+                        source: "image://hud/primaryFlightDisplay/display.png"
                     }
                 }
             }
@@ -472,7 +475,7 @@ Rectangle {
                     {
                         anchors.horizontalCenter: parent.horizontalCenter;
                         anchors.verticalCenter: parent.verticalCenter;
-                        source: "./resources/components/primaryFlightDisplay/settings.png"
+                        source: "image://hud/primaryFlightDisplay/settings.png"
                     }
                 }
             }
@@ -18,6 +18,7 @@ import QtQuick 2.3
 import QtQuick.Controls 1.3
 import QtQuick.Layouts 1.1
 import QtGStreamer 1.0
+import Hud 1.0
 import QtQuick.LocalStorage 2.0
 import QtQuick.Controls.Styles 1.3
 import QtQuick.Dialogs 1.1
@@ -32,51 +33,66 @@ Rectangle {
     property bool enableBackgroundVideo: true
     property string statusMessage: ""
     property bool showStatusMessage: false
+    property bool showStatusTexts: false
+    property bool showTerrain: false
+    property bool showMap: false
+    property int mapZoom: 16
+    property bool cacheStaticLayers: true    // See StaticLayer.qml
 	property bool enableFullScreen: false
 	property bool popupVisible: false
     property bool enableConnect: true
     property bool showMessageBox: false
     property string navMode: ""
     property string messageBoxText: ""
+    property string pipLayout: "pip"    // Second camera: "pip" or "side"
     property real zoom: Screen.pixelDensity * zoomSlider.value
     property real mm: Screen.pixelDensity
 
 	Binding { target: root; property: "enableBackgroundVideo"; value: container.videoEnabled }
     Binding { target: root; property: "enableConnect"; value: container.uasConnected }
+    // Power save caps the video to the HUD's frame rate too, otherwise every decoded frame is a redraw
+    Binding { target: player; property: "maxFps"; value: framePacer.powerSave ? framePacer.targetFps : 0 }
+    Binding { target: player2; property: "maxFps"; value: framePacer.powerSave ? framePacer.targetFps : 0 }
 
     function activeUasSet() {
-        rollPitchIndicator.rollAngle = Qt.binding(function() { return relpositionoverview.roll})
-        rollPitchIndicator.pitchAngle = Qt.binding(function() { return  relpositionoverview.pitch})
-        pitchIndicator.rollAngle = Qt.binding(function() { return relpositionoverview.roll})
-        pitchIndicator.pitchAngle = Qt.binding(function() { return  relpositionoverview.pitch})
-        speedIndicator.groundspeed = Qt.binding(function() { return relpositionoverview.groundspeed})
-        informationIndicator.groundSpeed = Qt.binding(function() { return relpositionoverview.groundspeed})
-        informationIndicator.airSpeed = Qt.binding(function() { return relpositionoverview.airspeed })
-        informationIndicator.batVoltage = Qt.binding(function() { return vehicleoverview.voltage_battery/1000.0 })
-        informationIndicator.batCurrent = Qt.binding(function() { return vehicleoverview.current_battery/100.0 })
-        informationIndicator.batPercent = Qt.binding(function() { return vehicleoverview.battery_remaining })
-        informationIndicator.lat = Qt.binding(function() { return abspositionoverview.lat})
-        informationIndicator.lng = Qt.binding(function() { return abspositionoverview.lon})
-        informationIndicator.satcount = Qt.binding(function() { return abspositionoverview.satellites_visible})
+        // With alignTelemetry the attitude matches the (delayed) video frame on screen
+        rollPitchIndicator.rollAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedRoll : activeVehicle.relPosition.roll})
+        rollPitchIndicator.pitchAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedPitch : activeVehicle.relPosition.pitch})
+        rollPitchIndicator.horizonMatrix = Qt.binding(function() { return container.alignTelemetry ? container.alignedHorizon : activeVehicle.relPosition.horizon})
+        pitchIndicator.rollAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedRoll : activeVehicle.relPosition.roll})
+        pitchIndicator.pitchAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedPitch : activeVehicle.relPosition.pitch})
+        video.rollAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedRoll : activeVehicle.relPosition.roll})
+        video.pitchAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedPitch : activeVehicle.relPosition.pitch})
+        video.yawAngle = Qt.binding(function() { return container.alignTelemetry ? container.alignedYaw : activeVehicle.relPosition.yaw})
+        speedIndicator.groundspeed = Qt.binding(function() { return activeVehicle.relPosition.groundspeed})
+        informationIndicator.groundSpeed = Qt.binding(function() { return activeVehicle.relPosition.groundspeed})
+        informationIndicator.airSpeed = Qt.binding(function() { return activeVehicle.relPosition.airspeed })
+        informationIndicator.batVoltage = Qt.binding(function() { return activeVehicle.vehicle.sys_status.voltage_battery/1000.0 })
+        informationIndicator.batCurrent = Qt.binding(function() { return activeVehicle.vehicle.sys_status.current_battery/100.0 })
+        informationIndicator.batPercent = Qt.binding(function() { return activeVehicle.vehicle.sys_status.battery_remaining })
+        informationIndicator.lat = Qt.binding(function() { return activeVehicle.absPosition.lat})
+        informationIndicator.lng = Qt.binding(function() { return activeVehicle.absPosition.lon})
+        informationIndicator.satcount = Qt.binding(function() { return activeVehicle.absPosition.satellites_visible})
 
         compassIndicator.heading = Qt.binding(function() {
-            return (relpositionoverview.yaw < 0) ? relpositionoverview.yaw + 360 : relpositionoverview.yaw ;
+            var yaw = container.alignTelemetry ? container.alignedYaw : activeVehicle.relPosition.yaw;
+            return (yaw < 0) ? yaw + 360 : yaw ;
         })
 
         compassIndicator.homeHeading = Qt.binding(function()
         {
-            var homeHeading = abspositionoverview.homeHeading - relpositionoverview.yaw;
+            var homeHeading = activeVehicle.absPosition.homeHeading - activeVehicle.relPosition.yaw;
             if (homeHeading > 360) homeHeading = homeHeading - 360;
             if (homeHeading < 0) homeHeading = homeHeading + 360;
             return homeHeading;
         })
 
-        speedIndicator.airspeed = Qt.binding(function() { return relpositionoverview.airspeed } )
-        altIndicator.alt = Qt.binding(function() { return abspositionoverview.relative_alt } )
+        speedIndicator.airspeed = Qt.binding(function() { return activeVehicle.relPosition.airspeed } )
+        altIndicator.alt = Qt.binding(function() { return activeVehicle.absPosition.relative_alt } )
 
         informationIndicator.gpsstatus = Qt.binding(function()
         {
-            switch (abspositionoverview.fix_type)
+            switch (activeVehicle.absPosition.fix_type)
             {
                 case 0:
                 case 1:
@@ -114,6 +130,8 @@ Rectangle {
     
 	Component.onCompleted:
 	{
+		// Installed once, a vehicle change swaps what activeVehicle reads from
+		activeUasSet()
 		rollPitchIndicator.enableRollPitch = Settings.get("enableRollPitchIndicator", true) == 0 ? false : true
 		pitchIndicator.visible = Settings.get("enablePitchIndicator", true) == 0 ? false : true
 		altIndicator.visible = Settings.get("enableAltIndicator", true) == 0 ? false : true
@@ -125,8 +143,32 @@ Rectangle {
 		hueSlider.value = Settings.get("hue",0);
 		saturationSlider.value = Settings.get("saturation",0);
         ipOrHost.text = Settings.get("ipOrHost", "");
+        pipLayout = Settings.get("pipLayout", "pip");
+        container.alignTelemetry = Settings.get("alignTelemetry", false) == 0 ? false : true
+        container.telemetryOffsetMs = Settings.get("telemetryOffsetMs", 0);
+        video.stabilize = Settings.get("stabilizeVideo", false) == 0 ? false : true
+        video.fieldOfView = Settings.get("cameraFieldOfView", 90);
+        video.lensProfile = Settings.get("lensProfile", video.lensProfiles.length > 0 ? video.lensProfiles[0] : "");
+        video.lensCorrection = Settings.get("lensCorrection", false) == 0 ? false : true
+        secondaryPipelineString.text = Settings.get("secondaryPipelineString", "");
+        container.secondaryPipelineString = secondaryPipelineString.text;
         zoomSlider.value = Settings.get("zoomFactor",1.0);
         fontsizeSlider.value = Settings.get("fontPointSize", 20.0);
+        root.fusedHud = Settings.get("fusedHud", true) == 0 ? false : true
+        root.cacheStaticLayers = Settings.get("cacheStaticLayers", true) == 0 ? false : true
+        videoRate.enabled = Settings.get("adaptiveVideoRate", false) == 0 ? false : true
+        player.adaptiveSize = Settings.get("adaptiveVideoSize", true) == 0 ? false : true
+        player2.adaptiveSize = player.adaptiveSize
+        player.adaptiveJitter = Settings.get("adaptiveJitter", false) == 0 ? false : true
+        player2.adaptiveJitter = player.adaptiveJitter
+        framePacer.powerSave = Settings.get("powerSave", false) == 0 ? false : true
+        degradation.enabled = Settings.get("degradeUnderLoad", true) == 0 ? false : true
+        hudPerformance.enabled = Settings.get("showPerformance", false) == 0 ? false : true
+        showStatusTexts = Settings.get("showStatusTexts", false) == 0 ? false : true
+        showTerrain = Settings.get("showTerrain", false) == 0 ? false : true
+        showMap = Settings.get("showMap", false) == 0 ? false : true
+        mapZoom = Settings.get("mapZoom", 16);
+        terrain.minClearance = Settings.get("terrainMinClearance", 30);
     }
 	
 	function activeUasUnset() {
@@ -145,12 +187,46 @@ Rectangle {
         onTriggered: showStatusMessage = false
     }
 
-	VideoItem {
+    // Draw horizon, ladder and crosshair in the video item's own shader instead of the indicator items
+    property bool fusedHud: true
+    property bool fusedHudActive: fusedHud && enableBackgroundVideo
+
+	HudVideoItem {
 		id: video
         objectName: "video"
 		visible: enableBackgroundVideo
-		width: root.width
+		width: showSecondaryVideo && pipLayout == "side" ? root.width / 2 : root.width
 		height: root.height
+        overlay: fusedHudActive
+        rollEnabled: rollPitchIndicator.enableRollPitch
+        pitchEnabled: pitchIndicator.visible
+        pixelsPerDegree: root.zoom / 4
+        graticuleRadius: root.zoom * 20
+        lineWidth: Math.max(1, root.zoom / 4)
+    }
+
+    // Decode no larger than the streams are shown
+    Binding { target: player; property: "displaySize"; value: Qt.size(video.width * Screen.devicePixelRatio, video.height * Screen.devicePixelRatio) }
+    Binding { target: player2; property: "displaySize"; value: Qt.size(secondaryVideo.width * Screen.devicePixelRatio, secondaryVideo.height * Screen.devicePixelRatio) }
+
+    // Second camera, drawn by the same scene graph (and GL context) as the main one
+    property bool showSecondaryVideo: enableBackgroundVideo && container.secondaryPipelineString.length > 0
+
+    // Created the first time a second pipeline is set, most setups never have one
+    Loader {
+        id: secondaryVideo
+        active: showSecondaryVideo
+        width: pipLayout == "side" ? root.width / 2 : root.width / 3
+        height: pipLayout == "side" ? root.height : root.height / 3
+        anchors.right: parent.right
+        anchors.bottom: parent.bottom
+        anchors.rightMargin: pipLayout == "side" ? 0 : (2*root.mm)
+        anchors.bottomMargin: pipLayout == "side" ? 0 : (2*root.mm)
+        sourceComponent: VideoItem {
+            objectName: "video2"
+            anchors.fill: parent
+        }
+        onLoaded: container.wireSecondaryVideo()
     }
 
 	Menu { 
@@ -167,6 +243,118 @@ Rectangle {
 			}
         }
 
+        MenuItem { 
+            text: "Second Camera Side by Side"
+			checkable: true
+			checked: pipLayout == "side"
+			enabled: container.secondaryPipelineString.length > 0
+			onTriggered: 
+			{
+				root.pipLayout = (root.pipLayout == "side") ? "pip" : "side"
+				Settings.set("pipLayout", root.pipLayout)
+			}
+        }
+
+        MenuItem { 
+            text: "Align Telemetry to Video"
+			checkable: true
+			checked: container.alignTelemetry
+			onTriggered: 
+			{
+				container.alignTelemetry = !container.alignTelemetry
+				Settings.set("alignTelemetry", container.alignTelemetry)
+			}
+        }
+
+        MenuItem { 
+            text: "Stabilize Video"
+			checkable: true
+			checked: video.stabilize
+			onTriggered: 
+			{
+				video.stabilize = !video.stabilize
+				Settings.set("stabilizeVideo", video.stabilize)
+			}
+        }
+
+        MenuItem { 
+            text: "Correct Lens Distortion"
+			checkable: true
+			checked: video.lensCorrection
+			enabled: video.lensProfile.length > 0
+			onTriggered: 
+			{
+				video.lensCorrection = !video.lensCorrection
+				Settings.set("lensCorrection", video.lensCorrection)
+			}
+        }
+
+        MenuItem { 
+            text: "Record Video with HUD"
+			checkable: true
+			checked: hudRecorder.recording
+			onTriggered: 
+			{
+				if (hudRecorder.recording) hudRecorder.stop()
+				else hudRecorder.start()
+			}
+        }
+
+        MenuItem { 
+            text: review.active ? "Close Review" : "Review Recording..."
+			onTriggered: 
+			{
+				if (review.active) review.close()
+				else if (secondaryPanels.item) secondaryPanels.item.openReviewDialog()
+			}
+        }
+
+        MenuItem { 
+            text: "Adaptive Video Bitrate"
+			checkable: true
+			checked: videoRate.enabled
+			onTriggered: 
+			{
+				videoRate.enabled = !videoRate.enabled
+				Settings.set("adaptiveVideoRate", videoRate.enabled)
+			}
+        }
+
+        MenuItem { 
+            text: "Scale Video to View"
+			checkable: true
+			checked: player.adaptiveSize
+			onTriggered: 
+			{
+				player.adaptiveSize = !player.adaptiveSize
+				player2.adaptiveSize = player.adaptiveSize
+				Settings.set("adaptiveVideoSize", player.adaptiveSize)
+			}
+        }
+
+        MenuItem { 
+            text: "Adaptive Jitter Buffer"
+			checkable: true
+			checked: player.adaptiveJitter
+			onTriggered: 
+			{
+				player.adaptiveJitter = !player.adaptiveJitter
+				player2.adaptiveJitter = player.adaptiveJitter
+				Settings.set("adaptiveJitter", player.adaptiveJitter)
+			}
+        }
+
+        MenuItem { 
+            text: "GPU Attitude Overlay"
+			checkable: true
+			checked: root.fusedHud
+			onTriggered: 
+			{
+				root.fusedHud = !root.fusedHud
+				Settings.set("fusedHud", root.fusedHud)
+			}
+        }
+
         MenuItem { 
             text: "Roll/Pitch"
 			checkable: true
@@ -232,6 +420,84 @@ Rectangle {
 				Settings.set("enableInformationIndicator", informationIndicator.visible)
 			}
         }
+
+        MenuItem {
+            text: "Performance"
+            checkable: true
+            checked: hudPerformance.enabled
+            onTriggered:
+            {
+                hudPerformance.enabled = !hudPerformance.enabled
+                Settings.set("showPerformance", hudPerformance.enabled)
+            }
+        }
+
+        MenuItem {
+            text: statusTexts.alerts > 0 ? "Status Messages (" + statusTexts.alerts + ")" : "Status Messages"
+            checkable: true
+            checked: showStatusTexts
+            onTriggered:
+            {
+                showStatusTexts = !showStatusTexts
+                Settings.set("showStatusTexts", showStatusTexts)
+            }
+        }
+
+        MenuItem {
+            text: "Minimap"
+            checkable: true
+            checked: showMap
+            onTriggered:
+            {
+                showMap = !showMap
+                Settings.set("showMap", showMap)
+            }
+        }
+
+        MenuItem {
+            text: "Terrain (AGL)"
+            checkable: true
+            checked: showTerrain
+            onTriggered:
+            {
+                showTerrain = !showTerrain
+                Settings.set("showTerrain", showTerrain)
+            }
+        }
+
+        MenuItem {
+            text: "Power Save"
+            checkable: true
+            checked: framePacer.powerSave
+            onTriggered:
+            {
+                framePacer.powerSave = !framePacer.powerSave
+                Settings.set("powerSave", framePacer.powerSave)
+            }
+        }
+
+        MenuItem {
+            text: degradation.level > 0 ? "Degrade Under Load (" + degradation.levelName + ")" : "Degrade Under Load"
+            checkable: true
+            checked: degradation.enabled
+            onTriggered:
+            {
+                degradation.enabled = !degradation.enabled
+                Settings.set("degradeUnderLoad", degradation.enabled)
+            }
+        }
+
+        // Off to compare, the performance overlay shows the covered area either way
+        MenuItem {
+            text: "Cache Static Layers"
+            checkable: true
+            checked: root.cacheStaticLayers
+            onTriggered:
+            {
+                root.cacheStaticLayers = !root.cacheStaticLayers
+                Settings.set("cacheStaticLayers", root.cacheStaticLayers)
+            }
+        }
     }
 	
 	RollPitchIndicator {
@@ -241,11 +507,13 @@ Rectangle {
 		rollAngle: 0
 		pitchAngle: 0
         enableBackgroundVideo: root.enableBackgroundVideo
+        drawGraticule: !root.fusedHudActive
     }
 
     PitchIndicator {
         id: pitchIndicator
         zoom: root.zoom
+        drawLadder: !root.fusedHudActive
         anchors.top: parent.top
         anchors.bottom: parent.bottom
         opacity: 0.6
@@ -280,13 +548,123 @@ Rectangle {
         }
 
         heading: 0
+        cacheRose: root.cacheStaticLayers
+    }
+
+    // Height above the offline terrain tiles, blank where no tile covers the vehicle
+    Text {
+        visible: showTerrain && altIndicator.visible
+        anchors.right: altIndicator.left
+        anchors.rightMargin: root.mm
+        anchors.verticalCenter: parent.verticalCenter
+        font.pointSize: fontsizeSlider.value * 0.7
+        color: terrain.lowClearance ? "red" : "white"
+        style: Text.Outline
+        styleColor: "black"
+        text: terrain.valid ? "AGL " + terrain.agl.toFixed(0) + " m" : "AGL --"
+    }
+
+    Connections {
+        target: terrain
+        onClearanceChanged: {
+            if (showTerrain && low && sysid == terrain.sysid) {
+                statusMessage = "TERRAIN: " + terrain.agl.toFixed(0) + " m above ground"
+                showStatusMessage = true
+            }
+        }
     }
 
-    StatusMessageIndicator  {
-        id: statusMessageIndicator
+    // Only exists while a message is shown, its blinking border animates forever
+    Loader {
         anchors.fill: parent
-        message: statusMessage
-        visible: showStatusMessage
+        active: showStatusMessage
+        sourceComponent: StatusMessageIndicator {
+            anchors.fill: parent
+            message: statusMessage
+        }
+    }
+
+    // Every distinct STATUSTEXT, newest first; a repeat only updates its count
+    Loader {
+        active: showStatusTexts
+        anchors.left: parent.left
+        anchors.bottom: parent.bottom
+        anchors.leftMargin: 12 * root.mm
+        anchors.bottomMargin: 2 * root.mm
+        width: Math.min(parent.width / 2, 80 * root.mm)
+        height: parent.height / 3
+        sourceComponent: ListView {
+            clip: true
+            model: statusTexts
+            delegate: Text {
+                width: parent ? parent.width : 0
+                elide: Text.ElideRight
+                font.pointSize: fontsizeSlider.value * 0.6
+                color: severity <= 3 ? "red" : (severity == 4 ? "yellow" : "white")
+                style: Text.Outline
+                styleColor: "black"
+                text: (count > 1 ? "[" + count + "x] " : "") + severityName + ": " + model.text
+            }
+        }
+    }
+
+    // Offline tiles and the flown track; tap the left half to zoom out, the right half to zoom in
+    Loader {
+        active: showMap
+        anchors.right: altIndicator.left
+        anchors.bottom: parent.bottom
+        anchors.rightMargin: 2 * root.mm
+        anchors.bottomMargin: 2 * root.mm
+        width: Math.min(parent.width, parent.height) / 3
+        height: width
+        sourceComponent: Rectangle {
+            color: "#80000000"
+            border.color: "white"
+            clip: true
+
+            HudMapItem {
+                id: minimap
+                anchors.fill: parent
+                latitude: activeVehicle.absPosition.lat / 1E7
+                longitude: activeVehicle.absPosition.lon / 1E7
+                zoom: root.mapZoom
+                track: trackHistory
+                trackSysid: activeVehicle.uasId
+                trackWidth: Math.max(1, root.mm / 2)
+            }
+
+            // The other vehicles, all in one node
+            HudSwarmItem {
+                anchors.fill: parent
+                visible: swarm.count > 1
+                model: swarm
+                latitude: minimap.latitude
+                longitude: minimap.longitude
+                zoom: minimap.zoom
+                activeSysid: activeVehicle.uasId
+                color: "yellow"
+                iconSize: 3 * root.mm
+                lineWidth: Math.max(1, root.mm / 3)
+                velocityLead: 10
+            }
+
+            Rectangle {
+                anchors.centerIn: parent
+                width: 2 * root.mm
+                height: width
+                radius: width / 2
+                color: "red"
+                border.color: "white"
+            }
+
+            MouseArea {
+                anchors.fill: parent
+                onClicked: {
+                    root.mapZoom = Math.max(1, Math.min(19, root.mapZoom + (mouse.x < width / 2 ? -1 : 1)))
+                    Settings.set("mapZoom", root.mapZoom)
+                }
+            }
+        }
     }
 
     InformationOverlayIndicator{
@@ -299,14 +677,197 @@ Rectangle {
         batPercent: 0
         navMode : root.navMode
         fontPointSize: fontsizeSlider.value
+        showLinkHealth: root.enableBackgroundVideo
+        videoKbps: player.stats.bitrateKbps
+        videoLost: player.stats.jitterLost
+        videoJitter: player.stats.jitterMs
+        telemetryRate: container.telemetryInRate
+        telemetryLoss: container.telemetryLoss
     }
 	
+    // Frame, video, telemetry age and ingest numbers for field diagnosis
+    // Its text changes once a second, the frames in between draw the texture
+    StaticLayer {
+        id: performanceOverlay
+        cached: root.cacheStaticLayers
+        visible: hudPerformance.enabled
+        anchors.left: parent.left
+        anchors.top: parent.top
+        anchors.leftMargin: (12*root.mm)
+        anchors.topMargin: (10*root.mm)
+        width: performanceText.width + (2*root.mm)
+        height: performanceText.height + (2*root.mm)
+        z: 4
+
+        Rectangle {
+            anchors.fill: parent
+            color: Qt.rgba(0,0,0,0.6)
+        }
+
+        Text {
+            id: performanceText
+            anchors.centerIn: parent
+            color: "white"
+            font.family: "monospace"
+            font.pixelSize: (2.5*root.mm)
+            text: "HUD " + framePacer.fps.toFixed(1) + " fps, frame p50/95/99 "
+                  + framePacer.frameMs50 + "/" + framePacer.frameMs95 + "/" + framePacer.frameMs99 + " ms\n"
+                  + "render " + framePacer.renderMs.toFixed(1) + " ms, swap " + framePacer.swapMs.toFixed(1) + " ms\n"
+                  + "covered " + hudPerformance.coveredPercent + "% of the window by " + hudPerformance.contentItems
+                  + " items, " + hudPerformance.cachedLayers + " cached layers\n"
+                  + "video decode " + player.stats.decodedFps.toFixed(1) + " fps, shown "
+                  + player.stats.renderedFps.toFixed(1) + " fps\n"
+                  + (player.stats.srtRttMs > 0 ? "SRT rtt " + player.stats.srtRttMs.toFixed(0) + " ms, lost "
+                     + player.stats.srtLost + ", retransmit requests " + player.stats.srtRetransmitRequests + "\n" : "")
+                  + (player.stats.fecRecovered + player.stats.fecUnrecovered > 0 ? "FEC recovered "
+                     + player.stats.fecRecovered + ", unrecovered " + player.stats.fecUnrecovered + "\n" : "")
+                  + "ATTITUDE age " + hudPerformance.attitudeAgeMs + " ms (max " + hudPerformance.attitudeAgeMaxMs + ")\n"
+                  + "GLOBAL_POSITION_INT age " + hudPerformance.positionAgeMs + " ms (max " + hudPerformance.positionAgeMaxMs + ")\n"
+                  + "ingest reads " + hudPerformance.ingestPendingReads + ", messages " + hudPerformance.ingestPendingMessages
+                  + ", dropped " + hudPerformance.ingestDroppedMessages + "\n"
+                  + "arena " + hudPerformance.arenaAllocations + " allocs/s, " + hudPerformance.arenaHeapBlocks
+                  + " blocks/s, " + (hudPerformance.arenaReservedBytes / 1024).toFixed(0) + " kB, message heap "
+                  + hudPerformance.messageHeapAllocations + "/s\n"
+                  + "memory " + (memoryBudget.residentBytes / 1048576).toFixed(1) + " MB resident, "
+                  + (memoryBudget.trackedBytes / 1048576).toFixed(1) + " MB tracked"
+                  + (memoryBudget.lowMemory ? ", LOW MEMORY" : "") + "\n"
+                  + "link " + container.telemetryInRate + " B/s, loss " + container.telemetryLoss.toFixed(1) + "%\n"
+                  + "UI telemetry " + eventLoopMonitor.uiTelemetryMs.toFixed(1) + "/" + eventLoopMonitor.budgetMs
+                  + " ms a frame, " + eventLoopMonitor.overBudgetFrames + " frames over\n"
+                  + eventLoopMonitor.report + "\n"
+                  + (threadRoles.report !== "" ? threadRoles.report + "\n" : "")
+                  + "startup " + startupProfiler.interactiveMs + " ms to first frame\n"
+                  + startupProfiler.timeline
+        }
+    }
+
+    function formatTime(seconds) {
+        var s = Math.floor(seconds)
+        var m = Math.floor(s / 60)
+        return m + ":" + ((s % 60) < 10 ? "0" : "") + (s % 60)
+    }
+
+    // Log download, review bar and its file dialog, created once video is up
+    Loader {
+        id: secondaryPanels
+        anchors.fill: parent
+        z: 4
+        active: container.startupPhase >= 2
+        asynchronous: true
+        onLoaded: container.secondaryPanelsLoaded()
+        sourceComponent: Item {
+            function openReviewDialog() { reviewDialog.open() }
+
+            Rectangle {
+                id: logDownloadOverlay
+                property QtObject download: activeVehicle.logDownload
+                visible: download !== null && download.active
+                anchors.left: parent.left
+                anchors.bottom: parent.bottom
+                anchors.leftMargin: (12*root.mm)
+                anchors.bottomMargin: (10*root.mm)
+                width: logDownloadText.width + (2*root.mm)
+                height: logDownloadText.height + (2*root.mm)
+                color: Qt.rgba(0,0,0,0.6)
+                z: 4
+
+                Text {
+                    id: logDownloadText
+                    anchors.centerIn: parent
+                    color: "white"
+                    font.family: "monospace"
+                    font.pixelSize: (2.5*root.mm)
+                    text: logDownloadOverlay.visible
+                          ? "log " + logDownloadOverlay.download.logId + " "
+                            + (logDownloadOverlay.download.receivedBytes / 1024).toFixed(0) + " of "
+                            + (logDownloadOverlay.download.size / 1024).toFixed(0) + " kB, "
+                            + (logDownloadOverlay.download.bytesPerSecond / 1024).toFixed(1) + " kB/s"
+                          : ""
+                }
+            }
+
+            FileDialog {
+                id: reviewDialog
+                title: "Review a recording with its tlog"
+                nameFilters: [ "Recordings (*.mp4 *.mkv)" ]
+                onAccepted: review.open(fileUrl.toString().replace(/^file:\/\//, ""))
+            }
+
+            Rectangle {
+                id: reviewBar
+                visible: review.active
+                anchors.left: parent.left
+                anchors.right: parent.right
+                anchors.bottom: parent.bottom
+                anchors.margins: (2*root.mm)
+                height: (8*root.mm)
+                color: Qt.rgba(0,0,0,0.6)
+                z: 4
+
+                RowLayout {
+                    anchors.fill: parent
+                    anchors.margins: (1*root.mm)
+                    spacing: (1*root.mm)
+
+                    Button {
+                        text: review.paused ? "Play" : "Pause"
+                        onClicked: review.paused = !review.paused
+                    }
+                    Slider {
+                        id: reviewSlider
+                        Layout.fillWidth: true
+                        minimumValue: 0
+                        maximumValue: Math.max(review.duration, 1)
+                        // Key frames while dragging, the exact frame on release
+                        onValueChanged: if (pressed) review.seek(value, true)
+                        onPressedChanged: if (!pressed) review.seek(value, false)
+
+                        // The tile of the thumbnail sprite at the dragged position
+                        Item {
+                            property rect tile: review.thumbnailRect(reviewSlider.value)
+                            visible: reviewSlider.pressed && review.thumbnails.length > 0
+                            width: tile.width
+                            height: tile.height
+                            x: (reviewSlider.value - reviewSlider.minimumValue) / (reviewSlider.maximumValue - reviewSlider.minimumValue)
+                               * reviewSlider.width - width / 2
+                            y: -height - (1*root.mm)
+                            clip: true
+
+                            Image {
+                                source: review.thumbnails
+                                x: -parent.tile.x
+                                y: -parent.tile.y
+                            }
+                        }
+                    }
+                    Binding { target: reviewSlider; property: "value"; value: review.position; when: !reviewSlider.pressed }
+                    Text {
+                        color: "white"
+                        font.family: "monospace"
+                        font.pixelSize: (2.5*root.mm)
+                        text: root.formatTime(review.position) + " / " + root.formatTime(review.duration)
+                              + (review.tlogFile.length > 0 ? "" : "  no tlog")
+                    }
+                    ComboBox {
+                        model: [ "0.25x", "0.5x", "1x", "2x", "4x", "8x" ]
+                        currentIndex: 2
+                        onActivated: review.speed = parseFloat(model[index])
+                    }
+                    Button {
+                        text: "Close"
+                        onClicked: review.close()
+                    }
+                }
+            }
+        }
+    }
+
 	Rectangle
 	{
         id: popup
 		color: "lightgrey"
         width: parent.width
-        height: (63*root.mm)
+        height: (69*root.mm)
 		z:3
 		
         property real rowHeight: (6*root.mm)
@@ -470,6 +1031,25 @@ Rectangle {
                 }
             }
 
+            // Adds a recovering source's pipeline string to the list below
+            ComboBox
+            {
+                id: sourcePresets
+                width: parent.width
+                height: popup.rowHeight
+                z:3
+                model: ["Add Source Preset..."].concat(player.sourcePresets)
+                onActivated:
+                {
+                    if (index > 0)
+                    {
+                        pipelineString.editText = player.sourcePreset(model[index], ipOrHost.text)
+                        pipelineString.accepted()
+                        currentIndex = 0
+                    }
+                }
+            }
+
             RowLayout
             {
                 width: parent.width
@@ -592,7 +1172,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/disconnect.svg"
+                        source: "image://hud/primaryFlightDisplay/disconnect.svg"
                         sourceSize.height: (6*root.mm)
                         sourceSize.width: (6*root.mm)
                     }
@@ -612,6 +1192,20 @@ Rectangle {
                     Settings.set("ipOrHost", ipOrHost.text)
                 }
             }
+
+            TextField
+            {
+                id: secondaryPipelineString
+                width: parent.width
+                height: popup.rowHeight
+                z:3
+                placeholderText: "Second camera pipeline (empty to disable)"
+                onEditingFinished:
+                {
+                    container.secondaryPipelineString = secondaryPipelineString.text
+                    Settings.set("secondaryPipelineString", secondaryPipelineString.text)
+                }
+            }
 		}
 
         Text
@@ -724,7 +1318,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/play.svg"
+                        source: "image://hud/primaryFlightDisplay/play.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -739,7 +1333,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/stop.svg"
+                        source: "image://hud/primaryFlightDisplay/stop.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -754,7 +1348,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/pause.svg"
+                        source: "image://hud/primaryFlightDisplay/pause.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -769,7 +1363,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/reset.svg"
+                        source: "image://hud/primaryFlightDisplay/reset.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -784,7 +1378,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/connect.svg"
+                        source: "image://hud/primaryFlightDisplay/connect.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -799,7 +1393,7 @@ Rectangle {
                     Image {
                         anchors.verticalCenter: parent.verticalCenter
                         anchors.horizontalCenter: parent.horizontalCenter
-                        source: "./resources/components/primaryFlightDisplay/disconnect.svg"
+                        source: "image://hud/primaryFlightDisplay/disconnect.svg"
                         sourceSize.height: tbRow.buttonHeight
                         sourceSize.width: tbRow.buttonHeight
                     }
@@ -856,7 +1450,7 @@ Rectangle {
                     {
                         anchors.horizontalCenter: parent.horizontalCenter;
                         anchors.verticalCenter: parent.verticalCenter;
-                        source: "./resources/components/primaryFlightDisplay/display.png"
+                        source: "image://hud/primaryFlightDisplay/display.png"
                         width: topRow.buttonHeight
                         height: topRow.buttonHeight
                         sourceSize.height: topRow.buttonHeight
@@ -886,7 +1480,7 @@ Rectangle {
                     {
                         anchors.horizontalCenter: parent.horizontalCenter;
                         anchors.verticalCenter: parent.verticalCenter;
-                        source: "./resources/components/primaryFlightDisplay/settings.png"
+                        source: "image://hud/primaryFlightDisplay/settings.png"
                         width: topRow.buttonHeight
                         height: topRow.buttonHeight
                         sourceSize.height: topRow.buttonHeight
@@ -917,7 +1511,7 @@ Rectangle {
                     {
                         anchors.horizontalCenter: parent.horizontalCenter;
                         anchors.verticalCenter: parent.verticalCenter;
-                        source: "./resources/components/primaryFlightDisplay/help.png"
+                        source: "image://hud/primaryFlightDisplay/help.png"
                         width: topRow.buttonHeight
                         height: topRow.buttonHeight
                         sourceSize.height: topRow.buttonHeight
@@ -933,14 +1527,17 @@ Rectangle {
 
     }
 
-    MessageDialog
+    Loader
     {
-        id: messageDialog
-        icon : StandardIcon.Warning
-        visible: root.showMessageBox
-        title: ""
-        text: root.messageBoxText
-        onAccepted: { root.showMessageBox = false; }
+        active: root.showMessageBox
+        sourceComponent: MessageDialog
+        {
+            icon : StandardIcon.Warning
+            visible: true
+            title: ""
+            text: root.messageBoxText
+            onAccepted: { root.showMessageBox = false; }
+        }
     }
 }
 
@@ -15,8 +15,9 @@
 //
 
 import QtQuick 2.3
+import Hud 1.0
 
-Rectangle {
+Item {
     id: root
     property real alt: 0
 
@@ -30,41 +31,28 @@ Rectangle {
     height: parent.height*0.5
     z: 1
     clip: true
-    smooth: true
-    border.color: "black"
-    color: Qt.rgba(0,0,0,0.2)
-    Column{
-        id: altColumn
-        anchors.horizontalCenter: parent.horizontalCenter
-        anchors.verticalCenter: parent.verticalCenter
-        spacing: graticuleSpacing
 
-        Repeater {
-            model: [ "200", "190", "180", "170", "160", "150", "140","130","120",
-                    "110", "100", "90", "80", "70", "60", "50", "40", "30", "20", "10", "0",
-                    "-10", "-20", "-30", "-40", "-50" , "-60", "-70", "-80", "-90" , "-100",
-                    "-110", "-120", "-130", "-140", "-150" , "-160", "-170", "-180", "-190", "-200"]
-            Rectangle { // Graticule Light
-                id:graticuleLight
-                width: root.width
-                height: (1 * zoom)
-                color: "white"
-                smooth: true
-                opacity: 0.8
-                Text {
-                    anchors.horizontalCenter: parent.horizontalCenter
-                    anchors.verticalCenter: parent.verticalCenter
-                    smooth: true
-                    font.bold: true
-                    text: modelData
-                    color: "white"
-                    style: Text.Outline
-                    styleColor: "black"
-                }
-            }
-        }
-        transform: Translate {
-            y: alt*(graticuleSpacing+graticuleHeight)/graticuleAlt
+    HudTapeItem {
+        id: tape
+        anchors.fill: parent
+        value: alt
+        step: graticuleAlt
+        spacing: graticuleSpacing + graticuleHeight
+        lineWidth: graticuleHeight
+        color: Qt.rgba(1,1,1,0.8)
+        backgroundColor: Qt.rgba(0,0,0,0.2)
+        borderColor: "black"
+    }
+
+    Repeater { // Labels of the graticules in view, placed by the tape
+        model: tape.labelCount
+        HudReadoutItem {
+            anchors.horizontalCenter: parent.horizontalCenter
+            y: tape.labelOffset + index*tape.spacing - height/2
+            cells: 4
+            value: tape.firstLabel - index*tape.step
+            color: "white"
+            outlineColor: "black"
         }
     }
 
@@ -76,10 +64,10 @@ Rectangle {
         color: "black"
         border.color: "white"
         opacity: 1.0
-        Text {
+        HudReadoutItem {
             anchors.centerIn: parent
-
-            text: alt.toFixed(1)
+            value: alt
+            decimals: 1
             color: "white"
             z: 2
         }
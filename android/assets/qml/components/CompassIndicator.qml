@@ -16,6 +16,7 @@
 
 import QtQuick 2.3
 import QtQuick.Window 2.2
+import Hud 1.0
 
 Rectangle {
     id: root
@@ -23,6 +24,7 @@ Rectangle {
     property real homeHeading: 0
     property real zoom: 1
     property real mm: Screen.pixelDensity
+    property bool cacheRose: true
 
 
     anchors.horizontalCenterOffset: -compassImage.width/2
@@ -33,18 +35,50 @@ Rectangle {
         y: parent.height - (compassImage.height/2) - (2*root.mm)
     }
 
-    Image { // Compass
+    Item { // Compass
         id: compassImage
-        source: "../resources/components/rollPitchIndicator/compass.svg"
-        smooth: true
+        width: 30*zoom
+        height: 30*zoom
         rotation: -heading
-        sourceSize.height: 30*zoom
-        sourceSize.width: 30*zoom
+
+        // Disk, ticks and labels turn as one, re-rendered only on a resize or zoom
+        StaticLayer {
+            anchors.fill: parent
+            cached: root.cacheRose
+
+            HudDialItem {
+                anchors.fill: parent
+                color: "white"
+                backgroundColor: Qt.rgba(0,0,0,0.4)
+                lineWidth: (0.3 * zoom)
+                majorStep: 45
+                minorStep: 15
+                tickLength: (1 * zoom)
+            }
+
+            Repeater {
+                model: ["N", "NE", "E", "SE", "S", "SW", "W", "NW"]
+                Item {
+                    anchors.fill: parent
+                    rotation: index*45
+                    Text {
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        y: (2.5 * zoom)
+                        text: modelData
+                        font.bold: true
+                        font.pixelSize: (index % 2 == 0 ? 2.5 : 1.8)*zoom
+                        color: "white"
+                        style: Text.Outline
+                        styleColor: "black"
+                    }
+                }
+            }
+        }
     }
 
     Image { // homeheading
             id: homeHeadingImage
-            source: "../resources/components/rollPitchIndicator/homeheading.svg"
+            source: "image://hud/rollPitchIndicator/homeheading.svg"
             smooth: true
             rotation: homeHeading
             sourceSize.height: 30*zoom
@@ -55,7 +89,7 @@ Rectangle {
         id: compassIndicator
         y: -compassIndicator.height/2
         anchors.horizontalCenter: compassImage.horizontalCenter
-        source: "../resources/components/rollPitchIndicator/compassIndicator.svg"
+        source: "image://hud/rollPitchIndicator/compassIndicator.svg"
         sourceSize.height: 3*zoom
         sourceSize.width: 3*zoom
         smooth: true
@@ -15,6 +15,7 @@
 //
 
 import QtQuick 2.3
+import Hud 1.0
 
 Rectangle {
 
@@ -35,11 +36,12 @@ Rectangle {
         color: "white"
     }
 
-    Text {
+    HudReadoutItem {
         id:displayValue
         anchors.right: parent.right
         anchors.rightMargin: 3
         anchors.verticalCenter: parent.verticalCenter
+        cells: 8
         text: textValue
         color: "white"
     }
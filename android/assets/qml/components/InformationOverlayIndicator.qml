@@ -39,6 +39,12 @@ Item {
 	property string message: ""
 	property string navMode: ""
 	property string gpsstatus: ""
+	property bool showLinkHealth: false
+	property int videoKbps: 0
+	property real videoLost: 0
+	property real videoJitter: 0
+	property int telemetryRate: 0
+	property real telemetryLoss: 0
     property color color: "white"
     property color colorOutline: "black"
     property real fontPointSize
@@ -105,5 +111,20 @@ Item {
             style: Text.Outline
             text: "W: " + watts.toFixed(1)
         }
+        Text {
+            color: root.color
+            font.pointSize: fontPointSize
+            styleColor: root.colorOutline
+            style: Text.Outline
+            visible: showLinkHealth
+            text: "VID: " + videoKbps + "k L" + videoLost + " J" + videoJitter.toFixed(0)
+        }
+        Text {
+            color: root.color
+            font.pointSize: fontPointSize
+            styleColor: root.colorOutline
+            style: Text.Outline
+            text: "LNK: " + (telemetryRate / 1024).toFixed(1) + "k L" + telemetryLoss.toFixed(0) + "%"
+        }
     }
 }
@@ -15,39 +15,38 @@
 //
 
 import QtQuick 2.3
+import Hud 1.0
 
 Item {
     id: pitchIndicator
     property real pitchAngle: 0
     property real rollAngle: 0
     property real zoom
+    property bool drawLadder: true
 
     width: parent.width
     z:3
     clip: true
     smooth: true
-    Column{
-        anchors.horizontalCenter: parent.horizontalCenter
-        anchors.verticalCenter: parent.verticalCenter
-        spacing: (2 * zoom)
+    HudLadderItem {
+        id: ladder
+        visible: drawLadder
+        anchors.fill: parent
+        steps: 6
+        spacing: (2.5 * zoom)
+        rungWidth: (10 * zoom)
+        lineWidth: (0.5 * zoom)
+        color: "white"
+    }
 
-        Repeater {
-            model: ["60", "50", "40", "30", "20", "10", "0", "-10", "-20", "-30", "-40", "-50" , "-60"]
-            Rectangle { // Graticule Light
-                id:graticuleLight
-                width: (10 * zoom)
-                height: (0.5 * zoom)
-                color: "white"
-                smooth: true
-                Text {
-                    anchors.horizontalCenter: parent.horizontalCenter
-                    anchors.horizontalCenterOffset: -graticuleLight.width
-                    anchors.verticalCenter: parent.verticalCenter
-                    smooth: true
-                    text: modelData
-                    color: "white"
-                }
-            }
+    Repeater {
+        model: drawLadder ? 2*ladder.steps + 1 : 0
+        Text {
+            x: parent.width/2 - ladder.rungWidth - width/2
+            y: parent.height/2 + (index - ladder.steps)*ladder.spacing - height/2
+            smooth: true
+            text: ((ladder.steps - index)*10).toFixed(0)
+            color: "white"
         }
     }
     transform: [ Translate {
@@ -20,8 +20,10 @@ Item {
     id: root
     property real rollAngle : 0
     property real pitchAngle: 0
+    property matrix4x4 horizonMatrix
     property bool enableBackgroundVideo: false
 	property bool enableRollPitch: true
+	property bool drawGraticule: true
     property real scale: 1.0
     property real zoom: 1
     property real defaultSize: (50 * zoom)
@@ -64,26 +66,19 @@ Item {
                 visible: enableBackgroundVideo
             }
 
-            transform: [ Translate {
-                    id: artHorizonPitch
-                    y: pitchAngle * 1.75
-                },
-                Rotation {
-                    id: artHorizonRotation
-                    origin.x: width/2
-                    origin.y: height/2
-                    //horizon angle
-                    angle: -rollAngle
-                }]
+            // roll and pitch offset in one matrix, see AttitudeMatrix::horizon()
+            transform: [ Translate { x: -width/2; y: -height/2 },
+                Matrix4x4 { matrix: horizonMatrix },
+                Translate { x: width/2; y: height/2 }]
         }
     } // End Artficial Horizon
 
     Image { // Roll Graticule
         id: rollGraticule
-		visible: enableRollPitch
+		visible: enableRollPitch && drawGraticule
         anchors { bottom: parent.verticalCenter; horizontalCenter: parent.horizontalCenter}
         z: 1
-        source: "../resources/components/rollPitchIndicator/rollGraticule.svg"
+        source: "image://hud/rollPitchIndicator/rollGraticule.svg"
         sourceSize.width: defaultSize
         sourceSize.height: defaultSize
         scale: scale
@@ -95,7 +90,7 @@ Item {
             angle: -rollAngle
         }
         Image {
-            source: "../resources/components/rollPitchIndicator/rollPointer.svg"
+            source: "image://hud/rollPitchIndicator/rollPointer.svg"
             sourceSize.width: defaultSize
             sourceSize.height: defaultSize
             transform: Rotation {
@@ -109,10 +104,10 @@ Item {
 
     Image { // Cross Hairs
         id: crossHairs
-		visible: enableRollPitch
+		visible: enableRollPitch && drawGraticule
         anchors.centerIn: parent
         z:3
-        source: "../resources/components/rollPitchIndicator/crossHair.svg"
+        source: "image://hud/rollPitchIndicator/crossHair.svg"
         sourceSize.width: defaultSize
         sourceSize.height: defaultSize
     }
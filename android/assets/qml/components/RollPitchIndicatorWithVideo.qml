@@ -78,7 +78,7 @@ Rectangle {
         id: rollGraticule
         anchors { bottom: parent.verticalCenter; horizontalCenter: parent.horizontalCenter}
         z: 1
-        source: "../resources/components/rollPitchIndicator/rollGraticule.svg"
+        source: "image://hud/rollPitchIndicator/rollGraticule.svg"
         scale: scale
         smooth: true
         transform: Rotation {
@@ -88,7 +88,7 @@ Rectangle {
             angle: -rollAngle
         }
         Image {
-            source: "../resources/components/rollPitchIndicator/rollPointer.svg"
+            source: "image://hud/rollPitchIndicator/rollPointer.svg"
             transform: Rotation {
                 origin.x: 157.5
                 origin.y: 200
@@ -102,7 +102,7 @@ Rectangle {
         id: crossHairs
         anchors.centerIn: parent
         z:3
-        source: "../resources/components/rollPitchIndicator/crossHair.svg"
+        source: "image://hud/rollPitchIndicator/crossHair.svg"
 
     }
 }
@@ -0,0 +1,34 @@
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//    (c) 2014 APM_PLANNER PROJECT
+//
+
+import QtQuick 2.3
+import QtQuick.Window 2.2
+
+// Children that change far less often than frames come out of a texture:
+// they are rendered into it only when one of them changes, or the item is
+// resized, and each frame draws the texture as one quad. That pays for
+// dense content such as the compass rose, where the items overlap; the
+// whole rectangle is blended every frame, so for sparse content, a few
+// thin lines across the screen, leave cached off.
+Item {
+    property bool cached: true
+    // What HudPerformanceMonitor looks for, it counts the rectangle once while cached
+    readonly property bool staticLayerCached: cached
+
+    layer.enabled: cached
+    layer.smooth: true
+    layer.textureSize: Qt.size(width * Screen.devicePixelRatio, height * Screen.devicePixelRatio)
+}
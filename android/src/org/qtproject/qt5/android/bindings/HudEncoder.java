@@ -0,0 +1,134 @@
+package org.qtproject.qt5.android.bindings;
+
+import android.media.MediaCodec;
+import android.media.MediaCodecInfo;
+import android.media.MediaFormat;
+import android.media.MediaMuxer;
+import android.os.Build;
+import android.util.Log;
+import android.view.Surface;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Hardware H.264 encoder fed through an input surface, for HudBurnInRecorder.
+ *
+ * The native side draws each composited HUD frame into the surface with
+ * EGL, so no frame ever passes through the CPU. A drain thread moves the
+ * encoded output into an MP4 muxer. One recording at a time.
+ */
+public class HudEncoder
+{
+    private static final String TAG = "HudEncoder";
+    private static final String MIME_TYPE = "video/avc";
+    // Input surfaces and MediaMuxer
+    private static final int MIN_SDK = 18;
+    private static final int I_FRAME_INTERVAL_S = 1;
+    // Only bounds how long the drain thread takes to see the end of stream
+    private static final int DEQUEUE_TIMEOUT_US = 10000;
+    private static final int STOP_TIMEOUT_MS = 2000;
+
+    private static MediaCodec s_codec = null;
+    private static MediaMuxer s_muxer = null;
+    private static Surface s_surface = null;
+    private static Thread s_drain = null;
+
+    /** The encoder's input surface, null if it could not be set up */
+    public static synchronized Surface start(String path, int width, int height, int bitRate, int frameRate)
+    {
+        if (s_codec != null || Build.VERSION.SDK_INT < MIN_SDK) {
+            return null;
+        }
+        try {
+            MediaFormat format = MediaFormat.createVideoFormat(MIME_TYPE, width, height);
+            format.setInteger(MediaFormat.KEY_COLOR_FORMAT, MediaCodecInfo.CodecCapabilities.COLOR_FormatSurface);
+            format.setInteger(MediaFormat.KEY_BIT_RATE, bitRate);
+            format.setInteger(MediaFormat.KEY_FRAME_RATE, frameRate);
+            format.setInteger(MediaFormat.KEY_I_FRAME_INTERVAL, I_FRAME_INTERVAL_S);
+
+            s_codec = MediaCodec.createEncoderByType(MIME_TYPE);
+            s_codec.configure(format, null, null, MediaCodec.CONFIGURE_FLAG_ENCODE);
+            s_surface = s_codec.createInputSurface();
+            s_muxer = new MediaMuxer(path, MediaMuxer.OutputFormat.MUXER_OUTPUT_MPEG_4);
+            s_codec.start();
+        } catch (Exception e) {
+            Log.e(TAG, "Cannot start the encoder: " + e);
+            release();
+            return null;
+        }
+
+        final MediaCodec codec = s_codec;
+        final MediaMuxer muxer = s_muxer;
+        s_drain = new Thread(new Runnable() {
+            public void run() { drain(codec, muxer); }
+        }, TAG);
+        s_drain.start();
+        return s_surface;
+    }
+
+    /** Ends the stream and finalizes the file, after the native side released the surface */
+    public static synchronized void stop()
+    {
+        if (s_codec == null) {
+            return;
+        }
+        try {
+            s_codec.signalEndOfInputStream();
+            s_drain.join(STOP_TIMEOUT_MS);
+        } catch (Exception e) {
+            Log.e(TAG, "Encoder did not drain: " + e);
+        }
+        release();
+    }
+
+    private static void release()
+    {
+        if (s_codec != null) {
+            try { s_codec.stop(); } catch (RuntimeException e) { }
+            s_codec.release();
+            s_codec = null;
+        }
+        if (s_muxer != null) {
+            try { s_muxer.stop(); } catch (RuntimeException e) { }
+            s_muxer.release();
+            s_muxer = null;
+        }
+        if (s_surface != null) {
+            s_surface.release();
+            s_surface = null;
+        }
+        s_drain = null;
+    }
+
+    private static void drain(MediaCodec codec, MediaMuxer muxer)
+    {
+        MediaCodec.BufferInfo info = new MediaCodec.BufferInfo();
+        int track = -1;
+        try {
+            ByteBuffer[] buffers = codec.getOutputBuffers();
+            while (true) {
+                int index = codec.dequeueOutputBuffer(info, DEQUEUE_TIMEOUT_US);
+                if (index == MediaCodec.INFO_OUTPUT_BUFFERS_CHANGED) {
+                    buffers = codec.getOutputBuffers();
+                } else if (index == MediaCodec.INFO_OUTPUT_FORMAT_CHANGED) {
+                    track = muxer.addTrack(codec.getOutputFormat());
+                    muxer.start();
+                } else if (index >= 0) {
+                    ByteBuffer data = buffers[index];
+                    // The codec config went to the muxer with the output format
+                    if ((info.flags & MediaCodec.BUFFER_FLAG_CODEC_CONFIG) == 0 && info.size > 0 && track >= 0) {
+                        data.position(info.offset);
+                        data.limit(info.offset + info.size);
+                        muxer.writeSampleData(track, data, info);
+                    }
+                    codec.releaseOutputBuffer(index, false);
+                    if ((info.flags & MediaCodec.BUFFER_FLAG_END_OF_STREAM) != 0) {
+                        return;
+                    }
+                }
+            }
+        } catch (RuntimeException e) {
+            Log.e(TAG, "Encoding stopped: " + e);
+        }
+    }
+}
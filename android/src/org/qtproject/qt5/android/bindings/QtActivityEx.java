@@ -109,6 +109,27 @@ public class QtActivityEx extends QtActivity
         s_activity = null;
     }
 
+    // Registered by the native library once it is loaded, see MemoryBudget
+    private static native void nativeTrimMemory(int level);
+
+    @Override
+    public void onTrimMemory(int level)
+    {
+        super.onTrimMemory(level);
+        try {
+            nativeTrimMemory(level);
+        } catch (UnsatisfiedLinkError e) {
+            // the native library is not loaded yet, nothing to trim
+        }
+    }
+
+    @Override
+    public void onLowMemory()
+    {
+        super.onLowMemory();
+        onTrimMemory(TRIM_MEMORY_COMPLETE);
+    }
+
     public static void openUrl(final String m_url)
     {
         s_activity.runOnUiThread(new Runnable() {
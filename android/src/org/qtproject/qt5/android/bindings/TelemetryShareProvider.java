@@ -0,0 +1,99 @@
+package org.qtproject.qt5.android.bindings;
+
+import android.content.ContentProvider;
+import android.content.ContentValues;
+import android.database.Cursor;
+import android.net.Uri;
+import android.os.Build;
+import android.os.ParcelFileDescriptor;
+import android.util.Log;
+
+import java.io.FileNotFoundException;
+
+/**
+ * Hands companion apps the decoded vehicle state, see SharedTelemetry.h.
+ *
+ * content://org.qtproject.qtgstreamer.telemetry/state opens the shared
+ * memory segment, .../notify the eventfd that counts publications. Callers
+ * need the TELEMETRY_READ permission and map the segment natively with
+ * SharedTelemetryLayout.h; it is read only for everyone but this process.
+ */
+public class TelemetryShareProvider extends ContentProvider
+{
+    private static final String TAG = "TelemetryShareProvider";
+
+    // SharedTelemetry::Descriptor
+    private static final int STATE_DESCRIPTOR = 0;
+    private static final int NOTIFY_DESCRIPTOR = 1;
+
+    private static native int nativeSharedFd(int which);
+
+    @Override
+    public boolean onCreate()
+    {
+        return true;
+    }
+
+    @Override
+    public ParcelFileDescriptor openFile(Uri uri, String mode) throws FileNotFoundException
+    {
+        if (!"r".equals(mode)) {
+            throw new FileNotFoundException("Telemetry is read only");
+        }
+        final String path = uri.getLastPathSegment();
+        final int which;
+        if ("state".equals(path)) {
+            which = STATE_DESCRIPTOR;
+        } else if ("notify".equals(path)) {
+            which = NOTIFY_DESCRIPTOR;
+        } else {
+            throw new FileNotFoundException("No telemetry at " + uri);
+        }
+        // ParcelFileDescriptor.adoptFd() came with API 13
+        if (Build.VERSION.SDK_INT < 13) {
+            throw new FileNotFoundException("Shared telemetry needs API 13");
+        }
+        int fd;
+        try {
+            fd = nativeSharedFd(which);
+        } catch (UnsatisfiedLinkError e) {
+            // The Qt libraries are not loaded until the activity starts
+            Log.w(TAG, "Telemetry asked for before the native library was loaded");
+            fd = -1;
+        }
+        if (fd < 0) {
+            throw new FileNotFoundException("Shared telemetry is not available");
+        }
+        return ParcelFileDescriptor.adoptFd(fd);
+    }
+
+    @Override
+    public String getType(Uri uri)
+    {
+        return null;
+    }
+
+    @Override
+    public Cursor query(Uri uri, String[] projection, String selection, String[] selectionArgs, String sortOrder)
+    {
+        return null;
+    }
+
+    @Override
+    public Uri insert(Uri uri, ContentValues values)
+    {
+        return null;
+    }
+
+    @Override
+    public int delete(Uri uri, String selection, String[] selectionArgs)
+    {
+        return 0;
+    }
+
+    @Override
+    public int update(Uri uri, ContentValues values, String selection, String[] selectionArgs)
+    {
+        return 0;
+    }
+}
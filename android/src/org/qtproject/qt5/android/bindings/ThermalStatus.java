@@ -0,0 +1,81 @@
+package org.qtproject.qt5.android.bindings;
+
+import android.content.Context;
+import android.content.Intent;
+import android.content.IntentFilter;
+import android.os.BatteryManager;
+import android.os.PowerManager;
+import android.util.Log;
+
+import java.lang.reflect.Method;
+
+/**
+ * How hot the device runs, for DegradationController.
+ *
+ * Returns the PowerManager thermal status (0 none to 6 shutdown) where the
+ * platform has it. Older devices only report the battery temperature, which
+ * is mapped onto the same scale; the battery lags the SoC but is the best
+ * they offer.
+ */
+public class ThermalStatus
+{
+    private static final String TAG = "ThermalStatus";
+
+    public static final int UNKNOWN = -1;
+    private static final int STATUS_NONE = 0;
+    private static final int STATUS_LIGHT = 1;
+    private static final int STATUS_MODERATE = 2;
+    private static final int STATUS_SEVERE = 3;
+
+    // Battery temperature in tenths of a degree where each status starts
+    private static final int BATTERY_LIGHT = 400;
+    private static final int BATTERY_MODERATE = 430;
+    private static final int BATTERY_SEVERE = 460;
+
+    private static Method s_currentThermalStatus = null;
+    private static boolean s_looked = false;
+
+    /** The current status, UNKNOWN before the activity exists or without a sensor */
+    public static synchronized int status()
+    {
+        Context context = QtActivityEx.s_activity;
+        if (context == null) {
+            return UNKNOWN;
+        }
+        // getCurrentThermalStatus() is API 29, the build targets older SDKs
+        if (!s_looked) {
+            s_looked = true;
+            try {
+                s_currentThermalStatus = PowerManager.class.getMethod("getCurrentThermalStatus");
+            } catch (Exception e) {
+                s_currentThermalStatus = null;
+            }
+        }
+        if (s_currentThermalStatus != null) {
+            try {
+                PowerManager pm = (PowerManager) context.getSystemService(Context.POWER_SERVICE);
+                return ((Integer) s_currentThermalStatus.invoke(pm)).intValue();
+            } catch (Exception e) {
+                Log.w(TAG, "No thermal status: " + e);
+                s_currentThermalStatus = null;
+            }
+        }
+
+        // Sticky broadcast, registering without a receiver only reads it
+        Intent battery = context.registerReceiver(null, new IntentFilter(Intent.ACTION_BATTERY_CHANGED));
+        if (battery == null) {
+            return UNKNOWN;
+        }
+        int temperature = battery.getIntExtra(BatteryManager.EXTRA_TEMPERATURE, Integer.MIN_VALUE);
+        if (temperature == Integer.MIN_VALUE) {
+            return UNKNOWN;
+        }
+        if (temperature >= BATTERY_SEVERE) {
+            return STATUS_SEVERE;
+        }
+        if (temperature >= BATTERY_MODERATE) {
+            return STATUS_MODERATE;
+        }
+        return temperature >= BATTERY_LIGHT ? STATUS_LIGHT : STATUS_NONE;
+    }
+}
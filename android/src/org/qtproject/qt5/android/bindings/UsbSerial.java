@@ -0,0 +1,439 @@
+package org.qtproject.qt5.android.bindings;
+
+import android.app.PendingIntent;
+import android.content.BroadcastReceiver;
+import android.content.Context;
+import android.content.Intent;
+import android.content.IntentFilter;
+import android.hardware.usb.UsbConstants;
+import android.hardware.usb.UsbDevice;
+import android.hardware.usb.UsbDeviceConnection;
+import android.hardware.usb.UsbEndpoint;
+import android.hardware.usb.UsbInterface;
+import android.hardware.usb.UsbManager;
+import android.util.Log;
+import android.util.SparseArray;
+
+import java.util.Arrays;
+
+/**
+ * USB-serial adapters through the Android USB host API, for AndroidSerialLink.
+ *
+ * FTDI, CP210x and CDC-ACM devices are driven directly. Every open port has
+ * a reader thread that issues large bulk IN transfers and hands whatever
+ * arrived to the native side in one call, so a burst of telemetry costs one
+ * JNI round trip rather than one per USB packet.
+ */
+public class UsbSerial
+{
+    private static final String TAG = "UsbSerial";
+    private static final String ACTION_USB_PERMISSION = "org.qtproject.qt5.android.bindings.USB_PERMISSION";
+    private static final String EXTRA_LINK_ID = "linkId";
+
+    /** open() result while the user is asked for access to the device */
+    public static final int PERMISSION_PENDING = -2;
+
+    private static final int DRIVER_NONE = 0;
+    private static final int DRIVER_FTDI = 1;
+    private static final int DRIVER_CP210X = 2;
+    private static final int DRIVER_CDC_ACM = 3;
+
+    private static final int VENDOR_FTDI = 0x0403;
+    private static final int VENDOR_SILABS = 0x10C4;
+
+    // Big enough for a few hundred MAVLink frames, a short packet ends the transfer early
+    private static final int READ_BUFFER_SIZE = 16384;
+    // Only bounds how long close() waits for the reader
+    private static final int READ_TIMEOUT_MS = 200;
+    private static final int WRITE_TIMEOUT_MS = 500;
+    private static final int CONTROL_TIMEOUT_MS = 1000;
+    // FTDI chips start every packet with two modem status bytes
+    private static final int FTDI_STATUS_BYTES = 2;
+
+    private static final SparseArray<Port> s_ports = new SparseArray<Port>();
+    private static int s_nextHandle = 1;
+    private static BroadcastReceiver s_receiver = null;
+
+    private static native void nativeDataReceived(int linkId, byte[] data, int length);
+    private static native void nativePermission(int linkId, boolean granted);
+    private static native void nativeDetached(int linkId);
+
+    private static class Port implements Runnable
+    {
+        final int linkId;
+        final int driver;
+        final UsbDevice device;
+        final UsbDeviceConnection connection;
+        final UsbInterface control;
+        final UsbInterface data;
+        final UsbEndpoint in;
+        final UsbEndpoint out;
+        final Object writeLock = new Object();
+        volatile boolean running = true;
+        Thread reader;
+
+        Port(int linkId, int driver, UsbDevice device, UsbDeviceConnection connection,
+             UsbInterface control, UsbInterface data, UsbEndpoint in, UsbEndpoint out)
+        {
+            this.linkId = linkId;
+            this.driver = driver;
+            this.device = device;
+            this.connection = connection;
+            this.control = control;
+            this.data = data;
+            this.in = in;
+            this.out = out;
+        }
+
+        public void run()
+        {
+            byte[] buffer = new byte[READ_BUFFER_SIZE];
+            byte[] payload = driver == DRIVER_FTDI ? new byte[READ_BUFFER_SIZE] : buffer;
+            int packetSize = in.getMaxPacketSize();
+            while (running) {
+                int length = connection.bulkTransfer(in, buffer, buffer.length, READ_TIMEOUT_MS);
+                if (length <= 0) {
+                    // Timeouts and errors look alike here, a detach is reported by broadcast
+                    continue;
+                }
+                if (driver == DRIVER_FTDI) {
+                    length = stripFtdiStatus(buffer, length, packetSize, payload);
+                }
+                if (length > 0) {
+                    nativeDataReceived(linkId, payload, length);
+                }
+            }
+        }
+    }
+
+    private static UsbManager manager()
+    {
+        if (QtActivityEx.s_activity == null) {
+            return null;
+        }
+        return (UsbManager) QtActivityEx.s_activity.getSystemService(Context.USB_SERVICE);
+    }
+
+    private static int driverOf(UsbDevice device)
+    {
+        if (device.getVendorId() == VENDOR_FTDI) {
+            return DRIVER_FTDI;
+        }
+        if (device.getVendorId() == VENDOR_SILABS) {
+            return DRIVER_CP210X;
+        }
+        for (int i = 0; i < device.getInterfaceCount(); i++) {
+            if (device.getInterface(i).getInterfaceClass() == UsbConstants.USB_CLASS_CDC_DATA) {
+                return DRIVER_CDC_ACM;
+            }
+        }
+        return DRIVER_NONE;
+    }
+
+    /** Names of the attached adapters we can drive, one per line */
+    public static String devices()
+    {
+        UsbManager manager = manager();
+        if (manager == null) {
+            return "";
+        }
+        StringBuilder names = new StringBuilder();
+        for (UsbDevice device : manager.getDeviceList().values()) {
+            if (driverOf(device) != DRIVER_NONE) {
+                if (names.length() > 0) {
+                    names.append('\n');
+                }
+                names.append(device.getDeviceName());
+            }
+        }
+        return names.toString();
+    }
+
+    private static UsbDevice findDevice(UsbManager manager, String deviceName)
+    {
+        UsbDevice fallback = null;
+        for (UsbDevice device : manager.getDeviceList().values()) {
+            if (driverOf(device) == DRIVER_NONE) {
+                continue;
+            }
+            if (device.getDeviceName().equals(deviceName)) {
+                return device;
+            }
+            if (fallback == null) {
+                fallback = device;
+            }
+        }
+        // The name changes when the radio is plugged in again, take the first adapter then
+        return fallback;
+    }
+
+    private static synchronized void registerReceiver()
+    {
+        if (s_receiver != null) {
+            return;
+        }
+        s_receiver = new BroadcastReceiver() {
+            @Override
+            public void onReceive(Context context, Intent intent)
+            {
+                if (ACTION_USB_PERMISSION.equals(intent.getAction())) {
+                    nativePermission(intent.getIntExtra(EXTRA_LINK_ID, -1),
+                                     intent.getBooleanExtra(UsbManager.EXTRA_PERMISSION_GRANTED, false));
+                    return;
+                }
+                UsbDevice device = (UsbDevice) intent.getParcelableExtra(UsbManager.EXTRA_DEVICE);
+                if (device == null) {
+                    return;
+                }
+                synchronized (s_ports) {
+                    for (int i = 0; i < s_ports.size(); i++) {
+                        Port port = s_ports.valueAt(i);
+                        if (port.device.getDeviceName().equals(device.getDeviceName())) {
+                            nativeDetached(port.linkId);
+                        }
+                    }
+                }
+            }
+        };
+        IntentFilter filter = new IntentFilter(ACTION_USB_PERMISSION);
+        filter.addAction(UsbManager.ACTION_USB_DEVICE_DETACHED);
+        QtActivityEx.s_activity.registerReceiver(s_receiver, filter);
+    }
+
+    /**
+     * Open an adapter at baud bits/s 8N1 and start reading.
+     *
+     * @param latencyMs FTDI latency timer, how long the chip holds back a short packet
+     * @return handle for write() and close(), PERMISSION_PENDING or -1
+     */
+    public static int open(String deviceName, int baud, int latencyMs, int linkId)
+    {
+        UsbManager manager = manager();
+        if (manager == null) {
+            return -1;
+        }
+        UsbDevice device = findDevice(manager, deviceName);
+        if (device == null) {
+            return -1;
+        }
+        registerReceiver();
+        if (!manager.hasPermission(device)) {
+            Intent intent = new Intent(ACTION_USB_PERMISSION);
+            intent.putExtra(EXTRA_LINK_ID, linkId);
+            manager.requestPermission(device, PendingIntent.getBroadcast(QtActivityEx.s_activity, linkId, intent, 0));
+            return PERMISSION_PENDING;
+        }
+        UsbDeviceConnection connection = manager.openDevice(device);
+        if (connection == null) {
+            return -1;
+        }
+        Port port = createPort(linkId, device, connection);
+        if (port == null || !configure(port, baud, latencyMs)) {
+            connection.close();
+            return -1;
+        }
+        int handle;
+        synchronized (s_ports) {
+            handle = s_nextHandle++;
+            s_ports.put(handle, port);
+        }
+        port.reader = new Thread(port, "UsbSerial " + device.getDeviceName());
+        port.reader.setPriority(Thread.MAX_PRIORITY);
+        port.reader.start();
+        return handle;
+    }
+
+    private static Port createPort(int linkId, UsbDevice device, UsbDeviceConnection connection)
+    {
+        int driver = driverOf(device);
+        UsbInterface control = null;
+        UsbInterface data = null;
+        if (driver != DRIVER_CDC_ACM) {
+            data = device.getInterface(0);
+        }
+        for (int i = 0; driver == DRIVER_CDC_ACM && i < device.getInterfaceCount(); i++) {
+            UsbInterface iface = device.getInterface(i);
+            if (iface.getInterfaceClass() == UsbConstants.USB_CLASS_COMM && control == null) {
+                control = iface;
+            } else if (iface.getInterfaceClass() == UsbConstants.USB_CLASS_CDC_DATA && data == null) {
+                data = iface;
+            }
+        }
+        if (data == null) {
+            return null;
+        }
+        if (control != null && !connection.claimInterface(control, true)) {
+            return null;
+        }
+        if (!connection.claimInterface(data, true)) {
+            return null;
+        }
+        UsbEndpoint in = null;
+        UsbEndpoint out = null;
+        for (int i = 0; i < data.getEndpointCount(); i++) {
+            UsbEndpoint endpoint = data.getEndpoint(i);
+            if (endpoint.getType() != UsbConstants.USB_ENDPOINT_XFER_BULK) {
+                continue;
+            }
+            if (endpoint.getDirection() == UsbConstants.USB_DIR_IN) {
+                in = endpoint;
+            } else {
+                out = endpoint;
+            }
+        }
+        if (in == null || out == null) {
+            return null;
+        }
+        return new Port(linkId, driver, device, connection, control != null ? control : data, data, in, out);
+    }
+
+    private static boolean controlOut(Port port, int requestType, int request, int value, int index, byte[] buffer)
+    {
+        int length = buffer != null ? buffer.length : 0;
+        int result = port.connection.controlTransfer(requestType, request, value, index, buffer, length, CONTROL_TIMEOUT_MS);
+        if (result < 0) {
+            Log.w(TAG, "Control request " + request + " failed on " + port.device.getDeviceName());
+            return false;
+        }
+        return true;
+    }
+
+    private static boolean configure(Port port, int baud, int latencyMs)
+    {
+        switch (port.driver) {
+        case DRIVER_FTDI: {
+            int index = port.control.getId() + 1;
+            controlOut(port, 0x40, 0x00, 0, index, null);                       // SIO_RESET
+            controlOut(port, 0x40, 0x02, 0, index, null);                       // No flow control
+            controlOut(port, 0x40, 0x04, 0x0008, index, null);                  // 8N1
+            controlOut(port, 0x40, 0x01, 0x0303, index, null);                  // DTR and RTS on
+            controlOut(port, 0x40, 0x09, Math.max(1, Math.min(255, latencyMs)), index, null);
+            break;
+        }
+        case DRIVER_CP210X: {
+            controlOut(port, 0x41, 0x00, 0x0001, 0, null);                      // IFC_ENABLE
+            controlOut(port, 0x41, 0x03, 0x0800, 0, null);                      // 8N1
+            controlOut(port, 0x41, 0x07, 0x0303, 0, null);                      // DTR and RTS on
+            break;
+        }
+        case DRIVER_CDC_ACM:
+            controlOut(port, 0x21, 0x22, 0x0003, port.control.getId(), null);   // SET_CONTROL_LINE_STATE
+            break;
+        default:
+            return false;
+        }
+        return setBaud(port, baud);
+    }
+
+    private static boolean setBaud(Port port, int baud)
+    {
+        if (baud <= 0) {
+            return false;
+        }
+        byte[] le = { (byte) baud, (byte) (baud >> 8), (byte) (baud >> 16), (byte) (baud >> 24) };
+        switch (port.driver) {
+        case DRIVER_FTDI: {
+            int divisor = ftdiDivisor(baud);
+            int index = (divisor >> 16) & 0xFFFF;
+            if (port.device.getInterfaceCount() > 1) {
+                // Multi port chips carry the port in the low byte
+                index = ((divisor >> 8) & 0xFF00) | (port.control.getId() + 1);
+            }
+            return controlOut(port, 0x40, 0x03, divisor & 0xFFFF, index, null);
+        }
+        case DRIVER_CP210X:
+            return controlOut(port, 0x41, 0x1E, 0, 0, le);                      // SET_BAUDRATE
+        case DRIVER_CDC_ACM: {
+            byte[] coding = Arrays.copyOf(le, 7);                               // 1 stop bit, no parity
+            coding[6] = 8;
+            return controlOut(port, 0x21, 0x20, 0, port.control.getId(), coding);
+        }
+        }
+        return false;
+    }
+
+    /** FT232BM and later, baud = 3 MHz / (n + fraction in eighths) */
+    private static int ftdiDivisor(int baud)
+    {
+        final int[] fraction = { 0, 3, 2, 4, 1, 5, 6, 7 };
+        int divisor3 = (48000000 / 2 + baud / 2) / baud;
+        int divisor = (divisor3 >> 3) | (fraction[divisor3 & 0x7] << 14);
+        if (divisor == 1) {
+            divisor = 0;                // 3 Mbaud
+        } else if (divisor == 0x4001) {
+            divisor = 1;                // 2 Mbaud
+        }
+        return divisor;
+    }
+
+    private static int stripFtdiStatus(byte[] buffer, int length, int packetSize, byte[] payload)
+    {
+        int written = 0;
+        for (int offset = 0; offset < length; offset += packetSize) {
+            int chunk = Math.min(packetSize, length - offset) - FTDI_STATUS_BYTES;
+            if (chunk > 0) {
+                System.arraycopy(buffer, offset + FTDI_STATUS_BYTES, payload, written, chunk);
+                written += chunk;
+            }
+        }
+        return written;
+    }
+
+    private static Port port(int handle)
+    {
+        synchronized (s_ports) {
+            return s_ports.get(handle);
+        }
+    }
+
+    public static boolean setBaudRate(int handle, int baud)
+    {
+        Port port = port(handle);
+        return port != null && setBaud(port, baud);
+    }
+
+    /** Blocking write from any thread, the bytes written or -1 */
+    public static int write(int handle, byte[] buffer)
+    {
+        Port port = port(handle);
+        if (port == null) {
+            return -1;
+        }
+        synchronized (port.writeLock) {
+            int offset = 0;
+            while (offset < buffer.length) {
+                byte[] chunk = offset == 0 ? buffer : Arrays.copyOfRange(buffer, offset, buffer.length);
+                int written = port.connection.bulkTransfer(port.out, chunk, chunk.length, WRITE_TIMEOUT_MS);
+                if (written <= 0) {
+                    return offset > 0 ? offset : -1;
+                }
+                offset += written;
+            }
+        }
+        return buffer.length;
+    }
+
+    /** Stop the reader and release the device, no data callback runs after it returns */
+    public static void close(int handle)
+    {
+        Port port;
+        synchronized (s_ports) {
+            port = s_ports.get(handle);
+            s_ports.remove(handle);
+        }
+        if (port == null) {
+            return;
+        }
+        port.running = false;
+        try {
+            port.reader.join();
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+        port.connection.releaseInterface(port.data);
+        if (port.control != port.data) {
+            port.connection.releaseInterface(port.control);
+        }
+        port.connection.close();
+    }
+}
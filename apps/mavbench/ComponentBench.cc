@@ -0,0 +1,475 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ComponentBench
+ *          See ComponentBench.h
+ *
+ */
+
+#include "ComponentBench.h"
+#include "MAVBench.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QTextStream>
+#include <QThread>
+#include <QUdpSocket>
+#include "LinkManager1.h"
+#include "MAVLinkDecoder1.h"
+#include "MAVLinkProtocol1.h"
+#include "QCurrentState.h"
+#include "UAS1.h"
+#include "UASManager1.h"
+#include "UDPLink1.h"
+#include "comm/VehicleOverview.h"
+
+namespace {
+enum {
+    MessageHeartbeat,
+    MessageAttitude,
+    MessageGlobalPosition,
+    MessageVfrHud,
+    MessageGpsRaw,
+    MessageSysStatus,
+    MessageRcChannels,
+    MessageCount
+};
+}
+
+static const char currentStateQml[] =
+        "import QtQml 2.0\n"
+        "QtObject {\n"
+        "    property real roll: currentState.roll\n"
+        "    property real pitch: currentState.pitch\n"
+        "    property real yaw: currentState.yaw\n"
+        "    property real altitude: currentState.altitude\n"
+        "    property string speed: (currentState.groundspeed * 3.6).toFixed(1)\n"
+        "}\n";
+
+static const char overviewQml[] =
+        "import QtQml 2.0\n"
+        "QtObject {\n"
+        "    property real voltage: overview.sys_status.voltage_battery / 1000\n"
+        "    property int load: overview.sys_status.load\n"
+        "    property int remaining: overview.sys_status.battery_remaining\n"
+        "}\n";
+
+ComponentBench::ComponentBench(QObject *parent) :
+    QObject(parent),
+    m_link(NULL),
+    m_decoder(NULL),
+    m_uas(NULL),
+    m_engine(NULL),
+    m_currentState(NULL),
+    m_overview(NULL),
+    m_udp(NULL),
+    m_udpSender(NULL),
+    m_sink(0),
+    m_failures(0)
+{
+    m_bindings[0] = NULL;
+    m_bindings[1] = NULL;
+}
+
+ComponentBench::~ComponentBench()
+{
+    tearDown();
+}
+
+const ComponentBench::Case *ComponentBench::caseTable(int *count)
+{
+    static const Case table[] = {
+        { "decoder.heartbeat", &ComponentBench::decoderBody, MessageHeartbeat },
+        { "decoder.attitude", &ComponentBench::decoderBody, MessageAttitude },
+        { "decoder.global_position_int", &ComponentBench::decoderBody, MessageGlobalPosition },
+        { "decoder.vfr_hud", &ComponentBench::decoderBody, MessageVfrHud },
+        { "decoder.gps_raw_int", &ComponentBench::decoderBody, MessageGpsRaw },
+        { "decoder.sys_status", &ComponentBench::decoderBody, MessageSysStatus },
+        { "decoder.rc_channels_raw", &ComponentBench::decoderBody, MessageRcChannels },
+        { "uas.heartbeat", &ComponentBench::uasBody, MessageHeartbeat },
+        { "uas.attitude", &ComponentBench::uasBody, MessageAttitude },
+        { "uas.global_position_int", &ComponentBench::uasBody, MessageGlobalPosition },
+        { "uas.vfr_hud", &ComponentBench::uasBody, MessageVfrHud },
+        { "uas.gps_raw_int", &ComponentBench::uasBody, MessageGpsRaw },
+        { "uas.sys_status", &ComponentBench::uasBody, MessageSysStatus },
+        { "uas.rc_channels_raw", &ComponentBench::uasBody, MessageRcChannels },
+        { "qml.currentstate", &ComponentBench::currentStateBody, 0 },
+        { "qml.vehicleoverview", &ComponentBench::overviewBody, 0 },
+        { "params.find_name", &ComponentBench::paramFindNameBody, 0 },
+        { "params.find_id", &ComponentBench::paramFindIdBody, 0 },
+        { "params.value", &ComponentBench::paramValueBody, 0 },
+        { "udp.read", &ComponentBench::udpBody, 0 },
+        { "geo.wgs84_to_enu", &ComponentBench::geoSingleBody, 0 },
+        { "geo.wgs84_to_enu_batch", &ComponentBench::geoBatchBody, 0 },
+        { "geo.enu_to_wgs84", &ComponentBench::geoInverseBody, 0 }
+    };
+    *count = sizeof(table) / sizeof(table[0]);
+    return table;
+}
+
+QStringList ComponentBench::cases()
+{
+    int count;
+    const Case *table = caseTable(&count);
+    QStringList names;
+    for (int i = 0; i < count; i++)
+    {
+        names << table[i].name;
+    }
+    return names;
+}
+
+bool ComponentBench::setUp()
+{
+    m_link = new BenchLink("components");
+    m_link->setParent(this);
+
+    m_messages.resize(MessageCount);
+    mavlink_msg_heartbeat_pack(BenchSystem, 1, &m_messages[MessageHeartbeat], MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA,
+                               MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, 5, MAV_STATE_ACTIVE);
+    mavlink_msg_attitude_pack(BenchSystem, 1, &m_messages[MessageAttitude], 1000, 0.1f, -0.05f, 1.2f, 0.01f, 0.02f, 0.03f);
+    mavlink_msg_global_position_int_pack(BenchSystem, 1, &m_messages[MessageGlobalPosition], 1000, 473977418, 85455938,
+                                         500000, 20000, 100, 50, -10, 9000);
+    mavlink_msg_vfr_hud_pack(BenchSystem, 1, &m_messages[MessageVfrHud], 18.0f, 17.5f, 90, 55, 20.0f, 0.5f);
+    mavlink_msg_gps_raw_int_pack(BenchSystem, 1, &m_messages[MessageGpsRaw], 1000, 3, 473977418, 85455938, 500000,
+                                 120, 150, 1800, 9000, 10);
+    mavlink_msg_sys_status_pack(BenchSystem, 1, &m_messages[MessageSysStatus], 0, 0, 0, 500, 12400, 1500, 80, 0, 0, 0, 0, 0, 0);
+    mavlink_msg_rc_channels_raw_pack(BenchSystem, 1, &m_messages[MessageRcChannels], 1000, 0,
+                                     1500, 1500, 1100, 1500, 1800, 1000, 1500, 1500, 200);
+    mavlink_msg_sys_status_pack(BenchSystem, 1, &m_sysStatus[0], 0, 0, 0, 500, 12400, 1500, 80, 0, 0, 0, 0, 0, 0);
+    mavlink_msg_sys_status_pack(BenchSystem, 1, &m_sysStatus[1], 0, 0, 0, 510, 12300, 1600, 79, 0, 0, 0, 0, 0, 0);
+
+    // Every field decoded and emitted, as with a plot on each
+    m_decoder = new MAVLinkDecoder(this);
+    for (int i = 0; i < MessageCount; i++)
+    {
+        m_decoder->subscribe(m_messages[i].msgid);
+    }
+    m_uas = new UAS(LinkManager::instance()->getMavlinkProtocol(), BenchSystem);
+
+    m_engine = new QQmlEngine(this);
+    m_currentState = new QCurrentState(this);
+    m_overview = new VehicleOverview(this);
+    m_engine->rootContext()->setContextProperty("currentState", m_currentState);
+    m_engine->rootContext()->setContextProperty("overview", m_overview);
+    const char *sources[2] = { currentStateQml, overviewQml };
+    for (int i = 0; i < 2; i++)
+    {
+        QQmlComponent component(m_engine);
+        component.setData(sources[i], QUrl());
+        m_bindings[i] = component.create();
+        if (!m_bindings[i])
+        {
+            QTextStream(stderr) << "QML bindings: " << component.errorString() << endl;
+            return false;
+        }
+    }
+
+    // Names as an ArduCopter list has them, 16 characters at most
+    for (int i = 0; i < Parameters; i++)
+    {
+        const QString name = QString("PARAM_%1_%2").arg(i / 40).arg(i % 40, 3, 10, QChar('0'));
+        m_parameterNames << name;
+        m_parameterIds << ParameterId(name);
+        m_parameters.insert(1, i, Parameters, ParameterId(name), MAV_PARAM_TYPE_REAL32, 0x3f800000u + i);
+    }
+
+    for (int i = 0; i < GeoBatch; i++)
+    {
+        m_lat[i] = UASManager::instance()->getHomeLatitude() + i * 1E-5;
+        m_lon[i] = UASManager::instance()->getHomeLongitude() - i * 1E-5;
+        m_alt[i] = UASManager::instance()->getHomeAltitude() + i;
+        m_east[i] = i * 1.5;
+        m_north[i] = -i * 0.5;
+        m_up[i] = i * 0.1;
+    }
+
+    // Full datagram of whole frames
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    for (int i = 0; m_datagram.size() < 1400; i++)
+    {
+        const int length = mavlink_msg_to_send_buffer(buffer, &m_messages[i % MessageCount]);
+        m_datagram.append(reinterpret_cast<const char*>(buffer), length);
+    }
+    m_udp = new UDPLink(QHostAddress::LocalHost, UdpPort);
+    connect(m_udp, SIGNAL(bytesReceived(LinkInterface*,QByteArray)),
+            this, SLOT(udpBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    if (!m_udp->connect())
+    {
+        QTextStream(stderr) << "udp.read: cannot bind port " << UdpPort << endl;
+        delete m_udp;
+        m_udp = NULL;
+    }
+    m_udpSender = new QUdpSocket(this);
+    return true;
+}
+
+void ComponentBench::tearDown()
+{
+    if (m_udp)
+    {
+        m_udp->disconnect();
+        delete m_udp;
+        m_udp = NULL;
+    }
+    delete m_bindings[0];
+    delete m_bindings[1];
+    m_bindings[0] = NULL;
+    m_bindings[1] = NULL;
+    delete m_uas;
+    m_uas = NULL;
+}
+
+void ComponentBench::udpBytes(LinkInterface *link, QByteArray data)
+{
+    Q_UNUSED(link);
+    m_udpReceived.fetchAndAddRelaxed(data.size());
+}
+
+ComponentBench::Measurement ComponentBench::measure(const Case &benchCase)
+{
+    Measurement result;
+    result.name = benchCase.name;
+    int iterations = 1;
+    forever
+    {
+        const int allocations = MAVBench::allocations();
+        QElapsedTimer timer;
+        timer.start();
+        (this->*benchCase.body)(benchCase.arg, iterations);
+        const qint64 elapsed = timer.nsecsElapsed();
+        result.iterations = iterations;
+        result.elapsedNs = elapsed;
+        result.allocations = MAVBench::allocations() - allocations;
+        // Queued signals of the run are delivered outside the timing
+        QCoreApplication::processEvents();
+        if (elapsed >= Q_INT64_C(1000000) * MinRunMs || iterations >= MaxIterations)
+        {
+            return result;
+        }
+        iterations *= 2;
+    }
+}
+
+QList<ComponentBench::Measurement> ComponentBench::run(const QStringList &filters, int repeat)
+{
+    QList<Measurement> results;
+    if (!setUp())
+    {
+        m_failures++;
+        return results;
+    }
+    int count;
+    const Case *table = caseTable(&count);
+    for (int i = 0; i < count; i++)
+    {
+        const QString name = table[i].name;
+        bool selected = filters.isEmpty();
+        foreach (const QString &filter, filters)
+        {
+            selected = selected || name.startsWith(filter);
+        }
+        if (!selected)
+        {
+            continue;
+        }
+        if (table[i].body == &ComponentBench::udpBody && !m_udp)
+        {
+            m_failures++;
+            continue;
+        }
+        Measurement best = measure(table[i]);
+        for (int pass = 1; pass < repeat; pass++)
+        {
+            Measurement next = measure(table[i]);
+            if (next.nsPerOp() < best.nsPerOp())
+            {
+                best = next;
+            }
+        }
+        results.append(best);
+    }
+    tearDown();
+    return results;
+}
+
+void ComponentBench::decoderBody(int message, int iterations)
+{
+    const mavlink_message_t &frame = m_messages.at(message);
+    for (int i = 0; i < iterations; i++)
+    {
+        m_decoder->receiveMessage(m_link, frame);
+    }
+}
+
+void ComponentBench::uasBody(int message, int iterations)
+{
+    const mavlink_message_t &frame = m_messages.at(message);
+    for (int i = 0; i < iterations; i++)
+    {
+        m_uas->receiveMessage(m_link, frame);
+    }
+}
+
+void ComponentBench::currentStateBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    // One attitude and position update, every value a little different so every binding runs
+    for (int i = 0; i < iterations; i++)
+    {
+        const float step = (i & 1023) * 0.001f;
+        m_currentState->setRoll(step);
+        m_currentState->setPitch(-step);
+        m_currentState->setYaw(step * 3);
+        m_currentState->setAltitude(100 + step);
+        m_currentState->setGroundspeed(10 + step);
+    }
+}
+
+void ComponentBench::overviewBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    for (int i = 0; i < iterations; i++)
+    {
+        m_overview->messageReceived(m_link, m_sysStatus[i & 1]);
+    }
+}
+
+void ComponentBench::paramFindNameBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    int found = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        found += m_parameters.find(1, m_parameterNames.at(i % Parameters)) >= 0;
+    }
+    m_sink = found;
+}
+
+void ComponentBench::paramFindIdBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    int found = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        found += m_parameters.find(1, m_parameterIds.at(i % Parameters)) >= 0;
+    }
+    m_sink = found;
+}
+
+void ComponentBench::paramValueBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    // What QGCUASParamManager::getParameterValue() does per call
+    double sum = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        const ParameterStore::Handle handle = m_parameters.find(1, m_parameterNames.at(i % Parameters));
+        sum += m_parameters.toVariant(handle).toDouble();
+    }
+    m_sink = sum;
+}
+
+void ComponentBench::udpBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    const int size = m_datagram.size();
+    const int start = m_udpReceived.load();
+    int sent = 0;
+    QElapsedTimer stall;
+    stall.start();
+    int lastReceived = 0;
+    forever
+    {
+        const int received = (m_udpReceived.load() - start) / size;
+        if (received >= iterations)
+        {
+            return;
+        }
+        if (received != lastReceived)
+        {
+            lastReceived = received;
+            stall.restart();
+        }
+        else if (stall.elapsed() > UdpTimeoutMs)
+        {
+            // Loopback dropped some, the run counts what arrived
+            QTextStream(stderr) << "udp.read: " << iterations - received << " of " << iterations << " datagrams lost" << endl;
+            return;
+        }
+        while (sent < iterations && sent - received < UdpWindow)
+        {
+            m_udpSender->writeDatagram(m_datagram, QHostAddress::LocalHost, UdpPort);
+            sent++;
+        }
+        QThread::yieldCurrentThread();
+    }
+}
+
+void ComponentBench::geoSingleBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    UASManager *manager = UASManager::instance();
+    double sum = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        const int k = i & (GeoBatch - 1);
+        double east, north, up;
+        manager->wgs84ToEnu(m_lat[k], m_lon[k], m_alt[k], &east, &north, &up);
+        sum += east + north + up;
+    }
+    m_sink = sum;
+}
+
+void ComponentBench::geoBatchBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    // One iteration is one position, converted GeoBatch at a time
+    UASManager *manager = UASManager::instance();
+    double sum = 0;
+    for (int done = 0; done < iterations; done += GeoBatch)
+    {
+        const int count = qMin(static_cast<int>(GeoBatch), iterations - done);
+        manager->wgs84ToEnu(m_lat, m_lon, m_alt, count, m_east, m_north, m_up);
+        sum += m_east[0];
+    }
+    m_sink = sum;
+}
+
+void ComponentBench::geoInverseBody(int arg, int iterations)
+{
+    Q_UNUSED(arg);
+    UASManager *manager = UASManager::instance();
+    double sum = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        const int k = i & (GeoBatch - 1);
+        double lat, lon, alt;
+        manager->enuToWgs84(m_east[k], m_north[k], m_up[k], &lat, &lon, &alt);
+        sum += lat + lon + alt;
+    }
+    m_sink = sum;
+}
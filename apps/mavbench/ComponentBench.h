@@ -0,0 +1,146 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief ComponentBench
+ *          Micro benchmarks of the hot path components one at a time:
+ *          MAVLinkDecoder and UAS per message type, QCurrentState and
+ *          VehicleOverview updates with QML bindings on them, parameter
+ *          lookups, UDPLink reads and the UASManager geo conversions.
+ *          Each case runs with doubling iteration counts until one run
+ *          takes MinRunMs, the way QBENCHMARK settles, and the fastest of
+ *          --repeat runs is reported.
+ *
+ */
+
+#ifndef COMPONENTBENCH_H
+#define COMPONENTBENCH_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "ParameterStore.h"
+
+class BenchLink;
+class MAVLinkDecoder;
+class UAS;
+class QCurrentState;
+class VehicleOverview;
+class UDPLink;
+class QUdpSocket;
+class QQmlEngine;
+class QObject;
+class LinkInterface;
+
+class ComponentBench : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        MinRunMs = 200,
+        MaxIterations = 1 << 24,
+        BenchSystem = 201,       ///< Sysid of the messages and the benchmark's own UAS
+        Parameters = 800,        ///< About an ArduCopter parameter list
+        GeoBatch = 256,
+        UdpPort = 14597,
+        UdpWindow = 32,          ///< Datagrams in flight, loopback drops beyond the socket buffer
+        UdpTimeoutMs = 2000
+    };
+
+    struct Measurement
+    {
+        QString name;
+        qint64 iterations;
+        qint64 elapsedNs;
+        qint64 allocations;
+        double nsPerOp() const { return iterations ? double(elapsedNs) / iterations : 0.0; }
+        double allocationsPerOp() const { return iterations ? double(allocations) / iterations : 0.0; }
+    };
+
+    explicit ComponentBench(QObject *parent = 0);
+    ~ComponentBench();
+
+    /** @brief Every case name, "group.case" */
+    static QStringList cases();
+    /** @brief Runs the cases whose name starts with one of filters (all if empty), best of repeat each */
+    QList<Measurement> run(const QStringList &filters, int repeat);
+    /** @brief Cases that could not run, e.g. the UDP port was taken */
+    int failures() const { return m_failures; }
+
+private slots:
+    /** @brief UDPLink thread, direct connection */
+    void udpBytes(LinkInterface *link, QByteArray data);
+
+private:
+    typedef void (ComponentBench::*Body)(int arg, int iterations);
+    struct Case
+    {
+        const char *name;
+        Body body;
+        int arg;
+    };
+
+    bool setUp();
+    void tearDown();
+    Measurement measure(const Case &benchCase);
+    static const Case *caseTable(int *count);
+
+    void decoderBody(int message, int iterations);
+    void uasBody(int message, int iterations);
+    void currentStateBody(int arg, int iterations);
+    void overviewBody(int arg, int iterations);
+    void paramFindNameBody(int arg, int iterations);
+    void paramFindIdBody(int arg, int iterations);
+    void paramValueBody(int arg, int iterations);
+    void udpBody(int arg, int iterations);
+    void geoSingleBody(int arg, int iterations);
+    void geoBatchBody(int arg, int iterations);
+    void geoInverseBody(int arg, int iterations);
+
+    BenchLink *m_link;
+    QVector<mavlink_message_t> m_messages;   ///< One per message type, see caseTable()
+    mavlink_message_t m_sysStatus[2];        ///< Alternated so every update changes the group
+    MAVLinkDecoder *m_decoder;
+    UAS *m_uas;
+    QQmlEngine *m_engine;
+    QCurrentState *m_currentState;
+    VehicleOverview *m_overview;
+    QObject *m_bindings[2];                  ///< QML objects bound to the two
+    ParameterStore m_parameters;
+    QStringList m_parameterNames;
+    QVector<ParameterId> m_parameterIds;
+    UDPLink *m_udp;
+    QUdpSocket *m_udpSender;
+    QByteArray m_datagram;
+    QAtomicInt m_udpReceived;                ///< Bytes, from the link thread
+    double m_lat[GeoBatch], m_lon[GeoBatch], m_alt[GeoBatch];
+    double m_east[GeoBatch], m_north[GeoBatch], m_up[GeoBatch];
+    volatile double m_sink;                  ///< Keeps results the optimizer would drop
+    int m_failures;
+};
+
+#endif // COMPONENTBENCH_H
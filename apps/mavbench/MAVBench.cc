@@ -0,0 +1,667 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVBench
+ *          See MAVBench.h
+ *
+ */
+
+#include "MAVBench.h"
+#include "ComponentBench.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include <QTextStream>
+#include <QThread>
+#include <QFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QPair>
+#include <QtEndian>
+#include "LinkManager1.h"
+#include "UASManager1.h"
+#include "MAVLink2.h"
+#include "UASInterface1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkDispatcher.h"
+#include "CompressedTlog.h"
+#include "MAVLinkCrc.h"
+
+int MAVBench::s_dispatched = 0;
+
+// Keep the ingest ring below this so the benchmark measures parsing, not drops
+static const int maxPendingReads = 192;
+// A run that makes no progress for this long is reported as stalled
+static const int stallTimeoutMs = 2000;
+
+MAVBench::MAVBench(QObject *parent) :
+    QObject(parent),
+    m_protocol(NULL),
+    m_frames(200000),
+    m_noisePercent(10),
+    m_vehicles(4),
+    m_repeat(1),
+    m_signals(0),
+    m_failures(0)
+{
+}
+
+bool MAVBench::configure(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the MAVLink receive path with recorded and synthetic streams");
+    parser.addHelpOption();
+
+    QCommandLineOption scenarioOption("scenario", "Run only these scenarios: attitude, fragmented, mavlink2, noise, mixed, tlog, crc, components.", "name");
+    QCommandLineOption tlogOption("tlog", "Recorded capture (.tlog or .ctlog) for the tlog scenario.", "file");
+    QCommandLineOption framesOption("frames", "Frames per synthetic stream.", "count", QString::number(m_frames));
+    QCommandLineOption noiseOption("noise", "Bytes of line noise per 100 frame bytes in the noise scenario.", "percent", QString::number(m_noisePercent));
+    QCommandLineOption vehiclesOption("vehicles", "Systems in the mixed scenario.", "count", QString::number(m_vehicles));
+    QCommandLineOption repeatOption("repeat", "Run every scenario this many times.", "count", QString::number(m_repeat));
+    parser.addOption(scenarioOption);
+    parser.addOption(tlogOption);
+    parser.addOption(framesOption);
+    parser.addOption(noiseOption);
+    parser.addOption(vehiclesOption);
+    QCommandLineOption impairOption("impair", "Impair the reads of every scenario, e.g. loss=2,ber=1e-6,reorder=1,jitter=20,packet=64.", "spec");
+    QCommandLineOption caseOption("case", "Component benchmarks to run, by name prefix, e.g. uas or decoder.attitude. "
+                                  "All of: " + ComponentBench::cases().join(", ") + ".", "name");
+    QCommandLineOption jsonOption("json", "Also write every result to this file as JSON.", "file");
+    QCommandLineOption labelOption("label", "Stored with the JSON results, e.g. the commit.", "text");
+    parser.addOption(repeatOption);
+    parser.addOption(impairOption);
+    parser.addOption(caseOption);
+    parser.addOption(jsonOption);
+    parser.addOption(labelOption);
+    parser.process(arguments);
+
+    m_tlogFile = parser.value(tlogOption);
+    m_frames = qMax(1, parser.value(framesOption).toInt());
+    m_noisePercent = qBound(0, parser.value(noiseOption).toInt(), 100);
+    m_vehicles = qBound(1, parser.value(vehiclesOption).toInt(), 250);
+    m_repeat = qMax(1, parser.value(repeatOption).toInt());
+    bool ok = true;
+    m_impairment = LinkImpairment::Settings::fromString(parser.value(impairOption), &ok);
+    if (!ok)
+    {
+        QTextStream(stderr) << "Bad impairment " << parser.value(impairOption) << endl;
+        return false;
+    }
+    m_cases = parser.values(caseOption);
+    m_jsonFile = parser.value(jsonOption);
+    m_label = parser.value(labelOption);
+    m_scenarios = parser.values(scenarioOption);
+    if (!m_cases.isEmpty() && !m_scenarios.contains("components"))
+    {
+        m_scenarios << "components";
+    }
+    if (m_scenarios.isEmpty())
+    {
+        m_scenarios << "attitude" << "fragmented" << "mavlink2" << "noise" << "mixed";
+        if (!m_tlogFile.isEmpty())
+        {
+            m_scenarios << "tlog";
+        }
+    }
+    return true;
+}
+
+void MAVBench::appendFrame(QByteArray *stream, const mavlink_message_t &message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int length = mavlink_msg_to_send_buffer(buffer, &message);
+    stream->append((const char*)buffer, length);
+}
+
+MAVBench::Scenario MAVBench::attitudeScenario() const
+{
+    // One vehicle streaming ATTITUDE as fast as the link allows, read by a serial port
+    Scenario scenario;
+    scenario.name = "attitude";
+    scenario.frames = m_frames;
+    scenario.lossy = false;
+    scenario.minChunk = 512;
+    scenario.maxChunk = 512;
+    mavlink_message_t message;
+    for (int i = 0; i < m_frames; i++)
+    {
+        if (i % 50 == 0)
+        {
+            mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA,
+                                       MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, 0, MAV_STATE_ACTIVE);
+        }
+        else
+        {
+            mavlink_msg_attitude_pack(1, 1, &message, i, 0.01f * (i % 100), -0.01f * (i % 50), 0.001f * i, 0, 0, 0);
+        }
+        appendFrame(&scenario.stream, message);
+    }
+    return scenario;
+}
+
+MAVBench::Scenario MAVBench::fragmentedScenario() const
+{
+    // Same stream cut into small reads so most frames straddle two of them
+    Scenario scenario = attitudeScenario();
+    scenario.name = "fragmented";
+    scenario.minChunk = 1;
+    scenario.maxChunk = 40;
+    return scenario;
+}
+
+MAVBench::Scenario MAVBench::mavlink2Scenario() const
+{
+    // The attitude stream framed as MAVLink 2, truncated payloads, reads of any size
+    Scenario scenario;
+    scenario.name = "mavlink2";
+    scenario.frames = m_frames;
+    scenario.lossy = false;
+    scenario.minChunk = 1;
+    scenario.maxChunk = 512;
+    mavlink_message_t message;
+    uint8_t buffer[MAVLINK2_NUM_NON_PAYLOAD_BYTES + MAVLINK_MAX_PAYLOAD_LEN];
+    for (int i = 0; i < m_frames; i++)
+    {
+        if (i % 50 == 0)
+        {
+            mavlink_msg_heartbeat_pack(1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA,
+                                       MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, 0, MAV_STATE_ACTIVE);
+        }
+        else
+        {
+            mavlink_msg_attitude_pack(1, 1, &message, i, 0.01f * (i % 100), -0.01f * (i % 50), 0.001f * i, 0, 0, 0);
+        }
+        message.seq = (uint8_t)i;
+        int length = mavlink2_pack(message, buffer);
+        scenario.stream.append((const char*)buffer, length);
+    }
+    return scenario;
+}
+
+MAVBench::Scenario MAVBench::noiseScenario() const
+{
+    Scenario scenario;
+    scenario.name = "noise";
+    scenario.frames = m_frames;
+    scenario.lossy = true;
+    scenario.minChunk = 256;
+    scenario.maxChunk = 1024;
+    Scenario clean = attitudeScenario();
+
+    // Random bytes between frames, an STX among them every now and then
+    qsrand(1);
+    int offset = 0;
+    const uchar *data = (const uchar*)clean.stream.constData();
+    while (offset < clean.stream.size())
+    {
+        int length = MAVLINK_NUM_NON_PAYLOAD_BYTES + data[offset + 1];
+        scenario.stream.append((const char*)data + offset, length);
+        int noise = (length * m_noisePercent) / 100;
+        for (int i = 0; i < noise; i++)
+        {
+            char byte = (char)(qrand() & 0xFF);
+            if (byte == (char)MAVLINK_STX && (qrand() % 4) != 0)
+            {
+                byte = 0;
+            }
+            scenario.stream.append(byte);
+        }
+        offset += length;
+    }
+    return scenario;
+}
+
+MAVBench::Scenario MAVBench::mixedScenario() const
+{
+    // Several vehicles on one UDP port, full sized datagrams
+    Scenario scenario;
+    scenario.name = "mixed";
+    scenario.frames = m_frames;
+    scenario.lossy = false;
+    scenario.minChunk = 1472;
+    scenario.maxChunk = 1472;
+    mavlink_message_t message;
+    for (int i = 0; i < m_frames; i++)
+    {
+        int sysid = 1 + (i % m_vehicles);
+        int step = i / m_vehicles;
+        switch (step % 6)
+        {
+        case 0:
+            mavlink_msg_heartbeat_pack(sysid, 1, &message, MAV_TYPE_FIXED_WING, MAV_AUTOPILOT_ARDUPILOTMEGA,
+                                       MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, step % 16, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            mavlink_msg_attitude_pack(sysid, 1, &message, step, 0.1f, 0.2f, 0.3f, 0, 0, 0);
+            break;
+        case 2:
+            mavlink_msg_global_position_int_pack(sysid, 1, &message, step, 473977418 + step, 85455938, 500000, 20000, 100, 0, 0, 9000);
+            break;
+        case 3:
+            mavlink_msg_vfr_hud_pack(sysid, 1, &message, 18.0f, 17.5f, 90, 55, 20.0f, 0.5f);
+            break;
+        case 4:
+            mavlink_msg_gps_raw_int_pack(sysid, 1, &message, step, 3, 473977418, 85455938, 500000, 120, 150, 1800, 9000, 10);
+            break;
+        default:
+            mavlink_msg_sys_status_pack(sysid, 1, &message, 0, 0, 0, 500, 12400, 1500, 80, 0, 0, 0, 0, 0, 0);
+            break;
+        }
+        appendFrame(&scenario.stream, message);
+    }
+    return scenario;
+}
+
+bool MAVBench::tlogScenario(Scenario *scenario) const
+{
+    QByteArray records;
+    if (CompressedTlog::isCompressedFile(m_tlogFile))
+    {
+        CompressedTlog log;
+        if (!log.open(m_tlogFile))
+        {
+            QTextStream(stderr) << "Cannot open " << m_tlogFile << ": " << log.errorString() << endl;
+            return false;
+        }
+        for (int i = 0; i < log.blocks().size(); i++)
+        {
+            records.append(log.readBlock(i));
+        }
+    }
+    else
+    {
+        QFile file(m_tlogFile);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            QTextStream(stderr) << "Cannot open " << m_tlogFile << ": " << file.errorString() << endl;
+            return false;
+        }
+        records = file.readAll();
+    }
+
+    // Strip the timestamps, the link saw the bare frames
+    scenario->name = "tlog";
+    scenario->frames = 0;
+    scenario->lossy = false;
+    scenario->minChunk = 1024;
+    scenario->maxChunk = 1024;
+    scenario->stream.clear();
+    scenario->stream.reserve(records.size());
+    const uchar *data = (const uchar*)records.constData();
+    int offset = 0;
+    while (offset + 8 + MAVLINK_NUM_NON_PAYLOAD_BYTES <= records.size() && data[offset + 8] == MAVLINK_STX)
+    {
+        int length = MAVLINK_NUM_NON_PAYLOAD_BYTES + data[offset + 9];
+        if (offset + 8 + length > records.size())
+        {
+            break;
+        }
+        scenario->stream.append((const char*)data + offset + 8, length);
+        scenario->frames++;
+        offset += 8 + length;
+    }
+    return scenario->frames > 0;
+}
+
+static bool packetDueBefore(const LinkImpairment::Packet &a, const LinkImpairment::Packet &b)
+{
+    return a.dueUs < b.dueUs;
+}
+
+void MAVBench::countDispatch(QObject *receiver, LinkInterface *link, const MAVLinkMessageRef &message)
+{
+    Q_UNUSED(receiver);
+    Q_UNUSED(link);
+    Q_UNUSED(message);
+    s_dispatched++;
+}
+
+void MAVBench::uasCreated(UASInterface *uas)
+{
+    // Count every signal the vehicle emits, a slot without arguments copies nothing
+    const QMetaObject *meta = uas->metaObject();
+    QMetaMethod slot = metaObject()->method(metaObject()->indexOfSlot("countSignal()"));
+    for (int i = 0; i < meta->methodCount(); i++)
+    {
+        QMetaMethod method = meta->method(i);
+        if (method.methodType() == QMetaMethod::Signal && method.methodSignature() != "destroyed(QObject*)"
+                && method.methodSignature() != "destroyed()")
+        {
+            connect(uas, method, this, slot);
+        }
+    }
+}
+
+MAVBench::Result MAVBench::measure(const Scenario &scenario)
+{
+    Result result;
+    // The vehicles created on this link outlive the run, so does the link
+    BenchLink *link = new BenchLink(scenario.name);
+    link->setParent(this);
+    MAVLinkIngest *ingest = m_protocol->ingest();
+    int droppedReads = ingest->droppedReads();
+    int droppedMessages = ingest->droppedMessages();
+    int heapMessages = MAVLinkMessageRef::heapAllocations();
+    s_dispatched = 0;
+    m_signals = 0;
+
+    // Cut the reads up front so slicing is not timed
+    QList<QByteArray> reads;
+    qsrand(2);
+    for (int offset = 0; offset < scenario.stream.size(); )
+    {
+        int chunk = scenario.minChunk + ((scenario.maxChunk > scenario.minChunk) ? qrand() % (scenario.maxChunk - scenario.minChunk + 1) : 0);
+        reads.append(scenario.stream.mid(offset, chunk));
+        offset += chunk;
+    }
+    if (!m_impairment.isNull())
+    {
+        // Same seed every run; time only orders the packets, the benchmark does not wait for them
+        LinkImpairment impairment(3);
+        impairment.setSettings(m_impairment);
+        QList<LinkImpairment::Packet> packets;
+        for (int i = 0; i < reads.size(); i++)
+        {
+            impairment.process(reads.at(i), i * Q_INT64_C(1000), &packets);
+        }
+        qStableSort(packets.begin(), packets.end(), packetDueBefore);
+        reads.clear();
+        foreach (const LinkImpairment::Packet &packet, packets)
+        {
+            reads.append(packet.data);
+        }
+        result.impairment = impairment.stats();
+    }
+
+    int allocations = MAVBench::allocations();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < reads.size(); i++)
+    {
+        while (ingest->pendingReads() > maxPendingReads)
+        {
+            QCoreApplication::processEvents();
+            QThread::yieldCurrentThread();
+        }
+        m_protocol->receiveBytes(link, reads.at(i));
+    }
+
+    // Wait for the last read to be parsed and the UI side drain to empty
+    int parsedReads = ingest->parsedReads() + reads.size();
+    QElapsedTimer stall;
+    stall.start();
+    int lastParsed = 0;
+    forever
+    {
+        QCoreApplication::processEvents();
+        int parsed = ingest->parsedReads();
+        if (parsed - parsedReads >= 0 && ingest->pendingMessages() == 0)
+        {
+            break;
+        }
+        if (parsed != lastParsed)
+        {
+            lastParsed = parsed;
+            stall.restart();
+        }
+        else if (stall.elapsed() > stallTimeoutMs)
+        {
+            QTextStream(stderr) << scenario.name << ": ingest stalled" << endl;
+            m_failures++;
+            break;
+        }
+    }
+    QCoreApplication::processEvents();
+    result.elapsedNs = timer.nsecsElapsed();
+    result.allocations = MAVBench::allocations() - allocations;
+
+    LinkIngestStats::Snapshot snapshot = m_protocol->linkStats(link->getId())->sample();
+
+    result.parsed = snapshot.frames;
+    result.crcErrors = snapshot.crcErrors;
+    result.framingErrors = snapshot.framingErrors;
+    result.dispatched = s_dispatched;
+    result.signalCount = m_signals;
+    result.droppedReads = ingest->droppedReads() - droppedReads;
+    result.droppedMessages = ingest->droppedMessages() - droppedMessages;
+    result.heapMessages = MAVLinkMessageRef::heapAllocations() - heapMessages;
+    m_protocol->removeLinkStats(link->getId());
+    return result;
+}
+
+void MAVBench::report(const Scenario &scenario, const Result &result)
+{
+    double seconds = result.elapsedNs / 1e9;
+    int frames = qMax(1, result.parsed);
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(1);
+    out << qSetFieldWidth(11) << left << scenario.name << qSetFieldWidth(0)
+        << " frames " << result.parsed << "/" << scenario.frames
+        << "  " << (seconds > 0 ? result.parsed / seconds : 0.0) << " frames/s"
+        << "  " << (double)result.elapsedNs / frames << " ns/frame"
+        << "  " << qSetRealNumberPrecision(2) << (double)result.allocations / frames << " allocs/frame"
+        << "  " << (double)result.signalCount / frames << " signals/frame" << qSetRealNumberPrecision(1)
+        << "  dispatched " << result.dispatched
+        << "  crc " << result.crcErrors << " framing " << result.framingErrors
+        << "  dropped " << result.droppedReads << "/" << result.droppedMessages
+        << "  heap msgs " << result.heapMessages << endl;
+
+    QJsonObject extra;
+    extra["frames"] = result.parsed;
+    extra["expected_frames"] = scenario.frames;
+    extra["signals_per_frame"] = (double)result.signalCount / frames;
+    extra["crc_errors"] = result.crcErrors;
+    extra["framing_errors"] = result.framingErrors;
+    extra["dropped_reads"] = result.droppedReads;
+    extra["dropped_messages"] = result.droppedMessages;
+    record(scenario.name, result.parsed, (double)result.elapsedNs / frames, (double)result.allocations / frames, extra);
+    if (!m_impairment.isNull())
+    {
+        out << qSetFieldWidth(11) << "" << qSetFieldWidth(0)
+            << " impaired packets " << result.impairment.packets << "  dropped " << result.impairment.dropped
+            << "  corrupted " << result.impairment.corrupted << "  reordered " << result.impairment.reordered << endl;
+    }
+}
+
+int MAVBench::run()
+{
+    m_protocol = LinkManager::instance()->getMavlinkProtocol();
+    m_protocol->dispatcher()->subscribe(MAVLinkDispatcher::AnySystem, MAVLinkDispatcher::AnyMessage, &MAVBench::countDispatch, this);
+    connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(uasCreated(UASInterface*)));
+
+    // Build everything first, only the feeding and draining are measured
+    QList<Scenario> scenarios;
+    bool crc = false;
+    bool components = false;
+    foreach (const QString &name, m_scenarios)
+    {
+        Scenario scenario;
+        if (name == "crc")
+        {
+            // Not a receive path run, the checksum kernels alone
+            crc = true;
+            continue;
+        }
+        if (name == "components")
+        {
+            components = true;
+            continue;
+        }
+        if (name == "attitude") scenario = attitudeScenario();
+        else if (name == "fragmented") scenario = fragmentedScenario();
+        else if (name == "mavlink2") scenario = mavlink2Scenario();
+        else if (name == "noise") scenario = noiseScenario();
+        else if (name == "mixed") scenario = mixedScenario();
+        else if (name == "tlog")
+        {
+            if (!tlogScenario(&scenario))
+            {
+                QTextStream(stderr) << "No MAVLink frames in " << m_tlogFile << endl;
+                return 1;
+            }
+        }
+        else
+        {
+            QTextStream(stderr) << "Unknown scenario " << name << endl;
+            return 1;
+        }
+        scenarios.append(scenario);
+    }
+
+    for (int pass = 0; pass < m_repeat; pass++)
+    {
+        foreach (const Scenario &scenario, scenarios)
+        {
+            Result result = measure(scenario);
+            report(scenario, result);
+            // Everything but line noise must come through intact
+            bool lossy = scenario.lossy || !m_impairment.isNull();
+            if ((!lossy && result.parsed < scenario.frames) || result.droppedReads || result.droppedMessages)
+            {
+                m_failures++;
+            }
+        }
+        if (crc)
+        {
+            crcBenchmark();
+        }
+    }
+    // Repeats inside, best of m_repeat per case
+    if (components)
+    {
+        componentBenchmark();
+    }
+    if (!writeJson())
+    {
+        m_failures++;
+    }
+    return m_failures ? 1 : 0;
+}
+
+void MAVBench::componentBenchmark()
+{
+    ComponentBench bench;
+    QList<ComponentBench::Measurement> results = bench.run(m_cases, m_repeat);
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    foreach (const ComponentBench::Measurement &result, results)
+    {
+        out << qSetFieldWidth(28) << left << result.name << qSetFieldWidth(0)
+            << " " << qSetRealNumberPrecision(1) << result.nsPerOp() << " ns/op"
+            << "  " << qSetRealNumberPrecision(2) << result.allocationsPerOp() << " allocs/op"
+            << "  " << result.iterations << " iterations" << endl;
+        record(result.name, result.iterations, result.nsPerOp(), result.allocationsPerOp());
+    }
+    m_failures += bench.failures();
+}
+
+void MAVBench::record(const QString &name, qint64 iterations, double nsPerOp, double allocationsPerOp,
+                      const QJsonObject &extra)
+{
+    QJsonObject result = extra;
+    result["name"] = name;
+    result["iterations"] = static_cast<double>(iterations);
+    result["ns_per_op"] = nsPerOp;
+    result["allocs_per_op"] = allocationsPerOp;
+    m_results.append(result);
+}
+
+bool MAVBench::writeJson() const
+{
+    if (m_jsonFile.isEmpty())
+    {
+        return true;
+    }
+    QJsonObject root;
+    root["label"] = m_label;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qt"] = QString(qVersion());
+    root["repeat"] = m_repeat;
+    root["results"] = m_results;
+    QFile file(m_jsonFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write(QJsonDocument(root).toJson()) < 0)
+    {
+        QTextStream(stderr) << "Cannot write " << m_jsonFile << ": " << file.errorString() << endl;
+        return false;
+    }
+    return true;
+}
+
+void MAVBench::crcBenchmark()
+{
+    // The frames of the mixed stream, six message types of typical lengths
+    Scenario mixed = mixedScenario();
+    QList<QPair<int, int> > frames;
+    const uint8_t *data = (const uint8_t*)mixed.stream.constData();
+    for (int offset = 0; offset + MAVLINK_NUM_NON_PAYLOAD_BYTES <= mixed.stream.size(); offset += mavlink_frame_length(data + offset))
+    {
+        frames.append(qMakePair(offset, (int)data[offset + 1]));
+    }
+    if (frames.isEmpty())
+    {
+        return;
+    }
+    static const uint8_t crcs[256] = MAVLINK_MESSAGE_CRCS;
+    const int rounds = qMax(1, 2000000 / frames.size());
+
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(1);
+    double reference = 0;
+    for (int kernel = 0; kernel < MAVLinkCrc::KernelCount; kernel++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        int mismatches = 0;
+        qint64 bytes = 0;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (int i = 0; i < frames.size(); i++)
+            {
+                const uint8_t *frame = data + frames.at(i).first;
+                const int length = frames.at(i).second;
+                uint16_t checksum = MAVLinkCrc::calculateWith((MAVLinkCrc::Kernel)kernel, frame + 1, MAVLINK_CORE_HEADER_LEN + length);
+                crc_accumulate(crcs[frame[5]], &checksum);
+                const uint8_t *crc = frame + MAVLINK_NUM_HEADER_BYTES + length;
+                if (crc[0] != (checksum & 0xFF) || crc[1] != (checksum >> 8)) mismatches++;
+                bytes += MAVLINK_CORE_HEADER_LEN + length;
+            }
+        }
+        qint64 elapsedNs = qMax(Q_INT64_C(1), timer.nsecsElapsed());
+        double nsPerFrame = (double)elapsedNs / ((qint64)rounds * frames.size());
+        if (kernel == MAVLinkCrc::Bytewise) reference = nsPerFrame;
+        out << qSetFieldWidth(11) << left << QString("crc %1").arg(MAVLinkCrc::kernelName((MAVLinkCrc::Kernel)kernel)) << qSetFieldWidth(0)
+            << " " << nsPerFrame << " ns/frame  " << bytes * 1000.0 / elapsedNs << " MB/s"
+            << "  " << qSetRealNumberPrecision(2) << (nsPerFrame > 0 ? reference / nsPerFrame : 0.0) << "x" << qSetRealNumberPrecision(1)
+            << "  mismatches " << mismatches << endl;
+        record(QString("crc.%1").arg(MAVLinkCrc::kernelName((MAVLinkCrc::Kernel)kernel)),
+               (qint64)rounds * frames.size(), nsPerFrame, 0);
+        // Every kernel has to agree with the frames the reference packed
+        if (mismatches) m_failures++;
+    }
+}
@@ -0,0 +1,160 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVBench
+ *          End to end benchmark of the MAVLink receive path. Recorded or
+ *          synthetic streams are fed through MAVLinkProtocol::receiveBytes()
+ *          exactly like a link does, then framed on the ingest thread, drained
+ *          on the UI thread, decoded and dispatched to the UAS objects.
+ *
+ */
+
+#ifndef MAVBENCH_H
+#define MAVBENCH_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QStringList>
+#include <QList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "LinkInterface.h"
+#include "MAVLinkMessageRef.h"
+#include "ImpairedLink.h"
+
+class MAVLinkProtocol;
+class UASInterface;
+
+/** @brief Receive only link the benchmark feeds by hand */
+class BenchLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    explicit BenchLink(const QString &name) : m_id(getNextLinkId()), m_name(name) { }
+
+    void disableTimeouts() { }
+    void enableTimeouts() { }
+    void requestReset() { }
+    int getId() const { return m_id; }
+    QString getName() const { return m_name; }
+    bool isConnected() const { return true; }
+    qint64 getConnectionSpeed() const { return 0; }
+    qint64 bytesAvailable() { return 0; }
+
+public slots:
+    bool connect() { return true; }
+    bool disconnect() { return true; }
+    void writeBytes(const char *bytes, qint64 length) { Q_UNUSED(bytes); Q_UNUSED(length); }
+
+protected slots:
+    void readBytes() { }
+
+private:
+    int m_id;
+    QString m_name;
+};
+
+class MAVBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MAVBench(QObject *parent = 0);
+
+    /** @brief Parse the command line, returns false if the run should not start */
+    bool configure(const QStringList &arguments);
+
+    /** @brief Run every selected scenario and print one result line each, returns the exit code */
+    int run();
+
+    /** @brief Heap allocations so far, counted by the hooks in main.cc */
+    static int allocations();
+
+private slots:
+    void countSignal() { m_signals++; }
+    void uasCreated(UASInterface *uas);
+
+private:
+    struct Scenario
+    {
+        QString name;
+        QByteArray stream;
+        int frames;       ///< Valid frames in the stream
+        bool lossy;       ///< Line noise may swallow some of them
+        int minChunk;     ///< Read sizes handed to receiveBytes()
+        int maxChunk;
+    };
+    struct Result
+    {
+        int parsed;
+        int crcErrors;
+        int framingErrors;
+        int dispatched;
+        int signalCount;
+        int allocations;
+        int droppedReads;
+        int droppedMessages;
+        int heapMessages;
+        qint64 elapsedNs;
+        LinkImpairment::Stats impairment;
+    };
+
+    static void appendFrame(QByteArray *stream, const mavlink_message_t &message);
+    Scenario attitudeScenario() const;
+    Scenario fragmentedScenario() const;
+    Scenario mavlink2Scenario() const;
+    Scenario noiseScenario() const;
+    Scenario mixedScenario() const;
+    bool tlogScenario(Scenario *scenario) const;
+    Result measure(const Scenario &scenario);
+    void report(const Scenario &scenario, const Result &result);
+    /** @brief Time every MAVLinkCrc kernel against the stock crc_accumulate() on the mixed frames */
+    void crcBenchmark();
+    /** @brief The component micro benchmarks, see ComponentBench */
+    void componentBenchmark();
+    void record(const QString &name, qint64 iterations, double nsPerOp, double allocationsPerOp,
+                const QJsonObject &extra = QJsonObject());
+    bool writeJson() const;
+    static void countDispatch(QObject *receiver, LinkInterface *link, const MAVLinkMessageRef &message);
+
+    MAVLinkProtocol *m_protocol;
+    QStringList m_scenarios;
+    QString m_tlogFile;
+    QStringList m_cases;        ///< Component benchmark name prefixes, all if empty
+    QString m_jsonFile;
+    QString m_label;
+    QJsonArray m_results;       ///< Every result of the run, for --json
+    int m_frames;
+    int m_noisePercent;
+    int m_vehicles;
+    int m_repeat;
+    LinkImpairment::Settings m_impairment;  ///< Applied to every scenario's reads
+    int m_signals;
+    int m_failures;
+
+    static int s_dispatched;
+};
+
+#endif // MAVBENCH_H
@@ -0,0 +1,110 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+#include <QApplication>
+#include <QAtomicInt>
+#include <stdlib.h>
+#include <new>
+#include "MAVBench.h"
+#include "QsLog.h"
+#include "QsLogDest.h"
+
+// Every heap allocation of the process is counted, the benchmark reports the delta
+static QBasicAtomicInt s_allocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+int MAVBench::allocations()
+{
+    return s_allocations.load();
+}
+
+#if defined(__GLIBC__)
+// glibc lets the program interpose malloc, which also catches QByteArray and friends
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_realloc(pointer, size);
+}
+#else
+// Elsewhere only operator new is seen
+void *operator new(size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    void *pointer = malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    void *pointer = malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void *pointer) throw()
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) throw()
+{
+    free(pointer);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+#ifndef Q_OS_ANDROID
+    // Nothing is shown, do not require a display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication app(argc, argv);
+
+    // Warnings only, logging every frame would be the benchmark
+    QsLogging::Logger &logger = QsLogging::Logger::instance();
+    logger.setLoggingLevel(QsLogging::WarnLevel);
+    logger.addDestination(QsLogging::DestinationFactory::MakeDebugOutputDestination());
+
+    MAVBench bench;
+    if (!bench.configure(app.arguments()))
+    {
+        return 1;
+    }
+    return bench.run();
+}
@@ -0,0 +1,30 @@
+# MAVLink ingest benchmark
+# feeds recorded and synthetic MAVLink streams through MAVLinkProtocol,
+# MAVLinkDecoder and the UAS objects and reports frames/s, ns/frame,
+# allocations and signals per frame
+
+QT += core network gui widgets qml
+
+TEMPLATE = app
+TARGET = mavbench
+
+LANGUAGE = C++
+
+HUD_ROOT = $$PWD/../..
+
+# The benchmark never plays the alerts it raises
+DEFINES += AUDIO_NULL_BACKEND
+
+# MAVLink receive path shared with QtGStreamerHUD
+include($$HUD_ROOT/telemetry.pri)
+
+# Standalone files, QCurrentState is not part of the telemetry core
+HEADERS += MAVBench.h \
+    ComponentBench.h \
+    $$HUD_ROOT/QCurrentState.h
+SOURCES += main.cc \
+    MAVBench.cc \
+    ComponentBench.cc \
+    $$HUD_ROOT/QCurrentState.cpp
+
+CONFIG += warn_off
@@ -43,11 +43,13 @@ This file is part of the QGROUNDCONTROL project
 MAVLinkXMLParserV10::MAVLinkXMLParserV10(QDomDocument* document, QString outputDirectory, QObject* parent) : QObject(parent),
 doc(document),
 outputDirName(outputDirectory),
-fileName("")
+fileName(""),
+cppViews(false)
 {
 }
 
-MAVLinkXMLParserV10::MAVLinkXMLParserV10(QString document, QString outputDirectory, QObject* parent) : QObject(parent)
+MAVLinkXMLParserV10::MAVLinkXMLParserV10(QString document, QString outputDirectory, QObject* parent) : QObject(parent),
+cppViews(false)
 {
     doc = new QDomDocument();
     QFile file(document);
@@ -91,7 +93,8 @@ void MAVLinkXMLParserV10::processError(QProcess::ProcessError err)
 }
 
 /**
- * Generate C-code (C-89 compliant) out of the XML protocol specs.
+ * Generate C-code (C-89 compliant) out of the XML protocol specs, and with
+ * setCppViews() the C++ views on top of it.
  */
 bool MAVLinkXMLParserV10::generate()
 {
@@ -102,7 +105,8 @@ bool MAVLinkXMLParserV10::generate()
 #if (defined Q_OS_MAC) || (defined Q_OS_LINUX)
     QString generatorCall("python");
 #endif
-    QString lang("C");
+    // The C++ backend writes the C headers too, the views include them
+    QString lang(cppViews ? "C++" : "C");
     QString version("1.0");
 
     QStringList arguments;
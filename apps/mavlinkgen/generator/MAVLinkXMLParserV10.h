@@ -52,6 +52,9 @@ public:
     MAVLinkXMLParserV10(QString document, QString outputDirectory, QObject* parent=0);
     ~MAVLinkXMLParserV10();
 
+    /** @brief Also write mavlink.hpp, typed C++ views that read fields in place from the payload */
+    void setCppViews(bool enabled) { cppViews = enabled; }
+
 public slots:
     /** @brief Parse XML and generate C files */
     bool generate();
@@ -79,6 +82,7 @@ protected:
     QString outputDirName;
     QString fileName;
     QProcess* process;
+    bool cppViews;
 };
 
 #endif // MAVLINKXMLPARSERV10_H
@@ -150,6 +150,7 @@ void XMLCommProtocolWidget::generate()
     {
         MAVLinkXMLParserV10* parserV10 = new MAVLinkXMLParserV10(m_ui->fileNameLabel->text().trimmed(), m_ui->outputDirNameLabel->text().trimmed());
         connect(parserV10, SIGNAL(parseState(QString)), m_ui->compileLog, SLOT(appendHtml(QString)));
+        parserV10->setCppViews(m_ui->cppViewsCheckBox->isChecked());
         result = parserV10->generate();
     }
 
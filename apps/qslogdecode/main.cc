@@ -0,0 +1,138 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <cstdio>
+#include "QsLogBinary.h"
+#include "QsLogDestBufferedFile.h"
+
+static void usage(QTextStream &err)
+{
+    err << "usage: qslogdecode [--level trace|debug|info|warn|error] [--formats] file.qslb|file.qz..." << endl;
+}
+
+static bool parseLevel(const QString &name, QsLogging::Level *level)
+{
+    static const char *const names[] = { "trace", "debug", "info", "warn", "error", "fatal" };
+    for (int i = 0; i < 6; ++i)
+    {
+        if (name.compare(QLatin1String(names[i]), Qt::CaseInsensitive) == 0)
+        {
+            *level = static_cast<QsLogging::Level>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QsLogging::Level minimum = QsLogging::TraceLevel;
+    bool listFormats = false;
+    QStringList files;
+    QStringList args = app.arguments().mid(1);
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--level" && i + 1 < args.size())
+        {
+            if (!parseLevel(args[++i], &minimum))
+            {
+                usage(err);
+                return 2;
+            }
+        }
+        else if (args[i] == "--formats")
+        {
+            listFormats = true;
+        }
+        else if (args[i].startsWith("--"))
+        {
+            usage(err);
+            return 2;
+        }
+        else
+        {
+            files << args[i];
+        }
+    }
+    if (files.isEmpty())
+    {
+        usage(err);
+        return 2;
+    }
+
+    int result = 0;
+    foreach (const QString &file, files)
+    {
+        if (file.endsWith(".qz"))
+        {
+            // A rotated text log, already text once inflated
+            QByteArray text;
+            bool complete = QsLogging::BufferedFileDestination::readCompressed(file, &text);
+            fwrite(text.constData(), 1, text.size(), stdout);
+            fflush(stdout);
+            if (!complete)
+            {
+                err << file << " is not a compressed log or is damaged" << endl;
+                result = 1;
+            }
+            continue;
+        }
+        QsLogging::BinaryLogReader reader;
+        if (!reader.open(file))
+        {
+            err << reader.errorString() << endl;
+            result = 1;
+            continue;
+        }
+        QString line;
+        QsLogging::Level level;
+        while (reader.next(&line, &level))
+        {
+            if (!listFormats && level >= minimum)
+            {
+                out << line << '\n';
+            }
+        }
+        if (listFormats)
+        {
+            foreach (const QString &format, reader.formats())
+            {
+                out << format << '\n';
+            }
+        }
+        out.flush();
+        if (!reader.errorString().isEmpty())
+        {
+            // Whatever was readable was printed, a log cut short by a crash is the usual case
+            err << reader.errorString() << endl;
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,35 @@
+# Binary log decoder
+# renders the .qslb files written by QsLog's binary destination (QLOG_BIN_*)
+# as text, the same layout as the text log
+
+QT += core
+QT -= gui
+
+TEMPLATE = app
+TARGET = qslogdecode
+CONFIG += console
+
+LANGUAGE = C++
+
+HUD_ROOT = $$PWD/../..
+
+INCLUDEPATH += $$HUD_ROOT/QsLog
+
+HEADERS += \
+    $$HUD_ROOT/QsLog/QsLog.h \
+    $$HUD_ROOT/QsLog/QsLogDest.h \
+    $$HUD_ROOT/QsLog/QsLogBinary.h \
+    $$HUD_ROOT/QsLog/QsLogDestBufferedFile.h \
+    $$HUD_ROOT/QsLog/QsLogLimit.h
+
+SOURCES += \
+    $$HUD_ROOT/QsLog/QsLog.cpp \
+    $$HUD_ROOT/QsLog/QsLogDest.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestConsole.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestFile.cpp \
+    $$HUD_ROOT/QsLog/QsLogBinary.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestBufferedFile.cpp \
+    $$HUD_ROOT/QsLog/QsLogLimit.cpp
+
+# Standalone files
+SOURCES += main.cc
@@ -0,0 +1,298 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryDaemon
+ *          See TelemetryDaemon.h
+ *
+ */
+
+#include "TelemetryDaemon.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTextStream>
+#include <QTimer>
+#include <signal.h>
+#include <sys/resource.h>
+#include "LinkManager1.h"
+#include "UASManager1.h"
+#include "UASInterface1.h"
+#include "TlogReplayLink.h"
+#include "SettingsStore.h"
+
+static volatile sig_atomic_t s_stopRequested = 0;
+
+TelemetryDaemon::TelemetryDaemon(QObject *parent) :
+    QObject(parent),
+    m_speed(1.0),
+    m_seconds(0),
+    m_intervalMs(DefaultIntervalMs),
+    m_fanoutPort(0),
+    m_stateServerPort(0),
+    m_tlogLogging(true),
+    m_swarm(false),
+    m_quiet(false),
+    m_reportTimer(new QTimer(this)),
+    m_pollTimer(new QTimer(this)),
+    m_vehicles(0),
+    m_failures(0)
+{
+    connect(m_reportTimer, SIGNAL(timeout()), this, SLOT(report()));
+    connect(m_pollTimer, SIGNAL(timeout()), this, SLOT(pollStop()));
+}
+
+void TelemetryDaemon::requestStop()
+{
+    s_stopRequested = 1;
+}
+
+bool TelemetryDaemon::configure(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run the MAVLink telemetry stack without a display and report what the links deliver");
+    parser.addHelpOption();
+
+    QCommandLineOption udpOption("udp", "Listen for MAVLink on this UDP port, repeatable. Without any link option: 14550.", "port");
+    QCommandLineOption tcpOption("tcp", "Connect to a MAVLink TCP server, repeatable.", "host:port");
+    QCommandLineOption tcpServerOption("tcp-server", "Accept MAVLink TCP clients on this port, repeatable.", "port");
+    QCommandLineOption tlogOption("tlog", "Replay a recorded .tlog or .ctlog; the run ends with it unless --seconds is given.", "file");
+    QCommandLineOption speedOption("speed", "Replay speed, 0 for as fast as the stack takes it.", "factor", QString::number(m_speed));
+    QCommandLineOption secondsOption("seconds", "Stop after this many seconds, 0 runs until interrupted.", "seconds", QString::number(m_seconds));
+    QCommandLineOption intervalOption("interval", "Milliseconds between report lines.", "ms", QString::number(m_intervalMs));
+    QCommandLineOption fanoutOption("fanout-tcp", "Serve the received stream to TCP subscribers on this port.", "port");
+    QCommandLineOption stateServerOption("state-ws", "Serve the decoded vehicle state to WebSocket clients, e.g. browser dashboards, on this port.", "port");
+    QCommandLineOption noTlogOption("no-tlog", "Do not write the received traffic to .tlog files.");
+    QCommandLineOption swarmOption("swarm", "Decode every message only for the active vehicle, like the HUD's swarm mode.");
+    QCommandLineOption quietOption("quiet", "Only print the totals at the end.");
+    parser.addOption(udpOption);
+    parser.addOption(tcpOption);
+    parser.addOption(tcpServerOption);
+    parser.addOption(tlogOption);
+    parser.addOption(speedOption);
+    parser.addOption(secondsOption);
+    parser.addOption(intervalOption);
+    parser.addOption(fanoutOption);
+    parser.addOption(stateServerOption);
+    parser.addOption(noTlogOption);
+    parser.addOption(swarmOption);
+    parser.addOption(quietOption);
+    parser.process(arguments);
+
+    foreach (const QString &value, parser.values(udpOption))
+    {
+        int port = value.toInt();
+        if (port <= 0 || port > 65535)
+        {
+            QTextStream(stderr) << "Bad UDP port " << value << endl;
+            return false;
+        }
+        m_udpPorts << port;
+    }
+    foreach (const QString &value, parser.values(tcpOption))
+    {
+        int colon = value.lastIndexOf(':');
+        int port = colon > 0 ? value.mid(colon + 1).toInt() : 0;
+        if (port <= 0 || port > 65535)
+        {
+            QTextStream(stderr) << "Bad TCP server " << value << ", expected host:port" << endl;
+            return false;
+        }
+        m_tcpHosts << qMakePair(value.left(colon), port);
+    }
+    foreach (const QString &value, parser.values(tcpServerOption))
+    {
+        int port = value.toInt();
+        if (port <= 0 || port > 65535)
+        {
+            QTextStream(stderr) << "Bad TCP port " << value << endl;
+            return false;
+        }
+        m_tcpServerPorts << port;
+    }
+    m_tlogFile = parser.value(tlogOption);
+    m_speed = qMax(0.0, parser.value(speedOption).toDouble());
+    m_seconds = qMax(0, parser.value(secondsOption).toInt());
+    m_intervalMs = qMax(100, parser.value(intervalOption).toInt());
+    m_fanoutPort = qBound(0, parser.value(fanoutOption).toInt(), 65535);
+    m_stateServerPort = qBound(0, parser.value(stateServerOption).toInt(), 65535);
+    m_tlogLogging = !parser.isSet(noTlogOption);
+    m_swarm = parser.isSet(swarmOption);
+    m_quiet = parser.isSet(quietOption);
+    return true;
+}
+
+bool TelemetryDaemon::start()
+{
+    // Every run starts from the HUD's defaults, the links are the ones asked for
+    SettingsStore::instance()->remove("LINKMANAGER");
+    SettingsStore::instance()->setValue("LINKMANAGER/LOGGING", m_tlogLogging);
+
+    connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(uasCreated(UASInterface*)));
+    LinkManager *links = LinkManager::instance();
+    connect(links, SIGNAL(linkError(int,QString)), this, SLOT(linkError(int,QString)));
+    links->setSwarmMode(m_swarm);
+    links->setFanoutTcpPort(m_fanoutPort);
+    links->setStateServerPort(m_stateServerPort);
+
+    // LinkManager always opens the UDP default, keep it only without other links
+    bool explicitLinks = !m_udpPorts.isEmpty() || !m_tcpHosts.isEmpty() || !m_tcpServerPorts.isEmpty() || !m_tlogFile.isEmpty();
+    QList<int> openUdpPorts;
+    foreach (int linkid, links->getLinks())
+    {
+        if (links->getLinkType(linkid) != LinkInterface::UDP_LINK)
+        {
+            continue;
+        }
+        if (explicitLinks && !m_udpPorts.contains(links->getUdpLinkPort(linkid)))
+        {
+            links->removeLink(linkid);
+            continue;
+        }
+        openUdpPorts << links->getUdpLinkPort(linkid);
+    }
+    foreach (int port, m_udpPorts)
+    {
+        if (!openUdpPorts.contains(port))
+        {
+            links->addUdpConnection(QHostAddress::Any, port);
+        }
+    }
+    for (int i = 0; i < m_tcpHosts.size(); i++)
+    {
+        int linkid = links->addTcpConnection(m_tcpHosts.at(i).first, m_tcpHosts.at(i).second, false);
+        links->connectLink(linkid);
+    }
+    foreach (int port, m_tcpServerPorts)
+    {
+        links->addTcpConnection(QHostAddress::Any, port, true);
+    }
+    if (!m_tlogFile.isEmpty())
+    {
+        int linkid = links->addTlogReplay(m_tlogFile);
+        TlogReplayLink *replay = links->getReplayLink(linkid);
+        if (!replay || !replay->isConnected())
+        {
+            QTextStream(stderr) << "Cannot replay " << m_tlogFile << endl;
+            return false;
+        }
+        replay->setSpeed(m_speed);
+        if (m_seconds == 0)
+        {
+            connect(replay, SIGNAL(replayFinished()), QCoreApplication::instance(), SLOT(quit()), Qt::QueuedConnection);
+        }
+    }
+    if (m_seconds > 0)
+    {
+        QTimer::singleShot(m_seconds * 1000, QCoreApplication::instance(), SLOT(quit()));
+    }
+
+    m_clock.start();
+    if (!m_quiet)
+    {
+        m_reportTimer->start(m_intervalMs);
+    }
+    m_pollTimer->start(SignalPollMs);
+    return true;
+}
+
+void TelemetryDaemon::pollStop()
+{
+    if (s_stopRequested)
+    {
+        m_pollTimer->stop();
+        QCoreApplication::quit();
+    }
+}
+
+void TelemetryDaemon::uasCreated(UASInterface *uas)
+{
+    m_vehicles++;
+    if (!m_quiet)
+    {
+        QTextStream(stdout) << "vehicle " << uas->getUASID() << " " << uas->getUASName() << endl;
+    }
+}
+
+void TelemetryDaemon::linkError(int linkid, const QString &message)
+{
+    m_failures++;
+    QTextStream(stderr) << LinkManager::instance()->getLinkName(linkid) << ": " << message << endl;
+}
+
+void TelemetryDaemon::report()
+{
+    printLinks(false);
+}
+
+void TelemetryDaemon::printLinks(bool totals)
+{
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(1);
+    double seconds = m_clock.elapsed() / 1000.0;
+    LinkManager *links = LinkManager::instance();
+    foreach (int linkid, links->getLinks())
+    {
+        // Sampled once a second by LinkManager, the same numbers the HUD shows
+        LinkIngestStats::Snapshot stats = links->getLinkIngestStats(linkid);
+        out << qSetFieldWidth(8) << seconds << qSetFieldWidth(0) << "s  " << links->getLinkName(linkid) << "  ";
+        if (totals)
+        {
+            out << stats.bytes << " bytes  " << stats.frames << " frames";
+            if (seconds > 0)
+            {
+                out << "  " << stats.frames / seconds << " frames/s";
+            }
+            out << "  " << stats.crcErrors << " crc  " << stats.framingErrors << " framing  "
+                << stats.mavlink2Frames << " v2  " << stats.unsupportedFrames << " unsupported";
+        }
+        else
+        {
+            out << stats.bytesPerSecond / 1024.0 << " kB/s  " << stats.framesPerSecond << " frames/s  "
+                << stats.errorsPerSecond << " errors/s";
+        }
+        out << endl;
+    }
+}
+
+int TelemetryDaemon::finish()
+{
+    m_reportTimer->stop();
+    m_pollTimer->stop();
+    QTextStream out(stdout);
+    out << "totals" << endl;
+    printLinks(true);
+
+    // What the stack cost, for comparing runs without a profiler
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        double cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+                   + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        out.setRealNumberNotation(QTextStream::FixedNotation);
+        out.setRealNumberPrecision(2);
+        out << "vehicles " << m_vehicles << "  cpu " << cpu << " s  max rss " << usage.ru_maxrss << " kB" << endl;
+    }
+    return m_failures ? 1 : 0;
+}
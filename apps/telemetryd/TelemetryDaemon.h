@@ -0,0 +1,97 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryDaemon
+ *          Headless driver of the telemetry library. Opens UDP, TCP and tlog
+ *          replay links through LinkManager exactly like the HUD, lets the
+ *          ingest thread, MAVLinkDecoder and the UAS objects run without a
+ *          window and prints what each link delivered, so the stack can run
+ *          under perf or valgrind and on a companion computer.
+ *
+ */
+
+#ifndef TELEMETRYDAEMON_H
+#define TELEMETRYDAEMON_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+class UASInterface;
+
+class TelemetryDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum { DefaultIntervalMs = 1000, SignalPollMs = 100 };
+
+    explicit TelemetryDaemon(QObject *parent = 0);
+
+    /** @brief Parse the command line, returns false if the run should not start */
+    bool configure(const QStringList &arguments);
+
+    /** @brief Open the links, false if one of them could not be set up */
+    bool start();
+
+    /** @brief Print the totals of the run, returns the exit code */
+    int finish();
+
+    /** @brief Stop at the next poll, safe from a signal handler */
+    static void requestStop();
+
+private slots:
+    void report();
+    void pollStop();
+    void uasCreated(UASInterface *uas);
+    void linkError(int linkid, const QString &message);
+
+private:
+    void printLinks(bool totals);
+
+    QList<int> m_udpPorts;
+    QList<QPair<QString, int> > m_tcpHosts;
+    QList<int> m_tcpServerPorts;
+    QString m_tlogFile;
+    double m_speed;
+    int m_seconds;
+    int m_intervalMs;
+    int m_fanoutPort;
+    int m_stateServerPort;
+    bool m_tlogLogging;
+    bool m_swarm;
+    bool m_quiet;
+
+    QTimer *m_reportTimer;
+    QTimer *m_pollTimer;
+    QElapsedTimer m_clock;
+    int m_vehicles;
+    int m_failures;     ///< Link errors, the exit code is non zero after any
+};
+
+#endif // TELEMETRYDAEMON_H
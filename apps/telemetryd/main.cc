@@ -0,0 +1,65 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+#include <QApplication>
+#include <signal.h>
+#include "TelemetryDaemon.h"
+#include "SettingsStore.h"
+#include "QsLog.h"
+#include "QsLogDest.h"
+
+static void stopOnSignal(int)
+{
+    TelemetryDaemon::requestStop();
+}
+
+int main(int argc, char **argv)
+{
+    // Nothing is shown, do not require a display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    // Settings apart from the HUD's, a run never changes the HUD's links
+    QCoreApplication::setApplicationName("telemetryd");
+    SettingsStore::instance();
+
+    QsLogging::Logger &logger = QsLogging::Logger::instance();
+    logger.setLoggingLevel(QsLogging::WarnLevel);
+    logger.addDestination(QsLogging::DestinationFactory::MakeDebugOutputDestination());
+
+    TelemetryDaemon daemon;
+    if (!daemon.configure(app.arguments()))
+    {
+        return 1;
+    }
+    // Interrupting a profiled run still prints the totals and exits cleanly
+    signal(SIGINT, stopOnSignal);
+    signal(SIGTERM, stopOnSignal);
+    if (!daemon.start())
+    {
+        SettingsStore::instance()->shutdown();
+        return 1;
+    }
+    app.exec();
+    int result = daemon.finish();
+    SettingsStore::instance()->shutdown();
+    return result;
+}
@@ -0,0 +1,36 @@
+# Headless telemetry driver
+# runs libs/telemetry against UDP, TCP or tlog replay links without a window
+# and prints per link rates and totals; build both with qmake headless.pro
+
+QT += core network gui widgets
+
+TEMPLATE = app
+TARGET = telemetryd
+CONFIG += console
+
+LANGUAGE = C++
+
+HUD_ROOT = $$PWD/../..
+
+DEFINES += AUDIO_NULL_BACKEND
+
+# Headers only, the code comes from the static library
+INCLUDEPATH += $$HUD_ROOT \
+    $$HUD_ROOT/comm \
+    $$HUD_ROOT/uas \
+    $$HUD_ROOT/audio \
+    $$HUD_ROOT/ui/RadioCalibration \
+    $$HUD_ROOT/QsLog \
+    $$HUD_ROOT/libs/mavlink/include/mavlink/v1.0 \
+    $$HUD_ROOT/libs/mavlink/include/mavlink/v1.0/ardupilotmega
+
+TELEMETRY_LIB_DIR = $$OUT_PWD/../../libs/telemetry
+LIBS += -L$$TELEMETRY_LIB_DIR -ltelemetry
+PRE_TARGETDEPS += $$TELEMETRY_LIB_DIR/libtelemetry.a
+
+# Standalone files
+HEADERS += TelemetryDaemon.h
+SOURCES += main.cc \
+    TelemetryDaemon.cc
+
+CONFIG += warn_off
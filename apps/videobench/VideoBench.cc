@@ -0,0 +1,275 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VideoBench.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+#include <QtQuick/QQuickItem>
+#include <QtQml/QQmlContext>
+#include <QtQml/QQmlEngine>
+#include <QGst/Quick/VideoItem>
+#include <sys/resource.h>
+#include <algorithm>
+
+// Callback to update the custom plugin, see main.cc
+void* update_node(void* surface,  void* node, qreal x, qreal y, qreal w, qreal h);
+
+QMutex VideoBench::s_frameMutex;
+QElapsedTimer VideoBench::s_frameClock;
+QVector<qint64> VideoBench::s_frameTimes;
+bool VideoBench::s_recording = false;
+
+VideoBench::VideoBench(QObject *parent) :
+    QObject(parent),
+    m_view(NULL),
+    m_surface(NULL),
+    m_player(NULL),
+    m_encoding("H264"),
+    m_width(1280),
+    m_height(720),
+    m_framerate(30),
+    m_duration(30),
+    m_warmup(2),
+    m_zeroCopy(false),
+    m_exitCode(1),
+    m_cpuStart(0)
+{
+    m_warmupTimer.setSingleShot(true);
+    m_runTimer.setSingleShot(true);
+    connect(&m_warmupTimer, SIGNAL(timeout()), this, SLOT(onWarmupDone()));
+    connect(&m_runTimer, SIGNAL(timeout()), this, SLOT(onRunDone()));
+}
+
+VideoBench::~VideoBench()
+{
+    if (m_player) m_player->stop();
+    delete m_view;
+    delete m_surface;
+}
+
+bool VideoBench::configure(const QStringList & arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the HUD video path with a synthetic or recorded source");
+    parser.addHelpOption();
+
+    QCommandLineOption pipelineOption("pipeline", "Use this pipeline instead of the generated one.", "launch");
+    QCommandLineOption rtpOption("rtp", "Play a recorded RTP capture (pcap) instead of videotestsrc.", "file");
+    QCommandLineOption encodingOption("encoding", "Encoding of the RTP capture, H264 or H265.", "name", m_encoding);
+    QCommandLineOption widthOption("width", "Test source width.", "pixels", QString::number(m_width));
+    QCommandLineOption heightOption("height", "Test source height.", "pixels", QString::number(m_height));
+    QCommandLineOption framerateOption("framerate", "Test source framerate.", "fps", QString::number(m_framerate));
+    QCommandLineOption durationOption("duration", "Measured run time.", "seconds", QString::number(m_duration));
+    QCommandLineOption warmupOption("warmup", "Time to run before measuring.", "seconds", QString::number(m_warmup));
+    QCommandLineOption zeroCopyOption("zero-copy", "Negotiate GL memory / EGLImage with the sink.");
+    QCommandLineOption headlessOption("headless", "Render on the offscreen platform.");
+
+    parser.addOption(pipelineOption);
+    parser.addOption(rtpOption);
+    parser.addOption(encodingOption);
+    parser.addOption(widthOption);
+    parser.addOption(heightOption);
+    parser.addOption(framerateOption);
+    parser.addOption(durationOption);
+    parser.addOption(warmupOption);
+    parser.addOption(zeroCopyOption);
+    parser.addOption(headlessOption);
+
+    if (!parser.parse(arguments))
+    {
+        qCritical() << parser.errorText();
+        return false;
+    }
+    if (parser.isSet("help"))
+    {
+        parser.showHelp(0);
+    }
+
+    m_pipeline = parser.value(pipelineOption);
+    m_rtpFile = parser.value(rtpOption);
+    m_encoding = parser.value(encodingOption).toUpper();
+    m_width = qMax(16, parser.value(widthOption).toInt());
+    m_height = qMax(16, parser.value(heightOption).toInt());
+    m_framerate = qMax(1, parser.value(framerateOption).toInt());
+    m_duration = qMax(1, parser.value(durationOption).toInt());
+    m_warmup = qMax(0, parser.value(warmupOption).toInt());
+    m_zeroCopy = parser.isSet(zeroCopyOption);
+
+    if (m_encoding != "H264" && m_encoding != "H265")
+    {
+        qCritical() << "Unsupported encoding" << m_encoding;
+        return false;
+    }
+    return true;
+}
+
+QString VideoBench::buildPipeline() const
+{
+    if (!m_pipeline.isEmpty()) return m_pipeline;
+
+    if (!m_rtpFile.isEmpty())
+    {
+        // Same tail as the HUD default RTP pipeline, fed from the capture
+        QString depay = m_encoding == "H265" ? "rtph265depay ! h265parse ! queue ! avdec_h265"
+                                             : "rtph264depay ! h264parse ! queue ! avdec_h264";
+        return QString("filesrc location=\"%1\" ! pcapparse ! "
+                       "application/x-rtp,media=video,clock-rate=90000,encoding-name=%2,payload=96 ! "
+                       "rtpjitterbuffer ! %3").arg(m_rtpFile, m_encoding, depay);
+    }
+
+    return QString("videotestsrc is-live=true ! video/x-raw,width=%1,height=%2,framerate=%3/1 ! queue")
+            .arg(m_width).arg(m_height).arg(m_framerate);
+}
+
+bool VideoBench::start()
+{
+    m_view = new QQuickView();
+    m_surface = new QGst::Quick::VideoSurface;
+    m_player = new GStreamerPlayer(m_view);
+    m_player->setVideoSink(m_surface->videoSink());
+    m_player->setZeroCopy(m_zeroCopy);
+    m_player->setPipelineString(buildPipeline());
+
+    connect(m_player, SIGNAL(messageBox(QString)), this,
+            SLOT(onMessageBox(QString)), Qt::UniqueConnection);
+
+    m_view->setResizeMode(QQuickView::SizeRootObjectToView);
+    m_view->rootContext()->setContextProperty(QLatin1String("videoSurface1"), m_surface);
+    m_view->setSource(QUrl(QLatin1String("qrc:/videobench.qml")));
+    m_view->resize(m_width, m_height);
+    m_view->show();
+
+    // Wire up video surface manually, as the HUD does
+    QQuickItem *videoObj = m_view->rootObject() ? m_view->rootObject()->findChild<QQuickItem*>("video") : NULL;
+    QGst::Quick::VideoItem *pItem = dynamic_cast<QGst::Quick::VideoItem*>(videoObj);
+    if (!pItem)
+    {
+        qCritical() << "Failed to find video object in QML!";
+        return false;
+    }
+    pItem->setSurface(m_surface);
+    pItem->setUpdateNodeCallback(&update_node);
+
+    s_frameClock.start();
+    m_player->play();
+    m_warmupTimer.start(m_warmup * 1000);
+    return true;
+}
+
+void VideoBench::frameRendered()
+{
+    QMutexLocker locker(&s_frameMutex);
+    if (s_recording) s_frameTimes.append(s_frameClock.nsecsElapsed());
+}
+
+void VideoBench::onWarmupDone()
+{
+    {
+        QMutexLocker locker(&s_frameMutex);
+        s_frameTimes.clear();
+        s_frameTimes.reserve(m_duration * m_framerate * 2);
+        s_recording = true;
+    }
+
+    static_cast<GStreamerStats*>(m_player->getStats())->reset();
+    m_cpuStart = cpuSeconds();
+    m_wallClock.start();
+    m_runTimer.start(m_duration * 1000);
+}
+
+void VideoBench::onRunDone()
+{
+    {
+        QMutexLocker locker(&s_frameMutex);
+        s_recording = false;
+    }
+    report();
+    m_exitCode = s_frameTimes.size() > 1 ? 0 : 1;
+    emit finished(m_exitCode);
+}
+
+void VideoBench::onMessageBox(QString message)
+{
+    qCritical() << "Player:" << message;
+}
+
+void VideoBench::report()
+{
+    double wall = m_wallClock.nsecsElapsed() / 1e9;
+    double cpu = cpuSeconds() - m_cpuStart;
+
+    QVector<qint64> intervals;
+    for (int i = 1; i < s_frameTimes.size(); i++)
+    {
+        intervals.append(s_frameTimes[i] - s_frameTimes[i - 1]);
+    }
+    std::sort(intervals.begin(), intervals.end());
+
+    GStreamerStats *stats = static_cast<GStreamerStats*>(m_player->getStats());
+
+    QTextStream out(stdout);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(2);
+    out << "pipeline        : " << buildPipeline() << "\n";
+    out << "caps            : " << m_player->getVideoCaps() << "\n";
+    out << "duration (s)    : " << wall << "\n";
+    out << "frames rendered : " << s_frameTimes.size() << "\n";
+    out << "render fps      : " << (wall > 0 ? s_frameTimes.size() / wall : 0.0) << "\n";
+    out << "frame time (ms) : p50 " << percentile(intervals, 0.50)
+        << " p95 " << percentile(intervals, 0.95)
+        << " p99 " << percentile(intervals, 0.99)
+        << " max " << (intervals.isEmpty() ? 0.0 : intervals.last() / 1e6) << "\n";
+    out << "dropped (qos)   : " << stats->getDroppedFrames() << "\n";
+    out << "stale (mailbox) : " << stats->getStaleFrames() << "\n";
+    out << "cpu (%)         : " << (wall > 0 ? 100.0 * cpu / wall : 0.0) << "\n";
+    out << "rss (kB)        : " << memoryKb("VmRSS:") << " peak " << memoryKb("VmHWM:") << "\n";
+    out.flush();
+}
+
+double VideoBench::percentile(const QVector<qint64> & sorted, double p)
+{
+    if (sorted.isEmpty()) return 0;
+    int index = qBound(0, int(p * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+    return sorted[index] / 1e6;
+}
+
+double VideoBench::cpuSeconds()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+         + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+qint64 VideoBench::memoryKb(const char *field)
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) return -1;
+
+    foreach (const QByteArray & line, status.readAll().split('\n'))
+    {
+        if (line.startsWith(field))
+        {
+            return line.mid(qstrlen(field)).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,100 @@
+/*
+   Copyright (C) 2010 Marco Ballesio <gibrovacco@gmail.com>
+   Copyright (C) 2011-2013 Collabora Ltd.
+     @author George Kiagiadakis <george.kiagiadakis@collabora.co.uk>
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VideoBench_H
+#define VideoBench_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtQuick/QQuickView>
+#include <QGst/Quick/VideoSurface>
+#include "GStreamerPlayer.h"
+
+/**
+ * @brief Headless / on-device benchmark of the video path
+ *
+ * Drives GStreamerPlayer and a VideoSurface exactly like the HUD does, from a
+ * videotestsrc or a recorded RTP capture, for a fixed number of seconds and
+ * then prints render fps, frame-time percentiles, CPU load and memory use.
+ */
+class VideoBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VideoBench(QObject *parent = 0);
+    ~VideoBench();
+
+    /** @brief Parse the command line, returns false if the run should not start */
+    bool configure(const QStringList & arguments);
+
+    /** @brief Build the view and start the pipeline, false if the view could not be wired */
+    bool start();
+
+    /** @brief 0 when frames were rendered during the measured run */
+    int exitCode() { return m_exitCode; }
+
+    /** @brief Called from the render thread by update_node() for every frame drawn */
+    static void frameRendered();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void onWarmupDone();
+    void onRunDone();
+    void onMessageBox(QString message);
+
+private:
+    QString buildPipeline() const;
+    void report();
+
+    static double percentile(const QVector<qint64> & sorted, double p);
+    static double cpuSeconds();
+    static qint64 memoryKb(const char *field);
+
+    QQuickView *m_view;
+    QGst::Quick::VideoSurface *m_surface;
+    GStreamerPlayer *m_player;
+    QTimer m_warmupTimer;
+    QTimer m_runTimer;
+
+    QString m_pipeline;
+    QString m_rtpFile;
+    QString m_encoding;
+    int m_width;
+    int m_height;
+    int m_framerate;
+    int m_duration;
+    int m_warmup;
+    bool m_zeroCopy;
+    int m_exitCode;
+
+    double m_cpuStart;
+    QElapsedTimer m_wallClock;
+
+    static QMutex s_frameMutex;
+    static QElapsedTimer s_frameClock;
+    static QVector<qint64> s_frameTimes;
+    static bool s_recording;
+};
+
+#endif // VideoBench_H
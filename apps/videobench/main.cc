@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2012-2013 Collabora Ltd. <info@collabora.com>
+      @author George Kiagiadakis <george.kiagiadakis@collabora.com>
+    Copyright (C) 2013 basysKom GmbH <info@basyskom.com>
+      @author Benjamin Federau <benjamin.federau@basyskom.com>
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtGui/QGuiApplication>
+#include <QGst/Init>
+#include <gst/gst.h>
+#include <string.h>
+#include <gstqtquick2videosink.h>
+#include <GStreamerStats.h>
+#include <GStreamerFrameMailbox.h>
+#include "VideoBench.h"
+
+// Needed to manually register plugin
+gboolean plugin_init(GstPlugin *plugin);
+
+gpointer gst_qt_quick2_video_sink_update_node(GstQtQuick2VideoSink *self, gpointer node, qreal x, qreal y, qreal w, qreal h);
+
+// Same hook as the HUD, plus the benchmark frame clock
+void* update_node(void* surface,  void* node, qreal x, qreal y, qreal w, qreal h)
+{
+    GStreamerStats::frameRendered(surface);
+    VideoBench::frameRendered();
+    void *result = gst_qt_quick2_video_sink_update_node((GstQtQuick2VideoSink*)surface, (gpointer)node, x, y, w, h);
+    GStreamerFrameMailbox::frameRendered(surface);
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    // The platform has to be chosen before the application exists
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0) qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication app(argc, argv);
+
+    QGst::init(&argc, &argv);
+
+    gboolean success = gst_plugin_register_static (GST_VERSION_MAJOR,
+                                GST_VERSION_MINOR ,
+                                "qt5videosink",
+                                "A video sink that can draw on any Qt surface",
+                                &plugin_init,
+                                "1.2.0",
+                                "LGPL",
+                                "libgstqt5videosink.so",
+                                "QtGStreamer",
+                                "http://gstreamer.freedesktop.org");
+
+    if (!success)
+    {
+        qCritical() << "Could not register qt5videosink plugin with GStreamer!";
+        return 1;
+    }
+
+    int retVal = 1;
+    {
+        VideoBench bench;
+        QObject::connect(&bench, SIGNAL(finished(int)), &app, SLOT(quit()));
+        if (bench.configure(app.arguments()) && bench.start())
+        {
+            app.exec();
+            retVal = bench.exitCode();
+        }
+    }
+
+    QGst::cleanup();
+
+    return retVal;
+}
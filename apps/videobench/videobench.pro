@@ -0,0 +1,123 @@
+# Video pipeline benchmark
+# drives GStreamerPlayer and the qt5videosink from a synthetic or recorded
+# source for a fixed time and reports render fps, frame times, cpu and memory
+
+QT += core gui widgets qml quick opengl
+
+DEFINES += QTVIDEOSINK_NAME=qt5videosink
+
+TEMPLATE = app
+TARGET = videobench
+
+LANGUAGE = C++
+
+HUD_ROOT = $$PWD/../..
+SINK_ROOT = $$HUD_ROOT/../../elements/gstqtvideosink
+isEmpty(SINK_BUILD_ROOT): SINK_BUILD_ROOT = $$HUD_ROOT/../../build-armv7-release/elements/gstqtvideosink
+
+INCLUDEPATH += $$HUD_ROOT \
+    $$HUD_ROOT/QsLog \
+    $$SINK_ROOT \
+    $$SINK_BUILD_ROOT
+
+android {
+    # Same prebuilt libraries as QtGStreamerHUD, armeabi-v7a release only
+    isEmpty(GST_ANDROID_ROOT): GST_ANDROID_ROOT = $$HUD_ROOT/../../../gstreamer-1.0-android-armv7-release-1.4.5
+    QTGST_LIBS = $$HUD_ROOT/../../libs/armeabi-v7a/Release
+
+    ANDROID_EXTRA_LIBS += $$QTGST_LIBS/libgstreamer_android.so
+    ANDROID_EXTRA_LIBS += $$QTGST_LIBS/libQtGStreamerQuick2.so
+    INCLUDEPATH += $$GST_ANDROID_ROOT/include/gstreamer-1.0
+    INCLUDEPATH += $$GST_ANDROID_ROOT/include/glib-2.0
+    INCLUDEPATH += $$GST_ANDROID_ROOT/lib/glib-2.0/include
+
+    LIBS += -L$$QTGST_LIBS -lQt5GStreamerQuick-1.0 -lQt5GStreamerUi-1.0 -lQt5GStreamerUtils-1.0 -lQt5GStreamer-1.0 -lQt5GLib-2.0
+    LIBS += -L$$GST_ANDROID_ROOT/lib/ -lgstreamer_android -lgstpbutils-1.0 -lorc-0.4 -lffi -lgmodule-2.0 -lglib-2.0 -lintl -liconv
+} else {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += Qt5GStreamer-1.0 Qt5GStreamerQuick-1.0 Qt5GStreamerUtils-1.0 gstreamer-1.0 gstreamer-video-1.0 gstreamer-rtsp-server-1.0
+}
+
+# Player and sink sources shared with QtGStreamerHUD
+HEADERS += \
+    $$SINK_ROOT/gstqtglvideosink.h \
+    $$SINK_ROOT/gstqtglvideosinkbase.h \
+    $$SINK_ROOT/gstqtquick2videosink.h \
+    $$SINK_ROOT/gstqtvideosink.h \
+    $$SINK_ROOT/gstqtvideosinkbase.h \
+    $$SINK_ROOT/gstqtvideosinkplugin.h \
+    $$SINK_ROOT/gstqwidgetvideosink.h \
+    $$SINK_BUILD_ROOT/gstqtvideosinkmarshal.h \
+    $$SINK_ROOT/delegates/basedelegate.h \
+    $$SINK_ROOT/delegates/qtquick2videosinkdelegate.h \
+    $$SINK_ROOT/delegates/qtvideosinkdelegate.h \
+    $$SINK_ROOT/delegates/qwidgetvideosinkdelegate.h \
+    $$SINK_ROOT/painters/abstractsurfacepainter.h \
+    $$SINK_ROOT/painters/genericsurfacepainter.h \
+    $$SINK_ROOT/painters/openglsurfacepainter.h \
+    $$SINK_ROOT/painters/videomaterial.h \
+    $$SINK_ROOT/painters/videonode.h \
+    $$SINK_ROOT/utils/bufferformat.h \
+    $$SINK_ROOT/utils/utils.h \
+    $$HUD_ROOT/GStreamerPlayer.h \
+    $$HUD_ROOT/GStreamerPipelineBuilder.h \
+    $$HUD_ROOT/GStreamerStats.h \
+    $$HUD_ROOT/GStreamerRecorder.h \
+    $$HUD_ROOT/GStreamerRestreamer.h \
+    $$HUD_ROOT/GStreamerSnapshot.h \
+    $$HUD_ROOT/GStreamerFrameMailbox.h \
+    $$HUD_ROOT/GStreamerDecoderProbe.h \
+    $$HUD_ROOT/configuration.h \
+    $$HUD_ROOT/globalobject.h \
+    $$HUD_ROOT/SettingsStore.h \
+    $$HUD_ROOT/QsLog/QsLog.h \
+    $$HUD_ROOT/QsLog/QsLogDest.h \
+    $$HUD_ROOT/QsLog/QsLogBinary.h \
+    $$HUD_ROOT/QsLog/QsLogDestBufferedFile.h \
+    $$HUD_ROOT/QsLog/QsLogLimit.h
+
+SOURCES += \
+    $$SINK_ROOT/gstqtglvideosink.cpp \
+    $$SINK_ROOT/gstqtglvideosinkbase.cpp \
+    $$SINK_ROOT/gstqtquick2videosink.cpp \
+    $$SINK_ROOT/gstqtvideosink.cpp \
+    $$SINK_ROOT/gstqtvideosinkbase.cpp \
+    $$SINK_ROOT/gstqtvideosinkplugin.cpp \
+    $$SINK_ROOT/gstqwidgetvideosink.cpp \
+    $$SINK_BUILD_ROOT/gstqtvideosinkmarshal.c \
+    $$SINK_ROOT/delegates/basedelegate.cpp \
+    $$SINK_ROOT/delegates/qtquick2videosinkdelegate.cpp \
+    $$SINK_ROOT/delegates/qtvideosinkdelegate.cpp \
+    $$SINK_ROOT/delegates/qwidgetvideosinkdelegate.cpp \
+    $$SINK_ROOT/painters/genericsurfacepainter.cpp \
+    $$SINK_ROOT/painters/openglsurfacepainter.cpp \
+    $$SINK_ROOT/painters/videomaterial.cpp \
+    $$SINK_ROOT/painters/videonode.cpp \
+    $$SINK_ROOT/utils/bufferformat.cpp \
+    $$SINK_ROOT/utils/utils.cpp \
+    $$HUD_ROOT/GStreamerPlayer.cpp \
+    $$HUD_ROOT/GStreamerPipelineBuilder.cpp \
+    $$HUD_ROOT/GStreamerStats.cpp \
+    $$HUD_ROOT/GStreamerRecorder.cpp \
+    $$HUD_ROOT/GStreamerRestreamer.cpp \
+    $$HUD_ROOT/GStreamerSnapshot.cpp \
+    $$HUD_ROOT/GStreamerFrameMailbox.cpp \
+    $$HUD_ROOT/GStreamerDecoderProbe.cpp \
+    $$HUD_ROOT/globalobject.cc \
+    $$HUD_ROOT/SettingsStore.cc \
+    $$HUD_ROOT/QsLog/QsLog.cpp \
+    $$HUD_ROOT/QsLog/QsLogDest.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestConsole.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestFile.cpp \
+    $$HUD_ROOT/QsLog/QsLogBinary.cpp \
+    $$HUD_ROOT/QsLog/QsLogDestBufferedFile.cpp \
+    $$HUD_ROOT/QsLog/QsLogLimit.cpp
+
+# Standalone files
+HEADERS += VideoBench.h
+SOURCES += main.cc \
+    VideoBench.cc
+
+RESOURCES += videobench.qrc
+
+CONFIG += warn_off
@@ -0,0 +1,15 @@
+import QtQuick 2.1
+import QtGStreamer 1.0
+
+Rectangle {
+    id: root
+    color: "black"
+
+    VideoItem {
+        id: video
+        objectName: "video"
+        width: root.width
+        height: root.height
+        surface: videoSurface1 //bound on the context from VideoBench
+    }
+}
@@ -0,0 +1,78 @@
+#include "AlsaAudioBackend.h"
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID) && !defined(AUDIO_NULL_BACKEND)
+
+#include "QsLog.h"
+#include <alsa/asoundlib.h>
+
+AlsaAudioBackend::AlsaAudioBackend() :
+    m_pcm(NULL)
+{
+}
+
+AlsaAudioBackend::~AlsaAudioBackend()
+{
+    if (m_pcm)
+    {
+        snd_pcm_drain(m_pcm);
+        snd_pcm_close(m_pcm);
+    }
+}
+
+bool AlsaAudioBackend::open(int sampleRate, int periodFrames, QString *error)
+{
+    int res = snd_pcm_open(&m_pcm, "default", SND_PCM_STREAM_PLAYBACK, 0);
+    if (res < 0)
+    {
+        *error = QString("snd_pcm_open: %1").arg(snd_strerror(res));
+        m_pcm = NULL;
+        return false;
+    }
+    // Two periods of buffering, the engine keeps it full
+    const unsigned int latencyUs = static_cast<unsigned int>(2000000LL * periodFrames / sampleRate);
+    res = snd_pcm_set_params(m_pcm, SND_PCM_FORMAT_S16, SND_PCM_ACCESS_RW_INTERLEAVED,
+                             1, sampleRate, 1, latencyUs);
+    if (res < 0)
+    {
+        *error = QString("snd_pcm_set_params: %1").arg(snd_strerror(res));
+        snd_pcm_close(m_pcm);
+        m_pcm = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool AlsaAudioBackend::write(const qint16 *samples, int frames)
+{
+    while (frames > 0)
+    {
+        snd_pcm_sframes_t written = snd_pcm_writei(m_pcm, samples, frames);
+        if (written < 0)
+        {
+            // Underrun or suspend, start over rather than give up the device
+            written = snd_pcm_recover(m_pcm, static_cast<int>(written), 1);
+            if (written < 0)
+            {
+                QLOG_WARN() << "ALSA write failed:" << snd_strerror(static_cast<int>(written));
+                return false;
+            }
+            continue;
+        }
+        samples += written;
+        frames -= static_cast<int>(written);
+    }
+    return true;
+}
+
+void AlsaAudioBackend::pause()
+{
+    // Let the last period play out, then the device idles
+    snd_pcm_drain(m_pcm);
+}
+
+void AlsaAudioBackend::resume()
+{
+    snd_pcm_prepare(m_pcm);
+}
+
+#endif
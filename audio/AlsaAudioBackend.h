@@ -0,0 +1,29 @@
+#ifndef ALSAAUDIOBACKEND_H
+#define ALSAAUDIOBACKEND_H
+
+#include "AudioBackend.h"
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID) && !defined(AUDIO_NULL_BACKEND)
+
+typedef struct _snd_pcm snd_pcm_t;
+
+/** @brief Blocking writes to the ALSA "default" playback device */
+class AlsaAudioBackend : public AudioBackend
+{
+public:
+    AlsaAudioBackend();
+    ~AlsaAudioBackend();
+
+    bool open(int sampleRate, int periodFrames, QString *error);
+    bool write(const qint16 *samples, int frames);
+    void pause();
+    void resume();
+    QString name() const { return QLatin1String("alsa"); }
+
+private:
+    snd_pcm_t *m_pcm;
+};
+
+#endif
+
+#endif // ALSAAUDIOBACKEND_H
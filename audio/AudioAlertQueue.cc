@@ -0,0 +1,212 @@
+#include "AudioAlertQueue.h"
+#include <QTimer>
+
+// Speech runs at roughly 14 characters a second, plus the start of the output
+static const int StartMs = 400;
+static const int MsPerCharacter = 70;
+// Time for a clip to reach the speaker after play()
+static const int ClipLatencyMs = 100;
+
+AudioAlertQueue::AudioAlertQueue() :
+    m_speaking(false),
+    m_speakingPriority(PriorityLow),
+    m_doneTimer(new QTimer(this)),
+    m_clipsEnabled(0),
+    m_spoken(0),
+    m_clips(0),
+    m_duplicates(0),
+    m_overflows(0),
+    m_stale(0),
+    m_interrupted(0)
+{
+    m_doneTimer->setSingleShot(true);
+    connect(m_doneTimer, SIGNAL(timeout()), this, SLOT(finished()));
+    m_clock.start();
+    // The timer and the queue live on the alert thread
+    moveToThread(this);
+    start(QThread::LowPriority);
+}
+
+AudioAlertQueue::~AudioAlertQueue()
+{
+    quit();
+    wait();
+}
+
+void AudioAlertQueue::run()
+{
+    // Decoding every clip takes a while on a phone, keep it off the GUI thread.
+    // Alerts posted meanwhile wait in the event queue.
+    m_clipCache.load(AudioClipCache::defaultDirectory());
+    exec();
+}
+
+AudioAlertQueue::Priority AudioAlertQueue::priorityForSeverity(int severity)
+{
+    if (severity <= 2)
+    {
+        // EMERGENCY, ALERT, CRITICAL
+        return PriorityCritical;
+    }
+    if (severity <= 4)
+    {
+        // ERROR, WARNING
+        return PriorityHigh;
+    }
+    return severity <= 6 ? PriorityNormal : PriorityLow;
+}
+
+void AudioAlertQueue::post(const QString &text, Priority priority)
+{
+    QMetaObject::invokeMethod(this, "enqueue", Qt::QueuedConnection, Q_ARG(QString, text), Q_ARG(int, priority));
+}
+
+void AudioAlertQueue::clear()
+{
+    QMetaObject::invokeMethod(this, "drop", Qt::QueuedConnection);
+}
+
+void AudioAlertQueue::setClipsEnabled(bool enabled)
+{
+    m_clipsEnabled.store(enabled ? 1 : 0);
+}
+
+void AudioAlertQueue::speakingFinished()
+{
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+}
+
+AudioAlertQueue::Stats AudioAlertQueue::stats() const
+{
+    Stats stats;
+    stats.spoken = m_spoken.load();
+    stats.clips = m_clips.load();
+    stats.duplicates = m_duplicates.load();
+    stats.overflows = m_overflows.load();
+    stats.stale = m_stale.load();
+    stats.interrupted = m_interrupted.load();
+    return stats;
+}
+
+void AudioAlertQueue::enqueue(QString text, int priority)
+{
+    qint64 now = m_clock.elapsed();
+    // Forget texts older than the window, the hash stays as small as the recent chatter
+    QHash<QString, qint64>::iterator it = m_recent.begin();
+    while (it != m_recent.end())
+    {
+        if (now - it.value() >= DuplicateWindowMs)
+        {
+            it = m_recent.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if (m_recent.contains(text))
+    {
+        m_duplicates.fetchAndAddRelaxed(1);
+        return;
+    }
+    m_recent.insert(text, now);
+
+    Alert alert;
+    alert.text = text;
+    alert.priority = static_cast<Priority>(qBound(static_cast<int>(PriorityLow), priority, static_cast<int>(PriorityCritical)));
+    alert.queuedMs = now;
+
+    if (alert.priority == PriorityCritical && m_speaking && m_speakingPriority < PriorityCritical)
+    {
+        m_interrupted.fetchAndAddRelaxed(1);
+        emit interrupt();
+        m_doneTimer->stop();
+        m_speaking = false;
+    }
+    insert(alert);
+    if (!m_speaking)
+    {
+        next();
+    }
+}
+
+void AudioAlertQueue::insert(const Alert &alert)
+{
+    if (m_alerts.size() >= MaxQueued)
+    {
+        // The oldest of the least important goes, unless that is more important than the new one
+        int victim = m_alerts.size() - 1;
+        Priority lowest = m_alerts[victim].priority;
+        while (victim > 0 && m_alerts[victim - 1].priority == lowest)
+        {
+            --victim;
+        }
+        m_overflows.fetchAndAddRelaxed(1);
+        if (lowest > alert.priority)
+        {
+            return;
+        }
+        m_alerts.removeAt(victim);
+    }
+    int index = 0;
+    while (index < m_alerts.size() && m_alerts[index].priority >= alert.priority)
+    {
+        ++index;
+    }
+    m_alerts.insert(index, alert);
+}
+
+void AudioAlertQueue::next()
+{
+    qint64 now = m_clock.elapsed();
+    while (!m_alerts.isEmpty())
+    {
+        Alert alert = m_alerts.takeFirst();
+        if (alert.priority < PriorityCritical && now - alert.queuedMs > StaleMs)
+        {
+            m_stale.fetchAndAddRelaxed(1);
+            continue;
+        }
+        m_speaking = true;
+        m_speakingPriority = alert.priority;
+        m_spoken.fetchAndAddRelaxed(1);
+        QByteArray pcm;
+        if (m_clipsEnabled.load() && m_clipCache.render(alert.text, &pcm))
+        {
+            m_clips.fetchAndAddRelaxed(1);
+            m_doneTimer->start(AudioClipCache::durationMs(pcm) + ClipLatencyMs);
+            emit play(pcm, alert.priority);
+            return;
+        }
+        m_doneTimer->start(estimateMs(alert.text));
+        emit speak(alert.text, alert.priority);
+        return;
+    }
+}
+
+void AudioAlertQueue::finished()
+{
+    if (!m_speaking)
+    {
+        return;
+    }
+    m_doneTimer->stop();
+    m_speaking = false;
+    next();
+}
+
+void AudioAlertQueue::drop()
+{
+    m_alerts.clear();
+    if (m_speaking)
+    {
+        emit interrupt();
+        m_doneTimer->stop();
+        m_speaking = false;
+    }
+}
+
+int AudioAlertQueue::estimateMs(const QString &text)
+{
+    return StartMs + MsPerCharacter * text.size();
+}
@@ -0,0 +1,145 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AudioAlertQueue
+ *          Decides what is spoken and when, on its own thread. Alerts carry
+ *          a priority taken from the MAVLink severity. An identical text
+ *          within DuplicateWindowMs of the last one is dropped, so a
+ *          flapping mode or a repeated STATUSTEXT is said once. The queue
+ *          holds MaxQueued alerts, ordered by priority and then age; when
+ *          it is full the oldest of the lowest priority goes. Alerts that
+ *          waited longer than StaleMs are no longer news and are skipped,
+ *          critical ones excepted. A critical alert interrupts whatever
+ *          less important speech is playing.
+ *
+ *          The queue only emits play(), speak() and interrupt(); the output
+ *          reports the end of an alert with speakingFinished(). Outputs that
+ *          cannot tell are assumed done after an estimate from the text
+ *          length. Once an output accepts PCM (setClipsEnabled()), alerts
+ *          made entirely of recorded phrases are played from the clip cache,
+ *          which is loaded on this thread, and the rest are synthesised.
+ *
+ */
+
+#ifndef AUDIOALERTQUEUE_H
+#define AUDIOALERTQUEUE_H
+
+#include <QThread>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include "AudioClipCache.h"
+
+class QTimer;
+
+class AudioAlertQueue : public QThread
+{
+    Q_OBJECT
+public:
+    enum Priority { PriorityLow, PriorityNormal, PriorityHigh, PriorityCritical };
+    enum {
+        MaxQueued = 8,
+        DuplicateWindowMs = 10000,
+        StaleMs = 15000
+    };
+
+    struct Stats
+    {
+        int spoken;
+        int clips;          ///< Of those spoken, played from recorded clips
+        int duplicates;     ///< Dropped as a repeat within the window
+        int overflows;      ///< Dropped because the queue was full
+        int stale;          ///< Skipped after waiting too long
+        int interrupted;    ///< Cut short by a critical alert
+        Stats() : spoken(0), clips(0), duplicates(0), overflows(0), stale(0), interrupted(0) {}
+    };
+
+    /** @brief Moves itself to its own thread, so it cannot have a parent */
+    AudioAlertQueue();
+    ~AudioAlertQueue();
+
+    /** @brief Priority of a MAV_SEVERITY, 0 emergency to 7 debug */
+    static Priority priorityForSeverity(int severity);
+
+    /** @brief Queue text for speaking. Any thread */
+    void post(const QString &text, Priority priority);
+    /** @brief Drop everything queued and stop the current alert. Any thread */
+    void clear();
+    /** @brief Whether an output plays the PCM of play(). Any thread */
+    void setClipsEnabled(bool enabled);
+    Stats stats() const;
+
+signals:
+    /** @brief Play Int16 mono PCM at AudioClipCache::SampleRate now */
+    void play(QByteArray pcm, int priority);
+    /** @brief Say text now, emitted on the queue thread */
+    void speak(QString text, int priority);
+    /** @brief Stop the alert being spoken */
+    void interrupt();
+
+public slots:
+    /** @brief The output finished the last speak(). Any thread */
+    void speakingFinished();
+
+protected:
+    void run();
+
+private slots:
+    void enqueue(QString text, int priority);
+    void drop();
+    void finished();
+
+private:
+    struct Alert
+    {
+        QString text;
+        Priority priority;
+        qint64 queuedMs;
+    };
+    void insert(const Alert &alert);
+    void next();
+    static int estimateMs(const QString &text);
+
+    // Owned by the queue thread
+    QList<Alert> m_alerts;              ///< Most important first, oldest first within a priority
+    QHash<QString, qint64> m_recent;    ///< Text to the time it was last accepted
+    bool m_speaking;
+    Priority m_speakingPriority;
+    QTimer *m_doneTimer;                ///< Fallback for outputs that do not report the end
+    QElapsedTimer m_clock;
+    AudioClipCache m_clipCache;         ///< Written once in run() before any alert
+    QAtomicInt m_clipsEnabled;
+
+    QAtomicInt m_spoken;
+    QAtomicInt m_clips;
+    QAtomicInt m_duplicates;
+    QAtomicInt m_overflows;
+    QAtomicInt m_stale;
+    QAtomicInt m_interrupted;
+};
+
+#endif // AUDIOALERTQUEUE_H
@@ -0,0 +1,73 @@
+#include "AudioBackend.h"
+#include "AlsaAudioBackend.h"
+#include "OpenSLAudioBackend.h"
+#include "GStreamerAudioBackend.h"
+#include <QElapsedTimer>
+#include <QThread>
+
+namespace {
+
+/** @brief Paces the engine like a device would and drops the samples */
+class NullAudioBackend : public AudioBackend
+{
+public:
+    NullAudioBackend() : m_sampleRate(1), m_written(0) {}
+
+    bool open(int sampleRate, int periodFrames, QString *error)
+    {
+        Q_UNUSED(periodFrames);
+        Q_UNUSED(error);
+        m_sampleRate = sampleRate;
+        resume();
+        return true;
+    }
+
+    bool write(const qint16 *samples, int frames)
+    {
+        Q_UNUSED(samples);
+        m_written += frames;
+        const qint64 aheadMs = m_written * 1000 / m_sampleRate - m_clock.elapsed();
+        if (aheadMs > 0)
+        {
+            QThread::msleep(aheadMs);
+        }
+        return true;
+    }
+
+    void pause() {}
+
+    void resume()
+    {
+        m_written = 0;
+        m_clock.start();
+    }
+
+    QString name() const { return QLatin1String("null"); }
+
+private:
+    int m_sampleRate;
+    qint64 m_written;
+    QElapsedTimer m_clock;
+};
+
+}
+
+AudioBackend *AudioBackend::create(const QString &name)
+{
+#if defined(AUDIO_NULL_BACKEND)
+    Q_UNUSED(name);
+    return new NullAudioBackend();
+#else
+    if (name == QLatin1String("gstreamer"))
+    {
+        return new GStreamerAudioBackend();
+    }
+#if defined(Q_OS_ANDROID)
+    return new OpenSLAudioBackend();
+#elif defined(Q_OS_LINUX)
+    return new AlsaAudioBackend();
+#else
+    return new NullAudioBackend();
+#endif
+#endif
+}
@@ -0,0 +1,59 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AudioBackend
+ *          The platform half of the AudioEngine: an output stream of Int16
+ *          mono PCM written one period at a time. ALSA on Linux, OpenSL ES
+ *          on Android and a silent clock everywhere else, or when the build
+ *          defines AUDIO_NULL_BACKEND. "gstreamer" selects a pipeline on the
+ *          GStreamer runtime instead. Used only from the engine thread.
+ *
+ */
+
+#ifndef AUDIOBACKEND_H
+#define AUDIOBACKEND_H
+
+#include <QString>
+#include <QtGlobal>
+
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() {}
+
+    /** @brief Open the device with room for about two periods of latency */
+    virtual bool open(int sampleRate, int periodFrames, QString *error) = 0;
+    /** @brief Queue one period, blocks until the device has room for it */
+    virtual bool write(const qint16 *samples, int frames) = 0;
+    /** @brief Stop the stream while idle, the device stays open */
+    virtual void pause() = 0;
+    virtual void resume() = 0;
+    virtual QString name() const = 0;
+
+    /** @brief The named backend, or the one for this platform if name is
+     *  empty or unknown. Never NULL */
+    static AudioBackend *create(const QString &name = QString());
+};
+
+#endif // AUDIOBACKEND_H
@@ -0,0 +1,303 @@
+#include "AudioClipCache.h"
+#include "QsLog.h"
+#include "configuration.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QVector>
+#include <QtEndian>
+
+static const char *const Ones[] = {
+    "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+    "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen",
+    "seventeen", "eighteen", "nineteen"
+};
+static const char *const Tens[] = {
+    "", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"
+};
+
+AudioClipCache::AudioClipCache() :
+    m_bytes(0)
+{
+}
+
+QString AudioClipCache::defaultDirectory()
+{
+#ifdef Q_OS_ANDROID
+    return QLatin1String("assets:/audio/clips");
+#else
+    return QGC::shareDirectory() + QLatin1String("/files/audio/clips");
+#endif
+}
+
+int AudioClipCache::load(const QString &directory)
+{
+    QDir dir(directory);
+    QStringList files = dir.entryList(QStringList() << "*.wav", QDir::Files, QDir::Name);
+    foreach (const QString &name, files)
+    {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            QLOG_WARN() << "Audio clip" << file.fileName() << "could not be opened:" << file.errorString();
+            continue;
+        }
+        QByteArray pcm;
+        QString error;
+        if (!decodeWav(file.readAll(), &pcm, &error))
+        {
+            QLOG_WARN() << "Audio clip" << file.fileName() << "skipped:" << error;
+            continue;
+        }
+        QString phrase = QFileInfo(name).completeBaseName().toLower().replace('_', ' ');
+        m_bytes += pcm.size() - m_clips.value(phrase).size();
+        m_clips.insert(phrase, pcm);
+    }
+    QLOG_INFO() << "Loaded" << m_clips.size() << "audio clips," << m_bytes / 1024 << "KB, from" << directory;
+    return m_clips.size();
+}
+
+bool AudioClipCache::decodeWav(const QByteArray &data, QByteArray *pcm, QString *error)
+{
+    const uchar *bytes = reinterpret_cast<const uchar*>(data.constData());
+    const int size = data.size();
+    if (size < 12 || qstrncmp(data.constData(), "RIFF", 4) != 0 || qstrncmp(data.constData() + 8, "WAVE", 4) != 0)
+    {
+        *error = "not a WAV file";
+        return false;
+    }
+
+    int channels = 0;
+    int rate = 0;
+    int bits = 0;
+    const uchar *samples = 0;
+    int sampleBytes = 0;
+    int pos = 12;
+    while (pos + 8 <= size)
+    {
+        const quint32 chunkSize = qFromLittleEndian<quint32>(bytes + pos + 4);
+        const int body = pos + 8;
+        if (chunkSize > static_cast<quint32>(size - body))
+        {
+            *error = "truncated chunk";
+            return false;
+        }
+        if (qstrncmp(data.constData() + pos, "fmt ", 4) == 0 && chunkSize >= 16)
+        {
+            if (qFromLittleEndian<quint16>(bytes + body) != 1)
+            {
+                *error = "not PCM";
+                return false;
+            }
+            channels = qFromLittleEndian<quint16>(bytes + body + 2);
+            rate = qFromLittleEndian<quint32>(bytes + body + 4);
+            bits = qFromLittleEndian<quint16>(bytes + body + 14);
+        }
+        else if (qstrncmp(data.constData() + pos, "data", 4) == 0)
+        {
+            samples = bytes + body;
+            sampleBytes = chunkSize;
+        }
+        // Chunks are padded to an even size
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+    if (channels < 1 || rate < 1 || (bits != 8 && bits != 16) || !samples)
+    {
+        *error = QString("unsupported format, %1 channels %2 Hz %3 bit").arg(channels).arg(rate).arg(bits);
+        return false;
+    }
+
+    // Mix down to mono
+    const int frameBytes = channels * bits / 8;
+    const int frames = sampleBytes / frameBytes;
+    QVector<qint16> mono(frames);
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        int sum = 0;
+        const uchar *in = samples + frame * frameBytes;
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            if (bits == 8)
+            {
+                sum += (static_cast<int>(in[channel]) - 128) << 8;
+            }
+            else
+            {
+                sum += static_cast<qint16>(qFromLittleEndian<quint16>(in + channel * 2));
+            }
+        }
+        mono[frame] = static_cast<qint16>(sum / channels);
+    }
+
+    // Resample linearly to SampleRate, speech clips do not need better
+    const int outFrames = static_cast<int>(static_cast<qint64>(frames) * SampleRate / rate);
+    pcm->resize(outFrames * sizeof(qint16));
+    qint16 *out = reinterpret_cast<qint16*>(pcm->data());
+    for (int i = 0; i < outFrames; ++i)
+    {
+        const qint64 position = static_cast<qint64>(i) * rate * 256 / SampleRate;
+        const int index = static_cast<int>(position >> 8);
+        const int fraction = static_cast<int>(position & 0xff);
+        const int a = mono[index];
+        const int b = index + 1 < frames ? mono[index + 1] : a;
+        out[i] = static_cast<qint16>(a + ((b - a) * fraction >> 8));
+    }
+    return true;
+}
+
+bool AudioClipCache::render(const QString &text, QByteArray *pcm) const
+{
+    if (m_clips.isEmpty())
+    {
+        return false;
+    }
+    const QStringList list = words(text);
+    if (list.isEmpty())
+    {
+        return false;
+    }
+
+    // Longest phrase first, so "link lost" wins over "link" and "lost"
+    QList<const QByteArray*> parts;
+    int total = 0;
+    int index = 0;
+    while (index < list.size())
+    {
+        const QByteArray *clip = 0;
+        int length = qMin(static_cast<int>(MaxPhraseWords), list.size() - index);
+        for (; length > 0; --length)
+        {
+            QHash<QString, QByteArray>::const_iterator it = m_clips.constFind(QStringList(list.mid(index, length)).join(" "));
+            if (it != m_clips.constEnd())
+            {
+                clip = &it.value();
+                break;
+            }
+        }
+        if (!clip)
+        {
+            return false;
+        }
+        parts.append(clip);
+        total += clip->size();
+        index += length;
+    }
+
+    const int gapBytes = SampleRate * GapMs / 1000 * sizeof(qint16);
+    pcm->clear();
+    pcm->reserve(total + gapBytes * (parts.size() - 1));
+    for (int i = 0; i < parts.size(); ++i)
+    {
+        if (i > 0)
+        {
+            pcm->append(QByteArray(gapBytes, '\0'));
+        }
+        pcm->append(*parts[i]);
+    }
+    return true;
+}
+
+int AudioClipCache::durationMs(const QByteArray &pcm)
+{
+    return static_cast<int>(static_cast<qint64>(pcm.size() / sizeof(qint16)) * 1000 / SampleRate);
+}
+
+QStringList AudioClipCache::words(const QString &text)
+{
+    // Numbers keep their sign and decimal point, everything else splits words
+    QRegExp matcher("-?\\d+(\\.\\d+)?|[a-z']+");
+    const QString lower = text.toLower();
+    QStringList result;
+    int pos = 0;
+    while ((pos = matcher.indexIn(lower, pos)) != -1)
+    {
+        const QString word = matcher.cap(0);
+        if (word[0].isDigit() || word[0] == '-')
+        {
+            appendNumber(word, &result);
+        }
+        else
+        {
+            result.append(word);
+        }
+        pos += matcher.matchedLength();
+    }
+    return result;
+}
+
+void AudioClipCache::appendNumber(const QString &number, QStringList *words)
+{
+    QString digits = number;
+    if (digits.startsWith('-'))
+    {
+        words->append("minus");
+        digits.remove(0, 1);
+    }
+    const int point = digits.indexOf('.');
+    const QString whole = point < 0 ? digits : digits.left(point);
+    if (whole.size() > 9)
+    {
+        // Too long to say as a number, read the digits
+        foreach (const QChar &digit, whole)
+        {
+            words->append(Ones[digit.digitValue()]);
+        }
+    }
+    else
+    {
+        appendInteger(whole.toLongLong(), words);
+    }
+    if (point >= 0)
+    {
+        words->append("point");
+        foreach (const QChar &digit, digits.mid(point + 1))
+        {
+            words->append(Ones[digit.digitValue()]);
+        }
+    }
+}
+
+void AudioClipCache::appendInteger(qint64 value, QStringList *words)
+{
+    if (value >= 1000000)
+    {
+        appendInteger(value / 1000000, words);
+        words->append("million");
+        value %= 1000000;
+        if (value == 0)
+        {
+            return;
+        }
+    }
+    if (value >= 1000)
+    {
+        appendInteger(value / 1000, words);
+        words->append("thousand");
+        value %= 1000;
+        if (value == 0)
+        {
+            return;
+        }
+    }
+    if (value >= 100)
+    {
+        words->append(Ones[value / 100]);
+        words->append("hundred");
+        value %= 100;
+        if (value == 0)
+        {
+            return;
+        }
+    }
+    if (value >= 20)
+    {
+        words->append(Tens[value / 10]);
+        if (value % 10 != 0)
+        {
+            words->append(Ones[value % 10]);
+        }
+        return;
+    }
+    words->append(Ones[value]);
+}
@@ -0,0 +1,86 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AudioClipCache
+ *          Recorded phrases for the common alerts, decoded once into PCM in
+ *          the one format the outputs play (Int16 mono at SampleRate). A
+ *          sentence is put together by joining clips, so an alert built
+ *          from known words starts without synthesis or file access.
+ *
+ *          Clips are WAV files named after their phrase, with underscores
+ *          for spaces ("link_lost.wav", "stabilize.wav", "twenty.wav").
+ *          8 or 16 bit PCM at any rate and channel count is converted on
+ *          load. Numbers in the text are spoken as words, so "battery 12.5
+ *          volts" needs "battery", "twelve", "point", "five" and "volts".
+ *
+ */
+
+#ifndef AUDIOCLIPCACHE_H
+#define AUDIOCLIPCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+class AudioClipCache
+{
+public:
+    enum {
+        SampleRate = 22050,
+        MaxPhraseWords = 4,     ///< Longest clip name matched, in words
+        GapMs = 60              ///< Silence between joined clips
+    };
+
+    AudioClipCache();
+
+    /** @brief Where the clips are installed for this platform */
+    static QString defaultDirectory();
+
+    /** @brief Decode every WAV in directory, returns the number of clips loaded */
+    int load(const QString &directory);
+    /** @brief Decode one WAV file into the cache format, false if it is not PCM WAV */
+    static bool decodeWav(const QByteArray &data, QByteArray *pcm, QString *error);
+
+    /** @brief Join the clips speaking text, false if a word has no clip */
+    bool render(const QString &text, QByteArray *pcm) const;
+    bool contains(const QString &phrase) const { return m_clips.contains(phrase); }
+    int count() const { return m_clips.size(); }
+    /** @brief Decoded size of all clips in bytes */
+    int bytes() const { return m_bytes; }
+
+    /** @brief Duration of Int16 mono PCM at SampleRate */
+    static int durationMs(const QByteArray &pcm);
+    /** @brief text in lower case words, numbers spelled out */
+    static QStringList words(const QString &text);
+
+private:
+    static void appendNumber(const QString &number, QStringList *words);
+    static void appendInteger(qint64 value, QStringList *words);
+
+    QHash<QString, QByteArray> m_clips;
+    int m_bytes;
+};
+
+#endif // AUDIOCLIPCACHE_H
@@ -0,0 +1,286 @@
+#include "AudioEngine.h"
+#include "AudioBackend.h"
+#include "AudioClipCache.h"
+#include "QsLog.h"
+#include "ThreadRoles.h"
+#include <cstring>
+
+// Wrap safe difference of two ring positions
+static inline int distance(int a, int b)
+{
+    return static_cast<int>(static_cast<quint32>(a) - static_cast<quint32>(b));
+}
+
+AudioEngine::AudioEngine(const QString &backend, QObject *parent) :
+    QThread(parent),
+    m_pushPos(0),
+    m_popPos(0),
+    m_nextVoice(0),
+    m_volume(UnityGain),
+    m_stopping(0),
+    m_dropped(0),
+    m_backendName(backend),
+    m_voiceCount(0),
+    m_mixBuffer(PeriodFrames),
+    m_outBuffer(PeriodFrames)
+{
+    for (int i = 0; i < CommandCapacity; ++i)
+    {
+        m_commands[i].sequence.store(i);
+    }
+}
+
+AudioEngine::~AudioEngine()
+{
+    m_stopping.store(1);
+    m_wake.release();
+    wait();
+    if (m_dropped.load() > 0)
+    {
+        QLOG_WARN() << "Audio engine dropped" << m_dropped.load() << "commands, the ring was full";
+    }
+}
+
+int AudioEngine::play(const QByteArray &pcm, Channel channel, double gain)
+{
+    int voice = m_nextVoice.fetchAndAddRelaxed(1) + 1;
+    if (voice <= 0)
+    {
+        // Wrapped, 0 means failure
+        voice = m_nextVoice.fetchAndAddRelaxed(1) + 1;
+    }
+    const int q15 = static_cast<int>(qBound(0.0, gain, 1.0) * UnityGain);
+    return push(CommandPlay, voice, channel, q15, pcm) ? voice : 0;
+}
+
+void AudioEngine::stop(int voice)
+{
+    push(CommandStop, voice, ChannelSpeech, 0, QByteArray());
+}
+
+void AudioEngine::stopChannel(Channel channel)
+{
+    push(CommandStopChannel, 0, channel, 0, QByteArray());
+}
+
+void AudioEngine::setVolume(double volume)
+{
+    m_volume.store(static_cast<int>(qBound(0.0, volume, 1.0) * UnityGain));
+}
+
+double AudioEngine::volume() const
+{
+    return static_cast<double>(m_volume.load()) / UnityGain;
+}
+
+bool AudioEngine::push(CommandType type, int voice, Channel channel, int gain, const QByteArray &pcm)
+{
+    int pos = m_pushPos.load();
+    Command *command;
+    forever
+    {
+        command = &m_commands[pos & (CommandCapacity - 1)];
+        const int diff = distance(command->sequence.loadAcquire(), pos);
+        if (diff == 0)
+        {
+            if (m_pushPos.testAndSetRelaxed(pos, pos + 1))
+            {
+                break;
+            }
+            pos = m_pushPos.load();
+        }
+        else if (diff < 0)
+        {
+            m_dropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+        else
+        {
+            pos = m_pushPos.load();
+        }
+    }
+    command->type = type;
+    command->voice = voice;
+    command->channel = channel;
+    command->gain = gain;
+    command->pcm = pcm;
+    command->sequence.storeRelease(pos + 1);
+    m_wake.release();
+    return true;
+}
+
+bool AudioEngine::pop(Command *out)
+{
+    Command *command = &m_commands[m_popPos & (CommandCapacity - 1)];
+    if (distance(command->sequence.loadAcquire(), m_popPos + 1) != 0)
+    {
+        return false;
+    }
+    out->type = command->type;
+    out->voice = command->voice;
+    out->channel = command->channel;
+    out->gain = command->gain;
+    out->pcm = command->pcm;
+    // The sample data is freed on the engine thread, not in the next push
+    command->pcm = QByteArray();
+    command->sequence.storeRelease(m_popPos + CommandCapacity);
+    ++m_popPos;
+    return true;
+}
+
+void AudioEngine::execute(Command &command)
+{
+    switch (command.type)
+    {
+    case CommandPlay:
+        if (m_voiceCount == MaxVoices)
+        {
+            // The oldest voice makes room
+            release(0);
+        }
+        m_voices[m_voiceCount].id = command.voice;
+        m_voices[m_voiceCount].channel = command.channel;
+        m_voices[m_voiceCount].gain = command.gain;
+        m_voices[m_voiceCount].pcm = command.pcm;
+        m_voices[m_voiceCount].position = 0;
+        ++m_voiceCount;
+        break;
+    case CommandStop:
+        for (int i = 0; i < m_voiceCount; ++i)
+        {
+            if (m_voices[i].id == command.voice)
+            {
+                release(i);
+                break;
+            }
+        }
+        break;
+    case CommandStopChannel:
+        for (int i = m_voiceCount - 1; i >= 0; --i)
+        {
+            if (m_voices[i].channel == command.channel)
+            {
+                release(i);
+            }
+        }
+        break;
+    }
+}
+
+void AudioEngine::release(int index)
+{
+    const int id = m_voices[index].id;
+    // Keep the order, index 0 stays the oldest
+    for (int i = index; i + 1 < m_voiceCount; ++i)
+    {
+        m_voices[i] = m_voices[i + 1];
+    }
+    --m_voiceCount;
+    m_voices[m_voiceCount].pcm = QByteArray();
+    emit finished(id);
+}
+
+void AudioEngine::mix(qint16 *out)
+{
+    int *acc = m_mixBuffer.data();
+    std::memset(acc, 0, PeriodFrames * sizeof(int));
+    for (int v = m_voiceCount - 1; v >= 0; --v)
+    {
+        Voice &voice = m_voices[v];
+        const qint16 *samples = reinterpret_cast<const qint16*>(voice.pcm.constData());
+        const int total = voice.pcm.size() / sizeof(qint16);
+        const int frames = qMin(static_cast<int>(PeriodFrames), total - voice.position);
+        for (int i = 0; i < frames; ++i)
+        {
+            acc[i] += (samples[voice.position + i] * voice.gain) >> 15;
+        }
+        voice.position += frames;
+        if (voice.position >= total)
+        {
+            release(v);
+        }
+    }
+    const int volume = m_volume.load();
+    for (int i = 0; i < PeriodFrames; ++i)
+    {
+        out[i] = static_cast<qint16>(qBound(-32768, (acc[i] * volume) >> 15, 32767));
+    }
+}
+
+void AudioEngine::run()
+{
+    ThreadRoles::enter(ThreadRoles::Audio);
+    AudioBackend *backend = AudioBackend::create(m_backendName);
+    QString error;
+    bool ok = backend->open(AudioClipCache::SampleRate, PeriodFrames, &error);
+    if (!ok && !m_backendName.isEmpty())
+    {
+        QLOG_WARN() << "Audio engine could not open" << backend->name() << "output:" << error
+                    << ", using the platform output";
+        delete backend;
+        backend = AudioBackend::create();
+        ok = backend->open(AudioClipCache::SampleRate, PeriodFrames, &error);
+    }
+    if (!ok)
+    {
+        QLOG_WARN() << "Audio engine could not open" << backend->name() << "output:" << error;
+        delete backend;
+        emit opened(false);
+        return;
+    }
+    QLOG_INFO() << "Audio engine on" << backend->name() << "at" << AudioClipCache::SampleRate
+                << "Hz," << PeriodFrames << "frame periods";
+    emit opened(true);
+
+    const qint64 periodUs = 1000000LL * PeriodFrames / AudioClipCache::SampleRate;
+    const int idlePeriods = static_cast<int>(IdleMs * 1000LL / periodUs);
+    int silentPeriods = 0;
+    bool paused = false;
+    Command command;
+
+    while (!m_stopping.load())
+    {
+        // Commands only add to the count, the loop drains the ring each period
+        m_wake.tryAcquire(m_wake.available());
+        while (pop(&command))
+        {
+            execute(command);
+        }
+        command.pcm = QByteArray();
+
+        if (m_voiceCount == 0)
+        {
+            if (++silentPeriods > idlePeriods)
+            {
+                if (!paused)
+                {
+                    backend->pause();
+                    paused = true;
+                }
+                m_wake.acquire();
+                continue;
+            }
+        }
+        else
+        {
+            silentPeriods = 0;
+        }
+        if (paused)
+        {
+            backend->resume();
+            paused = false;
+        }
+
+        mix(m_outBuffer.data());
+        if (!backend->write(m_outBuffer.constData(), PeriodFrames))
+        {
+            // The device went away; stop the voices so the queue moves on
+            while (m_voiceCount > 0)
+            {
+                release(0);
+            }
+            QThread::msleep(periodUs / 1000);
+        }
+    }
+    delete backend;
+}
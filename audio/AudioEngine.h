@@ -0,0 +1,134 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief AudioEngine
+ *          Owns the audio device for the lifetime of the application and
+ *          mixes everything played on it. The device is opened once, with a
+ *          period of PeriodFrames (under 12 ms), so an alert starts within a
+ *          period or two instead of after a device open. Speech and tones
+ *          mix, up to MaxVoices at once, saturating rather than wrapping.
+ *
+ *          Other threads talk to the engine only through a bounded command
+ *          ring: play() and stop() claim a slot with a compare and swap and
+ *          never wait for the mixer. The engine thread drains the ring
+ *          between periods. After IdleMs without a voice it stops the stream
+ *          and sleeps until the next command.
+ *
+ */
+
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QSemaphore>
+#include <QVector>
+
+class AudioBackend;
+
+class AudioEngine : public QThread
+{
+    Q_OBJECT
+public:
+    enum Channel { ChannelSpeech, ChannelTone };
+    enum {
+        PeriodFrames = 256,
+        MaxVoices = 4,
+        CommandCapacity = 64,   // power of two
+        IdleMs = 2000,
+        UnityGain = 32768
+    };
+
+    /** @brief backend names an AudioBackend, the platform one is the fallback.
+     *  Call start() once opened() is connected, the thread opens the device */
+    explicit AudioEngine(const QString &backend = QString(), QObject *parent = NULL);
+    ~AudioEngine();
+
+    /** @brief Mix Int16 mono PCM at AudioClipCache::SampleRate. Any thread.
+     *  @return the voice id reported by finished(), 0 if the command ring is full */
+    int play(const QByteArray &pcm, Channel channel, double gain = 1.0);
+    /** @brief Stop one voice, finished() still follows. Any thread */
+    void stop(int voice);
+    /** @brief Stop every voice on a channel. Any thread */
+    void stopChannel(Channel channel);
+    /** @brief Master volume 0.0 - 1.0. Any thread */
+    void setVolume(double volume);
+    double volume() const;
+
+signals:
+    /** @brief The device is open, or could not be, emitted on the engine thread */
+    void opened(bool ok);
+    /** @brief A voice played to its end or was stopped */
+    void finished(int voice);
+
+protected:
+    void run();
+
+private:
+    enum CommandType { CommandPlay, CommandStop, CommandStopChannel };
+    struct Command
+    {
+        QAtomicInt sequence;    ///< Slot state, as in QsLogging::LogRing
+        CommandType type;
+        int voice;
+        Channel channel;
+        int gain;
+        QByteArray pcm;
+    };
+    struct Voice
+    {
+        int id;
+        Channel channel;
+        int gain;
+        QByteArray pcm;
+        int position;           ///< In samples
+    };
+
+    bool push(CommandType type, int voice, Channel channel, int gain, const QByteArray &pcm);
+    bool pop(Command *command);
+    void execute(Command &command);
+    void mix(qint16 *out);
+    void release(int index);
+
+    Command m_commands[CommandCapacity];
+    QAtomicInt m_pushPos;
+    int m_popPos;               ///< Engine thread only
+    QSemaphore m_wake;          ///< Released after each push, wakes the idle engine
+
+    QAtomicInt m_nextVoice;
+    QAtomicInt m_volume;        ///< Q15, UnityGain is full volume
+    QAtomicInt m_stopping;
+    QAtomicInt m_dropped;       ///< Commands lost to a full ring
+
+    const QString m_backendName;
+
+    // Engine thread only
+    Voice m_voices[MaxVoices];
+    int m_voiceCount;
+    QVector<int> m_mixBuffer;
+    QVector<qint16> m_outBuffer;
+};
+
+#endif // AUDIOENGINE_H
@@ -0,0 +1,125 @@
+#include "GStreamerAudioBackend.h"
+
+#ifndef AUDIO_NULL_BACKEND
+
+#include "QsLog.h"
+#include <cstring>
+
+// Time allowed for the sink to open the device and preroll
+static const GstClockTime StateTimeout = 2 * GST_SECOND;
+
+GStreamerAudioBackend::GStreamerAudioBackend() :
+    m_pipeline(NULL),
+    m_source(NULL)
+{
+}
+
+GStreamerAudioBackend::~GStreamerAudioBackend()
+{
+    if (m_pipeline)
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_source);
+        gst_object_unref(m_pipeline);
+    }
+}
+
+bool GStreamerAudioBackend::open(int sampleRate, int periodFrames, QString *error)
+{
+    const qint64 periodUs = 1000000LL * periodFrames / sampleRate;
+#ifdef Q_OS_ANDROID
+    // Two periods in the sink, the same budget the native backends keep
+    const QString sink = QString("openslessink buffer-time=%1 latency-time=%2").arg(2 * periodUs).arg(periodUs);
+#else
+    const QString sink = QLatin1String("autoaudiosink");
+#endif
+    // A live source timestamps each period as it arrives; block with two
+    // periods queued paces write() like a device would
+    const QString description = QString(
+            "appsrc name=alertsrc is-live=true do-timestamp=true format=time block=true max-bytes=%1 "
+            "caps=audio/x-raw,format=S16LE,layout=interleaved,channels=1,rate=%2 "
+            "! audioconvert ! audioresample ! %3")
+            .arg(2 * periodFrames * sizeof(qint16)).arg(sampleRate).arg(sink);
+
+    GError *parseError = NULL;
+    m_pipeline = gst_parse_launch(description.toUtf8().constData(), &parseError);
+    if (parseError)
+    {
+        *error = QString::fromUtf8(parseError->message);
+        g_error_free(parseError);
+        if (m_pipeline)
+        {
+            gst_object_unref(m_pipeline);
+            m_pipeline = NULL;
+        }
+        return false;
+    }
+    m_source = gst_bin_get_by_name(GST_BIN(m_pipeline), "alertsrc");
+    if (!m_source)
+    {
+        *error = "no appsrc in the audio pipeline";
+        gst_object_unref(m_pipeline);
+        m_pipeline = NULL;
+        return false;
+    }
+    if (!setState(GST_STATE_PLAYING, error))
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_source);
+        gst_object_unref(m_pipeline);
+        m_source = NULL;
+        m_pipeline = NULL;
+        return false;
+    }
+    QLOG_DEBUG() << "Audio pipeline:" << description;
+    return true;
+}
+
+bool GStreamerAudioBackend::setState(GstState state, QString *error)
+{
+    if (gst_element_set_state(m_pipeline, state) == GST_STATE_CHANGE_FAILURE
+            || gst_element_get_state(m_pipeline, NULL, NULL, StateTimeout) == GST_STATE_CHANGE_FAILURE)
+    {
+        *error = QString("audio pipeline did not reach %1").arg(gst_element_state_get_name(state));
+        return false;
+    }
+    return true;
+}
+
+bool GStreamerAudioBackend::write(const qint16 *samples, int frames)
+{
+    const gsize size = frames * sizeof(qint16);
+    GstBuffer *buffer = gst_buffer_new_allocate(NULL, size, NULL);
+    gst_buffer_fill(buffer, 0, samples, size);
+    // push-buffer takes its own reference, no link against gstapp needed
+    GstFlowReturn flow = GST_FLOW_OK;
+    g_signal_emit_by_name(m_source, "push-buffer", buffer, &flow);
+    gst_buffer_unref(buffer);
+    if (flow != GST_FLOW_OK)
+    {
+        QLOG_WARN() << "Audio pipeline refused a buffer:" << gst_flow_get_name(flow);
+        return false;
+    }
+    return true;
+}
+
+void GStreamerAudioBackend::pause()
+{
+    // PAUSED keeps the device and the negotiated pipeline, no preroll later
+    QString error;
+    if (!setState(GST_STATE_PAUSED, &error))
+    {
+        QLOG_WARN() << error;
+    }
+}
+
+void GStreamerAudioBackend::resume()
+{
+    QString error;
+    if (!setState(GST_STATE_PLAYING, &error))
+    {
+        QLOG_WARN() << error;
+    }
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef GSTREAMERAUDIOBACKEND_H
+#define GSTREAMERAUDIOBACKEND_H
+
+#include "AudioBackend.h"
+
+#ifndef AUDIO_NULL_BACKEND
+
+#include <gst/gst.h>
+
+/** @brief Feeds the engine periods into a pipeline built once and kept
+ *  playing: appsrc ! audioconvert ! audioresample ! native sink. Uses the
+ *  GStreamer runtime the video already loads, openslessink on Android, so
+ *  the device is negotiated by the same code on every handset. */
+class GStreamerAudioBackend : public AudioBackend
+{
+public:
+    GStreamerAudioBackend();
+    ~GStreamerAudioBackend();
+
+    bool open(int sampleRate, int periodFrames, QString *error);
+    bool write(const qint16 *samples, int frames);
+    void pause();
+    void resume();
+    QString name() const { return QLatin1String("gstreamer"); }
+
+private:
+    bool setState(GstState state, QString *error);
+
+    GstElement *m_pipeline;
+    GstElement *m_source;
+};
+
+#endif
+
+#endif // GSTREAMERAUDIOBACKEND_H
@@ -0,0 +1,139 @@
+#include "OpenSLAudioBackend.h"
+
+#if defined(Q_OS_ANDROID) && !defined(AUDIO_NULL_BACKEND)
+
+#include <cstring>
+
+OpenSLAudioBackend::OpenSLAudioBackend() :
+    m_engineObject(NULL),
+    m_engine(NULL),
+    m_mixObject(NULL),
+    m_playerObject(NULL),
+    m_play(NULL),
+    m_queue(NULL),
+    m_next(0),
+    m_free(BufferCount)
+{
+}
+
+OpenSLAudioBackend::~OpenSLAudioBackend()
+{
+    destroy();
+}
+
+void OpenSLAudioBackend::destroy()
+{
+    if (m_playerObject)
+    {
+        (*m_playerObject)->Destroy(m_playerObject);
+        m_playerObject = NULL;
+        m_play = NULL;
+        m_queue = NULL;
+    }
+    if (m_mixObject)
+    {
+        (*m_mixObject)->Destroy(m_mixObject);
+        m_mixObject = NULL;
+    }
+    if (m_engineObject)
+    {
+        (*m_engineObject)->Destroy(m_engineObject);
+        m_engineObject = NULL;
+        m_engine = NULL;
+    }
+}
+
+bool OpenSLAudioBackend::open(int sampleRate, int periodFrames, QString *error)
+{
+    SLresult res = slCreateEngine(&m_engineObject, 0, NULL, 0, NULL, NULL);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_engineObject)->Realize(m_engineObject, SL_BOOLEAN_FALSE);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_engineObject)->GetInterface(m_engineObject, SL_IID_ENGINE, &m_engine);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_engine)->CreateOutputMix(m_engine, &m_mixObject, 0, NULL, NULL);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_mixObject)->Realize(m_mixObject, SL_BOOLEAN_FALSE);
+    if (res != SL_RESULT_SUCCESS)
+    {
+        *error = QString("OpenSL ES engine: error %1").arg(res);
+        destroy();
+        return false;
+    }
+
+    SLDataLocator_AndroidSimpleBufferQueue queueLocator = { SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, BufferCount };
+    SLDataFormat_PCM format = { SL_DATAFORMAT_PCM, 1, static_cast<SLuint32>(sampleRate) * 1000,
+                                SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
+                                SL_SPEAKER_FRONT_CENTER, SL_BYTEORDER_LITTLEENDIAN };
+    SLDataSource source = { &queueLocator, &format };
+    SLDataLocator_OutputMix mixLocator = { SL_DATALOCATOR_OUTPUTMIX, m_mixObject };
+    SLDataSink sink = { &mixLocator, NULL };
+    const SLInterfaceID ids[] = { SL_IID_ANDROIDSIMPLEBUFFERQUEUE };
+    const SLboolean required[] = { SL_BOOLEAN_TRUE };
+
+    res = (*m_engine)->CreateAudioPlayer(m_engine, &m_playerObject, &source, &sink, 1, ids, required);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_playerObject)->Realize(m_playerObject, SL_BOOLEAN_FALSE);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_playerObject)->GetInterface(m_playerObject, SL_IID_PLAY, &m_play);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_playerObject)->GetInterface(m_playerObject, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &m_queue);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_queue)->RegisterCallback(m_queue, bufferDone, this);
+    if (res == SL_RESULT_SUCCESS)
+        res = (*m_play)->SetPlayState(m_play, SL_PLAYSTATE_PLAYING);
+    if (res != SL_RESULT_SUCCESS)
+    {
+        *error = QString("OpenSL ES player: error %1").arg(res);
+        destroy();
+        return false;
+    }
+
+    for (int i = 0; i < BufferCount; ++i)
+    {
+        m_buffers[i].resize(periodFrames);
+    }
+    return true;
+}
+
+void OpenSLAudioBackend::bufferDone(SLAndroidSimpleBufferQueueItf queue, void *context)
+{
+    Q_UNUSED(queue);
+    // Runs on the OpenSL ES callback thread
+    static_cast<OpenSLAudioBackend*>(context)->m_free.release();
+}
+
+bool OpenSLAudioBackend::write(const qint16 *samples, int frames)
+{
+    m_free.acquire();
+    QVector<qint16> &buffer = m_buffers[m_next];
+    m_next = (m_next + 1) % BufferCount;
+    if (buffer.size() < frames)
+    {
+        buffer.resize(frames);
+    }
+    std::memcpy(buffer.data(), samples, frames * sizeof(qint16));
+    if ((*m_queue)->Enqueue(m_queue, buffer.constData(), frames * sizeof(qint16)) != SL_RESULT_SUCCESS)
+    {
+        m_free.release();
+        return false;
+    }
+    return true;
+}
+
+void OpenSLAudioBackend::pause()
+{
+    (*m_play)->SetPlayState(m_play, SL_PLAYSTATE_PAUSED);
+    // Clearing drops the queued buffers without a callback, they are free again
+    (*m_queue)->Clear(m_queue);
+    m_free.acquire(m_free.available());
+    m_free.release(BufferCount);
+    m_next = 0;
+}
+
+void OpenSLAudioBackend::resume()
+{
+    (*m_play)->SetPlayState(m_play, SL_PLAYSTATE_PLAYING);
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef OPENSLAUDIOBACKEND_H
+#define OPENSLAUDIOBACKEND_H
+
+#include "AudioBackend.h"
+
+#if defined(Q_OS_ANDROID) && !defined(AUDIO_NULL_BACKEND)
+
+#include <QSemaphore>
+#include <QVector>
+#include <SLES/OpenSLES.h>
+#include <SLES/OpenSLES_Android.h>
+
+/** @brief OpenSL ES buffer queue player, the lowest latency path before AAudio */
+class OpenSLAudioBackend : public AudioBackend
+{
+public:
+    enum { BufferCount = 2 };
+
+    OpenSLAudioBackend();
+    ~OpenSLAudioBackend();
+
+    bool open(int sampleRate, int periodFrames, QString *error);
+    bool write(const qint16 *samples, int frames);
+    void pause();
+    void resume();
+    QString name() const { return QLatin1String("opensles"); }
+
+private:
+    static void bufferDone(SLAndroidSimpleBufferQueueItf queue, void *context);
+    void destroy();
+
+    SLObjectItf m_engineObject;
+    SLEngineItf m_engine;
+    SLObjectItf m_mixObject;
+    SLObjectItf m_playerObject;
+    SLPlayItf m_play;
+    SLAndroidSimpleBufferQueueItf m_queue;
+    QVector<qint16> m_buffers[BufferCount];   ///< Owned by the device until bufferDone()
+    int m_next;
+    QSemaphore m_free;                          ///< Buffers the device gave back
+};
+
+#endif
+
+#endif // OPENSLAUDIOBACKEND_H
@@ -1,7 +1,10 @@
 #include "AbsPositionOverview.h"
+#include "AttitudeHistory.h"
+#include "MAVLinkLatencyTracer.h"
 
 AbsPositionOverview::AbsPositionOverview(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_dirty(0)
 {
     m_timeUsec = 0;
     m_lat = 0;
@@ -24,6 +27,38 @@ AbsPositionOverview::AbsPositionOverview(QObject *parent) :
     m_vz = 0;
     m_hdg = 0;
     m_homeHeading = 0;
+    m_positionReceivedMs = -1;
+}
+
+AbsPositionOverview::~AbsPositionOverview()
+{
+    FramePacer::instance()->cancel(this);
+}
+
+void AbsPositionOverview::flushChanges()
+{
+    quint32 dirty = m_dirty;
+    m_dirty = 0;
+    if (dirty & DirtyTimeUsec) emit timeUsecChanged(m_timeUsec);
+    if (dirty & DirtyLat) emit latChanged(m_lat);
+    if (dirty & DirtyLon) emit lonChanged(m_lon);
+    if (dirty & DirtyAlt) emit altChanged(m_alt);
+    if (dirty & DirtyLatHome) emit latHomeChanged(m_latHome);
+    if (dirty & DirtyLonHome) emit lonHomeChanged(m_lonHome);
+    if (dirty & DirtyAltHome) emit altHomeChanged(m_altHome);
+    if (dirty & DirtyEph) emit ephChanged(m_eph);
+    if (dirty & DirtyEpv) emit epvChanged(m_epv);
+    if (dirty & DirtyVel) emit velChanged(m_vel);
+    if (dirty & DirtyCog) emit cogChanged(m_cog);
+    if (dirty & DirtyFixType) emit fixTypeChanged(m_fixType);
+    if (dirty & DirtySatellitesVisible) emit satellitesVisibleChanged(m_satellitesVisible);
+    if (dirty & DirtyTimeBootMs) emit timeBootMsChanged(m_timeBootMs);
+    if (dirty & DirtyRelativeAlt) emit relativeAltChanged(m_relativeAlt);
+    if (dirty & DirtyVx) emit vxChanged(m_vx);
+    if (dirty & DirtyVy) emit vyChanged(m_vy);
+    if (dirty & DirtyVz) emit vzChanged(m_vz);
+    if (dirty & DirtyHdg) emit hdgChanged(m_hdg);
+    if (dirty & DirtyHomeHeading) emit homeHeadingChanged(m_homeHeading);
 }
 
 void AbsPositionOverview::parseGpsRawInt(LinkInterface *link, const mavlink_message_t &message, const mavlink_gps_raw_int_t &state)
@@ -66,8 +101,10 @@ void AbsPositionOverview::parseGpsRawInt(LinkInterface *link, const mavlink_mess
 void AbsPositionOverview::parseGlobalPositionInt(LinkInterface *link, const mavlink_message_t &message, const mavlink_global_position_int_t &state)
 {
     Q_UNUSED(link);
-    Q_UNUSED(message);
+    m_positionReceivedMs = AttitudeHistory::now();
     this->setRelativeAlt(state.relative_alt/1000.0);
+    MAVLinkLatencyTracer *tracer = MAVLinkLatencyTracer::instance();
+    if (tracer->traces(message)) tracer->reached(message, MAVLinkLatencyTracer::StageProperty);
 }
 
 void AbsPositionOverview::messageReceived(LinkInterface* link,mavlink_message_t message)
@@ -4,8 +4,9 @@
 #include <QObject>
 #include "mavlink.h"
 #include "LinkInterface.h"
+#include "FramePacer.h"
 
-class AbsPositionOverview : public QObject
+class AbsPositionOverview : public QObject, public FramePaced
 {
     Q_OBJECT
 public:
@@ -44,19 +45,19 @@ public:
     unsigned int getCog() { return m_cog; }
     unsigned int getFixType() { return m_fixType; }
     unsigned int getSatellitesVisible() { return m_satellitesVisible; }
-    void setTimeUsec(quint64 timeUsec) { if (m_timeUsec!=timeUsec){m_timeUsec = timeUsec; emit timeUsecChanged(timeUsec);}}
-    void setLat(int lat) { if (m_lat!=lat){m_lat = lat; emit latChanged(lat);}}
-    void setLon(int lon) { if (m_lon!=lon){m_lon = lon; emit lonChanged(lon);}}
-    void setAlt(int alt) { if (m_alt!=alt){m_alt = alt; emit altChanged(alt);}}
-    void setLatHome(int lat) { if (m_latHome!=lat){m_latHome = lat; emit latHomeChanged(lat);}}
-    void setLonHome(int lon) { if (m_lonHome!=lon){m_lonHome = lon; emit lonHomeChanged(lon);}}
-    void setAltHome(int alt) { if (m_altHome!=alt){m_altHome = alt; emit altHomeChanged(alt);}}
-    void setEph(unsigned int eph) { if (m_eph!=eph){m_eph = eph; emit ephChanged(eph);}}
-    void setEpv(unsigned int epv) { if (m_epv!=epv){m_epv = epv; emit epvChanged(epv);}}
-    void setVel(unsigned int vel) { if (m_vel!=vel){m_vel = vel; emit velChanged(vel);}}
-    void setCog(unsigned int cog) { if (m_cog!=cog){m_cog = cog; emit cogChanged(cog);}}
-    void setFixType(unsigned int fixType) { if (m_fixType!=fixType){m_fixType = fixType; emit fixTypeChanged(fixType);}}
-    void setSatellitesVisible(unsigned int satellitesVisible) { if (m_satellitesVisible!=satellitesVisible){m_satellitesVisible = satellitesVisible; emit satellitesVisibleChanged(satellitesVisible);}}
+    void setTimeUsec(quint64 timeUsec) { if (m_timeUsec!=timeUsec){m_timeUsec = timeUsec; if (!defer(DirtyTimeUsec)) emit timeUsecChanged(timeUsec);}}
+    void setLat(int lat) { if (m_lat!=lat){m_lat = lat; if (!defer(DirtyLat)) emit latChanged(lat);}}
+    void setLon(int lon) { if (m_lon!=lon){m_lon = lon; if (!defer(DirtyLon)) emit lonChanged(lon);}}
+    void setAlt(int alt) { if (m_alt!=alt){m_alt = alt; if (!defer(DirtyAlt)) emit altChanged(alt);}}
+    void setLatHome(int lat) { if (m_latHome!=lat){m_latHome = lat; if (!defer(DirtyLatHome)) emit latHomeChanged(lat);}}
+    void setLonHome(int lon) { if (m_lonHome!=lon){m_lonHome = lon; if (!defer(DirtyLonHome)) emit lonHomeChanged(lon);}}
+    void setAltHome(int alt) { if (m_altHome!=alt){m_altHome = alt; if (!defer(DirtyAltHome)) emit altHomeChanged(alt);}}
+    void setEph(unsigned int eph) { if (m_eph!=eph){m_eph = eph; if (!defer(DirtyEph)) emit ephChanged(eph);}}
+    void setEpv(unsigned int epv) { if (m_epv!=epv){m_epv = epv; if (!defer(DirtyEpv)) emit epvChanged(epv);}}
+    void setVel(unsigned int vel) { if (m_vel!=vel){m_vel = vel; if (!defer(DirtyVel)) emit velChanged(vel);}}
+    void setCog(unsigned int cog) { if (m_cog!=cog){m_cog = cog; if (!defer(DirtyCog)) emit cogChanged(cog);}}
+    void setFixType(unsigned int fixType) { if (m_fixType!=fixType){m_fixType = fixType; if (!defer(DirtyFixType)) emit fixTypeChanged(fixType);}}
+    void setSatellitesVisible(unsigned int satellitesVisible) { if (m_satellitesVisible!=satellitesVisible){m_satellitesVisible = satellitesVisible; if (!defer(DirtySatellitesVisible)) emit satellitesVisibleChanged(satellitesVisible);}}
 
     unsigned int getTimeBootMs() { return m_timeBootMs; }
     int getRelativeAlt() { return m_relativeAlt; }
@@ -65,13 +66,13 @@ public:
     int getVz() { return m_vz; }
     unsigned int getHdg() { return m_hdg; }
     double getHomeHeading() { return m_homeHeading; }
-    void setTimeBootMs(unsigned int timeBootMs) { if (m_timeBootMs!=timeBootMs){m_timeBootMs = timeBootMs; emit timeBootMsChanged(timeBootMs);}}
-    void setRelativeAlt(int relativeAlt) { if (m_relativeAlt!=relativeAlt){m_relativeAlt = relativeAlt; emit relativeAltChanged(relativeAlt);}}
-    void setVx(int vx) { if (m_vx!=vx){m_vx = vx; emit vxChanged(vx);}}
-    void setVy(int vy) { if (m_vy!=vy){m_vy = vy; emit vyChanged(vy);}}
-    void setVz(int vz) { if (m_vz!=vz){m_vz = vz; emit vzChanged(vz);}}
-    void setHdg(unsigned int hdg) { if (m_hdg!=hdg){m_hdg = hdg; emit hdgChanged(hdg);}}
-    void setHomeHeading(double deg) { if (m_homeHeading != deg) {m_homeHeading = deg; emit homeHeadingChanged(deg);}}
+    void setTimeBootMs(unsigned int timeBootMs) { if (m_timeBootMs!=timeBootMs){m_timeBootMs = timeBootMs; if (!defer(DirtyTimeBootMs)) emit timeBootMsChanged(timeBootMs);}}
+    void setRelativeAlt(int relativeAlt) { if (m_relativeAlt!=relativeAlt){m_relativeAlt = relativeAlt; if (!defer(DirtyRelativeAlt)) emit relativeAltChanged(relativeAlt);}}
+    void setVx(int vx) { if (m_vx!=vx){m_vx = vx; if (!defer(DirtyVx)) emit vxChanged(vx);}}
+    void setVy(int vy) { if (m_vy!=vy){m_vy = vy; if (!defer(DirtyVy)) emit vyChanged(vy);}}
+    void setVz(int vz) { if (m_vz!=vz){m_vz = vz; if (!defer(DirtyVz)) emit vzChanged(vz);}}
+    void setHdg(unsigned int hdg) { if (m_hdg!=hdg){m_hdg = hdg; if (!defer(DirtyHdg)) emit hdgChanged(hdg);}}
+    void setHomeHeading(double deg) { if (m_homeHeading != deg) {m_homeHeading = deg; if (!defer(DirtyHomeHeading)) emit homeHeadingChanged(deg);}}
 
 private:
     quint64 m_timeUsec;
@@ -121,6 +122,50 @@ signals:
 
 public:
     explicit AbsPositionOverview(QObject *parent = 0);
+    ~AbsPositionOverview();
+
+    /** @brief Emit what changed since the last frame, see FramePacer */
+    void flushChanges();
+private:
+    enum DirtyProperty
+    {
+        DirtyTimeUsec = 1u << 0,
+        DirtyLat = 1u << 1,
+        DirtyLon = 1u << 2,
+        DirtyAlt = 1u << 3,
+        DirtyLatHome = 1u << 4,
+        DirtyLonHome = 1u << 5,
+        DirtyAltHome = 1u << 6,
+        DirtyEph = 1u << 7,
+        DirtyEpv = 1u << 8,
+        DirtyVel = 1u << 9,
+        DirtyCog = 1u << 10,
+        DirtyFixType = 1u << 11,
+        DirtySatellitesVisible = 1u << 12,
+        DirtyTimeBootMs = 1u << 13,
+        DirtyRelativeAlt = 1u << 14,
+        DirtyVx = 1u << 15,
+        DirtyVy = 1u << 16,
+        DirtyVz = 1u << 17,
+        DirtyHdg = 1u << 18,
+        DirtyHomeHeading = 1u << 19
+    };
+    /** @brief True when the NOTIFY for bit waits for the next frame */
+    bool defer(quint32 bit)
+    {
+        FramePacer *pacer = FramePacer::instance();
+        if (!pacer->pacing()) return false;
+        if (!m_dirty) pacer->schedule(this);
+        m_dirty |= bit;
+        return true;
+    }
+    quint32 m_dirty;
+
+public:
+    /** @brief AttitudeHistory::now() when the last GLOBAL_POSITION_INT arrived, -1 before the first */
+    qint64 positionReceivedMs() const { return m_positionReceivedMs; }
+private:
+    qint64 m_positionReceivedMs;
 
 signals:
 private:
@@ -0,0 +1,19 @@
+#include "ActiveVehicle.h"
+
+ActiveVehicle::ActiveVehicle(QObject *parent) :
+    QObject(parent),
+    m_uasId(-1)
+{
+}
+
+void ActiveVehicle::setSource(UASObject *source, int uasId, QObject *logDownload)
+{
+    if (m_source == source && m_uasId == uasId && m_logDownload == logDownload)
+    {
+        return;
+    }
+    m_source = source;
+    m_uasId = source ? uasId : -1;
+    m_logDownload = source ? logDownload : 0;
+    emit sourceChanged();
+}
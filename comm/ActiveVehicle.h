@@ -0,0 +1,55 @@
+#ifndef ACTIVEVEHICLE_H
+#define ACTIVEVEHICLE_H
+
+#include <QObject>
+#include <QPointer>
+#include "UASObject.h"
+
+/**
+ * @brief The vehicle on the HUD, for QML
+ *
+ * One context property for the whole session. Bindings read through it,
+ * e.g. activeVehicle.relPosition.roll, so a vehicle change is one
+ * sourceChanged() that re-evaluates the bindings reading through it,
+ * instead of replacing context properties and with them every binding of
+ * the tree. Until a vehicle is set the properties are blank overviews,
+ * never null; logDownload, which only a UAS has, is null then.
+ */
+class ActiveVehicle : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int uasId READ getUasId NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* vehicle READ getVehicle NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* relPosition READ getRelPosition NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* absPosition READ getAbsPosition NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* mission READ getMission NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* servosRc READ getServosRc NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* predictedAttitude READ getPredictedAttitude NOTIFY sourceChanged)
+    Q_PROPERTY(QObject* logDownload READ getLogDownload NOTIFY sourceChanged)
+public:
+    explicit ActiveVehicle(QObject *parent = 0);
+
+    /** @brief Show source, the overviews of uasId, and its LogDownload; 0 goes back to the blank ones */
+    void setSource(UASObject *source, int uasId, QObject *logDownload = 0);
+
+    /** @brief -1 while no vehicle is set */
+    int getUasId() const { return m_uasId; }
+    QObject *getVehicle() { return source()->getVehicleOverview(); }
+    QObject *getRelPosition() { return source()->getRelPositionOverview(); }
+    QObject *getAbsPosition() { return source()->getAbsPositionOverview(); }
+    QObject *getMission() { return source()->getMissionOverview(); }
+    QObject *getServosRc() { return source()->getServosRcOverview(); }
+    QObject *getPredictedAttitude() { return source()->getRelPositionOverview()->predictedAttitude(); }
+    QObject *getLogDownload() { return m_logDownload.data(); }
+signals:
+    void sourceChanged();
+private:
+    UASObject *source() { return m_source ? m_source.data() : &m_blank; }
+
+    QPointer<UASObject> m_source;
+    QPointer<QObject> m_logDownload;
+    int m_uasId;
+    UASObject m_blank;
+};
+
+#endif // ACTIVEVEHICLE_H
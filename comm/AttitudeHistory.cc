@@ -0,0 +1,117 @@
+#include "AttitudeHistory.h"
+
+// The lowest receive delay only ever decreases, let it creep back up this much per sample
+// (about 1 ms/s at 50 Hz) so clock drift between vehicle and ground does not accumulate
+static const double OffsetDriftMs = 0.02;
+
+QElapsedTimer AttitudeHistory::s_clock;
+
+AttitudeHistory::AttitudeHistory(int capacity) :
+    m_samples(qMax(2, capacity)),
+    m_next(0),
+    m_count(0),
+    m_bootOffset(0),
+    m_lastBootMs(0),
+    m_offsetValid(false)
+{
+    if (!s_clock.isValid()) s_clock.start();
+}
+
+qint64 AttitudeHistory::now()
+{
+    if (!s_clock.isValid()) s_clock.start();
+    return s_clock.elapsed();
+}
+
+void AttitudeHistory::append(quint32 bootMs, double roll, double pitch, double yaw)
+{
+    qint64 received = now();
+
+    // Vehicle rebooted
+    if (m_offsetValid && bootMs < m_lastBootMs) clear();
+    m_lastBootMs = bootMs;
+
+    double offset = double(received - bootMs);
+    if (!m_offsetValid || offset < m_bootOffset)
+    {
+        m_bootOffset = offset;
+        m_offsetValid = true;
+    }
+    else
+    {
+        m_bootOffset += OffsetDriftMs;
+    }
+
+    Sample &sample = m_samples[m_next];
+    sample.groundMs = bootMs + qint64(m_bootOffset);
+    sample.bootMs = bootMs;
+    sample.roll = roll;
+    sample.pitch = pitch;
+    sample.yaw = yaw;
+
+    m_next = (m_next + 1) % m_samples.size();
+    if (m_count < m_samples.size()) m_count++;
+}
+
+bool AttitudeHistory::sampleAt(qint64 groundMs, Sample & result) const
+{
+    if (m_count == 0) return false;
+
+    int size = m_samples.size();
+    int newest = (m_next - 1 + size) % size;
+    int oldest = (m_next - m_count + size) % size;
+
+    // Outside the history, hold the nearest end
+    if (groundMs >= m_samples[newest].groundMs)
+    {
+        result = m_samples[newest];
+        return true;
+    }
+    if (groundMs <= m_samples[oldest].groundMs)
+    {
+        result = m_samples[oldest];
+        return true;
+    }
+
+    // Newest first, the overlay asks for the recent past
+    for (int i = 1; i < m_count; i++)
+    {
+        const Sample &before = m_samples[(newest - i + size) % size];
+        if (before.groundMs <= groundMs)
+        {
+            const Sample &after = m_samples[(newest - i + 1 + size) % size];
+            qint64 span = after.groundMs - before.groundMs;
+            double t = span > 0 ? double(groundMs - before.groundMs) / span : 0.0;
+
+            result.groundMs = groundMs;
+            result.bootMs = before.bootMs + quint32(t * (after.bootMs - before.bootMs));
+            result.roll = interpolateAngle(before.roll, after.roll, t);
+            result.pitch = interpolateAngle(before.pitch, after.pitch, t);
+            result.yaw = interpolateAngle(before.yaw, after.yaw, t);
+            return true;
+        }
+    }
+
+    result = m_samples[oldest];
+    return true;
+}
+
+void AttitudeHistory::clear()
+{
+    m_next = 0;
+    m_count = 0;
+    m_offsetValid = false;
+}
+
+// Degrees, along the shorter way round
+double AttitudeHistory::interpolateAngle(double from, double to, double t)
+{
+    double delta = to - from;
+    while (delta > 180.0) delta -= 360.0;
+    while (delta < -180.0) delta += 360.0;
+
+    double result = from + delta * t;
+    if (result > 180.0) result -= 360.0;
+    if (result < -180.0) result += 360.0;
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef ATTITUDEHISTORY_H
+#define ATTITUDEHISTORY_H
+
+#include <QVector>
+#include <QElapsedTimer>
+
+/**
+ * @brief Time-aligned ring of recent attitude samples
+ *
+ * Samples are keyed by the vehicle's time_boot_ms and mapped onto the ground
+ * clock with the smallest receive delay seen, so link bursts do not smear the
+ * timeline. The video overlay asks for the attitude at the time the displayed
+ * frame was captured and gets it interpolated between the two nearest samples.
+ */
+class AttitudeHistory
+{
+public:
+    struct Sample
+    {
+        qint64 groundMs;    ///< Ground clock, see now()
+        quint32 bootMs;     ///< Vehicle time_boot_ms
+        double roll;
+        double pitch;
+        double yaw;
+    };
+
+    explicit AttitudeHistory(int capacity = 256);
+
+    /** @brief Monotonic ground clock in ms, shared by all histories */
+    static qint64 now();
+
+    void append(quint32 bootMs, double roll, double pitch, double yaw);
+    /** @brief Attitude at ground time groundMs, false while the history is empty */
+    bool sampleAt(qint64 groundMs, Sample & result) const;
+    void clear();
+
+private:
+    static double interpolateAngle(double from, double to, double t);
+
+    QVector<Sample> m_samples;
+    int m_next;
+    int m_count;
+    double m_bootOffset;    ///< ground ms - boot ms, lowest seen
+    quint32 m_lastBootMs;
+    bool m_offsetValid;
+
+    static QElapsedTimer s_clock;
+};
+
+#endif // ATTITUDEHISTORY_H
@@ -0,0 +1,71 @@
+#include "AttitudeMatrix.h"
+#include <cmath>
+
+const float AttitudeMatrix::HorizonPitchScale = 1.75f;
+
+AttitudeQuaternion AttitudeMatrix::fromEuler(float roll, float pitch, float yaw)
+{
+    AttitudeQuaternion attitude(Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ())
+                                * Eigen::AngleAxisf(pitch, Eigen::Vector3f::UnitY())
+                                * Eigen::AngleAxisf(roll, Eigen::Vector3f::UnitX()));
+    return attitude;
+}
+
+AttitudeQuaternion AttitudeMatrix::fromMavlink(float q1, float q2, float q3, float q4)
+{
+    AttitudeQuaternion attitude(q1, q2, q3, q4);
+    attitude.normalize();
+    return attitude;
+}
+
+void AttitudeMatrix::toEuler(const AttitudeQuaternion &attitude, float *roll, float *pitch, float *yaw)
+{
+    const Eigen::Matrix3f r = attitude.toRotationMatrix();
+    *pitch = std::asin(qBound(-1.0f, -r(2, 0), 1.0f));
+    if (std::fabs(r(2, 0)) > 0.999f)
+    {
+        // Looking straight up or down, roll and yaw are one axis; put it all in yaw
+        *roll = 0;
+        *yaw = std::atan2(-r(0, 1), r(1, 1));
+    }
+    else
+    {
+        *roll = std::atan2(r(2, 1), r(2, 2));
+        *yaw = std::atan2(r(1, 0), r(0, 0));
+    }
+}
+
+QMatrix4x4 AttitudeMatrix::rotation(const AttitudeQuaternion &attitude)
+{
+    const Eigen::Matrix3f r = attitude.toRotationMatrix();
+    return QMatrix4x4(r(0, 0), r(0, 1), r(0, 2), 0,
+                      r(1, 0), r(1, 1), r(1, 2), 0,
+                      r(2, 0), r(2, 1), r(2, 2), 0,
+                      0, 0, 0, 1);
+}
+
+QMatrix4x4 AttitudeMatrix::horizon(const AttitudeQuaternion &attitude, float pitchScale)
+{
+    const Eigen::Matrix3f r = attitude.toRotationMatrix();
+    // The body y and z axes' down components are cos(pitch) * (sin, cos)(roll)
+    float s = r(2, 1);
+    float c = r(2, 2);
+    const float norm = std::sqrt(s * s + c * c);
+    if (norm > 1e-4f)
+    {
+        s /= norm;
+        c /= norm;
+    }
+    else
+    {
+        // Vertical, the horizon has no tilt to show
+        s = 0;
+        c = 1;
+    }
+    const float offset = std::asin(qBound(-1.0f, -r(2, 0), 1.0f)) * 57.2957795f * pitchScale;
+    // Rotation by -roll after moving down by offset, in screen coordinates
+    return QMatrix4x4(c, s, 0, s * offset,
+                      -s, c, 0, c * offset,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1);
+}
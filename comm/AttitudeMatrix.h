@@ -0,0 +1,44 @@
+#ifndef ATTITUDEMATRIX_H
+#define ATTITUDEMATRIX_H
+
+#include <QMatrix4x4>
+#include "libs/eigen/Eigen/Geometry"
+
+/** @brief Unaligned, so it can be a member of objects made with plain new */
+typedef Eigen::Quaternion<float, Eigen::DontAlign> AttitudeQuaternion;
+
+/**
+ * @brief Attitude as a quaternion and the matrices the HUD draws with
+ *
+ * The HUD used to rebuild the horizon from roll and pitch in every binding.
+ * The overviews keep the attitude as a quaternion instead and hand QML
+ * finished matrices, computed once per sample: the full body to NED
+ * rotation for shaders, and the 2D transform of the artificial horizon.
+ * The horizon tilt comes from the rotation matrix itself, so it has no
+ * Euler angle discontinuities near +-90 degrees pitch.
+ */
+class AttitudeMatrix
+{
+public:
+    /** @brief Pixels per degree of pitch the horizon moves, as the QML instruments always did */
+    static const float HorizonPitchScale;
+
+    /** @brief Attitude of the MAVLink Euler angles, radians, yaw-pitch-roll order */
+    static AttitudeQuaternion fromEuler(float roll, float pitch, float yaw);
+    /** @brief ATTITUDE_QUATERNION order, w first */
+    static AttitudeQuaternion fromMavlink(float q1, float q2, float q3, float q4);
+    /** @brief Back to roll, pitch and yaw in radians, for the properties that are still angles */
+    static void toEuler(const AttitudeQuaternion &attitude, float *roll, float *pitch, float *yaw);
+
+    /** @brief Body to NED rotation in the upper left 3x3 */
+    static QMatrix4x4 rotation(const AttitudeQuaternion &attitude);
+    /**
+     * @brief Transform of the artificial horizon about its centre
+     *
+     * Rotates against the roll and moves down by pitchScale per degree of
+     * pitch; QML applies it between translations to and from the centre.
+     */
+    static QMatrix4x4 horizon(const AttitudeQuaternion &attitude, float pitchScale = HorizonPitchScale);
+};
+
+#endif // ATTITUDEMATRIX_H
@@ -0,0 +1,164 @@
+#include "AttitudePredictor.h"
+#include "AttitudeHistory.h"
+#include <qmath.h>
+
+static const int DefaultHorizonMs = 250;
+static const int DefaultCorrectionMs = 120;
+// A jump this large is a new situation (reconnect, reset), not prediction error
+static const double MaxCorrectionDeg = 30.0;
+// Past one and a half sample intervals the rates are more guess than data
+static const double HorizonIntervals = 1.5;
+
+AttitudePredictor::AttitudePredictor(QObject *parent) :
+    QObject(parent),
+    m_sampleMs(0),
+    m_intervalMs(0),
+    m_horizonMs(DefaultHorizonMs),
+    m_correctionMs(DefaultCorrectionMs),
+    m_hasSample(false),
+    m_scheduled(false)
+{
+    for (int i = 0; i < AxisCount; ++i)
+    {
+        m_base[i] = 0;
+        m_rate[i] = 0;
+        m_error[i] = 0;
+        m_value[i] = 0;
+    }
+}
+
+AttitudePredictor::~AttitudePredictor()
+{
+    FramePacer::instance()->cancel(this);
+}
+
+double AttitudePredictor::wrap(double degrees)
+{
+    while (degrees > 180.0) degrees -= 360.0;
+    while (degrees <= -180.0) degrees += 360.0;
+    return degrees;
+}
+
+void AttitudePredictor::addSample(double roll, double pitch, double yaw, double rollspeed, double pitchspeed, double yawspeed)
+{
+    const double measured[AxisCount] = { roll, pitch, yaw };
+    const double rate[AxisCount] = { rollspeed, pitchspeed, yawspeed };
+    qint64 now = AttitudeHistory::now();
+
+    double shown[AxisCount];
+    if (m_hasSample)
+    {
+        evaluate(now, shown);
+        double interval = now - m_sampleMs;
+        m_intervalMs = m_intervalMs == 0 ? interval : 0.8 * m_intervalMs + 0.2 * interval;
+    }
+    for (int i = 0; i < AxisCount; ++i)
+    {
+        double error = m_hasSample ? wrap(shown[i] - measured[i]) : 0;
+        m_error[i] = qAbs(error) > MaxCorrectionDeg ? 0 : error;
+        m_base[i] = measured[i];
+        m_rate[i] = rate[i];
+    }
+    m_sampleMs = now;
+    m_hasSample = true;
+
+    FramePacer *pacer = FramePacer::instance();
+    if (!pacer->pacing())
+    {
+        // No frames to extrapolate to
+        for (int i = 0; i < AxisCount; ++i)
+        {
+            m_error[i] = 0;
+        }
+        publish(measured);
+        return;
+    }
+    if (!m_scheduled)
+    {
+        m_scheduled = true;
+        pacer->schedule(this);
+    }
+}
+
+void AttitudePredictor::reset()
+{
+    m_hasSample = false;
+    m_intervalMs = 0;
+    for (int i = 0; i < AxisCount; ++i)
+    {
+        m_rate[i] = 0;
+        m_error[i] = 0;
+    }
+}
+
+bool AttitudePredictor::evaluate(qint64 now, double *value) const
+{
+    double elapsed = qMax(Q_INT64_C(0), now - m_sampleMs);
+    double horizon = m_horizonMs;
+    if (m_intervalMs > 0)
+    {
+        horizon = qMin(horizon, HorizonIntervals * m_intervalMs);
+    }
+    double seconds = qMin(elapsed, horizon) / 1000.0;
+    double decay = m_correctionMs > 0 ? qExp(-elapsed / m_correctionMs) : 0;
+    for (int i = 0; i < AxisCount; ++i)
+    {
+        double angle = m_base[i] + m_rate[i] * seconds + m_error[i] * decay;
+        value[i] = i == Pitch ? qBound(-90.0, angle, 90.0) : wrap(angle);
+    }
+    return elapsed < horizon || decay > 0.01;
+}
+
+void AttitudePredictor::flushChanges()
+{
+    m_scheduled = false;
+    if (!m_hasSample)
+    {
+        return;
+    }
+    double value[AxisCount];
+    bool moving = evaluate(AttitudeHistory::now(), value);
+    publish(value);
+    FramePacer *pacer = FramePacer::instance();
+    if (moving && pacer->pacing())
+    {
+        // Ask for the next frame too, until the horizon is reached
+        m_scheduled = true;
+        pacer->schedule(this);
+    }
+}
+
+void AttitudePredictor::publish(const double *value)
+{
+    if (value[Roll] == m_value[Roll] && value[Pitch] == m_value[Pitch] && value[Yaw] == m_value[Yaw])
+    {
+        return;
+    }
+    for (int i = 0; i < AxisCount; ++i)
+    {
+        m_value[i] = value[i];
+    }
+    emit attitudeChanged();
+}
+
+void AttitudePredictor::setHorizonMs(int ms)
+{
+    ms = qMax(0, ms);
+    if (ms == m_horizonMs)
+    {
+        return;
+    }
+    m_horizonMs = ms;
+    emit horizonMsChanged(ms);
+}
+
+void AttitudePredictor::setCorrectionMs(int ms)
+{
+    ms = qMax(0, ms);
+    if (ms == m_correctionMs)
+    {
+        return;
+    }
+    m_correctionMs = ms;
+    emit correctionMsChanged(ms);
+}
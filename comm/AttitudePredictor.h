@@ -0,0 +1,74 @@
+#ifndef ATTITUDEPREDICTOR_H
+#define ATTITUDEPREDICTOR_H
+
+#include <QObject>
+#include "FramePacer.h"
+
+/**
+ * @brief Attitude extrapolated to every rendered frame
+ *
+ * A long range radio may carry ATTITUDE at only 4-10 Hz, which makes the
+ * horizon step. Between samples the attitude is advanced with the body rates
+ * of the last sample, for at most horizonMs. When the next sample arrives the
+ * difference between what was shown and what was measured is not jumped but
+ * decays over correctionMs.
+ *
+ * roll, pitch and yaw are in degrees like RelPositionOverview, so QML can
+ * bind to either. Without a FramePacer window the samples pass straight
+ * through.
+ */
+class AttitudePredictor : public QObject, public FramePaced
+{
+    Q_OBJECT
+    Q_PROPERTY(double roll READ getRoll NOTIFY attitudeChanged)
+    Q_PROPERTY(double pitch READ getPitch NOTIFY attitudeChanged)
+    Q_PROPERTY(double yaw READ getYaw NOTIFY attitudeChanged)
+    Q_PROPERTY(int horizonMs READ horizonMs WRITE setHorizonMs NOTIFY horizonMsChanged)
+    Q_PROPERTY(int correctionMs READ correctionMs WRITE setCorrectionMs NOTIFY correctionMsChanged)
+public:
+    explicit AttitudePredictor(QObject *parent = 0);
+    ~AttitudePredictor();
+
+    /** @brief One ATTITUDE, angles in degrees (roll, yaw +-180) and rates in degrees per second */
+    void addSample(double roll, double pitch, double yaw, double rollspeed, double pitchspeed, double yawspeed);
+    /** @brief Forget the motion, e.g. when another vehicle becomes active */
+    void reset();
+
+    double getRoll() const { return m_value[Roll]; }
+    double getPitch() const { return m_value[Pitch]; }
+    double getYaw() const { return m_value[Yaw]; }
+
+    int horizonMs() const { return m_horizonMs; }
+    void setHorizonMs(int ms);
+    int correctionMs() const { return m_correctionMs; }
+    void setCorrectionMs(int ms);
+
+    /** @brief Advance to the frame being prepared */
+    void flushChanges();
+
+signals:
+    void attitudeChanged();
+    void horizonMsChanged(int ms);
+    void correctionMsChanged(int ms);
+
+private:
+    enum Axis { Roll, Pitch, Yaw, AxisCount };
+
+    /** @brief Attitude at ground time now into value, true while it still moves */
+    bool evaluate(qint64 now, double *value) const;
+    void publish(const double *value);
+    static double wrap(double degrees);
+
+    double m_base[AxisCount];       ///< Last sample
+    double m_rate[AxisCount];
+    double m_error[AxisCount];      ///< Shown minus measured when the sample arrived
+    double m_value[AxisCount];      ///< What the properties report
+    qint64 m_sampleMs;              ///< AttitudeHistory::now() of the last sample
+    double m_intervalMs;            ///< Smoothed time between samples, 0 until two arrived
+    int m_horizonMs;
+    int m_correctionMs;
+    bool m_hasSample;
+    bool m_scheduled;
+};
+
+#endif // ATTITUDEPREDICTOR_H
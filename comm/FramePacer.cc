@@ -0,0 +1,252 @@
+#include "FramePacer.h"
+#include "TraceMarkers.h"
+#include <QMetaObject>
+
+FramePacer *FramePacer::instance()
+{
+    static FramePacer* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new FramePacer();
+    }
+    return _instance;
+}
+
+FramePacer::FramePacer(QObject *parent) :
+    QObject(parent),
+    m_everySample(false),
+    m_updateRequested(false),
+    m_powerSave(false),
+    m_targetFps(20),
+    m_lastFrame(-1),
+    m_syncStart(0),
+    m_renderEnd(0),
+    m_frames(0),
+    m_renderUs(0),
+    m_swapUs(0),
+    m_lastSwap(-1),
+    m_fps(0),
+    m_renderMs(0),
+    m_swapMs(0)
+{
+    for (int i = 0; i < IntervalBuckets; ++i)
+    {
+        m_intervals[i].store(0);
+    }
+    m_frameMs[0] = m_frameMs[1] = m_frameMs[2] = 0;
+    m_clock.start();
+    m_renderClock.start();
+    m_capTimer.setSingleShot(true);
+    connect(&m_capTimer, SIGNAL(timeout()), this, SLOT(requestUpdate()));
+    connect(&m_statsTimer, SIGNAL(timeout()), this, SLOT(publishFrameStats()));
+}
+
+void FramePacer::attach(QObject *window)
+{
+    if (m_window)
+    {
+        disconnect(m_window, 0, this, 0);
+    }
+    flush();
+    m_window = window;
+    m_statsTimer.stop();
+    if (!m_window)
+    {
+        return;
+    }
+    // afterAnimating is emitted on the GUI thread right before the scene is synchronized,
+    // beforeSynchronizing itself comes from the render thread with the GUI thread blocked
+#if QT_VERSION >= 0x050300
+    connect(m_window, SIGNAL(afterAnimating()), this, SLOT(flush()));
+#else
+    connect(m_window, SIGNAL(beforeSynchronizing()), this, SLOT(flush()), Qt::QueuedConnection);
+#endif
+    // Nothing rendered, nothing flushed
+    connect(m_window, SIGNAL(visibleChanged(bool)), this, SLOT(flush()));
+
+    connect(m_window, SIGNAL(beforeSynchronizing()), this, SLOT(beforeSynchronizing()), Qt::DirectConnection);
+    connect(m_window, SIGNAL(afterRendering()), this, SLOT(afterRendering()), Qt::DirectConnection);
+#if defined(HUD_TRACE) && QT_VERSION >= 0x050300
+    // Splits the frame's slice into the synchronization and the rendering
+    connect(m_window, SIGNAL(afterSynchronizing()), this, SLOT(afterSynchronizing()), Qt::DirectConnection);
+#endif
+    connect(m_window, SIGNAL(frameSwapped()), this, SLOT(frameSwapped()), Qt::DirectConnection);
+    m_statsClock.start();
+    m_statsTimer.start(1000);
+}
+
+void FramePacer::schedule(FramePaced *object)
+{
+    if (!pacing())
+    {
+        object->flushChanges();
+        return;
+    }
+    m_pending.append(object);
+    // A static scene renders no frames, ask for one
+    requestFrame();
+}
+
+void FramePacer::requestFrame()
+{
+    if (m_updateRequested)
+    {
+        return;
+    }
+    m_updateRequested = true;
+    qint64 wait = 0;
+    if (m_powerSave && m_targetFps > 0 && m_lastFrame >= 0)
+    {
+        wait = m_lastFrame + 1000 / m_targetFps - m_clock.elapsed();
+    }
+    if (wait > 0)
+    {
+        m_capTimer.start(static_cast<int>(wait));
+        return;
+    }
+    requestUpdate();
+}
+
+void FramePacer::requestUpdate()
+{
+    if (m_window)
+    {
+        QMetaObject::invokeMethod(m_window, "update");
+    }
+}
+
+void FramePacer::cancel(FramePaced *object)
+{
+    m_pending.removeAll(object);
+    // Deleted by a binding during flush()
+    int index = m_flushing.indexOf(object);
+    if (index >= 0)
+    {
+        m_flushing[index] = 0;
+    }
+}
+
+void FramePacer::flush()
+{
+    HUD_TRACE_SCOPE("FramePacer::flush");
+    m_updateRequested = false;
+    m_capTimer.stop();
+    m_lastFrame = m_clock.elapsed();
+    if (m_pending.isEmpty())
+    {
+        return;
+    }
+    // Bindings may set paced properties again, those go to the next frame
+    m_flushing.swap(m_pending);
+    for (int i = 0; i < m_flushing.size(); ++i)
+    {
+        if (m_flushing[i])
+        {
+            m_flushing[i]->flushChanges();
+        }
+    }
+    m_flushing.clear();
+}
+
+void FramePacer::setEverySample(bool everySample)
+{
+    if (m_everySample == everySample)
+    {
+        return;
+    }
+    m_everySample = everySample;
+    flush();
+    emit everySampleChanged(everySample);
+}
+
+void FramePacer::setPowerSave(bool powerSave)
+{
+    if (m_powerSave == powerSave)
+    {
+        return;
+    }
+    m_powerSave = powerSave;
+    if (!powerSave && m_capTimer.isActive())
+    {
+        // The held back frame is due now
+        m_capTimer.stop();
+        requestUpdate();
+    }
+    emit powerSaveChanged(powerSave);
+}
+
+void FramePacer::setTargetFps(int fps)
+{
+    fps = qMax(1, fps);
+    if (m_targetFps == fps)
+    {
+        return;
+    }
+    m_targetFps = fps;
+    emit targetFpsChanged(fps);
+}
+
+void FramePacer::beforeSynchronizing()
+{
+    HUD_TRACE_BEGIN("scene graph sync");
+    m_syncStart = m_renderClock.nsecsElapsed() / 1000;
+}
+
+void FramePacer::afterSynchronizing()
+{
+    HUD_TRACE_END();
+    HUD_TRACE_BEGIN("scene graph render");
+}
+
+void FramePacer::afterRendering()
+{
+    HUD_TRACE_END();
+    m_renderEnd = m_renderClock.nsecsElapsed() / 1000;
+    m_renderUs.fetchAndAddRelaxed(static_cast<int>(m_renderEnd - m_syncStart));
+}
+
+void FramePacer::frameSwapped()
+{
+    qint64 now = m_renderClock.nsecsElapsed() / 1000;
+    m_swapUs.fetchAndAddRelaxed(static_cast<int>(now - m_renderEnd));
+    if (m_lastSwap >= 0)
+    {
+        qint64 interval = (now - m_lastSwap) / 1000;
+        m_intervals[qMin(interval, static_cast<qint64>(IntervalBuckets - 1))].fetchAndAddRelaxed(1);
+    }
+    m_lastSwap = now;
+    m_frames.fetchAndAddRelease(1);
+}
+
+void FramePacer::publishFrameStats()
+{
+    qint64 elapsed = m_statsClock.restart();
+    int frames = m_frames.fetchAndStoreAcquire(0);
+    int renderUs = m_renderUs.fetchAndStoreRelaxed(0);
+    int swapUs = m_swapUs.fetchAndStoreRelaxed(0);
+    m_fps = elapsed > 0 ? frames * 1000.0 / elapsed : 0;
+    m_renderMs = frames > 0 ? renderUs / 1000.0 / frames : 0;
+    m_swapMs = frames > 0 ? swapUs / 1000.0 / frames : 0;
+
+    int counts[IntervalBuckets];
+    int total = 0;
+    for (int i = 0; i < IntervalBuckets; ++i)
+    {
+        counts[i] = m_intervals[i].fetchAndStoreRelaxed(0);
+        total += counts[i];
+    }
+    static const int percentiles[3] = { 50, 95, 99 };
+    for (int p = 0; p < 3; ++p)
+    {
+        // First bucket that brings the count up to the percentile
+        int rank = (total * percentiles[p] + 99) / 100;
+        int seen = 0;
+        int bucket = 0;
+        while (bucket < IntervalBuckets - 1 && seen + counts[bucket] < rank)
+        {
+            seen += counts[bucket++];
+        }
+        m_frameMs[p] = total > 0 ? bucket : 0;
+    }
+    emit frameStatsChanged();
+}
@@ -0,0 +1,139 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+/** @brief Object whose property notifications the FramePacer holds back until the next frame */
+class FramePaced
+{
+public:
+    virtual ~FramePaced() { }
+    /** @brief Emit the NOTIFY signals of every property changed since the last call */
+    virtual void flushChanges() = 0;
+};
+
+/**
+ * @brief Coalesces vehicle state notifications to one batch per rendered frame
+ *
+ * ATTITUDE at 50 Hz and the position messages notify every binding several
+ * times between two frames. Paced objects store the latest value, mark the
+ * property dirty and schedule() themselves; when the window is about to hand
+ * the scene to the renderer the pacer asks each of them to emit once.
+ *
+ * everySample turns pacing off, for plots that need every value.
+ *
+ * powerSave caps the frames the pacer asks for to targetFps: a change that
+ * comes sooner after the previous frame waits for the rest of the interval,
+ * and all changes of that interval share one frame. Video frames are capped
+ * by the players themselves (GStreamerPlayer::maxFps). Every second the
+ * time the render thread spent per frame is published, split into
+ * synchronizing plus rendering and waiting in the buffer swap, which is
+ * where the GPU catching up shows, along with percentiles of the time
+ * between two swapped frames.
+ */
+class FramePacer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool everySample READ everySample WRITE setEverySample NOTIFY everySampleChanged)
+    Q_PROPERTY(bool powerSave READ powerSave WRITE setPowerSave NOTIFY powerSaveChanged)
+    Q_PROPERTY(int targetFps READ targetFps WRITE setTargetFps NOTIFY targetFpsChanged)
+    Q_PROPERTY(double fps READ fps NOTIFY frameStatsChanged)
+    Q_PROPERTY(double renderMs READ renderMs NOTIFY frameStatsChanged)
+    Q_PROPERTY(double swapMs READ swapMs NOTIFY frameStatsChanged)
+    Q_PROPERTY(int frameMs50 READ frameMs50 NOTIFY frameStatsChanged)
+    Q_PROPERTY(int frameMs95 READ frameMs95 NOTIFY frameStatsChanged)
+    Q_PROPERTY(int frameMs99 READ frameMs99 NOTIFY frameStatsChanged)
+public:
+    static FramePacer *instance();
+
+    /** @brief Pace to the frames of window, a QQuickWindow, NULL to emit every change immediately */
+    void attach(QObject *window);
+
+    /** @brief True when setters should defer their NOTIFY to the next frame */
+    bool pacing() const { return m_window && !m_everySample; }
+    /** @brief Queue object for the next frame, once per frame */
+    void schedule(FramePaced *object);
+    /** @brief Forget object, e.g. from its destructor */
+    void cancel(FramePaced *object);
+
+    bool everySample() const { return m_everySample; }
+    void setEverySample(bool everySample);
+
+    bool powerSave() const { return m_powerSave; }
+    void setPowerSave(bool powerSave);
+    /** @brief Frames per second in powerSave, also what the video should be capped to */
+    int targetFps() const { return m_targetFps; }
+    void setTargetFps(int fps);
+
+    /** @brief Frames rendered per second, over the last second */
+    double fps() const { return m_fps; }
+    /** @brief Average render thread time from synchronizing to the end of rendering */
+    double renderMs() const { return m_renderMs; }
+    /** @brief Average time spent in the buffer swap */
+    double swapMs() const { return m_swapMs; }
+    /** @brief Percentiles of the swap to swap interval over the last second, whole ms */
+    int frameMs50() const { return m_frameMs[0]; }
+    int frameMs95() const { return m_frameMs[1]; }
+    int frameMs99() const { return m_frameMs[2]; }
+
+public slots:
+    void flush();
+
+signals:
+    void everySampleChanged(bool everySample);
+    void powerSaveChanged(bool powerSave);
+    void targetFpsChanged(int fps);
+    void frameStatsChanged();
+
+private slots:
+    void requestUpdate();
+    void publishFrameStats();
+    // Render thread
+    void beforeSynchronizing();
+    void afterSynchronizing();
+    void afterRendering();
+    void frameSwapped();
+
+private:
+    enum {
+        IntervalBuckets = 100       ///< 1 ms each, the last one counts everything longer
+    };
+
+    explicit FramePacer(QObject *parent = 0);
+    /** @brief Ask the window for a frame, no sooner than the power save interval allows */
+    void requestFrame();
+
+    QPointer<QObject> m_window;
+    QVector<FramePaced*> m_pending;
+    QVector<FramePaced*> m_flushing;
+    bool m_everySample;
+    bool m_updateRequested;
+    bool m_powerSave;
+    int m_targetFps;
+    QTimer m_capTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastFrame;             ///< m_clock time of the last flush(), -1 before the first
+
+    // Written by the render thread, collected once a second
+    QElapsedTimer m_renderClock;
+    qint64 m_syncStart;
+    qint64 m_renderEnd;
+    QAtomicInt m_frames;
+    QAtomicInt m_renderUs;
+    QAtomicInt m_swapUs;
+    qint64 m_lastSwap;              ///< -1 before the first
+    QAtomicInt m_intervals[IntervalBuckets];
+    QTimer m_statsTimer;
+    QElapsedTimer m_statsClock;
+    double m_fps;
+    double m_renderMs;
+    double m_swapMs;
+    int m_frameMs[3];
+};
+
+#endif // FRAMEPACER_H
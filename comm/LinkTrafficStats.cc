@@ -0,0 +1,123 @@
+#include "LinkTrafficStats.h"
+
+LinkTrafficStats::LinkTrafficStats() :
+    m_sequence(0),
+    m_totalBytes(0),
+    m_totalPackets(0)
+{
+    for (int i = 0; i < Buckets; ++i)
+    {
+        m_buckets[i].second.store(-1);
+        m_buckets[i].bytes.store(0);
+        m_buckets[i].packets.store(0);
+    }
+}
+
+void LinkTrafficStats::add(quint32 bytes, quint32 packets, qint64 nowMs)
+{
+    int second = static_cast<int>(nowMs / BucketMs);
+    Bucket &bucket = m_buckets[second % Buckets];
+    if (bucket.second.loadAcquire() != second)
+    {
+        // Recycle the bucket of Buckets seconds ago; readers tell by the tag
+        bucket.second.storeRelease(-1);
+        bucket.bytes.storeRelease(0);
+        bucket.packets.storeRelease(0);
+        bucket.second.storeRelease(second);
+    }
+    bucket.bytes.fetchAndAddRelease(static_cast<int>(bytes));
+    bucket.packets.fetchAndAddRelease(static_cast<int>(packets));
+
+    m_sequence.fetchAndAddAcquire(1);
+    m_totalBytes += bytes;
+    m_totalPackets += packets;
+    m_sequence.fetchAndAddRelease(1);
+}
+
+void LinkTrafficStats::readTotals(quint64 *bytes, quint64 *packets) const
+{
+    forever
+    {
+        int before = m_sequence.loadAcquire();
+        if (before & 1)
+        {
+            // Mid write, the writer only needs a few instructions
+            continue;
+        }
+        *bytes = m_totalBytes;
+        *packets = m_totalPackets;
+        if (m_sequence.loadAcquire() == before)
+        {
+            return;
+        }
+    }
+}
+
+quint64 LinkTrafficStats::totalBytes() const
+{
+    quint64 bytes, packets;
+    readTotals(&bytes, &packets);
+    return bytes;
+}
+
+quint64 LinkTrafficStats::totalPackets() const
+{
+    quint64 bytes, packets;
+    readTotals(&bytes, &packets);
+    return packets;
+}
+
+bool LinkTrafficStats::read(int second, quint32 *bytes) const
+{
+    const Bucket &bucket = m_buckets[second % Buckets];
+    if (bucket.second.loadAcquire() != second)
+    {
+        return false;
+    }
+    quint32 value = static_cast<quint32>(bucket.bytes.loadAcquire());
+    if (bucket.second.loadAcquire() != second)
+    {
+        // Recycled while we read it
+        return false;
+    }
+    *bytes = value;
+    return true;
+}
+
+qint64 LinkTrafficStats::rate(qint64 nowMs, int windowMs) const
+{
+    int now = static_cast<int>(nowMs / BucketMs);
+    // Whole seconds before the running one, plus the part of it that passed
+    int seconds = qBound(0, (windowMs + BucketMs - 1) / BucketMs, Buckets - 1);
+    qint64 elapsed = nowMs % BucketMs + static_cast<qint64>(seconds) * BucketMs;
+    if (elapsed <= 0)
+    {
+        return 0;
+    }
+    quint64 total = 0;
+    for (int second = now - seconds; second <= now; ++second)
+    {
+        quint32 bytes;
+        if (read(second, &bytes))
+        {
+            total += bytes;
+        }
+    }
+    return static_cast<qint64>(total * 8 * 1000 / elapsed);
+}
+
+QVector<quint32> LinkTrafficStats::history(qint64 nowMs, int seconds) const
+{
+    seconds = qBound(0, seconds, static_cast<int>(Buckets));
+    int now = static_cast<int>(nowMs / BucketMs);
+    QVector<quint32> result(seconds, 0);
+    for (int i = 0; i < seconds; ++i)
+    {
+        quint32 bytes;
+        if (read(now - seconds + 1 + i, &bytes))
+        {
+            result[i] = bytes;
+        }
+    }
+    return result;
+}
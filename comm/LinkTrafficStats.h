@@ -0,0 +1,54 @@
+#ifndef LINKTRAFFICSTATS_H
+#define LINKTRAFFICSTATS_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+/**
+ * @brief Byte and packet counters of one direction of a link
+ *
+ * The link's I/O thread adds to it without locking: a running total and a
+ * ring of one second buckets covering the last five minutes. Readers on any
+ * thread never block the writer; a bucket the writer recycles while it is
+ * being read is skipped, the totals are read under a sequence counter.
+ *
+ * One writer per instance.
+ */
+class LinkTrafficStats
+{
+public:
+    enum {
+        BucketMs = 1000,
+        Buckets = 300
+    };
+
+    LinkTrafficStats();
+
+    /** @brief Count a read or write, nowMs from GroundClock::msecs() */
+    void add(quint32 bytes, quint32 packets, qint64 nowMs);
+
+    quint64 totalBytes() const;
+    quint64 totalPackets() const;
+    /** @brief Bits per second over the last windowMs, the running second included */
+    qint64 rate(qint64 nowMs, int windowMs = BucketMs) const;
+    /** @brief Bytes of each of the last seconds seconds, oldest first, the running one last */
+    QVector<quint32> history(qint64 nowMs, int seconds) const;
+
+private:
+    struct Bucket
+    {
+        QAtomicInt second;          ///< Which second the counts belong to
+        QAtomicInt bytes;
+        QAtomicInt packets;
+    };
+    /** @brief Bytes of bucket second, false if it holds another second */
+    bool read(int second, quint32 *bytes) const;
+    void readTotals(quint64 *bytes, quint64 *packets) const;
+
+    Bucket m_buckets[Buckets];
+    QAtomicInt m_sequence;          ///< Odd while the totals are written
+    quint64 m_totalBytes;
+    quint64 m_totalPackets;
+};
+
+#endif // LINKTRAFFICSTATS_H
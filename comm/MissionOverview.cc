@@ -0,0 +1,38 @@
+#include "MissionOverview.h"
+
+MissionOverview::MissionOverview(QObject *parent) :
+    QObject(parent),
+    m_count(-1),
+    m_current(-1),
+    m_reached(-1)
+{
+}
+
+//MISSION_COUNT
+//MISSION_CURRENT
+//MISSION_ITEM_REACHED
+void MissionOverview::messageReceived(LinkInterface* link,mavlink_message_t message)
+{
+    Q_UNUSED(link);
+    switch (message.msgid)
+    {
+        case MAVLINK_MSG_ID_MISSION_COUNT:
+        {
+            int count = mavlink_msg_mission_count_get_count(&message);
+            if (m_count != count) { m_count = count; emit countChanged(count); }
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_CURRENT:
+        {
+            int current = mavlink_msg_mission_current_get_seq(&message);
+            if (m_current != current) { m_current = current; emit currentChanged(current); }
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_ITEM_REACHED:
+        {
+            int reached = mavlink_msg_mission_item_reached_get_seq(&message);
+            if (m_reached != reached) { m_reached = reached; emit reachedChanged(reached); }
+            break;
+        }
+    }
+}
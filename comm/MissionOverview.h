@@ -0,0 +1,41 @@
+#ifndef MISSIONOVERVIEW_H
+#define MISSIONOVERVIEW_H
+
+#include <QObject>
+#include "mavlink.h"
+#include "LinkInterface.h"
+
+/**
+ * @brief Mission progress of one vehicle, for QML
+ *
+ * Only the summary messages; the items themselves are up- and downloaded
+ * by MissionSync.
+ */
+class MissionOverview : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ getCount NOTIFY countChanged)
+    Q_PROPERTY(int current READ getCurrent NOTIFY currentChanged)
+    Q_PROPERTY(int reached READ getReached NOTIFY reachedChanged)
+public:
+    explicit MissionOverview(QObject *parent = 0);
+
+    /** @brief Items in the vehicle's mission, -1 until a MISSION_COUNT arrived */
+    int getCount() const { return m_count; }
+    /** @brief Item the vehicle flies to, -1 before the first MISSION_CURRENT */
+    int getCurrent() const { return m_current; }
+    /** @brief Last item reached, -1 if none yet */
+    int getReached() const { return m_reached; }
+signals:
+    void countChanged(int);
+    void currentChanged(int);
+    void reachedChanged(int);
+public slots:
+    void messageReceived(LinkInterface* link,mavlink_message_t message);
+private:
+    int m_count;
+    int m_current;
+    int m_reached;
+};
+
+#endif // MISSIONOVERVIEW_H
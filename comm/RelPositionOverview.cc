@@ -1,7 +1,9 @@
 #include "RelPositionOverview.h"
+#include "MAVLinkLatencyTracer.h"
 
 RelPositionOverview::RelPositionOverview(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_dirty(0)
 {
     m_airspeed = 0;
     m_groundspeed = 0;
@@ -16,16 +18,55 @@ RelPositionOverview::RelPositionOverview(QObject *parent) :
     m_rollspeed = 0;
     m_pitchspeed = 0;
     m_yawspeed = 0;
+    m_attitudeReceivedMs = -1;
+    m_attitude = AttitudeQuaternion::Identity();
+}
+
+RelPositionOverview::~RelPositionOverview()
+{
+    FramePacer::instance()->cancel(this);
+}
+
+void RelPositionOverview::flushChanges()
+{
+    quint32 dirty = m_dirty;
+    m_dirty = 0;
+    if (dirty & DirtyAirspeed) emit airspeedChanged(m_airspeed);
+    if (dirty & DirtyGroundspeed) emit groundspeedChanged(m_groundspeed);
+    if (dirty & DirtyAlt) emit altChanged(m_alt);
+    if (dirty & DirtyClimb) emit climbChanged(m_climb);
+    if (dirty & DirtyHeading) emit headingChanged(m_heading);
+    if (dirty & DirtyThrottle) emit throttleChanged(m_throttle);
+    if (dirty & DirtyTimeBootMs) emit timeBootMsChanged(m_timeBootMs);
+    if (dirty & DirtyRoll) emit rollChanged(m_roll);
+    if (dirty & DirtyPitch) emit pitchChanged(m_pitch);
+    if (dirty & DirtyYaw) emit yawChanged(m_yaw);
+    if (dirty & DirtyRollspeed) emit rollspeedChanged(m_rollspeed);
+    if (dirty & DirtyPitchspeed) emit pitchspeedChanged(m_pitchspeed);
+    if (dirty & DirtyYawspeed) emit yawspeedChanged(m_yawspeed);
+    if (dirty & DirtyAttitudeMatrix) emit attitudeMatrixChanged();
 }
 
 void RelPositionOverview::parseAttitude(LinkInterface *link, const mavlink_message_t &message, const mavlink_attitude_t &state)
 {
     Q_UNUSED(link);
-    Q_UNUSED(message);
 
+    m_attitudeReceivedMs = AttitudeHistory::now();
+    this->setTimeBootMs(state.time_boot_ms);
     this->setRoll(ToDeg(state.roll));
     this->setPitch(ToDeg(state.pitch));
     this->setYaw(ToDeg(state.yaw));
+    this->setRollspeed(ToDeg(state.rollspeed));
+    this->setPitchspeed(ToDeg(state.pitchspeed));
+    this->setYawspeed(ToDeg(state.yawspeed));
+    m_attitude = AttitudeMatrix::fromEuler(state.roll, state.pitch, state.yaw);
+    m_rotation = AttitudeMatrix::rotation(m_attitude);
+    m_horizon = AttitudeMatrix::horizon(m_attitude);
+    if (!defer(DirtyAttitudeMatrix)) emit attitudeMatrixChanged();
+    m_attitudeHistory.append(state.time_boot_ms, m_roll, m_pitch, m_yaw);
+    m_predictedAttitude.addSample(m_roll, m_pitch, m_yaw, m_rollspeed, m_pitchspeed, m_yawspeed);
+    MAVLinkLatencyTracer *tracer = MAVLinkLatencyTracer::instance();
+    if (tracer->traces(message)) tracer->reached(message, MAVLinkLatencyTracer::StageProperty);
 }
 void RelPositionOverview::parseVfrHud(LinkInterface *link, const mavlink_message_t &message, const mavlink_vfr_hud_t &state)
 {
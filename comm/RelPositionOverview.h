@@ -4,11 +4,15 @@
 #include <QObject>
 #include "mavlink.h"
 #include "LinkInterface.h"
+#include "FramePacer.h"
+#include "AttitudeHistory.h"
+#include "AttitudePredictor.h"
+#include "AttitudeMatrix.h"
 
 #define ToRad(x) (x*0.01745329252)      // *pi/180
 #define ToDeg(x) (x*57.2957795131)      // *180/pi
 
-class RelPositionOverview : public QObject
+class RelPositionOverview : public QObject, public FramePaced
 {
     Q_OBJECT
 public:
@@ -16,6 +20,9 @@ public:
     Q_PROPERTY(double roll READ getRoll WRITE setRoll NOTIFY rollChanged)
     Q_PROPERTY(double pitch READ getPitch WRITE setPitch NOTIFY pitchChanged)
     Q_PROPERTY(double yaw READ getYaw WRITE setYaw NOTIFY yawChanged)
+    /** @brief Body to NED rotation and artificial horizon transform, see AttitudeMatrix */
+    Q_PROPERTY(QMatrix4x4 rotation READ getRotation NOTIFY attitudeMatrixChanged)
+    Q_PROPERTY(QMatrix4x4 horizon READ getHorizon NOTIFY attitudeMatrixChanged)
     Q_PROPERTY(double rollspeed READ getRollspeed WRITE setRollspeed NOTIFY rollspeedChanged)
     Q_PROPERTY(double pitchspeed READ getPitchspeed WRITE setPitchspeed NOTIFY pitchspeedChanged)
     //vfr_hud
@@ -34,12 +41,12 @@ public:
     double getClimb() { return m_climb; }
     int getHeading() { return m_heading; }
     unsigned int getThrottle() { return m_throttle; }
-    void setAirspeed(double airspeed) { if (m_airspeed!=airspeed){m_airspeed = airspeed; emit airspeedChanged(airspeed);}}
-    void setGroundspeed(double groundspeed) { if (m_groundspeed!=groundspeed){m_groundspeed = groundspeed; emit groundspeedChanged(groundspeed);}}
-    void setAlt(double alt) { if (m_alt!=alt){m_alt = alt; emit altChanged(alt);}}
-    void setClimb(double climb) { if (m_climb!=climb){m_climb = climb; emit climbChanged(climb);}}
-    void setHeading(int heading) { if (m_heading!=heading){m_heading = heading; emit headingChanged(heading);}}
-    void setThrottle(unsigned int throttle) { if (m_throttle!=throttle){m_throttle = throttle; emit throttleChanged(throttle);}}
+    void setAirspeed(double airspeed) { if (m_airspeed!=airspeed){m_airspeed = airspeed; if (!defer(DirtyAirspeed)) emit airspeedChanged(airspeed);}}
+    void setGroundspeed(double groundspeed) { if (m_groundspeed!=groundspeed){m_groundspeed = groundspeed; if (!defer(DirtyGroundspeed)) emit groundspeedChanged(groundspeed);}}
+    void setAlt(double alt) { if (m_alt!=alt){m_alt = alt; if (!defer(DirtyAlt)) emit altChanged(alt);}}
+    void setClimb(double climb) { if (m_climb!=climb){m_climb = climb; if (!defer(DirtyClimb)) emit climbChanged(climb);}}
+    void setHeading(int heading) { if (m_heading!=heading){m_heading = heading; if (!defer(DirtyHeading)) emit headingChanged(heading);}}
+    void setThrottle(unsigned int throttle) { if (m_throttle!=throttle){m_throttle = throttle; if (!defer(DirtyThrottle)) emit throttleChanged(throttle);}}
 private:
     double m_airspeed;
     double m_groundspeed;
@@ -62,13 +69,13 @@ public:
     double getRollspeed() { return m_rollspeed; }
     double getPitchspeed() { return m_pitchspeed; }
     double getYawspeed() { return m_yawspeed; }
-    void setTimeBootMs(unsigned int timeBootMs) { if (m_timeBootMs!=timeBootMs){m_timeBootMs = timeBootMs; emit timeBootMsChanged(timeBootMs);}}
-    void setRoll(double roll) { if (m_roll!=roll){m_roll = roll; emit rollChanged(roll);}}
-    void setPitch(double pitch) { if (m_pitch!=pitch){m_pitch = pitch; emit pitchChanged(pitch);}}
-    void setYaw(double yaw) { if (m_yaw!=yaw){m_yaw = yaw; emit yawChanged(yaw);}}
-    void setRollspeed(double rollspeed) { if (m_rollspeed!=rollspeed){m_rollspeed = rollspeed; emit rollspeedChanged(rollspeed);}}
-    void setPitchspeed(double pitchspeed) { if (m_pitchspeed!=pitchspeed){m_pitchspeed = pitchspeed; emit pitchspeedChanged(pitchspeed);}}
-    void setYawspeed(double yawspeed) { if (m_yawspeed!=yawspeed){m_yawspeed = yawspeed; emit yawspeedChanged(yawspeed);}}
+    void setTimeBootMs(unsigned int timeBootMs) { if (m_timeBootMs!=timeBootMs){m_timeBootMs = timeBootMs; if (!defer(DirtyTimeBootMs)) emit timeBootMsChanged(timeBootMs);}}
+    void setRoll(double roll) { if (m_roll!=roll){m_roll = roll; if (!defer(DirtyRoll)) emit rollChanged(roll);}}
+    void setPitch(double pitch) { if (m_pitch!=pitch){m_pitch = pitch; if (!defer(DirtyPitch)) emit pitchChanged(pitch);}}
+    void setYaw(double yaw) { if (m_yaw!=yaw){m_yaw = yaw; if (!defer(DirtyYaw)) emit yawChanged(yaw);}}
+    void setRollspeed(double rollspeed) { if (m_rollspeed!=rollspeed){m_rollspeed = rollspeed; if (!defer(DirtyRollspeed)) emit rollspeedChanged(rollspeed);}}
+    void setPitchspeed(double pitchspeed) { if (m_pitchspeed!=pitchspeed){m_pitchspeed = pitchspeed; if (!defer(DirtyPitchspeed)) emit pitchspeedChanged(pitchspeed);}}
+    void setYawspeed(double yawspeed) { if (m_yawspeed!=yawspeed){m_yawspeed = yawspeed; if (!defer(DirtyYawspeed)) emit yawspeedChanged(yawspeed);}}
 private:
     unsigned int m_timeBootMs;
     double m_roll;
@@ -87,6 +94,59 @@ signals:
     void yawspeedChanged(double);
 public:
     explicit RelPositionOverview(QObject *parent = 0);
+    ~RelPositionOverview();
+
+    /** @brief Emit what changed since the last frame, see FramePacer */
+    void flushChanges();
+private:
+    enum DirtyProperty
+    {
+        DirtyAirspeed = 1u << 0,
+        DirtyGroundspeed = 1u << 1,
+        DirtyAlt = 1u << 2,
+        DirtyClimb = 1u << 3,
+        DirtyHeading = 1u << 4,
+        DirtyThrottle = 1u << 5,
+        DirtyTimeBootMs = 1u << 6,
+        DirtyRoll = 1u << 7,
+        DirtyPitch = 1u << 8,
+        DirtyYaw = 1u << 9,
+        DirtyRollspeed = 1u << 10,
+        DirtyPitchspeed = 1u << 11,
+        DirtyYawspeed = 1u << 12,
+        DirtyAttitudeMatrix = 1u << 13
+    };
+    /** @brief True when the NOTIFY for bit waits for the next frame */
+    bool defer(quint32 bit)
+    {
+        FramePacer *pacer = FramePacer::instance();
+        if (!pacer->pacing()) return false;
+        if (!m_dirty) pacer->schedule(this);
+        m_dirty |= bit;
+        return true;
+    }
+    quint32 m_dirty;
+public:
+    /** @brief Recent ATTITUDE messages, for overlays drawn on delayed video */
+    const AttitudeHistory & attitudeHistory() const { return m_attitudeHistory; }
+    /** @brief The attitude extrapolated to each frame, for the horizon at low ATTITUDE rates */
+    AttitudePredictor *predictedAttitude() { return &m_predictedAttitude; }
+    /** @brief The last ATTITUDE as a quaternion */
+    const AttitudeQuaternion &attitude() const { return m_attitude; }
+    QMatrix4x4 getRotation() const { return m_rotation; }
+    QMatrix4x4 getHorizon() const { return m_horizon; }
+    /** @brief AttitudeHistory::now() when the last ATTITUDE arrived, -1 before the first */
+    qint64 attitudeReceivedMs() const { return m_attitudeReceivedMs; }
+private:
+    AttitudeHistory m_attitudeHistory;
+    qint64 m_attitudeReceivedMs;
+    AttitudePredictor m_predictedAttitude;
+    AttitudeQuaternion m_attitude;
+    QMatrix4x4 m_rotation;
+    QMatrix4x4 m_horizon;
+signals:
+    void attitudeMatrixChanged();
+public:
     //scaled_imu
     //SCALED_IMU2
     //raw_imu
@@ -0,0 +1,112 @@
+#include "ServosRcOverview.h"
+#include <string.h>
+
+ServosRcOverview::ServosRcOverview(QObject *parent) :
+    QObject(parent),
+    m_rssi(255),
+    m_rcChannelCount(0)
+{
+    memset(m_rcRaw, 0, sizeof(m_rcRaw));
+    memset(m_rcScaled, 0, sizeof(m_rcScaled));
+    memset(m_servoRaw, 0, sizeof(m_servoRaw));
+}
+
+int ServosRcOverview::rcRaw(int channel) const
+{
+    return (channel >= 0 && channel < MaxRcChannels) ? m_rcRaw[channel] : 0;
+}
+
+double ServosRcOverview::rcScaled(int channel) const
+{
+    return (channel >= 0 && channel < MaxRcScaled) ? static_cast<qint16>(m_rcScaled[channel]) / 10000.0 : 0;
+}
+
+int ServosRcOverview::servoRaw(int output) const
+{
+    return (output >= 0 && output < MaxServos) ? m_servoRaw[output] : 0;
+}
+
+bool ServosRcOverview::store(quint16 *target, const quint16 *values, int count)
+{
+    bool changed = false;
+    for (int i = 0; i < count; ++i)
+    {
+        if (values[i] == UINT16_MAX || values[i] == target[i]) continue;
+        target[i] = values[i];
+        changed = true;
+    }
+    return changed;
+}
+
+//rc_channels_raw
+//rc_channels_scaled
+//RC_CHANNELS
+//servo_output_raw
+void ServosRcOverview::messageReceived(LinkInterface* link,mavlink_message_t message)
+{
+    Q_UNUSED(link);
+    switch (message.msgid)
+    {
+        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+        {
+            mavlink_rc_channels_raw_t state;
+            mavlink_msg_rc_channels_raw_decode(&message, &state);
+            // Devices with RC_CHANNELS report all channels there
+            if (m_rcChannelCount || state.port * PortWidth >= MaxRcChannels) break;
+            const quint16 raw[PortWidth] = {
+                state.chan1_raw, state.chan2_raw, state.chan3_raw, state.chan4_raw,
+                state.chan5_raw, state.chan6_raw, state.chan7_raw, state.chan8_raw
+            };
+            const int count = qMin<int>(PortWidth, MaxRcChannels - state.port * PortWidth);
+            bool changed = store(m_rcRaw + state.port * PortWidth, raw, count);
+            if (m_rssi != state.rssi) { m_rssi = state.rssi; changed = true; }
+            if (changed) emit rcChanged();
+            break;
+        }
+        case MAVLINK_MSG_ID_RC_CHANNELS:
+        {
+            mavlink_rc_channels_t state;
+            mavlink_msg_rc_channels_decode(&message, &state);
+            const quint16 raw[MaxRcChannels] = {
+                state.chan1_raw, state.chan2_raw, state.chan3_raw, state.chan4_raw,
+                state.chan5_raw, state.chan6_raw, state.chan7_raw, state.chan8_raw,
+                state.chan9_raw, state.chan10_raw, state.chan11_raw, state.chan12_raw,
+                state.chan13_raw, state.chan14_raw, state.chan15_raw, state.chan16_raw,
+                state.chan17_raw, state.chan18_raw
+            };
+            bool changed = store(m_rcRaw, raw, MaxRcChannels);
+            if (m_rssi != state.rssi) { m_rssi = state.rssi; changed = true; }
+            if (m_rcChannelCount != state.chancount) { m_rcChannelCount = state.chancount; changed = true; }
+            if (changed) emit rcChanged();
+            break;
+        }
+        case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
+        {
+            mavlink_rc_channels_scaled_t state;
+            mavlink_msg_rc_channels_scaled_decode(&message, &state);
+            if (state.port * PortWidth >= MaxRcScaled) break;
+            const quint16 scaled[PortWidth] = {
+                quint16(state.chan1_scaled), quint16(state.chan2_scaled),
+                quint16(state.chan3_scaled), quint16(state.chan4_scaled),
+                quint16(state.chan5_scaled), quint16(state.chan6_scaled),
+                quint16(state.chan7_scaled), quint16(state.chan8_scaled)
+            };
+            if (store(m_rcScaled + state.port * PortWidth, scaled, PortWidth))
+                emit rcScaledChanged();
+            break;
+        }
+        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        {
+            mavlink_servo_output_raw_t state;
+            mavlink_msg_servo_output_raw_decode(&message, &state);
+            if (state.port * PortWidth >= MaxServos) break;
+            const quint16 raw[PortWidth] = {
+                state.servo1_raw, state.servo2_raw, state.servo3_raw, state.servo4_raw,
+                state.servo5_raw, state.servo6_raw, state.servo7_raw, state.servo8_raw
+            };
+            if (store(m_servoRaw + state.port * PortWidth, raw, PortWidth))
+                emit servosChanged();
+            break;
+        }
+    }
+}
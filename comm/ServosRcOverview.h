@@ -0,0 +1,58 @@
+#ifndef SERVOSRCOVERVIEW_H
+#define SERVOSRCOVERVIEW_H
+
+#include <QObject>
+#include "mavlink.h"
+#include "LinkInterface.h"
+
+/**
+ * @brief RC inputs and servo outputs of one vehicle, for QML
+ *
+ * Like the groups in VehicleMessageGroups, each kind of value signals once
+ * per message that changed it rather than once per channel; QML reads the
+ * channels with rcRaw(), rcScaled() and servoRaw().
+ */
+class ServosRcOverview : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int rssi READ getRssi NOTIFY rcChanged)
+    Q_PROPERTY(int rcChannelCount READ getRcChannelCount NOTIFY rcChanged)
+public:
+    enum {
+        PortWidth = 8,              ///< Channels per port of the *_RAW and *_SCALED messages
+        MaxRcChannels = 18,         ///< RC_CHANNELS
+        MaxRcScaled = 2 * PortWidth,
+        MaxServos = 2 * PortWidth
+    };
+
+    explicit ServosRcOverview(QObject *parent = 0);
+
+    /** @brief RC RSSI, 0 - 255, 255 unknown */
+    int getRssi() const { return m_rssi; }
+    /** @brief Channels the receiver reports, 0 without RC_CHANNELS */
+    int getRcChannelCount() const { return m_rcChannelCount; }
+
+    /** @brief Input of channel (from 0) in microseconds, 0 if not received */
+    Q_INVOKABLE int rcRaw(int channel) const;
+    /** @brief Input of channel scaled to -1 .. 1, 0 if not received */
+    Q_INVOKABLE double rcScaled(int channel) const;
+    /** @brief Output (from 0) in microseconds, 0 if not received */
+    Q_INVOKABLE int servoRaw(int output) const;
+signals:
+    void rcChanged();
+    void rcScaledChanged();
+    void servosChanged();
+public slots:
+    void messageReceived(LinkInterface* link,mavlink_message_t message);
+private:
+    /** @brief Stores count values at first, true if any differed; UINT16_MAX leaves a value */
+    static bool store(quint16 *target, const quint16 *values, int count);
+
+    quint16 m_rcRaw[MaxRcChannels];
+    quint16 m_rcScaled[MaxRcScaled];  ///< int16 values, kept unsigned for store()
+    quint16 m_servoRaw[MaxServos];
+    int m_rssi;
+    int m_rcChannelCount;
+};
+
+#endif // SERVOSRCOVERVIEW_H
@@ -0,0 +1,248 @@
+#include "TimerWheel.h"
+#include "QsLog.h"
+
+TimerWheel *TimerWheel::instance()
+{
+    static TimerWheel* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new TimerWheel();
+    }
+    return _instance;
+}
+
+TimerWheel::TimerWheel(QObject *parent) :
+    QObject(parent),
+    m_tick(0),
+    m_active(0)
+{
+    for (int i = 0; i < Slots; ++i)
+    {
+        m_buckets[i] = -1;
+    }
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    // Lets the event loop batch this wakeup with others
+    m_timer.setTimerType(Qt::CoarseTimer);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(advance()));
+}
+
+TimerWheel::TimerId TimerWheel::start(QObject *receiver, const char *member, int intervalMs, bool repeating)
+{
+    if (!receiver || !member)
+    {
+        return InvalidTimer;
+    }
+    // SLOT() prefixes the signature with its method type code
+    QByteArray signature = QMetaObject::normalizedSignature(member + 1);
+    int method = receiver->metaObject()->indexOfMethod(signature.constData());
+    if (method < 0)
+    {
+        QLOG_WARN() << "TimerWheel: no slot" << signature << "in" << receiver->metaObject()->className();
+        return InvalidTimer;
+    }
+
+    int entry;
+    if (m_free.isEmpty())
+    {
+        if (m_entries.size() > 0xFFFF)
+        {
+            return InvalidTimer;
+        }
+        entry = m_entries.size();
+        m_entries.append(Entry());
+    }
+    else
+    {
+        entry = m_free.takeLast();
+    }
+    qint64 now = m_clock.elapsed();
+    if (m_active == 0)
+    {
+        // Idle wheel, the cursor did not move while nothing was scheduled
+        m_tick = now / TickMs;
+    }
+    Entry &e = m_entries[entry];
+    e.receiver = receiver;
+    e.method = receiver->metaObject()->method(method);
+    e.interval = qMax(0, intervalMs);
+    e.due = now + e.interval;
+    e.repeating = repeating;
+    e.used = true;
+    ++m_active;
+    link(entry);
+    arm();
+    return idOf(entry);
+}
+
+void TimerWheel::stop(TimerId timer)
+{
+    int entry = entryOf(timer);
+    if (entry < 0)
+    {
+        return;
+    }
+    if (m_entries.at(entry).slot >= 0)
+    {
+        unlink(entry);
+    }
+    release(entry);
+    arm();
+}
+
+void TimerWheel::stopAll(QObject *receiver)
+{
+    for (int entry = 0; entry < m_entries.size(); ++entry)
+    {
+        if (m_entries.at(entry).used && m_entries.at(entry).receiver == receiver)
+        {
+            if (m_entries.at(entry).slot >= 0)
+            {
+                unlink(entry);
+            }
+            release(entry);
+        }
+    }
+    arm();
+}
+
+bool TimerWheel::isActive(TimerId timer) const
+{
+    return entryOf(timer) >= 0;
+}
+
+int TimerWheel::entryOf(TimerId timer) const
+{
+    if (timer < 0)
+    {
+        return -1;
+    }
+    int entry = timer & 0xFFFF;
+    if (entry >= m_entries.size() || !m_entries.at(entry).used || m_entries.at(entry).generation != (timer >> 16))
+    {
+        return -1;
+    }
+    return entry;
+}
+
+void TimerWheel::link(int entry)
+{
+    Entry &e = m_entries[entry];
+    // Round up, a timer may fire late but never early
+    qint64 tick = qMax((e.due + TickMs - 1) / TickMs, m_tick + 1);
+    e.slot = static_cast<int>(tick % Slots);
+    e.prev = -1;
+    e.next = m_buckets[e.slot];
+    if (e.next >= 0)
+    {
+        m_entries[e.next].prev = entry;
+    }
+    m_buckets[e.slot] = entry;
+}
+
+void TimerWheel::unlink(int entry)
+{
+    Entry &e = m_entries[entry];
+    if (e.prev >= 0)
+    {
+        m_entries[e.prev].next = e.next;
+    }
+    else
+    {
+        m_buckets[e.slot] = e.next;
+    }
+    if (e.next >= 0)
+    {
+        m_entries[e.next].prev = e.prev;
+    }
+    e.next = -1;
+    e.prev = -1;
+    e.slot = -1;
+}
+
+void TimerWheel::release(int entry)
+{
+    Entry &e = m_entries[entry];
+    e.used = false;
+    e.receiver = 0;
+    e.generation = (e.generation + 1) & 0x7FFF;
+    m_free.append(entry);
+    --m_active;
+}
+
+void TimerWheel::arm()
+{
+    if (m_active == 0)
+    {
+        m_timer.stop();
+        return;
+    }
+    // Sleep until the next bucket with a timer in it, which may hold only
+    // timers of a later revolution; that costs one wakeup per turn at most
+    int ahead = Slots;
+    for (int d = 1; d <= Slots; ++d)
+    {
+        if (m_buckets[(m_tick + d) % Slots] >= 0)
+        {
+            ahead = d;
+            break;
+        }
+    }
+    qint64 wait = (m_tick + ahead) * TickMs - m_clock.elapsed();
+    m_timer.start(static_cast<int>(qMax(Q_INT64_C(0), wait)));
+}
+
+void TimerWheel::advance()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 nowTick = now / TickMs;
+    // After a stall longer than a revolution every bucket is due
+    qint64 first = qMax(m_tick + 1, nowTick - Slots + 1);
+
+    m_expired.clear();
+    for (qint64 tick = first; tick <= nowTick; ++tick)
+    {
+        int entry = m_buckets[tick % Slots];
+        while (entry >= 0)
+        {
+            int next = m_entries.at(entry).next;
+            if (m_entries.at(entry).due <= now)
+            {
+                unlink(entry);
+                m_expired.append(entry);
+            }
+            entry = next;
+        }
+    }
+    m_tick = qMax(m_tick, nowTick);
+
+    // Slots may start and stop timers, the one firing included
+    QVector<int> expired = m_expired;
+    for (int i = 0; i < expired.size(); ++i)
+    {
+        int entry = expired.at(i);
+        Entry &e = m_entries[entry];
+        if (!e.used || e.slot >= 0)
+        {
+            // Stopped, or stopped and reused, by an earlier slot
+            continue;
+        }
+        QObject *receiver = e.receiver;
+        QMetaMethod method = e.method;
+        if (e.repeating)
+        {
+            e.due += e.interval;
+            if (e.due <= now)
+            {
+                e.due = now + qMax(e.interval, 1);
+            }
+            link(entry);
+        }
+        else
+        {
+            release(entry);
+        }
+        method.invoke(receiver, Qt::DirectConnection);
+    }
+    arm();
+}
@@ -0,0 +1,85 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief One timer for all periodic vehicle housekeeping
+ *
+ * Heartbeat checks, heartbeat sending, stream re-requests and parameter
+ * retries of every UAS are slots on a hashed timing wheel of Slots buckets,
+ * TickMs apart. Only one QTimer exists, it is armed for the next bucket that
+ * holds a timer, so an idle wheel does not wake up at all and a dozen
+ * vehicles cost the same wakeups as one. Timers fire up to TickMs late and
+ * never early; a late repeating timer is not fired twice to catch up.
+ *
+ * GUI thread only. Receivers stop their timers, e.g. with stopAll(this)
+ * from their destructor.
+ */
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+public:
+    enum { TickMs = 50, Slots = 256 };
+    /** @brief A started timer, negative for none */
+    typedef int TimerId;
+    enum { InvalidTimer = -1 };
+
+    static TimerWheel *instance();
+
+    /**
+     * @brief Call member, a SLOT() without arguments, of receiver after intervalMs
+     * @return the timer, InvalidTimer when member is not a slot of receiver
+     */
+    TimerId start(QObject *receiver, const char *member, int intervalMs, bool repeating = true);
+    /** @brief Stop timer, also from within its own slot; stale ids are ignored */
+    void stop(TimerId timer);
+    void stopAll(QObject *receiver);
+    bool isActive(TimerId timer) const;
+
+    /** @brief Timers currently running */
+    int size() const { return m_active; }
+
+private slots:
+    void advance();
+
+private:
+    explicit TimerWheel(QObject *parent = 0);
+
+    struct Entry
+    {
+        Entry() : receiver(0), due(0), interval(0), next(-1), prev(-1), slot(-1), generation(0), repeating(false), used(false) { }
+        QObject *receiver;
+        QMetaMethod method;
+        qint64 due;          ///< ms on m_clock
+        int interval;
+        int next;            ///< Bucket list, entry indices
+        int prev;
+        int slot;            ///< Bucket, -1 while expired and not yet fired
+        quint16 generation;  ///< Bumped on reuse so old TimerIds go stale
+        bool repeating;
+        bool used;
+    };
+
+    int entryOf(TimerId timer) const;
+    TimerId idOf(int entry) const { return (m_entries.at(entry).generation << 16) | entry; }
+    void link(int entry);
+    void unlink(int entry);
+    void release(int entry);
+    void arm();
+
+    QVector<Entry> m_entries;
+    QVector<int> m_free;
+    QVector<int> m_expired;
+    int m_buckets[Slots];     ///< First entry of each bucket, -1 when empty
+    qint64 m_tick;            ///< Last bucket processed, in ticks since m_clock started
+    int m_active;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
+
+#endif // TIMERWHEEL_H
@@ -1,15 +1,114 @@
 #include "UASObject.h"
 //#include "libs/mavlink/include/mavlink/v1.0/common/mavlink_msg_heartbeat.h"
 #include <QMetaType>
-UASObject::UASObject(QObject *parent) : QObject(parent)
+#include "MAVLinkDispatcher.h"
+#include <string.h>
+const UASObject::Route UASObject::routes[] = {
+    { MAVLINK_MSG_ID_HEARTBEAT, Vehicle },
+    { MAVLINK_MSG_ID_BATTERY_STATUS, Vehicle },
+    { MAVLINK_MSG_ID_SYS_STATUS, Vehicle },
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, Vehicle },
+    { MAVLINK_MSG_ID_POWER_STATUS, Vehicle },
+    { MAVLINK_MSG_ID_RADIO_STATUS, Vehicle },
+    { MAVLINK_MSG_ID_ATTITUDE, RelPosition },
+    { MAVLINK_MSG_ID_VFR_HUD, RelPosition },
+    { MAVLINK_MSG_ID_GPS_RAW_INT, AbsPosition },
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, AbsPosition },
+    { MAVLINK_MSG_ID_MISSION_COUNT, Mission },
+    { MAVLINK_MSG_ID_MISSION_CURRENT, Mission },
+    { MAVLINK_MSG_ID_MISSION_ITEM_REACHED, Mission },
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW, ServosRc },
+    { MAVLINK_MSG_ID_RC_CHANNELS_SCALED, ServosRc },
+    { MAVLINK_MSG_ID_RC_CHANNELS, ServosRc },
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, ServosRc },
+    { -1, Vehicle }
+};
+
+// The overviews are members, so a vehicle's QObjects come in one allocation.
+// Each still has this as its parent and leaves the child list when the
+// members are destroyed, before ~QObject would delete it.
+UASObject::UASObject(QObject *parent) : QObject(parent),
+    m_vehicleOverview(this),
+    m_relPositionOverview(this),
+    m_absPositionOverview(this),
+    m_missionOverview(this),
+    m_servosRcOverview(this),
+    m_sysid(MAVLinkDispatcher::AnySystem)
 {
-    m_vehicleOverview = new VehicleOverview(this);
-    m_relPositionOverview = new RelPositionOverview(this);
-    m_absPositionOverview = new AbsPositionOverview(this);
 }
+
+void UASObject::deliver(Overview overview, LinkInterface *link, const mavlink_message_t &message)
+{
+    switch (overview)
+    {
+    case Vehicle: m_vehicleOverview.messageReceived(link, message); break;
+    case RelPosition: m_relPositionOverview.messageReceived(link, message); break;
+    case AbsPosition: m_absPositionOverview.messageReceived(link, message); break;
+    case Mission: m_missionOverview.messageReceived(link, message); break;
+    case ServosRc: m_servosRcOverview.messageReceived(link, message); break;
+    }
+}
+
 void UASObject::messageReceived(LinkInterface* link,mavlink_message_t message)
 {
-    m_vehicleOverview->messageReceived(link,message);
-    m_relPositionOverview->messageReceived(link,message);
-    m_absPositionOverview->messageReceived(link,message);
+    if (m_sysid != MAVLinkDispatcher::AnySystem && message.sysid != m_sysid)
+    {
+        return;
+    }
+    // Built once from routes, one overview per message id or none
+    static signed char overviewFor[256];
+    static bool built = false;
+    if (!built)
+    {
+        memset(overviewFor, -1, sizeof(overviewFor));
+        for (const Route *route = routes; route->msgid != -1; ++route)
+        {
+            overviewFor[route->msgid] = route->overview;
+        }
+        built = true;
+    }
+    if (overviewFor[message.msgid] >= 0)
+    {
+        deliver(static_cast<Overview>(overviewFor[message.msgid]), link, message);
+    }
+}
+
+void UASObject::subscribe(MAVLinkDispatcher *dispatcher, int sysid)
+{
+    m_sysid = sysid;
+    for (const Route *route = routes; route->msgid != -1; ++route)
+    {
+        switch (route->overview)
+        {
+        case Vehicle:
+            dispatcher->subscribe(sysid, route->msgid,
+                                  &MAVLinkDispatcher::call<VehicleOverview, &VehicleOverview::messageReceived>, &m_vehicleOverview);
+            break;
+        case RelPosition:
+            dispatcher->subscribe(sysid, route->msgid,
+                                  &MAVLinkDispatcher::call<RelPositionOverview, &RelPositionOverview::messageReceived>, &m_relPositionOverview);
+            break;
+        case AbsPosition:
+            dispatcher->subscribe(sysid, route->msgid,
+                                  &MAVLinkDispatcher::call<AbsPositionOverview, &AbsPositionOverview::messageReceived>, &m_absPositionOverview);
+            break;
+        case Mission:
+            dispatcher->subscribe(sysid, route->msgid,
+                                  &MAVLinkDispatcher::call<MissionOverview, &MissionOverview::messageReceived>, &m_missionOverview);
+            break;
+        case ServosRc:
+            dispatcher->subscribe(sysid, route->msgid,
+                                  &MAVLinkDispatcher::call<ServosRcOverview, &ServosRcOverview::messageReceived>, &m_servosRcOverview);
+            break;
+        }
+    }
+}
+
+void UASObject::unsubscribe(MAVLinkDispatcher *dispatcher)
+{
+    dispatcher->unsubscribe(&m_vehicleOverview);
+    dispatcher->unsubscribe(&m_relPositionOverview);
+    dispatcher->unsubscribe(&m_absPositionOverview);
+    dispatcher->unsubscribe(&m_missionOverview);
+    dispatcher->unsubscribe(&m_servosRcOverview);
 }
@@ -14,36 +14,43 @@
 #include "libs/mavlink/include/mavlink/v1.0-qt/common/mavlink_message_hil_controls.h"
 #include "libs/mavlink/include/mavlink/v1.0-qt/common/mavlink_message_attitude.h"*/
 #include "VehicleOverview.h"
+#include "MissionOverview.h"
+#include "ServosRcOverview.h"
+class MAVLinkDispatcher;
 class UASObject : public QObject
 {
     Q_OBJECT
 public:
 
-    class MissionOverview
-    {
-        //MISSION_ITEM
-        //MISSION_CURRENT
-        //MISSION_COUNT
-        //MISSION_ITEM_REACHED
-    };
-    class ServosRcOverview
-    {
-        //rc_channels_scaled
-        //rc_channels_raw
-        //servo_output_raw
-        //RC_CHANNELS
-    };
-
     explicit UASObject(QObject *parent = 0);
-    VehicleOverview *getVehicleOverview() { return m_vehicleOverview; }
-    RelPositionOverview *getRelPositionOverview() { return m_relPositionOverview; }
-    AbsPositionOverview *getAbsPositionOverview() { return m_absPositionOverview; }
+    VehicleOverview *getVehicleOverview() { return &m_vehicleOverview; }
+    RelPositionOverview *getRelPositionOverview() { return &m_relPositionOverview; }
+    AbsPositionOverview *getAbsPositionOverview() { return &m_absPositionOverview; }
+    MissionOverview *getMissionOverview() { return &m_missionOverview; }
+    ServosRcOverview *getServosRcOverview() { return &m_servosRcOverview; }
+    /** @brief Subscribe the overviews to the messages of sysid they decode */
+    void subscribe(MAVLinkDispatcher *dispatcher, int sysid);
+    /** @brief Stop decoding, e.g. while another vehicle is on the HUD in swarm mode */
+    void unsubscribe(MAVLinkDispatcher *dispatcher);
 private slots:
 private:
+    enum Overview { Vehicle, RelPosition, AbsPosition, Mission, ServosRc };
+    struct Route
+    {
+        int msgid;
+        Overview overview;
+    };
+    /** @brief Which overview decodes which message */
+    static const Route routes[];
+    void deliver(Overview overview, LinkInterface *link, const mavlink_message_t &message);
+
     //mavlink_message_heartbeat_t lastHeartbeat;
-    VehicleOverview *m_vehicleOverview;
-    RelPositionOverview *m_relPositionOverview;
-    AbsPositionOverview *m_absPositionOverview;
+    VehicleOverview m_vehicleOverview;
+    RelPositionOverview m_relPositionOverview;
+    AbsPositionOverview m_absPositionOverview;
+    MissionOverview m_missionOverview;
+    ServosRcOverview m_servosRcOverview;
+    int m_sysid;    ///< Set by subscribe(), messageReceived() drops other systems
 signals:
 
    /*void ahrsReceived(QSharedPointer<mavlink_message_ahrs_t>);
@@ -53,6 +60,7 @@ signals:
     void hilControlsReceived(QSharedPointer<mavlink_message_hil_controls_t>);
     void attitudeReceived(QSharedPointer<mavlink_message_attitude_t>);*/
 public slots:
+    /** @brief Hands message to the overviews that decode it, for callers outside the dispatcher */
     void messageReceived(LinkInterface* link,mavlink_message_t message);
 };
 
@@ -0,0 +1,92 @@
+#include "VehicleMessageGroups.h"
+#include <cstring>
+
+VehicleHeartbeat::VehicleHeartbeat(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehicleHeartbeat::update(const mavlink_heartbeat_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
+
+VehicleSysStatus::VehicleSysStatus(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehicleSysStatus::update(const mavlink_sys_status_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
+
+VehicleNavOutput::VehicleNavOutput(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehicleNavOutput::update(const mavlink_nav_controller_output_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
+
+VehicleBatteryStatus::VehicleBatteryStatus(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehicleBatteryStatus::update(const mavlink_battery_status_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
+
+VehiclePowerStatus::VehiclePowerStatus(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehiclePowerStatus::update(const mavlink_power_status_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
+
+VehicleRadioStatus::VehicleRadioStatus(QObject *parent) : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+}
+
+void VehicleRadioStatus::update(const mavlink_radio_status_t &state)
+{
+    // MAVLink structs are packed, there is no padding to compare
+    if (memcmp(&state, &m_state, sizeof(m_state)) != 0)
+    {
+        m_state = state;
+        emit changed();
+    }
+}
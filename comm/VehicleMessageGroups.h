@@ -0,0 +1,196 @@
+#ifndef VEHICLEMESSAGEGROUPS_H
+#define VEHICLEMESSAGEGROUPS_H
+
+#include <QObject>
+#include "mavlink.h"
+
+/**
+ * @brief Fields of one MAVLink message, as one QML object per message
+ *
+ * Each group keeps the last decoded message and signals changed() once when
+ * a new one differs from it, so bindings to any of its fields re-evaluate
+ * once per message instead of once per field, and never see fields of two
+ * different messages.
+ */
+class VehicleHeartbeat : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(unsigned int custom_mode READ getCustomMode NOTIFY changed)
+    Q_PROPERTY(unsigned int type READ getType NOTIFY changed)
+    Q_PROPERTY(unsigned int autopilot READ getAutopilot NOTIFY changed)
+    Q_PROPERTY(unsigned int base_mode READ getBaseMode NOTIFY changed)
+    Q_PROPERTY(unsigned int system_status READ getSystemStatus NOTIFY changed)
+    Q_PROPERTY(unsigned int mavlink_version READ getMavlinkVersion NOTIFY changed)
+    Q_PROPERTY(bool armed READ isArmed NOTIFY changed)
+public:
+    explicit VehicleHeartbeat(QObject *parent = 0);
+    unsigned int getCustomMode() const { return m_state.custom_mode; }
+    unsigned int getType() const { return m_state.type; }
+    unsigned int getAutopilot() const { return m_state.autopilot; }
+    unsigned int getBaseMode() const { return m_state.base_mode; }
+    unsigned int getSystemStatus() const { return m_state.system_status; }
+    unsigned int getMavlinkVersion() const { return m_state.mavlink_version; }
+    bool isArmed() const { return m_state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY; }
+    const mavlink_heartbeat_t &state() const { return m_state; }
+    /** @brief Take a new HEARTBEAT, signals if it differs from the last */
+    void update(const mavlink_heartbeat_t &state);
+signals:
+    void changed();
+private:
+    mavlink_heartbeat_t m_state;
+};
+
+class VehicleSysStatus : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(unsigned int onboard_control_sensors_present READ getOnboardControlSensorsPresent NOTIFY changed)
+    Q_PROPERTY(unsigned int onboard_control_sensors_enabled READ getOnboardControlSensorsEnabled NOTIFY changed)
+    Q_PROPERTY(unsigned int onboard_control_sensors_health READ getOnboardControlSensorsHealth NOTIFY changed)
+    Q_PROPERTY(unsigned int load READ getLoad NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_battery READ getVoltageBattery NOTIFY changed)
+    Q_PROPERTY(int current_battery READ getCurrentBattery NOTIFY changed)
+    Q_PROPERTY(unsigned int drop_rate_comm READ getDropRateComm NOTIFY changed)
+    Q_PROPERTY(unsigned int errors_comm READ getErrorsComm NOTIFY changed)
+    Q_PROPERTY(unsigned int errors_count1 READ getErrorsCount1 NOTIFY changed)
+    Q_PROPERTY(unsigned int errors_count2 READ getErrorsCount2 NOTIFY changed)
+    Q_PROPERTY(unsigned int errors_count3 READ getErrorsCount3 NOTIFY changed)
+    Q_PROPERTY(unsigned int errors_count4 READ getErrorsCount4 NOTIFY changed)
+    Q_PROPERTY(int battery_remaining READ getBatteryRemaining NOTIFY changed)
+public:
+    explicit VehicleSysStatus(QObject *parent = 0);
+    unsigned int getOnboardControlSensorsPresent() const { return m_state.onboard_control_sensors_present; }
+    unsigned int getOnboardControlSensorsEnabled() const { return m_state.onboard_control_sensors_enabled; }
+    unsigned int getOnboardControlSensorsHealth() const { return m_state.onboard_control_sensors_health; }
+    unsigned int getLoad() const { return m_state.load; }
+    unsigned int getVoltageBattery() const { return m_state.voltage_battery; }
+    int getCurrentBattery() const { return m_state.current_battery; }
+    unsigned int getDropRateComm() const { return m_state.drop_rate_comm; }
+    unsigned int getErrorsComm() const { return m_state.errors_comm; }
+    unsigned int getErrorsCount1() const { return m_state.errors_count1; }
+    unsigned int getErrorsCount2() const { return m_state.errors_count2; }
+    unsigned int getErrorsCount3() const { return m_state.errors_count3; }
+    unsigned int getErrorsCount4() const { return m_state.errors_count4; }
+    int getBatteryRemaining() const { return m_state.battery_remaining; }
+    const mavlink_sys_status_t &state() const { return m_state; }
+    /** @brief Take a new SYS_STATUS, signals if it differs from the last */
+    void update(const mavlink_sys_status_t &state);
+signals:
+    void changed();
+private:
+    mavlink_sys_status_t m_state;
+};
+
+class VehicleNavOutput : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(double nav_roll READ getNavRoll NOTIFY changed)
+    Q_PROPERTY(double nav_pitch READ getNavPitch NOTIFY changed)
+    Q_PROPERTY(double alt_error READ getAltError NOTIFY changed)
+    Q_PROPERTY(double aspd_error READ getAspdError NOTIFY changed)
+    Q_PROPERTY(double xtrack_error READ getXtrackError NOTIFY changed)
+    Q_PROPERTY(int nav_bearing READ getNavBearing NOTIFY changed)
+    Q_PROPERTY(int target_bearing READ getTargetBearing NOTIFY changed)
+    Q_PROPERTY(unsigned int wp_dist READ getWpDist NOTIFY changed)
+public:
+    explicit VehicleNavOutput(QObject *parent = 0);
+    double getNavRoll() const { return m_state.nav_roll; }
+    double getNavPitch() const { return m_state.nav_pitch; }
+    double getAltError() const { return m_state.alt_error; }
+    double getAspdError() const { return m_state.aspd_error; }
+    double getXtrackError() const { return m_state.xtrack_error; }
+    int getNavBearing() const { return m_state.nav_bearing; }
+    int getTargetBearing() const { return m_state.target_bearing; }
+    unsigned int getWpDist() const { return m_state.wp_dist; }
+    const mavlink_nav_controller_output_t &state() const { return m_state; }
+    /** @brief Take a new NAV_CONTROLLER_OUTPUT, signals if it differs from the last */
+    void update(const mavlink_nav_controller_output_t &state);
+signals:
+    void changed();
+private:
+    mavlink_nav_controller_output_t m_state;
+};
+
+class VehicleBatteryStatus : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int current_consumed READ getCurrentConsumed NOTIFY changed)
+    Q_PROPERTY(int energy_consumed READ getEnergyConsumed NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_1 READ getVoltageCell1 NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_2 READ getVoltageCell2 NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_3 READ getVoltageCell3 NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_4 READ getVoltageCell4 NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_5 READ getVoltageCell5 NOTIFY changed)
+    Q_PROPERTY(unsigned int voltage_cell_6 READ getVoltageCell6 NOTIFY changed)
+    Q_PROPERTY(int current_battery READ getCurrentBattery NOTIFY changed)
+    Q_PROPERTY(unsigned int accu_id READ getAccuId NOTIFY changed)
+    Q_PROPERTY(int battery_remaining READ getBatteryRemaining NOTIFY changed)
+public:
+    explicit VehicleBatteryStatus(QObject *parent = 0);
+    int getCurrentConsumed() const { return m_state.current_consumed; }
+    int getEnergyConsumed() const { return m_state.energy_consumed; }
+    unsigned int getVoltageCell1() const { return m_state.voltage_cell_1; }
+    unsigned int getVoltageCell2() const { return m_state.voltage_cell_2; }
+    unsigned int getVoltageCell3() const { return m_state.voltage_cell_3; }
+    unsigned int getVoltageCell4() const { return m_state.voltage_cell_4; }
+    unsigned int getVoltageCell5() const { return m_state.voltage_cell_5; }
+    unsigned int getVoltageCell6() const { return m_state.voltage_cell_6; }
+    int getCurrentBattery() const { return m_state.current_battery; }
+    unsigned int getAccuId() const { return m_state.accu_id; }
+    int getBatteryRemaining() const { return m_state.battery_remaining; }
+    const mavlink_battery_status_t &state() const { return m_state; }
+    /** @brief Take a new BATTERY_STATUS, signals if it differs from the last */
+    void update(const mavlink_battery_status_t &state);
+signals:
+    void changed();
+private:
+    mavlink_battery_status_t m_state;
+};
+
+class VehiclePowerStatus : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(unsigned int Vcc READ getVcc NOTIFY changed)
+    Q_PROPERTY(unsigned int Vservo READ getVservo NOTIFY changed)
+    Q_PROPERTY(unsigned int flags READ getFlags NOTIFY changed)
+public:
+    explicit VehiclePowerStatus(QObject *parent = 0);
+    unsigned int getVcc() const { return m_state.Vcc; }
+    unsigned int getVservo() const { return m_state.Vservo; }
+    unsigned int getFlags() const { return m_state.flags; }
+    const mavlink_power_status_t &state() const { return m_state; }
+    /** @brief Take a new POWER_STATUS, signals if it differs from the last */
+    void update(const mavlink_power_status_t &state);
+signals:
+    void changed();
+private:
+    mavlink_power_status_t m_state;
+};
+
+class VehicleRadioStatus : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(unsigned int rxerrors READ getRxerrors NOTIFY changed)
+    Q_PROPERTY(unsigned int fixed READ getFixed NOTIFY changed)
+    Q_PROPERTY(unsigned int rssi READ getRssi NOTIFY changed)
+    Q_PROPERTY(unsigned int remrssi READ getRemrssi NOTIFY changed)
+    Q_PROPERTY(unsigned int txbuf READ getTxbuf NOTIFY changed)
+    Q_PROPERTY(unsigned int noise READ getNoise NOTIFY changed)
+    Q_PROPERTY(unsigned int remnoise READ getRemnoise NOTIFY changed)
+public:
+    explicit VehicleRadioStatus(QObject *parent = 0);
+    unsigned int getRxerrors() const { return m_state.rxerrors; }
+    unsigned int getFixed() const { return m_state.fixed; }
+    unsigned int getRssi() const { return m_state.rssi; }
+    unsigned int getRemrssi() const { return m_state.remrssi; }
+    unsigned int getTxbuf() const { return m_state.txbuf; }
+    unsigned int getNoise() const { return m_state.noise; }
+    unsigned int getRemnoise() const { return m_state.remnoise; }
+    const mavlink_radio_status_t &state() const { return m_state; }
+    /** @brief Take a new RADIO_STATUS, signals if it differs from the last */
+    void update(const mavlink_radio_status_t &state);
+signals:
+    void changed();
+private:
+    mavlink_radio_status_t m_state;
+};
+#endif // VEHICLEMESSAGEGROUPS_H
@@ -21,6 +21,8 @@
 #define PARAMETER_DIRECTORY "/parameters"
 #define MAVLINK_LOG_DIRECTORY "/tlogs"
 #define MAVLINK_LOGFILE_EXT ".tlog"
+#define MAVLINK_COMPRESSED_LOGFILE_EXT ".ctlog"
+#define VIDEO_DIRECTORY "/video"
 
 #ifndef APP_TYPE
 #define APP_TYPE stable // or "daily" for master branch builds
@@ -105,6 +107,14 @@ const int APPLICATIONVERSION = 2015; // 2.0.15 [TODO] we should deprecate this v
         GlobalObject::sharedInstance()->setParameterDirectory(dir);
     }
 
+    inline QString videoDirectory(){
+        return GlobalObject::sharedInstance()->videoDirectory();
+    }
+
+    inline void setVideoDirectory(const QString& dir){
+        GlobalObject::sharedInstance()->setVideoDirectory(dir);
+    }
+
     //Returns the absolute parth to the files, data, qml support directories
     //It could be in 1 of 2 places under Linux
     inline QString shareDirectory(){
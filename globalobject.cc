@@ -1,7 +1,7 @@
 #include "QsLog.h"
 #include "configuration.h"
 #include "globalobject.h"
-#include <QSettings>
+#include "SettingsStore.h"
 #include <QDateTime>
 #include <QDir>
 #include <QDesktopServices>
@@ -28,27 +28,28 @@ GlobalObject::~GlobalObject()
 
 void GlobalObject::loadSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup("GLOBAL_SETTINGS");
     m_appDataDirectory = settings.value("APP_DATA_DIRECTORY", defaultAppDataDirectory()).toString();
     m_logDirectory = settings.value("LOG_DIRECTORY", defaultLogDirectory()).toString();
     m_MAVLinklogDirectory = settings.value("MAVLINK_LOG_DIRECTORY", defaultMAVLinkLogDirectory()).toString();
     m_parameterDirectory = settings.value("PARAMETER_DIRECTORY", defaultParameterDirectory()).toString();
+    m_videoDirectory = settings.value("VIDEO_DIRECTORY", defaultVideoDirectory()).toString();
 
     settings.endGroup();
 }
 
 void GlobalObject::saveSettings()
 {
-    QSettings settings;
+    StoredSettings settings;
     settings.beginGroup("GLOBAL_SETTINGS");
     settings.setValue("APP_DATA_DIRECTORY", m_appDataDirectory);
     settings.setValue("LOG_DIRECTORY", m_logDirectory);
     settings.setValue("MAVLINK_LOG_DIRECTORY", m_MAVLinklogDirectory);
     QLOG_DEBUG() << "save tlog dir to:" << m_MAVLinklogDirectory;
     settings.setValue("PARAMETER_DIRECTORY", m_parameterDirectory);
+    settings.setValue("VIDEO_DIRECTORY", m_videoDirectory);
 
-    settings.sync();
 }
 
 QString GlobalObject::fileNameAsTime()
@@ -89,6 +90,8 @@ void GlobalObject::setAppDataDirectory(const QString &dir)
 {
     QLOG_DEBUG() << "Set app dir to:" << dir;
     m_appDataDirectory = dir;
+    // Only the in-memory settings change here, the store writes them out later
+    saveSettings();
 }
 
 //
@@ -113,6 +116,7 @@ void GlobalObject::setLogDirectory(const QString &dir)
 {
     QLOG_DEBUG() << "Set dataflash dir to:" << dir;
     m_logDirectory = dir;
+    saveSettings();
 }
 
 //
@@ -137,6 +141,7 @@ void GlobalObject::setMAVLinkLogDirectory(const QString &dir)
 {
     QLOG_DEBUG() << "Set tlog dir to:" << dir;
     m_MAVLinklogDirectory = dir;
+    saveSettings();
 }
 
 //
@@ -160,6 +165,31 @@ void GlobalObject::setParameterDirectory(const QString &dir)
 {
     QLOG_DEBUG() << "Set param dir to:" << dir;
     m_parameterDirectory = dir;
+    saveSettings();
+}
+
+//
+// Video Recording Directory
+//
+QString GlobalObject::defaultVideoDirectory()
+{
+    QString homeDir = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+    QString videoHomeDir = homeDir + APP_DATA_DIRECTORY + VIDEO_DIRECTORY;
+    makeDirectory(videoHomeDir);
+    return videoHomeDir;
+}
+
+QString GlobalObject::videoDirectory()
+{
+    makeDirectory(m_videoDirectory);
+    return m_videoDirectory;
+}
+
+void GlobalObject::setVideoDirectory(const QString &dir)
+{
+    QLOG_DEBUG() << "Set video dir to:" << dir;
+    m_videoDirectory = dir;
+    saveSettings();
 }
 
 QString GlobalObject::shareDirectory()
@@ -0,0 +1,12 @@
+# Desktop build of the telemetry stack without QtQuick, GStreamer or Android:
+# the static library and its headless driver. The HUD itself is qmlplayer2.pro.
+#
+#     qmake headless.pro && make
+
+TEMPLATE = subdirs
+
+telemetry.subdir = libs/telemetry
+telemetryd.subdir = apps/telemetryd
+telemetryd.depends = telemetry
+
+SUBDIRS = telemetry telemetryd
@@ -0,0 +1,4456 @@
+/** @file
+ *	@brief Typed C++ access to the MAVLink ardupilotmega dialect
+ *	Generated by mavgen_cpp.py, do not edit
+ */
+#ifndef MAVLINK_ARDUPILOTMEGA_HPP
+#define MAVLINK_ARDUPILOTMEGA_HPP
+
+#include "mavlink.h"
+#include <string.h>
+
+namespace mavlink {
+
+namespace detail {
+// Payload fields are packed and little endian, read them without assuming
+// alignment and swap them on a big endian host
+template <typename T> inline T read(const char *p)
+{
+    T value;
+#if MAVLINK_NEED_BYTE_SWAP
+    char *bytes = reinterpret_cast<char *>(&value);
+    for (unsigned i = 0; i < sizeof(T); i++)
+    {
+        bytes[i] = p[sizeof(T) - 1 - i];
+    }
+#else
+    memcpy(&value, p, sizeof(T));
+#endif
+    return value;
+}
+}
+
+struct FieldLayout
+{
+    const char *name;
+    uint8_t type;          ///< MAVLINK_TYPE_*
+    uint8_t arrayLength;   ///< 0 for a single value
+    uint8_t wireOffset;
+};
+
+struct MessageLayout
+{
+    const char *name;      ///< NULL for IDs without a message
+    uint8_t length;
+    uint8_t crcExtra;
+    uint8_t numFields;
+    const FieldLayout *fields;   ///< In wire order
+};
+
+/** @brief Layout of msgid, compile time initialised, shared by every translation unit */
+inline const MessageLayout &messageLayout(uint8_t msgid)
+{
+    static const FieldLayout fields_heartbeat[] = {
+        { "custom_mode", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "autopilot", MAVLINK_TYPE_UINT8_T, 0, 5 },
+        { "base_mode", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "system_status", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "mavlink_version", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const FieldLayout fields_sys_status[] = {
+        { "onboard_control_sensors_present", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "onboard_control_sensors_enabled", MAVLINK_TYPE_UINT32_T, 0, 4 },
+        { "onboard_control_sensors_health", MAVLINK_TYPE_UINT32_T, 0, 8 },
+        { "load", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "voltage_battery", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "current_battery", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "drop_rate_comm", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "errors_comm", MAVLINK_TYPE_UINT16_T, 0, 20 },
+        { "errors_count1", MAVLINK_TYPE_UINT16_T, 0, 22 },
+        { "errors_count2", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "errors_count3", MAVLINK_TYPE_UINT16_T, 0, 26 },
+        { "errors_count4", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "battery_remaining", MAVLINK_TYPE_INT8_T, 0, 30 },
+    };
+    static const FieldLayout fields_system_time[] = {
+        { "time_unix_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 8 },
+    };
+    static const FieldLayout fields_ping[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "seq", MAVLINK_TYPE_UINT32_T, 0, 8 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 12 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 13 },
+    };
+    static const FieldLayout fields_change_operator_control[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "control_request", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "version", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "passkey", MAVLINK_TYPE_CHAR, 25, 3 },
+    };
+    static const FieldLayout fields_change_operator_control_ack[] = {
+        { "gcs_system_id", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "control_request", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "ack", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_auth_key[] = {
+        { "key", MAVLINK_TYPE_CHAR, 32, 0 },
+    };
+    static const FieldLayout fields_set_mode[] = {
+        { "custom_mode", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "base_mode", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_param_request_read[] = {
+        { "param_index", MAVLINK_TYPE_INT16_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 3 },
+        { "param_id", MAVLINK_TYPE_CHAR, 16, 4 },
+    };
+    static const FieldLayout fields_param_request_list[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+    };
+    static const FieldLayout fields_param_value[] = {
+        { "param_value", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "param_count", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "param_index", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "param_id", MAVLINK_TYPE_CHAR, 16, 8 },
+        { "param_type", MAVLINK_TYPE_UINT8_T, 0, 24 },
+    };
+    static const FieldLayout fields_param_set[] = {
+        { "param_value", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 5 },
+        { "param_id", MAVLINK_TYPE_CHAR, 16, 6 },
+        { "param_type", MAVLINK_TYPE_UINT8_T, 0, 22 },
+    };
+    static const FieldLayout fields_gps_raw_int[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 12 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 16 },
+        { "eph", MAVLINK_TYPE_UINT16_T, 0, 20 },
+        { "epv", MAVLINK_TYPE_UINT16_T, 0, 22 },
+        { "vel", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "cog", MAVLINK_TYPE_UINT16_T, 0, 26 },
+        { "fix_type", MAVLINK_TYPE_UINT8_T, 0, 28 },
+        { "satellites_visible", MAVLINK_TYPE_UINT8_T, 0, 29 },
+    };
+    static const FieldLayout fields_gps_status[] = {
+        { "satellites_visible", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "satellite_prn", MAVLINK_TYPE_UINT8_T, 20, 1 },
+        { "satellite_used", MAVLINK_TYPE_UINT8_T, 20, 21 },
+        { "satellite_elevation", MAVLINK_TYPE_UINT8_T, 20, 41 },
+        { "satellite_azimuth", MAVLINK_TYPE_UINT8_T, 20, 61 },
+        { "satellite_snr", MAVLINK_TYPE_UINT8_T, 20, 81 },
+    };
+    static const FieldLayout fields_scaled_imu[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "xacc", MAVLINK_TYPE_INT16_T, 0, 4 },
+        { "yacc", MAVLINK_TYPE_INT16_T, 0, 6 },
+        { "zacc", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "xgyro", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "ygyro", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "zgyro", MAVLINK_TYPE_INT16_T, 0, 14 },
+        { "xmag", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "ymag", MAVLINK_TYPE_INT16_T, 0, 18 },
+        { "zmag", MAVLINK_TYPE_INT16_T, 0, 20 },
+    };
+    static const FieldLayout fields_raw_imu[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "xacc", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "yacc", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "zacc", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "xgyro", MAVLINK_TYPE_INT16_T, 0, 14 },
+        { "ygyro", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "zgyro", MAVLINK_TYPE_INT16_T, 0, 18 },
+        { "xmag", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "ymag", MAVLINK_TYPE_INT16_T, 0, 22 },
+        { "zmag", MAVLINK_TYPE_INT16_T, 0, 24 },
+    };
+    static const FieldLayout fields_raw_pressure[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "press_abs", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "press_diff1", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "press_diff2", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "temperature", MAVLINK_TYPE_INT16_T, 0, 14 },
+    };
+    static const FieldLayout fields_scaled_pressure[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "press_abs", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "press_diff", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "temperature", MAVLINK_TYPE_INT16_T, 0, 12 },
+    };
+    static const FieldLayout fields_attitude[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "rollspeed", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "pitchspeed", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "yawspeed", MAVLINK_TYPE_FLOAT, 0, 24 },
+    };
+    static const FieldLayout fields_attitude_quaternion[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "q1", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "q2", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "q3", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "q4", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "rollspeed", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "pitchspeed", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "yawspeed", MAVLINK_TYPE_FLOAT, 0, 28 },
+    };
+    static const FieldLayout fields_local_position_ned[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "vx", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "vy", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "vz", MAVLINK_TYPE_FLOAT, 0, 24 },
+    };
+    static const FieldLayout fields_global_position_int[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 12 },
+        { "relative_alt", MAVLINK_TYPE_INT32_T, 0, 16 },
+        { "vx", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "vy", MAVLINK_TYPE_INT16_T, 0, 22 },
+        { "vz", MAVLINK_TYPE_INT16_T, 0, 24 },
+        { "hdg", MAVLINK_TYPE_UINT16_T, 0, 26 },
+    };
+    static const FieldLayout fields_rc_channels_scaled[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "chan1_scaled", MAVLINK_TYPE_INT16_T, 0, 4 },
+        { "chan2_scaled", MAVLINK_TYPE_INT16_T, 0, 6 },
+        { "chan3_scaled", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "chan4_scaled", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "chan5_scaled", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "chan6_scaled", MAVLINK_TYPE_INT16_T, 0, 14 },
+        { "chan7_scaled", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "chan8_scaled", MAVLINK_TYPE_INT16_T, 0, 18 },
+        { "port", MAVLINK_TYPE_UINT8_T, 0, 20 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 21 },
+    };
+    static const FieldLayout fields_rc_channels_raw[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "chan1_raw", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "chan2_raw", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "chan3_raw", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "chan4_raw", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "chan5_raw", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "chan6_raw", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "chan7_raw", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "chan8_raw", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "port", MAVLINK_TYPE_UINT8_T, 0, 20 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 21 },
+    };
+    static const FieldLayout fields_servo_output_raw[] = {
+        { "time_usec", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "servo1_raw", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "servo2_raw", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "servo3_raw", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "servo4_raw", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "servo5_raw", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "servo6_raw", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "servo7_raw", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "servo8_raw", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "port", MAVLINK_TYPE_UINT8_T, 0, 20 },
+    };
+    static const FieldLayout fields_mission_request_partial_list[] = {
+        { "start_index", MAVLINK_TYPE_INT16_T, 0, 0 },
+        { "end_index", MAVLINK_TYPE_INT16_T, 0, 2 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_mission_write_partial_list[] = {
+        { "start_index", MAVLINK_TYPE_INT16_T, 0, 0 },
+        { "end_index", MAVLINK_TYPE_INT16_T, 0, 2 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_mission_item[] = {
+        { "param1", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "param2", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "param3", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "param4", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "seq", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "command", MAVLINK_TYPE_UINT16_T, 0, 30 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 32 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 33 },
+        { "frame", MAVLINK_TYPE_UINT8_T, 0, 34 },
+        { "current", MAVLINK_TYPE_UINT8_T, 0, 35 },
+        { "autocontinue", MAVLINK_TYPE_UINT8_T, 0, 36 },
+    };
+    static const FieldLayout fields_mission_request[] = {
+        { "seq", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 3 },
+    };
+    static const FieldLayout fields_mission_set_current[] = {
+        { "seq", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 3 },
+    };
+    static const FieldLayout fields_mission_current[] = {
+        { "seq", MAVLINK_TYPE_UINT16_T, 0, 0 },
+    };
+    static const FieldLayout fields_mission_request_list[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+    };
+    static const FieldLayout fields_mission_count[] = {
+        { "count", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 3 },
+    };
+    static const FieldLayout fields_mission_clear_all[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+    };
+    static const FieldLayout fields_mission_item_reached[] = {
+        { "seq", MAVLINK_TYPE_UINT16_T, 0, 0 },
+    };
+    static const FieldLayout fields_mission_ack[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_set_gps_global_origin[] = {
+        { "latitude", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "longitude", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "altitude", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 12 },
+    };
+    static const FieldLayout fields_gps_global_origin[] = {
+        { "latitude", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "longitude", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "altitude", MAVLINK_TYPE_INT32_T, 0, 8 },
+    };
+    static const FieldLayout fields_set_local_position_setpoint[] = {
+        { "x", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 16 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 17 },
+        { "coordinate_frame", MAVLINK_TYPE_UINT8_T, 0, 18 },
+    };
+    static const FieldLayout fields_local_position_setpoint[] = {
+        { "x", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "coordinate_frame", MAVLINK_TYPE_UINT8_T, 0, 16 },
+    };
+    static const FieldLayout fields_global_position_setpoint_int[] = {
+        { "latitude", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "longitude", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "altitude", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "yaw", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "coordinate_frame", MAVLINK_TYPE_UINT8_T, 0, 14 },
+    };
+    static const FieldLayout fields_set_global_position_setpoint_int[] = {
+        { "latitude", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "longitude", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "altitude", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "yaw", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "coordinate_frame", MAVLINK_TYPE_UINT8_T, 0, 14 },
+    };
+    static const FieldLayout fields_safety_set_allowed_area[] = {
+        { "p1x", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "p1y", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "p1z", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "p2x", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "p2y", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "p2z", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 24 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 25 },
+        { "frame", MAVLINK_TYPE_UINT8_T, 0, 26 },
+    };
+    static const FieldLayout fields_safety_allowed_area[] = {
+        { "p1x", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "p1y", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "p1z", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "p2x", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "p2y", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "p2z", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "frame", MAVLINK_TYPE_UINT8_T, 0, 24 },
+    };
+    static const FieldLayout fields_set_roll_pitch_yaw_thrust[] = {
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 16 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 17 },
+    };
+    static const FieldLayout fields_set_roll_pitch_yaw_speed_thrust[] = {
+        { "roll_speed", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "pitch_speed", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "yaw_speed", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 16 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 17 },
+    };
+    static const FieldLayout fields_roll_pitch_yaw_thrust_setpoint[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 16 },
+    };
+    static const FieldLayout fields_roll_pitch_yaw_speed_thrust_setpoint[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "roll_speed", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "pitch_speed", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw_speed", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 16 },
+    };
+    static const FieldLayout fields_set_quad_motors_setpoint[] = {
+        { "motor_front_nw", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "motor_right_ne", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "motor_back_se", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "motor_left_sw", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const FieldLayout fields_set_quad_swarm_roll_pitch_yaw_thrust[] = {
+        { "roll", MAVLINK_TYPE_INT16_T, 4, 0 },
+        { "pitch", MAVLINK_TYPE_INT16_T, 4, 8 },
+        { "yaw", MAVLINK_TYPE_INT16_T, 4, 16 },
+        { "thrust", MAVLINK_TYPE_UINT16_T, 4, 24 },
+        { "group", MAVLINK_TYPE_UINT8_T, 0, 32 },
+        { "mode", MAVLINK_TYPE_UINT8_T, 0, 33 },
+    };
+    static const FieldLayout fields_nav_controller_output[] = {
+        { "nav_roll", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "nav_pitch", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "alt_error", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "aspd_error", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "xtrack_error", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "nav_bearing", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "target_bearing", MAVLINK_TYPE_INT16_T, 0, 22 },
+        { "wp_dist", MAVLINK_TYPE_UINT16_T, 0, 24 },
+    };
+    static const FieldLayout fields_set_quad_swarm_led_roll_pitch_yaw_thrust[] = {
+        { "roll", MAVLINK_TYPE_INT16_T, 4, 0 },
+        { "pitch", MAVLINK_TYPE_INT16_T, 4, 8 },
+        { "yaw", MAVLINK_TYPE_INT16_T, 4, 16 },
+        { "thrust", MAVLINK_TYPE_UINT16_T, 4, 24 },
+        { "group", MAVLINK_TYPE_UINT8_T, 0, 32 },
+        { "mode", MAVLINK_TYPE_UINT8_T, 0, 33 },
+        { "led_red", MAVLINK_TYPE_UINT8_T, 4, 34 },
+        { "led_blue", MAVLINK_TYPE_UINT8_T, 4, 38 },
+        { "led_green", MAVLINK_TYPE_UINT8_T, 4, 42 },
+    };
+    static const FieldLayout fields_state_correction[] = {
+        { "xErr", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "yErr", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "zErr", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "rollErr", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "pitchErr", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "yawErr", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "vxErr", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "vyErr", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "vzErr", MAVLINK_TYPE_FLOAT, 0, 32 },
+    };
+    static const FieldLayout fields_rc_channels[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "chan1_raw", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "chan2_raw", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "chan3_raw", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "chan4_raw", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "chan5_raw", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "chan6_raw", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "chan7_raw", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "chan8_raw", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "chan9_raw", MAVLINK_TYPE_UINT16_T, 0, 20 },
+        { "chan10_raw", MAVLINK_TYPE_UINT16_T, 0, 22 },
+        { "chan11_raw", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "chan12_raw", MAVLINK_TYPE_UINT16_T, 0, 26 },
+        { "chan13_raw", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "chan14_raw", MAVLINK_TYPE_UINT16_T, 0, 30 },
+        { "chan15_raw", MAVLINK_TYPE_UINT16_T, 0, 32 },
+        { "chan16_raw", MAVLINK_TYPE_UINT16_T, 0, 34 },
+        { "chan17_raw", MAVLINK_TYPE_UINT16_T, 0, 36 },
+        { "chan18_raw", MAVLINK_TYPE_UINT16_T, 0, 38 },
+        { "chancount", MAVLINK_TYPE_UINT8_T, 0, 40 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 41 },
+    };
+    static const FieldLayout fields_request_data_stream[] = {
+        { "req_message_rate", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 3 },
+        { "req_stream_id", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "start_stop", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_data_stream[] = {
+        { "message_rate", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "stream_id", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "on_off", MAVLINK_TYPE_UINT8_T, 0, 3 },
+    };
+    static const FieldLayout fields_manual_control[] = {
+        { "x", MAVLINK_TYPE_INT16_T, 0, 0 },
+        { "y", MAVLINK_TYPE_INT16_T, 0, 2 },
+        { "z", MAVLINK_TYPE_INT16_T, 0, 4 },
+        { "r", MAVLINK_TYPE_INT16_T, 0, 6 },
+        { "buttons", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "target", MAVLINK_TYPE_UINT8_T, 0, 10 },
+    };
+    static const FieldLayout fields_rc_channels_override[] = {
+        { "chan1_raw", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "chan2_raw", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "chan3_raw", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "chan4_raw", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "chan5_raw", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "chan6_raw", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "chan7_raw", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "chan8_raw", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 16 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 17 },
+    };
+    static const FieldLayout fields_vfr_hud[] = {
+        { "airspeed", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "groundspeed", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "alt", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "climb", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "heading", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "throttle", MAVLINK_TYPE_UINT16_T, 0, 18 },
+    };
+    static const FieldLayout fields_command_long[] = {
+        { "param1", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "param2", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "param3", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "param4", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "param5", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "param6", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "param7", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "command", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 30 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 31 },
+        { "confirmation", MAVLINK_TYPE_UINT8_T, 0, 32 },
+    };
+    static const FieldLayout fields_command_ack[] = {
+        { "command", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "result", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_roll_pitch_yaw_rates_thrust_setpoint[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "roll_rate", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "pitch_rate", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw_rate", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 16 },
+    };
+    static const FieldLayout fields_manual_setpoint[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "thrust", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "mode_switch", MAVLINK_TYPE_UINT8_T, 0, 20 },
+        { "manual_override_switch", MAVLINK_TYPE_UINT8_T, 0, 21 },
+    };
+    static const FieldLayout fields_local_position_ned_system_global_offset[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 24 },
+    };
+    static const FieldLayout fields_hil_state[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "rollspeed", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "pitchspeed", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "yawspeed", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 32 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 36 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 40 },
+        { "vx", MAVLINK_TYPE_INT16_T, 0, 44 },
+        { "vy", MAVLINK_TYPE_INT16_T, 0, 46 },
+        { "vz", MAVLINK_TYPE_INT16_T, 0, 48 },
+        { "xacc", MAVLINK_TYPE_INT16_T, 0, 50 },
+        { "yacc", MAVLINK_TYPE_INT16_T, 0, 52 },
+        { "zacc", MAVLINK_TYPE_INT16_T, 0, 54 },
+    };
+    static const FieldLayout fields_hil_controls[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "roll_ailerons", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "pitch_elevator", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "yaw_rudder", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "throttle", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "aux1", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "aux2", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "aux3", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "aux4", MAVLINK_TYPE_FLOAT, 0, 36 },
+        { "mode", MAVLINK_TYPE_UINT8_T, 0, 40 },
+        { "nav_mode", MAVLINK_TYPE_UINT8_T, 0, 41 },
+    };
+    static const FieldLayout fields_hil_rc_inputs_raw[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "chan1_raw", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "chan2_raw", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "chan3_raw", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "chan4_raw", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "chan5_raw", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "chan6_raw", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "chan7_raw", MAVLINK_TYPE_UINT16_T, 0, 20 },
+        { "chan8_raw", MAVLINK_TYPE_UINT16_T, 0, 22 },
+        { "chan9_raw", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "chan10_raw", MAVLINK_TYPE_UINT16_T, 0, 26 },
+        { "chan11_raw", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "chan12_raw", MAVLINK_TYPE_UINT16_T, 0, 30 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 32 },
+    };
+    static const FieldLayout fields_optical_flow[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "flow_comp_m_x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "flow_comp_m_y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "ground_distance", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "flow_x", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "flow_y", MAVLINK_TYPE_INT16_T, 0, 22 },
+        { "sensor_id", MAVLINK_TYPE_UINT8_T, 0, 24 },
+        { "quality", MAVLINK_TYPE_UINT8_T, 0, 25 },
+    };
+    static const FieldLayout fields_global_vision_position_estimate[] = {
+        { "usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 28 },
+    };
+    static const FieldLayout fields_vision_position_estimate[] = {
+        { "usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 28 },
+    };
+    static const FieldLayout fields_vision_speed_estimate[] = {
+        { "usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 16 },
+    };
+    static const FieldLayout fields_vicon_position_estimate[] = {
+        { "usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 28 },
+    };
+    static const FieldLayout fields_highres_imu[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "xacc", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yacc", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "zacc", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "xgyro", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "ygyro", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "zgyro", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "xmag", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "ymag", MAVLINK_TYPE_FLOAT, 0, 36 },
+        { "zmag", MAVLINK_TYPE_FLOAT, 0, 40 },
+        { "abs_pressure", MAVLINK_TYPE_FLOAT, 0, 44 },
+        { "diff_pressure", MAVLINK_TYPE_FLOAT, 0, 48 },
+        { "pressure_alt", MAVLINK_TYPE_FLOAT, 0, 52 },
+        { "temperature", MAVLINK_TYPE_FLOAT, 0, 56 },
+        { "fields_updated", MAVLINK_TYPE_UINT16_T, 0, 60 },
+    };
+    static const FieldLayout fields_omnidirectional_flow[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "front_distance_m", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "left", MAVLINK_TYPE_INT16_T, 10, 12 },
+        { "right", MAVLINK_TYPE_INT16_T, 10, 32 },
+        { "sensor_id", MAVLINK_TYPE_UINT8_T, 0, 52 },
+        { "quality", MAVLINK_TYPE_UINT8_T, 0, 53 },
+    };
+    static const FieldLayout fields_hil_sensor[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "xacc", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "yacc", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "zacc", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "xgyro", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "ygyro", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "zgyro", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "xmag", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "ymag", MAVLINK_TYPE_FLOAT, 0, 36 },
+        { "zmag", MAVLINK_TYPE_FLOAT, 0, 40 },
+        { "abs_pressure", MAVLINK_TYPE_FLOAT, 0, 44 },
+        { "diff_pressure", MAVLINK_TYPE_FLOAT, 0, 48 },
+        { "pressure_alt", MAVLINK_TYPE_FLOAT, 0, 52 },
+        { "temperature", MAVLINK_TYPE_FLOAT, 0, 56 },
+        { "fields_updated", MAVLINK_TYPE_UINT32_T, 0, 60 },
+    };
+    static const FieldLayout fields_sim_state[] = {
+        { "q1", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "q2", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "q3", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "q4", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "xacc", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "yacc", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "zacc", MAVLINK_TYPE_FLOAT, 0, 36 },
+        { "xgyro", MAVLINK_TYPE_FLOAT, 0, 40 },
+        { "ygyro", MAVLINK_TYPE_FLOAT, 0, 44 },
+        { "zgyro", MAVLINK_TYPE_FLOAT, 0, 48 },
+        { "lat", MAVLINK_TYPE_FLOAT, 0, 52 },
+        { "lon", MAVLINK_TYPE_FLOAT, 0, 56 },
+        { "alt", MAVLINK_TYPE_FLOAT, 0, 60 },
+        { "std_dev_horz", MAVLINK_TYPE_FLOAT, 0, 64 },
+        { "std_dev_vert", MAVLINK_TYPE_FLOAT, 0, 68 },
+        { "vn", MAVLINK_TYPE_FLOAT, 0, 72 },
+        { "ve", MAVLINK_TYPE_FLOAT, 0, 76 },
+        { "vd", MAVLINK_TYPE_FLOAT, 0, 80 },
+    };
+    static const FieldLayout fields_radio_status[] = {
+        { "rxerrors", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "fixed", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "remrssi", MAVLINK_TYPE_UINT8_T, 0, 5 },
+        { "txbuf", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "noise", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "remnoise", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const FieldLayout fields_file_transfer_start[] = {
+        { "transfer_uid", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "file_size", MAVLINK_TYPE_UINT32_T, 0, 8 },
+        { "dest_path", MAVLINK_TYPE_CHAR, 240, 12 },
+        { "direction", MAVLINK_TYPE_UINT8_T, 0, 252 },
+        { "flags", MAVLINK_TYPE_UINT8_T, 0, 253 },
+    };
+    static const FieldLayout fields_file_transfer_dir_list[] = {
+        { "transfer_uid", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "dir_path", MAVLINK_TYPE_CHAR, 240, 8 },
+        { "flags", MAVLINK_TYPE_UINT8_T, 0, 248 },
+    };
+    static const FieldLayout fields_file_transfer_res[] = {
+        { "transfer_uid", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "result", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const FieldLayout fields_hil_gps[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 12 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 16 },
+        { "eph", MAVLINK_TYPE_UINT16_T, 0, 20 },
+        { "epv", MAVLINK_TYPE_UINT16_T, 0, 22 },
+        { "vel", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "vn", MAVLINK_TYPE_INT16_T, 0, 26 },
+        { "ve", MAVLINK_TYPE_INT16_T, 0, 28 },
+        { "vd", MAVLINK_TYPE_INT16_T, 0, 30 },
+        { "cog", MAVLINK_TYPE_UINT16_T, 0, 32 },
+        { "fix_type", MAVLINK_TYPE_UINT8_T, 0, 34 },
+        { "satellites_visible", MAVLINK_TYPE_UINT8_T, 0, 35 },
+    };
+    static const FieldLayout fields_hil_optical_flow[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "flow_comp_m_x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "flow_comp_m_y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "ground_distance", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "flow_x", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "flow_y", MAVLINK_TYPE_INT16_T, 0, 22 },
+        { "sensor_id", MAVLINK_TYPE_UINT8_T, 0, 24 },
+        { "quality", MAVLINK_TYPE_UINT8_T, 0, 25 },
+    };
+    static const FieldLayout fields_hil_state_quaternion[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "attitude_quaternion", MAVLINK_TYPE_FLOAT, 4, 8 },
+        { "rollspeed", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "pitchspeed", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "yawspeed", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 36 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 40 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 44 },
+        { "vx", MAVLINK_TYPE_INT16_T, 0, 48 },
+        { "vy", MAVLINK_TYPE_INT16_T, 0, 50 },
+        { "vz", MAVLINK_TYPE_INT16_T, 0, 52 },
+        { "ind_airspeed", MAVLINK_TYPE_UINT16_T, 0, 54 },
+        { "true_airspeed", MAVLINK_TYPE_UINT16_T, 0, 56 },
+        { "xacc", MAVLINK_TYPE_INT16_T, 0, 58 },
+        { "yacc", MAVLINK_TYPE_INT16_T, 0, 60 },
+        { "zacc", MAVLINK_TYPE_INT16_T, 0, 62 },
+    };
+    static const FieldLayout fields_scaled_imu2[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "xacc", MAVLINK_TYPE_INT16_T, 0, 4 },
+        { "yacc", MAVLINK_TYPE_INT16_T, 0, 6 },
+        { "zacc", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "xgyro", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "ygyro", MAVLINK_TYPE_INT16_T, 0, 12 },
+        { "zgyro", MAVLINK_TYPE_INT16_T, 0, 14 },
+        { "xmag", MAVLINK_TYPE_INT16_T, 0, 16 },
+        { "ymag", MAVLINK_TYPE_INT16_T, 0, 18 },
+        { "zmag", MAVLINK_TYPE_INT16_T, 0, 20 },
+    };
+    static const FieldLayout fields_log_request_list[] = {
+        { "start", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "end", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_log_entry[] = {
+        { "time_utc", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "size", MAVLINK_TYPE_UINT32_T, 0, 4 },
+        { "id", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "num_logs", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "last_log_num", MAVLINK_TYPE_UINT16_T, 0, 12 },
+    };
+    static const FieldLayout fields_log_request_data[] = {
+        { "ofs", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "count", MAVLINK_TYPE_UINT32_T, 0, 4 },
+        { "id", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 10 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 11 },
+    };
+    static const FieldLayout fields_log_data[] = {
+        { "ofs", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "id", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "count", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "data", MAVLINK_TYPE_UINT8_T, 90, 7 },
+    };
+    static const FieldLayout fields_log_erase[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+    };
+    static const FieldLayout fields_log_request_end[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+    };
+    static const FieldLayout fields_gps_inject_data[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "len", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "data", MAVLINK_TYPE_UINT8_T, 110, 3 },
+    };
+    static const FieldLayout fields_gps2_raw[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "lon", MAVLINK_TYPE_INT32_T, 0, 12 },
+        { "alt", MAVLINK_TYPE_INT32_T, 0, 16 },
+        { "dgps_age", MAVLINK_TYPE_UINT32_T, 0, 20 },
+        { "eph", MAVLINK_TYPE_UINT16_T, 0, 24 },
+        { "epv", MAVLINK_TYPE_UINT16_T, 0, 26 },
+        { "vel", MAVLINK_TYPE_UINT16_T, 0, 28 },
+        { "cog", MAVLINK_TYPE_UINT16_T, 0, 30 },
+        { "fix_type", MAVLINK_TYPE_UINT8_T, 0, 32 },
+        { "satellites_visible", MAVLINK_TYPE_UINT8_T, 0, 33 },
+        { "dgps_numch", MAVLINK_TYPE_UINT8_T, 0, 34 },
+    };
+    static const FieldLayout fields_power_status[] = {
+        { "Vcc", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "Vservo", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "flags", MAVLINK_TYPE_UINT16_T, 0, 4 },
+    };
+    static const FieldLayout fields_serial_control[] = {
+        { "baudrate", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "timeout", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "device", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "flags", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "count", MAVLINK_TYPE_UINT8_T, 0, 8 },
+        { "data", MAVLINK_TYPE_UINT8_T, 70, 9 },
+    };
+    static const FieldLayout fields_data_transmission_handshake[] = {
+        { "size", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "width", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "height", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "packets", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 10 },
+        { "payload", MAVLINK_TYPE_UINT8_T, 0, 11 },
+        { "jpg_quality", MAVLINK_TYPE_UINT8_T, 0, 12 },
+    };
+    static const FieldLayout fields_encapsulated_data[] = {
+        { "seqnr", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "data", MAVLINK_TYPE_UINT8_T, 253, 2 },
+    };
+    static const FieldLayout fields_battery_status[] = {
+        { "current_consumed", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "energy_consumed", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "voltage_cell_1", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "voltage_cell_2", MAVLINK_TYPE_UINT16_T, 0, 10 },
+        { "voltage_cell_3", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "voltage_cell_4", MAVLINK_TYPE_UINT16_T, 0, 14 },
+        { "voltage_cell_5", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "voltage_cell_6", MAVLINK_TYPE_UINT16_T, 0, 18 },
+        { "current_battery", MAVLINK_TYPE_INT16_T, 0, 20 },
+        { "accu_id", MAVLINK_TYPE_UINT8_T, 0, 22 },
+        { "battery_remaining", MAVLINK_TYPE_INT8_T, 0, 23 },
+    };
+    static const FieldLayout fields_setpoint_8dof[] = {
+        { "val1", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "val2", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "val3", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "val4", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "val5", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "val6", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "val7", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "val8", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 32 },
+    };
+    static const FieldLayout fields_setpoint_6dof[] = {
+        { "trans_x", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "trans_y", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "trans_z", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "rot_x", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "rot_y", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "rot_z", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 24 },
+    };
+    static const FieldLayout fields_sensor_offsets[] = {
+        { "mag_declination", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "raw_press", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "raw_temp", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "gyro_cal_x", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "gyro_cal_y", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "gyro_cal_z", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "accel_cal_x", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "accel_cal_y", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "accel_cal_z", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "mag_ofs_x", MAVLINK_TYPE_INT16_T, 0, 36 },
+        { "mag_ofs_y", MAVLINK_TYPE_INT16_T, 0, 38 },
+        { "mag_ofs_z", MAVLINK_TYPE_INT16_T, 0, 40 },
+    };
+    static const FieldLayout fields_set_mag_offsets[] = {
+        { "mag_ofs_x", MAVLINK_TYPE_INT16_T, 0, 0 },
+        { "mag_ofs_y", MAVLINK_TYPE_INT16_T, 0, 2 },
+        { "mag_ofs_z", MAVLINK_TYPE_INT16_T, 0, 4 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 7 },
+    };
+    static const FieldLayout fields_meminfo[] = {
+        { "brkval", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "freemem", MAVLINK_TYPE_UINT16_T, 0, 2 },
+    };
+    static const FieldLayout fields_ap_adc[] = {
+        { "adc1", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "adc2", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "adc3", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "adc4", MAVLINK_TYPE_UINT16_T, 0, 6 },
+        { "adc5", MAVLINK_TYPE_UINT16_T, 0, 8 },
+        { "adc6", MAVLINK_TYPE_UINT16_T, 0, 10 },
+    };
+    static const FieldLayout fields_digicam_configure[] = {
+        { "extra_value", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "shutter_speed", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "mode", MAVLINK_TYPE_UINT8_T, 0, 8 },
+        { "aperture", MAVLINK_TYPE_UINT8_T, 0, 9 },
+        { "iso", MAVLINK_TYPE_UINT8_T, 0, 10 },
+        { "exposure_type", MAVLINK_TYPE_UINT8_T, 0, 11 },
+        { "command_id", MAVLINK_TYPE_UINT8_T, 0, 12 },
+        { "engine_cut_off", MAVLINK_TYPE_UINT8_T, 0, 13 },
+        { "extra_param", MAVLINK_TYPE_UINT8_T, 0, 14 },
+    };
+    static const FieldLayout fields_digicam_control[] = {
+        { "extra_value", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 5 },
+        { "session", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "zoom_pos", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "zoom_step", MAVLINK_TYPE_INT8_T, 0, 8 },
+        { "focus_lock", MAVLINK_TYPE_UINT8_T, 0, 9 },
+        { "shot", MAVLINK_TYPE_UINT8_T, 0, 10 },
+        { "command_id", MAVLINK_TYPE_UINT8_T, 0, 11 },
+        { "extra_param", MAVLINK_TYPE_UINT8_T, 0, 12 },
+    };
+    static const FieldLayout fields_mount_configure[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "mount_mode", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "stab_roll", MAVLINK_TYPE_UINT8_T, 0, 3 },
+        { "stab_pitch", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "stab_yaw", MAVLINK_TYPE_UINT8_T, 0, 5 },
+    };
+    static const FieldLayout fields_mount_control[] = {
+        { "input_a", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "input_b", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "input_c", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 12 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 13 },
+        { "save_position", MAVLINK_TYPE_UINT8_T, 0, 14 },
+    };
+    static const FieldLayout fields_mount_status[] = {
+        { "pointing_a", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "pointing_b", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "pointing_c", MAVLINK_TYPE_INT32_T, 0, 8 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 12 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 13 },
+    };
+    static const FieldLayout fields_fence_point[] = {
+        { "lat", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "lng", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 8 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 9 },
+        { "idx", MAVLINK_TYPE_UINT8_T, 0, 10 },
+        { "count", MAVLINK_TYPE_UINT8_T, 0, 11 },
+    };
+    static const FieldLayout fields_fence_fetch_point[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "idx", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_fence_status[] = {
+        { "breach_time", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "breach_count", MAVLINK_TYPE_UINT16_T, 0, 4 },
+        { "breach_status", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "breach_type", MAVLINK_TYPE_UINT8_T, 0, 7 },
+    };
+    static const FieldLayout fields_ahrs[] = {
+        { "omegaIx", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "omegaIy", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "omegaIz", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "accel_weight", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "renorm_val", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "error_rp", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "error_yaw", MAVLINK_TYPE_FLOAT, 0, 24 },
+    };
+    static const FieldLayout fields_simstate[] = {
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "xacc", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "yacc", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "zacc", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "xgyro", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "ygyro", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "zgyro", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 36 },
+        { "lng", MAVLINK_TYPE_INT32_T, 0, 40 },
+    };
+    static const FieldLayout fields_hwstatus[] = {
+        { "Vcc", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "I2Cerr", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_radio[] = {
+        { "rxerrors", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "fixed", MAVLINK_TYPE_UINT16_T, 0, 2 },
+        { "rssi", MAVLINK_TYPE_UINT8_T, 0, 4 },
+        { "remrssi", MAVLINK_TYPE_UINT8_T, 0, 5 },
+        { "txbuf", MAVLINK_TYPE_UINT8_T, 0, 6 },
+        { "noise", MAVLINK_TYPE_UINT8_T, 0, 7 },
+        { "remnoise", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const FieldLayout fields_limits_status[] = {
+        { "last_trigger", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "last_action", MAVLINK_TYPE_UINT32_T, 0, 4 },
+        { "last_recovery", MAVLINK_TYPE_UINT32_T, 0, 8 },
+        { "last_clear", MAVLINK_TYPE_UINT32_T, 0, 12 },
+        { "breach_count", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "limits_state", MAVLINK_TYPE_UINT8_T, 0, 18 },
+        { "mods_enabled", MAVLINK_TYPE_UINT8_T, 0, 19 },
+        { "mods_required", MAVLINK_TYPE_UINT8_T, 0, 20 },
+        { "mods_triggered", MAVLINK_TYPE_UINT8_T, 0, 21 },
+    };
+    static const FieldLayout fields_wind[] = {
+        { "direction", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "speed", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "speed_z", MAVLINK_TYPE_FLOAT, 0, 8 },
+    };
+    static const FieldLayout fields_data16[] = {
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "len", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "data", MAVLINK_TYPE_UINT8_T, 16, 2 },
+    };
+    static const FieldLayout fields_data32[] = {
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "len", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "data", MAVLINK_TYPE_UINT8_T, 32, 2 },
+    };
+    static const FieldLayout fields_data64[] = {
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "len", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "data", MAVLINK_TYPE_UINT8_T, 64, 2 },
+    };
+    static const FieldLayout fields_data96[] = {
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "len", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "data", MAVLINK_TYPE_UINT8_T, 96, 2 },
+    };
+    static const FieldLayout fields_rangefinder[] = {
+        { "distance", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "voltage", MAVLINK_TYPE_FLOAT, 0, 4 },
+    };
+    static const FieldLayout fields_airspeed_autocal[] = {
+        { "vx", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "vy", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "vz", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "diff_pressure", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "EAS2TAS", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "ratio", MAVLINK_TYPE_FLOAT, 0, 20 },
+        { "state_x", MAVLINK_TYPE_FLOAT, 0, 24 },
+        { "state_y", MAVLINK_TYPE_FLOAT, 0, 28 },
+        { "state_z", MAVLINK_TYPE_FLOAT, 0, 32 },
+        { "Pax", MAVLINK_TYPE_FLOAT, 0, 36 },
+        { "Pby", MAVLINK_TYPE_FLOAT, 0, 40 },
+        { "Pcz", MAVLINK_TYPE_FLOAT, 0, 44 },
+    };
+    static const FieldLayout fields_rally_point[] = {
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 0 },
+        { "lng", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "alt", MAVLINK_TYPE_INT16_T, 0, 8 },
+        { "break_alt", MAVLINK_TYPE_INT16_T, 0, 10 },
+        { "land_dir", MAVLINK_TYPE_UINT16_T, 0, 12 },
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 14 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 15 },
+        { "idx", MAVLINK_TYPE_UINT8_T, 0, 16 },
+        { "count", MAVLINK_TYPE_UINT8_T, 0, 17 },
+        { "flags", MAVLINK_TYPE_UINT8_T, 0, 18 },
+    };
+    static const FieldLayout fields_rally_fetch_point[] = {
+        { "target_system", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "target_component", MAVLINK_TYPE_UINT8_T, 0, 1 },
+        { "idx", MAVLINK_TYPE_UINT8_T, 0, 2 },
+    };
+    static const FieldLayout fields_compassmot_status[] = {
+        { "current", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "CompensationX", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "CompensationY", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "CompensationZ", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "throttle", MAVLINK_TYPE_UINT16_T, 0, 16 },
+        { "interference", MAVLINK_TYPE_UINT16_T, 0, 18 },
+    };
+    static const FieldLayout fields_ahrs2[] = {
+        { "roll", MAVLINK_TYPE_FLOAT, 0, 0 },
+        { "pitch", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "yaw", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "altitude", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "lat", MAVLINK_TYPE_INT32_T, 0, 16 },
+        { "lng", MAVLINK_TYPE_INT32_T, 0, 20 },
+    };
+    static const FieldLayout fields_memory_vect[] = {
+        { "address", MAVLINK_TYPE_UINT16_T, 0, 0 },
+        { "ver", MAVLINK_TYPE_UINT8_T, 0, 2 },
+        { "type", MAVLINK_TYPE_UINT8_T, 0, 3 },
+        { "value", MAVLINK_TYPE_INT8_T, 32, 4 },
+    };
+    static const FieldLayout fields_debug_vect[] = {
+        { "time_usec", MAVLINK_TYPE_UINT64_T, 0, 0 },
+        { "x", MAVLINK_TYPE_FLOAT, 0, 8 },
+        { "y", MAVLINK_TYPE_FLOAT, 0, 12 },
+        { "z", MAVLINK_TYPE_FLOAT, 0, 16 },
+        { "name", MAVLINK_TYPE_CHAR, 10, 20 },
+    };
+    static const FieldLayout fields_named_value_float[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "value", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "name", MAVLINK_TYPE_CHAR, 10, 8 },
+    };
+    static const FieldLayout fields_named_value_int[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "value", MAVLINK_TYPE_INT32_T, 0, 4 },
+        { "name", MAVLINK_TYPE_CHAR, 10, 8 },
+    };
+    static const FieldLayout fields_statustext[] = {
+        { "severity", MAVLINK_TYPE_UINT8_T, 0, 0 },
+        { "text", MAVLINK_TYPE_CHAR, 50, 1 },
+    };
+    static const FieldLayout fields_debug[] = {
+        { "time_boot_ms", MAVLINK_TYPE_UINT32_T, 0, 0 },
+        { "value", MAVLINK_TYPE_FLOAT, 0, 4 },
+        { "ind", MAVLINK_TYPE_UINT8_T, 0, 8 },
+    };
+    static const MessageLayout table[256] = {
+        { "HEARTBEAT", 9, 50, 6, fields_heartbeat },
+        { "SYS_STATUS", 31, 124, 13, fields_sys_status },
+        { "SYSTEM_TIME", 12, 137, 2, fields_system_time },
+        { 0, 0, 0, 0, 0 },
+        { "PING", 14, 237, 4, fields_ping },
+        { "CHANGE_OPERATOR_CONTROL", 28, 217, 4, fields_change_operator_control },
+        { "CHANGE_OPERATOR_CONTROL_ACK", 3, 104, 3, fields_change_operator_control_ack },
+        { "AUTH_KEY", 32, 119, 1, fields_auth_key },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "SET_MODE", 6, 89, 3, fields_set_mode },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "PARAM_REQUEST_READ", 20, 214, 4, fields_param_request_read },
+        { "PARAM_REQUEST_LIST", 2, 159, 2, fields_param_request_list },
+        { "PARAM_VALUE", 25, 220, 5, fields_param_value },
+        { "PARAM_SET", 23, 168, 5, fields_param_set },
+        { "GPS_RAW_INT", 30, 24, 10, fields_gps_raw_int },
+        { "GPS_STATUS", 101, 23, 6, fields_gps_status },
+        { "SCALED_IMU", 22, 170, 10, fields_scaled_imu },
+        { "RAW_IMU", 26, 144, 10, fields_raw_imu },
+        { "RAW_PRESSURE", 16, 67, 5, fields_raw_pressure },
+        { "SCALED_PRESSURE", 14, 115, 4, fields_scaled_pressure },
+        { "ATTITUDE", 28, 39, 7, fields_attitude },
+        { "ATTITUDE_QUATERNION", 32, 246, 8, fields_attitude_quaternion },
+        { "LOCAL_POSITION_NED", 28, 185, 7, fields_local_position_ned },
+        { "GLOBAL_POSITION_INT", 28, 104, 9, fields_global_position_int },
+        { "RC_CHANNELS_SCALED", 22, 237, 11, fields_rc_channels_scaled },
+        { "RC_CHANNELS_RAW", 22, 244, 11, fields_rc_channels_raw },
+        { "SERVO_OUTPUT_RAW", 21, 222, 10, fields_servo_output_raw },
+        { "MISSION_REQUEST_PARTIAL_LIST", 6, 212, 4, fields_mission_request_partial_list },
+        { "MISSION_WRITE_PARTIAL_LIST", 6, 9, 4, fields_mission_write_partial_list },
+        { "MISSION_ITEM", 37, 254, 14, fields_mission_item },
+        { "MISSION_REQUEST", 4, 230, 3, fields_mission_request },
+        { "MISSION_SET_CURRENT", 4, 28, 3, fields_mission_set_current },
+        { "MISSION_CURRENT", 2, 28, 1, fields_mission_current },
+        { "MISSION_REQUEST_LIST", 2, 132, 2, fields_mission_request_list },
+        { "MISSION_COUNT", 4, 221, 3, fields_mission_count },
+        { "MISSION_CLEAR_ALL", 2, 232, 2, fields_mission_clear_all },
+        { "MISSION_ITEM_REACHED", 2, 11, 1, fields_mission_item_reached },
+        { "MISSION_ACK", 3, 153, 3, fields_mission_ack },
+        { "SET_GPS_GLOBAL_ORIGIN", 13, 41, 4, fields_set_gps_global_origin },
+        { "GPS_GLOBAL_ORIGIN", 12, 39, 3, fields_gps_global_origin },
+        { "SET_LOCAL_POSITION_SETPOINT", 19, 214, 7, fields_set_local_position_setpoint },
+        { "LOCAL_POSITION_SETPOINT", 17, 223, 5, fields_local_position_setpoint },
+        { "GLOBAL_POSITION_SETPOINT_INT", 15, 141, 5, fields_global_position_setpoint_int },
+        { "SET_GLOBAL_POSITION_SETPOINT_INT", 15, 33, 5, fields_set_global_position_setpoint_int },
+        { "SAFETY_SET_ALLOWED_AREA", 27, 15, 9, fields_safety_set_allowed_area },
+        { "SAFETY_ALLOWED_AREA", 25, 3, 7, fields_safety_allowed_area },
+        { "SET_ROLL_PITCH_YAW_THRUST", 18, 100, 6, fields_set_roll_pitch_yaw_thrust },
+        { "SET_ROLL_PITCH_YAW_SPEED_THRUST", 18, 24, 6, fields_set_roll_pitch_yaw_speed_thrust },
+        { "ROLL_PITCH_YAW_THRUST_SETPOINT", 20, 239, 5, fields_roll_pitch_yaw_thrust_setpoint },
+        { "ROLL_PITCH_YAW_SPEED_THRUST_SETPOINT", 20, 238, 5, fields_roll_pitch_yaw_speed_thrust_setpoint },
+        { "SET_QUAD_MOTORS_SETPOINT", 9, 30, 5, fields_set_quad_motors_setpoint },
+        { "SET_QUAD_SWARM_ROLL_PITCH_YAW_THRUST", 34, 240, 6, fields_set_quad_swarm_roll_pitch_yaw_thrust },
+        { "NAV_CONTROLLER_OUTPUT", 26, 183, 8, fields_nav_controller_output },
+        { "SET_QUAD_SWARM_LED_ROLL_PITCH_YAW_THRUST", 46, 130, 9, fields_set_quad_swarm_led_roll_pitch_yaw_thrust },
+        { "STATE_CORRECTION", 36, 130, 9, fields_state_correction },
+        { "RC_CHANNELS", 42, 118, 21, fields_rc_channels },
+        { "REQUEST_DATA_STREAM", 6, 148, 5, fields_request_data_stream },
+        { "DATA_STREAM", 4, 21, 3, fields_data_stream },
+        { 0, 0, 0, 0, 0 },
+        { "MANUAL_CONTROL", 11, 243, 6, fields_manual_control },
+        { "RC_CHANNELS_OVERRIDE", 18, 124, 10, fields_rc_channels_override },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "VFR_HUD", 20, 20, 6, fields_vfr_hud },
+        { 0, 0, 0, 0, 0 },
+        { "COMMAND_LONG", 33, 152, 11, fields_command_long },
+        { "COMMAND_ACK", 3, 143, 2, fields_command_ack },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "ROLL_PITCH_YAW_RATES_THRUST_SETPOINT", 20, 127, 5, fields_roll_pitch_yaw_rates_thrust_setpoint },
+        { "MANUAL_SETPOINT", 22, 106, 7, fields_manual_setpoint },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "LOCAL_POSITION_NED_SYSTEM_GLOBAL_OFFSET", 28, 231, 7, fields_local_position_ned_system_global_offset },
+        { "HIL_STATE", 56, 183, 16, fields_hil_state },
+        { "HIL_CONTROLS", 42, 63, 11, fields_hil_controls },
+        { "HIL_RC_INPUTS_RAW", 33, 54, 14, fields_hil_rc_inputs_raw },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "OPTICAL_FLOW", 26, 175, 8, fields_optical_flow },
+        { "GLOBAL_VISION_POSITION_ESTIMATE", 32, 102, 7, fields_global_vision_position_estimate },
+        { "VISION_POSITION_ESTIMATE", 32, 158, 7, fields_vision_position_estimate },
+        { "VISION_SPEED_ESTIMATE", 20, 208, 4, fields_vision_speed_estimate },
+        { "VICON_POSITION_ESTIMATE", 32, 56, 7, fields_vicon_position_estimate },
+        { "HIGHRES_IMU", 62, 93, 15, fields_highres_imu },
+        { "OMNIDIRECTIONAL_FLOW", 54, 211, 6, fields_omnidirectional_flow },
+        { "HIL_SENSOR", 64, 108, 15, fields_hil_sensor },
+        { "SIM_STATE", 84, 32, 21, fields_sim_state },
+        { "RADIO_STATUS", 9, 185, 7, fields_radio_status },
+        { "FILE_TRANSFER_START", 254, 235, 5, fields_file_transfer_start },
+        { "FILE_TRANSFER_DIR_LIST", 249, 93, 3, fields_file_transfer_dir_list },
+        { "FILE_TRANSFER_RES", 9, 124, 2, fields_file_transfer_res },
+        { "HIL_GPS", 36, 124, 13, fields_hil_gps },
+        { "HIL_OPTICAL_FLOW", 26, 119, 8, fields_hil_optical_flow },
+        { "HIL_STATE_QUATERNION", 64, 4, 16, fields_hil_state_quaternion },
+        { "SCALED_IMU2", 22, 76, 10, fields_scaled_imu2 },
+        { "LOG_REQUEST_LIST", 6, 128, 4, fields_log_request_list },
+        { "LOG_ENTRY", 14, 56, 5, fields_log_entry },
+        { "LOG_REQUEST_DATA", 12, 116, 5, fields_log_request_data },
+        { "LOG_DATA", 97, 134, 4, fields_log_data },
+        { "LOG_ERASE", 2, 237, 2, fields_log_erase },
+        { "LOG_REQUEST_END", 2, 203, 2, fields_log_request_end },
+        { "GPS_INJECT_DATA", 113, 250, 4, fields_gps_inject_data },
+        { "GPS2_RAW", 35, 87, 12, fields_gps2_raw },
+        { "POWER_STATUS", 6, 203, 3, fields_power_status },
+        { "SERIAL_CONTROL", 79, 220, 6, fields_serial_control },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "DATA_TRANSMISSION_HANDSHAKE", 13, 29, 7, fields_data_transmission_handshake },
+        { "ENCAPSULATED_DATA", 255, 223, 2, fields_encapsulated_data },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "BATTERY_STATUS", 24, 177, 11, fields_battery_status },
+        { "SETPOINT_8DOF", 33, 241, 9, fields_setpoint_8dof },
+        { "SETPOINT_6DOF", 25, 15, 7, fields_setpoint_6dof },
+        { "SENSOR_OFFSETS", 42, 134, 12, fields_sensor_offsets },
+        { "SET_MAG_OFFSETS", 8, 219, 5, fields_set_mag_offsets },
+        { "MEMINFO", 4, 208, 2, fields_meminfo },
+        { "AP_ADC", 12, 188, 6, fields_ap_adc },
+        { "DIGICAM_CONFIGURE", 15, 84, 11, fields_digicam_configure },
+        { "DIGICAM_CONTROL", 13, 22, 10, fields_digicam_control },
+        { "MOUNT_CONFIGURE", 6, 19, 6, fields_mount_configure },
+        { "MOUNT_CONTROL", 15, 21, 6, fields_mount_control },
+        { "MOUNT_STATUS", 14, 134, 5, fields_mount_status },
+        { 0, 0, 0, 0, 0 },
+        { "FENCE_POINT", 12, 78, 6, fields_fence_point },
+        { "FENCE_FETCH_POINT", 3, 68, 3, fields_fence_fetch_point },
+        { "FENCE_STATUS", 8, 189, 4, fields_fence_status },
+        { "AHRS", 28, 127, 7, fields_ahrs },
+        { "SIMSTATE", 44, 154, 11, fields_simstate },
+        { "HWSTATUS", 3, 21, 2, fields_hwstatus },
+        { "RADIO", 9, 21, 7, fields_radio },
+        { "LIMITS_STATUS", 22, 144, 9, fields_limits_status },
+        { "WIND", 12, 1, 3, fields_wind },
+        { "DATA16", 18, 234, 3, fields_data16 },
+        { "DATA32", 34, 73, 3, fields_data32 },
+        { "DATA64", 66, 181, 3, fields_data64 },
+        { "DATA96", 98, 22, 3, fields_data96 },
+        { "RANGEFINDER", 8, 83, 2, fields_rangefinder },
+        { "AIRSPEED_AUTOCAL", 48, 167, 12, fields_airspeed_autocal },
+        { "RALLY_POINT", 19, 138, 10, fields_rally_point },
+        { "RALLY_FETCH_POINT", 3, 234, 3, fields_rally_fetch_point },
+        { "COMPASSMOT_STATUS", 20, 240, 6, fields_compassmot_status },
+        { "AHRS2", 24, 47, 6, fields_ahrs2 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0 },
+        { "MEMORY_VECT", 36, 204, 4, fields_memory_vect },
+        { "DEBUG_VECT", 30, 49, 5, fields_debug_vect },
+        { "NAMED_VALUE_FLOAT", 18, 170, 3, fields_named_value_float },
+        { "NAMED_VALUE_INT", 18, 44, 3, fields_named_value_int },
+        { "STATUSTEXT", 51, 83, 2, fields_statustext },
+        { "DEBUG", 9, 46, 3, fields_debug },
+        { 0, 0, 0, 0, 0 },
+    };
+    return table[msgid];
+}
+
+/**
+ * @brief The constants of every message ID, one read only array each
+ *
+ * For code that needs one value of many messages, e.g. framing or time
+ * stamping, so it touches a few cache lines instead of the message table.
+ */
+struct MessageTables
+{
+    uint8_t length[256];
+    uint8_t crcExtra[256];
+    uint8_t timeType[256];     ///< MAVLINK_TYPE_* of a leading time_boot_ms or *usec field, 0 without one
+    uint8_t timeOffset[256];
+};
+
+inline const MessageTables &messageTables()
+{
+    static const MessageTables tables = {
+        {
+          9, 31, 12, 0, 14, 28, 3, 32, 0, 0, 0, 6, 0, 0, 0, 0,
+          0, 0, 0, 0, 20, 2, 25, 23, 30, 101, 22, 26, 16, 14, 28, 32,
+          28, 28, 22, 22, 21, 6, 6, 37, 4, 4, 2, 2, 4, 2, 2, 3,
+          13, 12, 19, 17, 15, 15, 27, 25, 18, 18, 20, 20, 9, 34, 26, 46,
+          36, 42, 6, 4, 0, 11, 18, 0, 0, 0, 20, 0, 33, 3, 0, 0,
+          20, 22, 0, 0, 0, 0, 0, 0, 0, 28, 56, 42, 33, 0, 0, 0,
+          0, 0, 0, 0, 26, 32, 32, 20, 32, 62, 54, 64, 84, 9, 254, 249,
+          9, 36, 26, 64, 22, 6, 14, 12, 97, 2, 2, 113, 35, 6, 79, 0,
+          0, 0, 13, 255, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 24, 33, 25, 42, 8, 4, 12, 15, 13, 6, 15, 14, 0,
+          12, 3, 8, 28, 44, 3, 9, 22, 12, 18, 34, 66, 98, 8, 48, 19,
+          3, 20, 24, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 36, 30, 18, 18, 51, 9, 0
+        },
+        {
+          50, 124, 137, 0, 237, 217, 104, 119, 0, 0, 0, 89, 0, 0, 0, 0,
+          0, 0, 0, 0, 214, 159, 220, 168, 24, 23, 170, 144, 67, 115, 39, 246,
+          185, 104, 237, 244, 222, 212, 9, 254, 230, 28, 28, 132, 221, 232, 11, 153,
+          41, 39, 214, 223, 141, 33, 15, 3, 100, 24, 239, 238, 30, 240, 183, 130,
+          130, 118, 148, 21, 0, 243, 124, 0, 0, 0, 20, 0, 152, 143, 0, 0,
+          127, 106, 0, 0, 0, 0, 0, 0, 0, 231, 183, 63, 54, 0, 0, 0,
+          0, 0, 0, 0, 175, 102, 158, 208, 56, 93, 211, 108, 32, 185, 235, 93,
+          124, 124, 119, 4, 76, 128, 56, 116, 134, 237, 203, 250, 87, 203, 220, 0,
+          0, 0, 29, 223, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 177, 241, 15, 134, 219, 208, 188, 84, 22, 19, 21, 134, 0,
+          78, 68, 189, 127, 154, 21, 21, 144, 1, 234, 73, 181, 22, 83, 167, 138,
+          234, 240, 47, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 204, 49, 170, 44, 83, 46, 0
+        },
+        {
+          0, 0, MAVLINK_TYPE_UINT64_T, 0, MAVLINK_TYPE_UINT64_T, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, MAVLINK_TYPE_UINT64_T, 0, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T,
+          MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, 0, 0, 0, 0,
+          0, MAVLINK_TYPE_UINT32_T, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, 0, 0, 0, 0, 0, 0, 0, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, 0, 0, 0,
+          0, 0, 0, 0, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, 0, 0, 0, 0,
+          0, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT32_T, 0, 0, 0, 0, 0, 0, 0, MAVLINK_TYPE_UINT64_T, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, MAVLINK_TYPE_UINT64_T, MAVLINK_TYPE_UINT32_T, MAVLINK_TYPE_UINT32_T, 0, MAVLINK_TYPE_UINT32_T, 0
+        },
+        {
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+        }
+    };
+    return tables;
+}
+
+/** @brief HEARTBEAT (#0), read in place from the payload */
+class Heartbeat
+{
+public:
+    enum { ID = 0, LENGTH = 9, CRC_EXTRA = 50 };
+    explicit Heartbeat(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t custom_mode() const { return detail::read<uint32_t>(payload() + 0); }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t autopilot() const { return detail::read<uint8_t>(payload() + 5); }
+    uint8_t base_mode() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t system_status() const { return detail::read<uint8_t>(payload() + 7); }
+    uint8_t mavlink_version() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SYS_STATUS (#1), read in place from the payload */
+class SysStatus
+{
+public:
+    enum { ID = 1, LENGTH = 31, CRC_EXTRA = 124 };
+    explicit SysStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t onboard_control_sensors_present() const { return detail::read<uint32_t>(payload() + 0); }
+    uint32_t onboard_control_sensors_enabled() const { return detail::read<uint32_t>(payload() + 4); }
+    uint32_t onboard_control_sensors_health() const { return detail::read<uint32_t>(payload() + 8); }
+    uint16_t load() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t voltage_battery() const { return detail::read<uint16_t>(payload() + 14); }
+    int16_t current_battery() const { return detail::read<int16_t>(payload() + 16); }
+    uint16_t drop_rate_comm() const { return detail::read<uint16_t>(payload() + 18); }
+    uint16_t errors_comm() const { return detail::read<uint16_t>(payload() + 20); }
+    uint16_t errors_count1() const { return detail::read<uint16_t>(payload() + 22); }
+    uint16_t errors_count2() const { return detail::read<uint16_t>(payload() + 24); }
+    uint16_t errors_count3() const { return detail::read<uint16_t>(payload() + 26); }
+    uint16_t errors_count4() const { return detail::read<uint16_t>(payload() + 28); }
+    int8_t battery_remaining() const { return detail::read<int8_t>(payload() + 30); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SYSTEM_TIME (#2), read in place from the payload */
+class SystemTime
+{
+public:
+    enum { ID = 2, LENGTH = 12, CRC_EXTRA = 137 };
+    explicit SystemTime(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_unix_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief PING (#4), read in place from the payload */
+class Ping
+{
+public:
+    enum { ID = 4, LENGTH = 14, CRC_EXTRA = 237 };
+    explicit Ping(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    uint32_t seq() const { return detail::read<uint32_t>(payload() + 8); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 12); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 13); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief CHANGE_OPERATOR_CONTROL (#5), read in place from the payload */
+class ChangeOperatorControl
+{
+public:
+    enum { ID = 5, LENGTH = 28, CRC_EXTRA = 217 };
+    explicit ChangeOperatorControl(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t control_request() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t version() const { return detail::read<uint8_t>(payload() + 2); }
+    enum { PASSKEY_LENGTH = 25 };
+    /** @brief Not terminated when all 25 characters are used */
+    const char *passkey() const { return payload() + 3; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief CHANGE_OPERATOR_CONTROL_ACK (#6), read in place from the payload */
+class ChangeOperatorControlAck
+{
+public:
+    enum { ID = 6, LENGTH = 3, CRC_EXTRA = 104 };
+    explicit ChangeOperatorControlAck(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t gcs_system_id() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t control_request() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t ack() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief AUTH_KEY (#7), read in place from the payload */
+class AuthKey
+{
+public:
+    enum { ID = 7, LENGTH = 32, CRC_EXTRA = 119 };
+    explicit AuthKey(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    enum { KEY_LENGTH = 32 };
+    /** @brief Not terminated when all 32 characters are used */
+    const char *key() const { return payload() + 0; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_MODE (#11), read in place from the payload */
+class SetMode
+{
+public:
+    enum { ID = 11, LENGTH = 6, CRC_EXTRA = 89 };
+    explicit SetMode(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t custom_mode() const { return detail::read<uint32_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t base_mode() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief PARAM_REQUEST_READ (#20), read in place from the payload */
+class ParamRequestRead
+{
+public:
+    enum { ID = 20, LENGTH = 20, CRC_EXTRA = 214 };
+    explicit ParamRequestRead(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int16_t param_index() const { return detail::read<int16_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 3); }
+    enum { PARAM_ID_LENGTH = 16 };
+    /** @brief Not terminated when all 16 characters are used */
+    const char *param_id() const { return payload() + 4; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief PARAM_REQUEST_LIST (#21), read in place from the payload */
+class ParamRequestList
+{
+public:
+    enum { ID = 21, LENGTH = 2, CRC_EXTRA = 159 };
+    explicit ParamRequestList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief PARAM_VALUE (#22), read in place from the payload */
+class ParamValue
+{
+public:
+    enum { ID = 22, LENGTH = 25, CRC_EXTRA = 220 };
+    explicit ParamValue(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float param_value() const { return detail::read<float>(payload() + 0); }
+    uint16_t param_count() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t param_index() const { return detail::read<uint16_t>(payload() + 6); }
+    enum { PARAM_ID_LENGTH = 16 };
+    /** @brief Not terminated when all 16 characters are used */
+    const char *param_id() const { return payload() + 8; }
+    uint8_t param_type() const { return detail::read<uint8_t>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief PARAM_SET (#23), read in place from the payload */
+class ParamSet
+{
+public:
+    enum { ID = 23, LENGTH = 23, CRC_EXTRA = 168 };
+    explicit ParamSet(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float param_value() const { return detail::read<float>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 5); }
+    enum { PARAM_ID_LENGTH = 16 };
+    /** @brief Not terminated when all 16 characters are used */
+    const char *param_id() const { return payload() + 6; }
+    uint8_t param_type() const { return detail::read<uint8_t>(payload() + 22); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GPS_RAW_INT (#24), read in place from the payload */
+class GpsRawInt
+{
+public:
+    enum { ID = 24, LENGTH = 30, CRC_EXTRA = 24 };
+    explicit GpsRawInt(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 8); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 12); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 16); }
+    uint16_t eph() const { return detail::read<uint16_t>(payload() + 20); }
+    uint16_t epv() const { return detail::read<uint16_t>(payload() + 22); }
+    uint16_t vel() const { return detail::read<uint16_t>(payload() + 24); }
+    uint16_t cog() const { return detail::read<uint16_t>(payload() + 26); }
+    uint8_t fix_type() const { return detail::read<uint8_t>(payload() + 28); }
+    uint8_t satellites_visible() const { return detail::read<uint8_t>(payload() + 29); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GPS_STATUS (#25), read in place from the payload */
+class GpsStatus
+{
+public:
+    enum { ID = 25, LENGTH = 101, CRC_EXTRA = 23 };
+    explicit GpsStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t satellites_visible() const { return detail::read<uint8_t>(payload() + 0); }
+    enum { SATELLITE_PRN_LENGTH = 20 };
+    uint8_t satellite_prn(int i) const { return detail::read<uint8_t>(payload() + 1 + i * 1); }
+    enum { SATELLITE_USED_LENGTH = 20 };
+    uint8_t satellite_used(int i) const { return detail::read<uint8_t>(payload() + 21 + i * 1); }
+    enum { SATELLITE_ELEVATION_LENGTH = 20 };
+    uint8_t satellite_elevation(int i) const { return detail::read<uint8_t>(payload() + 41 + i * 1); }
+    enum { SATELLITE_AZIMUTH_LENGTH = 20 };
+    uint8_t satellite_azimuth(int i) const { return detail::read<uint8_t>(payload() + 61 + i * 1); }
+    enum { SATELLITE_SNR_LENGTH = 20 };
+    uint8_t satellite_snr(int i) const { return detail::read<uint8_t>(payload() + 81 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SCALED_IMU (#26), read in place from the payload */
+class ScaledImu
+{
+public:
+    enum { ID = 26, LENGTH = 22, CRC_EXTRA = 170 };
+    explicit ScaledImu(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    int16_t xacc() const { return detail::read<int16_t>(payload() + 4); }
+    int16_t yacc() const { return detail::read<int16_t>(payload() + 6); }
+    int16_t zacc() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t xgyro() const { return detail::read<int16_t>(payload() + 10); }
+    int16_t ygyro() const { return detail::read<int16_t>(payload() + 12); }
+    int16_t zgyro() const { return detail::read<int16_t>(payload() + 14); }
+    int16_t xmag() const { return detail::read<int16_t>(payload() + 16); }
+    int16_t ymag() const { return detail::read<int16_t>(payload() + 18); }
+    int16_t zmag() const { return detail::read<int16_t>(payload() + 20); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RAW_IMU (#27), read in place from the payload */
+class RawImu
+{
+public:
+    enum { ID = 27, LENGTH = 26, CRC_EXTRA = 144 };
+    explicit RawImu(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    int16_t xacc() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t yacc() const { return detail::read<int16_t>(payload() + 10); }
+    int16_t zacc() const { return detail::read<int16_t>(payload() + 12); }
+    int16_t xgyro() const { return detail::read<int16_t>(payload() + 14); }
+    int16_t ygyro() const { return detail::read<int16_t>(payload() + 16); }
+    int16_t zgyro() const { return detail::read<int16_t>(payload() + 18); }
+    int16_t xmag() const { return detail::read<int16_t>(payload() + 20); }
+    int16_t ymag() const { return detail::read<int16_t>(payload() + 22); }
+    int16_t zmag() const { return detail::read<int16_t>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RAW_PRESSURE (#28), read in place from the payload */
+class RawPressure
+{
+public:
+    enum { ID = 28, LENGTH = 16, CRC_EXTRA = 67 };
+    explicit RawPressure(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    int16_t press_abs() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t press_diff1() const { return detail::read<int16_t>(payload() + 10); }
+    int16_t press_diff2() const { return detail::read<int16_t>(payload() + 12); }
+    int16_t temperature() const { return detail::read<int16_t>(payload() + 14); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SCALED_PRESSURE (#29), read in place from the payload */
+class ScaledPressure
+{
+public:
+    enum { ID = 29, LENGTH = 14, CRC_EXTRA = 115 };
+    explicit ScaledPressure(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float press_abs() const { return detail::read<float>(payload() + 4); }
+    float press_diff() const { return detail::read<float>(payload() + 8); }
+    int16_t temperature() const { return detail::read<int16_t>(payload() + 12); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ATTITUDE (#30), read in place from the payload */
+class Attitude
+{
+public:
+    enum { ID = 30, LENGTH = 28, CRC_EXTRA = 39 };
+    explicit Attitude(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float roll() const { return detail::read<float>(payload() + 4); }
+    float pitch() const { return detail::read<float>(payload() + 8); }
+    float yaw() const { return detail::read<float>(payload() + 12); }
+    float rollspeed() const { return detail::read<float>(payload() + 16); }
+    float pitchspeed() const { return detail::read<float>(payload() + 20); }
+    float yawspeed() const { return detail::read<float>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ATTITUDE_QUATERNION (#31), read in place from the payload */
+class AttitudeQuaternion
+{
+public:
+    enum { ID = 31, LENGTH = 32, CRC_EXTRA = 246 };
+    explicit AttitudeQuaternion(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float q1() const { return detail::read<float>(payload() + 4); }
+    float q2() const { return detail::read<float>(payload() + 8); }
+    float q3() const { return detail::read<float>(payload() + 12); }
+    float q4() const { return detail::read<float>(payload() + 16); }
+    float rollspeed() const { return detail::read<float>(payload() + 20); }
+    float pitchspeed() const { return detail::read<float>(payload() + 24); }
+    float yawspeed() const { return detail::read<float>(payload() + 28); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOCAL_POSITION_NED (#32), read in place from the payload */
+class LocalPositionNed
+{
+public:
+    enum { ID = 32, LENGTH = 28, CRC_EXTRA = 185 };
+    explicit LocalPositionNed(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 4); }
+    float y() const { return detail::read<float>(payload() + 8); }
+    float z() const { return detail::read<float>(payload() + 12); }
+    float vx() const { return detail::read<float>(payload() + 16); }
+    float vy() const { return detail::read<float>(payload() + 20); }
+    float vz() const { return detail::read<float>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GLOBAL_POSITION_INT (#33), read in place from the payload */
+class GlobalPositionInt
+{
+public:
+    enum { ID = 33, LENGTH = 28, CRC_EXTRA = 104 };
+    explicit GlobalPositionInt(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 8); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 12); }
+    int32_t relative_alt() const { return detail::read<int32_t>(payload() + 16); }
+    int16_t vx() const { return detail::read<int16_t>(payload() + 20); }
+    int16_t vy() const { return detail::read<int16_t>(payload() + 22); }
+    int16_t vz() const { return detail::read<int16_t>(payload() + 24); }
+    uint16_t hdg() const { return detail::read<uint16_t>(payload() + 26); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RC_CHANNELS_SCALED (#34), read in place from the payload */
+class RcChannelsScaled
+{
+public:
+    enum { ID = 34, LENGTH = 22, CRC_EXTRA = 237 };
+    explicit RcChannelsScaled(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    int16_t chan1_scaled() const { return detail::read<int16_t>(payload() + 4); }
+    int16_t chan2_scaled() const { return detail::read<int16_t>(payload() + 6); }
+    int16_t chan3_scaled() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t chan4_scaled() const { return detail::read<int16_t>(payload() + 10); }
+    int16_t chan5_scaled() const { return detail::read<int16_t>(payload() + 12); }
+    int16_t chan6_scaled() const { return detail::read<int16_t>(payload() + 14); }
+    int16_t chan7_scaled() const { return detail::read<int16_t>(payload() + 16); }
+    int16_t chan8_scaled() const { return detail::read<int16_t>(payload() + 18); }
+    uint8_t port() const { return detail::read<uint8_t>(payload() + 20); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 21); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RC_CHANNELS_RAW (#35), read in place from the payload */
+class RcChannelsRaw
+{
+public:
+    enum { ID = 35, LENGTH = 22, CRC_EXTRA = 244 };
+    explicit RcChannelsRaw(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t chan1_raw() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t chan2_raw() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t chan3_raw() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t chan4_raw() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t chan5_raw() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t chan6_raw() const { return detail::read<uint16_t>(payload() + 14); }
+    uint16_t chan7_raw() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t chan8_raw() const { return detail::read<uint16_t>(payload() + 18); }
+    uint8_t port() const { return detail::read<uint8_t>(payload() + 20); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 21); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SERVO_OUTPUT_RAW (#36), read in place from the payload */
+class ServoOutputRaw
+{
+public:
+    enum { ID = 36, LENGTH = 21, CRC_EXTRA = 222 };
+    explicit ServoOutputRaw(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_usec() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t servo1_raw() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t servo2_raw() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t servo3_raw() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t servo4_raw() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t servo5_raw() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t servo6_raw() const { return detail::read<uint16_t>(payload() + 14); }
+    uint16_t servo7_raw() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t servo8_raw() const { return detail::read<uint16_t>(payload() + 18); }
+    uint8_t port() const { return detail::read<uint8_t>(payload() + 20); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_REQUEST_PARTIAL_LIST (#37), read in place from the payload */
+class MissionRequestPartialList
+{
+public:
+    enum { ID = 37, LENGTH = 6, CRC_EXTRA = 212 };
+    explicit MissionRequestPartialList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int16_t start_index() const { return detail::read<int16_t>(payload() + 0); }
+    int16_t end_index() const { return detail::read<int16_t>(payload() + 2); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_WRITE_PARTIAL_LIST (#38), read in place from the payload */
+class MissionWritePartialList
+{
+public:
+    enum { ID = 38, LENGTH = 6, CRC_EXTRA = 9 };
+    explicit MissionWritePartialList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int16_t start_index() const { return detail::read<int16_t>(payload() + 0); }
+    int16_t end_index() const { return detail::read<int16_t>(payload() + 2); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_ITEM (#39), read in place from the payload */
+class MissionItem
+{
+public:
+    enum { ID = 39, LENGTH = 37, CRC_EXTRA = 254 };
+    explicit MissionItem(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float param1() const { return detail::read<float>(payload() + 0); }
+    float param2() const { return detail::read<float>(payload() + 4); }
+    float param3() const { return detail::read<float>(payload() + 8); }
+    float param4() const { return detail::read<float>(payload() + 12); }
+    float x() const { return detail::read<float>(payload() + 16); }
+    float y() const { return detail::read<float>(payload() + 20); }
+    float z() const { return detail::read<float>(payload() + 24); }
+    uint16_t seq() const { return detail::read<uint16_t>(payload() + 28); }
+    uint16_t command() const { return detail::read<uint16_t>(payload() + 30); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 32); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 33); }
+    uint8_t frame() const { return detail::read<uint8_t>(payload() + 34); }
+    uint8_t current() const { return detail::read<uint8_t>(payload() + 35); }
+    uint8_t autocontinue() const { return detail::read<uint8_t>(payload() + 36); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_REQUEST (#40), read in place from the payload */
+class MissionRequest
+{
+public:
+    enum { ID = 40, LENGTH = 4, CRC_EXTRA = 230 };
+    explicit MissionRequest(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t seq() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 3); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_SET_CURRENT (#41), read in place from the payload */
+class MissionSetCurrent
+{
+public:
+    enum { ID = 41, LENGTH = 4, CRC_EXTRA = 28 };
+    explicit MissionSetCurrent(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t seq() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 3); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_CURRENT (#42), read in place from the payload */
+class MissionCurrent
+{
+public:
+    enum { ID = 42, LENGTH = 2, CRC_EXTRA = 28 };
+    explicit MissionCurrent(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t seq() const { return detail::read<uint16_t>(payload() + 0); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_REQUEST_LIST (#43), read in place from the payload */
+class MissionRequestList
+{
+public:
+    enum { ID = 43, LENGTH = 2, CRC_EXTRA = 132 };
+    explicit MissionRequestList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_COUNT (#44), read in place from the payload */
+class MissionCount
+{
+public:
+    enum { ID = 44, LENGTH = 4, CRC_EXTRA = 221 };
+    explicit MissionCount(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t count() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 3); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_CLEAR_ALL (#45), read in place from the payload */
+class MissionClearAll
+{
+public:
+    enum { ID = 45, LENGTH = 2, CRC_EXTRA = 232 };
+    explicit MissionClearAll(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_ITEM_REACHED (#46), read in place from the payload */
+class MissionItemReached
+{
+public:
+    enum { ID = 46, LENGTH = 2, CRC_EXTRA = 11 };
+    explicit MissionItemReached(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t seq() const { return detail::read<uint16_t>(payload() + 0); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MISSION_ACK (#47), read in place from the payload */
+class MissionAck
+{
+public:
+    enum { ID = 47, LENGTH = 3, CRC_EXTRA = 153 };
+    explicit MissionAck(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_GPS_GLOBAL_ORIGIN (#48), read in place from the payload */
+class SetGpsGlobalOrigin
+{
+public:
+    enum { ID = 48, LENGTH = 13, CRC_EXTRA = 41 };
+    explicit SetGpsGlobalOrigin(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t latitude() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t longitude() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t altitude() const { return detail::read<int32_t>(payload() + 8); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 12); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GPS_GLOBAL_ORIGIN (#49), read in place from the payload */
+class GpsGlobalOrigin
+{
+public:
+    enum { ID = 49, LENGTH = 12, CRC_EXTRA = 39 };
+    explicit GpsGlobalOrigin(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t latitude() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t longitude() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t altitude() const { return detail::read<int32_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_LOCAL_POSITION_SETPOINT (#50), read in place from the payload */
+class SetLocalPositionSetpoint
+{
+public:
+    enum { ID = 50, LENGTH = 19, CRC_EXTRA = 214 };
+    explicit SetLocalPositionSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float x() const { return detail::read<float>(payload() + 0); }
+    float y() const { return detail::read<float>(payload() + 4); }
+    float z() const { return detail::read<float>(payload() + 8); }
+    float yaw() const { return detail::read<float>(payload() + 12); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 16); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 17); }
+    uint8_t coordinate_frame() const { return detail::read<uint8_t>(payload() + 18); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOCAL_POSITION_SETPOINT (#51), read in place from the payload */
+class LocalPositionSetpoint
+{
+public:
+    enum { ID = 51, LENGTH = 17, CRC_EXTRA = 223 };
+    explicit LocalPositionSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float x() const { return detail::read<float>(payload() + 0); }
+    float y() const { return detail::read<float>(payload() + 4); }
+    float z() const { return detail::read<float>(payload() + 8); }
+    float yaw() const { return detail::read<float>(payload() + 12); }
+    uint8_t coordinate_frame() const { return detail::read<uint8_t>(payload() + 16); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GLOBAL_POSITION_SETPOINT_INT (#52), read in place from the payload */
+class GlobalPositionSetpointInt
+{
+public:
+    enum { ID = 52, LENGTH = 15, CRC_EXTRA = 141 };
+    explicit GlobalPositionSetpointInt(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t latitude() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t longitude() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t altitude() const { return detail::read<int32_t>(payload() + 8); }
+    int16_t yaw() const { return detail::read<int16_t>(payload() + 12); }
+    uint8_t coordinate_frame() const { return detail::read<uint8_t>(payload() + 14); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_GLOBAL_POSITION_SETPOINT_INT (#53), read in place from the payload */
+class SetGlobalPositionSetpointInt
+{
+public:
+    enum { ID = 53, LENGTH = 15, CRC_EXTRA = 33 };
+    explicit SetGlobalPositionSetpointInt(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t latitude() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t longitude() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t altitude() const { return detail::read<int32_t>(payload() + 8); }
+    int16_t yaw() const { return detail::read<int16_t>(payload() + 12); }
+    uint8_t coordinate_frame() const { return detail::read<uint8_t>(payload() + 14); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SAFETY_SET_ALLOWED_AREA (#54), read in place from the payload */
+class SafetySetAllowedArea
+{
+public:
+    enum { ID = 54, LENGTH = 27, CRC_EXTRA = 15 };
+    explicit SafetySetAllowedArea(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float p1x() const { return detail::read<float>(payload() + 0); }
+    float p1y() const { return detail::read<float>(payload() + 4); }
+    float p1z() const { return detail::read<float>(payload() + 8); }
+    float p2x() const { return detail::read<float>(payload() + 12); }
+    float p2y() const { return detail::read<float>(payload() + 16); }
+    float p2z() const { return detail::read<float>(payload() + 20); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 24); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 25); }
+    uint8_t frame() const { return detail::read<uint8_t>(payload() + 26); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SAFETY_ALLOWED_AREA (#55), read in place from the payload */
+class SafetyAllowedArea
+{
+public:
+    enum { ID = 55, LENGTH = 25, CRC_EXTRA = 3 };
+    explicit SafetyAllowedArea(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float p1x() const { return detail::read<float>(payload() + 0); }
+    float p1y() const { return detail::read<float>(payload() + 4); }
+    float p1z() const { return detail::read<float>(payload() + 8); }
+    float p2x() const { return detail::read<float>(payload() + 12); }
+    float p2y() const { return detail::read<float>(payload() + 16); }
+    float p2z() const { return detail::read<float>(payload() + 20); }
+    uint8_t frame() const { return detail::read<uint8_t>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_ROLL_PITCH_YAW_THRUST (#56), read in place from the payload */
+class SetRollPitchYawThrust
+{
+public:
+    enum { ID = 56, LENGTH = 18, CRC_EXTRA = 100 };
+    explicit SetRollPitchYawThrust(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float roll() const { return detail::read<float>(payload() + 0); }
+    float pitch() const { return detail::read<float>(payload() + 4); }
+    float yaw() const { return detail::read<float>(payload() + 8); }
+    float thrust() const { return detail::read<float>(payload() + 12); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 16); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 17); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_ROLL_PITCH_YAW_SPEED_THRUST (#57), read in place from the payload */
+class SetRollPitchYawSpeedThrust
+{
+public:
+    enum { ID = 57, LENGTH = 18, CRC_EXTRA = 24 };
+    explicit SetRollPitchYawSpeedThrust(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float roll_speed() const { return detail::read<float>(payload() + 0); }
+    float pitch_speed() const { return detail::read<float>(payload() + 4); }
+    float yaw_speed() const { return detail::read<float>(payload() + 8); }
+    float thrust() const { return detail::read<float>(payload() + 12); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 16); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 17); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ROLL_PITCH_YAW_THRUST_SETPOINT (#58), read in place from the payload */
+class RollPitchYawThrustSetpoint
+{
+public:
+    enum { ID = 58, LENGTH = 20, CRC_EXTRA = 239 };
+    explicit RollPitchYawThrustSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float roll() const { return detail::read<float>(payload() + 4); }
+    float pitch() const { return detail::read<float>(payload() + 8); }
+    float yaw() const { return detail::read<float>(payload() + 12); }
+    float thrust() const { return detail::read<float>(payload() + 16); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ROLL_PITCH_YAW_SPEED_THRUST_SETPOINT (#59), read in place from the payload */
+class RollPitchYawSpeedThrustSetpoint
+{
+public:
+    enum { ID = 59, LENGTH = 20, CRC_EXTRA = 238 };
+    explicit RollPitchYawSpeedThrustSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float roll_speed() const { return detail::read<float>(payload() + 4); }
+    float pitch_speed() const { return detail::read<float>(payload() + 8); }
+    float yaw_speed() const { return detail::read<float>(payload() + 12); }
+    float thrust() const { return detail::read<float>(payload() + 16); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_QUAD_MOTORS_SETPOINT (#60), read in place from the payload */
+class SetQuadMotorsSetpoint
+{
+public:
+    enum { ID = 60, LENGTH = 9, CRC_EXTRA = 30 };
+    explicit SetQuadMotorsSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t motor_front_nw() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t motor_right_ne() const { return detail::read<uint16_t>(payload() + 2); }
+    uint16_t motor_back_se() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t motor_left_sw() const { return detail::read<uint16_t>(payload() + 6); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_QUAD_SWARM_ROLL_PITCH_YAW_THRUST (#61), read in place from the payload */
+class SetQuadSwarmRollPitchYawThrust
+{
+public:
+    enum { ID = 61, LENGTH = 34, CRC_EXTRA = 240 };
+    explicit SetQuadSwarmRollPitchYawThrust(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    enum { ROLL_LENGTH = 4 };
+    int16_t roll(int i) const { return detail::read<int16_t>(payload() + 0 + i * 2); }
+    enum { PITCH_LENGTH = 4 };
+    int16_t pitch(int i) const { return detail::read<int16_t>(payload() + 8 + i * 2); }
+    enum { YAW_LENGTH = 4 };
+    int16_t yaw(int i) const { return detail::read<int16_t>(payload() + 16 + i * 2); }
+    enum { THRUST_LENGTH = 4 };
+    uint16_t thrust(int i) const { return detail::read<uint16_t>(payload() + 24 + i * 2); }
+    uint8_t group() const { return detail::read<uint8_t>(payload() + 32); }
+    uint8_t mode() const { return detail::read<uint8_t>(payload() + 33); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief NAV_CONTROLLER_OUTPUT (#62), read in place from the payload */
+class NavControllerOutput
+{
+public:
+    enum { ID = 62, LENGTH = 26, CRC_EXTRA = 183 };
+    explicit NavControllerOutput(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float nav_roll() const { return detail::read<float>(payload() + 0); }
+    float nav_pitch() const { return detail::read<float>(payload() + 4); }
+    float alt_error() const { return detail::read<float>(payload() + 8); }
+    float aspd_error() const { return detail::read<float>(payload() + 12); }
+    float xtrack_error() const { return detail::read<float>(payload() + 16); }
+    int16_t nav_bearing() const { return detail::read<int16_t>(payload() + 20); }
+    int16_t target_bearing() const { return detail::read<int16_t>(payload() + 22); }
+    uint16_t wp_dist() const { return detail::read<uint16_t>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_QUAD_SWARM_LED_ROLL_PITCH_YAW_THRUST (#63), read in place from the payload */
+class SetQuadSwarmLedRollPitchYawThrust
+{
+public:
+    enum { ID = 63, LENGTH = 46, CRC_EXTRA = 130 };
+    explicit SetQuadSwarmLedRollPitchYawThrust(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    enum { ROLL_LENGTH = 4 };
+    int16_t roll(int i) const { return detail::read<int16_t>(payload() + 0 + i * 2); }
+    enum { PITCH_LENGTH = 4 };
+    int16_t pitch(int i) const { return detail::read<int16_t>(payload() + 8 + i * 2); }
+    enum { YAW_LENGTH = 4 };
+    int16_t yaw(int i) const { return detail::read<int16_t>(payload() + 16 + i * 2); }
+    enum { THRUST_LENGTH = 4 };
+    uint16_t thrust(int i) const { return detail::read<uint16_t>(payload() + 24 + i * 2); }
+    uint8_t group() const { return detail::read<uint8_t>(payload() + 32); }
+    uint8_t mode() const { return detail::read<uint8_t>(payload() + 33); }
+    enum { LED_RED_LENGTH = 4 };
+    uint8_t led_red(int i) const { return detail::read<uint8_t>(payload() + 34 + i * 1); }
+    enum { LED_BLUE_LENGTH = 4 };
+    uint8_t led_blue(int i) const { return detail::read<uint8_t>(payload() + 38 + i * 1); }
+    enum { LED_GREEN_LENGTH = 4 };
+    uint8_t led_green(int i) const { return detail::read<uint8_t>(payload() + 42 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief STATE_CORRECTION (#64), read in place from the payload */
+class StateCorrection
+{
+public:
+    enum { ID = 64, LENGTH = 36, CRC_EXTRA = 130 };
+    explicit StateCorrection(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float xErr() const { return detail::read<float>(payload() + 0); }
+    float yErr() const { return detail::read<float>(payload() + 4); }
+    float zErr() const { return detail::read<float>(payload() + 8); }
+    float rollErr() const { return detail::read<float>(payload() + 12); }
+    float pitchErr() const { return detail::read<float>(payload() + 16); }
+    float yawErr() const { return detail::read<float>(payload() + 20); }
+    float vxErr() const { return detail::read<float>(payload() + 24); }
+    float vyErr() const { return detail::read<float>(payload() + 28); }
+    float vzErr() const { return detail::read<float>(payload() + 32); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RC_CHANNELS (#65), read in place from the payload */
+class RcChannels
+{
+public:
+    enum { ID = 65, LENGTH = 42, CRC_EXTRA = 118 };
+    explicit RcChannels(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t chan1_raw() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t chan2_raw() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t chan3_raw() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t chan4_raw() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t chan5_raw() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t chan6_raw() const { return detail::read<uint16_t>(payload() + 14); }
+    uint16_t chan7_raw() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t chan8_raw() const { return detail::read<uint16_t>(payload() + 18); }
+    uint16_t chan9_raw() const { return detail::read<uint16_t>(payload() + 20); }
+    uint16_t chan10_raw() const { return detail::read<uint16_t>(payload() + 22); }
+    uint16_t chan11_raw() const { return detail::read<uint16_t>(payload() + 24); }
+    uint16_t chan12_raw() const { return detail::read<uint16_t>(payload() + 26); }
+    uint16_t chan13_raw() const { return detail::read<uint16_t>(payload() + 28); }
+    uint16_t chan14_raw() const { return detail::read<uint16_t>(payload() + 30); }
+    uint16_t chan15_raw() const { return detail::read<uint16_t>(payload() + 32); }
+    uint16_t chan16_raw() const { return detail::read<uint16_t>(payload() + 34); }
+    uint16_t chan17_raw() const { return detail::read<uint16_t>(payload() + 36); }
+    uint16_t chan18_raw() const { return detail::read<uint16_t>(payload() + 38); }
+    uint8_t chancount() const { return detail::read<uint8_t>(payload() + 40); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 41); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief REQUEST_DATA_STREAM (#66), read in place from the payload */
+class RequestDataStream
+{
+public:
+    enum { ID = 66, LENGTH = 6, CRC_EXTRA = 148 };
+    explicit RequestDataStream(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t req_message_rate() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 3); }
+    uint8_t req_stream_id() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t start_stop() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA_STREAM (#67), read in place from the payload */
+class DataStream
+{
+public:
+    enum { ID = 67, LENGTH = 4, CRC_EXTRA = 21 };
+    explicit DataStream(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t message_rate() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t stream_id() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t on_off() const { return detail::read<uint8_t>(payload() + 3); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MANUAL_CONTROL (#69), read in place from the payload */
+class ManualControl
+{
+public:
+    enum { ID = 69, LENGTH = 11, CRC_EXTRA = 243 };
+    explicit ManualControl(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int16_t x() const { return detail::read<int16_t>(payload() + 0); }
+    int16_t y() const { return detail::read<int16_t>(payload() + 2); }
+    int16_t z() const { return detail::read<int16_t>(payload() + 4); }
+    int16_t r() const { return detail::read<int16_t>(payload() + 6); }
+    uint16_t buttons() const { return detail::read<uint16_t>(payload() + 8); }
+    uint8_t target() const { return detail::read<uint8_t>(payload() + 10); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RC_CHANNELS_OVERRIDE (#70), read in place from the payload */
+class RcChannelsOverride
+{
+public:
+    enum { ID = 70, LENGTH = 18, CRC_EXTRA = 124 };
+    explicit RcChannelsOverride(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t chan1_raw() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t chan2_raw() const { return detail::read<uint16_t>(payload() + 2); }
+    uint16_t chan3_raw() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t chan4_raw() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t chan5_raw() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t chan6_raw() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t chan7_raw() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t chan8_raw() const { return detail::read<uint16_t>(payload() + 14); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 16); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 17); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief VFR_HUD (#74), read in place from the payload */
+class VfrHud
+{
+public:
+    enum { ID = 74, LENGTH = 20, CRC_EXTRA = 20 };
+    explicit VfrHud(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float airspeed() const { return detail::read<float>(payload() + 0); }
+    float groundspeed() const { return detail::read<float>(payload() + 4); }
+    float alt() const { return detail::read<float>(payload() + 8); }
+    float climb() const { return detail::read<float>(payload() + 12); }
+    int16_t heading() const { return detail::read<int16_t>(payload() + 16); }
+    uint16_t throttle() const { return detail::read<uint16_t>(payload() + 18); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief COMMAND_LONG (#76), read in place from the payload */
+class CommandLong
+{
+public:
+    enum { ID = 76, LENGTH = 33, CRC_EXTRA = 152 };
+    explicit CommandLong(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float param1() const { return detail::read<float>(payload() + 0); }
+    float param2() const { return detail::read<float>(payload() + 4); }
+    float param3() const { return detail::read<float>(payload() + 8); }
+    float param4() const { return detail::read<float>(payload() + 12); }
+    float param5() const { return detail::read<float>(payload() + 16); }
+    float param6() const { return detail::read<float>(payload() + 20); }
+    float param7() const { return detail::read<float>(payload() + 24); }
+    uint16_t command() const { return detail::read<uint16_t>(payload() + 28); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 30); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 31); }
+    uint8_t confirmation() const { return detail::read<uint8_t>(payload() + 32); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief COMMAND_ACK (#77), read in place from the payload */
+class CommandAck
+{
+public:
+    enum { ID = 77, LENGTH = 3, CRC_EXTRA = 143 };
+    explicit CommandAck(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t command() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t result() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ROLL_PITCH_YAW_RATES_THRUST_SETPOINT (#80), read in place from the payload */
+class RollPitchYawRatesThrustSetpoint
+{
+public:
+    enum { ID = 80, LENGTH = 20, CRC_EXTRA = 127 };
+    explicit RollPitchYawRatesThrustSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float roll_rate() const { return detail::read<float>(payload() + 4); }
+    float pitch_rate() const { return detail::read<float>(payload() + 8); }
+    float yaw_rate() const { return detail::read<float>(payload() + 12); }
+    float thrust() const { return detail::read<float>(payload() + 16); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MANUAL_SETPOINT (#81), read in place from the payload */
+class ManualSetpoint
+{
+public:
+    enum { ID = 81, LENGTH = 22, CRC_EXTRA = 106 };
+    explicit ManualSetpoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float roll() const { return detail::read<float>(payload() + 4); }
+    float pitch() const { return detail::read<float>(payload() + 8); }
+    float yaw() const { return detail::read<float>(payload() + 12); }
+    float thrust() const { return detail::read<float>(payload() + 16); }
+    uint8_t mode_switch() const { return detail::read<uint8_t>(payload() + 20); }
+    uint8_t manual_override_switch() const { return detail::read<uint8_t>(payload() + 21); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOCAL_POSITION_NED_SYSTEM_GLOBAL_OFFSET (#89), read in place from the payload */
+class LocalPositionNedSystemGlobalOffset
+{
+public:
+    enum { ID = 89, LENGTH = 28, CRC_EXTRA = 231 };
+    explicit LocalPositionNedSystemGlobalOffset(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 4); }
+    float y() const { return detail::read<float>(payload() + 8); }
+    float z() const { return detail::read<float>(payload() + 12); }
+    float roll() const { return detail::read<float>(payload() + 16); }
+    float pitch() const { return detail::read<float>(payload() + 20); }
+    float yaw() const { return detail::read<float>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_STATE (#90), read in place from the payload */
+class HilState
+{
+public:
+    enum { ID = 90, LENGTH = 56, CRC_EXTRA = 183 };
+    explicit HilState(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float roll() const { return detail::read<float>(payload() + 8); }
+    float pitch() const { return detail::read<float>(payload() + 12); }
+    float yaw() const { return detail::read<float>(payload() + 16); }
+    float rollspeed() const { return detail::read<float>(payload() + 20); }
+    float pitchspeed() const { return detail::read<float>(payload() + 24); }
+    float yawspeed() const { return detail::read<float>(payload() + 28); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 32); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 36); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 40); }
+    int16_t vx() const { return detail::read<int16_t>(payload() + 44); }
+    int16_t vy() const { return detail::read<int16_t>(payload() + 46); }
+    int16_t vz() const { return detail::read<int16_t>(payload() + 48); }
+    int16_t xacc() const { return detail::read<int16_t>(payload() + 50); }
+    int16_t yacc() const { return detail::read<int16_t>(payload() + 52); }
+    int16_t zacc() const { return detail::read<int16_t>(payload() + 54); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_CONTROLS (#91), read in place from the payload */
+class HilControls
+{
+public:
+    enum { ID = 91, LENGTH = 42, CRC_EXTRA = 63 };
+    explicit HilControls(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float roll_ailerons() const { return detail::read<float>(payload() + 8); }
+    float pitch_elevator() const { return detail::read<float>(payload() + 12); }
+    float yaw_rudder() const { return detail::read<float>(payload() + 16); }
+    float throttle() const { return detail::read<float>(payload() + 20); }
+    float aux1() const { return detail::read<float>(payload() + 24); }
+    float aux2() const { return detail::read<float>(payload() + 28); }
+    float aux3() const { return detail::read<float>(payload() + 32); }
+    float aux4() const { return detail::read<float>(payload() + 36); }
+    uint8_t mode() const { return detail::read<uint8_t>(payload() + 40); }
+    uint8_t nav_mode() const { return detail::read<uint8_t>(payload() + 41); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_RC_INPUTS_RAW (#92), read in place from the payload */
+class HilRcInputsRaw
+{
+public:
+    enum { ID = 92, LENGTH = 33, CRC_EXTRA = 54 };
+    explicit HilRcInputsRaw(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    uint16_t chan1_raw() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t chan2_raw() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t chan3_raw() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t chan4_raw() const { return detail::read<uint16_t>(payload() + 14); }
+    uint16_t chan5_raw() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t chan6_raw() const { return detail::read<uint16_t>(payload() + 18); }
+    uint16_t chan7_raw() const { return detail::read<uint16_t>(payload() + 20); }
+    uint16_t chan8_raw() const { return detail::read<uint16_t>(payload() + 22); }
+    uint16_t chan9_raw() const { return detail::read<uint16_t>(payload() + 24); }
+    uint16_t chan10_raw() const { return detail::read<uint16_t>(payload() + 26); }
+    uint16_t chan11_raw() const { return detail::read<uint16_t>(payload() + 28); }
+    uint16_t chan12_raw() const { return detail::read<uint16_t>(payload() + 30); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 32); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief OPTICAL_FLOW (#100), read in place from the payload */
+class OpticalFlow
+{
+public:
+    enum { ID = 100, LENGTH = 26, CRC_EXTRA = 175 };
+    explicit OpticalFlow(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float flow_comp_m_x() const { return detail::read<float>(payload() + 8); }
+    float flow_comp_m_y() const { return detail::read<float>(payload() + 12); }
+    float ground_distance() const { return detail::read<float>(payload() + 16); }
+    int16_t flow_x() const { return detail::read<int16_t>(payload() + 20); }
+    int16_t flow_y() const { return detail::read<int16_t>(payload() + 22); }
+    uint8_t sensor_id() const { return detail::read<uint8_t>(payload() + 24); }
+    uint8_t quality() const { return detail::read<uint8_t>(payload() + 25); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GLOBAL_VISION_POSITION_ESTIMATE (#101), read in place from the payload */
+class GlobalVisionPositionEstimate
+{
+public:
+    enum { ID = 101, LENGTH = 32, CRC_EXTRA = 102 };
+    explicit GlobalVisionPositionEstimate(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 8); }
+    float y() const { return detail::read<float>(payload() + 12); }
+    float z() const { return detail::read<float>(payload() + 16); }
+    float roll() const { return detail::read<float>(payload() + 20); }
+    float pitch() const { return detail::read<float>(payload() + 24); }
+    float yaw() const { return detail::read<float>(payload() + 28); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief VISION_POSITION_ESTIMATE (#102), read in place from the payload */
+class VisionPositionEstimate
+{
+public:
+    enum { ID = 102, LENGTH = 32, CRC_EXTRA = 158 };
+    explicit VisionPositionEstimate(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 8); }
+    float y() const { return detail::read<float>(payload() + 12); }
+    float z() const { return detail::read<float>(payload() + 16); }
+    float roll() const { return detail::read<float>(payload() + 20); }
+    float pitch() const { return detail::read<float>(payload() + 24); }
+    float yaw() const { return detail::read<float>(payload() + 28); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief VISION_SPEED_ESTIMATE (#103), read in place from the payload */
+class VisionSpeedEstimate
+{
+public:
+    enum { ID = 103, LENGTH = 20, CRC_EXTRA = 208 };
+    explicit VisionSpeedEstimate(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 8); }
+    float y() const { return detail::read<float>(payload() + 12); }
+    float z() const { return detail::read<float>(payload() + 16); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief VICON_POSITION_ESTIMATE (#104), read in place from the payload */
+class ViconPositionEstimate
+{
+public:
+    enum { ID = 104, LENGTH = 32, CRC_EXTRA = 56 };
+    explicit ViconPositionEstimate(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 8); }
+    float y() const { return detail::read<float>(payload() + 12); }
+    float z() const { return detail::read<float>(payload() + 16); }
+    float roll() const { return detail::read<float>(payload() + 20); }
+    float pitch() const { return detail::read<float>(payload() + 24); }
+    float yaw() const { return detail::read<float>(payload() + 28); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIGHRES_IMU (#105), read in place from the payload */
+class HighresImu
+{
+public:
+    enum { ID = 105, LENGTH = 62, CRC_EXTRA = 93 };
+    explicit HighresImu(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float xacc() const { return detail::read<float>(payload() + 8); }
+    float yacc() const { return detail::read<float>(payload() + 12); }
+    float zacc() const { return detail::read<float>(payload() + 16); }
+    float xgyro() const { return detail::read<float>(payload() + 20); }
+    float ygyro() const { return detail::read<float>(payload() + 24); }
+    float zgyro() const { return detail::read<float>(payload() + 28); }
+    float xmag() const { return detail::read<float>(payload() + 32); }
+    float ymag() const { return detail::read<float>(payload() + 36); }
+    float zmag() const { return detail::read<float>(payload() + 40); }
+    float abs_pressure() const { return detail::read<float>(payload() + 44); }
+    float diff_pressure() const { return detail::read<float>(payload() + 48); }
+    float pressure_alt() const { return detail::read<float>(payload() + 52); }
+    float temperature() const { return detail::read<float>(payload() + 56); }
+    uint16_t fields_updated() const { return detail::read<uint16_t>(payload() + 60); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief OMNIDIRECTIONAL_FLOW (#106), read in place from the payload */
+class OmnidirectionalFlow
+{
+public:
+    enum { ID = 106, LENGTH = 54, CRC_EXTRA = 211 };
+    explicit OmnidirectionalFlow(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float front_distance_m() const { return detail::read<float>(payload() + 8); }
+    enum { LEFT_LENGTH = 10 };
+    int16_t left(int i) const { return detail::read<int16_t>(payload() + 12 + i * 2); }
+    enum { RIGHT_LENGTH = 10 };
+    int16_t right(int i) const { return detail::read<int16_t>(payload() + 32 + i * 2); }
+    uint8_t sensor_id() const { return detail::read<uint8_t>(payload() + 52); }
+    uint8_t quality() const { return detail::read<uint8_t>(payload() + 53); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_SENSOR (#107), read in place from the payload */
+class HilSensor
+{
+public:
+    enum { ID = 107, LENGTH = 64, CRC_EXTRA = 108 };
+    explicit HilSensor(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float xacc() const { return detail::read<float>(payload() + 8); }
+    float yacc() const { return detail::read<float>(payload() + 12); }
+    float zacc() const { return detail::read<float>(payload() + 16); }
+    float xgyro() const { return detail::read<float>(payload() + 20); }
+    float ygyro() const { return detail::read<float>(payload() + 24); }
+    float zgyro() const { return detail::read<float>(payload() + 28); }
+    float xmag() const { return detail::read<float>(payload() + 32); }
+    float ymag() const { return detail::read<float>(payload() + 36); }
+    float zmag() const { return detail::read<float>(payload() + 40); }
+    float abs_pressure() const { return detail::read<float>(payload() + 44); }
+    float diff_pressure() const { return detail::read<float>(payload() + 48); }
+    float pressure_alt() const { return detail::read<float>(payload() + 52); }
+    float temperature() const { return detail::read<float>(payload() + 56); }
+    uint32_t fields_updated() const { return detail::read<uint32_t>(payload() + 60); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SIM_STATE (#108), read in place from the payload */
+class SimState
+{
+public:
+    enum { ID = 108, LENGTH = 84, CRC_EXTRA = 32 };
+    explicit SimState(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float q1() const { return detail::read<float>(payload() + 0); }
+    float q2() const { return detail::read<float>(payload() + 4); }
+    float q3() const { return detail::read<float>(payload() + 8); }
+    float q4() const { return detail::read<float>(payload() + 12); }
+    float roll() const { return detail::read<float>(payload() + 16); }
+    float pitch() const { return detail::read<float>(payload() + 20); }
+    float yaw() const { return detail::read<float>(payload() + 24); }
+    float xacc() const { return detail::read<float>(payload() + 28); }
+    float yacc() const { return detail::read<float>(payload() + 32); }
+    float zacc() const { return detail::read<float>(payload() + 36); }
+    float xgyro() const { return detail::read<float>(payload() + 40); }
+    float ygyro() const { return detail::read<float>(payload() + 44); }
+    float zgyro() const { return detail::read<float>(payload() + 48); }
+    float lat() const { return detail::read<float>(payload() + 52); }
+    float lon() const { return detail::read<float>(payload() + 56); }
+    float alt() const { return detail::read<float>(payload() + 60); }
+    float std_dev_horz() const { return detail::read<float>(payload() + 64); }
+    float std_dev_vert() const { return detail::read<float>(payload() + 68); }
+    float vn() const { return detail::read<float>(payload() + 72); }
+    float ve() const { return detail::read<float>(payload() + 76); }
+    float vd() const { return detail::read<float>(payload() + 80); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RADIO_STATUS (#109), read in place from the payload */
+class RadioStatus
+{
+public:
+    enum { ID = 109, LENGTH = 9, CRC_EXTRA = 185 };
+    explicit RadioStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t rxerrors() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t fixed() const { return detail::read<uint16_t>(payload() + 2); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t remrssi() const { return detail::read<uint8_t>(payload() + 5); }
+    uint8_t txbuf() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t noise() const { return detail::read<uint8_t>(payload() + 7); }
+    uint8_t remnoise() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FILE_TRANSFER_START (#110), read in place from the payload */
+class FileTransferStart
+{
+public:
+    enum { ID = 110, LENGTH = 254, CRC_EXTRA = 235 };
+    explicit FileTransferStart(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t transfer_uid() const { return detail::read<uint64_t>(payload() + 0); }
+    uint32_t file_size() const { return detail::read<uint32_t>(payload() + 8); }
+    enum { DEST_PATH_LENGTH = 240 };
+    /** @brief Not terminated when all 240 characters are used */
+    const char *dest_path() const { return payload() + 12; }
+    uint8_t direction() const { return detail::read<uint8_t>(payload() + 252); }
+    uint8_t flags() const { return detail::read<uint8_t>(payload() + 253); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FILE_TRANSFER_DIR_LIST (#111), read in place from the payload */
+class FileTransferDirList
+{
+public:
+    enum { ID = 111, LENGTH = 249, CRC_EXTRA = 93 };
+    explicit FileTransferDirList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t transfer_uid() const { return detail::read<uint64_t>(payload() + 0); }
+    enum { DIR_PATH_LENGTH = 240 };
+    /** @brief Not terminated when all 240 characters are used */
+    const char *dir_path() const { return payload() + 8; }
+    uint8_t flags() const { return detail::read<uint8_t>(payload() + 248); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FILE_TRANSFER_RES (#112), read in place from the payload */
+class FileTransferRes
+{
+public:
+    enum { ID = 112, LENGTH = 9, CRC_EXTRA = 124 };
+    explicit FileTransferRes(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t transfer_uid() const { return detail::read<uint64_t>(payload() + 0); }
+    uint8_t result() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_GPS (#113), read in place from the payload */
+class HilGps
+{
+public:
+    enum { ID = 113, LENGTH = 36, CRC_EXTRA = 124 };
+    explicit HilGps(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 8); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 12); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 16); }
+    uint16_t eph() const { return detail::read<uint16_t>(payload() + 20); }
+    uint16_t epv() const { return detail::read<uint16_t>(payload() + 22); }
+    uint16_t vel() const { return detail::read<uint16_t>(payload() + 24); }
+    int16_t vn() const { return detail::read<int16_t>(payload() + 26); }
+    int16_t ve() const { return detail::read<int16_t>(payload() + 28); }
+    int16_t vd() const { return detail::read<int16_t>(payload() + 30); }
+    uint16_t cog() const { return detail::read<uint16_t>(payload() + 32); }
+    uint8_t fix_type() const { return detail::read<uint8_t>(payload() + 34); }
+    uint8_t satellites_visible() const { return detail::read<uint8_t>(payload() + 35); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_OPTICAL_FLOW (#114), read in place from the payload */
+class HilOpticalFlow
+{
+public:
+    enum { ID = 114, LENGTH = 26, CRC_EXTRA = 119 };
+    explicit HilOpticalFlow(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float flow_comp_m_x() const { return detail::read<float>(payload() + 8); }
+    float flow_comp_m_y() const { return detail::read<float>(payload() + 12); }
+    float ground_distance() const { return detail::read<float>(payload() + 16); }
+    int16_t flow_x() const { return detail::read<int16_t>(payload() + 20); }
+    int16_t flow_y() const { return detail::read<int16_t>(payload() + 22); }
+    uint8_t sensor_id() const { return detail::read<uint8_t>(payload() + 24); }
+    uint8_t quality() const { return detail::read<uint8_t>(payload() + 25); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HIL_STATE_QUATERNION (#115), read in place from the payload */
+class HilStateQuaternion
+{
+public:
+    enum { ID = 115, LENGTH = 64, CRC_EXTRA = 4 };
+    explicit HilStateQuaternion(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    enum { ATTITUDE_QUATERNION_LENGTH = 4 };
+    float attitude_quaternion(int i) const { return detail::read<float>(payload() + 8 + i * 4); }
+    float rollspeed() const { return detail::read<float>(payload() + 24); }
+    float pitchspeed() const { return detail::read<float>(payload() + 28); }
+    float yawspeed() const { return detail::read<float>(payload() + 32); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 36); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 40); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 44); }
+    int16_t vx() const { return detail::read<int16_t>(payload() + 48); }
+    int16_t vy() const { return detail::read<int16_t>(payload() + 50); }
+    int16_t vz() const { return detail::read<int16_t>(payload() + 52); }
+    uint16_t ind_airspeed() const { return detail::read<uint16_t>(payload() + 54); }
+    uint16_t true_airspeed() const { return detail::read<uint16_t>(payload() + 56); }
+    int16_t xacc() const { return detail::read<int16_t>(payload() + 58); }
+    int16_t yacc() const { return detail::read<int16_t>(payload() + 60); }
+    int16_t zacc() const { return detail::read<int16_t>(payload() + 62); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SCALED_IMU2 (#116), read in place from the payload */
+class ScaledImu2
+{
+public:
+    enum { ID = 116, LENGTH = 22, CRC_EXTRA = 76 };
+    explicit ScaledImu2(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    int16_t xacc() const { return detail::read<int16_t>(payload() + 4); }
+    int16_t yacc() const { return detail::read<int16_t>(payload() + 6); }
+    int16_t zacc() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t xgyro() const { return detail::read<int16_t>(payload() + 10); }
+    int16_t ygyro() const { return detail::read<int16_t>(payload() + 12); }
+    int16_t zgyro() const { return detail::read<int16_t>(payload() + 14); }
+    int16_t xmag() const { return detail::read<int16_t>(payload() + 16); }
+    int16_t ymag() const { return detail::read<int16_t>(payload() + 18); }
+    int16_t zmag() const { return detail::read<int16_t>(payload() + 20); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_REQUEST_LIST (#117), read in place from the payload */
+class LogRequestList
+{
+public:
+    enum { ID = 117, LENGTH = 6, CRC_EXTRA = 128 };
+    explicit LogRequestList(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t start() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t end() const { return detail::read<uint16_t>(payload() + 2); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_ENTRY (#118), read in place from the payload */
+class LogEntry
+{
+public:
+    enum { ID = 118, LENGTH = 14, CRC_EXTRA = 56 };
+    explicit LogEntry(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_utc() const { return detail::read<uint32_t>(payload() + 0); }
+    uint32_t size() const { return detail::read<uint32_t>(payload() + 4); }
+    uint16_t id() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t num_logs() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t last_log_num() const { return detail::read<uint16_t>(payload() + 12); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_REQUEST_DATA (#119), read in place from the payload */
+class LogRequestData
+{
+public:
+    enum { ID = 119, LENGTH = 12, CRC_EXTRA = 116 };
+    explicit LogRequestData(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t ofs() const { return detail::read<uint32_t>(payload() + 0); }
+    uint32_t count() const { return detail::read<uint32_t>(payload() + 4); }
+    uint16_t id() const { return detail::read<uint16_t>(payload() + 8); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 10); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 11); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_DATA (#120), read in place from the payload */
+class LogData
+{
+public:
+    enum { ID = 120, LENGTH = 97, CRC_EXTRA = 134 };
+    explicit LogData(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t ofs() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t id() const { return detail::read<uint16_t>(payload() + 4); }
+    uint8_t count() const { return detail::read<uint8_t>(payload() + 6); }
+    enum { DATA_LENGTH = 90 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 7 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_ERASE (#121), read in place from the payload */
+class LogErase
+{
+public:
+    enum { ID = 121, LENGTH = 2, CRC_EXTRA = 237 };
+    explicit LogErase(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LOG_REQUEST_END (#122), read in place from the payload */
+class LogRequestEnd
+{
+public:
+    enum { ID = 122, LENGTH = 2, CRC_EXTRA = 203 };
+    explicit LogRequestEnd(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GPS_INJECT_DATA (#123), read in place from the payload */
+class GpsInjectData
+{
+public:
+    enum { ID = 123, LENGTH = 113, CRC_EXTRA = 250 };
+    explicit GpsInjectData(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t len() const { return detail::read<uint8_t>(payload() + 2); }
+    enum { DATA_LENGTH = 110 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 3 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief GPS2_RAW (#124), read in place from the payload */
+class Gps2Raw
+{
+public:
+    enum { ID = 124, LENGTH = 35, CRC_EXTRA = 87 };
+    explicit Gps2Raw(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 8); }
+    int32_t lon() const { return detail::read<int32_t>(payload() + 12); }
+    int32_t alt() const { return detail::read<int32_t>(payload() + 16); }
+    uint32_t dgps_age() const { return detail::read<uint32_t>(payload() + 20); }
+    uint16_t eph() const { return detail::read<uint16_t>(payload() + 24); }
+    uint16_t epv() const { return detail::read<uint16_t>(payload() + 26); }
+    uint16_t vel() const { return detail::read<uint16_t>(payload() + 28); }
+    uint16_t cog() const { return detail::read<uint16_t>(payload() + 30); }
+    uint8_t fix_type() const { return detail::read<uint8_t>(payload() + 32); }
+    uint8_t satellites_visible() const { return detail::read<uint8_t>(payload() + 33); }
+    uint8_t dgps_numch() const { return detail::read<uint8_t>(payload() + 34); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief POWER_STATUS (#125), read in place from the payload */
+class PowerStatus
+{
+public:
+    enum { ID = 125, LENGTH = 6, CRC_EXTRA = 203 };
+    explicit PowerStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t Vcc() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t Vservo() const { return detail::read<uint16_t>(payload() + 2); }
+    uint16_t flags() const { return detail::read<uint16_t>(payload() + 4); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SERIAL_CONTROL (#126), read in place from the payload */
+class SerialControl
+{
+public:
+    enum { ID = 126, LENGTH = 79, CRC_EXTRA = 220 };
+    explicit SerialControl(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t baudrate() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t timeout() const { return detail::read<uint16_t>(payload() + 4); }
+    uint8_t device() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t flags() const { return detail::read<uint8_t>(payload() + 7); }
+    uint8_t count() const { return detail::read<uint8_t>(payload() + 8); }
+    enum { DATA_LENGTH = 70 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 9 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA_TRANSMISSION_HANDSHAKE (#130), read in place from the payload */
+class DataTransmissionHandshake
+{
+public:
+    enum { ID = 130, LENGTH = 13, CRC_EXTRA = 29 };
+    explicit DataTransmissionHandshake(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t size() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t width() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t height() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t packets() const { return detail::read<uint16_t>(payload() + 8); }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 10); }
+    uint8_t payload_() const { return detail::read<uint8_t>(payload() + 11); }
+    uint8_t jpg_quality() const { return detail::read<uint8_t>(payload() + 12); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief ENCAPSULATED_DATA (#131), read in place from the payload */
+class EncapsulatedData
+{
+public:
+    enum { ID = 131, LENGTH = 255, CRC_EXTRA = 223 };
+    explicit EncapsulatedData(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t seqnr() const { return detail::read<uint16_t>(payload() + 0); }
+    enum { DATA_LENGTH = 253 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 2 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief BATTERY_STATUS (#147), read in place from the payload */
+class BatteryStatus
+{
+public:
+    enum { ID = 147, LENGTH = 24, CRC_EXTRA = 177 };
+    explicit BatteryStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t current_consumed() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t energy_consumed() const { return detail::read<int32_t>(payload() + 4); }
+    uint16_t voltage_cell_1() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t voltage_cell_2() const { return detail::read<uint16_t>(payload() + 10); }
+    uint16_t voltage_cell_3() const { return detail::read<uint16_t>(payload() + 12); }
+    uint16_t voltage_cell_4() const { return detail::read<uint16_t>(payload() + 14); }
+    uint16_t voltage_cell_5() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t voltage_cell_6() const { return detail::read<uint16_t>(payload() + 18); }
+    int16_t current_battery() const { return detail::read<int16_t>(payload() + 20); }
+    uint8_t accu_id() const { return detail::read<uint8_t>(payload() + 22); }
+    int8_t battery_remaining() const { return detail::read<int8_t>(payload() + 23); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SETPOINT_8DOF (#148), read in place from the payload */
+class Setpoint8dof
+{
+public:
+    enum { ID = 148, LENGTH = 33, CRC_EXTRA = 241 };
+    explicit Setpoint8dof(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float val1() const { return detail::read<float>(payload() + 0); }
+    float val2() const { return detail::read<float>(payload() + 4); }
+    float val3() const { return detail::read<float>(payload() + 8); }
+    float val4() const { return detail::read<float>(payload() + 12); }
+    float val5() const { return detail::read<float>(payload() + 16); }
+    float val6() const { return detail::read<float>(payload() + 20); }
+    float val7() const { return detail::read<float>(payload() + 24); }
+    float val8() const { return detail::read<float>(payload() + 28); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 32); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SETPOINT_6DOF (#149), read in place from the payload */
+class Setpoint6dof
+{
+public:
+    enum { ID = 149, LENGTH = 25, CRC_EXTRA = 15 };
+    explicit Setpoint6dof(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float trans_x() const { return detail::read<float>(payload() + 0); }
+    float trans_y() const { return detail::read<float>(payload() + 4); }
+    float trans_z() const { return detail::read<float>(payload() + 8); }
+    float rot_x() const { return detail::read<float>(payload() + 12); }
+    float rot_y() const { return detail::read<float>(payload() + 16); }
+    float rot_z() const { return detail::read<float>(payload() + 20); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SENSOR_OFFSETS (#150), read in place from the payload */
+class SensorOffsets
+{
+public:
+    enum { ID = 150, LENGTH = 42, CRC_EXTRA = 134 };
+    explicit SensorOffsets(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float mag_declination() const { return detail::read<float>(payload() + 0); }
+    int32_t raw_press() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t raw_temp() const { return detail::read<int32_t>(payload() + 8); }
+    float gyro_cal_x() const { return detail::read<float>(payload() + 12); }
+    float gyro_cal_y() const { return detail::read<float>(payload() + 16); }
+    float gyro_cal_z() const { return detail::read<float>(payload() + 20); }
+    float accel_cal_x() const { return detail::read<float>(payload() + 24); }
+    float accel_cal_y() const { return detail::read<float>(payload() + 28); }
+    float accel_cal_z() const { return detail::read<float>(payload() + 32); }
+    int16_t mag_ofs_x() const { return detail::read<int16_t>(payload() + 36); }
+    int16_t mag_ofs_y() const { return detail::read<int16_t>(payload() + 38); }
+    int16_t mag_ofs_z() const { return detail::read<int16_t>(payload() + 40); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SET_MAG_OFFSETS (#151), read in place from the payload */
+class SetMagOffsets
+{
+public:
+    enum { ID = 151, LENGTH = 8, CRC_EXTRA = 219 };
+    explicit SetMagOffsets(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int16_t mag_ofs_x() const { return detail::read<int16_t>(payload() + 0); }
+    int16_t mag_ofs_y() const { return detail::read<int16_t>(payload() + 2); }
+    int16_t mag_ofs_z() const { return detail::read<int16_t>(payload() + 4); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 7); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MEMINFO (#152), read in place from the payload */
+class Meminfo
+{
+public:
+    enum { ID = 152, LENGTH = 4, CRC_EXTRA = 208 };
+    explicit Meminfo(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t brkval() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t freemem() const { return detail::read<uint16_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief AP_ADC (#153), read in place from the payload */
+class ApAdc
+{
+public:
+    enum { ID = 153, LENGTH = 12, CRC_EXTRA = 188 };
+    explicit ApAdc(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t adc1() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t adc2() const { return detail::read<uint16_t>(payload() + 2); }
+    uint16_t adc3() const { return detail::read<uint16_t>(payload() + 4); }
+    uint16_t adc4() const { return detail::read<uint16_t>(payload() + 6); }
+    uint16_t adc5() const { return detail::read<uint16_t>(payload() + 8); }
+    uint16_t adc6() const { return detail::read<uint16_t>(payload() + 10); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DIGICAM_CONFIGURE (#154), read in place from the payload */
+class DigicamConfigure
+{
+public:
+    enum { ID = 154, LENGTH = 15, CRC_EXTRA = 84 };
+    explicit DigicamConfigure(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float extra_value() const { return detail::read<float>(payload() + 0); }
+    uint16_t shutter_speed() const { return detail::read<uint16_t>(payload() + 4); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 7); }
+    uint8_t mode() const { return detail::read<uint8_t>(payload() + 8); }
+    uint8_t aperture() const { return detail::read<uint8_t>(payload() + 9); }
+    uint8_t iso() const { return detail::read<uint8_t>(payload() + 10); }
+    uint8_t exposure_type() const { return detail::read<uint8_t>(payload() + 11); }
+    uint8_t command_id() const { return detail::read<uint8_t>(payload() + 12); }
+    uint8_t engine_cut_off() const { return detail::read<uint8_t>(payload() + 13); }
+    uint8_t extra_param() const { return detail::read<uint8_t>(payload() + 14); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DIGICAM_CONTROL (#155), read in place from the payload */
+class DigicamControl
+{
+public:
+    enum { ID = 155, LENGTH = 13, CRC_EXTRA = 22 };
+    explicit DigicamControl(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float extra_value() const { return detail::read<float>(payload() + 0); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 5); }
+    uint8_t session() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t zoom_pos() const { return detail::read<uint8_t>(payload() + 7); }
+    int8_t zoom_step() const { return detail::read<int8_t>(payload() + 8); }
+    uint8_t focus_lock() const { return detail::read<uint8_t>(payload() + 9); }
+    uint8_t shot() const { return detail::read<uint8_t>(payload() + 10); }
+    uint8_t command_id() const { return detail::read<uint8_t>(payload() + 11); }
+    uint8_t extra_param() const { return detail::read<uint8_t>(payload() + 12); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MOUNT_CONFIGURE (#156), read in place from the payload */
+class MountConfigure
+{
+public:
+    enum { ID = 156, LENGTH = 6, CRC_EXTRA = 19 };
+    explicit MountConfigure(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t mount_mode() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t stab_roll() const { return detail::read<uint8_t>(payload() + 3); }
+    uint8_t stab_pitch() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t stab_yaw() const { return detail::read<uint8_t>(payload() + 5); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MOUNT_CONTROL (#157), read in place from the payload */
+class MountControl
+{
+public:
+    enum { ID = 157, LENGTH = 15, CRC_EXTRA = 21 };
+    explicit MountControl(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t input_a() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t input_b() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t input_c() const { return detail::read<int32_t>(payload() + 8); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 12); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 13); }
+    uint8_t save_position() const { return detail::read<uint8_t>(payload() + 14); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MOUNT_STATUS (#158), read in place from the payload */
+class MountStatus
+{
+public:
+    enum { ID = 158, LENGTH = 14, CRC_EXTRA = 134 };
+    explicit MountStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t pointing_a() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t pointing_b() const { return detail::read<int32_t>(payload() + 4); }
+    int32_t pointing_c() const { return detail::read<int32_t>(payload() + 8); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 12); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 13); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FENCE_POINT (#160), read in place from the payload */
+class FencePoint
+{
+public:
+    enum { ID = 160, LENGTH = 12, CRC_EXTRA = 78 };
+    explicit FencePoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float lat() const { return detail::read<float>(payload() + 0); }
+    float lng() const { return detail::read<float>(payload() + 4); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 8); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 9); }
+    uint8_t idx() const { return detail::read<uint8_t>(payload() + 10); }
+    uint8_t count() const { return detail::read<uint8_t>(payload() + 11); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FENCE_FETCH_POINT (#161), read in place from the payload */
+class FenceFetchPoint
+{
+public:
+    enum { ID = 161, LENGTH = 3, CRC_EXTRA = 68 };
+    explicit FenceFetchPoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t idx() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief FENCE_STATUS (#162), read in place from the payload */
+class FenceStatus
+{
+public:
+    enum { ID = 162, LENGTH = 8, CRC_EXTRA = 189 };
+    explicit FenceStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t breach_time() const { return detail::read<uint32_t>(payload() + 0); }
+    uint16_t breach_count() const { return detail::read<uint16_t>(payload() + 4); }
+    uint8_t breach_status() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t breach_type() const { return detail::read<uint8_t>(payload() + 7); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief AHRS (#163), read in place from the payload */
+class Ahrs
+{
+public:
+    enum { ID = 163, LENGTH = 28, CRC_EXTRA = 127 };
+    explicit Ahrs(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float omegaIx() const { return detail::read<float>(payload() + 0); }
+    float omegaIy() const { return detail::read<float>(payload() + 4); }
+    float omegaIz() const { return detail::read<float>(payload() + 8); }
+    float accel_weight() const { return detail::read<float>(payload() + 12); }
+    float renorm_val() const { return detail::read<float>(payload() + 16); }
+    float error_rp() const { return detail::read<float>(payload() + 20); }
+    float error_yaw() const { return detail::read<float>(payload() + 24); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief SIMSTATE (#164), read in place from the payload */
+class Simstate
+{
+public:
+    enum { ID = 164, LENGTH = 44, CRC_EXTRA = 154 };
+    explicit Simstate(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float roll() const { return detail::read<float>(payload() + 0); }
+    float pitch() const { return detail::read<float>(payload() + 4); }
+    float yaw() const { return detail::read<float>(payload() + 8); }
+    float xacc() const { return detail::read<float>(payload() + 12); }
+    float yacc() const { return detail::read<float>(payload() + 16); }
+    float zacc() const { return detail::read<float>(payload() + 20); }
+    float xgyro() const { return detail::read<float>(payload() + 24); }
+    float ygyro() const { return detail::read<float>(payload() + 28); }
+    float zgyro() const { return detail::read<float>(payload() + 32); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 36); }
+    int32_t lng() const { return detail::read<int32_t>(payload() + 40); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief HWSTATUS (#165), read in place from the payload */
+class Hwstatus
+{
+public:
+    enum { ID = 165, LENGTH = 3, CRC_EXTRA = 21 };
+    explicit Hwstatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t Vcc() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t I2Cerr() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RADIO (#166), read in place from the payload */
+class Radio
+{
+public:
+    enum { ID = 166, LENGTH = 9, CRC_EXTRA = 21 };
+    explicit Radio(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t rxerrors() const { return detail::read<uint16_t>(payload() + 0); }
+    uint16_t fixed() const { return detail::read<uint16_t>(payload() + 2); }
+    uint8_t rssi() const { return detail::read<uint8_t>(payload() + 4); }
+    uint8_t remrssi() const { return detail::read<uint8_t>(payload() + 5); }
+    uint8_t txbuf() const { return detail::read<uint8_t>(payload() + 6); }
+    uint8_t noise() const { return detail::read<uint8_t>(payload() + 7); }
+    uint8_t remnoise() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief LIMITS_STATUS (#167), read in place from the payload */
+class LimitsStatus
+{
+public:
+    enum { ID = 167, LENGTH = 22, CRC_EXTRA = 144 };
+    explicit LimitsStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t last_trigger() const { return detail::read<uint32_t>(payload() + 0); }
+    uint32_t last_action() const { return detail::read<uint32_t>(payload() + 4); }
+    uint32_t last_recovery() const { return detail::read<uint32_t>(payload() + 8); }
+    uint32_t last_clear() const { return detail::read<uint32_t>(payload() + 12); }
+    uint16_t breach_count() const { return detail::read<uint16_t>(payload() + 16); }
+    uint8_t limits_state() const { return detail::read<uint8_t>(payload() + 18); }
+    uint8_t mods_enabled() const { return detail::read<uint8_t>(payload() + 19); }
+    uint8_t mods_required() const { return detail::read<uint8_t>(payload() + 20); }
+    uint8_t mods_triggered() const { return detail::read<uint8_t>(payload() + 21); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief WIND (#168), read in place from the payload */
+class Wind
+{
+public:
+    enum { ID = 168, LENGTH = 12, CRC_EXTRA = 1 };
+    explicit Wind(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float direction() const { return detail::read<float>(payload() + 0); }
+    float speed() const { return detail::read<float>(payload() + 4); }
+    float speed_z() const { return detail::read<float>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA16 (#169), read in place from the payload */
+class Data16
+{
+public:
+    enum { ID = 169, LENGTH = 18, CRC_EXTRA = 234 };
+    explicit Data16(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t len() const { return detail::read<uint8_t>(payload() + 1); }
+    enum { DATA_LENGTH = 16 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 2 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA32 (#170), read in place from the payload */
+class Data32
+{
+public:
+    enum { ID = 170, LENGTH = 34, CRC_EXTRA = 73 };
+    explicit Data32(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t len() const { return detail::read<uint8_t>(payload() + 1); }
+    enum { DATA_LENGTH = 32 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 2 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA64 (#171), read in place from the payload */
+class Data64
+{
+public:
+    enum { ID = 171, LENGTH = 66, CRC_EXTRA = 181 };
+    explicit Data64(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t len() const { return detail::read<uint8_t>(payload() + 1); }
+    enum { DATA_LENGTH = 64 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 2 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DATA96 (#172), read in place from the payload */
+class Data96
+{
+public:
+    enum { ID = 172, LENGTH = 98, CRC_EXTRA = 22 };
+    explicit Data96(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t len() const { return detail::read<uint8_t>(payload() + 1); }
+    enum { DATA_LENGTH = 96 };
+    uint8_t data(int i) const { return detail::read<uint8_t>(payload() + 2 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RANGEFINDER (#173), read in place from the payload */
+class Rangefinder
+{
+public:
+    enum { ID = 173, LENGTH = 8, CRC_EXTRA = 83 };
+    explicit Rangefinder(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float distance() const { return detail::read<float>(payload() + 0); }
+    float voltage() const { return detail::read<float>(payload() + 4); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief AIRSPEED_AUTOCAL (#174), read in place from the payload */
+class AirspeedAutocal
+{
+public:
+    enum { ID = 174, LENGTH = 48, CRC_EXTRA = 167 };
+    explicit AirspeedAutocal(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float vx() const { return detail::read<float>(payload() + 0); }
+    float vy() const { return detail::read<float>(payload() + 4); }
+    float vz() const { return detail::read<float>(payload() + 8); }
+    float diff_pressure() const { return detail::read<float>(payload() + 12); }
+    float EAS2TAS() const { return detail::read<float>(payload() + 16); }
+    float ratio() const { return detail::read<float>(payload() + 20); }
+    float state_x() const { return detail::read<float>(payload() + 24); }
+    float state_y() const { return detail::read<float>(payload() + 28); }
+    float state_z() const { return detail::read<float>(payload() + 32); }
+    float Pax() const { return detail::read<float>(payload() + 36); }
+    float Pby() const { return detail::read<float>(payload() + 40); }
+    float Pcz() const { return detail::read<float>(payload() + 44); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RALLY_POINT (#175), read in place from the payload */
+class RallyPoint
+{
+public:
+    enum { ID = 175, LENGTH = 19, CRC_EXTRA = 138 };
+    explicit RallyPoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 0); }
+    int32_t lng() const { return detail::read<int32_t>(payload() + 4); }
+    int16_t alt() const { return detail::read<int16_t>(payload() + 8); }
+    int16_t break_alt() const { return detail::read<int16_t>(payload() + 10); }
+    uint16_t land_dir() const { return detail::read<uint16_t>(payload() + 12); }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 14); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 15); }
+    uint8_t idx() const { return detail::read<uint8_t>(payload() + 16); }
+    uint8_t count() const { return detail::read<uint8_t>(payload() + 17); }
+    uint8_t flags() const { return detail::read<uint8_t>(payload() + 18); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief RALLY_FETCH_POINT (#176), read in place from the payload */
+class RallyFetchPoint
+{
+public:
+    enum { ID = 176, LENGTH = 3, CRC_EXTRA = 234 };
+    explicit RallyFetchPoint(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t target_system() const { return detail::read<uint8_t>(payload() + 0); }
+    uint8_t target_component() const { return detail::read<uint8_t>(payload() + 1); }
+    uint8_t idx() const { return detail::read<uint8_t>(payload() + 2); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief COMPASSMOT_STATUS (#177), read in place from the payload */
+class CompassmotStatus
+{
+public:
+    enum { ID = 177, LENGTH = 20, CRC_EXTRA = 240 };
+    explicit CompassmotStatus(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float current() const { return detail::read<float>(payload() + 0); }
+    float CompensationX() const { return detail::read<float>(payload() + 4); }
+    float CompensationY() const { return detail::read<float>(payload() + 8); }
+    float CompensationZ() const { return detail::read<float>(payload() + 12); }
+    uint16_t throttle() const { return detail::read<uint16_t>(payload() + 16); }
+    uint16_t interference() const { return detail::read<uint16_t>(payload() + 18); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief AHRS2 (#178), read in place from the payload */
+class Ahrs2
+{
+public:
+    enum { ID = 178, LENGTH = 24, CRC_EXTRA = 47 };
+    explicit Ahrs2(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    float roll() const { return detail::read<float>(payload() + 0); }
+    float pitch() const { return detail::read<float>(payload() + 4); }
+    float yaw() const { return detail::read<float>(payload() + 8); }
+    float altitude() const { return detail::read<float>(payload() + 12); }
+    int32_t lat() const { return detail::read<int32_t>(payload() + 16); }
+    int32_t lng() const { return detail::read<int32_t>(payload() + 20); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief MEMORY_VECT (#249), read in place from the payload */
+class MemoryVect
+{
+public:
+    enum { ID = 249, LENGTH = 36, CRC_EXTRA = 204 };
+    explicit MemoryVect(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint16_t address() const { return detail::read<uint16_t>(payload() + 0); }
+    uint8_t ver() const { return detail::read<uint8_t>(payload() + 2); }
+    uint8_t type() const { return detail::read<uint8_t>(payload() + 3); }
+    enum { VALUE_LENGTH = 32 };
+    int8_t value(int i) const { return detail::read<int8_t>(payload() + 4 + i * 1); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DEBUG_VECT (#250), read in place from the payload */
+class DebugVect
+{
+public:
+    enum { ID = 250, LENGTH = 30, CRC_EXTRA = 49 };
+    explicit DebugVect(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint64_t time_usec() const { return detail::read<uint64_t>(payload() + 0); }
+    float x() const { return detail::read<float>(payload() + 8); }
+    float y() const { return detail::read<float>(payload() + 12); }
+    float z() const { return detail::read<float>(payload() + 16); }
+    enum { NAME_LENGTH = 10 };
+    /** @brief Not terminated when all 10 characters are used */
+    const char *name() const { return payload() + 20; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief NAMED_VALUE_FLOAT (#251), read in place from the payload */
+class NamedValueFloat
+{
+public:
+    enum { ID = 251, LENGTH = 18, CRC_EXTRA = 170 };
+    explicit NamedValueFloat(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float value() const { return detail::read<float>(payload() + 4); }
+    enum { NAME_LENGTH = 10 };
+    /** @brief Not terminated when all 10 characters are used */
+    const char *name() const { return payload() + 8; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief NAMED_VALUE_INT (#252), read in place from the payload */
+class NamedValueInt
+{
+public:
+    enum { ID = 252, LENGTH = 18, CRC_EXTRA = 44 };
+    explicit NamedValueInt(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    int32_t value() const { return detail::read<int32_t>(payload() + 4); }
+    enum { NAME_LENGTH = 10 };
+    /** @brief Not terminated when all 10 characters are used */
+    const char *name() const { return payload() + 8; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief STATUSTEXT (#253), read in place from the payload */
+class Statustext
+{
+public:
+    enum { ID = 253, LENGTH = 51, CRC_EXTRA = 83 };
+    explicit Statustext(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint8_t severity() const { return detail::read<uint8_t>(payload() + 0); }
+    enum { TEXT_LENGTH = 50 };
+    /** @brief Not terminated when all 50 characters are used */
+    const char *text() const { return payload() + 1; }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/** @brief DEBUG (#254), read in place from the payload */
+class Debug
+{
+public:
+    enum { ID = 254, LENGTH = 9, CRC_EXTRA = 46 };
+    explicit Debug(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+    uint32_t time_boot_ms() const { return detail::read<uint32_t>(payload() + 0); }
+    float value() const { return detail::read<float>(payload() + 4); }
+    uint8_t ind() const { return detail::read<uint8_t>(payload() + 8); }
+
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+
+/**
+ * @brief Static dispatch to per message handlers:
+ *
+ *   class Vehicle : public mavlink::Handler<Vehicle>
+ *   {
+ *   public:
+ *       void onAttitude(const mavlink::Attitude &attitude);
+ *   };
+ *
+ * Messages the derived class has no handler for go to the empty defaults
+ * below, which the compiler drops. Nothing is copied out of the message.
+ */
+template <class Derived>
+class Handler
+{
+public:
+    /** @brief False for message IDs this dialect does not define */
+    bool dispatch(const mavlink_message_t &msg)
+    {
+        Derived &self = static_cast<Derived&>(*this);
+        switch (msg.msgid)
+        {
+        case 0: self.onHeartbeat(Heartbeat(msg)); return true;
+        case 1: self.onSysStatus(SysStatus(msg)); return true;
+        case 2: self.onSystemTime(SystemTime(msg)); return true;
+        case 4: self.onPing(Ping(msg)); return true;
+        case 5: self.onChangeOperatorControl(ChangeOperatorControl(msg)); return true;
+        case 6: self.onChangeOperatorControlAck(ChangeOperatorControlAck(msg)); return true;
+        case 7: self.onAuthKey(AuthKey(msg)); return true;
+        case 11: self.onSetMode(SetMode(msg)); return true;
+        case 20: self.onParamRequestRead(ParamRequestRead(msg)); return true;
+        case 21: self.onParamRequestList(ParamRequestList(msg)); return true;
+        case 22: self.onParamValue(ParamValue(msg)); return true;
+        case 23: self.onParamSet(ParamSet(msg)); return true;
+        case 24: self.onGpsRawInt(GpsRawInt(msg)); return true;
+        case 25: self.onGpsStatus(GpsStatus(msg)); return true;
+        case 26: self.onScaledImu(ScaledImu(msg)); return true;
+        case 27: self.onRawImu(RawImu(msg)); return true;
+        case 28: self.onRawPressure(RawPressure(msg)); return true;
+        case 29: self.onScaledPressure(ScaledPressure(msg)); return true;
+        case 30: self.onAttitude(Attitude(msg)); return true;
+        case 31: self.onAttitudeQuaternion(AttitudeQuaternion(msg)); return true;
+        case 32: self.onLocalPositionNed(LocalPositionNed(msg)); return true;
+        case 33: self.onGlobalPositionInt(GlobalPositionInt(msg)); return true;
+        case 34: self.onRcChannelsScaled(RcChannelsScaled(msg)); return true;
+        case 35: self.onRcChannelsRaw(RcChannelsRaw(msg)); return true;
+        case 36: self.onServoOutputRaw(ServoOutputRaw(msg)); return true;
+        case 37: self.onMissionRequestPartialList(MissionRequestPartialList(msg)); return true;
+        case 38: self.onMissionWritePartialList(MissionWritePartialList(msg)); return true;
+        case 39: self.onMissionItem(MissionItem(msg)); return true;
+        case 40: self.onMissionRequest(MissionRequest(msg)); return true;
+        case 41: self.onMissionSetCurrent(MissionSetCurrent(msg)); return true;
+        case 42: self.onMissionCurrent(MissionCurrent(msg)); return true;
+        case 43: self.onMissionRequestList(MissionRequestList(msg)); return true;
+        case 44: self.onMissionCount(MissionCount(msg)); return true;
+        case 45: self.onMissionClearAll(MissionClearAll(msg)); return true;
+        case 46: self.onMissionItemReached(MissionItemReached(msg)); return true;
+        case 47: self.onMissionAck(MissionAck(msg)); return true;
+        case 48: self.onSetGpsGlobalOrigin(SetGpsGlobalOrigin(msg)); return true;
+        case 49: self.onGpsGlobalOrigin(GpsGlobalOrigin(msg)); return true;
+        case 50: self.onSetLocalPositionSetpoint(SetLocalPositionSetpoint(msg)); return true;
+        case 51: self.onLocalPositionSetpoint(LocalPositionSetpoint(msg)); return true;
+        case 52: self.onGlobalPositionSetpointInt(GlobalPositionSetpointInt(msg)); return true;
+        case 53: self.onSetGlobalPositionSetpointInt(SetGlobalPositionSetpointInt(msg)); return true;
+        case 54: self.onSafetySetAllowedArea(SafetySetAllowedArea(msg)); return true;
+        case 55: self.onSafetyAllowedArea(SafetyAllowedArea(msg)); return true;
+        case 56: self.onSetRollPitchYawThrust(SetRollPitchYawThrust(msg)); return true;
+        case 57: self.onSetRollPitchYawSpeedThrust(SetRollPitchYawSpeedThrust(msg)); return true;
+        case 58: self.onRollPitchYawThrustSetpoint(RollPitchYawThrustSetpoint(msg)); return true;
+        case 59: self.onRollPitchYawSpeedThrustSetpoint(RollPitchYawSpeedThrustSetpoint(msg)); return true;
+        case 60: self.onSetQuadMotorsSetpoint(SetQuadMotorsSetpoint(msg)); return true;
+        case 61: self.onSetQuadSwarmRollPitchYawThrust(SetQuadSwarmRollPitchYawThrust(msg)); return true;
+        case 62: self.onNavControllerOutput(NavControllerOutput(msg)); return true;
+        case 63: self.onSetQuadSwarmLedRollPitchYawThrust(SetQuadSwarmLedRollPitchYawThrust(msg)); return true;
+        case 64: self.onStateCorrection(StateCorrection(msg)); return true;
+        case 65: self.onRcChannels(RcChannels(msg)); return true;
+        case 66: self.onRequestDataStream(RequestDataStream(msg)); return true;
+        case 67: self.onDataStream(DataStream(msg)); return true;
+        case 69: self.onManualControl(ManualControl(msg)); return true;
+        case 70: self.onRcChannelsOverride(RcChannelsOverride(msg)); return true;
+        case 74: self.onVfrHud(VfrHud(msg)); return true;
+        case 76: self.onCommandLong(CommandLong(msg)); return true;
+        case 77: self.onCommandAck(CommandAck(msg)); return true;
+        case 80: self.onRollPitchYawRatesThrustSetpoint(RollPitchYawRatesThrustSetpoint(msg)); return true;
+        case 81: self.onManualSetpoint(ManualSetpoint(msg)); return true;
+        case 89: self.onLocalPositionNedSystemGlobalOffset(LocalPositionNedSystemGlobalOffset(msg)); return true;
+        case 90: self.onHilState(HilState(msg)); return true;
+        case 91: self.onHilControls(HilControls(msg)); return true;
+        case 92: self.onHilRcInputsRaw(HilRcInputsRaw(msg)); return true;
+        case 100: self.onOpticalFlow(OpticalFlow(msg)); return true;
+        case 101: self.onGlobalVisionPositionEstimate(GlobalVisionPositionEstimate(msg)); return true;
+        case 102: self.onVisionPositionEstimate(VisionPositionEstimate(msg)); return true;
+        case 103: self.onVisionSpeedEstimate(VisionSpeedEstimate(msg)); return true;
+        case 104: self.onViconPositionEstimate(ViconPositionEstimate(msg)); return true;
+        case 105: self.onHighresImu(HighresImu(msg)); return true;
+        case 106: self.onOmnidirectionalFlow(OmnidirectionalFlow(msg)); return true;
+        case 107: self.onHilSensor(HilSensor(msg)); return true;
+        case 108: self.onSimState(SimState(msg)); return true;
+        case 109: self.onRadioStatus(RadioStatus(msg)); return true;
+        case 110: self.onFileTransferStart(FileTransferStart(msg)); return true;
+        case 111: self.onFileTransferDirList(FileTransferDirList(msg)); return true;
+        case 112: self.onFileTransferRes(FileTransferRes(msg)); return true;
+        case 113: self.onHilGps(HilGps(msg)); return true;
+        case 114: self.onHilOpticalFlow(HilOpticalFlow(msg)); return true;
+        case 115: self.onHilStateQuaternion(HilStateQuaternion(msg)); return true;
+        case 116: self.onScaledImu2(ScaledImu2(msg)); return true;
+        case 117: self.onLogRequestList(LogRequestList(msg)); return true;
+        case 118: self.onLogEntry(LogEntry(msg)); return true;
+        case 119: self.onLogRequestData(LogRequestData(msg)); return true;
+        case 120: self.onLogData(LogData(msg)); return true;
+        case 121: self.onLogErase(LogErase(msg)); return true;
+        case 122: self.onLogRequestEnd(LogRequestEnd(msg)); return true;
+        case 123: self.onGpsInjectData(GpsInjectData(msg)); return true;
+        case 124: self.onGps2Raw(Gps2Raw(msg)); return true;
+        case 125: self.onPowerStatus(PowerStatus(msg)); return true;
+        case 126: self.onSerialControl(SerialControl(msg)); return true;
+        case 130: self.onDataTransmissionHandshake(DataTransmissionHandshake(msg)); return true;
+        case 131: self.onEncapsulatedData(EncapsulatedData(msg)); return true;
+        case 147: self.onBatteryStatus(BatteryStatus(msg)); return true;
+        case 148: self.onSetpoint8dof(Setpoint8dof(msg)); return true;
+        case 149: self.onSetpoint6dof(Setpoint6dof(msg)); return true;
+        case 150: self.onSensorOffsets(SensorOffsets(msg)); return true;
+        case 151: self.onSetMagOffsets(SetMagOffsets(msg)); return true;
+        case 152: self.onMeminfo(Meminfo(msg)); return true;
+        case 153: self.onApAdc(ApAdc(msg)); return true;
+        case 154: self.onDigicamConfigure(DigicamConfigure(msg)); return true;
+        case 155: self.onDigicamControl(DigicamControl(msg)); return true;
+        case 156: self.onMountConfigure(MountConfigure(msg)); return true;
+        case 157: self.onMountControl(MountControl(msg)); return true;
+        case 158: self.onMountStatus(MountStatus(msg)); return true;
+        case 160: self.onFencePoint(FencePoint(msg)); return true;
+        case 161: self.onFenceFetchPoint(FenceFetchPoint(msg)); return true;
+        case 162: self.onFenceStatus(FenceStatus(msg)); return true;
+        case 163: self.onAhrs(Ahrs(msg)); return true;
+        case 164: self.onSimstate(Simstate(msg)); return true;
+        case 165: self.onHwstatus(Hwstatus(msg)); return true;
+        case 166: self.onRadio(Radio(msg)); return true;
+        case 167: self.onLimitsStatus(LimitsStatus(msg)); return true;
+        case 168: self.onWind(Wind(msg)); return true;
+        case 169: self.onData16(Data16(msg)); return true;
+        case 170: self.onData32(Data32(msg)); return true;
+        case 171: self.onData64(Data64(msg)); return true;
+        case 172: self.onData96(Data96(msg)); return true;
+        case 173: self.onRangefinder(Rangefinder(msg)); return true;
+        case 174: self.onAirspeedAutocal(AirspeedAutocal(msg)); return true;
+        case 175: self.onRallyPoint(RallyPoint(msg)); return true;
+        case 176: self.onRallyFetchPoint(RallyFetchPoint(msg)); return true;
+        case 177: self.onCompassmotStatus(CompassmotStatus(msg)); return true;
+        case 178: self.onAhrs2(Ahrs2(msg)); return true;
+        case 249: self.onMemoryVect(MemoryVect(msg)); return true;
+        case 250: self.onDebugVect(DebugVect(msg)); return true;
+        case 251: self.onNamedValueFloat(NamedValueFloat(msg)); return true;
+        case 252: self.onNamedValueInt(NamedValueInt(msg)); return true;
+        case 253: self.onStatustext(Statustext(msg)); return true;
+        case 254: self.onDebug(Debug(msg)); return true;
+        default: self.onUnknown(msg); return false;
+        }
+    }
+
+    void onHeartbeat(const Heartbeat &) { }
+    void onSysStatus(const SysStatus &) { }
+    void onSystemTime(const SystemTime &) { }
+    void onPing(const Ping &) { }
+    void onChangeOperatorControl(const ChangeOperatorControl &) { }
+    void onChangeOperatorControlAck(const ChangeOperatorControlAck &) { }
+    void onAuthKey(const AuthKey &) { }
+    void onSetMode(const SetMode &) { }
+    void onParamRequestRead(const ParamRequestRead &) { }
+    void onParamRequestList(const ParamRequestList &) { }
+    void onParamValue(const ParamValue &) { }
+    void onParamSet(const ParamSet &) { }
+    void onGpsRawInt(const GpsRawInt &) { }
+    void onGpsStatus(const GpsStatus &) { }
+    void onScaledImu(const ScaledImu &) { }
+    void onRawImu(const RawImu &) { }
+    void onRawPressure(const RawPressure &) { }
+    void onScaledPressure(const ScaledPressure &) { }
+    void onAttitude(const Attitude &) { }
+    void onAttitudeQuaternion(const AttitudeQuaternion &) { }
+    void onLocalPositionNed(const LocalPositionNed &) { }
+    void onGlobalPositionInt(const GlobalPositionInt &) { }
+    void onRcChannelsScaled(const RcChannelsScaled &) { }
+    void onRcChannelsRaw(const RcChannelsRaw &) { }
+    void onServoOutputRaw(const ServoOutputRaw &) { }
+    void onMissionRequestPartialList(const MissionRequestPartialList &) { }
+    void onMissionWritePartialList(const MissionWritePartialList &) { }
+    void onMissionItem(const MissionItem &) { }
+    void onMissionRequest(const MissionRequest &) { }
+    void onMissionSetCurrent(const MissionSetCurrent &) { }
+    void onMissionCurrent(const MissionCurrent &) { }
+    void onMissionRequestList(const MissionRequestList &) { }
+    void onMissionCount(const MissionCount &) { }
+    void onMissionClearAll(const MissionClearAll &) { }
+    void onMissionItemReached(const MissionItemReached &) { }
+    void onMissionAck(const MissionAck &) { }
+    void onSetGpsGlobalOrigin(const SetGpsGlobalOrigin &) { }
+    void onGpsGlobalOrigin(const GpsGlobalOrigin &) { }
+    void onSetLocalPositionSetpoint(const SetLocalPositionSetpoint &) { }
+    void onLocalPositionSetpoint(const LocalPositionSetpoint &) { }
+    void onGlobalPositionSetpointInt(const GlobalPositionSetpointInt &) { }
+    void onSetGlobalPositionSetpointInt(const SetGlobalPositionSetpointInt &) { }
+    void onSafetySetAllowedArea(const SafetySetAllowedArea &) { }
+    void onSafetyAllowedArea(const SafetyAllowedArea &) { }
+    void onSetRollPitchYawThrust(const SetRollPitchYawThrust &) { }
+    void onSetRollPitchYawSpeedThrust(const SetRollPitchYawSpeedThrust &) { }
+    void onRollPitchYawThrustSetpoint(const RollPitchYawThrustSetpoint &) { }
+    void onRollPitchYawSpeedThrustSetpoint(const RollPitchYawSpeedThrustSetpoint &) { }
+    void onSetQuadMotorsSetpoint(const SetQuadMotorsSetpoint &) { }
+    void onSetQuadSwarmRollPitchYawThrust(const SetQuadSwarmRollPitchYawThrust &) { }
+    void onNavControllerOutput(const NavControllerOutput &) { }
+    void onSetQuadSwarmLedRollPitchYawThrust(const SetQuadSwarmLedRollPitchYawThrust &) { }
+    void onStateCorrection(const StateCorrection &) { }
+    void onRcChannels(const RcChannels &) { }
+    void onRequestDataStream(const RequestDataStream &) { }
+    void onDataStream(const DataStream &) { }
+    void onManualControl(const ManualControl &) { }
+    void onRcChannelsOverride(const RcChannelsOverride &) { }
+    void onVfrHud(const VfrHud &) { }
+    void onCommandLong(const CommandLong &) { }
+    void onCommandAck(const CommandAck &) { }
+    void onRollPitchYawRatesThrustSetpoint(const RollPitchYawRatesThrustSetpoint &) { }
+    void onManualSetpoint(const ManualSetpoint &) { }
+    void onLocalPositionNedSystemGlobalOffset(const LocalPositionNedSystemGlobalOffset &) { }
+    void onHilState(const HilState &) { }
+    void onHilControls(const HilControls &) { }
+    void onHilRcInputsRaw(const HilRcInputsRaw &) { }
+    void onOpticalFlow(const OpticalFlow &) { }
+    void onGlobalVisionPositionEstimate(const GlobalVisionPositionEstimate &) { }
+    void onVisionPositionEstimate(const VisionPositionEstimate &) { }
+    void onVisionSpeedEstimate(const VisionSpeedEstimate &) { }
+    void onViconPositionEstimate(const ViconPositionEstimate &) { }
+    void onHighresImu(const HighresImu &) { }
+    void onOmnidirectionalFlow(const OmnidirectionalFlow &) { }
+    void onHilSensor(const HilSensor &) { }
+    void onSimState(const SimState &) { }
+    void onRadioStatus(const RadioStatus &) { }
+    void onFileTransferStart(const FileTransferStart &) { }
+    void onFileTransferDirList(const FileTransferDirList &) { }
+    void onFileTransferRes(const FileTransferRes &) { }
+    void onHilGps(const HilGps &) { }
+    void onHilOpticalFlow(const HilOpticalFlow &) { }
+    void onHilStateQuaternion(const HilStateQuaternion &) { }
+    void onScaledImu2(const ScaledImu2 &) { }
+    void onLogRequestList(const LogRequestList &) { }
+    void onLogEntry(const LogEntry &) { }
+    void onLogRequestData(const LogRequestData &) { }
+    void onLogData(const LogData &) { }
+    void onLogErase(const LogErase &) { }
+    void onLogRequestEnd(const LogRequestEnd &) { }
+    void onGpsInjectData(const GpsInjectData &) { }
+    void onGps2Raw(const Gps2Raw &) { }
+    void onPowerStatus(const PowerStatus &) { }
+    void onSerialControl(const SerialControl &) { }
+    void onDataTransmissionHandshake(const DataTransmissionHandshake &) { }
+    void onEncapsulatedData(const EncapsulatedData &) { }
+    void onBatteryStatus(const BatteryStatus &) { }
+    void onSetpoint8dof(const Setpoint8dof &) { }
+    void onSetpoint6dof(const Setpoint6dof &) { }
+    void onSensorOffsets(const SensorOffsets &) { }
+    void onSetMagOffsets(const SetMagOffsets &) { }
+    void onMeminfo(const Meminfo &) { }
+    void onApAdc(const ApAdc &) { }
+    void onDigicamConfigure(const DigicamConfigure &) { }
+    void onDigicamControl(const DigicamControl &) { }
+    void onMountConfigure(const MountConfigure &) { }
+    void onMountControl(const MountControl &) { }
+    void onMountStatus(const MountStatus &) { }
+    void onFencePoint(const FencePoint &) { }
+    void onFenceFetchPoint(const FenceFetchPoint &) { }
+    void onFenceStatus(const FenceStatus &) { }
+    void onAhrs(const Ahrs &) { }
+    void onSimstate(const Simstate &) { }
+    void onHwstatus(const Hwstatus &) { }
+    void onRadio(const Radio &) { }
+    void onLimitsStatus(const LimitsStatus &) { }
+    void onWind(const Wind &) { }
+    void onData16(const Data16 &) { }
+    void onData32(const Data32 &) { }
+    void onData64(const Data64 &) { }
+    void onData96(const Data96 &) { }
+    void onRangefinder(const Rangefinder &) { }
+    void onAirspeedAutocal(const AirspeedAutocal &) { }
+    void onRallyPoint(const RallyPoint &) { }
+    void onRallyFetchPoint(const RallyFetchPoint &) { }
+    void onCompassmotStatus(const CompassmotStatus &) { }
+    void onAhrs2(const Ahrs2 &) { }
+    void onMemoryVect(const MemoryVect &) { }
+    void onDebugVect(const DebugVect &) { }
+    void onNamedValueFloat(const NamedValueFloat &) { }
+    void onNamedValueInt(const NamedValueInt &) { }
+    void onStatustext(const Statustext &) { }
+    void onDebug(const Debug &) { }
+    void onUnknown(const mavlink_message_t &) { }
+};
+
+template <class H>
+inline bool dispatch(H &handler, const mavlink_message_t &msg)
+{
+    return handler.dispatch(msg);
+}
+
+} // namespace mavlink
+
+#endif // MAVLINK_ARDUPILOTMEGA_HPP
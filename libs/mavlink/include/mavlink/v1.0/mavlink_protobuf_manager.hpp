@@ -1,7 +1,9 @@
 #ifndef MAVLINKPROTOBUFMANAGER_HPP
 #define MAVLINKPROTOBUFMANAGER_HPP
 
-#include <deque>
+#include <algorithm>
+#include <map>
+#include <vector>
 #include <google/protobuf/message.h>
 #include <iostream>
 #include <tr1/memory>
@@ -141,7 +143,18 @@ public:
 
 	bool cacheFragment(mavlink_extended_message_t& msg)
 	{
-		if (!validFragment(msg))
+		return cacheFragment(msg.base_msg, msg.extended_payload, msg.extended_payload_len);
+	}
+
+	/**
+	 * Add one fragment to the message of its stream. header is the
+	 * MAVLINK_MSG_ID_EXTENDED_MESSAGE frame, payload the extended payload
+	 * that followed it; it is appended straight to the reassembly buffer of
+	 * the stream, which keeps its capacity from one message to the next.
+	 */
+	bool cacheFragment(const mavlink_message_t& header, const uint8_t* payload, int payloadLength)
+	{
+		if (!validFragment(header))
 		{
 			if (mVerbose)
 			{
@@ -152,18 +165,18 @@ public:
 		}
 
 		// read extended header
-		uint8_t* payload = reinterpret_cast<uint8_t*>(msg.base_msg.payload64);
+		const uint8_t* extendedHeader = reinterpret_cast<const uint8_t*>(header.payload64);
 		uint8_t typecode = 0;
 		unsigned int length = 0;
 		unsigned short streamID = 0;
 		unsigned int offset = 0;
 		uint8_t flags = 0;
 
-		memcpy(&typecode, payload + 2, 1);
-		memcpy(&length, payload + 3, 4);
-		memcpy(&streamID, payload + 7, 2);
-		memcpy(&offset, payload + 9, 4);
-		memcpy(&flags, payload + 13, 1);
+		memcpy(&typecode, extendedHeader + 2, 1);
+		memcpy(&length, extendedHeader + 3, 4);
+		memcpy(&streamID, extendedHeader + 7, 2);
+		memcpy(&offset, extendedHeader + 9, 4);
+		memcpy(&flags, extendedHeader + 13, 1);
 
 		if (typecode >= mTypeMap.size())
 		{
@@ -172,106 +185,43 @@ public:
 			return false;
 		}
 
-		bool reassemble = false;
-
-		FragmentQueue::iterator it = mFragmentQueue.find(streamID);
-		if (it == mFragmentQueue.end())
+		Reassembly& stream = mStreams[streamID];
+		if (offset == 0)
 		{
-			if (offset == 0)
-			{
-				mFragmentQueue[streamID].push_back(msg);
-
-				if ((flags & 0x1) != 0x1)
-				{
-					reassemble = true;
-				}
-
-				if (mVerbose)
-				{
-					std::cerr << "# INFO: Added fragment to new queue."
-							  << std::endl;
-				}
-			}
-			else
+			stream.data.clear();
+			stream.typecode = typecode;
+			if (mVerbose)
 			{
-				if (mVerbose)
-				{
-					std::cerr << "# WARNING: Message is not a valid fragment. "
-							  << "Dropping message..." << std::endl;
-				}
+				std::cerr << "# INFO: Started message of stream " << streamID << "." << std::endl;
 			}
 		}
-		else
+		else if (stream.data.empty() || stream.nextOffset != offset)
 		{
-			std::deque<mavlink_extended_message_t>& queue = it->second;
-
-			if (queue.empty())
-			{
-				if (offset == 0)
-				{
-					queue.push_back(msg);
-
-					if ((flags & 0x1) != 0x1)
-					{
-						reassemble = true;
-					}
-				}
-				else
-				{
-					if (mVerbose)
-					{
-						std::cerr << "# WARNING: Message is not a valid fragment. "
-								  << "Dropping message..." << std::endl;
-					}
-				}
-			}
-			else
+			if (mVerbose)
 			{
-				if (fragmentDataSize(queue.back()) + fragmentOffset(queue.back()) != offset)
-				{
-					if (mVerbose)
-					{
-						std::cerr << "# WARNING: Previous fragment(s) have been lost. "
-								  << "Dropping message and clearing queue..." << std::endl;
-					}
-					queue.clear();
-				}
-				else
-				{
-					queue.push_back(msg);
-
-					if ((flags & 0x1) != 0x1)
-					{
-						reassemble = true;
-					}
-				}
+				std::cerr << "# WARNING: Previous fragment(s) have been lost. "
+						  << "Dropping message and clearing queue..." << std::endl;
 			}
+			stream.data.clear();
+			return true;
 		}
 
-		if (reassemble)
-		{
-			std::deque<mavlink_extended_message_t>& queue = mFragmentQueue[streamID];
-
-			std::string data;
-			for (size_t i = 0; i < queue.size(); ++i)
-			{
-				mavlink_extended_message_t& mavlink_msg = queue.at(i);
-
-				data.append(reinterpret_cast<char*>(&mavlink_msg.extended_payload[0]),
-							static_cast<size_t>(mavlink_msg.extended_payload_len));
-			}
-
-			mMessages.at(typecode)->ParseFromString(data);
-
-			mMessageAvailable.at(typecode) = true;
+		const size_t size = static_cast<size_t>(std::max(0, std::min(payloadLength, kExtendedPayloadMaxSize)));
+		stream.data.insert(stream.data.end(), payload, payload + size);
+		stream.nextOffset = offset + length;
 
-			queue.clear();
+		if ((flags & 0x1) != 0x1)
+		{
+			google::protobuf::Message& message = *mMessages.at(stream.typecode);
+			message.ParseFromArray(stream.data.empty() ? NULL : &stream.data[0], static_cast<int>(stream.data.size()));
+			mMessageAvailable.at(stream.typecode) = true;
+			stream.data.clear();
 
 			if (mVerbose)
 			{
 				std::cerr << "# INFO: Reassembled fragments for message with typename "
-						  << mMessages.at(typecode)->GetTypeName() << " and size "
-						  << mMessages.at(typecode)->ByteSize()
+						  << message.GetTypeName() << " and size "
+						  << message.ByteSize()
 						  << "." << std::endl;
 			}
 		}
@@ -304,25 +254,25 @@ private:
 		mMessageAvailable.push_back(false);
 	}
 
-	bool validFragment(const mavlink_extended_message_t& msg) const
+	bool validFragment(const mavlink_message_t& msg) const
 	{
-		if (msg.base_msg.magic != MAVLINK_STX ||
-			msg.base_msg.len != kExtendedHeaderSize ||
-			msg.base_msg.msgid != MAVLINK_MSG_ID_EXTENDED_MESSAGE)
+		if (msg.magic != MAVLINK_STX ||
+			msg.len != kExtendedHeaderSize ||
+			msg.msgid != MAVLINK_MSG_ID_EXTENDED_MESSAGE)
 		{
 			return false;
 		}
 
 		uint16_t checksum;
-		checksum = crc_calculate(reinterpret_cast<const uint8_t*>(&msg.base_msg.len), MAVLINK_CORE_HEADER_LEN);
-		crc_accumulate_buffer(&checksum, reinterpret_cast<const char*>(&msg.base_msg.payload64), kExtendedHeaderSize);
+		checksum = crc_calculate(reinterpret_cast<const uint8_t*>(&msg.len), MAVLINK_CORE_HEADER_LEN);
+		crc_accumulate_buffer(&checksum, reinterpret_cast<const char*>(&msg.payload64), kExtendedHeaderSize);
 #if MAVLINK_CRC_EXTRA
 		static const uint8_t mavlink_message_crcs[256] = MAVLINK_MESSAGE_CRCS;
-		crc_accumulate(mavlink_message_crcs[msg.base_msg.msgid], &checksum);
+		crc_accumulate(mavlink_message_crcs[msg.msgid], &checksum);
 #endif
 
-		if (mavlink_ck_a(&(msg.base_msg)) != (uint8_t)(checksum & 0xFF) &&
-		    mavlink_ck_b(&(msg.base_msg)) != (uint8_t)(checksum >> 8))
+		if (mavlink_ck_a(&msg) != (uint8_t)(checksum & 0xFF) &&
+		    mavlink_ck_b(&msg) != (uint8_t)(checksum >> 8))
 		{
 			return false;
 		}
@@ -330,20 +280,6 @@ private:
 		return true;
 	}
 
-	unsigned int fragmentDataSize(const mavlink_extended_message_t& msg) const
-	{
-		const uint8_t* payload = reinterpret_cast<const uint8_t*>(msg.base_msg.payload64);
-
-		return *(reinterpret_cast<const unsigned int*>(payload + 3));
-	}
-
-	unsigned int fragmentOffset(const mavlink_extended_message_t& msg) const
-	{
-		const uint8_t* payload = reinterpret_cast<const uint8_t*>(msg.base_msg.payload64);
-
-		return *(reinterpret_cast<const unsigned int*>(payload + 9));
-	}
-
 	int mRegisteredTypeCount;
 	unsigned short mStreamID;
 	bool mVerbose;
@@ -353,8 +289,15 @@ private:
 	std::vector< std::tr1::shared_ptr<google::protobuf::Message> > mMessages;
 	std::vector<bool> mMessageAvailable;
 
-	typedef std::map<unsigned short, std::deque<mavlink_extended_message_t> > FragmentQueue;
-	FragmentQueue mFragmentQueue;
+	struct Reassembly
+	{
+		Reassembly() : typecode(0), nextOffset(0) {}
+		uint8_t typecode;
+		unsigned int nextOffset;	///< Offset the next fragment must have
+		std::vector<char> data;		///< Payload so far, cleared but not freed between messages
+	};
+	typedef std::map<unsigned short, Reassembly> StreamMap;
+	StreamMap mStreams;
 
 	const int kExtendedHeaderSize;
 	/**
@@ -16,6 +16,7 @@ def mavgen(opts, args) :
     import mavparse
     import mavgen_python
     import mavgen_c
+    import mavgen_cpp
 
     xml = []
 
@@ -55,6 +56,10 @@ def mavgen(opts, args) :
         mavgen_python.generate(opts.output, xml)
     elif opts.language == 'C':
         mavgen_c.generate(opts.output, xml)
+    elif opts.language == 'C++':
+        # the views sit on top of the C headers
+        mavgen_c.generate(opts.output, xml)
+        mavgen_cpp.generate(opts.output, xml)
     else:
         print("Unsupported language %s" % opts.language)
     
@@ -73,7 +78,7 @@ if __name__=="__main__":
 
     parser = OptionParser("%prog [options] <XML files>")
     parser.add_option("-o", "--output", dest="output", default="mavlink", help="output directory.")
-    parser.add_option("--lang", dest="language", default="python", help="language of generated code: 'Python' or 'C' [default: %default]")
+    parser.add_option("--lang", dest="language", default="python", help="language of generated code: 'Python', 'C' or 'C++' [default: %default]")
     parser.add_option("--wire-protocol", dest="wire_protocol", default=mavparse.PROTOCOL_0_9, help="MAVLink protocol version: '0.9' or '1.0'. [default: %default]")
     (opts, args) = parser.parse_args()
 
@@ -0,0 +1,386 @@
+#!/usr/bin/env python
+'''
+parse a MAVLink protocol XML file and generate typed C++ views and a
+template dispatcher on top of the C implementation
+
+The generated mavlink.hpp needs the C headers of the same dialect, mavgen.py
+--lang=C++ writes both. It only uses C++03, the message table is a compile time initialised
+aggregate and the per message constants are enums.
+
+Released under GNU GPL version 3 or later
+'''
+
+from __future__ import print_function
+
+import sys, os, re
+
+# C++ keywords that may turn up as field names
+keywords = set(['auto', 'bool', 'break', 'case', 'char', 'class', 'const', 'default',
+                'delete', 'do', 'double', 'else', 'enum', 'float', 'for', 'friend',
+                'int', 'long', 'new', 'operator', 'private', 'protected', 'public',
+                'register', 'return', 'short', 'signed', 'sizeof', 'static', 'struct',
+                'switch', 'template', 'this', 'union', 'unsigned', 'virtual', 'void',
+                'volatile', 'while'])
+
+type_ids = {
+    'char'     : 'MAVLINK_TYPE_CHAR',
+    'uint8_t'  : 'MAVLINK_TYPE_UINT8_T',
+    'int8_t'   : 'MAVLINK_TYPE_INT8_T',
+    'uint16_t' : 'MAVLINK_TYPE_UINT16_T',
+    'int16_t'  : 'MAVLINK_TYPE_INT16_T',
+    'uint32_t' : 'MAVLINK_TYPE_UINT32_T',
+    'int32_t'  : 'MAVLINK_TYPE_INT32_T',
+    'uint64_t' : 'MAVLINK_TYPE_UINT64_T',
+    'int64_t'  : 'MAVLINK_TYPE_INT64_T',
+    'float'    : 'MAVLINK_TYPE_FLOAT',
+    'double'   : 'MAVLINK_TYPE_DOUBLE'
+    }
+
+type_lengths = {
+    'char' : 1, 'uint8_t' : 1, 'int8_t' : 1, 'uint16_t' : 2, 'int16_t' : 2,
+    'uint32_t' : 4, 'int32_t' : 4, 'uint64_t' : 8, 'int64_t' : 8, 'float' : 4, 'double' : 8
+    }
+
+
+def class_name(name):
+    '''GLOBAL_POSITION_INT -> GlobalPositionInt, 6DOF_SETPOINT -> Msg6dofSetpoint'''
+    cname = ''.join([part.capitalize() for part in name.lower().split('_') if part])
+    if cname[0].isdigit():
+        cname = 'Msg' + cname
+    return cname
+
+
+def member_name(name):
+    if name in keywords or name in ('message', 'payload'):
+        return name + '_'
+    return name
+
+
+def field_type(f):
+    # uint8_t_mavlink_version is a uint8_t on the wire
+    if f.type.startswith('uint8_t'):
+        return 'uint8_t'
+    return f.type
+
+
+def write_view(out, m):
+    '''one read only view class'''
+    cname = class_name(m.name)
+    out.append('''
+/** @brief %s (#%u), read in place from the payload */
+class %s
+{
+public:
+    enum { ID = %u, LENGTH = %u, CRC_EXTRA = %u };
+    explicit %s(const mavlink_message_t &msg) : m_msg(&msg) { }
+    const mavlink_message_t &message() const { return *m_msg; }
+''' % (m.name, m.id, cname, m.id, m.wire_length, m.crc_extra, cname))
+    for f in m.ordered_fields:
+        ftype = field_type(f)
+        name = member_name(f.name)
+        if f.array_length == 0:
+            out.append('    %s %s() const { return detail::read<%s>(payload() + %u); }\n' % (
+                ftype, name, ftype, f.wire_offset))
+        elif ftype == 'char':
+            out.append('    enum { %s_LENGTH = %u };\n' % (f.name.upper(), f.array_length))
+            out.append('    /** @brief Not terminated when all %u characters are used */\n' % f.array_length)
+            out.append('    const char *%s() const { return payload() + %u; }\n' % (name, f.wire_offset))
+        else:
+            out.append('    enum { %s_LENGTH = %u };\n' % (f.name.upper(), f.array_length))
+            out.append('    %s %s(int i) const { return detail::read<%s>(payload() + %u + i * %u); }\n' % (
+                ftype, name, ftype, f.wire_offset, type_lengths[ftype]))
+    out.append('''
+private:
+    const char *payload() const { return _MAV_PAYLOAD(m_msg); }
+    const mavlink_message_t *m_msg;
+};
+''')
+
+
+def write_layouts(out, messages):
+    '''field layouts and the message table'''
+    out.append('''
+struct FieldLayout
+{
+    const char *name;
+    uint8_t type;          ///< MAVLINK_TYPE_*
+    uint8_t arrayLength;   ///< 0 for a single value
+    uint8_t wireOffset;
+};
+
+struct MessageLayout
+{
+    const char *name;      ///< NULL for IDs without a message
+    uint8_t length;
+    uint8_t crcExtra;
+    uint8_t numFields;
+    const FieldLayout *fields;   ///< In wire order
+};
+
+/** @brief Layout of msgid, compile time initialised, shared by every translation unit */
+inline const MessageLayout &messageLayout(uint8_t msgid)
+{
+''')
+    for m in messages:
+        out.append('    static const FieldLayout fields_%s[] = {\n' % m.name.lower())
+        for f in m.ordered_fields:
+            out.append('        { "%s", %s, %u, %u },\n' % (
+                f.name, type_ids[field_type(f)], f.array_length, f.wire_offset))
+        out.append('    };\n')
+    out.append('    static const MessageLayout table[256] = {\n')
+    by_id = dict([(m.id, m) for m in messages])
+    for i in range(256):
+        if i in by_id:
+            m = by_id[i]
+            out.append('        { "%s", %u, %u, %u, fields_%s },\n' % (
+                m.name, m.wire_length, m.crc_extra, len(m.ordered_fields), m.name.lower()))
+        else:
+            out.append('        { 0, 0, 0, 0, 0 },\n')
+    out.append('''    };
+    return table[msgid];
+}
+''')
+    write_tables(out, by_id)
+
+
+def time_field(m):
+    '''type and offset of a leading time_boot_ms or *usec field, (0, 0) without one'''
+    if len(m.ordered_fields) == 0:
+        return (0, 0)
+    f = m.ordered_fields[0]
+    if f.name == 'time_boot_ms' and f.type == 'uint32_t':
+        return ('MAVLINK_TYPE_UINT32_T', f.wire_offset)
+    if 'usec' in f.name and f.type == 'uint64_t':
+        return ('MAVLINK_TYPE_UINT64_T', f.wire_offset)
+    return (0, 0)
+
+
+def write_tables(out, by_id):
+    '''the per message constants as one array each'''
+    def row(values):
+        lines = []
+        for i in range(0, 256, 16):
+            lines.append('          ' + ', '.join([str(v) for v in values[i:i + 16]]))
+        return ',\n'.join(lines)
+    lengths = [by_id[i].wire_length if i in by_id else 0 for i in range(256)]
+    crcs = [by_id[i].crc_extra if i in by_id else 0 for i in range(256)]
+    times = [time_field(by_id[i]) if i in by_id else (0, 0) for i in range(256)]
+    out.append('''
+/**
+ * @brief The constants of every message ID, one read only array each
+ *
+ * For code that needs one value of many messages, e.g. framing or time
+ * stamping, so it touches a few cache lines instead of the message table.
+ */
+struct MessageTables
+{
+    uint8_t length[256];
+    uint8_t crcExtra[256];
+    uint8_t timeType[256];     ///< MAVLINK_TYPE_* of a leading time_boot_ms or *usec field, 0 without one
+    uint8_t timeOffset[256];
+};
+
+inline const MessageTables &messageTables()
+{
+    static const MessageTables tables = {
+        {
+%s
+        },
+        {
+%s
+        },
+        {
+%s
+        },
+        {
+%s
+        }
+    };
+    return tables;
+}
+''' % (row(lengths), row(crcs), row([t[0] for t in times]), row([t[1] for t in times])))
+
+
+def write_handler(out, messages):
+    '''CRTP base whose dispatch() calls Derived::on<Message>()'''
+    out.append('''
+/**
+ * @brief Static dispatch to per message handlers:
+ *
+ *   class Vehicle : public mavlink::Handler<Vehicle>
+ *   {
+ *   public:
+ *       void onAttitude(const mavlink::Attitude &attitude);
+ *   };
+ *
+ * Messages the derived class has no handler for go to the empty defaults
+ * below, which the compiler drops. Nothing is copied out of the message.
+ */
+template <class Derived>
+class Handler
+{
+public:
+    /** @brief False for message IDs this dialect does not define */
+    bool dispatch(const mavlink_message_t &msg)
+    {
+        Derived &self = static_cast<Derived&>(*this);
+        switch (msg.msgid)
+        {
+''')
+    for m in messages:
+        out.append('        case %u: self.on%s(%s(msg)); return true;\n' % (m.id, class_name(m.name), class_name(m.name)))
+    out.append('''        default: self.onUnknown(msg); return false;
+        }
+    }
+
+''')
+    for m in messages:
+        out.append('    void on%s(const %s &) { }\n' % (class_name(m.name), class_name(m.name)))
+    out.append('''    void onUnknown(const mavlink_message_t &) { }
+};
+
+template <class H>
+inline bool dispatch(H &handler, const mavlink_message_t &msg)
+{
+    return handler.dispatch(msg);
+}
+''')
+
+
+def generate_hpp(filename, basename, messages):
+    # a dialect wins over the message of the same ID in what it includes
+    by_id = {}
+    for m in messages:
+        if m.id not in by_id:
+            by_id[m.id] = m
+    messages = sorted(by_id.values(), key=lambda m: m.id)
+    out = []
+    guard = 'MAVLINK_%s_HPP' % basename.upper()
+    out.append('''/** @file
+ *	@brief Typed C++ access to the MAVLink %s dialect
+ *	Generated by mavgen_cpp.py, do not edit
+ */
+#ifndef %s
+#define %s
+
+#include "mavlink.h"
+#include <string.h>
+
+namespace mavlink {
+
+namespace detail {
+// Payload fields are packed and little endian, read them without assuming
+// alignment and swap them on a big endian host
+template <typename T> inline T read(const char *p)
+{
+    T value;
+#if MAVLINK_NEED_BYTE_SWAP
+    char *bytes = reinterpret_cast<char *>(&value);
+    for (unsigned i = 0; i < sizeof(T); i++)
+    {
+        bytes[i] = p[sizeof(T) - 1 - i];
+    }
+#else
+    memcpy(&value, p, sizeof(T));
+#endif
+    return value;
+}
+}
+''' % (basename, guard, guard))
+    write_layouts(out, messages)
+    for m in messages:
+        write_view(out, m)
+    write_handler(out, messages)
+    out.append('''
+} // namespace mavlink
+
+#endif // %s
+''' % guard)
+    f = open(filename, mode='w')
+    f.write(''.join(out))
+    f.close()
+    print("Generated %s with %u messages" % (filename, len(messages)))
+
+
+def generate(basename, xml_list):
+    '''generate mavlink.hpp for the first XML file and everything it includes'''
+    messages = []
+    for xml in xml_list:
+        messages.extend(xml.message)
+    directory = os.path.join(basename, xml_list[0].basename)
+    if not os.path.isdir(directory):
+        os.makedirs(directory)
+    generate_hpp(os.path.join(directory, 'mavlink.hpp'), xml_list[0].basename, messages)
+
+
+class CField(object):
+    def __init__(self, name, type, array_length, wire_offset):
+        self.name = name
+        self.type = type
+        self.array_length = array_length
+        self.wire_offset = wire_offset
+
+
+class CMessage(object):
+    def __init__(self, name, id, wire_length, crc_extra, fields):
+        self.name = name
+        self.id = id
+        self.wire_length = wire_length
+        self.crc_extra = crc_extra
+        self.ordered_fields = fields
+
+
+def messages_from_c(directory, seen=None, crcs=None):
+    '''Rebuild the message list from a generated C dialect directory and the dialects it includes'''
+    if seen is None:
+        seen = set()
+    directory = os.path.normpath(directory)
+    if directory in seen:
+        return []
+    seen.add(directory)
+    dialect = os.path.join(directory, os.path.basename(directory) + '.h')
+    dialect_text = open(dialect).read() if os.path.exists(dialect) else ''
+    if crcs is None:
+        # older headers have no per message _CRC define, the dialect table has them all
+        table = re.search(r'#define MAVLINK_MESSAGE_CRCS \{([^}]*)\}', dialect_text)
+        if table is not None:
+            crcs = [int(c) for c in table.group(1).split(',')]
+    c_types = dict([(v, k) for (k, v) in type_ids.items()])
+    messages = []
+    # only what the dialect header includes, stale headers may reuse an ID
+    for fname in re.findall(r'#include "\./(mavlink_msg_\w+\.h)"', dialect_text):
+        text = open(os.path.join(directory, fname)).read()
+        info = re.search(r'#define MAVLINK_MESSAGE_INFO_(\w+) \{', text)
+        if info is None:
+            continue
+        name = info.group(1)
+        id = int(re.search(r'#define MAVLINK_MSG_ID_%s (\d+)' % name, text).group(1))
+        length = int(re.search(r'#define MAVLINK_MSG_ID_%s_LEN (\d+)' % name, text).group(1))
+        crc = re.search(r'#define MAVLINK_MSG_ID_%s_CRC (\d+)' % name, text)
+        if crc is not None:
+            crc = int(crc.group(1))
+        elif crcs is not None:
+            crc = crcs[id]
+        else:
+            raise Exception("no CRC_EXTRA for %s" % name)
+        fields = []
+        for f in re.finditer(r'\{ "(\w+)", (?:NULL|"[^"]*"), (MAVLINK_TYPE_\w+), (\d+), (\d+), offsetof', text):
+            fields.append(CField(f.group(1), c_types[f.group(2)], int(f.group(3)), int(f.group(4))))
+        messages.append(CMessage(name, id, length, crc, fields))
+    # the dialect header pulls in the dialects it extends
+    for inc in re.findall(r'#include "\.\./(\w+)/\w+\.h"', dialect_text):
+        messages.extend(messages_from_c(os.path.join(directory, '..', inc), seen, crcs))
+    return messages
+
+
+if __name__ == "__main__":
+    # Trees that only ship the generated C headers: mavgen_cpp.py include/mavlink/v1.0/ardupilotmega
+    from optparse import OptionParser
+    parser = OptionParser("%prog [options] <C dialect directory>")
+    parser.add_option("-o", "--output", dest="output", default=None, help="output file [default: <directory>/mavlink.hpp]")
+    (opts, args) = parser.parse_args()
+    if len(args) != 1:
+        parser.error("You must supply one generated C dialect directory")
+    directory = args[0].rstrip('/')
+    output = opts.output or os.path.join(directory, 'mavlink.hpp')
+    generate_hpp(output, os.path.basename(directory), messages_from_c(directory))
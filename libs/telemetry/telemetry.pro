@@ -0,0 +1,20 @@
+# Headless telemetry library
+# the MAVLink stack of QtGStreamerHUD (telemetry.pri) as a static library,
+# for desktop profiling and for companion computers; see apps/telemetryd
+
+QT += core network gui widgets
+
+TEMPLATE = lib
+TARGET = telemetry
+CONFIG += staticlib
+
+LANGUAGE = C++
+
+HUD_ROOT = $$PWD/../..
+
+# Alerts are raised but never played, nothing here links an audio library
+DEFINES += AUDIO_NULL_BACKEND
+
+include($$HUD_ROOT/telemetry.pri)
+
+CONFIG += warn_off
@@ -32,6 +32,27 @@
 #include <PrimaryFlightDisplayQML.h>
 #include <LinkManager1.h>
 #include <UASManager1.h>
+#include <GStreamerStats.h>
+#include <GStreamerFrameMailbox.h>
+#include <GStreamerFramePacer.h>
+#include <GStreamerDecoderProbe.h>
+#include <GStreamerRegistryCache.h>
+#include <HudVideoItem.h>
+#include <HudInstruments.h>
+#include <HudReadout.h>
+#include <HudMap.h>
+#include <HudSwarm.h>
+#include <StartupProfiler.h>
+#include <SettingsStore.h>
+#include <ReplayBenchmark.h>
+#include <EventLoopMonitor.h>
+#include <ThreadRoles.h>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QDir>
+#include "QsLog.h"
+#include "QsLogDest.h"
 
 // Needed to manually register plugin
 gboolean plugin_init(GstPlugin *plugin);
@@ -42,46 +63,172 @@ gpointer gst_qt_quick2_video_sink_update_node(GstQtQuick2VideoSink *self, gpoint
 
 void* update_node(void* surface,  void* node, qreal x, qreal y, qreal w, qreal h)
 {
-    return gst_qt_quick2_video_sink_update_node((GstQtQuick2VideoSink*)surface, (gpointer)node, x, y, w, h);
+    GStreamerStats::frameRendered(surface);
+    GStreamerFramePacer::frameRendered(surface);
+    void *result = gst_qt_quick2_video_sink_update_node((GstQtQuick2VideoSink*)surface, (gpointer)node, x, y, w, h);
+
+    // The frame is on the scene graph now, let the next one out of the mailbox
+    GStreamerFrameMailbox::frameRendered(surface);
+    return result;
 }
 
+/**
+ * @brief GStreamer start up, off the main thread
+ *
+ * Loading the registry and registering the video sink take the longest on
+ * a cold start and touch nothing of the GUI, so they overlap the link and
+ * UAS managers loading their settings and building the protocol stack.
+ * The display needs the sink element, main() waits before building it.
+ */
+class GStreamerInitThread : public QThread
+{
+public:
+    GStreamerInitThread(int *argc, char ***argv) : m_argc(argc), m_argv(argv) {}
+
+protected:
+    void run()
+    {
+        {
+            StartupStage stage("gstreamer init");
+            QGst::init(m_argc, m_argv);
+        }
+
+        StartupStage stage("gstreamer plugins");
+        gboolean success = gst_plugin_register_static (GST_VERSION_MAJOR,
+                                    GST_VERSION_MINOR ,
+                                    "qt5videosink",
+                                    "A video sink that can draw on any Qt surface",
+                                    &plugin_init,
+                                    "1.2.0",
+                                    "LGPL",
+                                    "libgstqt5videosink.so",
+                                    "QtGStreamer",
+                                    "http://gstreamer.freedesktop.org");
+
+        if (!success)
+        {
+            qCritical() << "Could not register qt5videosink plugin with GStreamer!";
+        }
+
+        // Scan (or load the cached list of) H.264/H.265 decoders before the first pipeline is built
+        GStreamerDecoderProbe::instance()->moveToThread(QCoreApplication::instance()->thread());
+
+        StartupStage preload("gstreamer preload");
+        GStreamerRegistryCache::preload();
+    }
+
+private:
+    int *m_argc;
+    char ***m_argv;
+};
+
 int main(int argc, char **argv)
 {
-    QGuiApplication app(argc, argv);
+    StartupProfiler::instance()->begin("application");
+    // One 1024x1024 atlas page holds every instrument image from HudImageProvider,
+    // the default 512 page would split them over several textures
+    if (qEnvironmentVariableIsEmpty("QSG_ATLAS_WIDTH"))
+    {
+        qputenv("QSG_ATLAS_WIDTH", "1024");
+        qputenv("QSG_ATLAS_HEIGHT", "1024");
+    }
+    // A benchmark renders the same scene graph into an offscreen window, unless a platform is asked for
+    const QStringList benchmarkArguments = ReplayBenchmark::arguments(argc, argv);
+    if (!benchmarkArguments.isEmpty() && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // Times every event delivery while the performance overlay is on
+    HudApplication app(argc, argv);
+    StartupProfiler::instance()->end("application");
 
-    QGst::init(&argc, &argv);
+    // Reads every setting on its own thread while the rest starts
+    SettingsStore::instance();
+
+    StartupProfiler::instance()->begin("logging");
+    QSettings settings;
+    QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/logs";
+    if (settings.value("FILE_LOG", false).toBool() || settings.value("BINARY_LOG", false).toBool())
+    {
+        QDir().mkpath(logDir);
+    }
+    // Text log, written, rotated and deflated off the logging path
+    if (settings.value("FILE_LOG", false).toBool())
+    {
+        QsLogging::Logger::instance().addDestination(QsLogging::DestinationFactory::MakeBufferedFileDestination(
+                logDir + "/hud.log", 1024 * 1024, 5, true));
+    }
+    // QLOG_BIN_* records, render them with apps/qslogdecode
+    if (settings.value("BINARY_LOG", false).toBool())
+    {
+        QString logFile = logDir + "/hud-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".qslb";
+        QsLogging::Logger::instance().setBinaryDestination(QsLogging::DestinationFactory::MakeBinaryFileDestination(logFile));
+    }
+    StartupProfiler::instance()->end("logging");
+
+    // Before any other thread of a role starts; the log writers already run
+    ThreadRoles::instance()->adopt(ThreadRoles::Logging, QLatin1String("QsLogWriter"));
+    ThreadRoles::instance()->adopt(ThreadRoles::Logging, QLatin1String("QsLogFile"));
+
+    // Environment for the registry, before any other thread can read it
+    GStreamerRegistryCache::prepare();
+    GStreamerInitThread gstreamerInit(&argc, &argv);
+    gstreamerInit.start();
 
     qDebug() << "Start Link Manager";
+    StartupProfiler::instance()->begin("link manager");
     LinkManager::instance();
+    StartupProfiler::instance()->end("link manager");
 
     qDebug() << "Start UAS Manager";
+    StartupProfiler::instance()->begin("uas manager");
     UASManager::instance();
-
-    gboolean success = gst_plugin_register_static (GST_VERSION_MAJOR,
-                                GST_VERSION_MINOR ,
-                                "qt5videosink",
-                                "A video sink that can draw on any Qt surface",
-                                &plugin_init,
-                                "1.2.0",
-                                "LGPL",
-                                "libgstqt5videosink.so",
-                                "QtGStreamer",
-                                "http://gstreamer.freedesktop.org");
-
-    if (!success)
-    {
-        qCritical() << "Could not register qt5videosink plugin with GStreamer!";
-    }
-
+    StartupProfiler::instance()->end("uas manager");
+
+    // Video with the attitude overlay drawn in one shader, see HudVideoItem
+    qmlRegisterType<HudVideoItem>("Hud", 1, 0, "HudVideoItem");
+    // Tape, ladder and compass graticules as vertex geometry, see HudInstruments
+    qmlRegisterType<HudTapeItem>("Hud", 1, 0, "HudTapeItem");
+    qmlRegisterType<HudLadderItem>("Hud", 1, 0, "HudLadderItem");
+    qmlRegisterType<HudDialItem>("Hud", 1, 0, "HudDialItem");
+    // Numeric readouts from a distance field digit atlas, see HudReadout
+    qmlRegisterType<HudReadoutItem>("Hud", 1, 0, "HudReadoutItem");
+    // Offline tile minimap with the flown track, see HudMap
+    qmlRegisterType<HudMapItem>("Hud", 1, 0, "HudMapItem");
+    // All swarm vehicles as one geometry node, see HudSwarm
+    qmlRegisterType<HudSwarmItem>("Hud", 1, 0, "HudSwarmItem");
+
+    StartupProfiler::instance()->begin("wait for gstreamer");
+    gstreamerInit.wait();
+    StartupProfiler::instance()->end("wait for gstreamer");
+
+    // Loads the QML; the first frame makes it interactive, video and the extra panels follow
+    StartupProfiler::instance()->begin("display");
     PrimaryFlightDisplayQML theDisplay;
+    StartupProfiler::instance()->end("display");
 
     // Connect for android sleep signals
     QObject::connect(&app, SIGNAL(applicationStateChanged(Qt::ApplicationState)), &theDisplay,
             SLOT(applicationStateChanged(Qt::ApplicationState)), Qt::UniqueConnection);
 
+    // --benchmark-replay <tlog> [video]: exits after printing its report
+    ReplayBenchmark *benchmark = NULL;
+    if (!benchmarkArguments.isEmpty())
+    {
+        benchmark = new ReplayBenchmark(&theDisplay, benchmarkArguments, &app);
+        if (!benchmark->start())
+        {
+            return 1;
+        }
+    }
+
     int retVal = app.exec();
+    // Flushes and closes the binary log
+    QsLogging::Logger::instance().setBinaryDestination(QsLogging::BinaryDestinationPtr());
 
     QGst::cleanup();
+    // Writes what the debounce still holds; later writes go straight to QSettings
+    SettingsStore::instance()->shutdown();
 
     return retVal;
 }
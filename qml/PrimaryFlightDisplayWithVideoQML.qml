@@ -98,6 +98,8 @@ Rectangle {
     
 	Component.onCompleted:
 	{
+		// Installed once, a vehicle change swaps what activeVehicle reads from
+		activeUasSet()
 		rollPitchIndicator.enableRollPitch = Settings.get("enableRollPitchIndicator", true) == 0 ? false : true
 		pitchIndicator.visible = Settings.get("enablePitchIndicator", true) == 0 ? false : true
 		altIndicator.visible = Settings.get("enableAltIndicator", true) == 0 ? false : true
@@ -284,6 +286,13 @@ Rectangle {
         visible: showStatusMessage
     }
 
+    StatusMessageIndicator  {
+        id: videoStalledIndicator
+        anchors.fill: parent
+        message: "VIDEO STALLED, RECONNECTING"
+        visible: enableBackgroundVideo && player.stalled
+    }
+
     InformationOverlayIndicator{
         id: informationIndicator
         anchors.fill: parent
@@ -1,38 +1,34 @@
-function getDatabase() {
-     return LocalStorage.openDatabaseSync("APM_PLanner", "0.1", "SettingsDatabase", 100);
+// Settings of the QML pages, kept by the application (qmlSettings, see
+// QmlSettings.h): get() is answered from memory and set() is written to disk
+// in the background. The LocalStorage table older versions used is copied
+// over once, the first time a page asks for a setting.
+
+var imported = false;
+
+function importDatabase() {
+    imported = true;
+    if (qmlSettings.contains("localStorageImported")) return;
+    try {
+        var db = LocalStorage.openDatabaseSync("APM_PLanner", "0.1", "SettingsDatabase", 100);
+        db.readTransaction(function(tx) {
+            var rs = tx.executeSql('SELECT setting, value FROM settings');
+            for (var i = 0; i < rs.rows.length; i++) {
+                qmlSettings.set(rs.rows.item(i).setting, rs.rows.item(i).value);
+            }
+        });
+    } catch (err) {
+        // No table yet, nothing to import
+    }
+    qmlSettings.set("localStorageImported", 1);
 }
 
 function set(setting, value) {
-   var db = getDatabase();
-   var res = "";
-   db.transaction(function(tx) {
-        tx.executeSql('CREATE TABLE IF NOT EXISTS settings(setting TEXT UNIQUE, value TEXT)');
-        var rs = tx.executeSql('INSERT OR REPLACE INTO settings VALUES (?,?);', [setting,value]);
-              if (rs.rowsAffected > 0) {
-                res = "OK";
-              } else {
-                res = "Error";
-              }
-        }
-  );
-  return res;
+    if (!imported) importDatabase();
+    qmlSettings.set(setting, value);
+    return "OK";
 }
 
 function get(setting, default_value) {
-   var db = getDatabase();
-   var res="";
-   try {
-       db.transaction(function(tx) {
-         var rs = tx.executeSql('SELECT value FROM settings WHERE setting=?;', [setting]);
-         if (rs.rows.length > 0) {
-              res = rs.rows.item(0).value;
-         } else {
-             res = default_value;
-         }
-      })
-   } catch (err) {
-       //console.log("Database " + err);
-       res = default_value;
-   };
-  return res
-}
\ No newline at end of file
+    if (!imported) importDatabase();
+    return qmlSettings.get(setting, default_value);
+}
@@ -7,6 +7,20 @@
 QT += core network gui qml opengl quick svg xml testlib androidextras
 
 DEFINES += QTVIDEOSINK_NAME=qt5videosink
+# QLOG_* only copies the message into a ring, a writer thread formats it
+DEFINES += QS_LOG_SEPARATE_THREAD
+# Release builds compile out QLOG_DEBUG/QLOG_TRACE, the runtime level is info anyway;
+# the binary QLOG_BIN_DEBUG statements stay, they cost nothing without a binary log
+CONFIG(release, debug|release): DEFINES += QS_LOG_MIN_LEVEL=2 QS_LOG_BIN_MIN_LEVEL=1
+# Audio engine backends, see audio/AudioBackend.h
+android: LIBS += -lOpenSLES
+else:linux: LIBS += -lasound
+# HudBurnInRecorder: encoder input surfaces
+android: LIBS += -landroid -lEGL
+# GStreamerRestreamer: libgstreamer_android has to be built with gstreamer-rtsp-server-1.0
+# in GSTREAMER_EXTRA_DEPS, desktop builds take it from pkg-config
+!android: CONFIG += link_pkgconfig
+!android: PKGCONFIG += gstreamer-rtsp-server-1.0
 
 TARGET = QtGStreamerHUD
 TEMPLATE = app
@@ -152,12 +166,11 @@ INCLUDEPATH += C:/Users/p_duffy/Documents/Android/qt-gstreamer-1.2.0/src
 INCLUDEPATH += C:/Users/p_duffy/Documents/Android/Boost-for-Android-master/boost_1_53_0
 INCLUDEPATH += ../../elements/gstqtvideosink
 INCLUDEPATH += ../../build-armv7-release/elements/gstqtvideosink
-INCLUDEPATH += $$PWD/libs/mavlink/include/mavlink/v1.0/ardupilotmega
-INCLUDEPATH += $$PWD/uas
-INCLUDEPATH += $$PWD/comm
-INCLUDEPATH += $$PWD/QsLog
 INCLUDEPATH += $$PWD/ui
-INCLUDEPATH += $$PWD
+
+# Links, ingest, decoder, UAS and overviews; the audio backends and the
+# QtQuick side of the vehicle are below
+include(telemetry.pri)
 
 HEADERS += \
     ../../elements/gstqtvideosink/gstqtglvideosink.h \
@@ -181,40 +194,41 @@ HEADERS += \
     ../../elements/gstqtvideosink/utils/utils.h \
     CCurrentState.h \
     GStreamerPlayer.h \
+    GStreamerPipelineBuilder.h \
+    GStreamerStats.h \
+    GStreamerRecorder.h \
+    GStreamerRecordingIndexer.h \
+    GStreamerRestreamer.h \
+    GStreamerSnapshot.h \
+    GStreamerFrameMailbox.h \
+    GStreamerFramePacer.h \
+    GStreamerDecoderProbe.h \
+    GStreamerRegistryCache.h \
+    HudVideoItem.h \
+    LensProfile.h \
+    FlightReview.h \
+    HudBurnInRecorder.h \
+    DegradationController.h \
+    MetricsExporter.h \
+    HudInstruments.h \
+    HudReadout.h \
+    HudMap.h \
+    HudSwarm.h \
+    HudImageProvider.h \
+    HudPerformanceMonitor.h \
+    MemoryBudget.h \
+    StartupProfiler.h \
+    ReplayBenchmark.h \
     QCurrentState.h \
     PrimaryFlightDisplayQML.h \
-    audio/AlsaAudio.h \
-    comm/AbsPositionOverview.h \
-    comm/LinkInterface.h \
-    comm/QGCMAVLink.h \
-    comm/RelPositionOverview.h \
-    comm/UASObject.h \
-    comm/VehicleOverview.h \
-    QsLog/QsLog.h \
-    QsLog/QsLogDest.h \
-    QsLog/QsLogDestConsole.h \
-    QsLog/QsLogDestFile.h \
-    QsLog/QsLogDisableForThisFile.h \
-    QsLog/QsLogLevel.h \
-    uas/QGCUASParamManager.h \
-    ui/RadioCalibration/RadioCalibrationData.h \
-    ArduPilotMegaMAV1.h \
-    configuration.h \
-    GAudioOutput.h \
-    globalobject.h \
-    LinkManager1.h \
-    MAVLinkDecoder1.h \
-    MAVLinkProtocol1.h \
-    MG.h \
-    PxQuadMAV1.h \
-    QGC.h \
-    QGCGeo.h \
-    SlugsMAV1.h \
-    TCPLink1.h \
-    UAS1.h \
-    UASInterface1.h \
-    UASManager1.h \
-    UDPLink1.h
+    audio/AlsaAudioBackend.h \
+    audio/OpenSLAudioBackend.h \
+    audio/GStreamerAudioBackend.h \
+    comm/ActiveVehicle.h \
+    uas/ParameterListModel.h \
+    QmlSettings.h \
+    VibrationAnalyzer.h \
+    VideoRateController.h
 SOURCES += main.cpp \
     ../../elements/gstqtvideosink/gstqtglvideosink.cpp \
     ../../elements/gstqtvideosink/gstqtglvideosinkbase.cpp \
@@ -236,33 +250,52 @@ SOURCES += main.cpp \
     ../../elements/gstqtvideosink/utils/utils.cpp \
     CCurrentState.cpp \
     GStreamerPlayer.cpp \
+    GStreamerPipelineBuilder.cpp \
+    GStreamerStats.cpp \
+    GStreamerRecorder.cpp \
+    GStreamerRecordingIndexer.cpp \
+    GStreamerRestreamer.cpp \
+    GStreamerSnapshot.cpp \
+    GStreamerFrameMailbox.cpp \
+    GStreamerFramePacer.cpp \
+    GStreamerDecoderProbe.cpp \
+    GStreamerRegistryCache.cpp \
+    HudVideoItem.cpp \
+    LensProfile.cc \
+    FlightReview.cc \
+    HudBurnInRecorder.cc \
+    DegradationController.cc \
+    MetricsExporter.cc \
+    HudInstruments.cc \
+    HudReadout.cc \
+    HudMap.cc \
+    HudSwarm.cc \
+    HudImageProvider.cc \
+    HudPerformanceMonitor.cc \
+    MemoryBudget.cc \
+    StartupProfiler.cc \
+    ReplayBenchmark.cc \
+    VideoRateController.cpp \
     PrimaryFlightDisplayQML.cpp \
     QCurrentState.cpp \
-    audio/AlsaAudio.cc \
-    comm/AbsPositionOverview.cc \
-    comm/LinkInterface.cpp \
-    comm/RelPositionOverview.cc \
-    comm/UASObject.cc \
-    comm/VehicleOverview.cc \
-    QsLog/QsLog.cpp \
-    QsLog/QsLogDest.cpp \
-    QsLog/QsLogDestConsole.cpp \
-    QsLog/QsLogDestFile.cpp \
-    uas/QGCUASParamManager.cc \
-    ui/RadioCalibration/RadioCalibrationData.cc \
-    ArduPilotMegaMAV1.cc \
-    GAudioOutput.cc \
-    globalobject.cc \
-    LinkManager1.cc \
-    MAVLinkDecoder1.cc \
-    MAVLinkProtocol1.cc \
-    PxQuadMAV1.cc \
-    QGC.cc \
-    SlugsMAV1.cc \
-    TCPLink1.cc \
-    UAS1.cc \
-    UASManager1.cc \
-    UDPLink1.cc
+    audio/AlsaAudioBackend.cc \
+    audio/OpenSLAudioBackend.cc \
+    audio/GStreamerAudioBackend.cc \
+    comm/ActiveVehicle.cc \
+    uas/ParameterListModel.cc \
+    QmlSettings.cc \
+    VibrationAnalyzer.cc
+
+# USB-serial radios through the Android USB host API, Bluetooth SPP radios through QtBluetooth
+android {
+    QT += bluetooth
+    HEADERS += AndroidSerialLink.h BluetoothLink.h
+    SOURCES += AndroidSerialLink.cc BluetoothLink.cc
+    OTHER_FILES += android/src/org/qtproject/qt5/android/bindings/UsbSerial.java
+    OTHER_FILES += android/src/org/qtproject/qt5/android/bindings/TelemetryShareProvider.java
+    OTHER_FILES += android/src/org/qtproject/qt5/android/bindings/HudEncoder.java
+    OTHER_FILES += android/src/org/qtproject/qt5/android/bindings/ThermalStatus.java
+}
 RESOURCES += qmlplayer2.qrc
 
 FORMS    +=
@@ -293,6 +326,7 @@ DISTFILES += \
     android/assets/qml/components/RollPitchIndicator.qml \
     android/assets/qml/components/RollPitchIndicatorWithVideo.qml \
     android/assets/qml/components/SpeedIndicator.qml \
+    android/assets/qml/components/StaticLayer.qml \
     android/assets/qml/components/StatusDisplay.qml \
     android/assets/qml/components/StatusMessageIndicator.qml \
     android/assets/qml/components/TextButton.qml \
@@ -0,0 +1,223 @@
+# MAVLink telemetry stack shared by QtGStreamerHUD, the headless library
+# (libs/telemetry) and the tools in apps/: links, ingest, MAVLinkProtocol,
+# MAVLinkDecoder, the UAS objects and the overviews. Nothing here needs
+# QtQuick, GStreamer or Android; QtWidgets only for UAS's confirmation dialogs.
+#
+# The audio alerts have no backend here. The HUD adds the ALSA / OpenSL /
+# GStreamer backends, everything else defines AUDIO_NULL_BACKEND.
+
+# CONFIG += hud_trace builds the systrace / Perfetto markers of TraceMarkers.h
+hud_trace: DEFINES += HUD_TRACE
+
+INCLUDEPATH += $$PWD \
+    $$PWD/comm \
+    $$PWD/uas \
+    $$PWD/audio \
+    $$PWD/ui/RadioCalibration \
+    $$PWD/QsLog \
+    $$PWD/libs/mavlink/include/mavlink/v1.0 \
+    $$PWD/libs/mavlink/include/mavlink/v1.0/ardupilotmega
+
+HEADERS += \
+    $$PWD/audio/AudioBackend.h \
+    $$PWD/audio/AudioEngine.h \
+    $$PWD/audio/AudioAlertQueue.h \
+    $$PWD/audio/AudioClipCache.h \
+    $$PWD/comm/AbsPositionOverview.h \
+    $$PWD/comm/AttitudeHistory.h \
+    $$PWD/comm/AttitudePredictor.h \
+    $$PWD/comm/FramePacer.h \
+    $$PWD/comm/TimerWheel.h \
+    $$PWD/comm/LinkInterface.h \
+    $$PWD/comm/LinkTrafficStats.h \
+    $$PWD/comm/QGCMAVLink.h \
+    $$PWD/comm/MissionOverview.h \
+    $$PWD/comm/AttitudeMatrix.h \
+    $$PWD/comm/RelPositionOverview.h \
+    $$PWD/comm/ServosRcOverview.h \
+    $$PWD/comm/UASObject.h \
+    $$PWD/comm/VehicleMessageGroups.h \
+    $$PWD/comm/VehicleOverview.h \
+    $$PWD/uas/QGCUASParamManager.h \
+    $$PWD/uas/ParameterCache.h \
+    $$PWD/uas/ParameterSync.h \
+    $$PWD/uas/ParameterWriter.h \
+    $$PWD/uas/CommandTracker.h \
+    $$PWD/uas/MissionSync.h \
+    $$PWD/uas/ImageTransfer.h \
+    $$PWD/uas/LogDownload.h \
+    $$PWD/uas/StreamRateTuner.h \
+    $$PWD/uas/StreamNegotiator.h \
+    $$PWD/uas/LinkBudget.h \
+    $$PWD/uas/ParameterStore.h \
+    $$PWD/uas/StatusTextModel.h \
+    $$PWD/uas/GpsSatellites.h \
+    $$PWD/ui/RadioCalibration/RadioCalibrationData.h \
+    $$PWD/ui/RadioCalibration/RadioChannels.h \
+    $$PWD/ArduPilotMegaMAV1.h \
+    $$PWD/configuration.h \
+    $$PWD/GAudioOutput.h \
+    $$PWD/globalobject.h \
+    $$PWD/SettingsStore.h \
+    $$PWD/StringPool.h \
+    $$PWD/EventLoopMonitor.h \
+    $$PWD/ThreadRoles.h \
+    $$PWD/LinkManager1.h \
+    $$PWD/MAVLinkDecoder1.h \
+    $$PWD/MAVLinkProtocol1.h \
+    $$PWD/MAVLinkIngest.h \
+    $$PWD/VehicleStateSnapshot.h \
+    $$PWD/VehicleState.h \
+    $$PWD/SharedTelemetry.h \
+    $$PWD/SharedTelemetryLayout.h \
+    $$PWD/DerivedMetrics.h \
+    $$PWD/MAVLinkDispatcher.h \
+    $$PWD/MAVLinkMessageRef.h \
+    $$PWD/MAVLinkStreamModel.h \
+    $$PWD/ProximityGrid.h \
+    $$PWD/SwarmModel.h \
+    $$PWD/MAVLinkMessageCache.h \
+    $$PWD/MAVLinkSender.h \
+    $$PWD/ManualControl.h \
+    $$PWD/MAVLink2.h \
+    $$PWD/MAVLinkCrc.h \
+    $$PWD/MAVLinkRouter.h \
+    $$PWD/MAVLinkFusion.h \
+    $$PWD/MAVLinkLatencyProbe.h \
+    $$PWD/MAVLinkLatencyTracer.h \
+    $$PWD/TlogWriter.h \
+    $$PWD/TraceMarkers.h \
+    $$PWD/LinkIngestStats.h \
+    $$PWD/SpscRing.h \
+    $$PWD/Arena.h \
+    $$PWD/TelemetryChannels.h \
+    $$PWD/TelemetryHistory.h \
+    $$PWD/TrackHistory.h \
+    $$PWD/TerrainCache.h \
+    $$PWD/MG.h \
+    $$PWD/PxQuadMAV1.h \
+    $$PWD/QGC.h \
+    $$PWD/GroundClock.h \
+    $$PWD/HilBridge.h \
+    $$PWD/QGCGeo.h \
+    $$PWD/SlugsMAV1.h \
+    $$PWD/TCPLink1.h \
+    $$PWD/TlogReplayLink.h \
+    $$PWD/ImpairedLink.h \
+    $$PWD/LinkReconnector.h \
+    $$PWD/MAVLinkFanout.h \
+    $$PWD/StateWebSocketServer.h \
+    $$PWD/TlogIndex.h \
+    $$PWD/CompressedTlog.h \
+    $$PWD/TelemetryCache.h \
+    $$PWD/TelemetryExporter.h \
+    $$PWD/UAS1.h \
+    $$PWD/UASInterface1.h \
+    $$PWD/UASManager1.h \
+    $$PWD/UDPLink1.h \
+    $$PWD/QsLog/QsLog.h \
+    $$PWD/QsLog/QsLogDest.h \
+    $$PWD/QsLog/QsLogDestConsole.h \
+    $$PWD/QsLog/QsLogDestFile.h \
+    $$PWD/QsLog/QsLogDisableForThisFile.h \
+    $$PWD/QsLog/QsLogLevel.h \
+    $$PWD/QsLog/QsLogBinary.h \
+    $$PWD/QsLog/QsLogDestBufferedFile.h \
+    $$PWD/QsLog/QsLogLimit.h \
+    $$PWD/QsLog/QsLogRing.h
+
+SOURCES += \
+    $$PWD/audio/AudioBackend.cc \
+    $$PWD/audio/AudioEngine.cc \
+    $$PWD/audio/AudioAlertQueue.cc \
+    $$PWD/audio/AudioClipCache.cc \
+    $$PWD/comm/AbsPositionOverview.cc \
+    $$PWD/comm/AttitudeHistory.cc \
+    $$PWD/comm/AttitudePredictor.cc \
+    $$PWD/comm/FramePacer.cc \
+    $$PWD/comm/TimerWheel.cc \
+    $$PWD/comm/LinkInterface.cpp \
+    $$PWD/comm/LinkTrafficStats.cc \
+    $$PWD/comm/MissionOverview.cc \
+    $$PWD/comm/AttitudeMatrix.cc \
+    $$PWD/comm/RelPositionOverview.cc \
+    $$PWD/comm/ServosRcOverview.cc \
+    $$PWD/comm/UASObject.cc \
+    $$PWD/comm/VehicleMessageGroups.cc \
+    $$PWD/comm/VehicleOverview.cc \
+    $$PWD/uas/QGCUASParamManager.cc \
+    $$PWD/uas/ParameterCache.cc \
+    $$PWD/uas/ParameterSync.cc \
+    $$PWD/uas/ParameterWriter.cc \
+    $$PWD/uas/CommandTracker.cc \
+    $$PWD/uas/MissionSync.cc \
+    $$PWD/uas/ImageTransfer.cc \
+    $$PWD/uas/LogDownload.cc \
+    $$PWD/uas/StreamRateTuner.cc \
+    $$PWD/uas/StreamNegotiator.cc \
+    $$PWD/uas/LinkBudget.cc \
+    $$PWD/uas/ParameterStore.cc \
+    $$PWD/uas/StatusTextModel.cc \
+    $$PWD/uas/GpsSatellites.cc \
+    $$PWD/ui/RadioCalibration/RadioCalibrationData.cc \
+    $$PWD/ui/RadioCalibration/RadioChannels.cc \
+    $$PWD/ArduPilotMegaMAV1.cc \
+    $$PWD/GAudioOutput.cc \
+    $$PWD/globalobject.cc \
+    $$PWD/SettingsStore.cc \
+    $$PWD/StringPool.cc \
+    $$PWD/EventLoopMonitor.cc \
+    $$PWD/ThreadRoles.cc \
+    $$PWD/LinkManager1.cc \
+    $$PWD/MAVLinkDecoder1.cc \
+    $$PWD/MAVLinkProtocol1.cc \
+    $$PWD/Arena.cc \
+    $$PWD/MAVLinkIngest.cc \
+    $$PWD/MAVLinkCrc.cc \
+    $$PWD/VehicleStateSnapshot.cc \
+    $$PWD/SharedTelemetry.cc \
+    $$PWD/DerivedMetrics.cc \
+    $$PWD/MAVLinkDispatcher.cc \
+    $$PWD/MAVLinkMessageRef.cc \
+    $$PWD/MAVLinkStreamModel.cc \
+    $$PWD/ProximityGrid.cc \
+    $$PWD/SwarmModel.cc \
+    $$PWD/MAVLinkMessageCache.cc \
+    $$PWD/TelemetryChannels.cc \
+    $$PWD/TelemetryHistory.cc \
+    $$PWD/TrackHistory.cc \
+    $$PWD/TerrainCache.cc \
+    $$PWD/MAVLinkSender.cc \
+    $$PWD/ManualControl.cc \
+    $$PWD/MAVLinkRouter.cc \
+    $$PWD/MAVLinkFusion.cc \
+    $$PWD/MAVLinkLatencyProbe.cc \
+    $$PWD/MAVLinkLatencyTracer.cc \
+    $$PWD/TlogWriter.cc \
+    $$PWD/TraceMarkers.cc \
+    $$PWD/PxQuadMAV1.cc \
+    $$PWD/QGC.cc \
+    $$PWD/GroundClock.cc \
+    $$PWD/HilBridge.cc \
+    $$PWD/SlugsMAV1.cc \
+    $$PWD/TCPLink1.cc \
+    $$PWD/TlogReplayLink.cc \
+    $$PWD/ImpairedLink.cc \
+    $$PWD/LinkReconnector.cc \
+    $$PWD/MAVLinkFanout.cc \
+    $$PWD/StateWebSocketServer.cc \
+    $$PWD/TlogIndex.cc \
+    $$PWD/CompressedTlog.cc \
+    $$PWD/TelemetryCache.cc \
+    $$PWD/TelemetryExporter.cc \
+    $$PWD/UAS1.cc \
+    $$PWD/UASManager1.cc \
+    $$PWD/UDPLink1.cc \
+    $$PWD/QsLog/QsLog.cpp \
+    $$PWD/QsLog/QsLogDest.cpp \
+    $$PWD/QsLog/QsLogDestConsole.cpp \
+    $$PWD/QsLog/QsLogDestFile.cpp \
+    $$PWD/QsLog/QsLogBinary.cpp \
+    $$PWD/QsLog/QsLogDestBufferedFile.cpp \
+    $$PWD/QsLog/QsLogLimit.cpp \
+    $$PWD/QsLog/QsLogRing.cpp
@@ -0,0 +1,161 @@
+#include "CommandTracker.h"
+#include "UAS1.h"
+#include "QsLog.h"
+
+static const int TickMs = TimerWheel::TickMs;
+static const int InitialTimeoutMs = 1000;
+static const int MinTimeoutMs = 200;
+static const int MaxTimeoutMs = 4000;
+static const int MaxAttempts = 4;
+
+CommandTracker::CommandTracker(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_timer(TimerWheel::InvalidTimer),
+    m_srtt(0),
+    m_rttVar(0),
+    m_timeout(InitialTimeoutMs)
+{
+    m_clock.start();
+}
+
+CommandTracker::~CommandTracker()
+{
+    stop();
+}
+
+void CommandTracker::send(const mavlink_command_long_t &cmd)
+{
+    qint64 now = m_clock.elapsed();
+    Pending &pending = m_pending[key(cmd.target_component, cmd.command)];
+    // A command sent again restarts, answers to the old one count for the new
+    pending.cmd = cmd;
+    pending.attempts = 0;
+    pending.firstSent = now;
+    ++m_stats[cmd.command].sent;
+    transmit(pending, now);
+    if (!isActive())
+    {
+        m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    }
+}
+
+void CommandTracker::stop()
+{
+    m_pending.clear();
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+}
+
+bool CommandTracker::ackReceived(int component, int command, int result)
+{
+    QMap<int, Pending>::iterator it = m_pending.find(key(component, command));
+    if (it == m_pending.end())
+    {
+        // Sent to all components, or answered by another one than addressed
+        for (it = m_pending.begin(); it != m_pending.end(); ++it)
+        {
+            if (it.value().cmd.command == command)
+            {
+                break;
+            }
+        }
+        if (it == m_pending.end())
+        {
+            return false;
+        }
+    }
+
+    qint64 now = m_clock.elapsed();
+    Pending pending = it.value();
+    m_pending.erase(it);
+    if (m_pending.isEmpty())
+    {
+        stop();
+    }
+
+    Stats &stats = m_stats[command];
+    ++stats.acked;
+    int rtt = static_cast<int>(now - pending.firstSent);
+    // Karn: after a resend the ACK may answer either attempt
+    if (pending.attempts == 1)
+    {
+        updateTimeout(now - pending.sent);
+        stats.lastRttMs = rtt;
+        stats.maxRttMs = qMax(stats.maxRttMs, rtt);
+        stats.totalRttMs += rtt;
+        ++stats.measured;
+    }
+    QLOG_DEBUG() << "Command" << command << "of component" << pending.cmd.target_component
+                 << "result" << result << "after" << pending.attempts << "attempts," << rtt << "ms";
+    emit commandFinished(m_uas->getUASID(), pending.cmd.target_component, command, result, pending.attempts, rtt);
+    return true;
+}
+
+void CommandTracker::tick()
+{
+    qint64 now = m_clock.elapsed();
+    QList<Pending> expired;
+    for (QMap<int, Pending>::iterator it = m_pending.begin(); it != m_pending.end();)
+    {
+        Pending &pending = it.value();
+        if (now - pending.sent < attemptTimeout(pending.attempts))
+        {
+            ++it;
+            continue;
+        }
+        if (pending.attempts < MaxAttempts)
+        {
+            ++m_stats[pending.cmd.command].retries;
+            transmit(pending, now);
+            ++it;
+            continue;
+        }
+        ++m_stats[pending.cmd.command].timeouts;
+        expired.append(pending);
+        it = m_pending.erase(it);
+    }
+    if (m_pending.isEmpty())
+    {
+        stop();
+    }
+    // After the table is consistent, receivers may send new commands
+    foreach (const Pending &pending, expired)
+    {
+        int elapsed = static_cast<int>(now - pending.firstSent);
+        QLOG_WARN() << "Command" << pending.cmd.command << "of system" << m_uas->getUASID()
+                    << "not acknowledged after" << pending.attempts << "attempts," << elapsed << "ms";
+        emit commandFinished(m_uas->getUASID(), pending.cmd.target_component, pending.cmd.command, -1, pending.attempts, elapsed);
+    }
+}
+
+void CommandTracker::transmit(Pending &pending, qint64 now)
+{
+    // The confirmation field tells the autopilot this is a resend
+    pending.cmd.confirmation = static_cast<uint8_t>(pending.cmd.confirmation + (pending.attempts > 0 ? 1 : 0));
+    ++pending.attempts;
+    pending.sent = now;
+    mavlink_message_t msg;
+    mavlink_msg_command_long_encode(m_uas->getSystemId(), m_uas->getComponentId(), &msg, &pending.cmd);
+    m_uas->sendMessage(msg);
+}
+
+int CommandTracker::attemptTimeout(int attempts) const
+{
+    return qMin(MaxTimeoutMs, m_timeout << qMax(0, attempts - 1));
+}
+
+void CommandTracker::updateTimeout(qint64 rtt)
+{
+    if (m_srtt == 0)
+    {
+        m_srtt = rtt;
+        m_rttVar = rtt / 2.0;
+    }
+    else
+    {
+        m_rttVar = 0.75 * m_rttVar + 0.25 * qAbs(m_srtt - rtt);
+        m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+    m_timeout = qBound(MinTimeoutMs, static_cast<int>(m_srtt + 4 * m_rttVar), MaxTimeoutMs);
+}
@@ -0,0 +1,88 @@
+#ifndef COMMANDTRACKER_H
+#define COMMANDTRACKER_H
+
+#include <QObject>
+#include <QMap>
+#include <QElapsedTimer>
+#include "QGCMAVLink.h"
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Keeps COMMAND_LONGs in flight until their COMMAND_ACK arrives
+ *
+ * Commands are keyed by target component and command, sending the same
+ * command again replaces the one in flight. Without an ACK the command is
+ * resent with the confirmation field counted up, each attempt waiting twice
+ * as long as the one before, and given up after MaxAttempts. The first
+ * timeout follows the measured round trip like ParameterSync's, only ACKs of
+ * first attempts are measured since a retried one is ambiguous.
+ */
+class CommandTracker : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Round trips and outcomes of one command */
+    struct Stats
+    {
+        Stats() : sent(0), acked(0), retries(0), timeouts(0), lastRttMs(0), maxRttMs(0), totalRttMs(0), measured(0) { }
+        int averageRttMs() const { return measured > 0 ? static_cast<int>(totalRttMs / measured) : 0; }
+        int sent;           ///< Commands sent, not counting resends
+        int acked;
+        int retries;        ///< Resends
+        int timeouts;       ///< Commands given up after MaxAttempts
+        int lastRttMs;
+        int maxRttMs;
+        qint64 totalRttMs;
+        int measured;       ///< ACKs of first attempts, the ones with an RTT
+    };
+
+    explicit CommandTracker(UAS *uas);
+    ~CommandTracker();
+
+    /** @brief Send cmd and keep resending it until it is acknowledged */
+    void send(const mavlink_command_long_t &cmd);
+    /** @brief Record a COMMAND_ACK, false if no such command was in flight */
+    bool ackReceived(int component, int command, int result);
+    /** @brief Forget all commands in flight */
+    void stop();
+
+    bool isActive() const { return m_timer != TimerWheel::InvalidTimer; }
+    int pendingCount() const { return m_pending.size(); }
+    Stats stats(int command) const { return m_stats.value(command); }
+    /** @brief Timeout of a first attempt */
+    int timeout() const { return m_timeout; }
+
+signals:
+    /** @brief A command ended, result is a MAV_RESULT or -1 after MaxAttempts without ACK */
+    void commandFinished(int uas, int component, int command, int result, int attempts, int rttMs);
+
+private slots:
+    void tick();
+
+private:
+    struct Pending
+    {
+        mavlink_command_long_t cmd;
+        int attempts;
+        qint64 firstSent;
+        qint64 sent;
+    };
+
+    static int key(int component, int command) { return (component << 16) | command; }
+    void transmit(Pending &pending, qint64 now);
+    int attemptTimeout(int attempts) const;
+    void updateTimeout(qint64 rtt);
+
+    UAS *m_uas;
+    QMap<int, Pending> m_pending;
+    QMap<int, Stats> m_stats;       ///< command -> statistics
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    double m_srtt;
+    double m_rttVar;
+    int m_timeout;
+};
+
+#endif // COMMANDTRACKER_H
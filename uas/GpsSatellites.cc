@@ -0,0 +1,38 @@
+#include "GpsSatellites.h"
+
+#include <string.h>
+
+GpsSatellites::GpsSatellites() :
+    m_count(0),
+    m_used(0)
+{
+    memset(m_satellites, 0, sizeof(m_satellites));
+}
+
+quint32 GpsSatellites::update(int visible, const uint8_t prn[MaxSatellites], const uint8_t elevation[MaxSatellites],
+                              const uint8_t azimuth[MaxSatellites], const uint8_t snr[MaxSatellites],
+                              const uint8_t used[MaxSatellites])
+{
+    const int count = qBound(0, visible, int(MaxSatellites));
+    quint32 changed = 0;
+    int inUse = 0;
+    // Slots past count are cleared, so a lost satellite shows as changed
+    for (int i = 0; i < MaxSatellites; ++i) {
+        const bool valid = i < count;
+        GpsSatellite next;
+        next.prn = valid ? prn[i] : 0;
+        next.elevation = valid ? elevation[i] : 0;
+        next.azimuth = valid ? azimuth[i] : 0;
+        next.snr = valid ? snr[i] : 0;
+        next.used = valid && used[i] ? 1 : 0;
+        GpsSatellite &slot = m_satellites[i];
+        const bool differs = slot.prn != next.prn || slot.elevation != next.elevation
+                || slot.azimuth != next.azimuth || slot.snr != next.snr || slot.used != next.used;
+        changed |= quint32(differs) << i;
+        inUse += next.used;
+        slot = next;
+    }
+    m_count = count;
+    m_used = inUse;
+    return changed;
+}
@@ -0,0 +1,50 @@
+#ifndef GPSSATELLITES_H
+#define GPSSATELLITES_H
+
+#include <QtGlobal>
+#include <stdint.h>
+
+/** @brief One satellite of GPS_STATUS, the message's units */
+struct GpsSatellite
+{
+    uint8_t prn;        ///< Satellite id
+    uint8_t elevation;  ///< Degrees, 0 at the horizon, 90 straight up
+    uint8_t azimuth;    ///< Degrees scaled to 0..255 for 0..360
+    uint8_t snr;        ///< dB
+    uint8_t used;       ///< 1 if the fix uses it
+};
+
+/**
+ * @brief The satellites of the last GPS_STATUS.
+ *
+ * Like RadioChannels for the RC channels: one message updates all of them
+ * in one pass and reports which slots changed as a bit mask, so a sky view
+ * redraws once per message instead of taking one queued signal per
+ * satellite.
+ */
+class GpsSatellites
+{
+public:
+    enum { MaxSatellites = 20 };    ///< GPS_STATUS array length, fits the changed mask
+
+    GpsSatellites();
+
+    /** @brief Stores one message's arrays, returns the mask of slots that changed */
+    quint32 update(int visible, const uint8_t prn[MaxSatellites], const uint8_t elevation[MaxSatellites],
+                   const uint8_t azimuth[MaxSatellites], const uint8_t snr[MaxSatellites],
+                   const uint8_t used[MaxSatellites]);
+
+    /** @brief Satellites in the last message */
+    int count() const { return m_count; }
+    /** @brief Of those, how many the fix uses */
+    int usedCount() const { return m_used; }
+    const GpsSatellite& satellite(int index) const { return m_satellites[index]; }
+    const GpsSatellite* satellites() const { return m_satellites; }
+
+private:
+    GpsSatellite m_satellites[MaxSatellites];
+    int m_count;
+    int m_used;
+};
+
+#endif // GPSSATELLITES_H
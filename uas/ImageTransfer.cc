@@ -0,0 +1,219 @@
+#include "ImageTransfer.h"
+#include "UAS1.h"
+#include "QsLog.h"
+#include <cstring>
+
+static const int TickMs = TimerWheel::TickMs;
+// No handshake this long after a request and it was lost
+static const int HandshakeTimeoutMs = 2000;
+// No ENCAPSULATED_DATA this long and the stream is over
+static const int StreamIdleMs = 500;
+static const int MaxRequests = 4;
+static const int ProgressIntervalMs = 100;
+
+void ImageDecoder::decode(int transfer, const QByteArray &data, int type, int width, int height)
+{
+    QImage image;
+    if (type == MAVLINK_DATA_STREAM_IMG_RAW8U)
+    {
+        // RAW greyscale, a PGM header makes it loadable
+        QByteArray pgm = QString("P5\n%1 %2\n255\n").arg(width).arg(height).toLatin1();
+        pgm.append(data);
+        image.loadFromData(pgm, "PGM");
+    }
+    else if (type == MAVLINK_DATA_STREAM_IMG_JPEG)
+    {
+        image.loadFromData(data, "JPG");
+    }
+    else
+    {
+        // BMP, PGM and PNG carry their own header
+        image.loadFromData(data);
+    }
+    emit decoded(transfer, image);
+}
+
+ImageTransfer::ImageTransfer(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_decoder(new ImageDecoder),
+    m_timer(TimerWheel::InvalidTimer),
+    m_transfer(0),
+    m_type(MAVLINK_DATA_STREAM_IMG_JPEG),
+    m_quality(50),
+    m_size(0),
+    m_width(0),
+    m_height(0),
+    m_packets(0),
+    m_payload(0),
+    m_received(0),
+    m_requests(0),
+    m_lastReceived(0),
+    m_lastRequest(0),
+    m_lastProgress(0)
+{
+    m_clock.start();
+    m_decoder->moveToThread(&m_decoderThread);
+    connect(m_decoder, SIGNAL(decoded(int,QImage)), this, SLOT(decoded(int,QImage)));
+}
+
+ImageTransfer::~ImageTransfer()
+{
+    stop();
+    m_decoderThread.quit();
+    m_decoderThread.wait();
+    delete m_decoder;
+}
+
+void ImageTransfer::start(int type, int quality)
+{
+    if (isActive())
+    {
+        return;
+    }
+    m_type = type;
+    m_quality = quality;
+    m_packets = 0;
+    m_received = 0;
+    m_requests = 1;
+    m_lastRequest = m_clock.elapsed();
+    m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    m_uas->sendImageRequest(m_type, m_quality);
+}
+
+void ImageTransfer::stop()
+{
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+}
+
+void ImageTransfer::handshake(int type, int size, int width, int height, int packets, int payload, int quality)
+{
+    if (size <= 0 || packets <= 0 || payload <= 0)
+    {
+        // A request, or an empty answer
+        return;
+    }
+    qint64 now = m_clock.elapsed();
+    m_lastReceived = now;
+    if (isActive() && size == m_size && packets == m_packets && payload == m_payload && type == m_type)
+    {
+        // The image sent again after a re-request, keep what arrived
+        return;
+    }
+
+    ++m_transfer;
+    m_type = type;
+    m_quality = quality;
+    m_size = size;
+    m_width = width;
+    m_height = height;
+    m_packets = packets;
+    m_payload = payload;
+    m_received = 0;
+    m_have = QBitArray(packets);
+    // The capacity stays from the last image of this size
+    m_buffer.resize(size);
+    m_buffer.fill(0);
+    if (!isActive())
+    {
+        // Sent without a request of ours
+        m_requests = 0;
+        m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    }
+    QLOG_DEBUG() << "Image transfer from system" << m_uas->getUASID() << "of" << size << "bytes in" << packets << "packets";
+}
+
+void ImageTransfer::received(int seq, const uchar *data, int length)
+{
+    if (!isActive() || m_packets == 0 || seq < 0 || seq >= m_packets)
+    {
+        return;
+    }
+    m_lastReceived = m_clock.elapsed();
+    if (m_have.testBit(seq))
+    {
+        return;
+    }
+    const int pos = seq * m_payload;
+    const int count = qMin(qMin(length, m_payload), m_size - pos);
+    if (count > 0)
+    {
+        std::memcpy(m_buffer.data() + pos, data, count);
+    }
+    m_have.setBit(seq);
+    ++m_received;
+
+    if (m_received == m_packets)
+    {
+        complete();
+        return;
+    }
+    if (m_lastReceived - m_lastProgress >= ProgressIntervalMs)
+    {
+        m_lastProgress = m_lastReceived;
+        emit progress(m_uas->getUASID(), m_received, m_packets);
+    }
+}
+
+void ImageTransfer::tick()
+{
+    qint64 now = m_clock.elapsed();
+    const bool streaming = m_packets > 0;
+    if (streaming ? now - m_lastReceived < StreamIdleMs
+                  : now - m_lastRequest < HandshakeTimeoutMs)
+    {
+        return;
+    }
+    if (streaming && now - m_lastRequest < StreamIdleMs)
+    {
+        // The repeated stream has not started yet
+        return;
+    }
+    if (m_requests >= MaxRequests)
+    {
+        const int missing = streaming ? m_packets - m_received : 0;
+        QLOG_WARN() << "Image transfer from system" << m_uas->getUASID() << "given up,"
+                    << missing << "of" << m_packets << "packets missing";
+        stop();
+        emit failed(m_uas->getUASID(), missing);
+        return;
+    }
+    ++m_requests;
+    m_lastRequest = now;
+    if (streaming)
+    {
+        QLOG_DEBUG() << "Image transfer stalled at" << m_received << "of" << m_packets << "packets, requesting again";
+    }
+    m_uas->sendImageRequest(m_type, m_quality);
+}
+
+void ImageTransfer::complete()
+{
+    stop();
+    emit progress(m_uas->getUASID(), m_received, m_packets);
+    if (!m_decoderThread.isRunning())
+    {
+        m_decoderThread.start(QThread::LowPriority);
+    }
+    // The buffer is shared, not copied, until the next handshake writes to it
+    QMetaObject::invokeMethod(m_decoder, "decode", Qt::QueuedConnection,
+                              Q_ARG(int, m_transfer), Q_ARG(QByteArray, m_buffer),
+                              Q_ARG(int, m_type), Q_ARG(int, m_width), Q_ARG(int, m_height));
+}
+
+void ImageTransfer::decoded(int transfer, const QImage &image)
+{
+    if (transfer != m_transfer)
+    {
+        return;
+    }
+    if (image.isNull())
+    {
+        QLOG_WARN() << "Could not decode the image from system" << m_uas->getUASID();
+        return;
+    }
+    QLOG_INFO() << "Image" << image.width() << "x" << image.height() << "from system" << m_uas->getUASID();
+    m_image = image;
+    emit imageReady();
+}
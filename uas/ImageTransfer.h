@@ -0,0 +1,100 @@
+#ifndef IMAGETRANSFER_H
+#define IMAGETRANSFER_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QThread>
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Turns a reassembled image buffer into a QImage, on its own thread
+ */
+class ImageDecoder : public QObject
+{
+    Q_OBJECT
+public slots:
+    void decode(int transfer, const QByteArray &data, int type, int width, int height);
+
+signals:
+    /** @brief image is null if data could not be decoded */
+    void decoded(int transfer, const QImage &image);
+};
+
+/**
+ * @brief Receives still images sent as DATA_TRANSMISSION_HANDSHAKE and ENCAPSULATED_DATA
+ *
+ * The handshake the vehicle answers a request with gives the image size,
+ * the packet count and the payload per packet. The whole buffer is
+ * allocated from it once, every ENCAPSULATED_DATA is copied straight to
+ * seqnr * payload and marked in a bitmap, so duplicates and reordering
+ * cost nothing. The protocol has no way to ask for single packets: when
+ * the stream goes quiet with gaps the image is requested again and only
+ * the packets still missing are taken from the repeated stream. A complete
+ * buffer is decoded on a worker thread, imageReady() follows on the GUI
+ * thread.
+ */
+class ImageTransfer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImageTransfer(UAS *uas);
+    ~ImageTransfer();
+
+    /** @brief Ask the vehicle for an image, unless a transfer is running */
+    void start(int type, int quality);
+    /** @brief Give up on the running transfer */
+    void stop();
+    /** @brief Record a received DATA_TRANSMISSION_HANDSHAKE */
+    void handshake(int type, int size, int width, int height, int packets, int payload, int quality);
+    /** @brief Record a received ENCAPSULATED_DATA */
+    void received(int seq, const uchar *data, int length);
+
+    bool isActive() const { return m_timer != TimerWheel::InvalidTimer; }
+    int receivedCount() const { return m_received; }
+    int packetCount() const { return m_packets; }
+    /** @brief The last decoded image */
+    QImage image() const { return m_image; }
+
+signals:
+    /** @brief Emitted at most every ProgressIntervalMs and on completion */
+    void progress(int uas, int received, int packets);
+    void imageReady();
+    /** @brief The transfer was given up with missing packets still missing */
+    void failed(int uas, int missing);
+
+private slots:
+    void tick();
+    void decoded(int transfer, const QImage &image);
+
+private:
+    void complete();
+
+    UAS *m_uas;
+    ImageDecoder *m_decoder;
+    QThread m_decoderThread;
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    QByteArray m_buffer;      ///< Allocated from the handshake, filled in place
+    QBitArray m_have;         ///< Packets received, by seqnr
+    int m_transfer;           ///< Bumped by every handshake, stale decodes are dropped
+    int m_type;
+    int m_quality;
+    int m_size;
+    int m_width;
+    int m_height;
+    int m_packets;
+    int m_payload;
+    int m_received;
+    int m_requests;
+    qint64 m_lastReceived;
+    qint64 m_lastRequest;
+    qint64 m_lastProgress;
+    QImage m_image;
+};
+
+#endif // IMAGETRANSFER_H
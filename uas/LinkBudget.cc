@@ -0,0 +1,152 @@
+#include "LinkBudget.h"
+#include <qmath.h>
+#include <climits>
+
+// SiK radios report RSSI and noise in units of about 1.9 per dB
+static const float RssiPerDb = 1.9f;
+// Signal over noise the GFSK modem needs to decode, the margin is counted above it
+static const float RequiredSnrDb = 6.0f;
+// Share of each report taken into the smoothed values and their slopes
+static const float Smoothing = 0.3f;
+// Same as StreamRateTuner's congestion threshold, percent of txbuf free
+static const float CongestedTxbuf = 50.0f;
+// Slopes below these are report noise, not a trend
+static const float MinTxbufSlope = 1.0f;
+static const float MinMarginSlope = 0.2f;
+// Below this margin the radio loses frames it has to send again, the capacity shrinks with it
+static const float LowMarginDb = 6.0f;
+static const float MinMarginShare = 0.25f;
+// Closer in the distance says little about the path loss
+static const float MinRangeDistance = 20.0f;
+// A round trip this many times the lowest one, and at least QueueingMs longer, is a queue filling
+static const double QueueingFactor = 3.0;
+static const double QueueingMs = 200.0;
+// The capacity estimate grows by this factor every healthy tick
+static const double CapacityProbe = 1.05;
+
+LinkBudget::LinkBudget() :
+    m_hasRadio(false),
+    m_radioTime(0),
+    m_margin(0),
+    m_marginSlope(0),
+    m_txbuf(0),
+    m_txbufSlope(0),
+    m_capacity(0),
+    m_baseRoundTrip(0)
+{
+}
+
+void LinkBudget::radioReceived(int rssi, int remrssi, int noise, int remnoise, int txbuf, qint64 nowMs)
+{
+    float snr = rssi - noise;
+    // A radio that has not heard the far end yet reports zeros for it
+    if (remrssi != 0 || remnoise != 0)
+    {
+        snr = qMin(snr, static_cast<float>(remrssi - remnoise));
+    }
+    float margin = snr / RssiPerDb - RequiredSnrDb;
+
+    qint64 dt = nowMs - m_radioTime;
+    if (!m_hasRadio || dt <= 0 || dt >= RadioStaleMs)
+    {
+        m_margin = margin;
+        m_txbuf = txbuf;
+        m_marginSlope = 0;
+        m_txbufSlope = 0;
+    }
+    else
+    {
+        float nextMargin = m_margin + Smoothing * (margin - m_margin);
+        float nextTxbuf = m_txbuf + Smoothing * (txbuf - m_txbuf);
+        m_marginSlope += Smoothing * ((nextMargin - m_margin) * 1000.0f / dt - m_marginSlope);
+        m_txbufSlope += Smoothing * ((nextTxbuf - m_txbuf) * 1000.0f / dt - m_txbufSlope);
+        m_margin = nextMargin;
+        m_txbuf = nextTxbuf;
+    }
+    m_hasRadio = true;
+    m_radioTime = nowMs;
+}
+
+void LinkBudget::congested(qint64 rate)
+{
+    if (rate > 0)
+    {
+        m_capacity = rate;
+    }
+}
+
+void LinkBudget::probe()
+{
+    if (m_capacity > 0)
+    {
+        m_capacity = static_cast<qint64>(m_capacity * CapacityProbe);
+    }
+}
+
+const LinkBudget::Estimate &LinkBudget::update(qint64 nowMs, float loss, double roundTrip, qint64 rate, float distance)
+{
+    Estimate e;
+    e.radio = m_hasRadio && nowMs - m_radioTime < RadioStaleMs;
+    if (e.radio)
+    {
+        e.fadeMargin = m_margin;
+        if (distance >= MinRangeDistance)
+        {
+            e.rangeLeft = distance * (qPow(10.0, qMax(0.0f, m_margin) / 20.0) - 1.0);
+        }
+    }
+
+    double capacity = m_capacity * (1.0 - qBound(0.0f, loss, 100.0f) / 100.0);
+    if (e.radio && m_margin < LowMarginDb)
+    {
+        capacity *= qMax(MinMarginShare, m_margin / LowMarginDb);
+    }
+    if (roundTrip > 0)
+    {
+        if (m_baseRoundTrip <= 0 || roundTrip < m_baseRoundTrip)
+        {
+            m_baseRoundTrip = roundTrip;
+        }
+        // A queue filling somewhere on the way: the link already carries all it can
+        if (rate > 0 && roundTrip > QueueingFactor * m_baseRoundTrip && roundTrip - m_baseRoundTrip > QueueingMs)
+        {
+            capacity = capacity > 0 ? qMin(capacity, static_cast<double>(rate)) : rate;
+        }
+    }
+    e.capacity = static_cast<qint64>(capacity);
+    if (e.capacity > 0)
+    {
+        e.available = qMax(Q_INT64_C(0), e.capacity - rate);
+    }
+
+    // Earliest of the txbuf trend, the margin trend and the bandwidth running out
+    qint64 saturation = -1;
+    if (e.radio)
+    {
+        if (m_txbuf <= CongestedTxbuf)
+        {
+            saturation = 0;
+        }
+        else if (m_txbufSlope < -MinTxbufSlope)
+        {
+            saturation = static_cast<qint64>((m_txbuf - CongestedTxbuf) * 1000.0f / -m_txbufSlope);
+        }
+        if (m_margin <= 0)
+        {
+            saturation = 0;
+        }
+        else if (m_marginSlope < -MinMarginSlope)
+        {
+            qint64 fade = static_cast<qint64>(m_margin * 1000.0f / -m_marginSlope);
+            saturation = saturation < 0 ? fade : qMin(saturation, fade);
+        }
+    }
+    if (e.available == 0)
+    {
+        saturation = 0;
+    }
+    e.saturationMs = static_cast<int>(qMin(saturation, static_cast<qint64>(INT_MAX)));
+    e.saturating = saturation >= 0 && saturation < HorizonMs;
+    m_estimate = e;
+    return m_estimate;
+}
@@ -0,0 +1,80 @@
+#ifndef LINKBUDGET_H
+#define LINKBUDGET_H
+
+#include <QtGlobal>
+
+/**
+ * @brief What is left of a telemetry radio link, for StreamRateTuner
+ *
+ * Fuses the radio reports (RADIO and RADIO_STATUS: RSSI and noise at both
+ * ends, txbuf) with the receive loss, the round trip time and the data rate
+ * the links carry into
+ *
+ * - the fade margin: signal over noise at the weaker end, less what the
+ *   modem needs to decode, in dB;
+ * - the range left: under free space loss every 6 dB of margin doubles the
+ *   distance, so from the current distance to home the link should close at
+ *   distance * 10^(margin / 20);
+ * - the available bandwidth: the capacity estimate, taken from the data
+ *   rate whenever the link congests, derated by the loss and by queueing
+ *   the round trip shows, less what the links carry now;
+ * - whether the link is about to saturate: the trend of txbuf and of the
+ *   fade margin reaching the congestion thresholds within HorizonMs.
+ *
+ * The tuner sheds a stream on that prediction instead of waiting for the
+ * loss, and caps the bulk uplink with the bandwidth. Plain data, updated on
+ * the GUI thread with the tuner's tick.
+ */
+class LinkBudget
+{
+public:
+    enum {
+        HorizonMs = 6000,       ///< How far ahead saturation is predicted, three tuner ticks
+        RadioStaleMs = 5000     ///< Radio reports older than this no longer describe the link
+    };
+
+    struct Estimate
+    {
+        bool radio;             ///< A recent radio report went in
+        float fadeMargin;       ///< dB above what the modem needs, weaker end
+        float rangeLeft;        ///< m still to go before the link closes, -1 if unknown
+        qint64 capacity;        ///< bit/s the link carries, 0 if unknown
+        qint64 available;       ///< bit/s left under the capacity, -1 if unknown
+        int saturationMs;       ///< Predicted time until congestion, -1 if not in sight
+        bool saturating;        ///< Within HorizonMs
+        Estimate() : radio(false), fadeMargin(0), rangeLeft(-1), capacity(0), available(-1),
+            saturationMs(-1), saturating(false) { }
+    };
+
+    LinkBudget();
+
+    /** @brief Record a radio report; the units are the SiK radio's, about 1.9 per dB */
+    void radioReceived(int rssi, int remrssi, int noise, int remnoise, int txbuf, qint64 nowMs);
+    /** @brief The link congested while carrying rate bit/s, which becomes the capacity */
+    void congested(qint64 rate);
+    /** @brief The link stayed healthy, let the capacity estimate grow so it keeps being probed */
+    void probe();
+
+    /**
+     * @brief Update the estimate
+     * @param loss Receive loss in percent
+     * @param roundTrip Smoothed round trip in ms, 0 if unknown
+     * @param rate bit/s the links carry now
+     * @param distance m from home, negative if unknown
+     */
+    const Estimate &update(qint64 nowMs, float loss, double roundTrip, qint64 rate, float distance);
+    const Estimate &estimate() const { return m_estimate; }
+
+private:
+    bool m_hasRadio;
+    qint64 m_radioTime;         ///< nowMs of the last radio report
+    float m_margin;             ///< Smoothed fade margin, dB
+    float m_marginSlope;        ///< dB per second
+    float m_txbuf;              ///< Smoothed txbuf, percent free
+    float m_txbufSlope;         ///< percent per second
+    qint64 m_capacity;
+    double m_baseRoundTrip;     ///< Lowest round trip seen, the link without queueing
+    Estimate m_estimate;
+};
+
+#endif // LINKBUDGET_H
@@ -0,0 +1,328 @@
+#include "LogDownload.h"
+#include "UAS1.h"
+#include "QsLog.h"
+#include <cstring>
+
+static const int TickMs = TimerWheel::TickMs;
+// No LOG_DATA this long and the request was lost or the stream is over
+static const int StallMs = 1000;
+static const int MaxStalls = 10;
+static const int ProgressIntervalMs = 250;
+static const int RateIntervalMs = 500;
+// The file grows in steps when the log is longer than its entry said
+static const qint64 GrowBytes = 1024 * 1024;
+
+QMutex LogDownload::s_mutex;
+LogDownload *LogDownload::s_downloads[256];
+
+LogDownload::LogDownload(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_sysid(uas->getUASID() & 0xFF),
+    m_id(-1),
+    m_timer(TimerWheel::InvalidTimer),
+    m_map(NULL),
+    m_size(0),
+    m_allocated(0),
+    m_endKnown(false),
+    m_received(0),
+    m_requestEnd(0),
+    m_lastData(0),
+    m_nextQueued(false),
+    m_lastRequest(0),
+    m_stalls(0),
+    m_stallBytes(0),
+    m_started(0),
+    m_rateBytes(0),
+    m_rateTime(0),
+    m_rate(0),
+    m_lastProgress(0)
+{
+    m_clock.start();
+}
+
+LogDownload::~LogDownload()
+{
+    stop();
+}
+
+void LogDownload::requestList()
+{
+    m_entries.clear();
+    m_uas->logRequestList(0, 0xFFFF);
+}
+
+void LogDownload::entryReceived(int id, quint32 size)
+{
+    m_entries.insert(id, size);
+}
+
+qint64 LogDownload::getReceivedBytes() const
+{
+    QMutexLocker locker(&s_mutex);
+    return m_received;
+}
+
+qint64 LogDownload::getSize() const
+{
+    QMutexLocker locker(&s_mutex);
+    return m_size;
+}
+
+bool LogDownload::start(int id, const QString &fileName)
+{
+    if (isActive() || id < 0)
+    {
+        return false;
+    }
+    m_file.setFileName(fileName);
+    if (!m_file.open(QFile::ReadWrite | QFile::Truncate))
+    {
+        QLOG_WARN() << "Cannot write log download" << fileName << m_file.errorString();
+        return false;
+    }
+
+    QMutexLocker locker(&s_mutex);
+    if (s_downloads[m_sysid])
+    {
+        m_file.close();
+        return false;
+    }
+    m_id = id;
+    m_size = m_entries.value(id, 0);
+    m_allocated = 0;
+    m_endKnown = false;
+    m_have = QBitArray();
+    m_received = 0;
+    m_map = NULL;
+    if (!resizeLocked(m_size))
+    {
+        m_file.close();
+        return false;
+    }
+    m_nextQueued = false;
+    m_stalls = 0;
+    m_stallBytes = 0;
+    m_rate = 0;
+    m_rateBytes = 0;
+    m_started = m_clock.elapsed();
+    m_rateTime = m_started;
+    m_lastData = m_started;
+    m_lastRequest = m_rateTime;
+    m_lastProgress = 0;
+    // The whole log in one request, with the size unknown as far as it goes
+    m_requestEnd = m_size > 0 ? m_size : Q_INT64_C(0xFFFFFFFF);
+    s_downloads[m_sysid] = this;
+    locker.unlock();
+
+    QLOG_INFO() << "Downloading log" << id << "of system" << m_sysid << "," << m_size << "bytes to" << fileName;
+    m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    m_uas->logRequestData(id, 0, static_cast<quint32>(m_requestEnd));
+    emit progressChanged();
+    return true;
+}
+
+void LogDownload::stop()
+{
+    if (!isActive())
+    {
+        return;
+    }
+    finish(false);
+}
+
+bool LogDownload::resizeLocked(qint64 size)
+{
+    if (size <= m_allocated)
+    {
+        return true;
+    }
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = NULL;
+    }
+    if (!m_file.resize(size))
+    {
+        QLOG_WARN() << "Cannot grow log download" << m_file.fileName() << "to" << size << "bytes";
+        return false;
+    }
+    m_allocated = size;
+    m_have.resize((size + BlockBytes - 1) / BlockBytes);
+    if (size > 0)
+    {
+        m_map = m_file.map(0, size);
+        if (!m_map)
+        {
+            QLOG_DEBUG() << "Log download" << m_file.fileName() << "not mapped, writing by seek";
+        }
+    }
+    return true;
+}
+
+bool LogDownload::write(const mavlink_message_t &message)
+{
+    QMutexLocker locker(&s_mutex);
+    LogDownload *download = s_downloads[message.sysid];
+    if (!download)
+    {
+        return false;
+    }
+    mavlink_log_data_t data;
+    mavlink_msg_log_data_decode(&message, &data);
+    if (data.id != download->m_id)
+    {
+        return false;
+    }
+    if (download->writeLocked(data))
+    {
+        // Back to the UI thread once, for the next gap
+        download->m_nextQueued = true;
+        QMetaObject::invokeMethod(download, "requestNext", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+bool LogDownload::writeLocked(const mavlink_log_data_t &data)
+{
+    const qint64 ofs = data.ofs;
+    const int count = qMin<int>(data.count, BlockBytes);
+    m_lastData = m_clock.elapsed();
+    if (count < BlockBytes && (!m_endKnown || ofs + count < m_size))
+    {
+        // A short block, or none at all, is the end of the log
+        m_endKnown = true;
+        m_size = ofs + count;
+    }
+    else if (!m_endKnown && ofs + count > m_size)
+    {
+        m_size = ofs + count;
+    }
+    if (count > 0 && ofs % BlockBytes == 0)
+    {
+        if (ofs + count > m_allocated && !resizeLocked(qMax(ofs + count, m_allocated + GrowBytes)))
+        {
+            return false;
+        }
+        const int block = ofs / BlockBytes;
+        if (!m_have.testBit(block))
+        {
+            if (m_map)
+            {
+                std::memcpy(m_map + ofs, data.data, count);
+            }
+            else if (!m_file.seek(ofs) || m_file.write(reinterpret_cast<const char*>(data.data), count) != count)
+            {
+                return false;
+            }
+            m_have.setBit(block);
+            m_received += count;
+        }
+    }
+    const bool rangeDone = count < BlockBytes || ofs + count >= m_requestEnd;
+    return rangeDone && !m_nextQueued;
+}
+
+void LogDownload::requestNext()
+{
+    if (!isActive())
+    {
+        return;
+    }
+    QMutexLocker locker(&s_mutex);
+    m_nextQueued = false;
+    const int blocks = static_cast<int>((m_size + BlockBytes - 1) / BlockBytes);
+    int first = 0;
+    while (first < blocks && m_have.testBit(first))
+    {
+        ++first;
+    }
+    if (first >= blocks && (m_endKnown || m_size > 0))
+    {
+        locker.unlock();
+        finish(true);
+        return;
+    }
+    int last = first;
+    const int maxBlocks = MaxRequestBytes / BlockBytes;
+    while (last < blocks && !m_have.testBit(last) && last - first < maxBlocks)
+    {
+        ++last;
+    }
+    const qint64 ofs = qint64(first) * BlockBytes;
+    // Past the known end while the size is still open, ask for the rest
+    const qint64 end = (last >= blocks && !m_endKnown) ? Q_INT64_C(0xFFFFFFFF) : qint64(last) * BlockBytes;
+    m_requestEnd = end;
+    m_lastRequest = m_clock.elapsed();
+    locker.unlock();
+    m_uas->logRequestData(m_id, static_cast<quint32>(ofs), static_cast<quint32>(end - ofs));
+}
+
+void LogDownload::tick()
+{
+    const qint64 now = m_clock.elapsed();
+    QMutexLocker locker(&s_mutex);
+    const qint64 received = m_received;
+    const qint64 lastActivity = qMax(m_lastData, m_lastRequest);
+    locker.unlock();
+
+    if (now - m_rateTime >= RateIntervalMs)
+    {
+        const double sample = (received - m_rateBytes) * 1000.0 / (now - m_rateTime);
+        m_rate = m_rate == 0 ? sample : 0.5 * m_rate + 0.5 * sample;
+        m_rateBytes = received;
+        m_rateTime = now;
+    }
+    if (now - m_lastProgress >= ProgressIntervalMs)
+    {
+        m_lastProgress = now;
+        emit progressChanged();
+    }
+    if (now - lastActivity < StallMs)
+    {
+        return;
+    }
+    if (received != m_stallBytes)
+    {
+        // Something arrived since the last stall, a fresh set of retries
+        m_stallBytes = received;
+        m_stalls = 0;
+    }
+    if (++m_stalls > MaxStalls)
+    {
+        QLOG_WARN() << "Log" << m_id << "download from system" << m_sysid << "stalled at" << received << "bytes";
+        finish(false);
+        return;
+    }
+    requestNext();
+}
+
+void LogDownload::finish(bool complete)
+{
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+
+    QMutexLocker locker(&s_mutex);
+    s_downloads[m_sysid] = NULL;
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = NULL;
+    }
+    if (complete || m_endKnown)
+    {
+        m_file.resize(m_size);
+    }
+    m_file.close();
+    const qint64 received = m_received;
+    locker.unlock();
+
+    m_uas->logRequestEnd();
+    if (complete)
+    {
+        QLOG_INFO() << "Downloaded log" << m_id << "," << received << "bytes at"
+                    << qRound(received * 1000.0 / qMax(Q_INT64_C(1), m_clock.elapsed() - m_started)) << "B/s";
+    }
+    emit progressChanged();
+    emit finished(m_sysid, m_id, complete, m_file.fileName());
+}
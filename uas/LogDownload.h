@@ -0,0 +1,115 @@
+#ifndef LOGDOWNLOAD_H
+#define LOGDOWNLOAD_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include "QGCMAVLink.h"
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Downloads an onboard (dataflash) log straight into a file
+ *
+ * One LOG_REQUEST_DATA asks for the whole log and the autopilot streams it
+ * at link speed. LOG_DATA never reaches the UI thread: MAVLinkIngest hands
+ * it to write() on the ingest thread, which copies the 90 byte block to
+ * its offset in the memory mapped output file and marks it in a bitmap.
+ * When the requested range is done or the stream stalls, the gaps are
+ * requested as large ranges of up to MaxRequestBytes, so loss costs one
+ * request per hole rather than a round trip per block. The file is
+ * allocated from the LOG_ENTRY size, grown if the log turns out longer
+ * and cut to the end of log at completion.
+ */
+class LogDownload : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive NOTIFY progressChanged)
+    Q_PROPERTY(int logId READ getLogId NOTIFY progressChanged)
+    Q_PROPERTY(qint64 receivedBytes READ getReceivedBytes NOTIFY progressChanged)
+    Q_PROPERTY(qint64 size READ getSize NOTIFY progressChanged)
+    Q_PROPERTY(double bytesPerSecond READ getBytesPerSecond NOTIFY progressChanged)
+    Q_PROPERTY(QString fileName READ getFileName NOTIFY progressChanged)
+public:
+    enum {
+        BlockBytes = 90,                ///< LOG_DATA payload
+        MaxRequestBytes = 256 * 1024
+    };
+
+    explicit LogDownload(UAS *uas);
+    ~LogDownload();
+
+    /** @brief Ask for LOG_ENTRY of every log */
+    Q_INVOKABLE void requestList();
+    /** @brief Download log id to fileName, false if no download could be started */
+    Q_INVOKABLE bool start(int id, const QString &fileName);
+    /** @brief Give up, the partial file is kept */
+    Q_INVOKABLE void stop();
+    /** @brief Record a received LOG_ENTRY */
+    void entryReceived(int id, quint32 size);
+
+    /**
+     * @brief Take LOG_DATA of a running download, ingest thread
+     * @return false if no download of message's system takes it
+     */
+    static bool write(const mavlink_message_t &message);
+
+    bool isActive() const { return m_timer != TimerWheel::InvalidTimer; }
+    int getLogId() const { return m_id; }
+    qint64 getReceivedBytes() const;
+    qint64 getSize() const;
+    double getBytesPerSecond() const { return m_rate; }
+    QString getFileName() const { return m_file.fileName(); }
+
+signals:
+    /** @brief Emitted at most every ProgressIntervalMs and on completion */
+    void progressChanged();
+    void finished(int uas, int id, bool complete, const QString &fileName);
+
+private slots:
+    void tick();
+    void requestNext();
+
+private:
+    bool writeLocked(const mavlink_log_data_t &data);
+    bool resizeLocked(qint64 size);
+    void finish(bool complete);
+
+    UAS *m_uas;
+    int m_sysid;
+    int m_id;
+    QMap<int, quint32> m_entries;   ///< LOG_ENTRY sizes by id
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+
+    // Under s_mutex, written on the ingest thread
+    QFile m_file;
+    uchar *m_map;                   ///< Whole file, 0 if mapping failed and writes seek
+    qint64 m_size;                  ///< Known length of the log
+    qint64 m_allocated;             ///< Length of the file
+    bool m_endKnown;                ///< A short block marked the end of the log
+    QBitArray m_have;               ///< Blocks received
+    qint64 m_received;              ///< Bytes
+    qint64 m_requestEnd;            ///< End of the range asked for last
+    qint64 m_lastData;              ///< ms on m_clock
+    bool m_nextQueued;
+
+    qint64 m_lastRequest;
+    int m_stalls;                   ///< Re-requests without a new byte
+    qint64 m_stallBytes;
+    qint64 m_started;
+    qint64 m_rateBytes;
+    qint64 m_rateTime;
+    double m_rate;
+    qint64 m_lastProgress;
+
+    static QMutex s_mutex;
+    static LogDownload *s_downloads[256];   ///< Running downloads by system
+};
+
+#endif // LOGDOWNLOAD_H
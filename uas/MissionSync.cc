@@ -0,0 +1,352 @@
+#include "MissionSync.h"
+#include "UAS1.h"
+#include "QsLog.h"
+
+static const int TickMs = TimerWheel::TickMs;
+static const int InitialTimeoutMs = 500;
+static const int MinTimeoutMs = 100;
+static const int MaxTimeoutMs = 3000;
+static const int InitialWindow = 4;
+static const int MaxWindow = 16;
+static const int MaxAttempts = 5;
+static const int ProgressIntervalMs = 100;
+
+MissionSync::MissionSync(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_direction(Idle),
+    m_count(-1),
+    m_transferred(0),
+    m_lastRequested(-1),
+    m_resends(0),
+    m_timer(TimerWheel::InvalidTimer),
+    m_lastActivity(0),
+    m_lastProgress(0),
+    m_window(InitialWindow),
+    m_srtt(0),
+    m_rttVar(0),
+    m_timeout(InitialTimeoutMs)
+{
+}
+
+MissionSync::~MissionSync()
+{
+    TimerWheel::instance()->stop(m_timer);
+}
+
+void MissionSync::start(Direction direction)
+{
+    cancel();
+    m_direction = direction;
+    m_count = -1;
+    m_transferred = 0;
+    m_inFlight.clear();
+    m_attempts.clear();
+    m_lastRequested = -1;
+    m_resends = 0;
+    m_window = InitialWindow;
+    m_clock.start();
+    m_lastActivity = 0;
+    m_lastProgress = 0;
+    m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+}
+
+void MissionSync::download()
+{
+    start(Download);
+    m_items.clear();
+    m_have.clear();
+    m_attempts.insert(-1, 1);
+    m_uas->requestMissionList();
+}
+
+void MissionSync::upload(const QVector<mavlink_mission_item_t> &items)
+{
+    start(Upload);
+    m_items = items;
+    for (int seq = 0; seq < m_items.size(); ++seq)
+    {
+        m_items[seq].seq = seq;
+    }
+    m_count = m_items.size();
+    m_attempts.insert(-1, 1);
+    m_uas->sendMissionCount(m_count);
+}
+
+void MissionSync::cancel()
+{
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+    m_direction = Idle;
+    m_inFlight.clear();
+}
+
+void MissionSync::received(const mavlink_message_t &message)
+{
+    if (!isActive())
+    {
+        return;
+    }
+    qint64 now = m_clock.elapsed();
+    switch (message.msgid)
+    {
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    {
+        if (m_direction != Download || m_count >= 0)
+        {
+            return;
+        }
+        m_lastActivity = now;
+        m_count = mavlink_msg_mission_count_get_count(&message);
+        m_items.resize(m_count);
+        m_have = QBitArray(m_count);
+        m_attempts.clear();
+        if (m_count == 0)
+        {
+            finish(MAV_MISSION_ACCEPTED);
+            return;
+        }
+        fillWindow(now);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    {
+        if (m_direction != Download || m_count < 0)
+        {
+            return;
+        }
+        mavlink_mission_item_t item;
+        mavlink_msg_mission_item_decode(&message, &item);
+        itemReceived(item, now);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    {
+        if (m_direction != Upload)
+        {
+            return;
+        }
+        itemRequested(mavlink_msg_mission_request_get_seq(&message), now);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    {
+        if (m_direction != Upload)
+        {
+            return;
+        }
+        int type = mavlink_msg_mission_ack_get_type(&message);
+        if (type == MAV_MISSION_ACCEPTED && m_count > 0 && m_lastRequested != m_count - 1)
+        {
+            // A late ACK of an earlier transfer
+            return;
+        }
+        finish(type);
+        break;
+    }
+    }
+}
+
+void MissionSync::itemReceived(const mavlink_mission_item_t &item, qint64 now)
+{
+    int seq = item.seq;
+    if (seq >= m_count)
+    {
+        return;
+    }
+    m_lastActivity = now;
+    QMap<int, qint64>::iterator request = m_inFlight.find(seq);
+    if (request != m_inFlight.end())
+    {
+        // Karn: a retried request says nothing about the round trip
+        if (m_attempts.value(seq) == 1)
+        {
+            updateTimeout(now - request.value());
+        }
+        m_inFlight.erase(request);
+        if (m_window < MaxWindow)
+        {
+            ++m_window;
+        }
+    }
+    if (m_have.testBit(seq))
+    {
+        return;
+    }
+    m_have.setBit(seq);
+    m_items[seq] = item;
+    ++m_transferred;
+    if (m_transferred == m_count)
+    {
+        finish(MAV_MISSION_ACCEPTED);
+        return;
+    }
+    reportProgress(now, false);
+    fillWindow(now);
+}
+
+void MissionSync::itemRequested(int seq, qint64 now)
+{
+    if (seq < 0 || seq >= m_count)
+    {
+        return;
+    }
+    m_lastActivity = now;
+    if (seq != m_lastRequested)
+    {
+        m_resends = 0;
+        // Asking for seq means every item before it arrived
+        m_transferred = qMax(m_transferred, seq);
+        reportProgress(now, false);
+    }
+    m_lastRequested = seq;
+    m_uas->sendMissionItem(m_items.at(seq));
+}
+
+void MissionSync::fillWindow(qint64 now)
+{
+    for (int seq = 0; seq < m_count && m_inFlight.size() < m_window; ++seq)
+    {
+        if (m_have.testBit(seq) || m_inFlight.contains(seq))
+        {
+            continue;
+        }
+        int &attempts = m_attempts[seq];
+        if (attempts >= MaxAttempts)
+        {
+            continue;
+        }
+        ++attempts;
+        m_inFlight.insert(seq, now);
+        m_uas->requestMissionItem(seq);
+    }
+}
+
+void MissionSync::tick()
+{
+    qint64 now = m_clock.elapsed();
+    if (m_count < 0 || (m_direction == Upload && m_lastRequested < 0))
+    {
+        // Nothing back yet, MISSION_REQUEST_LIST or MISSION_COUNT may have been lost
+        if (now - m_lastActivity < qMax(m_timeout * 2, InitialTimeoutMs * 2))
+        {
+            return;
+        }
+        int &attempts = m_attempts[-1];
+        if (attempts >= MaxAttempts)
+        {
+            QLOG_WARN() << "No mission" << (m_direction == Upload ? "requests" : "count")
+                        << "from system" << m_uas->getUASID() << "after" << attempts << "tries";
+            finish(-1);
+            return;
+        }
+        ++attempts;
+        m_lastActivity = now;
+        if (m_direction == Upload)
+        {
+            m_uas->sendMissionCount(m_count);
+        }
+        else
+        {
+            m_uas->requestMissionList();
+        }
+        return;
+    }
+
+    if (m_direction == Upload)
+    {
+        if (now - m_lastActivity < m_timeout)
+        {
+            return;
+        }
+        if (m_resends >= MaxAttempts)
+        {
+            QLOG_WARN() << "Mission upload to system" << m_uas->getUASID() << "stalled at item" << m_lastRequested;
+            finish(-1);
+            return;
+        }
+        // Our item or the next request got lost, the autopilot asks again only for the former
+        ++m_resends;
+        m_lastActivity = now;
+        m_timeout = qMin(MaxTimeoutMs, m_timeout * 2);
+        m_uas->sendMissionItem(m_items.at(m_lastRequested));
+        return;
+    }
+
+    bool timedOut = false;
+    for (QMap<int, qint64>::iterator it = m_inFlight.begin(); it != m_inFlight.end();)
+    {
+        if (now - it.value() >= m_timeout)
+        {
+            it = m_inFlight.erase(it);
+            timedOut = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if (timedOut)
+    {
+        // Likely congestion on the radio, back off
+        m_window = qMax(1, m_window / 2);
+        m_timeout = qMin(MaxTimeoutMs, m_timeout * 2);
+    }
+    fillWindow(now);
+    if (m_inFlight.isEmpty())
+    {
+        // Whatever is still missing ran out of attempts
+        QLOG_WARN() << "Mission download from system" << m_uas->getUASID() << "incomplete,"
+                    << (m_count - m_transferred) << "items missing";
+        finish(-1);
+    }
+}
+
+void MissionSync::finish(int result)
+{
+    bool upload = m_direction == Upload;
+    bool acknowledge = m_direction == Download && result == MAV_MISSION_ACCEPTED;
+    cancel();
+    if (acknowledge)
+    {
+        // Lets the autopilot leave its transfer state
+        m_uas->sendMissionAck(MAV_MISSION_ACCEPTED);
+    }
+    if (result == MAV_MISSION_ACCEPTED)
+    {
+        m_transferred = m_count;
+        QLOG_INFO() << (upload ? "Uploaded" : "Downloaded") << m_count << "mission items of system"
+                    << m_uas->getUASID() << "in" << m_clock.elapsed() << "ms";
+    }
+    else if (result >= 0)
+    {
+        QLOG_WARN() << "Mission upload to system" << m_uas->getUASID() << "rejected with" << result;
+    }
+    reportProgress(m_clock.elapsed(), true);
+    emit finished(m_uas->getUASID(), upload, result);
+}
+
+void MissionSync::reportProgress(qint64 now, bool force)
+{
+    if (!force && now - m_lastProgress < ProgressIntervalMs)
+    {
+        return;
+    }
+    m_lastProgress = now;
+    emit progress(m_uas->getUASID(), m_transferred, qMax(0, m_count));
+}
+
+void MissionSync::updateTimeout(qint64 rtt)
+{
+    if (m_srtt == 0)
+    {
+        m_srtt = rtt;
+        m_rttVar = rtt / 2.0;
+    }
+    else
+    {
+        m_rttVar = 0.75 * m_rttVar + 0.25 * qAbs(m_srtt - rtt);
+        m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+    m_timeout = qBound(MinTimeoutMs, static_cast<int>(m_srtt + 4 * m_rttVar), MaxTimeoutMs);
+}
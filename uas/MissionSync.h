@@ -0,0 +1,88 @@
+#ifndef MISSIONSYNC_H
+#define MISSIONSYNC_H
+
+#include <QObject>
+#include <QMap>
+#include <QBitArray>
+#include <QVector>
+#include <QElapsedTimer>
+#include "QGCMAVLink.h"
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Mission download and upload of a UAS
+ *
+ * Download: after MISSION_COUNT the items are requested with a window of
+ * MISSION_REQUESTs in flight, so the round trip is paid once per window
+ * instead of once per item. Lost answers are requested again by sequence
+ * number; the window and the retry timeout adapt like in ParameterSync.
+ *
+ * Upload: the autopilot asks for every item itself and rejects items it did
+ * not ask for, so each MISSION_REQUEST is answered from the dispatch path
+ * right away; an autopilot that stops asking gets its last request answered
+ * again.
+ */
+class MissionSync : public QObject
+{
+    Q_OBJECT
+public:
+    enum Direction { Idle, Download, Upload };
+
+    explicit MissionSync(UAS *uas);
+    ~MissionSync();
+
+    /** @brief Read the mission of the autopilot into items() */
+    void download();
+    /** @brief Replace the mission of the autopilot, seq and targets are filled in */
+    void upload(const QVector<mavlink_mission_item_t> &items);
+    /** @brief Abandon the transfer in progress */
+    void cancel();
+    /** @brief Record a MISSION_COUNT, MISSION_ITEM, MISSION_REQUEST or MISSION_ACK */
+    void received(const mavlink_message_t &message);
+
+    Direction direction() const { return m_direction; }
+    bool isActive() const { return m_direction != Idle; }
+    /** @brief The mission last downloaded or uploaded */
+    const QVector<mavlink_mission_item_t> &items() const { return m_items; }
+
+signals:
+    /** @brief Emitted at most every ProgressIntervalMs and on completion */
+    void progress(int uas, int transferred, int count);
+    /** @brief result is a MAV_MISSION_RESULT, -1 when the autopilot stopped answering */
+    void finished(int uas, bool upload, int result);
+
+private slots:
+    void tick();
+
+private:
+    void start(Direction direction);
+    void fillWindow(qint64 now);
+    void itemReceived(const mavlink_mission_item_t &item, qint64 now);
+    void itemRequested(int seq, qint64 now);
+    void finish(int result);
+    void updateTimeout(qint64 rtt);
+    void reportProgress(qint64 now, bool force);
+
+    UAS *m_uas;
+    Direction m_direction;
+    QVector<mavlink_mission_item_t> m_items;
+    QBitArray m_have;               ///< Download: items received
+    int m_count;                    ///< Items of the transfer, -1 until MISSION_COUNT
+    int m_transferred;
+    QMap<int, qint64> m_inFlight;   ///< seq -> time requested
+    QMap<int, int> m_attempts;      ///< seq -> requests sent
+    int m_lastRequested;            ///< Upload: seq of the last MISSION_REQUEST, -1 before the first
+    int m_resends;                  ///< Upload: answers repeated since the last new request
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastActivity;          ///< Last message of the transfer, or our last (re)send
+    qint64 m_lastProgress;
+    int m_window;
+    double m_srtt;
+    double m_rttVar;
+    int m_timeout;
+};
+
+#endif // MISSIONSYNC_H
@@ -0,0 +1,134 @@
+#include "ParameterCache.h"
+#include "globalobject.h"
+#include "QsLog.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QSaveFile>
+
+static const quint32 CacheMagic = 0x50415243; // "PARC"
+static const quint16 CacheVersion = 2;
+
+ParameterCache::ParameterCache() :
+    m_hash(0),
+    m_hasHash(false),
+    m_loaded(false)
+{
+}
+
+QString ParameterCache::fileName(int systemId, int autopilot)
+{
+    return QDir(GlobalObject::sharedInstance()->parameterDirectory())
+            .filePath(QString("cache_sys%1_ap%2.params").arg(systemId).arg(autopilot));
+}
+
+bool ParameterCache::load(const QString &fileName, ParameterStore &store)
+{
+    clear();
+    store.clear();
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic;
+    quint16 version;
+    in >> magic >> version;
+    if (magic != CacheMagic || version != CacheVersion)
+    {
+        QLOG_WARN() << "Ignoring parameter cache" << fileName << "of unknown format";
+        return false;
+    }
+    qint32 components;
+    in >> m_firmware >> m_hasHash >> m_hash >> components;
+    for (int i = 0; i < components && in.status() == QDataStream::Ok; ++i)
+    {
+        qint32 component;
+        qint32 count;
+        qint32 size;
+        in >> component >> count >> size;
+        for (int slot = 0; slot < size && in.status() == QDataStream::Ok; ++slot)
+        {
+            qint32 index;
+            char id[ParameterId::Length];
+            quint8 type;
+            quint32 raw;
+            in >> index;
+            in.readRawData(id, ParameterId::Length);
+            in >> type >> raw;
+            store.insert(component, index, count, ParameterId(id), type, raw);
+        }
+    }
+    if (in.status() != QDataStream::Ok)
+    {
+        QLOG_WARN() << "Parameter cache" << fileName << "is truncated";
+        clear();
+        store.clear();
+        return false;
+    }
+    m_loaded = true;
+    return true;
+}
+
+bool ParameterCache::save(const QString &fileName, const ParameterStore &store) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        QLOG_WARN() << "Cannot write parameter cache" << fileName << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    QList<int> components = store.components();
+    out << CacheMagic << CacheVersion << m_firmware << m_hasHash << m_hash
+        << static_cast<qint32>(components.size());
+    foreach (int component, components)
+    {
+        QList<ParameterStore::Handle> handles;
+        for (int slot = 0; slot < store.size(component); ++slot)
+        {
+            ParameterStore::Handle handle = store.handle(component, slot);
+            if (handle >= 0)
+            {
+                handles.append(handle);
+            }
+        }
+        out << static_cast<qint32>(component) << static_cast<qint32>(store.count(component))
+            << static_cast<qint32>(handles.size());
+        foreach (ParameterStore::Handle handle, handles)
+        {
+            out << static_cast<qint32>(store.index(handle));
+            out.writeRawData(store.id(handle).data(), ParameterId::Length);
+            out << static_cast<quint8>(store.type(handle)) << store.raw(handle);
+        }
+    }
+    return file.commit();
+}
+
+void ParameterCache::clear()
+{
+    m_firmware.clear();
+    m_hash = 0;
+    m_hasHash = false;
+    m_loaded = false;
+}
+
+QString ParameterCache::firmwareFromText(const QString &text)
+{
+    static const QRegExp banner("^(?:APM:|Ardu)\\S*\\s+(V\\d+\\.\\d+\\S*)(?:\\s+\\(([0-9a-fA-F]+)\\))?");
+    QRegExp match(banner);
+    if (match.indexIn(text) < 0)
+    {
+        return QString();
+    }
+    QString firmware = text.section(' ', 0, 0) + " " + match.cap(1);
+    if (!match.cap(2).isEmpty())
+    {
+        firmware += " " + match.cap(2);
+    }
+    return firmware;
+}
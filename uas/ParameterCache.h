@@ -0,0 +1,49 @@
+#ifndef PARAMETERCACHE_H
+#define PARAMETERCACHE_H
+
+#include <QString>
+#include "ParameterStore.h"
+
+/**
+ * @brief Last known parameter list of one vehicle, kept on disk between connections
+ *
+ * Files live in GlobalObject::parameterDirectory() and are named after the
+ * system ID and autopilot type. The firmware version the list was read from,
+ * and the parameter hash of autopilots that send _HASH_CHECK, are stored in
+ * the file and decide whether the list still applies.
+ */
+class ParameterCache
+{
+public:
+    ParameterCache();
+
+    /** @brief Cache file of a vehicle */
+    static QString fileName(int systemId, int autopilot);
+
+    /** @brief Fill store from fileName, store is left empty when the file is unusable */
+    bool load(const QString &fileName, ParameterStore &store);
+    /** @brief Replace fileName with store, the old file survives a failed write */
+    bool save(const QString &fileName, const ParameterStore &store) const;
+    void clear();
+
+    bool isLoaded() const { return m_loaded; }
+
+    /** @brief Firmware version as announced in STATUSTEXT, empty when unknown */
+    const QString &firmware() const { return m_firmware; }
+    void setFirmware(const QString &firmware) { m_firmware = firmware; }
+
+    bool hasHash() const { return m_hasHash; }
+    quint32 hash() const { return m_hash; }
+    void setHash(quint32 hash) { m_hash = hash; m_hasHash = true; }
+
+    /** @brief The firmware version in a STATUSTEXT banner like "APM:Copter V3.2.1 (36b405fb)", or empty */
+    static QString firmwareFromText(const QString &text);
+
+private:
+    QString m_firmware;
+    quint32 m_hash;
+    bool m_hasHash;
+    bool m_loaded;
+};
+
+#endif // PARAMETERCACHE_H
@@ -0,0 +1,294 @@
+#include "ParameterListModel.h"
+#include "UASInterface1.h"
+#include "QsLog.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstring>
+
+class ParameterListModel::SuffixLess
+{
+public:
+    explicit SuffixLess(const ParameterListModel *model) : m_model(model) { }
+    bool operator()(quint32 a, quint32 b) const
+    {
+        return qstrcmp(m_model->suffixText(a), m_model->suffixText(b)) < 0;
+    }
+private:
+    const ParameterListModel *m_model;
+};
+
+namespace {
+
+struct EntryLess
+{
+    template <typename Entry>
+    bool operator()(const Entry &a, const Entry &b) const
+    {
+        return qstrcmp(a.key, b.key) < 0;
+    }
+};
+
+// Compares only the first length characters, so a range is everything starting with the key
+struct PrefixLess
+{
+    PrefixLess(const char *key, int length) : key(key), length(length) { }
+    bool operator()(const char *text, int) const { return qstrncmp(text, key, length) < 0; }
+    bool operator()(int, const char *text) const { return qstrncmp(key, text, length) < 0; }
+    const char *key;
+    int length;
+};
+
+}
+
+ParameterListModel::ParameterListModel(QObject *parent) :
+    QAbstractListModel(parent)
+{
+    m_rebuildTimer.setSingleShot(true);
+    m_rebuildTimer.setInterval(RebuildDelayMs);
+    connect(&m_rebuildTimer, SIGNAL(timeout()), this, SLOT(rebuild()));
+}
+
+void ParameterListModel::setUas(UASInterface *uas)
+{
+    if (m_uas == uas)
+    {
+        return;
+    }
+    if (m_uas)
+    {
+        disconnect(m_uas, 0, this, 0);
+    }
+    m_uas = uas;
+    if (m_uas)
+    {
+        connect(m_uas, SIGNAL(parameterChanged(int,int,QString,QVariant)),
+                this, SLOT(parameterChanged(int,int,QString,QVariant)));
+        connect(m_uas, SIGNAL(parameterListComplete(int,int,int)),
+                this, SLOT(parameterListComplete(int,int,int)));
+    }
+    rebuild();
+}
+
+void ParameterListModel::rebuild()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_rebuildTimer.stop();
+
+    beginResetModel();
+    m_entries.clear();
+    m_suffixes.clear();
+    m_keyTexts.clear();
+    m_suffixTexts.clear();
+    m_entryOfHandle.clear();
+    if (m_uas)
+    {
+        const ParameterStore &store = m_uas->getParameterStore();
+        foreach (int component, store.components())
+        {
+            for (int slot = 0; slot < store.size(component); ++slot)
+            {
+                ParameterStore::Handle handle = store.handle(component, slot);
+                if (handle < 0)
+                {
+                    continue;
+                }
+                Entry entry;
+                entry.key = QByteArray(store.id(handle).data(), qstrnlen(store.id(handle).data(), ParameterId::Length)).toUpper();
+                entry.handle = handle;
+                m_entries.append(entry);
+            }
+        }
+    }
+    std::sort(m_entries.begin(), m_entries.end(), EntryLess());
+
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        m_entryOfHandle.insert(m_entries.at(i).handle, i);
+        // Offset 0 is the name itself, found through m_entries
+        for (int offset = 1; offset < m_entries.at(i).key.size(); ++offset)
+        {
+            m_suffixes.append(suffix(i, offset));
+        }
+    }
+    std::sort(m_suffixes.begin(), m_suffixes.end(), SuffixLess(this));
+
+    // The searches run over plain pointers, the keys do not move until the next rebuild
+    m_keyTexts.resize(m_entries.size());
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        m_keyTexts[i] = m_entries.at(i).key.constData();
+    }
+    m_suffixTexts.resize(m_suffixes.size());
+    for (int i = 0; i < m_suffixes.size(); ++i)
+    {
+        m_suffixTexts[i] = suffixText(m_suffixes.at(i));
+    }
+    applyFilter();
+    endResetModel();
+    emit countChanged();
+
+    if (!m_entries.isEmpty())
+    {
+        QLOG_DEBUG() << "Indexed" << m_entries.size() << "parameters," << m_suffixes.size()
+                     << "suffixes in" << timer.elapsed() << "ms";
+    }
+}
+
+void ParameterListModel::setFilter(const QString &filter)
+{
+    if (filter == m_filter)
+    {
+        return;
+    }
+    m_filter = filter;
+    beginResetModel();
+    applyFilter();
+    endResetModel();
+    emit filterChanged();
+    emit countChanged();
+}
+
+void ParameterListModel::applyFilter()
+{
+    m_key = m_filter.trimmed().toLatin1().toUpper();
+    m_rows.clear();
+    m_rowOfEntry.fill(-1, m_entries.size());
+
+    if (m_key.isEmpty())
+    {
+        m_rows.reserve(m_entries.size());
+        for (int i = 0; i < m_entries.size(); ++i)
+        {
+            m_rowOfEntry[i] = i;
+            m_rows.append(i);
+        }
+        return;
+    }
+
+    // Names starting with the filter are contiguous in the sorted entries
+    PrefixLess less(m_key.constData(), m_key.size());
+    QVector<const char*>::const_iterator first = std::lower_bound(m_keyTexts.constBegin(), m_keyTexts.constEnd(), 0, less);
+    QVector<const char*>::const_iterator last = std::upper_bound(first, m_keyTexts.constEnd(), 0, less);
+    for (QVector<const char*>::const_iterator it = first; it != last; ++it)
+    {
+        int entry = it - m_keyTexts.constBegin();
+        m_rowOfEntry[entry] = m_rows.size();
+        m_rows.append(entry);
+    }
+
+    // Then the names containing it, from the suffixes starting with it
+    QVector<const char*>::const_iterator from = std::lower_bound(m_suffixTexts.constBegin(), m_suffixTexts.constEnd(), 0, less);
+    QVector<const char*>::const_iterator to = std::upper_bound(from, m_suffixTexts.constEnd(), 0, less);
+    QVector<int> contained;
+    for (QVector<const char*>::const_iterator it = from; it != to; ++it)
+    {
+        int entry = m_suffixes.at(it - m_suffixTexts.constBegin()) >> 5;
+        if (m_rowOfEntry.at(entry) < 0)
+        {
+            // A name containing the filter twice is seen twice
+            m_rowOfEntry[entry] = 0;
+            contained.append(entry);
+        }
+    }
+    std::sort(contained.begin(), contained.end());
+    foreach (int entry, contained)
+    {
+        m_rowOfEntry[entry] = m_rows.size();
+        m_rows.append(entry);
+    }
+}
+
+int ParameterListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+    return m_rows.size();
+}
+
+QVariant ParameterListModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_uas || !index.isValid() || index.row() >= m_rows.size())
+    {
+        return QVariant();
+    }
+    const ParameterStore &store = m_uas->getParameterStore();
+    ParameterStore::Handle handle = m_entries.at(m_rows.at(index.row())).handle;
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case NameRole:
+        return store.name(handle);
+    case ValueRole:
+        return store.toVariant(handle);
+    case ComponentRole:
+        return ParameterStore::component(handle);
+    case IndexRole:
+        return store.index(handle);
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ParameterListModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[NameRole] = "name";
+    roles[ValueRole] = "value";
+    roles[ComponentRole] = "component";
+    roles[IndexRole] = "paramIndex";
+    return roles;
+}
+
+void ParameterListModel::setValue(int row, const QVariant &value)
+{
+    if (!m_uas || row < 0 || row >= m_rows.size())
+    {
+        return;
+    }
+    const ParameterStore &store = m_uas->getParameterStore();
+    ParameterStore::Handle handle = m_entries.at(m_rows.at(row)).handle;
+    // Keep the type the vehicle reported, QML hands over doubles
+    QVariant typed = value;
+    if (typed.convert(store.toVariant(handle).type()))
+    {
+        m_uas->setParameter(ParameterStore::component(handle), store.name(handle), typed);
+    }
+}
+
+void ParameterListModel::parameterChanged(int uas, int component, QString name, QVariant value)
+{
+    Q_UNUSED(uas);
+    Q_UNUSED(value);
+    if (!m_uas)
+    {
+        return;
+    }
+    ParameterStore::Handle handle = m_uas->getParameterStore().find(component, name);
+    QHash<ParameterStore::Handle, int>::const_iterator entry = m_entryOfHandle.constFind(handle);
+    if (entry == m_entryOfHandle.constEnd())
+    {
+        // A name the index does not have yet, pick it up with the ones behind it
+        if (!m_rebuildTimer.isActive())
+        {
+            m_rebuildTimer.start();
+        }
+        return;
+    }
+    int row = m_rowOfEntry.at(entry.value());
+    if (row >= 0)
+    {
+        QModelIndex changed = index(row);
+        emit dataChanged(changed, changed);
+    }
+}
+
+void ParameterListModel::parameterListComplete(int uas, int component, int missing)
+{
+    Q_UNUSED(uas);
+    Q_UNUSED(component);
+    Q_UNUSED(missing);
+    rebuild();
+}
@@ -0,0 +1,95 @@
+#ifndef PARAMETERLISTMODEL_H
+#define PARAMETERLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include "ParameterStore.h"
+
+class UASInterface;
+
+/**
+ * @brief The parameters of one UAS as a flat list, filtered by name
+ *
+ * Rows read their values straight from the UAS's ParameterStore. Once the
+ * list is downloaded the upper case names are sorted, and every suffix of
+ * every name goes into a suffix array. A filter is then one binary search
+ * for the names starting with it and one for the suffixes starting with it,
+ * i.e. the names containing it; prefix matches are listed first. Nothing
+ * is compared per row, so a keystroke costs the same with 700 parameters
+ * as with 7.
+ */
+class ParameterListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int total READ total NOTIFY countChanged)
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        ValueRole,
+        ComponentRole,
+        IndexRole           ///< param_index, -1 for values only read by name
+    };
+
+    explicit ParameterListModel(QObject *parent = 0);
+
+    /** @brief Follow the parameters of uas, null empties the list */
+    void setUas(UASInterface *uas);
+
+    QString filter() const { return m_filter; }
+    /** @brief Case insensitive, names starting with filter come first, then those containing it */
+    void setFilter(const QString &filter);
+    /** @brief Rows matching the filter */
+    int count() const { return m_rows.size(); }
+    /** @brief All parameters */
+    int total() const { return m_entries.size(); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    /** @brief Write a new value for row, see UAS::setParameter */
+    Q_INVOKABLE void setValue(int row, const QVariant &value);
+
+signals:
+    void filterChanged();
+    void countChanged();
+
+private slots:
+    void rebuild();
+    void parameterChanged(int uas, int component, QString name, QVariant value);
+    void parameterListComplete(int uas, int component, int missing);
+
+private:
+    enum { RebuildDelayMs = 250 };
+    struct Entry
+    {
+        QByteArray key;                 ///< Upper case name, the sort key
+        ParameterStore::Handle handle;
+    };
+    class SuffixLess;
+    friend class SuffixLess;
+
+    static quint32 suffix(int entry, int offset) { return (quint32(entry) << 5) | quint32(offset); }
+    const char *suffixText(quint32 suffix) const { return m_entries.at(suffix >> 5).key.constData() + (suffix & 31); }
+    void applyFilter();
+
+    QPointer<UASInterface> m_uas;
+    QVector<Entry> m_entries;           ///< Sorted by key
+    QVector<quint32> m_suffixes;        ///< entry << 5 | offset, sorted by the text from offset on
+    QVector<const char*> m_keyTexts;    ///< Key of each entry
+    QVector<const char*> m_suffixTexts; ///< Text of each suffix
+    QHash<ParameterStore::Handle, int> m_entryOfHandle;
+    QVector<int> m_rows;                ///< Entries shown, in row order
+    QVector<int> m_rowOfEntry;          ///< -1 when filtered out
+    QByteArray m_key;                   ///< Upper case filter
+    QString m_filter;
+    QTimer m_rebuildTimer;              ///< Coalesces names arriving one by one
+};
+
+#endif // PARAMETERLISTMODEL_H
@@ -0,0 +1,257 @@
+#include "ParameterStore.h"
+
+ParameterStore::ParameterStore() :
+    m_floatEncoded(false)
+{
+    memset(m_components, 0, sizeof(m_components));
+}
+
+ParameterStore::~ParameterStore()
+{
+    clear();
+}
+
+bool ParameterStore::isSupportedType(int type)
+{
+    switch (type)
+    {
+    case MAV_PARAM_TYPE_REAL32:
+    case MAV_PARAM_TYPE_UINT8:
+    case MAV_PARAM_TYPE_INT8:
+    case MAV_PARAM_TYPE_INT16:
+    case MAV_PARAM_TYPE_UINT32:
+    case MAV_PARAM_TYPE_INT32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ParameterStore::Handle ParameterStore::insert(int component, int index, int count, const ParameterId &id, int type, quint32 raw, bool *changed)
+{
+    if (component < 0 || component > 255 || id.isNull())
+    {
+        return InvalidHandle;
+    }
+    Component *&state = m_components[component];
+    if (!state)
+    {
+        state = new Component();
+    }
+    if (count > 0 && count != state->count && count < 0xFFFF)
+    {
+        // A different list, keep what can be found by name until it is sent again
+        QVector<Entry> named;
+        for (int slot = 0; slot < state->entries.size(); ++slot)
+        {
+            if (state->entries.at(slot).type != 0)
+            {
+                named.append(state->entries.at(slot));
+            }
+        }
+        state->count = count;
+        state->entries = QVector<Entry>(count);
+        state->entries += named;
+        state->lookup.clear();
+        for (int slot = count; slot < state->entries.size(); ++slot)
+        {
+            state->lookup.insert(state->entries.at(slot).id, slot);
+        }
+    }
+
+    int slot = state->lookup.value(id, -1);
+    bool known = slot >= 0;
+    Entry previous;
+    if (known)
+    {
+        previous = state->entries.at(slot);
+    }
+    if (index >= 0 && index < state->count && slot != index)
+    {
+        // The value moved to its index, or a read by name came first
+        if (known)
+        {
+            remove(*state, slot);
+        }
+        if (state->entries.at(index).type != 0)
+        {
+            state->lookup.remove(state->entries.at(index).id);
+        }
+        slot = index;
+        state->lookup.insert(id, slot);
+    }
+    else if (slot < 0)
+    {
+        slot = state->entries.size();
+        state->entries.append(Entry());
+        state->lookup.insert(id, slot);
+    }
+
+    Entry &value = state->entries[slot];
+    value.id = id;
+    value.type = static_cast<quint8>(type);
+    value.raw = raw;
+    if (changed)
+    {
+        *changed = !known || previous.type != value.type || previous.raw != value.raw;
+    }
+    return (component << 16) | slot;
+}
+
+void ParameterStore::remove(Component &state, int slot)
+{
+    state.lookup.remove(state.entries.at(slot).id);
+    if (slot < state.count)
+    {
+        state.entries[slot] = Entry();
+        return;
+    }
+    // Extra slots stay compact, move the last one into the gap
+    int last = state.entries.size() - 1;
+    if (slot != last)
+    {
+        state.entries[slot] = state.entries.at(last);
+        state.lookup.insert(state.entries.at(slot).id, slot);
+    }
+    state.entries.resize(last);
+}
+
+void ParameterStore::clear()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        delete m_components[i];
+        m_components[i] = 0;
+    }
+}
+
+ParameterStore::Handle ParameterStore::find(int component, const ParameterId &id) const
+{
+    if (component < 0 || component > 255 || !m_components[component])
+    {
+        return InvalidHandle;
+    }
+    int slot = m_components[component]->lookup.value(id, -1);
+    return slot < 0 ? static_cast<int>(InvalidHandle) : ((component << 16) | slot);
+}
+
+int ParameterStore::index(Handle handle) const
+{
+    int slot = handle & 0xFFFF;
+    return slot < m_components[handle >> 16]->count ? slot : -1;
+}
+
+float ParameterStore::toFloat(Handle handle) const
+{
+    const Entry &value = entry(handle);
+    mavlink_param_union_t u;
+    u.param_uint32 = value.raw;
+    if (m_floatEncoded || value.type == MAV_PARAM_TYPE_REAL32)
+    {
+        return u.param_float;
+    }
+    return static_cast<float>(toInt(handle));
+}
+
+qint32 ParameterStore::toInt(Handle handle) const
+{
+    const Entry &value = entry(handle);
+    mavlink_param_union_t u;
+    u.param_uint32 = value.raw;
+    if (m_floatEncoded || value.type == MAV_PARAM_TYPE_REAL32)
+    {
+        return static_cast<qint32>(u.param_float);
+    }
+    switch (value.type)
+    {
+    case MAV_PARAM_TYPE_UINT8: return u.param_uint8;
+    case MAV_PARAM_TYPE_INT8: return u.param_int8;
+    case MAV_PARAM_TYPE_INT16: return u.param_int16;
+    case MAV_PARAM_TYPE_UINT32: return static_cast<qint32>(u.param_uint32);
+    default: return u.param_int32;
+    }
+}
+
+QVariant ParameterStore::toVariant(Handle handle) const
+{
+    const Entry &value = entry(handle);
+    mavlink_param_union_t u;
+    u.param_uint32 = value.raw;
+    switch (value.type)
+    {
+    case MAV_PARAM_TYPE_REAL32:
+        return m_floatEncoded ? QVariant(static_cast<double>(u.param_float)) : QVariant(u.param_float);
+    case MAV_PARAM_TYPE_UINT8:
+        return m_floatEncoded ? QVariant(static_cast<uint>(u.param_float)) : QVariant(QChar((unsigned char)u.param_uint8));
+    case MAV_PARAM_TYPE_INT8:
+        return m_floatEncoded ? QVariant(static_cast<int>(u.param_float)) : QVariant(QChar((char)u.param_int8));
+    case MAV_PARAM_TYPE_INT16:
+        return m_floatEncoded ? QVariant(static_cast<int>(u.param_float)) : QVariant(u.param_int16);
+    case MAV_PARAM_TYPE_UINT32:
+        return m_floatEncoded ? QVariant(static_cast<uint>(u.param_float)) : QVariant(u.param_uint32);
+    case MAV_PARAM_TYPE_INT32:
+        return m_floatEncoded ? QVariant(static_cast<int>(u.param_float)) : QVariant(u.param_int32);
+    default:
+        return QVariant();
+    }
+}
+
+QList<int> ParameterStore::components() const
+{
+    QList<int> ids;
+    for (int i = 0; i < 256; ++i)
+    {
+        if (m_components[i] && !m_components[i]->lookup.isEmpty())
+        {
+            ids.append(i);
+        }
+    }
+    return ids;
+}
+
+int ParameterStore::count(int component) const
+{
+    return (component >= 0 && component <= 255 && m_components[component]) ? m_components[component]->count : 0;
+}
+
+int ParameterStore::size(int component) const
+{
+    return (component >= 0 && component <= 255 && m_components[component]) ? m_components[component]->entries.size() : 0;
+}
+
+ParameterStore::Handle ParameterStore::handle(int component, int slot) const
+{
+    if (slot < 0 || slot >= size(component) || m_components[component]->entries.at(slot).type == 0)
+    {
+        return InvalidHandle;
+    }
+    return (component << 16) | slot;
+}
+
+QList<QString> ParameterStore::names(int component) const
+{
+    QList<QString> list;
+    for (int slot = 0; slot < size(component); ++slot)
+    {
+        Handle h = handle(component, slot);
+        if (h >= 0)
+        {
+            list.append(name(h));
+        }
+    }
+    return list;
+}
+
+QList<QVariant> ParameterStore::values(int component) const
+{
+    QList<QVariant> list;
+    for (int slot = 0; slot < size(component); ++slot)
+    {
+        Handle h = handle(component, slot);
+        if (h >= 0)
+        {
+            list.append(toVariant(h));
+        }
+    }
+    return list;
+}
@@ -0,0 +1,133 @@
+#ifndef PARAMETERSTORE_H
+#define PARAMETERSTORE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <cstring>
+#include "QGCMAVLink.h"
+
+/** @brief A MAVLink param_id: 16 characters, NUL padded, hashed and compared as two words */
+class ParameterId
+{
+public:
+    enum { Length = 16 };
+
+    ParameterId() { m_words[0] = 0; m_words[1] = 0; }
+    /** @brief From a param_id field, not necessarily NUL terminated */
+    explicit ParameterId(const char *id)
+    {
+        m_words[0] = 0;
+        m_words[1] = 0;
+        strncpy(reinterpret_cast<char*>(m_words), id, Length);
+    }
+    explicit ParameterId(const QString &name)
+    {
+        m_words[0] = 0;
+        m_words[1] = 0;
+        QByteArray latin = name.toLatin1();
+        memcpy(m_words, latin.constData(), qMin(latin.size(), static_cast<int>(Length)));
+    }
+
+    bool isNull() const { return m_words[0] == 0; }
+    const char *data() const { return reinterpret_cast<const char*>(m_words); }
+    QString toString() const { return QString::fromLatin1(data(), qstrnlen(data(), Length)); }
+
+    bool operator==(const ParameterId &other) const { return m_words[0] == other.m_words[0] && m_words[1] == other.m_words[1]; }
+    bool operator!=(const ParameterId &other) const { return !(*this == other); }
+    friend inline uint qHash(const ParameterId &id) { return qHash(id.m_words[0] ^ (id.m_words[1] * 0x9E3779B97F4A7C15ULL)); }
+
+private:
+    quint64 m_words[2];
+};
+
+/**
+ * @brief Parameters of all components of one vehicle
+ *
+ * Each component keeps one contiguous array of values. Slot i holds
+ * param_index i, answers to reads by name that carry no index are appended
+ * after param_count. The value is kept as the 32 bits of the param union
+ * and converted on read. A Handle names one slot, so code that reads a
+ * parameter often looks it up once and then reads it without any hashing.
+ */
+class ParameterStore
+{
+public:
+    /** @brief component << 16 | slot, negative when not found */
+    typedef int Handle;
+    enum { InvalidHandle = -1 };
+
+    ParameterStore();
+    ~ParameterStore();
+
+    /** @brief ArduPilot sends every type as a float, see toVariant */
+    void setFloatEncoded(bool floatEncoded) { m_floatEncoded = floatEncoded; }
+    bool floatEncoded() const { return m_floatEncoded; }
+
+    /** @brief Types the store converts, MAV_PARAM_TYPE_* */
+    static bool isSupportedType(int type);
+
+    /**
+     * @brief Store one PARAM_VALUE
+     * @param changed set when the value was new or differs from the stored one
+     */
+    Handle insert(int component, int index, int count, const ParameterId &id, int type, quint32 raw, bool *changed = 0);
+    void clear();
+
+    Handle find(int component, const ParameterId &id) const;
+    Handle find(int component, const QString &name) const { return find(component, ParameterId(name)); }
+    bool contains(int component, const QString &name) const { return find(component, name) >= 0; }
+
+    static int component(Handle handle) { return handle >> 16; }
+    const ParameterId &id(Handle handle) const { return entry(handle).id; }
+    QString name(Handle handle) const { return entry(handle).id.toString(); }
+    int type(Handle handle) const { return entry(handle).type; }
+    quint32 raw(Handle handle) const { return entry(handle).raw; }
+    /** @brief param_index, -1 for values only read by name */
+    int index(Handle handle) const;
+
+    float toFloat(Handle handle) const;
+    qint32 toInt(Handle handle) const;
+    /** @brief The QVariant UAS has always emitted for this value */
+    QVariant toVariant(Handle handle) const;
+
+    /** @brief Components with at least one parameter */
+    QList<int> components() const;
+    /** @brief param_count of component, 0 when unknown */
+    int count(int component) const;
+    /** @brief Slots of component, iterate with handle(component, slot) */
+    int size(int component) const;
+    /** @brief Handle of a slot, InvalidHandle where empty */
+    Handle handle(int component, int slot) const;
+
+    QList<QString> names(int component) const;
+    QList<QVariant> values(int component) const;
+
+private:
+    Q_DISABLE_COPY(ParameterStore)
+
+    struct Entry
+    {
+        Entry() : type(0), raw(0) { }
+        ParameterId id;
+        quint8 type;            ///< 0 for an empty slot
+        quint32 raw;
+    };
+    struct Component
+    {
+        Component() : count(0) { }
+        int count;
+        QVector<Entry> entries;
+        QHash<ParameterId, int> lookup;   ///< id -> slot
+    };
+
+    const Entry &entry(Handle handle) const { return m_components[handle >> 16]->entries.at(handle & 0xFFFF); }
+    void remove(Component &state, int slot);
+
+    Component *m_components[256];
+    bool m_floatEncoded;
+};
+
+#endif // PARAMETERSTORE_H
@@ -0,0 +1,269 @@
+#include "ParameterSync.h"
+#include "UAS1.h"
+#include "QsLog.h"
+
+static const int TickMs = TimerWheel::TickMs;
+static const int InitialTimeoutMs = 500;
+static const int MinTimeoutMs = 100;
+static const int MaxTimeoutMs = 3000;
+// No PARAM_VALUE this long (or two timeouts) and the initial stream is over
+static const int StreamIdleMs = 300;
+static const int ListTimeoutMs = 2000;
+static const int MaxListRequests = 3;
+static const int InitialWindow = 4;
+static const int MaxWindow = 16;
+static const int MaxAttempts = 5;
+static const int ProgressIntervalMs = 100;
+
+ParameterSync::ParameterSync(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_timer(TimerWheel::InvalidTimer),
+    m_lastReceived(0),
+    m_lastProgress(0),
+    m_lastListRequest(0),
+    m_listRequests(0),
+    m_window(InitialWindow),
+    m_srtt(0),
+    m_rttVar(0),
+    m_timeout(InitialTimeoutMs)
+{
+}
+
+ParameterSync::~ParameterSync()
+{
+    stop();
+}
+
+void ParameterSync::start()
+{
+    m_components.clear();
+    m_clock.start();
+    m_lastReceived = 0;
+    m_lastProgress = 0;
+    m_lastListRequest = 0;
+    m_listRequests = 1;
+    m_window = InitialWindow;
+    stop();
+    m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    m_uas->requestParameterList();
+}
+
+void ParameterSync::stop()
+{
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+}
+
+int ParameterSync::receivedCount(int component) const
+{
+    return m_components.value(component).received;
+}
+
+int ParameterSync::parameterCount(int component) const
+{
+    return m_components.value(component).count;
+}
+
+void ParameterSync::received(int component, int index, int count)
+{
+    if (!isActive() || count <= 0)
+    {
+        return;
+    }
+    Component &state = m_components[component];
+    if (state.done)
+    {
+        return;
+    }
+    if (state.count != count)
+    {
+        // First value, or the autopilot changed its list under us
+        state.have = QBitArray(count);
+        state.count = count;
+        state.received = 0;
+        state.inFlight.clear();
+        state.attempts.clear();
+    }
+    qint64 now = m_clock.elapsed();
+    m_lastReceived = now;
+    // 65535 answers a read by name
+    if (index < 0 || index >= count)
+    {
+        return;
+    }
+
+    QMap<int, qint64>::iterator request = state.inFlight.find(index);
+    if (request != state.inFlight.end())
+    {
+        // Karn: a retried request says nothing about the round trip
+        if (state.attempts.value(index) == 1)
+        {
+            updateTimeout(now - request.value());
+        }
+        state.inFlight.erase(request);
+        if (m_window < MaxWindow)
+        {
+            ++m_window;
+        }
+    }
+    if (state.have.testBit(index))
+    {
+        return;
+    }
+    state.have.setBit(index);
+    ++state.received;
+
+    if (state.received == state.count)
+    {
+        complete(component, state);
+        return;
+    }
+    if (now - m_lastProgress >= ProgressIntervalMs)
+    {
+        m_lastProgress = now;
+        emit progress(m_uas->getUASID(), component, state.received, state.count);
+    }
+    if (state.filling)
+    {
+        // Keep the window full instead of waiting for the next tick
+        fillGaps(component, state, now);
+    }
+}
+
+void ParameterSync::tick()
+{
+    qint64 now = m_clock.elapsed();
+    if (m_components.isEmpty())
+    {
+        // Not a single PARAM_VALUE yet, the list request may have been lost
+        if (now - m_lastListRequest < ListTimeoutMs)
+        {
+            return;
+        }
+        if (m_listRequests >= MaxListRequests)
+        {
+            QLOG_WARN() << "No parameters from system" << m_uas->getUASID() << "after" << m_listRequests << "requests";
+            stop();
+            return;
+        }
+        ++m_listRequests;
+        m_lastListRequest = now;
+        m_uas->requestParameterList();
+        return;
+    }
+
+    bool pending = false;
+    for (QMap<int, Component>::iterator it = m_components.begin(); it != m_components.end(); ++it)
+    {
+        Component &state = it.value();
+        if (state.done)
+        {
+            continue;
+        }
+        pending = true;
+        if (!state.filling)
+        {
+            if (now - m_lastReceived < qMax(StreamIdleMs, 2 * m_timeout))
+            {
+                continue;
+            }
+            state.filling = true;
+            QLOG_DEBUG() << "Parameter stream of component" << it.key() << "ended with"
+                         << state.received << "of" << state.count;
+        }
+        fillGaps(it.key(), state, now);
+    }
+    if (!pending)
+    {
+        stop();
+    }
+}
+
+void ParameterSync::fillGaps(int component, Component &state, qint64 now)
+{
+    bool timedOut = false;
+    for (QMap<int, qint64>::iterator it = state.inFlight.begin(); it != state.inFlight.end();)
+    {
+        if (now - it.value() >= m_timeout)
+        {
+            it = state.inFlight.erase(it);
+            timedOut = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if (timedOut)
+    {
+        // Likely congestion on the radio, back off
+        m_window = qMax(1, m_window / 2);
+        m_timeout = qMin(MaxTimeoutMs, m_timeout * 2);
+    }
+
+    for (int index = 0; index < state.count && state.inFlight.size() < m_window; ++index)
+    {
+        if (state.have.testBit(index) || state.inFlight.contains(index))
+        {
+            continue;
+        }
+        int &attempts = state.attempts[index];
+        if (attempts >= MaxAttempts)
+        {
+            continue;
+        }
+        ++attempts;
+        state.inFlight.insert(index, now);
+        m_uas->requestParameter(component, index);
+    }
+
+    if (state.inFlight.isEmpty())
+    {
+        // Whatever is still missing ran out of attempts
+        complete(component, state);
+    }
+}
+
+void ParameterSync::complete(int component, Component &state)
+{
+    state.done = true;
+    state.inFlight.clear();
+    bool all = true;
+    for (QMap<int, Component>::const_iterator it = m_components.constBegin(); it != m_components.constEnd(); ++it)
+    {
+        all = all && it.value().done;
+    }
+    if (all)
+    {
+        // Before finished(), so receivers see the download as over
+        stop();
+    }
+    int missing = state.count - state.received;
+    if (missing > 0)
+    {
+        QLOG_WARN() << "Parameter list of component" << component << "incomplete," << missing << "missing";
+    }
+    else
+    {
+        QLOG_INFO() << "Received" << state.count << "parameters of component" << component
+                    << "in" << m_clock.elapsed() << "ms";
+    }
+    emit progress(m_uas->getUASID(), component, state.received, state.count);
+    emit finished(m_uas->getUASID(), component, missing);
+}
+
+void ParameterSync::updateTimeout(qint64 rtt)
+{
+    if (m_srtt == 0)
+    {
+        m_srtt = rtt;
+        m_rttVar = rtt / 2.0;
+    }
+    else
+    {
+        m_rttVar = 0.75 * m_rttVar + 0.25 * qAbs(m_srtt - rtt);
+        m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+    m_timeout = qBound(MinTimeoutMs, static_cast<int>(m_srtt + 4 * m_rttVar), MaxTimeoutMs);
+}
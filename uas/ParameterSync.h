@@ -0,0 +1,83 @@
+#ifndef PARAMETERSYNC_H
+#define PARAMETERSYNC_H
+
+#include <QObject>
+#include <QMap>
+#include <QBitArray>
+#include <QVector>
+#include <QElapsedTimer>
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Downloads the parameter list of every component of a UAS
+ *
+ * PARAM_REQUEST_LIST makes the autopilot stream all parameters once. Each
+ * PARAM_VALUE carries param_index and param_count, a bitmap per component
+ * records what arrived. When the stream goes quiet the missing indices are
+ * requested by PARAM_REQUEST_READ with a window of requests in flight.
+ * The window grows while answers come back and halves on a timeout, the
+ * timeout follows the measured round trip like TCP's retransmission timer.
+ */
+class ParameterSync : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ParameterSync(UAS *uas);
+    ~ParameterSync();
+
+    /** @brief Request the full list again, forgetting what was received */
+    void start();
+    /** @brief Give up on all components */
+    void stop();
+    /** @brief Record a received PARAM_VALUE */
+    void received(int component, int index, int count);
+
+    bool isActive() const { return m_timer != TimerWheel::InvalidTimer; }
+    /** @brief Parameters received for component */
+    int receivedCount(int component) const;
+    /** @brief Parameters component has, 0 until its first PARAM_VALUE */
+    int parameterCount(int component) const;
+
+signals:
+    /** @brief Emitted at most every ProgressIntervalMs and on completion */
+    void progress(int uas, int component, int received, int count);
+    /** @brief The list of component is complete, or missing could not be fetched */
+    void finished(int uas, int component, int missing);
+
+private slots:
+    void tick();
+
+private:
+    struct Component
+    {
+        Component() : count(0), received(0), filling(false), done(false) { }
+        QBitArray have;
+        int count;
+        int received;
+        QMap<int, qint64> inFlight;   ///< index -> time requested
+        QMap<int, int> attempts;      ///< index -> requests sent
+        bool filling;                 ///< The stream went quiet, requesting gaps
+        bool done;
+    };
+
+    void fillGaps(int component, Component &state, qint64 now);
+    void complete(int component, Component &state);
+    void updateTimeout(qint64 rtt);
+
+    UAS *m_uas;
+    QMap<int, Component> m_components;
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastReceived;
+    qint64 m_lastProgress;
+    qint64 m_lastListRequest;
+    int m_listRequests;
+    int m_window;
+    double m_srtt;
+    double m_rttVar;
+    int m_timeout;
+};
+
+#endif // PARAMETERSYNC_H
@@ -0,0 +1,301 @@
+#include "ParameterWriter.h"
+#include "UAS1.h"
+#include "QsLog.h"
+#include <cstring>
+
+static const int TickMs = TimerWheel::TickMs;
+static const int InitialTimeoutMs = 500;
+static const int MinTimeoutMs = 100;
+static const int MaxTimeoutMs = 3000;
+static const int InitialWindow = 4;
+static const int MaxWindow = 16;
+static const int MaxAttempts = 5;
+static const int ProgressIntervalMs = 100;
+
+static quint32 rawValue(const mavlink_param_set_t &set)
+{
+    quint32 raw;
+    memcpy(&raw, &set.param_value, sizeof(raw));
+    return raw;
+}
+
+static float floatValue(quint32 raw)
+{
+    float value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+ParameterWriter::ParameterWriter(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_timer(TimerWheel::InvalidTimer),
+    m_lastProgress(0),
+    m_count(0),
+    m_written(0),
+    m_failed(0),
+    m_window(InitialWindow),
+    m_srtt(0),
+    m_rttVar(0),
+    m_timeout(InitialTimeoutMs)
+{
+    m_clock.start();
+}
+
+ParameterWriter::~ParameterWriter()
+{
+    stop();
+}
+
+bool ParameterWriter::write(int component, const QString &name, const QVariant &value)
+{
+    return enqueue(component, name, value, false);
+}
+
+int ParameterWriter::writeChanged(int component, const QMap<QString, QVariant> &values)
+{
+    int queued = 0;
+    for (QMap<QString, QVariant>::const_iterator it = values.constBegin(); it != values.constEnd(); ++it)
+    {
+        if (enqueue(component, it.key(), it.value(), true))
+        {
+            ++queued;
+        }
+    }
+    QLOG_INFO() << "Writing" << queued << "of" << values.size() << "parameters of component" << component;
+    return queued;
+}
+
+bool ParameterWriter::enqueue(int component, const QString &name, const QVariant &value, bool onlyChanged)
+{
+    Write write;
+    write.component = component;
+    write.id = ParameterId(name);
+    if (write.id.isNull() || !m_uas->encodeParameter(component, name, value, &write.set))
+    {
+        return false;
+    }
+    if (onlyChanged)
+    {
+        const ParameterStore &store = m_uas->getParameterStore();
+        ParameterStore::Handle handle = store.find(component, write.id);
+        if (handle >= 0 && matches(write, store.type(handle), store.raw(handle)))
+        {
+            return false;
+        }
+    }
+
+    // The latest value wins, an older one in flight is ignored when it echoes
+    for (int i = 0; i < m_queue.size(); ++i)
+    {
+        if (m_queue.at(i).component == component && m_queue.at(i).id == write.id)
+        {
+            m_queue[i] = write;
+            return true;
+        }
+    }
+    for (int i = 0; i < m_inFlight.size(); ++i)
+    {
+        if (m_inFlight.at(i).component == component && m_inFlight.at(i).id == write.id)
+        {
+            m_inFlight.removeAt(i);
+            --m_count;
+            break;
+        }
+    }
+    if (m_queue.isEmpty() && m_inFlight.isEmpty())
+    {
+        m_count = 0;
+        m_written = 0;
+        m_failed = 0;
+        m_lastProgress = 0;
+    }
+    m_queue.append(write);
+    ++m_count;
+
+    if (!isActive())
+    {
+        m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+    }
+    fillWindow(m_clock.elapsed());
+    return true;
+}
+
+void ParameterWriter::stop()
+{
+    m_queue.clear();
+    m_inFlight.clear();
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+}
+
+bool ParameterWriter::matches(const Write &write, int type, quint32 raw) const
+{
+    Q_UNUSED(type);
+    quint32 expected = rawValue(write.set);
+    if (expected == raw)
+    {
+        return true;
+    }
+    // ArduPilot keeps every value as a float and may round what it stores
+    if (write.set.param_type == MAV_PARAM_TYPE_REAL32 || m_uas->getParameterStore().floatEncoded())
+    {
+        float a = floatValue(expected);
+        float b = floatValue(raw);
+        return qAbs(a - b) <= 1e-5f * qMax(1.0f, qAbs(a));
+    }
+    return false;
+}
+
+void ParameterWriter::received(int component, const ParameterId &id, int type, quint32 raw)
+{
+    if (m_inFlight.isEmpty())
+    {
+        return;
+    }
+    int found = -1;
+    for (int i = 0; i < m_inFlight.size(); ++i)
+    {
+        const Write &write = m_inFlight.at(i);
+        if (write.id == id && (write.component == component || write.component == MAV_COMP_ID_ALL))
+        {
+            found = i;
+            break;
+        }
+    }
+    if (found < 0)
+    {
+        return;
+    }
+
+    qint64 now = m_clock.elapsed();
+    Write &write = m_inFlight[found];
+    if (!matches(write, type, raw))
+    {
+        // Part of the download that crossed the write, or the write was lost on the way
+        if (now - write.sent < m_timeout / 2)
+        {
+            return;
+        }
+        QLOG_DEBUG() << "Parameter" << id.toString() << "echoed" << floatValue(raw) << "instead of"
+                     << write.set.param_value;
+        if (write.attempts < MaxAttempts)
+        {
+            transmit(write, now);
+            return;
+        }
+        QLOG_WARN() << "Parameter" << id.toString() << "of component" << component << "kept a different value";
+        ++m_failed;
+    }
+    else
+    {
+        // Karn: a resent write says nothing about the round trip
+        if (write.attempts == 1)
+        {
+            updateTimeout(now - write.sent);
+        }
+        ++m_written;
+        if (m_window < MaxWindow)
+        {
+            ++m_window;
+        }
+    }
+    m_inFlight.removeAt(found);
+
+    if (m_queue.isEmpty() && m_inFlight.isEmpty())
+    {
+        complete();
+        return;
+    }
+    if (now - m_lastProgress >= ProgressIntervalMs)
+    {
+        m_lastProgress = now;
+        emit progress(m_uas->getUASID(), m_written + m_failed, m_count);
+    }
+    fillWindow(now);
+}
+
+void ParameterWriter::tick()
+{
+    qint64 now = m_clock.elapsed();
+    bool timedOut = false;
+    for (int i = 0; i < m_inFlight.size();)
+    {
+        Write &write = m_inFlight[i];
+        if (now - write.sent < m_timeout)
+        {
+            ++i;
+            continue;
+        }
+        timedOut = true;
+        if (write.attempts < MaxAttempts)
+        {
+            transmit(write, now);
+            ++i;
+            continue;
+        }
+        QLOG_WARN() << "No echo for parameter" << write.id.toString() << "of component" << write.component
+                    << "after" << write.attempts << "attempts";
+        ++m_failed;
+        m_inFlight.removeAt(i);
+    }
+    if (timedOut)
+    {
+        // Likely congestion on the radio, back off
+        m_window = qMax(1, m_window / 2);
+        m_timeout = qMin(MaxTimeoutMs, m_timeout * 2);
+    }
+    if (m_queue.isEmpty() && m_inFlight.isEmpty())
+    {
+        complete();
+        return;
+    }
+    fillWindow(now);
+}
+
+void ParameterWriter::fillWindow(qint64 now)
+{
+    while (!m_queue.isEmpty() && m_inFlight.size() < m_window)
+    {
+        m_inFlight.append(m_queue.takeFirst());
+        transmit(m_inFlight.last(), now);
+    }
+}
+
+void ParameterWriter::transmit(Write &write, qint64 now)
+{
+    ++write.attempts;
+    write.sent = now;
+    m_uas->sendParameterSet(write.set);
+}
+
+void ParameterWriter::complete()
+{
+    // Before finished(), so receivers see the writer as idle
+    stop();
+    if (m_failed > 0)
+    {
+        QLOG_WARN() << m_failed << "of" << m_count << "parameter writes of system" << m_uas->getUASID() << "failed";
+    }
+    else
+    {
+        QLOG_INFO() << "Wrote" << m_written << "parameters of system" << m_uas->getUASID();
+    }
+    emit progress(m_uas->getUASID(), m_written + m_failed, m_count);
+    emit finished(m_uas->getUASID(), m_written, m_failed);
+}
+
+void ParameterWriter::updateTimeout(qint64 rtt)
+{
+    if (m_srtt == 0)
+    {
+        m_srtt = rtt;
+        m_rttVar = rtt / 2.0;
+    }
+    else
+    {
+        m_rttVar = 0.75 * m_rttVar + 0.25 * qAbs(m_srtt - rtt);
+        m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+    m_timeout = qBound(MinTimeoutMs, static_cast<int>(m_srtt + 4 * m_rttVar), MaxTimeoutMs);
+}
@@ -0,0 +1,92 @@
+#ifndef PARAMETERWRITER_H
+#define PARAMETERWRITER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QVariant>
+#include <QElapsedTimer>
+#include "QGCMAVLink.h"
+#include "ParameterStore.h"
+#include "TimerWheel.h"
+
+class UAS;
+
+/**
+ * @brief Writes many parameters of a UAS and verifies each one
+ *
+ * Writes are queued and streamed as PARAM_SETs with a window of them in
+ * flight. The autopilot answers every PARAM_SET with the PARAM_VALUE it
+ * stored, that echo is matched to the pending write by component and name.
+ * A different value or no echo within the timeout sends the write again,
+ * up to MaxAttempts. Window and timeout adapt like in ParameterSync.
+ */
+class ParameterWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ParameterWriter(UAS *uas);
+    ~ParameterWriter();
+
+    /** @brief Queue one write, replacing a queued write of the same parameter */
+    bool write(int component, const QString &name, const QVariant &value);
+    /**
+     * @brief Queue the values that differ from the parameter store
+     *
+     * The store holds what the vehicle last reported, or the cached list
+     * until that is verified, so a saved configuration only costs the
+     * writes of what it changes.
+     * @return Writes queued
+     */
+    int writeChanged(int component, const QMap<QString, QVariant> &values);
+    /** @brief Drop all queued and pending writes */
+    void stop();
+    /** @brief Record a received PARAM_VALUE */
+    void received(int component, const ParameterId &id, int type, quint32 raw);
+
+    bool isActive() const { return m_timer != TimerWheel::InvalidTimer; }
+    int pendingCount() const { return m_queue.size() + m_inFlight.size(); }
+
+signals:
+    /** @brief Emitted at most every ProgressIntervalMs and on completion */
+    void progress(int uas, int written, int count);
+    /** @brief All writes ended, failed is the number that could not be verified */
+    void finished(int uas, int written, int failed);
+
+private slots:
+    void tick();
+
+private:
+    struct Write
+    {
+        Write() : attempts(0), sent(0) { }
+        int component;
+        ParameterId id;
+        mavlink_param_set_t set;
+        int attempts;
+        qint64 sent;
+    };
+
+    bool enqueue(int component, const QString &name, const QVariant &value, bool onlyChanged);
+    bool matches(const Write &write, int type, quint32 raw) const;
+    void transmit(Write &write, qint64 now);
+    void fillWindow(qint64 now);
+    void complete();
+    void updateTimeout(qint64 rtt);
+
+    UAS *m_uas;
+    QList<Write> m_queue;
+    QList<Write> m_inFlight;        ///< at most m_window, searched linearly
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastProgress;
+    int m_count;                    ///< Writes since the queue was last empty
+    int m_written;
+    int m_failed;
+    int m_window;
+    double m_srtt;
+    double m_rttVar;
+    int m_timeout;
+};
+
+#endif // PARAMETERWRITER_H
@@ -12,64 +12,57 @@ QGCUASParamManager::QGCUASParamManager(UASInterface* uas, QWidget *parent) :
     retransmissionBurstRequestSize(5)
 {
     uas->setParamManager(this);
+    connect(uas, SIGNAL(parameterListComplete(int,int,int)), this, SLOT(parameterListComplete(int,int,int)));
 }
 QList<QString> QGCUASParamManager::getParameterNames(int component) const
 {
-    if (parameters.contains(component))
-    {
-        return parameters.value(component)->keys();
-    }
-    else
-    {
-        return QList<QString>();
-    }
+    return mav->getParameterStore().names(component);
 }
 QList<QVariant> QGCUASParamManager::getParameterValues(int component) const
 {
-    if (parameters.contains(component))
-    {
-        return parameters.value(component)->values();
-    }
-    else
-    {
-        return QList<QVariant>();
-    }
+    return mav->getParameterStore().values(component);
 }
 bool QGCUASParamManager::getParameterValue(int component, const QString& parameter, QVariant& value) const {
-    if (!parameters.contains(component))
-    {
-        return false;
-    }
-
-    if (!parameters.value(component)->contains(parameter))
+    const ParameterStore &store = mav->getParameterStore();
+    ParameterStore::Handle handle = store.find(component, parameter);
+    if (handle < 0)
     {
         return false;
     }
 
-    value = parameters.value(component)->value(parameter);
+    value = store.toVariant(handle);
 
     return true;
 }
 
 QVariant QGCUASParamManager::getParameterValue(int component, const QString& parameter) const
 {
-    if (!parameters.contains(component))
-    {
-        return QVariant();
-    }
-    if (!parameters.value(component)->contains(parameter))
+    const ParameterStore &store = mav->getParameterStore();
+    ParameterStore::Handle handle = store.find(component, parameter);
+    if (handle < 0)
     {
         return QVariant();
     }
-    return parameters.value(component)->value(parameter);
+    return store.toVariant(handle);
 }
 
 /**
- * The .. signal is emitted
+ * The parameterListUpToDate signal is emitted once every parameter of the component arrived
  */
 void QGCUASParamManager::requestParameterListUpdate(int component)
 {
-	Q_UNUSED(component);
+    // PARAM_REQUEST_LIST goes to all components, the download is tracked per component
+    Q_UNUSED(component);
+    mav->requestParameters();
+}
+
+void QGCUASParamManager::parameterListComplete(int uas, int component, int missing)
+{
+    Q_UNUSED(uas);
+    if (missing == 0)
+    {
+        emit parameterListUpToDate(component);
+    }
 }
 
 
@@ -52,10 +52,12 @@ public slots:
     /** @brief Request list of parameters from MAV */
     virtual void requestParameterList() = 0;
 
+protected slots:
+    void parameterListComplete(int uas, int component, int missing);
+
 protected:
     UASInterface* mav;   ///< The MAV this widget is controlling
     QMap<int, QMap<QString, QVariant>* > changedValues; ///< Changed values
-    QMap<int, QMap<QString, QVariant>* > parameters; ///< All parameters
     QVector<bool> received; ///< Successfully received parameters
     QMap<int, QList<int>* > transmissionMissingPackets; ///< Missing packets
     QMap<int, QMap<QString, QVariant>* > transmissionMissingWriteAckPackets; ///< Missing write ACK packets
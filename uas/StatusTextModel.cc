@@ -0,0 +1,146 @@
+#include "StatusTextModel.h"
+#include <QDateTime>
+#include <cstring>
+
+StatusTextModel::StatusTextModel(QObject *parent) :
+    QAbstractListModel(parent),
+    m_ring(Capacity),
+    m_size(0),
+    m_next(0)
+{
+    memset(m_severityCounts, 0, sizeof(m_severityCounts));
+}
+
+bool StatusTextModel::add(int componentid, int severity, const QString &text)
+{
+    severity = qBound(0, severity, SeverityLevels - 1);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const Key key(componentid, severity, text);
+
+    QHash<Key, quint32>::const_iterator it = m_sequenceOfKey.constFind(key);
+    if (it != m_sequenceOfKey.constEnd())
+    {
+        Entry &entry = m_ring[it.value() % Capacity];
+        entry.count++;
+        entry.lastSeen = now;
+        QModelIndex changed = index(rowOfSequence(it.value()));
+        emit dataChanged(changed, changed, QVector<int>() << CountRole << LastSeenRole);
+        return false;
+    }
+
+    if (m_size == Capacity)
+    {
+        // The ring is full, the oldest row makes room
+        beginRemoveRows(QModelIndex(), m_size - 1, m_size - 1);
+        const Entry &oldest = m_ring.at(m_next % Capacity);
+        m_sequenceOfKey.remove(Key(oldest.component, oldest.severity, oldest.text));
+        m_severityCounts[oldest.severity]--;
+        m_size--;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), 0, 0);
+    Entry &entry = m_ring[m_next % Capacity];
+    entry.text = text;
+    entry.severity = severity;
+    entry.component = componentid;
+    entry.count = 1;
+    entry.firstSeen = now;
+    entry.lastSeen = now;
+    m_sequenceOfKey.insert(key, m_next);
+    m_severityCounts[severity]++;
+    m_next++;
+    m_size++;
+    endInsertRows();
+    emit countChanged();
+    return true;
+}
+
+void StatusTextModel::clear()
+{
+    if (m_size == 0)
+    {
+        return;
+    }
+    beginResetModel();
+    m_sequenceOfKey.clear();
+    memset(m_severityCounts, 0, sizeof(m_severityCounts));
+    m_size = 0;
+    endResetModel();
+    emit countChanged();
+}
+
+int StatusTextModel::alerts() const
+{
+    // MAV_SEVERITY_EMERGENCY to MAV_SEVERITY_ERROR
+    return m_severityCounts[0] + m_severityCounts[1] + m_severityCounts[2] + m_severityCounts[3];
+}
+
+int StatusTextModel::severityCount(int severity) const
+{
+    if (severity < 0 || severity >= SeverityLevels)
+    {
+        return 0;
+    }
+    return m_severityCounts[severity];
+}
+
+QString StatusTextModel::severityName(int severity)
+{
+    static const char *const names[SeverityLevels] =
+    {
+        "EMERGENCY", "ALERT", "CRITICAL", "ERROR", "WARNING", "NOTICE", "INFO", "DEBUG"
+    };
+    if (severity < 0 || severity >= SeverityLevels)
+    {
+        return QString();
+    }
+    return QLatin1String(names[severity]);
+}
+
+int StatusTextModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_size;
+}
+
+QVariant StatusTextModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_size)
+    {
+        return QVariant();
+    }
+    const Entry &entry = entryAtRow(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case TextRole:
+        return entry.text;
+    case SeverityRole:
+        return entry.severity;
+    case SeverityNameRole:
+        return severityName(entry.severity);
+    case ComponentRole:
+        return entry.component;
+    case CountRole:
+        return entry.count;
+    case FirstSeenRole:
+        return entry.firstSeen;
+    case LastSeenRole:
+        return entry.lastSeen;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> StatusTextModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[TextRole] = "text";
+    roles[SeverityRole] = "severity";
+    roles[SeverityNameRole] = "severityName";
+    roles[ComponentRole] = "component";
+    roles[CountRole] = "count";
+    roles[FirstSeenRole] = "firstSeen";
+    roles[LastSeenRole] = "lastSeen";
+    return roles;
+}
@@ -0,0 +1,94 @@
+#ifndef STATUSTEXTMODEL_H
+#define STATUSTEXTMODEL_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The STATUSTEXT messages of the active vehicle, newest first
+ *
+ * At most Capacity distinct messages are kept in a ring, the oldest drops
+ * out. A text the vehicle sends again from the same component with the same
+ * severity is not a new row: its count and last seen time go up and only
+ * those two roles change, so an autopilot repeating "PreArm: ..." every few
+ * seconds costs one dataChanged() instead of a new row and a banner. The
+ * rows held per severity are counted, for a badge or a filter.
+ */
+class StatusTextModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int alerts READ alerts NOTIFY countChanged)
+public:
+    enum { Capacity = 100, SeverityLevels = 8 };
+    enum Roles {
+        TextRole = Qt::UserRole + 1,
+        SeverityRole,       ///< MAV_SEVERITY, 0 emergency to 7 debug
+        SeverityNameRole,
+        ComponentRole,
+        CountRole,          ///< Times received
+        FirstSeenRole,      ///< ms since the epoch
+        LastSeenRole
+    };
+
+    explicit StatusTextModel(QObject *parent = 0);
+
+    /** @brief Add a received text, false if it only repeated a row */
+    bool add(int componentid, int severity, const QString &text);
+    /** @brief Forget every row, e.g. for another vehicle */
+    void clear();
+
+    int count() const { return m_size; }
+    /** @brief Rows of severity error or worse */
+    int alerts() const;
+    /** @brief Rows of one severity */
+    Q_INVOKABLE int severityCount(int severity) const;
+    static QString severityName(int severity);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+signals:
+    void countChanged();
+
+private:
+    /** @brief Pooled texts (see StringPool) compare by pointer, the key needs no string of its own */
+    struct Key
+    {
+        Key(int component, int severity, const QString &text) : component(component), severity(severity), text(text) { }
+        bool operator==(const Key &other) const
+        {
+            return component == other.component && severity == other.severity && text == other.text;
+        }
+        int component;
+        int severity;
+        QString text;
+    };
+    friend uint qHash(const Key &key) { return qHash(key.text) ^ uint(key.component << 3) ^ uint(key.severity); }
+
+    struct Entry
+    {
+        QString text;
+        int severity;
+        int component;
+        int count;
+        qint64 firstSeen;
+        qint64 lastSeen;
+    };
+
+    /** @brief Sequence numbers ascend with age; row 0 is the newest */
+    int rowOfSequence(quint32 sequence) const { return int(m_next - 1 - sequence); }
+    const Entry &entryAtRow(int row) const { return m_ring.at((m_next - 1 - row) % Capacity); }
+
+    QVector<Entry> m_ring;              ///< Capacity entries, sequence s at s % Capacity
+    int m_size;
+    quint32 m_next;                     ///< Sequence of the next new row
+    QHash<Key, quint32> m_sequenceOfKey;
+    int m_severityCounts[SeverityLevels];
+};
+
+#endif // STATUSTEXTMODEL_H
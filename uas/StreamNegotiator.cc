@@ -0,0 +1,207 @@
+#include "StreamNegotiator.h"
+#include "StreamRateTuner.h"
+#include "CommandTracker.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkDispatcher.h"
+#include "MAVLinkDecoder1.h"
+#include "UAS1.h"
+#include "QsLog.h"
+
+struct NegotiatedMessage
+{
+    int msgid;
+    StreamRateTuner::StreamClass stream;    ///< Whose rate it is requested at
+    bool always;                    ///< Vehicle state, alarms, history and track need it
+};
+
+// Roughly ArduPilot's stream groups, so the rates mean what they meant before
+static const NegotiatedMessage messages[] =
+{
+    { MAVLINK_MSG_ID_ATTITUDE, StreamRateTuner::Attitude, true },
+    { MAVLINK_MSG_ID_AHRS2, StreamRateTuner::Attitude, false },
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, StreamRateTuner::Position, true },
+    { MAVLINK_MSG_ID_LOCAL_POSITION_NED, StreamRateTuner::Position, false },
+    { MAVLINK_MSG_ID_VFR_HUD, StreamRateTuner::Hud, true },
+    { MAVLINK_MSG_ID_SYS_STATUS, StreamRateTuner::Status, true },
+    { MAVLINK_MSG_ID_GPS_RAW_INT, StreamRateTuner::Status, true },
+    { MAVLINK_MSG_ID_MISSION_CURRENT, StreamRateTuner::Status, true },
+    { MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, StreamRateTuner::Status, false },
+    { MAVLINK_MSG_ID_POWER_STATUS, StreamRateTuner::Status, false },
+    { MAVLINK_MSG_ID_BATTERY_STATUS, StreamRateTuner::Extra3, false },
+    { MAVLINK_MSG_ID_SYSTEM_TIME, StreamRateTuner::Extra3, false },
+    { MAVLINK_MSG_ID_AHRS, StreamRateTuner::Extra3, false },
+    { MAVLINK_MSG_ID_HWSTATUS, StreamRateTuner::Extra3, false },
+    { MAVLINK_MSG_ID_RANGEFINDER, StreamRateTuner::Extra3, false },
+    { MAVLINK_MSG_ID_RC_CHANNELS_RAW, StreamRateTuner::RcChannels, false },
+    { MAVLINK_MSG_ID_RC_CHANNELS, StreamRateTuner::RcChannels, false },
+    { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, StreamRateTuner::RcChannels, false },
+    { MAVLINK_MSG_ID_RAW_IMU, StreamRateTuner::RawSensors, false },
+    { MAVLINK_MSG_ID_SCALED_IMU2, StreamRateTuner::RawSensors, false },
+    { MAVLINK_MSG_ID_SCALED_PRESSURE, StreamRateTuner::RawSensors, false }
+};
+static const int MessageCount = sizeof(messages) / sizeof(messages[0]);
+
+StreamNegotiator::StreamNegotiator(UAS *uas, StreamRateTuner *tuner) :
+    QObject(tuner),
+    m_uas(uas),
+    m_tuner(tuner),
+    m_support(Unknown),
+    m_applied(MessageCount, 0),
+    m_inFlight(-1),
+    m_inFlightInterval(0),
+    m_settle(TimerWheel::InvalidTimer)
+{
+    connect(LinkManager::instance()->getMavlinkProtocol()->dispatcher(), SIGNAL(subscriptionsChanged()),
+            this, SLOT(subscriptionsChanged()));
+    connect(LinkManager::instance()->getMavlinkDecoder(), SIGNAL(subscriptionsChanged()),
+            this, SLOT(subscriptionsChanged()));
+    connect(uas->getCommandTracker(), SIGNAL(commandFinished(int,int,int,int,int,int)),
+            this, SLOT(commandFinished(int,int,int,int,int,int)));
+}
+
+StreamNegotiator::~StreamNegotiator()
+{
+    TimerWheel::instance()->stop(m_settle);
+}
+
+void StreamNegotiator::setSupport(Support support)
+{
+    if (support != m_support)
+    {
+        m_support = support;
+        emit supportChanged(support);
+    }
+}
+
+bool StreamNegotiator::isWanted(int entry) const
+{
+    const NegotiatedMessage &message = messages[entry];
+    return message.always
+            || LinkManager::instance()->getMavlinkProtocol()->dispatcher()->isWanted(m_uas->getUASID(), message.msgid)
+            || LinkManager::instance()->getMavlinkDecoder()->isSubscribed(message.msgid);
+}
+
+int StreamNegotiator::interval(int entry) const
+{
+    int rate = m_tuner->rate(messages[entry].stream);
+    return rate > 0 && isWanted(entry) ? 1000000 / rate : -1;
+}
+
+int StreamNegotiator::wantedCount() const
+{
+    int count = 0;
+    for (int i = 0; i < MessageCount; ++i)
+    {
+        if (interval(i) > 0) ++count;
+    }
+    return count;
+}
+
+void StreamNegotiator::probe()
+{
+    if (m_support != Unknown)
+    {
+        return;
+    }
+    setSupport(Probing);
+    sendNext();
+}
+
+void StreamNegotiator::requestAll()
+{
+    if (!isActive())
+    {
+        return;
+    }
+    // After a reconnect the autopilot may have rebooted and forgotten them
+    m_applied.fill(0);
+    m_uas->enableAllDataTransmission(0);
+    negotiate();
+}
+
+void StreamNegotiator::negotiate()
+{
+    // An answer in flight sends the rest when it comes back
+    if (isActive() && m_inFlight < 0)
+    {
+        sendNext();
+    }
+}
+
+void StreamNegotiator::subscriptionsChanged()
+{
+    if (isActive() && !TimerWheel::instance()->isActive(m_settle))
+    {
+        m_settle = TimerWheel::instance()->start(this, SLOT(settled()), SettleMs, false);
+    }
+}
+
+void StreamNegotiator::settled()
+{
+    m_settle = TimerWheel::InvalidTimer;
+    negotiate();
+}
+
+void StreamNegotiator::sendNext()
+{
+    for (int i = 0; i < MessageCount; ++i)
+    {
+        int wanted = interval(i);
+        if (wanted == m_applied[i])
+        {
+            continue;
+        }
+        m_inFlight = i;
+        m_inFlightInterval = wanted;
+        mavlink_command_long_t cmd;
+        cmd.command = SetMessageIntervalCommand;
+        cmd.confirmation = 0;
+        cmd.param1 = messages[i].msgid;
+        cmd.param2 = wanted;
+        cmd.param3 = 0.0f;
+        cmd.param4 = 0.0f;
+        cmd.param5 = 0.0f;
+        cmd.param6 = 0.0f;
+        cmd.param7 = 0.0f;
+        cmd.target_system = m_uas->getUASID();
+        cmd.target_component = 0;
+        m_uas->getCommandTracker()->send(cmd);
+        return;
+    }
+}
+
+void StreamNegotiator::commandFinished(int uas, int component, int command, int result, int attempts, int rttMs)
+{
+    Q_UNUSED(component);
+    Q_UNUSED(attempts);
+    Q_UNUSED(rttMs);
+    if (uas != m_uas->getUASID() || command != SetMessageIntervalCommand || m_inFlight < 0)
+    {
+        return;
+    }
+    int entry = m_inFlight;
+    m_inFlight = -1;
+
+    if (m_support == Probing)
+    {
+        if (result != MAV_RESULT_ACCEPTED)
+        {
+            QLOG_INFO() << "Streams: system" << uas << "has no message intervals (" << result << "), using data streams";
+            setSupport(Unsupported);
+            return;
+        }
+        QLOG_INFO() << "Streams: system" << uas << "takes message intervals, the data streams are stopped";
+        setSupport(Supported);
+        // Overrides outlive the stream rates, so only what is asked for keeps coming
+        m_uas->enableAllDataTransmission(0);
+    }
+    else if (result != MAV_RESULT_ACCEPTED)
+    {
+        // Not sent again until the wanted interval changes
+        QLOG_WARN() << "Streams: system" << uas << "refused an interval of" << m_inFlightInterval
+                    << "us for message" << messages[entry].msgid << "(" << result << ")";
+    }
+    m_applied[entry] = m_inFlightInterval;
+    sendNext();
+}
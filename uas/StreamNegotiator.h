@@ -0,0 +1,76 @@
+#ifndef STREAMNEGOTIATOR_H
+#define STREAMNEGOTIATOR_H
+
+#include <QObject>
+#include <QVector>
+#include "QGCMAVLink.h"
+#include "TimerWheel.h"
+
+class UAS;
+class StreamRateTuner;
+
+/**
+ * @brief Per message intervals for exactly what the ground station consumes
+ *
+ * REQUEST_DATA_STREAM only switches whole groups. Where the autopilot
+ * accepts MAV_CMD_SET_MESSAGE_INTERVAL the group streams are stopped and
+ * each message of the table is requested on its own: at its group's rate
+ * from StreamRateTuner while somebody wants it, and turned off otherwise.
+ * A message is wanted when a consumer subscribed to its id at the
+ * dispatcher or required it (MAVLinkDispatcher::isWanted()), when a plot
+ * subscribed one of its fields at the decoder, or when the vehicle state,
+ * recorders and alarms always need it.
+ *
+ * The first interval doubles as the probe. An UNSUPPORTED answer, or none
+ * at all, leaves the vehicle on REQUEST_DATA_STREAM. Commands go through
+ * CommandTracker one at a time, only messages whose interval changed are
+ * sent, and subscription changes are collected for SettleMs first.
+ */
+class StreamNegotiator : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief MAV_CMD_SET_MESSAGE_INTERVAL, newer than the bundled headers */
+    enum { SetMessageIntervalCommand = 511, SettleMs = 1000 };
+    enum Support { Unknown, Probing, Supported, Unsupported };
+
+    StreamNegotiator(UAS *uas, StreamRateTuner *tuner);
+    ~StreamNegotiator();
+
+    Support support() const { return m_support; }
+    /** @brief The tuner sends per message intervals instead of stream requests */
+    bool isActive() const { return m_support == Supported; }
+    /** @brief Ask whether intervals are supported, the first time only */
+    void probe();
+    /** @brief Stop the data streams again and send every interval, e.g. after a reconnect */
+    void requestAll();
+    /** @brief Send the intervals that changed since the last negotiation */
+    void negotiate();
+    /** @brief Messages requested at a rate, the others are off */
+    int wantedCount() const;
+
+signals:
+    void supportChanged(int support);
+
+private slots:
+    void subscriptionsChanged();
+    void settled();
+    void commandFinished(int uas, int component, int command, int result, int attempts, int rttMs);
+
+private:
+    /** @brief Interval in us for entry, -1 to turn it off */
+    int interval(int entry) const;
+    bool isWanted(int entry) const;
+    void sendNext();
+    void setSupport(Support support);
+
+    UAS *m_uas;
+    StreamRateTuner *m_tuner;
+    Support m_support;
+    QVector<int> m_applied;     ///< Interval the autopilot accepted per entry, 0 before the first
+    int m_inFlight;             ///< Entry waiting for its ACK, -1 for none
+    int m_inFlightInterval;
+    TimerWheel::TimerId m_settle;
+};
+
+#endif // STREAMNEGOTIATOR_H
@@ -0,0 +1,345 @@
+#include "StreamRateTuner.h"
+#include "StreamNegotiator.h"
+#include "UAS1.h"
+#include "LinkInterface.h"
+#include "LinkManager1.h"
+#include "MAVLinkProtocol1.h"
+#include "MAVLinkSender.h"
+#include "MAVLinkLatencyProbe.h"
+#include "VehicleState.h"
+#include "QsLog.h"
+#include <QSettings>
+
+static const int TickMs = 2000;
+// Ticks without congestion before a stream is raised, lets the radio buffer drain first
+static const int HealthyTicks = 3;
+// RADIO reports older than this no longer describe the link
+static const int RadioStaleMs = 5000;
+static const float CongestedLoss = 10.0f;
+static const float SevereLoss = 25.0f;
+static const float HealthyLoss = 2.0f;
+// txbuf is read the way ArduPilot's own throttling reads it: little room left is congestion
+static const int CongestedTxbuf = 50;
+static const int SevereTxbuf = 20;
+static const int HealthyTxbuf = 80;
+static const int CongestedRxErrors = 5;
+// Raise only while the link carries less than this share of the capacity estimate
+static const double Headroom = 0.9;
+// Share of the capacity the bulk uplink may take, the radio splits its air time between directions
+static const double UplinkShare = 0.25;
+// Parameter and mission transfers still have to make progress
+static const int MinUplinkCap = 100;
+// Smaller changes of the cap are not worth dropping the sender's byte budget for
+static const double UplinkCapHysteresis = 0.1;
+
+struct StreamClassInfo
+{
+    const char *key;                ///< DATA_RATES setting
+    int ceiling;                    ///< Default of the setting
+    int floor;                      ///< Never shed below, unless the setting is lower
+    void (UAS::*enable)(int rate);
+};
+
+static const StreamClassInfo streamClasses[StreamRateTuner::ClassCount] =
+{
+    { "EXTRA1", 10, 4, &UAS::enableExtra1Transmission },
+    { "POSITION", 3, 1, &UAS::enablePositionTransmission },
+    { "EXTRA2", 10, 2, &UAS::enableExtra2Transmission },
+    { "EXT_SYS_STATUS", 2, 1, &UAS::enableExtendedSystemStatusTransmission },
+    { "EXTRA3", 2, 0, &UAS::enableExtra3Transmission },
+    { "RC_CHANNEL_DATA", 2, 0, &UAS::enableRCChannelDataTransmission },
+    { "RAW_SENSOR_DATA", 2, 0, &UAS::enableRawSensorDataTransmission }
+};
+
+StreamRateTuner::StreamRateTuner(UAS *uas) :
+    QObject(uas),
+    m_uas(uas),
+    m_negotiator(NULL),
+    m_enabled(false),
+    m_loadLimited(false),
+    m_timer(TimerWheel::InvalidTimer),
+    m_loss(0),
+    m_txbuf(-1),
+    m_rxerrors(0),
+    m_rxerrorsSeen(0),
+    m_radioTime(0),
+    m_uplinkCap(0),
+    m_healthyTicks(0)
+{
+    m_clock.start();
+    loadCeilings();
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        m_rate[i] = m_ceiling[i];
+    }
+    m_negotiator = new StreamNegotiator(uas, this);
+}
+
+StreamRateTuner::~StreamRateTuner()
+{
+    TimerWheel::instance()->stop(m_timer);
+}
+
+void StreamRateTuner::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled)
+    {
+        return;
+    }
+    m_enabled = enabled;
+    if (enabled)
+    {
+        m_healthyTicks = 0;
+        m_timer = TimerWheel::instance()->start(this, SLOT(tick()), TickMs);
+        return;
+    }
+    TimerWheel::instance()->stop(m_timer);
+    m_timer = TimerWheel::InvalidTimer;
+    setUplinkCap(0);
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        m_rate[i] = ceiling(i);
+    }
+}
+
+void StreamRateTuner::setLoadLimited(bool limited)
+{
+    if (limited == m_loadLimited)
+    {
+        return;
+    }
+    m_loadLimited = limited;
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        if (m_rate[i] > ceiling(i) || (!m_enabled && m_rate[i] != ceiling(i)))
+        {
+            m_rate[i] = ceiling(i);
+            request(i);
+        }
+    }
+}
+
+void StreamRateTuner::loadCeilings()
+{
+    QSettings settings;
+    settings.beginGroup("DATA_RATES");
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        m_ceiling[i] = qMax(0, settings.value(streamClasses[i].key, streamClasses[i].ceiling).toInt());
+    }
+    settings.endGroup();
+}
+
+int StreamRateTuner::ceiling(int stream) const
+{
+    if (!m_loadLimited)
+    {
+        return m_ceiling[stream];
+    }
+    return qMin(m_ceiling[stream], qMax(streamClasses[stream].floor, m_ceiling[stream] / 2));
+}
+
+void StreamRateTuner::requestAll()
+{
+    loadCeilings();
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        if (!m_enabled || m_rate[i] > ceiling(i))
+        {
+            m_rate[i] = ceiling(i);
+        }
+    }
+    if (m_negotiator->isActive())
+    {
+        m_negotiator->requestAll();
+        return;
+    }
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        request(i);
+    }
+    // Until the answer the streams above keep the vehicle talking
+    m_negotiator->probe();
+}
+
+void StreamRateTuner::request(int stream)
+{
+    if (m_negotiator->isActive())
+    {
+        m_negotiator->negotiate();
+        return;
+    }
+    (m_uas->*streamClasses[stream].enable)(m_rate[stream]);
+}
+
+void StreamRateTuner::radioReceived(const mavlink_radio_t &radio)
+{
+    radioReceived(radio.rssi, radio.remrssi, radio.noise, radio.remnoise, radio.txbuf, radio.rxerrors);
+}
+
+void StreamRateTuner::radioReceived(const mavlink_radio_status_t &radio)
+{
+    radioReceived(radio.rssi, radio.remrssi, radio.noise, radio.remnoise, radio.txbuf, radio.rxerrors);
+}
+
+void StreamRateTuner::radioReceived(int rssi, int remrssi, int noise, int remnoise, int txbuf, int rxerrors)
+{
+    m_txbuf = txbuf;
+    m_rxerrors = rxerrors;
+    if (m_radioTime == 0)
+    {
+        m_rxerrorsSeen = m_rxerrors;
+    }
+    m_radioTime = qMax(Q_INT64_C(1), m_clock.elapsed());
+    m_budget.radioReceived(rssi, remrssi, noise, remnoise, txbuf, m_radioTime);
+}
+
+void StreamRateTuner::receiveLossChanged(int uasId, float loss)
+{
+    if (uasId == m_uas->getUASID())
+    {
+        m_loss = loss;
+    }
+}
+
+qint64 StreamRateTuner::inDataRate() const
+{
+    qint64 rate = 0;
+    QList<LinkInterface*> *links = m_uas->getLinks();
+    for (int i = 0; i < links->size(); ++i)
+    {
+        rate += links->at(i)->getCurrentInDataRate();
+    }
+    return rate;
+}
+
+void StreamRateTuner::setUplinkCap(int bytesPerSecond)
+{
+    if (bytesPerSecond == m_uplinkCap
+            || (bytesPerSecond > 0 && m_uplinkCap > 0
+                && qAbs(bytesPerSecond - m_uplinkCap) < UplinkCapHysteresis * m_uplinkCap))
+    {
+        return;
+    }
+    m_uplinkCap = bytesPerSecond;
+    MAVLinkSender *sender = LinkManager::instance()->getMavlinkProtocol()->sender();
+    QList<LinkInterface*> *links = m_uas->getLinks();
+    for (int i = 0; i < links->size(); ++i)
+    {
+        sender->setRateLimit(links->at(i)->getId(), bytesPerSecond);
+    }
+}
+
+void StreamRateTuner::tick()
+{
+    qint64 now = m_clock.elapsed();
+    bool radio = m_radioTime > 0 && now - m_radioTime < RadioStaleMs;
+    // rxerrors is a wrapping counter
+    int rxerrors = radio ? static_cast<quint16>(m_rxerrors - m_rxerrorsSeen) : 0;
+    m_rxerrorsSeen = m_rxerrors;
+
+    bool severe = m_loss > SevereLoss || (radio && m_txbuf < SevereTxbuf);
+    bool congested = severe || m_loss > CongestedLoss
+            || (radio && (m_txbuf < CongestedTxbuf || rxerrors > CongestedRxErrors));
+    bool healthy = m_loss < HealthyLoss && (!radio || (m_txbuf > HealthyTxbuf && rxerrors == 0));
+    qint64 rate = inDataRate();
+
+    if (congested)
+    {
+        m_budget.congested(rate);
+    }
+    else if (healthy)
+    {
+        m_budget.probe();
+    }
+    MAVLinkProtocol *protocol = LinkManager::instance()->getMavlinkProtocol();
+    VehicleState state;
+    float distance = protocol->vehicleState(m_uas->getUASID(), &state) ? state.distToHome : -1.0f;
+    const LinkBudget::Estimate &budget = m_budget.update(now, m_loss,
+            protocol->latencyProbe()->roundTripTime(m_uas->getUASID()), rate, distance);
+    // Only a radio link is known to be narrow enough to cap
+    if (budget.radio && budget.capacity > 0)
+    {
+        double share = budget.saturating ? UplinkShare / 2 : UplinkShare;
+        setUplinkCap(qMax(MinUplinkCap, static_cast<int>(budget.capacity * share / 8)));
+    }
+    else
+    {
+        setUplinkCap(0);
+    }
+
+    if (congested)
+    {
+        m_healthyTicks = 0;
+        if (shed(severe ? 2 : 1))
+        {
+            QLOG_DEBUG() << "Stream rates of system" << m_uas->getUASID() << "lowered, loss" << m_loss
+                         << "txbuf" << (radio ? m_txbuf : -1) << "at" << rate << "bit/s";
+        }
+        return;
+    }
+    // Ahead of the congestion the link is heading for
+    if (budget.saturating)
+    {
+        m_healthyTicks = 0;
+        if (shed(1))
+        {
+            QLOG_DEBUG() << "Stream rates of system" << m_uas->getUASID() << "lowered, saturation predicted in"
+                         << budget.saturationMs << "ms, fade margin" << budget.fadeMargin << "dB, range left"
+                         << budget.rangeLeft << "m, at" << rate << "of" << budget.capacity << "bit/s";
+        }
+        return;
+    }
+    if (!healthy)
+    {
+        m_healthyTicks = 0;
+        return;
+    }
+    if (++m_healthyTicks < HealthyTicks)
+    {
+        return;
+    }
+    if (budget.capacity > 0 && rate > Headroom * budget.capacity)
+    {
+        return;
+    }
+    m_healthyTicks = 0;
+    if (restore())
+    {
+        QLOG_DEBUG() << "Stream rates of system" << m_uas->getUASID() << "raised at" << rate << "bit/s";
+    }
+}
+
+bool StreamRateTuner::shed(int count)
+{
+    bool changed = false;
+    for (int i = ClassCount - 1; i >= 0 && count > 0; --i)
+    {
+        int floor = qMin(streamClasses[i].floor, ceiling(i));
+        if (m_rate[i] <= floor)
+        {
+            continue;
+        }
+        m_rate[i] = qMax(floor, m_rate[i] / 2);
+        request(i);
+        changed = true;
+        --count;
+    }
+    return changed;
+}
+
+bool StreamRateTuner::restore()
+{
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        if (m_rate[i] >= ceiling(i))
+        {
+            continue;
+        }
+        // A quarter of the ceiling per step, so a 10 Hz stream is back in four
+        m_rate[i] = qMin(ceiling(i), m_rate[i] + qMax(1, m_ceiling[i] / 4));
+        request(i);
+        return true;
+    }
+    return false;
+}
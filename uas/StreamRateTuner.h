@@ -0,0 +1,114 @@
+#ifndef STREAMRATETUNER_H
+#define STREAMRATETUNER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include "QGCMAVLink.h"
+#include "TimerWheel.h"
+#include "LinkBudget.h"
+
+class UAS;
+class StreamNegotiator;
+
+/**
+ * @brief REQUEST_DATA_STREAM rates that follow what the link can carry
+ *
+ * The rates in the DATA_RATES settings are ceilings. Every TickMs the
+ * receive loss of the vehicle, the radio's RADIO report and the incoming
+ * data rate of its links decide whether the link is congested, healthy or
+ * in between. Congestion halves the least important stream above its floor,
+ * and the data rate seen at that moment becomes the link capacity estimate.
+ * A link that stays healthy gets the most important stream below its
+ * ceiling raised again, one step at a time, while there is headroom left
+ * under the capacity estimate, which itself creeps up so the tuner keeps
+ * probing.
+ *
+ * LinkBudget looks ahead of that: when the txbuf or fade margin trend
+ * predicts congestion within its horizon, or the bandwidth left under the
+ * capacity is used up, a stream is shed before the loss shows. The same
+ * estimate caps the parameter, mission and bulk uplink in MAVLinkSender, so
+ * requests from the ground do not fill the radio's buffer either.
+ *
+ * Priority is attitude, then position and VFR_HUD, then status, then RC and
+ * raw sensors: the last to go and the first to come back is the horizon.
+ *
+ * Autopilots that take message intervals get the rates per message from
+ * StreamNegotiator instead, for only the messages somebody consumes.
+ */
+class StreamRateTuner : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Stream classes in priority order */
+    enum StreamClass { Attitude, Position, Hud, Status, Extra3, RcChannels, RawSensors, ClassCount };
+
+    explicit StreamRateTuner(UAS *uas);
+    ~StreamRateTuner();
+
+    /** @brief Adapt the rates, otherwise the ceilings are requested as they are */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Halve every ceiling, down to the stream's floor, while the ground station is overloaded
+     *
+     * Streams above the lowered ceiling are requested at it at once. When
+     * lifted the rates climb back as the tuner restores them, or straight
+     * to the ceilings if it is not adapting.
+     */
+    void setLoadLimited(bool limited);
+    bool isLoadLimited() const { return m_loadLimited; }
+
+    /** @brief Reload the ceilings and request every stream at its current rate */
+    void requestAll();
+    /** @brief Record a RADIO report of the vehicle's radio */
+    void radioReceived(const mavlink_radio_t &radio);
+    /** @brief Record a RADIO_STATUS report, the same fields as RADIO */
+    void radioReceived(const mavlink_radio_status_t &radio);
+    /** @brief Link budget as of the last tick */
+    const LinkBudget::Estimate &linkBudget() const { return m_budget.estimate(); }
+
+    int rate(StreamClass stream) const { return m_rate[stream]; }
+    /** @brief Per message intervals, which take over from the stream requests where supported */
+    StreamNegotiator *negotiator() const { return m_negotiator; }
+
+public slots:
+    /** @brief Receive loss of a system in percent, from MAVLinkProtocol */
+    void receiveLossChanged(int uasId, float loss);
+
+private slots:
+    void tick();
+
+private:
+    void loadCeilings();
+    /** @brief Ceiling of stream, lowered while load limited */
+    int ceiling(int stream) const;
+    /** @brief Halve the count least important streams above their floor */
+    bool shed(int count);
+    /** @brief Raise the most important stream below its ceiling */
+    bool restore();
+    void request(int stream);
+    qint64 inDataRate() const;
+    void radioReceived(int rssi, int remrssi, int noise, int remnoise, int txbuf, int rxerrors);
+    /** @brief Cap the lower two classes of MAVLinkSender on the vehicle's links, 0 lifts the cap */
+    void setUplinkCap(int bytesPerSecond);
+
+    UAS *m_uas;
+    StreamNegotiator *m_negotiator;
+    bool m_enabled;
+    bool m_loadLimited;
+    int m_rate[ClassCount];
+    int m_ceiling[ClassCount];
+    TimerWheel::TimerId m_timer;
+    QElapsedTimer m_clock;
+    float m_loss;                   ///< Last receive loss in percent
+    int m_txbuf;                    ///< Last RADIO txbuf, -1 before the first
+    int m_rxerrors;
+    int m_rxerrorsSeen;             ///< rxerrors at the previous tick
+    qint64 m_radioTime;             ///< m_clock time of the last RADIO
+    LinkBudget m_budget;            ///< Capacity estimate and saturation prediction
+    int m_uplinkCap;                ///< Bytes per second last set on the sender, 0 for none
+    int m_healthyTicks;
+};
+
+#endif // STREAMRATETUNER_H
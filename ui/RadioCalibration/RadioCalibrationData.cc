@@ -2,13 +2,13 @@
 
 RadioCalibrationData::RadioCalibrationData()
 {
-    data = new QVector<QVector<uint16_t> >(6);
-    (*data).insert(AILERON, QVector<uint16_t>(3));
-    (*data).insert(ELEVATOR, QVector<uint16_t>(3));
-    (*data).insert(RUDDER, QVector<uint16_t>(3));
-    (*data).insert(GYRO, QVector<uint16_t>(2));
-    (*data).insert(PITCH, QVector<uint16_t>(5));
-    (*data).insert(THROTTLE, QVector<uint16_t>(5));
+    data.reserve(6);
+    data << QVector<uint16_t>(3)    // AILERON
+         << QVector<uint16_t>(3)    // ELEVATOR
+         << QVector<uint16_t>(3)    // RUDDER
+         << QVector<uint16_t>(2)    // GYRO
+         << QVector<uint16_t>(5)    // PITCH
+         << QVector<uint16_t>(5);   // THROTTLE
 }
 
 RadioCalibrationData::RadioCalibrationData(const QVector<uint16_t> &aileron,
@@ -18,30 +18,29 @@ RadioCalibrationData::RadioCalibrationData(const QVector<uint16_t> &aileron,
         const QVector<uint16_t> &pitch,
         const QVector<uint16_t> &throttle)
 {
-    data = new QVector<QVector<uint16_t> >();
-    (*data) << aileron
-            << elevator
-            << rudder
-            << gyro
-            << pitch
-            << throttle;
+    data.reserve(6);
+    data << aileron
+         << elevator
+         << rudder
+         << gyro
+         << pitch
+         << throttle;
 }
 
 RadioCalibrationData::RadioCalibrationData(const RadioCalibrationData &other)
-    :QObject()
+    :QObject(),
+    data(other.data)
 {
-    data = new QVector<QVector<uint16_t> >(*other.data);
 }
 
 RadioCalibrationData::~RadioCalibrationData()
 {
-    delete data;
 }
 
 const uint16_t* RadioCalibrationData::operator [](int i) const
 {
-    if (i < data->size()) {
-        return (*data)[i].constData();
+    if (i < data.size()) {
+        return data[i].constData();
     }
 
     return NULL;
@@ -49,8 +48,8 @@ const uint16_t* RadioCalibrationData::operator [](int i) const
 
 const QVector<uint16_t>& RadioCalibrationData::operator ()(const int i) const throw(std::out_of_range)
 {
-    if ((i < data->size()) && (i >=0)) {
-        return (*data)[i];
+    if ((i < data.size()) && (i >=0)) {
+        return data[i];
     }
 
     throw std::out_of_range("Invalid channel index");
@@ -59,7 +58,7 @@ const QVector<uint16_t>& RadioCalibrationData::operator ()(const int i) const th
 QString RadioCalibrationData::toString(RadioElement element) const
 {
     QString s;
-    foreach (float f, (*data)[element]) {
+    foreach (float f, data[element]) {
         s += QString::number(f) + ", ";
     }
     return s.mid(0, s.length()-2);
@@ -74,7 +74,7 @@ public:
     const QVector<uint16_t>& operator()(int i) const throw(std::out_of_range);
 #endif
     void set(int element, int index, float value) {
-        (*data)[element][index] = value;
+        data[element][index] = value;
     }
 
 public slots:
@@ -102,15 +102,7 @@ public:
     QString toString(const RadioElement element) const;
 
 protected:
-    QVector<QVector<uint16_t> > *data;
-
-    void init(const QVector<float>& aileron,
-              const QVector<float>& elevator,
-              const QVector<float>& rudder,
-              const QVector<float>& gyro,
-              const QVector<float>& pitch,
-              const QVector<float>& throttle);
-
+    QVector<QVector<uint16_t> > data;
 };
 
 #endif // RADIOCALIBRATIONDATA_H
@@ -0,0 +1,77 @@
+#include "RadioChannels.h"
+
+#include <string.h>
+
+RadioChannels::RadioChannels() :
+    m_count(0),
+    m_calibrating(false)
+{
+    memset(m_channels, 0, sizeof(m_channels));
+}
+
+quint32 RadioChannels::update(int port, const uint16_t raw[PortWidth])
+{
+    if (port < 0 || port >= MaxPorts)
+        return 0;
+
+    RadioChannel *channel = m_channels + port * PortWidth;
+    // Unused channels keep their value: select it instead of branching
+    uint16_t value[PortWidth];
+    quint32 changed = 0;
+    int last = -1;
+    for (int i = 0; i < PortWidth; ++i) {
+        const bool used = raw[i] != Unused;
+        value[i] = used ? raw[i] : channel[i].raw;
+        changed |= quint32(value[i] != channel[i].raw) << i;
+        last = used ? i : last;
+        channel[i].raw = value[i];
+    }
+
+    if (m_calibrating) {
+        for (int i = 0; i < PortWidth; ++i) {
+            // a channel first seen during the calibration starts its range here
+            const bool fresh = channel[i].trim == 0 && value[i] != 0;
+            channel[i].trim = fresh ? value[i] : channel[i].trim;
+            channel[i].min = fresh ? value[i] : qMin(channel[i].min, value[i]);
+            channel[i].max = qMax(channel[i].max, value[i]);
+        }
+    }
+
+    m_count = qMax(m_count, port * PortWidth + last + 1);
+    return changed << (port * PortWidth);
+}
+
+quint32 RadioChannels::updateScaled(int port, const int16_t scaled[PortWidth])
+{
+    if (port < 0 || port >= MaxPorts)
+        return 0;
+
+    RadioChannel *channel = m_channels + port * PortWidth;
+    quint32 changed = 0;
+    int last = -1;
+    for (int i = 0; i < PortWidth; ++i) {
+        const bool used = static_cast<uint16_t>(scaled[i]) != Unused;
+        const int16_t value = used ? scaled[i] : channel[i].scaled;
+        changed |= quint32(value != channel[i].scaled) << i;
+        last = used ? i : last;
+        channel[i].scaled = value;
+    }
+
+    m_count = qMax(m_count, port * PortWidth + last + 1);
+    return changed << (port * PortWidth);
+}
+
+void RadioChannels::startCalibration()
+{
+    for (int i = 0; i < MaxChannels; ++i) {
+        m_channels[i].trim = m_channels[i].raw;
+        m_channels[i].min = m_channels[i].raw;
+        m_channels[i].max = m_channels[i].raw;
+    }
+    m_calibrating = true;
+}
+
+void RadioChannels::endCalibration()
+{
+    m_calibrating = false;
+}
@@ -0,0 +1,90 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Latest raw remote control channels and their calibration range
+ */
+
+#ifndef RADIOCHANNELS_H
+#define RADIOCHANNELS_H
+
+#include <QtGlobal>
+
+#include <stdint.h>
+
+/** @brief State of one remote control channel, in microseconds */
+struct RadioChannel
+{
+    uint16_t raw;   ///< Last value, 0 until the channel was received
+    uint16_t min;   ///< Lowest value since the calibration started
+    uint16_t max;   ///< Highest value since the calibration started
+    uint16_t trim;  ///< Value when the calibration started, sticks centred
+    int16_t scaled; ///< Last RC_CHANNELS_SCALED value, -10000 to 10000
+};
+
+/**
+ * @brief Fixed store of the RC_CHANNELS_RAW and RC_CHANNELS_SCALED channels of all ports.
+ *
+ * One message updates a whole port in one pass and reports which
+ * channels changed as a bit mask, so listeners get one notification per
+ * message instead of one per channel. While calibrating the same pass
+ * widens each channel's min and max; the loop has no data dependent
+ * branches so the compiler can vectorize it.
+ */
+class RadioChannels
+{
+public:
+    enum {
+        PortWidth = 8,
+        MaxPorts = 4,
+        MaxChannels = PortWidth * MaxPorts,  ///< Fits the changed mask
+        Unused = UINT16_MAX                  ///< Sent for channels the port does not have
+    };
+
+    RadioChannels();
+
+    /** @brief Stores one port, returns the mask of channels whose value changed */
+    quint32 update(int port, const uint16_t raw[PortWidth]);
+    /** @brief Same for the scaled values of a port */
+    quint32 updateScaled(int port, const int16_t scaled[PortWidth]);
+
+    /** @brief Starts min, max and trim capture from the current values */
+    void startCalibration();
+    void endCalibration();
+    bool isCalibrating() const { return m_calibrating; }
+
+    /** @brief Highest channel received plus one */
+    int count() const { return m_count; }
+    const RadioChannel& channel(int index) const { return m_channels[index]; }
+    const RadioChannel* channels() const { return m_channels; }
+    /** @brief Scaled value of a channel, -1 to 1 */
+    float normalized(int index) const { return m_channels[index].scaled / 10000.0f; }
+
+private:
+    RadioChannel m_channels[MaxChannels];
+    int m_count;
+    bool m_calibrating;
+};
+
+#endif // RADIOCHANNELS_H